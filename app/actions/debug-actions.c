@@ -25,6 +25,7 @@
 #include "actions-types.h"
 
 #include "core/gimp.h"
+#include "core/gimp-tile-profile.h"
 
 #include "widgets/gimpactiongroup.h"
 
@@ -54,6 +55,28 @@ static const GimpActionEntry debug_actions[] =
     debug_benchmark_projection_cmd_callback,
     NULL },
 
+  { "debug-record-session", NULL,
+    N_("_Record Session"), NULL, { NULL },
+    N_("Starts recording the tool events of the active display and the "
+       "procedures run from the menus to a file in the configuration "
+       "folder, or stops the recording."),
+    debug_record_session_cmd_callback,
+    NULL },
+
+  { "debug-replay-session", NULL,
+    N_("Rep_lay Session"), NULL, { NULL },
+    N_("Replays the recorded session on the active display, and prints "
+       "the time each of its strokes and procedures takes to stdout."),
+    debug_replay_session_cmd_callback,
+    NULL },
+
+  { "debug-tile-heat-map-reset", NULL,
+    N_("_Reset Tile Heat Map"), NULL, { NULL },
+    N_("Forgets the tile cache misses counted so far, so that the heat "
+       "map only shows those of what follows."),
+    debug_tile_heat_map_reset_cmd_callback,
+    NULL },
+
   { "debug-show-image-graph", NULL,
     N_("Show Image _Graph"), NULL, { NULL },
     N_("Creates a new image showing the GEGL graph of this image"),
@@ -71,6 +94,19 @@ static const GimpActionEntry debug_actions[] =
     NULL }
 };
 
+static const GimpToggleActionEntry debug_toggle_actions[] =
+{
+  { "debug-tile-heat-map", NULL,
+    N_("Tile _Heat Map"), NULL, { NULL },
+    N_("Shows the tiles of the images fetched while not in the tile "
+       "cache over the canvas: drawables in red, projections in blue, "
+       "undo in green, the more opaque the more often.  Tiles read back "
+       "from swap count double."),
+    debug_tile_heat_map_cmd_callback,
+    FALSE,
+    NULL }
+};
+
 void
 debug_actions_setup (GimpActionGroup *group)
 {
@@ -80,12 +116,19 @@ debug_actions_setup (GimpActionGroup *group)
                                  debug_actions,
                                  G_N_ELEMENTS (debug_actions));
 
+  gimp_action_group_add_toggle_actions (group, NULL,
+                                        debug_toggle_actions,
+                                        G_N_ELEMENTS (debug_toggle_actions));
+
 #define SET_VISIBLE(action,condition) \
         gimp_action_group_set_action_visible (group, action, (condition) != 0)
 
   for (i = 0; i < G_N_ELEMENTS (debug_actions); i++)
     SET_VISIBLE (debug_actions[i].name, group->gimp->show_debug_menu);
 
+  for (i = 0; i < G_N_ELEMENTS (debug_toggle_actions); i++)
+    SET_VISIBLE (debug_toggle_actions[i].name, group->gimp->show_debug_menu);
+
 #undef SET_VISIBLE
 }
 
@@ -97,6 +140,7 @@ debug_actions_update (GimpActionGroup *group,
         gimp_action_group_set_action_sensitive (group, action, (condition) != 0, NULL)
 
   SET_SENSITIVE ("debug-show-image-graph", gegl_has_operation ("gegl:introspect"));
+  SET_SENSITIVE ("debug-tile-heat-map-reset", gimp_tile_profile_is_enabled ());
 
 #undef SET_SENSITIVE
 }
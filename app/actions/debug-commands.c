@@ -27,6 +27,7 @@
 #include "actions-types.h"
 
 #include "core/gimp.h"
+#include "core/gimp-tile-profile.h"
 #include "core/gimp-utils.h"
 #include "core/gimpcontext.h"
 #include "core/gimpimage.h"
@@ -42,6 +43,8 @@
 
 #include "display/gimpdisplay.h"
 #include "display/gimpdisplayshell.h"
+#include "display/gimpdisplayshell-expose.h"
+#include "display/gimpdisplayshell-replay.h"
 #include "display/gimpimagewindow.h"
 
 #include "menus/menus.h"
@@ -53,6 +56,7 @@
 /*  local function prototypes  */
 
 static gboolean  debug_benchmark_projection    (GimpDisplay *display);
+static gboolean  debug_replay_session          (GimpDisplay *display);
 static gboolean  debug_show_image_graph        (GimpImage   *source_image);
 
 static void      debug_print_qdata             (GimpObject  *object);
@@ -60,6 +64,13 @@ static void      debug_print_qdata_foreach     (GQuark       key_id,
                                                 gpointer     data,
                                                 gpointer     user_data);
 
+static gboolean  debug_tile_heat_map_update    (Gimp        *gimp);
+
+
+/*  local variables  */
+
+static guint debug_tile_heat_map_timeout_id = 0;
+
 
 /*  public functions  */
 
@@ -98,6 +109,49 @@ debug_benchmark_projection_cmd_callback (GimpAction *action,
   g_idle_add ((GSourceFunc) debug_benchmark_projection, g_object_ref (display));
 }
 
+void
+debug_record_session_cmd_callback (GimpAction *action,
+                                   GVariant   *value,
+                                   gpointer    data)
+{
+  GimpDisplay *display;
+  GFile       *file;
+  GError      *error = NULL;
+  return_if_no_display (display, data);
+
+  file = gimp_directory_file ("session-recording.txt", NULL);
+
+  if (gimp_display_shell_is_recording (NULL))
+    {
+      gimp_display_shell_record_stop ();
+
+      g_print ("Stopped recording to %s\n", gimp_file_get_utf8_name (file));
+    }
+  else if (gimp_display_shell_record_start (gimp_display_get_shell (display),
+                                            file, &error))
+    {
+      g_print ("Started recording to %s\n", gimp_file_get_utf8_name (file));
+    }
+  else
+    {
+      g_printerr ("Recording failed: %s\n", error->message);
+      g_clear_error (&error);
+    }
+
+  g_object_unref (file);
+}
+
+void
+debug_replay_session_cmd_callback (GimpAction *action,
+                                   GVariant   *value,
+                                   gpointer    data)
+{
+  GimpDisplay *display;
+  return_if_no_display (display, data);
+
+  g_idle_add ((GSourceFunc) debug_replay_session, g_object_ref (display));
+}
+
 void
 debug_show_image_graph_cmd_callback (GimpAction *action,
                                      GVariant   *value,
@@ -199,6 +253,50 @@ debug_dump_attached_data_cmd_callback (GimpAction *action,
 }
 
 
+void
+debug_tile_heat_map_cmd_callback (GimpAction *action,
+                                  GVariant   *value,
+                                  gpointer    data)
+{
+  Gimp     *gimp;
+  gboolean  active = g_variant_get_boolean (value);
+  return_if_no_gimp (gimp, data);
+
+  if (active == (debug_tile_heat_map_timeout_id != 0))
+    return;
+
+  if (active)
+    {
+      gimp_tile_profile_enable (gimp);
+
+      debug_tile_heat_map_timeout_id =
+        g_timeout_add_seconds (1,
+                               (GSourceFunc) debug_tile_heat_map_update,
+                               gimp);
+    }
+  else
+    {
+      g_clear_handle_id (&debug_tile_heat_map_timeout_id, g_source_remove);
+
+      gimp_tile_profile_disable ();
+    }
+
+  debug_tile_heat_map_update (gimp);
+}
+
+void
+debug_tile_heat_map_reset_cmd_callback (GimpAction *action,
+                                        GVariant   *value,
+                                        gpointer    data)
+{
+  Gimp *gimp;
+  return_if_no_gimp (gimp, data);
+
+  gimp_tile_profile_reset ();
+
+  debug_tile_heat_map_update (gimp);
+}
+
 /*  private functions  */
 
 static gboolean
@@ -225,6 +323,31 @@ debug_benchmark_projection (GimpDisplay *display)
   return FALSE;
 }
 
+static gboolean
+debug_replay_session (GimpDisplay *display)
+{
+  GimpDisplayShell *shell = gimp_display_get_shell (display);
+  GFile            *file;
+  GError           *error = NULL;
+
+  file = gimp_directory_file ("session-recording.txt", NULL);
+
+  /*  replaying what is being recorded would never end  */
+  if (gimp_display_shell_is_recording (NULL))
+    gimp_display_shell_record_stop ();
+
+  if (shell && ! gimp_display_shell_replay (shell, file, &error))
+    {
+      g_printerr ("Replay failed: %s\n", error->message);
+      g_clear_error (&error);
+    }
+
+  g_object_unref (file);
+  g_object_unref (display);
+
+  return FALSE;
+}
+
 static gboolean
 debug_show_image_graph (GimpImage *source_image)
 {
@@ -296,3 +419,18 @@ debug_print_qdata_foreach (GQuark   key_id,
 {
   g_print ("%s: %p\n", g_quark_to_string (key_id), data);
 }
+
+static gboolean
+debug_tile_heat_map_update (Gimp *gimp)
+{
+  GList *list;
+
+  for (list = gimp_get_display_iter (gimp); list; list = g_list_next (list))
+    {
+      GimpDisplay *display = list->data;
+
+      gimp_display_shell_expose_full (gimp_display_get_shell (display));
+    }
+
+  return G_SOURCE_CONTINUE;
+}
@@ -27,6 +27,12 @@ void   debug_mem_profile_cmd_callback             (GimpAction *action,
 void   debug_benchmark_projection_cmd_callback    (GimpAction *action,
                                                    GVariant   *value,
                                                    gpointer    data);
+void   debug_record_session_cmd_callback          (GimpAction *action,
+                                                   GVariant   *value,
+                                                   gpointer    data);
+void   debug_replay_session_cmd_callback          (GimpAction *action,
+                                                   GVariant   *value,
+                                                   gpointer    data);
 void   debug_show_image_graph_cmd_callback        (GimpAction *action,
                                                    GVariant   *value,
                                                    gpointer    data);
@@ -39,3 +45,9 @@ void   debug_dump_keyboard_shortcuts_cmd_callback (GimpAction *action,
 void   debug_dump_attached_data_cmd_callback      (GimpAction *action,
                                                    GVariant   *value,
                                                    gpointer    data);
+void   debug_tile_heat_map_cmd_callback           (GimpAction *action,
+                                                   GVariant   *value,
+                                                   gpointer    data);
+void   debug_tile_heat_map_reset_cmd_callback     (GimpAction *action,
+                                                   GVariant   *value,
+                                                   gpointer    data);
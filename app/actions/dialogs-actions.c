@@ -299,7 +299,15 @@ const GimpStringActionEntry dialogs_dockable_actions[] =
     { NULL },
     NC_("dialogs-action", "Open the dashboard"),
     "gimp-dashboard",
-    GIMP_HELP_ERRORS_DIALOG }
+    GIMP_HELP_ERRORS_DIALOG },
+
+  { "dialogs-render-profile", GIMP_ICON_DIALOG_DASHBOARD,
+    NC_("dialogs-action", "_Render Profile"),
+    NC_("dialogs-action", "_Render Profile"),
+    { NULL },
+    NC_("dialogs-action", "Open the render profile dialog"),
+    "gimp-render-profile-editor",
+    GIMP_HELP_RENDER_PROFILE_DIALOG }
 };
 
 gint n_dialogs_dockable_actions = G_N_ELEMENTS (dialogs_dockable_actions);
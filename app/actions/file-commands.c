@@ -38,6 +38,7 @@
 
 #include "plug-in/gimppluginmanager-file.h"
 
+#include "file/file-export-queue.h"
 #include "file/file-open.h"
 #include "file/file-save.h"
 #include "file/gimp-file.h"
@@ -386,13 +387,14 @@ file_save_cmd_callback (GimpAction *action,
 
         if (file && export_proc)
           {
-            saved = file_save_dialog_save_image (GIMP_PROGRESS (display),
-                                                 gimp, image, file,
-                                                 export_proc,
-                                                 GIMP_RUN_WITH_LAST_VALS,
-                                                 FALSE,
-                                                 overwrite, ! overwrite,
-                                                 FALSE, TRUE);
+            /*  repeated exports don't need any interaction, so run
+             *  them on a snapshot of the image and keep it editable
+             */
+            file_export_queue_add (gimp, image, GIMP_PROGRESS (display),
+                                   file, export_proc,
+                                   GIMP_RUN_WITH_LAST_VALS,
+                                   overwrite, ! overwrite);
+            saved = TRUE;
           }
       }
       break;
@@ -219,20 +219,28 @@ gimp_gegl_procedure_get_sensitive (GimpProcedure  *procedure,
   if (image)
     drawables = gimp_image_get_selected_drawables (image);
 
-  if (g_list_length (drawables) == 1)
+  if (drawables)
     {
-      GimpDrawable *drawable  = drawables->data;
-      GimpItem     *item;
+      GList *list;
 
-      if (GIMP_IS_LAYER_MASK (drawable))
-        item = GIMP_ITEM (gimp_layer_mask_get_layer (GIMP_LAYER_MASK (drawable)));
-      else
-        item = GIMP_ITEM (drawable);
+      sensitive = TRUE;
 
-      sensitive = ! gimp_item_is_content_locked (item, NULL);
+      for (list = drawables; list && sensitive; list = g_list_next (list))
+        {
+          GimpDrawable *drawable = list->data;
+          GimpItem     *item;
+
+          if (GIMP_IS_LAYER_MASK (drawable))
+            item = GIMP_ITEM (gimp_layer_mask_get_layer (GIMP_LAYER_MASK (drawable)));
+          else
+            item = GIMP_ITEM (drawable);
 
-      if (gimp_viewable_get_children (GIMP_VIEWABLE (drawable)))
-        sensitive = FALSE;
+          if (gimp_item_is_content_locked (item, NULL))
+            sensitive = FALSE;
+
+          if (gimp_viewable_get_children (GIMP_VIEWABLE (drawable)))
+            sensitive = FALSE;
+        }
     }
 
   g_list_free (drawables);
@@ -259,21 +267,26 @@ gimp_gegl_procedure_execute (GimpProcedure   *procedure,
 
   n_drawables = gimp_core_object_array_get_length ((GObject **) drawables);
 
-  if (n_drawables == 1)
+  if (n_drawables > 0)
     {
       GeglNode *node;
+      GList    *list = NULL;
+      gint      i;
+
+      for (i = n_drawables - 1; i >= 0; i--)
+        list = g_list_prepend (list, drawables[i]);
 
       node = gegl_node_new_child (NULL,
                                   "operation",
                                   GIMP_GEGL_PROCEDURE (procedure)->operation,
                                   NULL);
 
-      gimp_drawable_apply_operation_with_config (GIMP_DRAWABLE (drawables[0]),
-                                                 progress,
-                                                 gimp_procedure_get_label (procedure),
-                                                 node, config);
+      gimp_drawables_apply_operation (list, progress,
+                                      gimp_procedure_get_label (procedure),
+                                      node, config);
 
       g_object_unref (node);
+      g_list_free (list);
 
       gimp_image_flush (image);
 
@@ -35,6 +35,7 @@
 #include "pdb/gimpprocedure.h"
 
 #include "display/gimpdisplay.h"
+#include "display/gimpdisplayshell-replay.h"
 
 #include "procedure-commands.h"
 
@@ -348,6 +349,9 @@ procedure_commands_run_procedure (GimpProcedure  *procedure,
     g_value_set_enum (gimp_value_array_index (args, 0),
                       GIMP_RUN_NONINTERACTIVE);
 
+  gimp_display_shell_record_procedure (procedure, GIMP_RUN_NONINTERACTIVE,
+                                       args);
+
   return_vals = gimp_procedure_execute (procedure, gimp,
                                         gimp_get_user_context (gimp),
                                         progress, args,
@@ -388,6 +392,8 @@ procedure_commands_run_procedure_async (GimpProcedure  *procedure,
     g_value_set_enum (gimp_value_array_index (args, 0),
                       run_mode);
 
+  gimp_display_shell_record_procedure (procedure, run_mode, args);
+
   gimp_procedure_execute_async (procedure, gimp,
                                 gimp_get_user_context (gimp),
                                 progress, args,
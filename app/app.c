@@ -55,11 +55,14 @@
 
 #include "core/gimp.h"
 #include "core/gimp-batch.h"
+#include "core/gimp-startup-profile.h"
 #include "core/gimp-user-install.h"
 #include "core/gimpimage.h"
 
 #include "file/file-open.h"
 
+#include "pdb/gimppdb-profile.h"
+
 #ifndef GIMP_CONSOLE_COMPILATION
 #include <gtk/gtk.h>
 
@@ -177,11 +180,15 @@ app_run (const gchar         *full_prog_name,
          const gchar         *session_name,
          const gchar         *batch_interpreter,
          const gchar        **batch_commands,
+         const gchar         *batch_queue,
+         gint                 batch_jobs,
+         guint64              batch_memory_limit,
          gboolean             quit,
          gboolean             as_new,
          gboolean             no_interface,
          gboolean             no_data,
          gboolean             no_fonts,
+         gboolean             core_only,
          gboolean             no_splash,
          gboolean             be_verbose,
          gboolean             use_shm,
@@ -200,6 +207,8 @@ app_run (const gchar         *full_prog_name,
   GFile              *gimpdir        = NULL;
   const gchar        *abort_message  = NULL;
   gint                retval         = EXIT_SUCCESS;
+  gint64              profile_time;
+  gboolean            pdb_profile;
 
   if (filenames && filenames[0] && ! filenames[1] &&
       g_file_test (filenames[0], G_FILE_TEST_IS_DIR))
@@ -231,6 +240,7 @@ app_run (const gchar         *full_prog_name,
                    no_data,
                    no_fonts,
                    no_interface,
+                   core_only,
                    use_shm,
                    use_cpu_accel,
                    console_messages,
@@ -242,9 +252,11 @@ app_run (const gchar         *full_prog_name,
   g_clear_object (&default_folder);
 
 #ifndef GIMP_CONSOLE_COMPILATION
-  app = gimp_app_new (gimp, no_splash, quit, as_new, filenames, batch_interpreter, batch_commands);
+  app = gimp_app_new (gimp, no_splash, quit, as_new, filenames, batch_interpreter, batch_commands,
+                      batch_queue, batch_jobs, batch_memory_limit);
 #else
-  app = gimp_console_app_new (gimp, quit, as_new, filenames, batch_interpreter, batch_commands);
+  app = gimp_console_app_new (gimp, quit, as_new, filenames, batch_interpreter, batch_commands,
+                              batch_queue, batch_jobs, batch_memory_limit);
 #endif
 
   gimp->app = app;
@@ -274,7 +286,9 @@ app_run (const gchar         *full_prog_name,
 
   g_object_unref (gimpdir);
 
+  profile_time = gimp_startup_profile_begin ();
   gimp_load_config (gimp, alternate_system_gimprc, alternate_gimprc);
+  gimp_startup_profile_end ("Configuration", profile_time);
 
   /* Initialize the error handling after creating/migrating the config
    * directory because it will create some folders for backup and crash
@@ -297,7 +311,17 @@ app_run (const gchar         *full_prog_name,
     app_abort (no_interface, abort_message);
 
   /*  initialize lowlevel stuff  */
+  profile_time = gimp_startup_profile_begin ();
   gimp_gegl_init (gimp);
+  gimp_startup_profile_end ("GEGL", profile_time);
+
+  /*  profile the PDB calls of the whole session, which is mostly useful
+   *  for batch scripts, and print the profile when quitting
+   */
+  pdb_profile = g_getenv ("GIMP_PDB_PROFILE") != NULL;
+
+  if (pdb_profile)
+    gimp_pdb_profile_start (TRUE);
 
   g_signal_connect_after (gimp, "exit",
                           G_CALLBACK (app_exit_after_callback),
@@ -314,6 +338,12 @@ app_run (const gchar         *full_prog_name,
   if (gimp->be_verbose)
     g_print ("EXIT: %s\n", G_STRFUNC);
 
+  if (pdb_profile)
+    {
+      gimp_pdb_profile_stop ();
+      gimp_pdb_profile_dump ();
+    }
+
   g_clear_object (&app);
 
   gimp_gegl_exit (gimp);
@@ -355,6 +385,7 @@ app_activate_callback (GimpCoreApp *app,
   gchar              *prev_language      = NULL;
   GError             *font_error         = NULL;
   gint                batch_retval;
+  gint64              profile_time;
 
   g_return_if_fail (GIMP_IS_CORE_APP (app));
 
@@ -369,8 +400,12 @@ app_activate_callback (GimpCoreApp *app,
   current_language = language_init (NULL, &system_lang_l10n);
 #ifndef GIMP_CONSOLE_COMPILATION
   if (! gimp->no_interface)
-    update_status_func = gui_init (gimp, gimp_app_get_no_splash (GIMP_APP (app)),
-                                   GIMP_APP (app), NULL, system_lang_l10n);
+    {
+      profile_time = gimp_startup_profile_begin ();
+      update_status_func = gui_init (gimp, gimp_app_get_no_splash (GIMP_APP (app)),
+                                     GIMP_APP (app), NULL, system_lang_l10n);
+      gimp_startup_profile_end ("User interface", profile_time);
+    }
 #endif
 
   if (! update_status_func)
@@ -379,7 +414,9 @@ app_activate_callback (GimpCoreApp *app,
   /*  Create all members of the global Gimp instance which need an already
    *  parsed gimprc, e.g. the data factories
    */
+  profile_time = gimp_startup_profile_begin ();
   gimp_initialize (gimp, update_status_func);
+  gimp_startup_profile_end ("Initialize", profile_time);
 
   g_object_get (gimp->edit_config,
                 "prev-language", &prev_language,
@@ -390,12 +427,16 @@ app_activate_callback (GimpCoreApp *app,
   g_free (prev_language);
 
   /*  Load all data files */
+  profile_time = gimp_startup_profile_begin ();
   gimp_restore (gimp, update_status_func, &font_error);
+  gimp_startup_profile_end ("Restore", profile_time);
 
   /*  enable autosave late so we don't autosave when the
-   *  monitor resolution is set in gui_init()
+   *  monitor resolution is set in gui_init(), and not at all for the
+   *  core only, which leaves the user's configuration alone
    */
-  gimp_rc_set_autosave (GIMP_RC (gimp->edit_config), TRUE);
+  if (! gimp->core_only)
+    gimp_rc_set_autosave (GIMP_RC (gimp->edit_config), TRUE);
 
 #ifndef GIMP_CONSOLE_COMPILATION
   if (! gimp->no_interface)
@@ -457,7 +498,8 @@ app_activate_callback (GimpCoreApp *app,
   /*  check for updates *after* enabling config autosave, so that the timestamp
    *  is saved
    */
-  gimp_update_auto_check (gimp->edit_config, gimp);
+  if (! gimp->core_only)
+    gimp_update_auto_check (gimp->edit_config, gimp);
 
   /* Setting properties to be used for the next run.  */
   g_object_set (gimp->edit_config,
@@ -473,6 +515,8 @@ app_activate_callback (GimpCoreApp *app,
     {
       gint i;
 
+      profile_time = gimp_startup_profile_begin ();
+
       for (i = 0; filenames[i] != NULL; i++)
         {
           GFile *file = g_file_new_for_commandline_arg (filenames[i]);
@@ -483,6 +527,8 @@ app_activate_callback (GimpCoreApp *app,
 
           g_object_unref (file);
         }
+
+      gimp_startup_profile_end ("Open images", profile_time);
     }
 
   /* The software is now fully loaded and ready to be used and get
@@ -490,6 +536,8 @@ app_activate_callback (GimpCoreApp *app,
    */
   gimp->initialized = TRUE;
 
+  gimp_startup_profile_mark ("Ready");
+
   if (font_error)
     {
       gimp_message_literal (gimp, NULL,
@@ -502,6 +550,13 @@ app_activate_callback (GimpCoreApp *app,
                                  gimp_core_app_get_batch_interpreter (app),
                                  gimp_core_app_get_batch_commands (app));
 
+  if (batch_retval == EXIT_SUCCESS && gimp_core_app_get_batch_queue (app))
+    batch_retval = gimp_batch_run_queue (gimp,
+                                         gimp_core_app_get_batch_interpreter (app),
+                                         gimp_core_app_get_batch_queue (app),
+                                         gimp_core_app_get_batch_jobs (app),
+                                         gimp_core_app_get_batch_memory_limit (app));
+
   if (gimp_core_app_get_quit (app))
     {
       /*  Only if we are in batch mode, we want to exit with the
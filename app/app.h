@@ -35,11 +35,15 @@ gint  app_run       (const gchar         *full_prog_name,
                      const gchar         *session_name,
                      const gchar         *batch_interpreter,
                      const gchar        **batch_commands,
+                     const gchar         *batch_queue,
+                     gint                 batch_jobs,
+                     guint64              batch_memory_limit,
                      gboolean             quit,
                      gboolean             as_new,
                      gboolean             no_interface,
                      gboolean             no_data,
                      gboolean             no_fonts,
+                     gboolean             core_only,
                      gboolean             no_splash,
                      gboolean             be_verbose,
                      gboolean             use_shm,
@@ -420,6 +420,35 @@ gimp_theme_scheme_get_type (void)
   return type;
 }
 
+GType
+gimp_thread_placement_get_type (void)
+{
+  static const GEnumValue values[] =
+  {
+    { GIMP_THREAD_PLACEMENT_SYSTEM, "GIMP_THREAD_PLACEMENT_SYSTEM", "system" },
+    { GIMP_THREAD_PLACEMENT_TOPOLOGY, "GIMP_THREAD_PLACEMENT_TOPOLOGY", "topology" },
+    { 0, NULL, NULL }
+  };
+
+  static const GimpEnumDesc descs[] =
+  {
+    { GIMP_THREAD_PLACEMENT_SYSTEM, NC_("thread-placement", "Let the system decide"), NULL },
+    { GIMP_THREAD_PLACEMENT_TOPOLOGY, NC_("thread-placement", "Follow the CPU topology"), NULL },
+    { 0, NULL, NULL }
+  };
+
+  static GType type = 0;
+
+  if (G_UNLIKELY (! type))
+    {
+      type = g_enum_register_static ("GimpThreadPlacement", values);
+      gimp_type_set_translation_context (type, "thread-placement");
+      gimp_enum_set_value_descriptions (type, descs);
+    }
+
+  return type;
+}
+
 
 /* Generated data ends here */
 
@@ -174,3 +174,14 @@ typedef enum
   GIMP_THEME_DARK,   /*< desc="Dark Colors"   >*/
   GIMP_THEME_SYSTEM, /*< desc="System Colors" >*/
 } GimpThemeScheme;
+
+
+#define GIMP_TYPE_THREAD_PLACEMENT (gimp_thread_placement_get_type ())
+
+GType gimp_thread_placement_get_type (void) G_GNUC_CONST;
+
+typedef enum
+{
+  GIMP_THREAD_PLACEMENT_SYSTEM,   /*< desc="Let the system decide"  >*/
+  GIMP_THREAD_PLACEMENT_TOPOLOGY  /*< desc="Follow the CPU topology" >*/
+} GimpThreadPlacement;
@@ -99,9 +99,15 @@ enum
   PROP_DEFAULT_GRID,
   PROP_UNDO_LEVELS,
   PROP_UNDO_SIZE,
+  PROP_UNDO_SWAP_SIZE,
+  PROP_IMAGE_MEMORY_BUDGET,
+  PROP_CLIPBOARD_SWAP_THRESHOLD,
   PROP_UNDO_PREVIEW_SIZE,
   PROP_FILTER_HISTORY_SIZE,
   PROP_PLUGINRC_PATH,
+  PROP_PLUG_IN_POOL_SIZE,
+  PROP_PLUG_IN_POOL_IDLE_TIMEOUT,
+  PROP_PLUG_IN_POOL_MEMORY_LIMIT,
   PROP_LAYER_PREVIEWS,
   PROP_GROUP_LAYER_PREVIEWS,
   PROP_LAYER_PREVIEW_SIZE,
@@ -114,6 +120,7 @@ enum
   PROP_IMPORT_PROMOTE_DITHER,
   PROP_IMPORT_ADD_ALPHA,
   PROP_IMPORT_RAW_PLUG_IN,
+  PROP_XCF_LAZY_LOAD,
   PROP_EXPORT_FILE_TYPE,
   PROP_EXPORT_COLOR_PROFILE,
   PROP_EXPORT_COMMENT,
@@ -586,6 +593,31 @@ gimp_core_config_class_init (GimpCoreConfigClass *klass)
                             GIMP_PARAM_STATIC_STRINGS |
                             GIMP_CONFIG_PARAM_CONFIRM);
 
+  GIMP_CONFIG_PROP_MEMSIZE (object_class, PROP_UNDO_SWAP_SIZE,
+                            "undo-swap-size",
+                            "Undo swap size",
+                            UNDO_SWAP_SIZE_BLURB,
+                            0, GIMP_MAX_MEMSIZE,
+                            G_GUINT64_CONSTANT (1) << 31, /* 2GB */
+                            GIMP_PARAM_STATIC_STRINGS |
+                            GIMP_CONFIG_PARAM_CONFIRM);
+
+  GIMP_CONFIG_PROP_MEMSIZE (object_class, PROP_IMAGE_MEMORY_BUDGET,
+                            "image-memory-budget",
+                            "Image memory budget",
+                            IMAGE_MEMORY_BUDGET_BLURB,
+                            0, GIMP_MAX_MEMSIZE, 0,
+                            GIMP_PARAM_STATIC_STRINGS |
+                            GIMP_CONFIG_PARAM_CONFIRM);
+
+  GIMP_CONFIG_PROP_MEMSIZE (object_class, PROP_CLIPBOARD_SWAP_THRESHOLD,
+                            "clipboard-swap-threshold",
+                            "Clipboard swap threshold",
+                            CLIPBOARD_SWAP_THRESHOLD_BLURB,
+                            0, GIMP_MAX_MEMSIZE,
+                            G_GUINT64_CONSTANT (1) << 29, /* 512MB */
+                            GIMP_PARAM_STATIC_STRINGS);
+
   GIMP_CONFIG_PROP_ENUM (object_class, PROP_UNDO_PREVIEW_SIZE,
                          "undo-preview-size",
                          "Undo preview size",
@@ -613,6 +645,27 @@ gimp_core_config_class_init (GimpCoreConfigClass *klass)
                          GIMP_PARAM_STATIC_STRINGS |
                          GIMP_CONFIG_PARAM_RESTART);
 
+  GIMP_CONFIG_PROP_INT (object_class, PROP_PLUG_IN_POOL_SIZE,
+                        "plug-in-pool-size",
+                        "Plug-in pool size",
+                        PLUG_IN_POOL_SIZE_BLURB,
+                        0, 64, 0,
+                        GIMP_PARAM_STATIC_STRINGS);
+
+  GIMP_CONFIG_PROP_INT (object_class, PROP_PLUG_IN_POOL_IDLE_TIMEOUT,
+                        "plug-in-pool-idle-timeout",
+                        "Plug-in pool idle timeout",
+                        PLUG_IN_POOL_IDLE_TIMEOUT_BLURB,
+                        1, 3600, 60,
+                        GIMP_PARAM_STATIC_STRINGS);
+
+  GIMP_CONFIG_PROP_MEMSIZE (object_class, PROP_PLUG_IN_POOL_MEMORY_LIMIT,
+                            "plug-in-pool-memory-limit",
+                            "Plug-in pool memory limit",
+                            PLUG_IN_POOL_MEMORY_LIMIT_BLURB,
+                            0, GIMP_MAX_MEMSIZE, 1 << 28,
+                            GIMP_PARAM_STATIC_STRINGS);
+
   GIMP_CONFIG_PROP_BOOLEAN (object_class, PROP_LAYER_PREVIEWS,
                             "layer-previews",
                             "Layer previews",
@@ -744,6 +797,13 @@ gimp_core_config_class_init (GimpCoreConfigClass *klass)
                          GIMP_PARAM_STATIC_STRINGS |
                          GIMP_CONFIG_PARAM_RESTART);
 
+  GIMP_CONFIG_PROP_BOOLEAN (object_class, PROP_XCF_LAZY_LOAD,
+                            "xcf-lazy-load",
+                            "XCF lazy load",
+                            XCF_LAZY_LOAD_BLURB,
+                            FALSE,
+                            GIMP_PARAM_STATIC_STRINGS);
+
   GIMP_CONFIG_PROP_ENUM (object_class, PROP_EXPORT_FILE_TYPE,
                          "export-file-type",
                          "Default export file type",
@@ -1105,6 +1165,15 @@ gimp_core_config_set_property (GObject      *object,
     case PROP_UNDO_SIZE:
       core_config->undo_size = g_value_get_uint64 (value);
       break;
+    case PROP_UNDO_SWAP_SIZE:
+      core_config->undo_swap_size = g_value_get_uint64 (value);
+      break;
+    case PROP_IMAGE_MEMORY_BUDGET:
+      core_config->image_memory_budget = g_value_get_uint64 (value);
+      break;
+    case PROP_CLIPBOARD_SWAP_THRESHOLD:
+      core_config->clipboard_swap_threshold = g_value_get_uint64 (value);
+      break;
     case PROP_UNDO_PREVIEW_SIZE:
       core_config->undo_preview_size = g_value_get_enum (value);
       break;
@@ -1112,6 +1181,15 @@ gimp_core_config_set_property (GObject      *object,
       g_set_str (&core_config->plug_in_rc_path,
                  g_value_get_string (value));
       break;
+    case PROP_PLUG_IN_POOL_SIZE:
+      core_config->plug_in_pool_size = g_value_get_int (value);
+      break;
+    case PROP_PLUG_IN_POOL_IDLE_TIMEOUT:
+      core_config->plug_in_pool_idle_timeout = g_value_get_int (value);
+      break;
+    case PROP_PLUG_IN_POOL_MEMORY_LIMIT:
+      core_config->plug_in_pool_memory_limit = g_value_get_uint64 (value);
+      break;
     case PROP_LAYER_PREVIEWS:
       core_config->layer_previews = g_value_get_boolean (value);
       break;
@@ -1181,6 +1259,9 @@ gimp_core_config_set_property (GObject      *object,
       g_set_str (&core_config->import_raw_plug_in,
                  g_value_get_string (value));
       break;
+    case PROP_XCF_LAZY_LOAD:
+      core_config->xcf_lazy_load = g_value_get_boolean (value);
+      break;
     case PROP_EXPORT_FILE_TYPE:
       core_config->export_file_type = g_value_get_enum (value);
       break;
@@ -1389,12 +1470,30 @@ gimp_core_config_get_property (GObject    *object,
     case PROP_UNDO_SIZE:
       g_value_set_uint64 (value, core_config->undo_size);
       break;
+    case PROP_UNDO_SWAP_SIZE:
+      g_value_set_uint64 (value, core_config->undo_swap_size);
+      break;
+    case PROP_IMAGE_MEMORY_BUDGET:
+      g_value_set_uint64 (value, core_config->image_memory_budget);
+      break;
+    case PROP_CLIPBOARD_SWAP_THRESHOLD:
+      g_value_set_uint64 (value, core_config->clipboard_swap_threshold);
+      break;
     case PROP_UNDO_PREVIEW_SIZE:
       g_value_set_enum (value, core_config->undo_preview_size);
       break;
     case PROP_PLUGINRC_PATH:
       g_value_set_string (value, core_config->plug_in_rc_path);
       break;
+    case PROP_PLUG_IN_POOL_SIZE:
+      g_value_set_int (value, core_config->plug_in_pool_size);
+      break;
+    case PROP_PLUG_IN_POOL_IDLE_TIMEOUT:
+      g_value_set_int (value, core_config->plug_in_pool_idle_timeout);
+      break;
+    case PROP_PLUG_IN_POOL_MEMORY_LIMIT:
+      g_value_set_uint64 (value, core_config->plug_in_pool_memory_limit);
+      break;
     case PROP_LAYER_PREVIEWS:
       g_value_set_boolean (value, core_config->layer_previews);
       break;
@@ -1452,6 +1551,9 @@ gimp_core_config_get_property (GObject    *object,
     case PROP_IMPORT_RAW_PLUG_IN:
       g_value_set_string (value, core_config->import_raw_plug_in);
       break;
+    case PROP_XCF_LAZY_LOAD:
+      g_value_set_boolean (value, core_config->xcf_lazy_load);
+      break;
     case PROP_EXPORT_FILE_TYPE:
       g_value_set_enum (value, core_config->export_file_type);
       break;
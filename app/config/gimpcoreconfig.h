@@ -82,9 +82,15 @@ struct _GimpCoreConfig
   GimpGrid               *default_grid;
   gint                    levels_of_undo;
   guint64                 undo_size;
+  guint64                 undo_swap_size;
+  guint64                 image_memory_budget;
+  guint64                 clipboard_swap_threshold;
   GimpViewSize            undo_preview_size;
   gint                    filter_history_size;
   gchar                  *plug_in_rc_path;
+  gint                    plug_in_pool_size;
+  gint                    plug_in_pool_idle_timeout;
+  guint64                 plug_in_pool_memory_limit;
   gboolean                layer_previews;
   gboolean                group_layer_previews;
   GimpViewSize            layer_preview_size;
@@ -97,6 +103,7 @@ struct _GimpCoreConfig
   gboolean                import_promote_dither;
   gboolean                import_add_alpha;
   gchar                  *import_raw_plug_in;
+  gboolean                xcf_lazy_load;
   GimpExportFileType      export_file_type;
   gboolean                export_color_profile;
   gboolean                export_comment;
@@ -41,6 +41,7 @@
 #define DEFAULT_MONITOR_RESOLUTION   96.0
 #define DEFAULT_MARCHING_ANTS_SPEED  200
 #define DEFAULT_USE_EVENT_HISTORY    FALSE
+#define DEFAULT_STROKE_PREDICTION    FALSE
 
 enum
 {
@@ -76,6 +77,7 @@ enum
   PROP_SPACE_BAR_ACTION,
   PROP_ZOOM_QUALITY,
   PROP_USE_EVENT_HISTORY,
+  PROP_STROKE_PREDICTION,
 
   /* ignored, only for backward compatibility: */
   PROP_DEFAULT_SNAP_TO_GUIDES,
@@ -342,6 +344,13 @@ gimp_display_config_class_init (GimpDisplayConfigClass *klass)
                             DEFAULT_USE_EVENT_HISTORY,
                             GIMP_PARAM_STATIC_STRINGS);
 
+  GIMP_CONFIG_PROP_BOOLEAN (object_class, PROP_STROKE_PREDICTION,
+                            "stroke-prediction",
+                            "Stroke prediction",
+                            STROKE_PREDICTION_BLURB,
+                            DEFAULT_STROKE_PREDICTION,
+                            GIMP_PARAM_STATIC_STRINGS);
+
   /*  only for backward compatibility:  */
   GIMP_CONFIG_PROP_BOOLEAN (object_class, PROP_DEFAULT_SNAP_TO_GUIDES,
                             "default-snap-to-guides",
@@ -561,6 +570,9 @@ gimp_display_config_set_property (GObject      *object,
     case PROP_USE_EVENT_HISTORY:
       display_config->use_event_history = g_value_get_boolean (value);
       break;
+    case PROP_STROKE_PREDICTION:
+      display_config->stroke_prediction = g_value_get_boolean (value);
+      break;
 
     case PROP_DEFAULT_SNAP_TO_GUIDES:
     case PROP_DEFAULT_SNAP_TO_GRID:
@@ -681,6 +693,9 @@ gimp_display_config_get_property (GObject    *object,
     case PROP_USE_EVENT_HISTORY:
       g_value_set_boolean (value, display_config->use_event_history);
       break;
+    case PROP_STROKE_PREDICTION:
+      g_value_set_boolean (value, display_config->stroke_prediction);
+      break;
 
     case PROP_DEFAULT_SNAP_TO_GUIDES:
     case PROP_DEFAULT_SNAP_TO_GRID:
@@ -50,8 +50,12 @@ enum
   PROP_SWAP_PATH,
   PROP_SWAP_COMPRESSION,
   PROP_NUM_PROCESSORS,
+  PROP_THREAD_PLACEMENT,
   PROP_TILE_CACHE_SIZE,
   PROP_USE_OPENCL,
+  PROP_LAYER_STACK_CACHE,
+  PROP_HALF_FLOAT_PROJECTION,
+  PROP_PARALLEL_PROJECTION,
 
   /* ignored, only for backward compatibility: */
   PROP_STINGY_MEMORY_USE
@@ -130,6 +134,14 @@ gimp_gegl_config_class_init (GimpGeglConfigClass *klass)
                         1, max_n_threads, n_threads,
                         GIMP_PARAM_STATIC_STRINGS);
 
+  GIMP_CONFIG_PROP_ENUM (object_class, PROP_THREAD_PLACEMENT,
+                         "thread-placement",
+                         "Thread placement",
+                         THREAD_PLACEMENT_BLURB,
+                         GIMP_TYPE_THREAD_PLACEMENT,
+                         GIMP_THREAD_PLACEMENT_SYSTEM,
+                         GIMP_PARAM_STATIC_STRINGS);
+
   memory_size = gimp_get_physical_memory_size ();
 
   /* limit to the amount one process can handle */
@@ -156,6 +168,27 @@ gimp_gegl_config_class_init (GimpGeglConfigClass *klass)
                             FALSE,
                             GIMP_PARAM_STATIC_STRINGS);
 
+  GIMP_CONFIG_PROP_BOOLEAN (object_class, PROP_LAYER_STACK_CACHE,
+                            "layer-stack-cache",
+                            "Layer stack cache",
+                            LAYER_STACK_CACHE_BLURB,
+                            FALSE,
+                            GIMP_PARAM_STATIC_STRINGS);
+
+  GIMP_CONFIG_PROP_BOOLEAN (object_class, PROP_HALF_FLOAT_PROJECTION,
+                            "half-float-projection",
+                            "Half float projection",
+                            HALF_FLOAT_PROJECTION_BLURB,
+                            FALSE,
+                            GIMP_PARAM_STATIC_STRINGS);
+
+  GIMP_CONFIG_PROP_BOOLEAN (object_class, PROP_PARALLEL_PROJECTION,
+                            "parallel-projection",
+                            "Parallel projection",
+                            PARALLEL_PROJECTION_BLURB,
+                            FALSE,
+                            GIMP_PARAM_STATIC_STRINGS);
+
   /*  only for backward compatibility:  */
   GIMP_CONFIG_PROP_BOOLEAN (object_class, PROP_STINGY_MEMORY_USE,
                             "stingy-memory-use",
@@ -217,6 +250,10 @@ gimp_gegl_config_set_property (GObject      *object,
       gegl_config->num_processors = g_value_get_int (value);
       break;
 
+    case PROP_THREAD_PLACEMENT:
+      gegl_config->thread_placement = g_value_get_enum (value);
+      break;
+
     case PROP_TILE_CACHE_SIZE:
       gegl_config->tile_cache_size = g_value_get_uint64 (value);
       break;
@@ -225,6 +262,18 @@ gimp_gegl_config_set_property (GObject      *object,
       gegl_config->use_opencl = g_value_get_boolean (value);
       break;
 
+    case PROP_LAYER_STACK_CACHE:
+      gegl_config->layer_stack_cache = g_value_get_boolean (value);
+      break;
+
+    case PROP_HALF_FLOAT_PROJECTION:
+      gegl_config->half_float_projection = g_value_get_boolean (value);
+      break;
+
+    case PROP_PARALLEL_PROJECTION:
+      gegl_config->parallel_projection = g_value_get_boolean (value);
+      break;
+
     case PROP_STINGY_MEMORY_USE:
       /* ignored */
       break;
@@ -261,6 +310,10 @@ gimp_gegl_config_get_property (GObject    *object,
       g_value_set_int (value, gegl_config->num_processors);
       break;
 
+    case PROP_THREAD_PLACEMENT:
+      g_value_set_enum (value, gegl_config->thread_placement);
+      break;
+
     case PROP_TILE_CACHE_SIZE:
       g_value_set_uint64 (value, gegl_config->tile_cache_size);
       break;
@@ -269,6 +322,18 @@ gimp_gegl_config_get_property (GObject    *object,
       g_value_set_boolean (value, gegl_config->use_opencl);
       break;
 
+    case PROP_LAYER_STACK_CACHE:
+      g_value_set_boolean (value, gegl_config->layer_stack_cache);
+      break;
+
+    case PROP_HALF_FLOAT_PROJECTION:
+      g_value_set_boolean (value, gegl_config->half_float_projection);
+      break;
+
+    case PROP_PARALLEL_PROJECTION:
+      g_value_set_boolean (value, gegl_config->parallel_projection);
+      break;
+
     case PROP_STINGY_MEMORY_USE:
       /* ignored */
       break;
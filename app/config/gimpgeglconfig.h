@@ -32,14 +32,18 @@ typedef struct _GimpGeglConfigClass GimpGeglConfigClass;
 
 struct _GimpGeglConfig
 {
-  GObject   parent_instance;
-
-  gchar    *temp_path;
-  gchar    *swap_path;
-  gchar    *swap_compression;
-  gint      num_processors;
-  guint64   tile_cache_size;
-  gboolean  use_opencl;
+  GObject              parent_instance;
+
+  gchar               *temp_path;
+  gchar               *swap_path;
+  gchar               *swap_compression;
+  gint                 num_processors;
+  GimpThreadPlacement  thread_placement;
+  guint64              tile_cache_size;
+  gboolean             use_opencl;
+  gboolean             layer_stack_cache;
+  gboolean             half_float_projection;
+  gboolean             parallel_projection;
 };
 
 struct _GimpGeglConfigClass
@@ -190,6 +190,12 @@ _("When enabled, the selected auto expand layer settings will be used for all to
 #define FONT_PATH_BLURB \
 "Where to look for fonts in addition to the system-wide installed fonts."
 
+#define HALF_FLOAT_PROJECTION_BLURB \
+_("When enabled, the projection of images with floating point precision " \
+  "is kept at half float precision.  This halves the memory used by the " \
+  "projection, at the expense of precision when displaying the image and " \
+  "when sampling merged.  Layer data keeps the image's precision.")
+
 #define HELP_BROWSER_BLURB \
 _("Sets the browser used by the help system.")
 
@@ -227,6 +233,12 @@ _("Add an alpha channel to all layers of imported images.")
 #define IMPORT_RAW_PLUG_IN_BLURB \
 _("Which plug-in to use for importing raw digital camera files.")
 
+#define XCF_LAZY_LOAD_BLURB \
+_("When opening local XCF files, map the file into memory and only decode " \
+  "the pixel data of each tile when it is first accessed.  This makes " \
+  "opening large files faster, but the file must not be modified by other " \
+  "programs while the image is open.")
+
 #define EXPORT_FILE_TYPE_BLURB \
 _("Export file type used by default.")
 
@@ -355,6 +367,17 @@ _("Sets the size of the navigation preview available in the lower right " \
 #define NUM_PROCESSORS_BLURB \
 _("Sets how many threads GIMP should use for operations that support it.")
 
+#define THREAD_PLACEMENT_BLURB \
+_("Sets how GIMP's threads are placed on the processors.  When following " \
+  "the CPU topology, interactive work runs on the performance cores of " \
+  "the memory node GIMP was started on, and background work on the " \
+  "efficiency cores.")
+
+#define PARALLEL_PROJECTION_BLURB \
+_("When enabled, the image projection is rendered on a separate thread " \
+  "while GIMP waits for events, so that rendering large images doesn't " \
+  "hold back the user interface.")
+
 #define PALETTE_PATH_BLURB \
 "Sets the palette search path."
 
@@ -374,6 +397,19 @@ _("Sets how many threads GIMP should use for operations that support it.")
 #define PLUGINRC_PATH_BLURB \
 "Sets the pluginrc search path."
 
+#define PLUG_IN_POOL_SIZE_BLURB \
+"How many plug-in processes which declared themselves reusable to keep " \
+"running after they return, so that the next call into the same plug-in " \
+"doesn't have to start it again.  0 disables the pool."
+
+#define PLUG_IN_POOL_IDLE_TIMEOUT_BLURB \
+"How many seconds an idle plug-in process is kept in the plug-in pool " \
+"before it is asked to quit."
+
+#define PLUG_IN_POOL_MEMORY_LIMIT_BLURB \
+"Plug-in processes using more memory than this when they return are not " \
+"kept in the plug-in pool.  0 means no limit."
+
 #define LAYER_PREVIEWS_BLURB \
 _("Sets whether GIMP should create previews of layers and channels. " \
   "Previews in the layers and channels dialog are nice to have but they " \
@@ -387,6 +423,11 @@ _("Sets whether GIMP should create previews of layer groups. " \
 _("Sets the preview size used for layers and channel previews in newly " \
   "created dialogs.")
 
+#define LAYER_STACK_CACHE_BLURB \
+_("When enabled, GIMP keeps the composite of the layers below the layer " \
+  "being edited, so that only the layers above it have to be composited " \
+  "again.  This uses more memory.")
+
 #define QUICK_MASK_COLOR_BLURB \
 _("Sets the default quick mask color.")
 
@@ -783,6 +824,25 @@ _("Sets an upper limit to the memory that is used per image to keep " \
   "operations on the undo stack. Regardless of this setting, at least " \
   "as many undo-levels as configured can be undone.")
 
+#define UNDO_SWAP_SIZE_BLURB \
+_("Sets an upper limit to the disk space that is used per image to keep " \
+  "the pixels of the oldest operations on the undo stack, once the " \
+  "undo-size limit is reached, instead of discarding them. The pixels " \
+  "are kept in the swap folder.")
+
+#define IMAGE_MEMORY_BUDGET_BLURB \
+_("Sets an upper limit to the memory that is used per image, including " \
+  "its undo history and cached previews. Once the limit is reached, " \
+  "undo steps beyond the minimal undo levels are discarded, then " \
+  "previews are dropped, and then the pixels of the remaining undo " \
+  "steps are moved to the swap. The image itself is never touched. " \
+  "Zero means no limit.")
+
+#define CLIPBOARD_SWAP_THRESHOLD_BLURB \
+_("Copied pixels that take more memory than this are kept in a file in " \
+  "the swap folder, instead of in memory. Zero means copies are always " \
+  "kept in memory.")
+
 #define UNDO_PREVIEW_SIZE_BLURB \
 _("Sets the size of the previews in the Undo History.")
 
@@ -807,6 +867,12 @@ _("There's a tradeoff between speed and quality of the zoomed-out display.")
 "Bugs in event history buffer are frequent so in case of cursor " \
 "offset problems turning it off helps."
 
+#define STROKE_PREDICTION_BLURB \
+"When enabled, strokes of devices that report few events are filled in " \
+"up to the latest event right away, extrapolating the stroke's curve, " \
+"instead of holding the last event back.  This lowers the latency of " \
+"painting."
+
 #define SEARCH_SHOW_UNAVAILABLE_BLURB \
 _("When enabled, a search of actions will also return inactive actions.")
 
@@ -67,6 +67,13 @@ static void         gimp_rc_notify            (GimpRc       *rc,
                                                GParamSpec   *param,
                                                gpointer      data);
 
+static GFile      * gimp_rc_get_cache_file    (void);
+static gboolean     gimp_rc_restore_cache     (GimpRc       *rc);
+static void         gimp_rc_store_cache       (GimpRc       *rc);
+static void         gimp_rc_count_unknown     (const gchar  *key,
+                                               const gchar  *value,
+                                               gint         *n_unknown);
+
 
 G_DEFINE_TYPE_WITH_CODE (GimpRc, gimp_rc, GIMP_TYPE_PLUGIN_CONFIG,
                          G_IMPLEMENT_INTERFACE (GIMP_TYPE_CONFIG,
@@ -298,18 +305,27 @@ gimp_rc_new (GObject  *gimp,
                      "user-gimprc",   user_gimprc,
                      NULL);
 
-  gimp_rc_load_system (rc);
-  gimp_rc_load_user (rc);
+  if (! gimp_rc_restore_cache (rc))
+    {
+      gboolean success;
+
+      success = gimp_rc_load_system (rc);
+      success = gimp_rc_load_user (rc) && success;
+
+      if (success)
+        gimp_rc_store_cache (rc);
+    }
 
   return rc;
 }
 
-void
+gboolean
 gimp_rc_load_system (GimpRc *rc)
 {
-  GError *error = NULL;
+  GError   *error   = NULL;
+  gboolean  success = TRUE;
 
-  g_return_if_fail (GIMP_IS_RC (rc));
+  g_return_val_if_fail (GIMP_IS_RC (rc), FALSE);
 
   if (rc->verbose)
     g_print ("Parsing '%s'\n",
@@ -319,18 +335,25 @@ gimp_rc_load_system (GimpRc *rc)
                                       rc->system_gimprc, NULL, &error))
     {
       if (error->code != GIMP_CONFIG_ERROR_OPEN_ENOENT)
-        g_message ("%s", error->message);
+        {
+          g_message ("%s", error->message);
+
+          success = FALSE;
+        }
 
       g_clear_error (&error);
     }
+
+  return success;
 }
 
-void
+gboolean
 gimp_rc_load_user (GimpRc *rc)
 {
-  GError *error = NULL;
+  GError   *error   = NULL;
+  gboolean  success = TRUE;
 
-  g_return_if_fail (GIMP_IS_RC (rc));
+  g_return_val_if_fail (GIMP_IS_RC (rc), FALSE);
 
   if (rc->verbose)
     g_print ("Parsing '%s'\n",
@@ -344,10 +367,14 @@ gimp_rc_load_user (GimpRc *rc)
           g_message ("%s", error->message);
 
           gimp_config_file_backup_on_error (rc->user_gimprc, "gimprc", NULL);
+
+          success = FALSE;
         }
 
       g_clear_error (&error);
     }
+
+  return success;
 }
 
 void
@@ -591,3 +618,75 @@ gimp_rc_migrate (GimpRc *rc)
 
   g_free (pspecs);
 }
+
+
+/*  private functions  */
+
+static GFile *
+gimp_rc_get_cache_file (void)
+{
+  return g_file_new_build_filename (gimp_cache_directory (),
+                                    "gimprc.cache", NULL);
+}
+
+/*  parsing the gimprc files is a noticeable part of the startup time,
+ *  so the resulting properties are kept in a binary snapshot, which is
+ *  only used as long as neither file changed
+ */
+static gboolean
+gimp_rc_restore_cache (GimpRc *rc)
+{
+  GFile    *cache     = gimp_rc_get_cache_file ();
+  GFile    *sources[] = { rc->system_gimprc, rc->user_gimprc, NULL };
+  gboolean  success;
+
+  success = gimp_config_cache_restore (GIMP_CONFIG (rc), cache, sources, NULL);
+
+  if (success && rc->verbose)
+    g_print ("Restored gimprc from '%s'\n",
+             gimp_file_get_utf8_name (cache));
+
+  g_object_unref (cache);
+
+  return success;
+}
+
+static void
+gimp_rc_store_cache (GimpRc *rc)
+{
+  GFile  *cache;
+  GFile  *sources[] = { rc->system_gimprc, rc->user_gimprc, NULL };
+  gint    n_unknown = 0;
+  GError *error     = NULL;
+
+  /*  unknown tokens aren't properties, so they can't be restored from
+   *  the snapshot
+   */
+  gimp_rc_foreach_unknown_token (GIMP_CONFIG (rc),
+                                 (GimpConfigForeachFunc) gimp_rc_count_unknown,
+                                 &n_unknown);
+
+  if (n_unknown > 0)
+    return;
+
+  cache = gimp_rc_get_cache_file ();
+
+  if (! gimp_config_cache_store (GIMP_CONFIG (rc), cache, sources, &error))
+    {
+      if (rc->verbose)
+        g_print ("Could not write '%s': %s\n",
+                 gimp_file_get_utf8_name (cache), error->message);
+
+      g_clear_error (&error);
+    }
+
+  g_object_unref (cache);
+}
+
+static void
+gimp_rc_count_unknown (const gchar *key,
+                       const gchar *value,
+                       gint        *n_unknown)
+{
+  (*n_unknown)++;
+}
@@ -56,8 +56,8 @@ GimpRc  * gimp_rc_new               (GObject     *gimp,
                                      GFile       *user_gimprc,
                                      gboolean     verbose);
 
-void      gimp_rc_load_system       (GimpRc      *rc);
-void      gimp_rc_load_user         (GimpRc      *rc);
+gboolean  gimp_rc_load_system       (GimpRc      *rc);
+gboolean  gimp_rc_load_user         (GimpRc      *rc);
 
 void      gimp_rc_set_autosave      (GimpRc      *rc,
                                      gboolean     autosave);
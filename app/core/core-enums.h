@@ -688,6 +688,19 @@ typedef enum /*< pdb-skip >*/
   GIMP_SELECT_GLOB_PATTERN,  /*< desc="Selection by glob pattern search"       >*/
 } GimpSelectMethod;
 
+
+#define GIMP_TYPE_XCF_COMPRESSION (gimp_xcf_compression_get_type ())
+
+GType gimp_xcf_compression_get_type (void) G_GNUC_CONST;
+
+typedef enum  /*< pdb-skip >*/
+{
+  GIMP_XCF_COMPRESSION_RLE,   /*< desc="RLE"       >*/
+  GIMP_XCF_COMPRESSION_ZLIB,  /*< desc="zlib"      >*/
+  GIMP_XCF_COMPRESSION_ZSTD,  /*< desc="Zstandard" >*/
+  GIMP_XCF_COMPRESSION_LZ4    /*< desc="LZ4"       >*/
+} GimpXcfCompression;
+
 /*
  * non-registered enums; register them if needed
  */
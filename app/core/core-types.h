@@ -231,11 +231,13 @@ typedef struct _GimpWaitable                    GimpWaitable;    /* dummy typede
 
 /*  non-object types  */
 
+typedef struct _GimpArena                       GimpArena;
 typedef struct _GimpBacktrace                   GimpBacktrace;
 typedef struct _GimpBoundSeg                    GimpBoundSeg;
 typedef struct _GimpChunkIterator               GimpChunkIterator;
 typedef struct _GimpCoords                      GimpCoords;
 typedef struct _GimpGradientSegment             GimpGradientSegment;
+typedef struct _GimpHistogramCache              GimpHistogramCache;
 typedef struct _GimpPaletteEntry                GimpPaletteEntry;
 typedef struct _GimpScanConvert                 GimpScanConvert;
 typedef struct _GimpTempBuf                     GimpTempBuf;
@@ -17,11 +17,13 @@
 
 #include "config.h"
 
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gegl.h>
+#include <json-glib/json-glib.h>
 
 #include "libgimpbase/gimpbase.h"
 
@@ -29,24 +31,98 @@
 
 #include "gimp.h"
 #include "gimp-batch.h"
+#include "gimpcontainer.h"
+#include "gimpimage.h"
 #include "gimpparamspecs.h"
 
 #include "pdb/gimppdb.h"
 #include "pdb/gimpprocedure.h"
 
+#include "plug-in/gimpplugin.h"
 #include "plug-in/gimppluginmanager.h"
+#include "plug-in/gimppluginmanager-call.h"
 #include "plug-in/gimppluginprocedure.h"
 
 #include "gimp-intl.h"
 
 
-static void  gimp_batch_exit_after_callback (Gimp          *gimp) G_GNUC_NORETURN;
+/*  how often the memory used by the images of batch jobs is checked  */
+#define MEMORY_CHECK_INTERVAL 500 /* milliseconds */
 
-static gint  gimp_batch_run_cmd             (Gimp          *gimp,
-                                             const gchar   *proc_name,
-                                             GimpProcedure *procedure,
-                                             GimpRunMode    run_mode,
-                                             const gchar   *cmd);
+
+typedef struct
+{
+  gint                 line;
+  JsonNode            *id;
+  gchar               *command;
+  GimpPlugInProcedure *procedure;
+  guint64              memory_limit;
+
+  GimpPlugIn          *plug_in;
+  GList               *images;
+  gboolean             over_limit;
+} BatchJob;
+
+typedef struct
+{
+  Gimp                *gimp;
+  BatchJob            *jobs;
+  gint                 n_jobs;
+  gint                *indices;
+  guint                check_id;
+  gint                 retval;
+} BatchQueue;
+
+
+static const gchar    * gimp_batch_find_interpreter     (Gimp                *gimp,
+                                                         const gchar         *batch_interpreter,
+                                                         gint                *retval);
+
+static void             gimp_batch_exit_after_callback  (Gimp                *gimp) G_GNUC_NORETURN;
+
+static GimpValueArray * gimp_batch_get_arguments        (GimpProcedure       *procedure,
+                                                         GimpRunMode          run_mode,
+                                                         const gchar         *cmd);
+static gint             gimp_batch_get_exit_status      (GimpPDBStatusType    status);
+static gint             gimp_batch_run_cmd              (Gimp                *gimp,
+                                                         const gchar         *proc_name,
+                                                         GimpProcedure       *procedure,
+                                                         GimpRunMode          run_mode,
+                                                         const gchar         *cmd);
+
+static gchar          * gimp_batch_read_queue           (const gchar         *batch_queue,
+                                                         GError             **error);
+static gboolean         gimp_batch_parse_job            (Gimp                *gimp,
+                                                         BatchJob            *job,
+                                                         const gchar         *line,
+                                                         const gchar         *batch_interpreter,
+                                                         GError             **error);
+static GimpPlugInProcedure *
+                        gimp_batch_get_procedure        (Gimp                *gimp,
+                                                         const gchar         *batch_interpreter);
+static void             gimp_batch_job_report           (BatchQueue          *queue,
+                                                         BatchJob            *job,
+                                                         gint                 exit_status,
+                                                         const gchar         *status,
+                                                         const gchar         *message);
+
+static BatchJob       * gimp_batch_queue_find_job       (BatchQueue          *queue);
+static void             gimp_batch_queue_image_add      (GimpContainer       *images,
+                                                         GimpImage           *image,
+                                                         BatchQueue          *queue);
+static void             gimp_batch_queue_image_remove   (GimpContainer       *images,
+                                                         GimpImage           *image,
+                                                         BatchQueue          *queue);
+static gboolean         gimp_batch_queue_check_memory   (BatchQueue          *queue);
+static void             gimp_batch_queue_job_start      (gint                 index,
+                                                         GimpPlugIn          *plug_in,
+                                                         BatchQueue          *queue);
+static void             gimp_batch_queue_job_done       (gint                 index,
+                                                         GimpValueArray      *return_vals,
+                                                         BatchQueue          *queue);
+
+
+/*  public functions  */
 
 
 gint
@@ -55,21 +131,218 @@ gimp_batch_run (Gimp         *gimp,
                 const gchar **batch_commands)
 {
   GimpProcedure *eval_proc;
-  GSList        *batch_procedures;
-  GSList        *iter;
   gulong         exit_id;
   gint           retval = EXIT_SUCCESS;
 
   if (! batch_commands || ! batch_commands[0])
     return retval;
 
+  batch_interpreter = gimp_batch_find_interpreter (gimp, batch_interpreter,
+                                                   &retval);
+  if (! batch_interpreter)
+    return retval;
+
+  exit_id = g_signal_connect_after (gimp, "exit",
+                                    G_CALLBACK (gimp_batch_exit_after_callback),
+                                    NULL);
+
+  eval_proc = gimp_pdb_lookup_procedure (gimp->pdb, batch_interpreter);
+  if (eval_proc)
+    {
+      gint i;
+
+      retval = EXIT_SUCCESS;
+      for (i = 0; batch_commands[i]; i++)
+        {
+          retval = gimp_batch_run_cmd (gimp, batch_interpreter, eval_proc,
+                                       GIMP_RUN_NONINTERACTIVE, batch_commands[i]);
+
+          /* In case of several commands, stop and return last
+           * failed command.
+           */
+          if (retval != EXIT_SUCCESS)
+            {
+              g_printerr ("Stopping at failing batch command [%d]: %s\n",
+                          i, batch_commands[i]);
+              break;
+            }
+        }
+    }
+  else
+    {
+      retval = 69; /* EX_UNAVAILABLE - service unavailable (sysexits.h) */
+      g_message (_("The batch interpreter '%s' is not available. "
+                   "Batch mode disabled."), batch_interpreter);
+    }
+
+  g_signal_handler_disconnect (gimp, exit_id);
+
+  return retval;
+}
+
+/* Runs the jobs listed in 'batch_queue', or read from the standard
+ * input if it is "-", up to 'batch_jobs' of them at the same time.
+ * Each line is a job, either a JSON string, the batch command, or a
+ * JSON object with the members "command", and optionally "interpreter",
+ * "memory-limit" and "id".
+ *
+ * When a job's images use more than its memory limit, or
+ * 'batch_memory_limit' if it has none, the job is stopped.  Images a
+ * job leaves open are closed when it ends, and a JSON object reporting
+ * how the job went is printed for each of them, in the order they end.
+ * Returns the exit status of the last job which failed, if any.
+ */
+gint
+gimp_batch_run_queue (Gimp        *gimp,
+                      const gchar *batch_interpreter,
+                      const gchar *batch_queue,
+                      gint         batch_jobs,
+                      guint64      batch_memory_limit)
+{
+  BatchQueue             queue = { 0, };
+  GimpPlugInProcedure  **procedures;
+  GimpValueArray       **args;
+  gchar                 *contents;
+  gchar                **lines;
+  GError                *error = NULL;
+  gulong                 exit_id;
+  gint                   n_runs = 0;
+  gint                   i;
+
+  g_return_val_if_fail (GIMP_IS_GIMP (gimp), EXIT_FAILURE);
+  g_return_val_if_fail (batch_queue != NULL, EXIT_FAILURE);
+
+  queue.gimp   = gimp;
+  queue.retval = EXIT_SUCCESS;
+
+  batch_interpreter = gimp_batch_find_interpreter (gimp, batch_interpreter,
+                                                   &queue.retval);
+  if (! batch_interpreter)
+    return queue.retval;
+
+  /*  read the whole queue first, the plug-ins share our standard input  */
+  contents = gimp_batch_read_queue (batch_queue, &error);
+
+  if (! contents)
+    {
+      g_printerr ("%s\n", error->message);
+      g_clear_error (&error);
+
+      return 66; /* EX_NOINPUT - cannot open input (sysexits.h) */
+    }
+
+  if (batch_jobs < 1)
+    batch_jobs = MAX (g_get_num_processors (), 1);
+
+  lines = g_strsplit (contents, "\n", -1);
+  g_free (contents);
+
+  queue.jobs = g_new0 (BatchJob, g_strv_length (lines));
+
+  for (i = 0; lines[i]; i++)
+    {
+      const gchar *line = g_strstrip (lines[i]);
+      BatchJob    *job;
+
+      if (! *line || *line == '#')
+        continue;
+
+      job = &queue.jobs[queue.n_jobs++];
+
+      job->line         = i + 1;
+      job->memory_limit = batch_memory_limit;
+
+      if (! gimp_batch_parse_job (gimp, job, line, batch_interpreter, &error))
+        {
+          gimp_batch_job_report (&queue, job, 64, /* EX_USAGE */
+                                 "calling-error", error->message);
+          g_clear_error (&error);
+        }
+    }
+
+  g_strfreev (lines);
+
+  procedures    = g_new (GimpPlugInProcedure *, queue.n_jobs);
+  args          = g_new (GimpValueArray *, queue.n_jobs);
+  queue.indices = g_new (gint, queue.n_jobs);
+
+  for (i = 0; i < queue.n_jobs; i++)
+    {
+      BatchJob *job = &queue.jobs[i];
+
+      if (! job->procedure)
+        continue;
+
+      procedures[n_runs]    = job->procedure;
+      args[n_runs]          = gimp_batch_get_arguments (GIMP_PROCEDURE (job->procedure),
+                                                        GIMP_RUN_NONINTERACTIVE,
+                                                        job->command);
+      queue.indices[n_runs] = i;
+      n_runs++;
+    }
+
+  exit_id = g_signal_connect_after (gimp, "exit",
+                                    G_CALLBACK (gimp_batch_exit_after_callback),
+                                    NULL);
+
+  g_signal_connect (gimp->images, "add",
+                    G_CALLBACK (gimp_batch_queue_image_add),
+                    &queue);
+  g_signal_connect (gimp->images, "remove",
+                    G_CALLBACK (gimp_batch_queue_image_remove),
+                    &queue);
+
+  queue.check_id = g_timeout_add (MEMORY_CHECK_INTERVAL,
+                                  (GSourceFunc) gimp_batch_queue_check_memory,
+                                  &queue);
+
+  gimp_plug_in_manager_call_run_list (gimp->plug_in_manager,
+                                      gimp_get_user_context (gimp),
+                                      procedures, args, n_runs, batch_jobs,
+                                      (GimpPlugInCallStartFunc) gimp_batch_queue_job_start,
+                                      (GimpPlugInCallRunFunc) gimp_batch_queue_job_done,
+                                      &queue);
+
+  g_source_remove (queue.check_id);
+
+  g_signal_handlers_disconnect_by_data (gimp->images, &queue);
+  g_signal_handler_disconnect (gimp, exit_id);
+
+  for (i = 0; i < n_runs; i++)
+    gimp_value_array_unref (args[i]);
+
+  for (i = 0; i < queue.n_jobs; i++)
+    {
+      g_free (queue.jobs[i].command);
+      g_clear_pointer (&queue.jobs[i].id, json_node_unref);
+    }
+
+  g_free (queue.indices);
+  g_free (queue.jobs);
+  g_free (args);
+  g_free (procedures);
+
+  return queue.retval;
+}
+
+
+/*  private functions  */
+
+static const gchar *
+gimp_batch_find_interpreter (Gimp        *gimp,
+                             const gchar *batch_interpreter,
+                             gint        *retval)
+{
+  GSList *batch_procedures;
+  GSList *iter;
+
   batch_procedures = gimp_plug_in_manager_get_batch_procedures (gimp->plug_in_manager);
   if (g_slist_length (batch_procedures) == 0)
     {
       g_message (_("No batch interpreters are available. "
                    "Batch mode disabled."));
-      retval = 69; /* EX_UNAVAILABLE - service unavailable (sysexits.h) */
-      return retval;
+      *retval = 69; /* EX_UNAVAILABLE - service unavailable (sysexits.h) */
+      return NULL;
     }
 
   if (! batch_interpreter)
@@ -88,7 +361,7 @@ gimp_batch_run (Gimp         *gimp,
             }
           else
             {
-              retval = 64; /* EX_USAGE - command line usage error */
+              *retval = 64; /* EX_USAGE - command line usage error */
               g_print ("%s\n\n%s\n",
                        _("No batch interpreter specified."),
                        _("Available interpreters are:"));
@@ -111,7 +384,7 @@ gimp_batch_run (Gimp         *gimp,
               g_print ("\n%s\n",
                        _("Specify one of these interpreters as --batch-interpreter option."));
 
-              return retval;
+              return NULL;
             }
         }
     }
@@ -124,7 +397,7 @@ gimp_batch_run (Gimp         *gimp,
 
   if (iter == NULL)
     {
-      retval = 69; /* EX_UNAVAILABLE - service unavailable (sysexits.h) */
+      *retval = 69; /* EX_UNAVAILABLE - service unavailable (sysexits.h) */
       g_print (_("The procedure '%s' is not a valid batch interpreter."),
                  batch_interpreter);
       g_print ("\n%s\n\n%s\n",
@@ -149,48 +422,12 @@ gimp_batch_run (Gimp         *gimp,
       g_print ("\n%s\n",
                _("Specify one of these interpreters as --batch-interpreter option."));
 
-      return retval;
-    }
-
-  exit_id = g_signal_connect_after (gimp, "exit",
-                                    G_CALLBACK (gimp_batch_exit_after_callback),
-                                    NULL);
-
-  eval_proc = gimp_pdb_lookup_procedure (gimp->pdb, batch_interpreter);
-  if (eval_proc)
-    {
-      gint i;
-
-      retval = EXIT_SUCCESS;
-      for (i = 0; batch_commands[i]; i++)
-        {
-          retval = gimp_batch_run_cmd (gimp, batch_interpreter, eval_proc,
-                                       GIMP_RUN_NONINTERACTIVE, batch_commands[i]);
-
-          /* In case of several commands, stop and return last
-           * failed command.
-           */
-          if (retval != EXIT_SUCCESS)
-            {
-              g_printerr ("Stopping at failing batch command [%d]: %s\n",
-                          i, batch_commands[i]);
-              break;
-            }
-        }
+      return NULL;
     }
-  else
-    {
-      retval = 69; /* EX_UNAVAILABLE - service unavailable (sysexits.h) */
-      g_message (_("The batch interpreter '%s' is not available. "
-                   "Batch mode disabled."), batch_interpreter);
-    }
-
-  g_signal_handler_disconnect (gimp, exit_id);
 
-  return retval;
+  return batch_interpreter;
 }
 
-
 /*
  * The purpose of this handler is to exit GIMP cleanly when the batch
  * procedure calls the gimp-exit procedure. Without this callback, the
@@ -215,18 +452,13 @@ GIMP_IS_PARAM_SPEC_RUN_MODE (GParamSpec *pspec)
           pspec->value_type == GIMP_TYPE_RUN_MODE);
 }
 
-static gint
-gimp_batch_run_cmd (Gimp          *gimp,
-                    const gchar   *proc_name,
-                    GimpProcedure *procedure,
-                    GimpRunMode    run_mode,
-                    const gchar   *cmd)
+static GimpValueArray *
+gimp_batch_get_arguments (GimpProcedure *procedure,
+                          GimpRunMode    run_mode,
+                          const gchar   *cmd)
 {
   GimpValueArray *args;
-  GimpValueArray *return_vals;
-  GError         *error  = NULL;
-  gint            i      = 0;
-  gint            retval = EXIT_SUCCESS;
+  gint            i = 0;
 
   args = gimp_procedure_get_arguments (procedure);
 
@@ -242,20 +474,67 @@ gimp_batch_run_cmd (Gimp          *gimp,
       g_value_set_static_string (gimp_value_array_index (args, i++), cmd);
     }
 
+  return args;
+}
+
+static gint
+gimp_batch_get_exit_status (GimpPDBStatusType status)
+{
+  switch (status)
+    {
+    case GIMP_PDB_EXECUTION_ERROR:
+      /* Using Linux's standard exit code as found in /usr/include/sysexits.h
+       * Since other platforms may not have the header, I simply
+       * hardcode the few cases.
+       */
+      return 70; /* EX_SOFTWARE - internal software error */
+
+    case GIMP_PDB_CALLING_ERROR:
+      return 64; /* EX_USAGE - command line usage error */
+
+    case GIMP_PDB_SUCCESS:
+      return EXIT_SUCCESS;
+
+    case GIMP_PDB_CANCEL:
+      /* Not in sysexits.h, but usually used for 'Script terminated by
+       * Control-C'. See: https://tldp.org/LDP/abs/html/exitcodes.html
+       */
+      return 130;
+
+    case GIMP_PDB_PASS_THROUGH:
+      break;
+    }
+
+  return EXIT_FAILURE; /* Catchall. */
+}
+
+static gint
+gimp_batch_run_cmd (Gimp          *gimp,
+                    const gchar   *proc_name,
+                    GimpProcedure *procedure,
+                    GimpRunMode    run_mode,
+                    const gchar   *cmd)
+{
+  GimpValueArray    *args;
+  GimpValueArray    *return_vals;
+  GimpPDBStatusType  status;
+  GError            *error  = NULL;
+  gint               retval = EXIT_SUCCESS;
+
+  args = gimp_batch_get_arguments (procedure, run_mode, cmd);
+
   return_vals =
     gimp_pdb_execute_procedure_by_name_args (gimp->pdb,
                                              gimp_get_user_context (gimp),
                                              NULL, &error,
                                              proc_name, args);
 
-  switch (g_value_get_enum (gimp_value_array_index (return_vals, 0)))
+  status = g_value_get_enum (gimp_value_array_index (return_vals, 0));
+  retval = gimp_batch_get_exit_status (status);
+
+  switch (status)
     {
     case GIMP_PDB_EXECUTION_ERROR:
-      /* Using Linux's standard exit code as found in /usr/include/sysexits.h
-       * Since other platforms may not have the header, I simply
-       * hardcode the few cases.
-       */
-      retval = 70; /* EX_SOFTWARE - internal software error */
       if (error)
         {
           g_printerr ("batch command experienced an execution error:\n"
@@ -268,7 +547,6 @@ gimp_batch_run_cmd (Gimp          *gimp,
       break;
 
     case GIMP_PDB_CALLING_ERROR:
-      retval = 64; /* EX_USAGE - command line usage error */
       if (error)
         {
           g_printerr ("batch command experienced a calling error:\n"
@@ -281,19 +559,11 @@ gimp_batch_run_cmd (Gimp          *gimp,
       break;
 
     case GIMP_PDB_SUCCESS:
-      retval = EXIT_SUCCESS;
       g_printerr ("batch command executed successfully\n");
       break;
 
     case GIMP_PDB_CANCEL:
-      /* Not in sysexits.h, but usually used for 'Script terminated by
-       * Control-C'. See: https://tldp.org/LDP/abs/html/exitcodes.html
-       */
-      retval = 130;
-      break;
-
     case GIMP_PDB_PASS_THROUGH:
-      retval = EXIT_FAILURE; /* Catchall. */
       break;
     }
 
@@ -305,3 +575,362 @@ gimp_batch_run_cmd (Gimp          *gimp,
 
   return retval;
 }
+
+static gchar *
+gimp_batch_read_queue (const gchar  *batch_queue,
+                       GError      **error)
+{
+  gchar *contents;
+
+  if (strcmp (batch_queue, "-") == 0)
+    {
+      GString *string = g_string_new (NULL);
+      gchar    buffer[4096];
+      gsize    size;
+
+      while ((size = fread (buffer, 1, sizeof (buffer), stdin)) > 0)
+        g_string_append_len (string, buffer, size);
+
+      if (ferror (stdin))
+        {
+          g_set_error_literal (error, G_FILE_ERROR, G_FILE_ERROR_IO,
+                               _("Could not read batch jobs from the "
+                                 "standard input"));
+          g_string_free (string, TRUE);
+
+          return NULL;
+        }
+
+      return g_string_free (string, FALSE);
+    }
+
+  if (! g_file_get_contents (batch_queue, &contents, NULL, error))
+    return NULL;
+
+  return contents;
+}
+
+static gboolean
+gimp_batch_parse_job (Gimp         *gimp,
+                      BatchJob     *job,
+                      const gchar  *line,
+                      const gchar  *batch_interpreter,
+                      GError      **error)
+{
+  JsonParser  *parser;
+  JsonNode    *root;
+  const gchar *interpreter = batch_interpreter;
+  const gchar *command     = NULL;
+
+  parser = json_parser_new ();
+
+  if (! json_parser_load_from_data (parser, line, -1, error))
+    {
+      g_object_unref (parser);
+      return FALSE;
+    }
+
+  root = json_parser_get_root (parser);
+
+  if (JSON_NODE_HOLDS_VALUE (root) &&
+      json_node_get_value_type (root) == G_TYPE_STRING)
+    {
+      command = json_node_get_string (root);
+    }
+  else if (JSON_NODE_HOLDS_OBJECT (root))
+    {
+      JsonObject *object = json_node_get_object (root);
+      JsonNode   *member;
+
+      member = json_object_get_member (object, "id");
+
+      if (member)
+        job->id = json_node_copy (member);
+
+      member = json_object_get_member (object, "command");
+
+      if (member && JSON_NODE_HOLDS_VALUE (member) &&
+          json_node_get_value_type (member) == G_TYPE_STRING)
+        command = json_node_get_string (member);
+
+      member = json_object_get_member (object, "interpreter");
+
+      if (member && JSON_NODE_HOLDS_VALUE (member) &&
+          json_node_get_value_type (member) == G_TYPE_STRING)
+        interpreter = json_node_get_string (member);
+
+      member = json_object_get_member (object, "memory-limit");
+
+      if (member && JSON_NODE_HOLDS_VALUE (member))
+        {
+          if (json_node_get_value_type (member) == G_TYPE_INT64 &&
+              json_node_get_int (member) >= 0)
+            {
+              job->memory_limit = json_node_get_int (member);
+            }
+          else if (json_node_get_value_type (member) != G_TYPE_STRING ||
+                   ! gimp_memsize_deserialize (json_node_get_string (member),
+                                               &job->memory_limit))
+            {
+              g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                           _("Invalid memory limit in batch job on line %d"),
+                           job->line);
+              g_object_unref (parser);
+
+              return FALSE;
+            }
+        }
+    }
+
+  if (! command)
+    {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                   _("No batch command in batch job on line %d"),
+                   job->line);
+      g_object_unref (parser);
+
+      return FALSE;
+    }
+
+  job->command   = g_strdup (command);
+  job->procedure = gimp_batch_get_procedure (gimp, interpreter);
+
+  g_object_unref (parser);
+
+  if (! job->procedure)
+    {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                   _("The procedure '%s' is not a valid batch interpreter."),
+                   interpreter);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static GimpPlugInProcedure *
+gimp_batch_get_procedure (Gimp        *gimp,
+                          const gchar *batch_interpreter)
+{
+  GSList *iter;
+
+  for (iter = gimp_plug_in_manager_get_batch_procedures (gimp->plug_in_manager);
+       iter;
+       iter = iter->next)
+    {
+      if (g_strcmp0 (gimp_object_get_name (iter->data),
+                     batch_interpreter) == 0)
+        return iter->data;
+    }
+
+  return NULL;
+}
+
+static void
+gimp_batch_job_report (BatchQueue  *queue,
+                       BatchJob    *job,
+                       gint         exit_status,
+                       const gchar *status,
+                       const gchar *message)
+{
+  JsonBuilder   *builder;
+  JsonGenerator *generator;
+  JsonNode      *root;
+  gchar         *data;
+
+  builder = json_builder_new ();
+
+  json_builder_begin_object (builder);
+
+  json_builder_set_member_name (builder, "line");
+  json_builder_add_int_value (builder, job->line);
+
+  if (job->id)
+    {
+      json_builder_set_member_name (builder, "id");
+      json_builder_add_value (builder, json_node_copy (job->id));
+    }
+
+  json_builder_set_member_name (builder, "status");
+  json_builder_add_string_value (builder, status);
+
+  json_builder_set_member_name (builder, "exit-status");
+  json_builder_add_int_value (builder, exit_status);
+
+  if (message)
+    {
+      json_builder_set_member_name (builder, "message");
+      json_builder_add_string_value (builder, message);
+    }
+
+  json_builder_end_object (builder);
+
+  root      = json_builder_get_root (builder);
+  generator = json_generator_new ();
+
+  json_generator_set_root (generator, root);
+  data = json_generator_to_data (generator, NULL);
+
+  g_print ("%s\n", data);
+
+  g_free (data);
+  g_object_unref (generator);
+  json_node_unref (root);
+  g_object_unref (builder);
+
+  if (exit_status != EXIT_SUCCESS)
+    queue->retval = exit_status;
+}
+
+static BatchJob *
+gimp_batch_queue_find_job (BatchQueue *queue)
+{
+  GSList *list;
+
+  /*  the job is the one whose interpreter is, directly or through the
+   *  plug-ins it called, running the current procedure
+   */
+  for (list = queue->gimp->plug_in_manager->plug_in_stack;
+       list;
+       list = g_slist_next (list))
+    {
+      gint i;
+
+      for (i = 0; i < queue->n_jobs; i++)
+        {
+          if (queue->jobs[i].plug_in == list->data)
+            return &queue->jobs[i];
+        }
+    }
+
+  return NULL;
+}
+
+static void
+gimp_batch_queue_image_add (GimpContainer *images,
+                            GimpImage     *image,
+                            BatchQueue    *queue)
+{
+  BatchJob *job = gimp_batch_queue_find_job (queue);
+
+  if (job)
+    job->images = g_list_prepend (job->images, image);
+}
+
+static void
+gimp_batch_queue_image_remove (GimpContainer *images,
+                               GimpImage     *image,
+                               BatchQueue    *queue)
+{
+  gint i;
+
+  for (i = 0; i < queue->n_jobs; i++)
+    queue->jobs[i].images = g_list_remove (queue->jobs[i].images, image);
+}
+
+static gboolean
+gimp_batch_queue_check_memory (BatchQueue *queue)
+{
+  GSList *stack = queue->gimp->plug_in_manager->plug_in_stack;
+  gint    i;
+
+  for (i = 0; i < queue->n_jobs; i++)
+    {
+      BatchJob *job     = &queue->jobs[i];
+      gint64    memsize = 0;
+      GList    *list;
+
+      if (! job->plug_in || ! job->memory_limit || job->over_limit)
+        continue;
+
+      /*  don't pull the interpreter from under a procedure it called,
+       *  it is stopped on the next check once the procedure returns
+       */
+      if (g_slist_find (stack, job->plug_in))
+        continue;
+
+      for (list = job->images; list; list = g_list_next (list))
+        memsize += gimp_object_get_memsize (list->data, NULL);
+
+      if ((guint64) memsize > job->memory_limit)
+        {
+          job->over_limit = TRUE;
+
+          gimp_plug_in_close (job->plug_in, TRUE);
+        }
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+gimp_batch_queue_job_start (gint        index,
+                            GimpPlugIn *plug_in,
+                            BatchQueue *queue)
+{
+  BatchJob *job = &queue->jobs[queue->indices[index]];
+
+  job->plug_in = plug_in;
+}
+
+static void
+gimp_batch_queue_job_done (gint            index,
+                           GimpValueArray *return_vals,
+                           BatchQueue     *queue)
+{
+  BatchJob          *job     = &queue->jobs[queue->indices[index]];
+  GimpPDBStatusType  status;
+  const gchar       *nick    = NULL;
+  const gchar       *message = NULL;
+  GList             *images;
+  GList             *list;
+
+  job->plug_in = NULL;
+
+  /*  close whatever the job left open, taking the images off its list
+   *  first, since closing them removes them from it
+   */
+  images      = job->images;
+  job->images = NULL;
+
+  for (list = images; list; list = g_list_next (list))
+    {
+      if (gimp_image_get_display_count (list->data) == 0)
+        g_object_unref (list->data);
+    }
+
+  g_list_free (images);
+
+  if (job->over_limit)
+    {
+      gchar *limit = g_format_size (job->memory_limit);
+      gchar *text  = g_strdup_printf (_("The batch job's images use more "
+                                        "than its memory limit of %s"),
+                                      limit);
+
+      gimp_batch_job_report (queue, job,
+                             70, /* EX_SOFTWARE */
+                             "memory-limit", text);
+
+      g_free (text);
+      g_free (limit);
+
+      return;
+    }
+
+  status = g_value_get_enum (gimp_value_array_index (return_vals, 0));
+
+  if (status != GIMP_PDB_SUCCESS                  &&
+      gimp_value_array_length (return_vals) > 1   &&
+      G_VALUE_HOLDS_STRING (gimp_value_array_index (return_vals, 1)))
+    {
+      message = g_value_get_string (gimp_value_array_index (return_vals, 1));
+    }
+
+  gimp_enum_get_value (GIMP_TYPE_PDB_STATUS_TYPE, status,
+                       NULL, &nick, NULL, NULL);
+
+  gimp_batch_job_report (queue, job,
+                         gimp_batch_get_exit_status (status), nick,
+                         message);
+}
@@ -18,6 +18,11 @@
 #pragma once
 
 
-gint   gimp_batch_run (Gimp         *gimp,
-                       const gchar  *batch_interpreter,
-                       const gchar **batch_commands);
+gint   gimp_batch_run       (Gimp         *gimp,
+                             const gchar  *batch_interpreter,
+                             const gchar **batch_commands);
+gint   gimp_batch_run_queue (Gimp         *gimp,
+                             const gchar  *batch_interpreter,
+                             const gchar  *batch_queue,
+                             gint          batch_jobs,
+                             guint64       batch_memory_limit);
@@ -0,0 +1,74 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-cpu-dispatch.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Runtime selection between variants of a function compiled for
+ * different instruction sets.  Kernels list their variants from the
+ * generic one to the most specialized one, each with the CPU features
+ * it needs, and pick one once, usually from class_init() or on first
+ * use:
+ *
+ *   static const GimpCpuDispatchVariant variants[] =
+ *   {
+ *     { GIMP_CPU_ACCEL_NONE,     foo_generic },
+ *   #if COMPILE_SSE2_INTRINISICS
+ *     { GIMP_CPU_ACCEL_X86_SSE2, foo_sse2    },
+ *   #endif
+ *   };
+ *
+ *   foo = GIMP_CPU_DISPATCH_SELECT (variants);
+ *
+ * Selection goes through gimp_cpu_accel_get_support(), so it follows
+ * --no-cpu-accel, and the GIMP_CPU_ACCEL environment variable, which
+ * restricts the features used to the listed ones, e.g.
+ * GIMP_CPU_ACCEL=sse2 to benchmark the SSE2 variants on an AVX2
+ * machine.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include "libgimpbase/gimpbase.h"
+
+#include "gimp-cpu-dispatch.h"
+
+
+/*  public functions  */
+
+gpointer
+gimp_cpu_dispatch_select (const GimpCpuDispatchVariant *variants,
+                          gint                          n_variants)
+{
+  GimpCpuAccelFlags support = gimp_cpu_accel_get_support ();
+  gpointer          func    = NULL;
+  gint              i;
+
+  g_return_val_if_fail (variants != NULL, NULL);
+
+  /*  the last variant the CPU can run is the most specialized one  */
+  for (i = 0; i < n_variants; i++)
+    {
+      if ((variants[i].accel & support) == variants[i].accel)
+        func = variants[i].func;
+    }
+
+  g_warn_if_fail (func != NULL);
+
+  return func;
+}
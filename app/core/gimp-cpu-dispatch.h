@@ -0,0 +1,39 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-cpu-dispatch.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+/*  a variant of a function, which may only be used if the CPU supports
+ *  all of 'accel'.  the generic variant, with 'accel' set to
+ *  GIMP_CPU_ACCEL_NONE, should always be present.
+ */
+typedef struct
+{
+  GimpCpuAccelFlags  accel;
+  gpointer           func;
+} GimpCpuDispatchVariant;
+
+
+gpointer   gimp_cpu_dispatch_select (const GimpCpuDispatchVariant *variants,
+                                     gint                          n_variants);
+
+
+#define GIMP_CPU_DISPATCH_SELECT(variants) \
+  gimp_cpu_dispatch_select ((variants), G_N_ELEMENTS (variants))
@@ -77,12 +77,12 @@ gimp_data_factories_init (Gimp *gimp)
                                "brush factory");
   gimp_data_loader_factory_add_loader (gimp->brush_factory,
                                        "GIMP Brush",
-                                       gimp_brush_load,
+                                       gimp_brush_load_lazy,
                                        GIMP_BRUSH_FILE_EXTENSION,
                                        TRUE);
   gimp_data_loader_factory_add_loader (gimp->brush_factory,
                                        "GIMP Brush Pixmap",
-                                       gimp_brush_load,
+                                       gimp_brush_load_lazy,
                                        GIMP_BRUSH_PIXMAP_FILE_EXTENSION,
                                        FALSE);
   gimp_data_loader_factory_add_loader (gimp->brush_factory,
@@ -105,6 +105,15 @@ gimp_data_factories_init (Gimp *gimp)
                                        gimp_brush_pipe_load,
                                        GIMP_BRUSH_PIPE_FILE_EXTENSION,
                                        TRUE);
+  gimp_data_loader_factory_set_index_funcs (gimp->brush_factory,
+                                            GIMP_BRUSH_FILE_EXTENSION,
+                                            gimp_brush_load_index,
+                                            gimp_brush_save_index);
+  gimp_data_loader_factory_set_index_funcs (gimp->brush_factory,
+                                            GIMP_BRUSH_PIXMAP_FILE_EXTENSION,
+                                            gimp_brush_load_index,
+                                            gimp_brush_save_index);
+  gimp_data_loader_factory_set_parallel (gimp->brush_factory, TRUE);
 
   gimp->dynamics_factory =
     gimp_data_loader_factory_new (gimp,
@@ -150,12 +159,17 @@ gimp_data_factories_init (Gimp *gimp)
                                "pattern factory");
   gimp_data_loader_factory_add_loader (gimp->pattern_factory,
                                        "GIMP Pattern",
-                                       gimp_pattern_load,
+                                       gimp_pattern_load_lazy,
                                        GIMP_PATTERN_FILE_EXTENSION,
                                        TRUE);
   gimp_data_loader_factory_add_fallback (gimp->pattern_factory,
                                          "Pattern from GdkPixbuf",
                                          gimp_pattern_load_pixbuf);
+  gimp_data_loader_factory_set_index_funcs (gimp->pattern_factory,
+                                            GIMP_PATTERN_FILE_EXTENSION,
+                                            gimp_pattern_load_index,
+                                            gimp_pattern_save_index);
+  gimp_data_loader_factory_set_parallel (gimp->pattern_factory, TRUE);
 
   gimp->gradient_factory =
     gimp_data_loader_factory_new (gimp,
@@ -177,6 +191,7 @@ gimp_data_factories_init (Gimp *gimp)
                                        gimp_gradient_load_svg,
                                        GIMP_GRADIENT_SVG_FILE_EXTENSION,
                                        FALSE);
+  gimp_data_loader_factory_set_parallel (gimp->gradient_factory, TRUE);
 
   gimp->palette_factory =
     gimp_data_loader_factory_new (gimp,
@@ -193,6 +208,7 @@ gimp_data_factories_init (Gimp *gimp)
                                        gimp_palette_load,
                                        GIMP_PALETTE_FILE_EXTENSION,
                                        TRUE);
+  gimp_data_loader_factory_set_parallel (gimp->palette_factory, TRUE);
 
   gimp->font_factory =
     gimp_font_factory_new (gimp,
@@ -26,8 +26,13 @@
 
 #include "core-types.h"
 
+#include "config/gimpcoreconfig.h"
+
+#include "gegl/gimp-gegl-utils.h"
+
 #include "gimp.h"
 #include "gimp-edit.h"
+#include "gimp-memsize.h"
 #include "gimpbuffer.h"
 #include "gimpcontext.h"
 #include "gimpdrawable-edit.h"
@@ -1245,10 +1250,13 @@ gimp_edit_extract (GimpImage     *image,
     gimp_image_undo_group_start (image, GIMP_UNDO_GROUP_EDIT_CUT,
                                  C_("undo-type", "Cut"));
 
-  /*  Cut/copy the mask portion from the image  */
+  /*  Cut/copy the mask portion from the image, keeping huge copies in
+   *  the swap; pasting them reads their tiles back on demand
+   */
   buffer = gimp_selection_extract (GIMP_SELECTION (gimp_image_get_mask (image)),
                                    pickables, context,
                                    cut_pixels, FALSE, FALSE,
+                                   image->gimp->config->clipboard_swap_threshold,
                                    &offset_x, &offset_y, error);
 
   if (cut_pixels)
@@ -0,0 +1,266 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-frame-stats.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <gegl.h>
+
+#include "libgimpmath/gimpmath.h"
+
+#include "core-types.h"
+
+#include "gimp-frame-stats.h"
+
+
+/* per-frame timing of the display pipeline, for the dashboard.
+ *
+ * a frame is a single canvas draw.  the render time is the part of the
+ * frame spent rendering the image into the render cache, including the
+ * color transforms.  projection rendering happens at idle time, between
+ * frames, so the projection time and chunks are those accumulated since
+ * the previous frame.
+ *
+ * frames are reported on the main thread; the stats may be read from any
+ * thread.
+ */
+
+
+/*  the number of frames the percentiles are computed over  */
+#define HISTORY_SIZE 128
+
+
+typedef struct
+{
+  gint64 frame_time;
+  gint64 render_time;
+  gint64 projection_time;
+  gint   projection_chunks;
+  gint64 checkerboard_area;
+} FrameStats;
+
+
+/*  local function prototypes  */
+
+static gint      gimp_frame_stats_compare_times  (const gint64 *time1,
+                                                  const gint64 *time2);
+static gdouble   gimp_frame_stats_get_percentile (gdouble       percentile);
+
+
+/*  local variables  */
+
+G_LOCK_DEFINE_STATIC (frame_stats);
+
+static gint64     frame_start_time = 0;
+
+static FrameStats current_frame;
+static FrameStats last_frame;
+
+static gint64     history[HISTORY_SIZE];
+static gint       history_index    = 0;
+static gint       history_length   = 0;
+
+
+/*  private functions  */
+
+static gint
+gimp_frame_stats_compare_times (const gint64 *time1,
+                                const gint64 *time2)
+{
+  return (*time1 > *time2) - (*time1 < *time2);
+}
+
+static gdouble
+gimp_frame_stats_get_percentile (gdouble percentile)
+{
+  gint64 times[HISTORY_SIZE];
+  gint   n_times;
+  gint   i;
+
+  G_LOCK (frame_stats);
+
+  n_times = history_length;
+
+  memcpy (times, history, n_times * sizeof (gint64));
+
+  G_UNLOCK (frame_stats);
+
+  if (n_times == 0)
+    return 0.0;
+
+  qsort (times, n_times, sizeof (gint64),
+         (GCompareFunc) gimp_frame_stats_compare_times);
+
+  i = CLAMP ((gint) ceil (percentile * n_times) - 1, 0, n_times - 1);
+
+  return (gdouble) times[i] / G_TIME_SPAN_SECOND;
+}
+
+
+/*  public functions  */
+
+void
+gimp_frame_stats_begin_frame (void)
+{
+  frame_start_time = g_get_monotonic_time ();
+}
+
+void
+gimp_frame_stats_end_frame (void)
+{
+  gint64 time;
+
+  if (! frame_start_time)
+    return;
+
+  time = g_get_monotonic_time () - frame_start_time;
+
+  frame_start_time = 0;
+
+  G_LOCK (frame_stats);
+
+  current_frame.frame_time = time;
+
+  last_frame = current_frame;
+
+  memset (&current_frame, 0, sizeof (current_frame));
+
+  history[history_index] = time;
+
+  history_index  = (history_index + 1) % HISTORY_SIZE;
+  history_length = MIN (history_length + 1, HISTORY_SIZE);
+
+  G_UNLOCK (frame_stats);
+}
+
+void
+gimp_frame_stats_add_render (gint64 time)
+{
+  G_LOCK (frame_stats);
+
+  current_frame.render_time += time;
+
+  G_UNLOCK (frame_stats);
+}
+
+void
+gimp_frame_stats_add_projection (gint64 time,
+                                 gint   n_chunks)
+{
+  G_LOCK (frame_stats);
+
+  current_frame.projection_time   += time;
+  current_frame.projection_chunks += n_chunks;
+
+  G_UNLOCK (frame_stats);
+}
+
+void
+gimp_frame_stats_add_checkerboard (gint64 area)
+{
+  G_LOCK (frame_stats);
+
+  current_frame.checkerboard_area += area;
+
+  G_UNLOCK (frame_stats);
+}
+
+gdouble
+gimp_frame_stats_get_frame_time (void)
+{
+  gint64 time;
+
+  G_LOCK (frame_stats);
+
+  time = last_frame.frame_time;
+
+  G_UNLOCK (frame_stats);
+
+  return (gdouble) time / G_TIME_SPAN_SECOND;
+}
+
+gdouble
+gimp_frame_stats_get_frame_time_p95 (void)
+{
+  return gimp_frame_stats_get_percentile (0.95);
+}
+
+gdouble
+gimp_frame_stats_get_frame_time_p99 (void)
+{
+  return gimp_frame_stats_get_percentile (0.99);
+}
+
+gdouble
+gimp_frame_stats_get_render_time (void)
+{
+  gint64 time;
+
+  G_LOCK (frame_stats);
+
+  time = last_frame.render_time;
+
+  G_UNLOCK (frame_stats);
+
+  return (gdouble) time / G_TIME_SPAN_SECOND;
+}
+
+gdouble
+gimp_frame_stats_get_projection_time (void)
+{
+  gint64 time;
+
+  G_LOCK (frame_stats);
+
+  time = last_frame.projection_time;
+
+  G_UNLOCK (frame_stats);
+
+  return (gdouble) time / G_TIME_SPAN_SECOND;
+}
+
+gint
+gimp_frame_stats_get_projection_chunks (void)
+{
+  gint n_chunks;
+
+  G_LOCK (frame_stats);
+
+  n_chunks = last_frame.projection_chunks;
+
+  G_UNLOCK (frame_stats);
+
+  return n_chunks;
+}
+
+gint
+gimp_frame_stats_get_checkerboard_area (void)
+{
+  gint64 area;
+
+  G_LOCK (frame_stats);
+
+  area = last_frame.checkerboard_area;
+
+  G_UNLOCK (frame_stats);
+
+  return MIN (area, G_MAXINT);
+}
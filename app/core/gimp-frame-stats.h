@@ -0,0 +1,37 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-frame-stats.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+void      gimp_frame_stats_begin_frame            (void);
+void      gimp_frame_stats_end_frame              (void);
+
+void      gimp_frame_stats_add_render             (gint64 time);
+void      gimp_frame_stats_add_projection         (gint64 time,
+                                                   gint   n_chunks);
+void      gimp_frame_stats_add_checkerboard       (gint64 area);
+
+gdouble   gimp_frame_stats_get_frame_time         (void);
+gdouble   gimp_frame_stats_get_frame_time_p95     (void);
+gdouble   gimp_frame_stats_get_frame_time_p99     (void);
+gdouble   gimp_frame_stats_get_render_time        (void);
+gdouble   gimp_frame_stats_get_projection_time    (void);
+gint      gimp_frame_stats_get_projection_chunks  (void);
+gint      gimp_frame_stats_get_checkerboard_area  (void);
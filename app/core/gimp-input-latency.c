@@ -0,0 +1,365 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-input-latency.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <gegl.h>
+
+#include "libgimpmath/gimpmath.h"
+
+#include "core-types.h"
+
+#include "gimp-input-latency.h"
+
+
+/* event-to-pixels latency of the painting tools, for the dashboard.
+ *
+ * an event is stamped when it reaches the canvas, and handed to the tool
+ * consuming it.  once painted, possibly by the paint thread, it's flushed
+ * to the projection and display along with the rest of the painted
+ * events, and its latency is taken when the next canvas frame is drawn.
+ *
+ * the events reaching the canvas while the tool is busy are coalesced,
+ * and represented by the oldest of them, so the latency is that of the
+ * first motion which the drawn pixels reflect.
+ *
+ * events are stamped, flushed and displayed on the main thread, and may
+ * be painted on any thread; the stats may be read from any thread.
+ */
+
+
+/*  the number of events the stats are computed over, per tool  */
+#define HISTORY_SIZE  256
+
+/*  the number of events waiting for a frame, before the oldest are
+ *  dropped, e.g. while there's no display to draw them
+ */
+#define MAX_PENDING   1024
+
+
+typedef struct
+{
+  const gchar *tool;
+  gint64       time;
+} Event;
+
+typedef struct
+{
+  const gchar *tool;
+  gint64       history[HISTORY_SIZE];
+  gint         history_index;
+  gint         history_length;
+} ToolStats;
+
+
+/*  local function prototypes  */
+
+static void        gimp_input_latency_queue_push    (GQueue                     *queue,
+                                                     const gchar                *tool,
+                                                     gint64                      time);
+
+static ToolStats * gimp_input_latency_get_stats     (const gchar                *tool);
+static void        gimp_input_latency_get_summary   (ToolStats                  *stats,
+                                                     GimpInputLatencyTool       *summary);
+
+static gint        gimp_input_latency_compare_times (const gint64               *time1,
+                                                     const gint64               *time2);
+static gint        gimp_input_latency_compare_tools (const GimpInputLatencyTool *tool1,
+                                                     const GimpInputLatencyTool *tool2);
+
+
+/*  local variables  */
+
+G_LOCK_DEFINE_STATIC (input_latency);
+
+static gint64       event_time   = 0;
+
+static GQueue       painted      = G_QUEUE_INIT;
+static GQueue       flushed      = G_QUEUE_INIT;
+
+static GHashTable  *tool_stats   = NULL;
+static ToolStats   *last_stats   = NULL;
+
+
+/*  private functions  */
+
+static void
+gimp_input_latency_queue_push (GQueue      *queue,
+                               const gchar *tool,
+                               gint64       time)
+{
+  Event *event;
+
+  if (queue->length >= MAX_PENDING)
+    {
+      event = g_queue_pop_head (queue);
+    }
+  else
+    {
+      event = g_slice_new (Event);
+    }
+
+  event->tool = tool;
+  event->time = time;
+
+  g_queue_push_tail (queue, event);
+}
+
+static ToolStats *
+gimp_input_latency_get_stats (const gchar *tool)
+{
+  ToolStats *stats;
+
+  if (! tool_stats)
+    tool_stats = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+  stats = g_hash_table_lookup (tool_stats, tool);
+
+  if (! stats)
+    {
+      stats = g_new0 (ToolStats, 1);
+
+      stats->tool = tool;
+
+      g_hash_table_insert (tool_stats, (gpointer) tool, stats);
+    }
+
+  return stats;
+}
+
+static void
+gimp_input_latency_get_summary (ToolStats            *stats,
+                                GimpInputLatencyTool *summary)
+{
+  gint64 times[HISTORY_SIZE];
+  gint64 total = 0;
+  gint   n     = stats->history_length;
+  gint   i;
+
+  memset (summary, 0, sizeof (GimpInputLatencyTool));
+
+  summary->tool     = stats->tool;
+  summary->n_events = n;
+
+  if (n == 0)
+    return;
+
+  memcpy (times, stats->history, n * sizeof (gint64));
+
+  for (i = 0; i < n; i++)
+    total += times[i];
+
+  qsort (times, n, sizeof (gint64),
+         (GCompareFunc) gimp_input_latency_compare_times);
+
+  summary->mean = (gdouble) total / n / G_TIME_SPAN_SECOND;
+  summary->p95  = (gdouble) times[CLAMP ((gint) ceil (0.95 * n) - 1,
+                                         0, n - 1)] / G_TIME_SPAN_SECOND;
+  summary->p99  = (gdouble) times[CLAMP ((gint) ceil (0.99 * n) - 1,
+                                         0, n - 1)] / G_TIME_SPAN_SECOND;
+}
+
+static gint
+gimp_input_latency_compare_times (const gint64 *time1,
+                                  const gint64 *time2)
+{
+  return (*time1 > *time2) - (*time1 < *time2);
+}
+
+static gint
+gimp_input_latency_compare_tools (const GimpInputLatencyTool *tool1,
+                                  const GimpInputLatencyTool *tool2)
+{
+  return strcmp (tool1->tool, tool2->tool);
+}
+
+
+/*  public functions  */
+
+/*  an input event reached the canvas  */
+void
+gimp_input_latency_event (void)
+{
+  if (! event_time)
+    event_time = g_get_monotonic_time ();
+}
+
+/*  returns the time the oldest event not yet consumed reached the canvas,
+ *  or 0 if there is none
+ */
+gint64
+gimp_input_latency_take_event (void)
+{
+  gint64 time = event_time;
+
+  event_time = 0;
+
+  return time;
+}
+
+/*  the event stamped 'time' was painted by 'tool'  */
+void
+gimp_input_latency_painted (const gchar *tool,
+                            gint64       time)
+{
+  g_return_if_fail (tool != NULL);
+
+  if (! time)
+    return;
+
+  G_LOCK (input_latency);
+
+  gimp_input_latency_queue_push (&painted, g_intern_string (tool), time);
+
+  G_UNLOCK (input_latency);
+}
+
+/*  the painted events were flushed to the display  */
+void
+gimp_input_latency_flushed (void)
+{
+  Event *event;
+
+  G_LOCK (input_latency);
+
+  while ((event = g_queue_pop_head (&painted)))
+    {
+      gimp_input_latency_queue_push (&flushed, event->tool, event->time);
+
+      g_slice_free (Event, event);
+    }
+
+  G_UNLOCK (input_latency);
+}
+
+/*  a canvas frame was drawn, showing the flushed events  */
+void
+gimp_input_latency_displayed (void)
+{
+  gint64  now;
+  Event  *event;
+
+  if (g_queue_is_empty (&flushed))
+    return;
+
+  now = g_get_monotonic_time ();
+
+  G_LOCK (input_latency);
+
+  while ((event = g_queue_pop_head (&flushed)))
+    {
+      ToolStats *stats = gimp_input_latency_get_stats (event->tool);
+
+      stats->history[stats->history_index] = now - event->time;
+
+      stats->history_index  = (stats->history_index + 1) % HISTORY_SIZE;
+      stats->history_length = MIN (stats->history_length + 1, HISTORY_SIZE);
+
+      last_stats = stats;
+
+      g_slice_free (Event, event);
+    }
+
+  G_UNLOCK (input_latency);
+}
+
+/*  the stats of the last tool used  */
+gdouble
+gimp_input_latency_get_mean (void)
+{
+  GimpInputLatencyTool summary = { 0, };
+
+  G_LOCK (input_latency);
+
+  if (last_stats)
+    gimp_input_latency_get_summary (last_stats, &summary);
+
+  G_UNLOCK (input_latency);
+
+  return summary.mean;
+}
+
+gdouble
+gimp_input_latency_get_p95 (void)
+{
+  GimpInputLatencyTool summary = { 0, };
+
+  G_LOCK (input_latency);
+
+  if (last_stats)
+    gimp_input_latency_get_summary (last_stats, &summary);
+
+  G_UNLOCK (input_latency);
+
+  return summary.p95;
+}
+
+gdouble
+gimp_input_latency_get_p99 (void)
+{
+  GimpInputLatencyTool summary = { 0, };
+
+  G_LOCK (input_latency);
+
+  if (last_stats)
+    gimp_input_latency_get_summary (last_stats, &summary);
+
+  G_UNLOCK (input_latency);
+
+  return summary.p99;
+}
+
+/*  returns a newly allocated array of the GimpInputLatencyTool stats of
+ *  all the tools used so far, sorted by tool name
+ */
+GArray *
+gimp_input_latency_get_tools (void)
+{
+  GArray *tools;
+
+  tools = g_array_new (FALSE, FALSE, sizeof (GimpInputLatencyTool));
+
+  G_LOCK (input_latency);
+
+  if (tool_stats)
+    {
+      GHashTableIter iter;
+      gpointer       value;
+
+      g_hash_table_iter_init (&iter, tool_stats);
+
+      while (g_hash_table_iter_next (&iter, NULL, &value))
+        {
+          GimpInputLatencyTool summary;
+
+          gimp_input_latency_get_summary (value, &summary);
+
+          g_array_append_val (tools, summary);
+        }
+    }
+
+  G_UNLOCK (input_latency);
+
+  g_array_sort (tools, (GCompareFunc) gimp_input_latency_compare_tools);
+
+  return tools;
+}
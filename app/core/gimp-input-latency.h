@@ -0,0 +1,45 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-input-latency.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+typedef struct
+{
+  const gchar *tool;
+  gint         n_events;
+  gdouble      mean;
+  gdouble      p95;
+  gdouble      p99;
+} GimpInputLatencyTool;
+
+
+void          gimp_input_latency_event         (void);
+gint64        gimp_input_latency_take_event    (void);
+
+void          gimp_input_latency_painted       (const gchar *tool,
+                                                gint64       time);
+void          gimp_input_latency_flushed       (void);
+void          gimp_input_latency_displayed     (void);
+
+gdouble       gimp_input_latency_get_mean      (void);
+gdouble       gimp_input_latency_get_p95       (void);
+gdouble       gimp_input_latency_get_p99       (void);
+
+GArray      * gimp_input_latency_get_tools     (void);
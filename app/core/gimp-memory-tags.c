@@ -0,0 +1,397 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-memory-tags.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <gegl.h>
+
+#include "core-types.h"
+
+#include "gimp-memory-tags.h"
+#include "gimpimage.h"
+
+
+/* attribution of live memory to the subsystem, and image, that
+ * allocated it, for the dashboard.
+ *
+ * while tagging is enabled, each accounted allocation is tagged when
+ * it's made, and the tag is kept along with it, so that the same amount
+ * is taken back from the same subsystem and image when it's freed, even
+ * if tagging was disabled in the meantime.  allocations made while
+ * tagging is disabled are never accounted for.
+ *
+ * temp bufs take the tag of the innermost scope pushed on the thread
+ * allocating them, while drawable buffers and undo steps are tagged
+ * explicitly.
+ */
+
+
+typedef struct
+{
+  GimpMemoryTag tag;
+  gint          image_id;
+} Scope;
+
+
+/*  local function prototypes  */
+
+static void   gimp_memory_tags_add           (GimpMemoryTag              tag,
+                                              gint                       image_id,
+                                              gint64                     size);
+static gint   gimp_memory_tags_image_compare (const GimpMemoryTagsImage *image1,
+                                              const GimpMemoryTagsImage *image2);
+static GQuark gimp_memory_tags_get_quark     (void);
+static void   gimp_memory_tags_free_tagged   (GimpMemoryTagged          *tagged);
+
+
+/*  local variables  */
+
+static gint        gimp_memory_tags_n_enabled = 0;
+
+static GPrivate    gimp_memory_tags_scopes =
+  G_PRIVATE_INIT ((GDestroyNotify) g_array_unref);
+
+/*  protected by 'gimp_memory_tags'  */
+G_LOCK_DEFINE_STATIC (gimp_memory_tags);
+
+static gint64      gimp_memory_tags_totals[GIMP_MEMORY_TAG_N_TAGS];
+static GHashTable *gimp_memory_tags_images = NULL;
+
+static const gchar * const gimp_memory_tags_names[GIMP_MEMORY_TAG_N_TAGS] =
+{
+  [GIMP_MEMORY_TAG_NONE]     = "none",
+  [GIMP_MEMORY_TAG_OTHER]    = "other",
+  [GIMP_MEMORY_TAG_DRAWABLE] = "drawables",
+  [GIMP_MEMORY_TAG_UNDO]     = "undo",
+  [GIMP_MEMORY_TAG_PREVIEW]  = "previews",
+  [GIMP_MEMORY_TAG_PAINT]    = "paint"
+};
+
+
+/*  public functions  */
+
+/*  tagging is enabled for as long as any caller has it enabled  */
+void
+gimp_memory_tags_enable (void)
+{
+  g_atomic_int_inc (&gimp_memory_tags_n_enabled);
+}
+
+void
+gimp_memory_tags_disable (void)
+{
+  g_return_if_fail (g_atomic_int_get (&gimp_memory_tags_n_enabled) > 0);
+
+  g_atomic_int_add (&gimp_memory_tags_n_enabled, -1);
+}
+
+gboolean
+gimp_memory_tags_is_enabled (void)
+{
+  return g_atomic_int_get (&gimp_memory_tags_n_enabled) > 0;
+}
+
+/*  until the matching call to gimp_memory_tags_pop(), temp bufs
+ *  allocated by the calling thread are accounted for under 'tag' and
+ *  'image', which may be NULL.
+ */
+void
+gimp_memory_tags_push (GimpMemoryTag  tag,
+                       GimpImage     *image)
+{
+  GArray *scopes = g_private_get (&gimp_memory_tags_scopes);
+  Scope   scope;
+
+  g_return_if_fail (tag > GIMP_MEMORY_TAG_NONE &&
+                    tag < GIMP_MEMORY_TAG_N_TAGS);
+  g_return_if_fail (image == NULL || GIMP_IS_IMAGE (image));
+
+  if (! scopes)
+    {
+      scopes = g_array_new (FALSE, FALSE, sizeof (Scope));
+
+      g_private_set (&gimp_memory_tags_scopes, scopes);
+    }
+
+  scope.tag      = tag;
+  scope.image_id = image ? gimp_image_get_id (image) : 0;
+
+  g_array_append_val (scopes, scope);
+}
+
+void
+gimp_memory_tags_pop (void)
+{
+  GArray *scopes = g_private_get (&gimp_memory_tags_scopes);
+
+  g_return_if_fail (scopes != NULL && scopes->len > 0);
+
+  g_array_set_size (scopes, scopes->len - 1);
+}
+
+/*  tags an allocation of 'size' bytes, made by the calling thread, with
+ *  its innermost scope
+ */
+void
+gimp_memory_tags_tag_current (GimpMemoryTagged *tagged,
+                              gint64            size)
+{
+  GArray *scopes;
+
+  g_return_if_fail (tagged != NULL);
+
+  tagged->tag      = GIMP_MEMORY_TAG_NONE;
+  tagged->image_id = 0;
+  tagged->size     = 0;
+
+  if (! gimp_memory_tags_is_enabled ())
+    return;
+
+  scopes = g_private_get (&gimp_memory_tags_scopes);
+
+  if (scopes && scopes->len > 0)
+    {
+      const Scope *scope = &g_array_index (scopes, Scope, scopes->len - 1);
+
+      tagged->tag      = scope->tag;
+      tagged->image_id = scope->image_id;
+    }
+  else
+    {
+      tagged->tag      = GIMP_MEMORY_TAG_OTHER;
+    }
+
+  tagged->size = size;
+
+  gimp_memory_tags_add (tagged->tag, tagged->image_id, tagged->size);
+}
+
+void
+gimp_memory_tags_untag (GimpMemoryTagged *tagged)
+{
+  g_return_if_fail (tagged != NULL);
+
+  if (tagged->tag == GIMP_MEMORY_TAG_NONE)
+    return;
+
+  gimp_memory_tags_add (tagged->tag, tagged->image_id, -tagged->size);
+
+  tagged->tag      = GIMP_MEMORY_TAG_NONE;
+  tagged->image_id = 0;
+  tagged->size     = 0;
+}
+
+/*  tags the memory owned by 'object', replacing its previous tag, and
+ *  untags it when 'object' is finalized
+ */
+void
+gimp_memory_tags_tag_object (GObject       *object,
+                             GimpMemoryTag  tag,
+                             GimpImage     *image,
+                             gint64         size)
+{
+  GimpMemoryTagged *tagged;
+
+  g_return_if_fail (G_IS_OBJECT (object));
+  g_return_if_fail (tag > GIMP_MEMORY_TAG_NONE &&
+                    tag < GIMP_MEMORY_TAG_N_TAGS);
+  g_return_if_fail (image == NULL || GIMP_IS_IMAGE (image));
+
+  if (! gimp_memory_tags_is_enabled ())
+    {
+      g_object_set_qdata (object, gimp_memory_tags_get_quark (), NULL);
+
+      return;
+    }
+
+  tagged = g_slice_new (GimpMemoryTagged);
+
+  tagged->tag      = tag;
+  tagged->image_id = image ? gimp_image_get_id (image) : 0;
+  tagged->size     = size;
+
+  gimp_memory_tags_add (tagged->tag, tagged->image_id, tagged->size);
+
+  g_object_set_qdata_full (object, gimp_memory_tags_get_quark (), tagged,
+                           (GDestroyNotify) gimp_memory_tags_free_tagged);
+}
+
+/*  takes 'size' bytes, which left memory, back from the memory tagged
+ *  for 'object'
+ */
+void
+gimp_memory_tags_shrink_object (GObject *object,
+                                gint64   size)
+{
+  GimpMemoryTagged *tagged;
+
+  g_return_if_fail (G_IS_OBJECT (object));
+
+  tagged = g_object_get_qdata (object, gimp_memory_tags_get_quark ());
+
+  if (! tagged)
+    return;
+
+  size = CLAMP (size, 0, tagged->size);
+
+  tagged->size -= size;
+
+  gimp_memory_tags_add (tagged->tag, tagged->image_id, -size);
+}
+
+gint64
+gimp_memory_tags_get_total (GimpMemoryTag tag)
+{
+  gint64 total;
+
+  g_return_val_if_fail (tag >= GIMP_MEMORY_TAG_NONE &&
+                        tag < GIMP_MEMORY_TAG_N_TAGS, 0);
+
+  G_LOCK (gimp_memory_tags);
+
+  total = gimp_memory_tags_totals[tag];
+
+  G_UNLOCK (gimp_memory_tags);
+
+  return total;
+}
+
+/*  returns the memory accounted for to each image, as an array of
+ *  GimpMemoryTagsImage sorted by image ID.  memory that isn't specific
+ *  to any image is reported under the image ID 0.
+ */
+GArray *
+gimp_memory_tags_get_images (void)
+{
+  GArray *images;
+
+  images = g_array_new (FALSE, FALSE, sizeof (GimpMemoryTagsImage));
+
+  G_LOCK (gimp_memory_tags);
+
+  if (gimp_memory_tags_images)
+    {
+      GHashTableIter iter;
+      gpointer       value;
+
+      g_hash_table_iter_init (&iter, gimp_memory_tags_images);
+
+      while (g_hash_table_iter_next (&iter, NULL, &value))
+        g_array_append_vals (images, value, 1);
+    }
+
+  G_UNLOCK (gimp_memory_tags);
+
+  g_array_sort (images, (GCompareFunc) gimp_memory_tags_image_compare);
+
+  return images;
+}
+
+const gchar *
+gimp_memory_tags_get_name (GimpMemoryTag tag)
+{
+  g_return_val_if_fail (tag >= GIMP_MEMORY_TAG_NONE &&
+                        tag < GIMP_MEMORY_TAG_N_TAGS, NULL);
+
+  return gimp_memory_tags_names[tag];
+}
+
+
+/*  private functions  */
+
+static void
+gimp_memory_tags_add (GimpMemoryTag tag,
+                      gint          image_id,
+                      gint64        size)
+{
+  GimpMemoryTagsImage *image;
+
+  if (size == 0)
+    return;
+
+  G_LOCK (gimp_memory_tags);
+
+  gimp_memory_tags_totals[tag] += size;
+
+  if (! gimp_memory_tags_images)
+    {
+      gimp_memory_tags_images = g_hash_table_new_full (NULL, NULL,
+                                                       NULL, g_free);
+    }
+
+  image = g_hash_table_lookup (gimp_memory_tags_images,
+                               GINT_TO_POINTER (image_id));
+
+  if (! image)
+    {
+      image = g_new0 (GimpMemoryTagsImage, 1);
+
+      image->image_id = image_id;
+
+      g_hash_table_insert (gimp_memory_tags_images,
+                           GINT_TO_POINTER (image_id), image);
+    }
+
+  image->sizes[tag] += size;
+
+  if (size < 0)
+    {
+      gint i;
+
+      for (i = 0; i < GIMP_MEMORY_TAG_N_TAGS; i++)
+        {
+          if (image->sizes[i])
+            break;
+        }
+
+      if (i == GIMP_MEMORY_TAG_N_TAGS)
+        {
+          g_hash_table_remove (gimp_memory_tags_images,
+                               GINT_TO_POINTER (image_id));
+        }
+    }
+
+  G_UNLOCK (gimp_memory_tags);
+}
+
+static gint
+gimp_memory_tags_image_compare (const GimpMemoryTagsImage *image1,
+                                const GimpMemoryTagsImage *image2)
+{
+  return image1->image_id - image2->image_id;
+}
+
+static GQuark
+gimp_memory_tags_get_quark (void)
+{
+  static GQuark quark = 0;
+
+  if (! quark)
+    quark = g_quark_from_static_string ("gimp-memory-tags-tagged");
+
+  return quark;
+}
+
+static void
+gimp_memory_tags_free_tagged (GimpMemoryTagged *tagged)
+{
+  gimp_memory_tags_untag (tagged);
+
+  g_slice_free (GimpMemoryTagged, tagged);
+}
@@ -0,0 +1,71 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-memory-tags.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+typedef enum
+{
+  GIMP_MEMORY_TAG_NONE,      /*  not accounted for                     */
+  GIMP_MEMORY_TAG_OTHER,     /*  temp bufs allocated outside any scope */
+  GIMP_MEMORY_TAG_DRAWABLE,  /*  layer and channel buffers             */
+  GIMP_MEMORY_TAG_UNDO,      /*  undo steps                            */
+  GIMP_MEMORY_TAG_PREVIEW,   /*  temp bufs allocated for previews      */
+  GIMP_MEMORY_TAG_PAINT,     /*  temp bufs allocated while painting    */
+
+  GIMP_MEMORY_TAG_N_TAGS
+} GimpMemoryTag;
+
+typedef struct
+{
+  GimpMemoryTag tag;
+  gint          image_id;
+  gint64        size;
+} GimpMemoryTagged;
+
+typedef struct
+{
+  gint          image_id;
+  gint64        sizes[GIMP_MEMORY_TAG_N_TAGS];
+} GimpMemoryTagsImage;
+
+
+void            gimp_memory_tags_enable        (void);
+void            gimp_memory_tags_disable       (void);
+gboolean        gimp_memory_tags_is_enabled    (void);
+
+void            gimp_memory_tags_push          (GimpMemoryTag     tag,
+                                                GimpImage        *image);
+void            gimp_memory_tags_pop           (void);
+
+void            gimp_memory_tags_tag_current   (GimpMemoryTagged *tagged,
+                                                gint64            size);
+void            gimp_memory_tags_untag         (GimpMemoryTagged *tagged);
+
+void            gimp_memory_tags_tag_object    (GObject          *object,
+                                                GimpMemoryTag     tag,
+                                                GimpImage        *image,
+                                                gint64            size);
+void            gimp_memory_tags_shrink_object (GObject          *object,
+                                                gint64            size);
+
+gint64          gimp_memory_tags_get_total     (GimpMemoryTag     tag);
+GArray        * gimp_memory_tags_get_images    (void);
+
+const gchar   * gimp_memory_tags_get_name      (GimpMemoryTag     tag);
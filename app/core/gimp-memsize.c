@@ -21,6 +21,7 @@
 
 #include <cairo.h>
 #include <gegl.h>
+#include <gegl-buffer-backend.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
 
 #include "libgimpbase/gimpbase.h"
@@ -33,6 +34,29 @@
 #include "gimpparamspecs.h"
 
 
+typedef struct
+{
+  gint        depth;
+  GHashTable *tiles;
+} SharedMemsize;
+
+
+/*  local function prototypes  */
+
+static void     gimp_memsize_shared_free              (SharedMemsize *shared);
+static gint64   gimp_gegl_buffer_get_shared_memsize   (GeglBuffer    *buffer,
+                                                       GHashTable    *tiles);
+
+
+/*  local variables  */
+
+static GPrivate memsize_shared =
+  G_PRIVATE_INIT ((GDestroyNotify) gimp_memsize_shared_free);
+
+
+/*  public functions  */
+
+
 gint64
 gimp_g_type_instance_get_memsize (GTypeInstance *instance)
 {
@@ -309,7 +333,14 @@ gimp_gegl_buffer_get_memsize (GeglBuffer *buffer)
 {
   if (buffer)
     {
-      const Babl *format = gegl_buffer_get_format (buffer);
+      const Babl    *format = gegl_buffer_get_format (buffer);
+      SharedMemsize *shared = g_private_get (&memsize_shared);
+
+      if (shared && shared->depth > 0)
+        {
+          return (gimp_gegl_buffer_get_shared_memsize (buffer, shared->tiles) +
+                  gimp_g_object_get_memsize (G_OBJECT (buffer)));
+        }
 
       return ((gint64) babl_format_get_bytes_per_pixel (format) *
               (gint64) gegl_buffer_get_width (buffer) *
@@ -320,6 +351,47 @@ gimp_gegl_buffer_get_memsize (GeglBuffer *buffer)
   return 0;
 }
 
+/**
+ * gimp_gegl_buffer_memsize_begin_shared:
+ *
+ * Until the matching call to gimp_gegl_buffer_memsize_end_shared(),
+ * gimp_gegl_buffer_get_memsize() counts the in-memory tiles of the
+ * buffers it measures individually, and counts the tiles that are
+ * shared copy-on-write between these buffers only once, instead of
+ * assuming that each buffer owns all of its pixels.  This is slower,
+ * but reflects the real memory use of a set of buffers that share most
+ * of their tiles, like undo steps and duplicated layers.
+ *
+ * Tiles that are not in memory are still counted in full.  Calls can be
+ * nested, and only affect the calling thread.
+ **/
+void
+gimp_gegl_buffer_memsize_begin_shared (void)
+{
+  SharedMemsize *shared = g_private_get (&memsize_shared);
+
+  if (! shared)
+    {
+      shared = g_slice_new0 (SharedMemsize);
+
+      g_private_set (&memsize_shared, shared);
+    }
+
+  if (shared->depth++ == 0)
+    shared->tiles = g_hash_table_new (NULL, NULL);
+}
+
+void
+gimp_gegl_buffer_memsize_end_shared (void)
+{
+  SharedMemsize *shared = g_private_get (&memsize_shared);
+
+  g_return_if_fail (shared != NULL && shared->depth > 0);
+
+  if (--shared->depth == 0)
+    g_clear_pointer (&shared->tiles, g_hash_table_unref);
+}
+
 gint64
 gimp_gegl_pyramid_get_memsize (GeglBuffer *buffer)
 {
@@ -357,3 +429,80 @@ gimp_parasite_get_memsize (GimpParasite *parasite,
 
   return 0;
 }
+
+
+/*  private functions  */
+
+static void
+gimp_memsize_shared_free (SharedMemsize *shared)
+{
+  g_clear_pointer (&shared->tiles, g_hash_table_unref);
+
+  g_slice_free (SharedMemsize, shared);
+}
+
+static gint64
+gimp_gegl_buffer_get_shared_memsize (GeglBuffer *buffer,
+                                     GHashTable *tiles)
+{
+  GeglTileSource *source = GEGL_TILE_SOURCE (buffer);
+  GeglRectangle   rect;
+  gint            tile_width;
+  gint            tile_height;
+  gint            shift_x;
+  gint            shift_y;
+  gint64          tile_size;
+  gint64          memsize = 0;
+  gint            x, y;
+
+  g_object_get (buffer,
+                "tile-width",  &tile_width,
+                "tile-height", &tile_height,
+                "shift-x",     &shift_x,
+                "shift-y",     &shift_y,
+                NULL);
+
+  tile_size = (gint64) babl_format_get_bytes_per_pixel (
+                         gegl_buffer_get_format (buffer)) *
+              tile_width * tile_height;
+
+  gegl_rectangle_align_to_buffer (&rect,
+                                  gegl_buffer_get_extent (buffer), buffer,
+                                  GEGL_RECTANGLE_ALIGNMENT_SUPERSET);
+
+  gegl_tile_handler_lock (GEGL_TILE_HANDLER (buffer));
+
+  for (y = rect.y; y < rect.y + rect.height; y += tile_height)
+    {
+      for (x = rect.x; x < rect.x + rect.width; x += tile_width)
+        {
+          gint      tile_x = (x + shift_x) / tile_width;
+          gint      tile_y = (y + shift_y) / tile_height;
+          GeglTile *tile   = NULL;
+
+          /*  don't pull tiles that are not in memory into memory  */
+          if (gegl_tile_source_command (source, GEGL_TILE_IS_CACHED,
+                                        tile_x, tile_y, 0, NULL))
+            {
+              tile = gegl_tile_source_get_tile (source, tile_x, tile_y, 0);
+            }
+
+          if (tile)
+            {
+              /*  tiles shared copy-on-write share their data  */
+              if (g_hash_table_add (tiles, gegl_tile_get_data (tile)))
+                memsize += tile_size;
+
+              gegl_tile_unref (tile);
+            }
+          else
+            {
+              memsize += tile_size;
+            }
+        }
+    }
+
+  gegl_tile_handler_unlock (GEGL_TILE_HANDLER (buffer));
+
+  return memsize;
+}
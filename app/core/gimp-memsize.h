@@ -49,6 +49,8 @@ gint64   gimp_g_value_get_memsize              (GValue          *value);
 gint64   gimp_g_param_spec_get_memsize         (GParamSpec      *pspec);
 
 gint64   gimp_gegl_buffer_get_memsize          (GeglBuffer      *buffer);
+void     gimp_gegl_buffer_memsize_begin_shared (void);
+void     gimp_gegl_buffer_memsize_end_shared   (void);
 gint64   gimp_gegl_pyramid_get_memsize         (GeglBuffer      *buffer);
 
 gint64   gimp_string_get_memsize               (const gchar     *string);
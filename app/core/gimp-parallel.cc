@@ -21,6 +21,10 @@
 
 #include "config.h"
 
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include <gio/gio.h>
 #include <gegl.h>
 
@@ -28,6 +32,11 @@
 #include <unistd.h>
 #endif
 
+#if defined (HAVE_UNISTD_H) && defined (__gnu_linux__)
+#include <sched.h>
+#define GIMP_PARALLEL_THREAD_AFFINITY
+#endif
+
 #ifdef G_OS_WIN32
 #include <windows.h>
 #endif
@@ -46,31 +55,115 @@ extern "C"
 
 
 #define GIMP_PARALLEL_MAX_THREADS           64
-#define GIMP_PARALLEL_RUN_ASYNC_MAX_THREADS  1
+#define GIMP_PARALLEL_RUN_ASYNC_MAX_THREADS GIMP_PARALLEL_MAX_THREADS
+
+/*  the number of tasks the percentiles are computed over  */
+#define GIMP_PARALLEL_STATS_HISTORY_SIZE    64
+
+/*  processors whose capacity is at least this fraction of the highest
+ *  capacity count as performance cores
+ */
+#define GIMP_PARALLEL_PERFORMANCE_CAPACITY  0.9
 
 
+/*  tasks are kept in per-thread deques, split into a small number of priority
+ *  buckets.  each thread serves its own deque first, and steals from the other
+ *  threads' deques when its own deque has no task of the most urgent pending
+ *  bucket.  within a bucket, tasks are served in FIFO order.
+ */
+typedef enum
+{
+  GIMP_PARALLEL_RUN_ASYNC_BUCKET_URGENT,  /*  tasks being waited upon  */
+  GIMP_PARALLEL_RUN_ASYNC_BUCKET_HIGH,    /*  priority <  0            */
+  GIMP_PARALLEL_RUN_ASYNC_BUCKET_DEFAULT, /*  priority == 0            */
+  GIMP_PARALLEL_RUN_ASYNC_BUCKET_LOW,     /*  priority >  0            */
+
+  GIMP_PARALLEL_RUN_ASYNC_N_BUCKETS
+} GimpParallelRunAsyncBucket;
+
+/*  tasks are run one at a time by default, by the first thread only, as
+ *  when there was a single async thread, since callers may rely on their
+ *  tasks not running alongside each other.  tasks of callers that opt in,
+ *  through gimp_parallel_run_async_concurrent_labeled_full(), go to the
+ *  concurrent pool, which is served by all threads.
+ */
+typedef enum
+{
+  GIMP_PARALLEL_RUN_ASYNC_POOL_SERIAL,
+  GIMP_PARALLEL_RUN_ASYNC_POOL_CONCURRENT,
+
+  GIMP_PARALLEL_RUN_ASYNC_N_POOLS
+} GimpParallelRunAsyncPool;
+
 typedef struct
 {
-  GimpAsync        *async;
-  gint              priority;
-  GimpRunAsyncFunc  func;
-  gpointer          user_data;
-  GDestroyNotify    user_data_destroy_func;
+  GimpAsync                  *async;
+  gint                        priority;
+  GimpRunAsyncFunc            func;
+  gpointer                    user_data;
+  GDestroyNotify              user_data_destroy_func;
+
+  GimpParallelRunAsyncPool    pool;
+  GimpParallelRunAsyncBucket  bucket;
+  GList                       link;
+
+  /*  stats  */
+  const gchar                *label;
+  GimpParallelRunAsyncBucket  stats_bucket;
+  gint64                      enqueue_time;
+  gint64                      run_time;
+  gboolean                    started;
 } GimpParallelRunAsyncTask;
 
 typedef struct
 {
   GThread   *thread;
+  gint       index;
 
-  gboolean   quit;
-
+  /*  protected by 'mutex'  */
+  GMutex     mutex;
+  gboolean   active;
+  GQueue     queues[GIMP_PARALLEL_RUN_ASYNC_N_POOLS][GIMP_PARALLEL_RUN_ASYNC_N_BUCKETS];
   GimpAsync *current_async;
+
+  /*  atomic  */
+  gint       quit;
+  gint       n_tasks;
 } GimpParallelRunAsyncThread;
 
+/*  with topology-aware thread placement, threads running interactive
+ *  tasks are restricted to the performance cores of the main thread's
+ *  memory node, so that the tiles they allocate and touch stay local,
+ *  and threads running background tasks to the efficiency cores.
+ */
+typedef enum
+{
+  GIMP_PARALLEL_PLACEMENT_ANY,
+  GIMP_PARALLEL_PLACEMENT_INTERACTIVE,
+  GIMP_PARALLEL_PLACEMENT_BACKGROUND,
+
+  GIMP_PARALLEL_N_PLACEMENTS
+} GimpParallelPlacement;
+
+typedef struct
+{
+  gint64 samples[GIMP_PARALLEL_STATS_HISTORY_SIZE];
+  gint   index;
+  gint   length;
+} GimpParallelStatsHistory;
+
 
 /*  local function prototypes  */
 
 static void                       gimp_parallel_notify_num_processors   (GimpGeglConfig             *config);
+static void                       gimp_parallel_notify_thread_placement (GimpGeglConfig             *config);
+
+#ifdef GIMP_PARALLEL_THREAD_AFFINITY
+static gint64                     gimp_parallel_read_cpu_value          (gint                        cpu,
+                                                                         const gchar                *name);
+static gint                       gimp_parallel_get_cpu_node            (gint                        cpu);
+#endif
+static void                       gimp_parallel_placement_init          (void);
 
 static void                       gimp_parallel_set_n_threads           (gint                        n_threads,
                                                                          gboolean                    finish_tasks);
@@ -78,22 +171,73 @@ static void                       gimp_parallel_set_n_threads           (gint
 static void                       gimp_parallel_run_async_set_n_threads (gint                        n_threads,
                                                                          gboolean                    finish_tasks);
 static gpointer                   gimp_parallel_run_async_thread_func   (GimpParallelRunAsyncThread *thread);
-static void                       gimp_parallel_run_async_enqueue_task  (GimpParallelRunAsyncTask   *task);
-static GimpParallelRunAsyncTask * gimp_parallel_run_async_dequeue_task  (void);
+static GimpParallelRunAsyncBucket gimp_parallel_run_async_get_bucket    (gint                        priority);
+static gboolean                   gimp_parallel_run_async_has_pending   (GimpParallelRunAsyncBucket  max_bucket,
+                                                                         gboolean                    serial);
+static GimpAsync                * gimp_parallel_run_async_submit        (const gchar                *label,
+                                                                         gint                        priority,
+                                                                         GimpParallelRunAsyncPool    pool,
+                                                                         GimpRunAsyncFunc            func,
+                                                                         gpointer                    user_data,
+                                                                         GDestroyNotify              user_data_destroy_func);
+static void                       gimp_parallel_run_async_enqueue_task  (GimpParallelRunAsyncTask   *task,
+                                                                         GimpParallelRunAsyncThread *thread);
+static GimpParallelRunAsyncTask * gimp_parallel_run_async_pop_task      (GimpParallelRunAsyncThread *thread,
+                                                                         GimpParallelRunAsyncPool    pool,
+                                                                         GimpParallelRunAsyncBucket  bucket);
+static GimpParallelRunAsyncTask * gimp_parallel_run_async_dequeue_task  (GimpParallelRunAsyncThread *thread);
+static GimpParallelRunAsyncTask * gimp_parallel_run_async_lock_task     (GimpAsync                  *async,
+                                                                         GimpParallelRunAsyncThread **thread);
+static void                       gimp_parallel_run_async_take_task     (GimpParallelRunAsyncThread *thread,
+                                                                         GimpParallelRunAsyncTask   *task);
 static gboolean                   gimp_parallel_run_async_execute_task  (GimpParallelRunAsyncTask   *task);
 static void                       gimp_parallel_run_async_abort_task    (GimpParallelRunAsyncTask   *task);
 static void                       gimp_parallel_run_async_cancel        (GimpAsync                  *async);
 static void                       gimp_parallel_run_async_waiting       (GimpAsync                  *async);
 
+static GimpParallelRunAsyncTask * gimp_parallel_run_async_task_new      (const gchar                *label,
+                                                                         gint                        priority,
+                                                                         GimpRunAsyncFunc            func,
+                                                                         gpointer                    user_data,
+                                                                         GDestroyNotify              user_data_destroy_func);
+
+static void                       gimp_parallel_stats_add_sample        (GimpParallelStatsHistory   *history,
+                                                                         gint64                      sample);
+static void                       gimp_parallel_stats_add_task          (GimpParallelRunAsyncTask   *task);
+static gdouble                    gimp_parallel_stats_get_percentile    (GimpParallelStatsHistory   *history,
+                                                                         gdouble                     percentile);
+
 
 /*  local variables  */
 
 static gint                       gimp_parallel_run_async_n_threads = 0;
+static gint                       gimp_parallel_run_async_n_slots   = 0;
 static GimpParallelRunAsyncThread gimp_parallel_run_async_threads[GIMP_PARALLEL_RUN_ASYNC_MAX_THREADS];
 
-static GMutex                     gimp_parallel_run_async_mutex;
-static GCond                      gimp_parallel_run_async_cond;
-static GQueue                     gimp_parallel_run_async_queue = G_QUEUE_INIT;
+static GPrivate                   gimp_parallel_run_async_current_thread = G_PRIVATE_INIT (NULL);
+static gint                       gimp_parallel_run_async_next_thread    = 0;
+static gint                       gimp_parallel_run_async_n_pending[GIMP_PARALLEL_RUN_ASYNC_N_POOLS][GIMP_PARALLEL_RUN_ASYNC_N_BUCKETS];
+
+static GMutex                     gimp_parallel_run_async_idle_mutex;
+static GCond                      gimp_parallel_run_async_idle_cond;
+static gint                       gimp_parallel_run_async_n_idle = 0;
+
+static gint                       gimp_parallel_thread_placement         = GIMP_THREAD_PLACEMENT_SYSTEM;
+static GPrivate                   gimp_parallel_current_placement        = G_PRIVATE_INIT (NULL);
+#ifdef GIMP_PARALLEL_THREAD_AFFINITY
+static gboolean                   gimp_parallel_placement_valid          = FALSE;
+static cpu_set_t                  gimp_parallel_placement_cpus[GIMP_PARALLEL_N_PLACEMENTS];
+#endif
+
+static GQuark                     gimp_parallel_run_async_thread_quark;
+static GQuark                     gimp_parallel_run_async_task_quark;
+
+/*  protected by 'gimp_parallel_stats'  */
+G_LOCK_DEFINE_STATIC (gimp_parallel_stats);
+
+static GimpParallelStatsHistory   gimp_parallel_stats_latencies[GIMP_PARALLEL_RUN_ASYNC_N_BUCKETS];
+static GimpParallelStatsHistory   gimp_parallel_stats_durations[GIMP_PARALLEL_RUN_ASYNC_N_BUCKETS];
+static GHashTable                *gimp_parallel_stats_label_times = NULL;
 
 
 /*  public functions  */
@@ -103,15 +247,45 @@ void
 gimp_parallel_init (Gimp *gimp)
 {
   GimpGeglConfig *config;
+  gint            i;
 
   g_return_if_fail (GIMP_IS_GIMP (gimp));
 
+  gimp_parallel_run_async_thread_quark =
+    g_quark_from_static_string ("gimp-parallel-run-async-thread");
+  gimp_parallel_run_async_task_quark =
+    g_quark_from_static_string ("gimp-parallel-run-async-task");
+
+  for (i = 0; i < GIMP_PARALLEL_RUN_ASYNC_MAX_THREADS; i++)
+    {
+      GimpParallelRunAsyncThread *thread =
+        &gimp_parallel_run_async_threads[i];
+      gint                        j;
+      gint                        k;
+
+      thread->index = i;
+
+      g_mutex_init (&thread->mutex);
+
+      for (j = 0; j < GIMP_PARALLEL_RUN_ASYNC_N_POOLS; j++)
+        {
+          for (k = 0; k < GIMP_PARALLEL_RUN_ASYNC_N_BUCKETS; k++)
+            g_queue_init (&thread->queues[j][k]);
+        }
+    }
+
+  gimp_parallel_placement_init ();
+
   config = GIMP_GEGL_CONFIG (gimp->config);
 
+  g_signal_connect (config, "notify::thread-placement",
+                    G_CALLBACK (gimp_parallel_notify_thread_placement),
+                    NULL);
   g_signal_connect (config, "notify::num-processors",
                     G_CALLBACK (gimp_parallel_notify_num_processors),
                     NULL);
 
+  gimp_parallel_notify_thread_placement (config);
   gimp_parallel_notify_num_processors (config);
 }
 
@@ -120,6 +294,9 @@ gimp_parallel_exit (Gimp *gimp)
 {
   g_return_if_fail (GIMP_IS_GIMP (gimp));
 
+  g_signal_handlers_disconnect_by_func (gimp->config,
+                                        (gpointer) gimp_parallel_notify_thread_placement,
+                                        NULL);
   g_signal_handlers_disconnect_by_func (gimp->config,
                                         (gpointer) gimp_parallel_notify_num_processors,
                                         NULL);
@@ -141,44 +318,47 @@ gimp_parallel_run_async_full (gint             priority,
                               gpointer         user_data,
                               GDestroyNotify   user_data_destroy_func)
 {
-  GimpAsync                *async;
-  GimpParallelRunAsyncTask *task;
+  return gimp_parallel_run_async_labeled_full (NULL, priority,
+                                               func, user_data,
+                                               user_data_destroy_func);
+}
 
+/* like gimp_parallel_run_async_full(), and accounts for the task under
+ * 'label', naming the kind of work it does (e.g., "histogram") in the
+ * dashboard.  unlabeled tasks are accounted for under "other".
+ */
+GimpAsync *
+gimp_parallel_run_async_labeled_full (const gchar      *label,
+                                      gint              priority,
+                                      GimpRunAsyncFunc  func,
+                                      gpointer          user_data,
+                                      GDestroyNotify    user_data_destroy_func)
+{
   g_return_val_if_fail (func != NULL, NULL);
 
-  async = gimp_async_new ();
-
-  task = g_slice_new (GimpParallelRunAsyncTask);
-
-  task->async                  = GIMP_ASYNC (g_object_ref (async));
-  task->priority               = priority;
-  task->func                   = func;
-  task->user_data              = user_data;
-  task->user_data_destroy_func = user_data_destroy_func;
-
-  if (gimp_parallel_run_async_n_threads > 0)
-    {
-      g_signal_connect_after (async, "cancel",
-                              G_CALLBACK (gimp_parallel_run_async_cancel),
-                              NULL);
-      g_signal_connect_after (async, "waiting",
-                              G_CALLBACK (gimp_parallel_run_async_waiting),
-                              NULL);
-
-      g_mutex_lock (&gimp_parallel_run_async_mutex);
-
-      gimp_parallel_run_async_enqueue_task (task);
-
-      g_cond_signal (&gimp_parallel_run_async_cond);
+  return gimp_parallel_run_async_submit (label, priority,
+                                         GIMP_PARALLEL_RUN_ASYNC_POOL_SERIAL,
+                                         func, user_data,
+                                         user_data_destroy_func);
+}
 
-      g_mutex_unlock (&gimp_parallel_run_async_mutex);
-    }
-  else
-    {
-      while (gimp_parallel_run_async_execute_task (task));
-    }
+/* like gimp_parallel_run_async_labeled_full(), except that the task may
+ * run at the same time as other tasks, including other tasks of the same
+ * caller, on any of the async threads.
+ */
+GimpAsync *
+gimp_parallel_run_async_concurrent_labeled_full (const gchar      *label,
+                                                 gint              priority,
+                                                 GimpRunAsyncFunc  func,
+                                                 gpointer          user_data,
+                                                 GDestroyNotify    user_data_destroy_func)
+{
+  g_return_val_if_fail (func != NULL, NULL);
 
-  return async;
+  return gimp_parallel_run_async_submit (label, priority,
+                                         GIMP_PARALLEL_RUN_ASYNC_POOL_CONCURRENT,
+                                         func, user_data,
+                                         user_data_destroy_func);
 }
 
 GimpAsync *
@@ -192,6 +372,16 @@ GimpAsync *
 gimp_parallel_run_async_independent_full (gint             priority,
                                           GimpRunAsyncFunc func,
                                           gpointer         user_data)
+{
+  return gimp_parallel_run_async_independent_labeled_full (NULL, priority,
+                                                           func, user_data);
+}
+
+GimpAsync *
+gimp_parallel_run_async_independent_labeled_full (const gchar      *label,
+                                                  gint              priority,
+                                                  GimpRunAsyncFunc  func,
+                                                  gpointer          user_data)
 {
   GimpAsync                *async;
   GimpParallelRunAsyncTask *task;
@@ -199,14 +389,9 @@ gimp_parallel_run_async_independent_full (gint             priority,
 
   g_return_val_if_fail (func != NULL, NULL);
 
-  async = gimp_async_new ();
-
-  task = g_slice_new0 (GimpParallelRunAsyncTask);
-
-  task->async     = GIMP_ASYNC (g_object_ref (async));
-  task->priority  = priority;
-  task->func      = func;
-  task->user_data = user_data;
+  task  = gimp_parallel_run_async_task_new (label, priority, func, user_data,
+                                            NULL);
+  async = GIMP_ASYNC (g_object_ref (task->async));
 
   thread = g_thread_new (
     "async-ind",
@@ -231,6 +416,8 @@ gimp_parallel_run_async_independent_full (gint             priority,
         }
 #endif
 
+      gimp_parallel_place_current_thread (task->priority);
+
       while (gimp_parallel_run_async_execute_task (task));
 
       return NULL;
@@ -248,6 +435,140 @@ gimp_parallel_run_async_independent_full (gint             priority,
   return async;
 }
 
+/* restricts the calling thread to the processors suited for work of
+ * the given priority, according to the "thread-placement" setting:
+ * interactive work (priority < 0) goes to the performance cores of the
+ * memory node GIMP was started on, and background work (priority > 0)
+ * to the efficiency cores; both fall back to all processors when the
+ * machine has no such distinction.  does nothing when the placement is
+ * left to the system, other than undoing a previous placement.
+ */
+void
+gimp_parallel_place_current_thread (gint priority)
+{
+#ifdef GIMP_PARALLEL_THREAD_AFFINITY
+  GimpParallelPlacement placement = GIMP_PARALLEL_PLACEMENT_ANY;
+  GimpParallelPlacement current;
+
+  if (! gimp_parallel_placement_valid)
+    return;
+
+  if (g_atomic_int_get (&gimp_parallel_thread_placement) ==
+      GIMP_THREAD_PLACEMENT_TOPOLOGY)
+    {
+      if (priority < 0)
+        placement = GIMP_PARALLEL_PLACEMENT_INTERACTIVE;
+      else if (priority > 0)
+        placement = GIMP_PARALLEL_PLACEMENT_BACKGROUND;
+    }
+
+  current = (GimpParallelPlacement) GPOINTER_TO_INT (
+    g_private_get (&gimp_parallel_current_placement));
+
+  if (placement == current)
+    return;
+
+  if (! sched_setaffinity (0, sizeof (cpu_set_t),
+                           &gimp_parallel_placement_cpus[placement]))
+    {
+      g_private_set (&gimp_parallel_current_placement,
+                     GINT_TO_POINTER (placement));
+    }
+#endif /* GIMP_PARALLEL_THREAD_AFFINITY */
+}
+
+/* the number of tasks waiting to be run */
+gint
+gimp_parallel_get_n_queued (void)
+{
+  gint n_queued = 0;
+  gint pool;
+  gint bucket;
+
+  for (pool = 0; pool < GIMP_PARALLEL_RUN_ASYNC_N_POOLS; pool++)
+    {
+      for (bucket = 0; bucket < GIMP_PARALLEL_RUN_ASYNC_N_BUCKETS; bucket++)
+        {
+          n_queued += g_atomic_int_get (
+            &gimp_parallel_run_async_n_pending[pool][bucket]);
+        }
+    }
+
+  return n_queued;
+}
+
+/* the 95th percentile of the time recent tasks of each priority waited
+ * between being queued and starting to run, and of the time they took
+ * to run.
+ */
+gdouble
+gimp_parallel_get_latency_high (void)
+{
+  return gimp_parallel_stats_get_percentile (
+    &gimp_parallel_stats_latencies[GIMP_PARALLEL_RUN_ASYNC_BUCKET_HIGH], 0.95);
+}
+
+gdouble
+gimp_parallel_get_latency_default (void)
+{
+  return gimp_parallel_stats_get_percentile (
+    &gimp_parallel_stats_latencies[GIMP_PARALLEL_RUN_ASYNC_BUCKET_DEFAULT], 0.95);
+}
+
+gdouble
+gimp_parallel_get_latency_low (void)
+{
+  return gimp_parallel_stats_get_percentile (
+    &gimp_parallel_stats_latencies[GIMP_PARALLEL_RUN_ASYNC_BUCKET_LOW], 0.95);
+}
+
+gdouble
+gimp_parallel_get_duration_high (void)
+{
+  return gimp_parallel_stats_get_percentile (
+    &gimp_parallel_stats_durations[GIMP_PARALLEL_RUN_ASYNC_BUCKET_HIGH], 0.95);
+}
+
+gdouble
+gimp_parallel_get_duration_default (void)
+{
+  return gimp_parallel_stats_get_percentile (
+    &gimp_parallel_stats_durations[GIMP_PARALLEL_RUN_ASYNC_BUCKET_DEFAULT], 0.95);
+}
+
+gdouble
+gimp_parallel_get_duration_low (void)
+{
+  return gimp_parallel_stats_get_percentile (
+    &gimp_parallel_stats_durations[GIMP_PARALLEL_RUN_ASYNC_BUCKET_LOW], 0.95);
+}
+
+/* the total time, in seconds, spent running the finished tasks labeled
+ * 'label', or the unlabeled tasks if 'label' is "other".
+ */
+gdouble
+gimp_parallel_get_label_time (const gchar *label)
+{
+  gint64 *time = NULL;
+  gdouble result;
+
+  g_return_val_if_fail (label != NULL, 0.0);
+
+  G_LOCK (gimp_parallel_stats);
+
+  if (gimp_parallel_stats_label_times)
+    {
+      time = (gint64 *) g_hash_table_lookup (gimp_parallel_stats_label_times,
+                                             g_intern_string (label));
+    }
+
+  result = time ? (gdouble) *time / G_TIME_SPAN_SECOND : 0.0;
+
+  G_UNLOCK (gimp_parallel_stats);
+
+  return result;
+}
+
 
 /*  private functions  */
 
@@ -259,6 +580,160 @@ gimp_parallel_notify_num_processors (GimpGeglConfig *config)
                                /* finish_tasks = */ TRUE);
 }
 
+static void
+gimp_parallel_notify_thread_placement (GimpGeglConfig *config)
+{
+  g_atomic_int_set (&gimp_parallel_thread_placement, config->thread_placement);
+
+  /* the main thread feeds the projection, so it counts as interactive.
+   * the pool threads pick the new setting up with their next task.
+   */
+  gimp_parallel_place_current_thread (-1);
+}
+
+#ifdef GIMP_PARALLEL_THREAD_AFFINITY
+
+static gint64
+gimp_parallel_read_cpu_value (gint         cpu,
+                              const gchar *name)
+{
+  gchar  *filename;
+  gchar  *contents;
+  gint64  value = -1;
+
+  filename = g_strdup_printf ("/sys/devices/system/cpu/cpu%d/%s", cpu, name);
+
+  if (g_file_get_contents (filename, &contents, NULL, NULL))
+    {
+      value = g_ascii_strtoll (contents, NULL, 10);
+
+      g_free (contents);
+    }
+
+  g_free (filename);
+
+  return value;
+}
+
+static gint
+gimp_parallel_get_cpu_node (gint cpu)
+{
+  gchar       *dirname;
+  GDir        *dir;
+  const gchar *name;
+  gint         node = -1;
+
+  if (cpu < 0)
+    return -1;
+
+  dirname = g_strdup_printf ("/sys/devices/system/cpu/cpu%d", cpu);
+  dir     = g_dir_open (dirname, 0, NULL);
+
+  g_free (dirname);
+
+  if (! dir)
+    return -1;
+
+  while ((name = g_dir_read_name (dir)))
+    {
+      if (g_str_has_prefix (name, "node") && g_ascii_isdigit (name[4]))
+        {
+          node = atoi (name + 4);
+
+          break;
+        }
+    }
+
+  g_dir_close (dir);
+
+  return node;
+}
+
+#endif /* GIMP_PARALLEL_THREAD_AFFINITY */
+
+/* finds the processors for each placement, among the ones the process
+ * may run on.  the capacity of a processor is its "cpu_capacity" where
+ * the kernel provides one, as on hybrid ARM and x86 machines, and its
+ * maximal frequency otherwise.
+ */
+static void
+gimp_parallel_placement_init (void)
+{
+#ifdef GIMP_PARALLEL_THREAD_AFFINITY
+  cpu_set_t *cpus = gimp_parallel_placement_cpus;
+  gint64    *capacities;
+  gint64     max_capacity = 0;
+  gint       home_node;
+  gint       cpu;
+
+  if (sched_getaffinity (0, sizeof (cpu_set_t),
+                         &cpus[GIMP_PARALLEL_PLACEMENT_ANY]))
+    {
+      return;
+    }
+
+  capacities = g_new0 (gint64, CPU_SETSIZE);
+
+  for (cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+      if (! CPU_ISSET (cpu, &cpus[GIMP_PARALLEL_PLACEMENT_ANY]))
+        continue;
+
+      capacities[cpu] = gimp_parallel_read_cpu_value (cpu, "cpu_capacity");
+
+      if (capacities[cpu] < 0)
+        {
+          capacities[cpu] = gimp_parallel_read_cpu_value (
+            cpu, "cpufreq/cpuinfo_max_freq");
+        }
+
+      max_capacity = MAX (max_capacity, capacities[cpu]);
+    }
+
+  home_node = gimp_parallel_get_cpu_node (sched_getcpu ());
+
+  CPU_ZERO (&cpus[GIMP_PARALLEL_PLACEMENT_INTERACTIVE]);
+  CPU_ZERO (&cpus[GIMP_PARALLEL_PLACEMENT_BACKGROUND]);
+
+  for (cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+      gboolean performance;
+
+      if (! CPU_ISSET (cpu, &cpus[GIMP_PARALLEL_PLACEMENT_ANY]))
+        continue;
+
+      performance = capacities[cpu] >=
+                    max_capacity * GIMP_PARALLEL_PERFORMANCE_CAPACITY;
+
+      if (! performance)
+        {
+          CPU_SET (cpu, &cpus[GIMP_PARALLEL_PLACEMENT_BACKGROUND]);
+        }
+      else if (home_node < 0 ||
+               gimp_parallel_get_cpu_node (cpu) == home_node)
+        {
+          CPU_SET (cpu, &cpus[GIMP_PARALLEL_PLACEMENT_INTERACTIVE]);
+        }
+    }
+
+  g_free (capacities);
+
+  if (CPU_COUNT (&cpus[GIMP_PARALLEL_PLACEMENT_INTERACTIVE]) == 0)
+    {
+      cpus[GIMP_PARALLEL_PLACEMENT_INTERACTIVE] =
+        cpus[GIMP_PARALLEL_PLACEMENT_ANY];
+    }
+
+  if (CPU_COUNT (&cpus[GIMP_PARALLEL_PLACEMENT_BACKGROUND]) == 0)
+    {
+      cpus[GIMP_PARALLEL_PLACEMENT_BACKGROUND] =
+        cpus[GIMP_PARALLEL_PLACEMENT_ANY];
+    }
+
+  gimp_parallel_placement_valid = TRUE;
+#endif /* GIMP_PARALLEL_THREAD_AFFINITY */
+}
+
 static void
 gimp_parallel_set_n_threads (gint     n_threads,
                              gboolean finish_tasks)
@@ -270,66 +745,118 @@ static void
 gimp_parallel_run_async_set_n_threads (gint     n_threads,
                                        gboolean finish_tasks)
 {
+  gint old_n_threads = gimp_parallel_run_async_n_threads;
   gint i;
 
   n_threads = CLAMP (n_threads, 0, GIMP_PARALLEL_RUN_ASYNC_MAX_THREADS);
 
-  if (n_threads > gimp_parallel_run_async_n_threads) /* need more threads */
+  if (n_threads > old_n_threads) /* need more threads */
     {
-      for (i = gimp_parallel_run_async_n_threads; i < n_threads; i++)
+      g_atomic_int_set (&gimp_parallel_run_async_n_slots,
+                        MAX (gimp_parallel_run_async_n_slots, n_threads));
+
+      for (i = old_n_threads; i < n_threads; i++)
         {
           GimpParallelRunAsyncThread *thread =
             &gimp_parallel_run_async_threads[i];
 
-          thread->quit = FALSE;
+          g_mutex_lock (&thread->mutex);
+
+          thread->active = TRUE;
+
+          g_mutex_unlock (&thread->mutex);
+
+          g_atomic_int_set (&thread->quit, FALSE);
 
           thread->thread = g_thread_new (
             "async",
             (GThreadFunc) gimp_parallel_run_async_thread_func,
             thread);
         }
+
+      g_atomic_int_set (&gimp_parallel_run_async_n_threads, n_threads);
     }
-  else if (n_threads < gimp_parallel_run_async_n_threads) /* need less threads */
+  else if (n_threads < old_n_threads) /* need less threads */
     {
-      g_mutex_lock (&gimp_parallel_run_async_mutex);
+      GQueue tasks = G_QUEUE_INIT;
+
+      /* new tasks only go to the remaining threads from now on */
+      g_atomic_int_set (&gimp_parallel_run_async_n_threads, n_threads);
 
-      for (i = n_threads; i < gimp_parallel_run_async_n_threads; i++)
+      for (i = n_threads; i < old_n_threads; i++)
         {
           GimpParallelRunAsyncThread *thread =
             &gimp_parallel_run_async_threads[i];
 
-          thread->quit = TRUE;
+          g_mutex_lock (&thread->mutex);
+
+          g_atomic_int_set (&thread->quit, TRUE);
 
           if (thread->current_async && ! finish_tasks)
             gimp_cancelable_cancel (GIMP_CANCELABLE (thread->current_async));
+
+          g_mutex_unlock (&thread->mutex);
         }
 
-      g_cond_broadcast (&gimp_parallel_run_async_cond);
+      g_mutex_lock (&gimp_parallel_run_async_idle_mutex);
+
+      g_cond_broadcast (&gimp_parallel_run_async_idle_cond);
 
-      g_mutex_unlock (&gimp_parallel_run_async_mutex);
+      g_mutex_unlock (&gimp_parallel_run_async_idle_mutex);
 
-      for (i = n_threads; i < gimp_parallel_run_async_n_threads; i++)
+      for (i = n_threads; i < old_n_threads; i++)
         {
           GimpParallelRunAsyncThread *thread =
             &gimp_parallel_run_async_threads[i];
+          GimpParallelRunAsyncTask   *task;
+          gint                        pool;
+          gint                        bucket;
 
           g_thread_join (thread->thread);
-        }
-    }
 
-  gimp_parallel_run_async_n_threads = n_threads;
+          /* collect the tasks left in the thread's deque */
+          g_mutex_lock (&thread->mutex);
 
-  if (n_threads == 0)
-    {
-      GimpParallelRunAsyncTask *task;
+          thread->active = FALSE;
+
+          for (pool = 0; pool < GIMP_PARALLEL_RUN_ASYNC_N_POOLS; pool++)
+            {
+              for (bucket = 0;
+                   bucket < GIMP_PARALLEL_RUN_ASYNC_N_BUCKETS;
+                   bucket++)
+                {
+                  while ((task = gimp_parallel_run_async_pop_task (
+                                   thread,
+                                   (GimpParallelRunAsyncPool)   pool,
+                                   (GimpParallelRunAsyncBucket) bucket)))
+                    {
+                      g_queue_push_tail (&tasks, task);
+                    }
+                }
+            }
+
+          g_mutex_unlock (&thread->mutex);
+        }
 
-      /* finish remaining tasks */
-      while ((task = gimp_parallel_run_async_dequeue_task ()))
+      while (! g_queue_is_empty (&tasks))
         {
-          if (finish_tasks)
-            while (gimp_parallel_run_async_execute_task (task));
+          GimpParallelRunAsyncTask *task =
+            (GimpParallelRunAsyncTask *) g_queue_pop_head (&tasks);
+
+          if (n_threads > 0)
+            {
+              /* hand the task over to one of the remaining threads */
+              gimp_parallel_run_async_enqueue_task (task, NULL);
+            }
+          else if (finish_tasks)
+            {
+              /* finish remaining tasks */
+              while (gimp_parallel_run_async_execute_task (task));
+            }
           else
-            gimp_parallel_run_async_abort_task (task);
+            {
+              gimp_parallel_run_async_abort_task (task);
+            }
         }
     }
 }
@@ -337,58 +864,168 @@ gimp_parallel_run_async_set_n_threads (gint     n_threads,
 static gpointer
 gimp_parallel_run_async_thread_func (GimpParallelRunAsyncThread *thread)
 {
-  g_mutex_lock (&gimp_parallel_run_async_mutex);
+  g_private_set (&gimp_parallel_run_async_current_thread, thread);
 
-  while (TRUE)
+  while (! g_atomic_int_get (&thread->quit))
     {
       GimpParallelRunAsyncTask *task;
 
-      while (! thread->quit &&
-             (task = gimp_parallel_run_async_dequeue_task ()))
+      task = gimp_parallel_run_async_dequeue_task (thread);
+
+      if (task)
         {
           gboolean resume;
 
+          /* tasks being waited upon count as interactive */
+          gimp_parallel_place_current_thread (
+            task->bucket <= GIMP_PARALLEL_RUN_ASYNC_BUCKET_HIGH    ? -1 :
+            task->bucket == GIMP_PARALLEL_RUN_ASYNC_BUCKET_DEFAULT ?  0 :
+                                                                      1);
+
+          g_mutex_lock (&thread->mutex);
+
           thread->current_async = GIMP_ASYNC (g_object_ref (task->async));
 
+          g_mutex_unlock (&thread->mutex);
+
+          /* keep running the task for as long as there is no other pending
+           * task of the same, or higher, priority bucket
+           */
           do
             {
-              g_mutex_unlock (&gimp_parallel_run_async_mutex);
-
               resume = gimp_parallel_run_async_execute_task (task);
-
-              g_mutex_lock (&gimp_parallel_run_async_mutex);
             }
           while (resume &&
-                 (g_queue_is_empty (&gimp_parallel_run_async_queue) ||
-                  task->priority <
-                  ((GimpParallelRunAsyncTask *)
-                     g_queue_peek_head (
-                       &gimp_parallel_run_async_queue))->priority));
+                 ! gimp_parallel_run_async_has_pending (task->bucket,
+                                                        thread->index == 0));
+
+          g_mutex_lock (&thread->mutex);
 
           g_clear_object (&thread->current_async);
 
+          g_mutex_unlock (&thread->mutex);
+
           if (resume)
-            gimp_parallel_run_async_enqueue_task (task);
+            gimp_parallel_run_async_enqueue_task (task, thread);
+
+          continue;
         }
 
-      if (thread->quit)
-        break;
+      g_mutex_lock (&gimp_parallel_run_async_idle_mutex);
 
-      g_cond_wait (&gimp_parallel_run_async_cond,
-                   &gimp_parallel_run_async_mutex);
-    }
+      g_atomic_int_inc (&gimp_parallel_run_async_n_idle);
+
+      while (! g_atomic_int_get (&thread->quit) &&
+             ! gimp_parallel_run_async_has_pending (
+                 GIMP_PARALLEL_RUN_ASYNC_BUCKET_LOW,
+                 thread->index == 0))
+        {
+          g_cond_wait (&gimp_parallel_run_async_idle_cond,
+                       &gimp_parallel_run_async_idle_mutex);
+        }
 
-  g_mutex_unlock (&gimp_parallel_run_async_mutex);
+      g_atomic_int_dec_and_test (&gimp_parallel_run_async_n_idle);
+
+      g_mutex_unlock (&gimp_parallel_run_async_idle_mutex);
+    }
 
   return NULL;
 }
 
-static void
-gimp_parallel_run_async_enqueue_task (GimpParallelRunAsyncTask *task)
+static GimpParallelRunAsyncBucket
+gimp_parallel_run_async_get_bucket (gint priority)
 {
-  GList *link;
-  GList *iter;
+  if (priority == G_MININT)
+    return GIMP_PARALLEL_RUN_ASYNC_BUCKET_URGENT;
+  else if (priority < 0)
+    return GIMP_PARALLEL_RUN_ASYNC_BUCKET_HIGH;
+  else if (priority == 0)
+    return GIMP_PARALLEL_RUN_ASYNC_BUCKET_DEFAULT;
+  else
+    return GIMP_PARALLEL_RUN_ASYNC_BUCKET_LOW;
+}
+
+/* checks if there is any queued concurrent task, or, if 'serial' is TRUE,
+ * any queued task, whose bucket is at least as urgent as 'max_bucket'.
+ */
+static gboolean
+gimp_parallel_run_async_has_pending (GimpParallelRunAsyncBucket max_bucket,
+                                     gboolean                   serial)
+{
+  gint bucket;
+
+  for (bucket = 0; bucket <= max_bucket; bucket++)
+    {
+      if (g_atomic_int_get (&gimp_parallel_run_async_n_pending
+                              [GIMP_PARALLEL_RUN_ASYNC_POOL_CONCURRENT]
+                              [bucket]) > 0)
+        {
+          return TRUE;
+        }
+
+      if (serial &&
+          g_atomic_int_get (&gimp_parallel_run_async_n_pending
+                              [GIMP_PARALLEL_RUN_ASYNC_POOL_SERIAL]
+                              [bucket]) > 0)
+        {
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+static GimpAsync *
+gimp_parallel_run_async_submit (const gchar              *label,
+                                gint                      priority,
+                                GimpParallelRunAsyncPool  pool,
+                                GimpRunAsyncFunc          func,
+                                gpointer                  user_data,
+                                GDestroyNotify            user_data_destroy_func)
+{
+  GimpAsync                *async;
+  GimpParallelRunAsyncTask *task;
 
+  task  = gimp_parallel_run_async_task_new (label, priority, func, user_data,
+                                            user_data_destroy_func);
+  async = GIMP_ASYNC (g_object_ref (task->async));
+
+  task->pool = pool;
+
+  if (g_atomic_int_get (&gimp_parallel_run_async_n_threads) > 0)
+    {
+      g_signal_connect_after (async, "cancel",
+                              G_CALLBACK (gimp_parallel_run_async_cancel),
+                              NULL);
+      g_signal_connect_after (async, "waiting",
+                              G_CALLBACK (gimp_parallel_run_async_waiting),
+                              NULL);
+
+      /* concurrent tasks spawned by an async thread go to the thread's own
+       * deque, while other concurrent tasks are distributed among the
+       * threads round-robin.  serial tasks always go to the first thread.
+       */
+      gimp_parallel_run_async_enqueue_task (
+        task,
+        (GimpParallelRunAsyncThread *) g_private_get (
+          &gimp_parallel_run_async_current_thread));
+    }
+  else
+    {
+      while (gimp_parallel_run_async_execute_task (task));
+    }
+
+  return async;
+}
+
+/* adds 'task' to the deque of 'thread', or, if 'thread' is NULL, or is no
+ * longer accepting tasks, to the deque of the next thread in round-robin
+ * order.  serial tasks always go to the deque of the first thread.
+ */
+static void
+gimp_parallel_run_async_enqueue_task (GimpParallelRunAsyncTask   *task,
+                                      GimpParallelRunAsyncThread *thread)
+{
   if (gimp_async_is_canceled (task->async))
     {
       gimp_parallel_run_async_abort_task (task);
@@ -396,63 +1033,244 @@ gimp_parallel_run_async_enqueue_task (GimpParallelRunAsyncTask *task)
       return;
     }
 
-  link       = g_list_alloc ();
-  link->data = task;
-
-  g_object_set_data (G_OBJECT (task->async),
-                     "gimp-parallel-run-async-link", link);
+  if (task->pool == GIMP_PARALLEL_RUN_ASYNC_POOL_SERIAL)
+    thread = NULL;
 
-  for (iter = g_queue_peek_tail_link (&gimp_parallel_run_async_queue);
-       iter;
-       iter = g_list_previous (iter))
+  while (TRUE)
     {
-      GimpParallelRunAsyncTask *other_task =
-        (GimpParallelRunAsyncTask *) iter->data;
+      if (! thread)
+        {
+          gint n_threads;
+
+          n_threads = g_atomic_int_get (&gimp_parallel_run_async_n_threads);
+
+          if (n_threads == 0)
+            {
+              /* all threads are gone; run the task synchronously */
+              while (gimp_parallel_run_async_execute_task (task));
+
+              return;
+            }
+
+          if (task->pool == GIMP_PARALLEL_RUN_ASYNC_POOL_SERIAL)
+            {
+              thread = &gimp_parallel_run_async_threads[0];
+            }
+          else
+            {
+              thread = &gimp_parallel_run_async_threads[
+                (guint) g_atomic_int_add (&gimp_parallel_run_async_next_thread,
+                                          1) % n_threads];
+            }
+        }
 
-      if (other_task->priority <= task->priority)
+      g_mutex_lock (&thread->mutex);
+
+      if (thread->active && ! g_atomic_int_get (&thread->quit))
         break;
+
+      g_mutex_unlock (&thread->mutex);
+
+      thread = NULL;
     }
 
-  if (iter)
-    {
-      link->prev = iter;
-      link->next = iter->next;
+  if (task->bucket == GIMP_PARALLEL_RUN_ASYNC_BUCKET_URGENT)
+    g_queue_push_head_link (&thread->queues[task->pool][task->bucket],
+                            &task->link);
+  else
+    g_queue_push_tail_link (&thread->queues[task->pool][task->bucket],
+                            &task->link);
 
-      iter->next = link;
+  g_object_set_qdata (G_OBJECT (task->async),
+                      gimp_parallel_run_async_task_quark, task);
+  g_object_set_qdata (G_OBJECT (task->async),
+                      gimp_parallel_run_async_thread_quark,
+                      GINT_TO_POINTER (thread->index + 1));
 
-      if (link->next)
-        link->next->prev = link;
+  g_atomic_int_inc (&thread->n_tasks);
+  g_atomic_int_inc (
+    &gimp_parallel_run_async_n_pending[task->pool][task->bucket]);
+
+  g_mutex_unlock (&thread->mutex);
+
+  if (g_atomic_int_get (&gimp_parallel_run_async_n_idle) > 0)
+    {
+      g_mutex_lock (&gimp_parallel_run_async_idle_mutex);
+
+      /* only the first thread can run serial tasks, so make sure it's
+       * among the woken threads
+       */
+      if (task->pool == GIMP_PARALLEL_RUN_ASYNC_POOL_SERIAL)
+        g_cond_broadcast (&gimp_parallel_run_async_idle_cond);
       else
-        gimp_parallel_run_async_queue.tail = link;
+        g_cond_signal (&gimp_parallel_run_async_idle_cond);
 
-      gimp_parallel_run_async_queue.length++;
+      g_mutex_unlock (&gimp_parallel_run_async_idle_mutex);
     }
-  else
+}
+
+/* pops the first task of 'pool' and 'bucket' off the deque of 'thread'.
+ * must be called with the thread's mutex held.
+ */
+static GimpParallelRunAsyncTask *
+gimp_parallel_run_async_pop_task (GimpParallelRunAsyncThread *thread,
+                                  GimpParallelRunAsyncPool    pool,
+                                  GimpParallelRunAsyncBucket  bucket)
+{
+  GList *link;
+
+  link = g_queue_pop_head_link (&thread->queues[pool][bucket]);
+
+  if (link)
     {
-      g_queue_push_head_link (&gimp_parallel_run_async_queue, link);
+      GimpParallelRunAsyncTask *task = (GimpParallelRunAsyncTask *) link->data;
+
+      gimp_parallel_run_async_take_task (thread, task);
+
+      return task;
     }
+
+  return NULL;
 }
 
+/* dequeues the next task to be run by 'thread', from its own deque if
+ * possible, or otherwise by stealing it from another thread.  tasks of more
+ * urgent buckets always take precedence, regardless of the deque they're in.
+ * serial tasks are only run by the first thread, and are never stolen.
+ */
 static GimpParallelRunAsyncTask *
-gimp_parallel_run_async_dequeue_task (void)
+gimp_parallel_run_async_dequeue_task (GimpParallelRunAsyncThread *thread)
 {
-  GimpParallelRunAsyncTask *task;
+  gint bucket;
 
-  task = (GimpParallelRunAsyncTask *) g_queue_pop_head (
-                                        &gimp_parallel_run_async_queue);
+  for (bucket = 0; bucket < GIMP_PARALLEL_RUN_ASYNC_N_BUCKETS; bucket++)
+    {
+      GimpParallelRunAsyncTask *task = NULL;
+      gint                      n_slots;
+      gint                      i;
+
+      if (thread->index == 0 &&
+          g_atomic_int_get (&gimp_parallel_run_async_n_pending
+                              [GIMP_PARALLEL_RUN_ASYNC_POOL_SERIAL]
+                              [bucket]) > 0)
+        {
+          g_mutex_lock (&thread->mutex);
 
-  if (task)
+          task = gimp_parallel_run_async_pop_task (
+            thread,
+            GIMP_PARALLEL_RUN_ASYNC_POOL_SERIAL,
+            (GimpParallelRunAsyncBucket) bucket);
+
+          g_mutex_unlock (&thread->mutex);
+
+          if (task)
+            return task;
+        }
+
+      if (g_atomic_int_get (&gimp_parallel_run_async_n_pending
+                              [GIMP_PARALLEL_RUN_ASYNC_POOL_CONCURRENT]
+                              [bucket]) == 0)
+        {
+          continue;
+        }
+
+      if (g_atomic_int_get (&thread->n_tasks) > 0)
+        {
+          g_mutex_lock (&thread->mutex);
+
+          task = gimp_parallel_run_async_pop_task (
+            thread,
+            GIMP_PARALLEL_RUN_ASYNC_POOL_CONCURRENT,
+            (GimpParallelRunAsyncBucket) bucket);
+
+          g_mutex_unlock (&thread->mutex);
+
+          if (task)
+            return task;
+        }
+
+      n_slots = g_atomic_int_get (&gimp_parallel_run_async_n_slots);
+
+      for (i = 1; i < n_slots; i++)
+        {
+          GimpParallelRunAsyncThread *victim =
+            &gimp_parallel_run_async_threads[(thread->index + i) % n_slots];
+
+          if (g_atomic_int_get (&victim->n_tasks) == 0)
+            continue;
+
+          g_mutex_lock (&victim->mutex);
+
+          task = gimp_parallel_run_async_pop_task (
+            victim,
+            GIMP_PARALLEL_RUN_ASYNC_POOL_CONCURRENT,
+            (GimpParallelRunAsyncBucket) bucket);
+
+          g_mutex_unlock (&victim->mutex);
+
+          if (task)
+            return task;
+        }
+    }
+
+  return NULL;
+}
+
+/* looks up the queued task of 'async', and locks the mutex of the thread
+ * whose deque it's in.  returns NULL, without holding any lock, if the task
+ * isn't queued.
+ */
+static GimpParallelRunAsyncTask *
+gimp_parallel_run_async_lock_task (GimpAsync                   *async,
+                                   GimpParallelRunAsyncThread **thread)
+{
+  gint index;
+
+  while ((index = GPOINTER_TO_INT (
+                    g_object_get_qdata (G_OBJECT (async),
+                                        gimp_parallel_run_async_thread_quark))))
     {
-      g_object_set_data (G_OBJECT (task->async),
-                         "gimp-parallel-run-async-link", NULL);
+      *thread = &gimp_parallel_run_async_threads[index - 1];
+
+      g_mutex_lock (&(*thread)->mutex);
+
+      /* the task might have moved to a different thread in the meantime */
+      if (GPOINTER_TO_INT (
+            g_object_get_qdata (G_OBJECT (async),
+                                gimp_parallel_run_async_thread_quark)) == index)
+        {
+          return (GimpParallelRunAsyncTask *) g_object_get_qdata (
+            G_OBJECT (async), gimp_parallel_run_async_task_quark);
+        }
+
+      g_mutex_unlock (&(*thread)->mutex);
     }
 
-  return task;
+  return NULL;
+}
+
+/* marks 'task', which has already been unlinked from the deque of 'thread',
+ * as no longer queued.  must be called with the thread's mutex held.
+ */
+static void
+gimp_parallel_run_async_take_task (GimpParallelRunAsyncThread *thread,
+                                   GimpParallelRunAsyncTask   *task)
+{
+  g_object_set_qdata (G_OBJECT (task->async),
+                      gimp_parallel_run_async_thread_quark, NULL);
+  g_object_set_qdata (G_OBJECT (task->async),
+                      gimp_parallel_run_async_task_quark, NULL);
+
+  g_atomic_int_dec_and_test (&thread->n_tasks);
+  g_atomic_int_dec_and_test (
+    &gimp_parallel_run_async_n_pending[task->pool][task->bucket]);
 }
 
 static gboolean
 gimp_parallel_run_async_execute_task (GimpParallelRunAsyncTask *task)
 {
+  gint64 start_time;
+
   if (gimp_async_is_canceled (task->async))
     {
       gimp_parallel_run_async_abort_task (task);
@@ -460,10 +1278,29 @@ gimp_parallel_run_async_execute_task (GimpParallelRunAsyncTask *task)
       return FALSE;
     }
 
+  start_time = g_get_monotonic_time ();
+
+  if (! task->started)
+    {
+      task->started = TRUE;
+
+      G_LOCK (gimp_parallel_stats);
+
+      gimp_parallel_stats_add_sample (
+        &gimp_parallel_stats_latencies[task->stats_bucket],
+        start_time - task->enqueue_time);
+
+      G_UNLOCK (gimp_parallel_stats);
+    }
+
   task->func (task->async, task->user_data);
 
+  task->run_time += g_get_monotonic_time () - start_time;
+
   if (gimp_async_is_stopped (task->async))
     {
+      gimp_parallel_stats_add_task (task);
+
       g_object_unref (task->async);
 
       g_slice_free (GimpParallelRunAsyncTask, task);
@@ -490,63 +1327,156 @@ gimp_parallel_run_async_abort_task (GimpParallelRunAsyncTask *task)
 static void
 gimp_parallel_run_async_cancel (GimpAsync *async)
 {
-  GList                    *link;
-  GimpParallelRunAsyncTask *task = NULL;
+  GimpParallelRunAsyncThread *thread;
+  GimpParallelRunAsyncTask   *task;
 
-  link = (GList *) g_object_get_data (G_OBJECT (async),
-                                      "gimp-parallel-run-async-link");
+  task = gimp_parallel_run_async_lock_task (async, &thread);
 
-  if (! link)
-    return;
+  if (task)
+    {
+      g_queue_unlink (&thread->queues[task->pool][task->bucket],
+                      &task->link);
 
-  g_mutex_lock (&gimp_parallel_run_async_mutex);
+      gimp_parallel_run_async_take_task (thread, task);
 
-  link = (GList *) g_object_get_data (G_OBJECT (async),
-                                      "gimp-parallel-run-async-link");
+      g_mutex_unlock (&thread->mutex);
 
-  if (link)
+      gimp_parallel_run_async_abort_task (task);
+    }
+}
+
+static void
+gimp_parallel_run_async_waiting (GimpAsync *async)
+{
+  GimpParallelRunAsyncThread *thread;
+  GimpParallelRunAsyncTask   *task;
+
+  task = gimp_parallel_run_async_lock_task (async, &thread);
+
+  if (task)
     {
-      g_object_set_data (G_OBJECT (async),
-                         "gimp-parallel-run-async-link", NULL);
+      g_queue_unlink (&thread->queues[task->pool][task->bucket],
+                      &task->link);
+
+      g_atomic_int_dec_and_test (
+        &gimp_parallel_run_async_n_pending[task->pool][task->bucket]);
 
-      task = (GimpParallelRunAsyncTask *) link->data;
+      task->priority = G_MININT;
+      task->bucket   = GIMP_PARALLEL_RUN_ASYNC_BUCKET_URGENT;
+
+      g_queue_push_head_link (&thread->queues[task->pool][task->bucket],
+                              &task->link);
 
-      g_queue_delete_link (&gimp_parallel_run_async_queue, link);
+      g_atomic_int_inc (
+        &gimp_parallel_run_async_n_pending[task->pool][task->bucket]);
+
+      g_mutex_unlock (&thread->mutex);
     }
+}
+
+static GimpParallelRunAsyncTask *
+gimp_parallel_run_async_task_new (const gchar      *label,
+                                  gint              priority,
+                                  GimpRunAsyncFunc  func,
+                                  gpointer          user_data,
+                                  GDestroyNotify    user_data_destroy_func)
+{
+  GimpParallelRunAsyncTask *task;
 
-  g_mutex_unlock (&gimp_parallel_run_async_mutex);
+  task = g_slice_new0 (GimpParallelRunAsyncTask);
 
-  if (task)
-    gimp_parallel_run_async_abort_task (task);
+  task->async                  = gimp_async_new ();
+  task->priority               = priority;
+  task->func                   = func;
+  task->user_data              = user_data;
+  task->user_data_destroy_func = user_data_destroy_func;
+  task->bucket                 = gimp_parallel_run_async_get_bucket (priority);
+  task->link.data              = task;
+
+  task->label                  = g_intern_string (label ? label : "other");
+  task->stats_bucket           = MAX (task->bucket,
+                                      GIMP_PARALLEL_RUN_ASYNC_BUCKET_HIGH);
+  task->enqueue_time           = g_get_monotonic_time ();
+
+  return task;
 }
 
+/* must be called with 'gimp_parallel_stats' held */
 static void
-gimp_parallel_run_async_waiting (GimpAsync *async)
+gimp_parallel_stats_add_sample (GimpParallelStatsHistory *history,
+                                gint64                    sample)
 {
-  GList *link;
+  history->samples[history->index] = sample;
 
-  link = (GList *) g_object_get_data (G_OBJECT (async),
-                                      "gimp-parallel-run-async-link");
+  history->index  = (history->index + 1) % GIMP_PARALLEL_STATS_HISTORY_SIZE;
+  history->length = MIN (history->length + 1,
+                         GIMP_PARALLEL_STATS_HISTORY_SIZE);
+}
 
-  if (! link)
-    return;
+static void
+gimp_parallel_stats_add_task (GimpParallelRunAsyncTask *task)
+{
+  gint64 *time;
 
-  g_mutex_lock (&gimp_parallel_run_async_mutex);
+  G_LOCK (gimp_parallel_stats);
 
-  link = (GList *) g_object_get_data (G_OBJECT (async),
-                                      "gimp-parallel-run-async-link");
+  gimp_parallel_stats_add_sample (
+    &gimp_parallel_stats_durations[task->stats_bucket], task->run_time);
 
-  if (link)
+  if (! gimp_parallel_stats_label_times)
     {
-      GimpParallelRunAsyncTask *task = (GimpParallelRunAsyncTask *) link->data;
+      gimp_parallel_stats_label_times = g_hash_table_new_full (NULL, NULL,
+                                                               NULL, g_free);
+    }
 
-      task->priority = G_MININT;
+  time = (gint64 *) g_hash_table_lookup (gimp_parallel_stats_label_times,
+                                         task->label);
+
+  if (! time)
+    {
+      time = g_new0 (gint64, 1);
 
-      g_queue_unlink         (&gimp_parallel_run_async_queue, link);
-      g_queue_push_head_link (&gimp_parallel_run_async_queue, link);
+      g_hash_table_insert (gimp_parallel_stats_label_times,
+                           (gpointer) task->label, time);
     }
 
-  g_mutex_unlock (&gimp_parallel_run_async_mutex);
+  *time += task->run_time;
+
+  G_UNLOCK (gimp_parallel_stats);
+}
+
+static gdouble
+gimp_parallel_stats_get_percentile (GimpParallelStatsHistory *history,
+                                    gdouble                   percentile)
+{
+  gint64 samples[GIMP_PARALLEL_STATS_HISTORY_SIZE];
+  gint   n_samples;
+  gint   i;
+
+  G_LOCK (gimp_parallel_stats);
+
+  n_samples = history->length;
+
+  memcpy (samples, history->samples, n_samples * sizeof (gint64));
+
+  G_UNLOCK (gimp_parallel_stats);
+
+  if (n_samples == 0)
+    return 0.0;
+
+  qsort (samples, n_samples, sizeof (gint64),
+         [] (const void *sample1,
+             const void *sample2) -> int
+         {
+           gint64 s1 = *(const gint64 *) sample1;
+           gint64 s2 = *(const gint64 *) sample2;
+
+           return (s1 > s2) - (s1 < s2);
+         });
+
+  i = CLAMP ((gint) ceil (percentile * n_samples) - 1, 0, n_samples - 1);
+
+  return (gdouble) samples[i] / G_TIME_SPAN_SECOND;
 }
 
 } /* extern "C" */
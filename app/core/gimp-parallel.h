@@ -36,6 +36,34 @@ GimpAsync * gimp_parallel_run_async_independent_full (gint              priority
                                                       GimpRunAsyncFunc  func,
                                                       gpointer          user_data);
 
+GimpAsync * gimp_parallel_run_async_labeled_full     (const gchar      *label,
+                                                      gint              priority,
+                                                      GimpRunAsyncFunc  func,
+                                                      gpointer          user_data,
+                                                      GDestroyNotify    user_data_destroy_func);
+GimpAsync * gimp_parallel_run_async_concurrent_labeled_full
+                                                     (const gchar      *label,
+                                                      gint              priority,
+                                                      GimpRunAsyncFunc  func,
+                                                      gpointer          user_data,
+                                                      GDestroyNotify    user_data_destroy_func);
+GimpAsync * gimp_parallel_run_async_independent_labeled_full
+                                                     (const gchar      *label,
+                                                      gint              priority,
+                                                      GimpRunAsyncFunc  func,
+                                                      gpointer          user_data);
+
+void        gimp_parallel_place_current_thread       (gint              priority);
+
+gint        gimp_parallel_get_n_queued               (void);
+gdouble     gimp_parallel_get_latency_high           (void);
+gdouble     gimp_parallel_get_latency_default        (void);
+gdouble     gimp_parallel_get_latency_low            (void);
+gdouble     gimp_parallel_get_duration_high          (void);
+gdouble     gimp_parallel_get_duration_default       (void);
+gdouble     gimp_parallel_get_duration_low           (void);
+gdouble     gimp_parallel_get_label_time             (const gchar      *label);
+
 
 #ifdef __cplusplus
 
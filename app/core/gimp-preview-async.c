@@ -0,0 +1,388 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-preview-async.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <cairo.h>
+#include <gegl.h>
+
+#include "libgimpmath/gimpmath.h"
+
+#include "core-types.h"
+
+#include "gegl/gimptilehandlervalidate.h"
+
+#include "gimp-parallel.h"
+#include "gimp-preview-async.h"
+#include "gimp-utils.h"
+#include "gimpasync.h"
+#include "gimpcancelable.h"
+#include "gimpchunkiterator.h"
+#include "gimptempbuf.h"
+
+#include "gimp-priorities.h"
+
+
+/* a single preview render, shared by all the identical requests made
+ * while it's running.  each request gets its own client async, so that
+ * canceling one of them doesn't affect the others; the render itself is
+ * only canceled once all of its clients are.
+ */
+typedef struct
+{
+  GeglBuffer        *buffer;
+  const Babl        *format;
+  GeglRectangle      rect;
+  gdouble            scale;
+
+  GimpChunkIterator *iter;
+} PreviewData;
+
+typedef struct
+{
+  GeglBuffer        *buffer;
+  const Babl        *format;
+  GeglRectangle      rect;
+  gdouble            scale;
+
+  GimpAsync         *async;
+  GList             *clients;
+  gint               n_clients;
+  gboolean           detached;
+} PreviewRequest;
+
+
+/*  local function prototypes  */
+
+static PreviewData * preview_data_new            (GeglBuffer           *buffer,
+                                                  const Babl           *format,
+                                                  const GeglRectangle  *rect,
+                                                  gdouble               scale);
+static void          preview_data_free           (PreviewData          *data);
+
+static guint         preview_request_hash        (const PreviewRequest *request);
+static gboolean      preview_request_equal       (const PreviewRequest *request1,
+                                                  const PreviewRequest *request2);
+static void          preview_request_detach      (PreviewRequest       *request);
+
+static void          gimp_preview_async_func     (GimpAsync            *async,
+                                                  PreviewData          *data);
+static void          gimp_preview_async_callback (GimpAsync            *async,
+                                                  PreviewRequest       *request);
+static void          gimp_preview_async_cancel   (GimpAsync            *client,
+                                                  PreviewRequest       *request);
+
+
+/*  local variables  */
+
+static GHashTable *preview_requests = NULL;
+
+
+/*  private functions  */
+
+static PreviewData *
+preview_data_new (GeglBuffer          *buffer,
+                  const Babl          *format,
+                  const GeglRectangle *rect,
+                  gdouble              scale)
+{
+  PreviewData *data = g_slice_new (PreviewData);
+
+  data->buffer = g_object_ref (buffer);
+  data->format = format;
+  data->rect   = *rect;
+  data->scale  = scale;
+
+  data->iter   = NULL;
+
+  return data;
+}
+
+static void
+preview_data_free (PreviewData *data)
+{
+  g_object_unref (data->buffer);
+
+  if (data->iter)
+    gimp_chunk_iterator_stop (data->iter, TRUE);
+
+  g_slice_free (PreviewData, data);
+}
+
+static guint
+preview_request_hash (const PreviewRequest *request)
+{
+  guint hash;
+
+  hash = g_direct_hash (request->buffer) ^ g_direct_hash (request->format);
+
+  hash = hash * 31 + request->rect.x;
+  hash = hash * 31 + request->rect.y;
+  hash = hash * 31 + request->rect.width;
+  hash = hash * 31 + request->rect.height;
+
+  return hash ^ g_double_hash (&request->scale);
+}
+
+static gboolean
+preview_request_equal (const PreviewRequest *request1,
+                       const PreviewRequest *request2)
+{
+  return request1->buffer == request2->buffer                     &&
+         request1->format == request2->format                     &&
+         gegl_rectangle_equal (&request1->rect, &request2->rect) &&
+         request1->scale  == request2->scale;
+}
+
+/* stop handing out the request to new clients */
+static void
+preview_request_detach (PreviewRequest *request)
+{
+  if (! request->detached)
+    {
+      g_hash_table_remove (preview_requests, request);
+
+      request->detached = TRUE;
+    }
+}
+
+static void
+gimp_preview_async_func (GimpAsync   *async,
+                         PreviewData *data)
+{
+  GimpTempBuf             *preview;
+  GimpTileHandlerValidate *validate;
+
+  validate = gimp_tile_handler_validate_get_assigned (data->buffer);
+
+  if (validate)
+    {
+      if (! data->iter)
+        {
+          cairo_region_t        *region;
+          cairo_rectangle_int_t  rect;
+
+          rect.x      = floor (data->rect.x / data->scale);
+          rect.y      = floor (data->rect.y / data->scale);
+          rect.width  = ceil ((data->rect.x + data->rect.width)  /
+                              data->scale) - rect.x;
+          rect.height = ceil ((data->rect.y + data->rect.height) /
+                              data->scale) - rect.y;
+
+          region = cairo_region_copy (validate->dirty_region);
+
+          cairo_region_intersect_rectangle (region, &rect);
+
+          data->iter = gimp_chunk_iterator_new (region);
+        }
+
+      if (gimp_chunk_iterator_next (data->iter))
+        {
+          GeglRectangle rect;
+
+          gimp_tile_handler_validate_begin_validate (validate);
+
+          while (gimp_chunk_iterator_get_rect (data->iter, &rect))
+            {
+              gimp_tile_handler_validate_validate (validate,
+                                                   data->buffer, &rect,
+                                                   FALSE, FALSE);
+            }
+
+          gimp_tile_handler_validate_end_validate (validate);
+
+          return;
+        }
+
+      data->iter = NULL;
+    }
+
+  preview = gimp_temp_buf_new (data->rect.width, data->rect.height,
+                               data->format);
+
+  /* for scales below 1, this reads from the buffer's mipmap levels */
+  gegl_buffer_get (data->buffer, &data->rect, data->scale,
+                   gimp_temp_buf_get_format (preview),
+                   gimp_temp_buf_get_data (preview),
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_CLAMP);
+
+  gimp_async_finish_full (async,
+                          preview,
+                          (GDestroyNotify) gimp_temp_buf_unref);
+}
+
+static void
+gimp_preview_async_callback (GimpAsync      *async,
+                             PreviewRequest *request)
+{
+  GimpTempBuf *preview = NULL;
+  GList       *list;
+
+  preview_request_detach (request);
+
+  if (gimp_async_is_finished (async))
+    preview = gimp_async_get_result (async);
+
+  for (list = request->clients; list; list = g_list_next (list))
+    {
+      GimpAsync *client = list->data;
+
+      g_signal_handlers_disconnect_by_func (client,
+                                            gimp_preview_async_cancel,
+                                            request);
+
+      if (preview && ! gimp_async_is_canceled (client))
+        {
+          gimp_async_finish_full (client,
+                                  gimp_temp_buf_ref (preview),
+                                  (GDestroyNotify) gimp_temp_buf_unref);
+        }
+      else
+        {
+          gimp_async_abort (client);
+        }
+    }
+
+  g_list_free_full (request->clients, g_object_unref);
+
+  g_object_unref (request->async);
+  g_object_unref (request->buffer);
+
+  g_slice_free (PreviewRequest, request);
+}
+
+static void
+gimp_preview_async_cancel (GimpAsync      *client,
+                           PreviewRequest *request)
+{
+  g_signal_handlers_disconnect_by_func (client,
+                                        gimp_preview_async_cancel,
+                                        request);
+
+  /* the canceled client was likely invalidated, so its next request
+   * shouldn't be served by this render
+   */
+  preview_request_detach (request);
+
+  if (--request->n_clients == 0)
+    gimp_cancelable_cancel (GIMP_CANCELABLE (request->async));
+}
+
+
+/*  public functions  */
+
+/* renders a 'rect.width' x 'rect.height' preview of 'buffer', at 'scale',
+ * in 'format', asynchronously.
+ *
+ * if 'buffer' has a validate handler, its dirty part is validated in
+ * chunks on the main thread, at idle time; otherwise, the preview is
+ * rendered on a worker thread.  identical requests that are made while
+ * a preview is being rendered share the same render.
+ *
+ * the returned async's result is a GimpTempBuf.  it's stopped from the
+ * main loop, and therefore shouldn't be waited upon.
+ *
+ * may only be called on the main thread.
+ */
+GimpAsync *
+gimp_preview_async_new (GeglBuffer          *buffer,
+                        const Babl          *format,
+                        const GeglRectangle *rect,
+                        gdouble              scale)
+{
+  PreviewRequest  key;
+  PreviewRequest *request;
+  GimpAsync      *client;
+  gboolean        new_request = FALSE;
+
+  g_return_val_if_fail (GEGL_IS_BUFFER (buffer), NULL);
+  g_return_val_if_fail (format != NULL, NULL);
+  g_return_val_if_fail (rect != NULL, NULL);
+  g_return_val_if_fail (scale > 0.0, NULL);
+
+  if (! preview_requests)
+    {
+      preview_requests = g_hash_table_new (
+        (GHashFunc)  preview_request_hash,
+        (GEqualFunc) preview_request_equal);
+    }
+
+  key.buffer = buffer;
+  key.format = format;
+  key.rect   = *rect;
+  key.scale  = scale;
+
+  request = g_hash_table_lookup (preview_requests, &key);
+
+  if (! request)
+    {
+      PreviewData *data;
+
+      request = g_slice_new0 (PreviewRequest);
+
+      request->buffer = g_object_ref (buffer);
+      request->format = format;
+      request->rect   = *rect;
+      request->scale  = scale;
+
+      data = preview_data_new (buffer, format, rect, scale);
+
+      if (gimp_tile_handler_validate_get_assigned (buffer))
+        {
+          request->async = gimp_idle_run_async_full (
+            GIMP_PRIORITY_VIEWABLE_IDLE,
+            (GimpRunAsyncFunc) gimp_preview_async_func,
+            data,
+            (GDestroyNotify) preview_data_free);
+        }
+      else
+        {
+          request->async = gimp_parallel_run_async_labeled_full (
+            "preview", +1,
+            (GimpRunAsyncFunc) gimp_preview_async_func,
+            data,
+            (GDestroyNotify) preview_data_free);
+        }
+
+      g_hash_table_add (preview_requests, request);
+
+      new_request = TRUE;
+    }
+
+  client = gimp_async_new ();
+
+  request->clients = g_list_prepend (request->clients, g_object_ref (client));
+  request->n_clients++;
+
+  g_signal_connect (client, "cancel",
+                    G_CALLBACK (gimp_preview_async_cancel),
+                    request);
+
+  /* the callback is only added once the request has a client, since it
+   * may be called, and free the request, right away
+   */
+  if (new_request)
+    {
+      gimp_async_add_callback (request->async,
+                               (GimpAsyncCallback) gimp_preview_async_callback,
+                               request);
+    }
+
+  return client;
+}
@@ -0,0 +1,286 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-startup-profile.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <gio/gio.h>
+
+#include "core-types.h"
+
+#include "gimp-startup-profile.h"
+
+
+/* startup tracing, enabled with --profile-startup.
+ *
+ * the duration of each init phase is recorded, together with the thread
+ * it ran on, and written as a Chrome trace (the JSON format read by
+ * about:tracing, Perfetto, etc.) when GIMP exits.
+ *
+ * phases may be recorded from any thread.  when tracing is disabled,
+ * recording a phase costs a single check.
+ */
+
+
+typedef struct
+{
+  gchar  *name;
+  gint64  begin_time;
+  gint64  end_time;   /*  -1 for instant events  */
+  gint    thread;
+} GimpStartupEvent;
+
+
+/*  local function prototypes  */
+
+static gint   gimp_startup_profile_get_thread (void);
+static void   gimp_startup_profile_add        (const gchar *name,
+                                               gint64       begin_time,
+                                               gint64       end_time);
+static void   gimp_startup_profile_append_str (GString     *str,
+                                               const gchar *s);
+
+
+/*  local variables  */
+
+G_LOCK_DEFINE_STATIC (startup_profile);
+
+static gchar   *profile_filename = NULL;
+static gint64   profile_start    = 0;
+static GArray  *profile_events   = NULL;
+static gint     profile_threads  = 0;
+
+static GPrivate profile_thread;
+
+
+/*  public functions  */
+
+void
+gimp_startup_profile_init (const gchar *filename)
+{
+  g_return_if_fail (profile_filename == NULL);
+
+  if (! filename)
+    return;
+
+  profile_filename = g_strdup (filename);
+  profile_start    = g_get_monotonic_time ();
+  profile_events   = g_array_new (FALSE, FALSE, sizeof (GimpStartupEvent));
+
+  /*  make the calling thread, i.e., the main thread, thread 1  */
+  gimp_startup_profile_get_thread ();
+}
+
+void
+gimp_startup_profile_exit (void)
+{
+  GString *str;
+  GError  *error = NULL;
+  guint    i;
+  gint     thread;
+
+  if (! profile_filename)
+    return;
+
+  str = g_string_new ("{\n\"traceEvents\": [\n");
+
+  G_LOCK (startup_profile);
+
+  for (thread = 1; thread <= profile_threads; thread++)
+    {
+      g_string_append_printf (str,
+                              "  {\"name\": \"thread_name\", \"ph\": \"M\", "
+                              "\"pid\": 1, \"tid\": %d, "
+                              "\"args\": {\"name\": ",
+                              thread);
+
+      if (thread == 1)
+        {
+          g_string_append (str, "\"Main thread\"");
+        }
+      else
+        {
+          gchar *name = g_strdup_printf ("Thread %d", thread);
+
+          gimp_startup_profile_append_str (str, name);
+
+          g_free (name);
+        }
+
+      g_string_append (str, "}},\n");
+    }
+
+  for (i = 0; i < profile_events->len; i++)
+    {
+      GimpStartupEvent *event = &g_array_index (profile_events,
+                                                GimpStartupEvent, i);
+
+      g_string_append (str, "  {\"name\": ");
+      gimp_startup_profile_append_str (str, event->name);
+
+      if (event->end_time >= 0)
+        {
+          g_string_append_printf (str,
+                                  ", \"cat\": \"startup\", \"ph\": \"X\", "
+                                  "\"ts\": %" G_GINT64_FORMAT ", "
+                                  "\"dur\": %" G_GINT64_FORMAT,
+                                  event->begin_time - profile_start,
+                                  event->end_time - event->begin_time);
+        }
+      else
+        {
+          g_string_append_printf (str,
+                                  ", \"cat\": \"startup\", \"ph\": \"i\", "
+                                  "\"s\": \"g\", "
+                                  "\"ts\": %" G_GINT64_FORMAT,
+                                  event->begin_time - profile_start);
+        }
+
+      g_string_append_printf (str, ", \"pid\": 1, \"tid\": %d}%s\n",
+                              event->thread,
+                              i + 1 < profile_events->len ? "," : "");
+
+      g_free (event->name);
+    }
+
+  g_clear_pointer (&profile_events, g_array_unref);
+
+  G_UNLOCK (startup_profile);
+
+  g_string_append (str, "],\n\"displayTimeUnit\": \"ms\"\n}\n");
+
+  if (! g_file_set_contents (profile_filename, str->str, str->len, &error))
+    {
+      g_printerr ("Could not write the startup profile: %s\n",
+                  error->message);
+      g_clear_error (&error);
+    }
+
+  g_string_free (str, TRUE);
+
+  g_clear_pointer (&profile_filename, g_free);
+}
+
+gboolean
+gimp_startup_profile_enabled (void)
+{
+  return profile_filename != NULL;
+}
+
+/* returns the time to pass to gimp_startup_profile_end() once the phase
+ * is done.
+ */
+gint64
+gimp_startup_profile_begin (void)
+{
+  if (! profile_filename)
+    return 0;
+
+  return g_get_monotonic_time ();
+}
+
+void
+gimp_startup_profile_end (const gchar *phase,
+                          gint64       begin_time)
+{
+  g_return_if_fail (phase != NULL);
+
+  if (! profile_filename)
+    return;
+
+  gimp_startup_profile_add (phase, begin_time, g_get_monotonic_time ());
+}
+
+void
+gimp_startup_profile_mark (const gchar *event)
+{
+  g_return_if_fail (event != NULL);
+
+  if (! profile_filename)
+    return;
+
+  gimp_startup_profile_add (event, g_get_monotonic_time (), -1);
+}
+
+
+/*  private functions  */
+
+static gint
+gimp_startup_profile_get_thread (void)
+{
+  gint thread = GPOINTER_TO_INT (g_private_get (&profile_thread));
+
+  if (! thread)
+    {
+      thread = g_atomic_int_add (&profile_threads, 1) + 1;
+
+      g_private_set (&profile_thread, GINT_TO_POINTER (thread));
+    }
+
+  return thread;
+}
+
+static void
+gimp_startup_profile_add (const gchar *name,
+                          gint64       begin_time,
+                          gint64       end_time)
+{
+  GimpStartupEvent event;
+
+  event.name       = g_strdup (name);
+  event.begin_time = begin_time;
+  event.end_time   = end_time;
+  event.thread     = gimp_startup_profile_get_thread ();
+
+  G_LOCK (startup_profile);
+
+  if (profile_events)
+    g_array_append_val (profile_events, event);
+  else
+    g_free (event.name);
+
+  G_UNLOCK (startup_profile);
+}
+
+static void
+gimp_startup_profile_append_str (GString     *str,
+                                 const gchar *s)
+{
+  g_string_append_c (str, '"');
+
+  for (; *s; s++)
+    {
+      switch (*s)
+        {
+        case '"':
+        case '\\':
+          g_string_append_c (str, '\\');
+          g_string_append_c (str, *s);
+          break;
+
+        default:
+          if ((guchar) *s < 0x20)
+            g_string_append_printf (str, "\\u%04x", (guchar) *s);
+          else
+            g_string_append_c (str, *s);
+          break;
+        }
+    }
+
+  g_string_append_c (str, '"');
+}
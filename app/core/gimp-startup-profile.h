@@ -0,0 +1,31 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-startup-profile.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+void       gimp_startup_profile_init    (const gchar *filename);
+void       gimp_startup_profile_exit    (void);
+
+gboolean   gimp_startup_profile_enabled (void);
+
+gint64     gimp_startup_profile_begin   (void);
+void       gimp_startup_profile_end     (const gchar *phase,
+                                         gint64       begin_time);
+void       gimp_startup_profile_mark    (const gchar *event);
@@ -0,0 +1,151 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-swap-stats.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <gegl.h>
+
+#include "libgimpmath/gimpmath.h"
+
+#include "core-types.h"
+
+#include "gimp-swap-stats.h"
+
+
+/* tile-swap timing, for the dashboard.
+ *
+ * GEGL only reports swap totals, so the read latencies are those of the
+ * tile fetches GIMP times itself, currently the projection's read-ahead,
+ * counting only fetches during which data was read from the swap.
+ *
+ * the stats may be added and read from any thread.
+ */
+
+
+/*  the number of reads the percentiles are computed over  */
+#define HISTORY_SIZE 128
+
+
+/*  local function prototypes  */
+
+static gint      gimp_swap_stats_compare_times  (const gint64 *time1,
+                                                 const gint64 *time2);
+static gdouble   gimp_swap_stats_get_percentile (gdouble       percentile);
+
+
+/*  local variables  */
+
+G_LOCK_DEFINE_STATIC (swap_stats);
+
+static gint64 history[HISTORY_SIZE];
+static gint   history_index  = 0;
+static gint   history_length = 0;
+
+static gint64 read_ahead     = 0;
+
+
+/*  private functions  */
+
+static gint
+gimp_swap_stats_compare_times (const gint64 *time1,
+                               const gint64 *time2)
+{
+  return (*time1 > *time2) - (*time1 < *time2);
+}
+
+static gdouble
+gimp_swap_stats_get_percentile (gdouble percentile)
+{
+  gint64 times[HISTORY_SIZE];
+  gint   n_times;
+  gint   i;
+
+  G_LOCK (swap_stats);
+
+  n_times = history_length;
+
+  memcpy (times, history, n_times * sizeof (gint64));
+
+  G_UNLOCK (swap_stats);
+
+  if (n_times == 0)
+    return 0.0;
+
+  qsort (times, n_times, sizeof (gint64),
+         (GCompareFunc) gimp_swap_stats_compare_times);
+
+  i = CLAMP ((gint) ceil (percentile * n_times) - 1, 0, n_times - 1);
+
+  return (gdouble) times[i] / G_TIME_SPAN_SECOND;
+}
+
+
+/*  public functions  */
+
+void
+gimp_swap_stats_add_read (gint64 time)
+{
+  G_LOCK (swap_stats);
+
+  history[history_index] = time;
+
+  history_index  = (history_index + 1) % HISTORY_SIZE;
+  history_length = MIN (history_length + 1, HISTORY_SIZE);
+
+  G_UNLOCK (swap_stats);
+}
+
+void
+gimp_swap_stats_add_read_ahead (gint64 size)
+{
+  G_LOCK (swap_stats);
+
+  read_ahead += size;
+
+  G_UNLOCK (swap_stats);
+}
+
+gdouble
+gimp_swap_stats_get_read_latency (void)
+{
+  return gimp_swap_stats_get_percentile (0.50);
+}
+
+gdouble
+gimp_swap_stats_get_read_latency_p95 (void)
+{
+  return gimp_swap_stats_get_percentile (0.95);
+}
+
+guint64
+gimp_swap_stats_get_read_ahead (void)
+{
+  gint64 size;
+
+  G_LOCK (swap_stats);
+
+  size = read_ahead;
+
+  G_UNLOCK (swap_stats);
+
+  return size;
+}
@@ -0,0 +1,465 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-tile-profile.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <gegl.h>
+
+#include "core-types.h"
+
+#include "gegl/gimptilehandlerprofile.h"
+
+#include "gimp.h"
+#include "gimp-tile-profile.h"
+#include "gimpchannel.h"
+#include "gimpdrawable.h"
+#include "gimpgrouplayer.h"
+#include "gimpimage.h"
+#include "gimplayer.h"
+#include "gimplayermask.h"
+#include "gimpprojectable.h"
+#include "gimpprojection.h"
+
+
+/* attribution of tile cache misses and swap reads to the buffers of the
+ * images, for the tile heat map.
+ *
+ * while profiling is enabled, each drawable, projection and drawable undo
+ * buffer is assigned a GimpTileHandlerProfile, counting the tiles fetched
+ * while not in the tile cache, and those of them read back from swap, as
+ * of the time the buffer was registered.  the counts are mapped to image
+ * coordinates through the buffer's owner, so they can be drawn over the
+ * canvas.
+ *
+ * buffers are registered on the main thread, and may be released on any
+ * thread.
+ */
+
+
+typedef struct
+{
+  GeglBuffer             *buffer;
+  GimpTileHandlerProfile *handler;
+  GimpTileProfileOwner    owner;
+  gint                    image_id;
+  gint                    item_id;
+  gint                    offset_x;
+  gint                    offset_y;
+} Entry;
+
+
+/*  local function prototypes  */
+
+static void   gimp_tile_profile_register      (GeglBuffer           *buffer,
+                                               GimpTileProfileOwner  owner,
+                                               GimpImage            *image,
+                                               GimpItem             *item,
+                                               gint                  offset_x,
+                                               gint                  offset_y);
+static void   gimp_tile_profile_add_image     (GimpImage            *image);
+static void   gimp_tile_profile_buffer_notify (gpointer              data,
+                                               GObject              *buffer);
+static void   gimp_tile_profile_entry_free    (Entry                *entry);
+
+
+/*  local variables  */
+
+G_LOCK_DEFINE_STATIC (tile_profile);
+
+static gint         gimp_tile_profile_n_enabled = 0;
+static Gimp        *gimp_tile_profile_gimp      = NULL;
+static GHashTable  *gimp_tile_profile_entries   = NULL;
+
+
+/*  private functions  */
+
+static void
+gimp_tile_profile_register (GeglBuffer           *buffer,
+                            GimpTileProfileOwner  owner,
+                            GimpImage            *image,
+                            GimpItem             *item,
+                            gint                  offset_x,
+                            gint                  offset_y)
+{
+  Entry *entry;
+
+  if (! buffer || ! image)
+    return;
+
+  G_LOCK (tile_profile);
+
+  entry = g_hash_table_lookup (gimp_tile_profile_entries, buffer);
+
+  if (! entry)
+    {
+      entry = g_slice_new0 (Entry);
+
+      entry->buffer  = buffer;
+      entry->handler = gimp_tile_handler_profile_get_assigned (buffer);
+
+      if (! entry->handler)
+        {
+          entry->handler = GIMP_TILE_HANDLER_PROFILE (
+            gimp_tile_handler_profile_new ());
+
+          gimp_tile_handler_profile_assign (entry->handler, buffer);
+
+          /*  the buffer's handler chain keeps it alive  */
+          g_object_unref (entry->handler);
+        }
+
+      g_object_weak_ref (G_OBJECT (buffer),
+                         gimp_tile_profile_buffer_notify, NULL);
+
+      g_hash_table_insert (gimp_tile_profile_entries, buffer, entry);
+    }
+
+  entry->owner    = owner;
+  entry->image_id = gimp_image_get_id (image);
+  entry->item_id  = item ? gimp_item_get_id (item) : 0;
+  entry->offset_x = offset_x;
+  entry->offset_y = offset_y;
+
+  G_UNLOCK (tile_profile);
+}
+
+static void
+gimp_tile_profile_add_image (GimpImage *image)
+{
+  GimpProjection *projection;
+  GeglBuffer     *buffer = NULL;
+  GList          *list;
+  GList          *iter;
+
+  list = gimp_image_get_layer_list (image);
+
+  for (iter = list; iter; iter = g_list_next (iter))
+    {
+      GimpLayer *layer = iter->data;
+
+      if (GIMP_IS_GROUP_LAYER (layer))
+        {
+          GeglBuffer *group_buffer = NULL;
+
+          projection =
+            gimp_group_layer_get_projection (GIMP_GROUP_LAYER (layer));
+
+          g_object_get (projection, "buffer", &group_buffer, NULL);
+
+          if (group_buffer)
+            {
+              gimp_tile_profile_add_projection (GIMP_PROJECTABLE (layer),
+                                                group_buffer);
+
+              g_object_unref (group_buffer);
+            }
+        }
+      else
+        {
+          gimp_tile_profile_add_drawable (GIMP_DRAWABLE (layer));
+        }
+
+      if (gimp_layer_get_mask (layer))
+        gimp_tile_profile_add_drawable (
+          GIMP_DRAWABLE (gimp_layer_get_mask (layer)));
+    }
+
+  g_list_free (list);
+
+  list = gimp_image_get_channel_list (image);
+
+  for (iter = list; iter; iter = g_list_next (iter))
+    gimp_tile_profile_add_drawable (iter->data);
+
+  g_list_free (list);
+
+  gimp_tile_profile_add_drawable (GIMP_DRAWABLE (gimp_image_get_mask (image)));
+
+  /*  only profile a projection which is already allocated  */
+  projection = gimp_image_get_projection (image);
+
+  g_object_get (projection, "buffer", &buffer, NULL);
+
+  if (buffer)
+    {
+      gimp_tile_profile_add_projection (GIMP_PROJECTABLE (image), buffer);
+
+      g_object_unref (buffer);
+    }
+}
+
+static void
+gimp_tile_profile_buffer_notify (gpointer  data,
+                                 GObject  *buffer)
+{
+  G_LOCK (tile_profile);
+
+  if (gimp_tile_profile_entries)
+    g_hash_table_remove (gimp_tile_profile_entries, buffer);
+
+  G_UNLOCK (tile_profile);
+}
+
+static void
+gimp_tile_profile_entry_free (Entry *entry)
+{
+  g_slice_free (Entry, entry);
+}
+
+
+/*  public functions  */
+
+/*  profiling is enabled for as long as any caller has it enabled  */
+void
+gimp_tile_profile_enable (Gimp *gimp)
+{
+  GList *list;
+
+  g_return_if_fail (GIMP_IS_GIMP (gimp));
+
+  if (gimp_tile_profile_n_enabled++ > 0)
+    return;
+
+  gimp_tile_profile_gimp = gimp;
+
+  G_LOCK (tile_profile);
+
+  gimp_tile_profile_entries = g_hash_table_new_full (
+    NULL, NULL, NULL, (GDestroyNotify) gimp_tile_profile_entry_free);
+
+  G_UNLOCK (tile_profile);
+
+  for (list = gimp_get_image_iter (gimp); list; list = g_list_next (list))
+    gimp_tile_profile_add_image (list->data);
+}
+
+void
+gimp_tile_profile_disable (void)
+{
+  GHashTable     *entries;
+  GHashTableIter  iter;
+  Entry          *entry;
+
+  g_return_if_fail (gimp_tile_profile_n_enabled > 0);
+
+  if (--gimp_tile_profile_n_enabled > 0)
+    return;
+
+  G_LOCK (tile_profile);
+
+  entries                   = gimp_tile_profile_entries;
+  gimp_tile_profile_entries = NULL;
+
+  G_UNLOCK (tile_profile);
+
+  g_hash_table_iter_init (&iter, entries);
+
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &entry))
+    {
+      g_object_weak_unref (G_OBJECT (entry->buffer),
+                           gimp_tile_profile_buffer_notify, NULL);
+
+      if (gimp_tile_handler_profile_get_assigned (entry->buffer) ==
+          entry->handler)
+        {
+          gimp_tile_handler_profile_unassign (entry->handler, entry->buffer);
+        }
+    }
+
+  g_hash_table_unref (entries);
+
+  gimp_tile_profile_gimp = NULL;
+}
+
+gboolean
+gimp_tile_profile_is_enabled (void)
+{
+  return gimp_tile_profile_n_enabled > 0;
+}
+
+/*  the buffer of 'drawable' was set  */
+void
+gimp_tile_profile_add_drawable (GimpDrawable *drawable)
+{
+  g_return_if_fail (GIMP_IS_DRAWABLE (drawable));
+
+  if (! gimp_tile_profile_is_enabled ())
+    return;
+
+  /*  drawables with children use their projection's buffer, which is
+   *  registered as such
+   */
+  if (gimp_viewable_get_children (GIMP_VIEWABLE (drawable)))
+    return;
+
+  gimp_tile_profile_register (gimp_drawable_get_buffer (drawable),
+                              GIMP_TILE_PROFILE_DRAWABLE,
+                              gimp_item_get_image (GIMP_ITEM (drawable)),
+                              GIMP_ITEM (drawable),
+                              0, 0);
+}
+
+/*  'buffer' was allocated for the projection of 'projectable'  */
+void
+gimp_tile_profile_add_projection (GimpProjectable *projectable,
+                                  GeglBuffer      *buffer)
+{
+  g_return_if_fail (GIMP_IS_PROJECTABLE (projectable));
+  g_return_if_fail (GEGL_IS_BUFFER (buffer));
+
+  if (! gimp_tile_profile_is_enabled ())
+    return;
+
+  if (GIMP_IS_IMAGE (projectable))
+    {
+      gimp_tile_profile_register (buffer, GIMP_TILE_PROFILE_PROJECTION,
+                                  GIMP_IMAGE (projectable), NULL,
+                                  0, 0);
+    }
+  else if (GIMP_IS_ITEM (projectable))
+    {
+      gimp_tile_profile_register (buffer, GIMP_TILE_PROFILE_PROJECTION,
+                                  gimp_item_get_image (GIMP_ITEM (projectable)),
+                                  GIMP_ITEM (projectable),
+                                  0, 0);
+    }
+}
+
+/*  'buffer' holds the pixels of an undo step of 'image', at 'offset_x',
+ *  'offset_y' of the image
+ */
+void
+gimp_tile_profile_add_undo (GimpImage  *image,
+                            GeglBuffer *buffer,
+                            gint        offset_x,
+                            gint        offset_y)
+{
+  g_return_if_fail (GIMP_IS_IMAGE (image));
+  g_return_if_fail (GEGL_IS_BUFFER (buffer));
+
+  if (! gimp_tile_profile_is_enabled ())
+    return;
+
+  gimp_tile_profile_register (buffer, GIMP_TILE_PROFILE_UNDO,
+                              image, NULL,
+                              offset_x, offset_y);
+}
+
+/*  returns a newly allocated array of the GimpTileProfileTile of each
+ *  tile of 'image' fetched while not cached
+ */
+GArray *
+gimp_tile_profile_get_heat_map (GimpImage *image)
+{
+  GArray         *tiles;
+  GHashTableIter  iter;
+  Entry          *entry;
+  gint            image_id;
+
+  g_return_val_if_fail (GIMP_IS_IMAGE (image), NULL);
+
+  tiles = g_array_new (FALSE, FALSE, sizeof (GimpTileProfileTile));
+
+  image_id = gimp_image_get_id (image);
+
+  G_LOCK (tile_profile);
+
+  if (! gimp_tile_profile_entries)
+    {
+      G_UNLOCK (tile_profile);
+
+      return tiles;
+    }
+
+  g_hash_table_iter_init (&iter, gimp_tile_profile_entries);
+
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &entry))
+    {
+      GArray *counts;
+      gint    offset_x = entry->offset_x;
+      gint    offset_y = entry->offset_y;
+      gint    i;
+
+      if (entry->image_id != image_id)
+        continue;
+
+      if (entry->item_id)
+        {
+          GimpItem *item = gimp_item_get_by_id (gimp_tile_profile_gimp,
+                                                entry->item_id);
+          gint      item_x;
+          gint      item_y;
+
+          if (! item)
+            continue;
+
+          gimp_item_get_offset (item, &item_x, &item_y);
+
+          offset_x += item_x;
+          offset_y += item_y;
+        }
+
+      counts = gimp_tile_handler_profile_get_counts (entry->handler);
+
+      for (i = 0; i < counts->len; i++)
+        {
+          const GimpTileProfileCount *count;
+          GimpTileProfileTile         tile;
+
+          count = &g_array_index (counts, GimpTileProfileCount, i);
+
+          /*  tiles of mipmap level 'z' cover 2^z times the pixels  */
+          tile.rect.width  = entry->handler->tile_width  << count->z;
+          tile.rect.height = entry->handler->tile_height << count->z;
+          tile.rect.x      = count->x * tile.rect.width  + offset_x;
+          tile.rect.y      = count->y * tile.rect.height + offset_y;
+          tile.owner       = entry->owner;
+          tile.misses      = count->misses;
+          tile.reads       = count->reads;
+
+          g_array_append_val (tiles, tile);
+        }
+
+      g_array_free (counts, TRUE);
+    }
+
+  G_UNLOCK (tile_profile);
+
+  return tiles;
+}
+
+/*  forgets the counts so far  */
+void
+gimp_tile_profile_reset (void)
+{
+  GHashTableIter  iter;
+  Entry          *entry;
+
+  G_LOCK (tile_profile);
+
+  if (gimp_tile_profile_entries)
+    {
+      g_hash_table_iter_init (&iter, gimp_tile_profile_entries);
+
+      while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &entry))
+        gimp_tile_handler_profile_reset (entry->handler);
+    }
+
+  G_UNLOCK (tile_profile);
+}
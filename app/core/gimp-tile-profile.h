@@ -0,0 +1,54 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-tile-profile.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+typedef enum
+{
+  GIMP_TILE_PROFILE_DRAWABLE,    /*  layer and channel buffers         */
+  GIMP_TILE_PROFILE_PROJECTION,  /*  image and layer group projections */
+  GIMP_TILE_PROFILE_UNDO,        /*  drawable undo buffers             */
+
+  GIMP_TILE_PROFILE_N_OWNERS
+} GimpTileProfileOwner;
+
+typedef struct
+{
+  GeglRectangle        rect;     /*  in image coordinates  */
+  GimpTileProfileOwner owner;
+  gint                 misses;
+  gint                 reads;
+} GimpTileProfileTile;
+
+
+void       gimp_tile_profile_enable         (Gimp            *gimp);
+void       gimp_tile_profile_disable        (void);
+gboolean   gimp_tile_profile_is_enabled     (void);
+
+void       gimp_tile_profile_add_drawable   (GimpDrawable    *drawable);
+void       gimp_tile_profile_add_projection (GimpProjectable *projectable,
+                                             GeglBuffer      *buffer);
+void       gimp_tile_profile_add_undo       (GimpImage       *image,
+                                             GeglBuffer      *buffer,
+                                             gint             offset_x,
+                                             gint             offset_y);
+
+GArray   * gimp_tile_profile_get_heat_map   (GimpImage       *image);
+void       gimp_tile_profile_reset          (void);
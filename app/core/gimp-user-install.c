@@ -1392,6 +1392,7 @@ user_install_migrate_files (GimpUserInstall *install)
           if (strcmp (basename, "documents") == 0      ||
               g_str_has_prefix (basename, "gimpswap.") ||
               strcmp (basename, "pluginrc") == 0       ||
+              strcmp (basename, "pluginrc.cache") == 0 ||
               strcmp (basename, "themerc") == 0        ||
               strcmp (basename, "gtkrc") == 0)
             {
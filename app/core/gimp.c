@@ -50,10 +50,13 @@
 #include "gimp-filter-history.h"
 #include "gimp-memsize.h"
 #include "gimp-modules.h"
+#include "gimp-parallel.h"
 #include "gimp-parasites.h"
+#include "gimp-startup-profile.h"
 #include "gimp-templates.h"
 #include "gimp-units.h"
 #include "gimp-utils.h"
+#include "gimpasync.h"
 #include "gimpbrush.h"
 #include "gimpbrushgenerated.h"
 #include "gimpbuffer.h"
@@ -75,6 +78,7 @@
 #include "gimptemplate.h"
 #include "gimptoolinfo.h"
 #include "gimptreeproxy.h"
+#include "gimpwaitable.h"
 
 #include "text/gimpfont.h"
 
@@ -124,6 +128,8 @@ static gint64    gimp_get_memsize                    (GimpObject        *object,
 
 static void      gimp_real_initialize                (Gimp              *gimp,
                                                       GimpInitStatusFunc status_callback);
+static void      gimp_restore_fishes_async           (GimpAsync         *async,
+                                                      gpointer           data);
 static void      gimp_real_restore                   (Gimp              *gimp,
                                                       GimpInitStatusFunc status_callback);
 static gboolean  gimp_real_exit                      (Gimp              *gimp,
@@ -231,6 +237,7 @@ gimp_init (Gimp *gimp)
   gimp->be_verbose       = FALSE;
   gimp->no_data          = FALSE;
   gimp->no_interface     = FALSE;
+  gimp->core_only        = FALSE;
   gimp->show_gui         = TRUE;
   gimp->use_shm          = FALSE;
   gimp->use_cpu_accel    = TRUE;
@@ -556,19 +563,32 @@ gimp_real_initialize (Gimp               *gimp,
   status_callback (NULL, "", 1.0);
 }
 
+static void
+gimp_restore_fishes_async (GimpAsync *async,
+                           gpointer   data)
+{
+  gint64 profile_time = gimp_startup_profile_begin ();
+
+  gimp_babl_init_fishes (NULL);
+
+  gimp_startup_profile_end ("Babl fishes", profile_time);
+
+  gimp_async_finish (async, NULL);
+}
+
 static void
 gimp_real_restore (Gimp               *gimp,
                    GimpInitStatusFunc  status_callback)
 {
+  gint64 profile_time;
+
   if (gimp->be_verbose)
     g_print ("INIT: %s\n", G_STRFUNC);
 
+  profile_time = gimp_startup_profile_begin ();
   gimp_plug_in_manager_restore (gimp->plug_in_manager,
                                 gimp_get_user_context (gimp), status_callback);
-
-  /*  initialize babl fishes  */
-  status_callback (_("Initialization"), "Babl Fishes", 0.0);
-  gimp_babl_init_fishes (status_callback);
+  gimp_startup_profile_end ("Plug-ins", profile_time);
 
   gimp->restored = TRUE;
 }
@@ -586,7 +606,9 @@ gimp_real_exit (Gimp     *gimp,
 
   gimp_data_factories_save (gimp);
 
-  gimp_templates_save (gimp);
+  /*  the core only didn't load them  */
+  if (! gimp->core_only)
+    gimp_templates_save (gimp);
   gimp_parasiterc_save (gimp);
   gimp_unitrc_save (gimp);
 
@@ -601,6 +623,7 @@ gimp_new (const gchar       *name,
           gboolean           no_data,
           gboolean           no_fonts,
           gboolean           no_interface,
+          gboolean           core_only,
           gboolean           use_shm,
           gboolean           use_cpu_accel,
           gboolean           console_messages,
@@ -625,6 +648,7 @@ gimp_new (const gchar       *name,
   gimp->no_data          = no_data          ? TRUE : FALSE;
   gimp->no_fonts         = no_fonts         ? TRUE : FALSE;
   gimp->no_interface     = no_interface     ? TRUE : FALSE;
+  gimp->core_only        = core_only        ? TRUE : FALSE;
   gimp->use_shm          = use_shm          ? TRUE : FALSE;
   gimp->use_cpu_accel    = use_cpu_accel    ? TRUE : FALSE;
   gimp->console_messages = console_messages ? TRUE : FALSE;
@@ -840,29 +864,72 @@ gimp_restore (Gimp                *gimp,
               GimpInitStatusFunc   status_callback,
               GError             **error)
 {
+  GimpAsync *fishes       = NULL;
+  gint64     profile_time;
+
   g_return_if_fail (GIMP_IS_GIMP (gimp));
   g_return_if_fail (status_callback != NULL);
 
   if (gimp->be_verbose)
     g_print ("INIT: %s\n", G_STRFUNC);
 
+  /*  the restore phases, and what they need:
+   *
+   *    babl fishes    only babl, run in the background meanwhile
+   *    parasites      -
+   *    data           the user context; fonts load in the background
+   *    templates      -
+   *    modules        -
+   *    plug-ins       parasites, data (through the PDB), modules
+   *
+   *  the phases which touch GIMP's objects run in that order on the main
+   *  thread, the data factories distribute their own loading across
+   *  threads.
+   *
+   *  the core only skips the fishes and the templates, which only serve
+   *  the user interface, or are initialized lazily anyway.
+   */
+  if (! gimp->core_only)
+    fishes = gimp_parallel_run_async_independent (gimp_restore_fishes_async,
+                                                  NULL);
+
   /*  initialize  the global parasite table  */
   status_callback (_("Looking for data files"), _("Parasites"), 0.0);
+  profile_time = gimp_startup_profile_begin ();
   gimp_parasiterc_load (gimp);
+  gimp_startup_profile_end ("Parasites", profile_time);
 
   /*  initialize the lists of gimp brushes, dynamics, patterns etc.  */
+  profile_time = gimp_startup_profile_begin ();
   gimp_data_factories_load (gimp, status_callback);
+  gimp_startup_profile_end ("Data", profile_time);
 
   /*  initialize the template list  */
-  status_callback (NULL, _("Templates"), 0.8);
-  gimp_templates_load (gimp);
+  if (! gimp->core_only)
+    {
+      status_callback (NULL, _("Templates"), 0.8);
+      profile_time = gimp_startup_profile_begin ();
+      gimp_templates_load (gimp);
+      gimp_startup_profile_end ("Templates", profile_time);
+    }
 
   /*  initialize the module list  */
   status_callback (NULL, _("Modules"), 0.9);
+  profile_time = gimp_startup_profile_begin ();
   gimp_modules_load (gimp);
+  gimp_startup_profile_end ("Modules", profile_time);
 
   g_signal_emit (gimp, gimp_signals[RESTORE], 0, status_callback);
 
+  /*  the fishes only avoid a lazy initialization cost later, nothing
+   *  depends on them, but don't leave startup with the thread running
+   */
+  if (fishes)
+    {
+      gimp_waitable_wait (GIMP_WAITABLE (fishes));
+      g_object_unref (fishes);
+    }
+
   /* when done, make sure everything is clean, to clean out dirty
    * states from data objects which reference each other and got
    * dirtied by loading the referenced object
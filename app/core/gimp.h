@@ -47,6 +47,7 @@ struct _Gimp
   gboolean                no_data;
   gboolean                no_fonts;
   gboolean                no_interface;
+  gboolean                core_only;
   gboolean                show_gui;
   gboolean                use_shm;
   gboolean                use_cpu_accel;
@@ -165,6 +166,7 @@ Gimp         * gimp_new                    (const gchar         *name,
                                             gboolean             no_data,
                                             gboolean             no_fonts,
                                             gboolean             no_interface,
+                                            gboolean             core_only,
                                             gboolean             use_shm,
                                             gboolean             use_cpu_accel,
                                             gboolean             console_messages,
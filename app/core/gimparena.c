@@ -0,0 +1,177 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimparena.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib-object.h>
+
+#include "core-types.h"
+
+#include "gimparena.h"
+
+
+/*  the alignment of all allocations  */
+#define ALIGNMENT          16
+
+/*  the size of the first block, if not specified  */
+#define DEFAULT_BLOCK_SIZE 4096
+
+/*  each new block is twice as big as the previous one, up to this  */
+#define MAX_BLOCK_SIZE     (4 << 20)
+
+
+typedef struct _ArenaBlock ArenaBlock;
+
+struct _ArenaBlock
+{
+  ArenaBlock *next;
+};
+
+G_STATIC_ASSERT (sizeof (ArenaBlock) <= ALIGNMENT);
+
+struct _GimpArena
+{
+  ArenaBlock *blocks;
+  guchar     *ptr;
+  gsize       left;
+  gsize       block_size;
+};
+
+
+/*  local function prototypes  */
+
+static gpointer   gimp_arena_add_block (GimpArena *arena,
+                                        gsize      size);
+
+
+/*  public functions  */
+
+/*  creates a bump allocator for the transient data of a single
+ *  operation.  its allocations can't be freed individually; they are
+ *  all freed at once by gimp_arena_free().
+ *
+ *  an arena may only be used by one thread at a time.
+ */
+GimpArena *
+gimp_arena_new (gsize block_size)
+{
+  GimpArena *arena = g_slice_new0 (GimpArena);
+
+  arena->block_size = block_size ? block_size : DEFAULT_BLOCK_SIZE;
+
+  return arena;
+}
+
+void
+gimp_arena_free (GimpArena *arena)
+{
+  g_return_if_fail (arena != NULL);
+
+  while (arena->blocks)
+    {
+      ArenaBlock *block = arena->blocks;
+
+      arena->blocks = block->next;
+
+      g_free (block);
+    }
+
+  g_slice_free (GimpArena, arena);
+}
+
+gpointer
+gimp_arena_alloc (GimpArena *arena,
+                  gsize      size)
+{
+  gpointer ptr;
+
+  g_return_val_if_fail (arena != NULL, NULL);
+
+  size = (size + ALIGNMENT - 1) & ~(gsize) (ALIGNMENT - 1);
+
+  if (size > arena->left)
+    return gimp_arena_add_block (arena, size);
+
+  ptr = arena->ptr;
+
+  arena->ptr  += size;
+  arena->left -= size;
+
+  return ptr;
+}
+
+gpointer
+gimp_arena_alloc0 (GimpArena *arena,
+                   gsize      size)
+{
+  gpointer ptr = gimp_arena_alloc (arena, size);
+
+  if (ptr)
+    memset (ptr, 0, size);
+
+  return ptr;
+}
+
+
+/*  private functions  */
+
+static gpointer
+gimp_arena_add_block (GimpArena *arena,
+                      gsize      size)
+{
+  ArenaBlock *block;
+  guchar     *ptr;
+
+  /*  allocations bigger than a block get a dedicated block, which
+   *  doesn't replace the current one
+   */
+  if (size > arena->block_size)
+    {
+      block = g_malloc (ALIGNMENT + size);
+
+      if (arena->blocks)
+        {
+          block->next         = arena->blocks->next;
+          arena->blocks->next = block;
+        }
+      else
+        {
+          block->next   = NULL;
+          arena->blocks = block;
+        }
+
+      return (guchar *) block + ALIGNMENT;
+    }
+
+  block = g_malloc (ALIGNMENT + arena->block_size);
+
+  block->next   = arena->blocks;
+  arena->blocks = block;
+
+  ptr = (guchar *) block + ALIGNMENT;
+
+  arena->ptr  = ptr + size;
+  arena->left = arena->block_size - size;
+
+  arena->block_size = MIN (2 * arena->block_size, MAX_BLOCK_SIZE);
+
+  return ptr;
+}
@@ -0,0 +1,33 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimparena.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+GimpArena * gimp_arena_new    (gsize      block_size);
+void        gimp_arena_free   (GimpArena *arena);
+
+gpointer    gimp_arena_alloc  (GimpArena *arena,
+                               gsize      size);
+gpointer    gimp_arena_alloc0 (GimpArena *arena,
+                               gsize      size);
+
+
+#define gimp_arena_new_n(arena, type, n) \
+  ((type *) gimp_arena_alloc ((arena), sizeof (type) * (n)))
@@ -26,32 +26,67 @@
 
 #include "core-types.h"
 
+#include "gimparena.h"
 #include "gimpboundary.h"
 
 
-/* GimpBoundSeg array growth parameter */
-#define MAX_SEGS_INC  2048
+/* the number of GimpBoundSegs in the first chunk; each following chunk
+ * is twice as big
+ */
+#define MIN_CHUNK_SEGS  2048
+
+#define PIXELS_PER_THREAD \
+  (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
 
 
 typedef struct _GimpBoundary GimpBoundary;
+typedef struct _SegChunk     SegChunk;
 
-struct _GimpBoundary
+struct _SegChunk
 {
-  /*  The array of segments  */
+  SegChunk     *next;
   GimpBoundSeg *segs;
   gint          num_segs;
   gint          max_segs;
+};
+
+struct _GimpBoundary
+{
+  /*  All the temporary data of the boundary, freed at once  */
+  GimpArena    *arena;
+
+  /*  The segments, in a list of chunks, which are only copied to a
+   *  single array when returned
+   */
+  SegChunk     *first_chunk;
+  SegChunk     *last_chunk;
+  gint          num_segs;
 
   /*  The array of vertical segments  */
   gint         *vert_segs;
-
-  /*  The empty segment arrays */
-  gint         *empty_segs_n;
-  gint         *empty_segs_c;
-  gint         *empty_segs_l;
-  gint          max_empty_segs;
 };
 
+/*  The arguments of the parallel search for horizontal segments  */
+typedef struct
+{
+  GeglBuffer          *buffer;
+  const GeglRectangle *region;
+  const Babl          *format;
+  GimpBoundaryType     type;
+  gint                 x1;
+  gint                 y1;
+  gint                 x2;
+  gint                 y2;
+  gfloat               threshold;
+
+  /*  The range of scanlines  */
+  gint                 start;
+  gint                 end;
+
+  /*  The horizontal segments of each band, at the band's offset  */
+  GArray             **band_segs;
+} BoundaryBands;
+
 
 /*  local function prototypes  */
 
@@ -84,7 +119,16 @@ static void           process_horiz_seg        (GimpBoundary        *boundary,
                                                 gint                 x2,
                                                 gint                 y2,
                                                 gboolean             open);
-static void           make_horiz_segs          (GimpBoundary        *boundary,
+static void           find_scanline_segs       (const BoundaryBands *bands,
+                                                gint                 scanline,
+                                                gfloat              *line_data,
+                                                gint                 empty_segs[],
+                                                gint                 max_empty,
+                                                gint                *num_empty);
+static void           find_band_segs           (gsize                offset,
+                                                gsize                size,
+                                                BoundaryBands       *bands);
+static void           make_horiz_segs          (GArray              *segs,
                                                 gint                 start,
                                                 gint                 end,
                                                 gint                 scanline,
@@ -225,11 +269,15 @@ gimp_boundary_sort (const GimpBoundSeg *segs,
   if (num_segs == 0)
     return NULL;
 
+  boundary = gimp_boundary_new (NULL);
+
   /* prepare arrays with GimpBoundSeg pointers sorted by xy1 and xy2
    * accordingly
    */
-  segs_ptrs_by_xy1 = g_new (const GimpBoundSeg *, num_segs);
-  segs_ptrs_by_xy2 = g_new (const GimpBoundSeg *, num_segs);
+  segs_ptrs_by_xy1 = gimp_arena_new_n (boundary->arena,
+                                       const GimpBoundSeg *, num_segs);
+  segs_ptrs_by_xy2 = gimp_arena_new_n (boundary->arena,
+                                       const GimpBoundSeg *, num_segs);
 
   for (index = 0; index < num_segs; index++)
     {
@@ -245,8 +293,6 @@ gimp_boundary_sort (const GimpBoundSeg *segs,
   for (index = 0; index < num_segs; index++)
     ((GimpBoundSeg *) segs)[index].visited = FALSE;
 
-  boundary = gimp_boundary_new (NULL);
-
   for (index = 0; index < num_segs; index++)
     {
       const GimpBoundSeg *cur_seg;
@@ -300,9 +346,6 @@ gimp_boundary_sort (const GimpBoundSeg *segs,
       gimp_boundary_add_seg (boundary, -1, -1, -1, -1, 0);
   }
 
-  g_free (segs_ptrs_by_xy1);
-  g_free (segs_ptrs_by_xy2);
-
   return gimp_boundary_free (boundary, FALSE);
 }
 
@@ -324,6 +367,7 @@ gimp_boundary_simplify (GimpBoundSeg *sorted_segs,
                         gint         *num_segs)
 {
   GArray *new_bounds;
+  GArray *tmp_points;
   gint    i, seg;
 
   g_return_val_if_fail ((sorted_segs == NULL && num_groups == 0) ||
@@ -332,6 +376,9 @@ gimp_boundary_simplify (GimpBoundSeg *sorted_segs,
 
   new_bounds = g_array_new (FALSE, FALSE, sizeof (GimpBoundSeg));
 
+  /*  reused by all the groups  */
+  tmp_points = g_array_new (FALSE, FALSE, sizeof (gint));
+
   seg = 0;
 
   for (i = 0; i < num_groups; i++)
@@ -350,11 +397,10 @@ gimp_boundary_simplify (GimpBoundSeg *sorted_segs,
 
       if (n_points > 0)
         {
-          GArray   *tmp_points;
           GimpBoundSeg  tmp_seg;
-          gint      j;
+          gint          j;
 
-          tmp_points = g_array_new (FALSE, FALSE, sizeof (gint));
+          g_array_set_size (tmp_points, 0);
 
           /* temporarily use the delimiter to close the polygon */
           tmp_seg = sorted_segs[seg];
@@ -369,13 +415,13 @@ gimp_boundary_simplify (GimpBoundSeg *sorted_segs,
                                                            gint, j)]);
 
           g_array_append_val (new_bounds, sorted_segs[seg]);
-
-          g_array_free (tmp_points, TRUE);
         }
 
       seg++;
     }
 
+  g_array_free (tmp_points, TRUE);
+
   *num_segs = new_bounds->len;
 
   return (GimpBoundSeg *) g_array_free (new_bounds, FALSE);
@@ -416,6 +462,8 @@ gimp_boundary_new (const GeglRectangle *region)
 {
   GimpBoundary *boundary = g_slice_new0 (GimpBoundary);
 
+  boundary->arena = gimp_arena_new (0);
+
   if (region)
     {
       gint i;
@@ -423,19 +471,11 @@ gimp_boundary_new (const GeglRectangle *region)
       /*  array for determining the vertical line segments
        *  which must be drawn
        */
-      boundary->vert_segs = g_new (gint, region->width + region->x + 1);
+      boundary->vert_segs = gimp_arena_new_n (boundary->arena, gint,
+                                              region->width + region->x + 1);
 
       for (i = 0; i <= (region->width + region->x); i++)
         boundary->vert_segs[i] = -1;
-
-      /*  find the maximum possible number of empty segments
-       *  given the current mask
-       */
-      boundary->max_empty_segs = region->width + 3;
-
-      boundary->empty_segs_n = g_new (gint, boundary->max_empty_segs);
-      boundary->empty_segs_c = g_new (gint, boundary->max_empty_segs);
-      boundary->empty_segs_l = g_new (gint, boundary->max_empty_segs);
     }
 
   return boundary;
@@ -447,15 +487,22 @@ gimp_boundary_free (GimpBoundary *boundary,
 {
   GimpBoundSeg *segs = NULL;
 
-  if (free_segs)
-    g_free (boundary->segs);
-  else
-    segs = boundary->segs;
+  if (! free_segs && boundary->num_segs > 0)
+    {
+      SegChunk     *chunk;
+      GimpBoundSeg *dest;
+
+      segs = dest = g_new (GimpBoundSeg, boundary->num_segs);
 
-  g_free (boundary->vert_segs);
-  g_free (boundary->empty_segs_n);
-  g_free (boundary->empty_segs_c);
-  g_free (boundary->empty_segs_l);
+      for (chunk = boundary->first_chunk; chunk; chunk = chunk->next)
+        {
+          memcpy (dest, chunk->segs, chunk->num_segs * sizeof (GimpBoundSeg));
+
+          dest += chunk->num_segs;
+        }
+    }
+
+  gimp_arena_free (boundary->arena);
 
   g_slice_free (GimpBoundary, boundary);
 
@@ -470,20 +517,37 @@ gimp_boundary_add_seg (GimpBoundary *boundary,
                        gint          y2,
                        gboolean      open)
 {
-  if (boundary->num_segs >= boundary->max_segs)
+  SegChunk     *chunk = boundary->last_chunk;
+  GimpBoundSeg *seg;
+
+  if (! chunk || chunk->num_segs == chunk->max_segs)
     {
-      boundary->max_segs += MAX_SEGS_INC;
+      chunk = gimp_arena_new_n (boundary->arena, SegChunk, 1);
+
+      chunk->next     = NULL;
+      chunk->num_segs = 0;
+      chunk->max_segs = boundary->last_chunk ?
+                        2 * boundary->last_chunk->max_segs : MIN_CHUNK_SEGS;
+      chunk->segs     = gimp_arena_new_n (boundary->arena,
+                                          GimpBoundSeg, chunk->max_segs);
 
-      boundary->segs = g_renew (GimpBoundSeg, boundary->segs, boundary->max_segs);
+      if (boundary->last_chunk)
+        boundary->last_chunk->next = chunk;
+      else
+        boundary->first_chunk = chunk;
+
+      boundary->last_chunk = chunk;
     }
 
-  boundary->segs[boundary->num_segs].x1   = x1;
-  boundary->segs[boundary->num_segs].y1   = y1;
-  boundary->segs[boundary->num_segs].x2   = x2;
-  boundary->segs[boundary->num_segs].y2   = y2;
-  boundary->segs[boundary->num_segs].open = open;
+  seg = &chunk->segs[chunk->num_segs++];
 
-  boundary->num_segs ++;
+  seg->x1   = x1;
+  seg->y1   = y1;
+  seg->x2   = x2;
+  seg->y2   = y2;
+  seg->open = open;
+
+  boundary->num_segs++;
 }
 
 static void
@@ -632,37 +696,160 @@ process_horiz_seg (GimpBoundary *boundary,
 }
 
 static void
-make_horiz_segs (GimpBoundary *boundary,
-                 gint          start,
-                 gint          end,
-                 gint          scanline,
-                 gint          empty[],
-                 gint          num_empty,
-                 gint          top)
+make_horiz_segs (GArray *segs,
+                 gint    start,
+                 gint    end,
+                 gint    scanline,
+                 gint    empty[],
+                 gint    num_empty,
+                 gint    top)
 {
   gint empty_index;
   gint e_s, e_e;    /* empty segment start and end values */
 
   for (empty_index = 0; empty_index < num_empty; empty_index += 2)
     {
+      GimpBoundSeg seg = { 0, };
+
       e_s = *empty++;
       e_e = *empty++;
 
       if (e_s <= start && e_e >= end)
         {
-          process_horiz_seg (boundary,
-                             start, scanline, end, scanline, top);
+          seg.x1 = start;
+          seg.x2 = end;
         }
       else if ((e_s > start && e_s < end) ||
                (e_e < end && e_e > start))
         {
-          process_horiz_seg (boundary,
-                             MAX (e_s, start), scanline,
-                             MIN (e_e, end), scanline, top);
+          seg.x1 = MAX (e_s, start);
+          seg.x2 = MIN (e_e, end);
         }
+      else
+        {
+          continue;
+        }
+
+      seg.y1   = scanline;
+      seg.y2   = scanline;
+      seg.open = top;
+
+      g_array_append_val (segs, seg);
     }
 }
 
+/*  Find the empty segments of a scanline, which is a run-length encoding
+ *  of the scanline's mask.  Scanlines outside the processed range are
+ *  never read, and are treated as empty by find_empty_segs().
+ */
+static void
+find_scanline_segs (const BoundaryBands *bands,
+                    gint                 scanline,
+                    gfloat              *line_data,
+                    gint                 empty_segs[],
+                    gint                 max_empty,
+                    gint                *num_empty)
+{
+  if (scanline >= bands->start && scanline < bands->end)
+    {
+      gegl_buffer_get (bands->buffer,
+                       GEGL_RECTANGLE (0, scanline,
+                                       gegl_buffer_get_width (bands->buffer),
+                                       1),
+                       1.0, bands->format,
+                       line_data, GEGL_AUTO_ROWSTRIDE,
+                       GEGL_ABYSS_NONE);
+    }
+  else
+    {
+      line_data = NULL;
+    }
+
+  find_empty_segs (bands->region, line_data,
+                   scanline, empty_segs,
+                   max_empty, num_empty,
+                   bands->type,
+                   bands->x1, bands->y1, bands->x2, bands->y2,
+                   bands->threshold);
+}
+
+/*  Find the horizontal segments of a band of scanlines.  Each scanline's
+ *  segments only depend on the scanline and its two neighbors, so that
+ *  bands can be processed independently, reading one more scanline on
+ *  each side.
+ */
+static void
+find_band_segs (gsize          offset,
+                gsize          size,
+                BoundaryBands *bands)
+{
+  GArray *segs;
+  gfloat *line_data;
+  gint   *empty_segs_l;
+  gint   *empty_segs_c;
+  gint   *empty_segs_n;
+  gint   *tmp_segs;
+  /*  the maximum possible number of empty segments of a scanline  */
+  gint    max_empty_segs = bands->region->width + 3;
+  gint    num_empty_n    = 0;
+  gint    num_empty_c    = 0;
+  gint    num_empty_l    = 0;
+  gint    start          = bands->start + offset;
+  gint    end            = start + size;
+  gint    scanline;
+  gint    i;
+
+  segs = g_array_new (FALSE, FALSE, sizeof (GimpBoundSeg));
+
+  line_data    = g_new (gfloat, gegl_buffer_get_width (bands->buffer));
+  empty_segs_l = g_new (gint, max_empty_segs);
+  empty_segs_c = g_new (gint, max_empty_segs);
+  empty_segs_n = g_new (gint, max_empty_segs);
+
+  /*  Find the empty segments for the previous and current scanlines  */
+  find_scanline_segs (bands, start - 1, line_data,
+                      empty_segs_l, max_empty_segs, &num_empty_l);
+  find_scanline_segs (bands, start, line_data,
+                      empty_segs_c, max_empty_segs, &num_empty_c);
+
+  for (scanline = start; scanline < end; scanline++)
+    {
+      /*  find the empty segment list for the next scanline  */
+      find_scanline_segs (bands, scanline + 1, line_data,
+                          empty_segs_n, max_empty_segs, &num_empty_n);
+
+      /*  process the segments on the current scanline  */
+      for (i = 1; i < num_empty_c - 1; i += 2)
+        {
+          make_horiz_segs (segs,
+                           empty_segs_c [i],
+                           empty_segs_c [i+1],
+                           scanline,
+                           empty_segs_l, num_empty_l, 1);
+          make_horiz_segs (segs,
+                           empty_segs_c [i],
+                           empty_segs_c [i+1],
+                           scanline + 1,
+                           empty_segs_n, num_empty_n, 0);
+        }
+
+      /*  get the next scanline of empty segments, swap others  */
+      tmp_segs     = empty_segs_l;
+      empty_segs_l = empty_segs_c;
+      num_empty_l  = num_empty_c;
+      empty_segs_c = empty_segs_n;
+      num_empty_c  = num_empty_n;
+      empty_segs_n = tmp_segs;
+    }
+
+  g_free (line_data);
+  g_free (empty_segs_l);
+  g_free (empty_segs_c);
+  g_free (empty_segs_n);
+
+  bands->band_segs[offset] = segs;
+}
+
 static GimpBoundary *
 generate_boundary (GeglBuffer          *buffer,
                    const GeglRectangle *region,
@@ -675,97 +862,73 @@ generate_boundary (GeglBuffer          *buffer,
                    gfloat               threshold)
 {
   GimpBoundary  *boundary;
-  GeglRectangle  line_rect = { 0, };
-  gfloat        *line_data;
-  gint           scanline;
+  BoundaryBands  bands;
+  gint           n_scanlines;
   gint           i;
-  gint           start, end;
-  gint          *tmp_segs;
-
-  gint          num_empty_n = 0;
-  gint          num_empty_c = 0;
-  gint          num_empty_l = 0;
 
   boundary = gimp_boundary_new (region);
 
-  line_rect.width  = gegl_buffer_get_width (buffer);
-  line_rect.height = 1;
-
-  line_data = g_alloca (sizeof (gfloat) * line_rect.width);
-
-  start = 0;
-  end   = 0;
+  bands.buffer    = buffer;
+  bands.region    = region;
+  bands.format    = format;
+  bands.type      = type;
+  bands.x1        = x1;
+  bands.y1        = y1;
+  bands.x2        = x2;
+  bands.y2        = y2;
+  bands.threshold = threshold;
+  bands.start     = 0;
+  bands.end       = 0;
 
   if (type == GIMP_BOUNDARY_WITHIN_BOUNDS)
     {
-      start = y1;
-      end   = y2;
+      bands.start = y1;
+      bands.end   = y2;
     }
   else if (type == GIMP_BOUNDARY_IGNORE_BOUNDS)
     {
-      start = region->y;
-      end   = region->y + region->height;
+      bands.start = region->y;
+      bands.end   = region->y + region->height;
     }
 
-  /*  Find the empty segments for the previous and current scanlines  */
-  find_empty_segs (region, NULL,
-                   start - 1, boundary->empty_segs_l,
-                   boundary->max_empty_segs, &num_empty_l,
-                   type, x1, y1, x2, y2,
-                   threshold);
-
-  line_rect.y = start;
-  gegl_buffer_get (buffer, &line_rect, 1.0, format,
-                   line_data, GEGL_AUTO_ROWSTRIDE,
-                   GEGL_ABYSS_NONE);
-
-  find_empty_segs (region, line_data,
-                   start, boundary->empty_segs_c,
-                   boundary->max_empty_segs, &num_empty_c,
-                   type, x1, y1, x2, y2,
-                   threshold);
+  n_scanlines = bands.end - bands.start;
 
-  for (scanline = start; scanline < end; scanline++)
+  if (n_scanlines <= 0)
+    return boundary;
+
+  bands.band_segs = g_new0 (GArray *, n_scanlines);
+
+  /*  find the horizontal segments in parallel...  */
+  gegl_parallel_distribute_range (
+    n_scanlines,
+    MAX (PIXELS_PER_THREAD / MAX (region->width, 1), 1),
+    (GeglParallelDistributeRangeFunc) find_band_segs,
+    &bands);
+
+  /*  ...and add them in order, along with the vertical segments closing
+   *  them in, which connect segments across bands
+   */
+  for (i = 0; i < n_scanlines; i++)
     {
-      /*  find the empty segment list for the next scanline  */
-      line_rect.y = scanline + 1;
-      if (scanline + 1 == end)
-        line_data = NULL;
-      else
-        gegl_buffer_get (buffer, &line_rect, 1.0, format,
-                         line_data, GEGL_AUTO_ROWSTRIDE,
-                         GEGL_ABYSS_NONE);
+      GArray *segs = bands.band_segs[i];
+      gint    j;
 
-      find_empty_segs (region, line_data,
-                       scanline + 1, boundary->empty_segs_n,
-                       boundary->max_empty_segs, &num_empty_n,
-                       type, x1, y1, x2, y2,
-                       threshold);
+      if (! segs)
+        continue;
 
-      /*  process the segments on the current scanline  */
-      for (i = 1; i < num_empty_c - 1; i += 2)
+      for (j = 0; j < segs->len; j++)
         {
-          make_horiz_segs (boundary,
-                           boundary->empty_segs_c [i],
-                           boundary->empty_segs_c [i+1],
-                           scanline,
-                           boundary->empty_segs_l, num_empty_l, 1);
-          make_horiz_segs (boundary,
-                           boundary->empty_segs_c [i],
-                           boundary->empty_segs_c [i+1],
-                           scanline + 1,
-                           boundary->empty_segs_n, num_empty_n, 0);
+          const GimpBoundSeg *seg = &g_array_index (segs, GimpBoundSeg, j);
+
+          process_horiz_seg (boundary,
+                             seg->x1, seg->y1, seg->x2, seg->y2, seg->open);
         }
 
-      /*  get the next scanline of empty segments, swap others  */
-      tmp_segs               = boundary->empty_segs_l;
-      boundary->empty_segs_l = boundary->empty_segs_c;
-      num_empty_l            = num_empty_c;
-      boundary->empty_segs_c = boundary->empty_segs_n;
-      num_empty_c            = num_empty_n;
-      boundary->empty_segs_n = tmp_segs;
+      g_array_free (segs, TRUE);
     }
 
+  g_free (bands.band_segs);
+
   return boundary;
 }
 
@@ -88,6 +88,16 @@ static GimpBrush * gimp_brush_load_abr_brush_v6  (GDataInputStream  *input,
                                                   gint               index,
                                                   GFile             *file,
                                                   GError           **error);
+static GimpBrush * gimp_brush_new_lazy           (const gchar       *name,
+                                                  gint               width,
+                                                  gint               height,
+                                                  gint               spacing);
+static gboolean    gimp_brush_load_header        (GFile             *file,
+                                                  GInputStream      *input,
+                                                  GimpBrushHeader   *header,
+                                                  gchar            **name,
+                                                  GError           **error);
+
 static gboolean    abr_supported                 (AbrHeader         *abr_hdr,
                                                   GError           **error);
 static gboolean    abr_reach_8bim_section        (GDataInputStream  *input,
@@ -122,9 +132,8 @@ gimp_brush_load_brush (GimpContext   *context,
                        GError       **error)
 {
   GimpBrush       *brush;
-  gsize            bn_size;
   GimpBrushHeader  header;
-  gchar           *name = NULL;
+  gchar           *name;
   guchar          *mask;
   gsize            bytes_read;
   gssize           i, size;
@@ -134,132 +143,8 @@ gimp_brush_load_brush (GimpContext   *context,
   g_return_val_if_fail (G_IS_INPUT_STREAM (input), NULL);
   g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-  /*  read the header  */
-  if (! g_input_stream_read_all (input, &header, sizeof (header),
-                                 &bytes_read, NULL, error) ||
-      bytes_read != sizeof (header))
-    {
-      return NULL;
-    }
-
-  /*  rearrange the bytes in each unsigned int  */
-  header.header_size  = g_ntohl (header.header_size);
-  header.version      = g_ntohl (header.version);
-  header.width        = g_ntohl (header.width);
-  header.height       = g_ntohl (header.height);
-  header.bytes        = g_ntohl (header.bytes);
-  header.magic_number = g_ntohl (header.magic_number);
-  header.spacing      = g_ntohl (header.spacing);
-
-  /*  Check for correct file format */
-
-  if (header.width == 0)
-    {
-      g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
-                   _("Fatal parse error in brush file: Width = 0."));
-      return NULL;
-    }
-
-  if (header.height == 0)
-    {
-      g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
-                   _("Fatal parse error in brush file: Height = 0."));
-      return NULL;
-    }
-
-  if (header.bytes == 0)
-    {
-      g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
-                   _("Fatal parse error in brush file: Bytes = 0."));
-      return NULL;
-    }
-
-  if (header.width  > GIMP_BRUSH_MAX_SIZE ||
-      header.height > GIMP_BRUSH_MAX_SIZE ||
-      G_MAXSIZE / header.width / header.height / MAX (4, header.bytes) < 1)
-    {
-      g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
-                   _("Fatal parse error in brush file: %dx%d over max size."),
-                   header.width, header.height);
-      return NULL;
-    }
-
-  switch (header.version)
-    {
-    case 1:
-      /*  If this is a version 1 brush, set the fp back 8 bytes  */
-      if (! g_seekable_seek (G_SEEKABLE (input), -8, G_SEEK_CUR,
-                             NULL, error))
-        return NULL;
-
-      header.header_size += 8;
-      /*  spacing is not defined in version 1  */
-      header.spacing = 25;
-      break;
-
-    case 3:  /*  cinepaint brush  */
-      if (header.bytes == 18  /* FLOAT16_GRAY_GIMAGE */)
-        {
-          header.bytes = 2;
-        }
-      else
-        {
-          g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
-                       _("Fatal parse error in brush file: Unknown depth %d."),
-                       header.bytes);
-          return NULL;
-        }
-      /*  fallthrough  */
-
-    case 2:
-      if (header.magic_number == GIMP_BRUSH_MAGIC)
-        break;
-
-    default:
-      g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
-                   _("Fatal parse error in brush file: Unknown version %d."),
-                   header.version);
-      return NULL;
-    }
-
-  if (header.header_size < sizeof (GimpBrushHeader))
-    {
-      g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
-                   _("Unsupported brush format"));
-      return NULL;
-    }
-
-  /*  Read in the brush name  */
-  if ((bn_size = (header.header_size - sizeof (header))))
-    {
-      gchar *utf8;
-
-      if (bn_size > GIMP_BRUSH_MAX_NAME)
-        {
-          g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
-                       _("Invalid header data in '%s': "
-                         "Brush name is too long: %lu"),
-                       gimp_file_get_utf8_name (file),
-                       (gulong) bn_size);
-          return NULL;
-        }
-
-      name = g_new0 (gchar, bn_size + 1);
-
-      if (! g_input_stream_read_all (input, name, bn_size,
-                                     &bytes_read, NULL, error) ||
-          bytes_read != bn_size)
-        {
-          g_free (name);
-          return NULL;
-        }
-
-      utf8 = gimp_any_to_utf8 (name, bn_size - 1,
-                               _("Invalid UTF-8 string in brush file '%s'."),
-                               gimp_file_get_utf8_name (file));
-      g_free (name);
-      name = utf8;
-    }
+  if (! gimp_brush_load_header (file, input, &header, &name, error))
+    return NULL;
 
   if (! name)
     name = g_strdup (_("Unnamed"));
@@ -447,6 +332,160 @@ gimp_brush_load_brush (GimpContext   *context,
   return brush;
 }
 
+GList *
+gimp_brush_load_lazy (GimpContext   *context,
+                      GFile         *file,
+                      GInputStream  *input,
+                      GError       **error)
+{
+  GimpBrush       *brush;
+  GimpBrushHeader  header;
+  gchar           *name;
+
+  g_return_val_if_fail (G_IS_FILE (file), NULL);
+  g_return_val_if_fail (G_IS_INPUT_STREAM (input), NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  if (! gimp_brush_load_header (file, input, &header, &name, error))
+    return NULL;
+
+  if (header.bytes != 1 && header.bytes != 2 && header.bytes != 4)
+    {
+      g_free (name);
+      g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
+                   _("Fatal parse error in brush file:\n"
+                     "Unsupported brush depth %d\n"
+                     "GIMP brushes must be GRAY or RGBA."),
+                   header.bytes);
+      return NULL;
+    }
+
+  if (! name)
+    name = g_strdup (_("Unnamed"));
+
+  brush = gimp_brush_new_lazy (name, header.width, header.height,
+                               header.spacing);
+  g_free (name);
+
+  return g_list_prepend (NULL, brush);
+}
+
+GimpData *
+gimp_brush_load_index (GKeyFile     *index,
+                       const gchar  *group,
+                       GError      **error)
+{
+  GimpBrush *brush;
+  gchar     *name;
+  gint       width;
+  gint       height;
+  gint       spacing;
+
+  g_return_val_if_fail (index != NULL, NULL);
+  g_return_val_if_fail (group != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  name    = g_key_file_get_string  (index, group, "name",    NULL);
+  width   = g_key_file_get_integer (index, group, "width",   NULL);
+  height  = g_key_file_get_integer (index, group, "height",  NULL);
+  spacing = g_key_file_get_integer (index, group, "spacing", NULL);
+
+  if (! name                                    ||
+      width  < 1 || width  > GIMP_BRUSH_MAX_SIZE ||
+      height < 1 || height > GIMP_BRUSH_MAX_SIZE)
+    {
+      g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
+                   _("Invalid brush index entry '%s'"), group);
+      g_free (name);
+      return NULL;
+    }
+
+  brush = gimp_brush_new_lazy (name, width, height, spacing);
+  g_free (name);
+
+  return GIMP_DATA (brush);
+}
+
+gboolean
+gimp_brush_save_index (GimpData    *data,
+                       GKeyFile    *index,
+                       const gchar *group)
+{
+  GimpBrush *brush;
+
+  g_return_val_if_fail (GIMP_IS_DATA (data), FALSE);
+  g_return_val_if_fail (index != NULL, FALSE);
+  g_return_val_if_fail (group != NULL, FALSE);
+
+  /*  only what gimp_brush_load_lazy() creates can be recreated from
+   *  the index
+   */
+  if (G_OBJECT_TYPE (data) != GIMP_TYPE_BRUSH)
+    return FALSE;
+
+  brush = GIMP_BRUSH (data);
+
+  g_key_file_set_string  (index, group, "name",
+                          gimp_object_get_name (brush));
+  g_key_file_set_integer (index, group, "width",
+                          gimp_brush_get_width (brush));
+  g_key_file_set_integer (index, group, "height",
+                          gimp_brush_get_height (brush));
+  g_key_file_set_integer (index, group, "spacing",
+                          brush->priv->spacing);
+
+  return TRUE;
+}
+
+void
+gimp_brush_load_pixels (GimpBrush *brush)
+{
+  GimpBrush    *loaded = NULL;
+  GFile        *file;
+  GInputStream *input;
+  GError       *error  = NULL;
+
+  g_return_if_fail (GIMP_IS_BRUSH (brush));
+
+  file  = gimp_data_get_file (GIMP_DATA (brush));
+  input = file ? G_INPUT_STREAM (g_file_read (file, NULL, &error)) : NULL;
+
+  if (input)
+    {
+      GInputStream *buffered = g_buffered_input_stream_new (input);
+
+      loaded = gimp_brush_load_brush (NULL, file, buffered, &error);
+
+      g_object_unref (buffered);
+      g_object_unref (input);
+    }
+
+  if (loaded &&
+      gimp_temp_buf_get_width  (loaded->priv->mask) == brush->priv->lazy_width &&
+      gimp_temp_buf_get_height (loaded->priv->mask) == brush->priv->lazy_height)
+    {
+      brush->priv->mask   = g_steal_pointer (&loaded->priv->mask);
+      brush->priv->pixmap = g_steal_pointer (&loaded->priv->pixmap);
+    }
+  else
+    {
+      /*  the file went away or changed since it was scanned, keep the
+       *  brush usable until the next refresh
+       */
+      if (error)
+        g_message (_("Error loading '%s': %s"),
+                   gimp_file_get_utf8_name (file), error->message);
+
+      brush->priv->mask = gimp_temp_buf_new (brush->priv->lazy_width,
+                                             brush->priv->lazy_height,
+                                             babl_format ("Y u8"));
+      gimp_temp_buf_data_clear (brush->priv->mask);
+    }
+
+  g_clear_object (&loaded);
+  g_clear_error (&error);
+}
+
 GList *
 gimp_brush_load_abr (GimpContext   *context,
                      GFile         *file,
@@ -513,6 +552,180 @@ gimp_brush_load_abr (GimpContext   *context,
 
 /*  private functions  */
 
+static GimpBrush *
+gimp_brush_new_lazy (const gchar *name,
+                     gint         width,
+                     gint         height,
+                     gint         spacing)
+{
+  GimpBrush *brush;
+
+  brush = g_object_new (GIMP_TYPE_BRUSH,
+                        "name",      name,
+                        "mime-type", "image/x-gimp-gbr",
+                        NULL);
+
+  /*  the pixels are read by gimp_brush_load_pixels() when the brush is
+   *  first used or previewed
+   */
+  brush->priv->lazy_width  = width;
+  brush->priv->lazy_height = height;
+  brush->priv->lazy        = TRUE;
+
+  brush->priv->spacing  = spacing;
+  brush->priv->x_axis.x = width  / 2.0;
+  brush->priv->x_axis.y = 0.0;
+  brush->priv->y_axis.x = 0.0;
+  brush->priv->y_axis.y = height / 2.0;
+
+  return brush;
+}
+
+/*  reads a brush's header and name, and leaves 'input' at the start of
+ *  its pixels
+ */
+static gboolean
+gimp_brush_load_header (GFile            *file,
+                        GInputStream     *input,
+                        GimpBrushHeader  *header,
+                        gchar           **name,
+                        GError          **error)
+{
+  gsize bn_size;
+  gsize bytes_read;
+
+  *name = NULL;
+
+  /*  read the header  */
+  if (! g_input_stream_read_all (input, header, sizeof (GimpBrushHeader),
+                                 &bytes_read, NULL, error) ||
+      bytes_read != sizeof (GimpBrushHeader))
+    {
+      return FALSE;
+    }
+
+  /*  rearrange the bytes in each unsigned int  */
+  header->header_size  = g_ntohl (header->header_size);
+  header->version      = g_ntohl (header->version);
+  header->width        = g_ntohl (header->width);
+  header->height       = g_ntohl (header->height);
+  header->bytes        = g_ntohl (header->bytes);
+  header->magic_number = g_ntohl (header->magic_number);
+  header->spacing      = g_ntohl (header->spacing);
+
+  /*  Check for correct file format */
+
+  if (header->width == 0)
+    {
+      g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
+                   _("Fatal parse error in brush file: Width = 0."));
+      return FALSE;
+    }
+
+  if (header->height == 0)
+    {
+      g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
+                   _("Fatal parse error in brush file: Height = 0."));
+      return FALSE;
+    }
+
+  if (header->bytes == 0)
+    {
+      g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
+                   _("Fatal parse error in brush file: Bytes = 0."));
+      return FALSE;
+    }
+
+  if (header->width  > GIMP_BRUSH_MAX_SIZE ||
+      header->height > GIMP_BRUSH_MAX_SIZE ||
+      G_MAXSIZE / header->width / header->height / MAX (4, header->bytes) < 1)
+    {
+      g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
+                   _("Fatal parse error in brush file: %dx%d over max size."),
+                   header->width, header->height);
+      return FALSE;
+    }
+
+  switch (header->version)
+    {
+    case 1:
+      /*  If this is a version 1 brush, set the fp back 8 bytes  */
+      if (! g_seekable_seek (G_SEEKABLE (input), -8, G_SEEK_CUR,
+                             NULL, error))
+        return FALSE;
+
+      header->header_size += 8;
+      /*  spacing is not defined in version 1  */
+      header->spacing = 25;
+      break;
+
+    case 3:  /*  cinepaint brush  */
+      if (header->bytes == 18  /* FLOAT16_GRAY_GIMAGE */)
+        {
+          header->bytes = 2;
+        }
+      else
+        {
+          g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
+                       _("Fatal parse error in brush file: Unknown depth %d."),
+                       header->bytes);
+          return FALSE;
+        }
+      /*  fallthrough  */
+
+    case 2:
+      if (header->magic_number == GIMP_BRUSH_MAGIC)
+        break;
+
+    default:
+      g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
+                   _("Fatal parse error in brush file: Unknown version %d."),
+                   header->version);
+      return FALSE;
+    }
+
+  if (header->header_size < sizeof (GimpBrushHeader))
+    {
+      g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
+                   _("Unsupported brush format"));
+      return FALSE;
+    }
+
+  /*  Read in the brush name  */
+  if ((bn_size = (header->header_size - sizeof (GimpBrushHeader))))
+    {
+      gchar *raw;
+
+      if (bn_size > GIMP_BRUSH_MAX_NAME)
+        {
+          g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
+                       _("Invalid header data in '%s': "
+                         "Brush name is too long: %lu"),
+                       gimp_file_get_utf8_name (file),
+                       (gulong) bn_size);
+          return FALSE;
+        }
+
+      raw = g_new0 (gchar, bn_size + 1);
+
+      if (! g_input_stream_read_all (input, raw, bn_size,
+                                     &bytes_read, NULL, error) ||
+          bytes_read != bn_size)
+        {
+          g_free (raw);
+          return FALSE;
+        }
+
+      *name = gimp_any_to_utf8 (raw, bn_size - 1,
+                                _("Invalid UTF-8 string in brush file '%s'."),
+                                gimp_file_get_utf8_name (file));
+      g_free (raw);
+    }
+
+  return TRUE;
+}
+
+
 static GList *
 gimp_brush_load_abr_v12 (GDataInputStream  *input,
                          AbrHeader         *abr_hdr,
@@ -33,6 +33,19 @@ GimpBrush * gimp_brush_load_brush  (GimpContext   *context,
                                     GInputStream  *input,
                                     GError       **error);
 
+GList     * gimp_brush_load_lazy   (GimpContext   *context,
+                                    GFile         *file,
+                                    GInputStream  *input,
+                                    GError       **error);
+void        gimp_brush_load_pixels (GimpBrush     *brush);
+
+GimpData  * gimp_brush_load_index  (GKeyFile      *index,
+                                    const gchar   *group,
+                                    GError       **error);
+gboolean    gimp_brush_save_index  (GimpData      *data,
+                                    GKeyFile      *index,
+                                    const gchar   *group);
+
 GList     * gimp_brush_load_abr    (GimpContext   *context,
                                     GFile         *file,
                                     GInputStream  *input,
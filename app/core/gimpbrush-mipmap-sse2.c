@@ -0,0 +1,147 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpbrush-mipmap-sse2.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include "gimpbrush-mipmap-sse2.h"
+
+
+#if COMPILE_SSE2_INTRINISICS
+
+#include <emmintrin.h>
+
+
+/*  the functions below process single-channel 8-bit rows, and produce the
+ *  same result as the scalar code in gimpbrush-mipmap.cc.  they return the
+ *  number of destination pixels (or, for the vertical case, bytes)
+ *  processed; the caller takes care of the remaining ones.
+ */
+
+static inline __m128i
+gimp_brush_mipmap_sum_pairs (__m128i v)
+{
+  /* adds the even and odd bytes, as 16-bit integers */
+  return _mm_add_epi16 (_mm_and_si128 (v, _mm_set1_epi16 (0x00ff)),
+                        _mm_srli_epi16 (v, 8));
+}
+
+/*  dest[x] = (src[2x] + src[2x + 1] +
+ *             src[stride + 2x] + src[stride + 2x + 1] + 2) / 4
+ */
+gint
+gimp_brush_mipmap_downscale_row_sse2 (const guint8 *src,
+                                      gint          src_stride,
+                                      guint8       *dest,
+                                      gint          width)
+{
+  const guint8  *src_below = src + src_stride;
+  const __m128i  two       = _mm_set1_epi16 (2);
+  gint           n_vectors = width / 16;
+  gint           i;
+
+  for (i = 0; i < n_vectors; i++)
+    {
+      __m128i lo;
+      __m128i hi;
+
+      lo = _mm_add_epi16 (
+        gimp_brush_mipmap_sum_pairs (
+          _mm_loadu_si128 ((const __m128i *) src)),
+        gimp_brush_mipmap_sum_pairs (
+          _mm_loadu_si128 ((const __m128i *) src_below)));
+      hi = _mm_add_epi16 (
+        gimp_brush_mipmap_sum_pairs (
+          _mm_loadu_si128 ((const __m128i *) (src + 16))),
+        gimp_brush_mipmap_sum_pairs (
+          _mm_loadu_si128 ((const __m128i *) (src_below + 16))));
+
+      lo = _mm_srli_epi16 (_mm_add_epi16 (lo, two), 2);
+      hi = _mm_srli_epi16 (_mm_add_epi16 (hi, two), 2);
+
+      _mm_storeu_si128 ((__m128i *) dest, _mm_packus_epi16 (lo, hi));
+
+      src       += 32;
+      src_below += 32;
+      dest      += 16;
+    }
+
+  return 16 * n_vectors;
+}
+
+/*  dest[x] = (src[2x] + src[2x + 1] + 1) / 2  */
+gint
+gimp_brush_mipmap_downscale_horz_row_sse2 (const guint8 *src,
+                                           guint8       *dest,
+                                           gint          width)
+{
+  const __m128i one       = _mm_set1_epi16 (1);
+  gint          n_vectors = width / 16;
+  gint          i;
+
+  for (i = 0; i < n_vectors; i++)
+    {
+      __m128i lo;
+      __m128i hi;
+
+      lo = gimp_brush_mipmap_sum_pairs (
+        _mm_loadu_si128 ((const __m128i *) src));
+      hi = gimp_brush_mipmap_sum_pairs (
+        _mm_loadu_si128 ((const __m128i *) (src + 16)));
+
+      lo = _mm_srli_epi16 (_mm_add_epi16 (lo, one), 1);
+      hi = _mm_srli_epi16 (_mm_add_epi16 (hi, one), 1);
+
+      _mm_storeu_si128 ((__m128i *) dest, _mm_packus_epi16 (lo, hi));
+
+      src  += 32;
+      dest += 16;
+    }
+
+  return 16 * n_vectors;
+}
+
+/*  dest[i] = (src[i] + src[stride + i] + 1) / 2, for any number of
+ *  components per pixel, with 'size' given in bytes
+ */
+gint
+gimp_brush_mipmap_downscale_vert_row_sse2 (const guint8 *src,
+                                           gint          src_stride,
+                                           guint8       *dest,
+                                           gint          size)
+{
+  gint n_vectors = size / 16;
+  gint i;
+
+  for (i = 0; i < n_vectors; i++)
+    {
+      __m128i a = _mm_loadu_si128 ((const __m128i *) src);
+      __m128i b = _mm_loadu_si128 ((const __m128i *) (src + src_stride));
+
+      _mm_storeu_si128 ((__m128i *) dest, _mm_avg_epu8 (a, b));
+
+      src  += 16;
+      dest += 16;
+    }
+
+  return 16 * n_vectors;
+}
+
+#endif /* COMPILE_SSE2_INTRINISICS */
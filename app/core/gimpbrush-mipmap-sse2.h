@@ -0,0 +1,37 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpbrush-mipmap-sse2.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+#if COMPILE_SSE2_INTRINISICS
+
+gint   gimp_brush_mipmap_downscale_row_sse2      (const guint8 *src,
+                                                  gint          src_stride,
+                                                  guint8       *dest,
+                                                  gint          width);
+gint   gimp_brush_mipmap_downscale_horz_row_sse2 (const guint8 *src,
+                                                  guint8       *dest,
+                                                  gint          width);
+gint   gimp_brush_mipmap_downscale_vert_row_sse2 (const guint8 *src,
+                                                  gint          src_stride,
+                                                  guint8       *dest,
+                                                  gint          size);
+
+#endif /* COMPILE_SSE2_INTRINISICS */
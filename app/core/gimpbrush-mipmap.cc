@@ -25,6 +25,7 @@
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gegl.h>
 
+#include "libgimpbase/gimpbase.h"
 #include "libgimpmath/gimpmath.h"
 
 extern "C"
@@ -34,6 +35,7 @@ extern "C"
 
 #include "gimpbrush.h"
 #include "gimpbrush-mipmap.h"
+#include "gimpbrush-mipmap-sse2.h"
 #include "gimpbrush-private.h"
 #include "gimptempbuf.h"
 
@@ -215,6 +217,88 @@ struct MipmapTraits<gfloat>
   }
 };
 
+/*  SIMD row functions.  each one returns the number of destination pixels
+ *  processed, leaving the rest of the row to the scalar code.
+ */
+template <class T,
+          gint  N>
+struct MipmapSIMD
+{
+  static gint
+  downscale (const T *src,
+             gint     src_stride,
+             T       *dest,
+             gint     width)
+  {
+    return 0;
+  }
+
+  static gint
+  downscale_horz (const T *src,
+                  T       *dest,
+                  gint     width)
+  {
+    return 0;
+  }
+
+  static gint
+  downscale_vert (const T *src,
+                  gint     src_stride,
+                  T       *dest,
+                  gint     width)
+  {
+    return 0;
+  }
+};
+
+#if COMPILE_SSE2_INTRINISICS
+
+template <gint N>
+struct MipmapSIMD<guint8, N>
+{
+  static gint
+  downscale (const guint8 *src,
+             gint          src_stride,
+             guint8       *dest,
+             gint          width)
+  {
+    if (N == 1 && (gimp_cpu_accel_get_support () & GIMP_CPU_ACCEL_X86_SSE2))
+      return gimp_brush_mipmap_downscale_row_sse2 (src, src_stride,
+                                                   dest, width);
+
+    return 0;
+  }
+
+  static gint
+  downscale_horz (const guint8 *src,
+                  guint8       *dest,
+                  gint          width)
+  {
+    if (N == 1 && (gimp_cpu_accel_get_support () & GIMP_CPU_ACCEL_X86_SSE2))
+      return gimp_brush_mipmap_downscale_horz_row_sse2 (src, dest, width);
+
+    return 0;
+  }
+
+  static gint
+  downscale_vert (const guint8 *src,
+                  gint          src_stride,
+                  guint8       *dest,
+                  gint          width)
+  {
+    /* vertical downscaling works on whole rows of components, so it
+     * doesn't care about the number of components
+     */
+    if (gimp_cpu_accel_get_support () & GIMP_CPU_ACCEL_X86_SSE2)
+      return gimp_brush_mipmap_downscale_vert_row_sse2 (src, src_stride,
+                                                        dest, N * width) / N;
+
+    return 0;
+  }
+};
+
+#endif /* COMPILE_SSE2_INTRINISICS */
+
 template <class T,
           gint  N>
 struct MipmapAlgorithms
@@ -251,7 +335,13 @@ struct MipmapAlgorithms
             T       *dest = dest0;
             gint     x;
 
-            for (x = 0; x < area->width; x++)
+            x = MipmapSIMD<T, N>::downscale (src, src_stride,
+                                             dest, area->width);
+
+            src  += 2 * N * x;
+            dest +=     N * x;
+
+            for (; x < area->width; x++)
               {
                 gint c;
 
@@ -307,7 +397,12 @@ struct MipmapAlgorithms
             T       *dest = dest0;
             gint     x;
 
-            for (x = 0; x < width; x++)
+            x = MipmapSIMD<T, N>::downscale_horz (src, dest, width);
+
+            src  += 2 * N * x;
+            dest +=     N * x;
+
+            for (; x < width; x++)
               {
                 gint c;
 
@@ -338,8 +433,9 @@ struct MipmapAlgorithms
     destination = gimp_temp_buf_new (width, height,
                                      gimp_temp_buf_get_format (source));
 
+    /* process whole rows, so that consecutive components are contiguous */
     gegl_parallel_distribute_range (
-      width, PIXELS_PER_THREAD / height,
+      height, PIXELS_PER_THREAD / width,
       [=] (gint offset,
            gint size)
       {
@@ -347,30 +443,36 @@ struct MipmapAlgorithms
         T       *dest0       = (T       *) gimp_temp_buf_get_data (destination);
         gint     src_stride  = N * gimp_temp_buf_get_width (source);
         gint     dest_stride = N * gimp_temp_buf_get_width (destination);
-        gint     x;
+        gint     y;
 
-        src0  += offset * N;
-        dest0 += offset * N;
+        src0  += 2 * offset * src_stride;
+        dest0 +=     offset * dest_stride;
 
-        for (x = 0; x < size; x++)
+        for (y = 0; y < size; y++)
           {
             const T *src  = src0;
             T       *dest = dest0;
-            gint     y;
+            gint     x;
 
-            for (y = 0; y < height; y++)
+            x = MipmapSIMD<T, N>::downscale_vert (src, src_stride,
+                                                  dest, width);
+
+            src  += N * x;
+            dest += N * x;
+
+            for (; x < width; x++)
               {
                 gint c;
 
                 for (c = 0; c < N; c++)
                   dest[c] = MipmapTraits<T>::mix (src[c], src[src_stride + c]);
 
-                src  += 2 * src_stride;
-                dest += dest_stride;
+                src  += N;
+                dest += N;
               }
 
-            src0  += N;
-            dest0 += N;
+            src0  += 2 * src_stride;
+            dest0 += dest_stride;
           }
       });
 
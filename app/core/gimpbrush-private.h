@@ -40,4 +40,8 @@ struct _GimpBrushPrivate
   GimpBrushCache  *mask_cache;
   GimpBrushCache  *pixmap_cache;
   GimpBrushCache  *boundary_cache;
+
+  gint             lazy;         /*  the pixels are not loaded yet  */
+  gint             lazy_width;   /*  the header's size, until then  */
+  gint             lazy_height;
 };
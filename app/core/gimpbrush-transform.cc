@@ -62,6 +62,12 @@ static void    gimp_brush_transform_adjust_hardness_matrix (gdouble            w
                                                             gdouble            blur_radius,
                                                             GimpMatrix3       *matrix);
 
+static inline gint gimp_brush_transform_sample_mask        (const guchar      *src,
+                                                            gint               src_width,
+                                                            gint               src_height,
+                                                            gint               src_x_i,
+                                                            gint               src_y_i);
+
 
 /*  public functions  */
 
@@ -92,7 +98,9 @@ gimp_brush_real_transform_size (GimpBrush *brush,
 }
 
 /*
- * Transforms the brush mask with bilinear interpolation.
+ * Transforms the brush mask with bilinear interpolation, or, when
+ * downscaling, with trilinear interpolation between the two nearest
+ * mipmap levels.
  *
  * Rather than calculating the inverse transform for each point in the
  * transformed image, this algorithm uses the inverse transformed
@@ -127,13 +135,16 @@ gimp_brush_real_transform_mask (GimpBrush *brush,
 {
   GimpTempBuf       *result;
   const GimpTempBuf *source;
+  const GimpTempBuf *coarse_source = NULL;
   const guchar      *src;
+  const guchar      *coarse_src    = NULL;
   GimpMatrix3        matrix;
   gdouble            scale_x, scale_y;
   gint               src_width;
   gint               src_height;
-  gint               src_width_minus_one;
-  gint               src_height_minus_one;
+  gint               coarse_width  = 0;
+  gint               coarse_height = 0;
+  gint               coarse_weight = 0;
   gint               dest_width;
   gint               dest_height;
   gint               blur_radius;
@@ -148,10 +159,6 @@ gimp_brush_real_transform_mask (GimpBrush *brush,
   gint               src_walk_uy_i;
   gint               src_walk_vx_i;
   gint               src_walk_vy_i;
-  gint               src_x_min_i;
-  gint               src_y_min_i;
-  gint               src_x_max_i;
-  gint               src_y_max_i;
 
   /*
    * tl, tr etc are used because it is easier to visualize top left,
@@ -161,31 +168,19 @@ gimp_brush_real_transform_mask (GimpBrush *brush,
   const gint fraction_bits = 12;
   const gint int_multiple  = pow (2, fraction_bits);
 
-  /* In inner loop's bilinear calculation, two numbers that were each
-   * previously multiplied by int_multiple are multiplied together.
-   * To get back the right result, the multiplication result must be
-   * divided *twice* by 2^fraction_bits, equivalent to bit shift right
-   * by 2 * fraction_bits
-   */
-  const gint recovery_bits = 2 * fraction_bits;
-
-  /*
-   * example: suppose fraction_bits = 9
-   * a 9-bit mask looks like this: 0001 1111 1111
-   * and is given by:  2^fraction_bits - 1
-   * demonstration:
-   * 2^0     = 0000 0000 0001
-   * 2^1     = 0000 0000 0010
-   * :
-   * 2^8     = 0001 0000 0000
-   * 2^9     = 0010 0000 0000
-   * 2^9 - 1 = 0001 1111 1111
-   */
-  const guint fraction_bitmask = pow(2, fraction_bits) - 1 ;
-
   gimp_brush_transform_get_scale (scale, aspect_ratio,
                                   &scale_x, &scale_y);
 
+  if (scale_x < 1.0 && scale_y < 1.0)
+    {
+      gdouble coarse_scale_x = scale_x / 2.0;
+      gdouble coarse_scale_y = scale_y / 2.0;
+
+      coarse_source = gimp_brush_mipmap_get_mask (brush,
+                                                  &coarse_scale_x,
+                                                  &coarse_scale_y);
+    }
+
   source = gimp_brush_mipmap_get_mask (brush, &scale_x, &scale_y);
 
   src_width  = gimp_temp_buf_get_width  (source);
@@ -197,8 +192,23 @@ gimp_brush_real_transform_mask (GimpBrush *brush,
   if (gimp_matrix3_is_identity (&matrix) && hardness == 1.0)
     return gimp_temp_buf_copy (source);
 
-  src_width_minus_one  = src_width  - 1;
-  src_height_minus_one = src_height - 1;
+  /*  when downscaling, blend the result with the next coarser mipmap
+   *  level, according to the remaining scale factor, which is in the
+   *  (0.5, 1.0) range, unless we're already at the last level.
+   */
+  if (coarse_source                  &&
+      coarse_source != source        &&
+      scale_x > 0.5 && scale_x < 1.0 &&
+      scale_y > 0.5 && scale_y < 1.0 &&
+      gimp_temp_buf_get_width  (coarse_source) == src_width  / 2 &&
+      gimp_temp_buf_get_height (coarse_source) == src_height / 2)
+    {
+      coarse_src    = gimp_temp_buf_get_data (coarse_source);
+      coarse_width  = gimp_temp_buf_get_width  (coarse_source);
+      coarse_height = gimp_temp_buf_get_height (coarse_source);
+      coarse_weight = RINT (128.0 * (log2 (1.0 / scale_x) +
+                                     log2 (1.0 / scale_y)));
+    }
 
   gimp_brush_transform_bounding_box (source, &matrix,
                                      &x, &y, &dest_width, &dest_height);
@@ -283,30 +293,16 @@ gimp_brush_real_transform_mask (GimpBrush *brush,
   src_walk_vy_i = (gint) ((src_tl_to_bl_delta_y / MAX (dest_height - 1, 1)) *
                           int_multiple);
 
-  src_x_min_i = -int_multiple / 2;
-  src_y_min_i = -int_multiple / 2;
-
-  src_x_max_i = src_width  * int_multiple - int_multiple / 2;
-  src_y_max_i = src_height * int_multiple - int_multiple / 2;
-
   gegl_parallel_distribute_area (
     GEGL_RECTANGLE (0, 0, dest_width, dest_height), PIXELS_PER_THREAD,
     [=] (const GeglRectangle *area)
     {
-      guchar       *dest;
-      gint          src_space_cur_pos_x;
-      gint          src_space_cur_pos_y;
-      gint          src_space_cur_pos_x_i;
-      gint          src_space_cur_pos_y_i;
-      gint          src_space_row_start_x_i;
-      gint          src_space_row_start_y_i;
-      const guchar *src_walker;
-      const guchar *pixel_next;
-      const guchar *pixel_below;
-      const guchar *pixel_below_next;
-      gint          opposite_x, distance_from_true_x;
-      gint          opposite_y, distance_from_true_y;
-      gint          u, v;
+      guchar *dest;
+      gint    src_space_cur_pos_x_i;
+      gint    src_space_cur_pos_y_i;
+      gint    src_space_row_start_x_i;
+      gint    src_space_row_start_y_i;
+      gint    u, v;
 
       dest = gimp_temp_buf_get_data (result) +
              dest_width * area->y + area->x;
@@ -328,61 +324,34 @@ gimp_brush_real_transform_mask (GimpBrush *brush,
 
           for (u = 0; u < area->width; u++)
             {
-              if (src_space_cur_pos_x_i <  src_x_min_i ||
-                  src_space_cur_pos_x_i >= src_x_max_i ||
-                  src_space_cur_pos_y_i <  src_y_min_i ||
-                  src_space_cur_pos_y_i >= src_y_max_i)
-                  /* no corresponding pixel in source space */
-                {
-                  *dest = 0;
-                }
-              else /* reverse transformed point hits source pixel */
-                {
-                  src_space_cur_pos_x = src_space_cur_pos_x_i >> fraction_bits;
-                  src_space_cur_pos_y = src_space_cur_pos_y_i >> fraction_bits;
-
-                  src_walker = src                             +
-                               src_space_cur_pos_y * src_width +
-                               src_space_cur_pos_x;
-
-                  pixel_next       = src_walker + 1;
-                  pixel_below      = src_walker + src_width;
-                  pixel_below_next = pixel_below + 1;
-
-                  if (src_space_cur_pos_x < 0)
-                    {
-                      src_walker  = pixel_next;
-                      pixel_below = pixel_below_next;
-                    }
-                  else if (src_space_cur_pos_x >= src_width_minus_one)
-                    {
-                      pixel_next       = src_walker;
-                      pixel_below_next = pixel_below;
-                    }
-
-                  if (src_space_cur_pos_y < 0)
-                    {
-                      src_walker = pixel_below;
-                      pixel_next = pixel_below_next;
-                    }
-                  else if (src_space_cur_pos_y >= src_height_minus_one)
-                    {
-                      pixel_below      = src_walker;
-                      pixel_below_next = pixel_next;
-                    }
+              gint value;
 
-                  distance_from_true_x = src_space_cur_pos_x_i & fraction_bitmask;
-                  distance_from_true_y = src_space_cur_pos_y_i & fraction_bitmask;
-                  opposite_x =  int_multiple - distance_from_true_x;
-                  opposite_y =  int_multiple - distance_from_true_y;
+              value = gimp_brush_transform_sample_mask (src,
+                                                        src_width,
+                                                        src_height,
+                                                        src_space_cur_pos_x_i,
+                                                        src_space_cur_pos_y_i);
 
-                  *dest = ((src_walker[0] * opposite_x +
-                            pixel_next[0] * distance_from_true_x) * opposite_y +
-                           (pixel_below[0] * opposite_x +
-                            pixel_below_next[0] *distance_from_true_x) * distance_from_true_y
-                           ) >> recovery_bits;
+              if (coarse_src)
+                {
+                  gint coarse_value;
+
+                  /* pixel centers in the coarse level are at half the
+                   * coordinates of the same points in the fine level
+                   */
+                  coarse_value = gimp_brush_transform_sample_mask (
+                    coarse_src,
+                    coarse_width,
+                    coarse_height,
+                    (src_space_cur_pos_x_i >> 1) - int_multiple / 4,
+                    (src_space_cur_pos_y_i >> 1) - int_multiple / 4);
+
+                  value = (value        * (256 - coarse_weight) +
+                           coarse_value * coarse_weight         + 128) >> 8;
                 }
 
+              *dest = value;
+
               src_space_cur_pos_x_i += src_walk_ux_i;
               src_space_cur_pos_y_i += src_walk_uy_i;
 
@@ -770,6 +739,85 @@ gimp_brush_transform_matrix (gdouble      width,
 
 /*  private functions  */
 
+/*  returns the bilinearly-interpolated value of 'src' at the given
+ *  position, premultiplied by 2^12, as in gimp_brush_real_transform_mask(),
+ *  or 0 outside of the mask.
+ */
+static inline gint
+gimp_brush_transform_sample_mask (const guchar *src,
+                                  gint          src_width,
+                                  gint          src_height,
+                                  gint          src_x_i,
+                                  gint          src_y_i)
+{
+  const gint    fraction_bits    = 12;
+  const gint    int_multiple     = 1 << fraction_bits;
+  const gint    recovery_bits    = 2 * fraction_bits;
+  const guint   fraction_bitmask = int_multiple - 1;
+  const guchar *src_walker;
+  const guchar *pixel_next;
+  const guchar *pixel_below;
+  const guchar *pixel_below_next;
+  gint          src_x, src_y;
+  gint          opposite_x, distance_from_true_x;
+  gint          opposite_y, distance_from_true_y;
+
+  /* two numbers that were each previously multiplied by int_multiple
+   * are multiplied together below, so the result must be divided
+   * *twice* by 2^fraction_bits, i.e. shifted right by recovery_bits.
+   */
+  if (src_x_i <  -int_multiple / 2                            ||
+      src_x_i >= src_width  * int_multiple - int_multiple / 2 ||
+      src_y_i <  -int_multiple / 2                            ||
+      src_y_i >= src_height * int_multiple - int_multiple / 2)
+    {
+      /* no corresponding pixel in source space */
+      return 0;
+    }
+
+  src_x = src_x_i >> fraction_bits;
+  src_y = src_y_i >> fraction_bits;
+
+  src_walker = src + src_y * src_width + src_x;
+
+  pixel_next       = src_walker + 1;
+  pixel_below      = src_walker + src_width;
+  pixel_below_next = pixel_below + 1;
+
+  if (src_x < 0)
+    {
+      src_walker  = pixel_next;
+      pixel_below = pixel_below_next;
+    }
+  else if (src_x >= src_width - 1)
+    {
+      pixel_next       = src_walker;
+      pixel_below_next = pixel_below;
+    }
+
+  if (src_y < 0)
+    {
+      src_walker = pixel_below;
+      pixel_next = pixel_below_next;
+    }
+  else if (src_y >= src_height - 1)
+    {
+      pixel_below      = src_walker;
+      pixel_below_next = pixel_next;
+    }
+
+  distance_from_true_x = src_x_i & fraction_bitmask;
+  distance_from_true_y = src_y_i & fraction_bitmask;
+  opposite_x           = int_multiple - distance_from_true_x;
+  opposite_y           = int_multiple - distance_from_true_y;
+
+  return ((src_walker[0]  * opposite_x +
+           pixel_next[0]  * distance_from_true_x) * opposite_y +
+          (pixel_below[0] * opposite_x +
+           pixel_below_next[0] * distance_from_true_x) * distance_from_true_y
+         ) >> recovery_bits;
+}
+
 static void
 gimp_brush_transform_bounding_box (const GimpTempBuf *temp_buf,
                                    const GimpMatrix3 *matrix,
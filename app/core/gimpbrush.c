@@ -17,6 +17,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <cairo.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gegl.h>
@@ -42,9 +44,20 @@
 #include "gimptagged.h"
 #include "gimptempbuf.h"
 
+#include "gimp-log.h"
+
 #include "gimp-intl.h"
 
 
+/*  the transform parameters are quantized, so that dynamics varying them
+ *  continuously, or jittering them, still hit the transform caches
+ */
+#define SCALE_STEPS        512  /* per octave */
+#define ASPECT_RATIO_STEPS 64
+#define ANGLE_STEPS        1024 /* per turn   */
+#define HARDNESS_STEPS     256
+
+
 enum
 {
   SPACING_CHANGED,
@@ -100,6 +113,24 @@ static gboolean      gimp_brush_real_want_null_motion (GimpBrush            *bru
 
 static gchar       * gimp_brush_get_checksum          (GimpTagged           *tagged);
 
+static void          gimp_brush_quantize_transform    (gdouble              *scale,
+                                                       gdouble              *aspect_ratio,
+                                                       gdouble              *angle,
+                                                       gdouble              *hardness);
+static void          gimp_brush_ensure_loaded         (GimpBrush            *brush);
+static GimpTempBuf * gimp_brush_derive_transform      (GimpBrush            *brush,
+                                                       GimpBrushCache       *cache,
+                                                       gint                  width,
+                                                       gint                  height,
+                                                       gdouble               scale,
+                                                       gdouble               aspect_ratio,
+                                                       gdouble               angle,
+                                                       gboolean              reflect,
+                                                       gdouble               hardness);
+static GimpTempBuf * gimp_brush_rotate_flip           (const GimpTempBuf    *src,
+                                                       gint                  quarters,
+                                                       gboolean              flip);
+
 
 G_DEFINE_TYPE_WITH_CODE (GimpBrush, gimp_brush, GIMP_TYPE_DATA,
                          G_ADD_PRIVATE (GimpBrush)
@@ -110,6 +141,8 @@ G_DEFINE_TYPE_WITH_CODE (GimpBrush, gimp_brush, GIMP_TYPE_DATA,
 
 static guint brush_signals[LAST_SIGNAL] = { 0 };
 
+G_LOCK_DEFINE_STATIC (lazy_brush);
+
 
 static void
 gimp_brush_class_init (GimpBrushClass *klass)
@@ -264,8 +297,8 @@ gimp_brush_get_size (GimpViewable *viewable,
 {
   GimpBrush *brush = GIMP_BRUSH (viewable);
 
-  *width  = gimp_temp_buf_get_width  (brush->priv->mask);
-  *height = gimp_temp_buf_get_height (brush->priv->mask);
+  *width  = gimp_brush_get_width  (brush);
+  *height = gimp_brush_get_height (brush);
 
   return TRUE;
 }
@@ -278,8 +311,8 @@ gimp_brush_get_new_preview (GimpViewable *viewable,
                             GeglColor    *fg_color)
 {
   GimpBrush         *brush       = GIMP_BRUSH (viewable);
-  const GimpTempBuf *mask_buf    = brush->priv->mask;
-  const GimpTempBuf *pixmap_buf  = brush->priv->pixmap;
+  const GimpTempBuf *mask_buf;
+  const GimpTempBuf *pixmap_buf;
   GimpTempBuf       *return_buf  = NULL;
   gint               mask_width;
   gint               mask_height;
@@ -290,6 +323,11 @@ gimp_brush_get_new_preview (GimpViewable *viewable,
   gboolean           free_mask = FALSE;
   gdouble            scale     = 1.0;
 
+  gimp_brush_ensure_loaded (brush);
+
+  mask_buf   = brush->priv->mask;
+  pixmap_buf = brush->priv->pixmap;
+
   mask_width  = gimp_temp_buf_get_width  (mask_buf);
   mask_height = gimp_temp_buf_get_height (mask_buf);
 
@@ -408,8 +446,8 @@ gimp_brush_get_description (GimpViewable  *viewable,
 
   return g_strdup_printf ("%s (%d × %d)",
                           gimp_object_get_name (brush),
-                          gimp_temp_buf_get_width  (brush->priv->mask),
-                          gimp_temp_buf_get_height (brush->priv->mask));
+                          gimp_brush_get_width  (brush),
+                          gimp_brush_get_height (brush));
 }
 
 static void
@@ -447,6 +485,8 @@ gimp_brush_copy (GimpData *data,
   GimpBrush *brush     = GIMP_BRUSH (data);
   GimpBrush *src_brush = GIMP_BRUSH (src_data);
 
+  gimp_brush_ensure_loaded (src_brush);
+
   g_clear_pointer (&brush->priv->mask, gimp_temp_buf_unref);
   if (src_brush->priv->mask)
     brush->priv->mask = gimp_temp_buf_copy (src_brush->priv->mask);
@@ -465,14 +505,22 @@ gimp_brush_copy (GimpData *data,
 static void
 gimp_brush_real_begin_use (GimpBrush *brush)
 {
+  gimp_brush_ensure_loaded (brush);
+
   brush->priv->mask_cache =
-    gimp_brush_cache_new ((GDestroyNotify) gimp_temp_buf_unref, 'M', 'm');
+    gimp_brush_cache_new ((GDestroyNotify) gimp_temp_buf_unref,
+                          (GimpBrushCacheMemsizeFunc) gimp_temp_buf_get_memsize,
+                          'M', 'm');
 
   brush->priv->pixmap_cache =
-    gimp_brush_cache_new ((GDestroyNotify) gimp_temp_buf_unref, 'P', 'p');
+    gimp_brush_cache_new ((GDestroyNotify) gimp_temp_buf_unref,
+                          (GimpBrushCacheMemsizeFunc) gimp_temp_buf_get_memsize,
+                          'P', 'p');
 
   brush->priv->boundary_cache =
-    gimp_brush_cache_new ((GDestroyNotify) gimp_bezier_desc_free, 'B', 'b');
+    gimp_brush_cache_new ((GDestroyNotify) gimp_bezier_desc_free,
+                          (GimpBrushCacheMemsizeFunc) gimp_bezier_desc_get_memsize,
+                          'B', 'b');
 }
 
 static void
@@ -508,6 +556,8 @@ gimp_brush_get_checksum (GimpTagged *tagged)
   GimpBrush *brush           = GIMP_BRUSH (tagged);
   gchar     *checksum_string = NULL;
 
+  gimp_brush_ensure_loaded (brush);
+
   if (brush->priv->mask)
     {
       GChecksum *checksum = g_checksum_new (G_CHECKSUM_MD5);
@@ -537,6 +587,190 @@ gimp_brush_get_checksum (GimpTagged *tagged)
   return checksum_string;
 }
 
+static void
+gimp_brush_quantize_transform (gdouble *scale,
+                               gdouble *aspect_ratio,
+                               gdouble *angle,
+                               gdouble *hardness)
+{
+  /*  the identity transform is preserved  */
+  *scale = exp2 (RINT (log2 (*scale) * SCALE_STEPS) / SCALE_STEPS);
+
+  *aspect_ratio = RINT (*aspect_ratio * ASPECT_RATIO_STEPS) / ASPECT_RATIO_STEPS;
+  *angle        = RINT (*angle        * ANGLE_STEPS)        / ANGLE_STEPS;
+
+  if (hardness)
+    *hardness = RINT (*hardness * HARDNESS_STEPS) / HARDNESS_STEPS;
+}
+
+static void
+gimp_brush_ensure_loaded (GimpBrush *brush)
+{
+  if (! g_atomic_int_get (&brush->priv->lazy))
+    return;
+
+  /*  a lazily loaded brush may be first used from any thread, e.g. by
+   *  a threaded paint core or a preview renderer
+   */
+  G_LOCK (lazy_brush);
+
+  if (brush->priv->lazy)
+    {
+      gimp_brush_load_pixels (brush);
+
+      g_atomic_int_set (&brush->priv->lazy, FALSE);
+    }
+
+  G_UNLOCK (lazy_brush);
+}
+
+/*  a transform whose angle differs from a cached one by a multiple of a
+ *  quarter turn, or which differs from it only in reflection, is an
+ *  exact rotation or flip of the cached buffer, which is much cheaper
+ *  than transforming the brush again.  this is the common case with
+ *  symmetry painting, where the strokes of each dab differ only in
+ *  angle and reflection.
+ */
+static GimpTempBuf *
+gimp_brush_derive_transform (GimpBrush      *brush,
+                             GimpBrushCache *cache,
+                             gint            width,
+                             gint            height,
+                             gdouble         scale,
+                             gdouble         aspect_ratio,
+                             gdouble         angle,
+                             gboolean        reflect,
+                             gdouble         hardness)
+{
+  gint k;
+  gint flip;
+
+  for (flip = 0; flip < 2; flip++)
+    {
+      gboolean base_reflect = reflect ^ flip;
+
+      for (k = 0; k < 4; k++)
+        {
+          const GimpTempBuf *base;
+          gdouble            base_angle;
+          gint               base_width;
+          gint               base_height;
+          gint               quarters;
+
+          if (! flip && ! k)
+            continue;
+
+          base_angle = angle - k * 0.25;
+
+          if (base_angle < 0.0)
+            base_angle += 1.0;
+
+          base_angle = RINT (base_angle * ANGLE_STEPS) / ANGLE_STEPS;
+
+          gimp_brush_transform_size (brush,
+                                     scale, aspect_ratio,
+                                     base_angle, base_reflect,
+                                     &base_width, &base_height);
+
+          if ((k % 2 == 0 && (base_width != width || base_height != height)) ||
+              (k % 2 == 1 && (base_width != height || base_height != width)))
+            {
+              continue;
+            }
+
+          base = gimp_brush_cache_get (cache,
+                                       base_width, base_height,
+                                       scale, aspect_ratio,
+                                       base_angle, base_reflect, hardness);
+
+          if (! base)
+            continue;
+
+          /*  the brush is rotated before it's reflected, so a reflected
+           *  base is rotated the other way
+           */
+          quarters = base_reflect ? (4 - k) % 4 : k;
+
+          return gimp_brush_rotate_flip (base, quarters, flip);
+        }
+    }
+
+  return NULL;
+}
+
+/*  returns 'src' rotated by 'quarters' quarter turns, in the direction
+ *  of increasing brush angle, and then flipped horizontally if 'flip'
+ */
+static GimpTempBuf *
+gimp_brush_rotate_flip (const GimpTempBuf *src,
+                        gint               quarters,
+                        gboolean           flip)
+{
+  const Babl   *format     = gimp_temp_buf_get_format (src);
+  gint          bpp        = babl_format_get_bytes_per_pixel (format);
+  gint          src_width  = gimp_temp_buf_get_width  (src);
+  gint          src_height = gimp_temp_buf_get_height (src);
+  const guchar *src_data   = gimp_temp_buf_get_data (src);
+  GimpTempBuf  *dest;
+  guchar       *dest_data;
+  gint          width;
+  gint          height;
+  gint          x, y;
+
+  if (quarters % 2)
+    {
+      width  = src_height;
+      height = src_width;
+    }
+  else
+    {
+      width  = src_width;
+      height = src_height;
+    }
+
+  dest      = gimp_temp_buf_new (width, height, format);
+  dest_data = gimp_temp_buf_get_data (dest);
+
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x < width; x++)
+        {
+          gint rx = flip ? width - 1 - x : x;
+          gint sx, sy;
+
+          switch (quarters)
+            {
+            case 1:
+              sx = src_width - 1 - y;
+              sy = rx;
+              break;
+
+            case 2:
+              sx = src_width  - 1 - rx;
+              sy = src_height - 1 - y;
+              break;
+
+            case 3:
+              sx = y;
+              sy = src_height - 1 - rx;
+              break;
+
+            default:
+              sx = rx;
+              sy = y;
+              break;
+            }
+
+          memcpy (dest_data + (y * width + x) * bpp,
+                  src_data  + (sy * src_width + sx) * bpp,
+                  bpp);
+        }
+    }
+
+  return dest;
+}
+
+
 /*  public functions  */
 
 GimpData *
@@ -632,6 +866,10 @@ gimp_brush_transform_size (GimpBrush     *brush,
   g_return_if_fail (width != NULL);
   g_return_if_fail (height != NULL);
 
+  gimp_brush_ensure_loaded (brush);
+
+  gimp_brush_quantize_transform (&scale, &aspect_ratio, &angle, NULL);
+
   if (scale             == 1.0 &&
       aspect_ratio      == 0.0 &&
       fmod (angle, 0.5) == 0.0)
@@ -658,11 +896,16 @@ gimp_brush_transform_mask (GimpBrush *brush,
   const GimpTempBuf *mask;
   gint               width;
   gint               height;
-  gdouble            effective_hardness = hardness;
+  gdouble            effective_hardness;
+  GIMP_TRACE_SPAN (span);
 
   g_return_val_if_fail (GIMP_IS_BRUSH (brush), NULL);
   g_return_val_if_fail (scale > 0.0, NULL);
 
+  gimp_brush_quantize_transform (&scale, &aspect_ratio, &angle, &hardness);
+
+  effective_hardness = hardness;
+
   gimp_brush_transform_size (brush,
                              scale, aspect_ratio, angle, reflect,
                              &width, &height);
@@ -698,12 +941,22 @@ gimp_brush_transform_mask (GimpBrush *brush,
         }
 #endif
 
-      mask = GIMP_BRUSH_GET_CLASS (brush)->transform_mask (brush,
-                                                           scale,
-                                                           aspect_ratio,
-                                                           angle,
-                                                           reflect,
-                                                           effective_hardness);
+      GIMP_TRACE_BEGIN (span, "brush-transform-mask");
+
+      mask = gimp_brush_derive_transform (brush, brush->priv->mask_cache,
+                                          width, height,
+                                          scale, aspect_ratio, angle, reflect,
+                                          effective_hardness);
+
+      if (! mask)
+        mask = GIMP_BRUSH_GET_CLASS (brush)->transform_mask (brush,
+                                                             scale,
+                                                             aspect_ratio,
+                                                             angle,
+                                                             reflect,
+                                                             effective_hardness);
+
+      GIMP_TRACE_END (span);
 
       gimp_brush_cache_add (brush->priv->mask_cache,
                             (gpointer) mask,
@@ -725,12 +978,20 @@ gimp_brush_transform_pixmap (GimpBrush *brush,
   const GimpTempBuf *pixmap;
   gint               width;
   gint               height;
-  gdouble            effective_hardness = hardness;
+  gdouble            effective_hardness;
+  GIMP_TRACE_SPAN (span);
 
   g_return_val_if_fail (GIMP_IS_BRUSH (brush), NULL);
+
+  gimp_brush_ensure_loaded (brush);
+
   g_return_val_if_fail (brush->priv->pixmap != NULL, NULL);
   g_return_val_if_fail (scale > 0.0, NULL);
 
+  gimp_brush_quantize_transform (&scale, &aspect_ratio, &angle, &hardness);
+
+  effective_hardness = hardness;
+
   gimp_brush_transform_size (brush,
                              scale, aspect_ratio, angle, reflect,
                              &width, &height);
@@ -761,12 +1022,22 @@ gimp_brush_transform_pixmap (GimpBrush *brush,
       }
 #endif
 
-      pixmap = GIMP_BRUSH_GET_CLASS (brush)->transform_pixmap (brush,
-                                                               scale,
-                                                               aspect_ratio,
-                                                               angle,
-                                                               reflect,
-                                                               effective_hardness);
+      GIMP_TRACE_BEGIN (span, "brush-transform-pixmap");
+
+      pixmap = gimp_brush_derive_transform (brush, brush->priv->pixmap_cache,
+                                            width, height,
+                                            scale, aspect_ratio, angle, reflect,
+                                            effective_hardness);
+
+      if (! pixmap)
+        pixmap = GIMP_BRUSH_GET_CLASS (brush)->transform_pixmap (brush,
+                                                                 scale,
+                                                                 aspect_ratio,
+                                                                 angle,
+                                                                 reflect,
+                                                                 effective_hardness);
+
+      GIMP_TRACE_END (span);
 
       gimp_brush_cache_add (brush->priv->pixmap_cache,
                             (gpointer) pixmap,
@@ -794,6 +1065,8 @@ gimp_brush_transform_boundary (GimpBrush *brush,
   g_return_val_if_fail (width != NULL, NULL);
   g_return_val_if_fail (height != NULL, NULL);
 
+  gimp_brush_quantize_transform (&scale, &aspect_ratio, &angle, &hardness);
+
   gimp_brush_transform_size (brush,
                              scale, aspect_ratio, angle, reflect,
                              width, height);
@@ -835,6 +1108,8 @@ gimp_brush_get_mask (GimpBrush *brush)
   g_return_val_if_fail (brush != NULL, NULL);
   g_return_val_if_fail (GIMP_IS_BRUSH (brush), NULL);
 
+  gimp_brush_ensure_loaded (brush);
+
   if (brush->priv->blurred_mask)
     {
       return brush->priv->blurred_mask;
@@ -848,6 +1123,8 @@ gimp_brush_get_pixmap (GimpBrush *brush)
   g_return_val_if_fail (brush != NULL, NULL);
   g_return_val_if_fail (GIMP_IS_BRUSH (brush), NULL);
 
+  gimp_brush_ensure_loaded (brush);
+
   if(brush->priv->blurred_pixmap)
     {
       return brush->priv->blurred_pixmap;
@@ -892,6 +1169,9 @@ gimp_brush_get_width (GimpBrush *brush)
   if (brush->priv->blurred_pixmap)
     return gimp_temp_buf_get_width (brush->priv->blurred_pixmap);
 
+  if (g_atomic_int_get (&brush->priv->lazy))
+    return brush->priv->lazy_width;
+
   return gimp_temp_buf_get_width (brush->priv->mask);
 }
 
@@ -906,6 +1186,9 @@ gimp_brush_get_height (GimpBrush *brush)
   if (brush->priv->blurred_pixmap)
     return gimp_temp_buf_get_height (brush->priv->blurred_pixmap);
 
+  if (g_atomic_int_get (&brush->priv->lazy))
+    return brush->priv->lazy_height;
+
   return gimp_temp_buf_get_height (brush->priv->mask);
 }
 
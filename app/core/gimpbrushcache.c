@@ -33,7 +33,14 @@
 #include "gimp-intl.h"
 
 
-#define MAX_CACHED_DATA 20
+/*  all brush caches share a single LRU list, bounded by the total size of
+ *  the cached data, and by the number of cached units
+ */
+#define MAX_CACHED_MEMSIZE (64 << 20)
+#define MAX_CACHED_UNITS   1024
+
+/*  the number of lookups between hit/miss reports  */
+#define REPORT_INTERVAL    1024
 
 
 enum
@@ -47,28 +54,40 @@ typedef struct _GimpBrushCacheUnit GimpBrushCacheUnit;
 
 struct _GimpBrushCacheUnit
 {
-  gpointer data;
-
-  gint     width;
-  gint     height;
-  gdouble  scale;
-  gdouble  aspect_ratio;
-  gdouble  angle;
-  gboolean reflect;
-  gdouble  hardness;
+  GimpBrushCache *cache;
+  GList           link;
+  gsize           memsize;
+
+  gpointer        data;
+
+  gint            width;
+  gint            height;
+  gdouble         scale;
+  gdouble         aspect_ratio;
+  gdouble         angle;
+  gboolean        reflect;
+  gdouble         hardness;
 };
 
 
-static void   gimp_brush_cache_constructed  (GObject      *object);
-static void   gimp_brush_cache_finalize     (GObject      *object);
-static void   gimp_brush_cache_set_property (GObject      *object,
-                                             guint         property_id,
-                                             const GValue *value,
-                                             GParamSpec   *pspec);
-static void   gimp_brush_cache_get_property (GObject      *object,
-                                             guint         property_id,
-                                             GValue       *value,
-                                             GParamSpec   *pspec);
+static void       gimp_brush_cache_constructed  (GObject            *object);
+static void       gimp_brush_cache_finalize     (GObject            *object);
+static void       gimp_brush_cache_set_property (GObject            *object,
+                                                 guint               property_id,
+                                                 const GValue       *value,
+                                                 GParamSpec         *pspec);
+static void       gimp_brush_cache_get_property (GObject            *object,
+                                                 guint               property_id,
+                                                 GValue             *value,
+                                                 GParamSpec         *pspec);
+
+static guint      gimp_brush_cache_unit_hash    (gconstpointer       key);
+static gboolean   gimp_brush_cache_unit_equal   (gconstpointer       key1,
+                                                 gconstpointer       key2);
+static void       gimp_brush_cache_unit_free    (GimpBrushCacheUnit *unit);
+
+static void       gimp_brush_cache_trim         (void);
+static void       gimp_brush_cache_report       (void);
 
 
 G_DEFINE_TYPE (GimpBrushCache, gimp_brush_cache, GIMP_TYPE_OBJECT)
@@ -76,6 +95,17 @@ G_DEFINE_TYPE (GimpBrushCache, gimp_brush_cache, GIMP_TYPE_OBJECT)
 #define parent_class gimp_brush_cache_parent_class
 
 
+/*  the brush transform functions are called both from the paint thread and
+ *  from the main thread, so the shared state is protected by a lock
+ */
+G_LOCK_DEFINE_STATIC (brush_cache);
+
+static GQueue brush_cache_lru     = G_QUEUE_INIT;
+static gsize  brush_cache_memsize = 0;
+static gint   brush_cache_hits    = 0;
+static gint   brush_cache_misses  = 0;
+
+
 static void
 gimp_brush_cache_class_init (GimpBrushCacheClass *klass)
 {
@@ -94,8 +124,10 @@ gimp_brush_cache_class_init (GimpBrushCacheClass *klass)
 }
 
 static void
-gimp_brush_cache_init (GimpBrushCache *brush)
+gimp_brush_cache_init (GimpBrushCache *cache)
 {
+  cache->units = g_hash_table_new (gimp_brush_cache_unit_hash,
+                                   gimp_brush_cache_unit_equal);
 }
 
 static void
@@ -115,6 +147,8 @@ gimp_brush_cache_finalize (GObject *object)
 
   gimp_brush_cache_clear (cache);
 
+  g_clear_pointer (&cache->units, g_hash_table_unref);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -162,20 +196,23 @@ gimp_brush_cache_get_property (GObject    *object,
 /*  public functions  */
 
 GimpBrushCache *
-gimp_brush_cache_new (GDestroyNotify  data_destroy,
-                      gchar           debug_hit,
-                      gchar           debug_miss)
+gimp_brush_cache_new (GDestroyNotify            data_destroy,
+                      GimpBrushCacheMemsizeFunc data_memsize,
+                      gchar                     debug_hit,
+                      gchar                     debug_miss)
 {
   GimpBrushCache *cache;
 
   g_return_val_if_fail (data_destroy != NULL, NULL);
+  g_return_val_if_fail (data_memsize != NULL, NULL);
 
   cache =  g_object_new (GIMP_TYPE_BRUSH_CACHE,
                          "data-destroy", data_destroy,
                          NULL);
 
-  cache->debug_hit  = debug_hit;
-  cache->debug_miss = debug_miss;
+  cache->data_memsize = data_memsize;
+  cache->debug_hit    = debug_hit;
+  cache->debug_miss   = debug_miss;
 
   return cache;
 }
@@ -183,22 +220,25 @@ gimp_brush_cache_new (GDestroyNotify  data_destroy,
 void
 gimp_brush_cache_clear (GimpBrushCache *cache)
 {
+  GHashTableIter      iter;
+  GimpBrushCacheUnit *unit;
+
   g_return_if_fail (GIMP_IS_BRUSH_CACHE (cache));
 
-  if (cache->cached_units)
-    {
-      GList *iter;
+  G_LOCK (brush_cache);
 
-      for (iter = cache->cached_units; iter; iter = g_list_next (iter))
-        {
-          GimpBrushCacheUnit *unit = iter->data;
+  g_hash_table_iter_init (&iter, cache->units);
 
-          cache->data_destroy (unit->data);
-        }
+  while (g_hash_table_iter_next (&iter, (gpointer *) &unit, NULL))
+    {
+      g_hash_table_iter_remove (&iter);
 
-      g_list_free_full (cache->cached_units, g_free);
-      cache->cached_units = NULL;
+      gimp_brush_cache_unit_free (unit);
     }
+
+  cache->last_unit = NULL;
+
+  G_UNLOCK (brush_cache);
 }
 
 gconstpointer
@@ -211,41 +251,52 @@ gimp_brush_cache_get (GimpBrushCache *cache,
                       gboolean        reflect,
                       gdouble         hardness)
 {
-  GList *iter;
+  GimpBrushCacheUnit  key;
+  GimpBrushCacheUnit *unit;
+  gconstpointer       data = NULL;
 
   g_return_val_if_fail (GIMP_IS_BRUSH_CACHE (cache), NULL);
 
-  for (iter = cache->cached_units; iter; iter = g_list_next (iter))
+  key.width        = width;
+  key.height       = height;
+  key.scale        = scale;
+  key.aspect_ratio = aspect_ratio;
+  key.angle        = angle;
+  key.reflect      = reflect;
+  key.hardness     = hardness;
+
+  G_LOCK (brush_cache);
+
+  unit = g_hash_table_lookup (cache->units, &key);
+
+  if (unit)
     {
-      GimpBrushCacheUnit *unit = iter->data;
+      /* Make the returned cached data first in the list. */
+      g_queue_unlink (&brush_cache_lru, &unit->link);
+      g_queue_push_head_link (&brush_cache_lru, &unit->link);
 
-      if (unit->data                         &&
-          unit->width        == width        &&
-          unit->height       == height       &&
-          unit->scale        == scale        &&
-          unit->aspect_ratio == aspect_ratio &&
-          unit->angle        == angle        &&
-          unit->reflect      == reflect      &&
-          unit->hardness     == hardness)
-        {
-          if (gimp_log_flags & GIMP_LOG_BRUSH_CACHE)
-            g_printerr ("%c", cache->debug_hit);
+      cache->last_unit = unit;
 
-          /* Make the returned cached brush first in the list. */
-          cache->cached_units = g_list_remove_link (cache->cached_units, iter);
-          iter->next = cache->cached_units;
-          if (cache->cached_units)
-            cache->cached_units->prev = iter;
-          cache->cached_units = iter;
+      brush_cache_hits++;
 
-          return (gconstpointer) unit->data;
-        }
+      data = unit->data;
+    }
+  else
+    {
+      brush_cache_misses++;
     }
 
   if (gimp_log_flags & GIMP_LOG_BRUSH_CACHE)
-    g_printerr ("%c", cache->debug_miss);
+    {
+      g_printerr ("%c", unit ? cache->debug_hit : cache->debug_miss);
+
+      if ((brush_cache_hits + brush_cache_misses) % REPORT_INTERVAL == 0)
+        gimp_brush_cache_report ();
+    }
 
-  return NULL;
+  G_UNLOCK (brush_cache);
+
+  return data;
 }
 
 void
@@ -259,36 +310,18 @@ gimp_brush_cache_add (GimpBrushCache *cache,
                       gboolean        reflect,
                       gdouble         hardness)
 {
-  GList              *iter;
   GimpBrushCacheUnit *unit;
-  GList              *last   = NULL;
-  gint                length = 0;
 
   g_return_if_fail (GIMP_IS_BRUSH_CACHE (cache));
   g_return_if_fail (data != NULL);
 
-  for (iter = cache->cached_units; iter; iter = g_list_next (iter))
-    {
-      unit = iter->data;
-
-      if (data == unit->data)
-        return;
-
-      length++;
-      last = iter;
-    }
-
-  if (length > MAX_CACHED_DATA)
-    {
-      unit = last->data;
-
-      cache->data_destroy (unit->data);
-      cache->cached_units = g_list_delete_link (cache->cached_units, last);
-      g_free (unit);
-    }
-
   unit = g_new0 (GimpBrushCacheUnit, 1);
 
+  unit->cache        = cache;
+  unit->link.data    = unit;
+  unit->memsize      = sizeof (GimpBrushCacheUnit) +
+                       cache->data_memsize (data);
+
   unit->data         = data;
   unit->width        = width;
   unit->height       = height;
@@ -298,5 +331,158 @@ gimp_brush_cache_add (GimpBrushCache *cache,
   unit->reflect      = reflect;
   unit->hardness     = hardness;
 
-  cache->cached_units = g_list_prepend (cache->cached_units, unit);
+  G_LOCK (brush_cache);
+
+  /*  replace the data cached under the same key, if any, unless it's the
+   *  same data
+   */
+  if (g_hash_table_contains (cache->units, unit))
+    {
+      GimpBrushCacheUnit *old_unit = g_hash_table_lookup (cache->units, unit);
+
+      if (old_unit->data == data)
+        {
+          G_UNLOCK (brush_cache);
+
+          g_free (unit);
+
+          return;
+        }
+
+      g_hash_table_remove (cache->units, old_unit);
+
+      if (cache->last_unit == old_unit)
+        cache->last_unit = NULL;
+
+      gimp_brush_cache_unit_free (old_unit);
+    }
+
+  g_hash_table_add (cache->units, unit);
+
+  g_queue_push_head_link (&brush_cache_lru, &unit->link);
+  brush_cache_memsize += unit->memsize;
+
+  cache->last_unit = unit;
+
+  gimp_brush_cache_trim ();
+
+  G_UNLOCK (brush_cache);
+}
+
+guint64
+gimp_brush_cache_get_total_memsize (void)
+{
+  guint64 memsize;
+
+  G_LOCK (brush_cache);
+
+  memsize = brush_cache_memsize;
+
+  G_UNLOCK (brush_cache);
+
+  return memsize;
+}
+
+void
+gimp_brush_cache_get_hit_miss (gint *hits,
+                               gint *misses)
+{
+  G_LOCK (brush_cache);
+
+  if (hits)   *hits   = brush_cache_hits;
+  if (misses) *misses = brush_cache_misses;
+
+  G_UNLOCK (brush_cache);
+}
+
+
+/*  private functions  */
+
+static guint
+gimp_brush_cache_unit_hash (gconstpointer key)
+{
+  const GimpBrushCacheUnit *unit = key;
+  guint                     hash;
+
+  hash  = unit->width;
+  hash  = hash * 31 + unit->height;
+  hash  = hash * 31 + g_double_hash (&unit->scale);
+  hash  = hash * 31 + g_double_hash (&unit->aspect_ratio);
+  hash  = hash * 31 + g_double_hash (&unit->angle);
+  hash  = hash * 31 + (unit->reflect ? 1 : 0);
+  hash  = hash * 31 + g_double_hash (&unit->hardness);
+
+  return hash;
+}
+
+static gboolean
+gimp_brush_cache_unit_equal (gconstpointer key1,
+                             gconstpointer key2)
+{
+  const GimpBrushCacheUnit *unit1 = key1;
+  const GimpBrushCacheUnit *unit2 = key2;
+
+  return unit1->width        == unit2->width        &&
+         unit1->height       == unit2->height       &&
+         unit1->scale        == unit2->scale        &&
+         unit1->aspect_ratio == unit2->aspect_ratio &&
+         unit1->angle        == unit2->angle        &&
+         ! unit1->reflect    == ! unit2->reflect    &&
+         unit1->hardness     == unit2->hardness;
+}
+
+/*  called with the lock held, after removing the unit from its cache  */
+static void
+gimp_brush_cache_unit_free (GimpBrushCacheUnit *unit)
+{
+  g_queue_unlink (&brush_cache_lru, &unit->link);
+  brush_cache_memsize -= unit->memsize;
+
+  unit->cache->data_destroy (unit->data);
+
+  g_free (unit);
+}
+
+/*  evicts the least recently used units, until the cache is within its
+ *  limits.  the last unit returned by, or added to, each cache is kept,
+ *  since callers may still be using its data.
+ */
+static void
+gimp_brush_cache_trim (void)
+{
+  GList *iter = brush_cache_lru.tail;
+
+  while (iter &&
+         (brush_cache_memsize    > MAX_CACHED_MEMSIZE ||
+          brush_cache_lru.length > MAX_CACHED_UNITS))
+    {
+      GimpBrushCacheUnit *unit = iter->data;
+
+      iter = iter->prev;
+
+      if (unit == unit->cache->last_unit)
+        continue;
+
+      g_hash_table_remove (unit->cache->units, unit);
+
+      gimp_brush_cache_unit_free (unit);
+    }
+}
+
+/*  called with the lock held  */
+static void
+gimp_brush_cache_report (void)
+{
+  gint n_lookups = brush_cache_hits + brush_cache_misses;
+
+  g_printerr ("\n");
+
+  GIMP_LOG (BRUSH_CACHE,
+            "%d hits, %d misses (%.1f%% hit rate), "
+            "%u units, %" G_GSIZE_FORMAT " bytes",
+            brush_cache_hits,
+            brush_cache_misses,
+            n_lookups ? 100.0 * brush_cache_hits / n_lookups : 0.0,
+            brush_cache_lru.length,
+            brush_cache_memsize);
 }
@@ -33,16 +33,20 @@
 
 typedef struct _GimpBrushCacheClass GimpBrushCacheClass;
 
+typedef gsize (* GimpBrushCacheMemsizeFunc) (gconstpointer data);
+
 struct _GimpBrushCache
 {
-  GimpObject      parent_instance;
+  GimpObject                 parent_instance;
 
-  GDestroyNotify  data_destroy;
+  GDestroyNotify             data_destroy;
+  GimpBrushCacheMemsizeFunc  data_memsize;
 
-  GList          *cached_units;
+  GHashTable                *units;
+  gpointer                   last_unit;
 
-  gchar           debug_hit;
-  gchar           debug_miss;
+  gchar                      debug_hit;
+  gchar                      debug_miss;
 };
 
 struct _GimpBrushCacheClass
@@ -53,9 +57,10 @@ struct _GimpBrushCacheClass
 
 GType            gimp_brush_cache_get_type (void) G_GNUC_CONST;
 
-GimpBrushCache * gimp_brush_cache_new      (GDestroyNotify  data_destory,
-                                            gchar           debug_hit,
-                                            gchar           debug_miss);
+GimpBrushCache * gimp_brush_cache_new      (GDestroyNotify            data_destory,
+                                            GimpBrushCacheMemsizeFunc data_memsize,
+                                            gchar                     debug_hit,
+                                            gchar                     debug_miss);
 
 void             gimp_brush_cache_clear    (GimpBrushCache *cache);
 
@@ -76,3 +81,7 @@ void             gimp_brush_cache_add      (GimpBrushCache *cache,
                                             gdouble         angle,
                                             gboolean        reflect,
                                             gdouble         hardness);
+
+guint64          gimp_brush_cache_get_total_memsize (void);
+void             gimp_brush_cache_get_hit_miss      (gint           *hits,
+                                                     gint           *misses);
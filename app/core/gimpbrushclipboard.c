@@ -234,7 +234,7 @@ gimp_brush_clipboard_changed (Gimp      *gimp,
               pickables = g_list_prepend (NULL, GIMP_IMAGE (paste));
               buffer = gimp_selection_extract (GIMP_SELECTION (mask),
                                                pickables, context,
-                                               FALSE, FALSE, FALSE,
+                                               FALSE, FALSE, FALSE, 0,
                                                &offset_x, &offset_y,
                                                NULL);
               g_list_free (pickables);
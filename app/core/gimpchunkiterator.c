@@ -528,6 +528,67 @@ gimp_chunk_iterator_get_rect (GimpChunkIterator *iter,
   return TRUE;
 }
 
+/* estimates the area processed by the next iteration, without advancing
+ * the iterator, so that its input can be prepared ahead of time.  this is
+ * only a hint: the actual area depends on the timing of the iteration,
+ * and on the priority rect.
+ */
+gboolean
+gimp_chunk_iterator_peek_rect (GimpChunkIterator *iter,
+                               GeglRectangle     *rect)
+{
+  GeglRectangle bounds;
+  gdouble       target_area;
+  gint          x;
+  gint          y;
+  gint          height;
+
+  g_return_val_if_fail (iter != NULL, FALSE);
+  g_return_val_if_fail (rect != NULL, FALSE);
+
+  bounds = iter->current_rect;
+  x      = iter->current_x;
+  y      = iter->current_y;
+  height = iter->current_height;
+
+  if (x == bounds.x + bounds.width)
+    {
+      x       = bounds.x;
+      y      += height;
+      height  = 0;
+    }
+
+  if (y == bounds.y + bounds.height)
+    {
+      if (cairo_region_is_empty (iter->current_region))
+        return FALSE;
+
+      cairo_region_get_rectangle (iter->current_region, 0,
+                                  (cairo_rectangle_int_t *) &bounds);
+
+      x      = bounds.x;
+      y      = bounds.y;
+      height = 0;
+    }
+
+  if (! height)
+    {
+      target_area = gimp_chunk_iterator_get_target_area (iter);
+
+      height = ceil (target_area / bounds.width);
+      height = MAX (height, iter->tile_rect.height);
+      height = MIN (height, bounds.y + bounds.height - y);
+      height = MIN (height, MAX_CHUNK_HEIGHT);
+    }
+
+  rect->x      = x;
+  rect->y      = y;
+  rect->width  = MIN (bounds.x + bounds.width - x, MAX_CHUNK_WIDTH);
+  rect->height = height;
+
+  return ! gegl_rectangle_is_empty (rect);
+}
+
 cairo_region_t *
 gimp_chunk_iterator_stop (GimpChunkIterator *iter,
                           gboolean           free_region)
@@ -35,6 +35,8 @@ void                gimp_chunk_iterator_set_interval      (GimpChunkIterator   *
 gboolean            gimp_chunk_iterator_next              (GimpChunkIterator   *iter);
 gboolean            gimp_chunk_iterator_get_rect          (GimpChunkIterator   *iter,
                                                            GeglRectangle       *rect);
+gboolean            gimp_chunk_iterator_peek_rect         (GimpChunkIterator   *iter,
+                                                           GeglRectangle       *rect);
 
 cairo_region_t    * gimp_chunk_iterator_stop              (GimpChunkIterator   *iter,
                                                            gboolean             free_region);
@@ -20,6 +20,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <cairo.h>
 #include <gegl.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
@@ -159,6 +161,9 @@ static void gimp_context_real_set_foreground (GimpContext      *context,
 static void gimp_context_real_set_background (GimpContext      *context,
                                               GeglColor        *color);
 
+static gboolean gimp_context_color_equal     (GeglColor        *color1,
+                                              GeglColor        *color2);
+
 /*  opacity  */
 static void gimp_context_real_set_opacity    (GimpContext      *context,
                                               gdouble           opacity);
@@ -1659,11 +1664,16 @@ gimp_context_copy_property (GimpContext         *src,
       break;
 
     case GIMP_CONTEXT_PROP_FOREGROUND:
-      gimp_context_real_set_foreground (dest, src->foreground);
+      /*  unlike the other setters, the color setters always emit, so
+       *  don't let copying an unchanged color reach all their users
+       */
+      if (! gimp_context_color_equal (dest->foreground, src->foreground))
+        gimp_context_real_set_foreground (dest, src->foreground);
       break;
 
     case GIMP_CONTEXT_PROP_BACKGROUND:
-      gimp_context_real_set_background (dest, src->background);
+      if (! gimp_context_color_equal (dest->background, src->background))
+        gimp_context_real_set_background (dest, src->background);
       break;
 
     case GIMP_CONTEXT_PROP_OPACITY:
@@ -1744,9 +1754,13 @@ gimp_context_copy_properties (GimpContext         *src,
   g_return_if_fail (GIMP_IS_CONTEXT (src));
   g_return_if_fail (GIMP_IS_CONTEXT (dest));
 
+  g_object_freeze_notify (G_OBJECT (dest));
+
   for (prop = GIMP_CONTEXT_PROP_FIRST; prop <= GIMP_CONTEXT_PROP_LAST; prop++)
     if ((1 << prop) & prop_mask)
       gimp_context_copy_property (src, dest, prop);
+
+  g_object_thaw_notify (G_OBJECT (dest));
 }
 
 
@@ -2463,6 +2477,31 @@ gimp_context_real_set_background (GimpContext *context,
   gimp_context_background_changed (context);
 }
 
+static gboolean
+gimp_context_color_equal (GeglColor *color1,
+                          GeglColor *color2)
+{
+  const Babl *format;
+  guint8      pixel1[48];
+  guint8      pixel2[48];
+
+  if (color1 == color2)
+    return TRUE;
+
+  if (! color1 || ! color2)
+    return FALSE;
+
+  format = gegl_color_get_format (color1);
+
+  if (format != gegl_color_get_format (color2))
+    return FALSE;
+
+  gegl_color_get_pixel (color1, format, pixel1);
+  gegl_color_get_pixel (color2, format, pixel2);
+
+  return ! memcmp (pixel1, pixel2, babl_format_get_bytes_per_pixel (format));
+}
+
 
 /*****************************************************************************/
 /*  color utility functions  *************************************************/
@@ -31,6 +31,7 @@
 #include "core-types.h"
 
 #include "gimp.h"
+#include "gimp-startup-profile.h"
 #include "gimp-utils.h"
 #include "gimpasyncset.h"
 #include "gimpcancelable.h"
@@ -523,10 +524,13 @@ gimp_data_factory_data_init (GimpDataFactory *factory,
 {
   GimpDataFactoryPrivate *priv = GET_PRIVATE (factory);
   gchar                  *signal_name;
+  gint64                  profile_time;
 
   g_return_if_fail (GIMP_IS_DATA_FACTORY (factory));
   g_return_if_fail (GIMP_IS_CONTEXT (context));
 
+  profile_time = gimp_startup_profile_begin ();
+
   /*  Always freeze() and thaw() the container around initialization,
    *  even if no_data, the thaw() will implicitly make GimpContext
    *  create the standard data that serves as fallback.
@@ -547,6 +551,13 @@ gimp_data_factory_data_init (GimpDataFactory *factory,
 
   gimp_container_thaw (priv->container);
 
+  if (gimp_startup_profile_enabled ())
+    {
+      const gchar *name = gimp_object_get_name (factory);
+
+      gimp_startup_profile_end (name ? name : "???", profile_time);
+    }
+
   signal_name = g_strdup_printf ("notify::%s", priv->path_property_name);
   g_signal_connect_object (priv->gimp->config, signal_name,
                            G_CALLBACK (gimp_data_factory_path_notify),
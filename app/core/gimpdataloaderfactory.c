@@ -20,6 +20,7 @@
 
 #include "config.h"
 
+#include <errno.h>
 #include <string.h>
 
 #include <gdk-pixbuf/gdk-pixbuf.h>
@@ -43,15 +44,52 @@
  */
 #define GIMP_OBSOLETE_DATA_DIR_NAME "gimp-obsolete-files"
 
+/* The index of a data directory lives in the cache directory, and
+ * records the header of each indexable file, so that files which did
+ * not change since the last run are not read at all
+ */
+#define GIMP_DATA_INDEX_DIR_NAME "data-index"
+#define GIMP_DATA_INDEX_VERSION  1
+#define GIMP_DATA_INDEX_GROUP    "index"
+
 
-typedef struct _GimpDataLoader GimpDataLoader;
+typedef struct _GimpDataLoader  GimpDataLoader;
+typedef struct _GimpDataLoadJob GimpDataLoadJob;
+typedef struct _GimpDataIndex   GimpDataIndex;
 
 struct _GimpDataLoader
 {
-  gchar            *name;
-  GimpDataLoadFunc  load_func;
-  gchar            *extension;
-  gboolean          writable;
+  gchar                  *name;
+  GimpDataLoadFunc        load_func;
+  gchar                  *extension;
+  gboolean                writable;
+
+  GimpDataIndexReadFunc   index_read_func;
+  GimpDataIndexWriteFunc  index_write_func;
+};
+
+struct _GimpDataIndex
+{
+  GFile    *top_directory;
+  gchar    *filename;
+  GKeyFile *entries;      /*  as read from disk      */
+  GKeyFile *new_entries;  /*  as found by this scan  */
+};
+
+struct _GimpDataLoadJob
+{
+  GimpDataLoader *loader;
+  GimpContext    *context;
+  GFile          *file;
+  GFile          *top_directory;
+  GimpDataIndex  *index;
+  gboolean        dir_writable;
+  guint64         mtime;
+  guint64         size;
+
+  gboolean        indexed;
+  GList          *data_list;
+  GError         *error;
 };
 
 
@@ -59,6 +97,9 @@ struct _GimpDataLoaderFactoryPrivate
 {
   GList          *loaders;
   GimpDataLoader *fallback;
+
+  gboolean        parallel;
+  GPtrArray      *jobs;
 };
 
 #define GET_PRIVATE(obj) (((GimpDataLoaderFactory *) (obj))->priv)
@@ -83,14 +124,41 @@ static void   gimp_data_loader_factory_load_directory (GimpDataFactory *factory,
                                                        GHashTable      *cache,
                                                        gboolean         dir_writable,
                                                        GFile           *directory,
-                                                       GFile           *top_directory);
+                                                       GFile           *top_directory,
+                                                       GimpDataIndex   *index);
 static void   gimp_data_loader_factory_load_data      (GimpDataFactory *factory,
                                                        GimpContext     *context,
                                                        GHashTable      *cache,
                                                        gboolean         dir_writable,
                                                        GFile           *file,
                                                        GFileInfo       *info,
+                                                       GFile           *top_directory,
+                                                       GimpDataIndex   *index);
+
+static void   gimp_data_loader_factory_run_job        (GimpDataLoadJob *job);
+static void   gimp_data_loader_factory_run_jobs       (gsize            offset,
+                                                       gsize            size,
+                                                       gpointer         data);
+static void   gimp_data_loader_factory_finish_job     (GimpDataFactory *factory,
+                                                       GimpDataLoadJob *job);
+static void   gimp_data_load_job_free                 (GimpDataLoadJob *job);
+
+static GimpDataIndex * gimp_data_index_new            (GimpDataFactory *factory,
                                                        GFile           *top_directory);
+static void            gimp_data_index_free           (GimpDataIndex   *index);
+static gchar         * gimp_data_index_get_group      (GimpDataIndex   *index,
+                                                       GFile           *file);
+static GimpData      * gimp_data_index_lookup         (GimpDataIndex   *index,
+                                                       GimpDataLoader  *loader,
+                                                       GFile           *file,
+                                                       guint64          mtime,
+                                                       guint64          size);
+static void            gimp_data_index_add            (GimpDataIndex   *index,
+                                                       GimpDataLoader  *loader,
+                                                       GFile           *file,
+                                                       guint64          mtime,
+                                                       guint64          size,
+                                                       GimpData        *data);
 
 static GimpDataLoader * gimp_data_loader_new          (const gchar     *name,
                                                        GimpDataLoadFunc load_func,
@@ -289,6 +357,73 @@ gimp_data_loader_factory_add_fallback (GimpDataFactory  *factory,
   priv->fallback = gimp_data_loader_new (name, load_func, NULL, FALSE);
 }
 
+/**
+ * gimp_data_loader_factory_set_parallel:
+ * @factory:  a #GimpDataLoaderFactory
+ * @parallel: whether to run the loaders in parallel
+ *
+ * Makes @factory run its loaders on all configured threads, when
+ * loading or refreshing its data.  The loaders must then be
+ * thread-safe, and not use their #GimpContext.
+ *
+ * The data objects are added to the factory's container on the main
+ * thread, in the same order as when loading serially.
+ **/
+void
+gimp_data_loader_factory_set_parallel (GimpDataFactory *factory,
+                                       gboolean         parallel)
+{
+  g_return_if_fail (GIMP_IS_DATA_LOADER_FACTORY (factory));
+
+  GET_PRIVATE (factory)->parallel = parallel ? TRUE : FALSE;
+}
+
+/**
+ * gimp_data_loader_factory_set_index_funcs:
+ * @factory:    a #GimpDataLoaderFactory
+ * @extension:  the extension of an already added loader
+ * @read_func:  creates a data object from its index entry
+ * @write_func: writes a single-object file's data to its index entry
+ *
+ * Makes @factory remember the files of the loader for @extension in
+ * the index of their data directory.  On the next start, the files
+ * whose modification time and size did not change are created by
+ * @read_func from their entry, without being opened.
+ *
+ * @read_func is called on the main thread.
+ **/
+void
+gimp_data_loader_factory_set_index_funcs (GimpDataFactory        *factory,
+                                          const gchar            *extension,
+                                          GimpDataIndexReadFunc   read_func,
+                                          GimpDataIndexWriteFunc  write_func)
+{
+  GimpDataLoaderFactoryPrivate *priv;
+  GList                        *list;
+
+  g_return_if_fail (GIMP_IS_DATA_LOADER_FACTORY (factory));
+  g_return_if_fail (extension != NULL);
+  g_return_if_fail (read_func != NULL);
+  g_return_if_fail (write_func != NULL);
+
+  priv = GET_PRIVATE (factory);
+
+  for (list = priv->loaders; list; list = g_list_next (list))
+    {
+      GimpDataLoader *loader = list->data;
+
+      if (! g_strcmp0 (loader->extension, extension))
+        {
+          loader->index_read_func  = read_func;
+          loader->index_write_func = write_func;
+
+          return;
+        }
+    }
+
+  g_return_if_reached ();
+}
+
 
 /*  private functions  */
 
@@ -315,10 +450,19 @@ gimp_data_loader_factory_load (GimpDataFactory *factory,
                                GimpContext     *context,
                                GHashTable      *cache)
 {
-  const GList *ext_path;
-  GList       *path;
-  GList       *writable_path;
-  GList       *list;
+  GimpDataLoaderFactoryPrivate *priv = GET_PRIVATE (factory);
+  const GList                  *ext_path;
+  GList                        *path;
+  GList                        *writable_path;
+  GList                        *indices = NULL;
+  GList                        *list;
+
+  /*  while walking the directories, only collect the files that need
+   *  loading, then load them all at once below
+   */
+  if (priv->parallel)
+    priv->jobs = g_ptr_array_new_with_free_func (
+      (GDestroyNotify) gimp_data_load_job_free);
 
   path          = gimp_data_factory_get_data_path          (factory);
   writable_path = gimp_data_factory_get_data_path_writable (factory);
@@ -331,15 +475,25 @@ gimp_data_loader_factory_load (GimpDataFactory *factory,
        * writable, since writability of extension is only taken into
        * account for extension update).
        */
+      GimpDataIndex *index = gimp_data_index_new (factory, list->data);
+
+      if (index)
+        indices = g_list_prepend (indices, index);
+
       gimp_data_loader_factory_load_directory (factory, context, cache,
                                                FALSE,
                                                list->data,
-                                               list->data);
+                                               list->data,
+                                               index);
     }
 
   for (list = path; list; list = g_list_next (list))
     {
-      gboolean dir_writable = FALSE;
+      GimpDataIndex *index        = gimp_data_index_new (factory, list->data);
+      gboolean       dir_writable = FALSE;
+
+      if (index)
+        indices = g_list_prepend (indices, index);
 
       if (g_list_find_custom (writable_path, list->data,
                               (GCompareFunc) gimp_file_compare))
@@ -348,11 +502,34 @@ gimp_data_loader_factory_load (GimpDataFactory *factory,
       gimp_data_loader_factory_load_directory (factory, context, cache,
                                                dir_writable,
                                                list->data,
-                                               list->data);
+                                               list->data,
+                                               index);
     }
 
   g_list_free_full (path,          (GDestroyNotify) g_object_unref);
   g_list_free_full (writable_path, (GDestroyNotify) g_object_unref);
+
+  if (priv->jobs)
+    {
+      GPtrArray *jobs = g_steal_pointer (&priv->jobs);
+      gint       i;
+
+      if (jobs->len > 0)
+        {
+          gegl_parallel_distribute_range (
+            jobs->len, 1,
+            gimp_data_loader_factory_run_jobs,
+            jobs->pdata);
+        }
+
+      for (i = 0; i < jobs->len; i++)
+        gimp_data_loader_factory_finish_job (factory, jobs->pdata[i]);
+
+      g_ptr_array_unref (jobs);
+    }
+
+  /*  the jobs are done, write back the indices which changed  */
+  g_list_free_full (indices, (GDestroyNotify) gimp_data_index_free);
 }
 
 static void
@@ -361,7 +538,8 @@ gimp_data_loader_factory_load_directory (GimpDataFactory *factory,
                                          GHashTable      *cache,
                                          gboolean         dir_writable,
                                          GFile           *directory,
-                                         GFile           *top_directory)
+                                         GFile           *top_directory,
+                                         GimpDataIndex   *index)
 {
   GFileEnumerator *enumerator;
 
@@ -369,6 +547,7 @@ gimp_data_loader_factory_load_directory (GimpDataFactory *factory,
                                           G_FILE_ATTRIBUTE_STANDARD_NAME ","
                                           G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN ","
                                           G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                                          G_FILE_ATTRIBUTE_STANDARD_SIZE ","
                                           G_FILE_ATTRIBUTE_TIME_MODIFIED,
                                           G_FILE_QUERY_INFO_NONE,
                                           NULL, NULL);
@@ -396,14 +575,16 @@ gimp_data_loader_factory_load_directory (GimpDataFactory *factory,
               gimp_data_loader_factory_load_directory (factory, context, cache,
                                                        dir_writable,
                                                        child,
-                                                       top_directory);
+                                                       top_directory,
+                                                       index);
             }
           else if (file_type == G_FILE_TYPE_REGULAR)
             {
               gimp_data_loader_factory_load_data (factory, context, cache,
                                                   dir_writable,
                                                   child, info,
-                                                  top_directory);
+                                                  top_directory,
+                                                  index);
             }
 
           g_object_unref (child);
@@ -421,29 +602,28 @@ gimp_data_loader_factory_load_data (GimpDataFactory *factory,
                                     gboolean         dir_writable,
                                     GFile           *file,
                                     GFileInfo       *info,
-                                    GFile           *top_directory)
+                                    GFile           *top_directory,
+                                    GimpDataIndex   *index)
 {
-  GimpDataLoader *loader;
-  GimpContainer  *container;
-  GimpContainer  *container_obsolete;
-  GList          *data_list = NULL;
-  GInputStream   *input;
-  guint64         mtime;
-  GError         *error = NULL;
+  GimpDataLoaderFactoryPrivate *priv = GET_PRIVATE (factory);
+  GimpDataLoader               *loader;
+  GimpDataLoadJob              *job;
+  GimpData                     *data;
+  guint64                       mtime;
+  guint64                       size;
 
   loader = gimp_data_loader_factory_get_loader (factory, file);
 
   if (! loader)
     return;
 
-  container          = gimp_data_factory_get_container          (factory);
-  container_obsolete = gimp_data_factory_get_container_obsolete (factory);
-
   if (gimp_data_factory_get_gimp (factory)->be_verbose)
     g_print ("  Loading %s\n", gimp_file_get_utf8_name (file));
 
   mtime = g_file_info_get_attribute_uint64 (info,
                                             G_FILE_ATTRIBUTE_TIME_MODIFIED);
+  size  = g_file_info_get_attribute_uint64 (info,
+                                            G_FILE_ATTRIBUTE_STANDARD_SIZE);
 
   if (cache)
     {
@@ -453,32 +633,82 @@ gimp_data_loader_factory_load_data (GimpDataFactory *factory,
           gimp_data_get_mtime (cached_data->data) != 0 &&
           gimp_data_get_mtime (cached_data->data) == mtime)
         {
-          GList *list;
+          GimpContainer *container = gimp_data_factory_get_container (factory);
+          GList         *list;
 
           for (list = cached_data; list; list = g_list_next (list))
             gimp_container_add (container, list->data);
 
+          if (! cached_data->next)
+            gimp_data_index_add (index, loader, file, mtime, size,
+                                 cached_data->data);
+
           return;
         }
     }
 
-  input = G_INPUT_STREAM (g_file_read (file, NULL, &error));
+  job = g_slice_new0 (GimpDataLoadJob);
+
+  job->loader        = loader;
+  job->context       = context;
+  job->file          = g_object_ref (file);
+  job->top_directory = g_object_ref (top_directory);
+  job->index         = index;
+  job->dir_writable  = dir_writable;
+  job->mtime         = mtime;
+  job->size          = size;
+
+  data = gimp_data_index_lookup (index, loader, file, mtime, size);
+
+  if (data)
+    {
+      job->data_list = g_list_prepend (NULL, data);
+      job->indexed   = TRUE;
+    }
+
+  if (priv->jobs)
+    {
+      g_ptr_array_add (priv->jobs, job);
+    }
+  else
+    {
+      gimp_data_loader_factory_run_job (job);
+      gimp_data_loader_factory_finish_job (factory, job);
+
+      gimp_data_load_job_free (job);
+    }
+}
+
+/*  runs the job's loader, may be called from any thread when the
+ *  factory is parallel
+ */
+static void
+gimp_data_loader_factory_run_job (GimpDataLoadJob *job)
+{
+  GFile        *file = job->file;
+  GInputStream *input;
+
+  if (job->indexed)
+    return;
+
+  input = G_INPUT_STREAM (g_file_read (file, NULL, &job->error));
 
   if (input)
     {
       GInputStream *buffered = g_buffered_input_stream_new (input);
 
-      data_list = loader->load_func (context, file, buffered, &error);
+      job->data_list = job->loader->load_func (job->context, file, buffered,
+                                               &job->error);
 
-      if (error)
+      if (job->error)
         {
-          g_prefix_error (&error,
+          g_prefix_error (&job->error,
                           _("Error loading '%s': "),
                           gimp_file_get_utf8_name (file));
         }
-      else if (! data_list)
+      else if (! job->data_list)
         {
-          g_set_error (&error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
+          g_set_error (&job->error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
                        _("Error loading '%s'"),
                        gimp_file_get_utf8_name (file));
         }
@@ -488,12 +718,36 @@ gimp_data_loader_factory_load_data (GimpDataFactory *factory,
     }
   else
     {
-      g_prefix_error (&error,
+      g_prefix_error (&job->error,
                       _("Could not open '%s' for reading: "),
                       gimp_file_get_utf8_name (file));
     }
+}
+
+static void
+gimp_data_loader_factory_run_jobs (gsize    offset,
+                                   gsize    size,
+                                   gpointer data)
+{
+  GimpDataLoadJob **jobs = data;
+  gsize             i;
+
+  for (i = offset; i < offset + size; i++)
+    gimp_data_loader_factory_run_job (jobs[i]);
+}
 
-  if (G_LIKELY (data_list))
+/*  adds the job's data to the factory, on the main thread  */
+static void
+gimp_data_loader_factory_finish_job (GimpDataFactory *factory,
+                                     GimpDataLoadJob *job)
+{
+  GimpContainer *container;
+  GimpContainer *container_obsolete;
+
+  container          = gimp_data_factory_get_container          (factory);
+  container_obsolete = gimp_data_factory_get_container_obsolete (factory);
+
+  if (G_LIKELY (job->data_list))
     {
       GList    *list;
       gchar    *uri;
@@ -501,7 +755,7 @@ gimp_data_loader_factory_load_data (GimpDataFactory *factory,
       gboolean  writable  = FALSE;
       gboolean  deletable = FALSE;
 
-      uri = g_file_get_uri (file);
+      uri = g_file_get_uri (job->file);
 
       obsolete = (strstr (uri, GIMP_OBSOLETE_DATA_DIR_NAME) != 0);
 
@@ -510,16 +764,21 @@ gimp_data_loader_factory_load_data (GimpDataFactory *factory,
       /* obsolete files are immutable, don't check their writability */
       if (! obsolete)
         {
-          deletable = (g_list_length (data_list) == 1 && dir_writable);
-          writable  = (deletable && loader->writable);
+          deletable = (g_list_length (job->data_list) == 1 &&
+                       job->dir_writable);
+          writable  = (deletable && job->loader->writable);
         }
 
-      for (list = data_list; list; list = g_list_next (list))
+      if (! job->data_list->next && ! job->error)
+        gimp_data_index_add (job->index, job->loader, job->file,
+                             job->mtime, job->size, job->data_list->data);
+
+      for (list = job->data_list; list; list = g_list_next (list))
         {
           GimpData *data = list->data;
 
-          gimp_data_set_file (data, file, writable, deletable);
-          gimp_data_set_mtime (data, mtime);
+          gimp_data_set_file (data, job->file, writable, deletable);
+          gimp_data_set_mtime (data, job->mtime);
           gimp_data_clean (data);
 
           if (obsolete)
@@ -529,7 +788,7 @@ gimp_data_loader_factory_load_data (GimpDataFactory *factory,
             }
           else
             {
-              gimp_data_set_folder_tags (data, top_directory);
+              gimp_data_set_folder_tags (data, job->top_directory);
 
               gimp_container_add (container,
                                   GIMP_OBJECT (data));
@@ -538,19 +797,201 @@ gimp_data_loader_factory_load_data (GimpDataFactory *factory,
           g_object_unref (data);
         }
 
-      g_list_free (data_list);
+      g_clear_pointer (&job->data_list, g_list_free);
     }
 
   /*  not else { ... } because loader->load_func() can return a list
    *  of data objects *and* an error message if loading failed after
    *  something was already loaded
    */
-  if (G_UNLIKELY (error))
+  if (G_UNLIKELY (job->error))
     {
       gimp_message (gimp_data_factory_get_gimp (factory), NULL,
                     GIMP_MESSAGE_ERROR,
-                    _("Failed to load data:\n\n%s"), error->message);
+                    _("Failed to load data:\n\n%s"), job->error->message);
+      g_clear_error (&job->error);
+    }
+}
+
+static void
+gimp_data_load_job_free (GimpDataLoadJob *job)
+{
+  g_list_free_full (job->data_list, (GDestroyNotify) g_object_unref);
+  g_clear_error (&job->error);
+
+  g_object_unref (job->file);
+  g_object_unref (job->top_directory);
+
+  g_slice_free (GimpDataLoadJob, job);
+}
+
+static GimpDataIndex *
+gimp_data_index_new (GimpDataFactory *factory,
+                     GFile           *top_directory)
+{
+  GimpDataLoaderFactoryPrivate *priv = GET_PRIVATE (factory);
+  GimpDataIndex                *index;
+  GList                        *list;
+  gchar                        *uri;
+  gchar                        *checksum;
+  gchar                        *basename;
+
+  for (list = priv->loaders; list; list = g_list_next (list))
+    {
+      GimpDataLoader *loader = list->data;
+
+      if (loader->index_read_func)
+        break;
+    }
+
+  if (! list)
+    return NULL;
+
+  uri      = g_file_get_uri (top_directory);
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_MD5, uri, -1);
+  basename = g_strconcat (checksum, ".index", NULL);
+
+  index = g_slice_new0 (GimpDataIndex);
+
+  index->top_directory = g_object_ref (top_directory);
+  index->filename      = g_build_filename (gimp_cache_directory (),
+                                           GIMP_DATA_INDEX_DIR_NAME,
+                                           basename, NULL);
+  index->entries       = g_key_file_new ();
+  index->new_entries   = g_key_file_new ();
+
+  if (! g_key_file_load_from_file (index->entries, index->filename,
+                                   G_KEY_FILE_NONE, NULL) ||
+      g_key_file_get_integer (index->entries,
+                              GIMP_DATA_INDEX_GROUP, "version",
+                              NULL) != GIMP_DATA_INDEX_VERSION)
+    {
+      g_key_file_unref (index->entries);
+      index->entries = g_key_file_new ();
+    }
+
+  g_key_file_set_integer (index->new_entries,
+                          GIMP_DATA_INDEX_GROUP, "version",
+                          GIMP_DATA_INDEX_VERSION);
+  g_key_file_set_string (index->new_entries,
+                         GIMP_DATA_INDEX_GROUP, "directory", uri);
+
+  g_free (basename);
+  g_free (checksum);
+  g_free (uri);
+
+  return index;
+}
+
+static void
+gimp_data_index_free (GimpDataIndex *index)
+{
+  gchar *old_data = g_key_file_to_data (index->entries,     NULL, NULL);
+  gchar *new_data = g_key_file_to_data (index->new_entries, NULL, NULL);
+
+  if (strcmp (old_data, new_data))
+    {
+      gchar  *dirname = g_path_get_dirname (index->filename);
+      GError *error   = NULL;
+
+      if (g_mkdir_with_parents (dirname, 0700) != 0 ||
+          ! g_file_set_contents (index->filename, new_data, -1, &error))
+        {
+          /*  the index is just a cache, don't bother the user  */
+          g_printerr ("Failed to write data index '%s': %s\n",
+                      gimp_filename_to_utf8 (index->filename),
+                      error ? error->message : g_strerror (errno));
+        }
+
       g_clear_error (&error);
+      g_free (dirname);
+    }
+
+  g_free (new_data);
+  g_free (old_data);
+
+  g_key_file_unref (index->new_entries);
+  g_key_file_unref (index->entries);
+  g_free (index->filename);
+  g_object_unref (index->top_directory);
+
+  g_slice_free (GimpDataIndex, index);
+}
+
+static gchar *
+gimp_data_index_get_group (GimpDataIndex *index,
+                           GFile         *file)
+{
+  gchar *path = g_file_get_relative_path (index->top_directory, file);
+  gchar *group;
+
+  if (! path)
+    return NULL;
+
+  /*  key file groups may not contain '[' and ']'  */
+  group = g_uri_escape_string (path, "/", TRUE);
+
+  g_free (path);
+
+  return group;
+}
+
+static GimpData *
+gimp_data_index_lookup (GimpDataIndex  *index,
+                        GimpDataLoader *loader,
+                        GFile          *file,
+                        guint64         mtime,
+                        guint64         size)
+{
+  GimpData *data = NULL;
+  gchar    *group;
+
+  if (! index || ! loader->index_read_func)
+    return NULL;
+
+  group = gimp_data_index_get_group (index, file);
+
+  if (group                                        &&
+      g_key_file_has_group (index->entries, group) &&
+      g_key_file_get_uint64 (index->entries, group, "mtime", NULL) == mtime &&
+      g_key_file_get_uint64 (index->entries, group, "size",  NULL) == size)
+    {
+      data = loader->index_read_func (index->entries, group, NULL);
+    }
+
+  g_free (group);
+
+  return data;
+}
+
+static void
+gimp_data_index_add (GimpDataIndex  *index,
+                     GimpDataLoader *loader,
+                     GFile          *file,
+                     guint64         mtime,
+                     guint64         size,
+                     GimpData       *data)
+{
+  gchar *group;
+
+  if (! index || ! loader->index_write_func || mtime == 0)
+    return;
+
+  group = gimp_data_index_get_group (index, file);
+
+  if (group)
+    {
+      if (loader->index_write_func (data, index->new_entries, group))
+        {
+          g_key_file_set_uint64 (index->new_entries, group, "mtime", mtime);
+          g_key_file_set_uint64 (index->new_entries, group, "size",  size);
+        }
+      else
+        {
+          g_key_file_remove_group (index->new_entries, group, NULL);
+        }
+
+      g_free (group);
     }
 }
 
@@ -560,7 +1001,7 @@ gimp_data_loader_new (const gchar      *name,
                       const gchar      *extension,
                       gboolean          writable)
 {
-  GimpDataLoader *loader = g_slice_new (GimpDataLoader);
+  GimpDataLoader *loader = g_slice_new0 (GimpDataLoader);
 
   loader->name      = g_strdup (name);
   loader->load_func = load_func;
@@ -28,6 +28,13 @@ typedef GList * (* GimpDataLoadFunc) (GimpContext   *context,
                                       GInputStream  *input,
                                       GError       **error);
 
+typedef GimpData * (* GimpDataIndexReadFunc)  (GKeyFile     *index,
+                                               const gchar  *group,
+                                               GError      **error);
+typedef gboolean   (* GimpDataIndexWriteFunc) (GimpData     *data,
+                                               GKeyFile     *index,
+                                               const gchar  *group);
+
 
 #define GIMP_TYPE_DATA_LOADER_FACTORY            (gimp_data_loader_factory_get_type ())
 #define GIMP_DATA_LOADER_FACTORY(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GIMP_TYPE_DATA_LOADER_FACTORY, GimpDataLoaderFactory))
@@ -71,3 +78,10 @@ void              gimp_data_loader_factory_add_loader   (GimpDataFactory
 void              gimp_data_loader_factory_add_fallback (GimpDataFactory         *factory,
                                                          const gchar             *name,
                                                          GimpDataLoadFunc         load_func);
+void              gimp_data_loader_factory_set_parallel (GimpDataFactory         *factory,
+                                                         gboolean                 parallel);
+void              gimp_data_loader_factory_set_index_funcs
+                                                        (GimpDataFactory         *factory,
+                                                         const gchar             *extension,
+                                                         GimpDataIndexReadFunc    read_func,
+                                                         GimpDataIndexWriteFunc   write_func);
@@ -50,6 +50,20 @@
 #include "gimp-intl.h"
 
 
+/*  the bounds of a fill mask are cached on it, so that successive
+ *  interactive fills only process the filled part of the mask
+ */
+#define MASK_BOUNDS_KEY "gimp-bucket-fill-mask-bounds"
+
+
+/*  local function prototypes  */
+
+static void   gimp_drawable_bucket_fill_set_mask_bounds (GeglBuffer          *mask,
+                                                         const GeglRectangle *bounds);
+static void   gimp_drawable_bucket_fill_get_mask_bounds (GeglBuffer          *mask,
+                                                         GeglRectangle       *bounds);
+
+
 /*  public functions  */
 
 void
@@ -152,15 +166,16 @@ gimp_drawable_get_bucket_fill_buffer (GimpDrawable         *drawable,
                                       gint                 *mask_width,
                                       gint                 *mask_height)
 {
-  GimpImage    *image;
-  GimpPickable *pickable;
-  GeglBuffer   *buffer;
-  GeglBuffer   *new_mask;
-  gboolean      antialias;
-  gint          x, y, width, height;
-  gint          mask_offset_x = 0;
-  gint          mask_offset_y = 0;
-  gint          sel_x, sel_y, sel_width, sel_height;
+  GimpImage     *image;
+  GimpPickable  *pickable;
+  GeglBuffer    *buffer;
+  GeglBuffer    *new_mask;
+  GeglRectangle  bounds;
+  gboolean       antialias;
+  gint           x, y, width, height;
+  gint           mask_offset_x = 0;
+  gint           mask_offset_y = 0;
+  gint           sel_x, sel_y, sel_width, sel_height;
 
   g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), NULL);
   g_return_val_if_fail (gimp_item_is_attached (GIMP_ITEM (drawable)), NULL);
@@ -211,20 +226,69 @@ gimp_drawable_get_bucket_fill_buffer (GimpDrawable         *drawable,
                                                       fill_criterion,
                                                       diagonal_neighbors,
                                                       (gint) seed_x,
-                                                      (gint) seed_y);
+                                                      (gint) seed_y,
+                                                      &bounds);
   if (mask_buffer && *mask_buffer)
     {
-      gimp_gegl_mask_combine_buffer (new_mask, *mask_buffer,
-                                     GIMP_CHANNEL_OP_ADD, 0, 0);
+      GeglRectangle old_bounds;
+
+      gimp_drawable_bucket_fill_get_mask_bounds (*mask_buffer, &old_bounds);
+
+      if (! gegl_rectangle_is_empty (&old_bounds))
+        {
+          GeglBuffer *old_mask;
+
+          old_mask = gegl_buffer_create_sub_buffer (*mask_buffer, &old_bounds);
+
+          gimp_gegl_mask_combine_buffer (new_mask, old_mask,
+                                         GIMP_CHANNEL_OP_ADD, 0, 0);
+
+          g_object_unref (old_mask);
+
+          gegl_rectangle_bounding_box (&bounds, &bounds, &old_bounds);
+        }
+
       g_object_unref (*mask_buffer);
     }
 
   if (mask_buffer)
     *mask_buffer = new_mask;
 
-  gimp_gegl_mask_bounds (new_mask, &x, &y, &width, &height);
-  width  -= x;
-  height -= y;
+  /*  the fill only touched the mask within its tracked bounds, so only
+   *  that part of the mask needs to be looked at, to tighten them
+   */
+  if (! gegl_rectangle_is_empty (&bounds))
+    {
+      GeglBuffer *mask;
+
+      mask = gegl_buffer_create_sub_buffer (new_mask, &bounds);
+
+      if (gimp_gegl_mask_bounds (mask, &x, &y, &width, &height))
+        gegl_rectangle_set (&bounds, x, y, width - x, height - y);
+      else
+        gegl_rectangle_set (&bounds, 0, 0, 0, 0);
+
+      g_object_unref (mask);
+    }
+
+  gimp_drawable_bucket_fill_set_mask_bounds (new_mask, &bounds);
+
+  if (gegl_rectangle_is_empty (&bounds))
+    {
+      /*  Nothing was filled; bail.  */
+
+      if (! mask_buffer)
+        g_object_unref (new_mask);
+
+      gimp_unset_busy (image->gimp);
+
+      return NULL;
+    }
+
+  x      = bounds.x;
+  y      = bounds.y;
+  width  = bounds.width;
+  height = bounds.height;
 
   /*  If there is a selection, intersect the region bounds
    *  with the selection bounds, to avoid processing areas
@@ -599,3 +663,32 @@ gimp_drawable_get_line_art_fill_buffer (GimpDrawable      *drawable,
 
   return buffer;
 }
+
+
+/*  private functions  */
+
+static void
+gimp_drawable_bucket_fill_set_mask_bounds (GeglBuffer          *mask,
+                                           const GeglRectangle *bounds)
+{
+  g_object_set_data_full (G_OBJECT (mask), MASK_BOUNDS_KEY,
+                          g_memdup2 (bounds, sizeof (GeglRectangle)),
+                          (GDestroyNotify) g_free);
+}
+
+static void
+gimp_drawable_bucket_fill_get_mask_bounds (GeglBuffer    *mask,
+                                           GeglRectangle *bounds)
+{
+  const GeglRectangle *cached;
+  gint                 x1, y1, x2, y2;
+
+  cached = g_object_get_data (G_OBJECT (mask), MASK_BOUNDS_KEY);
+
+  if (cached)
+    *bounds = *cached;
+  else if (gimp_gegl_mask_bounds (mask, &x1, &y1, &x2, &y2))
+    gegl_rectangle_set (bounds, x1, y1, x2 - x1, y2 - y1);
+  else
+    gegl_rectangle_set (bounds, 0, 0, 0, 0);
+}
@@ -21,6 +21,7 @@
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gegl.h>
 
+#include "libgimpbase/gimpbase.h"
 #include "libgimpcolor/gimpcolor.h"
 
 #include "core-types.h"
@@ -182,6 +183,21 @@ gimp_drawable_fill_path (GimpDrawable     *drawable,
                          GimpPath         *path,
                          gboolean          push_undo,
                          GError          **error)
+{
+  return gimp_drawable_fill_path_area (drawable, options, path, NULL,
+                                       push_undo, error);
+}
+
+/* like gimp_drawable_fill_path(), but only touches the part of the
+ * drawable inside @area, which is in drawable coordinates
+ */
+gboolean
+gimp_drawable_fill_path_area (GimpDrawable         *drawable,
+                              GimpFillOptions      *options,
+                              GimpPath             *path,
+                              const GeglRectangle  *area,
+                              gboolean              push_undo,
+                              GError              **error)
 {
   const GimpBezierDesc *bezier;
 
@@ -202,8 +218,8 @@ gimp_drawable_fill_path (GimpDrawable     *drawable,
       GimpScanConvert *scan_convert = gimp_scan_convert_new ();
 
       gimp_scan_convert_add_bezier (scan_convert, bezier);
-      gimp_drawable_fill_scan_convert (drawable, options,
-                                       scan_convert, push_undo);
+      gimp_drawable_fill_scan_convert_area (drawable, options,
+                                            scan_convert, area, push_undo);
 
       gimp_scan_convert_free (scan_convert);
 
@@ -221,6 +237,17 @@ gimp_drawable_fill_scan_convert (GimpDrawable    *drawable,
                                  GimpFillOptions *options,
                                  GimpScanConvert *scan_convert,
                                  gboolean         push_undo)
+{
+  gimp_drawable_fill_scan_convert_area (drawable, options, scan_convert,
+                                        NULL, push_undo);
+}
+
+void
+gimp_drawable_fill_scan_convert_area (GimpDrawable        *drawable,
+                                      GimpFillOptions     *options,
+                                      GimpScanConvert     *scan_convert,
+                                      const GeglRectangle *area,
+                                      gboolean             push_undo)
 {
   GimpContext *context;
   GeglBuffer  *buffer;
@@ -242,6 +269,12 @@ gimp_drawable_fill_scan_convert (GimpDrawable    *drawable,
   if (! gimp_item_mask_intersect (GIMP_ITEM (drawable), &x, &y, &w, &h))
     return;
 
+  if (area &&
+      ! gimp_rectangle_intersect (x, y, w, h,
+                                  area->x, area->y, area->width, area->height,
+                                  &x, &y, &w, &h))
+    return;
+
   /* fill a 1-bpp GeglBuffer with black, this will describe the shape
    * of the stroke.
    */
@@ -49,8 +49,20 @@ gboolean   gimp_drawable_fill_path         (GimpDrawable        *drawable,
                                             GimpPath            *path,
                                             gboolean             push_undo,
                                             GError             **error);
+gboolean   gimp_drawable_fill_path_area    (GimpDrawable        *drawable,
+                                            GimpFillOptions     *options,
+                                            GimpPath            *path,
+                                            const GeglRectangle *area,
+                                            gboolean             push_undo,
+                                            GError             **error);
 
 void       gimp_drawable_fill_scan_convert (GimpDrawable        *drawable,
                                             GimpFillOptions     *options,
                                             GimpScanConvert     *scan_convert,
                                             gboolean             push_undo);
+void       gimp_drawable_fill_scan_convert_area
+                                           (GimpDrawable        *drawable,
+                                            GimpFillOptions     *options,
+                                            GimpScanConvert     *scan_convert,
+                                            const GeglRectangle *area,
+                                            gboolean             push_undo);
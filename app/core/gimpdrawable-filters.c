@@ -31,6 +31,7 @@
 #include "gegl/gimp-gegl-utils.h"
 
 #include "gimp.h"
+#include "gimp-log.h"
 #include "gimp-utils.h"
 #include "gimpchannel.h"
 #include "gimpdrawable.h"
@@ -519,6 +520,23 @@ gimp_drawable_merge_filter (GimpDrawable *drawable,
             }
           else
             {
+              gint64 shared_size;
+
+              /*  the filter was rendered in place, so that all of the
+               *  area's tiles are now unshared from the undo buffer,
+               *  share the ones it didn't change again
+               */
+              shared_size = gimp_gegl_buffer_share_unchanged (
+                undo_buffer,
+                GEGL_RECTANGLE (0, 0, undo_rect.width, undo_rect.height),
+                gimp_drawable_get_buffer (drawable),
+                &undo_rect);
+
+              GIMP_LOG (TILE_SHARING,
+                        "filter of %dx%d: %" G_GINT64_FORMAT " bytes "
+                        "shared again",
+                        undo_rect.width, undo_rect.height, shared_size);
+
               gimp_drawable_push_undo (drawable, undo_desc, undo_buffer,
                                        undo_rect.x, undo_rect.y,
                                        undo_rect.width, undo_rect.height);
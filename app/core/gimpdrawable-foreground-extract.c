@@ -36,6 +36,374 @@
 #include "gimp-intl.h"
 
 
+/* with coarse-to-fine matting, the matting is first solved on a
+ * downscaled copy that fits in COARSE_MAX_PIXELS, and only refined at full
+ * resolution around the pixels it leaves uncertain, in tiles of
+ * REFINE_TILE_SIZE pixels, each solved with REFINE_MARGIN pixels of
+ * context around it.
+ */
+#define COARSE_MAX_PIXELS (1024 * 1024)
+#define REFINE_TILE_SIZE  256
+#define REFINE_MARGIN     32
+
+/* trimap values within which pixels are known, and coarse alpha values
+ * within which pixels are considered known when refining
+ */
+#define KNOWN_EPSILON     1e-3
+#define COARSE_CONFIDENCE 0.02
+
+
+typedef struct
+{
+  GeglBuffer        *input;
+  GeglBuffer        *trimap;
+  GeglBuffer        *coarse;
+  GeglBuffer        *output;
+  gint               width;
+  gint               height;
+  gint               level;
+  gint               off_x;
+  gint               off_y;
+  GimpMattingEngine  engine;
+  gint               global_iterations;
+  gint               levin_levels;
+  gint               levin_active_levels;
+
+  gint               y;
+} RefineData;
+
+
+/*  local function prototypes  */
+
+static GeglNode   * foreground_extract_matting_node (GeglNode           *gegl,
+                                                     GimpMattingEngine   engine,
+                                                     gint                global_iterations,
+                                                     gint                levin_levels,
+                                                     gint                levin_active_levels);
+static void         foreground_extract_process      (GeglNode           *output_node,
+                                                     GimpProgress       *progress,
+                                                     gdouble             start,
+                                                     gdouble             end);
+static GeglBuffer * foreground_extract_coarse       (GeglBuffer         *input,
+                                                     GeglBuffer         *trimap,
+                                                     gint                width,
+                                                     gint                height,
+                                                     gint                level,
+                                                     GimpMattingEngine   engine,
+                                                     gint                global_iterations,
+                                                     gint                levin_levels,
+                                                     gint                levin_active_levels,
+                                                     GimpProgress       *progress);
+static void         foreground_extract_refine_tiles (gsize               offset,
+                                                     gsize               size,
+                                                     RefineData         *data);
+
+
+/*  private functions  */
+
+static GeglNode *
+foreground_extract_matting_node (GeglNode          *gegl,
+                                 GimpMattingEngine  engine,
+                                 gint               global_iterations,
+                                 gint               levin_levels,
+                                 gint               levin_active_levels)
+{
+  if (engine == GIMP_MATTING_ENGINE_GLOBAL)
+    {
+      return gegl_node_new_child (gegl,
+                                  "operation",  "gegl:matting-global",
+                                  "iterations", global_iterations,
+                                  NULL);
+    }
+  else
+    {
+      return gegl_node_new_child (gegl,
+                                  "operation",     "gegl:matting-levin",
+                                  "levels",        levin_levels,
+                                  "active_levels", levin_active_levels,
+                                  NULL);
+    }
+}
+
+static void
+foreground_extract_process (GeglNode     *output_node,
+                            GimpProgress *progress,
+                            gdouble       start,
+                            gdouble       end)
+{
+  GeglProcessor *processor;
+  gdouble        value;
+
+  processor = gegl_node_new_processor (output_node, NULL);
+
+  while (gegl_processor_work (processor, &value))
+    {
+      if (progress)
+        gimp_progress_set_value (progress, start + (end - start) * value);
+    }
+
+  g_object_unref (processor);
+}
+
+static inline gboolean
+foreground_extract_is_known (gfloat value)
+{
+  return value <= KNOWN_EPSILON || value >= 1.0 - KNOWN_EPSILON;
+}
+
+/* solves the matting on a copy of @input and @trimap, both in drawable
+ * coordinates, downscaled by 2^@level.  pixels of the downscaled trimap
+ * that mix known and unknown pixels are unknown.
+ */
+static GeglBuffer *
+foreground_extract_coarse (GeglBuffer        *input,
+                           GeglBuffer        *trimap,
+                           gint               width,
+                           gint               height,
+                           gint               level,
+                           GimpMattingEngine  engine,
+                           gint               global_iterations,
+                           gint               levin_levels,
+                           gint               levin_active_levels,
+                           GimpProgress      *progress)
+{
+  const Babl    *format      = gegl_buffer_get_format (input);
+  const Babl    *mask_format = babl_format ("Y float");
+  gdouble        scale       = 1.0 / (1 << level);
+  GeglRectangle  rect;
+  GeglBuffer    *small_input;
+  GeglBuffer    *small_trimap;
+  GeglBuffer    *buffer;
+  GeglNode      *gegl;
+  GeglNode      *input_node;
+  GeglNode      *trimap_node;
+  GeglNode      *matting_node;
+  GeglNode      *output_node;
+  gpointer       data;
+  gfloat        *values;
+  gsize          n_pixels;
+  gsize          i;
+
+  gegl_rectangle_set (&rect,
+                      0, 0,
+                      (width  + (1 << level) - 1) >> level,
+                      (height + (1 << level) - 1) >> level);
+
+  n_pixels = (gsize) rect.width * rect.height;
+
+  data = g_malloc (n_pixels * MAX (babl_format_get_bytes_per_pixel (format),
+                                   sizeof (gfloat)));
+
+  small_input = gegl_buffer_new (&rect, format);
+
+  gegl_buffer_get (input, &rect, scale, format, data,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_CLAMP);
+  gegl_buffer_set (small_input, &rect, 0, format, data,
+                   GEGL_AUTO_ROWSTRIDE);
+
+  small_trimap = gegl_buffer_new (&rect, mask_format);
+  values       = data;
+
+  gegl_buffer_get (trimap, &rect, scale, mask_format, values,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  for (i = 0; i < n_pixels; i++)
+    {
+      if (! foreground_extract_is_known (values[i]))
+        values[i] = 0.5f;
+    }
+
+  gegl_buffer_set (small_trimap, &rect, 0, mask_format, values,
+                   GEGL_AUTO_ROWSTRIDE);
+
+  g_free (data);
+
+  gegl = gegl_node_new ();
+
+  input_node   = gegl_node_new_child (gegl,
+                                      "operation", "gegl:buffer-source",
+                                      "buffer",    small_input,
+                                      NULL);
+  trimap_node  = gegl_node_new_child (gegl,
+                                      "operation", "gegl:buffer-source",
+                                      "buffer",    small_trimap,
+                                      NULL);
+  output_node  = gegl_node_new_child (gegl,
+                                      "operation", "gegl:buffer-sink",
+                                      "buffer",    &buffer,
+                                      "format",    mask_format,
+                                      NULL);
+  matting_node = foreground_extract_matting_node (gegl, engine,
+                                                  global_iterations,
+                                                  levin_levels,
+                                                  levin_active_levels);
+
+  gegl_node_connect (input_node,   "output", matting_node, "input");
+  gegl_node_connect (trimap_node,  "output", matting_node, "aux");
+  gegl_node_connect (matting_node, "output", output_node,  "input");
+
+  foreground_extract_process (output_node, progress, 0.0, 0.5);
+
+  g_object_unref (gegl);
+
+  g_object_unref (small_trimap);
+  g_object_unref (small_input);
+
+  return buffer;
+}
+
+/* refines tiles [offset, offset + size) of the row of tiles at data->y.
+ * the pixels the coarse matting is confident about become known, and the
+ * matting is solved at full resolution over the tile and its margin, if
+ * any unknown pixels remain.
+ */
+static void
+foreground_extract_refine_tiles (gsize       offset,
+                                 gsize       size,
+                                 RefineData *data)
+{
+  const Babl *format = babl_format ("Y float");
+  gsize       t;
+
+  for (t = offset; t < offset + size; t++)
+    {
+      GeglRectangle  rect;
+      GeglRectangle  area;
+      gfloat        *trimap;
+      gfloat        *alpha;
+      gfloat        *out;
+      gsize          n_pixels;
+      gsize          i;
+      gint           n_unknown = 0;
+      gboolean       has_fg    = FALSE;
+      gboolean       has_bg    = FALSE;
+      gint           x, y;
+
+      gegl_rectangle_set (&rect,
+                          t * REFINE_TILE_SIZE, data->y,
+                          MIN (REFINE_TILE_SIZE,
+                               data->width  - t * REFINE_TILE_SIZE),
+                          MIN (REFINE_TILE_SIZE,
+                               data->height - data->y));
+
+      gegl_rectangle_intersect (&area,
+                                GEGL_RECTANGLE (rect.x - REFINE_MARGIN,
+                                                rect.y - REFINE_MARGIN,
+                                                rect.width  + 2 * REFINE_MARGIN,
+                                                rect.height + 2 * REFINE_MARGIN),
+                                GEGL_RECTANGLE (0, 0,
+                                                data->width, data->height));
+
+      n_pixels = (gsize) area.width * area.height;
+
+      trimap = g_new (gfloat, n_pixels);
+      alpha  = g_new (gfloat, n_pixels);
+      out    = g_new (gfloat, (gsize) rect.width * rect.height);
+
+      gegl_buffer_get (data->trimap, &area, 1.0, format, trimap,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+      gegl_buffer_get (data->coarse, &area, 1 << data->level, format, alpha,
+                       GEGL_AUTO_ROWSTRIDE,
+                       GEGL_ABYSS_CLAMP | GEGL_BUFFER_FILTER_BILINEAR);
+
+      for (i = 0; i < n_pixels; i++)
+        {
+          if (foreground_extract_is_known (trimap[i]))
+            alpha[i] = trimap[i];
+          else if (alpha[i] <= COARSE_CONFIDENCE)
+            trimap[i] = 0.0f;
+          else if (alpha[i] >= 1.0 - COARSE_CONFIDENCE)
+            trimap[i] = 1.0f;
+          else
+            {
+              trimap[i] = 0.5f;
+              n_unknown++;
+            }
+
+          has_fg |= trimap[i] == 1.0f;
+          has_bg |= trimap[i] == 0.0f;
+        }
+
+      /*  without both foreground and background samples around them, the
+       *  remaining unknown pixels keep their coarse alpha
+       */
+      if (n_unknown > 0 && has_fg && has_bg)
+        {
+          GeglBuffer *input_buffer;
+          GeglBuffer *trimap_buffer;
+          GeglNode   *gegl;
+          GeglNode   *input_node;
+          GeglNode   *trimap_node;
+          GeglNode   *matting_node;
+
+          input_buffer  = gegl_buffer_create_sub_buffer (data->input, &area);
+          trimap_buffer = gegl_buffer_linear_new_from_data (trimap, format,
+                                                            &area,
+                                                            GEGL_AUTO_ROWSTRIDE,
+                                                            NULL, NULL);
+
+          gegl = gegl_node_new ();
+
+          input_node   = gegl_node_new_child (gegl,
+                                              "operation", "gegl:buffer-source",
+                                              "buffer",    input_buffer,
+                                              NULL);
+          trimap_node  = gegl_node_new_child (gegl,
+                                              "operation", "gegl:buffer-source",
+                                              "buffer",    trimap_buffer,
+                                              NULL);
+          matting_node = foreground_extract_matting_node (
+            gegl, data->engine,
+            data->global_iterations,
+            data->levin_levels,
+            data->levin_active_levels);
+
+          gegl_node_connect (input_node,  "output", matting_node, "input");
+          gegl_node_connect (trimap_node, "output", matting_node, "aux");
+
+          gegl_node_blit (matting_node, 1.0, &rect, format, out,
+                          GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+          g_object_unref (gegl);
+
+          g_object_unref (trimap_buffer);
+          g_object_unref (input_buffer);
+        }
+      else
+        {
+          for (y = 0; y < rect.height; y++)
+            {
+              const gfloat *src = alpha + (gsize) (rect.y - area.y + y) *
+                                          area.width +
+                                          (rect.x - area.x);
+
+              for (x = 0; x < rect.width; x++)
+                {
+                  gfloat value = src[x];
+
+                  if (value <= COARSE_CONFIDENCE)
+                    value = 0.0f;
+                  else if (value >= 1.0 - COARSE_CONFIDENCE)
+                    value = 1.0f;
+
+                  out[(gsize) y * rect.width + x] = value;
+                }
+            }
+        }
+
+      gegl_buffer_set (data->output,
+                       GEGL_RECTANGLE (rect.x + data->off_x,
+                                       rect.y + data->off_y,
+                                       rect.width, rect.height),
+                       0, format, out, GEGL_AUTO_ROWSTRIDE);
+
+      g_free (out);
+      g_free (alpha);
+      g_free (trimap);
+    }
+}
+
+
 /*  public functions  */
 
 GeglBuffer *
@@ -54,8 +422,6 @@ gimp_drawable_foreground_extract (GimpDrawable      *drawable,
   GeglNode      *matting_node;
   GeglNode      *output_node;
   GeglBuffer    *buffer;
-  GeglProcessor *processor;
-  gdouble        value;
   gint           off_x, off_y;
 
   g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), NULL);
@@ -83,21 +449,10 @@ gimp_drawable_foreground_extract (GimpDrawable      *drawable,
                                      "format",    NULL,
                                      NULL);
 
-  if (engine == GIMP_MATTING_ENGINE_GLOBAL)
-    {
-      matting_node = gegl_node_new_child (gegl,
-                                          "operation",  "gegl:matting-global",
-                                          "iterations", global_iterations,
-                                          NULL);
-    }
-  else
-    {
-      matting_node = gegl_node_new_child (gegl,
-                                          "operation",     "gegl:matting-levin",
-                                          "levels",        levin_levels,
-                                          "active_levels", levin_active_levels,
-                                          NULL);
-    }
+  matting_node = foreground_extract_matting_node (gegl, engine,
+                                                  global_iterations,
+                                                  levin_levels,
+                                                  levin_active_levels);
 
   gimp_item_get_offset (GIMP_ITEM (drawable), &off_x, &off_y);
 
@@ -128,20 +483,122 @@ gimp_drawable_foreground_extract (GimpDrawable      *drawable,
       gegl_node_connect (matting_node, "output", output_node,  "input");
     }
 
-  processor = gegl_node_new_processor (output_node, NULL);
+  foreground_extract_process (output_node, progress, 0.0, 1.0);
 
-  while (gegl_processor_work (processor, &value))
+  if (progress)
+    gimp_progress_end (progress);
+
+  g_object_unref (gegl);
+
+  return buffer;
+}
+
+/* a faster variant of gimp_drawable_foreground_extract(), for large
+ * drawables: the matting is solved on a downscaled copy of the drawable,
+ * and only refined at full resolution, in tiles, in parallel, where the
+ * downscaled result is uncertain.  drawables that are small enough are
+ * matted at full resolution at once.
+ */
+GeglBuffer *
+gimp_drawable_foreground_extract_coarse_to_fine (GimpDrawable      *drawable,
+                                                 GimpMattingEngine  engine,
+                                                 gint               global_iterations,
+                                                 gint               levin_levels,
+                                                 gint               levin_active_levels,
+                                                 GeglBuffer        *trimap,
+                                                 GimpProgress      *progress)
+{
+  RefineData  data;
+  GeglBuffer *trimap_view;
+  gint        width;
+  gint        height;
+  gint        n_tiles;
+  gint        level = 0;
+
+  g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), NULL);
+  g_return_val_if_fail (GEGL_IS_BUFFER (trimap), NULL);
+  g_return_val_if_fail (progress == NULL || GIMP_IS_PROGRESS (progress), NULL);
+
+  width  = gimp_item_get_width  (GIMP_ITEM (drawable));
+  height = gimp_item_get_height (GIMP_ITEM (drawable));
+
+  while ((gdouble) (width  >> level) *
+                   (height >> level) > COARSE_MAX_PIXELS)
     {
+      level++;
+    }
+
+  if (level == 0)
+    {
+      return gimp_drawable_foreground_extract (drawable, engine,
+                                               global_iterations,
+                                               levin_levels,
+                                               levin_active_levels,
+                                               trimap, progress);
+    }
+
+  progress = gimp_progress_start (progress, FALSE,
+                                  _("Computing alpha of unknown pixels"));
+
+  gimp_item_get_offset (GIMP_ITEM (drawable), &data.off_x, &data.off_y);
+
+  /*  work in drawable coordinates  */
+  trimap_view = g_object_new (GEGL_TYPE_BUFFER,
+                              "source",  trimap,
+                              "x",       0,
+                              "y",       0,
+                              "width",   width,
+                              "height",  height,
+                              "shift-x", data.off_x,
+                              "shift-y", data.off_y,
+                              NULL);
+
+  data.input               = gimp_drawable_get_buffer (drawable);
+  data.trimap              = trimap_view;
+  data.width               = width;
+  data.height              = height;
+  data.level               = level;
+  data.engine              = engine;
+  data.global_iterations   = global_iterations;
+  data.levin_levels        = levin_levels;
+  data.levin_active_levels = levin_active_levels;
+
+  data.coarse = foreground_extract_coarse (data.input, data.trimap,
+                                           width, height, level,
+                                           engine,
+                                           global_iterations,
+                                           levin_levels,
+                                           levin_active_levels,
+                                           progress);
+
+  data.output = gegl_buffer_new (GEGL_RECTANGLE (data.off_x, data.off_y,
+                                                 width, height),
+                                 babl_format ("Y float"));
+
+  n_tiles = (width + REFINE_TILE_SIZE - 1) / REFINE_TILE_SIZE;
+
+  /*  refine a row of tiles at a time, so that progress can be reported  */
+  for (data.y = 0; data.y < height; data.y += REFINE_TILE_SIZE)
+    {
+      gegl_parallel_distribute_range (
+        n_tiles, 1,
+        (GeglParallelDistributeRangeFunc) foreground_extract_refine_tiles,
+        &data);
+
       if (progress)
-        gimp_progress_set_value (progress, value);
+        {
+          gimp_progress_set_value (progress,
+                                   0.5 + 0.5 *
+                                   MIN (data.y + REFINE_TILE_SIZE, height) /
+                                   (gdouble) height);
+        }
     }
 
   if (progress)
     gimp_progress_end (progress);
 
-  g_object_unref (processor);
-
-  g_object_unref (gegl);
+  g_object_unref (data.coarse);
+  g_object_unref (trimap_view);
 
-  return buffer;
+  return data.output;
 }
@@ -169,7 +169,46 @@ gimp_drawable_calculate_histogram_internal (GimpDrawable  *drawable,
 
           gimp_item_get_offset (GIMP_ITEM (drawable), &off_x, &off_y);
 
-          if (run_async)
+          if (buffer == gimp_drawable_get_buffer (drawable)          &&
+              GIMP_DRAWABLE (mask) != drawable                       &&
+              ! gimp_drawable_is_painting (drawable)                 &&
+              ! gimp_drawable_is_painting (GIMP_DRAWABLE (mask))     &&
+              ! gimp_viewable_get_children (GIMP_VIEWABLE (drawable)))
+            {
+              /*  the histogram through the selection is calculated as
+               *  a whole, and reused until the drawable or the
+               *  selection change, so that the histogram dock and the
+               *  color tools share a single calculation.
+               */
+              GimpHistogramCache *cache;
+              GimpHistogramCache *mask_cache;
+
+              cache      = gimp_drawable_get_histogram_cache (drawable);
+              mask_cache =
+                gimp_drawable_get_histogram_cache (GIMP_DRAWABLE (mask));
+
+              if (run_async)
+                {
+                  async = gimp_histogram_calculate_masked_cached_async (
+                    histogram, cache, buffer,
+                    GEGL_RECTANGLE (x, y, width, height),
+                    mask_cache,
+                    gimp_drawable_get_buffer (GIMP_DRAWABLE (mask)),
+                    GEGL_RECTANGLE (x + off_x, y + off_y,
+                                    width, height));
+                }
+              else
+                {
+                  gimp_histogram_calculate_masked_cached (
+                    histogram, cache, buffer,
+                    GEGL_RECTANGLE (x, y, width, height),
+                    mask_cache,
+                    gimp_drawable_get_buffer (GIMP_DRAWABLE (mask)),
+                    GEGL_RECTANGLE (x + off_x, y + off_y,
+                                    width, height));
+                }
+            }
+          else if (run_async)
             {
               async = gimp_histogram_calculate_async (
                 histogram, buffer,
@@ -188,6 +227,33 @@ gimp_drawable_calculate_histogram_internal (GimpDrawable  *drawable,
                                 width, height));
             }
         }
+      else if (buffer == gimp_drawable_get_buffer (drawable) &&
+               ! gimp_drawable_is_painting (drawable)         &&
+               ! gimp_viewable_get_children (GIMP_VIEWABLE (drawable)))
+        {
+          /*  the drawable's own buffer is kept track of by the
+           *  drawable's histogram cache, so only the tiles changed
+           *  since the last time need to be recalculated.  while
+           *  painting, and for drawables rendering their children,
+           *  the buffer changes without the cache hearing about it.
+           */
+          GimpHistogramCache *cache;
+
+          cache = gimp_drawable_get_histogram_cache (drawable);
+
+          if (run_async)
+            {
+              async = gimp_histogram_calculate_cached_async (
+                histogram, cache, buffer,
+                GEGL_RECTANGLE (x, y, width, height));
+            }
+          else
+            {
+              gimp_histogram_calculate_cached (
+                histogram, cache, buffer,
+                GEGL_RECTANGLE (x, y, width, height));
+            }
+        }
       else
         {
           if (run_async)
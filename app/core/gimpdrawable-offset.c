@@ -25,15 +25,28 @@
 
 #include "core-types.h"
 
+#include "gegl/gimp-gegl-loops.h"
+
 #include "gimp.h"
+#include "gimpchannel.h"
 #include "gimpcontext.h"
 #include "gimpdrawable.h"
 #include "gimpdrawable-offset.h"
 #include "gimpdrawable-operation.h"
+#include "gimpimage.h"
 
 #include "gimp-intl.h"
 
 
+static gboolean   gimp_drawable_offset_remap (GimpDrawable   *drawable,
+                                              GimpOffsetType  fill_type,
+                                              GeglColor      *color,
+                                              gint            offset_x,
+                                              gint            offset_y);
+
+
+/*  public functions  */
+
 void
 gimp_drawable_offset (GimpDrawable   *drawable,
                       GimpContext    *context,
@@ -68,6 +81,14 @@ gimp_drawable_offset (GimpDrawable   *drawable,
   if (offset_x == 0 && offset_y == 0)
     return;
 
+  if (gimp_drawable_offset_remap (drawable, fill_type,
+                                  color ? color :
+                                  gimp_context_get_background (context),
+                                  offset_x, offset_y))
+    {
+      return;
+    }
+
   node = gegl_node_new_child (NULL,
                               "operation", "gimp:offset",
                               "type",      fill_type,
@@ -92,3 +113,92 @@ gimp_drawable_offset (GimpDrawable   *drawable,
 
   g_object_unref (node);
 }
+
+
+/*  private functions  */
+
+/*  offsets the whole drawable by building its new buffer directly out
+ *  of the old one, instead of running gimp:offset over it.  the pieces
+ *  are copied with gimp_gegl_buffer_offset(), which shares the tiles
+ *  of the old buffer when the offsets are multiples of the tile size,
+ *  so wrapping a large texture by whole tiles costs next to nothing,
+ *  and the undo step just keeps the old buffer.
+ */
+static gboolean
+gimp_drawable_offset_remap (GimpDrawable   *drawable,
+                            GimpOffsetType  fill_type,
+                            GeglColor      *color,
+                            gint            offset_x,
+                            gint            offset_y)
+{
+  GimpImage     *image = gimp_item_get_image (GIMP_ITEM (drawable));
+  GeglBuffer    *src_buffer;
+  GeglBuffer    *dest_buffer;
+  GeglRectangle  bounds;
+  gint           i;
+
+  /*  only the selection's bounds are offset otherwise  */
+  if (! gimp_channel_is_empty (gimp_image_get_mask (image)))
+    return FALSE;
+
+  if (gimp_viewable_get_children (GIMP_VIEWABLE (drawable)))
+    return FALSE;
+
+  /*  the new buffer replaces all components, so leave lock-alpha and
+   *  disabled channels to the regular path
+   */
+  if (gimp_drawable_get_active_mask (drawable) != GIMP_COMPONENT_MASK_ALL)
+    return FALSE;
+
+  src_buffer = gimp_drawable_get_buffer (drawable);
+  bounds     = *gegl_buffer_get_extent (src_buffer);
+
+  if (fill_type == GIMP_OFFSET_WRAP_AROUND)
+    {
+      if (offset_x < 0)
+        offset_x += bounds.width;
+
+      if (offset_y < 0)
+        offset_y += bounds.height;
+    }
+  else
+    {
+      offset_x = CLAMP (offset_x, -bounds.width,  +bounds.width);
+      offset_y = CLAMP (offset_y, -bounds.height, +bounds.height);
+    }
+
+  /*  a new buffer has the default tile size, like the drawable's, and
+   *  its tiles start out empty, that is transparent
+   */
+  dest_buffer = gegl_buffer_new (&bounds, gimp_drawable_get_format (drawable));
+
+  gimp_gegl_buffer_offset (src_buffer, &bounds, dest_buffer, &bounds,
+                           offset_x, offset_y,
+                           fill_type == GIMP_OFFSET_WRAP_AROUND);
+
+  if (fill_type == GIMP_OFFSET_COLOR)
+    {
+      for (i = 1; i < 4; i++)
+        {
+          GeglRectangle offset_bounds = bounds;
+
+          offset_bounds.x += offset_x;
+          offset_bounds.y += offset_y;
+
+          if (i & 1)
+            offset_bounds.x += offset_x < 0 ? bounds.width  : -bounds.width;
+          if (i & 2)
+            offset_bounds.y += offset_y < 0 ? bounds.height : -bounds.height;
+
+          if (gegl_rectangle_intersect (&offset_bounds, &offset_bounds, &bounds))
+            gegl_buffer_set_color (dest_buffer, &offset_bounds, color);
+        }
+    }
+
+  gimp_drawable_set_buffer (drawable, TRUE,
+                            C_("undo-type", "Offset Drawable"),
+                            dest_buffer);
+  g_object_unref (dest_buffer);
+
+  return TRUE;
+}
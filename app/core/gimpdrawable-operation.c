@@ -27,6 +27,7 @@
 
 #include "core-types.h"
 
+#include "gegl/gimp-gegl-apply-operation.h"
 #include "gegl/gimp-gegl-utils.h"
 
 #include "operations/gimp-operation-config.h"
@@ -37,8 +38,47 @@
 #include "gimpdrawable-operation.h"
 #include "gimpdrawable.h"
 #include "gimpdrawablefilter.h"
+#include "gimpimage.h"
+#include "gimpimage-undo.h"
+#include "gimplayer.h"
 #include "gimpprogress.h"
 #include "gimpsettings.h"
+#include "gimpsubprogress.h"
+
+
+/*  drawables whose filtered area is at most this large are processed
+ *  concurrently, larger ones are processed one by one, each of them
+ *  being parallel enough on its own
+ */
+#define CONCURRENT_MAX_AREA   (512 * 512)
+
+/*  the area processed concurrently between progress updates  */
+#define CONCURRENT_BATCH_AREA (32 * CONCURRENT_MAX_AREA)
+
+
+typedef struct
+{
+  GimpDrawable  *drawable;
+  GeglRectangle  rect;
+  GeglNode      *operation;
+  GeglBuffer    *src_buffer;
+  GeglBuffer    *dest_buffer;
+} ApplyJob;
+
+
+/*  local function prototypes  */
+
+static gboolean   gimp_drawables_can_apply_concurrently (GeglNode     *operation,
+                                                         GObject      *config);
+static GeglNode * gimp_drawables_copy_operation         (GeglNode     *operation);
+static void       gimp_drawables_apply_jobs             (GList        *jobs,
+                                                         gboolean      needs_alpha,
+                                                         GeglNode     *operation,
+                                                         GObject      *config,
+                                                         const gchar  *undo_desc);
+static void       gimp_drawables_process_jobs           (gsize         offset,
+                                                         gsize         size,
+                                                         ApplyJob    **jobs);
 
 
 /*  public functions  */
@@ -137,3 +177,351 @@ gimp_drawable_apply_operation_by_name (GimpDrawable *drawable,
 
   g_object_unref (node);
 }
+
+/* applies 'operation' to each of 'drawables', as a single undo step and
+ * with a single progress.  drawables with a small area to process are
+ * processed concurrently, on copies of 'operation', and merged back
+ * once done; the others go through gimp_drawable_apply_operation_with_config()
+ * one after another.
+ */
+void
+gimp_drawables_apply_operation (GList        *drawables,
+                                GimpProgress *progress,
+                                const gchar  *undo_desc,
+                                GeglNode     *operation,
+                                GObject      *config)
+{
+  GimpImage *image;
+  GList     *concurrent = NULL;
+  GList     *sequential = NULL;
+  GList     *list;
+  gboolean   concurrently;
+  gboolean   needs_alpha;
+  gint64     total_area = 0;
+  gint64     done_area  = 0;
+
+  g_return_if_fail (progress == NULL || GIMP_IS_PROGRESS (progress));
+  g_return_if_fail (undo_desc != NULL);
+  g_return_if_fail (GEGL_IS_NODE (operation));
+  g_return_if_fail (config == NULL || GIMP_IS_OPERATION_SETTINGS (config));
+
+  if (! drawables)
+    return;
+
+  if (! drawables->next)
+    {
+      gimp_drawable_apply_operation_with_config (drawables->data,
+                                                 progress, undo_desc,
+                                                 operation, config);
+      return;
+    }
+
+  image = gimp_item_get_image (GIMP_ITEM (drawables->data));
+
+  if (config)
+    gimp_operation_config_sync_node (config, operation);
+
+  concurrently = gimp_drawables_can_apply_concurrently (operation, config);
+  needs_alpha  = gimp_gegl_node_has_key (operation, "needs-alpha");
+
+  for (list = drawables; list; list = g_list_next (list))
+    {
+      GimpDrawable  *drawable = list->data;
+      GeglRectangle  rect;
+      gint64         area;
+
+      g_return_if_fail (GIMP_IS_DRAWABLE (drawable));
+      g_return_if_fail (gimp_item_is_attached (GIMP_ITEM (drawable)));
+      g_return_if_fail (gimp_item_get_image (GIMP_ITEM (drawable)) == image);
+
+      if (! gimp_item_mask_intersect (GIMP_ITEM (drawable),
+                                      &rect.x, &rect.y,
+                                      &rect.width, &rect.height))
+        {
+          continue;
+        }
+
+      area        = (gint64) rect.width * rect.height;
+      total_area += area;
+
+      /*  without alpha, a drawable is always clipped, see
+       *  gimp_operation_settings_sync_drawable_filter()
+       */
+      if (concurrently && area <= CONCURRENT_MAX_AREA &&
+          (! config                                                      ||
+           GIMP_OPERATION_SETTINGS (config)->clip ==
+           GIMP_TRANSFORM_RESIZE_CLIP                                    ||
+           (! gimp_drawable_has_alpha (drawable) &&
+            ! (needs_alpha && GIMP_IS_LAYER (drawable)))))
+        {
+          ApplyJob *job = g_slice_new0 (ApplyJob);
+
+          job->drawable = drawable;
+          job->rect     = rect;
+
+          concurrent = g_list_prepend (concurrent, job);
+        }
+      else
+        {
+          sequential = g_list_prepend (sequential, drawable);
+        }
+    }
+
+  if (! concurrent && ! sequential)
+    return;
+
+  concurrent = g_list_reverse (concurrent);
+  sequential = g_list_reverse (sequential);
+
+  if (progress)
+    gimp_progress_start (progress, FALSE, "%s", undo_desc);
+
+  gimp_image_undo_group_start (image, GIMP_UNDO_GROUP_DRAWABLE_MOD,
+                               undo_desc);
+
+  while (concurrent)
+    {
+      GList  *batch      = concurrent;
+      gint64  batch_area = 0;
+
+      for (list = concurrent;
+           list && batch_area < CONCURRENT_BATCH_AREA;
+           list = g_list_next (list))
+        {
+          ApplyJob *job = list->data;
+
+          batch_area += (gint64) job->rect.width * job->rect.height;
+        }
+
+      if (list)
+        {
+          list->prev->next = NULL;
+          list->prev       = NULL;
+        }
+
+      concurrent = list;
+
+      gimp_drawables_apply_jobs (batch, needs_alpha, operation, config,
+                                 undo_desc);
+
+      g_list_free (batch);
+
+      done_area += batch_area;
+
+      if (progress)
+        gimp_progress_set_value (progress,
+                                 (gdouble) done_area / total_area);
+    }
+
+  for (list = sequential; list; list = g_list_next (list))
+    {
+      GimpDrawable  *drawable     = list->data;
+      GimpProgress  *sub_progress = NULL;
+      GeglRectangle  rect;
+      gint64         area;
+
+      gimp_item_mask_intersect (GIMP_ITEM (drawable),
+                                &rect.x, &rect.y, &rect.width, &rect.height);
+
+      area = (gint64) rect.width * rect.height;
+
+      if (progress)
+        {
+          sub_progress = gimp_sub_progress_new (progress);
+
+          gimp_sub_progress_set_range (GIMP_SUB_PROGRESS (sub_progress),
+                                       (gdouble) done_area / total_area,
+                                       (gdouble) (done_area + area) / total_area);
+        }
+
+      gimp_drawable_apply_operation_with_config (drawable,
+                                                 sub_progress, undo_desc,
+                                                 operation, config);
+
+      g_clear_object (&sub_progress);
+
+      done_area += area;
+    }
+
+  g_list_free (sequential);
+
+  gimp_image_undo_group_end (image);
+
+  if (progress)
+    gimp_progress_end (progress);
+}
+
+
+/*  private functions  */
+
+static gboolean
+gimp_drawables_can_apply_concurrently (GeglNode *operation,
+                                       GObject  *config)
+{
+  GSList   *children;
+  gboolean  simple;
+
+  /*  the concurrent path merges the results as gimp_drawable_apply_buffer()
+   *  does, it doesn't do anything but the default region
+   */
+  if (config &&
+      GIMP_OPERATION_SETTINGS (config)->region != GIMP_FILTER_REGION_SELECTION)
+    {
+      return FALSE;
+    }
+
+  /*  only single operations, not connected to anything, can be
+   *  copied for each drawable
+   */
+  if (! gegl_node_get_gegl_operation (operation) ||
+      gegl_node_get_producer (operation, "input", NULL) ||
+      (gegl_node_has_pad (operation, "aux") &&
+       gegl_node_get_producer (operation, "aux", NULL)))
+    {
+      return FALSE;
+    }
+
+  children = gegl_node_get_children (operation);
+  simple   = (children == NULL);
+  g_slist_free (children);
+
+  return simple;
+}
+
+static GeglNode *
+gimp_drawables_copy_operation (GeglNode *operation)
+{
+  const gchar  *operation_type = gegl_node_get_operation (operation);
+  GeglNode     *node;
+  GParamSpec  **pspecs;
+  guint         n_pspecs;
+  guint         i;
+
+  node = gegl_node_new_child (NULL,
+                              "operation", operation_type,
+                              NULL);
+
+  pspecs = gegl_operation_list_properties (operation_type, &n_pspecs);
+
+  for (i = 0; i < n_pspecs; i++)
+    {
+      GValue value = G_VALUE_INIT;
+
+      if ((pspecs[i]->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE ||
+          (pspecs[i]->flags & G_PARAM_CONSTRUCT_ONLY))
+        {
+          continue;
+        }
+
+      g_value_init (&value, pspecs[i]->value_type);
+
+      gegl_node_get_property (operation, pspecs[i]->name, &value);
+      gegl_node_set_property (node,      pspecs[i]->name, &value);
+
+      g_value_unset (&value);
+    }
+
+  g_free (pspecs);
+
+  return node;
+}
+
+static void
+gimp_drawables_apply_jobs (GList       *jobs,
+                           gboolean     needs_alpha,
+                           GeglNode    *operation,
+                           GObject     *config,
+                           const gchar *undo_desc)
+{
+  ApplyJob     **array;
+  GList         *list;
+  gint           n_jobs  = g_list_length (jobs);
+  gdouble        opacity = GIMP_OPACITY_OPAQUE;
+  GimpLayerMode  mode    = GIMP_LAYER_MODE_REPLACE;
+  gint           i;
+
+  if (config)
+    {
+      opacity = GIMP_OPERATION_SETTINGS (config)->opacity;
+      mode    = GIMP_OPERATION_SETTINGS (config)->mode;
+    }
+
+  array = g_new (ApplyJob *, n_jobs);
+
+  /*  everything touching the drawables is done here, the worker
+   *  threads only see buffers and their own copy of the operation
+   */
+  for (list = jobs, i = 0; list; list = g_list_next (list), i++)
+    {
+      ApplyJob *job = list->data;
+
+      if (needs_alpha && GIMP_IS_LAYER (job->drawable))
+        gimp_layer_add_alpha (GIMP_LAYER (job->drawable));
+
+      job->operation   = gimp_drawables_copy_operation (operation);
+      job->src_buffer  = g_object_new (GEGL_TYPE_BUFFER,
+                                       "source",  gimp_drawable_get_buffer (job->drawable),
+                                       "shift-x", job->rect.x,
+                                       "shift-y", job->rect.y,
+                                       NULL);
+      job->dest_buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0,
+                                                          job->rect.width,
+                                                          job->rect.height),
+                                          gimp_drawable_get_format (job->drawable));
+
+      array[i] = job;
+    }
+
+  gegl_parallel_distribute_range (
+    n_jobs, 1,
+    (GeglParallelDistributeRangeFunc) gimp_drawables_process_jobs,
+    array);
+
+  for (i = 0; i < n_jobs; i++)
+    {
+      ApplyJob *job = array[i];
+
+      gimp_drawable_apply_buffer (job->drawable, job->dest_buffer,
+                                  GEGL_RECTANGLE (0, 0,
+                                                  job->rect.width,
+                                                  job->rect.height),
+                                  TRUE, undo_desc,
+                                  opacity, mode,
+                                  GIMP_LAYER_COLOR_SPACE_AUTO,
+                                  GIMP_LAYER_COLOR_SPACE_AUTO,
+                                  GIMP_LAYER_COMPOSITE_AUTO,
+                                  NULL, job->rect.x, job->rect.y);
+
+      g_object_unref (job->dest_buffer);
+      g_object_unref (job->src_buffer);
+      g_object_unref (job->operation);
+
+      g_slice_free (ApplyJob, job);
+    }
+
+  g_free (array);
+}
+
+static void
+gimp_drawables_process_jobs (gsize      offset,
+                             gsize      size,
+                             ApplyJob **jobs)
+{
+  gsize i;
+
+  for (i = offset; i < offset + size; i++)
+    {
+      ApplyJob *job = jobs[i];
+
+      /*  like a GimpDrawableFilter's selection region, the operation
+       *  sees the area cropped and moved to the origin
+       */
+      gimp_gegl_apply_operation (job->src_buffer, NULL, NULL,
+                                 job->operation,
+                                 job->dest_buffer,
+                                 GEGL_RECTANGLE (0, 0,
+                                                 job->rect.width,
+                                                 job->rect.height),
+                                 TRUE);
+    }
+}
@@ -37,3 +37,9 @@ void   gimp_drawable_apply_operation_by_name     (GimpDrawable *drawable,
                                                   const gchar  *undo_desc,
                                                   const gchar  *operation_type,
                                                   GObject      *config);
+
+void   gimp_drawables_apply_operation            (GList        *drawables,
+                                                  GimpProgress *progress,
+                                                  const gchar  *undo_desc,
+                                                  GeglNode     *operation,
+                                                  GObject      *config);
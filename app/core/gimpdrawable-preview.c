@@ -32,14 +32,12 @@
 
 #include "gegl/gimp-babl.h"
 #include "gegl/gimp-gegl-loops.h"
-#include "gegl/gimptilehandlervalidate.h"
 
 #include "gimp.h"
-#include "gimp-parallel.h"
-#include "gimp-utils.h"
+#include "gimp-memory-tags.h"
+#include "gimp-preview-async.h"
 #include "gimpasync.h"
 #include "gimpchannel.h"
-#include "gimpchunkiterator.h"
 #include "gimpimage.h"
 #include "gimpimage-color-profile.h"
 #include "gimpdrawable-preview.h"
@@ -47,63 +45,6 @@
 #include "gimplayer.h"
 #include "gimptempbuf.h"
 
-#include "gimp-priorities.h"
-
-
-typedef struct
-{
-  const Babl        *format;
-  GeglBuffer        *buffer;
-  GeglRectangle      rect;
-  gdouble            scale;
-
-  GimpChunkIterator *iter;
-} SubPreviewData;
-
-
-/*  local function prototypes  */
-
-static SubPreviewData * sub_preview_data_new  (const Babl          *format,
-                                               GeglBuffer          *buffer,
-                                               const GeglRectangle *rect,
-                                               gdouble              scale);
-static void             sub_preview_data_free (SubPreviewData      *data);
-
-
-
-/*  private functions  */
-
-
-static SubPreviewData *
-sub_preview_data_new (const Babl          *format,
-                      GeglBuffer          *buffer,
-                      const GeglRectangle *rect,
-                      gdouble              scale)
-{
-  SubPreviewData *data = g_slice_new (SubPreviewData);
-
-  data->format = format;
-  /* We take ownership if the buffer reference. */
-  data->buffer = buffer;
-  data->rect   = *rect;
-  data->scale  = scale;
-
-  data->iter   = NULL;
-
-  return data;
-}
-
-static void
-sub_preview_data_free (SubPreviewData *data)
-{
-  g_object_unref (data->buffer);
-
-  if (data->iter)
-    gimp_chunk_iterator_stop (data->iter, TRUE);
-
-  g_slice_free (SubPreviewData, data);
-}
-
 
 /*  public functions  */
 
@@ -115,18 +56,25 @@ gimp_drawable_get_new_preview (GimpViewable *viewable,
                                gint          height,
                                GeglColor    *fg_color G_GNUC_UNUSED)
 {
-  GimpItem  *item  = GIMP_ITEM (viewable);
-  GimpImage *image = gimp_item_get_image (item);
+  GimpItem    *item  = GIMP_ITEM (viewable);
+  GimpImage   *image = gimp_item_get_image (item);
+  GimpTempBuf *preview;
 
   if (! image->gimp->config->layer_previews)
     return NULL;
 
-  return gimp_drawable_get_sub_preview (GIMP_DRAWABLE (viewable),
-                                        0, 0,
-                                        gimp_item_get_width  (item),
-                                        gimp_item_get_height (item),
-                                        width,
-                                        height);
+  gimp_memory_tags_push (GIMP_MEMORY_TAG_PREVIEW, image);
+
+  preview = gimp_drawable_get_sub_preview (GIMP_DRAWABLE (viewable),
+                                           0, 0,
+                                           gimp_item_get_width  (item),
+                                           gimp_item_get_height (item),
+                                           width,
+                                           height);
+
+  gimp_memory_tags_pop ();
+
+  return preview;
 }
 
 GdkPixbuf *
@@ -334,72 +282,6 @@ gimp_drawable_get_sub_pixbuf (GimpDrawable *drawable,
   return pixbuf;
 }
 
-static void
-gimp_drawable_get_sub_preview_async_func (GimpAsync      *async,
-                                          SubPreviewData *data)
-{
-  GimpTempBuf             *preview;
-  GimpTileHandlerValidate *validate;
-
-  preview = gimp_temp_buf_new (data->rect.width, data->rect.height,
-                               data->format);
-
-  validate = gimp_tile_handler_validate_get_assigned (data->buffer);
-
-  if (validate)
-    {
-      if (! data->iter)
-        {
-          cairo_region_t        *region;
-          cairo_rectangle_int_t  rect;
-
-          rect.x      = floor (data->rect.x / data->scale);
-          rect.y      = floor (data->rect.y / data->scale);
-          rect.width  = ceil ((data->rect.x + data->rect.width)  /
-                              data->scale) - rect.x;
-          rect.height = ceil ((data->rect.x + data->rect.height) /
-                              data->scale) - rect.y;
-
-          region = cairo_region_copy (validate->dirty_region);
-
-          cairo_region_intersect_rectangle (region, &rect);
-
-          data->iter = gimp_chunk_iterator_new (region);
-        }
-
-      if (gimp_chunk_iterator_next (data->iter))
-        {
-          GeglRectangle rect;
-
-          gimp_tile_handler_validate_begin_validate (validate);
-
-          while (gimp_chunk_iterator_get_rect (data->iter, &rect))
-            {
-              gimp_tile_handler_validate_validate (validate,
-                                                   data->buffer, &rect,
-                                                   FALSE, FALSE);
-            }
-
-          gimp_tile_handler_validate_end_validate (validate);
-
-          return;
-        }
-
-      data->iter = NULL;
-    }
-
-  gegl_buffer_get (data->buffer, &data->rect, data->scale,
-                   gimp_temp_buf_get_format (preview),
-                   gimp_temp_buf_get_data (preview),
-                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_CLAMP);
-
-  sub_preview_data_free (data);
-
-  gimp_async_finish_full (async,
-                          preview,
-                          (GDestroyNotify) gimp_temp_buf_unref);
-}
-
 GimpAsync *
 gimp_drawable_get_sub_preview_async (GimpDrawable *drawable,
                                      gint          src_x,
@@ -409,14 +291,14 @@ gimp_drawable_get_sub_preview_async (GimpDrawable *drawable,
                                      gint          dest_width,
                                      gint          dest_height)
 {
-  GimpItem       *item;
-  GimpImage      *image;
-  GeglBuffer     *buffer;
-  SubPreviewData *data;
-  gdouble         scale;
-  gint            scaled_x;
-  gint            scaled_y;
-  static gint     no_async_drawable_previews = -1;
+  GimpItem    *item;
+  GimpImage   *image;
+  GeglBuffer  *buffer;
+  GimpAsync   *async;
+  gdouble      scale;
+  gint         scaled_x;
+  gint         scaled_y;
+  static gint  no_async_drawable_previews = -1;
 
   g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), NULL);
   g_return_val_if_fail (src_x >= 0, NULL);
@@ -436,8 +318,6 @@ gimp_drawable_get_sub_preview_async (GimpDrawable *drawable,
   if (! image->gimp->config->layer_previews)
     return NULL;
 
-  buffer = gimp_drawable_get_buffer_with_effects (drawable);
-
   if (no_async_drawable_previews < 0)
     {
       no_async_drawable_previews =
@@ -446,7 +326,7 @@ gimp_drawable_get_sub_preview_async (GimpDrawable *drawable,
 
   if (no_async_drawable_previews)
     {
-      GimpAsync *async = gimp_async_new ();
+      async = gimp_async_new ();
 
       gimp_async_finish_full (async,
                               gimp_drawable_get_sub_preview (drawable,
@@ -467,26 +347,15 @@ gimp_drawable_get_sub_preview_async (GimpDrawable *drawable,
   scaled_x = RINT ((gdouble) src_x * scale);
   scaled_y = RINT ((gdouble) src_y * scale);
 
-  data = sub_preview_data_new (
-    gimp_drawable_get_preview_format (drawable),
+  buffer = gimp_drawable_get_buffer_with_effects (drawable);
+
+  async = gimp_preview_async_new (
     buffer,
+    gimp_drawable_get_preview_format (drawable),
     GEGL_RECTANGLE (scaled_x, scaled_y, dest_width, dest_height),
     scale);
 
-  if (gimp_tile_handler_validate_get_assigned (buffer))
-    {
-      return gimp_idle_run_async_full (
-        GIMP_PRIORITY_VIEWABLE_IDLE,
-        (GimpRunAsyncFunc) gimp_drawable_get_sub_preview_async_func,
-        data,
-        (GDestroyNotify) sub_preview_data_free);
-    }
-  else
-    {
-      return gimp_parallel_run_async_full (
-        +1,
-        (GimpRunAsyncFunc) gimp_drawable_get_sub_preview_async_func,
-        data,
-        (GDestroyNotify) sub_preview_data_free);
-    }
+  g_object_unref (buffer);
+
+  return async;
 }
@@ -36,6 +36,8 @@ struct _GimpDrawablePrivate
   GimpApplicator   *fs_applicator;
 
   GeglNode         *mode_node;
+  GimpOpaqueTiles  *opaque_tiles;
+  GimpHistogramCache *histogram_cache;
 
   gint              paint_count;
   GeglBuffer       *paint_buffer;
@@ -43,4 +45,8 @@ struct _GimpDrawablePrivate
   cairo_region_t   *paint_update_region;
 
   gboolean          push_resize_undo;
+
+  GeglBuffer       *scaled_buffer;
+  GeglBuffer       *scaled_source;
+  GimpInterpolationType scaled_interpolation;
 };
@@ -23,11 +23,15 @@
 
 #include "core-types.h"
 
+#include "gegl/gimp-gegl-loops.h"
 #include "gegl/gimp-gegl-utils.h"
 
+#include "gimp-log.h"
+#include "gimpchannel.h"
 #include "gimpdrawable.h"
 #include "gimpdrawable-private.h"
 #include "gimpdrawable-shadow.h"
+#include "gimpimage.h"
 
 
 GeglBuffer *
@@ -93,7 +97,42 @@ gimp_drawable_merge_shadow_buffer (GimpDrawable *drawable,
    */
   if (gimp_item_mask_intersect (GIMP_ITEM (drawable), &x, &y, &width, &height))
     {
-      GeglBuffer *buffer = g_object_ref (drawable->private->shadow);
+      GimpImage   *image = gimp_item_get_image (GIMP_ITEM (drawable));
+      GimpChannel *mask  = gimp_image_get_mask (image);
+      GeglBuffer  *buffer;
+
+      /*  without a selection, and with all components affected, merging
+       *  the shadow buffer is a plain copy, which shares the shadow
+       *  buffer's tiles with the drawable, instead of compositing them
+       */
+      if ((GIMP_DRAWABLE (mask) == drawable || gimp_channel_is_empty (mask)) &&
+          gimp_drawable_get_active_mask (drawable) == GIMP_COMPONENT_MASK_ALL)
+        {
+          gint64 shared_size;
+          gint64 copied_size;
+
+          if (push_undo)
+            {
+              gimp_drawable_push_undo (drawable, undo_desc,
+                                       NULL, x, y, width, height);
+            }
+
+          gimp_gegl_buffer_copy_shared (drawable->private->shadow,
+                                        GEGL_RECTANGLE (x, y, width, height),
+                                        GEGL_ABYSS_NONE,
+                                        gimp_drawable_get_buffer (drawable),
+                                        NULL,
+                                        &shared_size, &copied_size);
+
+          GIMP_LOG (TILE_SHARING,
+                    "shadow merge of %dx%d: %" G_GINT64_FORMAT " bytes shared, "
+                    "%" G_GINT64_FORMAT " bytes copied",
+                    width, height, shared_size, copied_size);
+
+          return;
+        }
+
+      buffer = g_object_ref (drawable->private->shadow);
 
       gimp_drawable_apply_buffer (drawable, buffer,
                                   GEGL_RECTANGLE (x, y, width, height),
@@ -79,6 +79,21 @@ gimp_drawable_stroke_path (GimpDrawable       *drawable,
                            GimpPath           *path,
                            gboolean            push_undo,
                            GError            **error)
+{
+  return gimp_drawable_stroke_path_area (drawable, options, path, NULL,
+                                         push_undo, error);
+}
+
+/* like gimp_drawable_stroke_path(), but only touches the part of the
+ * drawable inside @area, which is in drawable coordinates
+ */
+gboolean
+gimp_drawable_stroke_path_area (GimpDrawable         *drawable,
+                                GimpStrokeOptions    *options,
+                                GimpPath             *path,
+                                const GeglRectangle  *area,
+                                gboolean              push_undo,
+                                GError              **error)
 {
   const GimpBezierDesc *bezier;
 
@@ -99,8 +114,8 @@ gimp_drawable_stroke_path (GimpDrawable       *drawable,
       GimpScanConvert *scan_convert = gimp_scan_convert_new ();
 
       gimp_scan_convert_add_bezier (scan_convert, bezier);
-      gimp_drawable_stroke_scan_convert (drawable, options,
-                                         scan_convert, push_undo);
+      gimp_drawable_stroke_scan_convert_area (drawable, options,
+                                              scan_convert, area, push_undo);
 
       gimp_scan_convert_free (scan_convert);
 
@@ -118,6 +133,17 @@ gimp_drawable_stroke_scan_convert (GimpDrawable      *drawable,
                                    GimpStrokeOptions *options,
                                    GimpScanConvert   *scan_convert,
                                    gboolean           push_undo)
+{
+  gimp_drawable_stroke_scan_convert_area (drawable, options, scan_convert,
+                                          NULL, push_undo);
+}
+
+void
+gimp_drawable_stroke_scan_convert_area (GimpDrawable        *drawable,
+                                        GimpStrokeOptions   *options,
+                                        GimpScanConvert     *scan_convert,
+                                        const GeglRectangle *area,
+                                        gboolean             push_undo)
 {
   gdouble   width;
   GimpUnit *unit;
@@ -156,6 +182,6 @@ gimp_drawable_stroke_scan_convert (GimpDrawable      *drawable,
                             gimp_stroke_options_get_dash_offset (options),
                             gimp_stroke_options_get_dash_info (options));
 
-  gimp_drawable_fill_scan_convert (drawable, GIMP_FILL_OPTIONS (options),
-                                   scan_convert, push_undo);
+  gimp_drawable_fill_scan_convert_area (drawable, GIMP_FILL_OPTIONS (options),
+                                        scan_convert, area, push_undo);
 }
@@ -34,8 +34,20 @@ gboolean   gimp_drawable_stroke_path         (GimpDrawable       *drawable,
                                               GimpPath           *path,
                                               gboolean            push_undo,
                                               GError            **error);
+gboolean   gimp_drawable_stroke_path_area    (GimpDrawable        *drawable,
+                                              GimpStrokeOptions   *options,
+                                              GimpPath            *path,
+                                              const GeglRectangle *area,
+                                              gboolean             push_undo,
+                                              GError             **error);
 
 void       gimp_drawable_stroke_scan_convert (GimpDrawable      *drawable,
                                               GimpStrokeOptions *options,
                                               GimpScanConvert   *scan_convert,
                                               gboolean           push_undo);
+void       gimp_drawable_stroke_scan_convert_area
+                                             (GimpDrawable        *drawable,
+                                              GimpStrokeOptions   *options,
+                                              GimpScanConvert     *scan_convert,
+                                              const GeglRectangle *area,
+                                              gboolean             push_undo);
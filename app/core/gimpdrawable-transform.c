@@ -31,6 +31,7 @@
 #include "core-types.h"
 
 #include "gegl/gimp-gegl-apply-operation.h"
+#include "gegl/gimp-gegl-loops.h"
 #include "gegl/gimp-gegl-utils.h"
 
 #include "gimp.h"
@@ -51,6 +52,43 @@
 #include "gimp-intl.h"
 
 
+#define EPSILON    1e-6
+#define CHUNK_SIZE 64
+
+
+/*  local function prototypes  */
+
+static gboolean   gimp_drawable_transform_buffer_exact      (GeglBuffer            *orig_buffer,
+                                                             GeglBuffer            *new_buffer,
+                                                             GimpInterpolationType  interpolation_type,
+                                                             const GimpMatrix3     *matrix);
+static void       gimp_drawable_transform_buffer_orthogonal (GeglBuffer            *orig_buffer,
+                                                             GeglBuffer            *new_buffer,
+                                                             gint                   a,
+                                                             gint                   b,
+                                                             gint                   c,
+                                                             gint                   d,
+                                                             gint                   tx,
+                                                             gint                   ty);
+static void       gimp_drawable_transform_buffer_enlarge    (GeglBuffer            *orig_buffer,
+                                                             GeglBuffer            *new_buffer,
+                                                             gint                   kx,
+                                                             gint                   ky,
+                                                             gint                   tx,
+                                                             gint                   ty);
+static void       gimp_drawable_transform_buffer_reduce     (GeglBuffer            *orig_buffer,
+                                                             GeglBuffer            *new_buffer,
+                                                             gint                   kx,
+                                                             gint                   ky,
+                                                             gint                   ox,
+                                                             gint                   oy);
+
+static gboolean   gimp_drawable_transform_is_integer        (gdouble                value,
+                                                             gint                  *integer);
+static gint       gimp_drawable_transform_div_floor         (gint                   value,
+                                                             gint                   divisor);
+
+
 /*  public functions  */
 
 GeglBuffer *
@@ -114,10 +152,15 @@ gimp_drawable_transform_buffer_affine (GimpDrawable            *drawable,
   gimp_matrix3_mult (&m, &gegl_matrix);
   gimp_matrix3_translate (&gegl_matrix, -x1, -y1);
 
-  gimp_gegl_apply_transform (orig_buffer, progress, NULL,
-                             new_buffer,
-                             interpolation_type,
-                             &gegl_matrix);
+  if (! gimp_drawable_transform_buffer_exact (orig_buffer, new_buffer,
+                                              interpolation_type,
+                                              &gegl_matrix))
+    {
+      gimp_gegl_apply_transform (orig_buffer, progress, NULL,
+                                 new_buffer,
+                                 interpolation_type,
+                                 &gegl_matrix);
+    }
 
   *new_offset_x = x1;
   *new_offset_y = y1;
@@ -138,17 +181,13 @@ gimp_drawable_transform_buffer_flip (GimpDrawable         *drawable,
                                      gint                 *new_offset_x,
                                      gint                 *new_offset_y)
 {
-  const Babl         *format;
-  GeglBuffer         *new_buffer;
-  GeglBufferIterator *iter;
-  GeglRectangle       src_rect;
-  GeglRectangle       dest_rect;
-  gint                bpp;
-  gint                orig_x, orig_y;
-  gint                orig_width, orig_height;
-  gint                new_x, new_y;
-  gint                new_width, new_height;
-  gint                x, y;
+  const Babl    *format;
+  GeglBuffer    *new_buffer;
+  GeglRectangle  dest_rect;
+  gint           orig_x, orig_y;
+  gint           orig_width, orig_height;
+  gint           new_x, new_y;
+  gint           new_width, new_height;
 
   g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), NULL);
   g_return_val_if_fail (gimp_item_is_attached (GIMP_ITEM (drawable)), NULL);
@@ -189,7 +228,6 @@ gimp_drawable_transform_buffer_flip (GimpDrawable         *drawable,
     }
 
   format = gegl_buffer_get_format (orig_buffer);
-  bpp    = babl_format_get_bytes_per_pixel (format);
 
   new_buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0,
                                                 new_width, new_height),
@@ -252,89 +290,11 @@ gimp_drawable_transform_buffer_flip (GimpDrawable         *drawable,
   dest_rect.width  = new_width;
   dest_rect.height = new_height;
 
-  iter = gegl_buffer_iterator_new (new_buffer, &dest_rect, 0, NULL,
-                                   GEGL_BUFFER_WRITE, GEGL_ABYSS_NONE, 1);
-
-  switch (flip_type)
-    {
-    case GIMP_ORIENTATION_HORIZONTAL:
-      while (gegl_buffer_iterator_next (iter))
-        {
-          gint stride = iter->items[0].roi.width * bpp;
-
-          src_rect = iter->items[0].roi;
-
-          src_rect.x = (orig_x + orig_width)          -
-                       (iter->items[0].roi.x - dest_rect.x) -
-                       iter->items[0].roi.width;
-
-          gegl_buffer_get (orig_buffer, &src_rect, 1.0, NULL, iter->items[0].data,
-                           stride, GEGL_ABYSS_NONE);
-
-          for (y = 0; y < iter->items[0].roi.height; y++)
-            {
-              guint8 *left  = iter->items[0].data;
-              guint8 *right = iter->items[0].data;
-
-              left  += y * stride;
-              right += y * stride + (iter->items[0].roi.width - 1) * bpp;
-
-              for (x = 0; x < iter->items[0].roi.width / 2; x++)
-                {
-                  guint8 temp[bpp];
-
-                  memcpy (temp,  left,  bpp);
-                  memcpy (left,  right, bpp);
-                  memcpy (right, temp,  bpp);
-
-                  left  += bpp;
-                  right -= bpp;
-                }
-            }
-        }
-      break;
-
-    case GIMP_ORIENTATION_VERTICAL:
-      while (gegl_buffer_iterator_next (iter))
-        {
-          gint stride = iter->items[0].roi.width * bpp;
-
-          src_rect = iter->items[0].roi;
-
-          src_rect.y = (orig_y + orig_height)         -
-                       (iter->items[0].roi.y - dest_rect.y) -
-                       iter->items[0].roi.height;
-
-          gegl_buffer_get (orig_buffer, &src_rect, 1.0, NULL, iter->items[0].data,
-                           stride, GEGL_ABYSS_NONE);
-
-          for (x = 0; x < iter->items[0].roi.width; x++)
-            {
-              guint8 *top    = iter->items[0].data;
-              guint8 *bottom = iter->items[0].data;
-
-              top    += x * bpp;
-              bottom += x * bpp + (iter->items[0].roi.height - 1) * stride;
-
-              for (y = 0; y < iter->items[0].roi.height / 2; y++)
-                {
-                  guint8 temp[bpp];
-
-                  memcpy (temp,   top,    bpp);
-                  memcpy (top,    bottom, bpp);
-                  memcpy (bottom, temp,   bpp);
-
-                  top    += stride;
-                  bottom -= stride;
-                }
-            }
-        }
-      break;
-
-    case GIMP_ORIENTATION_UNKNOWN:
-      gegl_buffer_iterator_stop (iter);
-      break;
-    }
+  gimp_gegl_buffer_flip (orig_buffer,
+                         GEGL_RECTANGLE (orig_x, orig_y,
+                                         orig_width, orig_height),
+                         new_buffer, &dest_rect,
+                         flip_type);
 
   return new_buffer;
 }
@@ -395,7 +355,6 @@ gimp_drawable_transform_buffer_rotate (GimpDrawable      *drawable,
   GeglRectangle  dest_rect;
   gint           orig_x, orig_y;
   gint           orig_width, orig_height;
-  gint           orig_bpp;
   gint           new_x, new_y;
   gint           new_width, new_height;
 
@@ -414,7 +373,6 @@ gimp_drawable_transform_buffer_rotate (GimpDrawable      *drawable,
   orig_y      = orig_offset_y;
   orig_width  = gegl_buffer_get_width (orig_buffer);
   orig_height = gegl_buffer_get_height (orig_buffer);
-  orig_bpp    = babl_format_get_bytes_per_pixel (gegl_buffer_get_format (orig_buffer));
 
   switch (rotate_type)
     {
@@ -570,118 +528,9 @@ gimp_drawable_transform_buffer_rotate (GimpDrawable      *drawable,
   dest_rect.width  = new_width;
   dest_rect.height = new_height;
 
-  switch (rotate_type)
-    {
-    case GIMP_ROTATE_DEGREES90:
-      {
-        guchar *buf = g_new (guchar, new_height * orig_bpp);
-        gint    i;
-
-        /* Not cool, we leak memory if we return, but anyway that is
-         * never supposed to happen. If we see this warning, a bug has
-         * to be fixed!
-         */
-        g_return_val_if_fail (new_height == orig_width, NULL);
-
-        src_rect.y      = orig_y + orig_height - 1;
-        src_rect.height = 1;
-
-        dest_rect.x     = new_x;
-        dest_rect.width = 1;
-
-        for (i = 0; i < orig_height; i++)
-          {
-            src_rect.y  = orig_y + orig_height - 1 - i;
-            dest_rect.x = new_x + i;
-
-            gegl_buffer_get (orig_buffer, &src_rect, 1.0, NULL, buf,
-                             GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
-            gegl_buffer_set (new_buffer, &dest_rect, 0, NULL, buf,
-                             GEGL_AUTO_ROWSTRIDE);
-          }
-
-        g_free (buf);
-      }
-      break;
-
-    case GIMP_ROTATE_DEGREES180:
-      {
-        guchar *buf = g_new (guchar, new_width * orig_bpp);
-        gint    i, j, k;
-
-        /* Not cool, we leak memory if we return, but anyway that is
-         * never supposed to happen. If we see this warning, a bug has
-         * to be fixed!
-         */
-        g_return_val_if_fail (new_width == orig_width, NULL);
-
-        src_rect.y      = orig_y + orig_height - 1;
-        src_rect.height = 1;
-
-        dest_rect.y      = new_y;
-        dest_rect.height = 1;
-
-        for (i = 0; i < orig_height; i++)
-          {
-            src_rect.y  = orig_y + orig_height - 1 - i;
-            dest_rect.y = new_y + i;
-
-            gegl_buffer_get (orig_buffer, &src_rect, 1.0, NULL, buf,
-                             GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
-
-            for (j = 0; j < orig_width / 2; j++)
-              {
-                guchar *left  = buf + j * orig_bpp;
-                guchar *right = buf + (orig_width - 1 - j) * orig_bpp;
-
-                for (k = 0; k < orig_bpp; k++)
-                  {
-                    guchar tmp = left[k];
-                    left[k]    = right[k];
-                    right[k]   = tmp;
-                  }
-              }
-
-            gegl_buffer_set (new_buffer, &dest_rect, 0, NULL, buf,
-                             GEGL_AUTO_ROWSTRIDE);
-          }
-
-        g_free (buf);
-      }
-      break;
-
-    case GIMP_ROTATE_DEGREES270:
-      {
-        guchar *buf = g_new (guchar, new_width * orig_bpp);
-        gint    i;
-
-        /* Not cool, we leak memory if we return, but anyway that is
-         * never supposed to happen. If we see this warning, a bug has
-         * to be fixed!
-         */
-        g_return_val_if_fail (new_width == orig_height, NULL);
-
-        src_rect.x     = orig_x + orig_width - 1;
-        src_rect.width = 1;
-
-        dest_rect.y      = new_y;
-        dest_rect.height = 1;
-
-        for (i = 0; i < orig_width; i++)
-          {
-            src_rect.x  = orig_x + orig_width - 1 - i;
-            dest_rect.y = new_y + i;
-
-            gegl_buffer_get (orig_buffer, &src_rect, 1.0, NULL, buf,
-                             GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
-            gegl_buffer_set (new_buffer, &dest_rect, 0, NULL, buf,
-                             GEGL_AUTO_ROWSTRIDE);
-          }
-
-        g_free (buf);
-      }
-      break;
-    }
+  gimp_gegl_buffer_rotate (orig_buffer, &src_rect,
+                           new_buffer, &dest_rect,
+                           rotate_type);
 
   return new_buffer;
 }
@@ -991,7 +840,7 @@ gimp_drawable_transform_cut (GList        *drawables,
         {
           buffer = gimp_selection_extract (GIMP_SELECTION (gimp_image_get_mask (image)),
                                            drawables, context,
-                                           TRUE, FALSE, TRUE,
+                                           TRUE, FALSE, TRUE, 0,
                                            offset_x, offset_y,
                                            NULL);
           /*  clear the selection  */
@@ -1010,7 +859,7 @@ gimp_drawable_transform_cut (GList        *drawables,
       buffer = gimp_selection_extract (GIMP_SELECTION (gimp_image_get_mask (image)),
                                        drawables, context,
                                        FALSE, TRUE,
-                                       drawables_are_layers,
+                                       drawables_are_layers, 0,
                                        offset_x, offset_y,
                                        NULL);
 
@@ -1082,3 +931,383 @@ gimp_drawable_transform_paste (GimpDrawable     *drawable,
 
   return drawable;
 }
+
+
+/*  private functions  */
+
+/*  handles the transforms that map the source pixel grid exactly onto
+ *  the target pixel grid without going through gegl:transform: integer
+ *  translations, 90 degree rotations and flips, integer enlargements
+ *  when not interpolating, and integer reductions otherwise.  'matrix'
+ *  maps source buffer to target buffer coordinates.  returns FALSE if
+ *  the transform has to be resampled.
+ */
+static gboolean
+gimp_drawable_transform_buffer_exact (GeglBuffer            *orig_buffer,
+                                      GeglBuffer            *new_buffer,
+                                      GimpInterpolationType  interpolation_type,
+                                      const GimpMatrix3     *matrix)
+{
+  gint a, b, c, d;
+  gint tx, ty;
+
+  if (fabs (matrix->coeff[2][0])       > EPSILON ||
+      fabs (matrix->coeff[2][1])       > EPSILON ||
+      fabs (matrix->coeff[2][2] - 1.0) > EPSILON)
+    {
+      return FALSE;
+    }
+
+  if (gimp_drawable_transform_is_integer (matrix->coeff[0][0], &a) &&
+      gimp_drawable_transform_is_integer (matrix->coeff[0][1], &b) &&
+      gimp_drawable_transform_is_integer (matrix->coeff[1][0], &c) &&
+      gimp_drawable_transform_is_integer (matrix->coeff[1][1], &d) &&
+      abs (a) + abs (b) == 1 && abs (c) + abs (d) == 1 && abs (a) == abs (d))
+    {
+      if (! gimp_drawable_transform_is_integer (matrix->coeff[0][2], &tx) ||
+          ! gimp_drawable_transform_is_integer (matrix->coeff[1][2], &ty))
+        {
+          return FALSE;
+        }
+
+      gimp_drawable_transform_buffer_orthogonal (orig_buffer, new_buffer,
+                                                 a, b, c, d, tx, ty);
+
+      return TRUE;
+    }
+
+  if (fabs (matrix->coeff[0][1]) > EPSILON ||
+      fabs (matrix->coeff[1][0]) > EPSILON ||
+      matrix->coeff[0][0] <= EPSILON       ||
+      matrix->coeff[1][1] <= EPSILON)
+    {
+      return FALSE;
+    }
+
+  if (interpolation_type == GIMP_INTERPOLATION_NONE)
+    {
+      gint kx, ky;
+
+      /*  nearest neighbor enlargements replicate each pixel k times  */
+      if (! gimp_drawable_transform_is_integer (matrix->coeff[0][0], &kx) ||
+          ! gimp_drawable_transform_is_integer (matrix->coeff[1][1], &ky) ||
+          ! gimp_drawable_transform_is_integer (matrix->coeff[0][2], &tx) ||
+          ! gimp_drawable_transform_is_integer (matrix->coeff[1][2], &ty))
+        {
+          return FALSE;
+        }
+
+      gimp_drawable_transform_buffer_enlarge (orig_buffer, new_buffer,
+                                              kx, ky, tx, ty);
+    }
+  else
+    {
+      gint kx, ky;
+      gint ox, oy;
+
+      /*  interpolated reductions by k are box filtered, each target
+       *  pixel averaging the k x k source pixels it covers
+       */
+      if (! gimp_drawable_transform_is_integer (1.0 / matrix->coeff[0][0], &kx) ||
+          ! gimp_drawable_transform_is_integer (1.0 / matrix->coeff[1][1], &ky) ||
+          kx < 2 || ky < 2                                                     ||
+          ! gimp_drawable_transform_is_integer (-kx * matrix->coeff[0][2], &ox) ||
+          ! gimp_drawable_transform_is_integer (-ky * matrix->coeff[1][2], &oy))
+        {
+          return FALSE;
+        }
+
+      gimp_drawable_transform_buffer_reduce (orig_buffer, new_buffer,
+                                             kx, ky, ox, oy);
+    }
+
+  return TRUE;
+}
+
+/*  the linear part is one of the 8 rotations and flips of the pixel
+ *  grid, so target pixel (x, y) is source pixel (u, v) with
+ *
+ *    u = a (x - tx) + c (y - ty) + (a + c - 1) / 2
+ *    v = b (x - tx) + d (y - ty) + (b + d - 1) / 2
+ *
+ *  the target is left transparent outside the transformed source, like
+ *  gegl:transform does.
+ */
+static void
+gimp_drawable_transform_buffer_orthogonal (GeglBuffer *orig_buffer,
+                                           GeglBuffer *new_buffer,
+                                           gint        a,
+                                           gint        b,
+                                           gint        c,
+                                           gint        d,
+                                           gint        tx,
+                                           gint        ty)
+{
+  const Babl    *format = gegl_buffer_get_format (new_buffer);
+  gint           bpp    = babl_format_get_bytes_per_pixel (format);
+  gint           width  = gegl_buffer_get_width  (orig_buffer);
+  gint           height = gegl_buffer_get_height (orig_buffer);
+  GeglRectangle  dest;
+  GeglRectangle  area;
+  guchar        *src_buf;
+  guchar        *dest_buf;
+  gint           x, y;
+
+  /*  the part of the target the source lands on  */
+  dest.x      = tx + MIN (0, a * width) + MIN (0, b * height);
+  dest.y      = ty + MIN (0, c * width) + MIN (0, d * height);
+  dest.width  = abs (a) * width  + abs (b) * height;
+  dest.height = abs (c) * width  + abs (d) * height;
+
+  if (! gegl_rectangle_intersect (&area, &dest,
+                                  gegl_buffer_get_extent (new_buffer)))
+    {
+      return;
+    }
+
+  if (a == 1 && d == 1)
+    {
+      gimp_gegl_buffer_copy (orig_buffer,
+                             GEGL_RECTANGLE (area.x - tx, area.y - ty,
+                                             area.width, area.height),
+                             GEGL_ABYSS_NONE,
+                             new_buffer, &area);
+
+      return;
+    }
+
+  src_buf  = g_malloc (CHUNK_SIZE * CHUNK_SIZE * bpp);
+  dest_buf = g_malloc (CHUNK_SIZE * CHUNK_SIZE * bpp);
+
+  for (y = area.y; y < area.y + area.height; y += CHUNK_SIZE)
+    {
+      for (x = area.x; x < area.x + area.width; x += CHUNK_SIZE)
+        {
+          GeglRectangle  dest_rect;
+          GeglRectangle  src_rect;
+          gint           u1, v1, u2, v2;
+          gint           i, j;
+          guchar        *d_ptr;
+
+          dest_rect.x      = x;
+          dest_rect.y      = y;
+          dest_rect.width  = MIN (CHUNK_SIZE, area.x + area.width  - x);
+          dest_rect.height = MIN (CHUNK_SIZE, area.y + area.height - y);
+
+          /*  map the chunk's first and last pixel back to the source  */
+          u1 = a * (x - tx) + c * (y - ty) + (a + c - 1) / 2;
+          v1 = b * (x - tx) + d * (y - ty) + (b + d - 1) / 2;
+          u2 = u1 + a * (dest_rect.width - 1) + c * (dest_rect.height - 1);
+          v2 = v1 + b * (dest_rect.width - 1) + d * (dest_rect.height - 1);
+
+          src_rect.x      = MIN (u1, u2);
+          src_rect.y      = MIN (v1, v2);
+          src_rect.width  = abs (u2 - u1) + 1;
+          src_rect.height = abs (v2 - v1) + 1;
+
+          gegl_buffer_get (orig_buffer, &src_rect, 1.0, format, src_buf,
+                           GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+          d_ptr = dest_buf;
+
+          for (j = 0; j < dest_rect.height; j++)
+            {
+              gint u = u1 + c * j - src_rect.x;
+              gint v = v1 + d * j - src_rect.y;
+
+              for (i = 0; i < dest_rect.width; i++)
+                {
+                  memcpy (d_ptr, src_buf + (v * src_rect.width + u) * bpp, bpp);
+
+                  d_ptr += bpp;
+                  u     += a;
+                  v     += b;
+                }
+            }
+
+          gegl_buffer_set (new_buffer, &dest_rect, 0, format, dest_buf,
+                           GEGL_AUTO_ROWSTRIDE);
+        }
+    }
+
+  g_free (src_buf);
+  g_free (dest_buf);
+}
+
+/*  target pixel (x, y) is source pixel (floor ((x - tx) / kx),
+ *  floor ((y - ty) / ky))
+ */
+static void
+gimp_drawable_transform_buffer_enlarge (GeglBuffer *orig_buffer,
+                                        GeglBuffer *new_buffer,
+                                        gint        kx,
+                                        gint        ky,
+                                        gint        tx,
+                                        gint        ty)
+{
+  const Babl    *format = gegl_buffer_get_format (new_buffer);
+  gint           bpp    = babl_format_get_bytes_per_pixel (format);
+  GeglRectangle  dest;
+  GeglRectangle  area;
+  guchar        *src_buf;
+  guchar        *dest_buf;
+  gint           y;
+
+  dest.x      = tx;
+  dest.y      = ty;
+  dest.width  = kx * gegl_buffer_get_width  (orig_buffer);
+  dest.height = ky * gegl_buffer_get_height (orig_buffer);
+
+  if (! gegl_rectangle_intersect (&area, &dest,
+                                  gegl_buffer_get_extent (new_buffer)))
+    {
+      return;
+    }
+
+  src_buf  = g_malloc ((area.width / kx + 2) * bpp);
+  dest_buf = g_malloc (area.width * ky * bpp);
+
+  for (y = area.y; y < area.y + area.height; )
+    {
+      gint    v      = gimp_drawable_transform_div_floor (y - ty, ky);
+      gint    u1     = gimp_drawable_transform_div_floor (area.x - tx, kx);
+      gint    u2     = gimp_drawable_transform_div_floor (area.x + area.width - 1 - tx, kx);
+      gint    height = MIN (ty + (v + 1) * ky, area.y + area.height) - y;
+      guchar *d_ptr  = dest_buf;
+      gint    i, j;
+
+      gegl_buffer_get (orig_buffer,
+                       GEGL_RECTANGLE (u1, v, u2 - u1 + 1, 1), 1.0,
+                       format, src_buf,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+      for (i = 0; i < area.width; i++)
+        {
+          gint u = gimp_drawable_transform_div_floor (area.x + i - tx, kx);
+
+          memcpy (d_ptr, src_buf + (u - u1) * bpp, bpp);
+
+          d_ptr += bpp;
+        }
+
+      for (j = 1; j < height; j++)
+        memcpy (dest_buf + j * area.width * bpp, dest_buf, area.width * bpp);
+
+      gegl_buffer_set (new_buffer,
+                       GEGL_RECTANGLE (area.x, y, area.width, height), 0,
+                       format, dest_buf,
+                       GEGL_AUTO_ROWSTRIDE);
+
+      y += height;
+    }
+
+  g_free (src_buf);
+  g_free (dest_buf);
+}
+
+/*  target pixel (x, y) is the average of the kx x ky source pixels
+ *  starting at (kx * x + ox, ky * y + oy), computed in premultiplied
+ *  linear light like gegl:transform's samplers
+ */
+static void
+gimp_drawable_transform_buffer_reduce (GeglBuffer *orig_buffer,
+                                       GeglBuffer *new_buffer,
+                                       gint        kx,
+                                       gint        ky,
+                                       gint        ox,
+                                       gint        oy)
+{
+  const Babl    *format;
+  GeglRectangle  dest;
+  GeglRectangle  area;
+  gfloat        *src_buf;
+  gfloat        *dest_buf;
+  gfloat         scale = 1.0f / (kx * ky);
+  gint           y;
+
+  format = babl_format_with_space ("RaGaBaA float",
+                                   gegl_buffer_get_format (new_buffer));
+
+  dest.x      = gimp_drawable_transform_div_floor (-ox, kx);
+  dest.y      = gimp_drawable_transform_div_floor (-oy, ky);
+  dest.width  = gimp_drawable_transform_div_floor (gegl_buffer_get_width  (orig_buffer) - ox + kx - 1, kx) - dest.x;
+  dest.height = gimp_drawable_transform_div_floor (gegl_buffer_get_height (orig_buffer) - oy + ky - 1, ky) - dest.y;
+
+  if (! gegl_rectangle_intersect (&area, &dest,
+                                  gegl_buffer_get_extent (new_buffer)))
+    {
+      return;
+    }
+
+  src_buf  = g_new (gfloat, area.width * kx * ky * 4);
+  dest_buf = g_new (gfloat, area.width * 4);
+
+  for (y = area.y; y < area.y + area.height; y++)
+    {
+      gint src_width = area.width * kx;
+      gint i;
+
+      gegl_buffer_get (orig_buffer,
+                       GEGL_RECTANGLE (kx * area.x + ox, ky * y + oy,
+                                       src_width, ky), 1.0,
+                       format, src_buf,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+      for (i = 0; i < area.width; i++)
+        {
+          gfloat sum[4] = { 0.0f, };
+          gint   j, k, l;
+
+          for (j = 0; j < ky; j++)
+            {
+              const gfloat *s = src_buf + (j * src_width + i * kx) * 4;
+
+              for (k = 0; k < kx; k++)
+                {
+                  for (l = 0; l < 4; l++)
+                    sum[l] += s[l];
+
+                  s += 4;
+                }
+            }
+
+          for (l = 0; l < 4; l++)
+            dest_buf[i * 4 + l] = sum[l] * scale;
+        }
+
+      gegl_buffer_set (new_buffer,
+                       GEGL_RECTANGLE (area.x, y, area.width, 1), 0,
+                       format, dest_buf,
+                       GEGL_AUTO_ROWSTRIDE);
+    }
+
+  g_free (src_buf);
+  g_free (dest_buf);
+}
+
+static gboolean
+gimp_drawable_transform_is_integer (gdouble  value,
+                                    gint    *integer)
+{
+  gdouble rounded = RINT (value);
+
+  if (fabs (value - rounded) > EPSILON ||
+      fabs (rounded) > G_MAXINT / 2)
+    {
+      return FALSE;
+    }
+
+  *integer = (gint) rounded;
+
+  return TRUE;
+}
+
+static gint
+gimp_drawable_transform_div_floor (gint value,
+                                   gint divisor)
+{
+  if (value >= 0)
+    return value / divisor;
+  else
+    return -((-value + divisor - 1) / divisor);
+}
@@ -30,12 +30,17 @@
 #include "gegl/gimp-babl.h"
 #include "gegl/gimp-gegl-apply-operation.h"
 #include "gegl/gimp-gegl-loops.h"
+#include "gegl/gimp-gegl-profile.h"
 #include "gegl/gimp-gegl-utils.h"
+#include "gegl/gimpopaquetiles.h"
 #include "gegl/gimptilehandlervalidate.h"
 
+#include "gimp-memory-tags.h"
 #include "gimp-memsize.h"
+#include "gimp-tile-profile.h"
 #include "gimp-utils.h"
 #include "gimpchannel.h"
+#include "gimpcontainer.h"
 #include "gimpcontext.h"
 #include "gimpdrawable-combine.h"
 #include "gimpdrawable-fill.h"
@@ -47,6 +52,7 @@
 #include "gimpdrawable-transform.h"
 #include "gimpdrawablefilter.h"
 #include "gimpfilterstack.h"
+#include "gimphistogram.h"
 #include "gimpimage.h"
 #include "gimpimage-colormap.h"
 #include "gimpimage-undo-push.h"
@@ -337,6 +343,9 @@ gimp_drawable_init (GimpDrawable *drawable)
 {
   drawable->private = gimp_drawable_get_instance_private (drawable);
 
+  drawable->private->opaque_tiles    = gimp_opaque_tiles_new ();
+  drawable->private->histogram_cache = gimp_histogram_cache_new ();
+
   _gimp_drawable_filters_init (drawable);
 }
 
@@ -384,11 +393,22 @@ gimp_drawable_finalize (GObject *object)
   g_clear_object (&drawable->private->buffer);
   g_clear_object (&drawable->private->format_profile);
 
+  /*  the opaque tiles may outlive us, while they're being scanned  */
+  gimp_opaque_tiles_set_buffer (drawable->private->opaque_tiles, NULL);
+  g_clear_pointer (&drawable->private->opaque_tiles, gimp_opaque_tiles_unref);
+
+  /*  and so may the histogram cache, while a histogram is calculated  */
+  g_clear_pointer (&drawable->private->histogram_cache,
+                   gimp_histogram_cache_unref);
+
   gimp_drawable_free_shadow_buffer (drawable);
 
   g_clear_object (&drawable->private->source_node);
   g_clear_object (&drawable->private->buffer_source_node);
 
+  g_clear_object (&drawable->private->scaled_buffer);
+  g_clear_object (&drawable->private->scaled_source);
+
   _gimp_drawable_filters_finalize (drawable);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -527,6 +547,9 @@ gimp_drawable_get_node (GimpFilter *filter)
                          "operation", "gimp:normal",
                          NULL);
 
+  gimp_gegl_profile_set_node_owner (drawable->private->mode_node,
+                                    G_OBJECT (drawable));
+
   input  = gegl_node_get_input_proxy  (node, "input");
   output = gegl_node_get_output_proxy (node, "output");
 
@@ -609,20 +632,38 @@ gimp_drawable_scale (GimpItem              *item,
                      GimpProgress          *progress)
 {
   GimpDrawable *drawable = GIMP_DRAWABLE (item);
+  GeglBuffer   *scaled     = drawable->private->scaled_buffer;
   GeglBuffer   *new_buffer;
 
-  new_buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0,
-                                                new_width, new_height),
-                                gimp_drawable_get_format (drawable));
+  /*  use the buffer scaled ahead of time by gimp_image_scale(), if it
+   *  was made from our current buffer, with the same parameters
+   */
+  if (scaled &&
+      drawable->private->scaled_source == gimp_drawable_get_buffer (drawable) &&
+      drawable->private->scaled_interpolation == interpolation_type &&
+      gegl_buffer_get_width  (scaled) == new_width &&
+      gegl_buffer_get_height (scaled) == new_height)
+    {
+      new_buffer = g_object_ref (scaled);
+    }
+  else
+    {
+      new_buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0,
+                                                    new_width, new_height),
+                                    gimp_drawable_get_format (drawable));
+
+      gimp_gegl_apply_scale (gimp_drawable_get_buffer (drawable),
+                             progress, C_("undo-type", "Scale"),
+                             new_buffer,
+                             interpolation_type,
+                             ((gdouble) new_width /
+                              gimp_item_get_width  (item)),
+                             ((gdouble) new_height /
+                              gimp_item_get_height (item)));
+    }
 
-  gimp_gegl_apply_scale (gimp_drawable_get_buffer (drawable),
-                         progress, C_("undo-type", "Scale"),
-                         new_buffer,
-                         interpolation_type,
-                         ((gdouble) new_width /
-                          gimp_item_get_width  (item)),
-                         ((gdouble) new_height /
-                          gimp_item_get_height (item)));
+  g_clear_object (&drawable->private->scaled_buffer);
+  g_clear_object (&drawable->private->scaled_source);
 
   gimp_drawable_set_buffer_full (drawable, gimp_item_is_attached (item), NULL,
                                  new_buffer,
@@ -890,6 +931,11 @@ gimp_drawable_real_update (GimpDrawable *drawable,
 static void
 gimp_drawable_real_filters_changed (GimpDrawable *drawable)
 {
+  /*  the buffer's pixels are only what's composited without filters  */
+  gimp_opaque_tiles_set_active (
+    drawable->private->opaque_tiles,
+    gimp_container_is_empty (gimp_drawable_get_filters (drawable)));
+
   gimp_drawable_update_bounding_box (drawable);
 }
 
@@ -995,9 +1041,23 @@ gimp_drawable_real_set_buffer (GimpDrawable        *drawable,
 
   g_set_object (&drawable->private->buffer, buffer);
 
+  gimp_memory_tags_tag_object (G_OBJECT (drawable), GIMP_MEMORY_TAG_DRAWABLE,
+                               gimp_item_get_image (item),
+                               gimp_gegl_buffer_get_memsize (buffer));
+
+  gimp_tile_profile_add_drawable (drawable);
+
   if (gimp_drawable_is_painting (drawable))
     g_set_object (&drawable->private->paint_buffer, buffer);
 
+  /*  drawables with children, like group layers, render them rather
+   *  than their buffer, which is then not worth scanning
+   */
+  if (! gimp_viewable_get_children (GIMP_VIEWABLE (drawable)))
+    gimp_opaque_tiles_set_buffer (drawable->private->opaque_tiles, buffer);
+
+  gimp_histogram_cache_invalidate (drawable->private->histogram_cache, NULL);
+
   g_clear_object (&drawable->private->format_profile);
 
   if (drawable->private->buffer_source_node)
@@ -1046,6 +1106,8 @@ gimp_drawable_real_push_undo (GimpDrawable *drawable,
     {
       GeglBuffer    *drawable_buffer = gimp_drawable_get_buffer (drawable);
       GeglRectangle  drawable_rect;
+      gint64         shared_size;
+      gint64         copied_size;
 
       gegl_rectangle_align_to_buffer (
         &drawable_rect,
@@ -1061,11 +1123,20 @@ gimp_drawable_real_push_undo (GimpDrawable *drawable,
       buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0, width, height),
                                 gimp_drawable_get_format (drawable));
 
-      gimp_gegl_buffer_copy (
+      /*  the area is tile-aligned, so all of its tiles are shared with
+       *  the drawable until they are modified
+       */
+      gimp_gegl_buffer_copy_shared (
         drawable_buffer,
         &drawable_rect, GEGL_ABYSS_NONE,
         buffer,
-        GEGL_RECTANGLE (0, 0, 0, 0));
+        GEGL_RECTANGLE (0, 0, 0, 0),
+        &shared_size, &copied_size);
+
+      GIMP_LOG (TILE_SHARING,
+                "undo of %dx%d: %" G_GINT64_FORMAT " bytes shared, "
+                "%" G_GINT64_FORMAT " bytes copied",
+                width, height, shared_size, copied_size);
     }
   else
     {
@@ -1210,8 +1281,14 @@ gimp_drawable_update (GimpDrawable *drawable,
         }
     }
 
+  /*  while painting, the buffer only changes when the paint is flushed  */
   if (drawable->private->paint_count == 0)
     {
+      gimp_opaque_tiles_invalidate (drawable->private->opaque_tiles,
+                                    GEGL_RECTANGLE (x, y, width, height));
+      gimp_histogram_cache_invalidate (drawable->private->histogram_cache,
+                                       GEGL_RECTANGLE (x, y, width, height));
+
       g_signal_emit (drawable, gimp_drawable_signals[UPDATE], 0,
                      x, y, width, height);
     }
@@ -1619,6 +1696,38 @@ gimp_drawable_get_buffer_with_effects (GimpDrawable *drawable)
     }
 }
 
+/**
+ * gimp_drawable_set_scaled_buffer:
+ * @drawable:           a #GimpDrawable
+ * @source:             the buffer @buffer was scaled from
+ * @buffer:             (nullable): the scaled buffer
+ * @interpolation_type: the interpolation @buffer was scaled with
+ *
+ * Hands @drawable a copy of @source that was already scaled, so that
+ * the next gimp_item_scale() of @drawable can use it instead of
+ * scaling again.  It is only used if @source is still the drawable's
+ * buffer, and the scale asks for the same size and interpolation;
+ * either way, it is dropped by that scale.
+ **/
+void
+gimp_drawable_set_scaled_buffer (GimpDrawable          *drawable,
+                                 GeglBuffer            *source,
+                                 GeglBuffer            *buffer,
+                                 GimpInterpolationType  interpolation_type)
+{
+  g_return_if_fail (GIMP_IS_DRAWABLE (drawable));
+  g_return_if_fail (buffer == NULL || GEGL_IS_BUFFER (source));
+  g_return_if_fail (buffer == NULL || GEGL_IS_BUFFER (buffer));
+
+  if (! buffer)
+    source = NULL;
+
+  g_set_object (&drawable->private->scaled_buffer, buffer);
+  g_set_object (&drawable->private->scaled_source, source);
+
+  drawable->private->scaled_interpolation = interpolation_type;
+}
+
 void
 gimp_drawable_steal_buffer (GimpDrawable *drawable,
                             GimpDrawable *src_drawable)
@@ -1749,6 +1858,22 @@ gimp_drawable_get_mode_node (GimpDrawable *drawable)
   return drawable->private->mode_node;
 }
 
+GimpOpaqueTiles *
+gimp_drawable_get_opaque_tiles (GimpDrawable *drawable)
+{
+  g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), NULL);
+
+  return drawable->private->opaque_tiles;
+}
+
+GimpHistogramCache *
+gimp_drawable_get_histogram_cache (GimpDrawable *drawable)
+{
+  g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), NULL);
+
+  return drawable->private->histogram_cache;
+}
+
 GeglRectangle
 gimp_drawable_get_bounding_box (GimpDrawable *drawable)
 {
@@ -2141,6 +2266,11 @@ gimp_drawable_flush_paint (GimpDrawable *drawable)
           cairo_region_get_rectangle (drawable->private->paint_copy_region,
                                       i, (cairo_rectangle_int_t *) &rect);
 
+          gimp_opaque_tiles_invalidate (drawable->private->opaque_tiles,
+                                        &rect);
+          gimp_histogram_cache_invalidate (drawable->private->histogram_cache,
+                                           &rect);
+
           gimp_gegl_buffer_copy (
             drawable->private->paint_buffer, &rect, GEGL_ABYSS_NONE,
             buffer, NULL);
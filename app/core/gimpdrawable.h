@@ -180,6 +180,11 @@ void            gimp_drawable_set_buffer_full         (GimpDrawable       *drawa
                                                        gboolean            update);
 GeglBuffer    * gimp_drawable_get_buffer_with_effects (GimpDrawable       *drawable);
 
+void            gimp_drawable_set_scaled_buffer       (GimpDrawable       *drawable,
+                                                       GeglBuffer         *source,
+                                                       GeglBuffer         *buffer,
+                                                       GimpInterpolationType interpolation_type);
+
 void            gimp_drawable_steal_buffer            (GimpDrawable       *drawable,
                                                        GimpDrawable       *src_drawable);
 
@@ -190,6 +195,8 @@ void            gimp_drawable_set_format              (GimpDrawable       *drawa
 
 GeglNode      * gimp_drawable_get_source_node         (GimpDrawable       *drawable);
 GeglNode      * gimp_drawable_get_mode_node           (GimpDrawable       *drawable);
+GimpOpaqueTiles * gimp_drawable_get_opaque_tiles    (GimpDrawable       *drawable);
+GimpHistogramCache * gimp_drawable_get_histogram_cache (GimpDrawable    *drawable);
 
 GeglRectangle   gimp_drawable_get_bounding_box        (GimpDrawable       *drawable);
 gboolean        gimp_drawable_update_bounding_box
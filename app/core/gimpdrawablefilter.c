@@ -35,6 +35,7 @@
 
 #include "libgimpbase/gimpbase.h"
 #include "libgimpcolor/gimpcolor.h"
+#include "libgimpconfig/gimpconfig.h"
 
 #include "core-types.h"
 
@@ -42,6 +43,7 @@
 
 #include "gegl/gimp-babl.h"
 #include "gegl/gimpapplicator.h"
+#include "gegl/gimp-gegl-profile.h"
 #include "gegl/gimp-gegl-utils.h"
 
 #include "gimp.h"
@@ -426,8 +428,18 @@ gimp_drawable_filter_new (GimpDrawable *drawable,
 
   filter->applicator = gimp_applicator_new (node);
 
+  gimp_gegl_profile_set_node_owner (filter->applicator->mode_node,
+                                    G_OBJECT (filter));
+
   gimp_filter_set_applicator (GIMP_FILTER (filter), filter->applicator);
 
+  /*  the applicator's cache holds the filter's composited output, so
+   *  each effect of a drawable's filter stack feeds the one above it
+   *  from a cache.  GEGL invalidates it only downstream of a change,
+   *  and only in the changed area grown by the operations' extents:
+   *  painting re-renders the affected area of each effect, and editing
+   *  an effect doesn't re-render the ones below it.
+   */
   gimp_applicator_set_cache (filter->applicator, TRUE);
 
   filter->has_input = gegl_node_has_pad (filter->operation, "input");
@@ -551,6 +563,123 @@ gimp_drawable_filter_duplicate (GimpDrawable       *drawable,
   return filter;
 }
 
+/*  copies the operation of src_filter, with its arguments, blend
+ *  settings and aux inputs, into a new filter on drawable, which may
+ *  belong to another image.  src_filter itself is left untouched, so
+ *  a filter configured once can be merged on any number of drawables.
+ */
+GimpDrawableFilter *
+gimp_drawable_filter_copy (GimpDrawable       *drawable,
+                           GimpDrawableFilter *src_filter)
+{
+  GimpDrawableFilter  *filter;
+  GeglNode            *src_node;
+  GeglNode            *node;
+  gchar               *operation;
+  gchar              **pads;
+  const gchar         *undo_desc;
+  const gchar         *icon_name;
+  GParamSpec         **pspecs;
+  guint                n_pspecs;
+
+  g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), NULL);
+  g_return_val_if_fail (GIMP_IS_DRAWABLE_FILTER (src_filter), NULL);
+
+  src_node = gimp_drawable_filter_get_operation (src_filter);
+
+  if (src_node == NULL ||
+      ! strcmp (gegl_node_get_operation (src_node), "GraphNode"))
+    return NULL;
+
+  g_object_get (src_filter,
+                "name",      &undo_desc,
+                "icon-name", &icon_name,
+                NULL);
+
+  gegl_node_get (src_node,
+                 "operation", &operation,
+                 NULL);
+
+  node = gegl_node_new ();
+
+  gegl_node_set (node,
+                 "operation", operation,
+                 NULL);
+
+  pspecs = gegl_operation_list_properties (operation, &n_pspecs);
+
+  for (gint i = 0; i < n_pspecs; i++)
+    {
+      GParamSpec *pspec = pspecs[i];
+      GValue      value = G_VALUE_INIT;
+
+      g_value_init (&value, pspec->value_type);
+      gegl_node_get_property (src_node, pspec->name, &value);
+
+      /*  custom operations keep their arguments in a settings object,
+       *  which must not be shared with src_filter
+       */
+      if (G_VALUE_HOLDS_OBJECT (&value) &&
+          GIMP_IS_CONFIG (g_value_get_object (&value)))
+        {
+          g_value_take_object (&value,
+                               gimp_config_duplicate (g_value_get_object (&value)));
+        }
+
+      gegl_node_set_property (node, pspec->name, &value);
+      g_value_unset (&value);
+    }
+  g_free (pspecs);
+
+  filter = gimp_drawable_filter_new (drawable, undo_desc, node, icon_name);
+  g_object_unref (node);
+
+  /*  connect the same buffers to the aux pads  */
+  pads = gegl_node_list_input_pads (src_node);
+
+  for (gint i = 0; pads && pads[i]; i++)
+    {
+      GeglNode   *producer;
+      GeglNode   *src;
+      GeglBuffer *buffer = NULL;
+
+      if (! strcmp (pads[i], "input"))
+        continue;
+
+      producer = gegl_node_get_producer (src_node, pads[i], NULL);
+
+      if (! producer ||
+          g_strcmp0 (gegl_node_get_operation (producer),
+                     "gegl:buffer-source"))
+        continue;
+
+      gegl_node_get (producer, "buffer", &buffer, NULL);
+
+      src = gegl_node_new_child (gegl_node_get_parent (node),
+                                 "operation", "gegl:buffer-source",
+                                 "buffer",    buffer,
+                                 NULL);
+      g_clear_object (&buffer);
+
+      gegl_node_connect (src, "output", node, pads[i]);
+    }
+  g_strfreev (pads);
+
+  gimp_drawable_filter_set_clip (filter, src_filter->clip);
+  gimp_drawable_filter_set_opacity (filter, src_filter->opacity);
+  gimp_drawable_filter_set_mode (filter,
+                                 src_filter->paint_mode,
+                                 src_filter->blend_space,
+                                 src_filter->composite_space,
+                                 src_filter->composite_mode);
+  gimp_drawable_filter_set_region (filter, src_filter->region);
+  gimp_drawable_filter_set_add_alpha (filter, src_filter->add_alpha);
+
+  g_free (operation);
+
+  return filter;
+}
+
 gint
 gimp_drawable_filter_get_id (GimpDrawableFilter *filter)
 {
@@ -55,6 +55,9 @@ GimpDrawableFilter *
 GimpDrawableFilter *
            gimp_drawable_filter_duplicate      (GimpDrawable            *drawable,
                                                 GimpDrawableFilter      *prior_filter);
+GimpDrawableFilter *
+           gimp_drawable_filter_copy           (GimpDrawable            *drawable,
+                                                GimpDrawableFilter      *src_filter);
 
 gint       gimp_drawable_filter_get_id         (GimpDrawableFilter      *item);
 GimpDrawableFilter *
@@ -27,6 +27,7 @@
 #include "gegl/gimp-gegl-utils.h"
 
 #include "gimp-memsize.h"
+#include "gimp-tile-profile.h"
 #include "gimpimage.h"
 #include "gimpdrawable.h"
 #include "gimpdrawablemodundo.h"
@@ -121,6 +122,12 @@ gimp_drawable_mod_undo_constructed (GObject *object)
   gimp_item_get_offset (item,
                         &drawable_mod_undo->offset_x,
                         &drawable_mod_undo->offset_y);
+
+  if (! gimp_viewable_get_children (GIMP_VIEWABLE (drawable)))
+    gimp_tile_profile_add_undo (gimp_item_get_image (item),
+                                drawable_mod_undo->buffer,
+                                drawable_mod_undo->offset_x,
+                                drawable_mod_undo->offset_y);
 }
 
 static void
@@ -199,6 +206,12 @@ gimp_drawable_mod_undo_pop (GimpUndo            *undo,
                         &drawable_mod_undo->offset_x,
                         &drawable_mod_undo->offset_y);
 
+  if (! gimp_viewable_get_children (GIMP_VIEWABLE (drawable)))
+    gimp_tile_profile_add_undo (gimp_item_get_image (GIMP_ITEM (drawable)),
+                                drawable_mod_undo->buffer,
+                                drawable_mod_undo->offset_x,
+                                drawable_mod_undo->offset_y);
+
   gimp_drawable_set_buffer_full (drawable, FALSE, NULL,
                                  buffer,
                                  GEGL_RECTANGLE (offset_x, offset_y, 0, 0),
@@ -49,6 +49,7 @@ static void   gimp_drawable_stack_reorder          (GimpContainer     *container
                                                     GimpObject        *object,
                                                     gint               old_index,
                                                     gint               new_index);
+static void   gimp_drawable_stack_thaw             (GimpContainer     *container);
 
 static void   gimp_drawable_stack_drawable_update  (GimpItem          *item,
                                                     gint               x,
@@ -91,6 +92,7 @@ gimp_drawable_stack_class_init (GimpDrawableStackClass *klass)
   container_class->add      = gimp_drawable_stack_add;
   container_class->remove   = gimp_drawable_stack_remove;
   container_class->reorder  = gimp_drawable_stack_reorder;
+  container_class->thaw     = gimp_drawable_stack_thaw;
 }
 
 static void
@@ -155,6 +157,26 @@ gimp_drawable_stack_reorder (GimpContainer *container,
     gimp_drawable_stack_drawable_active (GIMP_ITEM (object), stack);
 }
 
+static void
+gimp_drawable_stack_thaw (GimpContainer *container)
+{
+  GimpDrawableStack *stack = GIMP_DRAWABLE_STACK (container);
+
+  if (GIMP_CONTAINER_CLASS (parent_class)->thaw)
+    GIMP_CONTAINER_CLASS (parent_class)->thaw (container);
+
+  if (! gegl_rectangle_is_empty (&stack->frozen_update))
+    {
+      GeglRectangle rect = stack->frozen_update;
+
+      stack->frozen_update = *GEGL_RECTANGLE (0, 0, 0, 0);
+
+      gimp_drawable_stack_update (stack,
+                                  rect.x,     rect.y,
+                                  rect.width, rect.height);
+    }
+}
+
 
 /*  public functions  */
 
@@ -182,6 +204,24 @@ gimp_drawable_stack_update (GimpDrawableStack *stack,
 {
   g_return_if_fail (GIMP_IS_DRAWABLE_STACK (stack));
 
+  /*  while the stack is frozen, collect the updates and emit a single
+   *  one when it's thawed, instead of one per added or removed item
+   */
+  if (gimp_container_frozen (GIMP_CONTAINER (stack)))
+    {
+      if (width > 0 && height > 0)
+        {
+          if (gegl_rectangle_is_empty (&stack->frozen_update))
+            gegl_rectangle_set (&stack->frozen_update, x, y, width, height);
+          else
+            gegl_rectangle_bounding_box (&stack->frozen_update,
+                                         &stack->frozen_update,
+                                         GEGL_RECTANGLE (x, y, width, height));
+        }
+
+      return;
+    }
+
   g_signal_emit (stack, stack_signals[UPDATE], 0,
                  x, y, width, height);
 }
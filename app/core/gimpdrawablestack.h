@@ -35,6 +35,9 @@ typedef struct _GimpDrawableStackClass GimpDrawableStackClass;
 struct _GimpDrawableStack
 {
   GimpItemStack  parent_instance;
+
+  /*  the area updated while the stack is frozen  */
+  GeglRectangle  frozen_update;
 };
 
 struct _GimpDrawableStackClass
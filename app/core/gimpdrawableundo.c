@@ -24,8 +24,15 @@
 
 #include "core-types.h"
 
+#include "gegl/gimp-gegl-utils.h"
+
 #include "gimp-memsize.h"
+#include "gimp-parallel.h"
+#include "gimp-tile-profile.h"
+#include "gimpasync.h"
+#include "gimpcancelable.h"
 #include "gimpimage.h"
+#include "gimpimage-undo.h"
 #include "gimpdrawable.h"
 #include "gimpdrawable-filters.h"
 #include "gimpdrawableundo.h"
@@ -58,6 +65,16 @@ static void     gimp_drawable_undo_pop          (GimpUndo            *undo,
                                                  GimpUndoAccumulator *accum);
 static void     gimp_drawable_undo_free         (GimpUndo            *undo,
                                                  GimpUndoMode         undo_mode);
+static gint64   gimp_drawable_undo_swap_out     (GimpUndo            *undo);
+
+static void     gimp_drawable_undo_swap_out_async
+                                                (GimpAsync           *async,
+                                                 GeglBuffer          *buffer);
+static void     gimp_drawable_undo_swapped_out  (GimpAsync           *async,
+                                                 GimpDrawableUndo    *drawable_undo);
+static void     gimp_drawable_undo_swap_cancel  (GimpDrawableUndo    *drawable_undo);
+
+static void     gimp_drawable_undo_profile      (GimpDrawableUndo    *drawable_undo);
 
 
 G_DEFINE_TYPE (GimpDrawableUndo, gimp_drawable_undo, GIMP_TYPE_ITEM_UNDO)
@@ -80,6 +97,7 @@ gimp_drawable_undo_class_init (GimpDrawableUndoClass *klass)
 
   undo_class->pop                = gimp_drawable_undo_pop;
   undo_class->free               = gimp_drawable_undo_free;
+  undo_class->swap_out           = gimp_drawable_undo_swap_out;
 
   g_object_class_install_property (object_class, PROP_BUFFER,
                                    g_param_spec_object ("buffer", NULL, NULL,
@@ -114,6 +132,8 @@ gimp_drawable_undo_constructed (GObject *object)
 
   gimp_assert (GIMP_IS_DRAWABLE (GIMP_ITEM_UNDO (object)->item));
   gimp_assert (GEGL_IS_BUFFER (drawable_undo->buffer));
+
+  gimp_drawable_undo_profile (drawable_undo);
 }
 
 static void
@@ -175,7 +195,11 @@ gimp_drawable_undo_get_memsize (GimpObject *object,
   GimpDrawableUndo *drawable_undo = GIMP_DRAWABLE_UNDO (object);
   gint64            memsize       = 0;
 
-  memsize += gimp_gegl_buffer_get_memsize (drawable_undo->buffer);
+  /*  the pixels of a swapped-out undo are on disk  */
+  if (GIMP_UNDO (object)->swap_size)
+    memsize += gimp_g_object_get_memsize (G_OBJECT (drawable_undo->buffer));
+  else
+    memsize += gimp_gegl_buffer_get_memsize (drawable_undo->buffer);
 
   return memsize + GIMP_OBJECT_CLASS (parent_class)->get_memsize (object,
                                                                   gui_size);
@@ -191,6 +215,17 @@ gimp_drawable_undo_pop (GimpUndo            *undo,
 
   GIMP_UNDO_CLASS (parent_class)->pop (undo, undo_mode, accum);
 
+  /*  popping writes to the buffer, which makes a pending swap file
+   *  stale; the pixels stay in memory, and can be swapped out again
+   */
+  if (drawable_undo->swap_async)
+    {
+      gimp_drawable_undo_swap_cancel (drawable_undo);
+
+      undo->swapped   = FALSE;
+      undo->swap_size = 0;
+    }
+
   gimp_drawable_swap_pixels (drawable,
                              drawable_undo->buffer,
                              drawable_undo->x,
@@ -206,7 +241,115 @@ gimp_drawable_undo_free (GimpUndo     *undo,
 {
   GimpDrawableUndo *drawable_undo = GIMP_DRAWABLE_UNDO (undo);
 
+  gimp_drawable_undo_swap_cancel (drawable_undo);
+
   g_clear_object (&drawable_undo->buffer);
 
   GIMP_UNDO_CLASS (parent_class)->free (undo, undo_mode);
 }
+
+/*  writes the pixels to the swap in a separate thread, so that freeing
+ *  undo memory doesn't block the main thread.  the undo keeps its buffer
+ *  until the swap file is complete, and only then replaces it with the
+ *  buffer backed by the file; the memory is counted as freed right away,
+ *  so that the undo stack doesn't swap out more steps meanwhile.
+ */
+static gint64
+gimp_drawable_undo_swap_out (GimpUndo *undo)
+{
+  GimpDrawableUndo *drawable_undo = GIMP_DRAWABLE_UNDO (undo);
+
+  /*  write a copy of the buffer, which shares its tiles, and doesn't
+   *  change if the undo is popped meanwhile
+   */
+  drawable_undo->swap_async =
+    gimp_parallel_run_async_independent_full (
+      +1,
+      (GimpRunAsyncFunc) gimp_drawable_undo_swap_out_async,
+      gimp_gegl_buffer_dup (drawable_undo->buffer));
+
+  gimp_async_add_callback_for_object (
+    drawable_undo->swap_async,
+    (GimpAsyncCallback) gimp_drawable_undo_swapped_out,
+    drawable_undo,
+    drawable_undo);
+
+  return gimp_gegl_buffer_get_memsize (drawable_undo->buffer);
+}
+
+static void
+gimp_drawable_undo_swap_out_async (GimpAsync  *async,
+                                   GeglBuffer *buffer)
+{
+  GeglBuffer *swap_buffer = NULL;
+
+  if (! gimp_async_is_canceled (async))
+    swap_buffer = gimp_gegl_buffer_swap_out (buffer);
+
+  g_object_unref (buffer);
+
+  if (swap_buffer)
+    gimp_async_finish_full (async, swap_buffer, g_object_unref);
+  else
+    gimp_async_abort (async);
+}
+
+static void
+gimp_drawable_undo_swapped_out (GimpAsync        *async,
+                                GimpDrawableUndo *drawable_undo)
+{
+  /*  the undo was popped or freed since  */
+  if (async != drawable_undo->swap_async)
+    return;
+
+  if (gimp_async_is_finished (async))
+    {
+      g_object_unref (drawable_undo->buffer);
+      drawable_undo->buffer = g_object_ref (gimp_async_get_result (async));
+
+      gimp_drawable_undo_profile (drawable_undo);
+    }
+  else
+    {
+      /*  the file couldn't be written, keep the pixels in memory, and
+       *  count them again
+       */
+      GIMP_UNDO (drawable_undo)->swap_size = 0;
+
+      gimp_image_undo_memsize_changed (GIMP_UNDO (drawable_undo)->image,
+                                       GIMP_UNDO (drawable_undo));
+    }
+
+  g_clear_object (&drawable_undo->swap_async);
+}
+
+static void
+gimp_drawable_undo_swap_cancel (GimpDrawableUndo *drawable_undo)
+{
+  if (drawable_undo->swap_async)
+    {
+      gimp_cancelable_cancel (GIMP_CANCELABLE (drawable_undo->swap_async));
+
+      g_clear_object (&drawable_undo->swap_async);
+    }
+}
+
+static void
+gimp_drawable_undo_profile (GimpDrawableUndo *drawable_undo)
+{
+  GimpItem *item;
+  gint      offset_x;
+  gint      offset_y;
+
+  if (! gimp_tile_profile_is_enabled ())
+    return;
+
+  item = GIMP_ITEM_UNDO (drawable_undo)->item;
+
+  gimp_item_get_offset (item, &offset_x, &offset_y);
+
+  gimp_tile_profile_add_undo (gimp_item_get_image (item),
+                              drawable_undo->buffer,
+                              offset_x + drawable_undo->x,
+                              offset_y + drawable_undo->y);
+}
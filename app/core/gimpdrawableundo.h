@@ -38,6 +38,8 @@ struct _GimpDrawableUndo
   GeglBuffer   *buffer;
   gint          x;
   gint          y;
+
+  GimpAsync    *swap_async;
 };
 
 struct _GimpDrawableUndoClass
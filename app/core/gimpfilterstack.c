@@ -47,6 +47,9 @@ static void   gimp_filter_stack_add_node         (GimpFilterStack *stack,
                                                   GimpFilter      *filter);
 static void   gimp_filter_stack_remove_node      (GimpFilterStack *stack,
                                                   GimpFilter      *filter);
+static GeglNode *
+              gimp_filter_stack_get_node_above   (GimpFilterStack *stack,
+                                                  GimpFilter      *filter);
 static void   gimp_filter_stack_update_last_node (GimpFilterStack *stack);
 
 static void   gimp_filter_stack_filter_active    (GimpFilter      *filter,
@@ -120,6 +123,10 @@ gimp_filter_stack_add (GimpContainer *container,
         }
 
       gimp_filter_stack_update_last_node (stack);
+
+      /*  the filter might have been set up as the last node elsewhere  */
+      if (filter != stack->last_filter)
+        gimp_filter_set_is_last_node (filter, FALSE);
     }
 }
 
@@ -140,6 +147,9 @@ gimp_filter_stack_remove (GimpContainer *container,
 
   if (gimp_filter_get_active (filter))
     {
+      if (filter == stack->last_filter)
+        stack->last_filter = NULL;
+
       gimp_filter_set_is_last_node (filter, FALSE);
       gimp_filter_stack_update_last_node (stack);
     }
@@ -234,29 +244,12 @@ gimp_filter_stack_add_node (GimpFilterStack *stack,
                             GimpFilter      *filter)
 {
   GeglNode *node;
-  GeglNode *node_above = NULL;
-  GeglNode *node_below = NULL;
-  GList    *iter;
+  GeglNode *node_above;
+  GeglNode *node_below;
 
   node = gimp_filter_get_node (filter);
 
-
-  iter = g_list_find (GIMP_LIST (stack)->queue->head, filter);
-
-  while ((iter = g_list_previous (iter)))
-    {
-      GimpFilter *filter_above = iter->data;
-
-      if (gimp_filter_get_active (filter_above))
-        {
-          node_above = gimp_filter_get_node (filter_above);
-
-          break;
-        }
-    }
-
-  if (! node_above)
-    node_above = gegl_node_get_output_proxy (stack->graph, "output");
+  node_above = gimp_filter_stack_get_node_above (stack, filter);
 
   node_below = gegl_node_get_producer (node_above, "input", NULL);
 
@@ -269,41 +262,55 @@ gimp_filter_stack_remove_node (GimpFilterStack *stack,
                                GimpFilter      *filter)
 {
   GeglNode *node;
-  GeglNode *node_above = NULL;
-  GeglNode *node_below = NULL;
-  GList    *iter;
+  GeglNode *node_above;
+  GeglNode *node_below;
 
   node = gimp_filter_get_node (filter);
 
-  iter = g_list_find (GIMP_LIST (stack)->queue->head, filter);
+  node_above = gimp_filter_stack_get_node_above (stack, filter);
 
-  while ((iter = g_list_previous (iter)))
-    {
-      GimpFilter *filter_above = iter->data;
+  node_below = gegl_node_get_producer (node, "input", NULL);
 
-      if (gimp_filter_get_active (filter_above))
-        {
-          node_above = gimp_filter_get_node (filter_above);
+  gegl_node_disconnect (node, "input");
 
-          break;
-        }
-    }
+  gegl_node_link (node_below, node_above);
+}
 
-  if (! node_above)
-    node_above = gegl_node_get_output_proxy (stack->graph, "output");
+/*  returns the node of the closest active filter above 'filter', or the
+ *  graph's output proxy.  this looks the filter up by index rather than
+ *  searching the list, which keeps adding many filters linear.
+ */
+static GeglNode *
+gimp_filter_stack_get_node_above (GimpFilterStack *stack,
+                                  GimpFilter      *filter)
+{
+  GimpContainer *container = GIMP_CONTAINER (stack);
+  gint           index;
 
-  node_below = gegl_node_get_producer (node, "input", NULL);
+  index = gimp_container_get_child_index (container, GIMP_OBJECT (filter));
 
-  gegl_node_disconnect (node, "input");
+  while (--index >= 0)
+    {
+      GimpFilter *filter_above;
 
-  gegl_node_link (node_below, node_above);
+      filter_above = GIMP_FILTER (gimp_container_get_child_by_index (container,
+                                                                     index));
+
+      if (gimp_filter_get_active (filter_above))
+        return gimp_filter_get_node (filter_above);
+    }
+
+  return gegl_node_get_output_proxy (stack->graph, "output");
 }
 
+/*  only the previous and the new last node change, so there's no need
+ *  to visit the filters above the bottom-most active one
+ */
 static void
 gimp_filter_stack_update_last_node (GimpFilterStack *stack)
 {
-  GList    *list;
-  gboolean  found_last = FALSE;
+  GimpFilter *last = NULL;
+  GList      *list;
 
   for (list = GIMP_LIST (stack)->queue->tail;
        list;
@@ -311,16 +318,23 @@ gimp_filter_stack_update_last_node (GimpFilterStack *stack)
     {
       GimpFilter *filter = list->data;
 
-      if (! found_last && gimp_filter_get_active (filter))
-        {
-          gimp_filter_set_is_last_node (filter, TRUE);
-          found_last = TRUE;
-        }
-      else
+      if (gimp_filter_get_active (filter))
         {
-          gimp_filter_set_is_last_node (filter, FALSE);
+          last = filter;
+          break;
         }
     }
+
+  if (last != stack->last_filter)
+    {
+      if (stack->last_filter)
+        gimp_filter_set_is_last_node (stack->last_filter, FALSE);
+
+      stack->last_filter = last;
+    }
+
+  if (last)
+    gimp_filter_set_is_last_node (last, TRUE);
 }
 
 static void
@@ -34,9 +34,10 @@ typedef struct _GimpFilterStackClass GimpFilterStackClass;
 
 struct _GimpFilterStack
 {
-  GimpList  parent_instance;
+  GimpList    parent_instance;
 
-  GeglNode *graph;
+  GeglNode   *graph;
+  GimpFilter *last_filter;
 };
 
 struct _GimpFilterStackClass
@@ -69,6 +69,11 @@ struct _GimpGroupLayerPrivate
   gboolean        expanded;
   gboolean        pass_through;
 
+  /*  changes of the children while they are frozen, handled on thaw  */
+  gboolean        size_dirty;
+  gboolean        mode_dirty;
+  gboolean        excludes_backdrop_dirty;
+
   /*  hackish temp states to make the projection/tiles stuff work  */
   const Babl     *convert_format;
   gboolean        reallocate_projection;
@@ -212,6 +217,8 @@ static void            gimp_group_layer_child_move   (GimpLayer       *child,
                                                       GimpGroupLayer  *group);
 static void            gimp_group_layer_child_resize (GimpLayer       *child,
                                                       GimpGroupLayer  *group);
+static void           gimp_group_layer_children_thaw (GimpContainer   *container,
+                                                      GimpGroupLayer  *group);
 static void    gimp_group_layer_child_active_changed (GimpLayer       *child,
                                                       GimpGroupLayer  *group);
 static void
@@ -224,6 +231,8 @@ static void
 static void            gimp_group_layer_flush        (GimpGroupLayer  *group);
 static void            gimp_group_layer_update       (GimpGroupLayer  *group);
 static void            gimp_group_layer_update_size  (GimpGroupLayer  *group);
+static void           gimp_group_layer_update_modes  (GimpGroupLayer  *group,
+                                                      gboolean         excludes_backdrop);
 static void        gimp_group_layer_update_mask_size (GimpGroupLayer  *group);
 static void      gimp_group_layer_update_source_node (GimpGroupLayer  *group);
 static void        gimp_group_layer_update_mode_node (GimpGroupLayer  *group);
@@ -356,6 +365,9 @@ gimp_group_layer_init (GimpGroupLayer *group)
   g_signal_connect (private->children, "remove",
                     G_CALLBACK (gimp_group_layer_child_remove),
                     group);
+  g_signal_connect (private->children, "thaw",
+                    G_CALLBACK (gimp_group_layer_children_thaw),
+                    group);
 
   gimp_container_add_handler (private->children, "notify::offset-x",
                               G_CALLBACK (gimp_group_layer_child_move),
@@ -404,6 +416,9 @@ gimp_group_layer_finalize (GObject *object)
       g_signal_handlers_disconnect_by_func (private->children,
                                             gimp_group_layer_child_remove,
                                             object);
+      g_signal_handlers_disconnect_by_func (private->children,
+                                            gimp_group_layer_children_thaw,
+                                            object);
       g_signal_handlers_disconnect_by_func (private->children,
                                             gimp_group_layer_stack_update,
                                             object);
@@ -1850,12 +1865,8 @@ gimp_group_layer_child_add (GimpContainer  *container,
   gimp_group_layer_update (group);
 
   if (gimp_filter_get_active (GIMP_FILTER (child)))
-    {
-      gimp_layer_update_effective_mode (GIMP_LAYER (group));
-
-      if (gimp_layer_get_excludes_backdrop (child))
-        gimp_layer_update_excludes_backdrop (GIMP_LAYER (group));
-    }
+    gimp_group_layer_update_modes (group,
+                                   gimp_layer_get_excludes_backdrop (child));
 }
 
 static void
@@ -1866,11 +1877,27 @@ gimp_group_layer_child_remove (GimpContainer  *container,
   gimp_group_layer_update (group);
 
   if (gimp_filter_get_active (GIMP_FILTER (child)))
+    gimp_group_layer_update_modes (group,
+                                   gimp_layer_get_excludes_backdrop (child));
+}
+
+static void
+gimp_group_layer_children_thaw (GimpContainer  *container,
+                                GimpGroupLayer *group)
+{
+  GimpGroupLayerPrivate *private = GET_PRIVATE (group);
+
+  if (private->size_dirty && private->suspend_resize == 0)
+    gimp_group_layer_update_size (group);
+
+  if (private->mode_dirty || private->excludes_backdrop_dirty)
     {
-      gimp_layer_update_effective_mode (GIMP_LAYER (group));
+      gboolean excludes_backdrop = private->excludes_backdrop_dirty;
+
+      private->mode_dirty              = FALSE;
+      private->excludes_backdrop_dirty = FALSE;
 
-      if (gimp_layer_get_excludes_backdrop (child))
-        gimp_layer_update_excludes_backdrop (GIMP_LAYER (group));
+      gimp_group_layer_update_modes (group, excludes_backdrop);
     }
 }
 
@@ -1893,10 +1920,8 @@ static void
 gimp_group_layer_child_active_changed (GimpLayer      *child,
                                        GimpGroupLayer *group)
 {
-  gimp_layer_update_effective_mode (GIMP_LAYER (group));
-
-  if (gimp_layer_get_excludes_backdrop (child))
-    gimp_layer_update_excludes_backdrop (GIMP_LAYER (group));
+  gimp_group_layer_update_modes (group,
+                                 gimp_layer_get_excludes_backdrop (child));
 }
 
 static void
@@ -1951,10 +1976,45 @@ gimp_group_layer_flush (GimpGroupLayer *group)
 static void
 gimp_group_layer_update (GimpGroupLayer *group)
 {
-  if (GET_PRIVATE (group)->suspend_resize == 0)
+  GimpGroupLayerPrivate *private = GET_PRIVATE (group);
+
+  if (private->suspend_resize == 0)
     {
-      gimp_group_layer_update_size (group);
+      /*  while the children are frozen, e.g. while the item tree is
+       *  changed in a batch, only remember that the size is out of
+       *  date, and compute it once when they are thawed, however many
+       *  of them change.
+       */
+      if (gimp_container_frozen (private->children))
+        private->size_dirty = TRUE;
+      else
+        gimp_group_layer_update_size (group);
+    }
+}
+
+/*  the group's effective mode depends on all its children, so like its
+ *  size it's only updated once the children are thawed
+ */
+static void
+gimp_group_layer_update_modes (GimpGroupLayer *group,
+                               gboolean        excludes_backdrop)
+{
+  GimpGroupLayerPrivate *private = GET_PRIVATE (group);
+
+  if (gimp_container_frozen (private->children))
+    {
+      private->mode_dirty = TRUE;
+
+      if (excludes_backdrop)
+        private->excludes_backdrop_dirty = TRUE;
+
+      return;
     }
+
+  gimp_layer_update_effective_mode (GIMP_LAYER (group));
+
+  if (excludes_backdrop)
+    gimp_layer_update_excludes_backdrop (GIMP_LAYER (group));
 }
 
 static void
@@ -1973,6 +2033,8 @@ gimp_group_layer_update_size (GimpGroupLayer *group)
   gboolean               resize_mask;
   GList                 *list;
 
+  private->size_dirty = FALSE;
+
   old_bounds.x      = gimp_item_get_offset_x (item);
   old_bounds.y      = gimp_item_get_offset_y (item);
   old_bounds.width  = gimp_item_get_width    (item);
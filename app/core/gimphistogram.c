@@ -33,6 +33,7 @@
 
 #include "gegl/gimp-babl.h"
 #include "gegl/gimp-gegl-loops.h"
+#include "gegl/gimp-gegl-utils.h"
 
 #include "gimp-atomic.h"
 #include "gimp-parallel.h"
@@ -48,6 +49,8 @@
 #define PIXELS_PER_THREAD \
   (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
 
+#define CACHE_TILE_SIZE    512
+
 
 enum
 {
@@ -57,6 +60,47 @@ enum
   PROP_VALUES
 };
 
+/*  the per-tile histograms of a buffer area.  each tile's histogram is
+ *  dropped when the tile is invalidated, and recalculated the next time
+ *  the histogram is calculated through the cache.  the cache is only
+ *  modified on the main thread, a calculation works on a snapshot of
+ *  the tiles, and stores the tiles it calculated back when it's done,
+ *  unless they were invalidated in the meantime.
+ *
+ *  a histogram calculated through a mask can't be split in tiles,
+ *  since the mask changes independently of the buffer, so the cache
+ *  remembers the last one as a whole, along with the number of changes
+ *  of the buffer's and the mask's caches at the time.
+ */
+struct _GimpHistogramCache
+{
+  GimpTRCType    trc;
+  const Babl    *format;
+  GeglRectangle  rect;
+  gint           n_cols;
+  gint           n_rows;
+  GBytes       **tiles;
+  guint         *stamps;
+  guint          generation;
+  gint           n_components;
+  gint           n_bins;
+
+  /*  bumped by every invalidation  */
+  guint          changes;
+
+  /*  the last histogram calculated through a mask  */
+  GimpHistogramCache *mask_cache;
+  guint               mask_changes;
+  guint               masked_changes;
+  GimpTRCType         masked_trc;
+  const Babl         *masked_format;
+  GeglRectangle       masked_rect;
+  GeglRectangle       mask_rect;
+  gint                masked_n_channels;
+  gint                masked_n_bins;
+  gdouble            *masked_values;
+};
+
 struct _GimpHistogramPrivate
 {
   GimpTRCType  trc;
@@ -75,6 +119,15 @@ typedef struct
   GeglBuffer    *mask;
   GeglRectangle  mask_rect;
 
+  /*  tile cache  */
+  GimpHistogramCache *cache;
+  guint               generation;
+  GeglRectangle       cache_rect;
+  gint                n_cols;
+  gint                n_rows;
+  GBytes            **tiles;
+  guint              *stamps;
+
   /*  output  */
   gint           n_components;
   gint           n_bins;
@@ -90,6 +143,27 @@ typedef struct
   GSList           *values_list;
 } CalculateData;
 
+typedef struct
+{
+  GimpHistogram      *histogram;
+  GimpHistogramCache *cache;
+  GimpHistogramCache *mask_cache;
+  guint               changes;
+  guint               mask_changes;
+  const Babl         *format;
+  GeglRectangle       buffer_rect;
+  GeglRectangle       mask_rect;
+} MaskedData;
+
+typedef struct
+{
+  gint    bpp;
+  gsize   n_slots;
+  gsize   n_colors;
+  guint8 *used;
+  guint8 *colors;
+} ColorSet;
+
 
 /*  local function prototypes  */
 
@@ -114,15 +188,55 @@ static void       gimp_histogram_set_values               (GimpHistogram
                                                            gint                  n_bins,
                                                            gdouble              *values);
 
+static gboolean   gimp_histogram_calculate_values         (GimpAsync            *async,
+                                                           CalculateContext     *context);
 static void       gimp_histogram_calculate_internal       (GimpAsync            *async,
                                                            CalculateContext     *context);
+static void       gimp_histogram_calculate_cached_internal
+                                                          (GimpAsync            *async,
+                                                           CalculateContext     *context);
 static void       gimp_histogram_calculate_area           (const GeglRectangle  *area,
                                                            CalculateData        *data);
 static void       gimp_histogram_calculate_async_callback (GimpAsync            *async,
                                                            CalculateContext     *context);
-static guint      hash_color_bytes                        (gpointer             *key);
-static gboolean   color_bytes_equal                       (gpointer             *key1,
-                                                           gpointer             *key2);
+static void       gimp_histogram_calculate_cached_async_callback
+                                                          (GimpAsync            *async,
+                                                           CalculateContext     *context);
+
+static void       gimp_histogram_cache_free               (GimpHistogramCache   *cache);
+static void       gimp_histogram_cache_clear              (GimpHistogramCache   *cache);
+static void       gimp_histogram_cache_clear_masked       (GimpHistogramCache   *cache);
+static gboolean   gimp_histogram_cache_lookup_masked      (GimpHistogramCache   *cache,
+                                                           GimpHistogram        *histogram,
+                                                           GeglBuffer           *buffer,
+                                                           const GeglRectangle  *buffer_rect,
+                                                           GimpHistogramCache   *mask_cache,
+                                                           const GeglRectangle  *mask_rect);
+static MaskedData * gimp_histogram_cache_masked_data_new
+                                                          (GimpHistogramCache   *cache,
+                                                           GimpHistogram        *histogram,
+                                                           GeglBuffer           *buffer,
+                                                           const GeglRectangle  *buffer_rect,
+                                                           GimpHistogramCache   *mask_cache,
+                                                           const GeglRectangle  *mask_rect);
+static void       gimp_histogram_cache_masked_data_free   (MaskedData           *data);
+static void       gimp_histogram_cache_store_masked       (MaskedData           *data);
+static void       gimp_histogram_cache_masked_async_callback
+                                                          (GimpAsync            *async,
+                                                           MaskedData           *data);
+static void       gimp_histogram_cache_get_tile_rect      (const GeglRectangle  *rect,
+                                                           gint                  col,
+                                                           gint                  row,
+                                                           GeglRectangle        *tile_rect);
+static void       gimp_histogram_cache_begin              (GimpHistogramCache   *cache,
+                                                           CalculateContext     *context);
+static void       gimp_histogram_cache_end                (CalculateContext     *context);
+
+static void       color_set_init                          (ColorSet             *set,
+                                                           gint                  bpp);
+static void       color_set_clear                         (ColorSet             *set);
+static gboolean   color_set_insert                        (ColorSet             *set,
+                                                           const guint8         *color);
 
 
 G_DEFINE_TYPE_WITH_PRIVATE (GimpHistogram, gimp_histogram, GIMP_TYPE_OBJECT)
@@ -233,49 +347,83 @@ gimp_histogram_get_memsize (GimpObject *object,
                                                                   gui_size);
 }
 
-static guint
-hash_color_bytes (gpointer *key)
+/*  an open-addressing set of the pixels' bytes, stored inline, used for
+ *  counting unique colors without allocating anything per pixel
+ */
+static void
+color_set_init (ColorSet *set,
+                gint      bpp)
 {
-  GBytes       *bytes     = (GBytes *) key;
-  gsize         size;
-  const guint8 *data;
-  gdouble       max_value = 0.0;
-  gdouble       value     = 0.0;
-  guint         hash;
-
-  data = g_bytes_get_data (bytes, &size);
+  set->bpp      = bpp;
+  set->n_slots  = 1 << 12;
+  set->n_colors = 0;
+  set->used     = g_new0 (guint8, set->n_slots);
+  set->colors   = g_new  (guint8, set->n_slots * bpp);
+}
 
-  for (gsize i = 0; i < size; ++i)
-    {
-      value     = value * 256.0 + data[i];
-      max_value = max_value * 256.0 + 255.0;
-    }
+static void
+color_set_clear (ColorSet *set)
+{
+  g_clear_pointer (&set->used,   g_free);
+  g_clear_pointer (&set->colors, g_free);
+}
 
-  if (max_value == 0)
-    return 0;
+static inline guint
+color_set_hash (const guint8 *color,
+                gint          bpp)
+{
+  /*  FNV-1a  */
+  guint hash = 2166136261u;
+  gint  i;
 
-  hash = (guint) (value * G_MAXUINT / max_value);
+  for (i = 0; i < bpp; i++)
+    hash = (hash ^ color[i]) * 16777619u;
 
   return hash;
 }
 
 static gboolean
-color_bytes_equal (gpointer *key1,
-                   gpointer *key2)
+color_set_insert (ColorSet     *set,
+                  const guint8 *color)
 {
-  GBytes       *bytes1 = (GBytes *) key1;
-  GBytes       *bytes2 = (GBytes *) key2;
-  gsize         size1;
-  gsize         size2;
-  const guint8 *data1  = g_bytes_get_data (bytes1, &size1);
-  const guint8 *data2  = g_bytes_get_data (bytes2, &size2);
+  gsize mask = set->n_slots - 1;
+  gsize i;
+
+  for (i = color_set_hash (color, set->bpp) & mask;
+       set->used[i];
+       i = (i + 1) & mask)
+    {
+      if (! memcmp (set->colors + i * set->bpp, color, set->bpp))
+        return FALSE;
+    }
+
+  set->used[i] = TRUE;
+  memcpy (set->colors + i * set->bpp, color, set->bpp);
+
+  /*  keep the set at most half full  */
+  if (++set->n_colors * 2 > set->n_slots)
+    {
+      ColorSet old = *set;
+      gsize    j;
+
+      set->n_slots *= 2;
+      set->n_colors = 0;
+      set->used     = g_new0 (guint8, set->n_slots);
+      set->colors   = g_new  (guint8, set->n_slots * set->bpp);
+
+      for (j = 0; j < old.n_slots; j++)
+        {
+          if (old.used[j])
+            color_set_insert (set, old.colors + j * old.bpp);
+        }
 
-  if (size1 != size2)
-    return FALSE;
+      color_set_clear (&old);
+    }
 
-  return memcmp (data1, data2, size1) == 0;
+  return TRUE;
 }
 
+
 /*  public functions  */
 
 GimpHistogram *
@@ -402,9 +550,10 @@ gimp_histogram_calculate_async (GimpHistogram       *histogram,
                              context->mask, NULL);
     }
 
-  histogram->priv->calculate_async = gimp_parallel_run_async (
+  histogram->priv->calculate_async = gimp_parallel_run_async_labeled_full (
+    "histogram", 0,
     (GimpRunAsyncFunc) gimp_histogram_calculate_internal,
-    context);
+    context, NULL);
 
   gimp_async_add_callback (
     histogram->priv->calculate_async,
@@ -414,6 +563,239 @@ gimp_histogram_calculate_async (GimpHistogram       *histogram,
   return histogram->priv->calculate_async;
 }
 
+void
+gimp_histogram_calculate_cached (GimpHistogram       *histogram,
+                                 GimpHistogramCache  *cache,
+                                 GeglBuffer          *buffer,
+                                 const GeglRectangle *buffer_rect)
+{
+  CalculateContext context = {};
+
+  g_return_if_fail (GIMP_IS_HISTOGRAM (histogram));
+  g_return_if_fail (cache != NULL);
+  g_return_if_fail (GEGL_IS_BUFFER (buffer));
+  g_return_if_fail (buffer_rect != NULL);
+
+  if (histogram->priv->calculate_async)
+    gimp_async_cancel_and_wait (histogram->priv->calculate_async);
+
+  context.histogram   = histogram;
+  context.buffer      = buffer;
+  context.buffer_rect = *buffer_rect;
+
+  gimp_histogram_cache_begin (cache, &context);
+
+  gimp_histogram_calculate_cached_internal (NULL, &context);
+
+  gimp_histogram_cache_end (&context);
+
+  gimp_histogram_set_values (histogram,
+                             context.n_components, context.n_bins,
+                             context.values);
+}
+
+GimpAsync *
+gimp_histogram_calculate_cached_async (GimpHistogram       *histogram,
+                                       GimpHistogramCache  *cache,
+                                       GeglBuffer          *buffer,
+                                       const GeglRectangle *buffer_rect)
+{
+  CalculateContext *context;
+  GeglRectangle     rect;
+  gint              i;
+
+  g_return_val_if_fail (GIMP_IS_HISTOGRAM (histogram), NULL);
+  g_return_val_if_fail (cache != NULL, NULL);
+  g_return_val_if_fail (GEGL_IS_BUFFER (buffer), NULL);
+  g_return_val_if_fail (buffer_rect != NULL, NULL);
+
+  if (histogram->priv->calculate_async)
+    gimp_async_cancel_and_wait (histogram->priv->calculate_async);
+
+  gegl_rectangle_align_to_buffer (&rect, buffer_rect, buffer,
+                                  GEGL_RECTANGLE_ALIGNMENT_SUPERSET);
+
+  context = g_slice_new0 (CalculateContext);
+
+  context->histogram   = histogram;
+  context->buffer      = gegl_buffer_new (&rect,
+                                          gegl_buffer_get_format (buffer));
+  context->buffer_rect = *buffer_rect;
+
+  gimp_histogram_cache_begin (cache, context);
+
+  /*  the copy is copy-on-write, so it's cheap, but we still don't need
+   *  to copy anything if all the tiles are cached already.
+   */
+  for (i = 0; i < context->n_cols * context->n_rows; i++)
+    {
+      if (! context->tiles[i])
+        {
+          gimp_gegl_buffer_copy (buffer, &rect, GEGL_ABYSS_NONE,
+                                 context->buffer, NULL);
+
+          break;
+        }
+    }
+
+  histogram->priv->calculate_async = gimp_parallel_run_async_labeled_full (
+    "histogram", 0,
+    (GimpRunAsyncFunc) gimp_histogram_calculate_cached_internal,
+    context, NULL);
+
+  gimp_async_add_callback (
+    histogram->priv->calculate_async,
+    (GimpAsyncCallback) gimp_histogram_calculate_cached_async_callback,
+    context);
+
+  return histogram->priv->calculate_async;
+}
+
+/*  calculates the histogram of 'buffer' through 'mask', reusing the
+ *  last histogram calculated through 'cache' if neither 'buffer' nor
+ *  'mask' changed since, according to 'cache' and 'mask_cache'.
+ */
+void
+gimp_histogram_calculate_masked_cached (GimpHistogram       *histogram,
+                                        GimpHistogramCache  *cache,
+                                        GeglBuffer          *buffer,
+                                        const GeglRectangle *buffer_rect,
+                                        GimpHistogramCache  *mask_cache,
+                                        GeglBuffer          *mask,
+                                        const GeglRectangle *mask_rect)
+{
+  MaskedData *data;
+
+  g_return_if_fail (GIMP_IS_HISTOGRAM (histogram));
+  g_return_if_fail (cache != NULL);
+  g_return_if_fail (GEGL_IS_BUFFER (buffer));
+  g_return_if_fail (buffer_rect != NULL);
+  g_return_if_fail (mask_cache != NULL && mask_cache != cache);
+  g_return_if_fail (GEGL_IS_BUFFER (mask));
+  g_return_if_fail (mask_rect != NULL);
+
+  if (gimp_histogram_cache_lookup_masked (cache, histogram,
+                                          buffer, buffer_rect,
+                                          mask_cache, mask_rect))
+    return;
+
+  data = gimp_histogram_cache_masked_data_new (cache, histogram,
+                                               buffer, buffer_rect,
+                                               mask_cache, mask_rect);
+
+  gimp_histogram_calculate (histogram, buffer, buffer_rect, mask, mask_rect);
+
+  gimp_histogram_cache_store_masked (data);
+  gimp_histogram_cache_masked_data_free (data);
+}
+
+GimpAsync *
+gimp_histogram_calculate_masked_cached_async (GimpHistogram       *histogram,
+                                              GimpHistogramCache  *cache,
+                                              GeglBuffer          *buffer,
+                                              const GeglRectangle *buffer_rect,
+                                              GimpHistogramCache  *mask_cache,
+                                              GeglBuffer          *mask,
+                                              const GeglRectangle *mask_rect)
+{
+  GimpAsync  *async;
+  MaskedData *data;
+
+  g_return_val_if_fail (GIMP_IS_HISTOGRAM (histogram), NULL);
+  g_return_val_if_fail (cache != NULL, NULL);
+  g_return_val_if_fail (GEGL_IS_BUFFER (buffer), NULL);
+  g_return_val_if_fail (buffer_rect != NULL, NULL);
+  g_return_val_if_fail (mask_cache != NULL && mask_cache != cache, NULL);
+  g_return_val_if_fail (GEGL_IS_BUFFER (mask), NULL);
+  g_return_val_if_fail (mask_rect != NULL, NULL);
+
+  if (gimp_histogram_cache_lookup_masked (cache, histogram,
+                                          buffer, buffer_rect,
+                                          mask_cache, mask_rect))
+    {
+      async = gimp_async_new ();
+
+      gimp_async_finish (async, NULL);
+
+      return async;
+    }
+
+  data = gimp_histogram_cache_masked_data_new (cache, histogram,
+                                               buffer, buffer_rect,
+                                               mask_cache, mask_rect);
+
+  async = gimp_histogram_calculate_async (histogram, buffer, buffer_rect,
+                                          mask, mask_rect);
+
+  /*  runs after the histogram got its values  */
+  gimp_async_add_callback (
+    async,
+    (GimpAsyncCallback) gimp_histogram_cache_masked_async_callback,
+    data);
+
+  return async;
+}
+
+GimpHistogramCache *
+gimp_histogram_cache_new (void)
+{
+  return g_rc_box_new0 (GimpHistogramCache);
+}
+
+void
+gimp_histogram_cache_unref (GimpHistogramCache *cache)
+{
+  g_return_if_fail (cache != NULL);
+
+  g_rc_box_release_full (cache,
+                         (GDestroyNotify) gimp_histogram_cache_free);
+}
+
+/*  drops the histograms of the tiles intersecting 'rect', or of all the
+ *  tiles if 'rect' is NULL.  'rect' is in the coordinates of the buffers
+ *  passed to gimp_histogram_calculate_cached().
+ */
+void
+gimp_histogram_cache_invalidate (GimpHistogramCache  *cache,
+                                 const GeglRectangle *rect)
+{
+  GeglRectangle area;
+  gint          col1, col2;
+  gint          row1, row2;
+  gint          col,  row;
+
+  g_return_if_fail (cache != NULL);
+
+  cache->changes++;
+
+  if (! rect)
+    {
+      gimp_histogram_cache_clear (cache);
+
+      return;
+    }
+
+  if (! gegl_rectangle_intersect (&area, rect, &cache->rect))
+    return;
+
+  col1 = (area.x - cache->rect.x) / CACHE_TILE_SIZE;
+  row1 = (area.y - cache->rect.y) / CACHE_TILE_SIZE;
+  col2 = (area.x + area.width  - 1 - cache->rect.x) / CACHE_TILE_SIZE;
+  row2 = (area.y + area.height - 1 - cache->rect.y) / CACHE_TILE_SIZE;
+
+  for (row = row1; row <= row2; row++)
+    {
+      for (col = col1; col <= col2; col++)
+        {
+          gint i = row * cache->n_cols + col;
+
+          g_clear_pointer (&cache->tiles[i], g_bytes_unref);
+
+          cache->stamps[i]++;
+        }
+    }
+}
+
 void
 gimp_histogram_clear_values (GimpHistogram *histogram,
                              gint           n_components)
@@ -925,9 +1307,9 @@ gimp_histogram_set_values (GimpHistogram *histogram,
   g_object_notify (G_OBJECT (histogram), "values");
 }
 
-static void
-gimp_histogram_calculate_internal (GimpAsync        *async,
-                                   CalculateContext *context)
+static gboolean
+gimp_histogram_calculate_values (GimpAsync        *async,
+                                 CalculateContext *context)
 {
   CalculateData         data;
   GimpHistogramPrivate *priv;
@@ -964,10 +1346,7 @@ gimp_histogram_calculate_internal (GimpAsync        *async,
       break;
 
     default:
-      if (async)
-        gimp_async_abort (async);
-
-      g_return_if_reached ();
+      g_return_val_if_reached (FALSE);
     }
 
   context->n_components = babl_format_get_n_components (format);
@@ -1012,18 +1391,96 @@ gimp_histogram_calculate_internal (GimpAsync        *async,
 
       context->values = total_values;
 
-      if (async)
-        gimp_async_finish (async, NULL);
+      return TRUE;
     }
   else
     {
       g_slist_free_full (data.values_list, g_free);
 
+      return FALSE;
+    }
+}
+
+static void
+gimp_histogram_calculate_internal (GimpAsync        *async,
+                                   CalculateContext *context)
+{
+  if (gimp_histogram_calculate_values (async, context))
+    {
+      if (async)
+        gimp_async_finish (async, NULL);
+    }
+  else
+    {
       if (async)
         gimp_async_abort (async);
     }
 }
 
+/*  calculates the histograms of the tiles missing from context->tiles,
+ *  and sums all of them up
+ */
+static void
+gimp_histogram_calculate_cached_internal (GimpAsync        *async,
+                                          CalculateContext *context)
+{
+  gint n_tiles = context->n_cols * context->n_rows;
+  gint n_values;
+  gint i;
+
+  for (i = 0; i < n_tiles; i++)
+    {
+      CalculateContext tile_context;
+
+      if (context->tiles[i])
+        continue;
+
+      tile_context        = *context;
+      tile_context.values = NULL;
+
+      gimp_histogram_cache_get_tile_rect (&context->cache_rect,
+                                          i % context->n_cols,
+                                          i / context->n_cols,
+                                          &tile_context.buffer_rect);
+
+      if (! gimp_histogram_calculate_values (async, &tile_context))
+        {
+          if (async)
+            gimp_async_abort (async);
+
+          return;
+        }
+
+      context->n_components = tile_context.n_components;
+      context->n_bins       = tile_context.n_bins;
+
+      n_values = (context->n_components + N_DERIVED_CHANNELS) *
+                 context->n_bins;
+
+      if (! tile_context.values)
+        tile_context.values = g_new0 (gdouble, n_values);
+
+      context->tiles[i] = g_bytes_new_take (tile_context.values,
+                                            n_values * sizeof (gdouble));
+    }
+
+  n_values = (context->n_components + N_DERIVED_CHANNELS) * context->n_bins;
+
+  context->values = g_new0 (gdouble, n_values);
+
+  for (i = 0; i < n_tiles; i++)
+    {
+      const gdouble *values = g_bytes_get_data (context->tiles[i], NULL);
+      gint           j;
+
+      for (j = 0; j < n_values; j++)
+        context->values[j] += values[j];
+    }
+
+  if (async)
+    gimp_async_finish (async, NULL);
+}
+
 static void
 gimp_histogram_calculate_area (const GeglRectangle *area,
                                CalculateData       *data)
@@ -1031,7 +1488,14 @@ gimp_histogram_calculate_area (const GeglRectangle *area,
   GimpAsync            *async;
   CalculateContext     *context;
   GeglBufferIterator   *iter;
+  const Babl           *src_format;
+  const Babl           *src_fish;
   const Babl           *fish;
+  gconstpointer         empty_data;
+  gfloat               *converted      = NULL;
+  gint                 *bins           = NULL;
+  gint                  converted_size = 0;
+  gint                  src_bpp;
   gdouble              *values;
   gint                  n_components;
   gint                  n_bins;
@@ -1044,13 +1508,21 @@ gimp_histogram_calculate_area (const GeglRectangle *area,
   n_bins       = context->n_bins;
   n_components = context->n_components;
 
+  src_format = gegl_buffer_get_format (context->buffer);
+  src_fish   = babl_fish (src_format, data->format);
+  src_bpp    = babl_format_get_bytes_per_pixel (src_format);
+  empty_data = gimp_gegl_buffer_get_empty_tile_data (context->buffer);
+
   fish = babl_fish (data->format, babl_format ("Y float"));
 
   values = g_new0 (gdouble, (n_components + N_DERIVED_CHANNELS) * n_bins);
   gimp_atomic_slist_push_head (&data->values_list, values);
 
+  /*  read the buffer in its own format, so that constant chunks, like
+   *  empty tiles, can be counted as a whole, and only convert the rest
+   */
   iter = gegl_buffer_iterator_new (context->buffer, area, 0,
-                                   data->format,
+                                   src_format,
                                    GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 2);
 
   if (context->mask)
@@ -1073,12 +1545,16 @@ gimp_histogram_calculate_area (const GeglRectangle *area,
                                                         0.0f,                  \
                                                         n_bins_1f))]))
 
+#define BIN(c,b) (values[(c) * n_bins + (b)])
+
 #define CHECK_CANCELED(length)                                                 \
   G_STMT_START                                                                 \
     {                                                                          \
       if ((length) % 128 == 0 && async && gimp_async_is_canceled (async))      \
         {                                                                      \
           gegl_buffer_iterator_stop (iter);                                    \
+          g_free (converted);                                                  \
+          g_free (bins);                                                       \
                                                                                \
           return;                                                              \
         }                                                                      \
@@ -1087,13 +1563,119 @@ gimp_histogram_calculate_area (const GeglRectangle *area,
 
   while (gegl_buffer_iterator_next (iter))
     {
-      const gfloat *data   = iter->items[0].data;
+      const guint8 *src    = iter->items[0].data;
+      const gfloat *data;
+      const gint   *bin;
+      const gint   *lum;
       gint          length = iter->length;
+      gint          n_values;
+      gint          max_bin;
       gfloat        max;
       gfloat        luminance;
+      gint          i;
 
       CHECK_CANCELED (0);
 
+      if (gimp_gegl_data_is_constant (src, src_bpp, length, empty_data))
+        {
+          gfloat  pixel[MAX_N_COMPONENTS];
+          gdouble total = length;
+
+          babl_process (src_fish, src, pixel, 1);
+
+          if (context->mask)
+            {
+              const gfloat *mask_data = iter->items[1].data;
+              gint          i;
+
+              total = 0.0;
+
+              for (i = 0; i < length; i++)
+                total += mask_data[i];
+            }
+
+          switch (n_components)
+            {
+            case 1:
+              VALUE (0, pixel[0]) += total;
+              break;
+
+            case 2:
+              VALUE (0, pixel[0]) += pixel[1] * total;
+              VALUE (1, pixel[1]) += total;
+              break;
+
+            case 3:
+              VALUE (1, pixel[0]) += total;
+              VALUE (2, pixel[1]) += total;
+              VALUE (3, pixel[2]) += total;
+
+              max = MAX (pixel[0], pixel[1]);
+              max = MAX (pixel[2], max);
+              VALUE (0, max) += total;
+
+              babl_process (fish, pixel, &luminance, 1);
+              VALUE (4, luminance) += total;
+              break;
+
+            case 4:
+              VALUE (1, pixel[0]) += pixel[3] * total;
+              VALUE (2, pixel[1]) += pixel[3] * total;
+              VALUE (3, pixel[2]) += pixel[3] * total;
+              VALUE (4, pixel[3]) += total;
+
+              max = MAX (pixel[0], pixel[1]);
+              max = MAX (pixel[2], max);
+              VALUE (0, max) += pixel[3] * total;
+
+              babl_process (fish, pixel, &luminance, 1);
+              VALUE (5, luminance) += pixel[3] * total;
+              break;
+            }
+
+          continue;
+        }
+
+      if (converted_size < length)
+        {
+          g_free (converted);
+          g_free (bins);
+
+          converted      = g_new (gfloat, length * (n_components + 1));
+          bins           = g_new (gint,   length * (n_components + 1));
+          converted_size = length;
+        }
+
+      babl_process (src_fish, src, converted, length);
+
+      n_values = length * n_components;
+
+      /*  convert the luminance of the whole chunk at once, after the
+       *  pixels, rather than one pixel at a time
+       */
+      if (n_components >= 3)
+        {
+          babl_process (fish, converted, converted + n_values, length);
+
+          n_values += length;
+        }
+
+      /*  quantize all the values in a single loop, which the compiler can
+       *  vectorize, so that the loops below only have to scatter them
+       *  into the bins.  this is the same as VALUE(), since the values
+       *  are clamped to be non-negative.
+       */
+      for (i = 0; i < n_values; i++)
+        {
+          temp = converted[i] * n_bins_1f;
+
+          bins[i] = (gint) (SAFE_CLAMP (temp, 0.0f, n_bins_1f) + 0.5);
+        }
+
+      data = converted;
+      bin  = bins;
+      lum  = bins + length * n_components;
+
       if (context->mask)
         {
           const gfloat *mask_data = iter->items[1].data;
@@ -1105,9 +1687,9 @@ gimp_histogram_calculate_area (const GeglRectangle *area,
                 {
                   const gdouble masked = *mask_data;
 
-                  VALUE (0, data[0]) += masked;
+                  BIN (0, bin[0]) += masked;
 
-                  data += n_components;
+                  bin += n_components;
                   mask_data += 1;
 
                   CHECK_CANCELED (length);
@@ -1120,10 +1702,11 @@ gimp_histogram_calculate_area (const GeglRectangle *area,
                   const gdouble masked = *mask_data;
                   const gdouble weight = data[1];
 
-                  VALUE (0, data[0]) += weight * masked;
-                  VALUE (1, data[1]) += masked;
+                  BIN (0, bin[0]) += weight * masked;
+                  BIN (1, bin[1]) += masked;
 
                   data += n_components;
+                  bin += n_components;
                   mask_data += 1;
 
                   CHECK_CANCELED (length);
@@ -1135,18 +1718,18 @@ gimp_histogram_calculate_area (const GeglRectangle *area,
                 {
                   const gdouble masked = *mask_data;
 
-                  VALUE (1, data[0]) += masked;
-                  VALUE (2, data[1]) += masked;
-                  VALUE (3, data[2]) += masked;
+                  BIN (1, bin[0]) += masked;
+                  BIN (2, bin[1]) += masked;
+                  BIN (3, bin[2]) += masked;
 
-                  max = MAX (data[0], data[1]);
-                  max = MAX (data[2], max);
-                  VALUE (0, max) += masked;
+                  max_bin = MAX (bin[0], bin[1]);
+                  max_bin = MAX (bin[2], max_bin);
+                  BIN (0, max_bin) += masked;
 
-                  babl_process (fish, data, &luminance, 1);
-                  VALUE (4, luminance) += masked;
+                  BIN (4, *lum) += masked;
 
-                  data += n_components;
+                  bin += n_components;
+                  lum += 1;
                   mask_data += 1;
 
                   CHECK_CANCELED (length);
@@ -1159,19 +1742,20 @@ gimp_histogram_calculate_area (const GeglRectangle *area,
                   const gdouble masked = *mask_data;
                   const gdouble weight = data[3];
 
-                  VALUE (1, data[0]) += weight * masked;
-                  VALUE (2, data[1]) += weight * masked;
-                  VALUE (3, data[2]) += weight * masked;
-                  VALUE (4, data[3]) += masked;
+                  BIN (1, bin[0]) += weight * masked;
+                  BIN (2, bin[1]) += weight * masked;
+                  BIN (3, bin[2]) += weight * masked;
+                  BIN (4, bin[3]) += masked;
 
-                  max = MAX (data[0], data[1]);
-                  max = MAX (data[2], max);
-                  VALUE (0, max) += weight * masked;
+                  max_bin = MAX (bin[0], bin[1]);
+                  max_bin = MAX (bin[2], max_bin);
+                  BIN (0, max_bin) += weight * masked;
 
-                  babl_process (fish, data, &luminance, 1);
-                  VALUE (5, luminance) += weight * masked;
+                  BIN (5, *lum) += weight * masked;
 
                   data += n_components;
+                  bin += n_components;
+                  lum += 1;
                   mask_data += 1;
 
                   CHECK_CANCELED (length);
@@ -1186,9 +1770,9 @@ gimp_histogram_calculate_area (const GeglRectangle *area,
             case 1:
               while (length--)
                 {
-                  VALUE (0, data[0]) += 1.0;
+                  BIN (0, bin[0]) += 1.0;
 
-                  data += n_components;
+                  bin += n_components;
 
                   CHECK_CANCELED (length);
                 }
@@ -1199,10 +1783,11 @@ gimp_histogram_calculate_area (const GeglRectangle *area,
                 {
                   const gdouble weight = data[1];
 
-                  VALUE (0, data[0]) += weight;
-                  VALUE (1, data[1]) += 1.0;
+                  BIN (0, bin[0]) += weight;
+                  BIN (1, bin[1]) += 1.0;
 
                   data += n_components;
+                  bin += n_components;
 
                   CHECK_CANCELED (length);
                 }
@@ -1211,18 +1796,18 @@ gimp_histogram_calculate_area (const GeglRectangle *area,
             case 3: /* calculate separate value values */
               while (length--)
                 {
-                  VALUE (1, data[0]) += 1.0;
-                  VALUE (2, data[1]) += 1.0;
-                  VALUE (3, data[2]) += 1.0;
+                  BIN (1, bin[0]) += 1.0;
+                  BIN (2, bin[1]) += 1.0;
+                  BIN (3, bin[2]) += 1.0;
 
-                  max = MAX (data[0], data[1]);
-                  max = MAX (data[2], max);
-                  VALUE (0, max) += 1.0;
+                  max_bin = MAX (bin[0], bin[1]);
+                  max_bin = MAX (bin[2], max_bin);
+                  BIN (0, max_bin) += 1.0;
 
-                  babl_process (fish, data, &luminance, 1);
-                  VALUE (4, luminance) += 1.0;
+                  BIN (4, *lum) += 1.0;
 
-                  data += n_components;
+                  bin += n_components;
+                  lum += 1;
 
                   CHECK_CANCELED (length);
                 }
@@ -1233,19 +1818,20 @@ gimp_histogram_calculate_area (const GeglRectangle *area,
                 {
                   const gdouble weight = data[3];
 
-                  VALUE (1, data[0]) += weight;
-                  VALUE (2, data[1]) += weight;
-                  VALUE (3, data[2]) += weight;
-                  VALUE (4, data[3]) += 1.0;
+                  BIN (1, bin[0]) += weight;
+                  BIN (2, bin[1]) += weight;
+                  BIN (3, bin[2]) += weight;
+                  BIN (4, bin[3]) += 1.0;
 
-                  max = MAX (data[0], data[1]);
-                  max = MAX (data[2], max);
-                  VALUE (0, max) += weight;
+                  max_bin = MAX (bin[0], bin[1]);
+                  max_bin = MAX (bin[2], max_bin);
+                  BIN (0, max_bin) += weight;
 
-                  babl_process (fish, data, &luminance, 1);
-                  VALUE (5, luminance) += weight;
+                  BIN (5, *lum) += weight;
 
                   data += n_components;
+                  bin += n_components;
+                  lum += 1;
 
                   CHECK_CANCELED (length);
                 }
@@ -1255,7 +1841,11 @@ gimp_histogram_calculate_area (const GeglRectangle *area,
     }
 
 #undef VALUE
+#undef BIN
 #undef CHECK_CANCELED
+
+  g_free (converted);
+  g_free (bins);
 }
 
 static void
@@ -1278,53 +1868,325 @@ gimp_histogram_calculate_async_callback (GimpAsync        *async,
   g_slice_free (CalculateContext, context);
 }
 
+static void
+gimp_histogram_calculate_cached_async_callback (GimpAsync        *async,
+                                                CalculateContext *context)
+{
+  context->histogram->priv->calculate_async = NULL;
+
+  /*  store whatever tiles we managed to calculate, even if we were
+   *  canceled
+   */
+  gimp_histogram_cache_end (context);
+
+  if (gimp_async_is_finished (async))
+    {
+      gimp_histogram_set_values (context->histogram,
+                                 context->n_components, context->n_bins,
+                                 context->values);
+    }
+  else
+    {
+      g_free (context->values);
+    }
+
+  g_object_unref (context->buffer);
+
+  g_slice_free (CalculateContext, context);
+}
+
+static void
+gimp_histogram_cache_free (GimpHistogramCache *cache)
+{
+  gimp_histogram_cache_clear (cache);
+  gimp_histogram_cache_clear_masked (cache);
+}
+
+static void
+gimp_histogram_cache_clear (GimpHistogramCache *cache)
+{
+  gint i;
+
+  for (i = 0; i < cache->n_cols * cache->n_rows; i++)
+    g_clear_pointer (&cache->tiles[i], g_bytes_unref);
+
+  g_clear_pointer (&cache->tiles,  g_free);
+  g_clear_pointer (&cache->stamps, g_free);
+
+  cache->format = NULL;
+  cache->rect   = *GEGL_RECTANGLE (0, 0, 0, 0);
+  cache->n_cols = 0;
+  cache->n_rows = 0;
+
+  cache->generation++;
+}
+
+static void
+gimp_histogram_cache_clear_masked (GimpHistogramCache *cache)
+{
+  g_clear_pointer (&cache->mask_cache,    gimp_histogram_cache_unref);
+  g_clear_pointer (&cache->masked_values, g_free);
+}
+
+static gboolean
+gimp_histogram_cache_lookup_masked (GimpHistogramCache  *cache,
+                                    GimpHistogram       *histogram,
+                                    GeglBuffer          *buffer,
+                                    const GeglRectangle *buffer_rect,
+                                    GimpHistogramCache  *mask_cache,
+                                    const GeglRectangle *mask_rect)
+{
+  GimpHistogramPrivate *priv = histogram->priv;
+  gsize                 size;
+
+  if (! cache->masked_values                                  ||
+      cache->mask_cache     != mask_cache                     ||
+      cache->mask_changes   != mask_cache->changes            ||
+      cache->masked_changes != cache->changes                 ||
+      cache->masked_trc     != priv->trc                      ||
+      cache->masked_format  != gegl_buffer_get_format (buffer) ||
+      ! gegl_rectangle_equal (&cache->masked_rect, buffer_rect) ||
+      ! gegl_rectangle_equal (&cache->mask_rect,   mask_rect))
+    {
+      return FALSE;
+    }
+
+  if (priv->calculate_async)
+    gimp_async_cancel_and_wait (priv->calculate_async);
+
+  size = sizeof (gdouble) * cache->masked_n_channels * cache->masked_n_bins;
+
+  gimp_histogram_set_values (histogram,
+                             MAX (cache->masked_n_channels -
+                                  N_DERIVED_CHANNELS, 0),
+                             cache->masked_n_bins,
+                             size ? g_memdup2 (cache->masked_values, size) :
+                                    NULL);
+
+  return TRUE;
+}
+
+static MaskedData *
+gimp_histogram_cache_masked_data_new (GimpHistogramCache  *cache,
+                                      GimpHistogram       *histogram,
+                                      GeglBuffer          *buffer,
+                                      const GeglRectangle *buffer_rect,
+                                      GimpHistogramCache  *mask_cache,
+                                      const GeglRectangle *mask_rect)
+{
+  MaskedData *data = g_slice_new0 (MaskedData);
+
+  data->histogram    = g_object_ref (histogram);
+  data->cache        = g_rc_box_acquire (cache);
+  data->mask_cache   = g_rc_box_acquire (mask_cache);
+  data->changes      = cache->changes;
+  data->mask_changes = mask_cache->changes;
+  data->format       = gegl_buffer_get_format (buffer);
+  data->buffer_rect  = *buffer_rect;
+  data->mask_rect    = *mask_rect;
+
+  return data;
+}
+
+static void
+gimp_histogram_cache_masked_data_free (MaskedData *data)
+{
+  g_object_unref (data->histogram);
+  gimp_histogram_cache_unref (data->cache);
+  gimp_histogram_cache_unref (data->mask_cache);
+
+  g_slice_free (MaskedData, data);
+}
+
+/*  remembers the histogram's values as the last histogram calculated
+ *  through a mask, unless the buffer or the mask changed during the
+ *  calculation.  called on the main thread.
+ */
+static void
+gimp_histogram_cache_store_masked (MaskedData *data)
+{
+  GimpHistogramCache   *cache = data->cache;
+  GimpHistogramPrivate *priv  = data->histogram->priv;
+
+  if (cache->changes            != data->changes ||
+      data->mask_cache->changes != data->mask_changes)
+    {
+      return;
+    }
+
+  gimp_histogram_cache_clear_masked (cache);
+
+  cache->mask_cache        = g_rc_box_acquire (data->mask_cache);
+  cache->mask_changes      = data->mask_changes;
+  cache->masked_changes    = data->changes;
+  cache->masked_trc        = priv->trc;
+  cache->masked_format     = data->format;
+  cache->masked_rect       = data->buffer_rect;
+  cache->mask_rect         = data->mask_rect;
+  cache->masked_n_channels = priv->n_channels;
+  cache->masked_n_bins     = priv->n_bins;
+  cache->masked_values     = g_memdup2 (priv->values,
+                                        sizeof (gdouble) *
+                                        priv->n_channels * priv->n_bins);
+}
+
+static void
+gimp_histogram_cache_masked_async_callback (GimpAsync  *async,
+                                            MaskedData *data)
+{
+  if (gimp_async_is_finished (async))
+    gimp_histogram_cache_store_masked (data);
+
+  gimp_histogram_cache_masked_data_free (data);
+}
+
+static void
+gimp_histogram_cache_get_tile_rect (const GeglRectangle *rect,
+                                    gint                 col,
+                                    gint                 row,
+                                    GeglRectangle       *tile_rect)
+{
+  gegl_rectangle_intersect (tile_rect,
+                            GEGL_RECTANGLE (rect->x + col * CACHE_TILE_SIZE,
+                                            rect->y + row * CACHE_TILE_SIZE,
+                                            CACHE_TILE_SIZE,
+                                            CACHE_TILE_SIZE),
+                            rect);
+}
+
+/*  sets the cache up for calculating the histogram of 'context', and
+ *  fills 'context' with a snapshot of the cached tiles.  called on the
+ *  main thread.
+ */
+static void
+gimp_histogram_cache_begin (GimpHistogramCache *cache,
+                            CalculateContext   *context)
+{
+  GimpHistogramPrivate *priv   = context->histogram->priv;
+  const Babl           *format = gegl_buffer_get_format (context->buffer);
+  gint                  n_tiles;
+  gint                  i;
+
+  if (cache->trc    != priv->trc ||
+      cache->format != format    ||
+      ! gegl_rectangle_equal (&cache->rect, &context->buffer_rect))
+    {
+      gimp_histogram_cache_clear (cache);
+
+      cache->trc    = priv->trc;
+      cache->format = format;
+      cache->rect   = context->buffer_rect;
+      cache->n_cols = (cache->rect.width  + CACHE_TILE_SIZE - 1) /
+                      CACHE_TILE_SIZE;
+      cache->n_rows = (cache->rect.height + CACHE_TILE_SIZE - 1) /
+                      CACHE_TILE_SIZE;
+
+      n_tiles = cache->n_cols * cache->n_rows;
+
+      cache->tiles  = g_new0 (GBytes *, n_tiles);
+      cache->stamps = g_new0 (guint,    n_tiles);
+    }
+
+  n_tiles = cache->n_cols * cache->n_rows;
+
+  context->cache        = g_rc_box_acquire (cache);
+  context->generation   = cache->generation;
+  context->cache_rect   = cache->rect;
+  context->n_cols       = cache->n_cols;
+  context->n_rows       = cache->n_rows;
+  context->tiles        = g_new0 (GBytes *, n_tiles);
+  context->stamps       = g_memdup2 (cache->stamps, n_tiles * sizeof (guint));
+  context->n_components = cache->n_components;
+  context->n_bins       = cache->n_bins;
+
+  for (i = 0; i < n_tiles; i++)
+    {
+      if (cache->tiles[i])
+        context->tiles[i] = g_bytes_ref (cache->tiles[i]);
+    }
+}
+
+/*  stores the tiles calculated by 'context' in the cache, unless they
+ *  were invalidated in the meantime, and releases the snapshot.  called
+ *  on the main thread.
+ */
+static void
+gimp_histogram_cache_end (CalculateContext *context)
+{
+  GimpHistogramCache *cache   = context->cache;
+  gint                n_tiles = context->n_cols * context->n_rows;
+  gint                i;
+
+  if (cache->generation == context->generation)
+    {
+      for (i = 0; i < n_tiles; i++)
+        {
+          if (context->tiles[i]                        &&
+              ! cache->tiles[i]                        &&
+              cache->stamps[i] == context->stamps[i])
+            {
+              cache->tiles[i] = g_bytes_ref (context->tiles[i]);
+
+              cache->n_components = context->n_components;
+              cache->n_bins       = context->n_bins;
+            }
+        }
+    }
+
+  for (i = 0; i < n_tiles; i++)
+    g_clear_pointer (&context->tiles[i], g_bytes_unref);
+
+  g_clear_pointer (&context->tiles,  g_free);
+  g_clear_pointer (&context->stamps, g_free);
+
+  g_clear_pointer (&context->cache, gimp_histogram_cache_unref);
+}
+
 guint
 gimp_histogram_unique_colors (GimpDrawable *drawable)
 {
+  GeglBuffer         *buffer;
   const Babl         *format;
-  guint               bpp;
+  gint                bpp;
+  gconstpointer       empty_data;
   GeglBufferIterator *iter;
-  GHashTable         *hash_table;
-  guint               uniques = 0;
+  ColorSet            set;
 
   g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), 0);
 
-  format = gimp_drawable_get_format (drawable);
-  bpp    = babl_format_get_bytes_per_pixel (format);
+  buffer     = gimp_drawable_get_buffer (drawable);
+  format     = gimp_drawable_get_format (drawable);
+  bpp        = babl_format_get_bytes_per_pixel (format);
+  empty_data = gimp_gegl_buffer_get_empty_tile_data (buffer);
 
-  iter = gegl_buffer_iterator_new (gimp_drawable_get_buffer (drawable),
+  iter = gegl_buffer_iterator_new (buffer,
                                    NULL, 0, format,
                                    GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
 
-
-  hash_table = g_hash_table_new_full ((GHashFunc)      hash_color_bytes,
-                                      (GEqualFunc)     color_bytes_equal,
-                                      (GDestroyNotify) g_bytes_unref,
-                                      NULL);
+  color_set_init (&set, bpp);
 
   while (gegl_buffer_iterator_next (iter))
     {
-      guint8 *data   = iter->items[0].data;
-      guint   length = iter->length;
+      const guint8 *data   = iter->items[0].data;
+      const guint8 *prev   = NULL;
+      gint          length = iter->length;
+
+      /*  constant chunks, like empty tiles, only have a single color  */
+      if (gimp_gegl_data_is_constant (data, bpp, length, empty_data))
+        length = 1;
 
       while (length--)
         {
-          GBytes *key = g_bytes_new (data, bpp);
-
-          if (! g_hash_table_lookup_extended (hash_table, key, NULL, NULL))
-            {
-              g_hash_table_insert (hash_table, key, NULL);
-              key = NULL;
-              uniques++;
-            }
-
-          g_bytes_unref (key);
+          /*  skip runs of the same color without looking them up  */
+          if (! prev || memcmp (data, prev, bpp))
+            color_set_insert (&set, data);
 
+          prev  = data;
           data += bpp;
         }
     }
 
-  g_hash_table_destroy (hash_table);
+  color_set_clear (&set);
 
-  return uniques;
+  return set.n_colors;
 }
@@ -63,6 +63,40 @@ GimpAsync     * gimp_histogram_calculate_async (GimpHistogram        *histogram,
                                                 GeglBuffer           *mask,
                                                 const GeglRectangle  *mask_rect);
 
+void            gimp_histogram_calculate_cached
+                                               (GimpHistogram        *histogram,
+                                                GimpHistogramCache   *cache,
+                                                GeglBuffer           *buffer,
+                                                const GeglRectangle  *buffer_rect);
+GimpAsync     * gimp_histogram_calculate_cached_async
+                                               (GimpHistogram        *histogram,
+                                                GimpHistogramCache   *cache,
+                                                GeglBuffer           *buffer,
+                                                const GeglRectangle  *buffer_rect);
+void            gimp_histogram_calculate_masked_cached
+                                               (GimpHistogram        *histogram,
+                                                GimpHistogramCache   *cache,
+                                                GeglBuffer           *buffer,
+                                                const GeglRectangle  *buffer_rect,
+                                                GimpHistogramCache   *mask_cache,
+                                                GeglBuffer           *mask,
+                                                const GeglRectangle  *mask_rect);
+GimpAsync     * gimp_histogram_calculate_masked_cached_async
+                                               (GimpHistogram        *histogram,
+                                                GimpHistogramCache   *cache,
+                                                GeglBuffer           *buffer,
+                                                const GeglRectangle  *buffer_rect,
+                                                GimpHistogramCache   *mask_cache,
+                                                GeglBuffer           *mask,
+                                                const GeglRectangle  *mask_rect);
+
+GimpHistogramCache *
+                gimp_histogram_cache_new       (void);
+void            gimp_histogram_cache_unref     (GimpHistogramCache   *cache);
+void            gimp_histogram_cache_invalidate
+                                               (GimpHistogramCache   *cache,
+                                                const GeglRectangle  *rect);
+
 void            gimp_histogram_clear_values    (GimpHistogram        *histogram,
                                                 gint                  n_components);
 
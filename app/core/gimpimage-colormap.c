@@ -50,10 +50,10 @@ typedef struct
 {
   GeglBuffer *buffer;
   const Babl *format;
+  gint        n_colors;
 
   /* Shared by jobs. */
-  gboolean   *found;
-  GRWLock    *lock;
+  guint      *used;
 } IndexUsedJobData;
 
 
@@ -62,8 +62,9 @@ typedef struct
 static void   gimp_image_colormap_set_palette_entry    (GimpImage        *image,
                                                         GeglColor        *color,
                                                         gint              index);
-static void   gimp_image_colormap_thread_is_index_used (IndexUsedJobData *data,
-                                                        gint              index);
+static void   gimp_image_colormap_update_used          (GimpImage        *image);
+static void   gimp_image_colormap_thread_get_used      (IndexUsedJobData *data,
+                                                        gpointer          user_data);
 
 
 /*  public functions  */
@@ -313,43 +314,44 @@ gimp_image_unset_colormap (GimpImage *image,
   gimp_image_colormap_changed (image, -1);
 }
 
+/**
+ * gimp_image_colormap_is_index_used:
+ * @image:       a #GimpImage
+ * @color_index: a color index
+ *
+ * The indices used by the image's layers are collected in a single
+ * pass over all of them, and kept until gimp_image_colormap_invalidate_used()
+ * is called, so asking for every index of the colormap costs no more
+ * than asking for one.
+ *
+ * Returns: whether any layer of @image uses @color_index.
+ **/
 gboolean
 gimp_image_colormap_is_index_used (GimpImage *image,
                                    gint       color_index)
 {
-  GList       *layers;
-  GList       *iter;
-  GThreadPool *pool;
-  GRWLock      lock;
-  gboolean     found = FALSE;
-  gint         num_processors;
-
-  g_rw_lock_init (&lock);
-  num_processors = GIMP_GEGL_CONFIG (image->gimp->config)->num_processors;
-  layers         = gimp_image_get_layer_list (image);
+  GimpImagePrivate *private;
 
-  pool = g_thread_pool_new_full ((GFunc) gimp_image_colormap_thread_is_index_used,
-                                 GINT_TO_POINTER (color_index),
-                                 (GDestroyNotify) g_free,
-                                 num_processors, TRUE, NULL);
-  for (iter = layers; iter; iter = g_list_next (iter))
-    {
-      IndexUsedJobData *job_data;
+  g_return_val_if_fail (GIMP_IS_IMAGE (image), FALSE);
+  g_return_val_if_fail (color_index >= 0 && color_index < 256, FALSE);
 
-      job_data = g_malloc (sizeof (IndexUsedJobData ));
-      job_data->buffer = gimp_drawable_get_buffer (iter->data);
-      job_data->format = gimp_drawable_get_format_without_alpha (iter->data);
-      job_data->found  = &found;
-      job_data->lock   = &lock;
+  private = GIMP_IMAGE_GET_PRIVATE (image);
 
-      g_thread_pool_push (pool, job_data, NULL);
-    }
+  if (! private->colormap_used_valid)
+    gimp_image_colormap_update_used (image);
 
-  g_thread_pool_free (pool, FALSE, TRUE);
-  g_rw_lock_clear (&lock);
-  g_list_free (layers);
+  return (private->colormap_used[color_index / 32] >> (color_index % 32)) & 1;
+}
+
+/* Called whenever the pixels of any layer, or the layers themselves,
+ * might have changed.
+ */
+void
+gimp_image_colormap_invalidate_used (GimpImage *image)
+{
+  g_return_if_fail (GIMP_IS_IMAGE (image));
 
-  return found;
+  GIMP_IMAGE_GET_PRIVATE (image)->colormap_used_valid = FALSE;
 }
 
 GeglColor *
@@ -459,6 +461,8 @@ gimp_image_delete_colormap_entry (GimpImage *image,
                                  color_index, -1);
         }
 
+      gimp_image_colormap_invalidate_used (image);
+
       entry = gimp_palette_get_entry (private->palette, color_index);
       gimp_palette_delete_entry (private->palette, entry);
 
@@ -515,20 +519,53 @@ gimp_image_colormap_set_palette_entry (GimpImage *image,
 }
 
 static void
-gimp_image_colormap_thread_is_index_used (IndexUsedJobData *data,
-                                          gint              index)
+gimp_image_colormap_update_used (GimpImage *image)
 {
-  g_rw_lock_reader_lock (data->lock);
-  if (*data->found)
-    {
-      g_rw_lock_reader_unlock (data->lock);
-      return;
-    }
-  g_rw_lock_reader_unlock (data->lock);
-  if (gimp_gegl_is_index_used (data->buffer, NULL, data->format, index))
+  GimpImagePrivate *private = GIMP_IMAGE_GET_PRIVATE (image);
+  GList            *layers;
+  GList            *iter;
+  GThreadPool      *pool;
+  gint              num_processors;
+  gint              n_colors = 256;
+
+  memset (private->colormap_used, 0, sizeof (private->colormap_used));
+
+  if (private->palette)
+    n_colors = MAX (gimp_palette_get_n_colors (private->palette), 1);
+
+  num_processors = GIMP_GEGL_CONFIG (image->gimp->config)->num_processors;
+  layers         = gimp_image_get_layer_list (image);
+
+  /*  one job per layer, all of them stop as soon as each color of the
+   *  colormap was found in any layer
+   */
+  pool = g_thread_pool_new_full ((GFunc) gimp_image_colormap_thread_get_used,
+                                 NULL,
+                                 (GDestroyNotify) g_free,
+                                 num_processors, TRUE, NULL);
+  for (iter = layers; iter; iter = g_list_next (iter))
     {
-      g_rw_lock_writer_lock (data->lock);
-      *data->found = TRUE;
-      g_rw_lock_writer_unlock (data->lock);
+      IndexUsedJobData *job_data;
+
+      job_data = g_new (IndexUsedJobData, 1);
+      job_data->buffer   = gimp_drawable_get_buffer (iter->data);
+      job_data->format   = gimp_drawable_get_format_without_alpha (iter->data);
+      job_data->n_colors = n_colors;
+      job_data->used     = private->colormap_used;
+
+      g_thread_pool_push (pool, job_data, NULL);
     }
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+  g_list_free (layers);
+
+  private->colormap_used_valid = TRUE;
+}
+
+static void
+gimp_image_colormap_thread_get_used (IndexUsedJobData *data,
+                                     gpointer          user_data)
+{
+  gimp_gegl_get_used_indices (data->buffer, NULL, data->format,
+                              data->used, data->n_colors);
 }
@@ -47,6 +47,7 @@ void           gimp_image_unset_colormap           (GimpImage     *image,
 
 gboolean       gimp_image_colormap_is_index_used   (GimpImage     *image,
                                                     gint           color_index);
+void           gimp_image_colormap_invalidate_used (GimpImage     *image);
 
 GeglColor    * gimp_image_get_colormap_entry       (GimpImage     *image,
                                                     gint           color_index);
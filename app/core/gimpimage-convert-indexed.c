@@ -178,6 +178,12 @@
 #include "gimp-intl.h"
 
 
+#define PIXELS_PER_THREAD \
+  (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
+
+/* progress is reported after each band of about this many pixels */
+#define PIXELS_PER_BAND (256 * 256)
+
 /* basic memory/quality tradeoff */
 #define PRECISION_R 8
 #define PRECISION_G 8
@@ -332,6 +338,23 @@ static const Babl *linear_to_rgb_float_fish = NULL;
 static const Babl *linear_to_gray_float_fish = NULL;
 static const Babl *lab_to_rgb_fish = NULL;
 
+static inline void
+lab_to_unshifted_lin (const gfloat *lab,
+                      gint         *hr,
+                      gint         *hg,
+                      gint         *hb)
+{
+  gint or, og, ob;
+
+  or = RINT(lab[0] * LRAT);
+  og = RINT((lab[1] - LOWA) * ARAT);
+  ob = RINT((lab[2] - LOWB) * BRAT);
+
+  *hr = CLAMP(or, 0, 255);
+  *hg = CLAMP(og, 0, 255);
+  *hb = CLAMP(ob, 0, 255);
+}
+
 static inline void
 rgb_to_unshifted_lin (const guchar  r,
                       const guchar  g,
@@ -340,7 +363,6 @@ rgb_to_unshifted_lin (const guchar  r,
                       gint         *hg,
                       gint         *hb)
 {
-  gint   or, og, ob;
   gfloat rgb[3] = { r / 255.0, g / 255.0, b / 255.0 };
   gfloat lab[3];
 
@@ -348,13 +370,7 @@ rgb_to_unshifted_lin (const guchar  r,
 
   /* fprintf(stderr, " %d-%d-%d -> %0.3f,%0.3f,%0.3f ", r, g, b, sL, sa, sb);*/
 
-  or = RINT(lab[0] * LRAT);
-  og = RINT((lab[1] - LOWA) * ARAT);
-  ob = RINT((lab[2] - LOWB) * BRAT);
-
-  *hr = CLAMP(or, 0, 255);
-  *hg = CLAMP(og, 0, 255);
-  *hb = CLAMP(ob, 0, 255);
+  lab_to_unshifted_lin (lab, hr, hg, hb);
 
   /*  fprintf(stderr, " %d:%d:%d ", *hr, *hg, *hb); */
 }
@@ -469,6 +485,19 @@ rgb_to_lin (const guchar  r,
   *hb = ob;
 }
 
+static inline void
+lab_to_lin (const gfloat *lab,
+            gint         *hr,
+            gint         *hg,
+            gint         *hb)
+{
+  lab_to_unshifted_lin (lab, hr, hg, hb);
+
+  *hr = RSDF (*hr);
+  *hg = GSDF (*hg);
+  *hb = BSDF (*hb);
+}
+
 
 static inline ColorFreq *
 HIST_RGB (ColorFreq  *hist_ptr,
@@ -574,6 +603,17 @@ typedef struct
 
 } box, *boxptr;
 
+typedef struct
+{
+  CFHistogram  histogram;
+  GeglBuffer  *buffer;
+  const Babl  *format;
+  gint         offset_x;
+  gint         offset_y;
+  gboolean     dither_alpha;
+  GMutex       mutex;
+} HistogramRGBData;
+
 
 static void          zero_histogram_gray     (CFHistogram   histogram);
 static void          zero_histogram_rgb      (CFHistogram   histogram);
@@ -1236,222 +1276,293 @@ generate_histogram_gray (CFHistogram  histogram,
 }
 
 static void
-check_white_or_black (const guchar *data)
+generate_histogram_rgb_area (const GeglRectangle *area,
+                             HistogramRGBData    *data)
 {
-  if (data[RED]   == 255 &&
-      data[GREEN] == 255 &&
-      data[BLUE]  == 255)
-    had_white = TRUE;
-  if (data[RED]  ==0 &&
-      data[GREEN]==0 &&
-      data[BLUE] ==0)
-    had_black = TRUE;
+  GeglBufferIterator *iter;
+  gfloat             *rgb;
+  gfloat             *lab;
+  guint32            *refs;
+  gint                bpp;
+  gboolean            has_alpha;
+  gboolean            had_white_area = FALSE;
+  gboolean            had_black_area = FALSE;
+
+  bpp       = babl_format_get_bytes_per_pixel (data->format);
+  has_alpha = babl_format_has_alpha (data->format);
+
+  rgb  = gegl_scratch_new (gfloat,  3 * area->width * area->height);
+  lab  = gegl_scratch_new (gfloat,  3 * area->width * area->height);
+  refs = gegl_scratch_new (guint32, area->width * area->height);
+
+  iter = gegl_buffer_iterator_new (data->buffer, area, 0, data->format,
+                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const guchar  *src = iter->items[0].data;
+      GeglRectangle *roi = &iter->items[0].roi;
+      gint           n   = 0;
+      gint           row;
+      gint           i;
+
+      /*  gather the opaque pixels, and convert them to lab in one go,
+       *  rather than one pixel at a time
+       */
+      for (row = 0; row < roi->height; row++)
+        {
+          gint col;
+
+          for (col = 0; col < roi->width; col++)
+            {
+              gboolean transparent = FALSE;
+
+              if (has_alpha)
+                {
+                  if (data->dither_alpha)
+                    {
+                      gint dither_x = (col + data->offset_x + roi->x) & DM_WIDTHMASK;
+                      gint dither_y = (row + data->offset_y + roi->y) & DM_HEIGHTMASK;
+
+                      if (src[ALPHA] < DM[dither_x][dither_y])
+                        transparent = TRUE;
+                    }
+                  else
+                    {
+                      if (src[ALPHA] <= 127)
+                        transparent = TRUE;
+                    }
+                }
+
+              if (! transparent)
+                {
+                  if (src[RED] == 255 && src[GREEN] == 255 && src[BLUE] == 255)
+                    had_white_area = TRUE;
+                  else if (src[RED] == 0 && src[GREEN] == 0 && src[BLUE] == 0)
+                    had_black_area = TRUE;
+
+                  rgb[3 * n + 0] = src[RED]   / 255.0f;
+                  rgb[3 * n + 1] = src[GREEN] / 255.0f;
+                  rgb[3 * n + 2] = src[BLUE]  / 255.0f;
+
+                  n++;
+                }
+
+              src += bpp;
+            }
+        }
+
+      babl_process (rgb_to_lab_fish, rgb, lab, n);
+
+      for (i = 0; i < n; i++)
+        {
+          gint hr, hg, hb;
+
+          lab_to_lin (lab + 3 * i, &hr, &hg, &hb);
+
+          refs[i] = REF_FUNC (hr, hg, hb);
+        }
+
+      g_mutex_lock (&data->mutex);
+
+      for (i = 0; i < n; i++)
+        data->histogram[refs[i]]++;
+
+      g_mutex_unlock (&data->mutex);
+    }
+
+  gegl_scratch_free (refs);
+  gegl_scratch_free (lab);
+  gegl_scratch_free (rgb);
+
+  g_mutex_lock (&data->mutex);
+
+  had_white |= had_white_area;
+  had_black |= had_black_area;
+
+  g_mutex_unlock (&data->mutex);
 }
 
+/*  collects the distinct colors of the layer in found_cols, until there
+ *  are more than col_limit of them, at which point needs_quantize is set.
+ *  this only compares pixel values, the histogram itself is built by
+ *  generate_histogram_rgb_area().
+ */
 static void
-generate_histogram_rgb (CFHistogram   histogram,
-                        GimpLayer    *layer,
-                        gint          col_limit,
-                        gboolean      dither_alpha,
-                        GimpProgress *progress)
+find_colors_rgb (GimpLayer  *layer,
+                 const Babl *format,
+                 gint        col_limit,
+                 gboolean    dither_alpha)
 {
   GeglBufferIterator *iter;
-  const Babl         *format;
-  GeglRectangle      *roi;
-  ColorFreq          *colfreq;
-  gint                nfc_iter;
-  gint                row, col, coledge;
   gint                offsetx, offsety;
-  gint64              layer_size;
-  gint64              total_size = 0;
-  gint                count      = 0;
   gint                bpp;
   gboolean            has_alpha;
 
-  format = gimp_drawable_get_format (GIMP_DRAWABLE (layer));
-
-  g_return_if_fail (format == babl_format_with_space ("R'G'B' u8", format) ||
-                    format == babl_format_with_space ("R'G'B'A u8", format));
-
   bpp       = babl_format_get_bytes_per_pixel (format);
   has_alpha = babl_format_has_alpha (format);
 
   gimp_item_get_offset (GIMP_ITEM (layer), &offsetx, &offsety);
 
-  layer_size = (gimp_item_get_width  (GIMP_ITEM (layer)) *
-                gimp_item_get_height (GIMP_ITEM (layer)));
-
-  /*  g_printerr ("col_limit = %d, nfc = %d\n", col_limit, num_found_cols); */
-
   iter = gegl_buffer_iterator_new (gimp_drawable_get_buffer (GIMP_DRAWABLE (layer)),
                                    NULL, 0, format,
                                    GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
-  roi = &iter->items[0].roi;
-
-  if (progress)
-    gimp_progress_set_value (progress, 0.0);
 
   while (gegl_buffer_iterator_next (iter))
     {
-      const guchar *data   = iter->items[0].data;
-      gint          length = iter->length;
-
-      total_size += length;
+      const guchar  *data   = iter->items[0].data;
+      GeglRectangle *roi    = &iter->items[0].roi;
+      gint           length = iter->length;
+      gint           col, coledge, row;
 
-      /* g_printerr (" [%d,%d - %d,%d]", srcPR.x, src_roi->y, offsetx, offsety); */
+      /* if alpha-dithering, we need to be deterministic w.r.t. offsets */
+      col = roi->x + offsetx;
+      coledge = col + roi->width;
+      row = roi->y + offsety;
 
-      if (needs_quantize)
+      while (length--)
         {
-          if (dither_alpha)
-            {
-              /* if alpha-dithering,
-                 we need to be deterministic w.r.t. offsets */
+          gboolean transparent = FALSE;
 
-              col = roi->x + offsetx;
-              coledge = col + roi->width;
-              row = roi->y + offsety;
-
-              while (length--)
+          if (has_alpha)
+            {
+              if (dither_alpha)
                 {
-                  gboolean transparent = FALSE;
-
-                  if (has_alpha &&
-                      data[ALPHA] <
+                  if (data[ALPHA] <
                       DM[col & DM_WIDTHMASK][row & DM_HEIGHTMASK])
                     transparent = TRUE;
-
-                  if (! transparent)
-                    {
-                      colfreq = HIST_RGB (histogram,
-                                          data[RED],
-                                          data[GREEN],
-                                          data[BLUE]);
-                      check_white_or_black (data);
-                      (*colfreq)++;
-                    }
-
-                  col++;
-                  if (col == coledge)
-                    {
-                      col = roi->x + offsetx;
-                      row++;
-                    }
-
-                  data += bpp;
                 }
-            }
-          else
-            {
-              while (length--)
+              else
                 {
-                  if ((has_alpha && ((data[ALPHA] > 127)))
-                      || (!has_alpha))
-                    {
-                      colfreq = HIST_RGB (histogram,
-                                          data[RED],
-                                          data[GREEN],
-                                          data[BLUE]);
-                      check_white_or_black (data);
-                      (*colfreq)++;
-                    }
-
-                  data += bpp;
+                  if (data[ALPHA] <= 127)
+                    transparent = TRUE;
                 }
             }
-        }
-      else
-        {
-          /* if alpha-dithering, we need to be deterministic w.r.t. offsets */
-          col = roi->x + offsetx;
-          coledge = col + roi->width;
-          row = roi->y + offsety;
 
-          while (length--)
+          if (! transparent)
             {
-              gboolean transparent = FALSE;
+              gint nfc_iter;
 
-              if (has_alpha)
+              for (nfc_iter = 0;
+                   nfc_iter < num_found_cols;
+                   nfc_iter++)
                 {
-                  if (dither_alpha)
-                    {
-                      if (data[ALPHA] <
-                          DM[col & DM_WIDTHMASK][row & DM_HEIGHTMASK])
-                        transparent = TRUE;
-                    }
-                  else
-                    {
-                      if (data[ALPHA] <= 127)
-                        transparent = TRUE;
-                    }
+                  if ((data[RED]   == found_cols[nfc_iter][0]) &&
+                      (data[GREEN] == found_cols[nfc_iter][1]) &&
+                      (data[BLUE]  == found_cols[nfc_iter][2]))
+                    goto already_found;
                 }
 
-              if (! transparent)
-                {
-                  colfreq = HIST_RGB (histogram,
-                                      data[RED],
-                                      data[GREEN],
-                                      data[BLUE]);
-                  (*colfreq)++;
-
-                  if (!needs_quantize)
-                    {
-                      for (nfc_iter = 0;
-                           nfc_iter < num_found_cols;
-                           nfc_iter++)
-                        {
-                          if ((data[RED]   == found_cols[nfc_iter][0]) &&
-                              (data[GREEN] == found_cols[nfc_iter][1]) &&
-                              (data[BLUE]  == found_cols[nfc_iter][2]))
-                            goto already_found;
-                        }
+              /* Color was not in the table of
+               * existing colors
+               */
 
-                      /* Color was not in the table of
-                       * existing colors
-                       */
+              num_found_cols++;
 
-                      num_found_cols++;
+              if (num_found_cols > col_limit)
+                {
+                  /* There are more colors in the image than
+                   *  were allowed.  We switch to plain
+                   *  histogram calculation with a view to
+                   *  quantizing at a later stage.
+                   */
+                  needs_quantize = TRUE;
+                  /* g_print ("\nmax colors exceeded - needs quantize.\n");*/
 
-                      if (num_found_cols > col_limit)
-                        {
-                          /* There are more colors in the image than
-                           *  were allowed.  We switch to plain
-                           *  histogram calculation with a view to
-                           *  quantizing at a later stage.
-                           */
-                          needs_quantize = TRUE;
-                          /* g_print ("\nmax colors exceeded - needs quantize.\n");*/
-                          goto already_found;
-                        }
-                      else
-                        {
-                          /* Remember the new color we just found.
-                           */
-                          found_cols[num_found_cols-1][0] = data[RED];
-                          found_cols[num_found_cols-1][1] = data[GREEN];
-                          found_cols[num_found_cols-1][2] = data[BLUE];
+                  gegl_buffer_iterator_stop (iter);
 
-                          check_white_or_black (data);
-                        }
-                    }
+                  return;
                 }
-            already_found:
 
-              col++;
-              if (col == coledge)
-                {
-                  col = roi->x + offsetx;
-                  row++;
-                }
+              /* Remember the new color we just found.
+               */
+              found_cols[num_found_cols-1][0] = data[RED];
+              found_cols[num_found_cols-1][1] = data[GREEN];
+              found_cols[num_found_cols-1][2] = data[BLUE];
+            }
+        already_found:
 
-              data += bpp;
+          col++;
+          if (col == coledge)
+            {
+              col = roi->x + offsetx;
+              row++;
             }
+
+          data += bpp;
         }
+    }
+}
+
+static void
+generate_histogram_rgb (CFHistogram   histogram,
+                        GimpLayer    *layer,
+                        gint          col_limit,
+                        gboolean      dither_alpha,
+                        GimpProgress *progress)
+{
+  HistogramRGBData  data;
+  GeglBuffer       *buffer;
+  const Babl       *format;
+  GeglRectangle     rect;
+  gint              band_height;
+  gint              y;
+
+  format = gimp_drawable_get_format (GIMP_DRAWABLE (layer));
+
+  g_return_if_fail (format == babl_format_with_space ("R'G'B' u8", format) ||
+                    format == babl_format_with_space ("R'G'B'A u8", format));
+
+  buffer = gimp_drawable_get_buffer (GIMP_DRAWABLE (layer));
+  rect   = *gegl_buffer_get_extent (buffer);
+
+  /*  g_printerr ("col_limit = %d, nfc = %d\n", col_limit, num_found_cols); */
+
+  if (progress)
+    gimp_progress_set_value (progress, 0.0);
+
+  if (! needs_quantize)
+    find_colors_rgb (layer, format, col_limit, dither_alpha);
 
-      if (progress && (count % 16 == 0))
+  if (rect.width <= 0 || rect.height <= 0)
+    return;
+
+  data.histogram    = histogram;
+  data.buffer       = buffer;
+  data.format       = format;
+  data.dither_alpha = dither_alpha;
+
+  gimp_item_get_offset (GIMP_ITEM (layer), &data.offset_x, &data.offset_y);
+
+  g_mutex_init (&data.mutex);
+
+  /*  fill the histogram in bands of rows, each of which is split across
+   *  threads, so that progress can be reported from this thread
+   */
+  band_height = CLAMP (PIXELS_PER_BAND / rect.width, 1, rect.height);
+
+  for (y = rect.y; y < rect.y + rect.height; y += band_height)
+    {
+      GeglRectangle band;
+
+      band.x      = rect.x;
+      band.y      = y;
+      band.width  = rect.width;
+      band.height = MIN (band_height, rect.y + rect.height - y);
+
+      gegl_parallel_distribute_area (
+        &band, PIXELS_PER_THREAD, GEGL_SPLIT_STRATEGY_AUTO,
+        (GeglParallelDistributeAreaFunc) generate_histogram_rgb_area,
+        &data);
+
+      if (progress)
         gimp_progress_set_value (progress,
-                                 (gdouble) total_size / (gdouble) layer_size);
+                                 (gdouble) (band.y + band.height - rect.y) /
+                                 (gdouble) rect.height);
     }
 
+  g_mutex_clear (&data.mutex);
+
 /*  g_print ("O: col_limit = %d, nfc = %d\n", col_limit, num_found_cols);*/
 }
 
@@ -188,17 +188,9 @@ gimp_image_convert_dither_u8 (GimpImage    *image,
 
   if (dither)
     {
-      GimpObjectQueue *queue;
-      GimpProgress    *sub_progress;
-      GList           *layers;
-      GList           *list;
-      GimpDrawable    *drawable;
-
-      if (progress)
-        gimp_progress_start (progress, FALSE, "%s", _("Dithering"));
-
-      queue        = gimp_object_queue_new (progress);
-      sub_progress = GIMP_PROGRESS (queue);
+      GList *layers;
+      GList *list;
+      GList *drawables = NULL;
 
       layers = gimp_image_get_layer_list (image);
 
@@ -207,23 +199,19 @@ gimp_image_convert_dither_u8 (GimpImage    *image,
           if (! gimp_viewable_get_children (list->data) &&
               ! gimp_item_is_text_layer (list->data))
             {
-              gimp_object_queue_push (queue, list->data);
+              drawables = g_list_prepend (drawables, list->data);
             }
         }
 
       g_list_free (layers);
 
-      while ((drawable = gimp_object_queue_pop (queue)))
-        {
-          gimp_drawable_apply_operation (drawable, sub_progress,
-                                         _("Dithering"),
-                                         dither);
-        }
+      drawables = g_list_reverse (drawables);
 
-      g_object_unref (queue);
+      gimp_drawables_apply_operation (drawables, progress,
+                                      _("Dithering"),
+                                      dither, NULL);
 
-      if (progress)
-        gimp_progress_end (progress);
+      g_list_free (drawables);
 
       g_object_unref (dither);
     }
@@ -0,0 +1,218 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpimage-memory.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <gegl.h>
+
+#include "core-types.h"
+
+#include "config/gimpcoreconfig.h"
+
+#include "gimp.h"
+#include "gimpimage.h"
+#include "gimpimage-memory.h"
+#include "gimpimage-undo.h"
+#include "gimpprojection.h"
+#include "gimpundostack.h"
+
+
+/*  local function prototypes  */
+
+static gint64   gimp_image_memory_measure        (GimpImage *image);
+static void     gimp_image_memory_drop_previews  (GimpImage *image);
+
+
+/*  local variables  */
+
+/*  the last measured memory use of each image, for the dashboard,
+ *  which samples it from another thread
+ */
+static GHashTable *image_memsizes = NULL;
+
+G_LOCK_DEFINE_STATIC (image_memsizes);
+
+
+/*  public functions  */
+
+/*  measures the memory used by 'image', and if it's over the
+ *  image-memory-budget limit, frees memory of the image, in order:
+ *
+ *    - its undo history, down to the minimal number of undo levels;
+ *    - its cached previews, and the projection's buffer and mipmap
+ *      levels, if the image isn't displayed;
+ *    - and lastly, moves the pixels of the remaining undo steps to the
+ *      swap.
+ *
+ *  the image's own layers and channels are never touched.
+ */
+void
+gimp_image_memory_enforce_budget (GimpImage *image)
+{
+  gint64 budget;
+  gint64 memsize;
+
+  g_return_if_fail (GIMP_IS_IMAGE (image));
+
+  budget  = image->gimp->config->image_memory_budget;
+  memsize = gimp_image_memory_measure (image);
+
+  if (budget == 0 || memsize <= budget)
+    return;
+
+  {
+    gint64 undo_memsize;
+
+    undo_memsize =
+      gimp_undo_stack_get_undos_size (gimp_image_get_undo_stack (image)) +
+      gimp_undo_stack_get_undos_size (gimp_image_get_redo_stack (image));
+
+    gimp_image_undo_trim (image,
+                          MAX (undo_memsize - (memsize - budget), 0));
+
+    memsize = gimp_image_memory_measure (image);
+  }
+
+  if (memsize > budget)
+    {
+      gimp_image_memory_drop_previews (image);
+
+      memsize = gimp_image_memory_measure (image);
+    }
+
+  if (memsize > budget)
+    {
+      gimp_image_undo_swap_out_all (image);
+
+      gimp_image_memory_measure (image);
+    }
+}
+
+void
+gimp_image_memory_forget (GimpImage *image)
+{
+  g_return_if_fail (GIMP_IS_IMAGE (image));
+
+  G_LOCK (image_memsizes);
+
+  if (image_memsizes)
+    g_hash_table_remove (image_memsizes, image);
+
+  G_UNLOCK (image_memsizes);
+}
+
+guint64
+gimp_image_memory_get_total (void)
+{
+  guint64 total = 0;
+
+  G_LOCK (image_memsizes);
+
+  if (image_memsizes)
+    {
+      GHashTableIter iter;
+      gpointer       value;
+
+      g_hash_table_iter_init (&iter, image_memsizes);
+
+      while (g_hash_table_iter_next (&iter, NULL, &value))
+        total += *(gint64 *) value;
+    }
+
+  G_UNLOCK (image_memsizes);
+
+  return total;
+}
+
+guint64
+gimp_image_memory_get_max (void)
+{
+  guint64 max = 0;
+
+  G_LOCK (image_memsizes);
+
+  if (image_memsizes)
+    {
+      GHashTableIter iter;
+      gpointer       value;
+
+      g_hash_table_iter_init (&iter, image_memsizes);
+
+      while (g_hash_table_iter_next (&iter, NULL, &value))
+        max = MAX (max, *(gint64 *) value);
+    }
+
+  G_UNLOCK (image_memsizes);
+
+  return max;
+}
+
+
+/*  private functions  */
+
+static gint64
+gimp_image_memory_measure (GimpImage *image)
+{
+  gint64  memsize = gimp_object_get_memsize (GIMP_OBJECT (image), NULL);
+  gint64 *value;
+
+  G_LOCK (image_memsizes);
+
+  if (! image_memsizes)
+    image_memsizes = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+  value = g_hash_table_lookup (image_memsizes, image);
+
+  if (! value)
+    {
+      value = g_new (gint64, 1);
+
+      g_hash_table_insert (image_memsizes, image, value);
+    }
+
+  *value = memsize;
+
+  G_UNLOCK (image_memsizes);
+
+  return memsize;
+}
+
+static void
+gimp_image_memory_drop_previews (GimpImage *image)
+{
+  GList *items;
+  GList *list;
+
+  gimp_viewable_invalidate_preview (GIMP_VIEWABLE (image));
+
+  items = g_list_concat (gimp_image_get_layer_list (image),
+                         gimp_image_get_channel_list (image));
+
+  for (list = items; list; list = g_list_next (list))
+    gimp_viewable_invalidate_preview (list->data);
+
+  g_list_free (items);
+
+  /*  the projection is only a cache of the layers, and is rendered
+   *  again on demand, but is needed by the image's displays
+   */
+  if (gimp_image_get_display_count (image) == 0)
+    gimp_projection_release_buffer (gimp_image_get_projection (image));
+}
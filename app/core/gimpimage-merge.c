@@ -40,9 +40,12 @@
 #include "gimperror.h"
 #include "gimpgrouplayer.h"
 #include "gimpimage.h"
+#include "gimpimage-color-profile.h"
+#include "gimpimage-colormap.h"
 #include "gimpimage-merge.h"
 #include "gimpimage-undo.h"
 #include "gimpitemstack.h"
+#include "gimpitemtree.h"
 #include "gimplayer-floating-selection.h"
 #include "gimplayer-new.h"
 #include "gimplayermask.h"
@@ -267,6 +270,138 @@ gimp_image_flatten (GimpImage     *image,
   return NULL;
 }
 
+/*  renders the flattened image into a new image with a single layer,
+ *  without touching the image, and without allocating its projection.
+ *  the layer graph is rendered in chunks, and the tiles of the result
+ *  move to GEGL's swap as they leave the tile cache, so this works for
+ *  images larger than the available memory.  saving the new image as
+ *  XCF then writes the layer tile by tile as well.
+ */
+GimpImage *
+gimp_image_flatten_to_image (GimpImage     *image,
+                             GimpContext   *context,
+                             GimpProgress  *progress,
+                             GError       **error)
+{
+  GimpImage  *new_image;
+  GimpLayer  *new_layer;
+  GList      *list;
+  GimpLayer  *bottom_layer = NULL;
+  GeglNode   *graph;
+  GeglNode   *layers_node;
+  GeglNode   *flatten_node;
+  GeglBuffer *buffer;
+  const Babl *format;
+  gdouble     xres;
+  gdouble     yres;
+  gboolean    success;
+
+  g_return_val_if_fail (GIMP_IS_IMAGE (image), NULL);
+  g_return_val_if_fail (GIMP_IS_CONTEXT (context), NULL);
+  g_return_val_if_fail (progress == NULL || GIMP_IS_PROGRESS (progress), NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  for (list = gimp_image_get_layer_iter (image);
+       list;
+       list = g_list_next (list))
+    {
+      GimpLayer *layer = list->data;
+
+      if (! gimp_layer_is_floating_sel (layer) &&
+          gimp_item_get_visible (GIMP_ITEM (layer)))
+        {
+          bottom_layer = layer;
+        }
+    }
+
+  if (! bottom_layer)
+    {
+      g_set_error_literal (error, GIMP_ERROR, GIMP_FAILED,
+                           _("Cannot flatten an image without any visible layer."));
+      return NULL;
+    }
+
+  /*  make sure the image's graph is constructed, so that the layer stack
+   *  has a parent node
+   */
+  graph       = gimp_projectable_get_graph (GIMP_PROJECTABLE (image));
+  layers_node = gimp_filter_stack_get_graph (
+                  GIMP_FILTER_STACK (gimp_image_get_layers (image)));
+
+  flatten_node = gimp_gegl_create_flatten_node
+    (gimp_context_get_background (context),
+     gimp_layer_get_real_composite_space (bottom_layer));
+
+  gegl_node_add_child (graph, flatten_node);
+  g_object_unref (flatten_node);
+
+  gegl_node_link (layers_node, flatten_node);
+
+  format = gimp_image_get_layer_format (image, FALSE);
+
+  buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0,
+                                            gimp_image_get_width  (image),
+                                            gimp_image_get_height (image)),
+                            format);
+
+  success = gimp_gegl_apply_cached_operation (NULL, progress,
+                                              C_("undo-type", "Flatten Image"),
+                                              flatten_node, FALSE,
+                                              buffer, NULL, FALSE,
+                                              NULL, NULL, 0,
+                                              progress != NULL);
+
+  gegl_node_remove_child (graph, flatten_node);
+
+  if (! success)
+    {
+      g_object_unref (buffer);
+
+      g_set_error_literal (error, GIMP_ERROR, GIMP_FAILED,
+                           _("Flattening the image was canceled."));
+      return NULL;
+    }
+
+  new_image = gimp_create_image (image->gimp,
+                                 gimp_image_get_width  (image),
+                                 gimp_image_get_height (image),
+                                 gimp_image_get_base_type (image),
+                                 gimp_image_get_precision (image),
+                                 FALSE);
+
+  gimp_image_undo_disable (new_image);
+
+  gimp_image_get_resolution (image, &xres, &yres);
+  gimp_image_set_resolution (new_image, xres, yres);
+  gimp_image_set_unit (new_image, gimp_image_get_unit (image));
+
+  if (gimp_image_get_base_type (image) == GIMP_INDEXED)
+    gimp_image_set_colormap_palette (new_image,
+                                     gimp_image_get_colormap_palette (image),
+                                     FALSE);
+
+  gimp_image_set_color_profile (new_image,
+                                gimp_image_get_color_profile (image),
+                                NULL);
+
+  new_layer = gimp_layer_new (new_image,
+                              gimp_image_get_width  (image),
+                              gimp_image_get_height (image),
+                              format,
+                              gimp_object_get_name (bottom_layer),
+                              GIMP_OPACITY_OPAQUE,
+                              gimp_image_get_default_new_layer_mode (new_image));
+
+  gimp_drawable_set_buffer (GIMP_DRAWABLE (new_layer), FALSE, NULL, buffer);
+  g_object_unref (buffer);
+
+  gimp_image_add_layer (new_image, new_layer, NULL, 0, FALSE);
+
+  gimp_image_undo_enable (new_image);
+
+  return new_image;
+}
+
 GList *
 gimp_image_merge_down (GimpImage      *image,
                        GList          *layers,
@@ -911,6 +1046,9 @@ gimp_image_merge_layers (GimpImage     *image,
   gimp_item_set_parasites (GIMP_ITEM (merge_layer), parasites);
   g_object_unref (parasites);
 
+  /*  batch removing the merged layers and adding the result  */
+  gimp_item_tree_freeze (gimp_image_get_layer_tree (image));
+
   for (layers = trimmed_list; layers; layers = g_slist_next (layers))
     {
       /* Remove the sisters below merged pass-through group layers. */
@@ -977,6 +1115,8 @@ gimp_image_merge_layers (GimpImage     *image,
                             TRUE);
     }
 
+  gimp_item_tree_thaw (gimp_image_get_layer_tree (image));
+
   gimp_drawable_update (GIMP_DRAWABLE (merge_layer), 0, 0, -1, -1);
   g_slist_free (trimmed_list);
 
@@ -37,6 +37,10 @@ GimpLayer   * gimp_image_flatten               (GimpImage      *image,
                                                 GimpContext    *context,
                                                 GimpProgress   *progress,
                                                 GError        **error);
+GimpImage   * gimp_image_flatten_to_image      (GimpImage      *image,
+                                                GimpContext    *context,
+                                                GimpProgress   *progress,
+                                                GError        **error);
 
 GimpPath    * gimp_image_merge_visible_paths   (GimpImage      *image,
                                                 GError        **error);
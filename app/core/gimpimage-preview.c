@@ -28,6 +28,8 @@
 #include "gegl/gimp-babl.h"
 #include "gegl/gimp-gegl-loops.h"
 
+#include "gimp-memory-tags.h"
+#include "gimp-preview-async.h"
 #include "gimpimage.h"
 #include "gimpimage-color-profile.h"
 #include "gimpimage-preview.h"
@@ -135,7 +137,9 @@ gimp_image_get_new_preview (GimpViewable *viewable,
 
   format = gimp_image_get_preview_format (image);
 
+  gimp_memory_tags_push (GIMP_MEMORY_TAG_PREVIEW, image);
   buf = gimp_temp_buf_new (width, height, format);
+  gimp_memory_tags_pop ();
 
   gegl_buffer_get (gimp_pickable_get_buffer (GIMP_PICKABLE (image)),
                    GEGL_RECTANGLE (0, 0, width, height),
@@ -212,3 +216,25 @@ gimp_image_get_new_pixbuf (GimpViewable *viewable,
 
   return pixbuf;
 }
+
+GimpAsync *
+gimp_image_get_preview_async (GimpImage *image,
+                              gint       width,
+                              gint       height)
+{
+  gdouble scale_x;
+  gdouble scale_y;
+
+  g_return_val_if_fail (GIMP_IS_IMAGE (image), NULL);
+  g_return_val_if_fail (width  > 0, NULL);
+  g_return_val_if_fail (height > 0, NULL);
+
+  scale_x = (gdouble) width  / (gdouble) gimp_image_get_width  (image);
+  scale_y = (gdouble) height / (gdouble) gimp_image_get_height (image);
+
+  return gimp_preview_async_new (
+    gimp_pickable_get_buffer (GIMP_PICKABLE (image)),
+    gimp_image_get_preview_format (image),
+    GEGL_RECTANGLE (0, 0, width, height),
+    MIN (scale_x, scale_y));
+}
@@ -20,6 +20,10 @@
 
 const Babl  * gimp_image_get_preview_format (GimpImage    *image);
 
+GimpAsync   * gimp_image_get_preview_async  (GimpImage    *image,
+                                             gint          width,
+                                             gint          height);
+
 
 /*
  *  virtual functions of GimpImage -- don't call directly
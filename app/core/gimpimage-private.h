@@ -58,6 +58,8 @@ struct _GimpImagePrivate
   GimpPalette       *palette;               /*  palette of colormap          */
   const Babl        *babl_palette_rgb;      /*  palette's RGB Babl format    */
   const Babl        *babl_palette_rgba;     /*  palette's RGBA Babl format   */
+  guint              colormap_used[8];      /*  bitmap of used color indices */
+  gboolean           colormap_used_valid;   /*  colormap_used is up to date  */
 
   GimpColorProfile  *color_profile;         /*  image's color profile        */
   const Babl        *layer_space;           /*  image's Babl layer space     */
@@ -84,7 +86,7 @@ struct _GimpImagePrivate
   GFile             *save_a_copy_file;      /*  the image's save-a-copy file */
   GFile             *untitled_file;         /*  a file saying "Untitled"     */
 
-  gboolean           xcf_compression;       /*  XCF compression enabled?     */
+  GimpXcfCompression xcf_compression;       /*  XCF tile compression         */
 
   gint               dirty;                 /*  dirty flag -- # of ops       */
   gint64             dirty_time;            /*  time when image became dirty */
@@ -144,6 +146,7 @@ struct _GimpImagePrivate
   GimpUndoStack     *redo_stack;            /*  stack for redo operations    */
   gint               group_count;           /*  nested undo groups           */
   GimpUndoType       pushing_undo_group;    /*  undo group status flag       */
+  gint64             last_undo_push_time;   /*  for coalescing undo steps    */
 
   /*  Signal emission accumulator  */
   GimpImageFlushAccumulator  flush_accum;
@@ -20,9 +20,18 @@
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gegl.h>
 
+#include "libgimpmath/gimpmath.h"
+
 #include "core-types.h"
 
+#include "config/gimpgeglconfig.h"
+
+#include "gegl/gimp-gegl-apply-operation.h"
+
 #include "gimp.h"
+#include "gimp-parallel.h"
+#include "gimpasync.h"
+#include "gimpchannel.h"
 #include "gimpcontainer.h"
 #include "gimpguide.h"
 #include "gimpgrouplayer.h"
@@ -33,15 +42,64 @@
 #include "gimpimage-undo.h"
 #include "gimpimage-undo-push.h"
 #include "gimplayer.h"
+#include "gimplayermask.h"
 #include "gimpobjectqueue.h"
 #include "gimpprogress.h"
 #include "gimpprojection.h"
 #include "gimpsamplepoint.h"
+#include "gimpwaitable.h"
 
 #include "gimp-log.h"
 #include "gimp-intl.h"
 
 
+typedef struct _ScaleJob  ScaleJob;
+typedef struct _ScaleJobs ScaleJobs;
+
+struct _ScaleJob
+{
+  GimpDrawable          *drawable;
+  GeglBuffer            *src_buffer;
+  GeglBuffer            *dest_buffer;
+  GimpInterpolationType  interpolation_type;
+  gdouble                x_factor;
+  gdouble                y_factor;
+  gint64                 memsize;
+  GimpAsync             *async;
+};
+
+struct _ScaleJobs
+{
+  GHashTable *jobs;
+  GQueue      pending;
+  gint64      max_memsize;
+  gint64      running_memsize;
+  gint        n_running;
+};
+
+
+static void   gimp_image_scale_jobs_init  (ScaleJobs             *jobs,
+                                           GimpImage             *image,
+                                           gdouble                w_factor,
+                                           gdouble                h_factor,
+                                           GimpInterpolationType  interpolation_type);
+static void   gimp_image_scale_jobs_add   (ScaleJobs             *jobs,
+                                           GimpDrawable          *drawable,
+                                           gint                   new_width,
+                                           gint                   new_height,
+                                           GimpInterpolationType  interpolation_type);
+static void   gimp_image_scale_jobs_start (ScaleJobs             *jobs);
+static void   gimp_image_scale_jobs_take  (ScaleJobs             *jobs,
+                                           GimpItem              *item);
+static void   gimp_image_scale_jobs_clear (ScaleJobs             *jobs);
+
+static void   gimp_image_scale_job_run    (GimpAsync             *async,
+                                           ScaleJob              *job);
+static void   gimp_image_scale_job_free   (ScaleJob              *job);
+
+
+/*  public functions  */
+
 void
 gimp_image_scale (GimpImage             *image,
                   gint                   new_width,
@@ -50,6 +108,7 @@ gimp_image_scale (GimpImage             *image,
                   GimpProgress          *progress)
 {
   GimpObjectQueue *queue;
+  ScaleJobs        jobs;
   GimpItem        *item;
   GList           *list;
   gint             old_width;
@@ -103,9 +162,18 @@ gimp_image_scale (GimpImage             *image,
                 "height", new_height,
                 NULL);
 
+  /*  Scale the pixels of plain layers, their masks and channels on
+   *  the thread pool, a few at a time, while the items are scaled
+   *  below in order, each one picking up its buffer when it is ready
+   */
+  gimp_image_scale_jobs_init (&jobs, image, img_scale_w, img_scale_h,
+                              interpolation_type);
+
   /*  Scale all layers, channels (including selection mask), and paths  */
   while ((item = gimp_object_queue_pop (queue)))
     {
+      gimp_image_scale_jobs_take (&jobs, item);
+
       if (! gimp_item_scale_by_factors (item,
                                         img_scale_w, img_scale_h,
                                         interpolation_type, progress))
@@ -120,6 +188,8 @@ gimp_image_scale (GimpImage             *image,
         }
     }
 
+  gimp_image_scale_jobs_clear (&jobs);
+
   /*  Scale all Guides  */
   for (list = gimp_image_get_guides (image);
        list;
@@ -258,3 +328,245 @@ gimp_image_scale_check (GimpImage *image,
 
   return GIMP_IMAGE_SCALE_OK;
 }
+
+
+/*  private functions  */
+
+static void
+gimp_image_scale_jobs_init (ScaleJobs             *jobs,
+                            GimpImage             *image,
+                            gdouble                w_factor,
+                            gdouble                h_factor,
+                            GimpInterpolationType  interpolation_type)
+{
+  GimpGeglConfig *config = GIMP_GEGL_CONFIG (image->gimp->config);
+  GList          *list;
+
+  jobs->jobs = g_hash_table_new_full (NULL, NULL, NULL,
+                                      (GDestroyNotify) gimp_image_scale_job_free);
+  g_queue_init (&jobs->pending);
+
+  /*  keep the scaled buffers waiting to be picked up within half of
+   *  the tile cache, so they don't get swapped out in the meantime
+   */
+  jobs->max_memsize     = config->tile_cache_size / 2;
+  jobs->running_memsize = 0;
+  jobs->n_running       = 0;
+
+  /*  only items whose scale ends up in gimp_drawable_scale() are
+   *  scaled ahead of time; group, text, vector and link layers, and
+   *  the selection, are scaled in order as before
+   */
+  for (list = gimp_image_get_layer_iter (image);
+       list;
+       list = g_list_next (list))
+    {
+      GimpItem  *item  = list->data;
+      GimpLayer *layer = list->data;
+      gint       new_offset_x;
+      gint       new_offset_y;
+      gint       new_width;
+      gint       new_height;
+
+      if (G_TYPE_FROM_INSTANCE (item) != GIMP_TYPE_LAYER)
+        continue;
+
+      /*  same as gimp_item_scale_by_factors()  */
+      new_offset_x = SIGNED_ROUND (w_factor * gimp_item_get_offset_x (item));
+      new_offset_y = SIGNED_ROUND (h_factor * gimp_item_get_offset_y (item));
+      new_width    = SIGNED_ROUND (w_factor * (gimp_item_get_offset_x (item) +
+                                               gimp_item_get_width (item))) -
+                     new_offset_x;
+      new_height   = SIGNED_ROUND (h_factor * (gimp_item_get_offset_y (item) +
+                                               gimp_item_get_height (item))) -
+                     new_offset_y;
+
+      if (new_width <= 0 || new_height <= 0)
+        continue;
+
+      gimp_image_scale_jobs_add (jobs, GIMP_DRAWABLE (layer),
+                                 new_width, new_height, interpolation_type);
+
+      if (layer->mask &&
+          G_TYPE_FROM_INSTANCE (layer->mask) == GIMP_TYPE_LAYER_MASK)
+        {
+          gimp_image_scale_jobs_add (jobs, GIMP_DRAWABLE (layer->mask),
+                                     new_width, new_height,
+                                     interpolation_type);
+        }
+    }
+
+  for (list = gimp_image_get_channel_iter (image);
+       list;
+       list = g_list_next (list))
+    {
+      GimpItem    *item    = list->data;
+      GimpChannel *channel = list->data;
+
+      if (G_TYPE_FROM_INSTANCE (item) != GIMP_TYPE_CHANNEL)
+        continue;
+
+      /*  gimp_channel_scale() doesn't scale these at all  */
+      if (channel->bounds_known && (channel->empty || channel->full))
+        continue;
+
+      gimp_image_scale_jobs_add (jobs, GIMP_DRAWABLE (channel),
+                                 gimp_image_get_width  (image),
+                                 gimp_image_get_height (image),
+                                 interpolation_type);
+    }
+
+  gimp_image_scale_jobs_start (jobs);
+}
+
+static void
+gimp_image_scale_jobs_add (ScaleJobs             *jobs,
+                           GimpDrawable          *drawable,
+                           gint                   new_width,
+                           gint                   new_height,
+                           GimpInterpolationType  interpolation_type)
+{
+  GimpItem   *item   = GIMP_ITEM (drawable);
+  const Babl *format = gimp_drawable_get_format (drawable);
+  ScaleJob   *job;
+
+  job = g_slice_new0 (ScaleJob);
+
+  job->drawable           = drawable;
+  job->src_buffer         = g_object_ref (gimp_drawable_get_buffer (drawable));
+  job->dest_buffer        = gegl_buffer_new (GEGL_RECTANGLE (0, 0,
+                                                             new_width,
+                                                             new_height),
+                                             format);
+  job->interpolation_type = interpolation_type;
+  job->x_factor           = (gdouble) new_width  / gimp_item_get_width  (item);
+  job->y_factor           = (gdouble) new_height / gimp_item_get_height (item);
+  job->memsize            = (gint64) babl_format_get_bytes_per_pixel (format) *
+                            new_width * new_height;
+
+  g_hash_table_insert (jobs->jobs, drawable, job);
+  g_queue_push_tail (&jobs->pending, job);
+}
+
+static void
+gimp_image_scale_jobs_start (ScaleJobs *jobs)
+{
+  ScaleJob *job;
+
+  /*  always keep at least one job running, however big  */
+  while ((job = g_queue_peek_head (&jobs->pending)) &&
+         (jobs->n_running == 0 ||
+          jobs->running_memsize + job->memsize <= jobs->max_memsize))
+    {
+      g_queue_pop_head (&jobs->pending);
+
+      /*  each job scales its own buffers, so the jobs can run side by
+       *  side
+       */
+      job->async = gimp_parallel_run_async_concurrent_labeled_full (
+        NULL, 0,
+        (GimpRunAsyncFunc) gimp_image_scale_job_run,
+        job, NULL);
+
+      jobs->running_memsize += job->memsize;
+      jobs->n_running++;
+    }
+}
+
+static void
+gimp_image_scale_jobs_take (ScaleJobs *jobs,
+                            GimpItem  *item)
+{
+  GimpDrawable *drawables[2] = { NULL, };
+  gint          i;
+
+  if (! GIMP_IS_DRAWABLE (item))
+    return;
+
+  drawables[0] = GIMP_DRAWABLE (item);
+
+  if (GIMP_IS_LAYER (item))
+    drawables[1] = GIMP_DRAWABLE (gimp_layer_get_mask (GIMP_LAYER (item)));
+
+  for (i = 0; i < G_N_ELEMENTS (drawables) && drawables[i]; i++)
+    {
+      ScaleJob *job = g_hash_table_lookup (jobs->jobs, drawables[i]);
+
+      if (! job)
+        continue;
+
+      if (job->async)
+        {
+          gimp_waitable_wait (GIMP_WAITABLE (job->async));
+
+          if (gimp_async_is_finished (job->async))
+            {
+              gimp_drawable_set_scaled_buffer (job->drawable,
+                                               job->src_buffer,
+                                               job->dest_buffer,
+                                               job->interpolation_type);
+            }
+
+          jobs->running_memsize -= job->memsize;
+          jobs->n_running--;
+        }
+      else
+        {
+          g_queue_remove (&jobs->pending, job);
+        }
+
+      g_hash_table_remove (jobs->jobs, drawables[i]);
+    }
+
+  /*  get the next jobs going while this item is being scaled  */
+  gimp_image_scale_jobs_start (jobs);
+}
+
+static void
+gimp_image_scale_jobs_clear (ScaleJobs *jobs)
+{
+  GHashTableIter  iter;
+  ScaleJob       *job;
+
+  g_queue_clear (&jobs->pending);
+
+  g_hash_table_iter_init (&iter, jobs->jobs);
+
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &job))
+    {
+      if (job->async)
+        gimp_async_cancel_and_wait (job->async);
+    }
+
+  g_clear_pointer (&jobs->jobs, g_hash_table_unref);
+}
+
+static void
+gimp_image_scale_job_run (GimpAsync *async,
+                          ScaleJob  *job)
+{
+  if (gimp_async_is_canceled (async))
+    {
+      gimp_async_abort (async);
+
+      return;
+    }
+
+  gimp_gegl_apply_scale (job->src_buffer, NULL, NULL,
+                         job->dest_buffer,
+                         job->interpolation_type,
+                         job->x_factor,
+                         job->y_factor);
+
+  gimp_async_finish (async, NULL);
+}
+
+static void
+gimp_image_scale_job_free (ScaleJob *job)
+{
+  g_clear_object (&job->async);
+  g_object_unref (job->src_buffer);
+  g_object_unref (job->dest_buffer);
+
+  g_slice_free (ScaleJob, job);
+}
@@ -33,17 +33,54 @@
 #include "gimpimage-guides.h"
 #include "gimpimage-snap.h"
 
+#include "path/gimpanchor.h"
 #include "path/gimppath.h"
 #include "path/gimpstroke.h"
 
 #include "gimp-intl.h"
 
 
-static gboolean  gimp_image_snap_distance (const gdouble  unsnapped,
-                                           const gdouble  nearest,
-                                           const gdouble  epsilon,
-                                           gdouble       *mindist,
-                                           gdouble       *target);
+#define SNAP_GUIDES_KEY "gimp-image-snap-guides"
+
+
+/*  the positions of the image's guides, sorted, so that the nearest
+ *  guide can be found by binary search.  rebuilt after any guide is
+ *  added, removed or moved.
+ */
+typedef struct
+{
+  GArray   *positions[2]; /*  indexed by GimpOrientationType  */
+  gboolean  valid;
+} SnapGuides;
+
+
+static gboolean     gimp_image_snap_distance          (const gdouble        unsnapped,
+                                                       const gdouble        nearest,
+                                                       const gdouble        epsilon,
+                                                       gdouble             *mindist,
+                                                       gdouble             *target);
+
+static gboolean     gimp_image_snap_guides            (GimpImage           *image,
+                                                       GimpOrientationType  orientation,
+                                                       const gdouble        unsnapped,
+                                                       const gdouble        epsilon,
+                                                       gdouble             *mindist,
+                                                       gdouble             *target);
+static SnapGuides * gimp_image_snap_guides_get        (GimpImage           *image);
+static void         gimp_image_snap_guides_free       (SnapGuides          *guides);
+static void         gimp_image_snap_guides_invalidate (GimpImage           *image);
+static void         gimp_image_snap_guide_added       (GimpImage           *image,
+                                                       GimpGuide           *guide);
+static gint         gimp_image_snap_position_compare  (const gint          *position1,
+                                                       const gint          *position2);
+
+static gboolean     gimp_image_snap_stroke_is_near    (GimpStroke          *stroke,
+                                                       gdouble              x1,
+                                                       gdouble              y1,
+                                                       gdouble              x2,
+                                                       gdouble              y2,
+                                                       gdouble              epsilon_x,
+                                                       gdouble              epsilon_y);
 
 
 
@@ -82,23 +119,9 @@ gimp_image_snap_x (GimpImage         *image,
 
   if (snap_to_guides)
     {
-      GList *list;
-
-      for (list = gimp_image_get_guides (image); list; list = g_list_next (list))
-        {
-          GimpGuide *guide    = list->data;
-          gint       position = gimp_guide_get_position (guide);
-
-          if (gimp_guide_is_custom (guide))
-            continue;
-
-          if (gimp_guide_get_orientation (guide) == GIMP_ORIENTATION_VERTICAL)
-            {
-              snapped |= gimp_image_snap_distance (x, position,
-                                                   epsilon_x,
-                                                   &mindist, tx);
-            }
-        }
+      snapped |= gimp_image_snap_guides (image, GIMP_ORIENTATION_VERTICAL,
+                                         x, epsilon_x,
+                                         &mindist, tx);
     }
 
   if (snap_to_grid)
@@ -351,23 +374,9 @@ gimp_image_snap_y (GimpImage         *image,
 
   if (snap_to_guides)
     {
-      GList *list;
-
-      for (list = gimp_image_get_guides (image); list; list = g_list_next (list))
-        {
-          GimpGuide *guide    = list->data;
-          gint       position = gimp_guide_get_position (guide);
-
-          if (gimp_guide_is_custom (guide))
-            continue;
-
-          if (gimp_guide_get_orientation (guide) == GIMP_ORIENTATION_HORIZONTAL)
-            {
-              snapped |= gimp_image_snap_distance (y, position,
-                                                   epsilon_y,
-                                                   &mindist, ty);
-            }
-        }
+      snapped |= gimp_image_snap_guides (image, GIMP_ORIENTATION_HORIZONTAL,
+                                         y, epsilon_y,
+                                         &mindist, ty);
     }
 
   if (snap_to_grid)
@@ -637,34 +646,12 @@ gimp_image_snap_point (GimpImage *image,
 
   if (snap_to_guides)
     {
-      GList *list;
-
-      for (list = gimp_image_get_guides (image); list; list = g_list_next (list))
-        {
-          GimpGuide *guide    = list->data;
-          gint       position = gimp_guide_get_position (guide);
-
-          if (gimp_guide_is_custom (guide))
-            continue;
-
-          switch (gimp_guide_get_orientation (guide))
-            {
-            case GIMP_ORIENTATION_HORIZONTAL:
-              snapped |= gimp_image_snap_distance (y, position,
-                                                   epsilon_y,
-                                                   &mindist_y, ty);
-              break;
-
-            case GIMP_ORIENTATION_VERTICAL:
-              snapped |= gimp_image_snap_distance (x, position,
-                                                   epsilon_x,
-                                                   &mindist_x, tx);
-              break;
-
-            default:
-              break;
-            }
-        }
+      snapped |= gimp_image_snap_guides (image, GIMP_ORIENTATION_HORIZONTAL,
+                                         y, epsilon_y,
+                                         &mindist_y, ty);
+      snapped |= gimp_image_snap_guides (image, GIMP_ORIENTATION_VERTICAL,
+                                         x, epsilon_x,
+                                         &mindist_x, tx);
     }
 
   if (snap_to_grid)
@@ -734,6 +721,10 @@ gimp_image_snap_point (GimpImage *image,
             {
               GimpCoords nearest;
 
+              if (! gimp_image_snap_stroke_is_near (stroke, x, y, x, y,
+                                                    epsilon_x, epsilon_y))
+                continue;
+
               if (gimp_stroke_nearest_point_get (stroke, &coords, 1.0,
                                                  &nearest,
                                                  NULL, NULL, NULL) >= 0)
@@ -984,6 +975,10 @@ gimp_image_snap_rectangle (GimpImage         *image,
               GimpCoords nearest;
               gdouble    dist;
 
+              if (! gimp_image_snap_stroke_is_near (stroke, x1, y1, x2, y2,
+                                                    epsilon_x, epsilon_y))
+                continue;
+
               /*  top edge  */
 
               coords1.x = x1;
@@ -1231,3 +1226,184 @@ gimp_image_snap_distance (const gdouble  unsnapped,
 
   return FALSE;
 }
+
+static gboolean
+gimp_image_snap_guides (GimpImage           *image,
+                        GimpOrientationType  orientation,
+                        const gdouble        unsnapped,
+                        const gdouble        epsilon,
+                        gdouble             *mindist,
+                        gdouble             *target)
+{
+  SnapGuides *guides    = gimp_image_snap_guides_get (image);
+  GArray     *positions = guides->positions[orientation];
+  gboolean    snapped   = FALSE;
+  gint        lo        = 0;
+  gint        hi        = positions->len;
+
+  /*  find the first position not below 'unsnapped', only it and the
+   *  one before it can be the nearest
+   */
+  while (lo < hi)
+    {
+      gint mid = (lo + hi) / 2;
+
+      if (g_array_index (positions, gint, mid) < unsnapped)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  if (lo > 0)
+    snapped |= gimp_image_snap_distance (unsnapped,
+                                         g_array_index (positions, gint,
+                                                        lo - 1),
+                                         epsilon, mindist, target);
+
+  if (lo < positions->len)
+    snapped |= gimp_image_snap_distance (unsnapped,
+                                         g_array_index (positions, gint, lo),
+                                         epsilon, mindist, target);
+
+  return snapped;
+}
+
+static SnapGuides *
+gimp_image_snap_guides_get (GimpImage *image)
+{
+  SnapGuides *guides = g_object_get_data (G_OBJECT (image), SNAP_GUIDES_KEY);
+  GList      *list;
+
+  if (! guides)
+    {
+      guides = g_slice_new0 (SnapGuides);
+
+      guides->positions[GIMP_ORIENTATION_HORIZONTAL] =
+        g_array_new (FALSE, FALSE, sizeof (gint));
+      guides->positions[GIMP_ORIENTATION_VERTICAL] =
+        g_array_new (FALSE, FALSE, sizeof (gint));
+
+      g_object_set_data_full (G_OBJECT (image), SNAP_GUIDES_KEY, guides,
+                              (GDestroyNotify) gimp_image_snap_guides_free);
+
+      g_signal_connect (image, "guide-added",
+                        G_CALLBACK (gimp_image_snap_guide_added),
+                        NULL);
+      g_signal_connect (image, "guide-removed",
+                        G_CALLBACK (gimp_image_snap_guides_invalidate),
+                        NULL);
+
+      for (list = gimp_image_get_guides (image); list; list = g_list_next (list))
+        gimp_image_snap_guide_added (image, list->data);
+    }
+
+  if (! guides->valid)
+    {
+      g_array_set_size (guides->positions[GIMP_ORIENTATION_HORIZONTAL], 0);
+      g_array_set_size (guides->positions[GIMP_ORIENTATION_VERTICAL],   0);
+
+      for (list = gimp_image_get_guides (image); list; list = g_list_next (list))
+        {
+          GimpGuide           *guide       = list->data;
+          GimpOrientationType  orientation = gimp_guide_get_orientation (guide);
+          gint                 position    = gimp_guide_get_position (guide);
+
+          if (gimp_guide_is_custom (guide))
+            continue;
+
+          if (orientation == GIMP_ORIENTATION_HORIZONTAL ||
+              orientation == GIMP_ORIENTATION_VERTICAL)
+            {
+              g_array_append_val (guides->positions[orientation], position);
+            }
+        }
+
+      g_array_sort (guides->positions[GIMP_ORIENTATION_HORIZONTAL],
+                    (GCompareFunc) gimp_image_snap_position_compare);
+      g_array_sort (guides->positions[GIMP_ORIENTATION_VERTICAL],
+                    (GCompareFunc) gimp_image_snap_position_compare);
+
+      guides->valid = TRUE;
+    }
+
+  return guides;
+}
+
+static void
+gimp_image_snap_guides_free (SnapGuides *guides)
+{
+  g_array_free (guides->positions[GIMP_ORIENTATION_HORIZONTAL], TRUE);
+  g_array_free (guides->positions[GIMP_ORIENTATION_VERTICAL],   TRUE);
+
+  g_slice_free (SnapGuides, guides);
+}
+
+static void
+gimp_image_snap_guides_invalidate (GimpImage *image)
+{
+  SnapGuides *guides = g_object_get_data (G_OBJECT (image), SNAP_GUIDES_KEY);
+
+  if (guides)
+    guides->valid = FALSE;
+}
+
+static void
+gimp_image_snap_guide_added (GimpImage *image,
+                             GimpGuide *guide)
+{
+  gimp_image_snap_guides_invalidate (image);
+
+  /*  guides are also moved by undo and image transforms, without
+   *  "guide-moved", so watch their position.  the handlers go away with
+   *  the image, and are not connected twice when a guide comes back.
+   */
+  g_signal_handlers_disconnect_by_func (guide,
+                                        gimp_image_snap_guides_invalidate,
+                                        image);
+  g_signal_connect_object (guide, "notify::position",
+                           G_CALLBACK (gimp_image_snap_guides_invalidate),
+                           image, G_CONNECT_SWAPPED);
+  g_signal_connect_object (guide, "notify::orientation",
+                           G_CALLBACK (gimp_image_snap_guides_invalidate),
+                           image, G_CONNECT_SWAPPED);
+}
+
+static gint
+gimp_image_snap_position_compare (const gint *position1,
+                                  const gint *position2)
+{
+  return (*position1 > *position2) - (*position1 < *position2);
+}
+
+/*  whether anything on 'stroke' can be close enough to snap to any of
+ *  x1..x2 or y1..y2.  bezier curves stay within the bounds of their
+ *  control points, so this doesn't need to interpolate the stroke.
+ */
+static gboolean
+gimp_image_snap_stroke_is_near (GimpStroke *stroke,
+                                gdouble     x1,
+                                gdouble     y1,
+                                gdouble     x2,
+                                gdouble     y2,
+                                gdouble     epsilon_x,
+                                gdouble     epsilon_y)
+{
+  gdouble  sx1 =  G_MAXDOUBLE;
+  gdouble  sy1 =  G_MAXDOUBLE;
+  gdouble  sx2 = -G_MAXDOUBLE;
+  gdouble  sy2 = -G_MAXDOUBLE;
+  GList   *list;
+
+  for (list = stroke->anchors->head; list; list = g_list_next (list))
+    {
+      GimpAnchor *anchor = list->data;
+
+      sx1 = MIN (sx1, anchor->position.x);
+      sy1 = MIN (sy1, anchor->position.y);
+      sx2 = MAX (sx2, anchor->position.x);
+      sy2 = MAX (sy2, anchor->position.y);
+    }
+
+  return ((sx2 > x1 - epsilon_x && sx1 < x2 + epsilon_x) ||
+          (sy2 > y1 - epsilon_y && sy1 < y2 + epsilon_y));
+}
@@ -17,6 +17,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gegl.h>
 
@@ -25,15 +27,24 @@
 #include "config/gimpcoreconfig.h"
 
 #include "gimp.h"
+#include "gimp-memory-tags.h"
 #include "gimp-utils.h"
 #include "gimpimage.h"
+#include "gimpimage-memory.h"
 #include "gimpimage-private.h"
 #include "gimpimage-undo.h"
 #include "gimpitem.h"
+#include "gimpitemundo.h"
 #include "gimplist.h"
 #include "gimpundostack.h"
 
 
+/*  consecutive pushes of a coalescing undo type, for the same item,
+ *  less than this apart, are merged into the first undo step
+ */
+#define UNDO_COALESCE_INTERVAL (G_TIME_SPAN_SECOND / 2)
+
+
 /*  local function prototypes  */
 
 static void          gimp_image_undo_pop_stack       (GimpImage     *image,
@@ -41,7 +52,14 @@ static void          gimp_image_undo_pop_stack       (GimpImage     *image,
                                                       GimpUndoStack *redo_stack,
                                                       GimpUndoMode   undo_mode);
 static void          gimp_image_undo_free_space      (GimpImage     *image);
+static gboolean      gimp_image_undo_swap_out        (GimpImage     *image);
 static void          gimp_image_undo_free_redo       (GimpImage     *image);
+static GimpUndo    * gimp_image_undo_coalesce        (GimpImage     *image,
+                                                      GType          object_type,
+                                                      GimpUndoType   undo_type,
+                                                      gint           n_properties,
+                                                      gchar        **names,
+                                                      GValue        *values);
 
 static GimpDirtyMask gimp_image_undo_dirty_from_type (GimpUndoType   undo_type);
 
@@ -262,6 +280,130 @@ gimp_image_undo_free (GimpImage *image)
    */
 }
 
+/**
+ * gimp_image_undo_trim:
+ * @image:    a #GimpImage
+ * @max_size: the memory the undo history may use, in bytes
+ *
+ * Frees the redo history, and then the oldest undo steps, until the
+ * undo history uses at most @max_size bytes, or only the configured
+ * minimal number of undo levels is left.
+ **/
+void
+gimp_image_undo_trim (GimpImage *image,
+                      gint64     max_size)
+{
+  GimpImagePrivate *private;
+  GimpContainer    *container;
+  gint              min_undo_levels;
+
+  g_return_if_fail (GIMP_IS_IMAGE (image));
+
+  private = GIMP_IMAGE_GET_PRIVATE (image);
+
+  container       = private->undo_stack->undos;
+  min_undo_levels = image->gimp->config->levels_of_undo;
+
+  gimp_image_undo_free_redo (image);
+
+  while (gimp_container_get_n_children (container) > min_undo_levels &&
+         gimp_undo_stack_get_undos_size (private->undo_stack) > max_size)
+    {
+      GimpUndo *freed = gimp_undo_stack_free_bottom (private->undo_stack,
+                                                     GIMP_UNDO_MODE_UNDO);
+
+      gimp_image_undo_event (image, GIMP_UNDO_EVENT_UNDO_EXPIRED, freed);
+
+      g_object_unref (freed);
+    }
+}
+
+/**
+ * gimp_image_undo_swap_out_all:
+ * @image: a #GimpImage
+ *
+ * Moves the pixels of all of @image's undo steps to the swap,
+ * regardless of the undo-swap-size limit.
+ **/
+void
+gimp_image_undo_swap_out_all (GimpImage *image)
+{
+  GimpImagePrivate *private;
+  GList            *list;
+
+  g_return_if_fail (GIMP_IS_IMAGE (image));
+
+  private = GIMP_IMAGE_GET_PRIVATE (image);
+
+  for (list = GIMP_LIST (private->undo_stack->undos)->queue->head;
+       list;
+       list = g_list_next (list))
+    {
+      GimpUndo *undo = list->data;
+
+      if (! undo->swapped)
+        {
+          gimp_undo_swap_out (undo);
+
+          gimp_undo_stack_update_undo (private->undo_stack, undo);
+        }
+    }
+}
+
+/**
+ * gimp_image_undo_memsize_changed:
+ * @image: a #GimpImage
+ * @undo:  an undo of @image, possibly inside an undo group
+ *
+ * Updates the memory counted for @image's undo history after @undo's
+ * memory use changed by itself, for example because swapping it out
+ * failed, and its pixels are back in memory.
+ **/
+void
+gimp_image_undo_memsize_changed (GimpImage *image,
+                                 GimpUndo  *undo)
+{
+  GimpImagePrivate *private;
+  GimpUndoStack    *stacks[2];
+  gint              i;
+
+  g_return_if_fail (GIMP_IS_IMAGE (image));
+  g_return_if_fail (GIMP_IS_UNDO (undo));
+
+  private = GIMP_IMAGE_GET_PRIVATE (image);
+
+  stacks[0] = private->undo_stack;
+  stacks[1] = private->redo_stack;
+
+  for (i = 0; i < G_N_ELEMENTS (stacks); i++)
+    {
+      GList *list;
+
+      for (list = GIMP_LIST (stacks[i]->undos)->queue->head;
+           list;
+           list = g_list_next (list))
+        {
+          GimpUndo *step = list->data;
+
+          if (step == undo)
+            {
+              gimp_undo_stack_update_undo (stacks[i], undo);
+
+              return;
+            }
+          else if (GIMP_IS_UNDO_STACK (step) &&
+                   gimp_container_have (GIMP_UNDO_STACK (step)->undos,
+                                        GIMP_OBJECT (undo)))
+            {
+              gimp_undo_stack_update_undo (GIMP_UNDO_STACK (step), undo);
+              gimp_undo_stack_update_undo (stacks[i], step);
+
+              return;
+            }
+        }
+    }
+}
+
 gint
 gimp_image_get_undo_group_count (GimpImage *image)
 {
@@ -346,6 +488,7 @@ gimp_image_undo_group_end (GimpImage *image)
                              gimp_undo_stack_peek (private->undo_stack));
 
       gimp_image_undo_free_space (image);
+      gimp_image_memory_enforce_budget (image);
     }
 
   return TRUE;
@@ -372,14 +515,16 @@ gimp_image_undo_push (GimpImage     *image,
 
   private = GIMP_IMAGE_GET_PRIVATE (image);
 
-  /* Does this undo dirty the image?  If so, we always want to mark
-   * image dirty, even if we can't actually push the undo.
-   */
-  if (dirty_mask != GIMP_DIRTY_NONE)
-    gimp_image_dirty (image, dirty_mask);
-
   if (private->undo_freeze_count > 0)
-    return NULL;
+    {
+      /* Does this undo dirty the image?  If so, we always want to mark
+       * image dirty, even if we can't actually push the undo.
+       */
+      if (dirty_mask != GIMP_DIRTY_NONE)
+        gimp_image_dirty (image, dirty_mask);
+
+      return NULL;
+    }
 
   if (! name)
     name = gimp_undo_type_to_name (undo_type);
@@ -398,6 +543,24 @@ gimp_image_undo_push (GimpImage     *image,
                                          args);
   va_end (args);
 
+  /*  the merged undo step restores the state from before its first
+   *  push, so the image isn't dirtied again either
+   */
+  undo = gimp_image_undo_coalesce (image, object_type, undo_type,
+                                   n_properties, names, values);
+
+  if (undo)
+    {
+      gimp_properties_free (n_properties, names, values);
+
+      return undo;
+    }
+
+  if (dirty_mask != GIMP_DIRTY_NONE)
+    gimp_image_dirty (image, dirty_mask);
+
+  private->last_undo_push_time = g_get_monotonic_time ();
+
   undo = (GimpUndo *) g_object_new_with_properties (object_type,
                                                     n_properties,
                                                     (const gchar **) names,
@@ -405,6 +568,14 @@ gimp_image_undo_push (GimpImage     *image,
 
   gimp_properties_free (n_properties, names, values);
 
+  if (gimp_memory_tags_is_enabled ())
+    {
+      gimp_memory_tags_tag_object (G_OBJECT (undo), GIMP_MEMORY_TAG_UNDO,
+                                   image,
+                                   gimp_object_get_memsize (GIMP_OBJECT (undo),
+                                                            NULL));
+    }
+
   /*  nuke the redo stack  */
   gimp_image_undo_free_redo (image);
 
@@ -415,6 +586,7 @@ gimp_image_undo_push (GimpImage     *image,
       gimp_image_undo_event (image, GIMP_UNDO_EVENT_UNDO_PUSHED, undo);
 
       gimp_image_undo_free_space (image);
+      gimp_image_memory_enforce_budget (image);
 
       /*  freeing undo space may have freed the newly pushed undo  */
       if (gimp_undo_stack_peek (private->undo_stack) == undo)
@@ -428,6 +600,10 @@ gimp_image_undo_push (GimpImage     *image,
 
       gimp_undo_stack_push_undo (undo_group, undo);
 
+      /*  the group grows with each undo  */
+      gimp_undo_stack_update_undo (private->undo_stack,
+                                   GIMP_UNDO (undo_group));
+
       return undo;
     }
 
@@ -537,11 +713,23 @@ gimp_image_undo_free_space (GimpImage *image)
   if (gimp_container_get_n_children (container) <= min_undo_levels)
     return;
 
-  while ((gimp_object_get_memsize (GIMP_OBJECT (container), NULL) > undo_size) ||
+  while ((gimp_undo_stack_get_undos_size (private->undo_stack) > undo_size) ||
          (gimp_container_get_n_children (container) > max_undo_levels))
     {
-      GimpUndo *freed = gimp_undo_stack_free_bottom (private->undo_stack,
-                                                     GIMP_UNDO_MODE_UNDO);
+      GimpUndo *freed;
+
+      /*  rather than dropping the oldest step, move the pixels of the
+       *  oldest steps that are still in memory to the swap, as long as
+       *  they fit
+       */
+      if (gimp_container_get_n_children (container) <= max_undo_levels &&
+          gimp_image_undo_swap_out (image))
+        {
+          continue;
+        }
+
+      freed = gimp_undo_stack_free_bottom (private->undo_stack,
+                                           GIMP_UNDO_MODE_UNDO);
 
 #ifdef DEBUG_IMAGE_UNDO
       g_printerr ("freed one step: undo_steps: %d    undo_bytes: %ld\n",
@@ -559,6 +747,58 @@ gimp_image_undo_free_space (GimpImage *image)
     }
 }
 
+/*  swaps out the oldest undo step that isn't swapped out yet, and
+ *  returns TRUE if this freed any memory.  the swapped-out steps are
+ *  always the oldest ones, so they are dropped first once the swap
+ *  limit is reached.
+ */
+static gboolean
+gimp_image_undo_swap_out (GimpImage *image)
+{
+  GimpImagePrivate *private   = GIMP_IMAGE_GET_PRIVATE (image);
+  GimpContainer    *container = private->undo_stack->undos;
+  gint64            swap_size = 0;
+  gint64            max_swap_size;
+  GList            *list;
+
+  max_swap_size = image->gimp->config->undo_swap_size;
+
+  /*  the oldest steps are at the tail  */
+  for (list = GIMP_LIST (container)->queue->tail;
+       list;
+       list = g_list_previous (list))
+    {
+      GimpUndo *undo = list->data;
+
+      if (! undo->swapped)
+        {
+          if (swap_size + undo->memsize > max_swap_size)
+            {
+              return FALSE;
+            }
+
+          /*  steps without pixels swap out nothing, go on with the
+           *  next one
+           */
+          if (gimp_undo_swap_out (undo) > 0)
+            {
+              gimp_undo_stack_update_undo (private->undo_stack, undo);
+
+#ifdef DEBUG_IMAGE_UNDO
+              g_printerr ("swapped out one step: swap_bytes: %ld\n",
+                          (glong) (swap_size + undo->swap_size));
+#endif
+
+              return TRUE;
+            }
+        }
+
+      swap_size += undo->swap_size;
+    }
+
+  return FALSE;
+}
+
 static void
 gimp_image_undo_free_redo (GimpImage *image)
 {
@@ -605,6 +845,68 @@ gimp_image_undo_free_redo (GimpImage *image)
     }
 }
 
+/*  returns the undo step on top of the stack if a push of 'undo_type'
+ *  with the given properties can be merged into it, which is the case
+ *  for continuously changed item properties, such as the opacity set
+ *  by dragging a slider
+ */
+static GimpUndo *
+gimp_image_undo_coalesce (GimpImage     *image,
+                          GType          object_type,
+                          GimpUndoType   undo_type,
+                          gint           n_properties,
+                          gchar        **names,
+                          GValue        *values)
+{
+  GimpImagePrivate *private = GIMP_IMAGE_GET_PRIVATE (image);
+  GimpUndo         *undo;
+  GimpItem         *item    = NULL;
+  gint64            now;
+  gint              i;
+
+  switch (undo_type)
+    {
+    case GIMP_UNDO_ITEM_DISPLACE:
+    case GIMP_UNDO_LAYER_OPACITY:
+    case GIMP_UNDO_CHANNEL_COLOR:
+      break;
+
+    default:
+      return NULL;
+    }
+
+  if (private->pushing_undo_group != GIMP_UNDO_GROUP_NONE)
+    return NULL;
+
+  now = g_get_monotonic_time ();
+
+  if (now - private->last_undo_push_time >= UNDO_COALESCE_INTERVAL)
+    return NULL;
+
+  undo = gimp_image_undo_can_compress (image, object_type, undo_type);
+
+  if (! undo || ! GIMP_IS_ITEM_UNDO (undo))
+    return NULL;
+
+  for (i = 0; i < n_properties; i++)
+    {
+      if (! strcmp (names[i], "item"))
+        {
+          item = g_value_get_object (&values[i]);
+          break;
+        }
+    }
+
+  if (! item || GIMP_ITEM_UNDO (undo)->item != item)
+    return NULL;
+
+  private->last_undo_push_time = now;
+
+  gimp_undo_refresh_preview (undo, gimp_get_user_context (image->gimp));
+
+  return undo;
+}
+
 static GimpDirtyMask
 gimp_image_undo_dirty_from_type (GimpUndoType undo_type)
 {
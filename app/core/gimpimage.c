@@ -37,12 +37,13 @@
 #include "operations/layer-modes/gimp-layer-modes.h"
 
 #include "gegl/gimp-babl.h"
-#include "gegl/gimp-gegl-loops.h"
 
 #include "gimp.h"
 #include "gimp-memsize.h"
+#include "gimp-parallel.h"
 #include "gimp-parasites.h"
 #include "gimp-utils.h"
+#include "gimpasync.h"
 #include "gimpcontext.h"
 #include "gimpdrawable-filters.h"
 #include "gimpdrawable-floating-selection.h"
@@ -57,6 +58,7 @@
 #include "gimpimage-colormap.h"
 #include "gimpimage-guides.h"
 #include "gimpimage-item-list.h"
+#include "gimpimage-memory.h"
 #include "gimpimage-metadata.h"
 #include "gimpimage-sample-points.h"
 #include "gimpimage-preview.h"
@@ -286,6 +288,8 @@ static void     gimp_image_freeze_bounding_box   (GimpImage         *image);
 static void     gimp_image_thaw_bounding_box     (GimpImage         *image);
 static void     gimp_image_update_bounding_box   (GimpImage         *image);
 
+static void     gimp_image_init_fishes           (GimpImage         *image);
+
 static gint     gimp_image_layer_stack_cmp         (GList           *layers1,
                                                     GList           *layers2);
 static void gimp_image_rec_remove_layer_stack_dups (GimpImage       *image,
@@ -959,6 +963,8 @@ gimp_image_constructed (GObject *object)
                            image, G_CONNECT_SWAPPED);
 
   gimp_container_add (image->gimp->images, GIMP_OBJECT (image));
+
+  gimp_image_init_fishes (image);
 }
 
 static void
@@ -1103,6 +1109,8 @@ gimp_image_dispose (GObject *object)
   if (private->palette)
     gimp_image_colormap_dispose (image);
 
+  gimp_image_memory_forget (image);
+
   gimp_image_undo_free (image);
 
   g_list_free_full (private->stored_layer_sets,   g_object_unref);
@@ -1385,6 +1393,8 @@ gimp_image_real_precision_changed (GimpImage *image)
   gimp_image_metadata_update_bits_per_sample (image);
 
   gimp_projectable_structure_changed (GIMP_PROJECTABLE (image));
+
+  gimp_image_init_fishes (image);
 }
 
 static void
@@ -1462,6 +1472,8 @@ gimp_image_color_managed_profile_changed (GimpColorManaged *managed)
   gimp_projectable_structure_changed (GIMP_PROJECTABLE (image));
   gimp_viewable_invalidate_preview (GIMP_VIEWABLE (image));
   gimp_item_stack_profile_changed (layers);
+
+  gimp_image_init_fishes (image);
 }
 
 static GimpColorProfile *
@@ -1666,10 +1678,27 @@ gimp_image_get_pixel_average (GimpPickable        *pickable,
                               const Babl          *format,
                               gpointer             pixel)
 {
-  GeglBuffer *buffer = gimp_pickable_get_buffer (pickable);
+  GimpImage        *image   = GIMP_IMAGE (pickable);
+  GimpImagePrivate *private = GIMP_IMAGE_GET_PRIVATE (image);
+  GeglRectangle     area    = *rect;
+
+  /*  average on the projection, which caches the sums, but only over
+   *  what gimp_image_get_buffer() covers
+   */
+  if (private->show_all)
+    {
+      if (! gegl_rectangle_intersect (&area, rect,
+                                      GEGL_RECTANGLE (0, 0,
+                                                      gimp_image_get_width  (image),
+                                                      gimp_image_get_height (image))))
+        {
+          area.width  = 0;
+          area.height = 0;
+        }
+    }
 
-  return gimp_gegl_average_color (buffer, rect, TRUE, GEGL_ABYSS_NONE, format,
-                                  pixel);
+  gimp_pickable_get_pixel_average (GIMP_PICKABLE (private->projection),
+                                   &area, format, pixel);
 }
 
 static GeglRectangle
@@ -1750,6 +1779,8 @@ gimp_image_layers_changed (GimpContainer *container,
                            GimpImage     *image)
 {
   gimp_image_update_bounding_box (image);
+
+  gimp_image_colormap_invalidate_used (image);
 }
 
 static void
@@ -1955,6 +1986,47 @@ gimp_image_update_bounding_box (GimpImage *image)
     }
 }
 
+static void
+gimp_image_init_fishes_async (GimpAsync  *async,
+                              const Babl *format)
+{
+  gimp_babl_init_format_fishes (format);
+
+  gimp_async_finish (async, NULL);
+}
+
+/*  build the fishes for the image's layer formats in the background, so
+ *  the first stroke or redraw in a new precision or color space doesn't
+ *  have to wait for babl.  each format is only handled once per session.
+ */
+static void
+gimp_image_init_fishes (GimpImage *image)
+{
+  static GHashTable *formats = NULL;
+  gint               i;
+
+  if (image->gimp->no_interface)
+    return;
+
+  if (! formats)
+    formats = g_hash_table_new (NULL, NULL);
+
+  for (i = 0; i < 2; i++)
+    {
+      const Babl *format = gimp_image_get_layer_format (image, i);
+
+      if (g_hash_table_contains (formats, format))
+        continue;
+
+      g_hash_table_add (formats, (gpointer) format);
+
+      g_object_unref (gimp_parallel_run_async_full (
+        +1,
+        (GimpRunAsyncFunc) gimp_image_init_fishes_async,
+        (gpointer) format, NULL));
+    }
+}
+
 static gint
 gimp_image_layer_stack_cmp (GList *layers1,
                             GList *layers2)
@@ -2807,11 +2879,11 @@ gimp_image_get_export_proc (GimpImage *image)
 }
 
 gint
-gimp_image_get_xcf_version (GimpImage    *image,
-                            gboolean      zlib_compression,
-                            gint         *gimp_version,
-                            const gchar **version_string,
-                            gchar       **version_reason)
+gimp_image_get_xcf_version (GimpImage          *image,
+                            GimpXcfCompression  compression,
+                            gint               *gimp_version,
+                            const gchar       **version_string,
+                            gchar             **version_reason)
 {
   GList       *items;
   GList       *list;
@@ -3099,13 +3171,22 @@ gimp_image_get_xcf_version (GimpImage    *image,
     }
 
   /* need version 8 for zlib compression */
-  if (zlib_compression)
+  if (compression == GIMP_XCF_COMPRESSION_ZLIB)
     {
       ADD_REASON (g_strdup_printf (_("Internal zlib compression was "
                                      "added in %s"), "GIMP 2.10"));
       version = MAX (8, version);
     }
 
+  /* need version 26 for zstd and LZ4 compression */
+  if (compression == GIMP_XCF_COMPRESSION_ZSTD ||
+      compression == GIMP_XCF_COMPRESSION_LZ4)
+    {
+      ADD_REASON (g_strdup_printf (_("Internal Zstandard and LZ4 compression "
+                                     "were added in %s"), "GIMP 3.2"));
+      version = MAX (26, version);
+    }
+
   /* if version is 10 (lots of new layer modes), go to version 11 with
    * 64 bit offsets right away
    */
@@ -3214,6 +3295,7 @@ gimp_image_get_xcf_version (GimpImage    *image,
       break;
     case 24:
     case 25:
+    case 26:
       if (gimp_version)   *gimp_version   = 320;
       if (version_string) *version_string = "GIMP 3.2";
       break;
@@ -3241,18 +3323,18 @@ gimp_image_get_xcf_version (GimpImage    *image,
 }
 
 void
-gimp_image_set_xcf_compression (GimpImage *image,
-                                gboolean   compression)
+gimp_image_set_xcf_compression (GimpImage          *image,
+                                GimpXcfCompression  compression)
 {
   g_return_if_fail (GIMP_IS_IMAGE (image));
 
   GIMP_IMAGE_GET_PRIVATE (image)->xcf_compression = compression;
 }
 
-gboolean
+GimpXcfCompression
 gimp_image_get_xcf_compression (GimpImage *image)
 {
-  g_return_val_if_fail (GIMP_IS_IMAGE (image), FALSE);
+  g_return_val_if_fail (GIMP_IS_IMAGE (image), GIMP_XCF_COMPRESSION_RLE);
 
   return GIMP_IMAGE_GET_PRIVATE (image)->xcf_compression;
 }
@@ -3870,6 +3952,8 @@ gimp_image_invalidate (GimpImage *image,
                                x, y, width, height);
 
   GIMP_IMAGE_GET_PRIVATE (image)->flush_accum.preview_invalidated = TRUE;
+
+  gimp_image_colormap_invalidate_used (image);
 }
 
 void
@@ -4071,6 +4155,11 @@ gimp_image_dirty (GimpImage     *image,
   private->dirty++;
   private->export_dirty++;
 
+  /*  pixels may have been changed without any layer update, e.g. of a
+   *  hidden layer
+   */
+  gimp_image_colormap_invalidate_used (image);
+
   if (! private->dirty_time)
     private->dirty_time = time (NULL);
 
@@ -4094,6 +4183,8 @@ gimp_image_clean (GimpImage     *image,
   private->dirty--;
   private->export_dirty--;
 
+  gimp_image_colormap_invalidate_used (image);
+
   g_signal_emit (image, gimp_image_signals[CLEAN], 0, dirty_mask);
 
   TRC (("clean %d -> %d\n", private->dirty + 1, private->dirty));
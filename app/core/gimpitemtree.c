@@ -60,6 +60,9 @@ struct _GimpItemTreePrivate
   GList      *selected_items;
 
   GHashTable *name_hash;
+
+  /*  the groups whose children are frozen along with the tree's container  */
+  GList      *frozen_parents;
 };
 
 #define GIMP_ITEM_TREE_GET_PRIVATE(object) \
@@ -87,6 +90,15 @@ static void     gimp_item_tree_uniquefy_name (GimpItemTree *tree,
                                               GimpItem     *item,
                                               const gchar  *new_name);
 
+static void     gimp_item_tree_freeze_children
+                                             (GimpItemTree  *tree,
+                                              GimpItem      *parent);
+static gint     gimp_item_tree_depth_compare (GimpItem      *item1,
+                                              GimpItem      *item2);
+static void     gimp_item_tree_container_thaw
+                                             (GimpContainer *container,
+                                              GimpItemTree  *tree);
+
 
 G_DEFINE_TYPE_WITH_PRIVATE (GimpItemTree, gimp_item_tree, GIMP_TYPE_OBJECT)
 
@@ -167,6 +179,10 @@ gimp_item_tree_constructed (GObject *object)
                                   "child-type", private->item_type,
                                   "policy",     GIMP_CONTAINER_POLICY_STRONG,
                                   NULL);
+
+  g_signal_connect (tree->container, "thaw",
+                    G_CALLBACK (gimp_item_tree_container_thaw),
+                    tree);
 }
 
 static void
@@ -177,6 +193,8 @@ gimp_item_tree_dispose (GObject *object)
 
   gimp_item_tree_set_selected_items (tree, NULL);
 
+  gimp_item_tree_container_thaw (tree->container, tree);
+
   gimp_container_foreach (tree->container,
                           (GFunc) gimp_item_removed, NULL);
 
@@ -401,6 +419,27 @@ gimp_item_tree_get_item_by_name (GimpItemTree *tree,
                               name);
 }
 
+/*  freezes the tree for a batch of changes.  while frozen, the
+ *  containers of the tree, including those of group items changed in
+ *  the meantime, collect their updates and emit them once when the
+ *  tree is thawed.  this is the same as freezing the tree's container.
+ */
+void
+gimp_item_tree_freeze (GimpItemTree *tree)
+{
+  g_return_if_fail (GIMP_IS_ITEM_TREE (tree));
+
+  gimp_container_freeze (tree->container);
+}
+
+void
+gimp_item_tree_thaw (GimpItemTree *tree)
+{
+  g_return_if_fail (GIMP_IS_ITEM_TREE (tree));
+
+  gimp_container_thaw (tree->container);
+}
+
 gboolean
 gimp_item_tree_get_insert_pos (GimpItemTree  *tree,
                                GimpItem      *item,
@@ -558,6 +597,8 @@ gimp_item_tree_add_item (GimpItemTree *tree,
     gimp_viewable_set_parent (GIMP_VIEWABLE (item),
                               GIMP_VIEWABLE (parent));
 
+  gimp_item_tree_freeze_children (tree, parent);
+
   gimp_container_insert (container, GIMP_OBJECT (item), position);
 
   /*  if the item came from the undo stack, reset its "removed" state  */
@@ -608,6 +649,8 @@ gimp_item_tree_remove_item (GimpItemTree *tree,
         }
     }
 
+  gimp_item_tree_freeze_children (tree, gimp_item_get_parent (item));
+
   gimp_container_remove (container, GIMP_OBJECT (item));
 
   if (parent)
@@ -701,6 +744,9 @@ gimp_item_tree_reorder_item (GimpItemTree *tree,
       if (push_undo)
         gimp_image_undo_push_item_reorder (private->image, undo_desc, item);
 
+      gimp_item_tree_freeze_children (tree, gimp_item_get_parent (item));
+      gimp_item_tree_freeze_children (tree, new_parent);
+
       if (new_container != container)
         {
           g_object_ref (item);
@@ -832,3 +878,52 @@ gimp_item_tree_uniquefy_name (GimpItemTree *tree,
                        (gpointer) gimp_object_get_name (item),
                        item);
 }
+
+static void
+gimp_item_tree_freeze_children (GimpItemTree *tree,
+                                GimpItem     *parent)
+{
+  GimpItemTreePrivate *private = GIMP_ITEM_TREE_GET_PRIVATE (tree);
+
+  if (parent                                  &&
+      gimp_container_frozen (tree->container) &&
+      ! g_list_find (private->frozen_parents, parent))
+    {
+      gimp_container_freeze (gimp_viewable_get_children (GIMP_VIEWABLE (parent)));
+
+      private->frozen_parents = g_list_prepend (private->frozen_parents,
+                                                g_object_ref (parent));
+    }
+}
+
+static gint
+gimp_item_tree_depth_compare (GimpItem *item1,
+                              GimpItem *item2)
+{
+  return (gimp_viewable_get_depth (GIMP_VIEWABLE (item2)) -
+          gimp_viewable_get_depth (GIMP_VIEWABLE (item1)));
+}
+
+static void
+gimp_item_tree_container_thaw (GimpContainer *container,
+                               GimpItemTree  *tree)
+{
+  GimpItemTreePrivate *private = GIMP_ITEM_TREE_GET_PRIVATE (tree);
+  GList               *list;
+
+  /*  thaw the deepest groups first, so that when a group updates its
+   *  size on thaw, the size of its child groups is final, and each
+   *  change propagates up the tree only once
+   */
+  list = g_list_sort (private->frozen_parents,
+                      (GCompareFunc) gimp_item_tree_depth_compare);
+  private->frozen_parents = NULL;
+
+  while (list)
+    {
+      gimp_container_thaw (gimp_viewable_get_children (list->data));
+      g_object_unref (list->data);
+
+      list = g_list_delete_link (list, list);
+    }
+}
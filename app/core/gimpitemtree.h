@@ -61,6 +61,9 @@ void           gimp_item_tree_set_selected_items (GimpItemTree  *tree,
 GimpItem     * gimp_item_tree_get_item_by_name (GimpItemTree  *tree,
                                                 const gchar   *name);
 
+void           gimp_item_tree_freeze           (GimpItemTree  *tree);
+void           gimp_item_tree_thaw             (GimpItemTree  *tree);
+
 gboolean       gimp_item_tree_get_insert_pos   (GimpItemTree  *tree,
                                                 GimpItem      *item,
                                                 GimpItem     **parent,
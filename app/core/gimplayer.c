@@ -37,6 +37,7 @@
 #include "gegl/gimp-gegl-apply-operation.h"
 #include "gegl/gimp-gegl-loops.h"
 #include "gegl/gimp-gegl-nodes.h"
+#include "gegl/gimp-gegl-utils.h"
 
 #include "gimpboundary.h"
 #include "gimpchannel-select.h"
@@ -707,6 +708,11 @@ gimp_layer_update_mode_node (GimpLayer *layer)
                                 visible_composite_space,
                                 visible_composite_mode);
   gimp_gegl_mode_node_set_opacity (mode_node, layer->opacity);
+
+  gimp_gegl_mode_node_set_opaque_tiles (
+    mode_node,
+    layer->show_mask ? NULL :
+                       gimp_drawable_get_opaque_tiles (GIMP_DRAWABLE (layer)));
 }
 
 static void
@@ -1771,9 +1777,46 @@ gimp_layer_real_convert_type (GimpLayer        *layer,
                               gboolean          push_undo,
                               GimpProgress     *progress)
 {
-  GimpDrawable *drawable = GIMP_DRAWABLE (layer);
+  GimpDrawable *drawable        = GIMP_DRAWABLE (layer);
   GeglBuffer   *src_buffer;
   GeglBuffer   *dest_buffer;
+  gboolean      convert_profile = FALSE;
+  gint          bits;
+
+  if (dest_profile)
+    {
+      if (! src_profile)
+        src_profile =
+          gimp_color_managed_get_color_profile (GIMP_COLOR_MANAGED (layer));
+
+      convert_profile = ! gimp_color_profile_is_equal (src_profile,
+                                                       dest_profile);
+    }
+
+  dest_buffer =
+    gegl_buffer_new (GEGL_RECTANGLE (0, 0,
+                                     gimp_item_get_width  (GIMP_ITEM (layer)),
+                                     gimp_item_get_height (GIMP_ITEM (layer))),
+                     new_format);
+
+  bits = (babl_format_get_bytes_per_pixel (new_format) * 8 /
+          babl_format_get_n_components (new_format));
+
+  if (layer_dither_type != GEGL_DITHER_NONE && ! convert_profile)
+    {
+      /*  there is no color transform to do, so dither straight into
+       *  dest_buffer, rather than keeping a dithered copy of the whole
+       *  layer at the old precision around while converting
+       */
+      gimp_gegl_apply_dither (gimp_drawable_get_buffer (drawable),
+                              NULL, NULL,
+                              dest_buffer, 1 << bits, layer_dither_type);
+
+      gimp_drawable_set_buffer (drawable, push_undo, NULL, dest_buffer);
+      g_object_unref (dest_buffer);
+
+      return;
+    }
 
   if (layer_dither_type == GEGL_DITHER_NONE)
     {
@@ -1781,34 +1824,19 @@ gimp_layer_real_convert_type (GimpLayer        *layer,
     }
   else
     {
-      gint bits;
-
       src_buffer =
         gegl_buffer_new (GEGL_RECTANGLE (0, 0,
                                          gimp_item_get_width  (GIMP_ITEM (layer)),
                                          gimp_item_get_height (GIMP_ITEM (layer))),
                          gimp_drawable_get_format (drawable));
 
-      bits = (babl_format_get_bytes_per_pixel (new_format) * 8 /
-              babl_format_get_n_components (new_format));
-
       gimp_gegl_apply_dither (gimp_drawable_get_buffer (drawable),
                               NULL, NULL,
                               src_buffer, 1 << bits, layer_dither_type);
     }
 
-  dest_buffer =
-    gegl_buffer_new (GEGL_RECTANGLE (0, 0,
-                                     gimp_item_get_width  (GIMP_ITEM (layer)),
-                                     gimp_item_get_height (GIMP_ITEM (layer))),
-                     new_format);
-
   if (dest_profile)
     {
-      if (! src_profile)
-        src_profile =
-          gimp_color_managed_get_color_profile (GIMP_COLOR_MANAGED (layer));
-
       gimp_gegl_convert_color_profile (src_buffer,  NULL, src_profile,
                                        dest_buffer, NULL, dest_profile,
                                        GIMP_COLOR_RENDERING_INTENT_PERCEPTUAL,
@@ -2271,21 +2299,38 @@ gimp_layer_apply_mask (GimpLayer         *layer,
     {
       GeglBuffer *mask_buffer;
       GeglBuffer *dest_buffer;
+      GeglBuffer *undo_buffer = NULL;
 
-      if (push_undo)
-        gimp_drawable_push_undo (GIMP_DRAWABLE (layer), NULL,
-                                 NULL,
-                                 0, 0,
-                                 gimp_item_get_width  (item),
-                                 gimp_item_get_height (item));
-
-      /*  Combine the current layer's alpha channel and the mask  */
       mask_buffer = gimp_drawable_get_buffer (GIMP_DRAWABLE (mask));
       dest_buffer = gimp_drawable_get_buffer (GIMP_DRAWABLE (layer));
 
-      gimp_gegl_apply_opacity (gimp_drawable_get_buffer (GIMP_DRAWABLE (layer)),
+      if (push_undo)
+        {
+          /*  shares all of the layer's tiles  */
+          undo_buffer = gimp_gegl_buffer_dup (dest_buffer);
+
+          gimp_drawable_push_undo (GIMP_DRAWABLE (layer), NULL,
+                                   undo_buffer,
+                                   0, 0,
+                                   gimp_item_get_width  (item),
+                                   gimp_item_get_height (item));
+        }
+
+      /*  Combine the current layer's alpha channel and the mask  */
+      gimp_gegl_apply_opacity (dest_buffer,
                                NULL, NULL, dest_buffer,
                                mask_buffer, 0, 0, 1.0);
+
+      if (undo_buffer)
+        {
+          /*  applying the mask in place unshares every tile, share the
+           *  ones under a fully opaque part of the mask again
+           */
+          gimp_gegl_buffer_share_unchanged (undo_buffer, NULL,
+                                            dest_buffer, NULL);
+
+          g_object_unref (undo_buffer);
+        }
     }
 
   g_signal_handlers_disconnect_by_func (mask,
@@ -25,13 +25,23 @@
 
 #include "core-types.h"
 
+#include "config/gimpgeglconfig.h"
+
+#include "gegl/gimp-babl.h"
+#include "gegl/gimptilehandlervalidate.h"
+
+#include "gimp.h"
+#include "gimp-memsize.h"
+#include "gimpimage.h"
 #include "gimplayer.h"
 #include "gimplayerstack.h"
+#include "gimpprojectable.h"
 
 
 /*  local function prototypes  */
 
 static void   gimp_layer_stack_constructed             (GObject       *object);
+static void   gimp_layer_stack_finalize                (GObject       *object);
 
 static void   gimp_layer_stack_add                     (GimpContainer *container,
                                                         GimpObject    *object);
@@ -42,6 +52,12 @@ static void   gimp_layer_stack_reorder                 (GimpContainer *container
                                                         gint           old_index,
                                                         gint           new_index);
 
+static void   gimp_layer_stack_layer_update            (GimpLayer      *layer,
+                                                        gint            x,
+                                                        gint            y,
+                                                        gint            width,
+                                                        gint            height,
+                                                        GimpLayerStack *stack);
 static void   gimp_layer_stack_layer_active            (GimpLayer      *layer,
                                                         GimpLayerStack *stack);
 static void   gimp_layer_stack_layer_excludes_backdrop (GimpLayer      *layer,
@@ -55,12 +71,23 @@ static void   gimp_layer_stack_update_range            (GimpLayerStack *stack,
                                                         gint            first,
                                                         gint            last);
 
+static void   gimp_layer_stack_cache_layer             (GimpLayerStack *stack,
+                                                        GimpLayer      *layer);
+static void   gimp_layer_stack_uncache                 (GimpLayerStack *stack);
+static void   gimp_layer_stack_cache_invalidated       (GeglNode            *node,
+                                                        const GeglRectangle *rect,
+                                                        GimpLayerStack      *stack);
+static void   gimp_layer_stack_cache_update_memsize    (GimpLayerStack *stack);
+
 
 G_DEFINE_TYPE (GimpLayerStack, gimp_layer_stack, GIMP_TYPE_DRAWABLE_STACK)
 
 #define parent_class gimp_layer_stack_parent_class
 
 
+static guintptr gimp_layer_stack_total_cache_memsize = 0;
+
+
 static void
 gimp_layer_stack_class_init (GimpLayerStackClass *klass)
 {
@@ -68,6 +95,7 @@ gimp_layer_stack_class_init (GimpLayerStackClass *klass)
   GimpContainerClass *container_class = GIMP_CONTAINER_CLASS (klass);
 
   object_class->constructed = gimp_layer_stack_constructed;
+  object_class->finalize    = gimp_layer_stack_finalize;
 
   container_class->add      = gimp_layer_stack_add;
   container_class->remove   = gimp_layer_stack_remove;
@@ -89,6 +117,9 @@ gimp_layer_stack_constructed (GObject *object)
   gimp_assert (g_type_is_a (gimp_container_get_child_type (container),
                             GIMP_TYPE_LAYER));
 
+  gimp_container_add_handler (container, "update",
+                              G_CALLBACK (gimp_layer_stack_layer_update),
+                              container);
   gimp_container_add_handler (container, "active-changed",
                               G_CALLBACK (gimp_layer_stack_layer_active),
                               container);
@@ -97,6 +128,16 @@ gimp_layer_stack_constructed (GObject *object)
                               container);
 }
 
+static void
+gimp_layer_stack_finalize (GObject *object)
+{
+  GimpLayerStack *stack = GIMP_LAYER_STACK (object);
+
+  gimp_layer_stack_uncache (stack);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gimp_layer_stack_add (GimpContainer *container,
                       GimpObject    *object)
@@ -105,6 +146,8 @@ gimp_layer_stack_add (GimpContainer *container,
 
   GIMP_CONTAINER_CLASS (parent_class)->add (container, object);
 
+  gimp_layer_stack_uncache (stack);
+
   gimp_layer_stack_update_backdrop (stack, GIMP_LAYER (object), FALSE, FALSE);
 }
 
@@ -124,6 +167,8 @@ gimp_layer_stack_remove (GimpContainer *container,
 
   GIMP_CONTAINER_CLASS (parent_class)->remove (container, object);
 
+  gimp_layer_stack_uncache (stack);
+
   if (update_backdrop)
     gimp_layer_stack_update_range (stack, index, -1);
 }
@@ -143,6 +188,8 @@ gimp_layer_stack_reorder (GimpContainer *container,
   GIMP_CONTAINER_CLASS (parent_class)->reorder (container, object,
                                                 old_index, new_index);
 
+  gimp_layer_stack_uncache (stack);
+
   if (update_backdrop)
     gimp_layer_stack_update_range (stack, old_index, new_index);
 }
@@ -163,12 +210,44 @@ gimp_layer_stack_new (GType layer_type)
 }
 
 
+
+
+/*  stats  */
+
+guint64
+gimp_layer_stack_get_total_cache_memsize (void)
+{
+  return gimp_layer_stack_total_cache_memsize;
+}
+
+
 /*  private functions  */
 
+static void
+gimp_layer_stack_layer_update (GimpLayer      *layer,
+                               gint            x,
+                               gint            y,
+                               gint            width,
+                               gint            height,
+                               GimpLayerStack *stack)
+{
+  GimpImage *image = gimp_item_get_image (GIMP_ITEM (layer));
+
+  if (! image || ! GIMP_GEGL_CONFIG (image->gimp->config)->layer_stack_cache)
+    gimp_layer_stack_uncache (stack);
+  else if (gimp_filter_get_active (GIMP_FILTER (layer)))
+    gimp_layer_stack_cache_layer (stack, layer);
+}
+
 static void
 gimp_layer_stack_layer_active (GimpLayer      *layer,
                                GimpLayerStack *stack)
 {
+  /*  the filter stack has already relinked the graph around the layer,
+   *  so the cache can only be dropped at this point
+   */
+  gimp_layer_stack_uncache (stack);
+
   gimp_layer_stack_update_backdrop (stack, layer, TRUE, FALSE);
 }
 
@@ -240,3 +319,191 @@ gimp_layer_stack_update_range (GimpLayerStack *stack,
         }
     }
 }
+
+/*  the cache keeps the composite of all the layers below the layer that
+ *  was last updated in a validated buffer, which replaces them as the
+ *  layer's input.  the layers below still feed a nop node, whose
+ *  "invalidated" signal invalidates the buffer whenever anything below
+ *  changes, so that only the layers from the edited one upward have to be
+ *  composited again while painting.
+ */
+static void
+gimp_layer_stack_cache_layer (GimpLayerStack *stack,
+                              GimpLayer      *layer)
+{
+  GeglNode                *graph;
+  GeglNode                *node;
+  GeglNode                *node_below;
+  GimpItem                *parent;
+  GimpProjectable         *projectable;
+  GimpTileHandlerValidate *validate;
+  GeglRectangle            bounding_box;
+  const Babl              *format;
+
+  if (layer == stack->cache_layer)
+    return;
+
+  gimp_layer_stack_uncache (stack);
+
+  graph = GIMP_FILTER_STACK (stack)->graph;
+
+  if (! graph)
+    return;
+
+  node       = gimp_filter_get_node (GIMP_FILTER (layer));
+  node_below = gegl_node_get_producer (node, "input", NULL);
+
+  /*  nothing to cache below the bottom layer  */
+  if (! node_below ||
+      node_below == gegl_node_get_input_proxy (graph, "input"))
+    return;
+
+  parent = gimp_item_get_parent (GIMP_ITEM (layer));
+
+  if (parent)
+    projectable = GIMP_PROJECTABLE (parent);
+  else
+    projectable = GIMP_PROJECTABLE (gimp_item_get_image (GIMP_ITEM (layer)));
+
+  /*  keep the backdrop at float precision, so that the layers above are
+   *  composited exactly as without the cache
+   */
+  format = gimp_babl_format_change_component_type (
+    gimp_projectable_get_format (projectable),
+    GIMP_COMPONENT_TYPE_FLOAT);
+
+  stack->cache_input = gegl_node_new_child (graph,
+                                            "operation", "gegl:nop",
+                                            NULL);
+
+  gegl_node_link (node_below, stack->cache_input);
+
+  bounding_box = gegl_node_get_bounding_box (stack->cache_input);
+
+  if (gegl_rectangle_is_empty (&bounding_box) ||
+      gegl_rectangle_is_infinite_plane (&bounding_box))
+    {
+      gegl_node_disconnect (stack->cache_input, "input");
+      gegl_node_remove_child (graph, stack->cache_input);
+      stack->cache_input = NULL;
+
+      return;
+    }
+
+  stack->cache_buffer = gegl_buffer_new (&bounding_box, format);
+
+  validate = GIMP_TILE_HANDLER_VALIDATE (
+    gimp_tile_handler_validate_new (stack->cache_input));
+
+  gimp_tile_handler_validate_assign (validate, stack->cache_buffer);
+
+  gimp_tile_handler_validate_invalidate (validate, &bounding_box);
+
+  g_object_unref (validate);
+
+  g_signal_connect (stack->cache_input, "invalidated",
+                    G_CALLBACK (gimp_layer_stack_cache_invalidated),
+                    stack);
+
+  stack->cache_node = gegl_node_new_child (graph,
+                                           "operation", "gimp:buffer-source-validate",
+                                           "buffer",    stack->cache_buffer,
+                                           NULL);
+
+  gegl_node_link (stack->cache_node, node);
+
+  stack->cache_layer = layer;
+
+  gimp_layer_stack_cache_update_memsize (stack);
+}
+
+static void
+gimp_layer_stack_uncache (GimpLayerStack *stack)
+{
+  GeglNode     *graph;
+  GeglNode     *node_below;
+  GeglNode    **nodes;
+  const gchar **pads;
+  gint          n_consumers;
+  gint          i;
+
+  if (! stack->cache_layer)
+    return;
+
+  graph = GIMP_FILTER_STACK (stack)->graph;
+
+  /*  whatever the filter stack linked to the cache since it was created
+   *  is linked back to the node below, which might not be the layer the
+   *  cache was created for anymore
+   */
+  node_below  = gegl_node_get_producer (stack->cache_input, "input", NULL);
+  n_consumers = gegl_node_get_consumers (stack->cache_node, "output",
+                                         &nodes, &pads);
+
+  for (i = 0; i < n_consumers; i++)
+    {
+      if (node_below)
+        gegl_node_connect (node_below, "output", nodes[i], pads[i]);
+      else
+        gegl_node_disconnect (nodes[i], pads[i]);
+    }
+
+  g_free (nodes);
+  g_free (pads);
+
+  g_signal_handlers_disconnect_by_func (stack->cache_input,
+                                        gimp_layer_stack_cache_invalidated,
+                                        stack);
+
+  gegl_node_disconnect (stack->cache_input, "input");
+
+  gegl_node_remove_child (graph, stack->cache_input);
+  gegl_node_remove_child (graph, stack->cache_node);
+
+  stack->cache_input = NULL;
+  stack->cache_node  = NULL;
+  stack->cache_layer = NULL;
+
+  g_clear_object (&stack->cache_buffer);
+
+  gimp_layer_stack_cache_update_memsize (stack);
+}
+
+static void
+gimp_layer_stack_cache_invalidated (GeglNode            *node,
+                                    const GeglRectangle *rect,
+                                    GimpLayerStack      *stack)
+{
+  GimpTileHandlerValidate *validate;
+  GeglRectangle            bounding_box;
+
+  validate = gimp_tile_handler_validate_get_assigned (stack->cache_buffer);
+
+  bounding_box = gegl_node_get_bounding_box (node);
+
+  if (! gegl_rectangle_equal (&bounding_box,
+                              gegl_buffer_get_extent (stack->cache_buffer)))
+    {
+      gimp_tile_handler_validate_buffer_set_extent (stack->cache_buffer,
+                                                    &bounding_box);
+
+      gimp_tile_handler_validate_invalidate (validate, &bounding_box);
+
+      gimp_layer_stack_cache_update_memsize (stack);
+    }
+  else
+    {
+      gimp_tile_handler_validate_invalidate (validate, rect);
+    }
+}
+
+static void
+gimp_layer_stack_cache_update_memsize (GimpLayerStack *stack)
+{
+  gint64 memsize = gimp_gegl_buffer_get_memsize (stack->cache_buffer);
+
+  g_atomic_pointer_add (&gimp_layer_stack_total_cache_memsize,
+                        memsize - stack->cache_memsize);
+
+  stack->cache_memsize = memsize;
+}
@@ -35,6 +35,12 @@ typedef struct _GimpLayerStackClass GimpLayerStackClass;
 struct _GimpLayerStack
 {
   GimpDrawableStack  parent_instance;
+
+  GimpLayer         *cache_layer;
+  GeglNode          *cache_input;
+  GeglNode          *cache_node;
+  GeglBuffer        *cache_buffer;
+  gint64             cache_memsize;
 };
 
 struct _GimpLayerStackClass
@@ -45,3 +51,8 @@ struct _GimpLayerStackClass
 
 GType           gimp_layer_stack_get_type  (void) G_GNUC_CONST;
 GimpContainer * gimp_layer_stack_new       (GType layer_type);
+
+
+/*  stats  */
+
+guint64   gimp_layer_stack_get_total_cache_memsize (void);
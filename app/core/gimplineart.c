@@ -20,6 +20,9 @@
 
 #include "config.h"
 
+#include <string.h>
+
+#include <cairo.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gegl.h>
 
@@ -40,12 +43,24 @@
 #include "gimpimage.h"
 #include "gimplineart.h"
 #include "gimppickable.h"
+#include "gimpprojectable.h"
 #include "gimpprojection.h"
 #include "gimpviewable.h"
 #include "gimpwaitable.h"
 
 #include "gimp-intl.h"
 
+
+#define PIXELS_PER_THREAD \
+  (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
+
+/* when only part of the input changes, the line art is recomputed around
+ * it, and spliced into the previous result.  this is the number of pixels
+ * of context used past the maximal closure length, so that strokes crossing
+ * the border of the spliced area are seen whole.
+ */
+#define UPDATE_CONTEXT 16
+
 enum
 {
   COMPUTING_START,
@@ -68,38 +83,48 @@ typedef struct _GimpLineArtPrivate GimpLineArtPrivate;
 
 struct _GimpLineArtPrivate
 {
-  gboolean      frozen;
-  gboolean      compute_after_thaw;
+  gboolean        frozen;
+  gboolean        compute_after_thaw;
 
-  GimpAsync    *async;
+  GimpAsync      *async;
 
-  gint          idle_id;
+  gint            idle_id;
 
-  GimpPickable *input;
-  GeglBuffer   *closed;
-  gfloat       *distmap;
+  GimpPickable   *input;
+  GeglBuffer     *closed;
+  gfloat         *distmap;
+
+  /* the part of the input that changed since the last computation, or
+   * NULL if unknown.
+   */
+  cairo_region_t *dirty_region;
 
   /* Used in the closing step. */
-  gboolean      select_transparent;
-  gdouble       threshold;
-  gboolean      automatic_closure;
-  gint          spline_max_len;
-  gint          segment_max_len;
-  gboolean      max_len_bound;
+  gboolean        select_transparent;
+  gdouble         threshold;
+  gboolean        automatic_closure;
+  gint            spline_max_len;
+  gint            segment_max_len;
+  gboolean        max_len_bound;
 
   /* Used in the grow step. */
-  gint          max_grow;
+  gint            max_grow;
 };
 
 typedef struct
 {
-  GeglBuffer  *buffer;
+  GeglBuffer    *buffer;
+
+  gboolean       select_transparent;
+  gdouble        threshold;
+  gboolean       automatic_closure;
+  gint           spline_max_len;
+  gint           segment_max_len;
 
-  gboolean     select_transparent;
-  gdouble      threshold;
-  gboolean     automatic_closure;
-  gint         spline_max_len;
-  gint         segment_max_len;
+  /* when updating a previous result, a copy of it, and the changed area */
+  GeglBuffer    *closed;
+  gfloat        *distmap;
+  GeglRectangle  rect;
 } LineArtData;
 
 typedef struct
@@ -147,6 +172,59 @@ typedef struct _Edgel
   guint     next, previous;
 } Edgel;
 
+/* edgel sets are stored as a structure of arrays, in scan order, so that
+ * each pass over a set only touches the fields it uses, and can be split
+ * across threads.
+ */
+typedef struct _EdgelSet
+{
+  guint      len;
+
+  gint      *x;
+  gint      *y;
+  Direction *direction;
+
+  gfloat    *x_normal;
+  gfloat    *y_normal;
+  gfloat    *curvature;
+  guint     *next;
+  guint     *previous;
+
+  /* the index of the first edgel of each row, followed by 'len' */
+  guint     *row_start;
+} EdgelSet;
+
+/* the arguments of a parallel pass over an edgel set */
+typedef struct
+{
+  EdgelSet     *set;
+  GimpAsync    *async;
+
+  const guint8 *mask;
+  gint          width;
+  gint          height;
+
+  const gfloat *weights;
+  gint          mask_size;
+
+  gfloat       *normals;
+  gfloat       *curvatures;
+  gfloat       *smoothed_curvatures;
+  gfloat       *edgels_curvatures;
+} EdgelSetPass;
+
+typedef struct
+{
+  GArray      *max_positions;
+  gfloat      *normals;
+  gint         width;
+  gint         distance_threshold;
+  gfloat       cos_min;
+
+  GArray     **candidates;
+  GimpAsync   *async;
+} SplineCandidatesData;
+
 
 static void            gimp_line_art_finalize                  (GObject               *object);
 static void            gimp_line_art_set_property              (GObject                *object,
@@ -161,11 +239,13 @@ static void            gimp_line_art_get_property              (GObject
 /* Functions for asynchronous computation. */
 
 static void            gimp_line_art_compute                   (GimpLineArt            *line_art);
+static void            gimp_line_art_compute_update            (GimpLineArt            *line_art);
+static void            gimp_line_art_start_async               (GimpLineArt            *line_art,
+                                                                LineArtData            *data);
 static void            gimp_line_art_compute_cb                (GimpAsync              *async,
                                                                 GimpLineArt            *line_art);
 
-static GimpAsync     * gimp_line_art_prepare_async             (GimpLineArt            *line_art,
-                                                                gint                    priority);
+static LineArtData   * gimp_line_art_prepare_data              (GimpLineArt            *line_art);
 static void            gimp_line_art_prepare_async_func        (GimpAsync              *async,
                                                                 LineArtData            *data);
 static LineArtData   * line_art_data_new                       (GeglBuffer             *buffer,
@@ -178,6 +258,12 @@ static void            line_art_result_free                    (LineArtResult
 static gboolean        gimp_line_art_idle                      (GimpLineArt            *line_art);
 static void            gimp_line_art_input_invalidate_preview  (GimpViewable           *viewable,
                                                                 GimpLineArt            *line_art);
+static void            gimp_line_art_input_update              (GimpPickable           *pickable,
+                                                                gint                    x,
+                                                                gint                    y,
+                                                                gint                    width,
+                                                                gint                    height,
+                                                                GimpLineArt            *line_art);
 
 
 /* All actual computation functions. */
@@ -210,8 +296,14 @@ static void            gimp_lineart_compute_normals_curvatures (GeglBuffer
                                                                 gfloat                 *smoothed_curvatures,
                                                                 int                     normal_estimate_mask_size,
                                                                 GimpAsync              *async);
-static gfloat        * gimp_lineart_get_smooth_curvatures      (GArray                 *edgelset,
+static void            gimp_lineart_normals_curvatures_rows    (gsize                   offset,
+                                                                gsize                   size,
+                                                                EdgelSetPass           *pass);
+static gfloat        * gimp_lineart_get_smooth_curvatures      (EdgelSet               *edgelset,
                                                                 GimpAsync              *async);
+static void            gimp_lineart_smooth_curvatures_range    (gsize                   offset,
+                                                                gsize                   size,
+                                                                EdgelSetPass           *pass);
 static GArray        * gimp_lineart_curvature_extremums        (gfloat                 *curvatures,
                                                                 gfloat                 *smoothed_curvatures,
                                                                 gint                    curvatures_width,
@@ -226,6 +318,10 @@ static GList         * gimp_lineart_find_spline_candidates     (GArray
                                                                 gint                    distance_threshold,
                                                                 gfloat                  max_angle_deg,
                                                                 GimpAsync              *async);
+static void            gimp_lineart_find_spline_candidates_range
+                                                               (gsize                   offset,
+                                                                gsize                   size,
+                                                                SplineCandidatesData   *data);
 
 static GArray        * gimp_lineart_discrete_spline            (Pixel                   p0,
                                                                 GimpVector2             n0,
@@ -265,16 +361,9 @@ static inline GimpVector2 pair2normal                           (Pixel
 
 /* Edgel */
 
-static Edgel    * gimp_edgel_new                  (int                x,
-                                                   int                y,
-                                                   Direction          direction);
 static void       gimp_edgel_init                 (Edgel             *edgel);
-static void       gimp_edgel_clear                (Edgel            **edgel);
 static int        gimp_edgel_cmp                  (const Edgel       *e1,
                                                    const Edgel       *e2);
-static guint      edgel2index_hash_fun            (Edgel              *key);
-static gboolean   edgel2index_equal_fun           (Edgel              *e1,
-                                                   Edgel              *e2);
 
 static glong      gimp_edgel_track_mark           (GeglBuffer         *mask,
                                                    Edgel               edgel,
@@ -284,27 +373,51 @@ static glong      gimp_edgel_region_area          (const GeglBuffer   *mask,
 
 /* Edgel set */
 
-static GArray   * gimp_edgelset_new               (GeglBuffer         *buffer,
+static EdgelSet * gimp_edgelset_new               (GeglBuffer         *buffer,
                                                    GimpAsync          *async);
-static void       gimp_edgelset_add               (GArray             *set,
-                                                   int                 x,
-                                                   int                 y,
-                                                   Direction           direction,
-                                                   GHashTable         *edgel2index);
-static void       gimp_edgelset_init_normals      (GArray             *set);
-static void       gimp_edgelset_smooth_normals    (GArray             *set,
+static void       gimp_edgelset_free              (EdgelSet           *set);
+static gboolean   gimp_edgelset_run_pass          (gsize               size,
+                                                   gdouble             cost,
+                                                   GeglParallelDistributeRangeFunc
+                                                                       func,
+                                                   EdgelSetPass       *pass);
+static inline gboolean gimp_edgelset_has_edgel    (const EdgelSetPass *pass,
+                                                   gint                x,
+                                                   gint                y,
+                                                   Direction           direction);
+static void       gimp_edgelset_count_rows        (gsize               offset,
+                                                   gsize               size,
+                                                   EdgelSetPass       *pass);
+static void       gimp_edgelset_add_rows          (gsize               offset,
+                                                   gsize               size,
+                                                   EdgelSetPass       *pass);
+static guint      gimp_edgelset_find              (const EdgelSet     *set,
+                                                   gint                height,
+                                                   const Edgel        *edgel);
+static void       gimp_edgelset_smooth_normals    (EdgelSet           *set,
                                                    int                 mask_size,
                                                    GimpAsync          *async);
-static void       gimp_edgelset_compute_curvature (GArray             *set,
+static void       gimp_edgelset_smooth_normals_range
+                                                  (gsize               offset,
+                                                   gsize               size,
+                                                   EdgelSetPass       *pass);
+static void       gimp_edgelset_compute_curvature (EdgelSet           *set,
                                                    GimpAsync          *async);
-
-static void       gimp_edgelset_build_graph       (GArray            *set,
-                                                   GeglBuffer        *buffer,
-                                                   GHashTable        *edgel2index,
-                                                   GimpAsync         *async);
-static void       gimp_edgelset_next8             (const GeglBuffer  *buffer,
-                                                   Edgel             *it,
-                                                   Edgel             *n);
+static void       gimp_edgelset_compute_curvature_range
+                                                  (gsize               offset,
+                                                   gsize               size,
+                                                   EdgelSetPass       *pass);
+
+static void       gimp_edgelset_build_graph       (EdgelSetPass       *pass);
+static void       gimp_edgelset_build_graph_range (gsize               offset,
+                                                   gsize               size,
+                                                   EdgelSetPass       *pass);
+static void       gimp_edgelset_next8             (const GeglBuffer   *buffer,
+                                                   Edgel              *it,
+                                                   Edgel              *n);
+static void       gimp_edgel_next8                (const guint8       *pixels,
+                                                   Edgel              *it,
+                                                   Edgel              *n);
 
 G_DEFINE_TYPE_WITH_CODE (GimpLineArt, gimp_line_art, GIMP_TYPE_OBJECT,
                          G_ADD_PRIVATE (GimpLineArt))
@@ -528,6 +641,22 @@ gimp_line_art_set_input (GimpLineArt  *line_art,
           g_signal_connect (pickable, "invalidate-preview",
                             G_CALLBACK (gimp_line_art_input_invalidate_preview),
                             line_art);
+
+          /* drawables and projectables report which of their parts
+           * changed, which lets us only update that part of the result
+           */
+          if (GIMP_IS_DRAWABLE (pickable))
+            {
+              g_signal_connect (pickable, "update",
+                                G_CALLBACK (gimp_line_art_input_update),
+                                line_art);
+            }
+          else if (GIMP_IS_PROJECTABLE (pickable))
+            {
+              g_signal_connect (pickable, "invalidate",
+                                G_CALLBACK (gimp_line_art_input_update),
+                                line_art);
+            }
         }
     }
 }
@@ -558,6 +687,10 @@ gimp_line_art_thaw (GimpLineArt *line_art)
       gimp_line_art_compute (line_art);
       line_art->priv->compute_after_thaw = FALSE;
     }
+  else if (line_art->priv->dirty_region)
+    {
+      gimp_line_art_compute_update (line_art);
+    }
 }
 
 gboolean
@@ -624,25 +757,72 @@ gimp_line_art_compute (GimpLineArt *line_art)
 
   if (line_art->priv->input)
     {
-      /* gimp_line_art_prepare_async() will flush the pickable, which
-       * may trigger this signal handler, and will leak a line art (as
-       * line_art->priv->async has not been set yet).
-       */
-      g_signal_handlers_block_by_func (
-        line_art->priv->input,
-        G_CALLBACK (gimp_line_art_input_invalidate_preview),
-        line_art);
-      line_art->priv->async = gimp_line_art_prepare_async (line_art, +1);
-      g_signal_emit (line_art, gimp_line_art_signals[COMPUTING_START], 0);
-      g_signal_handlers_unblock_by_func (
-        line_art->priv->input,
-        G_CALLBACK (gimp_line_art_input_invalidate_preview),
-        line_art);
-
-      gimp_async_add_callback_for_object (line_art->priv->async,
-                                          (GimpAsyncCallback) gimp_line_art_compute_cb,
-                                          line_art, line_art);
+      gimp_line_art_start_async (line_art,
+                                 gimp_line_art_prepare_data (line_art));
+    }
+  else
+    {
+      g_clear_pointer (&line_art->priv->dirty_region, cairo_region_destroy);
+    }
+}
+
+/* recomputes the part of the line art affected by the changes to the
+ * input since the last computation, reusing the rest of the result.  if
+ * a computation is running, the changes are applied once it's done, by
+ * gimp_line_art_compute_cb().
+ */
+static void
+gimp_line_art_compute_update (GimpLineArt *line_art)
+{
+  LineArtData *data;
+
+  if (line_art->priv->frozen || line_art->priv->async)
+    return;
+
+  if (! line_art->priv->closed || ! line_art->priv->input)
+    {
+      gimp_line_art_compute (line_art);
+      return;
+    }
+
+  if (line_art->priv->idle_id)
+    {
+      g_source_remove (line_art->priv->idle_id);
+      line_art->priv->idle_id = 0;
     }
+
+  data = gimp_line_art_prepare_data (line_art);
+
+  cairo_region_get_extents (line_art->priv->dirty_region,
+                            (cairo_rectangle_int_t *) &data->rect);
+
+  /* the previous result is updated in place by the async, and is
+   * therefore handed over to it.  gimp_line_art_get() waits for the
+   * async, so it's never seen half-updated.
+   */
+  data->closed  = g_steal_pointer (&line_art->priv->closed);
+  data->distmap = g_steal_pointer (&line_art->priv->distmap);
+
+  gimp_line_art_start_async (line_art, data);
+}
+
+static void
+gimp_line_art_start_async (GimpLineArt *line_art,
+                           LineArtData *data)
+{
+  line_art->priv->async = gimp_parallel_run_async_labeled_full (
+    "line-art", +1,
+    (GimpRunAsyncFunc) gimp_line_art_prepare_async_func,
+    data, (GDestroyNotify) line_art_data_free);
+
+  /* the async's snapshot of the input includes all the changes so far */
+  g_clear_pointer (&line_art->priv->dirty_region, cairo_region_destroy);
+
+  g_signal_emit (line_art, gimp_line_art_signals[COMPUTING_START], 0);
+
+  gimp_async_add_callback_for_object (line_art->priv->async,
+                                      (GimpAsyncCallback) gimp_line_art_compute_cb,
+                                      line_art, line_art);
 }
 
 static void
@@ -665,20 +845,34 @@ gimp_line_art_compute_cb (GimpAsync   *async,
     }
 
   g_clear_object (&line_art->priv->async);
+
+  /* catch up with the changes made while computing */
+  if (line_art->priv->dirty_region && ! line_art->priv->idle_id)
+    {
+      line_art->priv->idle_id = g_idle_add_full (
+        GIMP_PRIORITY_VIEWABLE_IDLE,
+        (GSourceFunc) gimp_line_art_idle,
+        line_art, NULL);
+    }
 }
 
-static GimpAsync *
-gimp_line_art_prepare_async (GimpLineArt *line_art,
-                             gint         priority)
+static LineArtData *
+gimp_line_art_prepare_data (GimpLineArt *line_art)
 {
   GeglBuffer  *buffer;
-  GimpAsync   *async;
   LineArtData *data;
 
   g_return_val_if_fail (GIMP_IS_PICKABLE (line_art->priv->input), NULL);
 
+  /* flushing the pickable may trigger our signal handlers, which would
+   * schedule another computation of the changes we're about to include.
+   */
+  g_signal_handlers_block_by_data (line_art->priv->input, line_art);
+
   gimp_pickable_flush (line_art->priv->input);
 
+  g_signal_handlers_unblock_by_data (line_art->priv->input, line_art);
+
   buffer = gimp_gegl_buffer_dup (
     gimp_pickable_get_buffer (line_art->priv->input));
 
@@ -686,25 +880,24 @@ gimp_line_art_prepare_async (GimpLineArt *line_art,
 
   g_object_unref (buffer);
 
-  async = gimp_parallel_run_async_full (
-    priority,
-    (GimpRunAsyncFunc) gimp_line_art_prepare_async_func,
-    data, (GDestroyNotify) line_art_data_free);
-
-  return async;
+  return data;
 }
 
 static void
 gimp_line_art_prepare_async_func (GimpAsync   *async,
                                   LineArtData *data)
 {
-  GeglBuffer *buffer;
-  GeglBuffer *closed  = NULL;
-  gfloat     *distmap = NULL;
-  gint        buffer_x;
-  gint        buffer_y;
-  gboolean    has_alpha;
-  gboolean    select_transparent = FALSE;
+  const GeglRectangle *extent;
+  GeglBuffer          *buffer;
+  GeglBuffer          *closed  = NULL;
+  gfloat              *distmap = NULL;
+  GeglRectangle        area;
+  GeglRectangle        splice;
+  gint                 buffer_x;
+  gint                 buffer_y;
+  gboolean             has_alpha;
+  gboolean             select_transparent = FALSE;
+  gboolean             update;
 
   has_alpha = babl_format_has_alpha (gegl_buffer_get_format (data->buffer));
 
@@ -753,17 +946,65 @@ gimp_line_art_prepare_async_func (GimpAsync   *async,
         }
     }
 
-  buffer   = data->buffer;
-  buffer_x = gegl_buffer_get_x (data->buffer);
-  buffer_y = gegl_buffer_get_y (data->buffer);
+  extent = gegl_buffer_get_extent (data->buffer);
+
+  /* a previous result can only be updated if the input's size didn't
+   * change
+   */
+  update = data->closed &&
+           gegl_rectangle_equal (gegl_buffer_get_extent (data->closed),
+                                 extent);
+
+  if (update)
+    {
+      gint margin = 0;
+
+      if (data->automatic_closure)
+        margin = MAX (data->spline_max_len, data->segment_max_len);
+
+      /* closures whose end points are within the changed area may reach
+       * up to 'margin' pixels away from it, and their end points may be
+       * paired with others up to 'margin' pixels further.
+       */
+      gegl_rectangle_intersect (&splice,
+                                GEGL_RECTANGLE (data->rect.x - margin,
+                                                data->rect.y - margin,
+                                                data->rect.width  + 2 * margin,
+                                                data->rect.height + 2 * margin),
+                                extent);
+
+      margin += UPDATE_CONTEXT;
+
+      gegl_rectangle_intersect (&area,
+                                GEGL_RECTANGLE (splice.x - margin,
+                                                splice.y - margin,
+                                                splice.width  + 2 * margin,
+                                                splice.height + 2 * margin),
+                                extent);
+
+      buffer = gegl_buffer_create_sub_buffer (data->buffer, &area);
+    }
+  else
+    {
+      area   = *extent;
+      buffer = g_object_ref (data->buffer);
+    }
+
+  buffer_x = area.x;
+  buffer_y = area.y;
 
   if (buffer_x != 0 || buffer_y != 0)
     {
-      buffer = g_object_new (GEGL_TYPE_BUFFER,
-                             "source",  buffer,
-                             "shift-x", buffer_x,
-                             "shift-y", buffer_y,
-                             NULL);
+      GeglBuffer *shifted;
+
+      shifted = g_object_new (GEGL_TYPE_BUFFER,
+                              "source",  buffer,
+                              "shift-x", buffer_x,
+                              "shift-y", buffer_y,
+                              NULL);
+
+      g_object_unref (buffer);
+      buffer = shifted;
     }
 
   /* For smart selection, we generate a binarized image with close
@@ -803,12 +1044,40 @@ gimp_line_art_prepare_async_func (GimpAsync   *async,
 
   GIMP_TIMER_END("close line-art");
 
-  if (buffer != data->buffer)
-    g_object_unref (buffer);
+  g_object_unref (buffer);
 
   if (! gimp_async_is_stopped (async))
     {
-      if (buffer_x != 0 || buffer_y != 0)
+      if (update)
+        {
+          gint y;
+
+          /* splice the recomputed area into the previous result */
+          gimp_gegl_buffer_copy (closed,
+                                 GEGL_RECTANGLE (splice.x - area.x,
+                                                 splice.y - area.y,
+                                                 splice.width,
+                                                 splice.height),
+                                 GEGL_ABYSS_NONE,
+                                 data->closed,
+                                 GEGL_RECTANGLE (splice.x, splice.y, 0, 0));
+
+          for (y = 0; y < splice.height; y++)
+            {
+              memcpy (data->distmap + (splice.x - extent->x) +
+                                      (splice.y - extent->y + y) * extent->width,
+                      distmap + (splice.x - area.x) +
+                                (splice.y - area.y + y) * area.width,
+                      splice.width * sizeof (gfloat));
+            }
+
+          g_object_unref (closed);
+          g_free (distmap);
+
+          closed  = g_steal_pointer (&data->closed);
+          distmap = g_steal_pointer (&data->distmap);
+        }
+      else if (buffer_x != 0 || buffer_y != 0)
         {
           buffer = g_object_new (GEGL_TYPE_BUFFER,
                                  "source",  closed,
@@ -842,6 +1111,9 @@ line_art_data_new (GeglBuffer  *buffer,
   data->spline_max_len     = line_art->priv->spline_max_len;
   data->segment_max_len    = line_art->priv->segment_max_len;
 
+  data->closed             = NULL;
+  data->distmap            = NULL;
+
   return data;
 }
 
@@ -849,6 +1121,8 @@ static void
 line_art_data_free (LineArtData *data)
 {
   g_object_unref (data->buffer);
+  g_clear_object (&data->closed);
+  g_clear_pointer (&data->distmap, g_free);
 
   g_slice_free (LineArtData, data);
 }
@@ -880,7 +1154,11 @@ gimp_line_art_idle (GimpLineArt *line_art)
 {
   line_art->priv->idle_id = 0;
 
-  gimp_line_art_compute (line_art);
+  if (line_art->priv->dirty_region)
+    gimp_line_art_compute_update (line_art);
+  else
+    /* we don't know what changed */
+    gimp_line_art_compute (line_art);
 
   return G_SOURCE_REMOVE;
 }
@@ -898,6 +1176,39 @@ gimp_line_art_input_invalidate_preview (GimpViewable *viewable,
     }
 }
 
+static void
+gimp_line_art_input_update (GimpPickable *pickable,
+                            gint          x,
+                            gint          y,
+                            gint          width,
+                            gint          height,
+                            GimpLineArt  *line_art)
+{
+  const GeglRectangle *extent;
+  GeglRectangle        rect;
+
+  extent = gegl_buffer_get_extent (gimp_pickable_get_buffer (pickable));
+
+  if (width < 0 || height < 0)
+    {
+      rect = *extent;
+    }
+  else if (! gegl_rectangle_intersect (&rect,
+                                       GEGL_RECTANGLE (x, y, width, height),
+                                       extent))
+    {
+      return;
+    }
+
+  if (! line_art->priv->dirty_region)
+    line_art->priv->dirty_region = cairo_region_create ();
+
+  cairo_region_union_rectangle (line_art->priv->dirty_region,
+                                (const cairo_rectangle_int_t *) &rect);
+
+  gimp_line_art_input_invalidate_preview (GIMP_VIEWABLE (pickable), line_art);
+}
+
 /* All actual computation functions. */
 
 /**
@@ -1577,18 +1888,15 @@ gimp_lineart_compute_normals_curvatures (GeglBuffer *mask,
                                          int         normal_estimate_mask_size,
                                          GimpAsync  *async)
 {
-  gfloat  *edgels_curvatures  = NULL;
-  gfloat  *smoothed_curvature;
-  GArray  *es                 = NULL;
-  Edgel  **e;
-  gint     width              = gegl_buffer_get_width (mask);
+  EdgelSetPass  pass              = { 0, };
+  gfloat       *edgels_curvatures = NULL;
+  EdgelSet     *es                = NULL;
+  gint          width             = gegl_buffer_get_width (mask);
 
   es = gimp_edgelset_new (mask, async);
   if (gimp_async_is_stopped (async))
     goto end;
 
-  e = (Edgel **) es->data;
-
   gimp_edgelset_smooth_normals (es, normal_estimate_mask_size, async);
   if (gimp_async_is_stopped (async))
     goto end;
@@ -1597,118 +1905,143 @@ gimp_lineart_compute_normals_curvatures (GeglBuffer *mask,
   if (gimp_async_is_stopped (async))
     goto end;
 
-  while (*e)
-    {
-      const float curvature = ((*e)->curvature > 0.0f) ? (*e)->curvature : 0.0f;
-      const float w         = MAX (1e-8f, curvature * curvature);
+  /* Smooth curvatures on edgels, then take maximum on each pixel. */
+  edgels_curvatures = gimp_lineart_get_smooth_curvatures (es, async);
+  if (gimp_async_is_stopped (async))
+    goto end;
 
-      if (gimp_async_is_canceled (async))
-        {
-          gimp_async_abort (async);
+  pass.set                 = es;
+  pass.async               = async;
+  pass.width               = width;
+  pass.height              = gegl_buffer_get_height (mask);
+  pass.normals             = normals;
+  pass.curvatures          = curvatures;
+  pass.smoothed_curvatures = smoothed_curvatures;
+  pass.edgels_curvatures   = edgels_curvatures;
+
+  /* the edgels of each row only touch the pixels of that row, so the rows
+   * can be processed in parallel.
+   */
+  gimp_edgelset_run_pass (
+    pass.height, PIXELS_PER_THREAD / MAX (width, 1),
+    (GeglParallelDistributeRangeFunc) gimp_lineart_normals_curvatures_rows,
+    &pass);
 
-          goto end;
-        }
+ end:
+  g_free (edgels_curvatures);
 
-      normals[((*e)->x + (*e)->y * width) * 2] += w * (*e)->x_normal;
-      normals[((*e)->x + (*e)->y * width) * 2 + 1] += w * (*e)->y_normal;
-      curvatures[(*e)->x + (*e)->y * width] = MAX (curvature,
-                                                   curvatures[(*e)->x + (*e)->y * width]);
-      e++;
-    }
-  for (int y = 0; y < gegl_buffer_get_height (mask); ++y)
-    {
-      if (gimp_async_is_canceled (async))
-        {
-          gimp_async_abort (async);
+  if (es)
+    gimp_edgelset_free (es);
+}
 
-          goto end;
-        }
+static void
+gimp_lineart_normals_curvatures_rows (gsize         offset,
+                                      gsize         size,
+                                      EdgelSetPass *pass)
+{
+  EdgelSet *set   = pass->set;
+  gint      width = pass->width;
+  gint      y;
 
-      for (int x = 0; x < gegl_buffer_get_width (mask); ++x)
-        {
-          const float _angle = atan2f (normals[(x + y * width) * 2 + 1],
-                                       normals[(x + y * width) * 2]);
-          normals[(x + y * width) * 2] = cosf (_angle);
-          normals[(x + y * width) * 2 + 1] = sinf (_angle);
-        }
-    }
+  if (gimp_async_is_canceled (pass->async))
+    return;
 
-  /* Smooth curvatures on edgels, then take maximum on each pixel. */
-  edgels_curvatures = gimp_lineart_get_smooth_curvatures (es, async);
-  if (gimp_async_is_stopped (async))
-    goto end;
+  for (y = offset; y < offset + size; y++)
+    {
+      gfloat *normals = pass->normals + y * width * 2;
+      guint   i;
+      gint    x;
 
-  smoothed_curvature = edgels_curvatures;
+      for (i = set->row_start[y]; i < set->row_start[y + 1]; i++)
+        {
+          const float curvature = (set->curvature[i] > 0.0f) ? set->curvature[i] : 0.0f;
+          const float w         = MAX (1e-8f, curvature * curvature);
+          gint        p         = set->x[i] + y * width;
 
-  e = (Edgel **) es->data;
-  while (*e)
-    {
-      gfloat *pixel_curvature = &smoothed_curvatures[(*e)->x + (*e)->y * width];
+          normals[set->x[i] * 2]     += w * set->x_normal[i];
+          normals[set->x[i] * 2 + 1] += w * set->y_normal[i];
 
-      if (*pixel_curvature < *smoothed_curvature)
-        *pixel_curvature = *smoothed_curvature;
+          pass->curvatures[p] = MAX (curvature, pass->curvatures[p]);
 
-      ++smoothed_curvature;
-      e++;
-    }
+          if (pass->smoothed_curvatures[p] < pass->edgels_curvatures[i])
+            pass->smoothed_curvatures[p] = pass->edgels_curvatures[i];
+        }
 
- end:
-  g_free (edgels_curvatures);
+      for (x = 0; x < width; x++)
+        {
+          const float _angle = atan2f (normals[x * 2 + 1], normals[x * 2]);
 
-  if (es)
-    g_array_free (es, TRUE);
+          normals[x * 2]     = cosf (_angle);
+          normals[x * 2 + 1] = sinf (_angle);
+        }
+    }
 }
 
 static gfloat *
-gimp_lineart_get_smooth_curvatures (GArray    *edgelset,
+gimp_lineart_get_smooth_curvatures (EdgelSet  *edgelset,
                                     GimpAsync *async)
 {
-  Edgel  **e;
-  gfloat  *smoothed_curvatures = g_new0 (gfloat, edgelset->len);
-  gfloat   weights[9];
-  gfloat   smoothed_curvature;
-  gfloat   weights_sum;
-  gint     idx = 0;
+  EdgelSetPass  pass                = { 0, };
+  gfloat       *smoothed_curvatures = g_new0 (gfloat, edgelset->len);
+  gfloat        weights[9];
 
   weights[0] = 1.0f;
   for (int i = 1; i <= 8; ++i)
     weights[i] = expf (-(i * i) / 30.0f);
 
-  e = (Edgel **) edgelset->data;
-  while (*e)
+  pass.set               = edgelset;
+  pass.async             = async;
+  pass.weights           = weights;
+  pass.edgels_curvatures = smoothed_curvatures;
+
+  if (! gimp_edgelset_run_pass (
+          edgelset->len, PIXELS_PER_THREAD / 5,
+          (GeglParallelDistributeRangeFunc) gimp_lineart_smooth_curvatures_range,
+          &pass))
     {
-      Edgel *edgel_before = g_array_index (edgelset, Edgel*, (*e)->previous);
-      Edgel *edgel_after  = g_array_index (edgelset, Edgel*, (*e)->next);
-      int    n = 5;
-      int    i = 1;
+      g_free (smoothed_curvatures);
 
-      if (gimp_async_is_canceled (async))
-        {
-          gimp_async_abort (async);
+      return NULL;
+    }
 
-          g_free (smoothed_curvatures);
+  return smoothed_curvatures;
+}
 
-          return NULL;
-        }
+static void
+gimp_lineart_smooth_curvatures_range (gsize         offset,
+                                      gsize         size,
+                                      EdgelSetPass *pass)
+{
+  EdgelSet     *set     = pass->set;
+  const gfloat *weights = pass->weights;
+  guint         e;
+
+  if (gimp_async_is_canceled (pass->async))
+    return;
+
+  for (e = offset; e < offset + size; e++)
+    {
+      guint  edgel_before = set->previous[e];
+      guint  edgel_after  = set->next[e];
+      gfloat smoothed_curvature;
+      gfloat weights_sum;
+      int    n = 5;
+      int    i = 1;
 
-      smoothed_curvature = (*e)->curvature;
+      smoothed_curvature = set->curvature[e];
       weights_sum = weights[0];
       while (n-- && (edgel_after != edgel_before))
         {
-          smoothed_curvature += weights[i] * edgel_before->curvature;
-          smoothed_curvature += weights[i] * edgel_after->curvature;
-          edgel_before = g_array_index (edgelset, Edgel*, edgel_before->previous);
-          edgel_after  = g_array_index (edgelset, Edgel*, edgel_after->next);
+          smoothed_curvature += weights[i] * set->curvature[edgel_before];
+          smoothed_curvature += weights[i] * set->curvature[edgel_after];
+          edgel_before = set->previous[edgel_before];
+          edgel_after  = set->next[edgel_after];
           weights_sum += 2 * weights[i];
           i++;
         }
       smoothed_curvature /= weights_sum;
-      smoothed_curvatures[idx++] = smoothed_curvature;
-
-      e++;
+      pass->edgels_curvatures[e] = smoothed_curvature;
     }
-
-  return smoothed_curvatures;
 }
 
 /**
@@ -1961,23 +2294,98 @@ gimp_lineart_find_spline_candidates (GArray    *max_positions,
                                      gfloat     max_angle_deg,
                                      GimpAsync *async)
 {
-  GList       *candidates = NULL;
-  const float  CosMin     = cosf (M_PI * (max_angle_deg / 180.0));
-  gint         i;
+  SplineCandidatesData  data;
+  GArray               *all;
+  GList                *candidates = NULL;
+  gint                  n          = max_positions->len;
+  gint                  i;
+
+  data.max_positions      = max_positions;
+  data.normals            = normals;
+  data.width              = width;
+  data.distance_threshold = distance_threshold;
+  data.cos_min            = cosf (M_PI * (max_angle_deg / 180.0));
+  data.candidates         = g_new0 (GArray *, MAX (n, 1));
+  data.async              = async;
+
+  /* each range of positions is paired with all the following ones, and
+   * the found candidates are stored at the range's offset, so that they
+   * can be collected in the same order regardless of the threads.
+   */
+  gegl_parallel_distribute_range (
+    n, MAX (PIXELS_PER_THREAD / MAX (n, 1), 1),
+    (GeglParallelDistributeRangeFunc) gimp_lineart_find_spline_candidates_range,
+    &data);
+
+  all = g_array_new (FALSE, FALSE, sizeof (SplineCandidate));
 
-  for (i = 0; i < max_positions->len; i++)
+  /* candidates of equal quality are sorted in the reverse order of their
+   * discovery, as with an insertion sort, hence collect them backwards
+   * for the stable sort below.
+   */
+  for (i = n - 1; i >= 0; i--)
     {
-      Pixel p1 = g_array_index (max_positions, Pixel, i);
-      gint  j;
+      GArray *range = data.candidates[i];
+      gint    j;
 
-      if (gimp_async_is_canceled (async))
-        {
-          gimp_async_abort (async);
+      if (! range)
+        continue;
 
-          g_list_free_full (candidates, g_free);
+      for (j = (gint) range->len - 1; j >= 0; j--)
+        g_array_append_val (all, g_array_index (range, SplineCandidate, j));
 
-          return NULL;
-        }
+      g_array_free (range, TRUE);
+    }
+
+  g_free (data.candidates);
+
+  if (gimp_async_is_canceled (async))
+    {
+      gimp_async_abort (async);
+
+      g_array_free (all, TRUE);
+
+      return NULL;
+    }
+
+  g_array_sort_with_data (all,
+                          (GCompareDataFunc) gimp_spline_candidate_cmp,
+                          NULL);
+
+  for (i = (gint) all->len - 1; i >= 0; i--)
+    {
+      candidates = g_list_prepend (candidates,
+                                   g_memdup2 (&g_array_index (all, SplineCandidate, i),
+                                              sizeof (SplineCandidate)));
+    }
+
+  g_array_free (all, TRUE);
+
+  return candidates;
+}
+
+static void
+gimp_lineart_find_spline_candidates_range (gsize                 offset,
+                                           gsize                 size,
+                                           SplineCandidatesData *data)
+{
+  GArray       *max_positions      = data->max_positions;
+  gfloat       *normals            = data->normals;
+  gint          width              = data->width;
+  gint          distance_threshold = data->distance_threshold;
+  const float   CosMin             = data->cos_min;
+  GArray       *candidates;
+  gint          i;
+
+  if (gimp_async_is_canceled (data->async))
+    return;
+
+  candidates = g_array_new (FALSE, FALSE, sizeof (SplineCandidate));
+
+  for (i = offset; i < offset + size; i++)
+    {
+      Pixel p1 = g_array_index (max_positions, Pixel, i);
+      gint  j;
 
       for (j = i + 1; j < max_positions->len; j++)
         {
@@ -2014,20 +2422,19 @@ gimp_lineart_find_spline_candidates (GArray    *max_positions,
               quality = qualityA * qualityB * qualityC;
               if (quality > 0)
                 {
-                  SplineCandidate *candidate = g_new (SplineCandidate, 1);
+                  SplineCandidate candidate;
 
-                  candidate->p1      = p1;
-                  candidate->p2      = p2;
-                  candidate->quality = quality;
+                  candidate.p1      = p1;
+                  candidate.p2      = p2;
+                  candidate.quality = quality;
 
-                  candidates = g_list_insert_sorted_with_data (candidates, candidate,
-                                                               (GCompareDataFunc) gimp_spline_candidate_cmp,
-                                                               NULL);
+                  g_array_append_val (candidates, candidate);
                 }
             }
         }
     }
-  return candidates;
+
+  data->candidates[offset] = candidates;
 }
 
 static GArray *
@@ -2543,22 +2950,6 @@ pair2normal (Pixel   p,
 }
 /* Edgel functions */
 
-static Edgel *
-gimp_edgel_new (int       x,
-                int       y,
-                Direction direction)
-{
-  Edgel *edgel = g_new (Edgel, 1);
-
-  edgel->x         = x;
-  edgel->y         = y;
-  edgel->direction = direction;
-
-  gimp_edgel_init (edgel);
-
-  return edgel;
-}
-
 static void
 gimp_edgel_init (Edgel *edgel)
 {
@@ -2568,12 +2959,6 @@ gimp_edgel_init (Edgel *edgel)
   edgel->next      = edgel->previous = G_MAXUINT;
 }
 
-static void
-gimp_edgel_clear (Edgel **edgel)
-{
-  g_clear_pointer (edgel, g_free);
-}
-
 static int
 gimp_edgel_cmp (const Edgel* e1,
                 const Edgel* e2)
@@ -2590,23 +2975,6 @@ gimp_edgel_cmp (const Edgel* e1,
     return 1;
 }
 
-static guint
-edgel2index_hash_fun (Edgel *key)
-{
-  /* Cantor pairing function.
-   * Was not sure how to use the direction though. :-/
-   */
-  return (key->x + key->y) * (key->x + key->y + 1) / 2 + key->y * key->direction;
-}
-
-static gboolean
-edgel2index_equal_fun (Edgel *e1,
-                       Edgel *e2)
-{
-  return (e1->x == e2->x && e1->y == e2->y &&
-          e1->direction == e2->direction);
-}
-
 /**
  * @mask;
  * @edgel:
@@ -2690,91 +3058,86 @@ gimp_edgel_region_area (const GeglBuffer *mask,
 
 /* Edgel sets */
 
-static GArray *
+static EdgelSet *
 gimp_edgelset_new (GeglBuffer *buffer,
                    GimpAsync  *async)
 {
-  GeglBufferIterator *gi;
-  GArray             *set;
-  GHashTable         *edgel2index;
-  gint                width  = gegl_buffer_get_width (buffer);
-  gint                height = gegl_buffer_get_height (buffer);
+  EdgelSetPass  pass   = { 0, };
+  EdgelSet     *set;
+  guint8       *mask   = NULL;
+  gint          width  = gegl_buffer_get_width (buffer);
+  gint          height = gegl_buffer_get_height (buffer);
+  guint         len    = 0;
+  gint          y;
+
+  set = g_slice_new0 (EdgelSet);
 
-  set = g_array_new (TRUE, TRUE, sizeof (Edgel *));
-  g_array_set_clear_func (set, (GDestroyNotify) gimp_edgel_clear);
+  set->row_start = g_new0 (guint, height + 1);
 
   if (width <= 1 || height <= 1)
     return set;
 
-  edgel2index = g_hash_table_new ((GHashFunc) edgel2index_hash_fun,
-                                  (GEqualFunc) edgel2index_equal_fun);
-
-  gi = gegl_buffer_iterator_new (buffer, GEGL_RECTANGLE (0, 0, width, height),
-                                 0, NULL, GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 5);
-  gegl_buffer_iterator_add (gi, buffer, GEGL_RECTANGLE (0, -1, width, height),
-                            0, NULL, GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
-  gegl_buffer_iterator_add (gi, buffer, GEGL_RECTANGLE (0, 1, width, height),
-                            0, NULL, GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
-  gegl_buffer_iterator_add (gi, buffer, GEGL_RECTANGLE (-1, 0, width, height),
-                            0, NULL, GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
-  gegl_buffer_iterator_add (gi, buffer, GEGL_RECTANGLE (1, 0, width, height),
-                            0, NULL, GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
-  while (gegl_buffer_iterator_next (gi))
-    {
-      guint8 *p      = (guint8*) gi->items[0].data;
-      guint8 *prevy  = (guint8*) gi->items[1].data;
-      guint8 *nexty  = (guint8*) gi->items[2].data;
-      guint8 *prevx  = (guint8*) gi->items[3].data;
-      guint8 *nextx  = (guint8*) gi->items[4].data;
-      gint    startx = gi->items[0].roi.x;
-      gint    starty = gi->items[0].roi.y;
-      gint    endy   = starty + gi->items[0].roi.height;
-      gint    endx   = startx + gi->items[0].roi.width;
-      gint    x;
-      gint    y;
+  /* the whole mask is read upfront, so that the passes below can look at
+   * it from any thread, without going through the buffer.
+   */
+  mask = g_malloc (width * height);
 
-      if (gimp_async_is_canceled (async))
-        {
-          gegl_buffer_iterator_stop (gi);
+  gegl_buffer_get (buffer, GEGL_RECTANGLE (0, 0, width, height), 1.0,
+                   NULL, mask, GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
 
-          gimp_async_abort (async);
+  pass.set    = set;
+  pass.async  = async;
+  pass.mask   = mask;
+  pass.width  = width;
+  pass.height = height;
 
-          goto end;
-        }
+  /* count the edgels of each row, so that each row knows where its edgels
+   * go in the set, and the rows can be added in parallel.
+   */
+  if (! gimp_edgelset_run_pass (
+          height, PIXELS_PER_THREAD / width,
+          (GeglParallelDistributeRangeFunc) gimp_edgelset_count_rows,
+          &pass))
+    {
+      goto end;
+    }
 
-      for (y = starty; y < endy; y++)
-        for (x = startx; x < endx; x++)
-          {
-            if (*(p++))
-              {
-                if (! *prevy)
-                  gimp_edgelset_add (set, x, y, YMinusDirection, edgel2index);
-                if (! *nexty)
-                  gimp_edgelset_add (set, x, y, YPlusDirection, edgel2index);
-                if (! *prevx)
-                  gimp_edgelset_add (set, x, y, XMinusDirection, edgel2index);
-                if (! *nextx)
-                  gimp_edgelset_add (set, x, y, XPlusDirection, edgel2index);
-              }
-            prevy++;
-            nexty++;
-            prevx++;
-            nextx++;
-          }
+  for (y = 0; y < height; y++)
+    {
+      guint count = set->row_start[y + 1];
+
+      set->row_start[y] = len;
+      len += count;
     }
 
-  gimp_edgelset_build_graph (set, buffer, edgel2index, async);
-  if (gimp_async_is_stopped (async))
-    goto end;
+  set->row_start[height] = len;
+  set->len               = len;
+
+  set->x         = g_new (gint,      len);
+  set->y         = g_new (gint,      len);
+  set->direction = g_new (Direction, len);
+  set->x_normal  = g_new (gfloat,    len);
+  set->y_normal  = g_new (gfloat,    len);
+  set->curvature = g_new (gfloat,    len);
+  set->next      = g_new (guint,     len);
+  set->previous  = g_new (guint,     len);
+
+  if (! gimp_edgelset_run_pass (
+          height, PIXELS_PER_THREAD / width,
+          (GeglParallelDistributeRangeFunc) gimp_edgelset_add_rows,
+          &pass))
+    {
+      goto end;
+    }
 
-  gimp_edgelset_init_normals (set);
+  gimp_edgelset_build_graph (&pass);
 
  end:
-  g_hash_table_destroy (edgel2index);
+  g_free (mask);
 
   if (gimp_async_is_stopped (async))
     {
-      g_array_free (set, TRUE);
+      gimp_edgelset_free (set);
       set = NULL;
     }
 
@@ -2782,44 +3145,186 @@ gimp_edgelset_new (GeglBuffer *buffer,
 }
 
 static void
-gimp_edgelset_add (GArray     *set,
-                   int         x,
-                   int         y,
-                   Direction   direction,
-                   GHashTable *edgel2index)
+gimp_edgelset_free (EdgelSet *set)
+{
+  g_free (set->x);
+  g_free (set->y);
+  g_free (set->direction);
+  g_free (set->x_normal);
+  g_free (set->y_normal);
+  g_free (set->curvature);
+  g_free (set->next);
+  g_free (set->previous);
+  g_free (set->row_start);
+
+  g_slice_free (EdgelSet, set);
+}
+
+/* runs 'func' over 'size' rows or edgels, in parallel, and aborts 'async'
+ * if it got canceled in the meantime.
+ *
+ * returns FALSE if 'async' was aborted.
+ */
+static gboolean
+gimp_edgelset_run_pass (gsize                            size,
+                        gdouble                          cost,
+                        GeglParallelDistributeRangeFunc  func,
+                        EdgelSetPass                    *pass)
 {
-  Edgel         *edgel    = gimp_edgel_new (x, y, direction);
-  unsigned long  position = set->len;
+  gegl_parallel_distribute_range (size, MAX (cost, 1.0), func, pass);
+
+  if (gimp_async_is_canceled (pass->async))
+    {
+      gimp_async_abort (pass->async);
 
-  g_array_append_val (set, edgel);
-  g_hash_table_insert (edgel2index, edgel, GUINT_TO_POINTER (position));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static inline gboolean
+gimp_edgelset_has_edgel (const EdgelSetPass *pass,
+                         gint                x,
+                         gint                y,
+                         Direction           direction)
+{
+  x += DeltaX[direction];
+  y += DeltaY[direction];
+
+  return x < 0 || x >= pass->width  ||
+         y < 0 || y >= pass->height ||
+         ! pass->mask[x + y * pass->width];
 }
 
 static void
-gimp_edgelset_init_normals (GArray *set)
+gimp_edgelset_count_rows (gsize         offset,
+                          gsize         size,
+                          EdgelSetPass *pass)
+{
+  gint y;
+
+  if (gimp_async_is_canceled (pass->async))
+    return;
+
+  for (y = offset; y < offset + size; y++)
+    {
+      const guint8 *p     = pass->mask + y * pass->width;
+      guint         count = 0;
+      gint          x;
+
+      for (x = 0; x < pass->width; x++)
+        {
+          if (p[x])
+            {
+              gint d;
+
+              for (d = 0; d < 4; d++)
+                count += gimp_edgelset_has_edgel (pass, x, y, d);
+            }
+        }
+
+      pass->set->row_start[y + 1] = count;
+    }
+}
+
+static void
+gimp_edgelset_add_rows (gsize         offset,
+                        gsize         size,
+                        EdgelSetPass *pass)
+{
+  /* the order in which the edgels of a pixel are added */
+  static const Direction directions[4] = { YMinusDirection,
+                                           YPlusDirection,
+                                           XMinusDirection,
+                                           XPlusDirection };
+  EdgelSet *set = pass->set;
+  gint      y;
+
+  if (gimp_async_is_canceled (pass->async))
+    return;
+
+  for (y = offset; y < offset + size; y++)
+    {
+      const guint8 *p = pass->mask + y * pass->width;
+      guint         i = set->row_start[y];
+      gint          x;
+
+      for (x = 0; x < pass->width; x++)
+        {
+          gint d;
+
+          if (! p[x])
+            continue;
+
+          for (d = 0; d < 4; d++)
+            {
+              Direction direction = directions[d];
+
+              if (gimp_edgelset_has_edgel (pass, x, y, direction))
+                {
+                  set->x[i]         = x;
+                  set->y[i]         = y;
+                  set->direction[i] = direction;
+                  set->x_normal[i]  = Direction2Normal[direction].x;
+                  set->y_normal[i]  = Direction2Normal[direction].y;
+                  set->curvature[i] = 0.0f;
+                  set->next[i]      = set->previous[i] = G_MAXUINT;
+
+                  i++;
+                }
+            }
+        }
+    }
+}
+
+/* returns the index of 'edgel' in 'set', or G_MAXUINT if it's not there */
+static guint
+gimp_edgelset_find (const EdgelSet *set,
+                    gint            height,
+                    const Edgel    *edgel)
 {
-  Edgel **e = (Edgel**) set->data;
+  guint lo;
+  guint hi;
+  guint end;
 
-  while (*e)
+  if (edgel->y < 0 || edgel->y >= height)
+    return G_MAXUINT;
+
+  lo  = set->row_start[edgel->y];
+  end = hi = set->row_start[edgel->y + 1];
+
+  /* find the first edgel of the pixel; the edgels of each row are sorted
+   * by x
+   */
+  while (lo < hi)
     {
-      GimpVector2 n = Direction2Normal[(*e)->direction];
+      guint mid = lo + (hi - lo) / 2;
+
+      if (set->x[mid] < edgel->x)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
 
-      (*e)->x_normal = n.x;
-      (*e)->y_normal = n.y;
-      e++;
+  for (; lo < end && set->x[lo] == edgel->x; lo++)
+    {
+      if (set->direction[lo] == edgel->direction)
+        return lo;
     }
+
+  return G_MAXUINT;
 }
 
 static void
-gimp_edgelset_smooth_normals (GArray    *set,
+gimp_edgelset_smooth_normals (EdgelSet  *set,
                               int        mask_size,
                               GimpAsync *async)
 {
+  EdgelSetPass pass  = { 0, };
   const gfloat sigma = mask_size * 0.775;
   const gfloat den   = 2 * sigma * sigma;
   gfloat       weights[65];
-  GimpVector2  smoothed_normal;
-  gint         i;
 
   gimp_assert (mask_size <= 65);
 
@@ -2827,96 +3332,155 @@ gimp_edgelset_smooth_normals (GArray    *set,
   for (int i = 1; i <= mask_size; ++i)
     weights[i] = expf (-(i * i) / den);
 
-  for (i = 0; i < set->len; i++)
-    {
-      Edgel *it           = g_array_index (set, Edgel*, i);
-      Edgel *edgel_before = g_array_index (set, Edgel*, it->previous);
-      Edgel *edgel_after  = g_array_index (set, Edgel*, it->next);
-      int    n = mask_size;
-      int    i = 1;
+  pass.set       = set;
+  pass.async     = async;
+  pass.weights   = weights;
+  pass.mask_size = mask_size;
 
-      if (gimp_async_is_canceled (async))
-        {
-          gimp_async_abort (async);
+  gimp_edgelset_run_pass (
+    set->len, PIXELS_PER_THREAD / MAX (mask_size, 1),
+    (GeglParallelDistributeRangeFunc) gimp_edgelset_smooth_normals_range,
+    &pass);
+}
 
-          return;
-        }
+static void
+gimp_edgelset_smooth_normals_range (gsize         offset,
+                                    gsize         size,
+                                    EdgelSetPass *pass)
+{
+  EdgelSet     *set     = pass->set;
+  const gfloat *weights = pass->weights;
+  GimpVector2   smoothed_normal;
+  guint         e;
+
+  if (gimp_async_is_canceled (pass->async))
+    return;
 
-      smoothed_normal = Direction2Normal[it->direction];
+  /* the smoothed normals only depend on the edgels' directions, so each
+   * edgel can be processed independently.
+   */
+  for (e = offset; e < offset + size; e++)
+    {
+      guint edgel_before = set->previous[e];
+      guint edgel_after  = set->next[e];
+      int   n = pass->mask_size;
+      int   i = 1;
+
+      smoothed_normal = Direction2Normal[set->direction[e]];
       while (n-- && (edgel_after != edgel_before))
         {
           smoothed_normal = gimp_vector2_add_val (smoothed_normal,
-                                                  gimp_vector2_mul_val (Direction2Normal[edgel_before->direction], weights[i]));
+                                                  gimp_vector2_mul_val (Direction2Normal[set->direction[edgel_before]], weights[i]));
           smoothed_normal = gimp_vector2_add_val (smoothed_normal,
-                                                  gimp_vector2_mul_val (Direction2Normal[edgel_after->direction], weights[i]));
-          edgel_before = g_array_index (set, Edgel *, edgel_before->previous);
-          edgel_after  = g_array_index (set, Edgel *, edgel_after->next);
+                                                  gimp_vector2_mul_val (Direction2Normal[set->direction[edgel_after]], weights[i]));
+          edgel_before = set->previous[edgel_before];
+          edgel_after  = set->next[edgel_after];
           ++i;
         }
       gimp_vector2_normalize (&smoothed_normal);
-      it->x_normal = smoothed_normal.x;
-      it->y_normal = smoothed_normal.y;
+      set->x_normal[e] = smoothed_normal.x;
+      set->y_normal[e] = smoothed_normal.y;
     }
 }
 
 static void
-gimp_edgelset_compute_curvature (GArray    *set,
+gimp_edgelset_compute_curvature (EdgelSet  *set,
                                  GimpAsync *async)
 {
-  gint i;
+  EdgelSetPass pass = { 0, };
+
+  pass.set   = set;
+  pass.async = async;
+
+  gimp_edgelset_run_pass (
+    set->len, PIXELS_PER_THREAD,
+    (GeglParallelDistributeRangeFunc) gimp_edgelset_compute_curvature_range,
+    &pass);
+}
 
-  for (i = 0; i < set->len; i++)
+static void
+gimp_edgelset_compute_curvature_range (gsize         offset,
+                                       gsize         size,
+                                       EdgelSetPass *pass)
+{
+  EdgelSet *set = pass->set;
+  guint     e;
+
+  if (gimp_async_is_canceled (pass->async))
+    return;
+
+  for (e = offset; e < offset + size; e++)
     {
-      Edgel       *it       = g_array_index (set, Edgel*, i);
-      Edgel       *previous = g_array_index (set, Edgel *, it->previous);
-      Edgel       *next     = g_array_index (set, Edgel *, it->next);
-      GimpVector2  n_prev   = gimp_vector2_new (previous->x_normal, previous->y_normal);
-      GimpVector2  n_next   = gimp_vector2_new (next->x_normal, next->y_normal);
+      guint        previous = set->previous[e];
+      guint        next     = set->next[e];
+      GimpVector2  n_prev   = gimp_vector2_new (set->x_normal[previous], set->y_normal[previous]);
+      GimpVector2  n_next   = gimp_vector2_new (set->x_normal[next], set->y_normal[next]);
       GimpVector2  diff     = gimp_vector2_mul_val (gimp_vector2_sub_val (n_next, n_prev),
                                                     0.5);
       const float  c        = gimp_vector2_length_val (diff);
       const float  crossp   = n_prev.x * n_next.y - n_prev.y * n_next.x;
 
-      it->curvature = (crossp > 0.0f) ? c : -c;
-
-      if (gimp_async_is_canceled (async))
-        {
-          gimp_async_abort (async);
-
-          return;
-        }
+      set->curvature[e] = (crossp > 0.0f) ? c : -c;
     }
 }
 
 static void
-gimp_edgelset_build_graph (GArray     *set,
-                           GeglBuffer *buffer,
-                           GHashTable *edgel2index,
-                           GimpAsync  *async)
+gimp_edgelset_build_graph (EdgelSetPass *pass)
 {
-  Edgel edgel;
-  gint  i;
+  gimp_edgelset_run_pass (
+    pass->set->len, PIXELS_PER_THREAD / 16,
+    (GeglParallelDistributeRangeFunc) gimp_edgelset_build_graph_range,
+    pass);
+}
 
-  for (i = 0; i < set->len; i++)
+static void
+gimp_edgelset_build_graph_range (gsize         offset,
+                                 gsize         size,
+                                 EdgelSetPass *pass)
+{
+  EdgelSet *set = pass->set;
+  guint     i;
+
+  if (gimp_async_is_canceled (pass->async))
+    return;
+
+  /* each edgel is the next edgel of exactly one other edgel, so the
+   * 'previous' links written below don't overlap.
+   */
+  for (i = offset; i < offset + size; i++)
     {
-      Edgel *neighbor;
-      Edgel *it = g_array_index (set, Edgel *, i);
+      Edgel  it;
+      Edgel  edgel;
+      guint8 pixels[9];
       guint  neighbor_pos;
+      gint   x;
+      gint   y;
 
-      if (gimp_async_is_canceled (async))
+      it.x         = set->x[i];
+      it.y         = set->y[i];
+      it.direction = set->direction[i];
+
+      for (y = -1; y <= 1; y++)
         {
-          gimp_async_abort (async);
+          for (x = -1; x <= 1; x++)
+            {
+              gint px = it.x + x;
+              gint py = it.y + y;
 
-          return;
+              if (px >= 0 && px < pass->width && py >= 0 && py < pass->height)
+                pixels[(x + 1) + (y + 1) * 3] = pass->mask[px + py * pass->width];
+              else
+                pixels[(x + 1) + (y + 1) * 3] = 0;
+            }
         }
 
-      gimp_edgelset_next8 (buffer, it, &edgel);
+      gimp_edgel_next8 (pixels, &it, &edgel);
 
-      gimp_assert (g_hash_table_contains (edgel2index, &edgel));
-      neighbor_pos = GPOINTER_TO_UINT (g_hash_table_lookup (edgel2index, &edgel));
-      it->next = neighbor_pos;
-      neighbor = g_array_index (set, Edgel *, neighbor_pos);
-      neighbor->previous = i;
+      neighbor_pos = gimp_edgelset_find (set, pass->height, &edgel);
+
+      gimp_assert (neighbor_pos != G_MAXUINT);
+      set->next[i] = neighbor_pos;
+      set->previous[neighbor_pos] = i;
     }
 }
 
@@ -2927,14 +3491,24 @@ gimp_edgelset_next8 (const GeglBuffer *buffer,
 {
   guint8 pixels[9];
 
+  gegl_buffer_get ((GeglBuffer *) buffer,
+                   GEGL_RECTANGLE (it->x - 1, it->y - 1, 3, 3),
+                   1.0, NULL, pixels, GEGL_AUTO_ROWSTRIDE,
+                   GEGL_ABYSS_NONE);
+
+  gimp_edgel_next8 (pixels, it, n);
+}
+
+/* finds the edgel following 'it', given the 3x3 'pixels' around it */
+static void
+gimp_edgel_next8 (const guint8 *pixels,
+                  Edgel        *it,
+                  Edgel        *n)
+{
   n->x         = it->x;
   n->y         = it->y;
   n->direction = it->direction;
 
-  gegl_buffer_get ((GeglBuffer *) buffer,
-                   GEGL_RECTANGLE (n->x - 1, n->y - 1, 3, 3),
-                   1.0, NULL, pixels, GEGL_AUTO_ROWSTRIDE,
-                   GEGL_ABYSS_NONE);
   switch (n->direction)
     {
     case XPlusDirection:
@@ -82,6 +82,25 @@ static GimpObject * gimp_list_get_child_by_index (GimpContainer           *conta
 static gint         gimp_list_get_child_index    (GimpContainer           *container,
                                                   GimpObject              *object);
 
+static void         gimp_list_name_index_add     (GimpList                *list,
+                                                  GimpObject              *object);
+static void         gimp_list_name_index_remove  (GimpList                *list,
+                                                  GimpObject              *object);
+static gboolean     gimp_list_name_taken         (GimpList                *list,
+                                                  GimpObject              *object,
+                                                  const gchar             *name);
+static gint         gimp_list_index_compare      (gconstpointer            a,
+                                                  gconstpointer            b,
+                                                  gpointer                 data);
+
+static void         gimp_list_slots_validate     (GimpList                *list);
+static void         gimp_list_slots_push_head    (GimpList                *list,
+                                                  GimpObject              *object);
+static void         gimp_list_slots_push_tail    (GimpList                *list,
+                                                  GimpObject              *object);
+static void         gimp_list_slots_remove       (GimpList                *list,
+                                                  GimpObject              *object);
+
 static void         gimp_list_uniquefy_name      (GimpList                *gimp_list,
                                                   GimpObject              *object);
 static void         gimp_list_object_renamed     (GimpObject              *object,
@@ -147,6 +166,12 @@ gimp_list_init (GimpList *list)
   list->unique_names = FALSE;
   list->sort_func    = NULL;
   list->append       = FALSE;
+
+  list->names   = g_hash_table_new (NULL, NULL);
+  list->by_name = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                         g_free,
+                                         (GDestroyNotify) g_queue_free);
+  list->slots   = g_hash_table_new (NULL, NULL);
 }
 
 static void
@@ -160,6 +185,11 @@ gimp_list_finalize (GObject *object)
       list->queue = NULL;
     }
 
+  g_clear_pointer (&list->names,      g_hash_table_unref);
+  g_clear_pointer (&list->by_name,    g_hash_table_unref);
+  g_clear_pointer (&list->slots,      g_hash_table_unref);
+  g_clear_pointer (&list->slot_array, g_free);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -234,6 +264,11 @@ gimp_list_get_memsize (GimpObject *object,
       memsize += gimp_g_queue_get_memsize (list->queue, 0);
     }
 
+  memsize += (gimp_g_hash_table_get_memsize (list->names,   0) +
+              gimp_g_hash_table_get_memsize (list->by_name, 0) +
+              gimp_g_hash_table_get_memsize (list->slots,   0) +
+              list->slot_alloc * sizeof (gpointer));
+
   return memsize + GIMP_OBJECT_CLASS (parent_class)->get_memsize (object,
                                                                   gui_size);
 }
@@ -257,23 +292,30 @@ gimp_list_add (GimpContainer *container,
   if (list->unique_names)
     gimp_list_uniquefy_name (list, object);
 
-  if (list->unique_names || list->sort_func)
-    g_signal_connect (object, "name-changed",
-                      G_CALLBACK (gimp_list_object_renamed),
-                      list);
+  g_signal_connect (object, "name-changed",
+                    G_CALLBACK (gimp_list_object_renamed),
+                    list);
+
+  gimp_list_name_index_add (list, object);
 
   if (list->sort_func)
     {
       g_queue_insert_sorted (list->queue, object, gimp_list_sort_func,
                              list->sort_func);
+
+      list->slots_valid = FALSE;
     }
   else if (list->append)
     {
       g_queue_push_tail (list->queue, object);
+
+      gimp_list_slots_push_tail (list, object);
     }
   else
     {
       g_queue_push_head (list->queue, object);
+
+      gimp_list_slots_push_head (list, object);
     }
 
   GIMP_CONTAINER_CLASS (parent_class)->add (container, object);
@@ -285,10 +327,13 @@ gimp_list_remove (GimpContainer *container,
 {
   GimpList *list = GIMP_LIST (container);
 
-  if (list->unique_names || list->sort_func)
-    g_signal_handlers_disconnect_by_func (object,
-                                          gimp_list_object_renamed,
-                                          list);
+  g_signal_handlers_disconnect_by_func (object,
+                                        gimp_list_object_renamed,
+                                        list);
+
+  gimp_list_name_index_remove (list, object);
+
+  gimp_list_slots_remove (list, object);
 
   g_queue_remove (list->queue, object);
 
@@ -310,6 +355,8 @@ gimp_list_reorder (GimpContainer *container,
   else
     g_queue_push_nth (list->queue, object, new_index);
 
+  list->slots_valid = FALSE;
+
   GIMP_CONTAINER_CLASS (parent_class)->reorder (container, object,
                                                 old_index, new_index);
 }
@@ -329,7 +376,7 @@ gimp_list_have (GimpContainer *container,
 {
   GimpList *list = GIMP_LIST (container);
 
-  return g_queue_find (list->queue, object) ? TRUE : FALSE;
+  return g_hash_table_contains (list->names, object);
 }
 
 static void
@@ -377,41 +424,48 @@ static GList *
 gimp_list_get_children_by_name (GimpContainer *container,
                                 const gchar   *name)
 {
-  GimpList *list     = GIMP_LIST (container);
-  GList    *children = NULL;
-  GList    *iter;
+  GimpList *list = GIMP_LIST (container);
+  GQueue   *bucket;
 
-  for (iter = list->queue->head; iter; iter = g_list_next (iter))
-    {
-      GimpObject *object = iter->data;
+  bucket = g_hash_table_lookup (list->by_name, name);
 
-      if (! strcmp (gimp_object_get_name (object), name))
-        {
-          children = g_list_prepend (children, object);
-          if (list->unique_names)
-            return children;
-        }
-    }
+  if (! bucket)
+    return NULL;
 
-  return children;
+  if (list->unique_names || bucket->length == 1)
+    return g_list_prepend (NULL,
+                           gimp_list_get_child_by_name (container, name));
+
+  /*  in reverse order of the list, like they used to be collected  */
+  return g_list_reverse (g_list_sort_with_data (g_list_copy (bucket->head),
+                                                gimp_list_index_compare,
+                                                list));
 }
 
 static GimpObject *
 gimp_list_get_child_by_name (GimpContainer *container,
                              const gchar   *name)
 {
-  GimpList *list = GIMP_LIST (container);
-  GList    *glist;
+  GimpList   *list = GIMP_LIST (container);
+  GQueue     *bucket;
+  GimpObject *child;
+  GList      *iter;
 
-  for (glist = list->queue->head; glist; glist = g_list_next (glist))
-    {
-      GimpObject *object = glist->data;
+  bucket = g_hash_table_lookup (list->by_name, name);
 
-      if (! strcmp (gimp_object_get_name (object), name))
-        return object;
+  if (! bucket)
+    return NULL;
+
+  child = g_queue_peek_head (bucket);
+
+  /*  the first one of the children sharing the name  */
+  for (iter = bucket->head->next; iter; iter = g_list_next (iter))
+    {
+      if (gimp_list_index_compare (iter->data, child, list) < 0)
+        child = iter->data;
     }
 
-  return NULL;
+  return child;
 }
 
 static GimpObject *
@@ -420,7 +474,12 @@ gimp_list_get_child_by_index (GimpContainer *container,
 {
   GimpList *list = GIMP_LIST (container);
 
-  return g_queue_peek_nth (list->queue, index);
+  if (index < 0 || index >= (gint) list->queue->length)
+    return NULL;
+
+  gimp_list_slots_validate (list);
+
+  return list->slot_array[list->slot_start + index];
 }
 
 static gint
@@ -428,8 +487,14 @@ gimp_list_get_child_index (GimpContainer *container,
                            GimpObject    *object)
 {
   GimpList *list = GIMP_LIST (container);
+  gpointer  slot;
+
+  gimp_list_slots_validate (list);
 
-  return g_queue_index (list->queue, (gpointer) object);
+  if (! g_hash_table_lookup_extended (list->slots, object, NULL, &slot))
+    return -1;
+
+  return GPOINTER_TO_INT (slot) - list->slot_start;
 }
 
 /**
@@ -515,6 +580,7 @@ gimp_list_reverse (GimpList *list)
     {
       gimp_container_freeze (GIMP_CONTAINER (list));
       g_queue_reverse (list->queue);
+      list->slots_valid = FALSE;
       gimp_container_thaw (GIMP_CONTAINER (list));
     }
 }
@@ -579,6 +645,7 @@ gimp_list_sort (GimpList     *list,
     {
       gimp_container_freeze (GIMP_CONTAINER (list));
       g_queue_sort (list->queue, gimp_list_sort_func, sort_func);
+      list->slots_valid = FALSE;
       gimp_container_thaw (GIMP_CONTAINER (list));
     }
 }
@@ -600,28 +667,198 @@ gimp_list_sort_by_name (GimpList *list)
 
 /*  private functions  */
 
+/*  the children are indexed by name in 'by_name', which maps each name
+ *  to the queue of children having it, while 'names' maps each child to
+ *  the name it is indexed under.
+ */
 static void
-gimp_list_uniquefy_name (GimpList   *gimp_list,
-                         GimpObject *object)
+gimp_list_name_index_add (GimpList   *list,
+                          GimpObject *object)
 {
-  gchar *name = (gchar *) gimp_object_get_name (object);
-  GList *list;
+  const gchar *name = gimp_object_get_name (object);
+  gpointer     key  = NULL;
 
-  if (! name)
+  if (name)
+    {
+      GQueue *bucket;
+
+      if (! g_hash_table_lookup_extended (list->by_name, name,
+                                          &key, (gpointer *) &bucket))
+        {
+          key    = g_strdup (name);
+          bucket = g_queue_new ();
+
+          g_hash_table_insert (list->by_name, key, bucket);
+        }
+
+      g_queue_push_tail (bucket, object);
+    }
+
+  g_hash_table_insert (list->names, object, key);
+}
+
+static void
+gimp_list_name_index_remove (GimpList   *list,
+                             GimpObject *object)
+{
+  const gchar *key = g_hash_table_lookup (list->names, object);
+
+  if (key)
+    {
+      GQueue *bucket = g_hash_table_lookup (list->by_name, key);
+
+      g_queue_remove (bucket, object);
+
+      if (g_queue_is_empty (bucket))
+        g_hash_table_remove (list->by_name, key);
+    }
+
+  g_hash_table_remove (list->names, object);
+}
+
+/*  whether a child other than 'object' is named 'name'  */
+static gboolean
+gimp_list_name_taken (GimpList    *list,
+                      GimpObject  *object,
+                      const gchar *name)
+{
+  GQueue *bucket = g_hash_table_lookup (list->by_name, name);
+
+  if (! bucket)
+    return FALSE;
+
+  return bucket->length > 1 || g_queue_peek_head (bucket) != object;
+}
+
+static gint
+gimp_list_index_compare (gconstpointer a,
+                         gconstpointer b,
+                         gpointer      data)
+{
+  GimpContainer *container = data;
+
+  return (gimp_list_get_child_index (container, (GimpObject *) a) -
+          gimp_list_get_child_index (container, (GimpObject *) b));
+}
+
+/*  the children are indexed by position in 'slot_array', whose used
+ *  slots start at 'slot_start', while 'slots' maps each child to its
+ *  slot.  adding or removing children at either end keeps the index
+ *  valid, anything else invalidates it until the next lookup.
+ */
+static void
+gimp_list_slots_validate (GimpList *list)
+{
+  GList *iter;
+  gint   slot;
+
+  if (list->slots_valid)
+    return;
+
+  list->slot_alloc = 2 * list->queue->length + 16;
+  list->slot_start = list->slot_alloc / 4;
+
+  g_free (list->slot_array);
+  list->slot_array = g_new (gpointer, list->slot_alloc);
+
+  g_hash_table_remove_all (list->slots);
+
+  for (iter = list->queue->head, slot = list->slot_start;
+       iter;
+       iter = g_list_next (iter), slot++)
+    {
+      list->slot_array[slot] = iter->data;
+
+      g_hash_table_insert (list->slots, iter->data, GINT_TO_POINTER (slot));
+    }
+
+  list->slots_valid = TRUE;
+}
+
+/*  called after pushing 'object' at the head of the queue  */
+static void
+gimp_list_slots_push_head (GimpList   *list,
+                           GimpObject *object)
+{
+  if (! list->slots_valid)
+    return;
+
+  if (list->slot_start == 0)
+    {
+      list->slots_valid = FALSE;
+
+      return;
+    }
+
+  list->slot_start--;
+  list->slot_array[list->slot_start] = object;
+
+  g_hash_table_insert (list->slots, object,
+                       GINT_TO_POINTER (list->slot_start));
+}
+
+/*  called after pushing 'object' at the tail of the queue  */
+static void
+gimp_list_slots_push_tail (GimpList   *list,
+                           GimpObject *object)
+{
+  gint slot;
+
+  if (! list->slots_valid)
     return;
 
-  for (list = gimp_list->queue->head; list; list = g_list_next (list))
+  slot = list->slot_start + list->queue->length - 1;
+
+  if (slot >= list->slot_alloc)
+    {
+      list->slots_valid = FALSE;
+
+      return;
+    }
+
+  list->slot_array[slot] = object;
+
+  g_hash_table_insert (list->slots, object, GINT_TO_POINTER (slot));
+}
+
+/*  called before removing 'object' from the queue  */
+static void
+gimp_list_slots_remove (GimpList   *list,
+                        GimpObject *object)
+{
+  gpointer slot;
+
+  if (! list->slots_valid)
+    return;
+
+  if (! g_hash_table_lookup_extended (list->slots, object, NULL, &slot))
+    return;
+
+  if (GPOINTER_TO_INT (slot) == list->slot_start)
+    {
+      list->slot_start++;
+    }
+  else if (GPOINTER_TO_INT (slot) !=
+           list->slot_start + list->queue->length - 1)
     {
-      GimpObject  *object2 = list->data;
-      const gchar *name2   = gimp_object_get_name (object2);
+      list->slots_valid = FALSE;
 
-      if (object != object2 &&
-          name2             &&
-          ! strcmp (name, name2))
-        break;
+      return;
     }
 
-  if (list)
+  g_hash_table_remove (list->slots, object);
+}
+
+static void
+gimp_list_uniquefy_name (GimpList   *gimp_list,
+                         GimpObject *object)
+{
+  gchar *name = (gchar *) gimp_object_get_name (object);
+
+  if (! name)
+    return;
+
+  if (gimp_list_name_taken (gimp_list, object, name))
     {
       gchar *ext;
       gchar *new_name   = NULL;
@@ -660,19 +897,8 @@ gimp_list_uniquefy_name (GimpList   *gimp_list,
           g_free (new_name);
 
           new_name = g_strdup_printf ("%s #%d", name, unique_ext);
-
-          for (list = gimp_list->queue->head; list; list = g_list_next (list))
-            {
-              GimpObject  *object2 = list->data;
-              const gchar *name2   = gimp_object_get_name (object2);
-
-              if (object != object2 &&
-                  name2             &&
-                  ! strcmp (new_name, name2))
-                break;
-            }
         }
-      while (list);
+      while (gimp_list_name_taken (gimp_list, object, new_name));
 
       g_free (name);
 
@@ -697,13 +923,16 @@ gimp_list_object_renamed (GimpObject *object,
                                          list);
     }
 
+  gimp_list_name_index_remove (list, object);
+  gimp_list_name_index_add (list, object);
+
   if (list->sort_func)
     {
       GList *glist;
       gint   old_index;
       gint   new_index = 0;
 
-      old_index = g_queue_index (list->queue, object);
+      old_index = gimp_list_get_child_index (GIMP_CONTAINER (list), object);
 
       for (glist = list->queue->head; glist; glist = g_list_next (glist))
         {
@@ -41,6 +41,15 @@ struct _GimpList
   gboolean       unique_names;
   GCompareFunc   sort_func;
   gboolean       append;
+
+  /*  private, indexes of the children by name and by position  */
+  GHashTable    *names;
+  GHashTable    *by_name;
+  GHashTable    *slots;
+  gpointer      *slot_array;
+  gint           slot_start;
+  gint           slot_alloc;
+  gboolean       slots_valid;
 };
 
 struct _GimpListClass
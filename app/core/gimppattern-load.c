@@ -48,12 +48,166 @@ static GList * gimp_pattern_load_photoshop_pattern   (GimpContext       *context
                                                       GInputStream      *input,
                                                       GError           **error);
 
+static GList * gimp_pattern_load_internal            (GimpContext       *context,
+                                                      GFile             *file,
+                                                      GInputStream      *input,
+                                                      gboolean           lazy,
+                                                      GError           **error);
+
 
 GList *
 gimp_pattern_load (GimpContext   *context,
                    GFile         *file,
                    GInputStream  *input,
                    GError       **error)
+{
+  g_return_val_if_fail (G_IS_FILE (file), NULL);
+  g_return_val_if_fail (G_IS_INPUT_STREAM (input), NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  return gimp_pattern_load_internal (context, file, input, FALSE, error);
+}
+
+GList *
+gimp_pattern_load_lazy (GimpContext   *context,
+                        GFile         *file,
+                        GInputStream  *input,
+                        GError       **error)
+{
+  g_return_val_if_fail (G_IS_FILE (file), NULL);
+  g_return_val_if_fail (G_IS_INPUT_STREAM (input), NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  return gimp_pattern_load_internal (context, file, input, TRUE, error);
+}
+
+GimpData *
+gimp_pattern_load_index (GKeyFile     *index,
+                         const gchar  *group,
+                         GError      **error)
+{
+  GimpPattern *pattern;
+  gchar       *name;
+  gint         width;
+  gint         height;
+
+  g_return_val_if_fail (index != NULL, NULL);
+  g_return_val_if_fail (group != NULL, NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  name   = g_key_file_get_string  (index, group, "name",   NULL);
+  width  = g_key_file_get_integer (index, group, "width",  NULL);
+  height = g_key_file_get_integer (index, group, "height", NULL);
+
+  if (! name                                      ||
+      width  < 1 || width  > GIMP_PATTERN_MAX_SIZE ||
+      height < 1 || height > GIMP_PATTERN_MAX_SIZE)
+    {
+      g_set_error (error, GIMP_DATA_ERROR, GIMP_DATA_ERROR_READ,
+                   _("Invalid pattern index entry '%s'"), group);
+      g_free (name);
+      return NULL;
+    }
+
+  pattern = g_object_new (GIMP_TYPE_PATTERN,
+                          "name",      name,
+                          "mime-type", "image/x-gimp-pat",
+                          NULL);
+  g_free (name);
+
+  pattern->lazy_width  = width;
+  pattern->lazy_height = height;
+  pattern->lazy        = TRUE;
+
+  return GIMP_DATA (pattern);
+}
+
+gboolean
+gimp_pattern_save_index (GimpData    *data,
+                         GKeyFile    *index,
+                         const gchar *group)
+{
+  GimpPattern *pattern;
+  gint         width;
+  gint         height;
+
+  g_return_val_if_fail (GIMP_IS_DATA (data), FALSE);
+  g_return_val_if_fail (index != NULL, FALSE);
+  g_return_val_if_fail (group != NULL, FALSE);
+
+  if (G_OBJECT_TYPE (data) != GIMP_TYPE_PATTERN)
+    return FALSE;
+
+  pattern = GIMP_PATTERN (data);
+
+  gimp_viewable_get_size (GIMP_VIEWABLE (pattern), &width, &height);
+
+  g_key_file_set_string  (index, group, "name",
+                          gimp_object_get_name (pattern));
+  g_key_file_set_integer (index, group, "width",  width);
+  g_key_file_set_integer (index, group, "height", height);
+
+  return TRUE;
+}
+
+void
+gimp_pattern_load_pixels (GimpPattern *pattern)
+{
+  GList        *loaded = NULL;
+  GFile        *file;
+  GInputStream *input;
+  GError       *error  = NULL;
+
+  g_return_if_fail (GIMP_IS_PATTERN (pattern));
+
+  file  = gimp_data_get_file (GIMP_DATA (pattern));
+  input = file ? G_INPUT_STREAM (g_file_read (file, NULL, &error)) : NULL;
+
+  if (input)
+    {
+      GInputStream *buffered = g_buffered_input_stream_new (input);
+
+      loaded = gimp_pattern_load_internal (NULL, file, buffered, FALSE,
+                                           &error);
+
+      g_object_unref (buffered);
+      g_object_unref (input);
+    }
+
+  if (loaded && ! loaded->next &&
+      gimp_temp_buf_get_width  (GIMP_PATTERN (loaded->data)->mask) ==
+      pattern->lazy_width &&
+      gimp_temp_buf_get_height (GIMP_PATTERN (loaded->data)->mask) ==
+      pattern->lazy_height)
+    {
+      pattern->mask = g_steal_pointer (&GIMP_PATTERN (loaded->data)->mask);
+    }
+  else
+    {
+      /*  the file went away or changed since it was scanned, keep the
+       *  pattern usable until the next refresh
+       */
+      if (error)
+        g_message (_("Error loading '%s': %s"),
+                   gimp_file_get_utf8_name (file), error->message);
+
+      pattern->mask = gimp_temp_buf_new (pattern->lazy_width,
+                                         pattern->lazy_height,
+                                         babl_format ("R'G'B' u8"));
+      gimp_temp_buf_data_clear (pattern->mask);
+    }
+
+  g_list_free_full (loaded, (GDestroyNotify) g_object_unref);
+  g_clear_error (&error);
+}
+
+
+static GList *
+gimp_pattern_load_internal (GimpContext   *context,
+                            GFile         *file,
+                            GInputStream  *input,
+                            gboolean       lazy,
+                            GError       **error)
 {
   GimpPattern       *pattern = NULL;
   const Babl        *format  = NULL;
@@ -63,10 +217,6 @@ gimp_pattern_load (GimpContext   *context,
   gsize              bn_size;
   gchar             *name = NULL;
 
-  g_return_val_if_fail (G_IS_FILE (file), NULL);
-  g_return_val_if_fail (G_IS_INPUT_STREAM (input), NULL);
-  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
-
   /*  read the size  */
   if (! g_input_stream_read_all (input, &header, sizeof (header),
                                  &bytes_read, NULL, error) ||
@@ -181,6 +331,18 @@ gimp_pattern_load (GimpContext   *context,
     case 4: format = babl_format ("R'G'B'A u8"); break;
     }
 
+  if (lazy)
+    {
+      /*  the pixels are read by gimp_pattern_load_pixels() when the
+       *  pattern is first used or previewed
+       */
+      pattern->lazy_width  = header.width;
+      pattern->lazy_height = header.height;
+      pattern->lazy        = TRUE;
+
+      return g_list_prepend (NULL, pattern);
+    }
+
   pattern->mask = gimp_temp_buf_new (header.width, header.height, format);
   size = (gsize) header.width * header.height * header.bytes;
 
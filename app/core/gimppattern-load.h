@@ -25,7 +25,20 @@ GList * gimp_pattern_load        (GimpContext   *context,
                                   GFile         *file,
                                   GInputStream  *input,
                                   GError       **error);
+GList * gimp_pattern_load_lazy   (GimpContext   *context,
+                                  GFile         *file,
+                                  GInputStream  *input,
+                                  GError       **error);
 GList * gimp_pattern_load_pixbuf (GimpContext   *context,
                                   GFile         *file,
                                   GInputStream  *input,
                                   GError       **error);
+
+void    gimp_pattern_load_pixels (GimpPattern   *pattern);
+
+GimpData * gimp_pattern_load_index (GKeyFile      *index,
+                                    const gchar   *group,
+                                    GError       **error);
+gboolean   gimp_pattern_save_index (GimpData      *data,
+                                    GKeyFile      *index,
+                                    const gchar   *group);
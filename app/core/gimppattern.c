@@ -61,6 +61,9 @@ static void          gimp_pattern_copy              (GimpData             *data,
 static gchar       * gimp_pattern_get_checksum      (GimpTagged           *tagged);
 
 
+G_LOCK_DEFINE_STATIC (lazy_pattern);
+
+
 G_DEFINE_TYPE_WITH_CODE (GimpPattern, gimp_pattern, GIMP_TYPE_DATA,
                          G_IMPLEMENT_INTERFACE (GIMP_TYPE_TAGGED,
                                                 gimp_pattern_tagged_iface_init))
@@ -133,8 +136,16 @@ gimp_pattern_get_size (GimpViewable *viewable,
 {
   GimpPattern *pattern = GIMP_PATTERN (viewable);
 
-  *width  = gimp_temp_buf_get_width  (pattern->mask);
-  *height = gimp_temp_buf_get_height (pattern->mask);
+  if (g_atomic_int_get (&pattern->lazy))
+    {
+      *width  = pattern->lazy_width;
+      *height = pattern->lazy_height;
+    }
+  else
+    {
+      *width  = gimp_temp_buf_get_width  (pattern->mask);
+      *height = gimp_temp_buf_get_height (pattern->mask);
+    }
 
   return TRUE;
 }
@@ -147,6 +158,7 @@ gimp_pattern_get_new_preview (GimpViewable *viewable,
                               GeglColor    *fg_color G_GNUC_UNUSED)
 {
   GimpPattern *pattern     = GIMP_PATTERN (viewable);
+  GimpTempBuf *mask        = gimp_pattern_get_mask (pattern);
   GimpTempBuf *temp_buf;
   GeglBuffer  *src_buffer;
   gint         true_width;
@@ -155,12 +167,12 @@ gimp_pattern_get_new_preview (GimpViewable *viewable,
   gint         copy_height;
   gboolean     has_temp_buf = FALSE;
 
-  true_width  = gimp_temp_buf_get_width (pattern->mask);
-  true_height = gimp_temp_buf_get_height (pattern->mask);
+  true_width  = gimp_temp_buf_get_width  (mask);
+  true_height = gimp_temp_buf_get_height (mask);
   copy_width  = MIN (width, true_width);
   copy_height = MIN (height, true_height);
 
-  src_buffer = gimp_temp_buf_create_buffer (pattern->mask);
+  src_buffer = gimp_temp_buf_create_buffer (mask);
 
   if (true_width > width || true_height > height)
     {
@@ -179,7 +191,7 @@ gimp_pattern_get_new_preview (GimpViewable *viewable,
       copy_height = MAX (1, copy_height);
 
       temp_buf = gimp_temp_buf_new (copy_width, copy_height,
-                                    gimp_temp_buf_get_format (pattern->mask));
+                                    gimp_temp_buf_get_format (mask));
 
       if (temp_buf)
         {
@@ -200,7 +212,7 @@ gimp_pattern_get_new_preview (GimpViewable *viewable,
       GeglBuffer *dest_buffer;
 
       temp_buf = gimp_temp_buf_new (copy_width, copy_height,
-                                    gimp_temp_buf_get_format (pattern->mask));
+                                    gimp_temp_buf_get_format (mask));
 
       dest_buffer = gimp_temp_buf_create_buffer (temp_buf);
 
@@ -222,11 +234,14 @@ gimp_pattern_get_description (GimpViewable  *viewable,
                               gchar        **tooltip)
 {
   GimpPattern *pattern = GIMP_PATTERN (viewable);
+  gint         width;
+  gint         height;
+
+  gimp_pattern_get_size (viewable, &width, &height);
 
   return g_strdup_printf ("%s (%d × %d)",
                           gimp_object_get_name (pattern),
-                          gimp_temp_buf_get_width  (pattern->mask),
-                          gimp_temp_buf_get_height (pattern->mask));
+                          width, height);
 }
 
 static const gchar *
@@ -243,7 +258,7 @@ gimp_pattern_copy (GimpData *data,
   GimpPattern *src_pattern = GIMP_PATTERN (src_data);
 
   g_clear_pointer (&pattern->mask, gimp_temp_buf_unref);
-  pattern->mask = gimp_temp_buf_copy (src_pattern->mask);
+  pattern->mask = gimp_temp_buf_copy (gimp_pattern_get_mask (src_pattern));
 
   gimp_data_dirty (data);
 }
@@ -252,14 +267,15 @@ static gchar *
 gimp_pattern_get_checksum (GimpTagged *tagged)
 {
   GimpPattern *pattern         = GIMP_PATTERN (tagged);
+  GimpTempBuf *mask            = gimp_pattern_get_mask (pattern);
   gchar       *checksum_string = NULL;
 
-  if (pattern->mask)
+  if (mask)
     {
       GChecksum *checksum = g_checksum_new (G_CHECKSUM_MD5);
 
-      g_checksum_update (checksum, gimp_temp_buf_get_data (pattern->mask),
-                         gimp_temp_buf_get_data_size (pattern->mask));
+      g_checksum_update (checksum, gimp_temp_buf_get_data (mask),
+                         gimp_temp_buf_get_data_size (mask));
 
       checksum_string = g_strdup (g_checksum_get_string (checksum));
 
@@ -320,6 +336,21 @@ gimp_pattern_get_mask (GimpPattern *pattern)
 {
   g_return_val_if_fail (GIMP_IS_PATTERN (pattern), NULL);
 
+  if (g_atomic_int_get (&pattern->lazy))
+    {
+      /*  may be called from any thread, e.g. by a threaded paint core  */
+      G_LOCK (lazy_pattern);
+
+      if (pattern->lazy)
+        {
+          gimp_pattern_load_pixels (pattern);
+
+          g_atomic_int_set (&pattern->lazy, FALSE);
+        }
+
+      G_UNLOCK (lazy_pattern);
+    }
+
   return pattern->mask;
 }
 
@@ -328,5 +359,5 @@ gimp_pattern_create_buffer (GimpPattern *pattern)
 {
   g_return_val_if_fail (GIMP_IS_PATTERN (pattern), NULL);
 
-  return gimp_temp_buf_create_buffer (pattern->mask);
+  return gimp_temp_buf_create_buffer (gimp_pattern_get_mask (pattern));
 }
@@ -35,6 +35,13 @@ struct _GimpPattern
   GimpData     parent_instance;
 
   GimpTempBuf *mask;
+
+  /*  set while the pixels of a pattern loaded by gimp_pattern_load_lazy()
+   *  are not read yet, only use gimp_pattern_get_mask() on those
+   */
+  gint         lazy;
+  gint         lazy_width;
+  gint         lazy_height;
 };
 
 struct _GimpPatternClass
@@ -24,12 +24,18 @@
 
 #include "core-types.h"
 
+#include "gegl/gimp-gegl-utils.h"
+
 #include "gimp.h"
 #include "gimpimage.h"
 #include "gimppickable.h"
 #include "gimppickable-auto-shrink.h"
 
 
+#define PIXELS_PER_THREAD \
+  (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
+
+
 typedef enum
 {
   AUTO_SHRINK_NOTHING = 0,
@@ -38,22 +44,40 @@ typedef enum
 } AutoShrinkType;
 
 
-typedef gboolean (* ColorsEqualFunc) (guchar *col1,
-                                      guchar *col2);
+typedef struct
+{
+  GeglBuffer    *buffer;
+  const Babl    *fish;
+  gint           bpp;
+  gconstpointer  empty_data;
+
+  /*  a pixel is background if (pixel & mask) == bgcolor, with pixels
+   *  in R'G'B'A u8, read as a guint32
+   */
+  guint32        mask;
+  guint32        bgcolor;
+
+  GMutex         mutex;
+
+  /*  the bounds of the contents found so far, x2 and y2 exclusive  */
+  gint           x1, y1;
+  gint           x2, y2;
+} AutoShrinkData;
 
 
 /*  local function prototypes  */
 
-static AutoShrinkType   gimp_pickable_guess_bgcolor (GimpPickable *pickable,
-                                                     guchar       *color,
-                                                     gint          x1,
-                                                     gint          x2,
-                                                     gint          y1,
-                                                     gint          y2);
-static gboolean         gimp_pickable_colors_equal  (guchar       *col1,
-                                                     guchar       *col2);
-static gboolean         gimp_pickable_colors_alpha  (guchar       *col1,
-                                                     guchar       *col2);
+static AutoShrinkType   gimp_pickable_guess_bgcolor    (GimpPickable        *pickable,
+                                                        guchar              *color,
+                                                        gint                 x1,
+                                                        gint                 x2,
+                                                        gint                 y1,
+                                                        gint                 y2);
+static gboolean         gimp_pickable_colors_equal     (guchar              *col1,
+                                                        guchar              *col2);
+
+static void             gimp_pickable_auto_shrink_area (const GeglRectangle *area,
+                                                        AutoShrinkData      *data);
 
 
 /*  public functions  */
@@ -69,16 +93,12 @@ gimp_pickable_auto_shrink (GimpPickable *pickable,
                            gint         *shrunk_width,
                            gint         *shrunk_height)
 {
-  GeglBuffer      *buffer;
-  GeglRectangle    rect;
-  ColorsEqualFunc  colors_equal_func;
-  guchar           bgcolor[MAX_CHANNELS] = { 0, 0, 0, 0 };
-  guchar          *buf = NULL;
-  gint             x1, y1, x2, y2;
-  gint             width, height;
-  const Babl      *format;
-  gint             x, y, abort;
-  GimpAutoShrink   retval = GIMP_AUTO_SHRINK_UNSHRINKABLE;
+  GeglBuffer     *buffer;
+  AutoShrinkData  data;
+  guchar          bgcolor[MAX_CHANNELS] = { 0, 0, 0, 0 };
+  guchar          mask[4]               = { 0xff, 0xff, 0xff, 0xff };
+  gint            x1, y1, x2, y2;
+  GimpAutoShrink  retval = GIMP_AUTO_SHRINK_UNSHRINKABLE;
 
   g_return_val_if_fail (GIMP_IS_PICKABLE (pickable), FALSE);
   g_return_val_if_fail (shrunk_x != NULL, FALSE);
@@ -109,106 +129,63 @@ gimp_pickable_auto_shrink (GimpPickable *pickable,
   *shrunk_width  = x2 - x1;
   *shrunk_height = y2 - y1;
 
-  format = babl_format ("R'G'B'A u8");
-
   switch (gimp_pickable_guess_bgcolor (pickable, bgcolor,
                                        x1, x2 - 1, y1, y2 - 1))
     {
     case AUTO_SHRINK_ALPHA:
-      colors_equal_func = gimp_pickable_colors_alpha;
+      /*  only compare the alpha channel  */
+      memset (mask, 0, ALPHA);
       break;
     case AUTO_SHRINK_COLOR:
-      colors_equal_func = gimp_pickable_colors_equal;
       break;
     default:
       goto FINISH;
       break;
     }
 
-  width  = x2 - x1;
-  height = y2 - y1;
-
-  /* The following could be optimized further by processing
-   * the smaller side first instead of defaulting to width    --Sven
+  /*  instead of scanning rows and columns inwards, find the bounds of
+   *  everything that isn't background, tile by tile and in parallel.
+   *  uniform tiles, like the empty ones, are classified as a whole, and
+   *  only non-uniform tiles at the edge of the bounds found so far are
+   *  looked at pixel by pixel.
    */
+  data.buffer     = buffer;
+  data.fish       = babl_fish (gegl_buffer_get_format (buffer),
+                               babl_format ("R'G'B'A u8"));
+  data.bpp        = babl_format_get_bytes_per_pixel (
+                      gegl_buffer_get_format (buffer));
+  data.empty_data = gimp_gegl_buffer_get_empty_tile_data (buffer);
 
-  buf = g_malloc (MAX (width, height) * 4);
-
-  /* Check how many of the top lines are uniform/transparent. */
-  rect.x      = x1;
-  rect.y      = 0;
-  rect.width  = width;
-  rect.height = 1;
+  memcpy (&data.mask,    mask,    4);
+  memcpy (&data.bgcolor, bgcolor, 4);
 
-  abort = FALSE;
-  for (y = y1; y < y2 && !abort; y++)
-    {
-      rect.y = y;
-      gegl_buffer_get (buffer, &rect, 1.0, format, buf,
-                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
-      for (x = 0; x < width && !abort; x++)
-        abort = ! colors_equal_func (bgcolor, buf + x * 4);
-    }
-  if (y == y2 && !abort)
-    {
-      retval = GIMP_AUTO_SHRINK_EMPTY;
-      goto FINISH;
-    }
-  y1 = y - 1;
+  data.bgcolor &= data.mask;
 
-  /* Check how many of the bottom lines are uniform/transparent. */
-  rect.x      = x1;
-  rect.y      = 0;
-  rect.width  = width;
-  rect.height = 1;
+  g_mutex_init (&data.mutex);
 
-  abort = FALSE;
-  for (y = y2; y > y1 && !abort; y--)
-    {
-      rect.y = y - 1;
-      gegl_buffer_get (buffer, &rect, 1.0, format, buf,
-                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
-      for (x = 0; x < width && !abort; x++)
-        abort = ! colors_equal_func  (bgcolor, buf + x * 4);
-    }
-  y2 = y + 1;
+  data.x1 = x2;
+  data.y1 = y2;
+  data.x2 = x1;
+  data.y2 = y1;
 
-  /* compute a new height for the next operations */
-  height = y2 - y1;
+  gegl_parallel_distribute_area (
+    GEGL_RECTANGLE (x1, y1, x2 - x1, y2 - y1),
+    PIXELS_PER_THREAD, GEGL_SPLIT_STRATEGY_AUTO,
+    (GeglParallelDistributeAreaFunc) gimp_pickable_auto_shrink_area,
+    &data);
 
-  /* Check how many of the left lines are uniform/transparent. */
-  rect.x      = 0;
-  rect.y      = y1;
-  rect.width  = 1;
-  rect.height = height;
+  g_mutex_clear (&data.mutex);
 
-  abort = FALSE;
-  for (x = x1; x < x2 && !abort; x++)
+  if (data.x1 >= data.x2 || data.y1 >= data.y2)
     {
-      rect.x = x;
-      gegl_buffer_get (buffer, &rect, 1.0, format, buf,
-                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
-      for (y = 0; y < height && !abort; y++)
-        abort = ! colors_equal_func (bgcolor, buf + y * 4);
+      retval = GIMP_AUTO_SHRINK_EMPTY;
+      goto FINISH;
     }
-  x1 = x - 1;
 
-  /* Check how many of the right lines are uniform/transparent. */
-  rect.x      = 0;
-  rect.y      = y1;
-  rect.width  = 1;
-  rect.height = height;
-
-  abort = FALSE;
-  for (x = x2; x > x1 && !abort; x--)
-    {
-      rect.x = x - 1;
-      gegl_buffer_get (buffer, &rect, 1.0, format, buf,
-                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
-      for (y = 0; y < height && !abort; y++)
-        abort = ! colors_equal_func (bgcolor, buf + y * 4);
-    }
-  x2 = x + 1;
+  x1 = data.x1;
+  y1 = data.y1;
+  x2 = data.x2;
+  y2 = data.y2;
 
   if (x1      != start_x     ||
       y1      != start_y     ||
@@ -225,7 +202,6 @@ gimp_pickable_auto_shrink (GimpPickable *pickable,
 
  FINISH:
 
-  g_free (buf);
   gimp_unset_busy (gimp_pickable_get_image (pickable)->gimp);
 
   return retval;
@@ -304,9 +280,178 @@ gimp_pickable_colors_equal (guchar *col1,
   return TRUE;
 }
 
-static gboolean
-gimp_pickable_colors_alpha (guchar *dummy,
-                            guchar *col)
+/*  returns the index of the first pixel of 'pixels' that isn't
+ *  background, or 'n_pixels'.  the OR-reduction over whole blocks,
+ *  without an early exit, lets the compiler vectorize the common case
+ *  of a run of background.
+ */
+static inline gint
+gimp_pickable_auto_shrink_find_first (const guint32 *pixels,
+                                      gint           n_pixels,
+                                      guint32        mask,
+                                      guint32        bgcolor)
+{
+  gint i = 0;
+
+  while (i < n_pixels)
+    {
+      gint    n   = MIN (n_pixels - i, 64);
+      guint32 acc = 0;
+      gint    j;
+
+      for (j = 0; j < n; j++)
+        acc |= (pixels[i + j] & mask) ^ bgcolor;
+
+      if (acc)
+        {
+          while ((pixels[i] & mask) == bgcolor)
+            i++;
+
+          return i;
+        }
+
+      i += n;
+    }
+
+  return n_pixels;
+}
+
+static inline gint
+gimp_pickable_auto_shrink_find_last (const guint32 *pixels,
+                                     gint           n_pixels,
+                                     guint32        mask,
+                                     guint32        bgcolor)
+{
+  gint i = n_pixels;
+
+  while (i > 0)
+    {
+      gint    n   = MIN (i, 64);
+      guint32 acc = 0;
+      gint    j;
+
+      for (j = i - n; j < i; j++)
+        acc |= (pixels[j] & mask) ^ bgcolor;
+
+      if (acc)
+        {
+          while ((pixels[i - 1] & mask) == bgcolor)
+            i--;
+
+          return i - 1;
+        }
+
+      i -= n;
+    }
+
+  return -1;
+}
+
+static void
+gimp_pickable_auto_shrink_area (const GeglRectangle *area,
+                                AutoShrinkData      *data)
 {
-  return (col[ALPHA] == 0);
+  GeglBufferIterator  *iter;
+  const GeglRectangle *roi;
+  guint32             *pixels = NULL;
+  gint                 n_pixels = 0;
+  gint                 x1, y1, x2, y2;
+
+  g_mutex_lock (&data->mutex);
+
+  x1 = data->x1;
+  y1 = data->y1;
+  x2 = data->x2;
+  y2 = data->y2;
+
+  g_mutex_unlock (&data->mutex);
+
+  iter = gegl_buffer_iterator_new (data->buffer, area, 0,
+                                   gegl_buffer_get_format (data->buffer),
+                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
+  roi = &iter->items[0].roi;
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const guint8 *src = iter->items[0].data;
+      gint          ex  = roi->x + roi->width;
+      gint          ey  = roi->y + roi->height;
+      gint          y;
+
+      /*  nothing in this tile can extend the bounds  */
+      if (roi->x >= x1 && ex <= x2 &&
+          roi->y >= y1 && ey <= y2)
+        {
+          continue;
+        }
+
+      if (gimp_gegl_data_is_constant (src, data->bpp, iter->length,
+                                      data->empty_data))
+        {
+          guint32 pixel;
+
+          babl_process (data->fish, src, &pixel, 1);
+
+          if ((pixel & data->mask) != data->bgcolor)
+            {
+              x1 = MIN (x1, roi->x);
+              y1 = MIN (y1, roi->y);
+              x2 = MAX (x2, ex);
+              y2 = MAX (y2, ey);
+            }
+
+          continue;
+        }
+
+      if (n_pixels < iter->length)
+        {
+          g_free (pixels);
+
+          n_pixels = iter->length;
+          pixels   = g_new (guint32, n_pixels);
+        }
+
+      babl_process (data->fish, src, pixels, iter->length);
+
+      for (y = roi->y; y < ey; y++)
+        {
+          const guint32 *row = pixels + (y - roi->y) * roi->width;
+          gint           first;
+          gint           last;
+
+          /*  rows within the vertical bounds only matter if they can
+           *  extend the horizontal ones
+           */
+          if (y >= y1 && y < y2 && roi->x >= x1 && ex <= x2)
+            continue;
+
+          first = gimp_pickable_auto_shrink_find_first (row, roi->width,
+                                                        data->mask,
+                                                        data->bgcolor);
+
+          if (first == roi->width)
+            continue;
+
+          last = gimp_pickable_auto_shrink_find_last (row + first,
+                                                      roi->width - first,
+                                                      data->mask,
+                                                      data->bgcolor) + first;
+
+          x1 = MIN (x1, roi->x + first);
+          x2 = MAX (x2, roi->x + last + 1);
+          y1 = MIN (y1, y);
+          y2 = MAX (y2, y + 1);
+        }
+    }
+
+  g_free (pixels);
+
+  g_mutex_lock (&data->mutex);
+
+  data->x1 = MIN (data->x1, x1);
+  data->y1 = MIN (data->y1, y1);
+  data->x2 = MAX (data->x2, x2);
+  data->y2 = MAX (data->y2, y2);
+
+  g_mutex_unlock (&data->mutex);
 }
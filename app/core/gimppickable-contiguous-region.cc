@@ -47,6 +47,18 @@ extern "C"
 #define PIXELS_PER_THREAD \
   (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
 
+/* the size of the blocks labeled independently by the parallel fill */
+#define BLOCK_SIZE        256
+
+/* the minimal area above which the parallel fill is used */
+#define PARALLEL_MIN_AREA (2048 * 2048)
+
+/* the largest distance reachable by a region, since thresholds don't
+ * exceed 1, and antialiasing extends the region to 1.5 times the
+ * threshold
+ */
+#define MAX_DISTANCE      1.5
+
 
 typedef struct
 {
@@ -55,6 +67,29 @@ typedef struct
   gint   level;
 } BorderPixel;
 
+typedef struct
+{
+  GeglRectangle  rect;
+
+  /* the border labels of the block's top, bottom, left and right edge
+   * pixels, which are consecutive in memory, or -1 for unselected pixels
+   */
+  gint          *border;
+  gint           n_border_labels;
+
+  /* the index of the first border label in the global forest */
+  gint           base;
+
+  /* whether any of the block's labels belongs to the filled region */
+  gboolean       selected;
+} RegionBlock;
+
+typedef struct
+{
+  gfloat distance;
+  gint   index;
+} DistanceNode;
+
 
 /*  local function prototypes  */
 
@@ -70,6 +105,31 @@ static gfloat   pixel_difference          (const gfloat        *col1,
                                            gboolean             has_alpha,
                                            gboolean             select_transparent,
                                            GimpSelectCriterion  select_criterion);
+static void     pixel_difference_row      (const gfloat        *col,
+                                           const gfloat        *src,
+                                           gfloat              *dest,
+                                           gint                 n_pixels,
+                                           gboolean             antialias,
+                                           gfloat               threshold,
+                                           gint                 n_components,
+                                           gboolean             has_alpha,
+                                           gboolean             select_transparent,
+                                           GimpSelectCriterion  select_criterion);
+static gfloat   pixel_distance            (const gfloat        *col1,
+                                           const gfloat        *col2,
+                                           gint                 n_components,
+                                           gboolean             has_alpha,
+                                           gboolean             select_transparent,
+                                           GimpSelectCriterion  select_criterion);
+static gfloat   distance_to_difference    (gfloat               max,
+                                           gboolean             antialias,
+                                           gfloat               threshold);
+static void     distance_heap_push        (GArray              *heap,
+                                           gfloat               distance,
+                                           gint                 index);
+static void     distance_heap_pop         (GArray              *heap,
+                                           gfloat              *distance,
+                                           gint                *index);
 static void     push_segment              (GQueue              *segment_queue,
                                            gint                 y,
                                            gint                 old_y,
@@ -113,7 +173,39 @@ static void     find_contiguous_region    (GeglBuffer          *src_buffer,
                                            gboolean             diagonal_neighbors,
                                            gint                 x,
                                            gint                 y,
-                                           const gfloat        *col);
+                                           const gfloat        *col,
+                                           GeglRectangle       *bounds);
+
+static gint     label_find                (gint                *parent,
+                                           gint                 i);
+static void     label_union               (gint                *parent,
+                                           gint                 i,
+                                           gint                 j);
+static gint     label_block               (const gfloat        *diff,
+                                           gint                 width,
+                                           gint                 height,
+                                           gboolean             diagonal_neighbors,
+                                           gint                *parent,
+                                           gint                *labels);
+static gint     label_block_border        (RegionBlock         *block,
+                                           const gint          *labels,
+                                           gint                 n_labels,
+                                           gint                *border_labels);
+static void     find_contiguous_region_parallel
+                                          (GeglBuffer          *src_buffer,
+                                           GeglBuffer          *mask_buffer,
+                                           const Babl          *format,
+                                           gint                 n_components,
+                                           gboolean             has_alpha,
+                                           gboolean             select_transparent,
+                                           GimpSelectCriterion  select_criterion,
+                                           gboolean             antialias,
+                                           gfloat               threshold,
+                                           gboolean             diagonal_neighbors,
+                                           gint                 x,
+                                           gint                 y,
+                                           const gfloat        *col,
+                                           GeglRectangle       *bounds);
 
 static void            line_art_queue_pixel (GQueue              *queue,
                                              gint                 x,
@@ -123,6 +215,9 @@ static void            line_art_queue_pixel (GQueue              *queue,
 
 /*  public functions  */
 
+/* if @bounds isn't NULL, it's set to a rectangle containing the region,
+ * tracked during the fill, or to an empty rectangle if nothing is filled.
+ */
 GeglBuffer *
 gimp_pickable_contiguous_region_by_seed (GimpPickable        *pickable,
                                          gboolean             antialias,
@@ -131,10 +226,12 @@ gimp_pickable_contiguous_region_by_seed (GimpPickable        *pickable,
                                          GimpSelectCriterion  select_criterion,
                                          gboolean             diagonal_neighbors,
                                          gint                 x,
-                                         gint                 y)
+                                         gint                 y,
+                                         GeglRectangle       *bounds)
 {
   GeglBuffer    *src_buffer;
   GeglBuffer    *mask_buffer;
+  GeglRectangle  mask_bounds = { 0, };
   const Babl    *format;
   GeglRectangle  extent;
   gint           n_components;
@@ -174,17 +271,278 @@ gimp_pickable_contiguous_region_by_seed (GimpPickable        *pickable,
   if (x >= extent.x && x < (extent.x + extent.width) &&
       y >= extent.y && y < (extent.y + extent.height))
     {
+      gint n_threads;
+
+      g_object_get (gegl_config (),
+                    "threads", &n_threads,
+                    NULL);
+
       GIMP_TIMER_START();
 
-      find_contiguous_region (src_buffer, mask_buffer,
-                              format, n_components, has_alpha,
-                              select_transparent, select_criterion,
-                              antialias, threshold, diagonal_neighbors,
-                              x, y, start_col);
+      /*  the serial fill only visits the filled region, while the parallel
+       *  fill has to label the whole buffer, so only use the latter for
+       *  large buffers.  both produce the same mask.
+       */
+      if (n_threads > 1 &&
+          (gint64) extent.width * extent.height >= PARALLEL_MIN_AREA)
+        {
+          find_contiguous_region_parallel (src_buffer, mask_buffer,
+                                           format, n_components, has_alpha,
+                                           select_transparent, select_criterion,
+                                           antialias, threshold,
+                                           diagonal_neighbors,
+                                           x, y, start_col, &mask_bounds);
+        }
+      else
+        {
+          find_contiguous_region (src_buffer, mask_buffer,
+                                  format, n_components, has_alpha,
+                                  select_transparent, select_criterion,
+                                  antialias, threshold, diagonal_neighbors,
+                                  x, y, start_col, &mask_bounds);
+        }
 
       GIMP_TIMER_END("foo");
     }
 
+  if (bounds)
+    *bounds = mask_bounds;
+
+  return mask_buffer;
+}
+
+/* Returns a map of the distances of the pickable's pixels from the seed
+ * pixel, from which the region returned by
+ * gimp_pickable_contiguous_region_by_seed() can be derived for any
+ * threshold, using gimp_pickable_contiguous_region_by_distance_map().
+ *
+ * each pixel of the map holds two floats: the pixel's own distance from
+ * the seed color, and the minimal threshold at which the pixel joins the
+ * seed's region, that is, the smallest maximal distance along a path from
+ * the seed, found with a Dijkstra-style flood.
+ */
+GeglBuffer *
+gimp_pickable_contiguous_region_distance_map (GimpPickable        *pickable,
+                                              gboolean             select_transparent,
+                                              GimpSelectCriterion  select_criterion,
+                                              gboolean             diagonal_neighbors,
+                                              gint                 x,
+                                              gint                 y)
+{
+  GeglBuffer    *src_buffer;
+  GeglBuffer    *map_buffer;
+  const Babl    *format;
+  const Babl    *map_format;
+  GeglRectangle  extent;
+  gint           n_components;
+  gboolean       has_alpha;
+  gfloat         start_col[MAX_CHANNELS];
+  gfloat        *map;
+
+  g_return_val_if_fail (GIMP_IS_PICKABLE (pickable), NULL);
+
+  gimp_pickable_flush (pickable);
+  src_buffer = gimp_pickable_get_buffer_with_effects (pickable);
+
+  format = choose_format (src_buffer, select_criterion,
+                          &n_components, &has_alpha);
+  gegl_buffer_sample (src_buffer, x, y, NULL, start_col, format,
+                      GEGL_SAMPLER_NEAREST, GEGL_ABYSS_NONE);
+
+  if (has_alpha)
+    {
+      if (select_transparent)
+        {
+          /*  don't select transparent regions if the start pixel isn't
+           *  fully transparent
+           */
+          if (start_col[n_components - 1] > 0)
+            select_transparent = FALSE;
+        }
+    }
+  else
+    {
+      select_transparent = FALSE;
+    }
+
+  extent     = *gegl_buffer_get_extent (src_buffer);
+  map_format = babl_format_n (babl_type ("float"), 2);
+  map_buffer = gegl_buffer_new (&extent, map_format);
+
+  map = g_new (gfloat, 2 * (gsize) extent.width * extent.height);
+
+  gegl_parallel_distribute_area (
+    &extent, PIXELS_PER_THREAD,
+    [=] (const GeglRectangle *area)
+    {
+      GeglBufferIterator *iter;
+
+      iter = gegl_buffer_iterator_new (src_buffer,
+                                       area, 0, format,
+                                       GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
+
+      while (gegl_buffer_iterator_next (iter))
+        {
+          const GeglRectangle *roi = &iter->items[0].roi;
+          const gfloat        *src = (const gfloat *) iter->items[0].data;
+          gint                 row;
+          gint                 col;
+
+          for (row = 0; row < roi->height; row++)
+            {
+              gfloat *dest = map +
+                             2 * ((gsize) (roi->y - extent.y + row) *
+                                  extent.width                      +
+                                  (roi->x - extent.x));
+
+              for (col = 0; col < roi->width; col++)
+                {
+                  dest[0] = pixel_distance (start_col, src,
+                                            n_components,
+                                            has_alpha,
+                                            select_transparent,
+                                            select_criterion);
+                  dest[1] = G_MAXFLOAT;
+
+                  src  += n_components;
+                  dest += 2;
+                }
+            }
+        }
+    });
+
+  if (x >= extent.x && x < (extent.x + extent.width) &&
+      y >= extent.y && y < (extent.y + extent.height))
+    {
+      GArray *heap = g_array_new (FALSE, FALSE, sizeof (DistanceNode));
+      gint    index;
+      gfloat  distance;
+
+      index = (y - extent.y) * extent.width + (x - extent.x);
+
+      if (map[2 * (gsize) index] <= MAX_DISTANCE)
+        {
+          map[2 * (gsize) index + 1] = map[2 * (gsize) index];
+
+          distance_heap_push (heap, map[2 * (gsize) index], index);
+        }
+
+      while (heap->len > 0)
+        {
+          gint px, py;
+          gint dx, dy;
+
+          distance_heap_pop (heap, &distance, &index);
+
+          /*  skip the stale nodes of pixels reached again at a shorter
+           *  distance
+           */
+          if (distance > map[2 * (gsize) index + 1])
+            continue;
+
+          px = index % extent.width;
+          py = index / extent.width;
+
+          for (dy = -1; dy <= 1; dy++)
+            {
+              for (dx = -1; dx <= 1; dx++)
+                {
+                  gfloat *neighbor;
+                  gfloat  d;
+
+                  if (! dx && ! dy)
+                    continue;
+
+                  if (dx && dy && ! diagonal_neighbors)
+                    continue;
+
+                  if (px + dx < 0 || px + dx >= extent.width ||
+                      py + dy < 0 || py + dy >= extent.height)
+                    {
+                      continue;
+                    }
+
+                  neighbor = map + 2 * ((gsize) (py + dy) * extent.width +
+                                        (px + dx));
+
+                  d = MAX (distance, neighbor[0]);
+
+                  if (d <= MAX_DISTANCE && d < neighbor[1])
+                    {
+                      neighbor[1] = d;
+
+                      distance_heap_push (heap, d,
+                                          (py + dy) * extent.width + (px + dx));
+                    }
+                }
+            }
+        }
+
+      g_array_free (heap, TRUE);
+    }
+
+  gegl_buffer_set (map_buffer, &extent, 0, map_format, map,
+                   GEGL_AUTO_ROWSTRIDE);
+
+  g_free (map);
+
+  return map_buffer;
+}
+
+/* Returns the same mask as gimp_pickable_contiguous_region_by_seed(), for
+ * a distance map returned by gimp_pickable_contiguous_region_distance_map(),
+ * for any 'threshold' up to 1.
+ */
+GeglBuffer *
+gimp_pickable_contiguous_region_by_distance_map (GeglBuffer *map_buffer,
+                                                 gboolean    antialias,
+                                                 gfloat      threshold)
+{
+  GeglBuffer *mask_buffer;
+
+  g_return_val_if_fail (GEGL_IS_BUFFER (map_buffer), NULL);
+
+  mask_buffer = gegl_buffer_new (gegl_buffer_get_extent (map_buffer),
+                                 babl_format ("Y float"));
+
+  gegl_parallel_distribute_area (
+    gegl_buffer_get_extent (map_buffer), PIXELS_PER_THREAD,
+    [=] (const GeglRectangle *area)
+    {
+      GeglBufferIterator *iter;
+
+      iter = gegl_buffer_iterator_new (map_buffer,
+                                       area, 0,
+                                       babl_format_n (babl_type ("float"), 2),
+                                       GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 2);
+
+      gegl_buffer_iterator_add (iter, mask_buffer,
+                                area, 0, babl_format ("Y float"),
+                                GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE);
+
+      while (gegl_buffer_iterator_next (iter))
+        {
+          const gfloat *src   = (const gfloat *) iter->items[0].data;
+          gfloat       *dest  = (      gfloat *) iter->items[1].data;
+          gint          count = iter->length;
+
+          while (count--)
+            {
+              /*  a pixel is in the region if all the pixels along its path
+               *  from the seed are, which only depends on the largest
+               *  distance along the path
+               */
+              if (distance_to_difference (src[1], antialias, threshold))
+                *dest = distance_to_difference (src[0], antialias, threshold);
+              else
+                *dest = 0.0;
+
+              src  += 2;
+              dest += 1;
+            }
+        }
+    });
+
   return mask_buffer;
 }
 
@@ -263,24 +621,17 @@ gimp_pickable_contiguous_region_by_color (GimpPickable        *pickable,
 
       while (gegl_buffer_iterator_next (iter))
         {
-          const gfloat *src   = (const gfloat *) iter->items[0].data;
-          gfloat       *dest  = (      gfloat *) iter->items[1].data;
-          gint          count = iter->length;
-
-          while (count--)
-            {
-              /*  Find how closely the colors match  */
-              *dest = pixel_difference (start_col, src,
-                                        antialias,
-                                        threshold,
-                                        n_components,
-                                        has_alpha,
-                                        select_transparent,
-                                        select_criterion);
-
-              src  += n_components;
-              dest += 1;
-            }
+          const gfloat *src  = (const gfloat *) iter->items[0].data;
+          gfloat       *dest = (      gfloat *) iter->items[1].data;
+
+          /*  Find how closely the colors match  */
+          pixel_difference_row (start_col, src, dest, iter->length,
+                                antialias,
+                                threshold,
+                                n_components,
+                                has_alpha,
+                                select_transparent,
+                                select_criterion);
         }
     });
 
@@ -755,12 +1106,114 @@ pixel_difference (const gfloat        *col1,
                   gboolean             has_alpha,
                   gboolean             select_transparent,
                   GimpSelectCriterion  select_criterion)
+{
+  return distance_to_difference (pixel_distance (col1, col2,
+                                                 n_components,
+                                                 has_alpha,
+                                                 select_transparent,
+                                                 select_criterion),
+                                 antialias, threshold);
+}
+
+/* the same as calling pixel_difference() for each of 'n_pixels' pixels of
+ * 'src'.  composite comparisons of RGB and grayscale pixels, which are the
+ * common case, use loops without per-pixel branching on the criterion,
+ * which the compiler can vectorize.
+ */
+static void
+pixel_difference_row (const gfloat        *col,
+                      const gfloat        *src,
+                      gfloat              *dest,
+                      gint                 n_pixels,
+                      gboolean             antialias,
+                      gfloat               threshold,
+                      gint                 n_components,
+                      gboolean             has_alpha,
+                      gboolean             select_transparent,
+                      GimpSelectCriterion  select_criterion)
+{
+  gint n_colors = n_components - (has_alpha ? 1 : 0);
+  gint i;
+
+  if (select_criterion != GIMP_SELECT_CRITERION_COMPOSITE ||
+      (select_transparent && has_alpha)                   ||
+      (n_colors != 3 && n_colors != 1))
+    {
+      for (i = 0; i < n_pixels; i++)
+        {
+          dest[i] = pixel_difference (col, src + i * n_components,
+                                      antialias, threshold,
+                                      n_components, has_alpha,
+                                      select_transparent,
+                                      select_criterion);
+        }
+
+      return;
+    }
+
+  /*  compute the distances first...  */
+  if (n_colors == 3)
+    {
+      const gfloat c0 = col[0];
+      const gfloat c1 = col[1];
+      const gfloat c2 = col[2];
+
+      for (i = 0; i < n_pixels; i++)
+        {
+          const gfloat *s = src + i * n_components;
+
+          dest[i] = MAX (MAX (fabsf (c0 - s[0]), fabsf (c1 - s[1])),
+                         fabsf (c2 - s[2]));
+        }
+    }
+  else
+    {
+      const gfloat c0 = col[0];
+
+      for (i = 0; i < n_pixels; i++)
+        dest[i] = fabsf (c0 - src[i * n_components]);
+    }
+
+  /*  ...never select transparent regions...  */
+  if (has_alpha)
+    {
+      for (i = 0; i < n_pixels; i++)
+        {
+          if (src[i * n_components + n_colors] == 0.0f)
+            dest[i] = G_MAXFLOAT;
+        }
+    }
+
+  /*  ...and map them to the selection values  */
+  if (antialias && threshold > 0.0f)
+    {
+      for (i = 0; i < n_pixels; i++)
+        {
+          gfloat aa = 1.5f - dest[i] / threshold;
+
+          dest[i] = CLAMP (aa * 2.0f, 0.0f, 1.0f);
+        }
+    }
+  else
+    {
+      for (i = 0; i < n_pixels; i++)
+        dest[i] = dest[i] > threshold ? 0.0f : 1.0f;
+    }
+}
+
+static gfloat
+pixel_distance (const gfloat        *col1,
+                const gfloat        *col2,
+                gint                 n_components,
+                gboolean             has_alpha,
+                gboolean             select_transparent,
+                GimpSelectCriterion  select_criterion)
 {
   gfloat max = 0.0;
 
   /*  if there is an alpha channel, never select transparent regions  */
   if (! select_transparent && has_alpha && col2[n_components - 1] == 0.0)
-    return 0.0;
+    return G_MAXFLOAT;
 
   if (select_transparent && has_alpha)
     {
@@ -875,6 +1328,14 @@ pixel_difference (const gfloat        *col1,
         }
     }
 
+  return max;
+}
+
+static gfloat
+distance_to_difference (gfloat   max,
+                        gboolean antialias,
+                        gfloat   threshold)
+{
   if (antialias && threshold > 0.0)
     {
       gfloat aa = 1.5 - (max / threshold);
@@ -895,6 +1356,67 @@ pixel_difference (const gfloat        *col1,
     }
 }
 
+static void
+distance_heap_push (GArray *heap,
+                    gfloat  distance,
+                    gint    index)
+{
+  DistanceNode *nodes;
+  gint          i;
+
+  g_array_set_size (heap, heap->len + 1);
+
+  nodes = (DistanceNode *) heap->data;
+
+  for (i = heap->len - 1; i > 0; i = (i - 1) / 2)
+    {
+      gint parent = (i - 1) / 2;
+
+      if (nodes[parent].distance <= distance)
+        break;
+
+      nodes[i] = nodes[parent];
+    }
+
+  nodes[i].distance = distance;
+  nodes[i].index    = index;
+}
+
+static void
+distance_heap_pop (GArray *heap,
+                   gfloat *distance,
+                   gint   *index)
+{
+  DistanceNode *nodes = (DistanceNode *) heap->data;
+  DistanceNode  last;
+  gint          n;
+  gint          i;
+
+  *distance = nodes[0].distance;
+  *index    = nodes[0].index;
+
+  last = nodes[heap->len - 1];
+  n    = heap->len - 1;
+
+  for (i = 0; 2 * i + 1 < n;)
+    {
+      gint child = 2 * i + 1;
+
+      if (child + 1 < n && nodes[child + 1].distance < nodes[child].distance)
+        child++;
+
+      if (last.distance <= nodes[child].distance)
+        break;
+
+      nodes[i] = nodes[child];
+      i        = child;
+    }
+
+  nodes[i] = last;
+
+  g_array_set_size (heap, n);
+}
+
 static void
 push_segment (GQueue *segment_queue,
               gint    y,
@@ -1082,7 +1604,8 @@ find_contiguous_region (GeglBuffer          *src_buffer,
                         gboolean             diagonal_neighbors,
                         gint                 x,
                         gint                 y,
-                        const gfloat        *col)
+                        const gfloat        *col,
+                        GeglRectangle       *bounds)
 {
   const Babl          *mask_format = babl_format ("Y float");
   GeglSampler         *src_sampler;
@@ -1143,6 +1666,11 @@ find_contiguous_region (GeglBuffer          *src_buffer,
                                          row))
             continue;
 
+          gegl_rectangle_bounding_box (bounds, bounds,
+                                       GEGL_RECTANGLE (new_start + 1, y,
+                                                       new_end - new_start - 1,
+                                                       1));
+
           /* We can skip directly to `new_end + 1` on the next iteration, since
            * we've just selected all pixels in the range `[x, new_end)`, and
            * the pixel at `new_end` is above threshold.  (Note that we assume
@@ -1187,6 +1715,490 @@ find_contiguous_region (GeglBuffer          *src_buffer,
 #endif
 }
 
+static inline gint
+label_find (gint *parent,
+            gint  i)
+{
+  while (parent[i] != i)
+    {
+      parent[i] = parent[parent[i]];
+      i         = parent[i];
+    }
+
+  return i;
+}
+
+static inline void
+label_union (gint *parent,
+             gint  i,
+             gint  j)
+{
+  i = label_find (parent, i);
+  j = label_find (parent, j);
+
+  /* always link to the smaller root, so that each node's parent precedes
+   * it, which label_block() relies on
+   */
+  if (i < j)
+    parent[j] = i;
+  else if (j < i)
+    parent[i] = j;
+}
+
+/* Label the connected components of the nonzero pixels of 'diff', in a
+ * deterministic order.  'labels' receives the label of each pixel,
+ * starting at 1, or 0 for unselected pixels.  'parent' is scratch space,
+ * of the same size.  Returns the number of labels.
+ */
+static gint
+label_block (const gfloat *diff,
+             gint          width,
+             gint          height,
+             gboolean      diagonal_neighbors,
+             gint         *parent,
+             gint         *labels)
+{
+  gint n_labels = 0;
+  gint x, y;
+  gint i;
+
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x < width; x++)
+        {
+          i = y * width + x;
+
+          if (! diff[i])
+            continue;
+
+          parent[i] = i;
+
+          if (x > 0 && diff[i - 1])
+            label_union (parent, i, i - 1);
+
+          if (y > 0)
+            {
+              if (diff[i - width])
+                label_union (parent, i, i - width);
+
+              if (diagonal_neighbors)
+                {
+                  if (x > 0 && diff[i - width - 1])
+                    label_union (parent, i, i - width - 1);
+
+                  if (x + 1 < width && diff[i - width + 1])
+                    label_union (parent, i, i - width + 1);
+                }
+            }
+        }
+    }
+
+  /* each node's parent precedes it, so a single pass in scan order
+   * resolves all the roots
+   */
+  for (i = 0; i < width * height; i++)
+    {
+      if (! diff[i])
+        {
+          labels[i] = 0;
+        }
+      else if (parent[i] == i)
+        {
+          labels[i] = ++n_labels;
+        }
+      else
+        {
+          parent[i] = parent[parent[i]];
+          labels[i] = labels[parent[i]];
+        }
+    }
+
+  return n_labels;
+}
+
+/* Number the labels of the block's edge pixels, in a deterministic order,
+ * and fill the block's border array.  'border_labels' receives the border
+ * label of each label, or -1 for labels not touching the block's edges.
+ * Returns the number of border labels.
+ */
+static gint
+label_block_border (RegionBlock *block,
+                    const gint  *labels,
+                    gint         n_labels,
+                    gint        *border_labels)
+{
+  const gint  width   = block->rect.width;
+  const gint  height  = block->rect.height;
+  gint       *border  = block->border;
+  gint        n       = 0;
+  gint        i;
+
+  for (i = 0; i <= n_labels; i++)
+    border_labels[i] = -1;
+
+  #define BORDER_PIXEL(index)                                  \
+    G_STMT_START                                               \
+      {                                                        \
+        gint label = labels[index];                            \
+                                                               \
+        if (label && border_labels[label] < 0)                 \
+          border_labels[label] = n++;                          \
+                                                               \
+        *border++ = label ? border_labels[label] : -1;         \
+      }                                                        \
+    G_STMT_END
+
+  for (i = 0; i < width; i++)
+    BORDER_PIXEL (i);
+
+  for (i = 0; i < width; i++)
+    BORDER_PIXEL ((height - 1) * width + i);
+
+  for (i = 0; i < height; i++)
+    BORDER_PIXEL (i * width);
+
+  for (i = 0; i < height; i++)
+    BORDER_PIXEL (i * width + width - 1);
+
+  #undef BORDER_PIXEL
+
+  return n;
+}
+
+/* Same as find_contiguous_region(), but labels the connected components
+ * of the whole buffer in parallel, in blocks, and then merges the labels
+ * across the block edges, keeping the component of (x, y).
+ */
+static void
+find_contiguous_region_parallel (GeglBuffer          *src_buffer,
+                                 GeglBuffer          *mask_buffer,
+                                 const Babl          *format,
+                                 gint                 n_components,
+                                 gboolean             has_alpha,
+                                 gboolean             select_transparent,
+                                 GimpSelectCriterion  select_criterion,
+                                 gboolean             antialias,
+                                 gfloat               threshold,
+                                 gboolean             diagonal_neighbors,
+                                 gint                 x,
+                                 gint                 y,
+                                 const gfloat        *col,
+                                 GeglRectangle       *bounds)
+{
+  const Babl          *mask_format = babl_format ("Y float");
+  const GeglRectangle *src_extent  = gegl_buffer_get_extent (src_buffer);
+  RegionBlock         *blocks;
+  RegionBlock         *seed_block;
+  gint                 n_blocks_x;
+  gint                 n_blocks_y;
+  gint                 n_blocks;
+  gint                 seed_label = 0;
+  gint                 seed_root  = -1;
+  gint                *forest;
+  gint                 n_border_labels;
+  gint                 bx, by;
+  gint                 i;
+
+  n_blocks_x = (src_extent->width  + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  n_blocks_y = (src_extent->height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+  n_blocks   = n_blocks_x * n_blocks_y;
+
+  blocks = g_new0 (RegionBlock, n_blocks);
+
+  for (by = 0; by < n_blocks_y; by++)
+    {
+      for (bx = 0; bx < n_blocks_x; bx++)
+        {
+          RegionBlock *block = &blocks[by * n_blocks_x + bx];
+
+          block->rect.x      = src_extent->x + bx * BLOCK_SIZE;
+          block->rect.y      = src_extent->y + by * BLOCK_SIZE;
+          block->rect.width  = MIN (BLOCK_SIZE,
+                                    src_extent->width  - bx * BLOCK_SIZE);
+          block->rect.height = MIN (BLOCK_SIZE,
+                                    src_extent->height - by * BLOCK_SIZE);
+
+          block->border = g_new (gint, 2 * block->rect.width +
+                                       2 * block->rect.height);
+        }
+    }
+
+  seed_block = &blocks[((y - src_extent->y) / BLOCK_SIZE) * n_blocks_x +
+                       ((x - src_extent->x) / BLOCK_SIZE)];
+
+  /* pass 1: compute the pixel differences into the mask, and label each
+   * block's components, keeping only the labels of its edges
+   */
+  gegl_parallel_distribute_range (
+    n_blocks, 1,
+    [&] (gint offset, gint size)
+    {
+      gfloat *src    = g_new (gfloat, BLOCK_SIZE * BLOCK_SIZE * n_components);
+      gfloat *diff   = g_new (gfloat, BLOCK_SIZE * BLOCK_SIZE);
+      gint   *parent = g_new (gint,   BLOCK_SIZE * BLOCK_SIZE);
+      gint   *labels = g_new (gint,   BLOCK_SIZE * BLOCK_SIZE);
+      gint   *border_labels;
+      gint    b;
+
+      border_labels = g_new (gint, BLOCK_SIZE * BLOCK_SIZE + 1);
+
+      for (b = offset; b < offset + size; b++)
+        {
+          RegionBlock *block    = &blocks[b];
+          gint         n_pixels = block->rect.width * block->rect.height;
+          gint         n_labels;
+          gint         j;
+
+          gegl_buffer_get (src_buffer, &block->rect, 1.0, format, src,
+                           GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+          pixel_difference_row (col, src, diff, n_pixels,
+                                antialias, threshold,
+                                n_components, has_alpha,
+                                select_transparent,
+                                select_criterion);
+
+          gegl_buffer_set (mask_buffer, &block->rect, 0, mask_format, diff,
+                           GEGL_AUTO_ROWSTRIDE);
+
+          n_labels = label_block (diff,
+                                  block->rect.width, block->rect.height,
+                                  diagonal_neighbors, parent, labels);
+
+          block->n_border_labels = label_block_border (block,
+                                                       labels, n_labels,
+                                                       border_labels);
+
+          if (block == seed_block)
+            {
+              seed_label = labels[(y - block->rect.y) * block->rect.width +
+                                  (x - block->rect.x)];
+
+              if (seed_label && border_labels[seed_label] >= 0)
+                seed_root = border_labels[seed_label];
+            }
+        }
+
+      g_free (border_labels);
+      g_free (labels);
+      g_free (parent);
+      g_free (diff);
+      g_free (src);
+    });
+
+  /* pass 2: merge the border labels across the block edges */
+  n_border_labels = 0;
+
+  for (i = 0; i < n_blocks; i++)
+    {
+      blocks[i].base   = n_border_labels;
+      n_border_labels += blocks[i].n_border_labels;
+    }
+
+  forest = g_new (gint, MAX (n_border_labels, 1));
+
+  for (i = 0; i < n_border_labels; i++)
+    forest[i] = i;
+
+  #define MERGE(block1, label1, block2, label2)                           \
+    G_STMT_START                                                          \
+      {                                                                   \
+        gint l1 = (label1);                                               \
+        gint l2 = (label2);                                               \
+                                                                          \
+        if (l1 >= 0 && l2 >= 0)                                           \
+          label_union (forest, (block1)->base + l1, (block2)->base + l2); \
+      }                                                                   \
+    G_STMT_END
+
+  for (by = 0; by < n_blocks_y; by++)
+    {
+      for (bx = 0; bx < n_blocks_x; bx++)
+        {
+          RegionBlock *block  = &blocks[by * n_blocks_x + bx];
+          gint         width  = block->rect.width;
+          gint         height = block->rect.height;
+          const gint  *bottom = block->border + width;
+          const gint  *right  = block->border + 2 * width + height;
+
+          if (bx + 1 < n_blocks_x)
+            {
+              RegionBlock *next = block + 1;
+              const gint  *left = next->border + 2 * next->rect.width;
+
+              for (i = 0; i < height; i++)
+                {
+                  MERGE (block, right[i], next, left[i]);
+
+                  if (diagonal_neighbors)
+                    {
+                      if (i > 0)
+                        MERGE (block, right[i], next, left[i - 1]);
+
+                      if (i + 1 < height)
+                        MERGE (block, right[i], next, left[i + 1]);
+                    }
+                }
+            }
+
+          if (by + 1 < n_blocks_y)
+            {
+              RegionBlock *next = block + n_blocks_x;
+              const gint  *top  = next->border;
+
+              for (i = 0; i < width; i++)
+                {
+                  MERGE (block, bottom[i], next, top[i]);
+
+                  if (diagonal_neighbors)
+                    {
+                      if (i > 0)
+                        MERGE (block, bottom[i], next, top[i - 1]);
+
+                      if (i + 1 < width)
+                        MERGE (block, bottom[i], next, top[i + 1]);
+                    }
+                }
+
+              if (diagonal_neighbors)
+                {
+                  if (bx + 1 < n_blocks_x)
+                    {
+                      RegionBlock *corner = next + 1;
+
+                      MERGE (block, bottom[width - 1], corner, corner->border[0]);
+                    }
+
+                  if (bx > 0)
+                    {
+                      RegionBlock *corner = next - 1;
+
+                      MERGE (block, bottom[0],
+                             corner, corner->border[corner->rect.width - 1]);
+                    }
+                }
+            }
+        }
+    }
+
+  #undef MERGE
+
+  if (seed_root >= 0)
+    seed_root = label_find (forest, seed_block->base + seed_root);
+
+  for (i = 0; i < n_blocks; i++)
+    {
+      RegionBlock *block = &blocks[i];
+      gint         j;
+
+      for (j = 0; j < block->n_border_labels && ! block->selected; j++)
+        {
+          if (seed_root >= 0 &&
+              label_find (forest, block->base + j) == seed_root)
+            {
+              block->selected = TRUE;
+            }
+        }
+    }
+
+  /* resolve all the roots, so that the forest can be read concurrently */
+  for (i = 0; i < n_border_labels; i++)
+    forest[i] = label_find (forest, i);
+
+  if (seed_label)
+    seed_block->selected = TRUE;
+
+  /* the region is within the selected blocks */
+  for (i = 0; i < n_blocks; i++)
+    {
+      if (blocks[i].selected)
+        gegl_rectangle_bounding_box (bounds, bounds, &blocks[i].rect);
+    }
+
+  /* pass 3: clear the pixels outside the seed's component.  the blocks are
+   * relabeled from the mask, which yields the same labels as in pass 1.
+   */
+  gegl_parallel_distribute_range (
+    n_blocks, 1,
+    [&] (gint offset, gint size)
+    {
+      gfloat *diff          = NULL;
+      gint   *parent        = NULL;
+      gint   *labels        = NULL;
+      gint   *border_labels = NULL;
+      gint    b;
+
+      for (b = offset; b < offset + size; b++)
+        {
+          RegionBlock *block    = &blocks[b];
+          gint         n_pixels = block->rect.width * block->rect.height;
+          gint         n_labels;
+          gint         j;
+
+          if (! block->selected)
+            {
+              gegl_buffer_clear (mask_buffer, &block->rect);
+
+              continue;
+            }
+
+          if (! diff)
+            {
+              diff          = g_new (gfloat, BLOCK_SIZE * BLOCK_SIZE);
+              parent        = g_new (gint,   BLOCK_SIZE * BLOCK_SIZE);
+              labels        = g_new (gint,   BLOCK_SIZE * BLOCK_SIZE);
+              border_labels = g_new (gint,   BLOCK_SIZE * BLOCK_SIZE + 1);
+            }
+
+          gegl_buffer_get (mask_buffer, &block->rect, 1.0, mask_format, diff,
+                           GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+          n_labels = label_block (diff,
+                                  block->rect.width, block->rect.height,
+                                  diagonal_neighbors, parent, labels);
+
+          label_block_border (block, labels, n_labels, border_labels);
+
+          /* reuse 'border_labels' as the set of labels to keep */
+          for (j = 1; j <= n_labels; j++)
+            {
+              gint border_label = border_labels[j];
+
+              if (border_label >= 0)
+                {
+                  border_labels[j] =
+                    seed_root >= 0 &&
+                    forest[block->base + border_label] == seed_root;
+                }
+              else
+                {
+                  border_labels[j] = block == seed_block && j == seed_label;
+                }
+            }
+
+          for (j = 0; j < n_pixels; j++)
+            {
+              if (labels[j] && ! border_labels[labels[j]])
+                diff[j] = 0.0;
+            }
+
+          gegl_buffer_set (mask_buffer, &block->rect, 0, mask_format, diff,
+                           GEGL_AUTO_ROWSTRIDE);
+        }
+
+      g_free (border_labels);
+      g_free (labels);
+      g_free (parent);
+      g_free (diff);
+    });
+
+  for (i = 0; i < n_blocks; i++)
+    g_free (blocks[i].border);
+
+  g_free (blocks);
+  g_free (forest);
+}
+
 static void
 line_art_queue_pixel (GQueue *queue,
                       gint    x,
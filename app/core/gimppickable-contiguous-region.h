@@ -21,11 +21,22 @@
 GeglBuffer * gimp_pickable_contiguous_region_by_seed                (GimpPickable        *pickable,
                                                                      gboolean             antialias,
                                                                      gfloat               threshold,
+                                                                     gboolean             select_transparent,
+                                                                     GimpSelectCriterion  select_criterion,
+                                                                     gboolean             diagonal_neighbors,
+                                                                     gint                 x,
+                                                                     gint                 y,
+                                                                     GeglRectangle       *bounds);
+
+GeglBuffer * gimp_pickable_contiguous_region_distance_map           (GimpPickable        *pickable,
                                                                      gboolean             select_transparent,
                                                                      GimpSelectCriterion  select_criterion,
                                                                      gboolean             diagonal_neighbors,
                                                                      gint                 x,
                                                                      gint                 y);
+GeglBuffer * gimp_pickable_contiguous_region_by_distance_map        (GeglBuffer          *map_buffer,
+                                                                     gboolean             antialias,
+                                                                     gfloat               threshold);
 
 GeglBuffer * gimp_pickable_contiguous_region_by_color               (GimpPickable        *pickable,
                                                                      gboolean             antialias,
@@ -29,14 +29,25 @@
 
 #include "core-types.h"
 
+#include "config/gimpgeglconfig.h"
+
 #include "gegl/gimp-babl.h"
 #include "gegl/gimp-gegl-loops.h"
 #include "gegl/gimp-gegl-utils.h"
+#include "gegl/gimpsummedareatable.h"
 
 #include "gimp.h"
+#include "gimp-frame-stats.h"
 #include "gimp-memsize.h"
+#include "gimp-parallel.h"
+#include "gimp-swap-stats.h"
+#include "gimp-tile-profile.h"
+#include "gimpasync.h"
+#include "gimpcancelable.h"
 #include "gimpchunkiterator.h"
 #include "gimpimage.h"
+#include "gimplayer.h"
+#include "gimplayermask.h"
 #include "gimpmarshal.h"
 #include "gimppickable.h"
 #include "gimpprojectable.h"
@@ -51,6 +62,17 @@
 #define GIMP_PROJECTION_UPDATE_CHUNK_WIDTH  32
 #define GIMP_PROJECTION_UPDATE_CHUNK_HEIGHT 32
 
+/*  when rendering the priority rect would take longer than this many
+ *  seconds, it is first rendered at a coarse mipmap level
+ */
+#define GIMP_PROJECTION_PREVIEW_TIME        0.05
+#define GIMP_PROJECTION_PREVIEW_MAX_LEVEL   3
+
+/*  the render thread is only stopped between chunks, so keep them short
+ *  enough not to hold back the events that stop it
+ */
+#define GIMP_PROJECTION_RENDER_INTERVAL     (1.0 / 60.0) /* seconds */
+
 
 enum
 {
@@ -65,12 +87,20 @@ enum
 };
 
 
+typedef struct
+{
+  GeglBuffer    *buffer;
+  GeglRectangle  rect;
+} ReadAheadArea;
+
+
 struct _GimpProjectionPrivate
 {
   GimpProjectable           *projectable;
 
   GeglBuffer                *buffer;
   GimpTileHandlerValidate   *validate_handler;
+  GimpSummedAreaTable       *summed_area_table;
 
   gint                       priority;
 
@@ -78,6 +108,13 @@ struct _GimpProjectionPrivate
   GeglRectangle              priority_rect;
   GimpChunkIterator         *iter;
   guint                      idle_id;
+  gboolean                   render_queued;
+  GArray                    *render_rects;
+  gint64                     render_time;
+  gdouble                    render_pixels;
+  gint                       render_chunks;
+  gdouble                    pixel_rate;
+  GimpAsync                 *read_ahead;
 
   gboolean                   invalidate_preview;
 };
@@ -124,12 +161,39 @@ static void        gimp_projection_add_update_area       (GimpProjection  *proj,
                                                           gint             y,
                                                           gint             w,
                                                           gint             h);
+static void        gimp_projection_get_priority_area     (GimpProjection  *proj,
+                                                          GeglRectangle   *rect);
 static void        gimp_projection_update_priority_rect  (GimpProjection  *proj);
+static void        gimp_projection_paint_preview         (GimpProjection  *proj,
+                                                          cairo_region_t  *region);
 static gboolean    gimp_projection_chunk_render_start    (GWeakRef        *proj_ref);
 static void        gimp_projection_chunk_render_stop     (GimpProjection  *proj,
                                                           gboolean         merge);
 static gboolean    gimp_projection_chunk_render_callback (GimpProjection  *proj);
 static gboolean    gimp_projection_chunk_render_iteration(GimpProjection  *proj);
+static void        gimp_projection_chunk_render_finish   (GimpProjection  *proj);
+static void        gimp_projection_chunk_render_add_stats(GimpProjection  *proj,
+                                                          gint64           time,
+                                                          gdouble          n_pixels,
+                                                          gint             n_chunks);
+static void        gimp_projection_chunk_render_queue    (GimpProjection  *proj);
+static void        gimp_projection_chunk_render_dequeue  (GimpProjection  *proj);
+static void        gimp_projection_chunk_render_update   (GimpProjection  *proj);
+static gint        gimp_projection_chunk_render_poll     (GPollFD         *fds,
+                                                          guint            nfds,
+                                                          gint             timeout);
+static gpointer    gimp_projection_chunk_render_thread   (gpointer         data);
+static gint        gimp_projection_compare_priority      (GimpProjection  *proj1,
+                                                          GimpProjection  *proj2,
+                                                          gpointer         data);
+static void        gimp_projection_read_ahead            (GimpProjection  *proj);
+static void        gimp_projection_read_ahead_func       (GimpAsync       *async,
+                                                          GArray          *areas);
+static void        gimp_projection_read_ahead_area_clear (ReadAheadArea   *area);
+static gboolean    gimp_projection_render_area           (GimpProjection  *proj,
+                                                          gboolean         now,
+                                                          const GeglRectangle *area,
+                                                          GeglRectangle   *rect);
 static void        gimp_projection_paint_area            (GimpProjection  *proj,
                                                           gboolean         now,
                                                           gint             x,
@@ -137,6 +201,10 @@ static void        gimp_projection_paint_area            (GimpProjection  *proj,
                                                           gint             w,
                                                           gint             h);
 
+static void        gimp_projection_buffer_invalidated    (GimpTileHandlerValidate *validate,
+                                                          const GeglRectangle     *rect,
+                                                          GimpProjection          *proj);
+
 static void        gimp_projection_projectable_invalidate(GimpProjectable *projectable,
                                                           gint             x,
                                                           gint             y,
@@ -165,6 +233,25 @@ G_DEFINE_TYPE_WITH_CODE (GimpProjection, gimp_projection, GIMP_TYPE_OBJECT,
 static guint projection_signals[LAST_SIGNAL] = { 0 };
 
 
+/*  with the parallel-projection option, chunks are rendered by the render
+ *  thread, from the main context's poll function:  it only runs while the
+ *  main thread waits for events, and is stopped, after its current chunk,
+ *  as soon as the poll returns, before anything is dispatched.  the
+ *  projectable graphs are only modified by the main thread, from
+ *  dispatched sources, so while the render thread runs, it has them, and
+ *  the projection, to itself.
+ */
+static GThread        *render_thread;
+static GPollFunc       render_poll_func;
+
+static GQueue          render_queue = G_QUEUE_INIT;
+
+static GMutex          render_mutex;
+static GCond           render_cond;
+static GimpProjection *render_proj;
+static gint            render_stop;
+
+
 static void
 gimp_projection_class_init (GimpProjectionClass *klass)
 {
@@ -220,6 +307,8 @@ gimp_projection_finalize (GObject *object)
 
   gimp_projection_free_buffer (proj);
 
+  g_clear_pointer (&proj->priv->render_rects, g_array_unref);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -339,8 +428,40 @@ static const Babl *
 gimp_projection_get_format (GimpPickable *pickable)
 {
   GimpProjection *proj = GIMP_PROJECTION (pickable);
+  const Babl     *format;
+
+  /*  keep reporting the format of an existing buffer, in case the
+   *  half-float-projection option changed after it was allocated
+   */
+  if (proj->priv->buffer)
+    return gegl_buffer_get_format (proj->priv->buffer);
+
+  format = gimp_projectable_get_format (proj->priv->projectable);
+
+  /*  only the image projection is reduced to half float, group layer
+   *  projections are the groups' pixel data
+   */
+  if (GIMP_IS_IMAGE (proj->priv->projectable))
+    {
+      GimpImage *image = GIMP_IMAGE (proj->priv->projectable);
 
-  return gimp_projectable_get_format (proj->priv->projectable);
+      if (GIMP_GEGL_CONFIG (image->gimp->config)->half_float_projection)
+        {
+          switch (gimp_babl_format_get_component_type (format))
+            {
+            case GIMP_COMPONENT_TYPE_FLOAT:
+            case GIMP_COMPONENT_TYPE_DOUBLE:
+              format = gimp_babl_format_change_component_type (
+                format, GIMP_COMPONENT_TYPE_HALF);
+              break;
+
+            default:
+              break;
+            }
+        }
+    }
+
+  return format;
 }
 
 static GeglBuffer *
@@ -415,10 +536,15 @@ gimp_projection_get_pixel_average (GimpPickable        *pickable,
                                    const Babl          *format,
                                    gpointer             pixel)
 {
-  GeglBuffer *buffer = gimp_projection_get_buffer (pickable);
+  GimpProjection *proj   = GIMP_PROJECTION (pickable);
+  GeglBuffer     *buffer = gimp_projection_get_buffer (pickable);
 
-  return gimp_gegl_average_color (buffer, rect, TRUE, GEGL_ABYSS_NONE, format,
-                                  pixel);
+  if (! gimp_summed_area_table_get_average (proj->priv->summed_area_table,
+                                            rect, format, pixel))
+    {
+      gimp_gegl_average_color (buffer, rect, TRUE, GEGL_ABYSS_NONE, format,
+                               pixel);
+    }
 }
 
 
@@ -561,6 +687,8 @@ gimp_projection_finish_draw (GimpProjection *proj)
 {
   g_return_if_fail (GIMP_IS_PROJECTION (proj));
 
+  gimp_projection_chunk_render_update (proj);
+
   if (proj->priv->iter)
     {
       gimp_chunk_iterator_set_priority_rect (proj->priv->iter, NULL);
@@ -575,6 +703,18 @@ gimp_projection_finish_draw (GimpProjection *proj)
     }
 }
 
+/*  frees the projection's buffer, including its mipmap levels, to save
+ *  memory.  the buffer is recreated, and rendered again, the next time
+ *  it's needed.
+ */
+void
+gimp_projection_release_buffer (GimpProjection *proj)
+{
+  g_return_if_fail (GIMP_IS_PROJECTION (proj));
+
+  gimp_projection_free_buffer (proj);
+}
+
 
 /*  private functions  */
 
@@ -600,6 +740,20 @@ gimp_projection_allocate_buffer (GimpProjection *proj)
   gimp_tile_handler_validate_assign (proj->priv->validate_handler,
                                      proj->priv->buffer);
 
+  /*  averages for the color picker and sample points, kept per cell,
+   *  and dropped whenever the projection is invalidated
+   */
+  proj->priv->summed_area_table = gimp_summed_area_table_new ();
+  gimp_summed_area_table_set_buffer (proj->priv->summed_area_table,
+                                     proj->priv->buffer);
+
+  g_signal_connect (proj->priv->validate_handler, "invalidated",
+                    G_CALLBACK (gimp_projection_buffer_invalidated),
+                    proj);
+
+  gimp_tile_profile_add_projection (proj->priv->projectable,
+                                    proj->priv->buffer);
+
   g_object_notify (G_OBJECT (proj), "buffer");
 }
 
@@ -612,9 +766,17 @@ gimp_projection_free_buffer (GimpProjection  *proj)
 
   if (proj->priv->buffer)
     {
+      g_signal_handlers_disconnect_by_func (
+        proj->priv->validate_handler,
+        gimp_projection_buffer_invalidated,
+        proj);
+
       gimp_tile_handler_validate_unassign (proj->priv->validate_handler,
                                            proj->priv->buffer);
 
+      g_clear_pointer (&proj->priv->summed_area_table,
+                       gimp_summed_area_table_free);
+
       g_clear_object (&proj->priv->buffer);
       g_clear_object (&proj->priv->validate_handler);
 
@@ -655,37 +817,121 @@ gimp_projection_add_update_area (GimpProjection *proj,
     }
 }
 
+static void
+gimp_projection_get_priority_area (GimpProjection *proj,
+                                   GeglRectangle  *rect)
+{
+  GeglRectangle bounding_box;
+  gint          off_x, off_y;
+
+  *rect = proj->priv->priority_rect;
+
+  gimp_projectable_get_offset (proj->priv->projectable, &off_x, &off_y);
+  bounding_box = gimp_projectable_get_bounding_box (proj->priv->projectable);
+
+  /*  subtract the projectable's offsets because the list of update
+   *  areas is in tile-pyramid coordinates, but our external API is
+   *  always in terms of image coordinates.
+   */
+  rect->x -= off_x;
+  rect->y -= off_y;
+
+  gegl_rectangle_intersect (rect, rect, &bounding_box);
+}
+
 static void
 gimp_projection_update_priority_rect (GimpProjection *proj)
 {
   if (proj->priv->iter)
     {
       GeglRectangle rect;
-      GeglRectangle bounding_box;
-      gint          off_x, off_y;
 
-      rect = proj->priv->priority_rect;
+      gimp_projection_get_priority_area (proj, &rect);
 
-      gimp_projectable_get_offset (proj->priv->projectable, &off_x, &off_y);
-      bounding_box = gimp_projectable_get_bounding_box (proj->priv->projectable);
+      gimp_chunk_iterator_set_priority_rect (proj->priv->iter, &rect);
+    }
+}
 
-      /*  subtract the projectable's offsets because the list of update
-       *  areas is in tile-pyramid coordinates, but our external API is
-       *  always in terms of image coordinates.
-       */
-      rect.x -= off_x;
-      rect.y -= off_y;
+/*  if the priority rect takes long to render, judging by the speed of the
+ *  previous renders, give quick feedback by rendering the dirty part of it
+ *  at a coarse level first.  the area stays dirty, and is refined at full
+ *  resolution by the chunk iterator, priority rect first.
+ */
+static void
+gimp_projection_paint_preview (GimpProjection *proj,
+                               cairo_region_t *region)
+{
+  GeglRectangle   rect;
+  cairo_region_t *preview_region;
+  gdouble         n_pixels = 0.0;
+  gint            n_rects;
+  gint            level;
+  gint            i;
+
+  if (proj->priv->pixel_rate <= 0.0)
+    return;
 
-      gegl_rectangle_intersect (&rect, &rect, &bounding_box);
+  gimp_projection_get_priority_area (proj, &rect);
 
-      gimp_chunk_iterator_set_priority_rect (proj->priv->iter, &rect);
+  if (gegl_rectangle_is_empty (&rect))
+    return;
+
+  preview_region = cairo_region_copy (region);
+
+  cairo_region_intersect_rectangle (preview_region,
+                                    (const cairo_rectangle_int_t *) &rect);
+
+  n_rects = cairo_region_num_rectangles (preview_region);
+
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_region_get_rectangle (preview_region, i,
+                                  (cairo_rectangle_int_t *) &rect);
+
+      n_pixels += (gdouble) rect.width * rect.height;
     }
+
+  /*  each level has a quarter of the pixels of the previous one  */
+  for (level = 0;
+       level < GIMP_PROJECTION_PREVIEW_MAX_LEVEL &&
+       n_pixels / proj->priv->pixel_rate > GIMP_PROJECTION_PREVIEW_TIME;
+       level++)
+    {
+      n_pixels /= 4.0;
+    }
+
+  if (level > 0)
+    {
+      gint off_x, off_y;
+
+      gimp_projectable_get_offset (proj->priv->projectable, &off_x, &off_y);
+
+      for (i = 0; i < n_rects; i++)
+        {
+          cairo_region_get_rectangle (preview_region, i,
+                                      (cairo_rectangle_int_t *) &rect);
+
+          gimp_tile_handler_validate_preview (proj->priv->validate_handler,
+                                              proj->priv->buffer,
+                                              &rect, level);
+
+          g_signal_emit (proj, projection_signals[UPDATE], 0,
+                         TRUE,
+                         rect.x + off_x,
+                         rect.y + off_y,
+                         rect.width,
+                         rect.height);
+        }
+    }
+
+  cairo_region_destroy (preview_region);
 }
 
 static gboolean
 gimp_projection_chunk_render_start (GWeakRef *proj_ref)
 {
   GimpProjection *proj;
+  GimpImage      *image;
 
   proj = g_weak_ref_get (proj_ref);
   g_weak_ref_clear (proj_ref);
@@ -694,6 +940,8 @@ gimp_projection_chunk_render_start (GWeakRef *proj_ref)
   if (proj == NULL)
     return G_SOURCE_REMOVE;
 
+  image = gimp_projectable_get_image (proj->priv->projectable);
+
   if (proj->priv->update_region)
     {
       cairo_region_t *region             = proj->priv->update_region;
@@ -723,15 +971,29 @@ gimp_projection_chunk_render_start (GWeakRef *proj_ref)
 
       if (region && ! cairo_region_is_empty (region))
         {
+          gimp_projection_paint_preview (proj, region);
+
           proj->priv->iter = gimp_chunk_iterator_new (region);
 
           gimp_projection_update_priority_rect (proj);
 
-          if (! proj->priv->idle_id)
+          if (GIMP_GEGL_CONFIG (image->gimp->config)->parallel_projection)
+            {
+              gimp_chunk_iterator_set_interval (proj->priv->iter,
+                                                GIMP_PROJECTION_RENDER_INTERVAL);
+
+              gimp_projection_chunk_render_queue (proj);
+            }
+          else
             {
-              proj->priv->idle_id = g_idle_add_full (GIMP_PRIORITY_PROJECTION_IDLE + proj->priv->priority,
-                                                     (GSourceFunc) gimp_projection_chunk_render_callback,
-                                                     proj, NULL);
+              gimp_projection_chunk_render_dequeue (proj);
+
+              if (! proj->priv->idle_id)
+                {
+                  proj->priv->idle_id = g_idle_add_full (GIMP_PRIORITY_PROJECTION_IDLE + proj->priv->priority,
+                                                         (GSourceFunc) gimp_projection_chunk_render_callback,
+                                                         proj, NULL);
+                }
             }
         }
       else
@@ -739,6 +1001,9 @@ gimp_projection_chunk_render_start (GWeakRef *proj_ref)
           if (region)
             cairo_region_destroy (region);
 
+          gimp_projection_chunk_render_dequeue (proj);
+          gimp_projection_chunk_render_update (proj);
+
           if (proj->priv->idle_id)
             {
               g_source_remove (proj->priv->idle_id);
@@ -781,6 +1046,22 @@ gimp_projection_chunk_render_stop (GimpProjection *proj,
       proj->priv->idle_id = 0;
     }
 
+  gimp_projection_chunk_render_dequeue (proj);
+
+  /*  the chunks already rendered by the render thread are valid, so they
+   *  still need to be shown, unless the buffer goes away
+   */
+  if (merge)
+    {
+      gimp_projection_chunk_render_update (proj);
+    }
+  else if (proj->priv->render_chunks)
+    {
+      g_array_set_size (proj->priv->render_rects, 0);
+
+      proj->priv->render_chunks = 0;
+    }
+
   if (proj->priv->iter)
     {
       if (merge)
@@ -807,11 +1088,30 @@ gimp_projection_chunk_render_stop (GimpProjection *proj,
 
       proj->priv->iter = NULL;
     }
+
+  if (proj->priv->read_ahead)
+    {
+      gimp_cancelable_cancel (GIMP_CANCELABLE (proj->priv->read_ahead));
+
+      g_clear_object (&proj->priv->read_ahead);
+    }
 }
 
 static gboolean
 gimp_projection_chunk_render_callback (GimpProjection *proj)
 {
+  gimp_projection_chunk_render_update (proj);
+
+  /*  the render thread resumes from the poll function  */
+  if (proj->priv->render_queued)
+    {
+      gimp_projection_read_ahead (proj);
+
+      proj->priv->idle_id = 0;
+
+      return G_SOURCE_REMOVE;
+    }
+
   if (gimp_projection_chunk_render_iteration (proj))
     {
       return G_SOURCE_CONTINUE;
@@ -827,9 +1127,15 @@ gimp_projection_chunk_render_callback (GimpProjection *proj)
 static gboolean
 gimp_projection_chunk_render_iteration (GimpProjection *proj)
 {
-  if (gimp_chunk_iterator_next (proj->priv->iter))
+  if (proj->priv->iter && gimp_chunk_iterator_next (proj->priv->iter))
     {
       GeglRectangle rect;
+      gint64        start_time = g_get_monotonic_time ();
+      gdouble       n_pixels   = 0.0;
+      gint          n_chunks   = 0;
+      GIMP_TRACE_SPAN (span);
+
+      GIMP_TRACE_BEGIN (span, "projection-chunk-render");
 
       gimp_tile_handler_validate_begin_validate (proj->priv->validate_handler);
 
@@ -837,30 +1143,505 @@ gimp_projection_chunk_render_iteration (GimpProjection *proj)
         {
           gimp_projection_paint_area (proj, TRUE,
                                       rect.x, rect.y, rect.width, rect.height);
+
+          n_pixels += (gdouble) rect.width * rect.height;
+          n_chunks++;
         }
 
       gimp_tile_handler_validate_end_validate (proj->priv->validate_handler);
 
+      GIMP_TRACE_END (span);
+
+      gimp_projection_chunk_render_add_stats (
+        proj, g_get_monotonic_time () - start_time, n_pixels, n_chunks);
+
+      gimp_projection_read_ahead (proj);
+
       /* Still work to do. */
       return TRUE;
     }
   else
     {
+      gimp_projection_chunk_render_finish (proj);
+
+      /* FINISHED */
+      return FALSE;
+    }
+}
+
+static void
+gimp_projection_chunk_render_finish (GimpProjection *proj)
+{
+  proj->priv->iter = NULL;
+
+  if (proj->priv->invalidate_preview)
+    {
+      /* invalidate the preview here since it is constructed from
+       * the projection
+       */
+      proj->priv->invalidate_preview = FALSE;
+
+      gimp_projectable_invalidate_preview (proj->priv->projectable);
+    }
+}
+
+static void
+gimp_projection_chunk_render_add_stats (GimpProjection *proj,
+                                        gint64          time,
+                                        gdouble         n_pixels,
+                                        gint            n_chunks)
+{
+  /*  keep a running estimate of the rendering speed, in pixels per
+   *  second, for gimp_projection_paint_preview()
+   */
+  gimp_frame_stats_add_projection (time, n_chunks);
+
+  if (time > 0)
+    {
+      gdouble pixel_rate = n_pixels * G_TIME_SPAN_SECOND / time;
+
+      if (proj->priv->pixel_rate > 0.0)
+        pixel_rate = (proj->priv->pixel_rate + pixel_rate) / 2.0;
+
+      proj->priv->pixel_rate = pixel_rate;
+    }
+}
+
+static void
+gimp_projection_chunk_render_queue (GimpProjection *proj)
+{
+  if (proj->priv->render_queued)
+    return;
+
+  if (! render_thread)
+    {
+      render_poll_func = g_main_context_get_poll_func (NULL);
+
+      g_main_context_set_poll_func (NULL, gimp_projection_chunk_render_poll);
+
+      render_thread = g_thread_new ("projection",
+                                    gimp_projection_chunk_render_thread,
+                                    NULL);
+    }
+
+  if (! proj->priv->render_rects)
+    {
+      proj->priv->render_rects = g_array_new (FALSE, FALSE,
+                                              sizeof (GeglRectangle));
+    }
+
+  g_queue_insert_sorted (&render_queue, proj,
+                         (GCompareDataFunc) gimp_projection_compare_priority,
+                         NULL);
+
+  proj->priv->render_queued = TRUE;
+}
+
+static void
+gimp_projection_chunk_render_dequeue (GimpProjection *proj)
+{
+  if (! proj->priv->render_queued)
+    return;
+
+  g_queue_remove (&render_queue, proj);
+
+  proj->priv->render_queued = FALSE;
+}
+
+/*  shows the chunks rendered by the render thread  */
+static void
+gimp_projection_chunk_render_update (GimpProjection *proj)
+{
+  gint off_x, off_y;
+  gint i;
+
+  if (! proj->priv->render_chunks)
+    return;
+
+  gimp_projectable_get_offset (proj->priv->projectable, &off_x, &off_y);
+
+  for (i = 0; i < proj->priv->render_rects->len; i++)
+    {
+      const GeglRectangle *rect = &g_array_index (proj->priv->render_rects,
+                                                  GeglRectangle, i);
+
+      g_signal_emit (proj, projection_signals[UPDATE], 0,
+                     TRUE,
+                     rect->x + off_x,
+                     rect->y + off_y,
+                     rect->width,
+                     rect->height);
+    }
+
+  gimp_projection_chunk_render_add_stats (proj,
+                                          proj->priv->render_time,
+                                          proj->priv->render_pixels,
+                                          proj->priv->render_chunks);
+
+  g_array_set_size (proj->priv->render_rects, 0);
+
+  proj->priv->render_chunks = 0;
+}
+
+/*  renders an iteration of the first queued projection on the render
+ *  thread, for as long as the main thread waits for events.  anything that
+ *  needs the main loop, like showing the rendered chunks, is left to the
+ *  projection's idle callback.
+ */
+static gint
+gimp_projection_chunk_render_poll (GPollFD *fds,
+                                   guint    nfds,
+                                   gint     timeout)
+{
+  GimpProjection *proj = g_queue_peek_head (&render_queue);
+  gint            result;
+
+  /*  only render when there's nothing else to do  */
+  if (! proj || timeout == 0)
+    return render_poll_func (fds, nfds, timeout);
+
+  if (! gimp_chunk_iterator_next (proj->priv->iter))
+    {
+      /*  the iterator is done, and freed.  have the idle callback finish
+       *  right away.
+       */
       proj->priv->iter = NULL;
 
-      if (proj->priv->invalidate_preview)
+      gimp_projection_chunk_render_dequeue (proj);
+
+      result = render_poll_func (fds, nfds, 0);
+    }
+  else
+    {
+      gimp_tile_handler_validate_begin_validate (proj->priv->validate_handler);
+
+      g_mutex_lock (&render_mutex);
+
+      g_atomic_int_set (&render_stop, FALSE);
+
+      render_proj = proj;
+      g_cond_broadcast (&render_cond);
+
+      g_mutex_unlock (&render_mutex);
+
+      result = render_poll_func (fds, nfds, timeout);
+
+      g_atomic_int_set (&render_stop, TRUE);
+
+      g_mutex_lock (&render_mutex);
+
+      while (render_proj)
+        g_cond_wait (&render_cond, &render_mutex);
+
+      g_mutex_unlock (&render_mutex);
+
+      gimp_tile_handler_validate_end_validate (proj->priv->validate_handler);
+    }
+
+  if (! proj->priv->idle_id)
+    {
+      proj->priv->idle_id = g_idle_add_full (GIMP_PRIORITY_PROJECTION_IDLE + proj->priv->priority,
+                                             (GSourceFunc) gimp_projection_chunk_render_callback,
+                                             proj, NULL);
+    }
+
+  return result;
+}
+
+static gpointer
+gimp_projection_chunk_render_thread (gpointer data)
+{
+  g_mutex_lock (&render_mutex);
+
+  while (TRUE)
+    {
+      GimpProjection *proj;
+      GeglRectangle   rect;
+      gint64          start_time;
+      GIMP_TRACE_SPAN (span);
+
+      while (! render_proj)
+        g_cond_wait (&render_cond, &render_mutex);
+
+      proj = render_proj;
+
+      g_mutex_unlock (&render_mutex);
+
+      GIMP_TRACE_BEGIN (span, "projection-chunk-render");
+
+      start_time = g_get_monotonic_time ();
+
+      proj->priv->render_pixels = 0.0;
+      proj->priv->render_chunks = 0;
+
+      /*  render at least one chunk, so that even a busy main loop lets the
+       *  projection make progress
+       */
+      while (gimp_chunk_iterator_get_rect (proj->priv->iter, &rect))
         {
-          /* invalidate the preview here since it is constructed from
-           * the projection
-           */
-          proj->priv->invalidate_preview = FALSE;
+          GeglRectangle rendered;
 
-          gimp_projectable_invalidate_preview (proj->priv->projectable);
+          if (gimp_projection_render_area (proj, TRUE, &rect, &rendered))
+            g_array_append_val (proj->priv->render_rects, rendered);
+
+          proj->priv->render_pixels += (gdouble) rect.width * rect.height;
+          proj->priv->render_chunks++;
+
+          if (g_atomic_int_get (&render_stop))
+            break;
         }
 
-      /* FINISHED */
-      return FALSE;
+      proj->priv->render_time = g_get_monotonic_time () - start_time;
+
+      GIMP_TRACE_END (span);
+
+      g_mutex_lock (&render_mutex);
+
+      render_proj = NULL;
+      g_cond_broadcast (&render_cond);
+
+      /*  have the main thread show the chunks  */
+      g_main_context_wakeup (NULL);
     }
+
+  g_mutex_unlock (&render_mutex);
+
+  return NULL;
+}
+
+static gint
+gimp_projection_compare_priority (GimpProjection *proj1,
+                                  GimpProjection *proj2,
+                                  gpointer        data)
+{
+  return proj1->priv->priority - proj2->priv->priority;
+}
+
+/*  once the tile cache is exceeded, rendering a chunk stalls on reading
+ *  its layer tiles back from the swap.  while the current chunk renders,
+ *  fetch the tiles of the next one on a worker, so that they're already
+ *  in the cache when it's reached.
+ */
+static void
+gimp_projection_read_ahead (GimpProjection *proj)
+{
+  GimpImage     *image;
+  GeglRectangle  rect;
+  GArray        *areas;
+  GList         *layers;
+  GList         *list;
+  guint64        swap_total;
+
+  if (proj->priv->read_ahead)
+    {
+      if (! gimp_async_is_stopped (proj->priv->read_ahead))
+        return;
+
+      g_clear_object (&proj->priv->read_ahead);
+    }
+
+  /*  group-layer projections read the same layers as the image's, so
+   *  reading ahead for the image projection covers them
+   */
+  if (! GIMP_IS_IMAGE (proj->priv->projectable))
+    return;
+
+  g_object_get (gegl_stats (),
+                "swap-total", &swap_total,
+                NULL);
+
+  /*  nothing to read while the swap is empty  */
+  if (! swap_total)
+    return;
+
+  if (! gimp_chunk_iterator_peek_rect (proj->priv->iter, &rect))
+    return;
+
+  image  = GIMP_IMAGE (proj->priv->projectable);
+  areas  = g_array_new (FALSE, FALSE, sizeof (ReadAheadArea));
+  layers = gimp_image_get_layer_list (image);
+
+  g_array_set_clear_func (areas,
+                          (GDestroyNotify) gimp_projection_read_ahead_area_clear);
+
+  for (list = layers; list; list = g_list_next (list))
+    {
+      GimpLayer    *layer = list->data;
+      GimpDrawable *drawables[2];
+      gint          off_x, off_y;
+      gint          i;
+
+      if (gimp_viewable_get_children (GIMP_VIEWABLE (layer)) ||
+          ! gimp_item_is_visible (GIMP_ITEM (layer)))
+        {
+          continue;
+        }
+
+      drawables[0] = GIMP_DRAWABLE (layer);
+      drawables[1] = NULL;
+
+      if (gimp_layer_get_mask (layer) && gimp_layer_get_apply_mask (layer))
+        drawables[1] = GIMP_DRAWABLE (gimp_layer_get_mask (layer));
+
+      gimp_item_get_offset (GIMP_ITEM (layer), &off_x, &off_y);
+
+      for (i = 0; i < G_N_ELEMENTS (drawables) && drawables[i]; i++)
+        {
+          ReadAheadArea area;
+
+          area.buffer = gimp_drawable_get_buffer (drawables[i]);
+          area.rect   = rect;
+
+          area.rect.x -= off_x;
+          area.rect.y -= off_y;
+
+          if (gegl_rectangle_intersect (&area.rect,
+                                        &area.rect,
+                                        gegl_buffer_get_extent (area.buffer)))
+            {
+              g_object_ref (area.buffer);
+
+              g_array_append_val (areas, area);
+            }
+        }
+    }
+
+  g_list_free (layers);
+
+  if (areas->len == 0)
+    {
+      g_array_unref (areas);
+
+      return;
+    }
+
+  proj->priv->read_ahead = gimp_parallel_run_async_labeled_full (
+    "projection", +1,
+    (GimpRunAsyncFunc) gimp_projection_read_ahead_func,
+    areas,
+    (GDestroyNotify) g_array_unref);
+}
+
+static void
+gimp_projection_read_ahead_func (GimpAsync *async,
+                                 GArray    *areas)
+{
+  guint i;
+
+  for (i = 0; i < areas->len; i++)
+    {
+      const ReadAheadArea *area   = &g_array_index (areas, ReadAheadArea, i);
+      const Babl          *format = gegl_buffer_get_format (area->buffer);
+      gpointer             pixel;
+      gint                 tile_width;
+      gint                 tile_height;
+      gint                 x, y;
+
+      pixel = g_malloc (babl_format_get_bytes_per_pixel (format));
+
+      g_object_get (area->buffer,
+                    "tile-width",  &tile_width,
+                    "tile-height", &tile_height,
+                    NULL);
+
+      /*  fetching a single pixel brings its whole tile into the cache  */
+      for (y = area->rect.y;
+           y < area->rect.y + area->rect.height;
+           y += tile_height - (y % tile_height + tile_height) % tile_height)
+        {
+          for (x = area->rect.x;
+               x < area->rect.x + area->rect.width;
+               x += tile_width - (x % tile_width + tile_width) % tile_width)
+            {
+              guint64 read_total;
+              guint64 new_read_total;
+              gint64  start_time;
+
+              if (gimp_async_is_canceled (async))
+                {
+                  g_free (pixel);
+
+                  gimp_async_abort (async);
+
+                  return;
+                }
+
+              g_object_get (gegl_stats (),
+                            "swap-read-total", &read_total,
+                            NULL);
+
+              start_time = g_get_monotonic_time ();
+
+              gegl_buffer_get (area->buffer, GEGL_RECTANGLE (x, y, 1, 1), 1.0,
+                               format, pixel,
+                               GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+              g_object_get (gegl_stats (),
+                            "swap-read-total", &new_read_total,
+                            NULL);
+
+              /*  only count the fetches that actually hit the swap.  reads
+               *  made concurrently by other threads are attributed to the
+               *  fetch as well, which is fine for a latency estimate.
+               */
+              if (new_read_total > read_total)
+                {
+                  gimp_swap_stats_add_read (g_get_monotonic_time () -
+                                            start_time);
+                  gimp_swap_stats_add_read_ahead (new_read_total - read_total);
+                }
+            }
+        }
+
+      g_free (pixel);
+    }
+
+  gimp_async_finish (async, NULL);
+}
+
+static void
+gimp_projection_read_ahead_area_clear (ReadAheadArea *area)
+{
+  g_object_unref (area->buffer);
+}
+
+/*  renders, or invalidates, the part of 'area' inside the projectable's
+ *  bounding box, and returns it in 'rect'.  returns FALSE if there's no
+ *  such part.
+ */
+static gboolean
+gimp_projection_render_area (GimpProjection      *proj,
+                             gboolean             now,
+                             const GeglRectangle *area,
+                             GeglRectangle       *rect)
+{
+  GeglRectangle bounding_box;
+
+  bounding_box = gimp_projectable_get_bounding_box (proj->priv->projectable);
+
+  if (! gegl_rectangle_intersect (rect, area, &bounding_box))
+    return FALSE;
+
+  if (now)
+    {
+      /*  rendering right away doesn't go through invalidation  */
+      gimp_summed_area_table_invalidate (proj->priv->summed_area_table,
+                                         rect);
+
+      gimp_tile_handler_validate_validate (
+        proj->priv->validate_handler,
+        proj->priv->buffer,
+        rect,
+        FALSE, FALSE);
+    }
+  else
+    {
+      gimp_tile_handler_validate_invalidate (
+        proj->priv->validate_handler,
+        rect);
+    }
+
+  return TRUE;
 }
 
 static void
@@ -872,30 +1653,13 @@ gimp_projection_paint_area (GimpProjection *proj,
                             gint            h)
 {
   gint          off_x, off_y;
-  GeglRectangle bounding_box;
   GeglRectangle rect;
 
   gimp_projectable_get_offset (proj->priv->projectable, &off_x, &off_y);
-  bounding_box = gimp_projectable_get_bounding_box (proj->priv->projectable);
 
-  if (gegl_rectangle_intersect (&rect,
-                                GEGL_RECTANGLE (x, y, w, h), &bounding_box))
+  if (gimp_projection_render_area (proj, now,
+                                   GEGL_RECTANGLE (x, y, w, h), &rect))
     {
-      if (now)
-        {
-          gimp_tile_handler_validate_validate (
-            proj->priv->validate_handler,
-            proj->priv->buffer,
-            &rect,
-            FALSE, FALSE);
-        }
-      else
-        {
-          gimp_tile_handler_validate_invalidate (
-            proj->priv->validate_handler,
-            &rect);
-        }
-
       /*  add the projectable's offsets because the list of update areas
        *  is in tile-pyramid coordinates, but our external API is always
        *  in terms of image coordinates.
@@ -912,6 +1676,14 @@ gimp_projection_paint_area (GimpProjection *proj,
 
 /*  image callbacks  */
 
+static void
+gimp_projection_buffer_invalidated (GimpTileHandlerValidate *validate,
+                                    const GeglRectangle     *rect,
+                                    GimpProjection          *proj)
+{
+  gimp_summed_area_table_invalidate (proj->priv->summed_area_table, rect);
+}
+
 static void
 gimp_projection_projectable_invalidate (GimpProjectable *projectable,
                                         gint             x,
@@ -56,6 +56,67 @@ struct _GimpScanConvert
   GArray         *path_data;
 };
 
+typedef struct
+{
+  gdouble         x0;
+  gdouble         y0;
+  gdouble         y1;
+  gdouble         dxdy;
+
+  gdouble         x;   /* x at the current sample */
+} Edge;
+
+
+/* the number of vertical samples per row, when antialiasing.  spans are
+ * covered exactly horizontally.
+ */
+#define N_SAMPLES 16
+
+/* the maximal distance of flattened curves from the actual curves */
+#define TOLERANCE 0.1
+
+
+/*  local function prototypes  */
+
+static gboolean   gimp_scan_convert_get_bounds (GimpScanConvert     *sc,
+                                                gint                 off_x,
+                                                gint                 off_y,
+                                                GeglRectangle       *bounds);
+static void       gimp_scan_convert_add_edge   (GArray              *edges,
+                                                gdouble              x0,
+                                                gdouble              y0,
+                                                gdouble              x1,
+                                                gdouble              y1);
+static GArray   * gimp_scan_convert_get_edges  (GimpScanConvert     *sc,
+                                                gint                 off_x,
+                                                gint                 off_y);
+static gint       gimp_scan_convert_edge_compare
+                                               (const Edge          *edge1,
+                                                const Edge          *edge2);
+static void       gimp_scan_convert_add_spans  (Edge               **active,
+                                                gint                 n_active,
+                                                const GeglRectangle *bounds,
+                                                gboolean             antialias,
+                                                gfloat              *cover,
+                                                gfloat              *delta);
+static void       gimp_scan_convert_fill       (GimpScanConvert     *sc,
+                                                GeglBuffer          *buffer,
+                                                const GeglRectangle *bounds,
+                                                gint                 off_x,
+                                                gint                 off_y,
+                                                gboolean             replace,
+                                                gboolean             antialias,
+                                                gdouble              value);
+static void       gimp_scan_convert_stroke_cairo
+                                               (GimpScanConvert     *sc,
+                                                GeglBuffer          *buffer,
+                                                const GeglRectangle *bounds,
+                                                gint                 off_x,
+                                                gint                 off_y,
+                                                gboolean             replace,
+                                                gboolean             antialias,
+                                                gdouble              value);
+
 
 /*  public functions  */
 
@@ -205,13 +266,21 @@ gimp_scan_convert_add_polyline (GimpScanConvert   *sc,
                                 gboolean           closed)
 {
   GimpVector2        prev = { 0.0, 0.0, };
-  cairo_path_data_t  pd;
+  cairo_path_data_t *pd;
+  guint              len;
   gint               i;
 
   g_return_if_fail (sc != NULL);
   g_return_if_fail (points != NULL);
   g_return_if_fail (n_points > 0);
 
+  /* grow the path once, for the worst case, rather than per point */
+  len = sc->path_data->len;
+
+  g_array_set_size (sc->path_data, len + 2 * n_points + 1);
+
+  pd = &g_array_index (sc->path_data, cairo_path_data_t, len);
+
   for (i = 0; i < n_points; i++)
     {
       /* compress multiple identical coordinates */
@@ -219,13 +288,13 @@ gimp_scan_convert_add_polyline (GimpScanConvert   *sc,
           prev.x != points[i].x ||
           prev.y != points[i].y)
         {
-          pd.header.type = (i == 0) ? CAIRO_PATH_MOVE_TO : CAIRO_PATH_LINE_TO;
-          pd.header.length = 2;
-          sc->path_data = g_array_append_val (sc->path_data, pd);
+          pd->header.type = (i == 0) ? CAIRO_PATH_MOVE_TO : CAIRO_PATH_LINE_TO;
+          pd->header.length = 2;
+          pd++;
 
-          pd.point.x = points[i].x;
-          pd.point.y = points[i].y;
-          sc->path_data = g_array_append_val (sc->path_data, pd);
+          pd->point.x = points[i].x;
+          pd->point.y = points[i].y;
+          pd++;
           prev = points[i];
         }
     }
@@ -233,10 +302,13 @@ gimp_scan_convert_add_polyline (GimpScanConvert   *sc,
   /* close the polyline when needed */
   if (closed)
     {
-      pd.header.type = CAIRO_PATH_CLOSE_PATH;
-      pd.header.length = 1;
-      sc->path_data = g_array_append_val (sc->path_data, pd);
+      pd->header.type = CAIRO_PATH_CLOSE_PATH;
+      pd->header.length = 1;
+      pd++;
     }
+
+  g_array_set_size (sc->path_data,
+                    pd - (cairo_path_data_t *) sc->path_data->data);
 }
 
 /**
@@ -495,6 +567,455 @@ gimp_scan_convert_render_full (GimpScanConvert *sc,
                                gboolean         replace,
                                gboolean         antialias,
                                gdouble          value)
+{
+  GeglRectangle region;
+  GeglRectangle bounds;
+
+  g_return_if_fail (sc != NULL);
+  g_return_if_fail (GEGL_IS_BUFFER (buffer));
+
+  region = *gegl_buffer_get_extent (buffer);
+
+  if (sc->clip && ! gimp_rectangle_intersect (region.x, region.y,
+                                              region.width, region.height,
+                                              sc->clip_x, sc->clip_y,
+                                              sc->clip_w, sc->clip_h,
+                                              &region.x, &region.y,
+                                              &region.width, &region.height))
+    return;
+
+  /*  only the tiles the shape can reach are rendered to, the rest of the
+   *  region being cleared as a whole, if at all
+   */
+  if (replace)
+    gegl_buffer_clear (buffer, &region);
+
+  if (! gimp_scan_convert_get_bounds (sc, off_x, off_y, &bounds) ||
+      ! gegl_rectangle_intersect (&bounds, &bounds, &region))
+    return;
+
+  if (sc->do_stroke)
+    {
+      gimp_scan_convert_stroke_cairo (sc, buffer, &bounds, off_x, off_y,
+                                      replace, antialias, value);
+    }
+  else
+    {
+      gimp_scan_convert_fill (sc, buffer, &bounds, off_x, off_y,
+                              replace, antialias, value);
+    }
+}
+
+
+/*  private functions  */
+
+/* computes the bounds of the rendered shape in @buffer coordinates,
+ * using the control points of the path, which contain its curves
+ */
+static gboolean
+gimp_scan_convert_get_bounds (GimpScanConvert *sc,
+                              gint             off_x,
+                              gint             off_y,
+                              GeglRectangle   *bounds)
+{
+  cairo_path_data_t *data = (cairo_path_data_t *) sc->path_data->data;
+  gdouble            x1   = G_MAXDOUBLE;
+  gdouble            y1   = G_MAXDOUBLE;
+  gdouble            x2   = -G_MAXDOUBLE;
+  gdouble            y2   = -G_MAXDOUBLE;
+  gint               i;
+
+  for (i = 0; i < sc->path_data->len; i += data[i].header.length)
+    {
+      gint j;
+
+      for (j = 1; j < data[i].header.length; j++)
+        {
+          x1 = MIN (x1, data[i + j].point.x);
+          y1 = MIN (y1, data[i + j].point.y);
+          x2 = MAX (x2, data[i + j].point.x);
+          y2 = MAX (y2, data[i + j].point.y);
+        }
+    }
+
+  if (x1 > x2)
+    return FALSE;
+
+  if (sc->do_stroke)
+    {
+      /*  miter joins and square caps reach the farthest from the path; the
+       *  pen is scaled vertically by the pixel ratio
+       */
+      gdouble extent = sc->width / 2.0 * MAX (sc->miter, G_SQRT2);
+
+      x1 -= extent;
+      x2 += extent;
+      y1 -= extent * sc->ratio_xy;
+      y2 += extent * sc->ratio_xy;
+    }
+
+  /*  leave a pixel for the antialiasing  */
+  x1 = floor (x1 - off_x) - 1;
+  y1 = floor (y1 - off_y) - 1;
+  x2 = ceil  (x2 - off_x) + 1;
+  y2 = ceil  (y2 - off_y) + 1;
+
+  x1 = CLAMP (x1, G_MININT / 2, G_MAXINT / 2);
+  y1 = CLAMP (y1, G_MININT / 2, G_MAXINT / 2);
+  x2 = CLAMP (x2, G_MININT / 2, G_MAXINT / 2);
+  y2 = CLAMP (y2, G_MININT / 2, G_MAXINT / 2);
+
+  gegl_rectangle_set (bounds, x1, y1, x2 - x1, y2 - y1);
+
+  return TRUE;
+}
+
+static void
+gimp_scan_convert_add_edge (GArray  *edges,
+                            gdouble  x0,
+                            gdouble  y0,
+                            gdouble  x1,
+                            gdouble  y1)
+{
+  Edge edge;
+
+  /*  horizontal edges don't cross any sample  */
+  if (y0 == y1)
+    return;
+
+  if (y0 > y1)
+    {
+      gdouble tmp;
+
+      tmp = x0; x0 = x1; x1 = tmp;
+      tmp = y0; y0 = y1; y1 = tmp;
+    }
+
+  edge.x0   = x0;
+  edge.y0   = y0;
+  edge.y1   = y1;
+  edge.dxdy = (x1 - x0) / (y1 - y0);
+  edge.x    = x0;
+
+  g_array_append_val (edges, edge);
+}
+
+/* flattens the path into a list of edges, in @buffer coordinates, sorted
+ * by their top.  all subpaths are implicitly closed, as when filling.
+ */
+static GArray *
+gimp_scan_convert_get_edges (GimpScanConvert *sc,
+                             gint             off_x,
+                             gint             off_y)
+{
+  cairo_path_data_t *data  = (cairo_path_data_t *) sc->path_data->data;
+  GArray            *edges = g_array_new (FALSE, FALSE, sizeof (Edge));
+  GimpVector2        start = { 0.0, 0.0, };
+  GimpVector2        cur   = { 0.0, 0.0, };
+  gint               i;
+
+  for (i = 0; i < sc->path_data->len; i += data[i].header.length)
+    {
+      switch (data[i].header.type)
+        {
+        case CAIRO_PATH_MOVE_TO:
+          gimp_scan_convert_add_edge (edges, cur.x, cur.y, start.x, start.y);
+
+          start.x = cur.x = data[i + 1].point.x - off_x;
+          start.y = cur.y = data[i + 1].point.y - off_y;
+          break;
+
+        case CAIRO_PATH_LINE_TO:
+          {
+            GimpVector2 p = { data[i + 1].point.x - off_x,
+                              data[i + 1].point.y - off_y };
+
+            gimp_scan_convert_add_edge (edges, cur.x, cur.y, p.x, p.y);
+
+            cur = p;
+          }
+          break;
+
+        case CAIRO_PATH_CURVE_TO:
+          {
+            GimpVector2 p1 = { data[i + 1].point.x - off_x,
+                               data[i + 1].point.y - off_y };
+            GimpVector2 p2 = { data[i + 2].point.x - off_x,
+                               data[i + 2].point.y - off_y };
+            GimpVector2 p3 = { data[i + 3].point.x - off_x,
+                               data[i + 3].point.y - off_y };
+            GimpVector2 p0 = cur;
+            gdouble     dd;
+            gint        n;
+            gint        j;
+
+            /*  uniform subdivision, into enough segments to stay within
+             *  the tolerance, given the curve's second differences
+             */
+            dd = MAX (hypot (p0.x - 2.0 * p1.x + p2.x,
+                             p0.y - 2.0 * p1.y + p2.y),
+                      hypot (p1.x - 2.0 * p2.x + p3.x,
+                             p1.y - 2.0 * p2.y + p3.y));
+
+            n = CLAMP ((gint) ceil (sqrt (0.75 * dd / TOLERANCE)), 1, 1024);
+
+            for (j = 1; j <= n; j++)
+              {
+                gdouble     t  = (gdouble) j / n;
+                gdouble     u  = 1.0 - t;
+                GimpVector2 p;
+
+                p.x = u * u * u * p0.x + 3.0 * u * u * t * p1.x +
+                      3.0 * u * t * t * p2.x + t * t * t * p3.x;
+                p.y = u * u * u * p0.y + 3.0 * u * u * t * p1.y +
+                      3.0 * u * t * t * p2.y + t * t * t * p3.y;
+
+                gimp_scan_convert_add_edge (edges, cur.x, cur.y, p.x, p.y);
+
+                cur = p;
+              }
+          }
+          break;
+
+        case CAIRO_PATH_CLOSE_PATH:
+          gimp_scan_convert_add_edge (edges, cur.x, cur.y, start.x, start.y);
+
+          cur = start;
+          break;
+        }
+    }
+
+  gimp_scan_convert_add_edge (edges, cur.x, cur.y, start.x, start.y);
+
+  g_array_sort (edges, (GCompareFunc) gimp_scan_convert_edge_compare);
+
+  return edges;
+}
+
+static gint
+gimp_scan_convert_edge_compare (const Edge *edge1,
+                                const Edge *edge2)
+{
+  return (edge1->y0 > edge2->y0) - (edge1->y0 < edge2->y0);
+}
+
+/* adds the coverage of the even-odd spans between the @active edges, which
+ * are sorted by their x at the current sample, to the row of @bounds.  pixels
+ * fully inside a span are accumulated in @delta, as differences along the
+ * row, and the partially covered pixels at its ends in @cover.
+ */
+static void
+gimp_scan_convert_add_spans (Edge                **active,
+                             gint                  n_active,
+                             const GeglRectangle  *bounds,
+                             gboolean              antialias,
+                             gfloat               *cover,
+                             gfloat               *delta)
+{
+  const gfloat weight = antialias ? 1.0f / N_SAMPLES : 1.0f;
+  gint         i;
+
+  for (i = 0; i + 1 < n_active; i += 2)
+    {
+      gdouble xa = CLAMP (active[i]->x     - bounds->x, 0.0, bounds->width);
+      gdouble xb = CLAMP (active[i + 1]->x - bounds->x, 0.0, bounds->width);
+
+      if (xb <= xa)
+        continue;
+
+      if (antialias)
+        {
+          gint ia = floor (xa);
+          gint ib = floor (xb);
+
+          if (ia == ib)
+            {
+              cover[ia] += (xb - xa) * weight;
+            }
+          else
+            {
+              cover[ia]     += (ia + 1 - xa) * weight;
+              delta[ia + 1] += weight;
+              delta[ib]     -= weight;
+              cover[ib]     += (xb - ib) * weight;
+            }
+        }
+      else
+        {
+          /*  pixels are covered if their center is  */
+          gint ia = ceil (xa - 0.5);
+          gint ib = ceil (xb - 0.5);
+
+          delta[ia] += weight;
+          delta[ib] -= weight;
+        }
+    }
+}
+
+/* scan converts the filled path, one band of rows at a time, each as high
+ * as the @buffer's tiles, writing only the bands the path covers
+ */
+static void
+gimp_scan_convert_fill (GimpScanConvert     *sc,
+                        GeglBuffer          *buffer,
+                        const GeglRectangle *bounds,
+                        gint                 off_x,
+                        gint                 off_y,
+                        gboolean             replace,
+                        gboolean             antialias,
+                        gdouble              value)
+{
+  const Babl  *format   = babl_format ("Y float");
+  GArray      *edges;
+  Edge       **active;
+  gint         n_active = 0;
+  gint         next     = 0;
+  gfloat      *band;
+  gfloat      *cover;
+  gfloat      *delta;
+  gint         n_samples;
+  gint         tile_height;
+  gint         y;
+
+  edges = gimp_scan_convert_get_edges (sc, off_x, off_y);
+
+  if (edges->len == 0)
+    {
+      g_array_free (edges, TRUE);
+
+      return;
+    }
+
+  g_object_get (buffer,
+                "tile-height", &tile_height,
+                NULL);
+
+  n_samples = antialias ? N_SAMPLES : 1;
+
+  active = g_new (Edge *, edges->len);
+  band   = g_new (gfloat, (gsize) bounds->width * tile_height);
+  cover  = g_new0 (gfloat, bounds->width + 2);
+  delta  = g_new0 (gfloat, bounds->width + 2);
+
+  for (y = bounds->y; y < bounds->y + bounds->height; )
+    {
+      GeglRectangle  rect;
+      gboolean       empty = TRUE;
+      gfloat        *row;
+      gint           i;
+
+      /*  align the bands to the tile grid  */
+      rect.x      = bounds->x;
+      rect.y      = y;
+      rect.width  = bounds->width;
+      rect.height = tile_height - ((y % tile_height) + tile_height) %
+                                  tile_height;
+      rect.height = MIN (rect.height, bounds->y + bounds->height - y);
+
+      if (replace)
+        memset (band, 0, (gsize) rect.width * rect.height * sizeof (gfloat));
+      else
+        gegl_buffer_get (buffer, &rect, 1.0, format, band,
+                         GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+      for (row = band; y < rect.y + rect.height; y++, row += rect.width)
+        {
+          gfloat sum;
+          gint   k;
+
+          if (n_active == 0 &&
+              (next == edges->len ||
+               g_array_index (edges, Edge, next).y0 >= y + 1))
+            {
+              continue;
+            }
+
+          for (k = 0; k < n_samples; k++)
+            {
+              gdouble sy = y + (k + 0.5) / n_samples;
+              gint    j;
+
+              /*  retire the edges ending above the sample...  */
+              for (i = 0, j = 0; i < n_active; i++)
+                {
+                  if (active[i]->y1 > sy)
+                    active[j++] = active[i];
+                }
+
+              n_active = j;
+
+              /*  ...add the ones starting above it...  */
+              while (next < edges->len &&
+                     g_array_index (edges, Edge, next).y0 <= sy)
+                {
+                  Edge *edge = &g_array_index (edges, Edge, next++);
+
+                  if (edge->y1 > sy)
+                    active[n_active++] = edge;
+                }
+
+              /*  ...and keep them sorted by x.  the order rarely changes
+               *  between samples, so insertion sort is close to linear.
+               */
+              for (i = 0; i < n_active; i++)
+                {
+                  Edge *edge = active[i];
+
+                  edge->x = edge->x0 + (sy - edge->y0) * edge->dxdy;
+
+                  for (j = i; j > 0 && active[j - 1]->x > edge->x; j--)
+                    active[j] = active[j - 1];
+
+                  active[j] = edge;
+                }
+
+              gimp_scan_convert_add_spans (active, n_active, bounds,
+                                           antialias, cover, delta);
+            }
+
+          for (i = 0, sum = 0.0f; i < rect.width; i++)
+            {
+              gfloat coverage;
+
+              sum      += delta[i];
+              coverage  = CLAMP (cover[i] + sum, 0.0f, 1.0f);
+
+              if (coverage > 0.0f)
+                {
+                  row[i] += coverage * (value - row[i]);
+
+                  empty = FALSE;
+                }
+            }
+
+          memset (cover, 0, (bounds->width + 2) * sizeof (gfloat));
+          memset (delta, 0, (bounds->width + 2) * sizeof (gfloat));
+        }
+
+      if (! empty)
+        {
+          gegl_buffer_set (buffer, &rect, 0, format, band,
+                           GEGL_AUTO_ROWSTRIDE);
+        }
+    }
+
+  g_free (delta);
+  g_free (cover);
+  g_free (band);
+  g_free (active);
+
+  g_array_free (edges, TRUE);
+}
+
+static void
+gimp_scan_convert_stroke_cairo (GimpScanConvert     *sc,
+                                GeglBuffer          *buffer,
+                                const GeglRectangle *bounds,
+                                gint                 off_x,
+                                gint                 off_y,
+                                gboolean             replace,
+                                gboolean             antialias,
+                                gdouble              value)
 {
   const Babl         *format;
   guchar             *shared_buf      = NULL;
@@ -505,22 +1026,6 @@ gimp_scan_convert_render_full (GimpScanConvert *sc,
   cairo_surface_t    *surface;
   cairo_path_t        path;
   gint                bpp;
-  gint                x, y;
-  gint                width, height;
-
-  g_return_if_fail (sc != NULL);
-  g_return_if_fail (GEGL_IS_BUFFER (buffer));
-
-  x      = gegl_buffer_get_x      (buffer);
-  y      = gegl_buffer_get_y      (buffer);
-  width  = gegl_buffer_get_width  (buffer);
-  height = gegl_buffer_get_height (buffer);
-
-  if (sc->clip && ! gimp_rectangle_intersect (x, y, width, height,
-                                              sc->clip_x, sc->clip_y,
-                                              sc->clip_w, sc->clip_h,
-                                              &x, &y, &width, &height))
-    return;
 
   path.status   = CAIRO_STATUS_SUCCESS;
   path.data     = (cairo_path_data_t *) sc->path_data->data;
@@ -529,7 +1034,7 @@ gimp_scan_convert_render_full (GimpScanConvert *sc,
   format = babl_format ("Y u8");
   bpp    = babl_format_get_bytes_per_pixel (format);
 
-  iter = gegl_buffer_iterator_new (buffer, NULL, 0, format,
+  iter = gegl_buffer_iterator_new (buffer, bounds, 0, format,
                                    GEGL_ACCESS_READWRITE, GEGL_ABYSS_NONE, 1);
   roi = &iter->items[0].roi;
 
@@ -596,33 +1101,25 @@ gimp_scan_convert_render_full (GimpScanConvert *sc,
                            CAIRO_ANTIALIAS_GRAY : CAIRO_ANTIALIAS_NONE);
       cairo_set_miter_limit (cr, sc->miter);
 
-      if (sc->do_stroke)
-        {
-          cairo_set_line_cap (cr,
-                              sc->cap == GIMP_CAP_BUTT ? CAIRO_LINE_CAP_BUTT :
-                              sc->cap == GIMP_CAP_ROUND ? CAIRO_LINE_CAP_ROUND :
-                              CAIRO_LINE_CAP_SQUARE);
-          cairo_set_line_join (cr,
-                               sc->join == GIMP_JOIN_MITER ? CAIRO_LINE_JOIN_MITER :
-                               sc->join == GIMP_JOIN_ROUND ? CAIRO_LINE_JOIN_ROUND :
-                               CAIRO_LINE_JOIN_BEVEL);
-
-          cairo_set_line_width (cr, sc->width);
-
-          if (sc->dash_info)
-            cairo_set_dash (cr,
-                            (double *) sc->dash_info->data,
-                            sc->dash_info->len,
-                            sc->dash_offset);
-
-          cairo_scale (cr, 1.0, sc->ratio_xy);
-          cairo_stroke (cr);
-        }
-      else
-        {
-          cairo_set_fill_rule (cr, CAIRO_FILL_RULE_EVEN_ODD);
-          cairo_fill (cr);
-        }
+      cairo_set_line_cap (cr,
+                          sc->cap == GIMP_CAP_BUTT ? CAIRO_LINE_CAP_BUTT :
+                          sc->cap == GIMP_CAP_ROUND ? CAIRO_LINE_CAP_ROUND :
+                          CAIRO_LINE_CAP_SQUARE);
+      cairo_set_line_join (cr,
+                           sc->join == GIMP_JOIN_MITER ? CAIRO_LINE_JOIN_MITER :
+                           sc->join == GIMP_JOIN_ROUND ? CAIRO_LINE_JOIN_ROUND :
+                           CAIRO_LINE_JOIN_BEVEL);
+
+      cairo_set_line_width (cr, sc->width);
+
+      if (sc->dash_info)
+        cairo_set_dash (cr,
+                        (double *) sc->dash_info->data,
+                        sc->dash_info->len,
+                        sc->dash_offset);
+
+      cairo_scale (cr, 1.0, sc->ratio_xy);
+      cairo_stroke (cr);
 
       cairo_destroy (cr);
       cairo_surface_destroy (surface);
@@ -28,6 +28,7 @@
 #include "gegl/gimp-babl.h"
 #include "gegl/gimp-gegl-apply-operation.h"
 #include "gegl/gimp-gegl-loops.h"
+#include "gegl/gimp-gegl-utils.h"
 
 #include "gimp.h"
 #include "gimpcontext.h"
@@ -668,6 +669,7 @@ gimp_selection_extract (GimpSelection *selection,
                         gboolean       cut_image,
                         gboolean       keep_indexed,
                         gboolean       add_alpha,
+                        guint64        swap_threshold,
                         gint          *offset_x,
                         gint          *offset_y,
                         GError       **error)
@@ -676,7 +678,7 @@ gimp_selection_extract (GimpSelection *selection,
   GimpImage    *temp_image = NULL;
   GimpPickable *pickable   = NULL;
   GeglBuffer   *src_buffer;
-  GeglBuffer   *dest_buffer;
+  GeglBuffer   *dest_buffer = NULL;
   GList        *iter;
   const Babl   *src_format;
   const Babl   *dest_format;
@@ -788,9 +790,21 @@ gimp_selection_extract (GimpSelection *selection,
 
   src_buffer = gimp_pickable_get_buffer (pickable);
 
-  /*  Allocate the temp buffer  */
-  dest_buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0, x2 - x1, y2 - y1),
-                                 dest_format);
+  /*  Allocate the temp buffer, huge ones directly in the swap, so that
+   *  their pixels don't need to fit in memory next to the source's
+   */
+  if (swap_threshold > 0 &&
+      (guint64) (x2 - x1) * (y2 - y1) *
+      babl_format_get_bytes_per_pixel (dest_format) > swap_threshold)
+    {
+      dest_buffer =
+        gimp_gegl_buffer_new_swapped (GEGL_RECTANGLE (0, 0, x2 - x1, y2 - y1),
+                                      dest_format);
+    }
+
+  if (! dest_buffer)
+    dest_buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0, x2 - x1, y2 - y1),
+                                   dest_format);
 
   /*  First, copy the pixels, possibly doing INDEXED->RGB and adding alpha  */
   gimp_gegl_buffer_copy (src_buffer,  GEGL_RECTANGLE (x1, y1, x2 - x1, y2 - y1),
@@ -905,7 +919,7 @@ gimp_selection_float (GimpSelection *selection,
 
   /*  Cut or copy the selected region  */
   buffer = gimp_selection_extract (selection, drawables, context,
-                                   cut_image, FALSE, TRUE,
+                                   cut_image, FALSE, TRUE, 0,
                                    &x1, &y1, NULL);
 
   profile = gimp_color_managed_get_color_profile (GIMP_COLOR_MANAGED (drawables->data));
@@ -58,6 +58,7 @@ GeglBuffer  * gimp_selection_extract  (GimpSelection *selection,
                                        gboolean       cut_image,
                                        gboolean       keep_indexed,
                                        gboolean       add_alpha,
+                                       guint64        swap_threshold,
                                        gint          *offset_x,
                                        gint          *offset_y,
                                        GError       **error);
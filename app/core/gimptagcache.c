@@ -18,8 +18,17 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+/* the tags are saved to tags.xml, and to a binary copy of it written next
+ * to it, tags.xml.cache.  the copy is a GVariant which is used directly
+ * from the mapped file, and is only used if it remembers the size and
+ * mtime of the tags.xml it was written with, so tags.xml stays the
+ * reference.
+ */
+
 #include "config.h"
 
+#include <string.h>
+
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gegl.h>
 
@@ -42,7 +51,16 @@
 #include "gimp-intl.h"
 
 
-#define GIMP_TAG_CACHE_FILE  "tags.xml"
+#define GIMP_TAG_CACHE_FILE          "tags.xml"
+#define GIMP_TAG_CACHE_BINARY_FILE   "tags.xml.cache"
+
+#define GIMP_TAG_CACHE_BINARY_MAGIC   "GIMP tags cache"
+#define GIMP_TAG_CACHE_BINARY_VERSION 1
+
+/*  (magic, file version, tags.xml mtime, tags.xml size,
+ *   [(identifier, checksum, [tag])])
+ */
+#define GIMP_TAG_CACHE_BINARY_TYPE    "(suxta(ssas))"
 
 /* #define DEBUG_GIMP_TAG_CACHE  1 */
 
@@ -68,10 +86,20 @@ typedef struct
   GimpTagCacheRecord  current_record;
 } GimpTagCacheParseData;
 
+typedef struct
+{
+  GList      *records;
+  GHashTable *checksums;
+} GimpTagCacheSaveData;
+
 struct _GimpTagCachePrivate
 {
-  GArray *records;
-  GList  *containers;
+  GArray     *records;
+  GList      *containers;
+
+  /*  quark => record index + 1  */
+  GHashTable *identifiers;
+  GHashTable *checksums;
 };
 
 
@@ -83,6 +111,17 @@ static void          gimp_tag_cache_object_initialize  (GimpTagged             *
                                                         GimpTagCache           *cache);
 static void          gimp_tag_cache_add_object         (GimpTagCache           *cache,
                                                         GimpTagged             *tagged);
+static void          gimp_tag_cache_clear_records      (GimpTagCache           *cache);
+static void          gimp_tag_cache_index_records      (GimpTagCache           *cache);
+
+static gboolean      gimp_tag_cache_load_binary        (GimpTagCache           *cache,
+                                                        GFile                  *file,
+                                                        GFile                  *xml_file,
+                                                        GError                **error);
+static gboolean      gimp_tag_cache_save_binary        (GList                  *records,
+                                                        GFile                  *file,
+                                                        GFile                  *xml_file,
+                                                        GError                **error);
 
 static void          gimp_tag_cache_load_start_element (GMarkupParseContext    *context,
                                                         const gchar            *element_name,
@@ -131,9 +170,11 @@ gimp_tag_cache_init (GimpTagCache *cache)
 {
   cache->priv = gimp_tag_cache_get_instance_private (cache);
 
-  cache->priv->records    = g_array_new (FALSE, FALSE,
-                                         sizeof (GimpTagCacheRecord));
-  cache->priv->containers = NULL;
+  cache->priv->records     = g_array_new (FALSE, FALSE,
+                                          sizeof (GimpTagCacheRecord));
+  cache->priv->containers  = NULL;
+  cache->priv->identifiers = g_hash_table_new (NULL, NULL);
+  cache->priv->checksums   = g_hash_table_new (NULL, NULL);
 }
 
 static void
@@ -143,20 +184,15 @@ gimp_tag_cache_finalize (GObject *object)
 
   if (cache->priv->records)
     {
-      gint i;
-
-      for (i = 0; i < cache->priv->records->len; i++)
-        {
-          GimpTagCacheRecord *rec = &g_array_index (cache->priv->records,
-                                                    GimpTagCacheRecord, i);
-
-          g_list_free_full (rec->tags, (GDestroyNotify) g_object_unref);
-        }
+      gimp_tag_cache_clear_records (cache);
 
       g_array_free (cache->priv->records, TRUE);
       cache->priv->records = NULL;
     }
 
+  g_clear_pointer (&cache->priv->identifiers, g_hash_table_unref);
+  g_clear_pointer (&cache->priv->checksums,   g_hash_table_unref);
+
   if (cache->priv->containers)
     {
       g_list_free (cache->priv->containers);
@@ -175,6 +211,8 @@ gimp_tag_cache_get_memsize (GimpObject *object,
 
   memsize += gimp_g_list_get_memsize (cache->priv->containers, 0);
   memsize += cache->priv->records->len * sizeof (GimpTagCacheRecord);
+  memsize += gimp_g_hash_table_get_memsize (cache->priv->identifiers, 0);
+  memsize += gimp_g_hash_table_get_memsize (cache->priv->checksums, 0);
 
   return memsize + GIMP_OBJECT_CLASS (parent_class)->get_memsize (object,
                                                                   gui_size);
@@ -233,7 +271,7 @@ gimp_tag_cache_add_object (GimpTagCache *cache,
   gchar  *checksum;
   GQuark  checksum_quark = 0;
   GList  *list;
-  gint    i;
+  guint   index;
 
   identifier = gimp_tagged_get_identifier (tagged);
 
@@ -245,21 +283,22 @@ gimp_tag_cache_add_object (GimpTagCache *cache,
 
   if (identifier_quark)
     {
-      for (i = 0; i < cache->priv->records->len; i++)
+      index = GPOINTER_TO_UINT (g_hash_table_lookup (cache->priv->identifiers,
+                                                     GUINT_TO_POINTER (identifier_quark)));
+
+      if (index)
         {
           GimpTagCacheRecord *rec = &g_array_index (cache->priv->records,
-                                                    GimpTagCacheRecord, i);
+                                                    GimpTagCacheRecord,
+                                                    index - 1);
 
-          if (rec->identifier == identifier_quark)
+          for (list = rec->tags; list; list = g_list_next (list))
             {
-              for (list = rec->tags; list; list = g_list_next (list))
-                {
-                  gimp_tagged_add_tag (tagged, GIMP_TAG (list->data));
-                }
-
-              rec->referenced = TRUE;
-              return;
+              gimp_tagged_add_tag (tagged, GIMP_TAG (list->data));
             }
+
+          rec->referenced = TRUE;
+          return;
         }
     }
 
@@ -273,32 +312,98 @@ gimp_tag_cache_add_object (GimpTagCache *cache,
 
   if (checksum_quark)
     {
-      for (i = 0; i < cache->priv->records->len; i++)
+      index = GPOINTER_TO_UINT (g_hash_table_lookup (cache->priv->checksums,
+                                                     GUINT_TO_POINTER (checksum_quark)));
+
+      if (index)
         {
           GimpTagCacheRecord *rec = &g_array_index (cache->priv->records,
-                                                    GimpTagCacheRecord, i);
+                                                    GimpTagCacheRecord,
+                                                    index - 1);
 
-          if (rec->checksum == checksum_quark)
-            {
 #if DEBUG_GIMP_TAG_CACHE
-              g_printerr ("remapping identifier: %s ==> %s\n",
-                          rec->identifier ? g_quark_to_string (rec->identifier) : "(NULL)",
-                          identifier_quark ? g_quark_to_string (identifier_quark) : "(NULL)");
+          g_printerr ("remapping identifier: %s ==> %s\n",
+                      rec->identifier ? g_quark_to_string (rec->identifier) : "(NULL)",
+                      identifier_quark ? g_quark_to_string (identifier_quark) : "(NULL)");
 #endif
 
-              rec->identifier = identifier_quark;
+          if (GPOINTER_TO_UINT (g_hash_table_lookup (cache->priv->identifiers,
+                                                     GUINT_TO_POINTER (rec->identifier))) == index)
+            {
+              g_hash_table_remove (cache->priv->identifiers,
+                                   GUINT_TO_POINTER (rec->identifier));
+            }
 
-              for (list = rec->tags; list; list = g_list_next (list))
-                {
-                  gimp_tagged_add_tag (tagged, GIMP_TAG (list->data));
-                }
+          rec->identifier = identifier_quark;
 
-              rec->referenced = TRUE;
-              return;
+          if (identifier_quark)
+            g_hash_table_insert (cache->priv->identifiers,
+                                 GUINT_TO_POINTER (identifier_quark),
+                                 GUINT_TO_POINTER (index));
+
+          for (list = rec->tags; list; list = g_list_next (list))
+            {
+              gimp_tagged_add_tag (tagged, GIMP_TAG (list->data));
             }
+
+          rec->referenced = TRUE;
+          return;
         }
     }
+}
+
+static void
+gimp_tag_cache_clear_records (GimpTagCache *cache)
+{
+  gint i;
+
+  for (i = 0; i < cache->priv->records->len; i++)
+    {
+      GimpTagCacheRecord *rec = &g_array_index (cache->priv->records,
+                                                GimpTagCacheRecord, i);
+
+      g_list_free_full (rec->tags, (GDestroyNotify) g_object_unref);
+    }
+
+  cache->priv->records = g_array_set_size (cache->priv->records, 0);
+
+  g_hash_table_remove_all (cache->priv->identifiers);
+  g_hash_table_remove_all (cache->priv->checksums);
+}
+
+/*  maps the identifiers and checksums to the first record which has
+ *  them, as the linear search used to
+ */
+static void
+gimp_tag_cache_index_records (GimpTagCache *cache)
+{
+  gint i;
 
+  g_hash_table_remove_all (cache->priv->identifiers);
+  g_hash_table_remove_all (cache->priv->checksums);
+
+  for (i = 0; i < cache->priv->records->len; i++)
+    {
+      GimpTagCacheRecord *rec   = &g_array_index (cache->priv->records,
+                                                  GimpTagCacheRecord, i);
+      gpointer            index = GUINT_TO_POINTER (i + 1);
+
+      if (rec->identifier &&
+          ! g_hash_table_contains (cache->priv->identifiers,
+                                   GUINT_TO_POINTER (rec->identifier)))
+        {
+          g_hash_table_insert (cache->priv->identifiers,
+                               GUINT_TO_POINTER (rec->identifier), index);
+        }
+
+      if (rec->checksum &&
+          ! g_hash_table_contains (cache->priv->checksums,
+                                   GUINT_TO_POINTER (rec->checksum)))
+        {
+          g_hash_table_insert (cache->priv->checksums,
+                               GUINT_TO_POINTER (rec->checksum), index);
+        }
+    }
 }
 
 static void
@@ -309,25 +414,36 @@ gimp_tag_cache_object_initialize (GimpTagged   *tagged,
 }
 
 static void
-gimp_tag_cache_tagged_to_cache_record_foreach (GimpTagged  *tagged,
-                                               GList      **cache_records)
+gimp_tag_cache_tagged_to_cache_record_foreach (GimpTagged           *tagged,
+                                               GimpTagCacheSaveData *data)
 {
   gchar *identifier = gimp_tagged_get_identifier (tagged);
 
   if (identifier)
     {
       GimpTagCacheRecord *cache_rec = g_new (GimpTagCacheRecord, 1);
-      gchar              *checksum;
-
-      checksum = gimp_tagged_get_checksum (tagged);
 
       cache_rec->identifier = g_quark_from_string (identifier);
-      cache_rec->checksum   = g_quark_from_string (checksum);
-      cache_rec->tags       = g_list_copy (gimp_tagged_get_tags (tagged));
+      cache_rec->checksum   =
+        GPOINTER_TO_UINT (g_hash_table_lookup (data->checksums,
+                                               GUINT_TO_POINTER (cache_rec->identifier)));
+
+      /*  computing the checksum of a lazily loaded resource reads all
+       *  of its pixels, so keep the one of the record the object was
+       *  matched against, if any
+       */
+      if (! cache_rec->checksum)
+        {
+          gchar *checksum = gimp_tagged_get_checksum (tagged);
 
-      g_free (checksum);
+          cache_rec->checksum = g_quark_from_string (checksum);
+
+          g_free (checksum);
+        }
+
+      cache_rec->tags = g_list_copy (gimp_tagged_get_tags (tagged));
 
-      *cache_records = g_list_prepend (*cache_records, cache_rec);
+      data->records = g_list_prepend (data->records, cache_rec);
     }
 
   g_free (identifier);
@@ -342,22 +458,34 @@ gimp_tag_cache_tagged_to_cache_record_foreach (GimpTagged  *tagged,
 void
 gimp_tag_cache_save (GimpTagCache *cache)
 {
-  GString       *buf;
-  GList         *saved_records;
-  GList         *iterator;
-  GFile         *file;
-  GOutputStream *output;
-  GError        *error = NULL;
-  gint           i;
+  GimpTagCacheSaveData  data;
+  GString              *buf;
+  GList                *saved_records;
+  GList                *iterator;
+  GFile                *file;
+  GOutputStream        *output;
+  GError               *error = NULL;
+  gint                  i;
 
   g_return_if_fail (GIMP_IS_TAG_CACHE (cache));
 
+  data.checksums = g_hash_table_new (NULL, NULL);
+
   saved_records = NULL;
   for (i = 0; i < cache->priv->records->len; i++)
     {
       GimpTagCacheRecord *current_record = &g_array_index (cache->priv->records,
                                                            GimpTagCacheRecord, i);
 
+      if (current_record->referenced &&
+          current_record->identifier &&
+          current_record->checksum)
+        {
+          g_hash_table_insert (data.checksums,
+                               GUINT_TO_POINTER (current_record->identifier),
+                               GUINT_TO_POINTER (current_record->checksum));
+        }
+
       if (! current_record->referenced && current_record->tags)
         {
           /* keep tagged objects which have tags assigned
@@ -373,16 +501,20 @@ gimp_tag_cache_save (GimpTagCache *cache)
         }
     }
 
+  data.records = saved_records;
+
   for (iterator = cache->priv->containers;
        iterator;
        iterator = g_list_next (iterator))
     {
       gimp_container_foreach (GIMP_CONTAINER (iterator->data),
                               (GFunc) gimp_tag_cache_tagged_to_cache_record_foreach,
-                              &saved_records);
+                              &data);
     }
 
-  saved_records = g_list_reverse (saved_records);
+  g_hash_table_unref (data.checksums);
+
+  saved_records = g_list_reverse (data.records);
 
   buf = g_string_new ("");
   g_string_append (buf, "<?xml version='1.0' encoding='UTF-8'?>\n");
@@ -447,6 +579,23 @@ gimp_tag_cache_save (GimpTagCache *cache)
       g_printerr (_("Error closing '%s': %s\n"),
                   gimp_file_get_utf8_name (file), error->message);
     }
+  else
+    {
+      GFile *binary_file = gimp_directory_file (GIMP_TAG_CACHE_BINARY_FILE,
+                                                NULL);
+
+      if (! gimp_tag_cache_save_binary (saved_records, binary_file, file,
+                                        &error))
+        {
+          g_printerr (_("Error writing '%s': %s\n"),
+                      gimp_file_get_utf8_name (binary_file), error->message);
+
+          /*  don't leave a copy of an older tags.xml around  */
+          g_file_delete (binary_file, NULL, NULL);
+        }
+
+      g_object_unref (binary_file);
+    }
 
   if (output)
     g_object_unref (output);
@@ -478,6 +627,7 @@ void
 gimp_tag_cache_load (GimpTagCache *cache)
 {
   GFile                 *file;
+  GFile                 *binary_file;
   GMarkupParser          markup_parser;
   GimpXmlParser         *xml_parser;
   GimpTagCacheParseData  parse_data;
@@ -486,7 +636,26 @@ gimp_tag_cache_load (GimpTagCache *cache)
   g_return_if_fail (GIMP_IS_TAG_CACHE (cache));
 
   /* clear any previous priv->records */
-  cache->priv->records = g_array_set_size (cache->priv->records, 0);
+  gimp_tag_cache_clear_records (cache);
+
+  file        = gimp_directory_file (GIMP_TAG_CACHE_FILE, NULL);
+  binary_file = gimp_directory_file (GIMP_TAG_CACHE_BINARY_FILE, NULL);
+
+  if (gimp_tag_cache_load_binary (cache, binary_file, file, &error))
+    {
+      gimp_tag_cache_index_records (cache);
+
+      g_object_unref (binary_file);
+      g_object_unref (file);
+      return;
+    }
+
+#if DEBUG_GIMP_TAG_CACHE
+  g_printerr ("not using tag cache copy: %s\n", error->message);
+#endif
+
+  g_clear_error (&error);
+  g_object_unref (binary_file);
 
   parse_data.records = g_array_new (FALSE, FALSE, sizeof (GimpTagCacheRecord));
   memset (&parse_data.current_record, 0, sizeof (GimpTagCacheRecord));
@@ -499,8 +668,6 @@ gimp_tag_cache_load (GimpTagCache *cache)
 
   xml_parser = gimp_xml_parser_new (&markup_parser, &parse_data);
 
-  file = gimp_directory_file (GIMP_TAG_CACHE_FILE, NULL);
-
   if (gimp_xml_parser_parse_gfile (xml_parser, file, &error))
     {
       cache->priv->records = g_array_append_vals (cache->priv->records,
@@ -514,11 +681,221 @@ gimp_tag_cache_load (GimpTagCache *cache)
       g_clear_error (&error);
     }
 
+  gimp_tag_cache_index_records (cache);
+
   g_object_unref (file);
   gimp_xml_parser_free (xml_parser);
   g_array_free (parse_data.records, TRUE);
 }
 
+static gboolean
+gimp_tag_cache_load_binary (GimpTagCache  *cache,
+                            GFile         *file,
+                            GFile         *xml_file,
+                            GError       **error)
+{
+  GFileInfo   *info;
+  GMappedFile *mapped;
+  GBytes      *bytes;
+  GVariant    *variant;
+  GVariant    *records;
+  GHashTable  *tags;
+  gchar       *path;
+  const gchar *magic;
+  guint32      file_version;
+  gint64       xml_mtime;
+  guint64      xml_size;
+  gint64       cache_xml_mtime;
+  guint64      cache_xml_size;
+  gsize        n_records;
+  gsize        i;
+
+  info = g_file_query_info (xml_file,
+                            G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                            G_FILE_QUERY_INFO_NONE,
+                            NULL, error);
+  if (! info)
+    return FALSE;
+
+  xml_mtime = g_file_info_get_attribute_uint64 (info,
+                                                G_FILE_ATTRIBUTE_TIME_MODIFIED);
+  xml_size  = g_file_info_get_size (info);
+
+  g_object_unref (info);
+
+  path = g_file_get_path (file);
+
+  if (! path)
+    {
+      g_set_error (error, GIMP_CONFIG_ERROR, GIMP_CONFIG_ERROR_OPEN,
+                   _("Could not open '%s' for reading"),
+                   gimp_file_get_utf8_name (file));
+      return FALSE;
+    }
+
+  mapped = g_mapped_file_new (path, FALSE, error);
+  g_free (path);
+
+  if (! mapped)
+    return FALSE;
+
+  bytes = g_mapped_file_get_bytes (mapped);
+  g_mapped_file_unref (mapped);
+
+  /*  don't trust the data, GVariant then checks each access  */
+  variant = g_variant_new_from_bytes (G_VARIANT_TYPE (GIMP_TAG_CACHE_BINARY_TYPE),
+                                      bytes, FALSE);
+  g_variant_ref_sink (variant);
+  g_bytes_unref (bytes);
+
+  g_variant_get_child (variant, 0, "&s", &magic);
+  g_variant_get_child (variant, 1, "u",  &file_version);
+  g_variant_get_child (variant, 2, "x",  &cache_xml_mtime);
+  g_variant_get_child (variant, 3, "t",  &cache_xml_size);
+
+  if (strcmp (magic, GIMP_TAG_CACHE_BINARY_MAGIC)   ||
+      file_version    != GIMP_TAG_CACHE_BINARY_VERSION ||
+      cache_xml_mtime != xml_mtime                     ||
+      cache_xml_size  != xml_size)
+    {
+      g_set_error (error, GIMP_CONFIG_ERROR, GIMP_CONFIG_ERROR_VERSION,
+                   "Skipping '%s': it doesn't belong to '%s'",
+                   gimp_file_get_utf8_name (file),
+                   gimp_file_get_utf8_name (xml_file));
+      g_variant_unref (variant);
+      return FALSE;
+    }
+
+  /*  the records share the tag objects of equal names  */
+  tags = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                NULL, g_object_unref);
+
+  records   = g_variant_get_child_value (variant, 4);
+  n_records = g_variant_n_children (records);
+
+  cache->priv->records = g_array_set_size (cache->priv->records, n_records);
+
+  for (i = 0; i < n_records; i++)
+    {
+      GimpTagCacheRecord *rec = &g_array_index (cache->priv->records,
+                                                GimpTagCacheRecord, i);
+      GVariantIter       *iter;
+      const gchar        *identifier;
+      const gchar        *checksum;
+      const gchar        *name;
+
+      memset (rec, 0, sizeof (GimpTagCacheRecord));
+
+      g_variant_get_child (records, i, "(&s&sas)",
+                           &identifier, &checksum, &iter);
+
+      rec->identifier = g_quark_from_string (identifier);
+      rec->checksum   = *checksum ? g_quark_from_string (checksum) : 0;
+
+      while (g_variant_iter_next (iter, "&s", &name))
+        {
+          GimpTag *tag = g_hash_table_lookup (tags, name);
+
+          if (! tag)
+            {
+              tag = gimp_tag_new (name);
+
+              if (! tag)
+                continue;
+
+              g_hash_table_insert (tags, (gpointer) name, tag);
+            }
+
+          rec->tags = g_list_prepend (rec->tags, g_object_ref (tag));
+        }
+
+      rec->tags = g_list_reverse (rec->tags);
+
+      g_variant_iter_free (iter);
+    }
+
+  g_variant_unref (records);
+  g_hash_table_unref (tags);
+  g_variant_unref (variant);
+
+  return TRUE;
+}
+
+static gboolean
+gimp_tag_cache_save_binary (GList   *records,
+                            GFile   *file,
+                            GFile   *xml_file,
+                            GError **error)
+{
+  GFileInfo       *info;
+  GVariantBuilder  builder;
+  GVariant        *variant;
+  GList           *iterator;
+  gboolean         success;
+
+  /*  tags.xml must be written first  */
+  info = g_file_query_info (xml_file,
+                            G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                            G_FILE_QUERY_INFO_NONE,
+                            NULL, error);
+  if (! info)
+    return FALSE;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(ssas)"));
+
+  for (iterator = records; iterator; iterator = g_list_next (iterator))
+    {
+      GimpTagCacheRecord *cache_rec = iterator->data;
+      const gchar        *checksum  = g_quark_to_string (cache_rec->checksum);
+      GList              *tag_iterator;
+
+      g_variant_builder_open (&builder, G_VARIANT_TYPE ("(ssas)"));
+
+      g_variant_builder_add (&builder, "s",
+                             g_quark_to_string (cache_rec->identifier));
+      g_variant_builder_add (&builder, "s", checksum ? checksum : "");
+
+      g_variant_builder_open (&builder, G_VARIANT_TYPE ("as"));
+
+      for (tag_iterator = cache_rec->tags;
+           tag_iterator;
+           tag_iterator = g_list_next (tag_iterator))
+        {
+          GimpTag *tag = GIMP_TAG (tag_iterator->data);
+
+          if (! gimp_tag_get_internal (tag))
+            g_variant_builder_add (&builder, "s", gimp_tag_get_name (tag));
+        }
+
+      g_variant_builder_close (&builder);
+      g_variant_builder_close (&builder);
+    }
+
+  variant = g_variant_new (GIMP_TAG_CACHE_BINARY_TYPE,
+                           GIMP_TAG_CACHE_BINARY_MAGIC,
+                           (guint32) GIMP_TAG_CACHE_BINARY_VERSION,
+                           (gint64) g_file_info_get_attribute_uint64 (info,
+                                                                      G_FILE_ATTRIBUTE_TIME_MODIFIED),
+                           (guint64) g_file_info_get_size (info),
+                           &builder);
+  g_variant_ref_sink (variant);
+
+  g_object_unref (info);
+
+  success = g_file_replace_contents (file,
+                                     g_variant_get_data (variant),
+                                     g_variant_get_size (variant),
+                                     NULL, FALSE,
+                                     G_FILE_CREATE_NONE,
+                                     NULL, NULL, error);
+
+  g_variant_unref (variant);
+
+  return success;
+}
+
 static  void
 gimp_tag_cache_load_start_element (GMarkupParseContext *context,
                                    const gchar         *element_name,
@@ -29,19 +29,34 @@
 
 #include "libgimpcolor/gimpcolor.h"
 
+#include "gimp-memory-tags.h"
 #include "gimptempbuf.h"
 
 
 #define LOCK_DATA_ALIGNMENT 16
 
+/*  the data of temp bufs of up to POOL_MAX_BLOCK_SIZE bytes is allocated
+ *  in size classes, four per power of two, and is kept in a per-thread
+ *  pool when freed, up to a total of POOL_MAX_SIZE bytes across all
+ *  threads
+ */
+#define POOL_MIN_BLOCK_SHIFT 10                        /* 1 KiB */
+#define POOL_MAX_BLOCK_SHIFT 22                        /* 4 MiB */
+#define POOL_N_CLASSES       (1 + 4 * (POOL_MAX_BLOCK_SHIFT - \
+                                       POOL_MIN_BLOCK_SHIFT))
+#define POOL_MAX_BLOCK_SIZE  ((gsize) 1 << POOL_MAX_BLOCK_SHIFT)
+#define POOL_MAX_SIZE        (32 << 20)                /* 32 MiB */
+
 
 struct _GimpTempBuf
 {
-  gint        ref_count;
-  gint        width;
-  gint        height;
-  const Babl *format;
-  guchar     *data;
+  gint              ref_count;
+  gint              width;
+  gint              height;
+  const Babl       *format;
+  guchar           *data;
+
+  GimpMemoryTagged  tagged;
 };
 
 typedef struct
@@ -52,10 +67,36 @@ typedef struct
 
 G_STATIC_ASSERT (sizeof (LockData) <= LOCK_DATA_ALIGNMENT);
 
+typedef struct _PoolBlock PoolBlock;
+
+struct _PoolBlock
+{
+  PoolBlock *next;
+};
+
+typedef struct
+{
+  PoolBlock *blocks[POOL_N_CLASSES];
+} Pool;
+
+
+/*  local function prototypes  */
+
+static gint       gimp_temp_buf_pool_get_class      (gsize     size);
+static gsize      gimp_temp_buf_pool_get_block_size (gint      size_class);
+static gpointer   gimp_temp_buf_pool_alloc          (gsize     size);
+static void       gimp_temp_buf_pool_free           (gpointer  data,
+                                                     gsize     size);
+static void       gimp_temp_buf_pool_destroy        (Pool     *pool);
+
 
 /*  local variables  */
 
 static guintptr gimp_temp_buf_total_memsize = 0;
+static guintptr gimp_temp_buf_pool_memsize  = 0;
+
+static GPrivate gimp_temp_buf_pool =
+  G_PRIVATE_INIT ((GDestroyNotify) gimp_temp_buf_pool_destroy);
 
 
 /*  public functions  */
@@ -81,11 +122,14 @@ gimp_temp_buf_new (gint        width,
   temp->width     = width;
   temp->height    = height;
   temp->format    = format;
-  temp->data      = gegl_malloc ((gsize) width * height * bpp);
+  temp->data      = gimp_temp_buf_pool_alloc ((gsize) width * height * bpp);
 
   g_atomic_pointer_add (&gimp_temp_buf_total_memsize,
                         +gimp_temp_buf_get_memsize (temp));
 
+  gimp_memory_tags_tag_current (&temp->tagged,
+                                gimp_temp_buf_get_memsize (temp));
+
   return temp;
 }
 
@@ -173,9 +217,13 @@ gimp_temp_buf_unref (const GimpTempBuf *buf)
       g_atomic_pointer_add (&gimp_temp_buf_total_memsize,
                             -gimp_temp_buf_get_memsize (buf));
 
+      gimp_memory_tags_untag (&((GimpTempBuf *) buf)->tagged);
 
       if (buf->data)
-        gegl_free (buf->data);
+        {
+          gimp_temp_buf_pool_free (buf->data,
+                                   gimp_temp_buf_get_data_size (buf));
+        }
 
       g_slice_free (GimpTempBuf, (GimpTempBuf *) buf);
     }
@@ -443,8 +491,148 @@ gimp_gegl_buffer_get_temp_buf (GeglBuffer *buffer)
 
 /*  public functions (stats)  */
 
+/*  includes the memory kept in the pools of free blocks  */
 guint64
 gimp_temp_buf_get_total_memsize (void)
 {
-  return gimp_temp_buf_total_memsize;
+  return (guint64) g_atomic_pointer_get (&gimp_temp_buf_total_memsize) +
+         (guint64) g_atomic_pointer_get (&gimp_temp_buf_pool_memsize);
+}
+
+
+/*  private functions  */
+
+/*  class 0 holds blocks of 2^POOL_MIN_BLOCK_SHIFT bytes, and each
+ *  following group of four classes splits the next power of two in
+ *  quarters, so that a block wastes at most a quarter of its size
+ */
+static gint
+gimp_temp_buf_pool_get_class (gsize size)
+{
+  gint  shift;
+  gsize step;
+
+  if (size > POOL_MAX_BLOCK_SIZE)
+    return -1;
+
+  shift = g_bit_storage (size - 1);
+
+  if (shift <= POOL_MIN_BLOCK_SHIFT)
+    return 0;
+
+  step = (gsize) 1 << (shift - 3);
+
+  return 4 * (shift - POOL_MIN_BLOCK_SHIFT - 1) +
+         (size - ((gsize) 1 << (shift - 1)) + step - 1) / step;
+}
+
+static gsize
+gimp_temp_buf_pool_get_block_size (gint size_class)
+{
+  gint shift;
+
+  if (size_class == 0)
+    return (gsize) 1 << POOL_MIN_BLOCK_SHIFT;
+
+  shift = POOL_MIN_BLOCK_SHIFT + 1 + (size_class - 1) / 4;
+
+  return ((gsize) 1 << (shift - 1)) +
+         ((gsize) ((size_class - 1) % 4 + 1) << (shift - 3));
+}
+
+static gpointer
+gimp_temp_buf_pool_alloc (gsize size)
+{
+  Pool *pool;
+  gint  size_class = gimp_temp_buf_pool_get_class (size);
+
+  if (size_class < 0)
+    return gegl_malloc (size);
+
+  pool = g_private_get (&gimp_temp_buf_pool);
+
+  if (pool && pool->blocks[size_class])
+    {
+      PoolBlock *block = pool->blocks[size_class];
+
+      pool->blocks[size_class] = block->next;
+
+      g_atomic_pointer_add (&gimp_temp_buf_pool_memsize,
+                            -(gssize) gimp_temp_buf_pool_get_block_size (size_class));
+
+      return block;
+    }
+
+  return gegl_malloc (gimp_temp_buf_pool_get_block_size (size_class));
+}
+
+static void
+gimp_temp_buf_pool_free (gpointer data,
+                         gsize    size)
+{
+  Pool      *pool;
+  PoolBlock *block;
+  gint       size_class = gimp_temp_buf_pool_get_class (size);
+  gsize      block_size;
+
+  if (size_class < 0)
+    {
+      gegl_free (data);
+
+      return;
+    }
+
+  block_size = gimp_temp_buf_pool_get_block_size (size_class);
+
+  /*  the cap is shared by all threads, so reserve the block's size
+   *  before adding it to the pool
+   */
+  if (g_atomic_pointer_add (&gimp_temp_buf_pool_memsize, block_size) +
+      block_size > POOL_MAX_SIZE)
+    {
+      g_atomic_pointer_add (&gimp_temp_buf_pool_memsize,
+                            -(gssize) block_size);
+
+      gegl_free (data);
+
+      return;
+    }
+
+  pool = g_private_get (&gimp_temp_buf_pool);
+
+  if (! pool)
+    {
+      pool = g_new0 (Pool, 1);
+
+      g_private_set (&gimp_temp_buf_pool, pool);
+    }
+
+  block       = data;
+  block->next = pool->blocks[size_class];
+
+  pool->blocks[size_class] = block;
+}
+
+/*  called when a thread that used temp bufs exits  */
+static void
+gimp_temp_buf_pool_destroy (Pool *pool)
+{
+  gint size_class;
+
+  for (size_class = 0; size_class < POOL_N_CLASSES; size_class++)
+    {
+      while (pool->blocks[size_class])
+        {
+          PoolBlock *block = pool->blocks[size_class];
+
+          pool->blocks[size_class] = block->next;
+
+          g_atomic_pointer_add (&gimp_temp_buf_pool_memsize,
+                                -(gssize) gimp_temp_buf_pool_get_block_size (size_class));
+
+          gegl_free (block);
+        }
+    }
+
+  g_free (pool);
 }
@@ -29,6 +29,7 @@
 #include "config/gimpcoreconfig.h"
 
 #include "gimp.h"
+#include "gimp-memory-tags.h"
 #include "gimpcontext.h"
 #include "gimpimage.h"
 #include "gimpimage-undo.h"
@@ -381,6 +382,35 @@ gimp_undo_free (GimpUndo     *undo,
   g_signal_emit (undo, undo_signals[FREE], 0, undo_mode);
 }
 
+/**
+ * gimp_undo_swap_out:
+ * @undo: a #GimpUndo
+ *
+ * Moves the bulk of @undo's data, such as its pixels, out of memory,
+ * into the swap.  The undo can still be popped afterwards, only
+ * slower.  This is done at most once per undo.
+ *
+ * Returns: the number of bytes that are now kept in the swap, instead
+ *          of memory.
+ **/
+gint64
+gimp_undo_swap_out (GimpUndo *undo)
+{
+  g_return_val_if_fail (GIMP_IS_UNDO (undo), 0);
+
+  if (! undo->swapped)
+    {
+      undo->swapped = TRUE;
+
+      if (GIMP_UNDO_GET_CLASS (undo)->swap_out)
+        undo->swap_size = GIMP_UNDO_GET_CLASS (undo)->swap_out (undo);
+
+      gimp_memory_tags_shrink_object (G_OBJECT (undo), undo->swap_size);
+    }
+
+  return undo->swap_size;
+}
+
 typedef struct _GimpUndoIdle GimpUndoIdle;
 
 struct _GimpUndoIdle
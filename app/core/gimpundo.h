@@ -59,17 +59,23 @@ struct _GimpUndo
 
   GimpTempBuf      *preview;
   guint             preview_idle_id;
+
+  gboolean          swapped;        /* swap_out() was called              */
+  gint64            swap_size;      /* size of the swapped-out data       */
+  gint64            memsize;        /* share of its stack's memory        */
 };
 
 struct _GimpUndoClass
 {
   GimpViewableClass  parent_class;
 
-  void (* pop)  (GimpUndo            *undo,
-                 GimpUndoMode         undo_mode,
-                 GimpUndoAccumulator *accum);
-  void (* free) (GimpUndo            *undo,
-                 GimpUndoMode         undo_mode);
+  void   (* pop)      (GimpUndo            *undo,
+                       GimpUndoMode         undo_mode,
+                       GimpUndoAccumulator *accum);
+  void   (* free)     (GimpUndo            *undo,
+                       GimpUndoMode         undo_mode);
+
+  gint64 (* swap_out) (GimpUndo            *undo);
 };
 
 
@@ -81,6 +87,8 @@ void          gimp_undo_pop             (GimpUndo            *undo,
 void          gimp_undo_free            (GimpUndo            *undo,
                                          GimpUndoMode         undo_mode);
 
+gint64        gimp_undo_swap_out        (GimpUndo            *undo);
+
 void          gimp_undo_create_preview  (GimpUndo            *undo,
                                          GimpContext         *context,
                                          gboolean             create_now);
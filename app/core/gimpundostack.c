@@ -22,6 +22,7 @@
 
 #include "core-types.h"
 
+#include "gimp-memsize.h"
 #include "gimpimage.h"
 #include "gimplist.h"
 #include "gimpundo.h"
@@ -38,6 +39,11 @@ static void    gimp_undo_stack_pop         (GimpUndo            *undo,
                                             GimpUndoAccumulator *accum);
 static void    gimp_undo_stack_free        (GimpUndo            *undo,
                                             GimpUndoMode         undo_mode);
+static gint64  gimp_undo_stack_swap_out    (GimpUndo            *undo);
+
+static gint64  gimp_undo_stack_measure     (GimpUndo            *undo,
+                                            GimpUndo            *below);
+static void    gimp_undo_stack_measure_all (GimpUndoStack       *stack);
 
 
 G_DEFINE_TYPE (GimpUndoStack, gimp_undo_stack, GIMP_TYPE_UNDO)
@@ -58,6 +64,7 @@ gimp_undo_stack_class_init (GimpUndoStackClass *klass)
 
   undo_class->pop                = gimp_undo_stack_pop;
   undo_class->free               = gimp_undo_stack_free;
+  undo_class->swap_out           = gimp_undo_stack_swap_out;
 }
 
 static void
@@ -107,6 +114,27 @@ gimp_undo_stack_pop (GimpUndo            *undo,
     }
 }
 
+static gint64
+gimp_undo_stack_swap_out (GimpUndo *undo)
+{
+  GimpUndoStack *stack     = GIMP_UNDO_STACK (undo);
+  gint64         swap_size = 0;
+  GList         *list;
+
+  for (list = GIMP_LIST (stack->undos)->queue->head;
+       list;
+       list = g_list_next (list))
+    {
+      GimpUndo *child = list->data;
+
+      swap_size += gimp_undo_swap_out (child);
+    }
+
+  gimp_undo_stack_measure_all (stack);
+
+  return swap_size;
+}
+
 static void
 gimp_undo_stack_free (GimpUndo     *undo,
                       GimpUndoMode  undo_mode)
@@ -125,6 +153,8 @@ gimp_undo_stack_free (GimpUndo     *undo,
     }
 
   gimp_container_clear (stack->undos);
+
+  stack->undos_size = 0;
 }
 
 GimpUndoStack *
@@ -144,6 +174,15 @@ gimp_undo_stack_push_undo (GimpUndoStack *stack,
   g_return_if_fail (GIMP_IS_UNDO_STACK (stack));
   g_return_if_fail (GIMP_IS_UNDO (undo));
 
+  /*  popping a group changes the pixels its undos keep  */
+  if (GIMP_IS_UNDO_STACK (undo))
+    gimp_undo_stack_measure_all (GIMP_UNDO_STACK (undo));
+
+  undo->memsize = gimp_undo_stack_measure (undo,
+                                           gimp_undo_stack_peek (stack));
+
+  stack->undos_size += undo->memsize;
+
   gimp_container_add (stack->undos, GIMP_OBJECT (undo));
 }
 
@@ -162,6 +201,9 @@ gimp_undo_stack_pop_undo (GimpUndoStack       *stack,
   if (undo)
     {
       gimp_container_remove (stack->undos, GIMP_OBJECT (undo));
+
+      stack->undos_size -= undo->memsize;
+
       gimp_undo_pop (undo, undo_mode, accum);
 
       return undo;
@@ -182,9 +224,22 @@ gimp_undo_stack_free_bottom (GimpUndoStack *stack,
 
   if (undo)
     {
+      GimpUndo *bottom;
+
       gimp_container_remove (stack->undos, GIMP_OBJECT (undo));
+
+      stack->undos_size -= undo->memsize;
+
       gimp_undo_free (undo, undo_mode);
 
+      /*  the undo above was measured without the tiles it shared
+       *  with the freed one, which it now has to count
+       */
+      bottom = GIMP_UNDO (gimp_container_get_last_child (stack->undos));
+
+      if (bottom)
+        gimp_undo_stack_update_undo (stack, bottom);
+
       return undo;
     }
 
@@ -206,3 +261,102 @@ gimp_undo_stack_get_depth (GimpUndoStack *stack)
 
   return gimp_container_get_n_children (stack->undos);
 }
+
+/**
+ * gimp_undo_stack_update_undo:
+ * @stack: a #GimpUndoStack
+ * @undo:  one of @stack's undos
+ *
+ * Measures @undo again, after its memory use changed, for example
+ * because it was swapped out, and updates @stack's total accordingly.
+ **/
+void
+gimp_undo_stack_update_undo (GimpUndoStack *stack,
+                             GimpUndo      *undo)
+{
+  GList  *list;
+  gint64  memsize;
+
+  g_return_if_fail (GIMP_IS_UNDO_STACK (stack));
+  g_return_if_fail (GIMP_IS_UNDO (undo));
+
+  list = g_list_find (GIMP_LIST (stack->undos)->queue->head, undo);
+
+  g_return_if_fail (list != NULL);
+
+  memsize = gimp_undo_stack_measure (undo,
+                                     list->next ? list->next->data : NULL);
+
+  stack->undos_size += memsize - undo->memsize;
+  undo->memsize      = memsize;
+}
+
+/**
+ * gimp_undo_stack_get_undos_size:
+ * @stack: a #GimpUndoStack
+ *
+ * Returns: the memory used by @stack's undos, counting the tiles that
+ *          neighboring undos share only once.  The total is kept up to
+ *          date as undos are pushed, popped and swapped out, so this is
+ *          cheap to call.
+ **/
+gint64
+gimp_undo_stack_get_undos_size (GimpUndoStack *stack)
+{
+  g_return_val_if_fail (GIMP_IS_UNDO_STACK (stack), 0);
+
+  return stack->undos_size;
+}
+
+
+/*  private functions  */
+
+/*  the memory @undo adds on top of the undo below it.  the tiles shared
+ *  copy-on-write are nearly always shared with the neighboring undo, so
+ *  this only looks at the two of them, instead of the whole stack.
+ */
+static gint64
+gimp_undo_stack_measure (GimpUndo *undo,
+                         GimpUndo *below)
+{
+  gint64 memsize;
+
+  /*  a group keeps a total of its own undos  */
+  if (GIMP_IS_UNDO_STACK (undo))
+    return GIMP_UNDO_STACK (undo)->undos_size;
+
+  gimp_gegl_buffer_memsize_begin_shared ();
+
+  if (below)
+    gimp_object_get_memsize (GIMP_OBJECT (below), NULL);
+
+  memsize = gimp_object_get_memsize (GIMP_OBJECT (undo), NULL);
+
+  gimp_gegl_buffer_memsize_end_shared ();
+
+  return memsize;
+}
+
+static void
+gimp_undo_stack_measure_all (GimpUndoStack *stack)
+{
+  GList *list;
+
+  stack->undos_size = 0;
+
+  for (list = GIMP_LIST (stack->undos)->queue->tail;
+       list;
+       list = g_list_previous (list))
+    {
+      GimpUndo *undo = list->data;
+
+      if (GIMP_IS_UNDO_STACK (undo))
+        gimp_undo_stack_measure_all (GIMP_UNDO_STACK (undo));
+
+      undo->memsize = gimp_undo_stack_measure (undo,
+                                               list->next ?
+                                               list->next->data : NULL);
+
+      stack->undos_size += undo->memsize;
+    }
+}
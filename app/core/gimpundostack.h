@@ -35,6 +35,7 @@ struct _GimpUndoStack
   GimpUndo       parent_instance;
 
   GimpContainer *undos;
+  gint64         undos_size;  /*  tiles shared between undos count once  */
 };
 
 struct _GimpUndoStackClass
@@ -43,17 +44,21 @@ struct _GimpUndoStackClass
 };
 
 
-GType           gimp_undo_stack_get_type    (void) G_GNUC_CONST;
+GType           gimp_undo_stack_get_type       (void) G_GNUC_CONST;
 
-GimpUndoStack * gimp_undo_stack_new         (GimpImage           *image);
+GimpUndoStack * gimp_undo_stack_new            (GimpImage           *image);
 
-void            gimp_undo_stack_push_undo   (GimpUndoStack       *stack,
-                                             GimpUndo            *undo);
-GimpUndo      * gimp_undo_stack_pop_undo    (GimpUndoStack       *stack,
-                                             GimpUndoMode         undo_mode,
-                                             GimpUndoAccumulator *accum);
+void            gimp_undo_stack_push_undo      (GimpUndoStack       *stack,
+                                                GimpUndo            *undo);
+GimpUndo      * gimp_undo_stack_pop_undo       (GimpUndoStack       *stack,
+                                                GimpUndoMode         undo_mode,
+                                                GimpUndoAccumulator *accum);
 
-GimpUndo      * gimp_undo_stack_free_bottom (GimpUndoStack       *stack,
-                                             GimpUndoMode         undo_mode);
-GimpUndo      * gimp_undo_stack_peek        (GimpUndoStack       *stack);
-gint            gimp_undo_stack_get_depth   (GimpUndoStack       *stack);
+GimpUndo      * gimp_undo_stack_free_bottom    (GimpUndoStack       *stack,
+                                                GimpUndoMode         undo_mode);
+GimpUndo      * gimp_undo_stack_peek           (GimpUndoStack       *stack);
+gint            gimp_undo_stack_get_depth      (GimpUndoStack       *stack);
+
+void            gimp_undo_stack_update_undo    (GimpUndoStack       *stack,
+                                                GimpUndo            *undo);
+gint64          gimp_undo_stack_get_undos_size (GimpUndoStack       *stack);
@@ -33,6 +33,7 @@
 
 #include "core-types.h"
 
+#include "gimp-memory-tags.h"
 #include "gimp-memsize.h"
 #include "gimpcontainer.h"
 #include "gimpcontext.h"
@@ -938,11 +939,16 @@ gimp_viewable_get_preview (GimpViewable *viewable,
   g_clear_pointer (&private->preview_temp_buf, gimp_temp_buf_unref);
   g_clear_object (&private->preview_temp_buf_color);
 
+  /*  item previews push their own image on top of this scope  */
+  gimp_memory_tags_push (GIMP_MEMORY_TAG_PREVIEW, NULL);
+
   if (viewable_class->get_new_preview)
     temp_buf = viewable_class->get_new_preview (viewable, context,
                                                 width, height,
                                                 fg_color);
 
+  gimp_memory_tags_pop ();
+
   private->preview_temp_buf       = temp_buf;
   private->preview_temp_buf_color = fg_color ?
                                     gegl_color_duplicate (fg_color) : NULL;
@@ -55,6 +55,7 @@
 #include "widgets/gimpmenudock.h"
 #include "widgets/gimppaletteeditor.h"
 #include "widgets/gimppatternfactoryview.h"
+#include "widgets/gimprenderprofileeditor.h"
 #include "widgets/gimpsamplepointeditor.h"
 #include "widgets/gimpselectioneditor.h"
 #include "widgets/gimpsymmetryeditor.h"
@@ -800,6 +801,15 @@ dialogs_histogram_editor_new (GimpDialogFactory *factory,
   return gimp_histogram_editor_new ();
 }
 
+GtkWidget *
+dialogs_render_profile_editor_new (GimpDialogFactory *factory,
+                                   GimpContext       *context,
+                                   GimpUIManager     *ui_manager,
+                                   gint               view_size)
+{
+  return gimp_render_profile_editor_new ();
+}
+
 GtkWidget *
 dialogs_selection_editor_new (GimpDialogFactory *factory,
                               GimpContext       *context,
@@ -392,6 +392,10 @@ static const GimpDialogFactoryEntry entries[] =
             N_("Histogram"), NULL, GIMP_ICON_HISTOGRAM,
             GIMP_HELP_HISTOGRAM_DIALOG,
             dialogs_histogram_editor_new, 0, FALSE),
+  DOCKABLE ("gimp-render-profile-editor",
+            N_("Render Profile"), NULL, GIMP_ICON_DIALOG_DASHBOARD,
+            GIMP_HELP_RENDER_PROFILE_DIALOG,
+            dialogs_render_profile_editor_new, 0, FALSE),
   DOCKABLE ("gimp-selection-editor",
             N_("Selection"), N_("Selection Editor"), GIMP_ICON_SELECTION,
             GIMP_HELP_SELECTION_DIALOG,
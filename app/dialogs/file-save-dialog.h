@@ -33,5 +33,5 @@ gboolean    file_save_dialog_save_image (GimpProgress        *progress_and_handl
                                          gboolean             save_a_copy,
                                          gboolean             export_backward,
                                          gboolean             export_forward,
-                                         gboolean             xcf_compression,
+                                         GimpXcfCompression   xcf_compression,
                                          gboolean             verbose_cancel);
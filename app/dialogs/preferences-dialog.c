@@ -1233,21 +1233,27 @@ prefs_dialog_new (Gimp       *gimp,
   prefs_memsize_entry_add (object, "undo-size",
                            _("Maximum undo _memory:"),
                            GTK_GRID (grid), 1, size_group);
+  prefs_memsize_entry_add (object, "undo-swap-size",
+                           _("Maximum undo swap s_pace:"),
+                           GTK_GRID (grid), 2, size_group);
+  prefs_memsize_entry_add (object, "image-memory-budget",
+                           _("Maximum memory _per image:"),
+                           GTK_GRID (grid), 3, size_group);
   prefs_memsize_entry_add (object, "tile-cache-size",
                            _("Tile cache _size:"),
-                           GTK_GRID (grid), 2, size_group);
+                           GTK_GRID (grid), 4, size_group);
   prefs_memsize_entry_add (object, "max-new-image-size",
                            _("Maximum _new image size:"),
-                           GTK_GRID (grid), 3, size_group);
+                           GTK_GRID (grid), 5, size_group);
 
   prefs_compression_combo_box_add (object, "swap-compression",
                                    _("S_wap compression:"),
-                                   GTK_GRID (grid), 4, size_group);
+                                   GTK_GRID (grid), 6, size_group);
 
 #ifdef ENABLE_MP
   prefs_spin_button_add (object, "num-processors", 1.0, 4.0, 0,
                          _("Number of _threads to use:"),
-                         GTK_GRID (grid), 5, size_group);
+                         GTK_GRID (grid), 7, size_group);
 #endif /* ENABLE_MP */
 
   /*  Internet access  */
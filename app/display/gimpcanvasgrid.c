@@ -51,13 +51,22 @@ typedef struct _GimpCanvasGridPrivate GimpCanvasGridPrivate;
 
 struct _GimpCanvasGridPrivate
 {
-  GimpGrid *grid;
-  gboolean  grid_style;
+  GimpGrid        *grid;
+  gboolean         grid_style;
+
+  /*  one grid cell, in display pixels, to paint repeatedly  */
+  cairo_pattern_t *cell;
+  GimpGridStyle    cell_style;
+  gint             cell_width;
+  gint             cell_height;
 };
 
 #define GET_PRIVATE(grid) \
         ((GimpCanvasGridPrivate *) gimp_canvas_grid_get_instance_private ((GimpCanvasGrid *) (grid)))
 
+#define CROSSHAIR     2
+#define MAX_CELL_SIZE 256
+
 
 /*  local function prototypes  */
 
@@ -76,6 +85,10 @@ static cairo_region_t * gimp_canvas_grid_get_extents  (GimpCanvasItem *item);
 static void             gimp_canvas_grid_stroke       (GimpCanvasItem *item,
                                                        cairo_t        *cr);
 
+static cairo_pattern_t *gimp_canvas_grid_get_cell     (GimpCanvasGrid *grid,
+                                                       gdouble         xspacing,
+                                                       gdouble         yspacing);
+
 
 G_DEFINE_TYPE_WITH_PRIVATE (GimpCanvasGrid, gimp_canvas_grid,
                             GIMP_TYPE_CANVAS_ITEM)
@@ -123,6 +136,7 @@ gimp_canvas_grid_finalize (GObject *object)
   GimpCanvasGridPrivate *private = GET_PRIVATE (object);
 
   g_clear_object (&private->grid);
+  g_clear_pointer (&private->cell, cairo_pattern_destroy);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -191,8 +205,6 @@ gimp_canvas_grid_draw (GimpCanvasItem *item,
   gdouble                dx, dy;
   gint                   x, y;
 
-#define CROSSHAIR 2
-
   gimp_grid_get_spacing (private->grid, &xspacing, &yspacing);
   gimp_grid_get_offset  (private->grid, &xoffset,  &yoffset);
 
@@ -268,6 +280,42 @@ gimp_canvas_grid_draw (GimpCanvasItem *item,
   if (yoffset < 0.0)
     yoffset += yspacing;
 
+  /*  painting a cached cell is a lot cheaper than stroking every line,
+   *  dot or crosshair, but only exact when the cells have a whole
+   *  number of display pixels
+   */
+  if (private->grid_style && ! shell->rotate_transform && vert && horz)
+    {
+      cairo_pattern_t *cell;
+
+      cell = gimp_canvas_grid_get_cell (GIMP_CANVAS_GRID (item),
+                                        xspacing, yspacing);
+
+      if (cell)
+        {
+          cairo_matrix_t matrix;
+
+          cairo_matrix_init_translate (&matrix,
+                                       - RINT (x1 + xoffset),
+                                       - RINT (y1 + yoffset));
+          cairo_pattern_set_matrix (cell, &matrix);
+
+          cairo_save (cr);
+
+          cairo_rectangle (cr, x1, y1, x2 - x1, y2 - y1);
+          cairo_clip (cr);
+
+          gimp_canvas_set_grid_style (gimp_canvas_item_get_canvas (item), cr,
+                                      private->grid,
+                                      shell->offset_x, shell->offset_y);
+          cairo_mask (cr, cell);
+
+          cairo_restore (cr);
+
+          return;
+        }
+    }
+
   switch (gimp_grid_get_style (private->grid))
     {
     case GIMP_GRID_DOTS:
@@ -400,6 +448,95 @@ gimp_canvas_grid_stroke (GimpCanvasItem *item,
     }
 }
 
+/*  returns a repeating mask of one grid cell, with its grid point at
+ *  the cell's origin, that is only rebuilt when the grid style or its
+ *  spacing in display pixels change.  returns NULL if the spacing isn't
+ *  a whole number of pixels, or if the cell would be too large to be
+ *  worth it.
+ */
+static cairo_pattern_t *
+gimp_canvas_grid_get_cell (GimpCanvasGrid *grid,
+                           gdouble         xspacing,
+                           gdouble         yspacing)
+{
+  GimpCanvasGridPrivate *private = GET_PRIVATE (grid);
+  GimpGridStyle          style   = gimp_grid_get_style (private->grid);
+  cairo_surface_t       *surface;
+  cairo_t               *cr;
+  gint                   width;
+  gint                   height;
+
+  width  = RINT (xspacing);
+  height = RINT (yspacing);
+
+  if (fabs (xspacing - width)  > 1e-6 ||
+      fabs (yspacing - height) > 1e-6 ||
+      width  > MAX_CELL_SIZE          ||
+      height > MAX_CELL_SIZE)
+    {
+      return NULL;
+    }
+
+  if (private->cell               &&
+      private->cell_style  == style &&
+      private->cell_width  == width &&
+      private->cell_height == height)
+    {
+      return private->cell;
+    }
+
+  g_clear_pointer (&private->cell, cairo_pattern_destroy);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_A8, width, height);
+  cr      = cairo_create (surface);
+
+  /*  the same pixels gimp_canvas_grid_draw() strokes  */
+  switch (style)
+    {
+    case GIMP_GRID_DOTS:
+      cairo_rectangle (cr, 0, 0, 1, 1);
+      break;
+
+    case GIMP_GRID_INTERSECTIONS:
+      {
+        gint i;
+
+        /*  the crosshair wraps around the cell's borders  */
+        for (i = 0; i < 4; i++)
+          {
+            gint x = (i & 1) ? width  : 0;
+            gint y = (i & 2) ? height : 0;
+
+            cairo_rectangle (cr, x, y - CROSSHAIR, 1, 2 * CROSSHAIR + 1);
+            cairo_rectangle (cr, x - CROSSHAIR, y, 2 * CROSSHAIR + 1, 1);
+          }
+      }
+      break;
+
+    case GIMP_GRID_ON_OFF_DASH:
+    case GIMP_GRID_DOUBLE_DASH:
+    case GIMP_GRID_SOLID:
+      cairo_rectangle (cr, 0, 0, 1,     height);
+      cairo_rectangle (cr, 0, 0, width, 1);
+      break;
+    }
+
+  cairo_fill (cr);
+  cairo_destroy (cr);
+
+  private->cell        = cairo_pattern_create_for_surface (surface);
+  private->cell_style  = style;
+  private->cell_width  = width;
+  private->cell_height = height;
+
+  cairo_surface_destroy (surface);
+
+  cairo_pattern_set_extend (private->cell, CAIRO_EXTEND_REPEAT);
+  cairo_pattern_set_filter (private->cell, CAIRO_FILTER_NEAREST);
+
+  return private->cell;
+}
+
 GimpCanvasItem *
 gimp_canvas_grid_new (GimpDisplayShell *shell,
                       GimpGrid         *grid)
@@ -177,16 +177,68 @@ static void
 gimp_canvas_group_draw (GimpCanvasItem *item,
                         cairo_t        *cr)
 {
-  GimpCanvasGroup *group = GIMP_CANVAS_GROUP (item);
-  GList           *list;
+  GimpCanvasGroup       *group = GIMP_CANVAS_GROUP (item);
+  GimpCanvasItem        *prev  = NULL;
+  cairo_rectangle_int_t  clip;
+  gdouble                x1, y1, x2, y2;
+  GList                 *list;
+
+  cairo_clip_extents (cr, &x1, &y1, &x2, &y2);
+
+  x1 = CLAMP (x1, -G_MAXINT / 4, G_MAXINT / 4);
+  y1 = CLAMP (y1, -G_MAXINT / 4, G_MAXINT / 4);
+  x2 = CLAMP (x2, -G_MAXINT / 4, G_MAXINT / 4);
+  y2 = CLAMP (y2, -G_MAXINT / 4, G_MAXINT / 4);
+
+  clip.x      = floor (x1);
+  clip.y      = floor (y1);
+  clip.width  = ceil (x2) - clip.x;
+  clip.height = ceil (y2) - clip.y;
 
   for (list = group->priv->items->head; list; list = g_list_next (list))
     {
       GimpCanvasItem *sub_item = list->data;
+      cairo_region_t *extents;
+
+      if (! gimp_canvas_item_get_visible (sub_item))
+        continue;
+
+      /*  skip the items that are entirely outside of the exposed area,
+       *  their extents are cached until they, or the display transform,
+       *  change
+       */
+      extents = _gimp_canvas_item_peek_extents (sub_item);
+
+      if (extents &&
+          cairo_region_contains_rectangle (extents, &clip) ==
+          CAIRO_REGION_OVERLAP_OUT)
+        {
+          continue;
+        }
+
+      /*  consecutive items that are stroked the same way are drawn as a
+       *  single path, and stroked once, by the last one of them
+       */
+      if (prev)
+        {
+          if (_gimp_canvas_item_same_style (prev, sub_item))
+            {
+              gimp_canvas_item_suspend_stroking (prev);
+              gimp_canvas_item_draw (prev, cr);
+              gimp_canvas_item_resume_stroking (prev);
+            }
+          else
+            {
+              gimp_canvas_item_draw (prev, cr);
+            }
+        }
 
-      gimp_canvas_item_draw (sub_item, cr);
+      prev = sub_item;
     }
 
+  if (prev)
+    gimp_canvas_item_draw (prev, cr);
+
   if (group->priv->group_stroking)
     _gimp_canvas_item_stroke (item, cr);
 
@@ -242,6 +294,8 @@ gimp_canvas_group_child_update (GimpCanvasItem  *item,
                                 cairo_region_t  *region,
                                 GimpCanvasGroup *group)
 {
+  _gimp_canvas_item_invalidate_extents (GIMP_CANVAS_ITEM (group));
+
   if (_gimp_canvas_item_needs_update (GIMP_CANVAS_ITEM (group)))
     _gimp_canvas_item_update (GIMP_CANVAS_ITEM (group), region);
 }
@@ -275,6 +329,8 @@ gimp_canvas_group_add_item (GimpCanvasGroup *group,
 
   g_queue_push_tail (group->priv->items, g_object_ref (item));
 
+  _gimp_canvas_item_invalidate_extents (GIMP_CANVAS_ITEM (group));
+
   if (_gimp_canvas_item_needs_update (GIMP_CANVAS_ITEM (group)))
     {
       cairo_region_t *region = gimp_canvas_item_get_extents (item);
@@ -306,6 +362,8 @@ gimp_canvas_group_remove_item (GimpCanvasGroup *group,
 
   g_queue_delete_link (group->priv->items, list);
 
+  _gimp_canvas_item_invalidate_extents (GIMP_CANVAS_ITEM (group));
+
   if (group->priv->group_stroking)
     gimp_canvas_item_resume_stroking (item);
 
@@ -71,6 +71,8 @@ static void             gimp_canvas_guide_draw         (GimpCanvasItem *item,
 static cairo_region_t * gimp_canvas_guide_get_extents  (GimpCanvasItem *item);
 static void             gimp_canvas_guide_stroke       (GimpCanvasItem *item,
                                                         cairo_t        *cr);
+static gboolean         gimp_canvas_guide_same_style   (GimpCanvasItem *item,
+                                                        GimpCanvasItem *other);
 
 
 G_DEFINE_TYPE_WITH_PRIVATE (GimpCanvasGuide, gimp_canvas_guide,
@@ -91,6 +93,7 @@ gimp_canvas_guide_class_init (GimpCanvasGuideClass *klass)
   item_class->draw           = gimp_canvas_guide_draw;
   item_class->get_extents    = gimp_canvas_guide_get_extents;
   item_class->stroke         = gimp_canvas_guide_stroke;
+  item_class->same_style     = gimp_canvas_guide_same_style;
 
   g_object_class_install_property (object_class, PROP_ORIENTATION,
                                    g_param_spec_enum ("orientation", NULL, NULL,
@@ -261,6 +264,13 @@ gimp_canvas_guide_stroke (GimpCanvasItem *item,
     }
 }
 
+static gboolean
+gimp_canvas_guide_same_style (GimpCanvasItem *item,
+                              GimpCanvasItem *other)
+{
+  return GET_PRIVATE (item)->style == GET_PRIVATE (other)->style;
+}
+
 GimpCanvasItem *
 gimp_canvas_guide_new (GimpDisplayShell    *shell,
                        GimpOrientationType  orientation,
@@ -61,6 +61,18 @@ struct _GimpCanvasItemPrivate
   gint              suspend_filling;
   gint              change_count;
   cairo_region_t   *change_region;
+
+  /*  the extents are cached for culling, along with the shell state they
+   *  were computed for
+   */
+  cairo_region_t   *extents;
+  gboolean          extents_valid;
+  gint              extents_offset_x;
+  gint              extents_offset_y;
+  gdouble           extents_scale_x;
+  gdouble           extents_scale_y;
+  gint              extents_disp_width;
+  gint              extents_disp_height;
 };
 
 
@@ -116,6 +128,7 @@ gimp_canvas_item_class_init (GimpCanvasItemClass *klass)
   klass->stroke                             = gimp_canvas_item_real_stroke;
   klass->fill                               = gimp_canvas_item_real_fill;
   klass->hit                                = gimp_canvas_item_real_hit;
+  klass->same_style                         = NULL;
 
   item_signals[UPDATE] =
     g_signal_new ("update",
@@ -191,6 +204,8 @@ gimp_canvas_item_dispose (GObject *object)
 
   item->private->change_count++; /* avoid emissions during destruction */
 
+  _gimp_canvas_item_invalidate_extents (item);
+
   G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
@@ -265,6 +280,8 @@ gimp_canvas_item_dispatch_properties_changed (GObject     *object,
                                                               n_pspecs,
                                                               pspecs);
 
+  _gimp_canvas_item_invalidate_extents (item);
+
   if (_gimp_canvas_item_needs_update (item))
     {
       cairo_region_t *region = gimp_canvas_item_get_extents (item);
@@ -465,6 +482,8 @@ gimp_canvas_item_begin_change (GimpCanvasItem *item)
 
   private->change_count++;
 
+  _gimp_canvas_item_invalidate_extents (item);
+
   if (private->change_count == 1 &&
       g_signal_has_handler_pending (item, item_signals[UPDATE], 0, FALSE))
     {
@@ -485,6 +504,8 @@ gimp_canvas_item_end_change (GimpCanvasItem *item)
 
   private->change_count--;
 
+  _gimp_canvas_item_invalidate_extents (item);
+
   if (private->change_count == 0)
     {
       if (g_signal_has_handler_pending (item, item_signals[UPDATE], 0, FALSE))
@@ -694,6 +715,68 @@ _gimp_canvas_item_needs_update (GimpCanvasItem *item)
           g_signal_has_handler_pending (item, item_signals[UPDATE], 0, FALSE));
 }
 
+/*  returns the item's extents, like gimp_canvas_item_get_extents(), but
+ *  without transferring ownership, and computing them only when the item
+ *  or the display transform changed since the last call.
+ */
+cairo_region_t *
+_gimp_canvas_item_peek_extents (GimpCanvasItem *item)
+{
+  GimpCanvasItemPrivate *private = item->private;
+  GimpDisplayShell      *shell   = private->shell;
+
+  if (! private->visible)
+    return NULL;
+
+  if (private->extents_valid                            &&
+      private->extents_offset_x    == shell->offset_x   &&
+      private->extents_offset_y    == shell->offset_y   &&
+      private->extents_scale_x     == shell->scale_x    &&
+      private->extents_scale_y     == shell->scale_y    &&
+      private->extents_disp_width  == shell->disp_width &&
+      private->extents_disp_height == shell->disp_height)
+    {
+      return private->extents;
+    }
+
+  g_clear_pointer (&private->extents, cairo_region_destroy);
+
+  private->extents             = gimp_canvas_item_get_extents (item);
+  private->extents_valid       = TRUE;
+  private->extents_offset_x    = shell->offset_x;
+  private->extents_offset_y    = shell->offset_y;
+  private->extents_scale_x     = shell->scale_x;
+  private->extents_scale_y     = shell->scale_y;
+  private->extents_disp_width  = shell->disp_width;
+  private->extents_disp_height = shell->disp_height;
+
+  return private->extents;
+}
+
+void
+_gimp_canvas_item_invalidate_extents (GimpCanvasItem *item)
+{
+  g_clear_pointer (&item->private->extents, cairo_region_destroy);
+  item->private->extents_valid = FALSE;
+}
+
+gboolean
+_gimp_canvas_item_same_style (GimpCanvasItem *item,
+                              GimpCanvasItem *other)
+{
+  GimpCanvasItemClass *item_class = GIMP_CANVAS_ITEM_GET_CLASS (item);
+
+  return (item_class->same_style                                &&
+          G_OBJECT_TYPE (item) == G_OBJECT_TYPE (other)         &&
+          item->private->suspend_stroking  == 0                 &&
+          item->private->suspend_filling   == 0                 &&
+          other->private->suspend_stroking == 0                 &&
+          other->private->suspend_filling  == 0                 &&
+          item->private->line_cap  == other->private->line_cap  &&
+          item->private->highlight == other->private->highlight &&
+          item_class->same_style (item, other));
+}
+
 void
 _gimp_canvas_item_stroke (GimpCanvasItem *item,
                           cairo_t        *cr)
@@ -62,6 +62,12 @@ struct _GimpCanvasItemClass
   gboolean         (* hit)         (GimpCanvasItem   *item,
                                     gdouble           x,
                                     gdouble           y);
+
+  /*  whether the item and another item of the same type are stroked
+   *  identically, so that a group can stroke them at once
+   */
+  gboolean         (* same_style)  (GimpCanvasItem   *item,
+                                    GimpCanvasItem   *other);
 };
 
 
@@ -136,6 +142,11 @@ void             gimp_canvas_item_untransform_viewport
 void             _gimp_canvas_item_update          (GimpCanvasItem   *item,
                                                     cairo_region_t   *region);
 gboolean         _gimp_canvas_item_needs_update    (GimpCanvasItem   *item);
+cairo_region_t * _gimp_canvas_item_peek_extents    (GimpCanvasItem   *item);
+void             _gimp_canvas_item_invalidate_extents
+                                                   (GimpCanvasItem   *item);
+gboolean         _gimp_canvas_item_same_style      (GimpCanvasItem   *item,
+                                                    GimpCanvasItem   *other);
 void             _gimp_canvas_item_stroke          (GimpCanvasItem   *item,
                                                     cairo_t          *cr);
 void             _gimp_canvas_item_fill            (GimpCanvasItem   *item,
@@ -49,6 +49,9 @@
 #include "gimpdisplayshell.h"
 
 
+#define MAX_LEVEL 8
+
+
 enum
 {
   PROP_0,
@@ -92,6 +95,7 @@ struct _GimpCanvasTransformPreviewPrivate
   GeglRectangle        node_rect;
   gdouble              node_opacity;
   GimpMatrix3          node_matrix;
+  gint                 node_level;
   GeglNode            *node_output;
 };
 
@@ -122,6 +126,11 @@ static void             gimp_canvas_transform_preview_set_pickable  (GimpCanvasT
                                                                      GimpPickable               *pickable);
 static void             gimp_canvas_transform_preview_sync_node     (GimpCanvasTransformPreview *transform_preview);
 
+static gint             gimp_canvas_transform_preview_get_level     (const GimpMatrix3          *matrix,
+                                                                     const GeglRectangle        *rect);
+static GeglBuffer     * gimp_canvas_transform_preview_scale_buffer  (GeglBuffer                 *buffer,
+                                                                     gint                        level);
+
 
 G_DEFINE_TYPE_WITH_PRIVATE (GimpCanvasTransformPreview,
                             gimp_canvas_transform_preview,
@@ -494,6 +503,7 @@ gimp_canvas_transform_preview_sync_node (GimpCanvasTransformPreview *transform_p
   gdouble                            opacity    = private->opacity;
   gint                               offset_x   = 0;
   gint                               offset_y   = 0;
+  gint                               level      = 0;
   GimpMatrix3                        matrix;
 
   if (! private->node)
@@ -573,6 +583,7 @@ gimp_canvas_transform_preview_sync_node (GimpCanvasTransformPreview *transform_p
       private->node_rect       = *GEGL_RECTANGLE (0, 0, 0, 0);
       private->node_opacity    = 1.0;
       gimp_matrix3_identity (&private->node_matrix);
+      private->node_level      = 0;
       private->node_output     = private->transform_node;
     }
 
@@ -615,7 +626,30 @@ gimp_canvas_transform_preview_sync_node (GimpCanvasTransformPreview *transform_p
   gimp_matrix3_mult (&private->transform, &matrix);
   gimp_matrix3_scale (&matrix, shell->scale_x, shell->scale_y);
 
-  if (pickable != private->node_pickable)
+  /*  sample the preview from the mipmap level matching the display
+   *  scale, rather than from the full-resolution source.  the selection
+   *  mask is in image coordinates, so it keeps the preview at level 0.
+   */
+  if (! mask)
+    {
+      GeglBuffer *buffer = gimp_pickable_get_buffer (pickable);
+
+      level = gimp_canvas_transform_preview_get_level (
+        &matrix, gegl_buffer_get_extent (buffer));
+    }
+
+  if (level > 0)
+    {
+      GimpMatrix3 level_matrix;
+
+      gimp_matrix3_identity (&level_matrix);
+      gimp_matrix3_scale (&level_matrix, 1 << level, 1 << level);
+      gimp_matrix3_mult (&matrix, &level_matrix);
+
+      matrix = level_matrix;
+    }
+
+  if (pickable != private->node_pickable || level != private->node_level)
     {
       GeglBuffer *buffer;
 
@@ -623,7 +657,9 @@ gimp_canvas_transform_preview_sync_node (GimpCanvasTransformPreview *transform_p
 
       buffer = gimp_pickable_get_buffer (pickable);
 
-      if (gimp_tile_handler_validate_get_assigned (buffer))
+      if (level > 0)
+        buffer = gimp_canvas_transform_preview_scale_buffer (buffer, level);
+      else if (gimp_tile_handler_validate_get_assigned (buffer))
         buffer = gimp_gegl_buffer_dup (buffer);
       else
         buffer = g_object_ref (buffer);
@@ -638,13 +674,26 @@ gimp_canvas_transform_preview_sync_node (GimpCanvasTransformPreview *transform_p
       g_object_unref (buffer);
     }
 
-  if (layer_mask != private->node_layer_mask)
+  if (layer_mask != private->node_layer_mask ||
+      (layer_mask && level != private->node_level))
     {
+      GeglBuffer *buffer = NULL;
+
+      if (layer_mask)
+        {
+          buffer = gimp_drawable_get_buffer (layer_mask);
+
+          if (level > 0)
+            buffer = gimp_canvas_transform_preview_scale_buffer (buffer, level);
+          else
+            buffer = g_object_ref (buffer);
+        }
+
       gegl_node_set (private->layer_mask_source_node,
-                     "buffer", layer_mask ?
-                                 gimp_drawable_get_buffer (layer_mask) :
-                                 NULL,
+                     "buffer", buffer,
                      NULL);
+
+      g_clear_object (&buffer);
     }
 
   if (mask)
@@ -760,6 +809,89 @@ gimp_canvas_transform_preview_sync_node (GimpCanvasTransformPreview *transform_p
   private->node_layer_mask = layer_mask;
   private->node_mask       = mask;
   private->node_opacity    = opacity;
+  private->node_level      = level;
+}
+
+/*  returns the highest mipmap level, at which each source pixel still
+ *  covers at least one display pixel along the most magnified edge of
+ *  'rect', so that sampling it with nearest neighbor looks the same as
+ *  sampling level 0.
+ */
+static gint
+gimp_canvas_transform_preview_get_level (const GimpMatrix3   *matrix,
+                                         const GeglRectangle *rect)
+{
+  const gdouble corners[4][2] = { { rect->x,               rect->y                },
+                                  { rect->x + rect->width, rect->y                },
+                                  { rect->x + rect->width, rect->y + rect->height },
+                                  { rect->x,               rect->y + rect->height } };
+  gdouble       points[4][2];
+  gdouble       ratio = 0.0;
+  gint          level = 0;
+  gint          i;
+
+  if (rect->width < 1 || rect->height < 1)
+    return 0;
+
+  for (i = 0; i < 4; i++)
+    {
+      gdouble w = matrix->coeff[2][0] * corners[i][0] +
+                  matrix->coeff[2][1] * corners[i][1] +
+                  matrix->coeff[2][2];
+
+      if (w < GIMP_TRANSFORM_NEAR_Z)
+        return 0;
+
+      gimp_matrix3_transform_point (matrix,
+                                    corners[i][0], corners[i][1],
+                                    &points[i][0], &points[i][1]);
+    }
+
+  for (i = 0; i < 4; i++)
+    {
+      gint    j      = (i + 1) % 4;
+      gdouble length = (i % 2 == 0) ? rect->width : rect->height;
+
+      ratio = MAX (ratio, hypot (points[j][0] - points[i][0],
+                                 points[j][1] - points[i][1]) / length);
+    }
+
+  while (level < MAX_LEVEL && ratio * (2 << level) <= 1.0)
+    level++;
+
+  return level;
+}
+
+/*  returns a copy of 'buffer' at mipmap level 'level'  */
+static GeglBuffer *
+gimp_canvas_transform_preview_scale_buffer (GeglBuffer *buffer,
+                                            gint        level)
+{
+  const Babl          *format = gegl_buffer_get_format (buffer);
+  const GeglRectangle *extent = gegl_buffer_get_extent (buffer);
+  gdouble              factor = 1 << level;
+  GeglBuffer          *level_buffer;
+  GeglBufferIterator  *iter;
+  GeglRectangle        rect;
+
+  rect.x      = floor (extent->x / factor);
+  rect.y      = floor (extent->y / factor);
+  rect.width  = ceil ((extent->x + extent->width)  / factor) - rect.x;
+  rect.height = ceil ((extent->y + extent->height) / factor) - rect.y;
+
+  level_buffer = gegl_buffer_new (&rect, format);
+
+  iter = gegl_buffer_iterator_new (level_buffer, &rect, 0, format,
+                                   GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE, 1);
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      gegl_buffer_get (buffer, &iter->items[0].roi, 1.0 / factor,
+                       format, iter->items[0].data,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+    }
+
+  return level_buffer;
 }
 
 
@@ -17,6 +17,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <gegl.h>
 #include <gtk/gtk.h>
 
@@ -57,6 +59,9 @@
 #define PAINT_AREA_CHUNK_WIDTH  32
 #define PAINT_AREA_CHUNK_HEIGHT 32
 
+/*  the size of the image-space tiles immediate updates are coalesced in  */
+#define UPDATE_TILE_SIZE        64
+
 
 enum
 {
@@ -76,6 +81,18 @@ struct _GimpDisplayImplPrivate
 
   GtkWidget      *shell;
   cairo_region_t *update_region;
+
+  /*  immediate updates, such as those of the projection's chunk renderer,
+   *  are marked in a bitmap of image-space tiles, and painted once per
+   *  frame, so that many small overlapping updates only cause each tile
+   *  to be exposed and rendered once.
+   */
+  guint8         *update_tiles;
+  GeglRectangle   update_tiles_rect;  /*  the area covered by the bitmap  */
+  gint            update_tiles_n_cols;
+  gint            update_tiles_n_rows;
+  GeglRectangle   update_tiles_dirty; /*  the dirty tiles' bounds, in tiles */
+  guint           update_tick_id;
 };
 
 
@@ -116,6 +133,16 @@ static void     gimp_display_progress_canceled      (GimpProgress        *progre
                                                      GimpDisplay         *display);
 
 static void     gimp_display_flush_update_region    (GimpDisplay         *display);
+static void     gimp_display_mark_update_tiles      (GimpDisplay         *display,
+                                                     gint                 x,
+                                                     gint                 y,
+                                                     gint                 w,
+                                                     gint                 h);
+static void     gimp_display_flush_update_tiles     (GimpDisplay         *display);
+static void     gimp_display_clear_update_tiles     (GimpDisplay         *display);
+static gboolean gimp_display_update_tiles_tick      (GtkWidget           *widget,
+                                                     GdkFrameClock       *frame_clock,
+                                                     GimpDisplay         *display);
 static void     gimp_display_paint_area             (GimpDisplay         *display,
                                                      gint                 x,
                                                      gint                 y,
@@ -581,6 +608,8 @@ gimp_display_set_image (GimpDisplay *display,
 
       g_clear_pointer (&private->update_region, cairo_region_destroy);
 
+      gimp_display_clear_update_tiles (display);
+
       gimp_image_dec_display_count (private->image);
 
       /*  set private->image before unrefing because there may be code
@@ -722,6 +751,9 @@ gimp_display_update_bounding_box (GimpDisplay *display)
           gint          n_diff_rects;
           gint          i;
 
+          /*  the update tiles cover the old bounding box  */
+          gimp_display_flush_update_tiles (display);
+
           n_diff_rects = gegl_rectangle_subtract (diff_rects,
                                                   &private->bounding_box,
                                                   &bounding_box);
@@ -761,7 +793,7 @@ gimp_display_update_area (GimpDisplay *display,
 
   if (now)
     {
-      gimp_display_paint_area (display, x, y, w, h);
+      gimp_display_mark_update_tiles (display, x, y, w, h);
     }
   else
     {
@@ -796,6 +828,7 @@ gimp_display_flush (GimpDisplay *display)
   if (gimp_display_get_shell (display))
     {
       gimp_display_flush_update_region (display);
+      gimp_display_flush_update_tiles (display);
 
       gimp_display_shell_flush (gimp_display_get_shell (display));
     }
@@ -807,6 +840,7 @@ gimp_display_flush_now (GimpDisplay *display)
   g_return_if_fail (GIMP_IS_DISPLAY (display));
 
   gimp_display_flush_update_region (display);
+  gimp_display_flush_update_tiles (display);
 }
 
 
@@ -840,6 +874,184 @@ gimp_display_flush_update_region (GimpDisplay *display)
     }
 }
 
+static void
+gimp_display_mark_update_tiles (GimpDisplay *display,
+                                gint         x,
+                                gint         y,
+                                gint         w,
+                                gint         h)
+{
+  GimpDisplayImplPrivate *private = GIMP_DISPLAY_IMPL (display)->priv;
+  GimpDisplayShell       *shell   = gimp_display_get_shell (display);
+  GeglRectangle           rect;
+  gint                    col1, col2;
+  gint                    row1, row2;
+  gint                    row;
+
+  /*  without a frame clock to paint the tiles on, paint right away  */
+  if (! shell || ! gtk_widget_get_mapped (shell->canvas))
+    {
+      gimp_display_paint_area (display, x, y, w, h);
+
+      return;
+    }
+
+  if (! gegl_rectangle_intersect (&rect,
+                                  &private->bounding_box,
+                                  GEGL_RECTANGLE (x, y, w, h)))
+    {
+      return;
+    }
+
+  if (! private->update_tiles)
+    {
+      private->update_tiles_rect   = private->bounding_box;
+      private->update_tiles_n_cols = (private->update_tiles_rect.width  +
+                                      UPDATE_TILE_SIZE - 1) / UPDATE_TILE_SIZE;
+      private->update_tiles_n_rows = (private->update_tiles_rect.height +
+                                      UPDATE_TILE_SIZE - 1) / UPDATE_TILE_SIZE;
+
+      private->update_tiles = g_new0 (guint8,
+                                      private->update_tiles_n_cols *
+                                      private->update_tiles_n_rows);
+
+      gegl_rectangle_set (&private->update_tiles_dirty, 0, 0, 0, 0);
+    }
+
+  rect.x -= private->update_tiles_rect.x;
+  rect.y -= private->update_tiles_rect.y;
+
+  col1 = rect.x                     / UPDATE_TILE_SIZE;
+  col2 = (rect.x + rect.width  - 1) / UPDATE_TILE_SIZE;
+  row1 = rect.y                     / UPDATE_TILE_SIZE;
+  row2 = (rect.y + rect.height - 1) / UPDATE_TILE_SIZE;
+
+  for (row = row1; row <= row2; row++)
+    {
+      memset (private->update_tiles + row * private->update_tiles_n_cols + col1,
+              1, col2 - col1 + 1);
+    }
+
+  gegl_rectangle_bounding_box (&private->update_tiles_dirty,
+                               &private->update_tiles_dirty,
+                               GEGL_RECTANGLE (col1,            row1,
+                                               col2 - col1 + 1, row2 - row1 + 1));
+
+  if (! private->update_tick_id)
+    {
+      private->update_tick_id =
+        gtk_widget_add_tick_callback (
+          shell->canvas,
+          (GtkTickCallback) gimp_display_update_tiles_tick,
+          display, NULL);
+    }
+}
+
+static void
+gimp_display_flush_update_tiles (GimpDisplay *display)
+{
+  GimpDisplayImplPrivate *private = GIMP_DISPLAY_IMPL (display)->priv;
+  const GeglRectangle    *dirty   = &private->update_tiles_dirty;
+  cairo_region_t         *region;
+  gint                    n_rects;
+  gint                    row;
+  gint                    i;
+
+  if (! private->update_tiles || gegl_rectangle_is_empty (dirty))
+    {
+      gimp_display_clear_update_tiles (display);
+
+      return;
+    }
+
+  /*  merge the dirty tiles of each row into runs; the region merges
+   *  identical runs of consecutive rows
+   */
+  region = cairo_region_create ();
+
+  for (row = dirty->y; row < dirty->y + dirty->height; row++)
+    {
+      guint8 *tiles = private->update_tiles +
+                      row * private->update_tiles_n_cols;
+      gint    col   = dirty->x;
+
+      while (col < dirty->x + dirty->width)
+        {
+          cairo_rectangle_int_t rect;
+          gint                  start;
+
+          if (! tiles[col])
+            {
+              col++;
+
+              continue;
+            }
+
+          for (start = col; col < dirty->x + dirty->width && tiles[col]; col++)
+            tiles[col] = 0;
+
+          rect.x      = private->update_tiles_rect.x + start * UPDATE_TILE_SIZE;
+          rect.y      = private->update_tiles_rect.y + row   * UPDATE_TILE_SIZE;
+          rect.width  = (col - start) * UPDATE_TILE_SIZE;
+          rect.height = UPDATE_TILE_SIZE;
+
+          cairo_region_union_rectangle (region, &rect);
+        }
+    }
+
+  gimp_display_clear_update_tiles (display);
+
+  n_rects = cairo_region_num_rectangles (region);
+
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (region, i, &rect);
+
+      gimp_display_paint_area (display,
+                               rect.x,
+                               rect.y,
+                               rect.width,
+                               rect.height);
+    }
+
+  cairo_region_destroy (region);
+}
+
+static void
+gimp_display_clear_update_tiles (GimpDisplay *display)
+{
+  GimpDisplayImplPrivate *private = GIMP_DISPLAY_IMPL (display)->priv;
+
+  g_clear_pointer (&private->update_tiles, g_free);
+
+  if (private->update_tick_id)
+    {
+      GimpDisplayShell *shell = gimp_display_get_shell (display);
+
+      if (shell)
+        gtk_widget_remove_tick_callback (shell->canvas,
+                                         private->update_tick_id);
+
+      private->update_tick_id = 0;
+    }
+}
+
+static gboolean
+gimp_display_update_tiles_tick (GtkWidget     *widget,
+                                GdkFrameClock *frame_clock,
+                                GimpDisplay   *display)
+{
+  GimpDisplayImplPrivate *private = GIMP_DISPLAY_IMPL (display)->priv;
+
+  private->update_tick_id = 0;
+
+  gimp_display_flush_update_tiles (display);
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
 gimp_display_paint_area (GimpDisplay *display,
                          gint         x,
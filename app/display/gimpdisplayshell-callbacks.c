@@ -26,6 +26,9 @@
 #include "display-types.h"
 
 #include "core/gimp.h"
+#include "core/gimp-frame-stats.h"
+#include "core/gimp-input-latency.h"
+#include "core/gimp-tile-profile.h"
 #include "core/gimpimage.h"
 #include "core/gimpimage-quick-mask.h"
 
@@ -268,7 +271,8 @@ gimp_display_shell_canvas_size_allocate (GtkWidget        *widget,
   if (shell->disp_width  != allocation->width ||
       shell->disp_height != allocation->height)
     {
-      g_clear_pointer (&shell->render_cache, cairo_surface_destroy);
+      g_clear_pointer (&shell->render_cache,      cairo_surface_destroy);
+      g_clear_pointer (&shell->render_cache_back, cairo_surface_destroy);
       gimp_display_shell_render_invalidate_full (shell);
 
       shell->disp_width  = allocation->width;
@@ -305,7 +309,13 @@ gimp_display_shell_canvas_draw (GtkWidget        *widget,
        */
       if (image != NULL && ! gimp_image_get_converting (image))
         {
+          gimp_frame_stats_begin_frame ();
+
           gimp_display_shell_canvas_draw_image (shell, cr);
+
+          gimp_frame_stats_end_frame ();
+
+          gimp_input_latency_displayed ();
         }
       else if (image == NULL)
         {
@@ -608,6 +618,20 @@ gimp_display_shell_canvas_draw_image (GimpDisplayShell *shell,
   cairo_rectangle_list_destroy (clip_rectangles);
   cairo_restore (cr);
 
+  /*  draw the tile heat map over the image, while profiling
+   */
+  if (gimp_tile_profile_is_enabled ())
+    {
+      cairo_save (cr);
+
+      if (shell->rotate_transform)
+        cairo_transform (cr, shell->rotate_transform);
+
+      gimp_display_shell_draw_tile_heat_map (shell, cr);
+
+      cairo_restore (cr);
+    }
+
 
   /*  finally, draw all the remaining image window stuff on top
    */
@@ -28,6 +28,7 @@
 #include "display-types.h"
 
 #include "core/gimp-cairo.h"
+#include "core/gimp-tile-profile.h"
 #include "core/gimp-utils.h"
 #include "core/gimpimage.h"
 
@@ -148,7 +149,7 @@ gimp_display_shell_draw_image (GimpDisplayShell *shell,
 {
   gdouble chunk_width;
   gdouble chunk_height;
-  gdouble scale = 1.0;
+  gdouble scale;
   gint    n_rows;
   gint    n_cols;
   gint    r, c;
@@ -167,11 +168,11 @@ gimp_display_shell_draw_image (GimpDisplayShell *shell,
 
   /* multiply the image scale-factor by the window scale-factor, and divide
    * the cairo scale-factor by the same amount (further down), so that we make
-   * full use of the screen resolution, even on hidpi displays.
+   * full use of the screen resolution, even on hidpi displays.  when zoomed
+   * out, the render scale may be lower, see
+   * gimp_display_shell_render_get_scale().
    */
-  scale *= shell->render_scale;
-
-  scale *= MAX (shell->scale_x, shell->scale_y);
+  scale = gimp_display_shell_render_get_scale (shell);
 
   if (scale != shell->scale_x)
     chunk_width  = (chunk_width  - 1.0) * (shell->scale_x / scale);
@@ -250,3 +251,68 @@ gimp_display_shell_draw_image (GimpDisplayShell *shell,
         }
     }
 }
+
+/*  draws the tiles of the image fetched while not in the tile cache, in
+ *  the color of their owner, and the more opaque the more often they were
+ *  fetched.  tiles read back from swap count double.
+ */
+void
+gimp_display_shell_draw_tile_heat_map (GimpDisplayShell *shell,
+                                       cairo_t          *cr)
+{
+  static const gdouble colors[GIMP_TILE_PROFILE_N_OWNERS][3] =
+  {
+    [GIMP_TILE_PROFILE_DRAWABLE]   = { 1.0, 0.2, 0.0 },
+    [GIMP_TILE_PROFILE_PROJECTION] = { 0.0, 0.4, 1.0 },
+    [GIMP_TILE_PROFILE_UNDO]       = { 0.0, 0.8, 0.2 }
+  };
+
+  GimpImage *image;
+  GArray    *tiles;
+  gint       max_heat = 0;
+  gint       i;
+
+  g_return_if_fail (GIMP_IS_DISPLAY_SHELL (shell));
+  g_return_if_fail (cr != NULL);
+
+  image = gimp_display_get_image (shell->display);
+
+  if (! image)
+    return;
+
+  tiles = gimp_tile_profile_get_heat_map (image);
+
+  for (i = 0; i < tiles->len; i++)
+    {
+      const GimpTileProfileTile *tile;
+
+      tile = &g_array_index (tiles, GimpTileProfileTile, i);
+
+      max_heat = MAX (max_heat, tile->misses + tile->reads);
+    }
+
+  cairo_translate (cr, - shell->offset_x, - shell->offset_y);
+  cairo_scale (cr, shell->scale_x, shell->scale_y);
+
+  for (i = 0; i < tiles->len; i++)
+    {
+      const GimpTileProfileTile *tile;
+      gdouble                    heat;
+
+      tile = &g_array_index (tiles, GimpTileProfileTile, i);
+      heat = (gdouble) (tile->misses + tile->reads) / max_heat;
+
+      cairo_set_source_rgba (cr,
+                             colors[tile->owner][0],
+                             colors[tile->owner][1],
+                             colors[tile->owner][2],
+                             0.1 + 0.5 * heat);
+
+      cairo_rectangle (cr,
+                       tile->rect.x,     tile->rect.y,
+                       tile->rect.width, tile->rect.height);
+      cairo_fill (cr);
+    }
+
+  g_array_free (tiles, TRUE);
+}
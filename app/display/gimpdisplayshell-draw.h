@@ -37,3 +37,5 @@ void   gimp_display_shell_draw_image         (GimpDisplayShell   *shell,
                                               gint                y,
                                               gint                w,
                                               gint                h);
+void   gimp_display_shell_draw_tile_heat_map (GimpDisplayShell   *shell,
+                                              cairo_t            *cr);
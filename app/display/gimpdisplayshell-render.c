@@ -28,6 +28,9 @@
 
 #include "config/gimpdisplayconfig.h"
 
+#include "gegl/gimptilehandlervalidate.h"
+
+#include "core/gimp-frame-stats.h"
 #include "core/gimpimage.h"
 #include "core/gimppickable.h"
 #include "core/gimpprojectable.h"
@@ -39,10 +42,96 @@
 #include "gimpdisplayshell-profile.h"
 #include "gimpdisplayshell-render.h"
 
+#include "gimp-log.h"
+
 
 #define GIMP_DISPLAY_RENDER_ENABLE_SCALING 1
 #define GIMP_DISPLAY_RENDER_MAX_SCALE      4
 
+/*  the number of render caches kept for previous views  */
+#define GIMP_DISPLAY_RENDER_MAX_VIEWS      3
+
+#define PIXELS_PER_THREAD \
+  (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
+
+
+typedef struct
+{
+  GimpDisplayShell *shell;
+  GeglBuffer       *buffer;
+#ifdef USE_NODE_BLIT
+  GeglNode         *node;
+#endif
+  const Babl       *format;
+  gint              x;
+  gint              y;
+  gdouble           scale;
+  GeglAbyssPolicy   abyss_policy;
+  gint              filter;
+  guchar           *cairo_data;
+  gint              cairo_stride;
+  GeglBuffer       *cairo_buffer;
+  gboolean          has_filter;
+  gboolean          can_convert_to_u8;
+} RenderData;
+
+/*  the view parameters a render cache was rendered for.  the render caches
+ *  of previous views are kept along with the image-space area that was
+ *  invalidated since, so that they can be reused when switching back.
+ */
+struct _GimpRenderView
+{
+  gdouble          scale_x;
+  gdouble          scale_y;
+  gint             offset_x;
+  gint             offset_y;
+  gdouble          rotate_angle;
+  gboolean         flip_horizontally;
+  gboolean         flip_vertically;
+
+  cairo_surface_t *cache;
+  cairo_region_t  *valid;
+  cairo_region_t  *dirty;
+};
+
+
+/*  local function prototypes  */
+
+static GimpRenderView * gimp_render_view_new                (GimpDisplayShell *shell);
+static void             gimp_render_view_free               (GimpRenderView   *view);
+static gboolean         gimp_render_view_has_same_transform (GimpRenderView   *view,
+                                                             GimpDisplayShell *shell);
+
+static void   gimp_display_shell_render_shift              (GimpDisplayShell *shell,
+                                                            gint              x_offset,
+                                                            gint              y_offset);
+
+static void   gimp_display_shell_render_distribute         (const GeglRectangle            *area,
+                                                            GeglParallelDistributeAreaFunc  func,
+                                                            RenderData                     *data);
+
+static void   gimp_display_shell_render_fetch              (RenderData                     *data,
+                                                            const GeglRectangle            *area,
+                                                            const Babl                     *format,
+                                                            guchar                         *dest,
+                                                            gint                            dest_stride);
+
+static void   gimp_display_shell_render_fetch_area         (const GeglRectangle            *area,
+                                                            RenderData                     *data);
+static void   gimp_display_shell_render_convert_area       (const GeglRectangle            *area,
+                                                            RenderData                     *data);
+static void   gimp_display_shell_render_fetch_convert_area (const GeglRectangle            *area,
+                                                            RenderData                     *data);
+
+static void   gimp_display_shell_render_count_checkerboard (GeglBuffer                     *buffer,
+                                                            gint                            x,
+                                                            gint                            y,
+                                                            gint                            width,
+                                                            gint                            height,
+                                                            gdouble                         scale);
+
+
+/*  public functions  */
 
 void
 gimp_display_shell_render_set_scale (GimpDisplayShell *shell,
@@ -62,12 +151,210 @@ gimp_display_shell_render_set_scale (GimpDisplayShell *shell,
 #endif
 }
 
+/**
+ * gimp_display_shell_render_get_scale:
+ * @shell: a #GimpDisplayShell
+ *
+ * Returns the scale at which the projection is fetched for rendering
+ * @shell.  Normally, this is the display scale multiplied by the
+ * window's scale factor, making full use of the screen resolution on
+ * hidpi displays.
+ *
+ * When zoomed out on a hidpi display in low zoom quality, the
+ * projection is instead fetched at the coarsest mipmap level that still
+ * provides a pixel per window pixel, which GEGL can read directly,
+ * instead of downsampling the next finer level, and which cuts the
+ * number of fetched pixels by up to the square of the scale factor.
+ * cairo upsamples the result into the render cache.
+ *
+ * Returns: the render scale.
+ **/
+gdouble
+gimp_display_shell_render_get_scale (GimpDisplayShell *shell)
+{
+  gdouble scale;
+  gdouble render_scale;
+
+  g_return_val_if_fail (GIMP_IS_DISPLAY_SHELL (shell), 1.0);
+
+  scale        = MAX (shell->scale_x, shell->scale_y);
+  render_scale = scale * shell->render_scale;
+
+  if (shell->render_scale > 1 && render_scale < 1.0 &&
+      shell->display->config->zoom_quality != GIMP_ZOOM_QUALITY_HIGH)
+    {
+      /*  since render_scale >= 2 * scale, there's always a power of two
+       *  between the two
+       */
+      render_scale = MIN (exp2 (ceil (log2 (scale))), 1.0);
+    }
+
+  return render_scale;
+}
+
+/**
+ * gimp_display_shell_render_view_changed:
+ * @shell: a #GimpDisplayShell
+ *
+ * Invalidates the render cache after the scale, offset, rotation or
+ * flipping of @shell has changed.  Unlike
+ * gimp_display_shell_render_invalidate_full(), the render cache of the
+ * previous view is kept, and if a render cache of the new view is
+ * still around, it's reused, minus the areas that were invalidated in
+ * the meantime.
+ **/
+void
+gimp_display_shell_render_view_changed (GimpDisplayShell *shell)
+{
+  GimpRenderView *view = NULL;
+  GList          *list;
+
+  g_return_if_fail (GIMP_IS_DISPLAY_SHELL (shell));
+
+  if (shell->render_view)
+    {
+      if (gimp_render_view_has_same_transform (shell->render_view, shell) &&
+          shell->render_view->offset_x == shell->offset_x &&
+          shell->render_view->offset_y == shell->offset_y)
+        {
+          return;
+        }
+
+      /*  keep the render cache of the previous view around  */
+      if (shell->render_cache       &&
+          shell->render_cache_valid &&
+          ! cairo_region_is_empty (shell->render_cache_valid))
+        {
+          view = g_steal_pointer (&shell->render_view);
+
+          view->cache = g_steal_pointer (&shell->render_cache);
+          view->valid = g_steal_pointer (&shell->render_cache_valid);
+          view->dirty = cairo_region_create ();
+
+          shell->render_views = g_list_prepend (shell->render_views, view);
+
+          while (g_list_length (shell->render_views) >
+                 GIMP_DISPLAY_RENDER_MAX_VIEWS)
+            {
+              list = g_list_last (shell->render_views);
+
+              gimp_render_view_free (list->data);
+              shell->render_views = g_list_delete_link (shell->render_views,
+                                                        list);
+            }
+
+          view = NULL;
+        }
+    }
+
+  g_clear_pointer (&shell->render_view, gimp_render_view_free);
+  g_clear_pointer (&shell->render_cache_valid, cairo_region_destroy);
+
+  /*  look for a render cache of the new view  */
+  for (list = shell->render_views; list; list = g_list_next (list))
+    {
+      if (gimp_render_view_has_same_transform (list->data, shell))
+        {
+          view = list->data;
+
+          shell->render_views = g_list_delete_link (shell->render_views,
+                                                    list);
+          break;
+        }
+    }
+
+  if (view)
+    {
+      if (cairo_image_surface_get_width  (view->cache) ==
+          shell->disp_width  * shell->render_scale &&
+          cairo_image_surface_get_height (view->cache) ==
+          shell->disp_height * shell->render_scale)
+        {
+          gint n_rects;
+          gint i;
+
+          g_clear_pointer (&shell->render_cache, cairo_surface_destroy);
+
+          shell->render_cache       = g_steal_pointer (&view->cache);
+          shell->render_cache_valid = g_steal_pointer (&view->valid);
+
+          /*  if only the offset differs, the cache can be shifted into
+           *  place, like when scrolling
+           */
+          gimp_display_shell_render_shift (shell,
+                                           shell->offset_x - view->offset_x,
+                                           shell->offset_y - view->offset_y);
+
+          /*  drop what was invalidated while the view wasn't current  */
+          n_rects = cairo_region_num_rectangles (view->dirty);
+
+          for (i = 0; i < n_rects; i++)
+            {
+              cairo_rectangle_int_t rect;
+              gdouble               x1, y1, x2, y2;
+
+              cairo_region_get_rectangle (view->dirty, i, &rect);
+
+              gimp_display_shell_transform_bounds (shell,
+                                                   rect.x,
+                                                   rect.y,
+                                                   rect.x + rect.width,
+                                                   rect.y + rect.height,
+                                                   &x1, &y1, &x2, &y2);
+
+              rect.x      = floor (x1 - 0.5);
+              rect.y      = floor (y1 - 0.5);
+              rect.width  = ceil (x2 + 0.5) - rect.x;
+              rect.height = ceil (y2 + 0.5) - rect.y;
+
+              cairo_region_subtract_rectangle (shell->render_cache_valid,
+                                               &rect);
+            }
+        }
+
+      gimp_render_view_free (view);
+    }
+
+  shell->render_view = gimp_render_view_new (shell);
+}
+
+/**
+ * gimp_display_shell_render_scroll:
+ * @shell:    a #GimpDisplayShell
+ * @x_offset: horizontal change of the scroll offset
+ * @y_offset: vertical change of the scroll offset
+ *
+ * Shifts the render cache after @shell has been scrolled, so that only
+ * the newly scrolled-in parts need to be rendered.
+ **/
+void
+gimp_display_shell_render_scroll (GimpDisplayShell *shell,
+                                  gint              x_offset,
+                                  gint              y_offset)
+{
+  g_return_if_fail (GIMP_IS_DISPLAY_SHELL (shell));
+
+  gimp_display_shell_render_shift (shell, x_offset, y_offset);
+
+  if (shell->render_view)
+    {
+      shell->render_view->offset_x = shell->offset_x;
+      shell->render_view->offset_y = shell->offset_y;
+    }
+}
+
 void
 gimp_display_shell_render_invalidate_full (GimpDisplayShell *shell)
 {
   g_return_if_fail (GIMP_IS_DISPLAY_SHELL (shell));
 
   g_clear_pointer (&shell->render_cache_valid, cairo_region_destroy);
+
+  g_clear_pointer (&shell->render_view, gimp_render_view_free);
+
+  g_list_free_full (shell->render_views,
+                    (GDestroyNotify) gimp_render_view_free);
+  shell->render_views = NULL;
 }
 
 void
@@ -90,6 +377,32 @@ gimp_display_shell_render_invalidate_area (GimpDisplayShell *shell,
 
       cairo_region_subtract_rectangle (shell->render_cache_valid, &rect);
     }
+
+  if (shell->render_views)
+    {
+      cairo_rectangle_int_t rect;
+      gdouble               x1, y1, x2, y2;
+      GList                *list;
+
+      /*  the render caches of the previous views are invalidated in
+       *  image space, since they have a different transform
+       */
+      gimp_display_shell_untransform_bounds (shell,
+                                             x, y, x + width, y + height,
+                                             &x1, &y1, &x2, &y2);
+
+      rect.x      = floor (x1);
+      rect.y      = floor (y1);
+      rect.width  = ceil (x2) - rect.x;
+      rect.height = ceil (y2) - rect.y;
+
+      for (list = shell->render_views; list; list = g_list_next (list))
+        {
+          GimpRenderView *view = list->data;
+
+          cairo_region_union_rectangle (view->dirty, &rect);
+        }
+    }
 }
 
 void
@@ -155,6 +468,8 @@ gimp_display_shell_render (GimpDisplayShell *shell,
 #ifdef USE_NODE_BLIT
   GeglNode          *node;
 #endif
+  RenderData         data;
+  GeglRectangle      area;
 
   cairo_t           *my_cr;
   gint               cairo_stride;
@@ -167,11 +482,15 @@ gimp_display_shell_render (GimpDisplayShell *shell,
   gint               height;
   GeglAbyssPolicy    abyss_policy;
   gint               filter = GEGL_BUFFER_FILTER_AUTO;
+  gint64             start_time;
+  GIMP_TRACE_SPAN (span);
 
   g_return_if_fail (GIMP_IS_DISPLAY_SHELL (shell));
   g_return_if_fail (cr != NULL);
   g_return_if_fail (scale > 0.0);
 
+  start_time = g_get_monotonic_time ();
+
   /* map chunk from screen space to scaled image space */
   gimp_display_shell_untransform_bounds_with_scale (shell, scale,
                                                     tx, ty,
@@ -214,8 +533,13 @@ gimp_display_shell_render (GimpDisplayShell *shell,
    */
   g_return_if_fail (! gimp_image_get_converting (image));
 
+  GIMP_TRACE_BEGIN (span, "display-render");
+
   buffer = gimp_pickable_get_buffer (
     gimp_display_shell_get_pickable (shell));
+
+  gimp_display_shell_render_count_checkerboard (buffer,
+                                                x, y, width, height, scale);
 #ifdef USE_NODE_BLIT
   node   = gimp_projectable_get_graph (GIMP_PROJECTABLE (image));
 
@@ -247,6 +571,11 @@ gimp_display_shell_render (GimpDisplayShell *shell,
       shell->render_cache_valid = cairo_region_create ();
     }
 
+  if (! shell->render_view)
+    {
+      shell->render_view = gimp_render_view_new (shell);
+    }
+
   my_cr = cairo_create (shell->render_cache);
 
   /* clip to chunk bounds, in screen space */
@@ -260,24 +589,39 @@ gimp_display_shell_render (GimpDisplayShell *shell,
   cairo_translate (my_cr, -shell->offset_x, -shell->offset_y);
   cairo_scale (my_cr, shell->scale_x / scale, shell->scale_y / scale);
 
-  cairo_stride = cairo_image_surface_get_stride (shell->render_surface);
-  cairo_data   = cairo_image_surface_get_data (shell->render_surface);
-
-  if (shell->profile_transform ||
-      gimp_display_shell_has_filter (shell))
+  data.shell        = shell;
+  data.buffer       = buffer;
+#ifdef USE_NODE_BLIT
+  data.node         = node;
+#endif
+  data.format       = gimp_projectable_get_format (GIMP_PROJECTABLE (image));
+  data.x            = x;
+  data.y            = y;
+  data.scale        = scale;
+  data.abyss_policy = abyss_policy;
+  data.filter       = filter;
+  data.cairo_stride = cairo_image_surface_get_stride (shell->render_surface);
+  data.cairo_data   = cairo_image_surface_get_data (shell->render_surface);
+  data.cairo_buffer = NULL;
+  data.has_filter   = gimp_display_shell_has_filter (shell);
+
+  data.can_convert_to_u8 = TRUE;
+
+  gegl_rectangle_set (&area, 0, 0, width, height);
+
+  if (shell->profile_transform || data.has_filter)
     {
-      gboolean can_convert_to_u8;
-
       /*  if there is a profile transform or a display filter, we need
        *  to use temp buffers
        */
 
-      can_convert_to_u8 = gimp_display_shell_profile_can_convert_to_u8 (shell);
+      data.can_convert_to_u8 =
+        gimp_display_shell_profile_can_convert_to_u8 (shell);
 
       /*  create the filter buffer if we have filters, or can't convert
        *  to u8 directly
        */
-      if ((gimp_display_shell_has_filter (shell) || ! can_convert_to_u8) &&
+      if ((data.has_filter || ! data.can_convert_to_u8) &&
           ! shell->filter_buffer)
         {
           gint fw = shell->render_buf_width;
@@ -299,66 +643,32 @@ gimp_display_shell_render (GimpDisplayShell *shell,
                                               shell->filter_data);
         }
 
-      if (! gimp_display_shell_has_filter (shell) || shell->filter_transform)
+      if (shell->profile_transform &&
+          ! data.has_filter    &&
+          data.can_convert_to_u8)
         {
-          /*  if there are no filters, or there is a filter transform,
-           *  load the projection pixels into the profile_buffer
-           */
-#ifndef USE_NODE_BLIT
-          gegl_buffer_get (buffer,
-                           GEGL_RECTANGLE (x, y, width, height), scale,
-                           gimp_projectable_get_format (GIMP_PROJECTABLE (image)),
-                           shell->profile_data, shell->profile_stride,
-                           abyss_policy | filter);
-#else
-          gegl_node_blit (node,
-                          scale, GEGL_RECTANGLE (x, y, width, height),
-                          gimp_projectable_get_format (GIMP_PROJECTABLE (image)),
-                          shell->profile_data, shell->profile_stride,
-                          GEGL_BLIT_CACHE | filter);
-#endif
-        }
-      else
-        {
-          /*  otherwise, load the pixels directly into the filter_buffer
-           */
-#ifndef USE_NODE_BLIT
-          gegl_buffer_get (buffer,
-                           GEGL_RECTANGLE (x, y, width, height), scale,
-                           shell->filter_format,
-                           shell->filter_data, shell->filter_stride,
-                           abyss_policy | filter);
-#else
-          gegl_node_blit (node,
-                          scale, GEGL_RECTANGLE (x, y, width, height),
-                          shell->filter_format,
-                          shell->filter_data, shell->filter_stride,
-                          GEGL_BLIT_CACHE | filter);
-#endif
+          data.cairo_buffer =
+            gegl_buffer_linear_new_from_data (data.cairo_data,
+                                              babl_format ("cairo-ARGB32"),
+                                              &area,
+                                              data.cairo_stride,
+                                              NULL, NULL);
         }
 
-      /*  if there is a filter transform, convert the pixels from
-       *  the profile_buffer to the filter_buffer
-       */
-      if (shell->filter_transform)
-        {
-          gimp_color_transform_process_buffer (shell->filter_transform,
-                                               shell->profile_buffer,
-                                               GEGL_RECTANGLE (0, 0,
-                                                               width, height),
-                                               shell->filter_buffer,
-                                               GEGL_RECTANGLE (0, 0,
-                                                               width, height));
-        }
-
-      /*  if there are filters, apply them
-       */
-      if (gimp_display_shell_has_filter (shell))
+      if (data.has_filter)
         {
           GeglBuffer *filter_buffer;
 
-          /*  shift the filter_buffer so that the area passed to
-           *  the filters is the real render area, allowing for
+          gimp_display_shell_render_distribute (
+            &area,
+            (GeglParallelDistributeAreaFunc) gimp_display_shell_render_fetch_area,
+            &data);
+
+          /*  the display filters are run on the main thread, on the whole
+           *  chunk at once, since they are not required to be thread-safe.
+           *
+           *  shift the filter_buffer so that the area passed to the
+           *  filters is the real render area, allowing for
            *  position-dependent filters
            */
           filter_buffer = g_object_new (GEGL_TYPE_BUFFER,
@@ -375,92 +685,31 @@ gimp_display_shell_render (GimpDisplayShell *shell,
                                                                    width, height));
 
           g_object_unref (filter_buffer);
-        }
 
-      /*  if there is a profile transform...
-       */
-      if (shell->profile_transform)
-        {
-          if (gimp_display_shell_has_filter (shell))
-            {
-              /*  if we have filters, convert the pixels in the filter_buffer
-               *  in-place
-               */
-              gimp_color_transform_process_buffer (shell->profile_transform,
-                                                   shell->filter_buffer,
-                                                   GEGL_RECTANGLE (0, 0,
-                                                                   width, height),
-                                                   shell->filter_buffer,
-                                                   GEGL_RECTANGLE (0, 0,
-                                                                   width, height));
-            }
-          else if (! can_convert_to_u8)
-            {
-              /*  otherwise, if we can't convert to u8 directly, convert
-               *  the pixels from the profile_buffer to the filter_buffer
-               */
-              gimp_color_transform_process_buffer (shell->profile_transform,
-                                                   shell->profile_buffer,
-                                                   GEGL_RECTANGLE (0, 0,
-                                                                   width, height),
-                                                   shell->filter_buffer,
-                                                   GEGL_RECTANGLE (0, 0,
-                                                                   width, height));
-            }
-          else
-            {
-              GeglBuffer *buffer =
-                gegl_buffer_linear_new_from_data (cairo_data,
-                                                  babl_format ("cairo-ARGB32"),
-                                                  GEGL_RECTANGLE (0, 0,
-                                                                  width, height),
-                                                  cairo_stride,
-                                                  NULL, NULL);
-
-              /*  otherwise, convert the profile_buffer directly into
-               *  the cairo_buffer
-               */
-              gimp_color_transform_process_buffer (shell->profile_transform,
-                                                   shell->profile_buffer,
-                                                   GEGL_RECTANGLE (0, 0,
-                                                                   width, height),
-                                                   buffer,
-                                                   GEGL_RECTANGLE (0, 0,
-                                                                   width, height));
-              g_object_unref (buffer);
-            }
+          gimp_display_shell_render_distribute (
+            &area,
+            (GeglParallelDistributeAreaFunc) gimp_display_shell_render_convert_area,
+            &data);
         }
-
-      /*  finally, copy the filter buffer to the cairo-ARGB32 buffer,
-       *  if necessary
-       */
-      if (gimp_display_shell_has_filter (shell) || ! can_convert_to_u8)
+      else
         {
-          gegl_buffer_get (shell->filter_buffer,
-                           GEGL_RECTANGLE (0, 0, width, height), 1.0,
-                           babl_format ("cairo-ARGB32"),
-                           cairo_data, cairo_stride,
-                           GEGL_ABYSS_NONE);
+          gimp_display_shell_render_distribute (
+            &area,
+            (GeglParallelDistributeAreaFunc) gimp_display_shell_render_fetch_convert_area,
+            &data);
         }
+
+      g_clear_object (&data.cairo_buffer);
     }
   else
     {
       /*  otherwise we can copy the projection pixels straight to the
        *  cairo-ARGB32 buffer
        */
-#ifndef USE_NODE_BLIT
-      gegl_buffer_get (buffer,
-                       GEGL_RECTANGLE (x, y, width, height), scale,
-                       babl_format ("cairo-ARGB32"),
-                       cairo_data, cairo_stride,
-                       abyss_policy | filter);
-#else
-      gegl_node_blit (node,
-                      scale, GEGL_RECTANGLE (x, y, width, height),
-                      babl_format ("cairo-ARGB32"),
-                      cairo_data, cairo_stride,
-                      GEGL_BLIT_CACHE | filter);
-#endif
+      gimp_display_shell_render_distribute (
+        &area,
+        (GeglParallelDistributeAreaFunc) gimp_display_shell_render_fetch_area,
+        &data);
     }
 
 #ifdef USE_NODE_BLIT
@@ -473,6 +722,18 @@ gimp_display_shell_render (GimpDisplayShell *shell,
   cairo_set_operator (my_cr, CAIRO_OPERATOR_SOURCE);
 
   cairo_set_source_surface (my_cr, shell->render_surface, x, y);
+
+  /*  when the canvas is rotated, cairo resamples the chunk bilinearly,
+   *  which dominates the cost of presenting it.  in low zoom quality,
+   *  the pixels were fetched with nearest-neighbor filtering already,
+   *  so do the same here.
+   */
+  if (shell->rotate_transform &&
+      display_config->zoom_quality != GIMP_ZOOM_QUALITY_HIGH)
+    {
+      cairo_pattern_set_filter (cairo_get_source (my_cr), CAIRO_FILTER_FAST);
+    }
+
   cairo_paint (my_cr);
 
   cairo_set_operator (my_cr, CAIRO_OPERATOR_OVER);
@@ -530,4 +791,335 @@ gimp_display_shell_render (GimpDisplayShell *shell,
     }
 
   cairo_destroy (my_cr);
+
+  GIMP_TRACE_END (span);
+
+  gimp_frame_stats_add_render (g_get_monotonic_time () - start_time);
+}
+
+
+/*  private functions  */
+
+static GimpRenderView *
+gimp_render_view_new (GimpDisplayShell *shell)
+{
+  GimpRenderView *view = g_slice_new0 (GimpRenderView);
+
+  view->scale_x           = shell->scale_x;
+  view->scale_y           = shell->scale_y;
+  view->offset_x          = shell->offset_x;
+  view->offset_y          = shell->offset_y;
+  view->rotate_angle      = shell->rotate_angle;
+  view->flip_horizontally = shell->flip_horizontally;
+  view->flip_vertically   = shell->flip_vertically;
+
+  return view;
+}
+
+static void
+gimp_render_view_free (GimpRenderView *view)
+{
+  g_clear_pointer (&view->cache, cairo_surface_destroy);
+  g_clear_pointer (&view->valid, cairo_region_destroy);
+  g_clear_pointer (&view->dirty, cairo_region_destroy);
+
+  g_slice_free (GimpRenderView, view);
+}
+
+static gboolean
+gimp_render_view_has_same_transform (GimpRenderView   *view,
+                                     GimpDisplayShell *shell)
+{
+  return view->scale_x           == shell->scale_x           &&
+         view->scale_y           == shell->scale_y           &&
+         view->rotate_angle      == shell->rotate_angle      &&
+         view->flip_horizontally == shell->flip_horizontally &&
+         view->flip_vertically   == shell->flip_vertically;
+}
+
+static void
+gimp_display_shell_render_shift (GimpDisplayShell *shell,
+                                 gint              x_offset,
+                                 gint              y_offset)
+{
+  if (x_offset == 0 && y_offset == 0)
+    return;
+
+  if (shell->render_cache)
+    {
+      cairo_surface_t *surface;
+      cairo_t         *cr;
+      gint             width  = shell->disp_width  * shell->render_scale;
+      gint             height = shell->disp_height * shell->render_scale;
+
+      /*  shift the render cache into its spare copy, and swap the
+       *  two, instead of allocating a new display-sized surface and
+       *  copying all of it twice on each scroll step.
+       */
+      if (shell->render_cache_back &&
+          (cairo_image_surface_get_width  (shell->render_cache_back) != width ||
+           cairo_image_surface_get_height (shell->render_cache_back) != height))
+        {
+          g_clear_pointer (&shell->render_cache_back, cairo_surface_destroy);
+        }
+
+      surface = shell->render_cache_back;
+
+      if (! surface)
+        {
+          surface = cairo_surface_create_similar_image (
+            shell->render_cache,
+            CAIRO_FORMAT_ARGB32,
+            width, height);
+        }
+
+      cr = cairo_create (surface);
+
+      /*  only the part which is still visible needs to be copied, the
+       *  rest is invalidated below
+       */
+      cairo_rectangle (cr,
+                       -x_offset * shell->render_scale,
+                       -y_offset * shell->render_scale,
+                       width, height);
+      cairo_clip (cr);
+
+      cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+      cairo_set_source_surface (cr, shell->render_cache,
+                                -x_offset * shell->render_scale,
+                                -y_offset * shell->render_scale);
+      cairo_paint (cr);
+      cairo_destroy (cr);
+
+      shell->render_cache_back = shell->render_cache;
+      shell->render_cache      = surface;
+    }
+
+  if (shell->render_cache_valid)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_translate (shell->render_cache_valid,
+                              -x_offset, -y_offset);
+
+      rect.x      = 0;
+      rect.y      = 0;
+      rect.width  = shell->disp_width;
+      rect.height = shell->disp_height;
+
+      cairo_region_intersect_rectangle (shell->render_cache_valid, &rect);
+    }
+}
+
+static void
+gimp_display_shell_render_distribute (const GeglRectangle            *area,
+                                      GeglParallelDistributeAreaFunc  func,
+                                      RenderData                     *data)
+{
+#ifndef USE_NODE_BLIT
+  gegl_parallel_distribute_area (area, PIXELS_PER_THREAD,
+                                 GEGL_SPLIT_STRATEGY_AUTO,
+                                 func, data);
+#else
+  /*  the projectable's graph can't be blitted from multiple threads  */
+  func (area, data);
+#endif
+}
+
+static void
+gimp_display_shell_render_fetch (RenderData          *data,
+                                 const GeglRectangle *area,
+                                 const Babl          *format,
+                                 guchar              *dest,
+                                 gint                 dest_stride)
+{
+  dest += area->y * dest_stride +
+          area->x * babl_format_get_bytes_per_pixel (format);
+
+#ifndef USE_NODE_BLIT
+  /*  show the coarse preview of slow projection updates, where there is
+   *  one, instead of validating the tiles here
+   */
+  gimp_tile_handler_validate_begin_preview ();
+
+  gegl_buffer_get (data->buffer,
+                   GEGL_RECTANGLE (data->x + area->x, data->y + area->y,
+                                   area->width, area->height),
+                   data->scale,
+                   format, dest, dest_stride,
+                   data->abyss_policy | data->filter);
+
+  gimp_tile_handler_validate_end_preview ();
+#else
+  gegl_node_blit (data->node,
+                  data->scale,
+                  GEGL_RECTANGLE (data->x + area->x, data->y + area->y,
+                                  area->width, area->height),
+                  format, dest, dest_stride,
+                  GEGL_BLIT_CACHE | data->filter);
+#endif
+}
+
+/*  fetches the projection pixels of @area of the chunk, and applies the
+ *  filter transform, if any.  called on worker threads.
+ */
+static void
+gimp_display_shell_render_fetch_area (const GeglRectangle *area,
+                                      RenderData          *data)
+{
+  GimpDisplayShell *shell = data->shell;
+
+  if (! shell->profile_transform && ! data->has_filter)
+    {
+      /*  copy the projection pixels straight to the cairo-ARGB32 buffer
+       */
+      gimp_display_shell_render_fetch (data, area,
+                                       babl_format ("cairo-ARGB32"),
+                                       data->cairo_data, data->cairo_stride);
+    }
+  else if (! data->has_filter || shell->filter_transform)
+    {
+      /*  if there are no filters, or there is a filter transform,
+       *  load the projection pixels into the profile_buffer
+       */
+      gimp_display_shell_render_fetch (data, area,
+                                       data->format,
+                                       shell->profile_data,
+                                       shell->profile_stride);
+
+      /*  if there is a filter transform, convert the pixels from
+       *  the profile_buffer to the filter_buffer
+       */
+      if (shell->filter_transform)
+        {
+          gimp_color_transform_process_buffer (shell->filter_transform,
+                                               shell->profile_buffer,
+                                               area,
+                                               shell->filter_buffer,
+                                               area);
+        }
+    }
+  else
+    {
+      /*  otherwise, load the pixels directly into the filter_buffer
+       */
+      gimp_display_shell_render_fetch (data, area,
+                                       shell->filter_format,
+                                       shell->filter_data,
+                                       shell->filter_stride);
+    }
+}
+
+/*  applies the profile transform to @area of the chunk, and converts it
+ *  to the cairo-ARGB32 buffer.  called on worker threads.
+ */
+static void
+gimp_display_shell_render_convert_area (const GeglRectangle *area,
+                                        RenderData          *data)
+{
+  GimpDisplayShell *shell = data->shell;
+
+  if (shell->profile_transform)
+    {
+      if (data->has_filter)
+        {
+          /*  if we have filters, convert the pixels in the filter_buffer
+           *  in-place
+           */
+          gimp_color_transform_process_buffer (shell->profile_transform,
+                                               shell->filter_buffer,
+                                               area,
+                                               shell->filter_buffer,
+                                               area);
+        }
+      else if (! data->can_convert_to_u8)
+        {
+          /*  otherwise, if we can't convert to u8 directly, convert
+           *  the pixels from the profile_buffer to the filter_buffer
+           */
+          gimp_color_transform_process_buffer (shell->profile_transform,
+                                               shell->profile_buffer,
+                                               area,
+                                               shell->filter_buffer,
+                                               area);
+        }
+      else
+        {
+          /*  otherwise, convert the profile_buffer directly into
+           *  the cairo_buffer
+           */
+          gimp_color_transform_process_buffer (shell->profile_transform,
+                                               shell->profile_buffer,
+                                               area,
+                                               data->cairo_buffer,
+                                               area);
+        }
+    }
+
+  /*  finally, copy the filter buffer to the cairo-ARGB32 buffer,
+   *  if necessary
+   */
+  if (data->has_filter || ! data->can_convert_to_u8)
+    {
+      gegl_buffer_get (shell->filter_buffer,
+                       area, 1.0,
+                       babl_format ("cairo-ARGB32"),
+                       data->cairo_data +
+                       area->y * data->cairo_stride + area->x * 4,
+                       data->cairo_stride,
+                       GEGL_ABYSS_NONE);
+    }
+}
+
+static void
+gimp_display_shell_render_fetch_convert_area (const GeglRectangle *area,
+                                              RenderData          *data)
+{
+  gimp_display_shell_render_fetch_area   (area, data);
+  gimp_display_shell_render_convert_area (area, data);
+}
+
+/*  count the area of the chunk whose pixels are not rendered yet, in
+ *  scaled image pixels, for the dashboard
+ */
+static void
+gimp_display_shell_render_count_checkerboard (GeglBuffer *buffer,
+                                              gint        x,
+                                              gint        y,
+                                              gint        width,
+                                              gint        height,
+                                              gdouble     scale)
+{
+  GimpTileHandlerValidate *validate;
+  cairo_region_t          *region;
+  cairo_rectangle_int_t    rect;
+  gdouble                  area = 0.0;
+  gint                     n_rects;
+  gint                     i;
+
+  validate = gimp_tile_handler_validate_get_assigned (buffer);
+
+  if (! validate || cairo_region_is_empty (validate->dirty_region))
+    return;
+
+  rect.x      = floor (x / scale);
+  rect.y      = floor (y / scale);
+  rect.width  = ceil ((x + width)  / scale) - rect.x;
+  rect.height = ceil ((y + height) / scale) - rect.y;
+
+  region = cairo_region_copy (validate->dirty_region);
+  cairo_region_intersect_rectangle (region, &rect);
+
+  n_rects = cairo_region_num_rectangles (region);
+
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_region_get_rectangle (region, i, &rect);
+
+      area += (gdouble) rect.width * rect.height;
+    }
+
+  cairo_region_destroy (region);
+
+  gimp_frame_stats_add_checkerboard (area * scale * scale);
 }
@@ -21,6 +21,13 @@
 void     gimp_display_shell_render_set_scale       (GimpDisplayShell *shell,
                                                     gint              scale);
 
+gdouble  gimp_display_shell_render_get_scale       (GimpDisplayShell *shell);
+
+void     gimp_display_shell_render_view_changed    (GimpDisplayShell *shell);
+void     gimp_display_shell_render_scroll          (GimpDisplayShell *shell,
+                                                    gint              x_offset,
+                                                    gint              y_offset);
+
 void     gimp_display_shell_render_invalidate_full (GimpDisplayShell *shell);
 void     gimp_display_shell_render_invalidate_area (GimpDisplayShell *shell,
                                                     gint              x,
@@ -0,0 +1,1051 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpdisplayshell-replay.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Records the tool events of a display, and the procedures run from the
+ * menus while recording, to a text file, and replays such a file on a
+ * display, timing each phase of the session: each stroke (from button
+ * press to release), each run of scroll events, and each procedure.
+ *
+ * The recording is a list of lines, split like shell arguments:
+ *
+ *   version 1
+ *   view <scale> <offset-x> <offset-y> <angle> <flip-h> <flip-v> <w> <h>
+ *   event <ms> <type> <x> <y> <state> <button|keyval> [<dir> <dx> <dy>]
+ *   procedure <ms> <run-mode> <name> <arg>...
+ *
+ * where event coordinates are canvas coordinates, relative to the view
+ * the recording started with, which is restored before replaying.
+ * Procedure arguments are "i:", "d:", "b:", "e:", "s:" and "c:" (a
+ * serialized config object) prefixed values, "image" and "drawables"
+ * for the display's image and its selected drawables, and "default" for
+ * anything else.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <gegl.h>
+#include <gtk/gtk.h>
+
+#include "libgimpbase/gimpbase.h"
+#include "libgimpconfig/gimpconfig.h"
+#include "libgimpwidgets/gimpwidgets.h"
+
+#include "display-types.h"
+
+#include "core/gimp.h"
+#include "core/gimpcontext.h"
+#include "core/gimpdrawable.h"
+#include "core/gimperror.h"
+#include "core/gimpimage.h"
+#include "core/gimpparamspecs.h"
+#include "core/gimpprogress.h"
+#include "core/gimpprojection.h"
+
+#include "pdb/gimppdb.h"
+#include "pdb/gimpprocedure.h"
+
+#include "widgets/gimpdashboard.h"
+#include "widgets/gimpdialogfactory.h"
+
+#include "gimpdisplay.h"
+#include "gimpdisplayshell.h"
+#include "gimpdisplayshell-replay.h"
+#include "gimpdisplayshell-rotate.h"
+#include "gimpdisplayshell-scale.h"
+#include "gimpdisplayshell-scroll.h"
+#include "gimpdisplayshell-tool-events.h"
+
+#include "gimp-intl.h"
+
+
+#define RECORDING_VERSION 1
+
+
+typedef enum
+{
+  PHASE_NONE,
+  PHASE_STROKE,
+  PHASE_SCROLL,
+  PHASE_PROCEDURE
+} ReplayPhaseType;
+
+typedef struct
+{
+  GimpDisplayShell *shell;
+  GOutputStream    *output;
+  gint64            start_time;
+} Recorder;
+
+typedef struct
+{
+  GimpDisplayShell *shell;
+  ReplayPhaseType   type;
+  gint              n_phases;
+  gint              n_events;
+  gchar            *name;
+  gint64            start_time;
+  gdouble           total;
+} Replay;
+
+
+/*  local function prototypes  */
+
+static void             gimp_display_shell_record_line      (const gchar       *first,
+                                                             ...) G_GNUC_NULL_TERMINATED;
+static void             gimp_display_shell_record_strv      (gchar            **strv);
+static gchar          * gimp_display_shell_record_time      (void);
+static gchar          * gimp_display_shell_record_double    (gdouble            value);
+static gchar          * gimp_display_shell_record_value     (GParamSpec        *pspec,
+                                                             const GValue      *value);
+
+static gboolean         gimp_display_shell_replay_line      (Replay            *replay,
+                                                             gchar            **argv,
+                                                             gint               argc,
+                                                             GError           **error);
+static gboolean         gimp_display_shell_replay_view      (Replay            *replay,
+                                                             gchar            **argv,
+                                                             gint               argc,
+                                                             GError           **error);
+static gboolean         gimp_display_shell_replay_event     (Replay            *replay,
+                                                             gchar            **argv,
+                                                             gint               argc,
+                                                             GError           **error);
+static gboolean         gimp_display_shell_replay_procedure (Replay            *replay,
+                                                             gchar            **argv,
+                                                             gint               argc,
+                                                             GError           **error);
+static gboolean         gimp_display_shell_replay_value     (Replay            *replay,
+                                                             GParamSpec        *pspec,
+                                                             const gchar       *str,
+                                                             GValue            *value);
+
+static void             gimp_display_shell_replay_begin     (Replay            *replay,
+                                                             ReplayPhaseType    type,
+                                                             const gchar       *name);
+static void             gimp_display_shell_replay_end       (Replay            *replay);
+static void             gimp_display_shell_replay_settle    (Replay            *replay);
+static GimpDashboard  * gimp_display_shell_replay_dashboard (void);
+
+
+/*  there is only ever one recording  */
+static Recorder recorder = { NULL, };
+
+
+/*  public functions  */
+
+gboolean
+gimp_display_shell_record_start (GimpDisplayShell  *shell,
+                                 GFile             *file,
+                                 GError           **error)
+{
+  GOutputStream *output;
+  gchar         *version;
+  gchar         *view[8];
+  gint           width;
+  gint           height;
+  gint           i;
+
+  g_return_val_if_fail (GIMP_IS_DISPLAY_SHELL (shell), FALSE);
+  g_return_val_if_fail (G_IS_FILE (file), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  gimp_display_shell_record_stop ();
+
+  output = G_OUTPUT_STREAM (g_file_replace (file,
+                                            NULL, FALSE, G_FILE_CREATE_NONE,
+                                            NULL, error));
+  if (! output)
+    return FALSE;
+
+  recorder.shell      = shell;
+  recorder.output     = output;
+  recorder.start_time = g_get_monotonic_time ();
+
+  g_object_add_weak_pointer (G_OBJECT (shell), (gpointer) &recorder.shell);
+
+  width  = gtk_widget_get_allocated_width  (shell->canvas);
+  height = gtk_widget_get_allocated_height (shell->canvas);
+
+  version = g_strdup_printf ("%d", RECORDING_VERSION);
+  gimp_display_shell_record_line ("version", version, NULL);
+  g_free (version);
+
+  view[0] = gimp_display_shell_record_double (
+              gimp_zoom_model_get_factor (shell->zoom));
+  view[1] = g_strdup_printf ("%d", shell->offset_x);
+  view[2] = g_strdup_printf ("%d", shell->offset_y);
+  view[3] = gimp_display_shell_record_double (shell->rotate_angle);
+  view[4] = g_strdup_printf ("%d", shell->flip_horizontally ? 1 : 0);
+  view[5] = g_strdup_printf ("%d", shell->flip_vertically   ? 1 : 0);
+  view[6] = g_strdup_printf ("%d", width);
+  view[7] = g_strdup_printf ("%d", height);
+
+  gimp_display_shell_record_line ("view",
+                                  view[0], view[1], view[2], view[3],
+                                  view[4], view[5], view[6], view[7],
+                                  NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (view); i++)
+    g_free (view[i]);
+
+  return TRUE;
+}
+
+void
+gimp_display_shell_record_stop (void)
+{
+  if (recorder.shell)
+    g_object_remove_weak_pointer (G_OBJECT (recorder.shell),
+                                  (gpointer) &recorder.shell);
+
+  if (recorder.output)
+    {
+      g_output_stream_close (recorder.output, NULL, NULL);
+      g_object_unref (recorder.output);
+    }
+
+  recorder.shell  = NULL;
+  recorder.output = NULL;
+}
+
+gboolean
+gimp_display_shell_is_recording (GimpDisplayShell *shell)
+{
+  g_return_val_if_fail (shell == NULL || GIMP_IS_DISPLAY_SHELL (shell),
+                        FALSE);
+
+  if (! recorder.output)
+    return FALSE;
+
+  return shell == NULL || shell == recorder.shell;
+}
+
+void
+gimp_display_shell_record_event (GimpDisplayShell *shell,
+                                 const GdkEvent   *event)
+{
+  gchar *strv[11] = { NULL, };
+  gint   n        = 0;
+  gint   i;
+
+  g_return_if_fail (GIMP_IS_DISPLAY_SHELL (shell));
+  g_return_if_fail (event != NULL);
+
+  if (! recorder.output || shell != recorder.shell)
+    return;
+
+  /*  don't record what we are replaying  */
+  if (event->any.send_event)
+    return;
+
+  strv[n++] = g_strdup ("event");
+  strv[n++] = gimp_display_shell_record_time ();
+
+  switch (event->type)
+    {
+    case GDK_BUTTON_PRESS:
+    case GDK_BUTTON_RELEASE:
+      {
+        const GdkEventButton *bevent = (const GdkEventButton *) event;
+
+        strv[n++] = g_strdup (event->type == GDK_BUTTON_PRESS ?
+                              "button-press" : "button-release");
+        strv[n++] = gimp_display_shell_record_double (bevent->x);
+        strv[n++] = gimp_display_shell_record_double (bevent->y);
+        strv[n++] = g_strdup_printf ("%u", bevent->state);
+        strv[n++] = g_strdup_printf ("%u", bevent->button);
+      }
+      break;
+
+    case GDK_MOTION_NOTIFY:
+      {
+        const GdkEventMotion *mevent = (const GdkEventMotion *) event;
+
+        strv[n++] = g_strdup ("motion");
+        strv[n++] = gimp_display_shell_record_double (mevent->x);
+        strv[n++] = gimp_display_shell_record_double (mevent->y);
+        strv[n++] = g_strdup_printf ("%u", mevent->state);
+        strv[n++] = g_strdup ("0");
+      }
+      break;
+
+    case GDK_SCROLL:
+      {
+        const GdkEventScroll *sevent = (const GdkEventScroll *) event;
+
+        strv[n++] = g_strdup ("scroll");
+        strv[n++] = gimp_display_shell_record_double (sevent->x);
+        strv[n++] = gimp_display_shell_record_double (sevent->y);
+        strv[n++] = g_strdup_printf ("%u", sevent->state);
+        strv[n++] = g_strdup ("0");
+        strv[n++] = g_strdup_printf ("%d", sevent->direction);
+        strv[n++] = gimp_display_shell_record_double (sevent->delta_x);
+        strv[n++] = gimp_display_shell_record_double (sevent->delta_y);
+      }
+      break;
+
+    case GDK_KEY_PRESS:
+    case GDK_KEY_RELEASE:
+      {
+        const GdkEventKey *kevent = (const GdkEventKey *) event;
+
+        strv[n++] = g_strdup (event->type == GDK_KEY_PRESS ?
+                              "key-press" : "key-release");
+        strv[n++] = g_strdup ("0");
+        strv[n++] = g_strdup ("0");
+        strv[n++] = g_strdup_printf ("%u", kevent->state);
+        strv[n++] = g_strdup_printf ("%u", kevent->keyval);
+      }
+      break;
+
+    default:
+      for (i = 0; i < n; i++)
+        g_free (strv[i]);
+      return;
+    }
+
+  gimp_display_shell_record_strv (strv);
+
+  for (i = 0; i < n; i++)
+    g_free (strv[i]);
+}
+
+void
+gimp_display_shell_record_procedure (GimpProcedure  *procedure,
+                                     GimpRunMode     run_mode,
+                                     GimpValueArray *args)
+{
+  gchar **strv;
+  gint    n_args;
+  gint    n = 0;
+  gint    i;
+
+  g_return_if_fail (GIMP_IS_PROCEDURE (procedure));
+  g_return_if_fail (args != NULL);
+
+  if (! recorder.output || ! recorder.shell)
+    return;
+
+  n_args = MIN (gimp_value_array_length (args), procedure->num_args);
+
+  strv = g_new0 (gchar *, n_args + 5);
+
+  strv[n++] = g_strdup ("procedure");
+  strv[n++] = gimp_display_shell_record_time ();
+  strv[n++] = g_strdup_printf ("%d", run_mode);
+  strv[n++] = g_strdup (gimp_object_get_name (procedure));
+
+  for (i = 0; i < n_args; i++)
+    {
+      GValue *value = gimp_value_array_index (args, i);
+
+      /*  the run mode is already recorded  */
+      if (i == 0 && G_VALUE_HOLDS (value, GIMP_TYPE_RUN_MODE))
+        strv[n++] = g_strdup ("default");
+      else
+        strv[n++] = gimp_display_shell_record_value (procedure->args[i],
+                                                     value);
+    }
+
+  gimp_display_shell_record_strv (strv);
+
+  g_strfreev (strv);
+}
+
+gboolean
+gimp_display_shell_replay (GimpDisplayShell  *shell,
+                           GFile             *file,
+                           GError           **error)
+{
+  GFileInputStream *input;
+  GDataInputStream *data;
+  Replay            replay  = { NULL, };
+  gchar            *line;
+  gint              line_no = 0;
+  gboolean          success = TRUE;
+
+  g_return_val_if_fail (GIMP_IS_DISPLAY_SHELL (shell), FALSE);
+  g_return_val_if_fail (G_IS_FILE (file), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  if (! gimp_display_get_image (shell->display))
+    {
+      g_set_error_literal (error, GIMP_ERROR, GIMP_FAILED,
+                           _("There is no image to replay the session on."));
+      return FALSE;
+    }
+
+  input = g_file_read (file, NULL, error);
+  if (! input)
+    return FALSE;
+
+  data = g_data_input_stream_new (G_INPUT_STREAM (input));
+  g_object_unref (input);
+
+  replay.shell = shell;
+
+  g_object_add_weak_pointer (G_OBJECT (shell), (gpointer) &replay.shell);
+
+  g_print ("Replaying %s\n", gimp_file_get_utf8_name (file));
+
+  while (success &&
+         (line = g_data_input_stream_read_line (data, NULL, NULL, error)))
+    {
+      gchar  **argv = NULL;
+      gint     argc;
+      GError  *parse_error = NULL;
+
+      line_no++;
+
+      g_strstrip (line);
+
+      if (! *line || *line == '#')
+        {
+          g_free (line);
+          continue;
+        }
+
+      if (! g_shell_parse_argv (line, &argc, &argv, &parse_error) ||
+          ! gimp_display_shell_replay_line (&replay, argv, argc, &parse_error))
+        {
+          g_set_error (error, GIMP_ERROR, GIMP_FAILED,
+                       _("Error in line %d of '%s': %s"),
+                       line_no, gimp_file_get_utf8_name (file),
+                       parse_error->message);
+          g_clear_error (&parse_error);
+
+          success = FALSE;
+        }
+
+      g_strfreev (argv);
+      g_free (line);
+
+      if (! replay.shell)
+        {
+          if (success)
+            g_set_error_literal (error, GIMP_ERROR, GIMP_FAILED,
+                                 _("The display was closed during the "
+                                   "replay."));
+          success = FALSE;
+        }
+    }
+
+  if (error && *error)
+    success = FALSE;
+
+  if (replay.shell)
+    {
+      gimp_display_shell_replay_end (&replay);
+
+      g_object_remove_weak_pointer (G_OBJECT (shell),
+                                    (gpointer) &replay.shell);
+    }
+
+  g_object_unref (data);
+
+  if (success)
+    g_print ("Replayed %d phases in %.3f ms\n",
+             replay.n_phases, replay.total);
+
+  return success;
+}
+
+
+/*  private functions  */
+
+static void
+gimp_display_shell_record_line (const gchar *first,
+                                ...)
+{
+  GPtrArray   *array = g_ptr_array_new ();
+  const gchar *str;
+  va_list      args;
+
+  va_start (args, first);
+
+  for (str = first; str; str = va_arg (args, const gchar *))
+    g_ptr_array_add (array, (gpointer) str);
+
+  va_end (args);
+
+  g_ptr_array_add (array, NULL);
+
+  gimp_display_shell_record_strv ((gchar **) array->pdata);
+
+  g_ptr_array_free (array, TRUE);
+}
+
+static void
+gimp_display_shell_record_strv (gchar **strv)
+{
+  GString *line = g_string_new (NULL);
+  GError  *error = NULL;
+  gint     i;
+
+  for (i = 0; strv[i]; i++)
+    {
+      gchar *quoted = g_shell_quote (strv[i]);
+
+      if (i > 0)
+        g_string_append_c (line, ' ');
+
+      g_string_append (line, quoted);
+
+      g_free (quoted);
+    }
+
+  g_string_append_c (line, '\n');
+
+  if (! g_output_stream_write_all (recorder.output, line->str, line->len,
+                                   NULL, NULL, &error))
+    {
+      g_printerr ("Session recording failed: %s\n", error->message);
+      g_clear_error (&error);
+
+      gimp_display_shell_record_stop ();
+    }
+
+  g_string_free (line, TRUE);
+}
+
+static gchar *
+gimp_display_shell_record_time (void)
+{
+  return gimp_display_shell_record_double ((g_get_monotonic_time () -
+                                           recorder.start_time) / 1000.0);
+}
+
+static gchar *
+gimp_display_shell_record_double (gdouble value)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  return g_strdup (g_ascii_dtostr (buf, sizeof (buf), value));
+}
+
+static gchar *
+gimp_display_shell_record_value (GParamSpec   *pspec,
+                                 const GValue *value)
+{
+  GType type = G_PARAM_SPEC_VALUE_TYPE (pspec);
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  if (G_VALUE_HOLDS_INT (value))
+    {
+      return g_strdup_printf ("i:%d", g_value_get_int (value));
+    }
+  else if (G_VALUE_HOLDS_DOUBLE (value))
+    {
+      return g_strconcat ("d:",
+                          g_ascii_dtostr (buf, sizeof (buf),
+                                          g_value_get_double (value)),
+                          NULL);
+    }
+  else if (G_VALUE_HOLDS_BOOLEAN (value))
+    {
+      return g_strdup_printf ("b:%d", g_value_get_boolean (value) ? 1 : 0);
+    }
+  else if (G_VALUE_HOLDS_ENUM (value))
+    {
+      return g_strdup_printf ("e:%d", g_value_get_enum (value));
+    }
+  else if (G_VALUE_HOLDS_STRING (value))
+    {
+      return g_strconcat ("s:", g_value_get_string (value), NULL);
+    }
+  else if (type == GIMP_TYPE_IMAGE)
+    {
+      return g_strdup ("image");
+    }
+  else if (g_type_is_a (type, GIMP_TYPE_DRAWABLE) ||
+           GIMP_IS_PARAM_SPEC_CORE_OBJECT_ARRAY (pspec))
+    {
+      return g_strdup ("drawables");
+    }
+  else if (g_type_is_a (type, GIMP_TYPE_CONFIG) &&
+           g_value_get_object (value))
+    {
+      gchar *config;
+      gchar *str;
+
+      config = gimp_config_serialize_to_string (g_value_get_object (value),
+                                                NULL);
+      str = g_strconcat ("c:", config, NULL);
+      g_free (config);
+
+      return str;
+    }
+
+  return g_strdup ("default");
+}
+
+static gboolean
+gimp_display_shell_replay_line (Replay  *replay,
+                                gchar  **argv,
+                                gint     argc,
+                                GError **error)
+{
+  if (! strcmp (argv[0], "version"))
+    {
+      if (argc != 2 || atoi (argv[1]) != RECORDING_VERSION)
+        {
+          g_set_error_literal (error, GIMP_ERROR, GIMP_FAILED,
+                               _("unsupported recording version"));
+          return FALSE;
+        }
+
+      return TRUE;
+    }
+  else if (! strcmp (argv[0], "view"))
+    {
+      return gimp_display_shell_replay_view (replay, argv, argc, error);
+    }
+  else if (! strcmp (argv[0], "event"))
+    {
+      return gimp_display_shell_replay_event (replay, argv, argc, error);
+    }
+  else if (! strcmp (argv[0], "procedure"))
+    {
+      return gimp_display_shell_replay_procedure (replay, argv, argc, error);
+    }
+
+  g_set_error (error, GIMP_ERROR, GIMP_FAILED,
+               _("unknown entry '%s'"), argv[0]);
+
+  return FALSE;
+}
+
+static gboolean
+gimp_display_shell_replay_view (Replay  *replay,
+                                gchar  **argv,
+                                gint     argc,
+                                GError **error)
+{
+  GimpDisplayShell *shell = replay->shell;
+  gint              width;
+  gint              height;
+
+  if (argc != 9)
+    {
+      g_set_error_literal (error, GIMP_ERROR, GIMP_FAILED,
+                           _("malformed view"));
+      return FALSE;
+    }
+
+  gimp_display_shell_replay_end (replay);
+
+  width  = gtk_widget_get_allocated_width  (shell->canvas);
+  height = gtk_widget_get_allocated_height (shell->canvas);
+
+  if (width != atoi (argv[7]) || height != atoi (argv[8]))
+    g_printerr ("Replaying on a %dx%d canvas, recorded on %sx%s, "
+                "events may land elsewhere\n",
+                width, height, argv[7], argv[8]);
+
+  gimp_display_shell_scale     (shell, GIMP_ZOOM_TO,
+                                g_ascii_strtod (argv[1], NULL),
+                                GIMP_ZOOM_FOCUS_IMAGE_CENTER);
+  gimp_display_shell_flip      (shell, atoi (argv[5]), atoi (argv[6]));
+  gimp_display_shell_rotate_to (shell, g_ascii_strtod (argv[4], NULL));
+  gimp_display_shell_scroll_set_offset (shell, atoi (argv[2]), atoi (argv[3]));
+
+  gimp_display_shell_replay_settle (replay);
+
+  return TRUE;
+}
+
+static gboolean
+gimp_display_shell_replay_event (Replay  *replay,
+                                 gchar  **argv,
+                                 gint     argc,
+                                 GError **error)
+{
+  GimpDisplayShell *shell = replay->shell;
+  GdkWindow        *window;
+  GdkDevice        *device;
+  GdkEvent         *event;
+  const gchar      *type;
+  gdouble           x;
+  gdouble           y;
+  guint             state;
+  guint             detail;
+  guint32           time;
+
+  if (argc < 7)
+    {
+      g_set_error_literal (error, GIMP_ERROR, GIMP_FAILED,
+                           _("malformed event"));
+      return FALSE;
+    }
+
+  time   = g_ascii_strtod (argv[1], NULL);
+  type   = argv[2];
+  x      = g_ascii_strtod (argv[3], NULL);
+  y      = g_ascii_strtod (argv[4], NULL);
+  state  = strtoul (argv[5], NULL, 10);
+  detail = strtoul (argv[6], NULL, 10);
+
+  window = gtk_widget_get_window (shell->canvas);
+  device = gdk_seat_get_pointer (
+             gdk_display_get_default_seat (gdk_window_get_display (window)));
+
+  if (! strcmp (type, "button-press") || ! strcmp (type, "button-release"))
+    {
+      gboolean press = ! strcmp (type, "button-press");
+
+      if (press)
+        gimp_display_shell_replay_begin (replay, PHASE_STROKE, "stroke");
+
+      event = gdk_event_new (press ? GDK_BUTTON_PRESS : GDK_BUTTON_RELEASE);
+
+      event->button.x      = x;
+      event->button.y      = y;
+      event->button.state  = state;
+      event->button.button = detail;
+      event->button.time   = time;
+    }
+  else if (! strcmp (type, "motion"))
+    {
+      event = gdk_event_new (GDK_MOTION_NOTIFY);
+
+      event->motion.x     = x;
+      event->motion.y     = y;
+      event->motion.state = state;
+      event->motion.time  = time;
+    }
+  else if (! strcmp (type, "scroll"))
+    {
+      if (argc != 10)
+        {
+          g_set_error_literal (error, GIMP_ERROR, GIMP_FAILED,
+                               _("malformed scroll event"));
+          return FALSE;
+        }
+
+      if (replay->type != PHASE_SCROLL)
+        gimp_display_shell_replay_begin (replay, PHASE_SCROLL, "scroll");
+
+      event = gdk_event_new (GDK_SCROLL);
+
+      event->scroll.x         = x;
+      event->scroll.y         = y;
+      event->scroll.state     = state;
+      event->scroll.time      = time;
+      event->scroll.direction = atoi (argv[7]);
+      event->scroll.delta_x   = g_ascii_strtod (argv[8], NULL);
+      event->scroll.delta_y   = g_ascii_strtod (argv[9], NULL);
+    }
+  else if (! strcmp (type, "key-press") || ! strcmp (type, "key-release"))
+    {
+      event = gdk_event_new (! strcmp (type, "key-press") ?
+                             GDK_KEY_PRESS : GDK_KEY_RELEASE);
+
+      event->key.state  = state;
+      event->key.keyval = detail;
+      event->key.time   = time;
+    }
+  else
+    {
+      g_set_error (error, GIMP_ERROR, GIMP_FAILED,
+                   _("unknown event type '%s'"), type);
+      return FALSE;
+    }
+
+  /*  a scroll phase lasts as long as there are scroll events  */
+  if (replay->type == PHASE_SCROLL && event->type != GDK_SCROLL)
+    gimp_display_shell_replay_end (replay);
+
+  event->any.window     = g_object_ref (window);
+  event->any.send_event = TRUE;
+  gdk_event_set_device (event, device);
+
+  gimp_display_shell_canvas_tool_events (shell->canvas, event, shell);
+
+  gdk_event_free (event);
+
+  if (replay->type != PHASE_NONE)
+    replay->n_events++;
+
+  if (replay->shell && replay->type == PHASE_STROKE &&
+      ! strcmp (type, "button-release"))
+    gimp_display_shell_replay_end (replay);
+
+  return TRUE;
+}
+
+static gboolean
+gimp_display_shell_replay_procedure (Replay  *replay,
+                                     gchar  **argv,
+                                     gint     argc,
+                                     GError **error)
+{
+  GimpDisplayShell *shell = replay->shell;
+  Gimp             *gimp  = gimp_display_get_gimp (shell->display);
+  GimpProcedure    *procedure;
+  GimpValueArray   *args;
+  GimpValueArray   *return_vals;
+  GimpRunMode       run_mode;
+  gint              i;
+
+  if (argc < 4)
+    {
+      g_set_error_literal (error, GIMP_ERROR, GIMP_FAILED,
+                           _("malformed procedure"));
+      return FALSE;
+    }
+
+  procedure = gimp_pdb_lookup_procedure (gimp->pdb, argv[3]);
+
+  if (! procedure)
+    {
+      g_set_error (error, GIMP_ERROR, GIMP_FAILED,
+                   _("procedure '%s' not found"), argv[3]);
+      return FALSE;
+    }
+
+  /*  dialogs would be part of the timing, and their outcome isn't
+   *  recorded, run with the last values instead
+   */
+  run_mode = atoi (argv[2]);
+  if (run_mode == GIMP_RUN_INTERACTIVE)
+    run_mode = GIMP_RUN_WITH_LAST_VALS;
+
+  args = gimp_procedure_get_arguments (procedure);
+
+  for (i = 0; i < procedure->num_args && i + 4 < argc; i++)
+    {
+      GValue *value = gimp_value_array_index (args, i);
+
+      if (i == 0 && G_VALUE_HOLDS (value, GIMP_TYPE_RUN_MODE))
+        g_value_set_enum (value, run_mode);
+      else if (! gimp_display_shell_replay_value (replay, procedure->args[i],
+                                                  argv[i + 4], value))
+        {
+          g_set_error (error, GIMP_ERROR, GIMP_FAILED,
+                       _("invalid argument '%s' for procedure '%s'"),
+                       argv[i + 4], argv[3]);
+          gimp_value_array_unref (args);
+          return FALSE;
+        }
+    }
+
+  gimp_display_shell_replay_begin (replay, PHASE_PROCEDURE, argv[3]);
+
+  return_vals = gimp_procedure_execute (procedure, gimp,
+                                        gimp_get_user_context (gimp),
+                                        GIMP_PROGRESS (shell->display),
+                                        args, NULL);
+
+  if (replay->shell)
+    gimp_display_shell_replay_end (replay);
+
+  if (return_vals)
+    gimp_value_array_unref (return_vals);
+
+  gimp_value_array_unref (args);
+
+  return TRUE;
+}
+
+static gboolean
+gimp_display_shell_replay_value (Replay      *replay,
+                                 GParamSpec  *pspec,
+                                 const gchar *str,
+                                 GValue      *value)
+{
+  GimpImage *image = gimp_display_get_image (replay->shell->display);
+
+  if (! strcmp (str, "default"))
+    {
+      return TRUE;
+    }
+  else if (! strcmp (str, "image"))
+    {
+      if (! G_VALUE_HOLDS (value, GIMP_TYPE_IMAGE))
+        return FALSE;
+
+      g_value_set_object (value, image);
+    }
+  else if (! strcmp (str, "drawables"))
+    {
+      GList *drawables = gimp_image_get_selected_drawables (image);
+
+      if (GIMP_IS_PARAM_SPEC_CORE_OBJECT_ARRAY (pspec))
+        {
+          GimpDrawable **array = g_new0 (GimpDrawable *,
+                                         g_list_length (drawables) + 1);
+          GList         *iter;
+          gint           i;
+
+          for (iter = drawables, i = 0; iter; iter = iter->next, i++)
+            array[i] = iter->data;
+
+          g_value_set_boxed (value, (GObject **) array);
+
+          g_free (array);
+        }
+      else if (g_type_is_a (G_PARAM_SPEC_VALUE_TYPE (pspec),
+                            GIMP_TYPE_DRAWABLE) &&
+               g_list_length (drawables) == 1)
+        {
+          g_value_set_object (value, drawables->data);
+        }
+      else
+        {
+          g_list_free (drawables);
+          return FALSE;
+        }
+
+      g_list_free (drawables);
+    }
+  else if (g_str_has_prefix (str, "i:") && G_VALUE_HOLDS_INT (value))
+    {
+      g_value_set_int (value, atoi (str + 2));
+    }
+  else if (g_str_has_prefix (str, "d:") && G_VALUE_HOLDS_DOUBLE (value))
+    {
+      g_value_set_double (value, g_ascii_strtod (str + 2, NULL));
+    }
+  else if (g_str_has_prefix (str, "b:") && G_VALUE_HOLDS_BOOLEAN (value))
+    {
+      g_value_set_boolean (value, atoi (str + 2) != 0);
+    }
+  else if (g_str_has_prefix (str, "e:") && G_VALUE_HOLDS_ENUM (value))
+    {
+      g_value_set_enum (value, atoi (str + 2));
+    }
+  else if (g_str_has_prefix (str, "s:") && G_VALUE_HOLDS_STRING (value))
+    {
+      g_value_set_string (value, str + 2);
+    }
+  else if (g_str_has_prefix (str, "c:") &&
+           g_type_is_a (G_PARAM_SPEC_VALUE_TYPE (pspec), GIMP_TYPE_CONFIG))
+    {
+      GObject *config;
+
+      config = g_object_new (G_PARAM_SPEC_VALUE_TYPE (pspec), NULL);
+
+      if (! gimp_config_deserialize_string (GIMP_CONFIG (config),
+                                            str + 2, -1, NULL, NULL))
+        {
+          g_object_unref (config);
+          return FALSE;
+        }
+
+      g_value_take_object (value, config);
+    }
+  else
+    {
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+gimp_display_shell_replay_begin (Replay          *replay,
+                                 ReplayPhaseType  type,
+                                 const gchar     *name)
+{
+  gimp_display_shell_replay_end (replay);
+
+  /*  don't let the rendering of the previous phase leak into this one  */
+  gimp_display_shell_replay_settle (replay);
+
+  replay->type       = type;
+  replay->n_events   = 0;
+  replay->name       = g_strdup (name);
+  replay->start_time = g_get_monotonic_time ();
+}
+
+static void
+gimp_display_shell_replay_end (Replay *replay)
+{
+  GimpDashboard *dashboard;
+  gdouble        ms;
+  gchar         *description;
+
+  if (replay->type == PHASE_NONE)
+    return;
+
+  gimp_display_shell_replay_settle (replay);
+
+  ms = (g_get_monotonic_time () - replay->start_time) / 1000.0;
+
+  replay->n_phases++;
+  replay->total += ms;
+
+  if (replay->type == PHASE_PROCEDURE)
+    description = g_strdup_printf ("replay phase %d: %s",
+                                   replay->n_phases, replay->name);
+  else
+    description = g_strdup_printf ("replay phase %d: %s (%d events)",
+                                   replay->n_phases, replay->name,
+                                   replay->n_events);
+
+  g_print ("%s: %.3f ms\n", description, ms);
+
+  dashboard = gimp_display_shell_replay_dashboard ();
+
+  if (dashboard && gimp_dashboard_log_is_recording (dashboard))
+    gimp_dashboard_log_add_marker (dashboard, description);
+
+  g_free (description);
+  g_clear_pointer (&replay->name, g_free);
+
+  replay->type = PHASE_NONE;
+}
+
+/*  waits for the projection and the display to catch up with the
+ *  events sent so far, so that each phase includes its rendering
+ */
+static void
+gimp_display_shell_replay_settle (Replay *replay)
+{
+  GimpImage *image;
+
+  if (! replay->shell)
+    return;
+
+  image = gimp_display_get_image (replay->shell->display);
+
+  if (image)
+    gimp_projection_finish_draw (gimp_image_get_projection (image));
+
+  gimp_display_flush_now (replay->shell->display);
+
+  while (replay->shell && gtk_events_pending ())
+    gtk_main_iteration ();
+}
+
+static GimpDashboard *
+gimp_display_shell_replay_dashboard (void)
+{
+  GtkWidget *widget;
+
+  widget = gimp_dialog_factory_find_widget (gimp_dialog_factory_get_singleton (),
+                                            "gimp-dashboard");
+  if (widget)
+    return GIMP_DASHBOARD (gtk_bin_get_child (GTK_BIN (widget)));
+
+  return NULL;
+}
@@ -0,0 +1,37 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpdisplayshell-replay.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+gboolean   gimp_display_shell_record_start     (GimpDisplayShell  *shell,
+                                                GFile             *file,
+                                                GError           **error);
+void       gimp_display_shell_record_stop      (void);
+gboolean   gimp_display_shell_is_recording     (GimpDisplayShell  *shell);
+
+void       gimp_display_shell_record_event     (GimpDisplayShell  *shell,
+                                                const GdkEvent    *event);
+void       gimp_display_shell_record_procedure (GimpProcedure     *procedure,
+                                                GimpRunMode        run_mode,
+                                                GimpValueArray    *args);
+
+gboolean   gimp_display_shell_replay           (GimpDisplayShell  *shell,
+                                                GFile             *file,
+                                                GError           **error);
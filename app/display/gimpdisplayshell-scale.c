@@ -790,6 +790,10 @@ gimp_display_shell_scale_by_values (GimpDisplayShell *shell,
   /* freeze the active tool */
   gimp_display_shell_pause (shell);
 
+  gimp_display_shell_scroll_track_motion (
+    shell, 0.0, 0.0,
+    log (scale / gimp_zoom_model_get_factor (shell->zoom)));
+
   gimp_zoom_model_zoom (shell->zoom, GIMP_ZOOM_TO, scale);
 
   shell->offset_x = offset_x;
@@ -908,7 +912,7 @@ gimp_display_shell_scale_resize (GimpDisplayShell *shell,
   gimp_display_shell_scaled (shell);
 
   gimp_display_shell_expose_full (shell);
-  gimp_display_shell_render_invalidate_full (shell);
+  gimp_display_shell_render_view_changed (shell);
 
   /* re-enable the active tool */
   gimp_display_shell_resume (shell);
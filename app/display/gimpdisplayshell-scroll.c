@@ -47,6 +47,17 @@
 
 #define OVERPAN_FACTOR 0.5
 
+/*  how far ahead, in seconds, the viewport is extrapolated when choosing
+ *  the area the projection renders first
+ */
+#define PREFETCH_TIME             0.25
+/*  pan/zoom velocities older than this many seconds are considered stale  */
+#define PREFETCH_TIMEOUT          0.1
+/*  weight of the newest sample in the velocity estimate  */
+#define PREFETCH_SMOOTHING        0.5
+/*  the largest zoom-out factor the prefetch area accounts for  */
+#define PREFETCH_MAX_ZOOM_FACTOR  2.0
+
 
 /**
  * gimp_display_shell_scroll:
@@ -90,53 +101,14 @@ gimp_display_shell_scroll (GimpDisplayShell *shell,
 
   if (x_offset || y_offset)
     {
+      gimp_display_shell_scroll_track_motion (shell, x_offset, y_offset, 0.0);
+
       gimp_display_shell_scrolled (shell);
 
       gimp_overlay_box_scroll (GIMP_OVERLAY_BOX (shell->canvas),
                                -x_offset, -y_offset);
 
-      if (shell->render_cache)
-        {
-          cairo_surface_t       *surface;
-          cairo_t               *cr;
-
-          surface = cairo_surface_create_similar_image (
-            shell->render_cache,
-            CAIRO_FORMAT_ARGB32,
-            shell->disp_width  * shell->render_scale,
-            shell->disp_height * shell->render_scale);
-
-          cr = cairo_create (surface);
-          cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
-          cairo_set_source_surface (cr, shell->render_cache, 0, 0);
-          cairo_paint (cr);
-          cairo_destroy (cr);
-
-          cr = cairo_create (shell->render_cache);
-          cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
-          cairo_set_source_surface (cr, surface,
-                                    -x_offset * shell->render_scale,
-                                    -y_offset * shell->render_scale);
-          cairo_paint (cr);
-          cairo_destroy (cr);
-
-          cairo_surface_destroy (surface);
-        }
-
-      if (shell->render_cache_valid)
-        {
-          cairo_rectangle_int_t rect;
-
-          cairo_region_translate (shell->render_cache_valid,
-                                  -x_offset, -y_offset);
-
-          rect.x      = 0;
-          rect.y      = 0;
-          rect.width  = shell->disp_width;
-          rect.height = shell->disp_height;
-
-          cairo_region_intersect_rectangle (shell->render_cache_valid, &rect);
-        }
+      gimp_display_shell_render_scroll (shell, x_offset, y_offset);
     }
 
   /* re-enable the active tool */
@@ -180,7 +152,7 @@ gimp_display_shell_scroll_set_offset (GimpDisplayShell *shell,
   gimp_display_shell_scrolled (shell);
 
   gimp_display_shell_expose_full (shell);
-  gimp_display_shell_render_invalidate_full (shell);
+  gimp_display_shell_render_view_changed (shell);
 
   /* re-enable the active tool */
   gimp_display_shell_resume (shell);
@@ -307,6 +279,146 @@ gimp_display_shell_scroll_clamp_and_update (GimpDisplayShell *shell)
   gimp_display_shell_rulers_update (shell);
 }
 
+/**
+ * gimp_display_shell_scroll_track_motion:
+ * @shell: a #GimpDisplayShell
+ * @dx:    horizontal change of the scroll offset, in display pixels
+ * @dy:    vertical change of the scroll offset, in display pixels
+ * @dzoom: change of the scale, as the log of the ratio of the new and
+ *         old scale
+ *
+ * Updates the estimate of the pan and zoom velocity of @shell, used by
+ * gimp_display_shell_scroll_get_prefetch_area().
+ **/
+void
+gimp_display_shell_scroll_track_motion (GimpDisplayShell *shell,
+                                        gdouble           dx,
+                                        gdouble           dy,
+                                        gdouble           dzoom)
+{
+  gint64  time;
+  gdouble dt;
+
+  g_return_if_fail (GIMP_IS_DISPLAY_SHELL (shell));
+
+  time = g_get_monotonic_time ();
+  dt   = (time - shell->motion_time) / (gdouble) G_TIME_SPAN_SECOND;
+
+  if (shell->motion_time == 0 || dt > PREFETCH_TIMEOUT)
+    {
+      /*  the first step of a new motion, we don't know its speed yet  */
+      shell->motion_vx    = 0.0;
+      shell->motion_vy    = 0.0;
+      shell->motion_vzoom = 0.0;
+    }
+  else
+    {
+      /*  several steps can arrive within the same frame  */
+      dt = MAX (dt, 0.001);
+
+      shell->motion_vx    += PREFETCH_SMOOTHING *
+                             (dx    / dt - shell->motion_vx);
+      shell->motion_vy    += PREFETCH_SMOOTHING *
+                             (dy    / dt - shell->motion_vy);
+      shell->motion_vzoom += PREFETCH_SMOOTHING *
+                             (dzoom / dt - shell->motion_vzoom);
+    }
+
+  shell->motion_time = time;
+}
+
+/**
+ * gimp_display_shell_scroll_get_prefetch_area:
+ * @shell:  a #GimpDisplayShell
+ * @x:      return location for the x coordinate of the area
+ * @y:      return location for the y coordinate of the area
+ * @width:  return location for the width of the area
+ * @height: return location for the height of the area
+ *
+ * Returns the area of the image, in image coordinates, which is about
+ * to be visible in @shell: the viewport, extended in the direction
+ * @shell is being panned, and grown if it is being zoomed out, judging
+ * by the recent motion steps reported to
+ * gimp_display_shell_scroll_track_motion().  When the view is not
+ * moving, this is the same area as the viewport.
+ **/
+void
+gimp_display_shell_scroll_get_prefetch_area (GimpDisplayShell *shell,
+                                             gint             *x,
+                                             gint             *y,
+                                             gint             *width,
+                                             gint             *height)
+{
+  gdouble x1, y1;
+  gdouble x2, y2;
+  gdouble dt;
+
+  g_return_if_fail (GIMP_IS_DISPLAY_SHELL (shell));
+
+  x1 = 0.0;
+  y1 = 0.0;
+  x2 = shell->disp_width;
+  y2 = shell->disp_height;
+
+  dt = (g_get_monotonic_time () - shell->motion_time) /
+       (gdouble) G_TIME_SPAN_SECOND;
+
+  if (shell->motion_time != 0 && dt <= PREFETCH_TIMEOUT)
+    {
+      gdouble dx    = shell->motion_vx    * PREFETCH_TIME;
+      gdouble dy    = shell->motion_vy    * PREFETCH_TIME;
+      gdouble dzoom = shell->motion_vzoom * PREFETCH_TIME;
+
+      /*  when zooming out, more of the image is about to become visible
+       *  around the viewport
+       */
+      if (dzoom < 0.0)
+        {
+          gdouble factor = MIN (exp (-dzoom), PREFETCH_MAX_ZOOM_FACTOR);
+          gdouble grow_x = (factor - 1.0) * shell->disp_width  / 2.0;
+          gdouble grow_y = (factor - 1.0) * shell->disp_height / 2.0;
+
+          x1 -= grow_x;
+          y1 -= grow_y;
+          x2 += grow_x;
+          y2 += grow_y;
+        }
+
+      /*  when panning, only extend the viewport on the side that is
+       *  scrolled in, by at most one viewport
+       */
+      dx = CLAMP (dx, -shell->disp_width,  shell->disp_width);
+      dy = CLAMP (dy, -shell->disp_height, shell->disp_height);
+
+      if (dx > 0.0) x2 += dx; else x1 += dx;
+      if (dy > 0.0) y2 += dy; else y1 += dy;
+    }
+
+  gimp_display_shell_untransform_bounds (shell,
+                                         x1, y1, x2, y2,
+                                         &x1, &y1, &x2, &y2);
+
+  x1 = floor (x1);
+  y1 = floor (y1);
+  x2 = ceil (x2);
+  y2 = ceil (y2);
+
+  if (! shell->show_all)
+    {
+      GimpImage *image = gimp_display_get_image (shell->display);
+
+      x1 = MAX (x1, 0);
+      y1 = MAX (y1, 0);
+      x2 = MIN (x2, gimp_image_get_width  (image));
+      y2 = MIN (y2, gimp_image_get_height (image));
+    }
+
+  if (x)      *x      = x1;
+  if (y)      *y      = y1;
+  if (width)  *width  = MAX (x2 - x1, 0);
+  if (height) *height = MAX (y2 - y1, 0);
+}
+
 /**
  * gimp_display_shell_scroll_unoverscrollify:
  * @shell:
@@ -27,6 +27,16 @@ void   gimp_display_shell_scroll_set_offset          (GimpDisplayShell *shell,
 
 void   gimp_display_shell_scroll_clamp_and_update    (GimpDisplayShell *shell);
 
+void   gimp_display_shell_scroll_track_motion        (GimpDisplayShell *shell,
+                                                      gdouble           dx,
+                                                      gdouble           dy,
+                                                      gdouble           dzoom);
+void   gimp_display_shell_scroll_get_prefetch_area   (GimpDisplayShell *shell,
+                                                      gint             *x,
+                                                      gint             *y,
+                                                      gint             *width,
+                                                      gint             *height);
+
 void   gimp_display_shell_scroll_unoverscrollify     (GimpDisplayShell *shell,
                                                       gint              in_offset_x,
                                                       gint              in_offset_y,
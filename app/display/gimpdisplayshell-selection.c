@@ -55,6 +55,24 @@ struct _Selection
   gboolean          show_selection;   /*  is the selection visible?         */
   guint             timeout;          /*  timer for successive draws        */
   cairo_pattern_t  *segs_in_mask;     /*  cache for rendered segments       */
+
+  /*  the boundary and view the segments were generated for, so that they
+   *  and segs_in_mask are only regenerated when either changes, and
+   *  not for each step of the ants
+   */
+  const GimpBoundSeg *src_segs_in;
+  const GimpBoundSeg *src_segs_out;
+  gint              src_n_segs_in;
+  gint              src_n_segs_out;
+  gint              offset_x;
+  gint              offset_y;
+  gdouble           scale_x;
+  gdouble           scale_y;
+  gdouble           rotate_angle;
+  gboolean          flip_horizontally;
+  gboolean          flip_vertically;
+  gint              width;
+  gint              height;
 };
 
 
@@ -73,6 +91,9 @@ static void      selection_zoom_segs      (Selection          *selection,
                                            gint                n_segs,
                                            gint                canvas_offset_x,
                                            gint                canvas_offset_y);
+static gboolean  selection_segs_valid     (Selection          *selection);
+static void      selection_compact_segs   (GimpSegment        *segs,
+                                           gint               *n_segs);
 static void      selection_generate_segs  (Selection          *selection);
 static void      selection_free_segs      (Selection          *selection);
 
@@ -148,6 +169,9 @@ gimp_display_shell_selection_undraw (GimpDisplayShell *shell)
   if (gimp_display_get_image (shell->display))
     {
       selection_undraw (shell->selection);
+
+      /*  the boundary changed, regenerate the segments on the next draw  */
+      selection_free_segs (shell->selection);
     }
   else
     {
@@ -275,7 +299,8 @@ gimp_display_shell_selection_draw (GimpDisplayShell *shell,
           shell->selection->index++;
         }
 
-      selection_generate_segs (shell->selection);
+      if (! selection_segs_valid (shell->selection))
+        selection_generate_segs (shell->selection);
 
       if (shell->selection->segs_in)
         {
@@ -393,6 +418,66 @@ selection_zoom_segs (Selection          *selection,
     }
 }
 
+static gboolean
+selection_segs_valid (Selection *selection)
+{
+  GimpDisplayShell   *shell = selection->shell;
+  GimpImage          *image = gimp_display_get_image (shell->display);
+  GdkWindow          *window;
+  const GimpBoundSeg *segs_in;
+  const GimpBoundSeg *segs_out;
+  gint                n_segs_in;
+  gint                n_segs_out;
+
+  if (! selection->src_segs_in && ! selection->src_segs_out)
+    return FALSE;
+
+  /*  this is cheap as long as the mask's boundary didn't change  */
+  gimp_channel_boundary (gimp_image_get_mask (image),
+                         &segs_in, &segs_out,
+                         &n_segs_in, &n_segs_out,
+                         0, 0, 0, 0);
+
+  window = gtk_widget_get_window (GTK_WIDGET (shell));
+
+  return (segs_in                  == selection->src_segs_in       &&
+          segs_out                 == selection->src_segs_out      &&
+          n_segs_in                == selection->src_n_segs_in     &&
+          n_segs_out               == selection->src_n_segs_out    &&
+          shell->offset_x          == selection->offset_x          &&
+          shell->offset_y          == selection->offset_y          &&
+          shell->scale_x           == selection->scale_x           &&
+          shell->scale_y           == selection->scale_y           &&
+          shell->rotate_angle      == selection->rotate_angle      &&
+          shell->flip_horizontally == selection->flip_horizontally &&
+          shell->flip_vertically   == selection->flip_vertically   &&
+          gdk_window_get_width  (window) == selection->width       &&
+          gdk_window_get_height (window) == selection->height);
+}
+
+/*  when zoomed out, many of the segments of a complex boundary end up on
+ *  the same display pixels, drop the repeated ones, so that they are not
+ *  stroked over and over when rendering the mask
+ */
+static void
+selection_compact_segs (GimpSegment *segs,
+                        gint        *n_segs)
+{
+  gint i, j;
+
+  for (i = 1, j = 0; i < *n_segs; i++)
+    {
+      if (segs[i].x1 != segs[j].x1 || segs[i].y1 != segs[j].y1 ||
+          segs[i].x2 != segs[j].x2 || segs[i].y2 != segs[j].y2)
+        {
+          segs[++j] = segs[i];
+        }
+    }
+
+  if (*n_segs > 0)
+    *n_segs = j + 1;
+}
+
 static void
 selection_generate_segs (Selection *selection)
 {
@@ -412,6 +497,22 @@ selection_generate_segs (Selection *selection)
                          &selection->n_segs_in, &selection->n_segs_out,
                          0, 0, 0, 0);
 
+  selection->src_segs_in       = segs_in;
+  selection->src_segs_out      = segs_out;
+  selection->src_n_segs_in     = selection->n_segs_in;
+  selection->src_n_segs_out    = selection->n_segs_out;
+  selection->offset_x          = selection->shell->offset_x;
+  selection->offset_y          = selection->shell->offset_y;
+  selection->scale_x           = selection->shell->scale_x;
+  selection->scale_y           = selection->shell->scale_y;
+  selection->rotate_angle      = selection->shell->rotate_angle;
+  selection->flip_horizontally = selection->shell->flip_horizontally;
+  selection->flip_vertically   = selection->shell->flip_vertically;
+  selection->width  =
+    gdk_window_get_width  (gtk_widget_get_window (GTK_WIDGET (selection->shell)));
+  selection->height =
+    gdk_window_get_height (gtk_widget_get_window (GTK_WIDGET (selection->shell)));
+
   if (selection->n_segs_in)
     {
       selection->segs_in = g_new (GimpSegment, selection->n_segs_in);
@@ -419,6 +520,8 @@ selection_generate_segs (Selection *selection)
                            selection->segs_in, selection->n_segs_in,
                            canvas_offset_x, canvas_offset_y);
 
+      selection_compact_segs (selection->segs_in, &selection->n_segs_in);
+
       selection_render_mask (selection);
     }
 
@@ -442,6 +545,9 @@ selection_free_segs (Selection *selection)
   selection->n_segs_out = 0;
 
   g_clear_pointer (&selection->segs_in_mask, cairo_pattern_destroy);
+
+  selection->src_segs_in  = NULL;
+  selection->src_segs_out = NULL;
 }
 
 static gboolean
@@ -33,6 +33,7 @@
 
 #include "core/gimp.h"
 #include "core/gimp-filter-history.h"
+#include "core/gimp-input-latency.h"
 #include "core/gimpcontext.h"
 #include "core/gimpimage.h"
 #include "core/gimpimage-pick-item.h"
@@ -70,6 +71,7 @@
 #include "gimpdisplayshell-cursor.h"
 #include "gimpdisplayshell-grab.h"
 #include "gimpdisplayshell-layer-select.h"
+#include "gimpdisplayshell-replay.h"
 #include "gimpdisplayshell-rotate.h"
 #include "gimpdisplayshell-scale.h"
 #include "gimpdisplayshell-scroll.h"
@@ -380,6 +382,8 @@ gimp_display_shell_canvas_tool_events (GtkWidget        *canvas,
   GIMP_LOG (TOOL_EVENTS, "event (display %p): %s",
             display, gimp_print_event (event));
 
+  gimp_display_shell_record_event (shell, event);
+
   if (gimp_display_shell_check_device (shell, event, &device_changed))
     return TRUE;
 
@@ -888,6 +892,8 @@ gimp_display_shell_canvas_tool_events (GtkWidget        *canvas,
                 gint           n_history_events;
                 guint32        last_motion_time;
 
+                gimp_input_latency_event ();
+
                 /*  if the first mouse button is down, check for automatic
                  *  scrolling...
                  */
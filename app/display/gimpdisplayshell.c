@@ -76,6 +76,7 @@
 #include "gimpdisplayshell-profile.h"
 #include "gimpdisplayshell-progress.h"
 #include "gimpdisplayshell-render.h"
+#include "gimpdisplayshell-replay.h"
 #include "gimpdisplayshell-rotate.h"
 #include "gimpdisplayshell-rulers.h"
 #include "gimpdisplayshell-scale.h"
@@ -631,6 +632,10 @@ gimp_display_shell_constructed (GObject *object)
                     G_CALLBACK (gimp_display_shell_canvas_draw),
                     shell);
 
+  g_object_bind_property (config,               "stroke-prediction",
+                          shell->motion_buffer, "prediction",
+                          G_BINDING_SYNC_CREATE);
+
   g_signal_connect_object (shell->display->gimp->config,
                            "notify::theme",
                            G_CALLBACK (gimp_display_shell_style_updated),
@@ -841,6 +846,9 @@ gimp_display_shell_dispose (GObject *object)
 
   shell->popup_manager = NULL;
 
+  if (gimp_display_shell_is_recording (shell))
+    gimp_display_shell_record_stop ();
+
   if (shell->selection)
     gimp_display_shell_selection_free (shell);
 
@@ -855,7 +863,10 @@ gimp_display_shell_dispose (GObject *object)
   g_clear_object (&shell->zoom_gesture);
   g_clear_object (&shell->rotate_gesture);
 
+  gimp_display_shell_render_invalidate_full (shell);
+
   g_clear_pointer (&shell->render_cache,       cairo_surface_destroy);
+  g_clear_pointer (&shell->render_cache_back,  cairo_surface_destroy);
   g_clear_pointer (&shell->render_cache_valid, cairo_region_destroy);
 
   g_clear_pointer (&shell->render_surface, cairo_surface_destroy);
@@ -2143,8 +2154,8 @@ gimp_display_shell_update_priority_rect (GimpDisplayShell *shell)
       gint            x, y;
       gint            width, height;
 
-      gimp_display_shell_untransform_viewport (shell, ! shell->show_all,
-                                               &x, &y, &width, &height);
+      gimp_display_shell_scroll_get_prefetch_area (shell,
+                                                   &x, &y, &width, &height);
       gimp_projection_set_priority_rect (projection, x, y, width, height);
     }
 }
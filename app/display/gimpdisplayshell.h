@@ -84,6 +84,11 @@ struct _GimpDisplayShell
   gint               last_offset_x;    /*  offsets used when reverting zoom   */
   gint               last_offset_y;
 
+  gint64             motion_time;      /*  time of the last pan/zoom step     */
+  gdouble            motion_vx;        /*  pan velocity, in pixels/sec        */
+  gdouble            motion_vy;
+  gdouble            motion_vzoom;     /*  zoom velocity, in log-scale/sec    */
+
   gint               disp_width;       /*  width of drawing area              */
   gint               disp_height;      /*  height of drawing area             */
 
@@ -171,7 +176,10 @@ struct _GimpDisplayShell
   gint               render_scale;
 
   cairo_surface_t   *render_cache;
+  cairo_surface_t   *render_cache_back; /*  spare render_cache, for scrolling */
   cairo_region_t    *render_cache_valid;
+  GimpRenderView    *render_view;      /*  view the render_cache is for       */
+  GList             *render_views;     /*  render caches of previous views    */
 
   gint               render_buf_width;
   gint               render_buf_height;
@@ -22,6 +22,7 @@
 #include <gegl.h>
 #include <gtk/gtk.h>
 
+#include "libgimpbase/gimpbase.h"
 #include "libgimpmath/gimpmath.h"
 
 #include "display-types.h"
@@ -42,7 +43,8 @@
 
 enum
 {
-  PROP_0
+  PROP_0,
+  PROP_PREDICTION
 };
 
 enum
@@ -73,6 +75,8 @@ static void     gimp_motion_buffer_pop_event_queue     (GimpMotionBuffer *buffer
 
 static void     gimp_motion_buffer_interpolate_stroke  (GimpMotionBuffer *buffer,
                                                         GimpCoords       *coords);
+static void     gimp_motion_buffer_predict_stroke      (GimpMotionBuffer *buffer,
+                                                        GimpCoords       *coords);
 static gboolean gimp_motion_buffer_event_queue_timeout (GimpMotionBuffer *buffer);
 
 
@@ -116,6 +120,12 @@ gimp_motion_buffer_class_init (GimpMotionBufferClass *klass)
   object_class->finalize     = gimp_motion_buffer_finalize;
   object_class->set_property = gimp_motion_buffer_set_property;
   object_class->get_property = gimp_motion_buffer_get_property;
+
+  g_object_class_install_property (object_class, PROP_PREDICTION,
+                                   g_param_spec_boolean ("prediction",
+                                                         NULL, NULL,
+                                                         FALSE,
+                                                         GIMP_PARAM_READWRITE));
 }
 
 static void
@@ -165,8 +175,14 @@ gimp_motion_buffer_set_property (GObject      *object,
                                  const GValue *value,
                                  GParamSpec   *pspec)
 {
+  GimpMotionBuffer *buffer = GIMP_MOTION_BUFFER (object);
+
   switch (property_id)
     {
+    case PROP_PREDICTION:
+      buffer->prediction = g_value_get_boolean (value);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -179,8 +195,14 @@ gimp_motion_buffer_get_property (GObject    *object,
                                  GValue     *value,
                                  GParamSpec *pspec)
 {
+  GimpMotionBuffer *buffer = GIMP_MOTION_BUFFER (object);
+
   switch (property_id)
     {
+    case PROP_PREDICTION:
+      g_value_set_boolean (value, buffer->prediction);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -394,7 +416,15 @@ gimp_motion_buffer_motion_event (GimpMotionBuffer *buffer,
           event_fill                       &&
           buffer->event_history->len >= 2)
         {
-          if (buffer->event_delay)
+          if (buffer->prediction)
+            {
+              /* don't hold the event back, extrapolate the
+               * curve's future instead
+               */
+              buffer->event_delay = FALSE;
+              gimp_motion_buffer_predict_stroke (buffer, coords);
+            }
+          else if (buffer->event_delay)
             {
               gimp_motion_buffer_interpolate_stroke (buffer, coords);
             }
@@ -571,6 +601,57 @@ gimp_motion_buffer_interpolate_stroke (GimpMotionBuffer *buffer,
   g_array_free (ret_coords, TRUE);
 }
 
+/* Like gimp_motion_buffer_interpolate_stroke(), but interpolates up
+ * to the new event right away, rather than waiting for the event
+ * following it: the missing control point is extrapolated from the
+ * last three events, assuming constant acceleration.  Only the
+ * tangent at the segment's end depends on the prediction, and it is
+ * replaced by the actual event when the next segment is interpolated,
+ * so nothing ever needs to be taken back.
+ */
+static void
+gimp_motion_buffer_predict_stroke (GimpMotionBuffer *buffer,
+                                   GimpCoords       *coords)
+{
+  GimpCoords  catmull[4];
+  GArray     *ret_coords;
+  gint        i = buffer->event_history->len - 1;
+  gdouble     dx0, dy0;
+  gdouble     dx1, dy1;
+
+  ret_coords = g_array_new (FALSE, FALSE, sizeof (GimpCoords));
+
+  catmull[0] = g_array_index (buffer->event_history, GimpCoords, i - 1);
+  catmull[1] = g_array_index (buffer->event_history, GimpCoords, i);
+  catmull[2] = *coords;
+  catmull[3] = *coords;
+
+  dx0 = catmull[1].x - catmull[0].x;
+  dy0 = catmull[1].y - catmull[0].y;
+  dx1 = coords->x    - catmull[1].x;
+  dy1 = coords->y    - catmull[1].y;
+
+  catmull[3].x = coords->x + dx1 + 0.5 * (dx1 - dx0);
+  catmull[3].y = coords->y + dy1 + 0.5 * (dy1 - dy0);
+
+  gimp_coords_interpolate_catmull (catmull, EVENT_FILL_PRECISION / 2,
+                                   ret_coords, NULL);
+
+  /* The last interpolated point is the event itself, which is
+   * queued by the caller
+   */
+  if (ret_coords->len > 1)
+    {
+      g_array_append_vals (buffer->event_queue,
+                           &g_array_index (ret_coords, GimpCoords, 0),
+                           ret_coords->len - 1);
+    }
+
+  gimp_motion_buffer_push_event_history (buffer, coords);
+
+  g_array_free (ret_coords, TRUE);
+}
+
 static gboolean
 gimp_motion_buffer_event_queue_timeout (GimpMotionBuffer *buffer)
 {
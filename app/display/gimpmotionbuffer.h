@@ -36,6 +36,10 @@ struct _GimpMotionBuffer
 {
   GimpObject  parent_instance;
 
+  gboolean    prediction;       /* extrapolate instead of delaying
+                                 *  event fill
+                                 */
+
   guint32     last_read_motion_time;
 
   guint32     last_motion_time; /*  previous time of a forwarded motion event  */
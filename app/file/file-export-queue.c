@@ -0,0 +1,331 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995, 1996, 1997 Spencer Kimball and Peter Mattis
+ *
+ * file-export-queue.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* A queue of exports, each one running on a duplicate of the image
+ * taken when it was queued.  Duplicated drawables share their tiles
+ * with the original until either side changes them, so queueing is
+ * cheap, and the image can be edited while the export plug-ins run.
+ */
+
+#include "config.h"
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <gegl.h>
+
+#include "libgimpbase/gimpbase.h"
+
+#include "core/core-types.h"
+
+#include "core/gimp.h"
+#include "core/gimpimage.h"
+#include "core/gimpimage-duplicate.h"
+#include "core/gimpprogress.h"
+
+#include "plug-in/gimppluginprocedure.h"
+
+#include "file-export-queue.h"
+#include "file-save.h"
+
+#include "gimp-intl.h"
+
+
+#define FILE_EXPORT_QUEUE_KEY "gimp-file-export-queue"
+
+
+typedef struct _FileExportQueue FileExportQueue;
+typedef struct _FileExportJob   FileExportJob;
+
+struct _FileExportQueue
+{
+  Gimp     *gimp;
+  GQueue    jobs;
+  guint     idle_id;
+  gboolean  running;
+};
+
+struct _FileExportJob
+{
+  GimpImage           *image;
+  GimpImage           *snapshot;
+  GimpProgress        *progress;
+  GFile               *file;
+  GimpPlugInProcedure *file_proc;
+  GimpRunMode          run_mode;
+  gboolean             export_backward;
+  gboolean             export_forward;
+
+  /*  whether the image was changed after the snapshot was taken  */
+  gboolean             modified;
+};
+
+
+static FileExportQueue * file_export_queue_get       (Gimp            *gimp);
+static void              file_export_queue_free      (FileExportQueue *queue);
+static void              file_export_queue_schedule  (FileExportQueue *queue);
+static gboolean          file_export_queue_idle      (FileExportQueue *queue);
+
+static void              file_export_job_run         (FileExportQueue *queue,
+                                                      FileExportJob   *job);
+static void              file_export_job_free        (FileExportJob   *job);
+static void              file_export_job_image_dirty (GimpImage       *image,
+                                                      GimpDirtyMask    dirty_mask,
+                                                      FileExportJob   *job);
+
+
+/*  public functions  */
+
+/**
+ * file_export_queue_add:
+ * @gimp:            a #Gimp
+ * @image:           the image to export
+ * @progress:        a #GimpProgress to report to, or %NULL
+ * @file:            the file to export to
+ * @file_proc:       the export procedure
+ * @run_mode:        the run mode to call @file_proc with
+ * @export_backward: whether this is an export back to the imported file
+ * @export_forward:  whether this is an export to a new file
+ *
+ * Queues an export of @image as it is now, and returns right away.
+ * The exports run one after another from the main loop, like
+ * file_save() with @change_saved_state set to %FALSE.  Once an export
+ * succeeds, the export state of @image is updated, and it is marked
+ * export-clean if it wasn't changed in the meantime.
+ **/
+void
+file_export_queue_add (Gimp                *gimp,
+                       GimpImage           *image,
+                       GimpProgress        *progress,
+                       GFile               *file,
+                       GimpPlugInProcedure *file_proc,
+                       GimpRunMode          run_mode,
+                       gboolean             export_backward,
+                       gboolean             export_forward)
+{
+  FileExportQueue *queue;
+  FileExportJob   *job;
+
+  g_return_if_fail (GIMP_IS_GIMP (gimp));
+  g_return_if_fail (GIMP_IS_IMAGE (image));
+  g_return_if_fail (progress == NULL || GIMP_IS_PROGRESS (progress));
+  g_return_if_fail (G_IS_FILE (file));
+  g_return_if_fail (GIMP_IS_PLUG_IN_PROCEDURE (file_proc));
+  g_return_if_fail ((export_backward && export_forward) == FALSE);
+
+  queue = file_export_queue_get (gimp);
+
+  job = g_slice_new0 (FileExportJob);
+
+  job->image           = image;
+  job->snapshot        = gimp_image_duplicate (image);
+  job->progress        = progress;
+  job->file            = g_object_ref (file);
+  job->file_proc       = g_object_ref (file_proc);
+  job->run_mode        = run_mode;
+  job->export_backward = export_backward;
+  job->export_forward  = export_forward;
+
+  g_object_add_weak_pointer (G_OBJECT (job->image), (gpointer) &job->image);
+
+  if (job->progress)
+    g_object_add_weak_pointer (G_OBJECT (job->progress),
+                               (gpointer) &job->progress);
+
+  g_signal_connect (image, "dirty",
+                    G_CALLBACK (file_export_job_image_dirty),
+                    job);
+
+  g_queue_push_tail (&queue->jobs, job);
+
+  file_export_queue_schedule (queue);
+}
+
+/**
+ * file_export_queue_get_n_pending:
+ * @gimp: a #Gimp
+ *
+ * Returns: the number of queued exports, including the running one.
+ **/
+gint
+file_export_queue_get_n_pending (Gimp *gimp)
+{
+  FileExportQueue *queue;
+
+  g_return_val_if_fail (GIMP_IS_GIMP (gimp), 0);
+
+  queue = g_object_get_data (G_OBJECT (gimp), FILE_EXPORT_QUEUE_KEY);
+
+  if (! queue)
+    return 0;
+
+  return g_queue_get_length (&queue->jobs) + (queue->running ? 1 : 0);
+}
+
+
+/*  private functions  */
+
+static FileExportQueue *
+file_export_queue_get (Gimp *gimp)
+{
+  FileExportQueue *queue;
+
+  queue = g_object_get_data (G_OBJECT (gimp), FILE_EXPORT_QUEUE_KEY);
+
+  if (! queue)
+    {
+      queue = g_slice_new0 (FileExportQueue);
+
+      queue->gimp = gimp;
+      g_queue_init (&queue->jobs);
+
+      g_object_set_data_full (G_OBJECT (gimp), FILE_EXPORT_QUEUE_KEY, queue,
+                              (GDestroyNotify) file_export_queue_free);
+    }
+
+  return queue;
+}
+
+static void
+file_export_queue_free (FileExportQueue *queue)
+{
+  if (queue->idle_id)
+    g_source_remove (queue->idle_id);
+
+  g_queue_clear_full (&queue->jobs, (GDestroyNotify) file_export_job_free);
+
+  g_slice_free (FileExportQueue, queue);
+}
+
+static void
+file_export_queue_schedule (FileExportQueue *queue)
+{
+  /*  file_save() iterates the main loop while the plug-in runs, so
+   *  only ever start one export at a time
+   */
+  if (! queue->running && ! queue->idle_id &&
+      ! g_queue_is_empty (&queue->jobs))
+    {
+      queue->idle_id =
+        g_idle_add ((GSourceFunc) file_export_queue_idle, queue);
+    }
+}
+
+static gboolean
+file_export_queue_idle (FileExportQueue *queue)
+{
+  FileExportJob *job;
+
+  queue->idle_id = 0;
+
+  job = g_queue_pop_head (&queue->jobs);
+
+  if (job)
+    {
+      queue->running = TRUE;
+
+      file_export_job_run (queue, job);
+      file_export_job_free (job);
+
+      queue->running = FALSE;
+
+      file_export_queue_schedule (queue);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+file_export_job_run (FileExportQueue *queue,
+                     FileExportJob   *job)
+{
+  Gimp              *gimp  = queue->gimp;
+  GError            *error = NULL;
+  GimpPDBStatusType  status;
+
+  status = file_save (gimp, job->snapshot, job->progress,
+                      job->file, job->file_proc, job->run_mode,
+                      FALSE, FALSE, FALSE, &error);
+
+  switch (status)
+    {
+    case GIMP_PDB_SUCCESS:
+      if (job->image)
+        {
+          if (job->export_forward)
+            {
+              gimp_image_set_exported_file (job->image, job->file);
+              gimp_image_set_export_proc (job->image, job->file_proc);
+
+              gimp_image_set_imported_file (job->image, NULL);
+            }
+
+          if (! job->modified)
+            gimp_image_export_clean_all (job->image);
+
+          if (job->export_backward || job->export_forward)
+            gimp_image_exported (job->image, job->file);
+
+          gimp_image_flush (job->image);
+        }
+      break;
+
+    case GIMP_PDB_CANCEL:
+      break;
+
+    default:
+      gimp_message (gimp, job->progress ? G_OBJECT (job->progress) : NULL,
+                    GIMP_MESSAGE_ERROR,
+                    _("Exporting '%s' failed:\n\n%s"),
+                    gimp_file_get_utf8_name (job->file),
+                    error ? error->message : _("Unknown error"));
+      break;
+    }
+
+  g_clear_error (&error);
+}
+
+static void
+file_export_job_free (FileExportJob *job)
+{
+  if (job->image)
+    {
+      g_signal_handlers_disconnect_by_func (job->image,
+                                            file_export_job_image_dirty,
+                                            job);
+      g_object_remove_weak_pointer (G_OBJECT (job->image),
+                                    (gpointer) &job->image);
+    }
+
+  if (job->progress)
+    g_object_remove_weak_pointer (G_OBJECT (job->progress),
+                                  (gpointer) &job->progress);
+
+  g_object_unref (job->snapshot);
+  g_object_unref (job->file);
+  g_object_unref (job->file_proc);
+
+  g_slice_free (FileExportJob, job);
+}
+
+static void
+file_export_job_image_dirty (GimpImage     *image,
+                             GimpDirtyMask  dirty_mask,
+                             FileExportJob *job)
+{
+  job->modified = TRUE;
+}
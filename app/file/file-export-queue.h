@@ -0,0 +1,32 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995, 1996, 1997 Spencer Kimball and Peter Mattis
+ *
+ * file-export-queue.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+void   file_export_queue_add           (Gimp                 *gimp,
+                                        GimpImage            *image,
+                                        GimpProgress         *progress,
+                                        GFile                *file,
+                                        GimpPlugInProcedure  *file_proc,
+                                        GimpRunMode           run_mode,
+                                        gboolean              export_backward,
+                                        gboolean              export_forward);
+
+gint   file_export_queue_get_n_pending (Gimp                 *gimp);
@@ -584,7 +584,8 @@ file_open_with_proc_and_display (Gimp                *gimp,
           g_object_unref (image);
         }
 
-      if (! as_new)
+      /*  the core only keeps neither recent documents nor thumbnails  */
+      if (! as_new && ! gimp->core_only)
         {
           GimpDocumentList *documents = GIMP_DOCUMENT_LIST (gimp->documents);
           GimpImagefile    *imagefile;
@@ -277,17 +277,21 @@ file_save (Gimp                *gimp,
       else
         gimp_image_saved (image, orig_file);
 
-      documents = GIMP_DOCUMENT_LIST (image->gimp->documents);
+      /*  the core only keeps neither recent documents nor thumbnails  */
+      if (! image->gimp->core_only)
+        {
+          documents = GIMP_DOCUMENT_LIST (image->gimp->documents);
 
-      imagefile = gimp_document_list_add_file (documents, orig_file,
-                                               g_slist_nth_data (file_proc->mime_types_list, 0));
+          imagefile = gimp_document_list_add_file (documents, orig_file,
+                                                   g_slist_nth_data (file_proc->mime_types_list, 0));
 
-      /* only save a thumbnail if we are saving as XCF, see bug #25272 */
-      if (GIMP_PROCEDURE (file_proc)->proc_type == GIMP_PDB_PROC_TYPE_INTERNAL)
-        gimp_imagefile_save_thumbnail (imagefile,
-                                       g_slist_nth_data (file_proc->mime_types_list, 0),
-                                       image,
-                                       NULL);
+          /* only save a thumbnail if we are saving as XCF, see bug #25272 */
+          if (GIMP_PROCEDURE (file_proc)->proc_type == GIMP_PDB_PROC_TYPE_INTERNAL)
+            gimp_imagefile_save_thumbnail (imagefile,
+                                           g_slist_nth_data (file_proc->mime_types_list, 0),
+                                           image,
+                                           NULL);
+        }
     }
   else if (status != GIMP_PDB_CANCEL)
     {
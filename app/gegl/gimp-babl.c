@@ -124,7 +124,8 @@ void
 gimp_babl_init_fishes (GimpInitStatusFunc status_callback)
 {
   /* create a bunch of fishes - to decrease the initial lazy
-   * initialization cost for some interactions
+   * initialization cost for some interactions.  may be called from any
+   * thread, with a NULL @status_callback.
    */
   static const struct
   {
@@ -165,15 +166,50 @@ gimp_babl_init_fishes (GimpInitStatusFunc status_callback)
 
   for (i = 0; i < G_N_ELEMENTS (fishes); i++)
     {
-      status_callback (NULL, NULL,
-                       (gdouble) (i + 1) /
-                       (gdouble) G_N_ELEMENTS (fishes) * 0.8);
+      if (status_callback)
+        status_callback (NULL, NULL,
+                         (gdouble) (i + 1) /
+                         (gdouble) G_N_ELEMENTS (fishes) * 0.8);
 
       babl_fish (babl_format (fishes[i].from_format),
                  babl_format (fishes[i].to_format));
     }
 }
 
+void
+gimp_babl_init_format_fishes (const Babl *format)
+{
+  /* create the fishes between @format, an image's layer format, and
+   * the formats used by compositing, painting and rendering the
+   * display, in @format's space.  the fishes above only cover the 8-bit
+   * sRGB case.  may be called from any thread.
+   */
+  static const gchar *formats[] =
+  {
+    "RGBA float",
+    "RaGaBaA float",
+    "R'G'B'A float",
+    "R'G'B'A u8"
+  };
+
+  const Babl *space;
+  gint        i;
+
+  g_return_if_fail (format != NULL);
+
+  space = babl_format_get_space (format);
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++)
+    {
+      const Babl *other = babl_format_with_space (formats[i], space);
+
+      babl_fish (format, other);
+      babl_fish (other,  format);
+    }
+
+  babl_fish (format, babl_format ("cairo-ARGB32"));
+}
+
 static const struct
 {
   const gchar *name;
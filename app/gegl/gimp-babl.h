@@ -23,6 +23,7 @@
 
 void                gimp_babl_init                         (void);
 void                gimp_babl_init_fishes                  (GimpInitStatusFunc  status_callback);
+void                gimp_babl_init_format_fishes           (const Babl         *format);
 
 const gchar       * gimp_babl_format_get_description       (const Babl         *format);
 GimpColorProfile  * gimp_babl_format_get_color_profile     (const Babl         *format);
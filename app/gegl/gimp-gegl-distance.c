@@ -0,0 +1,248 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-gegl-distance.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <gegl.h>
+
+#include "libgimpmath/gimpmath.h"
+
+#include "gimp-gegl-types.h"
+
+#include "gimp-gegl-distance.h"
+
+
+#define PIXELS_PER_THREAD \
+  (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
+
+/*  larger than any vertical distance within a buffer  */
+#define DISTANCE_FAR (1 << 24)
+
+
+typedef struct
+{
+  gfloat   *map;
+  gint      width;
+  gint      height;
+  gdouble   weight_x;
+  gdouble   weight_y;
+  gboolean  outside_is_feature;
+} DistanceData;
+
+
+/*  local function prototypes  */
+
+static void   gimp_gegl_distance_columns (gsize         offset,
+                                          gsize         size,
+                                          DistanceData *data);
+static void   gimp_gegl_distance_rows    (gsize         offset,
+                                          gsize         size,
+                                          DistanceData *data);
+
+
+/*  private functions  */
+
+/* finds the vertical distance of each pixel in columns
+ * [offset, offset + size) to the nearest feature of its column, and
+ * replaces it with its weighted square.  the columns are swept a row at a
+ * time, so that the inner loops run over contiguous memory.
+ */
+static void
+gimp_gegl_distance_columns (gsize         offset,
+                            gsize         size,
+                            DistanceData *data)
+{
+  gint *last = g_new (gint, size);
+  gint  init = data->outside_is_feature ? 0 : DISTANCE_FAR;
+  gint  y;
+  gsize i;
+
+  for (i = 0; i < size; i++)
+    last[i] = init;
+
+  for (y = 0; y < data->height; y++)
+    {
+      gfloat *row = data->map + (gsize) y * data->width + offset;
+
+      for (i = 0; i < size; i++)
+        {
+          if (row[i] == 0.0f)
+            last[i] = 0;
+          else
+            last[i] = MIN (last[i] + 1, DISTANCE_FAR);
+
+          row[i] = last[i];
+        }
+    }
+
+  for (i = 0; i < size; i++)
+    last[i] = init;
+
+  for (y = data->height - 1; y >= 0; y--)
+    {
+      gfloat *row = data->map + (gsize) y * data->width + offset;
+
+      for (i = 0; i < size; i++)
+        {
+          gint d;
+
+          if (row[i] == 0.0f)
+            last[i] = 0;
+          else
+            last[i] = MIN (last[i] + 1, DISTANCE_FAR);
+
+          d = MIN (last[i], (gint) row[i]);
+
+          if (d < DISTANCE_FAR)
+            row[i] = data->weight_y * SQR ((gdouble) d);
+          else
+            row[i] = G_MAXFLOAT;
+        }
+    }
+
+  g_free (last);
+}
+
+/* computes the lower envelope of the parabolas rooted at each pixel of
+ * rows [offset, offset + size), as in Felzenszwalb and Huttenlocher's
+ * "Distance Transforms of Sampled Functions".
+ */
+static void
+gimp_gegl_distance_rows (gsize         offset,
+                         gsize         size,
+                         DistanceData *data)
+{
+  gint     width = data->width;
+  gdouble  wx    = data->weight_x;
+  gint     q0    = data->outside_is_feature ? -1    : 0;
+  gint     q1    = data->outside_is_feature ? width : width - 1;
+  gint    *v     = g_new (gint,    width + 2);
+  gdouble *f     = g_new (gdouble, width + 2);
+  gdouble *z     = g_new (gdouble, width + 3);
+  gsize    y;
+
+  for (y = offset; y < offset + size; y++)
+    {
+      gfloat *row = data->map + (gsize) y * width;
+      gint    k   = -1;
+      gint    q;
+      gint    p;
+      gint    j;
+
+      for (q = q0; q <= q1; q++)
+        {
+          gdouble fq;
+          gdouble s = -G_MAXDOUBLE;
+
+          if (q < 0 || q >= width)
+            fq = 0.0;
+          else if (row[q] == G_MAXFLOAT)
+            continue;
+          else
+            fq = row[q];
+
+          while (k >= 0)
+            {
+              s = ((fq   + wx * SQR ((gdouble) q))     -
+                   (f[k] + wx * SQR ((gdouble) v[k]))) /
+                  (2.0 * wx * (q - v[k]));
+
+              if (s > z[k])
+                break;
+
+              k--;
+            }
+
+          if (k < 0)
+            s = -G_MAXDOUBLE;
+
+          k++;
+
+          v[k] = q;
+          f[k] = fq;
+          z[k] = s;
+        }
+
+      /*  no features in the row, or in its column  */
+      if (k < 0)
+        continue;
+
+      z[k + 1] = G_MAXDOUBLE;
+
+      for (p = 0, j = 0; p < width; p++)
+        {
+          while (z[j + 1] < p)
+            j++;
+
+          row[p] = f[j] + wx * SQR ((gdouble) (p - v[j]));
+        }
+    }
+
+  g_free (v);
+  g_free (f);
+  g_free (z);
+}
+
+
+/*  public functions  */
+
+/* replaces each pixel of the 'width' x 'height' 'map' with the weighted
+ * squared euclidean distance, 'weight_x' * dx^2 + 'weight_y' * dy^2, to
+ * the nearest "feature" pixel, i.e., the nearest pixel whose value is 0.
+ * pixels with no feature in reach are set to G_MAXFLOAT.  if
+ * 'outside_is_feature' is TRUE, the pixels surrounding the map are
+ * considered to be features as well.
+ *
+ * the transform is exact, and takes linear time regardless of the
+ * distances involved: a column pass, followed by a row pass, each
+ * distributed across threads.
+ */
+void
+gimp_gegl_distance_transform (gfloat   *map,
+                              gint      width,
+                              gint      height,
+                              gdouble   weight_x,
+                              gdouble   weight_y,
+                              gboolean  outside_is_feature)
+{
+  DistanceData data;
+
+  g_return_if_fail (map != NULL);
+  g_return_if_fail (weight_x > 0.0 && weight_y > 0.0);
+
+  if (width <= 0 || height <= 0)
+    return;
+
+  data.map                = map;
+  data.width              = width;
+  data.height             = height;
+  data.weight_x           = weight_x;
+  data.weight_y           = weight_y;
+  data.outside_is_feature = outside_is_feature;
+
+  gegl_parallel_distribute_range (
+    width, MAX (PIXELS_PER_THREAD / height, 1),
+    (GeglParallelDistributeRangeFunc) gimp_gegl_distance_columns,
+    &data);
+
+  gegl_parallel_distribute_range (
+    height, MAX (PIXELS_PER_THREAD / width, 1),
+    (GeglParallelDistributeRangeFunc) gimp_gegl_distance_rows,
+    &data);
+}
@@ -36,6 +36,109 @@
 #include <emmintrin.h>
 
 
+/* helper function of gimp_gegl_buffer_rotate().  dest pixel (x, y) of
+ * the 'width' x 'height' dest area is src pixel (y, x), strides are in
+ * pixels, and may be negative.  it transposes 4 x 4 blocks of 32-bit
+ * pixels in registers, and the remaining rows and columns one pixel at
+ * a time.
+ */
+void
+gimp_gegl_transpose_32_sse2 (const guint32 *src,
+                             gint           src_stride,
+                             guint32       *dest,
+                             gint           dest_stride,
+                             gint           width,
+                             gint           height)
+{
+  gint x, y;
+
+  for (y = 0; y + 4 <= height; y += 4)
+    {
+      for (x = 0; x + 4 <= width; x += 4)
+        {
+          const guint32 *s = src + (gssize) x * src_stride + y;
+          guint32       *d = dest + (gssize) y * dest_stride + x;
+          __m128i        r0, r1, r2, r3;
+          __m128i        t0, t1, t2, t3;
+
+          r0 = _mm_loadu_si128 ((const __m128i *) (s));
+          r1 = _mm_loadu_si128 ((const __m128i *) (s + src_stride));
+          r2 = _mm_loadu_si128 ((const __m128i *) (s + 2 * src_stride));
+          r3 = _mm_loadu_si128 ((const __m128i *) (s + 3 * src_stride));
+
+          t0 = _mm_unpacklo_epi32 (r0, r1);
+          t1 = _mm_unpacklo_epi32 (r2, r3);
+          t2 = _mm_unpackhi_epi32 (r0, r1);
+          t3 = _mm_unpackhi_epi32 (r2, r3);
+
+          _mm_storeu_si128 ((__m128i *) (d),
+                            _mm_unpacklo_epi64 (t0, t1));
+          _mm_storeu_si128 ((__m128i *) (d + dest_stride),
+                            _mm_unpackhi_epi64 (t0, t1));
+          _mm_storeu_si128 ((__m128i *) (d + 2 * dest_stride),
+                            _mm_unpacklo_epi64 (t2, t3));
+          _mm_storeu_si128 ((__m128i *) (d + 3 * dest_stride),
+                            _mm_unpackhi_epi64 (t2, t3));
+        }
+
+      for (; x < width; x++)
+        {
+          const guint32 *s = src + (gssize) x * src_stride + y;
+          guint32       *d = dest + (gssize) y * dest_stride + x;
+
+          d[0]               = s[0];
+          d[dest_stride]     = s[1];
+          d[2 * dest_stride] = s[2];
+          d[3 * dest_stride] = s[3];
+        }
+    }
+
+  for (; y < height; y++)
+    {
+      const guint32 *s = src + y;
+      guint32       *d = dest + (gssize) y * dest_stride;
+
+      for (x = 0; x < width; x++)
+        {
+          d[x]  = *s;
+          s    += src_stride;
+        }
+    }
+}
+
+/* helper function of gimp_gegl_convolve().  it processes 4 floats at a
+ * time, and returns the number of floats processed, leaving the rest to
+ * the caller.  the coefficients are accumulated in the same order as in
+ * the generic loop, so that the results are the same.
+ */
+gint
+gimp_gegl_convolve_line_sse2 (const gfloat *src,
+                              gfloat       *dest,
+                              gint          count,
+                              const gfloat *kernel,
+                              gint          kernel_size,
+                              gint          stride)
+{
+  gint i;
+
+  for (i = 0; i + 4 <= count; i += 4)
+    {
+      const gfloat *s     = src + i;
+      __m128        v_sum = _mm_setzero_ps ();
+      gint          k;
+
+      for (k = 0; k < kernel_size; k++, s += stride)
+        {
+          v_sum = _mm_add_ps (v_sum, _mm_mul_ps (_mm_set1_ps (kernel[k]),
+                                                 _mm_loadu_ps (s)));
+        }
+
+      _mm_storeu_ps (dest + i, v_sum);
+    }
+
+  return i;
+}
+
 /* helper function of gimp_gegl_smudge_with_paint_process_sse2()
  * src and dest can be the same address
  */
@@ -124,4 +227,177 @@ gimp_gegl_smudge_with_paint_process_sse2 (gfloat       *accum,
     }
 }
 
+/* helper functions of gimp_gegl_combine_mask() and
+ * gimp_gegl_combine_mask_weird().  they process 4 pixels at a time, and
+ * return the number of pixels processed, leaving the rest to the caller.
+ * like the generic loops, they calculate in double precision, so that the
+ * results are the same.
+ */
+gint
+gimp_gegl_combine_mask_process_sse2 (const gfloat *mask,
+                                     gfloat       *dest,
+                                     gint          count,
+                                     gdouble       opacity)
+{
+  const __m128d v_opacity = _mm_set1_pd (opacity);
+  gint          i;
+
+  for (i = 0; i + 4 <= count; i += 4)
+    {
+      __m128  v_mask = _mm_loadu_ps (mask + i);
+      __m128  v_dest = _mm_loadu_ps (dest + i);
+      __m128d lo;
+      __m128d hi;
+
+      lo = _mm_mul_pd (_mm_cvtps_pd (v_dest),
+                       _mm_mul_pd (_mm_cvtps_pd (v_mask), v_opacity));
+      hi = _mm_mul_pd (_mm_cvtps_pd (_mm_movehl_ps (v_dest, v_dest)),
+                       _mm_mul_pd (_mm_cvtps_pd (_mm_movehl_ps (v_mask, v_mask)),
+                                   v_opacity));
+
+      _mm_storeu_ps (dest + i,
+                     _mm_movelh_ps (_mm_cvtpd_ps (lo), _mm_cvtpd_ps (hi)));
+    }
+
+  return i;
+}
+
+static inline __m128d
+gimp_gegl_combine_mask_weird_sse2 (__m128d  v_mask,
+                                   __m128d  v_dest,
+                                   __m128d  v_opacity,
+                                   gboolean stipple)
+{
+  if (stipple)
+    {
+      /* dest += (1.0 - dest) * mask * opacity */
+      return _mm_add_pd (v_dest,
+                         _mm_mul_pd (_mm_mul_pd (_mm_sub_pd (_mm_set1_pd (1.0),
+                                                             v_dest),
+                                                 v_mask),
+                                     v_opacity));
+    }
+  else
+    {
+      /* if (opacity > dest) dest += (opacity - dest) * mask * opacity */
+      __m128d v_cmp = _mm_cmpgt_pd (v_opacity, v_dest);
+      __m128d v_new;
+
+      v_new = _mm_add_pd (v_dest,
+                          _mm_mul_pd (_mm_mul_pd (_mm_sub_pd (v_opacity, v_dest),
+                                                  v_mask),
+                                      v_opacity));
+
+      return _mm_or_pd (_mm_and_pd    (v_cmp, v_new),
+                        _mm_andnot_pd (v_cmp, v_dest));
+    }
+}
+
+gint
+gimp_gegl_combine_mask_weird_process_sse2 (const gfloat *mask,
+                                           gfloat       *dest,
+                                           gint          count,
+                                           gdouble       opacity,
+                                           gboolean      stipple)
+{
+  const __m128d v_opacity = _mm_set1_pd (opacity);
+  gint          i;
+
+  for (i = 0; i + 4 <= count; i += 4)
+    {
+      __m128  v_mask = _mm_loadu_ps (mask + i);
+      __m128  v_dest = _mm_loadu_ps (dest + i);
+      __m128d lo;
+      __m128d hi;
+
+      lo = gimp_gegl_combine_mask_weird_sse2 (
+        _mm_cvtps_pd (v_mask),
+        _mm_cvtps_pd (v_dest),
+        v_opacity, stipple);
+      hi = gimp_gegl_combine_mask_weird_sse2 (
+        _mm_cvtps_pd (_mm_movehl_ps (v_mask, v_mask)),
+        _mm_cvtps_pd (_mm_movehl_ps (v_dest, v_dest)),
+        v_opacity, stipple);
+
+      _mm_storeu_ps (dest + i,
+                     _mm_movelh_ps (_mm_cvtpd_ps (lo), _mm_cvtpd_ps (hi)));
+    }
+
+  return i;
+}
+
+/* helper function of gimp_gegl_index_to_mask(), processes 16 pixels at a
+ * time, and returns the number of processed pixels.
+ */
+gint
+gimp_gegl_index_to_mask_process_sse2 (const guchar *indexed,
+                                      gfloat       *mask,
+                                      gint          count,
+                                      gint          index)
+{
+  const __m128i v_index = _mm_set1_epi8 ((gchar) index);
+  const __m128i v_one   = _mm_castps_si128 (_mm_set1_ps (1.0f));
+  gint          i;
+
+  for (i = 0; i + 16 <= count; i += 16)
+    {
+      __m128i v_eq;
+      __m128i lo;
+      __m128i hi;
+
+      v_eq = _mm_cmpeq_epi8 (_mm_loadu_si128 ((const __m128i *) (indexed + i)),
+                             v_index);
+
+      /*  widen the 0x00 / 0xff bytes to 32 bits, and mask 1.0 with them  */
+      lo = _mm_unpacklo_epi8 (v_eq, v_eq);
+      hi = _mm_unpackhi_epi8 (v_eq, v_eq);
+
+      _mm_storeu_si128 ((__m128i *) (mask + i),
+                        _mm_and_si128 (_mm_unpacklo_epi16 (lo, lo), v_one));
+      _mm_storeu_si128 ((__m128i *) (mask + i + 4),
+                        _mm_and_si128 (_mm_unpackhi_epi16 (lo, lo), v_one));
+      _mm_storeu_si128 ((__m128i *) (mask + i + 8),
+                        _mm_and_si128 (_mm_unpacklo_epi16 (hi, hi), v_one));
+      _mm_storeu_si128 ((__m128i *) (mask + i + 12),
+                        _mm_and_si128 (_mm_unpackhi_epi16 (hi, hi), v_one));
+    }
+
+  return i;
+}
+
+/* helper function of gimp_gegl_shift_index(), processes 16 bytes at a
+ * time, that is 16 or 8 pixels for 'bpp' 1 or 2, in which case the
+ * second byte, the alpha, is left alone.  Returns the number of
+ * processed pixels.
+ */
+gint
+gimp_gegl_shift_index_process_sse2 (guchar *indexed,
+                                    gint    count,
+                                    gint    bpp,
+                                    gint    from_index,
+                                    gint    shift)
+{
+  const __m128i v_from  = _mm_set1_epi8 ((gchar) from_index);
+  __m128i       v_shift = _mm_set1_epi8 ((gchar) shift);
+  gint          n_bytes = count * bpp;
+  gint          i;
+
+  if (bpp == 2)
+    v_shift = _mm_and_si128 (v_shift, _mm_set1_epi16 (0x00ff));
+
+  for (i = 0; i + 16 <= n_bytes; i += 16)
+    {
+      __m128i v = _mm_loadu_si128 ((const __m128i *) (indexed + i));
+      __m128i v_ge;
+
+      /*  unsigned v >= from_index  */
+      v_ge = _mm_cmpeq_epi8 (_mm_max_epu8 (v, v_from), v);
+
+      _mm_storeu_si128 ((__m128i *) (indexed + i),
+                        _mm_add_epi8 (v, _mm_and_si128 (v_ge, v_shift)));
+    }
+
+  return i / bpp;
+}
+
 #endif /* COMPILE_SSE2_INTRINISICS */
@@ -23,6 +23,20 @@
 
 #if COMPILE_SSE2_INTRINISICS
 
+void   gimp_gegl_transpose_32_sse2              (const guint32 *src,
+                                                 gint           src_stride,
+                                                 guint32       *dest,
+                                                 gint           dest_stride,
+                                                 gint           width,
+                                                 gint           height);
+
+gint   gimp_gegl_convolve_line_sse2             (const gfloat *src,
+                                                 gfloat       *dest,
+                                                 gint          count,
+                                                 const gfloat *kernel,
+                                                 gint          kernel_size,
+                                                 gint          stride);
+
 void   gimp_gegl_smudge_with_paint_process_sse2 (gfloat       *accum,
                                                  const gfloat *canvas,
                                                  gfloat       *paint,
@@ -33,4 +47,24 @@ void   gimp_gegl_smudge_with_paint_process_sse2 (gfloat       *accum,
                                                  gfloat        flow,
                                                  gfloat        rate);
 
+gint   gimp_gegl_combine_mask_process_sse2       (const gfloat *mask,
+                                                 gfloat       *dest,
+                                                 gint          count,
+                                                 gdouble       opacity);
+gint   gimp_gegl_combine_mask_weird_process_sse2 (const gfloat *mask,
+                                                 gfloat       *dest,
+                                                 gint          count,
+                                                 gdouble       opacity,
+                                                 gboolean      stipple);
+
+gint   gimp_gegl_index_to_mask_process_sse2     (const guchar *indexed,
+                                                 gfloat       *mask,
+                                                 gint          count,
+                                                 gint          index);
+gint   gimp_gegl_shift_index_process_sse2       (guchar       *indexed,
+                                                 gint          count,
+                                                 gint          bpp,
+                                                 gint          from_index,
+                                                 gint          shift);
+
 #endif /* COMPILE_SSE2_INTRINISICS */
@@ -39,6 +39,7 @@ extern "C"
 #include "gimp-babl.h"
 #include "gimp-gegl-loops.h"
 #include "gimp-gegl-loops-sse2.h"
+#include "gimp-gegl-utils.h"
 
 #include "core/gimp-atomic.h"
 #include "core/gimp-utils.h"
@@ -57,6 +58,69 @@ extern "C"
   const GeglRectangle * const dest##_area = &dest##_area_
 
 
+/* walks the intersections of an area with the tile grid of a buffer, so
+ * that constant tiles can be handled as a whole
+ */
+typedef struct
+{
+  GeglRectangle area;
+  GeglRectangle grid;
+  gint          tile_width;
+  gint          tile_height;
+  gint          x;
+  gint          y;
+} TileIter;
+
+
+static void
+tile_iter_init (TileIter            *iter,
+                GeglBuffer          *buffer,
+                const GeglRectangle *area)
+{
+  iter->area = *area;
+
+  gegl_rectangle_align_to_buffer (&iter->grid, area, buffer,
+                                  GEGL_RECTANGLE_ALIGNMENT_SUPERSET);
+
+  g_object_get (buffer,
+                "tile-width",  &iter->tile_width,
+                "tile-height", &iter->tile_height,
+                NULL);
+
+  iter->x = 0;
+  iter->y = 0;
+}
+
+static gboolean
+tile_iter_next (TileIter      *iter,
+                GeglRectangle *rect)
+{
+  while (iter->y < iter->grid.height)
+    {
+      gboolean found;
+
+      found = gegl_rectangle_intersect (
+        rect,
+        GEGL_RECTANGLE (iter->grid.x + iter->x, iter->grid.y + iter->y,
+                        iter->tile_width, iter->tile_height),
+        &iter->area);
+
+      iter->x += iter->tile_width;
+
+      if (iter->x >= iter->grid.width)
+        {
+          iter->x  = 0;
+          iter->y += iter->tile_height;
+        }
+
+      if (found)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+
 void
 gimp_gegl_buffer_copy (GeglBuffer          *src_buffer,
                        const GeglRectangle *src_rect,
@@ -128,68 +192,849 @@ gimp_gegl_buffer_copy (GeglBuffer          *src_buffer,
     }
   else
     {
-      gegl_parallel_distribute_area (
-        src_rect, PIXELS_PER_THREAD,
-        [=] (const GeglRectangle *src_area)
+      gegl_parallel_distribute_area (
+        src_rect, PIXELS_PER_THREAD,
+        [=] (const GeglRectangle *src_area)
+        {
+          SHIFTED_AREA (dest, src);
+
+          gegl_buffer_copy (src_buffer, src_area, abyss_policy,
+                            dest_buffer, dest_area);
+        });
+    }
+}
+
+/*  like gimp_gegl_buffer_copy(), but also reports how many bytes of the
+ *  copied area were shared copy-on-write with 'src_buffer', and how many
+ *  were actually copied, in 'shared_size' and 'copied_size'.
+ *
+ *  GEGL shares the tiles of the copied area that fall fully inside
+ *  'dest_rect', when both buffers have the same format and tile size,
+ *  and 'src_rect' and 'dest_rect' are at the same offset relative to
+ *  their buffers' tile grids.  to make the most out of it, callers
+ *  should copy tile-aligned areas to a buffer with a matching tile grid.
+ */
+void
+gimp_gegl_buffer_copy_shared (GeglBuffer          *src_buffer,
+                              const GeglRectangle *src_rect,
+                              GeglAbyssPolicy      abyss_policy,
+                              GeglBuffer          *dest_buffer,
+                              const GeglRectangle *dest_rect,
+                              gint64              *shared_size,
+                              gint64              *copied_size)
+{
+  GeglRectangle real_dest_rect;
+  GeglRectangle shared_rect = {};
+  gint64        bpp;
+
+  g_return_if_fail (GEGL_IS_BUFFER (src_buffer));
+  g_return_if_fail (GEGL_IS_BUFFER (dest_buffer));
+
+  if (! src_rect)
+    src_rect = gegl_buffer_get_extent (src_buffer);
+
+  if (! dest_rect)
+    dest_rect = src_rect;
+
+  real_dest_rect        = *dest_rect;
+  real_dest_rect.width  = src_rect->width;
+  real_dest_rect.height = src_rect->height;
+
+  gimp_gegl_buffer_copy (src_buffer, src_rect, abyss_policy,
+                         dest_buffer, &real_dest_rect);
+
+  if (! shared_size && ! copied_size)
+    return;
+
+  bpp = babl_format_get_bytes_per_pixel (gegl_buffer_get_format (dest_buffer));
+
+  if (gegl_buffer_get_format (src_buffer) ==
+      gegl_buffer_get_format (dest_buffer))
+    {
+      gint src_tile_width,  src_tile_height;
+      gint dest_tile_width, dest_tile_height;
+      gint src_shift_x,     src_shift_y;
+      gint dest_shift_x,    dest_shift_y;
+
+      g_object_get (src_buffer,
+                    "tile-width",  &src_tile_width,
+                    "tile-height", &src_tile_height,
+                    "shift-x",     &src_shift_x,
+                    "shift-y",     &src_shift_y,
+                    NULL);
+      g_object_get (dest_buffer,
+                    "tile-width",  &dest_tile_width,
+                    "tile-height", &dest_tile_height,
+                    "shift-x",     &dest_shift_x,
+                    "shift-y",     &dest_shift_y,
+                    NULL);
+
+      if (src_tile_width  == dest_tile_width  &&
+          src_tile_height == dest_tile_height &&
+          ((src_rect->x + src_shift_x) -
+           (real_dest_rect.x + dest_shift_x)) % dest_tile_width  == 0 &&
+          ((src_rect->y + src_shift_y) -
+           (real_dest_rect.y + dest_shift_y)) % dest_tile_height == 0)
+        {
+          gegl_rectangle_align_to_buffer (&shared_rect,
+                                          &real_dest_rect, dest_buffer,
+                                          GEGL_RECTANGLE_ALIGNMENT_SUBSET);
+        }
+    }
+
+  if (shared_size)
+    {
+      *shared_size = bpp * shared_rect.width * shared_rect.height;
+    }
+
+  if (copied_size)
+    {
+      *copied_size = bpp * ((gint64) real_dest_rect.width *
+                                     real_dest_rect.height -
+                            (gint64) shared_rect.width *
+                                     shared_rect.height);
+    }
+}
+
+/*  copies 'src_rect' of 'src_buffer' to the same area of 'dest_buffer',
+ *  shifted by 'offset_x' and 'offset_y', and wrapped around at the
+ *  borders of 'src_rect' if 'wrap_around', in which case the offsets
+ *  must be within [0, size), otherwise within [-size, size].  only the
+ *  part within 'dest_roi' is written, and without 'wrap_around', the
+ *  area left uncovered by the shift isn't touched.
+ *
+ *  the at most four pieces are copied with gimp_gegl_buffer_copy(), so
+ *  when the offsets are multiples of the tile size, and the buffers'
+ *  tile grids match, their tiles are shared instead of copied, see
+ *  gimp_gegl_buffer_copy_shared().  otherwise, GEGL reads each dest
+ *  tile from the at most four src tiles it overlaps.
+ */
+void
+gimp_gegl_buffer_offset (GeglBuffer          *src_buffer,
+                         const GeglRectangle *src_rect,
+                         GeglBuffer          *dest_buffer,
+                         const GeglRectangle *dest_roi,
+                         gint                 offset_x,
+                         gint                 offset_y,
+                         gboolean             wrap_around)
+{
+  gint i;
+
+  g_return_if_fail (GEGL_IS_BUFFER (src_buffer));
+  g_return_if_fail (GEGL_IS_BUFFER (dest_buffer));
+
+  if (! src_rect)
+    src_rect = gegl_buffer_get_extent (src_buffer);
+
+  if (! dest_roi)
+    dest_roi = src_rect;
+
+  for (i = 0; i < (wrap_around ? 4 : 1); i++)
+    {
+      GeglRectangle offset_bounds = *src_rect;
+      gint          x             = offset_x;
+      gint          y             = offset_y;
+
+      if (i & 1)
+        x += offset_x < 0 ? src_rect->width  : -src_rect->width;
+      if (i & 2)
+        y += offset_y < 0 ? src_rect->height : -src_rect->height;
+
+      offset_bounds.x += x;
+      offset_bounds.y += y;
+
+      if (gegl_rectangle_intersect (&offset_bounds, &offset_bounds, src_rect) &&
+          gegl_rectangle_intersect (&offset_bounds, &offset_bounds, dest_roi))
+        {
+          GeglRectangle offset_roi = offset_bounds;
+
+          offset_roi.x -= x;
+          offset_roi.y -= y;
+
+          gimp_gegl_buffer_copy (src_buffer,  &offset_roi, GEGL_ABYSS_NONE,
+                                 dest_buffer, &offset_bounds);
+        }
+    }
+}
+
+/*  compares 'src_rect' of 'src_buffer' to 'dest_rect' of 'dest_buffer'
+ *  tile by tile, and copies the src tiles whose pixels are the same back
+ *  to 'dest_buffer', which makes them shared again.  this is meant for
+ *  buffers that were shared as a whole, and then rendered to in place,
+ *  so that only the tiles that actually changed stay unshared.  only
+ *  whole tiles of 'dest_buffer' are considered, and nothing is done
+ *  unless the buffers have the same format, and their tile grids match.
+ *
+ *  returns the size, in bytes, of the tiles that were shared again.
+ */
+gint64
+gimp_gegl_buffer_share_unchanged (GeglBuffer          *src_buffer,
+                                  const GeglRectangle *src_rect,
+                                  GeglBuffer          *dest_buffer,
+                                  const GeglRectangle *dest_rect)
+{
+  const Babl    *format;
+  GeglRectangle  area;
+  gint           src_tile_width,  src_tile_height;
+  gint           dest_tile_width, dest_tile_height;
+  gint           src_shift_x,     src_shift_y;
+  gint           dest_shift_x,    dest_shift_y;
+  gint           bpp;
+  gint           n_columns;
+  gint           n_rows;
+  gint           n_shared = 0;
+
+  g_return_val_if_fail (GEGL_IS_BUFFER (src_buffer), 0);
+  g_return_val_if_fail (GEGL_IS_BUFFER (dest_buffer), 0);
+
+  if (! src_rect)
+    src_rect = gegl_buffer_get_extent (src_buffer);
+
+  if (! dest_rect)
+    dest_rect = src_rect;
+
+  format = gegl_buffer_get_format (dest_buffer);
+
+  if (gegl_buffer_get_format (src_buffer) != format)
+    return 0;
+
+  g_object_get (src_buffer,
+                "tile-width",  &src_tile_width,
+                "tile-height", &src_tile_height,
+                "shift-x",     &src_shift_x,
+                "shift-y",     &src_shift_y,
+                NULL);
+  g_object_get (dest_buffer,
+                "tile-width",  &dest_tile_width,
+                "tile-height", &dest_tile_height,
+                "shift-x",     &dest_shift_x,
+                "shift-y",     &dest_shift_y,
+                NULL);
+
+  if (src_tile_width  != dest_tile_width  ||
+      src_tile_height != dest_tile_height ||
+      ((src_rect->x + src_shift_x) -
+       (dest_rect->x + dest_shift_x)) % dest_tile_width  != 0 ||
+      ((src_rect->y + src_shift_y) -
+       (dest_rect->y + dest_shift_y)) % dest_tile_height != 0)
+    {
+      return 0;
+    }
+
+  area        = *dest_rect;
+  area.width  = MIN (dest_rect->width,  src_rect->width);
+  area.height = MIN (dest_rect->height, src_rect->height);
+
+  gegl_rectangle_intersect (&area, &area, gegl_buffer_get_extent (dest_buffer));
+  gegl_rectangle_align_to_buffer (&area, &area, dest_buffer,
+                                  GEGL_RECTANGLE_ALIGNMENT_SUBSET);
+
+  if (gegl_rectangle_is_empty (&area))
+    return 0;
+
+  bpp       = babl_format_get_bytes_per_pixel (format);
+  n_columns = area.width  / dest_tile_width;
+  n_rows    = area.height / dest_tile_height;
+
+  gegl_parallel_distribute_range (
+    n_columns * n_rows,
+    MAX (PIXELS_PER_THREAD / (dest_tile_width * dest_tile_height), 1),
+    [&] (gint offset, gint size)
+    {
+      gsize   tile_size = (gsize) bpp * dest_tile_width * dest_tile_height;
+      guint8 *src_data  = gegl_scratch_new (guint8, tile_size);
+      guint8 *dest_data = gegl_scratch_new (guint8, tile_size);
+      gint    shared    = 0;
+      gint    i;
+
+      for (i = offset; i < offset + size; i++)
+        {
+          const GeglRectangle dest_tile = {
+            area.x + (i % n_columns) * dest_tile_width,
+            area.y + (i / n_columns) * dest_tile_height,
+            dest_tile_width, dest_tile_height
+          };
+          const GeglRectangle src_tile = {
+            dest_tile.x + (src_rect->x - dest_rect->x),
+            dest_tile.y + (src_rect->y - dest_rect->y),
+            dest_tile_width, dest_tile_height
+          };
+
+          gegl_buffer_get (src_buffer, &src_tile, 1.0, format, src_data,
+                           GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+          gegl_buffer_get (dest_buffer, &dest_tile, 1.0, format, dest_data,
+                           GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+          if (! memcmp (src_data, dest_data, tile_size))
+            {
+              gimp_gegl_buffer_copy (src_buffer,  &src_tile, GEGL_ABYSS_NONE,
+                                     dest_buffer, &dest_tile);
+
+              shared++;
+            }
+        }
+
+      gegl_scratch_free (dest_data);
+      gegl_scratch_free (src_data);
+
+      g_atomic_int_add (&n_shared, shared);
+    });
+
+  return (gint64) bpp * dest_tile_width * dest_tile_height * n_shared;
+}
+
+void
+gimp_gegl_clear (GeglBuffer          *buffer,
+                 const GeglRectangle *rect)
+{
+  const Babl *format;
+  gint        bpp;
+  gint        n_components;
+  gint        bpc;
+  gint        alpha_offset;
+
+  g_return_if_fail (GEGL_IS_BUFFER (buffer));
+
+  if (! rect)
+    rect = gegl_buffer_get_extent (buffer);
+
+  format = gegl_buffer_get_format (buffer);
+
+  if (! babl_format_has_alpha (format))
+    return;
+
+  bpp          = babl_format_get_bytes_per_pixel (format);
+  n_components = babl_format_get_n_components (format);
+  bpc          = bpp / n_components;
+  alpha_offset = (n_components - 1) * bpc;
+
+  gegl_parallel_distribute_area (
+    rect, PIXELS_PER_THREAD,
+    [=] (const GeglRectangle *area)
+    {
+      TileIter       tiles;
+      GeglRectangle  tile_rect;
+      guint8        *pixel = (guint8 *) g_alloca (bpp);
+
+      tile_iter_init (&tiles, buffer, area);
+
+      while (tile_iter_next (&tiles, &tile_rect))
+        {
+          GeglBufferIterator *iter;
+
+          /*  constant tiles are cleared as a whole, and already
+           *  transparent ones aren't touched, so that empty tiles stay
+           *  shared
+           */
+          if (gimp_gegl_buffer_is_constant (buffer, &tile_rect, pixel))
+            {
+              if (gegl_memeq_zero (pixel + alpha_offset, bpc))
+                continue;
+
+              memset (pixel + alpha_offset, 0, bpc);
+
+              if (gegl_memeq_zero (pixel, bpp))
+                gegl_buffer_clear (buffer, &tile_rect);
+              else
+                gegl_buffer_set_color_from_pixel (buffer, &tile_rect,
+                                                  pixel, format);
+
+              continue;
+            }
+
+          iter = gegl_buffer_iterator_new (buffer, &tile_rect, 0, format,
+                                           GEGL_ACCESS_READWRITE,
+                                           GEGL_ABYSS_NONE, 1);
+
+          while (gegl_buffer_iterator_next (iter))
+            {
+              guint8 *data = (guint8 *) iter->items[0].data;
+              gint    i;
+
+              data += alpha_offset;
+
+              for (i = 0; i < iter->length; i++)
+                {
+                  memset (data, 0, bpc);
+
+                  data += bpp;
+                }
+            }
+        }
+    });
+}
+
+/* helper functions of gimp_gegl_buffer_permute().  strides are in
+ * pixels, and may be negative.
+ */
+template <gint bpp>
+struct Pixel
+{
+  guint8 data[bpp];
+};
+
+template <class T>
+static void
+gimp_gegl_transpose_pixels (const T *src,
+                            gint     src_stride,
+                            T       *dest,
+                            gint     dest_stride,
+                            gint     width,
+                            gint     height)
+{
+  gint x, y;
+
+  for (y = 0; y < height; y++)
+    {
+      const T *s = src + y;
+      T       *d = dest + y * dest_stride;
+
+      for (x = 0; x < width; x++)
+        {
+          d[x]  = *s;
+          s    += src_stride;
+        }
+    }
+}
+
+template <class T>
+static void
+gimp_gegl_reverse_pixels (const T *src,
+                          T       *dest,
+                          gint     width)
+{
+  gint x;
+
+  for (x = 0; x < width; x++)
+    dest[x] = src[width - 1 - x];
+}
+
+/* dest pixel (x, y) of the 'width' x 'height' dest area is src pixel
+ * (y, x)
+ */
+static void
+gimp_gegl_transpose (const guint8 *src,
+                     gint          src_stride,
+                     guint8       *dest,
+                     gint          dest_stride,
+                     gint          width,
+                     gint          height,
+                     gint          bpp,
+                     gboolean      sse2)
+{
+  switch (bpp)
+    {
+#define TRANSPOSE(n)                                                           \
+    case n:                                                                    \
+      gimp_gegl_transpose_pixels ((const Pixel<n> *) src, src_stride,          \
+                                  (Pixel<n> *) dest, dest_stride,              \
+                                  width, height);                              \
+      return;
+
+    TRANSPOSE (1)
+    TRANSPOSE (2)
+    TRANSPOSE (3)
+    TRANSPOSE (6)
+    TRANSPOSE (8)
+    TRANSPOSE (12)
+    TRANSPOSE (16)
+
+#undef TRANSPOSE
+
+    case 4:
+#if COMPILE_SSE2_INTRINISICS
+      if (sse2)
+        {
+          gimp_gegl_transpose_32_sse2 ((const guint32 *) src, src_stride,
+                                       (guint32 *) dest, dest_stride,
+                                       width, height);
+          return;
+        }
+#endif
+      gimp_gegl_transpose_pixels ((const Pixel<4> *) src, src_stride,
+                                  (Pixel<4> *) dest, dest_stride,
+                                  width, height);
+      return;
+    }
+
+  for (gint y = 0; y < height; y++)
+    {
+      for (gint x = 0; x < width; x++)
+        {
+          memcpy (dest + ((gsize) y * dest_stride + x) * bpp,
+                  src  + ((gsize) x * src_stride  + y) * bpp,
+                  bpp);
+        }
+    }
+}
+
+static void
+gimp_gegl_reverse (const guint8 *src,
+                   guint8       *dest,
+                   gint          width,
+                   gint          bpp)
+{
+  switch (bpp)
+    {
+#define REVERSE(n)                                                             \
+    case n:                                                                    \
+      gimp_gegl_reverse_pixels ((const Pixel<n> *) src, (Pixel<n> *) dest,     \
+                                width);                                        \
+      return;
+
+    REVERSE (1)
+    REVERSE (2)
+    REVERSE (3)
+    REVERSE (4)
+    REVERSE (6)
+    REVERSE (8)
+    REVERSE (12)
+    REVERSE (16)
+
+#undef REVERSE
+    }
+
+  for (gint x = 0; x < width; x++)
+    memcpy (dest + x * bpp, src + (width - 1 - x) * bpp, bpp);
+}
+
+/* copies 'src_rect' of 'src_buffer' to 'dest_rect' of 'dest_buffer',
+ * where dest pixel (x, y) is src pixel (x, y), or (y, x) if 'transpose',
+ * mirrored horizontally and/or vertically within 'src_rect' afterwards.
+ * the dest buffer is written tile by tile, each tile from one read of
+ * the corresponding src area.
+ */
+static void
+gimp_gegl_buffer_permute (GeglBuffer          *src_buffer,
+                          const GeglRectangle *src_rect,
+                          GeglBuffer          *dest_buffer,
+                          const GeglRectangle *dest_rect,
+                          gboolean             transpose,
+                          gboolean             flip_x,
+                          gboolean             flip_y)
+{
+  const Babl *format = gegl_buffer_get_format (dest_buffer);
+  gint        bpp    = babl_format_get_bytes_per_pixel (format);
+  gboolean    sse2   = FALSE;
+
+#if COMPILE_SSE2_INTRINISICS
+  sse2 = (gimp_cpu_accel_get_support () & GIMP_CPU_ACCEL_X86_SSE2);
+#endif
+
+  gegl_parallel_distribute_area (
+    dest_rect, PIXELS_PER_THREAD,
+    [=] (const GeglRectangle *area)
+    {
+      GeglBufferIterator *iter;
+
+      iter = gegl_buffer_iterator_new (dest_buffer, area, 0, format,
+                                       GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE, 1);
+
+      while (gegl_buffer_iterator_next (iter))
+        {
+          const GeglRectangle *roi  = &iter->items[0].roi;
+          guint8              *dest = (guint8 *) iter->items[0].data;
+          GeglRectangle        src_area;
+          guint8              *src;
+          gint                 x, y;
+
+          x = roi->x - dest_rect->x;
+          y = roi->y - dest_rect->y;
+
+          if (transpose)
+            gegl_rectangle_set (&src_area, y, x, roi->height, roi->width);
+          else
+            gegl_rectangle_set (&src_area, x, y, roi->width, roi->height);
+
+          if (flip_x)
+            src_area.x = src_rect->width - src_area.x - src_area.width;
+
+          if (flip_y)
+            src_area.y = src_rect->height - src_area.y - src_area.height;
+
+          src_area.x += src_rect->x;
+          src_area.y += src_rect->y;
+
+          src = (guint8 *) gegl_scratch_alloc (src_area.width *
+                                               src_area.height * bpp);
+
+          gegl_buffer_get (src_buffer, &src_area, 1.0, format, src,
+                           GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+          if (transpose)
+            {
+              const guint8 *s           = src;
+              guint8       *d           = dest;
+              gint          src_stride  = src_area.width;
+              gint          dest_stride = roi->width;
+
+              /*  flipping the transposed src horizontally is flipping
+               *  the dest vertically
+               */
+              if (flip_y)
+                {
+                  s          += (gsize) (src_area.height - 1) * src_stride * bpp;
+                  src_stride  = -src_stride;
+                }
+
+              if (flip_x)
+                {
+                  d           += (gsize) (roi->height - 1) * dest_stride * bpp;
+                  dest_stride  = -dest_stride;
+                }
+
+              gimp_gegl_transpose (s, src_stride, d, dest_stride,
+                                   roi->width, roi->height, bpp, sse2);
+            }
+          else
+            {
+              gsize rowstride = (gsize) roi->width * bpp;
+
+              for (y = 0; y < roi->height; y++)
+                {
+                  const guint8 *s;
+
+                  s = src + (flip_y ? roi->height - 1 - y : y) * rowstride;
+
+                  if (flip_x)
+                    gimp_gegl_reverse (s, dest, roi->width, bpp);
+                  else
+                    memcpy (dest, s, rowstride);
+
+                  dest += rowstride;
+                }
+            }
+
+          gegl_scratch_free (src);
+        }
+    });
+}
+
+/* rotates 'src_rect' of 'src_buffer' into 'dest_rect' of 'dest_buffer',
+ * which must have the rotated size.  both buffers must have the same
+ * format.
+ */
+void
+gimp_gegl_buffer_rotate (GeglBuffer          *src_buffer,
+                         const GeglRectangle *src_rect,
+                         GeglBuffer          *dest_buffer,
+                         const GeglRectangle *dest_rect,
+                         GimpRotationType     rotate_type)
+{
+  if (! src_rect)
+    src_rect = gegl_buffer_get_extent (src_buffer);
+
+  if (! dest_rect)
+    dest_rect = gegl_buffer_get_extent (dest_buffer);
+
+  switch (rotate_type)
+    {
+    case GIMP_ROTATE_DEGREES90:
+      g_return_if_fail (dest_rect->width  == src_rect->height &&
+                        dest_rect->height == src_rect->width);
+
+      gimp_gegl_buffer_permute (src_buffer, src_rect, dest_buffer, dest_rect,
+                                TRUE, FALSE, TRUE);
+      break;
+
+    case GIMP_ROTATE_DEGREES180:
+      g_return_if_fail (dest_rect->width  == src_rect->width &&
+                        dest_rect->height == src_rect->height);
+
+      gimp_gegl_buffer_permute (src_buffer, src_rect, dest_buffer, dest_rect,
+                                FALSE, TRUE, TRUE);
+      break;
+
+    case GIMP_ROTATE_DEGREES270:
+      g_return_if_fail (dest_rect->width  == src_rect->height &&
+                        dest_rect->height == src_rect->width);
+
+      gimp_gegl_buffer_permute (src_buffer, src_rect, dest_buffer, dest_rect,
+                                TRUE, TRUE, FALSE);
+      break;
+
+    default:
+      g_return_if_reached ();
+    }
+}
+
+/* mirrors 'src_rect' of 'src_buffer' into 'dest_rect' of 'dest_buffer',
+ * which must have the same size.  both buffers must have the same
+ * format.
+ */
+void
+gimp_gegl_buffer_flip (GeglBuffer          *src_buffer,
+                       const GeglRectangle *src_rect,
+                       GeglBuffer          *dest_buffer,
+                       const GeglRectangle *dest_rect,
+                       GimpOrientationType  flip_type)
+{
+  if (! src_rect)
+    src_rect = gegl_buffer_get_extent (src_buffer);
+
+  if (! dest_rect)
+    dest_rect = gegl_buffer_get_extent (dest_buffer);
+
+  g_return_if_fail (dest_rect->width  == src_rect->width &&
+                    dest_rect->height == src_rect->height);
+
+  switch (flip_type)
+    {
+    case GIMP_ORIENTATION_HORIZONTAL:
+      gimp_gegl_buffer_permute (src_buffer, src_rect, dest_buffer, dest_rect,
+                                FALSE, TRUE, FALSE);
+      break;
+
+    case GIMP_ORIENTATION_VERTICAL:
+      gimp_gegl_buffer_permute (src_buffer, src_rect, dest_buffer, dest_rect,
+                                FALSE, FALSE, TRUE);
+      break;
+
+    default:
+      g_return_if_reached ();
+    }
+}
+
+/* helper function of gimp_gegl_convolve()
+ *
+ * checks if the kernel is the outer product of a column and a row vector,
+ * except for its center coefficient, which is the case for separable
+ * kernels, as well as for the blur and sharpen matrices of GimpConvolve,
+ * and returns the vectors, and the difference at the center.
+ */
+static gboolean
+gimp_gegl_convolve_separate (const gfloat *kernel,
+                             gint          kernel_size,
+                             gfloat       *row,
+                             gfloat       *col,
+                             gfloat       *center)
+{
+  const gint margin = kernel_size / 2;
+  gint       pivot_x = -1;
+  gint       pivot_y = -1;
+  gfloat     pivot   = 0.0f;
+  gint       i, j;
+
+#define KERNEL(x, y) (kernel[(y) * kernel_size + (x)])
+
+  if (kernel_size < 3)
+    return FALSE;
+
+  /*  find the largest coefficient outside of the center row and column,
+   *  which determines both vectors
+   */
+  for (j = 0; j < kernel_size; j++)
+    {
+      for (i = 0; i < kernel_size; i++)
+        {
+          if (i != margin && j != margin && fabsf (KERNEL (i, j)) > fabsf (pivot))
+            {
+              pivot   = KERNEL (i, j);
+              pivot_x = i;
+              pivot_y = j;
+            }
+        }
+    }
+
+  if (pivot != 0.0f)
+    {
+      for (i = 0; i < kernel_size; i++)
+        row[i] = KERNEL (i, pivot_y);
+
+      for (j = 0; j < kernel_size; j++)
+        col[j] = KERNEL (pivot_x, j) / pivot;
+    }
+  else
+    {
+      gboolean horizontal = FALSE;
+      gboolean vertical   = FALSE;
+
+      /*  the kernel is a cross, which can only be handled if one of its
+       *  arms is empty
+       */
+      for (i = 0; i < kernel_size; i++)
         {
-          SHIFTED_AREA (dest, src);
+          if (i != margin)
+            {
+              horizontal |= (KERNEL (i, margin) != 0.0f);
+              vertical   |= (KERNEL (margin, i) != 0.0f);
+            }
+        }
 
-          gegl_buffer_copy (src_buffer, src_area, abyss_policy,
-                            dest_buffer, dest_area);
-        });
+      if (horizontal == vertical)
+        return FALSE;
+
+      for (i = 0; i < kernel_size; i++)
+        {
+          if (horizontal)
+            {
+              row[i] = KERNEL (i, margin);
+              col[i] = (i == margin);
+            }
+          else
+            {
+              row[i] = (i == margin);
+              col[i] = KERNEL (margin, i);
+            }
+        }
     }
-}
 
-void
-gimp_gegl_clear (GeglBuffer          *buffer,
-                 const GeglRectangle *rect)
-{
-  const Babl *format;
-  gint        bpp;
-  gint        n_components;
-  gint        bpc;
-  gint        alpha_offset;
+  for (j = 0; j < kernel_size; j++)
+    {
+      for (i = 0; i < kernel_size; i++)
+        {
+          if (i == margin && j == margin)
+            continue;
 
-  g_return_if_fail (GEGL_IS_BUFFER (buffer));
+          if (fabsf (KERNEL (i, j) - col[j] * row[i]) >
+              1e-6f * fabsf (KERNEL (i, j)))
+            {
+              return FALSE;
+            }
+        }
+    }
 
-  if (! rect)
-    rect = gegl_buffer_get_extent (buffer);
+  *center = KERNEL (margin, margin) - col[margin] * row[margin];
 
-  format = gegl_buffer_get_format (buffer);
+#undef KERNEL
 
-  if (! babl_format_has_alpha (format))
-    return;
+  return TRUE;
+}
 
-  bpp          = babl_format_get_bytes_per_pixel (format);
-  n_components = babl_format_get_n_components (format);
-  bpc          = bpp / n_components;
-  alpha_offset = (n_components - 1) * bpc;
+/* helper function of gimp_gegl_convolve()
+ *
+ * dest[i] = sum (kernel[k] * src[i + k * stride]),  for 0 <= i < count
+ */
+static void
+gimp_gegl_convolve_line (const gfloat *src,
+                         gfloat       *dest,
+                         gint          count,
+                         const gfloat *kernel,
+                         gint          kernel_size,
+                         gint          stride,
+                         gboolean      sse2)
+{
+  gint i = 0;
+  gint k;
 
-  gegl_parallel_distribute_area (
-    rect, PIXELS_PER_THREAD,
-    [=] (const GeglRectangle *area)
+#if COMPILE_SSE2_INTRINISICS
+  if (sse2)
     {
-      GeglBufferIterator *iter;
-
-      iter = gegl_buffer_iterator_new (buffer, area, 0, format,
-                                       GEGL_ACCESS_READWRITE, GEGL_ABYSS_NONE,
-                                       1);
-
-      while (gegl_buffer_iterator_next (iter))
-        {
-          guint8 *data = (guint8 *) iter->items[0].data;
-          gint    i;
+      i = gimp_gegl_convolve_line_sse2 (src, dest, count,
+                                        kernel, kernel_size, stride);
+    }
+#endif
 
-          data += alpha_offset;
+  for (; i < count; i++)
+    {
+      const gfloat *s   = src + i;
+      gfloat        sum = 0.0f;
 
-          for (i = 0; i < iter->length; i++)
-            {
-              memset (data, 0, bpc);
+      for (k = 0; k < kernel_size; k++, s += stride)
+        sum += kernel[k] * *s;
 
-              data += bpp;
-            }
-        }
-    });
+      dest[i] = sum;
+    }
 }
 
 void
@@ -212,6 +1057,16 @@ gimp_gegl_convolve (GeglBuffer          *src_buffer,
   gint        dest_components;
   gfloat      offset;
 
+  gfloat     *row;
+  gfloat     *col;
+  gfloat      center;
+  gboolean    separable;
+  gboolean    sse2 = FALSE;
+
+#if COMPILE_SSE2_INTRINISICS
+  sse2 = (gimp_cpu_accel_get_support () & GIMP_CPU_ACCEL_X86_SSE2);
+#endif
+
   if (! src_rect)
     src_rect = gegl_buffer_get_extent (src_buffer);
 
@@ -264,6 +1119,17 @@ gimp_gegl_convolve (GeglBuffer          *src_buffer,
       offset = 0.0;
     }
 
+  /*  If the kernel is separable, convolve the rows and then the columns,
+   *  which takes 2 * kernel_size operations per pixel, instead of
+   *  kernel_size ^ 2.  Alpha weighting is the same as convolving
+   *  premultiplied pixels, and dividing by the resulting alpha.
+   */
+  row = g_new (gfloat, kernel_size);
+  col = g_new (gfloat, kernel_size);
+
+  separable = gimp_gegl_convolve_separate (kernel, kernel_size,
+                                           row, col, &center);
+
   gegl_parallel_distribute_area (
     dest_rect, PIXELS_PER_THREAD,
     [=] (const GeglRectangle *dest_area)
@@ -293,6 +1159,120 @@ gimp_gegl_convolve (GeglBuffer          *src_buffer,
           const gint  dest_y2 = dest_iter->items[0].roi.y + dest_iter->items[0].roi.height;
           gint        x, y;
 
+          if (separable)
+            {
+              const gint  width     = dest_iter->items[0].roi.width;
+              const gint  height    = dest_iter->items[0].roi.height;
+              const gint  rowstride = width * components;
+              gfloat     *line;
+              gfloat     *rows;
+              gfloat     *total;
+
+              line  = gegl_scratch_new (gfloat, (width + 2 * margin) * components);
+              rows  = gegl_scratch_new (gfloat, (height + 2 * margin) * rowstride);
+              total = gegl_scratch_new (gfloat, rowstride);
+
+              /*  convolve the rows, extending the edges of src  */
+              for (y = 0; y < height + 2 * margin; y++)
+                {
+                  const gfloat *s = src + CLAMP (dest_y1 - margin + y, y1, y2) *
+                                          src_rowstride;
+                  gfloat       *l = line;
+                  gint          b;
+
+                  for (x = dest_x1 - margin; x < dest_x2 + margin; x++)
+                    {
+                      const gfloat *p = s + CLAMP (x, x1, x2) * components;
+
+                      if (alpha_weighting)
+                        {
+                          for (b = 0; b < a_component; b++)
+                            l[b] = p[b] * p[a_component];
+
+                          l[a_component] = p[a_component];
+                        }
+                      else
+                        {
+                          for (b = 0; b < components; b++)
+                            l[b] = p[b];
+                        }
+
+                      l += components;
+                    }
+
+                  gimp_gegl_convolve_line (line, rows + y * rowstride,
+                                           rowstride, row, kernel_size,
+                                           components, sse2);
+                }
+
+              /*  convolve the columns, and add the center difference  */
+              for (y = 0; y < height; y++)
+                {
+                  const gfloat *s = src + CLAMP (dest_y1 + y, y1, y2) *
+                                          src_rowstride;
+                  const gfloat *t = total;
+                  gfloat       *d = dest;
+
+                  gimp_gegl_convolve_line (rows + y * rowstride, total,
+                                           rowstride, col, kernel_size,
+                                           rowstride, sse2);
+
+                  for (x = dest_x1; x < dest_x2; x++)
+                    {
+                      const gfloat *p = s + CLAMP (x, x1, x2) * components;
+                      gdouble       sum[4];
+                      gint          b;
+
+                      if (alpha_weighting)
+                        {
+                          const gfloat a = p[a_component];
+                          gdouble      weighted_divisor;
+
+                          for (b = 0; b < a_component; b++)
+                            sum[b] = t[b] + center * a * p[b];
+
+                          sum[a_component] = t[a_component] + center * a;
+
+                          weighted_divisor = sum[a_component];
+
+                          if (weighted_divisor == 0.0)
+                            weighted_divisor = divisor;
+
+                          for (b = 0; b < a_component; b++)
+                            sum[b] /= weighted_divisor;
+
+                          sum[a_component] /= divisor;
+
+                          for (b = 0; b < components; b++)
+                            sum[b] += offset;
+                        }
+                      else
+                        {
+                          for (b = 0; b < components; b++)
+                            sum[b] = (t[b] + center * p[b]) / divisor + offset;
+                        }
+
+                      for (b = 0; b < components; b++)
+                        {
+                          if (mode != GIMP_NORMAL_CONVOL && sum[b] < 0.0)
+                            sum[b] = - sum[b];
+
+                          *d++ = CLAMP (sum[b], 0.0, 1.0);
+                        }
+
+                      t += components;
+                    }
+
+                  dest += width * dest_components;
+                }
+
+              gegl_scratch_free (total);
+              gegl_scratch_free (rows);
+              gegl_scratch_free (line);
+
+              continue;
+            }
+
           for (y = dest_y1; y < dest_y2; y++)
             {
               gfloat *d = dest;
@@ -386,6 +1366,8 @@ gimp_gegl_convolve (GeglBuffer          *src_buffer,
         }
     });
 
+  g_free (row);
+  g_free (col);
   g_free (src);
 }
 
@@ -713,40 +1695,87 @@ gimp_gegl_apply_mask (GeglBuffer          *mask_buffer,
                       const GeglRectangle *dest_rect,
                       gdouble              opacity)
 {
+  const Babl *mask_format;
+  const Babl *dest_format;
+
   if (! mask_rect)
     mask_rect = gegl_buffer_get_extent (mask_buffer);
 
   if (! dest_rect)
     dest_rect = gegl_buffer_get_extent (dest_buffer);
 
+  mask_format = gegl_buffer_get_format (mask_buffer);
+  dest_format = gegl_buffer_get_format (dest_buffer);
+
   gegl_parallel_distribute_area (
     mask_rect, PIXELS_PER_THREAD,
-    [=] (const GeglRectangle *mask_area)
+    [=] (const GeglRectangle *area)
     {
-      GeglBufferIterator *iter;
+      TileIter       tiles;
+      GeglRectangle  mask_tile;
+      guint8        *pixel;
 
-      SHIFTED_AREA (dest, mask);
-
-      iter = gegl_buffer_iterator_new (mask_buffer, mask_area, 0,
-                                       babl_format ("Y float"),
-                                       GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 2);
+      pixel = (guint8 *) g_alloca (
+        MAX (babl_format_get_bytes_per_pixel (mask_format),
+             babl_format_get_bytes_per_pixel (dest_format)));
 
-      gegl_buffer_iterator_add (iter, dest_buffer, dest_area, 0,
-                                babl_format ("RGBA float"),
-                                GEGL_ACCESS_READWRITE, GEGL_ABYSS_NONE);
+      tile_iter_init (&tiles, mask_buffer, area);
 
-      while (gegl_buffer_iterator_next (iter))
+      while (tile_iter_next (&tiles, &mask_tile))
         {
-          const gfloat *mask  = (const gfloat *) iter->items[0].data;
-          gfloat       *dest  = (gfloat *)       iter->items[1].data;
-          gint          count = iter->length;
+          const GeglRectangle *mask_area = &mask_tile;
+          GeglBufferIterator  *iter;
+          gfloat               color[4];
 
-          while (count--)
+          SHIFTED_AREA (dest, mask);
+
+          /*  a constant mask either leaves the tile alone, or clears it  */
+          if (gimp_gegl_buffer_is_constant (mask_buffer, mask_area, pixel))
             {
-              dest[3] *= *mask * opacity;
+              babl_process (babl_fish (mask_format, babl_format ("Y float")),
+                            pixel, color, 1);
 
-              mask += 1;
-              dest += 4;
+              if (color[0] * opacity == 1.0)
+                continue;
+
+              if (color[0] * opacity == 0.0)
+                {
+                  gimp_gegl_clear (dest_buffer, dest_area);
+                  continue;
+                }
+            }
+
+          /*  and transparent parts of the destination stay transparent  */
+          if (gimp_gegl_buffer_is_constant (dest_buffer, dest_area, pixel))
+            {
+              babl_process (babl_fish (dest_format, babl_format ("RGBA float")),
+                            pixel, color, 1);
+
+              if (color[3] == 0.0f)
+                continue;
+            }
+
+          iter = gegl_buffer_iterator_new (mask_buffer, mask_area, 0,
+                                           babl_format ("Y float"),
+                                           GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 2);
+
+          gegl_buffer_iterator_add (iter, dest_buffer, dest_area, 0,
+                                    babl_format ("RGBA float"),
+                                    GEGL_ACCESS_READWRITE, GEGL_ABYSS_NONE);
+
+          while (gegl_buffer_iterator_next (iter))
+            {
+              const gfloat *mask  = (const gfloat *) iter->items[0].data;
+              gfloat       *dest  = (gfloat *)       iter->items[1].data;
+              gint          count = iter->length;
+
+              while (count--)
+                {
+                  dest[3] *= *mask * opacity;
+
+                  mask += 1;
+                  dest += 4;
+                }
             }
         }
     });
@@ -759,6 +1788,11 @@ gimp_gegl_combine_mask (GeglBuffer          *mask_buffer,
                         const GeglRectangle *dest_rect,
                         gdouble              opacity)
 {
+#if COMPILE_SSE2_INTRINISICS
+  gboolean sse2 = (gimp_cpu_accel_get_support () &
+                   GIMP_CPU_ACCEL_X86_SSE2);
+#endif
+
   if (! mask_rect)
     mask_rect = gegl_buffer_get_extent (mask_buffer);
 
@@ -787,6 +1821,18 @@ gimp_gegl_combine_mask (GeglBuffer          *mask_buffer,
           gfloat       *dest  = (gfloat *)       iter->items[1].data;
           gint          count = iter->length;
 
+#if COMPILE_SSE2_INTRINISICS
+          if (sse2)
+            {
+              gint n = gimp_gegl_combine_mask_process_sse2 (mask, dest, count,
+                                                            opacity);
+
+              mask  += n;
+              dest  += n;
+              count -= n;
+            }
+#endif
+
           while (count--)
             {
               *dest *= *mask * opacity;
@@ -806,6 +1852,11 @@ gimp_gegl_combine_mask_weird (GeglBuffer          *mask_buffer,
                               gdouble              opacity,
                               gboolean             stipple)
 {
+#if COMPILE_SSE2_INTRINISICS
+  gboolean sse2 = (gimp_cpu_accel_get_support () &
+                   GIMP_CPU_ACCEL_X86_SSE2);
+#endif
+
   if (! mask_rect)
     mask_rect = gegl_buffer_get_extent (mask_buffer);
 
@@ -834,6 +1885,20 @@ gimp_gegl_combine_mask_weird (GeglBuffer          *mask_buffer,
           gfloat       *dest  = (gfloat *)       iter->items[1].data;
           gint          count = iter->length;
 
+#if COMPILE_SSE2_INTRINISICS
+          if (sse2)
+            {
+              gint n = gimp_gegl_combine_mask_weird_process_sse2 (mask, dest,
+                                                                  count,
+                                                                  opacity,
+                                                                  stipple);
+
+              mask  += n;
+              dest  += n;
+              count -= n;
+            }
+#endif
+
           if (stipple)
             {
               while (count--)
@@ -867,6 +1932,11 @@ gimp_gegl_index_to_mask (GeglBuffer          *indexed_buffer,
                          const GeglRectangle *mask_rect,
                          gint                 index)
 {
+#if COMPILE_SSE2_INTRINISICS
+  gboolean sse2 = (gimp_cpu_accel_get_support () &
+                   GIMP_CPU_ACCEL_X86_SSE2);
+#endif
+
   if (! indexed_rect)
     indexed_rect = gegl_buffer_get_extent (indexed_buffer);
 
@@ -895,12 +1965,21 @@ gimp_gegl_index_to_mask (GeglBuffer          *indexed_buffer,
           gfloat       *mask    = (gfloat *)       iter->items[1].data;
           gint          count   = iter->length;
 
+#if COMPILE_SSE2_INTRINISICS
+          if (sse2)
+            {
+              gint n = gimp_gegl_index_to_mask_process_sse2 (indexed, mask,
+                                                             count, index);
+
+              indexed += n;
+              mask    += n;
+              count   -= n;
+            }
+#endif
+
           while (count--)
             {
-              if (*indexed == index)
-                *mask = 1.0;
-              else
-                *mask = 0.0;
+              *mask = (*indexed == index) ? 1.0f : 0.0f;
 
               indexed++;
               mask++;
@@ -917,10 +1996,13 @@ gimp_gegl_is_index_used (GeglBuffer          *indexed_buffer,
 {
   GeglBufferIterator *iter;
   gboolean            found = FALSE;
+  gint                bpp;
 
   if (! indexed_rect)
     indexed_rect = gegl_buffer_get_extent (indexed_buffer);
 
+  bpp = babl_format_get_bytes_per_pixel (indexed_format);
+
   iter = gegl_buffer_iterator_new (indexed_buffer, indexed_rect, 0,
                                    indexed_format,
                                    GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
@@ -936,19 +2018,22 @@ gimp_gegl_is_index_used (GeglBuffer          *indexed_buffer,
       const guchar *indexed = (const guchar *) iter->items[0].data;
       gint          count   = iter->length;
 
-      while (count--)
+      if (bpp == 1)
+        {
+          /*  memchr() is vectorized by the C library on most platforms  */
+          found = (memchr (indexed, index, count) != NULL);
+        }
+      else
         {
-          if (*indexed == index)
+          while (count--)
             {
-              /*
-               * Position of one item using this color index:
-               gint x = iter->items[0].roi.x + (iter->length - count - 1) % iter->items[0].roi.width;
-               gint y = iter->items[0].roi.y + (gint) ((iter->length - count - 1) / iter->items[0].roi.width);
-               */
-              found = TRUE;
-              break;
+              if (*indexed == index)
+                {
+                  found = TRUE;
+                  break;
+                }
+              indexed += bpp;
             }
-          indexed++;
         }
 
       if (found)
@@ -961,6 +2046,95 @@ gimp_gegl_is_index_used (GeglBuffer          *indexed_buffer,
   return found;
 }
 
+/* Sets the bits of the color indices used in 'indexed_buffer' in the
+ * 256 bits wide 'used' bitmap.  'used' can be shared by concurrent
+ * calls, and scanning stops as soon as the first 'n_indices' bits are
+ * all set, by any of them.
+ */
+void
+gimp_gegl_get_used_indices (GeglBuffer          *indexed_buffer,
+                            const GeglRectangle *indexed_rect,
+                            const Babl          *indexed_format,
+                            guint               *used,
+                            gint                 n_indices)
+{
+  guint all[8];
+  gint  bpp;
+  gint  i;
+
+  if (! indexed_rect)
+    indexed_rect = gegl_buffer_get_extent (indexed_buffer);
+
+  bpp = babl_format_get_bytes_per_pixel (indexed_format);
+
+  n_indices = CLAMP (n_indices, 1, 256);
+
+  for (i = 0; i < 8; i++)
+    {
+      gint n = CLAMP (n_indices - 32 * i, 0, 32);
+
+      all[i] = n == 32 ? 0xffffffff : (1u << n) - 1;
+    }
+
+  auto all_used = [=] ()
+  {
+    for (gint j = 0; j < 8; j++)
+      {
+        if ((g_atomic_int_get ((gint *) &used[j]) & all[j]) != all[j])
+          return FALSE;
+      }
+
+    return TRUE;
+  };
+
+  gegl_parallel_distribute_area (
+    indexed_rect, PIXELS_PER_THREAD,
+    [=] (const GeglRectangle *indexed_area)
+    {
+      GeglBufferIterator *iter;
+
+      if (all_used ())
+        return;
+
+      iter = gegl_buffer_iterator_new (indexed_buffer, indexed_area, 0,
+                                       indexed_format,
+                                       GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
+
+      while (gegl_buffer_iterator_next (iter))
+        {
+          const guchar *indexed = (const guchar *) iter->items[0].data;
+          gint          count   = iter->length;
+          guchar        seen[256];
+          guint         bits[8] = { 0, };
+          gint          j;
+
+          memset (seen, 0, sizeof (seen));
+
+          while (count--)
+            {
+              seen[*indexed] = 1;
+
+              indexed += bpp;
+            }
+
+          for (j = 0; j < 256; j++)
+            bits[j / 32] |= (guint) seen[j] << (j % 32);
+
+          for (j = 0; j < 8; j++)
+            {
+              if (bits[j] & ~ (guint) g_atomic_int_get ((gint *) &used[j]))
+                g_atomic_int_or (&used[j], bits[j]);
+            }
+
+          if (all_used ())
+            {
+              gegl_buffer_iterator_stop (iter);
+              break;
+            }
+        }
+    });
+}
+
 void
 gimp_gegl_shift_index (GeglBuffer          *indexed_buffer,
                        const GeglRectangle *indexed_rect,
@@ -968,12 +2142,16 @@ gimp_gegl_shift_index (GeglBuffer          *indexed_buffer,
                        gint                 from_index,
                        gint                 shift)
 {
-  gboolean indexed_format_has_alpha;
+  gint bpp;
+#if COMPILE_SSE2_INTRINISICS
+  gboolean sse2 = (gimp_cpu_accel_get_support () &
+                   GIMP_CPU_ACCEL_X86_SSE2);
+#endif
 
   if (! indexed_rect)
     indexed_rect = gegl_buffer_get_extent (indexed_buffer);
 
-  indexed_format_has_alpha = babl_format_has_alpha (indexed_format);
+  bpp = babl_format_has_alpha (indexed_format) ? 2 : 1;
 
   gegl_parallel_distribute_area (
     indexed_rect, PIXELS_PER_THREAD,
@@ -990,12 +2168,22 @@ gimp_gegl_shift_index (GeglBuffer          *indexed_buffer,
           guchar *indexed = (guchar *) iter->items[0].data;
           gint    count   = iter->length;
 
+#if COMPILE_SSE2_INTRINISICS
+          if (sse2)
+            {
+              gint n = gimp_gegl_shift_index_process_sse2 (indexed, count, bpp,
+                                                           from_index, shift);
+
+              indexed += n * bpp;
+              count   -= n;
+            }
+#endif
+
           while (count--)
             {
-              if (*indexed >= from_index)
-                *indexed += shift;
+              *indexed += (*indexed >= from_index) ? shift : 0;
 
-              indexed += (indexed_format_has_alpha ? 2 : 1);
+              indexed += bpp;
             }
         }
     });
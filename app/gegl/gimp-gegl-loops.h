@@ -26,10 +26,39 @@ void   gimp_gegl_buffer_copy           (GeglBuffer               *src_buffer,
                                         GeglAbyssPolicy           abyss_policy,
                                         GeglBuffer               *dest_buffer,
                                         const GeglRectangle      *dest_rect);
+void   gimp_gegl_buffer_copy_shared    (GeglBuffer               *src_buffer,
+                                        const GeglRectangle      *src_rect,
+                                        GeglAbyssPolicy           abyss_policy,
+                                        GeglBuffer               *dest_buffer,
+                                        const GeglRectangle      *dest_rect,
+                                        gint64                   *shared_size,
+                                        gint64                   *copied_size);
+void   gimp_gegl_buffer_offset         (GeglBuffer               *src_buffer,
+                                        const GeglRectangle      *src_rect,
+                                        GeglBuffer               *dest_buffer,
+                                        const GeglRectangle      *dest_roi,
+                                        gint                      offset_x,
+                                        gint                      offset_y,
+                                        gboolean                  wrap_around);
+gint64 gimp_gegl_buffer_share_unchanged (GeglBuffer              *src_buffer,
+                                         const GeglRectangle     *src_rect,
+                                         GeglBuffer              *dest_buffer,
+                                         const GeglRectangle     *dest_rect);
 
 void   gimp_gegl_clear                 (GeglBuffer               *buffer,
                                         const GeglRectangle      *rect);
 
+void   gimp_gegl_buffer_rotate         (GeglBuffer               *src_buffer,
+                                        const GeglRectangle      *src_rect,
+                                        GeglBuffer               *dest_buffer,
+                                        const GeglRectangle      *dest_rect,
+                                        GimpRotationType          rotate_type);
+void   gimp_gegl_buffer_flip           (GeglBuffer               *src_buffer,
+                                        const GeglRectangle      *src_rect,
+                                        GeglBuffer               *dest_buffer,
+                                        const GeglRectangle      *dest_rect,
+                                        GimpOrientationType       flip_type);
+
 /*  this is a pretty stupid port of concolve_region() that only works
  *  on a linear source buffer
  */
@@ -90,6 +119,11 @@ gboolean gimp_gegl_is_index_used       (GeglBuffer               *indexed_buffer
                                         const GeglRectangle      *indexed_rect,
                                         const Babl               *indexed_format,
                                         gint                      index);
+void     gimp_gegl_get_used_indices    (GeglBuffer               *indexed_buffer,
+                                        const GeglRectangle      *indexed_rect,
+                                        const Babl               *indexed_format,
+                                        guint                    *used,
+                                        gint                      n_indices);
 void     gimp_gegl_shift_index         (GeglBuffer               *indexed_buffer,
                                         const GeglRectangle      *indexed_rect,
                                         const Babl               *indexed_format,
@@ -22,6 +22,7 @@
 #include "gimp-gegl-types.h"
 
 #include "gegl/gimp-gegl-mask.h"
+#include "gegl/gimp-gegl-utils.h"
 
 
 gboolean
@@ -35,6 +36,7 @@ gimp_gegl_mask_bounds (GeglBuffer *buffer,
   const GeglRectangle *extent;
   const GeglRectangle *roi;
   const Babl          *format;
+  gconstpointer        empty_data;
   gint                 bpp;
   gint                 tx1, tx2, ty1, ty2;
 
@@ -52,8 +54,9 @@ gimp_gegl_mask_bounds (GeglBuffer *buffer,
   tx2 = extent->x;
   ty2 = extent->y;
 
-  format = gegl_buffer_get_format (buffer);
-  bpp    = babl_format_get_bytes_per_pixel (format);
+  format     = gegl_buffer_get_format (buffer);
+  bpp        = babl_format_get_bytes_per_pixel (format);
+  empty_data = gimp_gegl_buffer_get_empty_tile_data (buffer);
 
   iter = gegl_buffer_iterator_new (buffer, NULL, 0, format,
                                    GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
@@ -65,6 +68,10 @@ gimp_gegl_mask_bounds (GeglBuffer *buffer,
       gint          ex      = roi->x + roi->width;
       gint          ey      = roi->y + roi->height;
 
+      /*  skip empty tiles without looking at them  */
+      if (data_u8 == empty_data)
+        continue;
+
       /*  only check the pixels if this tile is not fully within the
        *  currently computed bounds
        */
@@ -229,19 +236,22 @@ gimp_gegl_mask_is_empty (GeglBuffer *buffer)
 {
   GeglBufferIterator *iter;
   const Babl         *format;
+  gconstpointer       empty_data;
   gint                bpp;
 
   g_return_val_if_fail (GEGL_IS_BUFFER (buffer), FALSE);
 
-  format = gegl_buffer_get_format (buffer);
-  bpp    = babl_format_get_bytes_per_pixel (format);
+  format     = gegl_buffer_get_format (buffer);
+  bpp        = babl_format_get_bytes_per_pixel (format);
+  empty_data = gimp_gegl_buffer_get_empty_tile_data (buffer);
 
   iter = gegl_buffer_iterator_new (buffer, NULL, 0, format,
                                    GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
 
   while (gegl_buffer_iterator_next (iter))
     {
-      if (! gegl_memeq_zero (iter->items[0].data, bpp * iter->length))
+      if (iter->items[0].data != empty_data &&
+          ! gegl_memeq_zero (iter->items[0].data, bpp * iter->length))
         {
           gegl_buffer_iterator_stop (iter);
 
@@ -28,6 +28,7 @@
 
 #include "gimp-gegl-nodes.h"
 #include "gimp-gegl-utils.h"
+#include "gimpopaquetiles.h"
 
 
 GeglNode *
@@ -173,7 +174,8 @@ gimp_gegl_mode_node_set_mode (GeglNode               *node,
                               GimpLayerColorSpace     composite_space,
                               GimpLayerCompositeMode  composite_mode)
 {
-  gdouble opacity;
+  gdouble          opacity;
+  GimpOpaqueTiles *opaque_tiles;
 
   g_return_if_fail (GEGL_IS_NODE (node));
 
@@ -187,7 +189,8 @@ gimp_gegl_mode_node_set_mode (GeglNode               *node,
     composite_mode = gimp_layer_mode_get_composite_mode (mode);
 
   gegl_node_get (node,
-                 "opacity", &opacity,
+                 "opacity",      &opacity,
+                 "opaque-tiles", &opaque_tiles,
                  NULL);
 
   /* setting the operation creates a new instance, so we have to set
@@ -200,7 +203,11 @@ gimp_gegl_mode_node_set_mode (GeglNode               *node,
                  "blend-space",     blend_space,
                  "composite-space", composite_space,
                  "composite-mode",  composite_mode,
+                 "opaque-tiles",    opaque_tiles,
                  NULL);
+
+  if (opaque_tiles)
+    gimp_opaque_tiles_unref (opaque_tiles);
 }
 
 void
@@ -214,6 +221,21 @@ gimp_gegl_mode_node_set_opacity (GeglNode *node,
                  NULL);
 }
 
+/*  lets the layer-mode op skip compositing its input wherever the
+ *  layer is known to be opaque.  'opaque_tiles' must track the layer's
+ *  unfiltered buffer, which its aux input renders, or be NULL.
+ */
+void
+gimp_gegl_mode_node_set_opaque_tiles (GeglNode        *node,
+                                      GimpOpaqueTiles *opaque_tiles)
+{
+  g_return_if_fail (GEGL_IS_NODE (node));
+
+  gegl_node_set (node,
+                 "opaque-tiles", opaque_tiles,
+                 NULL);
+}
+
 void
 gimp_gegl_node_set_matrix (GeglNode          *node,
                            const GimpMatrix3 *matrix)
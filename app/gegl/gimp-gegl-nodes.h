@@ -41,6 +41,9 @@ void       gimp_gegl_mode_node_set_mode        (GeglNode               *node,
                                                 GimpLayerCompositeMode  composite_mode);
 void       gimp_gegl_mode_node_set_opacity     (GeglNode               *node,
                                                 gdouble                 opacity);
+void       gimp_gegl_mode_node_set_opaque_tiles
+                                               (GeglNode               *node,
+                                                GimpOpaqueTiles        *opaque_tiles);
 
 void       gimp_gegl_node_set_matrix           (GeglNode               *node,
                                                 const GimpMatrix3      *matrix);
@@ -0,0 +1,260 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-gegl-profile.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Render profiling of the image graphs.
+ *
+ * GEGL processes the nodes of a graph one at a time, in an order where
+ * each node comes right after its inputs.  The nodes of interest (the
+ * mode nodes of drawables and applicators) are given an owner, and mark
+ * the time at the end of their processing; the time elapsed since the
+ * previous mark, on the same thread, is charged to the owner.  This
+ * includes the node itself, and all the nodes feeding it that have no
+ * owner of their own: a layer is charged for its source, mask and
+ * compositing, and a filter for its operation and for blending its
+ * result.
+ *
+ * Only the time spent within the blits of the tile validation handlers
+ * is accounted for, see gimp_gegl_profile_begin().
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <gegl.h>
+
+#include "gimp-gegl-types.h"
+
+#include "gimp-gegl-profile.h"
+
+
+typedef struct
+{
+  gdouble time;
+  gint64  n_pixels;
+} ProfileStats;
+
+typedef struct
+{
+  gint   depth;
+  gint64 last_mark;
+} ProfileClock;
+
+
+/*  local function prototypes  */
+
+static ProfileClock * gimp_gegl_profile_get_clock    (void);
+static void           gimp_gegl_profile_owner_notify (gpointer  data,
+                                                      GObject  *owner);
+
+
+/*  private variables  */
+
+static gint        profile_enabled = FALSE;
+static GMutex      profile_mutex;
+static GHashTable *profile_stats   = NULL;
+static GPrivate    profile_clock   = G_PRIVATE_INIT (g_free);
+
+static GQuark      owner_quark     = 0;
+
+
+/*  public functions  */
+
+void
+gimp_gegl_profile_set_enabled (gboolean enabled)
+{
+  g_atomic_int_set (&profile_enabled, enabled ? TRUE : FALSE);
+}
+
+gboolean
+gimp_gegl_profile_get_enabled (void)
+{
+  return g_atomic_int_get (&profile_enabled);
+}
+
+void
+gimp_gegl_profile_reset (void)
+{
+  g_mutex_lock (&profile_mutex);
+
+  if (profile_stats)
+    {
+      GHashTableIter iter;
+      gpointer       owner;
+      gpointer       stats;
+
+      g_hash_table_iter_init (&iter, profile_stats);
+
+      while (g_hash_table_iter_next (&iter, &owner, &stats))
+        memset (stats, 0, sizeof (ProfileStats));
+    }
+
+  g_mutex_unlock (&profile_mutex);
+}
+
+/* sets the object 'node' is charged to.  don't ref 'owner', the node
+ * is expected to be owned by it.
+ */
+void
+gimp_gegl_profile_set_node_owner (GeglNode *node,
+                                  GObject  *owner)
+{
+  g_return_if_fail (GEGL_IS_NODE (node));
+  g_return_if_fail (owner == NULL || G_IS_OBJECT (owner));
+
+  if (! owner_quark)
+    owner_quark = g_quark_from_static_string ("gimp-gegl-profile-owner");
+
+  g_object_set_qdata (G_OBJECT (node), owner_quark, owner);
+}
+
+/* starts an accounted evaluation of a graph on the current thread.
+ * evaluations can be nested, e.g., when a group layer's projection is
+ * validated while rendering the image.
+ */
+void
+gimp_gegl_profile_begin (void)
+{
+  ProfileClock *clock;
+
+  if (! gimp_gegl_profile_get_enabled ())
+    return;
+
+  clock = gimp_gegl_profile_get_clock ();
+
+  if (clock->depth++ == 0)
+    clock->last_mark = g_get_monotonic_time ();
+}
+
+void
+gimp_gegl_profile_end (void)
+{
+  ProfileClock *clock = g_private_get (&profile_clock);
+
+  if (clock && clock->depth > 0)
+    clock->depth--;
+}
+
+/* called by the operation of an owned node, once it's done processing
+ * 'roi'.
+ */
+void
+gimp_gegl_profile_mark (GeglOperation       *operation,
+                        const GeglRectangle *roi)
+{
+  ProfileClock *clock;
+  ProfileStats *stats;
+  GObject      *owner;
+  gint64        now;
+
+  if (! gimp_gegl_profile_get_enabled () || ! operation->node || ! owner_quark)
+    return;
+
+  clock = g_private_get (&profile_clock);
+
+  if (! clock || clock->depth == 0)
+    return;
+
+  now = g_get_monotonic_time ();
+
+  owner = g_object_get_qdata (G_OBJECT (operation->node), owner_quark);
+
+  if (! owner)
+    return;
+
+  g_mutex_lock (&profile_mutex);
+
+  if (! profile_stats)
+    profile_stats = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+  stats = g_hash_table_lookup (profile_stats, owner);
+
+  if (! stats)
+    {
+      stats = g_new0 (ProfileStats, 1);
+
+      g_hash_table_insert (profile_stats, owner, stats);
+
+      g_object_weak_ref (owner, gimp_gegl_profile_owner_notify, NULL);
+    }
+
+  stats->time     += (now - clock->last_mark) / 1000000.0;
+  stats->n_pixels += (gint64) roi->width * roi->height;
+
+  g_mutex_unlock (&profile_mutex);
+
+  clock->last_mark = now;
+}
+
+/* returns the time, in seconds, and the number of pixels charged to
+ * 'owner' since profiling was last reset.
+ */
+gboolean
+gimp_gegl_profile_get_stats (GObject *owner,
+                             gdouble *time,
+                             gint64  *n_pixels)
+{
+  ProfileStats *stats   = NULL;
+  gboolean      success;
+
+  g_return_val_if_fail (G_IS_OBJECT (owner), FALSE);
+
+  g_mutex_lock (&profile_mutex);
+
+  if (profile_stats)
+    stats = g_hash_table_lookup (profile_stats, owner);
+
+  if (time)     *time     = stats ? stats->time     : 0.0;
+  if (n_pixels) *n_pixels = stats ? stats->n_pixels : 0;
+
+  success = stats && stats->n_pixels > 0;
+
+  g_mutex_unlock (&profile_mutex);
+
+  return success;
+}
+
+
+/*  private functions  */
+
+static ProfileClock *
+gimp_gegl_profile_get_clock (void)
+{
+  ProfileClock *clock = g_private_get (&profile_clock);
+
+  if (! clock)
+    {
+      clock = g_new0 (ProfileClock, 1);
+
+      g_private_set (&profile_clock, clock);
+    }
+
+  return clock;
+}
+
+static void
+gimp_gegl_profile_owner_notify (gpointer  data,
+                                GObject  *owner)
+{
+  g_mutex_lock (&profile_mutex);
+
+  g_hash_table_remove (profile_stats, owner);
+
+  g_mutex_unlock (&profile_mutex);
+}
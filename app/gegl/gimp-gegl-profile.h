@@ -0,0 +1,37 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-gegl-profile.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+void       gimp_gegl_profile_set_enabled    (gboolean             enabled);
+gboolean   gimp_gegl_profile_get_enabled    (void);
+void       gimp_gegl_profile_reset          (void);
+
+void       gimp_gegl_profile_set_node_owner (GeglNode            *node,
+                                             GObject             *owner);
+
+void       gimp_gegl_profile_begin          (void);
+void       gimp_gegl_profile_end            (void);
+void       gimp_gegl_profile_mark           (GeglOperation       *operation,
+                                             const GeglRectangle *roi);
+
+gboolean   gimp_gegl_profile_get_stats      (GObject             *owner,
+                                             gdouble             *time,
+                                             gint64              *n_pixels);
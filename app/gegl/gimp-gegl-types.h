@@ -26,4 +26,6 @@
 #include "operations/operations-types.h"
 
 
-typedef struct _GimpApplicator GimpApplicator;
+typedef struct _GimpApplicator      GimpApplicator;
+typedef struct _GimpOpaqueTiles     GimpOpaqueTiles;
+typedef struct _GimpSummedAreaTable GimpSummedAreaTable;
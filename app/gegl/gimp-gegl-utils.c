@@ -26,6 +26,7 @@
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gegl.h>
 #include <gegl-plugin.h>
+#include <gegl-buffer-backend.h>
 
 #include "libgimpcolor/gimpcolor.h"
 
@@ -49,6 +50,14 @@ static GList    * gimp_gegl_get_op_subclasses (GType               type,
                                                gboolean            block_gimp_ops);
 static gint       gimp_gegl_compare_op_names  (GeglOperationClass *a,
                                                GeglOperationClass *b);
+static void       gimp_gegl_swap_file_remove  (gchar              *path);
+
+
+/*  local variables  */
+
+static GHashTable *empty_tile_data = NULL;
+
+G_LOCK_DEFINE_STATIC (empty_tile_data);
 
 
 /*  public functions  */
@@ -470,6 +479,279 @@ gimp_gegl_buffer_set_extent (GeglBuffer          *buffer,
   return gegl_buffer_set_extent (buffer, extent);
 }
 
+/* saves the contents of 'buffer' to a file in GEGL's swap directory, and
+ * returns a new buffer backed by that file, which only keeps the tiles
+ * that are in use in memory.  the file is removed together with the
+ * returned buffer.  it is created through GEGL's swap API, so GEGL
+ * removes it at startup if it is left behind by a crash.
+ *
+ * returns NULL if GEGL doesn't have a swap directory, or if the file
+ * can't be written.
+ */
+GeglBuffer *
+gimp_gegl_buffer_swap_out (GeglBuffer *buffer)
+{
+  GeglBuffer *swap_buffer = NULL;
+  gchar      *path;
+
+  g_return_val_if_fail (GEGL_IS_BUFFER (buffer), NULL);
+
+  path = gegl_buffer_swap_create_file ("gimp");
+
+  if (! path)
+    return NULL;
+
+  gegl_buffer_save (buffer, path, NULL);
+
+  if (g_file_test (path, G_FILE_TEST_IS_REGULAR))
+    swap_buffer = gegl_buffer_open (path);
+
+  if (swap_buffer &&
+      (gegl_buffer_get_format (swap_buffer) != gegl_buffer_get_format (buffer) ||
+       ! gegl_rectangle_equal (gegl_buffer_get_extent (swap_buffer),
+                               gegl_buffer_get_extent (buffer))))
+    {
+      g_clear_object (&swap_buffer);
+    }
+
+  if (! swap_buffer)
+    {
+      gimp_gegl_swap_file_remove (path);
+
+      return NULL;
+    }
+
+  g_object_set_data_full (G_OBJECT (swap_buffer),
+                          "gimp-swap-file", path,
+                          (GDestroyNotify) gimp_gegl_swap_file_remove);
+
+  return swap_buffer;
+}
+
+/* returns a new buffer backed by a file in GEGL's swap directory, like
+ * the ones returned by gimp_gegl_buffer_swap_out(), for creating pixels
+ * that are not meant to stay in memory.  only the tiles in use are kept
+ * in GEGL's tile cache, the others are written to the file by GEGL, in
+ * the background, as they are evicted.
+ *
+ * returns NULL if GEGL doesn't have a swap directory.
+ */
+GeglBuffer *
+gimp_gegl_buffer_new_swapped (const GeglRectangle *extent,
+                              const Babl          *format)
+{
+  GeglBuffer *buffer;
+  gchar      *path;
+
+  g_return_val_if_fail (extent != NULL, NULL);
+  g_return_val_if_fail (format != NULL, NULL);
+
+  path = gegl_buffer_swap_create_file ("gimp");
+
+  if (! path)
+    return NULL;
+
+  buffer = g_object_new (GEGL_TYPE_BUFFER,
+                         "x",      extent->x,
+                         "y",      extent->y,
+                         "width",  extent->width,
+                         "height", extent->height,
+                         "format", format,
+                         "path",   path,
+                         NULL);
+
+  g_object_set_data_full (G_OBJECT (buffer),
+                          "gimp-swap-file", path,
+                          (GDestroyNotify) gimp_gegl_swap_file_remove);
+
+  return buffer;
+}
+
+/* returns the data that GEGL shares among the empty tiles of 'buffer',
+ * or NULL if it doesn't share it.  when reading 'buffer' in its own
+ * format, an iterator whose data is this pointer covers a whole tile
+ * that is known to be all zeros, without looking at it.
+ */
+gconstpointer
+gimp_gegl_buffer_get_empty_tile_data (GeglBuffer *buffer)
+{
+  const Babl *format;
+  gint        tile_width;
+  gint        tile_height;
+  gint        tile_size;
+  gpointer    data;
+
+  g_return_val_if_fail (GEGL_IS_BUFFER (buffer), NULL);
+
+  format = gegl_buffer_get_format (buffer);
+
+  g_object_get (buffer,
+                "tile-width",  &tile_width,
+                "tile-height", &tile_height,
+                NULL);
+
+  tile_size = tile_width * tile_height *
+              babl_format_get_bytes_per_pixel (format);
+
+  G_LOCK (empty_tile_data);
+
+  if (! empty_tile_data)
+    empty_tile_data = g_hash_table_new (NULL, NULL);
+
+  if (! g_hash_table_lookup_extended (empty_tile_data,
+                                      GINT_TO_POINTER (tile_size),
+                                      NULL, &data))
+    {
+      GeglBuffer         *probe1;
+      GeglBuffer         *probe2;
+      GeglBufferIterator *iter;
+      const GeglRectangle rect = { 0, 0, tile_width, tile_height };
+
+      /*  read an empty tile of two different buffers at the same time,
+       *  so that their data can only be the same if it's shared, and
+       *  then lives as long as GEGL itself
+       */
+      probe1 = g_object_new (GEGL_TYPE_BUFFER,
+                             "x",           rect.x,
+                             "y",           rect.y,
+                             "width",       rect.width,
+                             "height",      rect.height,
+                             "tile-width",  tile_width,
+                             "tile-height", tile_height,
+                             "format",      format,
+                             NULL);
+      probe2 = g_object_new (GEGL_TYPE_BUFFER,
+                             "x",           rect.x,
+                             "y",           rect.y,
+                             "width",       rect.width,
+                             "height",      rect.height,
+                             "tile-width",  tile_width,
+                             "tile-height", tile_height,
+                             "format",      format,
+                             NULL);
+
+      iter = gegl_buffer_iterator_new (probe1, &rect, 0, format,
+                                       GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 2);
+      gegl_buffer_iterator_add (iter, probe2, &rect, 0, format,
+                                GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+
+      data = NULL;
+
+      if (gegl_buffer_iterator_next (iter))
+        {
+          if (iter->length == tile_width * tile_height &&
+              iter->items[0].data == iter->items[1].data)
+            {
+              data = iter->items[0].data;
+            }
+
+          gegl_buffer_iterator_stop (iter);
+        }
+
+      g_object_unref (probe1);
+      g_object_unref (probe2);
+
+      g_hash_table_insert (empty_tile_data, GINT_TO_POINTER (tile_size), data);
+    }
+
+  G_UNLOCK (empty_tile_data);
+
+  return data;
+}
+
+/* returns whether all the pixels of 'rect' have the same value, in
+ * which case it's written to 'pixel', if not NULL, in the format of
+ * 'buffer'.  nothing is written to the buffer, so empty tiles remain
+ * shared.
+ */
+gboolean
+gimp_gegl_buffer_is_constant (GeglBuffer          *buffer,
+                              const GeglRectangle *rect,
+                              gpointer             pixel)
+{
+  GeglBufferIterator *iter;
+  const Babl         *format;
+  gconstpointer       empty_data;
+  guint8             *value;
+  gboolean            has_value = FALSE;
+  gint                bpp;
+
+  g_return_val_if_fail (GEGL_IS_BUFFER (buffer), FALSE);
+
+  if (! rect)
+    rect = gegl_buffer_get_extent (buffer);
+
+  if (gegl_rectangle_is_empty (rect))
+    return FALSE;
+
+  format     = gegl_buffer_get_format (buffer);
+  bpp        = babl_format_get_bytes_per_pixel (format);
+  empty_data = gimp_gegl_buffer_get_empty_tile_data (buffer);
+  value      = g_alloca (bpp);
+
+  iter = gegl_buffer_iterator_new (buffer, rect, 0, format,
+                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 1);
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      const guint8 *data = iter->items[0].data;
+
+      if (! gimp_gegl_data_is_constant (data, bpp, iter->length, empty_data) ||
+          (has_value &&
+           (data == empty_data ? ! gegl_memeq_zero (value, bpp) :
+                                 memcmp (value, data, bpp))))
+        {
+          gegl_buffer_iterator_stop (iter);
+
+          return FALSE;
+        }
+
+      if (! has_value)
+        {
+          if (data == empty_data)
+            memset (value, 0, bpp);
+          else
+            memcpy (value, data, bpp);
+
+          has_value = TRUE;
+        }
+    }
+
+  if (pixel)
+    memcpy (pixel, value, bpp);
+
+  return TRUE;
+}
+
+/* returns whether the 'n_pixels' pixels of 'data' all have the same
+ * value.  if 'data' is 'empty_data', as returned by
+ * gimp_gegl_buffer_get_empty_tile_data(), it's all zeros.
+ */
+gboolean
+gimp_gegl_data_is_constant (gconstpointer data,
+                            gint          bpp,
+                            gint          n_pixels,
+                            gconstpointer empty_data)
+{
+  const guint8 *first = data;
+  const guint8 *pixel;
+  gint          i;
+
+  if (data == empty_data)
+    return TRUE;
+
+  if (gegl_memeq_zero (first, bpp))
+    return gegl_memeq_zero (first, (gsize) bpp * n_pixels);
+
+  for (i = 1, pixel = first + bpp; i < n_pixels; i++, pixel += bpp)
+    {
+      if (memcmp (pixel, first, bpp))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 
 /*  private functions  */
 
@@ -613,3 +895,10 @@ gimp_gegl_compare_op_names (GeglOperationClass *a,
 
   return strcmp (name_a, name_b);
 }
+
+static void
+gimp_gegl_swap_file_remove (gchar *path)
+{
+  gegl_buffer_swap_remove_file (path);
+  g_free (path);
+}
@@ -65,3 +65,16 @@ GeglBuffer  * gimp_gegl_buffer_resize                 (GeglBuffer          *buff
 
 gboolean      gimp_gegl_buffer_set_extent             (GeglBuffer          *buffer,
                                                        const GeglRectangle *extent);
+
+GeglBuffer  * gimp_gegl_buffer_swap_out               (GeglBuffer          *buffer);
+GeglBuffer  * gimp_gegl_buffer_new_swapped            (const GeglRectangle *extent,
+                                                      const Babl          *format);
+
+gconstpointer gimp_gegl_buffer_get_empty_tile_data    (GeglBuffer          *buffer);
+gboolean      gimp_gegl_buffer_is_constant            (GeglBuffer          *buffer,
+                                                       const GeglRectangle *rect,
+                                                       gpointer             pixel);
+gboolean      gimp_gegl_data_is_constant              (gconstpointer        data,
+                                                       gint                 bpp,
+                                                       gint                 n_pixels,
+                                                       gconstpointer        empty_data);
@@ -0,0 +1,388 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpopaquetiles.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <gio/gio.h>
+#include <gegl.h>
+
+#include "gimp-gegl-types.h"
+
+#include "gimpopaquetiles.h"
+
+
+/*  the size of the cells whose opacity is tracked  */
+#define CELL_SIZE        64
+
+/*  the time to spend scanning cells per idle iteration  */
+#define SCAN_TIME_BUDGET (G_TIME_SPAN_MILLISECOND * 2)
+
+
+enum
+{
+  CELL_OPAQUE = 1 << 0,
+  CELL_DIRTY  = 1 << 1
+};
+
+
+/*  keeps track of which CELL_SIZE x CELL_SIZE cells of a buffer are
+ *  fully opaque, so that the layer-mode ops can skip compositing what
+ *  is below them.  cells are marked dirty, and not opaque, as soon as
+ *  they're invalidated, and are scanned again at idle time.
+ *
+ *  an opaque tiles object is only ever written on the main thread, and
+ *  may be queried from any thread.
+ */
+struct _GimpOpaqueTiles
+{
+  gint           ref_count;
+  GMutex         mutex;
+
+  GeglBuffer    *buffer;
+  GeglRectangle  extent;
+  gboolean       has_alpha;
+  gboolean       active;
+
+  gint           n_cols;
+  gint           n_rows;
+  guint8        *cells;
+  gint           n_dirty;
+  gint           scan_index;
+
+  guint          idle_id;
+};
+
+
+/*  local function prototypes  */
+
+static void       gimp_opaque_tiles_queue_scan (GimpOpaqueTiles *tiles);
+static gboolean   gimp_opaque_tiles_scan       (GimpOpaqueTiles *tiles);
+
+
+G_DEFINE_BOXED_TYPE (GimpOpaqueTiles, gimp_opaque_tiles,
+                     gimp_opaque_tiles_ref, gimp_opaque_tiles_unref)
+
+
+/*  public functions  */
+
+GimpOpaqueTiles *
+gimp_opaque_tiles_new (void)
+{
+  GimpOpaqueTiles *tiles = g_slice_new0 (GimpOpaqueTiles);
+
+  tiles->ref_count = 1;
+  tiles->active    = TRUE;
+
+  g_mutex_init (&tiles->mutex);
+
+  return tiles;
+}
+
+GimpOpaqueTiles *
+gimp_opaque_tiles_ref (GimpOpaqueTiles *tiles)
+{
+  g_return_val_if_fail (tiles != NULL, NULL);
+
+  g_atomic_int_inc (&tiles->ref_count);
+
+  return tiles;
+}
+
+void
+gimp_opaque_tiles_unref (GimpOpaqueTiles *tiles)
+{
+  g_return_if_fail (tiles != NULL);
+
+  if (g_atomic_int_dec_and_test (&tiles->ref_count))
+    {
+      g_clear_object (&tiles->buffer);
+      g_free (tiles->cells);
+
+      g_mutex_clear (&tiles->mutex);
+
+      g_slice_free (GimpOpaqueTiles, tiles);
+    }
+}
+
+/*  sets the buffer whose opacity is tracked, or NULL, in which case
+ *  nothing is covered.  all the cells are scanned again.
+ */
+void
+gimp_opaque_tiles_set_buffer (GimpOpaqueTiles *tiles,
+                              GeglBuffer      *buffer)
+{
+  g_return_if_fail (tiles != NULL);
+  g_return_if_fail (buffer == NULL || GEGL_IS_BUFFER (buffer));
+
+  g_mutex_lock (&tiles->mutex);
+
+  g_set_object (&tiles->buffer, buffer);
+
+  g_clear_pointer (&tiles->cells, g_free);
+
+  tiles->n_cols     = 0;
+  tiles->n_rows     = 0;
+  tiles->n_dirty    = 0;
+  tiles->scan_index = 0;
+
+  if (buffer)
+    {
+      tiles->extent    = *gegl_buffer_get_extent (buffer);
+      tiles->has_alpha = babl_format_has_alpha (gegl_buffer_get_format (buffer));
+
+      /*  without alpha, the whole extent is opaque, and there's nothing
+       *  to scan
+       */
+      if (tiles->has_alpha)
+        {
+          gint n_cells;
+
+          tiles->n_cols = (tiles->extent.width  + CELL_SIZE - 1) / CELL_SIZE;
+          tiles->n_rows = (tiles->extent.height + CELL_SIZE - 1) / CELL_SIZE;
+
+          n_cells = tiles->n_cols * tiles->n_rows;
+
+          tiles->cells = g_malloc (n_cells);
+          memset (tiles->cells, CELL_DIRTY, n_cells);
+
+          tiles->n_dirty = n_cells;
+
+          gimp_opaque_tiles_queue_scan (tiles);
+        }
+    }
+
+  g_mutex_unlock (&tiles->mutex);
+}
+
+/*  inactive tiles don't cover anything, which is the case while the
+ *  pixels of the buffer are not what the layer composites, such as
+ *  when it has filters.
+ */
+void
+gimp_opaque_tiles_set_active (GimpOpaqueTiles *tiles,
+                              gboolean         active)
+{
+  g_return_if_fail (tiles != NULL);
+
+  g_mutex_lock (&tiles->mutex);
+
+  tiles->active = active;
+
+  g_mutex_unlock (&tiles->mutex);
+}
+
+/*  marks the cells intersecting 'rect', in buffer coordinates, as not
+ *  opaque, until they're scanned again.  must be called before the
+ *  changed pixels are rendered.
+ */
+void
+gimp_opaque_tiles_invalidate (GimpOpaqueTiles     *tiles,
+                              const GeglRectangle *rect)
+{
+  GeglRectangle area;
+  gint          col1, row1;
+  gint          col2, row2;
+  gint          row;
+
+  g_return_if_fail (tiles != NULL);
+  g_return_if_fail (rect != NULL);
+
+  g_mutex_lock (&tiles->mutex);
+
+  if (tiles->cells &&
+      gegl_rectangle_intersect (&area, rect, &tiles->extent))
+    {
+      col1 = (area.x - tiles->extent.x) / CELL_SIZE;
+      row1 = (area.y - tiles->extent.y) / CELL_SIZE;
+      col2 = (area.x + area.width  - tiles->extent.x - 1) / CELL_SIZE;
+      row2 = (area.y + area.height - tiles->extent.y - 1) / CELL_SIZE;
+
+      for (row = row1; row <= row2; row++)
+        {
+          guint8 *cell = tiles->cells + row * tiles->n_cols + col1;
+          gint    col;
+
+          for (col = col1; col <= col2; col++, cell++)
+            {
+              if (! (*cell & CELL_DIRTY))
+                tiles->n_dirty++;
+
+              *cell = CELL_DIRTY;
+            }
+        }
+
+      gimp_opaque_tiles_queue_scan (tiles);
+    }
+
+  g_mutex_unlock (&tiles->mutex);
+}
+
+/*  returns whether all the pixels of 'rect', in buffer coordinates, are
+ *  known to be fully opaque.  may be called from any thread.
+ */
+gboolean
+gimp_opaque_tiles_covers (GimpOpaqueTiles     *tiles,
+                          const GeglRectangle *rect)
+{
+  gboolean covers = FALSE;
+
+  g_return_val_if_fail (tiles != NULL, FALSE);
+  g_return_val_if_fail (rect != NULL, FALSE);
+
+  if (gegl_rectangle_is_empty (rect))
+    return FALSE;
+
+  g_mutex_lock (&tiles->mutex);
+
+  if (tiles->active && tiles->buffer &&
+      gegl_rectangle_contains (&tiles->extent, rect))
+    {
+      if (! tiles->has_alpha)
+        {
+          covers = TRUE;
+        }
+      else
+        {
+          gint col1 = (rect->x - tiles->extent.x) / CELL_SIZE;
+          gint row1 = (rect->y - tiles->extent.y) / CELL_SIZE;
+          gint col2 = (rect->x + rect->width  - tiles->extent.x - 1) / CELL_SIZE;
+          gint row2 = (rect->y + rect->height - tiles->extent.y - 1) / CELL_SIZE;
+          gint row;
+
+          covers = TRUE;
+
+          for (row = row1; covers && row <= row2; row++)
+            {
+              const guint8 *cell = tiles->cells + row * tiles->n_cols + col1;
+              gint          col;
+
+              for (col = col1; col <= col2; col++, cell++)
+                {
+                  if (*cell != CELL_OPAQUE)
+                    {
+                      covers = FALSE;
+                      break;
+                    }
+                }
+            }
+        }
+    }
+
+  g_mutex_unlock (&tiles->mutex);
+
+  return covers;
+}
+
+
+/*  private functions  */
+
+/*  called with the mutex held  */
+static void
+gimp_opaque_tiles_queue_scan (GimpOpaqueTiles *tiles)
+{
+  if (tiles->n_dirty > 0 && ! tiles->idle_id)
+    {
+      tiles->idle_id =
+        g_idle_add_full (G_PRIORITY_LOW,
+                         (GSourceFunc) gimp_opaque_tiles_scan,
+                         gimp_opaque_tiles_ref (tiles),
+                         (GDestroyNotify) gimp_opaque_tiles_unref);
+    }
+}
+
+static gboolean
+gimp_opaque_tiles_scan (GimpOpaqueTiles *tiles)
+{
+  gfloat alpha[CELL_SIZE * CELL_SIZE];
+  gint64 end_time = g_get_monotonic_time () + SCAN_TIME_BUDGET;
+
+  do
+    {
+      GeglBuffer    *buffer;
+      GeglRectangle  rect;
+      gint           index;
+      gint           n_cells;
+      gboolean       opaque;
+      gint           i;
+
+      g_mutex_lock (&tiles->mutex);
+
+      if (tiles->n_dirty == 0)
+        {
+          tiles->idle_id = 0;
+
+          g_mutex_unlock (&tiles->mutex);
+
+          return G_SOURCE_REMOVE;
+        }
+
+      n_cells = tiles->n_cols * tiles->n_rows;
+
+      index = tiles->scan_index % n_cells;
+
+      while (! (tiles->cells[index] & CELL_DIRTY))
+        index = (index + 1) % n_cells;
+
+      tiles->cells[index] = 0;
+      tiles->n_dirty--;
+      tiles->scan_index = index + 1;
+
+      gegl_rectangle_intersect (
+        &rect,
+        GEGL_RECTANGLE (tiles->extent.x + (index % tiles->n_cols) * CELL_SIZE,
+                        tiles->extent.y + (index / tiles->n_cols) * CELL_SIZE,
+                        CELL_SIZE, CELL_SIZE),
+        &tiles->extent);
+
+      buffer = g_object_ref (tiles->buffer);
+
+      g_mutex_unlock (&tiles->mutex);
+
+      gegl_buffer_get (buffer, &rect, 1.0, babl_format ("A float"), alpha,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+      opaque = TRUE;
+
+      for (i = 0; i < rect.width * rect.height; i++)
+        {
+          if (alpha[i] < 1.0f)
+            {
+              opaque = FALSE;
+              break;
+            }
+        }
+
+      g_mutex_lock (&tiles->mutex);
+
+      /*  the cell may have been invalidated, or the buffer replaced,
+       *  while it was being scanned
+       */
+      if (opaque && tiles->buffer == buffer && tiles->cells[index] == 0)
+        tiles->cells[index] = CELL_OPAQUE;
+
+      g_mutex_unlock (&tiles->mutex);
+
+      g_object_unref (buffer);
+    }
+  while (g_get_monotonic_time () < end_time);
+
+  return G_SOURCE_CONTINUE;
+}
@@ -0,0 +1,41 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpopaquetiles.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+#define GIMP_TYPE_OPAQUE_TILES (gimp_opaque_tiles_get_type ())
+
+
+GType             gimp_opaque_tiles_get_type   (void) G_GNUC_CONST;
+
+GimpOpaqueTiles * gimp_opaque_tiles_new        (void);
+GimpOpaqueTiles * gimp_opaque_tiles_ref        (GimpOpaqueTiles     *tiles);
+void              gimp_opaque_tiles_unref      (GimpOpaqueTiles     *tiles);
+
+void              gimp_opaque_tiles_set_buffer (GimpOpaqueTiles     *tiles,
+                                                GeglBuffer          *buffer);
+void              gimp_opaque_tiles_set_active (GimpOpaqueTiles     *tiles,
+                                                gboolean             active);
+
+void              gimp_opaque_tiles_invalidate (GimpOpaqueTiles     *tiles,
+                                                const GeglRectangle *rect);
+
+gboolean          gimp_opaque_tiles_covers     (GimpOpaqueTiles     *tiles,
+                                                const GeglRectangle *rect);
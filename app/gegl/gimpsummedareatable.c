@@ -0,0 +1,329 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpsummedareatable.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <cairo.h>
+#include <gio/gio.h>
+#include <gegl.h>
+
+#include "gimp-gegl-types.h"
+
+#include "gimpsummedareatable.h"
+#include "gimptilehandlervalidate.h"
+
+
+/*  the size of the cells that get a summed-area table  */
+#define CELL_SIZE 64
+
+/*  how many cells are kept at most, 64 KiB each  */
+#define MAX_CELLS 256
+
+
+/*  keeps summed-area tables of the premultiplied pixels of a buffer,
+ *  one per CELL_SIZE x CELL_SIZE cell, computed when an average is
+ *  first asked for over the cell.  the sum over any part of a cell
+ *  then takes four lookups, so that averaging a box only costs the
+ *  number of cells it touches.  cells are dropped as soon as they're
+ *  invalidated.
+ *
+ *  a summed-area table is only ever used on the main thread.
+ */
+struct _GimpSummedAreaTable
+{
+  GeglBuffer    *buffer;
+  GeglRectangle  extent;
+  const Babl    *format;
+
+  gint           n_cols;
+  gint           n_rows;
+  GHashTable    *cells;
+};
+
+
+/*  local function prototypes  */
+
+static gfloat * gimp_summed_area_table_compute_cell (GimpSummedAreaTable *table,
+                                                     const GeglRectangle *cell_rect);
+
+
+/*  public functions  */
+
+GimpSummedAreaTable *
+gimp_summed_area_table_new (void)
+{
+  GimpSummedAreaTable *table = g_slice_new0 (GimpSummedAreaTable);
+
+  table->cells = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+  return table;
+}
+
+void
+gimp_summed_area_table_free (GimpSummedAreaTable *table)
+{
+  g_return_if_fail (table != NULL);
+
+  g_clear_object (&table->buffer);
+  g_hash_table_unref (table->cells);
+
+  g_slice_free (GimpSummedAreaTable, table);
+}
+
+/*  sets the buffer to average, or NULL.  all the cells are dropped.  */
+void
+gimp_summed_area_table_set_buffer (GimpSummedAreaTable *table,
+                                   GeglBuffer          *buffer)
+{
+  g_return_if_fail (table != NULL);
+  g_return_if_fail (buffer == NULL || GEGL_IS_BUFFER (buffer));
+
+  g_set_object (&table->buffer, buffer);
+
+  g_hash_table_remove_all (table->cells);
+
+  table->n_cols = 0;
+  table->n_rows = 0;
+
+  if (buffer)
+    {
+      table->extent = *gegl_buffer_get_extent (buffer);
+      table->format = babl_format_with_space (
+        "RaGaBaA float",
+        babl_format_get_space (gegl_buffer_get_format (buffer)));
+
+      table->n_cols = (table->extent.width  + CELL_SIZE - 1) / CELL_SIZE;
+      table->n_rows = (table->extent.height + CELL_SIZE - 1) / CELL_SIZE;
+    }
+}
+
+/*  drops the cells intersecting 'rect', in buffer coordinates.  must be
+ *  called whenever the pixels of the buffer change.
+ */
+void
+gimp_summed_area_table_invalidate (GimpSummedAreaTable *table,
+                                   const GeglRectangle *rect)
+{
+  GeglRectangle area;
+  gint          col1, row1;
+  gint          col2, row2;
+  gint          row;
+
+  g_return_if_fail (table != NULL);
+  g_return_if_fail (rect != NULL);
+
+  if (g_hash_table_size (table->cells) == 0 ||
+      ! gegl_rectangle_intersect (&area, rect, &table->extent))
+    {
+      return;
+    }
+
+  col1 = (area.x - table->extent.x) / CELL_SIZE;
+  row1 = (area.y - table->extent.y) / CELL_SIZE;
+  col2 = (area.x + area.width  - table->extent.x - 1) / CELL_SIZE;
+  row2 = (area.y + area.height - table->extent.y - 1) / CELL_SIZE;
+
+  for (row = row1; row <= row2; row++)
+    {
+      gint col;
+
+      for (col = col1; col <= col2; col++)
+        {
+          g_hash_table_remove (table->cells,
+                               GINT_TO_POINTER (row * table->n_cols + col + 1));
+        }
+    }
+}
+
+/*  averages the pixels of 'rect', clipped to the buffer, like
+ *  gimp_gegl_average_color() does, and returns the average in 'format'.
+ *  returns FALSE, without touching 'pixel', if the average can't be
+ *  computed from the table, in which case the caller should fall back
+ *  to gimp_gegl_average_color().
+ */
+gboolean
+gimp_summed_area_table_get_average (GimpSummedAreaTable *table,
+                                    const GeglRectangle *rect,
+                                    const Babl          *format,
+                                    gpointer             pixel)
+{
+  GeglRectangle area;
+  gdouble       sum[4] = { 0.0, };
+  gfloat        average[4];
+  gint          col1, row1;
+  gint          col2, row2;
+  gint          row;
+  gint          c;
+
+  g_return_val_if_fail (table != NULL, FALSE);
+  g_return_val_if_fail (rect != NULL, FALSE);
+  g_return_val_if_fail (pixel != NULL, FALSE);
+
+  if (! table->buffer ||
+      babl_format_get_space (format) != babl_format_get_space (table->format))
+    {
+      return FALSE;
+    }
+
+  if (! gegl_rectangle_intersect (&area, rect, &table->extent))
+    {
+      memset (average, 0, sizeof (average));
+
+      babl_process (babl_fish (table->format, format), average, pixel, 1);
+
+      return TRUE;
+    }
+
+  col1 = (area.x - table->extent.x) / CELL_SIZE;
+  row1 = (area.y - table->extent.y) / CELL_SIZE;
+  col2 = (area.x + area.width  - table->extent.x - 1) / CELL_SIZE;
+  row2 = (area.y + area.height - table->extent.y - 1) / CELL_SIZE;
+
+  for (row = row1; row <= row2; row++)
+    {
+      gint col;
+
+      for (col = col1; col <= col2; col++)
+        {
+          gpointer       key = GINT_TO_POINTER (row * table->n_cols + col + 1);
+          GeglRectangle  cell_rect;
+          GeglRectangle  sub;
+          gfloat        *cell;
+          gboolean       temporary = FALSE;
+          gint           stride;
+          gint           x1, y1, x2, y2;
+
+          gegl_rectangle_intersect (&cell_rect,
+                                    GEGL_RECTANGLE (table->extent.x +
+                                                    col * CELL_SIZE,
+                                                    table->extent.y +
+                                                    row * CELL_SIZE,
+                                                    CELL_SIZE, CELL_SIZE),
+                                    &table->extent);
+          gegl_rectangle_intersect (&sub, &cell_rect, &area);
+
+          cell = g_hash_table_lookup (table->cells, key);
+
+          if (! cell)
+            {
+              GimpTileHandlerValidate *validate;
+
+              cell = gimp_summed_area_table_compute_cell (table, &cell_rect);
+
+              /*  reading the cell validates it, unless validation is
+               *  suspended, so only keep cells that are valid now
+               */
+              validate = gimp_tile_handler_validate_get_assigned (table->buffer);
+
+              if (validate &&
+                  cairo_region_contains_rectangle (
+                    validate->dirty_region,
+                    (const cairo_rectangle_int_t *) &cell_rect) !=
+                  CAIRO_REGION_OVERLAP_OUT)
+                {
+                  temporary = TRUE;
+                }
+              else
+                {
+                  if (g_hash_table_size (table->cells) >= MAX_CELLS)
+                    g_hash_table_remove_all (table->cells);
+
+                  g_hash_table_insert (table->cells, key, cell);
+                }
+            }
+
+          stride = cell_rect.width * 4;
+
+          /*  inclusive corners of 'sub', in cell coordinates  */
+          x1 = sub.x - cell_rect.x;
+          y1 = sub.y - cell_rect.y;
+          x2 = x1 + sub.width  - 1;
+          y2 = y1 + sub.height - 1;
+
+          for (c = 0; c < 4; c++)
+            {
+              gdouble s = cell[y2 * stride + x2 * 4 + c];
+
+              if (x1 > 0)
+                s -= cell[y2 * stride + (x1 - 1) * 4 + c];
+
+              if (y1 > 0)
+                s -= cell[(y1 - 1) * stride + x2 * 4 + c];
+
+              if (x1 > 0 && y1 > 0)
+                s += cell[(y1 - 1) * stride + (x1 - 1) * 4 + c];
+
+              sum[c] += s;
+            }
+
+          if (temporary)
+            g_free (cell);
+        }
+    }
+
+  for (c = 0; c < 4; c++)
+    average[c] = sum[c] / ((gdouble) area.width * area.height);
+
+  babl_process (babl_fish (table->format, format), average, pixel, 1);
+
+  return TRUE;
+}
+
+
+/*  private functions  */
+
+static gfloat *
+gimp_summed_area_table_compute_cell (GimpSummedAreaTable *table,
+                                     const GeglRectangle *cell_rect)
+{
+  gfloat *cell;
+  gint    stride = cell_rect->width * 4;
+  gint    x, y;
+  gint    c;
+
+  cell = g_new (gfloat, cell_rect->width * cell_rect->height * 4);
+
+  gegl_buffer_get (table->buffer, cell_rect, 1.0, table->format, cell,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  for (y = 0; y < cell_rect->height; y++)
+    {
+      gfloat  *p          = cell + y * stride;
+      gdouble  row_sum[4] = { 0.0, };
+
+      for (x = 0; x < cell_rect->width; x++)
+        {
+          for (c = 0; c < 4; c++)
+            {
+              row_sum[c] += p[c];
+
+              p[c] = row_sum[c];
+
+              if (y > 0)
+                p[c] += p[c - stride];
+            }
+
+          p += 4;
+        }
+    }
+
+  return cell;
+}
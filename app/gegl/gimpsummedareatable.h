@@ -0,0 +1,35 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpsummedareatable.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+GimpSummedAreaTable * gimp_summed_area_table_new         (void);
+void                  gimp_summed_area_table_free        (GimpSummedAreaTable *table);
+
+void                  gimp_summed_area_table_set_buffer  (GimpSummedAreaTable *table,
+                                                          GeglBuffer          *buffer);
+
+void                  gimp_summed_area_table_invalidate  (GimpSummedAreaTable *table,
+                                                          const GeglRectangle *rect);
+
+gboolean              gimp_summed_area_table_get_average (GimpSummedAreaTable *table,
+                                                          const GeglRectangle *rect,
+                                                          const Babl          *format,
+                                                          gpointer             pixel);
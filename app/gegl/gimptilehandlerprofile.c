@@ -0,0 +1,246 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <gio/gio.h>
+#include <gegl.h>
+
+#include "gimp-gegl-types.h"
+
+#include "gimptilehandlerprofile.h"
+
+
+static void     gimp_tile_handler_profile_finalize (GObject         *object);
+
+static gpointer gimp_tile_handler_profile_command  (GeglTileSource  *source,
+                                                    GeglTileCommand  command,
+                                                    gint             x,
+                                                    gint             y,
+                                                    gint             z,
+                                                    gpointer         data);
+
+static guint    gimp_tile_profile_count_hash       (const GimpTileProfileCount *count);
+static gboolean gimp_tile_profile_count_equal      (const GimpTileProfileCount *count1,
+                                                    const GimpTileProfileCount *count2);
+
+
+G_DEFINE_TYPE (GimpTileHandlerProfile, gimp_tile_handler_profile,
+               GEGL_TYPE_TILE_HANDLER)
+
+#define parent_class gimp_tile_handler_profile_parent_class
+
+
+static void
+gimp_tile_handler_profile_class_init (GimpTileHandlerProfileClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = gimp_tile_handler_profile_finalize;
+}
+
+static void
+gimp_tile_handler_profile_init (GimpTileHandlerProfile *profile)
+{
+  GeglTileSource *source = GEGL_TILE_SOURCE (profile);
+
+  source->command = gimp_tile_handler_profile_command;
+
+  g_mutex_init (&profile->mutex);
+
+  /*  the counts are their own keys  */
+  profile->tiles = g_hash_table_new_full (
+    (GHashFunc)  gimp_tile_profile_count_hash,
+    (GEqualFunc) gimp_tile_profile_count_equal,
+    NULL, g_free);
+
+  profile->tile_width  = 1;
+  profile->tile_height = 1;
+}
+
+static void
+gimp_tile_handler_profile_finalize (GObject *object)
+{
+  GimpTileHandlerProfile *profile = GIMP_TILE_HANDLER_PROFILE (object);
+
+  g_clear_pointer (&profile->tiles, g_hash_table_unref);
+
+  g_mutex_clear (&profile->mutex);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+/*  the profile sits above the tile cache, so it asks the cache whether a
+ *  tile is there before fetching it, and the backend whether it's in
+ *  swap, rather than observing the cache and backend themselves.
+ */
+static gpointer
+gimp_tile_handler_profile_command (GeglTileSource  *source,
+                                   GeglTileCommand  command,
+                                   gint             x,
+                                   gint             y,
+                                   gint             z,
+                                   gpointer         data)
+{
+  GimpTileHandlerProfile *profile = GIMP_TILE_HANDLER_PROFILE (source);
+  GimpTileProfileCount    key     = { x, y, z, };
+  GimpTileProfileCount   *count;
+  gpointer                tile;
+  gboolean                exists;
+
+  if (command != GEGL_TILE_GET ||
+      gegl_tile_handler_source_command (source, GEGL_TILE_IS_CACHED,
+                                        x, y, z, NULL))
+    {
+      return gegl_tile_handler_source_command (source, command,
+                                               x, y, z, data);
+    }
+
+  exists = gegl_tile_handler_source_command (source, GEGL_TILE_EXIST,
+                                             x, y, z, NULL) != NULL;
+
+  tile = gegl_tile_handler_source_command (source, command, x, y, z, data);
+
+  if (! tile)
+    return NULL;
+
+  g_mutex_lock (&profile->mutex);
+
+  count = g_hash_table_lookup (profile->tiles, &key);
+
+  if (! count)
+    {
+      count = g_memdup2 (&key, sizeof (key));
+
+      g_hash_table_add (profile->tiles, count);
+    }
+
+  count->misses++;
+
+  if (exists)
+    count->reads++;
+
+  g_mutex_unlock (&profile->mutex);
+
+  return tile;
+}
+
+static guint
+gimp_tile_profile_count_hash (const GimpTileProfileCount *count)
+{
+  return (guint) count->x * 73856093u ^
+         (guint) count->y * 19349663u ^
+         (guint) count->z * 83492791u;
+}
+
+static gboolean
+gimp_tile_profile_count_equal (const GimpTileProfileCount *count1,
+                               const GimpTileProfileCount *count2)
+{
+  return count1->x == count2->x &&
+         count1->y == count2->y &&
+         count1->z == count2->z;
+}
+
+
+/*  public functions  */
+
+GeglTileHandler *
+gimp_tile_handler_profile_new (void)
+{
+  return g_object_new (GIMP_TYPE_TILE_HANDLER_PROFILE, NULL);
+}
+
+void
+gimp_tile_handler_profile_assign (GimpTileHandlerProfile *profile,
+                                  GeglBuffer             *buffer)
+{
+  g_return_if_fail (GIMP_IS_TILE_HANDLER_PROFILE (profile));
+  g_return_if_fail (GEGL_IS_BUFFER (buffer));
+  g_return_if_fail (gimp_tile_handler_profile_get_assigned (buffer) == NULL);
+
+  gegl_buffer_add_handler (buffer, profile);
+
+  g_object_get (buffer,
+                "tile-width",  &profile->tile_width,
+                "tile-height", &profile->tile_height,
+                NULL);
+
+  g_object_set_data (G_OBJECT (buffer),
+                     "gimp-tile-handler-profile", profile);
+}
+
+void
+gimp_tile_handler_profile_unassign (GimpTileHandlerProfile *profile,
+                                    GeglBuffer             *buffer)
+{
+  g_return_if_fail (GIMP_IS_TILE_HANDLER_PROFILE (profile));
+  g_return_if_fail (GEGL_IS_BUFFER (buffer));
+  g_return_if_fail (gimp_tile_handler_profile_get_assigned (buffer) == profile);
+
+  g_object_set_data (G_OBJECT (buffer),
+                     "gimp-tile-handler-profile", NULL);
+
+  gegl_buffer_remove_handler (buffer, profile);
+}
+
+GimpTileHandlerProfile *
+gimp_tile_handler_profile_get_assigned (GeglBuffer *buffer)
+{
+  g_return_val_if_fail (GEGL_IS_BUFFER (buffer), NULL);
+
+  return g_object_get_data (G_OBJECT (buffer),
+                            "gimp-tile-handler-profile");
+}
+
+/*  returns a newly allocated array of the GimpTileProfileCount of each
+ *  tile fetched while not cached, in tile coordinates of level 'z'
+ */
+GArray *
+gimp_tile_handler_profile_get_counts (GimpTileHandlerProfile *profile)
+{
+  GArray         *counts;
+  GHashTableIter  iter;
+  gpointer        key;
+
+  g_return_val_if_fail (GIMP_IS_TILE_HANDLER_PROFILE (profile), NULL);
+
+  counts = g_array_new (FALSE, FALSE, sizeof (GimpTileProfileCount));
+
+  g_mutex_lock (&profile->mutex);
+
+  g_hash_table_iter_init (&iter, profile->tiles);
+
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    g_array_append_vals (counts, key, 1);
+
+  g_mutex_unlock (&profile->mutex);
+
+  return counts;
+}
+
+void
+gimp_tile_handler_profile_reset (GimpTileHandlerProfile *profile)
+{
+  g_return_if_fail (GIMP_IS_TILE_HANDLER_PROFILE (profile));
+
+  g_mutex_lock (&profile->mutex);
+
+  g_hash_table_remove_all (profile->tiles);
+
+  g_mutex_unlock (&profile->mutex);
+}
@@ -0,0 +1,76 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <gegl-buffer-backend.h>
+
+
+/***
+ * GimpTileHandlerProfile is a GeglTileHandler that counts the tiles of
+ * a buffer fetched while not in the tile cache, and those of them read
+ * back from swap.
+ */
+
+#define GIMP_TYPE_TILE_HANDLER_PROFILE            (gimp_tile_handler_profile_get_type ())
+#define GIMP_TILE_HANDLER_PROFILE(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GIMP_TYPE_TILE_HANDLER_PROFILE, GimpTileHandlerProfile))
+#define GIMP_TILE_HANDLER_PROFILE_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass),  GIMP_TYPE_TILE_HANDLER_PROFILE, GimpTileHandlerProfileClass))
+#define GIMP_IS_TILE_HANDLER_PROFILE(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GIMP_TYPE_TILE_HANDLER_PROFILE))
+#define GIMP_IS_TILE_HANDLER_PROFILE_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  GIMP_TYPE_TILE_HANDLER_PROFILE))
+#define GIMP_TILE_HANDLER_PROFILE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  GIMP_TYPE_TILE_HANDLER_PROFILE, GimpTileHandlerProfileClass))
+
+
+typedef struct _GimpTileHandlerProfile      GimpTileHandlerProfile;
+typedef struct _GimpTileHandlerProfileClass GimpTileHandlerProfileClass;
+
+struct _GimpTileHandlerProfile
+{
+  GeglTileHandler  parent_instance;
+
+  GMutex           mutex;
+  GHashTable      *tiles;
+  gint             tile_width;
+  gint             tile_height;
+};
+
+struct _GimpTileHandlerProfileClass
+{
+  GeglTileHandlerClass  parent_class;
+};
+
+typedef struct
+{
+  gint x;
+  gint y;
+  gint z;
+  gint misses;
+  gint reads;
+} GimpTileProfileCount;
+
+
+GType                    gimp_tile_handler_profile_get_type     (void) G_GNUC_CONST;
+
+GeglTileHandler        * gimp_tile_handler_profile_new          (void);
+
+void                     gimp_tile_handler_profile_assign       (GimpTileHandlerProfile *profile,
+                                                                 GeglBuffer             *buffer);
+void                     gimp_tile_handler_profile_unassign     (GimpTileHandlerProfile *profile,
+                                                                 GeglBuffer             *buffer);
+GimpTileHandlerProfile * gimp_tile_handler_profile_get_assigned (GeglBuffer             *buffer);
+
+GArray                 * gimp_tile_handler_profile_get_counts   (GimpTileHandlerProfile *profile);
+void                     gimp_tile_handler_profile_reset        (GimpTileHandlerProfile *profile);
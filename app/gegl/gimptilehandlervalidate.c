@@ -17,6 +17,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <cairo.h>
 #include <gio/gio.h>
 #include <gegl.h>
@@ -28,10 +30,19 @@
 #include "core/gimpchunkiterator.h"
 
 #include "gimp-gegl-loops.h"
+#include "gimp-gegl-profile.h"
 #include "gimp-gegl-utils.h"
 #include "gimptilehandlervalidate.h"
 
 
+#define PIXELS_PER_THREAD \
+  (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
+
+/* rounds towards negative infinity, for positive 'b' */
+#define FLOOR_DIV(a, b) \
+  ((a) >= 0 ? (a) / (b) : ((a) - (b) + 1) / (b))
+
+
 enum
 {
   INVALIDATED,
@@ -48,6 +59,13 @@ enum
 };
 
 
+typedef struct
+{
+  GimpTileHandlerValidate *validate;
+  GeglBuffer              *buffer;
+} ValidateParallelData;
+
+
 static void     gimp_tile_handler_validate_finalize             (GObject         *object);
 static void     gimp_tile_handler_validate_set_property         (GObject         *object,
                                                                  guint            property_id,
@@ -69,6 +87,9 @@ static void     gimp_tile_handler_validate_real_validate_buffer (GimpTileHandler
                                                                  const GeglRectangle     *rect,
                                                                  GeglBuffer              *buffer);
 
+static void     gimp_tile_handler_validate_clear_preview        (GimpTileHandlerValidate *validate,
+                                                                 const GeglRectangle     *rect);
+
 static gpointer gimp_tile_handler_validate_command              (GeglTileSource  *source,
                                                                  GeglTileCommand  command,
                                                                  gint             x,
@@ -76,6 +97,9 @@ static gpointer gimp_tile_handler_validate_command              (GeglTileSource
                                                                  gint             z,
                                                                  gpointer         data);
 
+static void     gimp_tile_handler_validate_parallel_area        (const GeglRectangle  *area,
+                                                                 ValidateParallelData *data);
+
 
 G_DEFINE_TYPE (GimpTileHandlerValidate, gimp_tile_handler_validate,
                GEGL_TYPE_TILE_HANDLER)
@@ -84,6 +108,9 @@ G_DEFINE_TYPE (GimpTileHandlerValidate, gimp_tile_handler_validate,
 
 static guint gimp_tile_handler_validate_signals[LAST_SIGNAL];
 
+/*  the nesting level of the preview reads of the current thread  */
+static GPrivate preview_reads = G_PRIVATE_INIT (NULL);
+
 
 static void
 gimp_tile_handler_validate_class_init (GimpTileHandlerValidateClass *klass)
@@ -149,6 +176,7 @@ gimp_tile_handler_validate_finalize (GObject *object)
 
   g_clear_object (&validate->graph);
   g_clear_pointer (&validate->dirty_region, cairo_region_destroy);
+  g_clear_pointer (&validate->preview_region, cairo_region_destroy);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -238,9 +266,13 @@ gimp_tile_handler_validate_real_validate (GimpTileHandlerValidate *validate,
               rect.height);
 #endif
 
+  gimp_gegl_profile_begin ();
+
   gegl_node_blit (validate->graph, 1.0, rect, format,
                   dest_buf, dest_stride,
                   GEGL_BLIT_DEFAULT);
+
+  gimp_gegl_profile_end ();
 }
 
 static void
@@ -254,8 +286,12 @@ gimp_tile_handler_validate_real_validate_buffer (GimpTileHandlerValidate *valida
 
   if (klass->validate == gimp_tile_handler_validate_real_validate)
     {
+      gimp_gegl_profile_begin ();
+
       gegl_node_blit_buffer (validate->graph, buffer, rect, 0,
                              GEGL_ABYSS_NONE);
+
+      gimp_gegl_profile_end ();
     }
   else
     {
@@ -271,6 +307,20 @@ gimp_tile_handler_validate_real_validate_buffer (GimpTileHandlerValidate *valida
     }
 }
 
+static void
+gimp_tile_handler_validate_clear_preview (GimpTileHandlerValidate *validate,
+                                          const GeglRectangle     *rect)
+{
+  if (validate->preview_region)
+    {
+      cairo_region_subtract_rectangle (validate->preview_region,
+                                       (const cairo_rectangle_int_t *) rect);
+
+      if (cairo_region_is_empty (validate->preview_region))
+        g_clear_pointer (&validate->preview_region, cairo_region_destroy);
+    }
+}
+
 static GeglTile *
 gimp_tile_handler_validate_validate_tile (GeglTileSource *source,
                                           gint            x,
@@ -293,6 +343,20 @@ gimp_tile_handler_validate_validate_tile (GeglTileSource *source,
   tile_rect.width  = validate->tile_width;
   tile_rect.height = validate->tile_height;
 
+  /*  dirty tiles holding a coarse preview are returned as is to the
+   *  display, which shows the preview until the tiles are explicitly
+   *  validated, and validated on demand for everyone else; see
+   *  gimp_tile_handler_validate_preview().
+   */
+  if (validate->preview_region &&
+      g_private_get (&preview_reads) &&
+      cairo_region_contains_rectangle (validate->preview_region,
+                                       &tile_rect) == CAIRO_REGION_OVERLAP_IN)
+    {
+      return gegl_tile_handler_source_command (source,
+                                               GEGL_TILE_GET, x, y, 0, NULL);
+    }
+
   overlap = cairo_region_contains_rectangle (validate->dirty_region,
                                              &tile_rect);
 
@@ -302,6 +366,9 @@ gimp_tile_handler_validate_validate_tile (GeglTileSource *source,
                                                GEGL_TILE_GET, x, y, 0, NULL);
     }
 
+  gimp_tile_handler_validate_clear_preview (
+    validate, (const GeglRectangle *) &tile_rect);
+
   if (overlap == CAIRO_REGION_OVERLAP_IN || validate->whole_tile)
     {
       gint tile_bpp;
@@ -422,6 +489,14 @@ gimp_tile_handler_validate_command (GeglTileSource  *source,
   return gegl_tile_handler_source_command (source, command, x, y, z, data);
 }
 
+static void
+gimp_tile_handler_validate_parallel_area (const GeglRectangle  *area,
+                                          ValidateParallelData *data)
+{
+  GIMP_TILE_HANDLER_VALIDATE_GET_CLASS (data->validate)->validate_buffer (
+    data->validate, area, data->buffer);
+}
+
 
 /*  public functions  */
 
@@ -492,6 +567,8 @@ gimp_tile_handler_validate_invalidate (GimpTileHandlerValidate *validate,
   cairo_region_union_rectangle (validate->dirty_region,
                                 (cairo_rectangle_int_t *) rect);
 
+  gimp_tile_handler_validate_clear_preview (validate, rect);
+
   gegl_tile_handler_damage_rect (GEGL_TILE_HANDLER (validate), rect);
 
   g_signal_emit (validate, gimp_tile_handler_validate_signals[INVALIDATED],
@@ -605,6 +682,8 @@ gimp_tile_handler_validate_validate (GimpTileHandlerValidate *validate,
           cairo_region_subtract_rectangle (
             validate->dirty_region,
             (const cairo_rectangle_int_t *) rect);
+
+          gimp_tile_handler_validate_clear_preview (validate, rect);
         }
 
       g_clear_pointer (&region, cairo_region_destroy);
@@ -620,9 +699,186 @@ gimp_tile_handler_validate_validate (GimpTileHandlerValidate *validate,
       cairo_region_subtract_rectangle (
             validate->dirty_region,
             (const cairo_rectangle_int_t *) rect);
+
+      gimp_tile_handler_validate_clear_preview (validate, rect);
     }
 }
 
+/* like gimp_tile_handler_validate_validate(), with neither 'intersect' nor
+ * 'chunked', except that 'rect' is split into smaller areas, which are
+ * rendered concurrently.  the dirty region is only updated by the calling
+ * thread.
+ *
+ * only handlers that provide their own validate_buffer(), which must be
+ * safe to call from multiple threads at once, are rendered concurrently.
+ * the default validate_buffer() blits the graph, and a single graph can't
+ * be processed by more than one thread at a time, so it's rendered on the
+ * calling thread, relying on the operations' own threading.
+ */
+void
+gimp_tile_handler_validate_validate_parallel (GimpTileHandlerValidate *validate,
+                                              GeglBuffer              *buffer,
+                                              const GeglRectangle     *rect)
+{
+  GimpTileHandlerValidateClass *klass;
+  ValidateParallelData          data;
+
+  g_return_if_fail (GIMP_IS_TILE_HANDLER_VALIDATE (validate));
+  g_return_if_fail (gimp_tile_handler_validate_get_assigned (buffer) ==
+                    validate);
+
+  klass = GIMP_TILE_HANDLER_VALIDATE_GET_CLASS (validate);
+
+  if (! rect)
+    rect = gegl_buffer_get_extent (buffer);
+
+  if (klass->validate_buffer == gimp_tile_handler_validate_real_validate_buffer)
+    {
+      gimp_tile_handler_validate_validate (validate, buffer, rect,
+                                           FALSE, FALSE);
+
+      return;
+    }
+
+  data.validate = validate;
+  data.buffer   = buffer;
+
+  gimp_tile_handler_validate_begin_validate (validate);
+
+  gegl_parallel_distribute_area (
+    rect, PIXELS_PER_THREAD, GEGL_SPLIT_STRATEGY_AUTO,
+    (GeglParallelDistributeAreaFunc)
+      gimp_tile_handler_validate_parallel_area,
+    &data);
+
+  gimp_tile_handler_validate_end_validate (validate);
+
+  cairo_region_subtract_rectangle (
+    validate->dirty_region,
+    (const cairo_rectangle_int_t *) rect);
+
+  gimp_tile_handler_validate_clear_preview (validate, rect);
+}
+
+/* renders 'rect' at mipmap 'level', and writes the result, scaled up, to
+ * the buffer.  unlike the actual validation functions, 'rect' stays dirty,
+ * so that the coarse result is replaced by the full resolution one when
+ * it's explicitly validated.  until then, reading the tiles between
+ * gimp_tile_handler_validate_begin_preview() and
+ * gimp_tile_handler_validate_end_preview() returns the coarse
+ * result, while any other read validates them on demand, as usual.
+ */
+void
+gimp_tile_handler_validate_preview (GimpTileHandlerValidate *validate,
+                                    GeglBuffer              *buffer,
+                                    const GeglRectangle     *rect,
+                                    gint                     level)
+{
+  const gint  scale       = 1 << level;
+  const gint  band_height = MAX (validate->tile_height, scale);
+  gint        bpp;
+  guchar     *coarse_data;
+  guchar     *data;
+  gint        x1, x2;
+  gint        y;
+
+  g_return_if_fail (GIMP_IS_TILE_HANDLER_VALIDATE (validate));
+  g_return_if_fail (gimp_tile_handler_validate_get_assigned (buffer) ==
+                    validate);
+  g_return_if_fail (rect != NULL);
+  g_return_if_fail (level >= 0 && level < 8);
+
+  if (gegl_rectangle_is_empty (rect))
+    return;
+
+  bpp = babl_format_get_bytes_per_pixel (validate->format);
+
+  /* the coarse pixels covering the rect's columns */
+  x1 = FLOOR_DIV (rect->x,                   scale);
+  x2 = FLOOR_DIV (rect->x + rect->width - 1, scale) + 1;
+
+  coarse_data = g_malloc ((gsize) (x2 - x1) * bpp *
+                          (band_height / scale + 1));
+  data        = g_malloc ((gsize) rect->width * bpp * band_height);
+
+  gimp_tile_handler_validate_begin_validate (validate);
+
+  /* render in bands, to keep the memory use bounded for large rects */
+  for (y = rect->y; y < rect->y + rect->height; y += band_height)
+    {
+      gint height = MIN (band_height, rect->y + rect->height - y);
+      gint y1     = FLOOR_DIV (y,              scale);
+      gint y2     = FLOOR_DIV (y + height - 1, scale) + 1;
+      gint row;
+
+      gimp_gegl_profile_begin ();
+
+      gegl_node_blit (validate->graph, 1.0 / scale,
+                      GEGL_RECTANGLE (x1, y1, x2 - x1, y2 - y1),
+                      validate->format, coarse_data,
+                      (x2 - x1) * bpp, GEGL_BLIT_DEFAULT);
+
+      gimp_gegl_profile_end ();
+
+      /* scale up using nearest neighbor */
+      for (row = 0; row < height; row++)
+        {
+          const guchar *src;
+          guchar       *dest = data + row * rect->width * bpp;
+          gint          x;
+
+          src = coarse_data +
+                (FLOOR_DIV (y + row, scale) - y1) * (x2 - x1) * bpp;
+
+          for (x = rect->x; x < rect->x + rect->width; x++)
+            {
+              memcpy (dest, src + (FLOOR_DIV (x, scale) - x1) * bpp, bpp);
+
+              dest += bpp;
+            }
+        }
+
+      gegl_buffer_set (buffer,
+                       GEGL_RECTANGLE (rect->x, y, rect->width, height), 0,
+                       validate->format, data, GEGL_AUTO_ROWSTRIDE);
+    }
+
+  gimp_tile_handler_validate_end_validate (validate);
+
+  g_free (data);
+  g_free (coarse_data);
+
+  if (! validate->preview_region)
+    validate->preview_region = cairo_region_create ();
+
+  cairo_region_union_rectangle (validate->preview_region,
+                                (const cairo_rectangle_int_t *) rect);
+}
+
+/* makes the reads of the calling thread, until the matching
+ * gimp_tile_handler_validate_end_preview(), return the coarse preview
+ * of tiles that have one, instead of validating them.  only meant for
+ * showing the buffer on the display, which is updated once the tiles are
+ * validated.
+ */
+void
+gimp_tile_handler_validate_begin_preview (void)
+{
+  gint n_reads = GPOINTER_TO_INT (g_private_get (&preview_reads));
+
+  g_private_set (&preview_reads, GINT_TO_POINTER (n_reads + 1));
+}
+
+void
+gimp_tile_handler_validate_end_preview (void)
+{
+  gint n_reads = GPOINTER_TO_INT (g_private_get (&preview_reads));
+
+  g_return_if_fail (n_reads > 0);
+
+  g_private_set (&preview_reads, GINT_TO_POINTER (n_reads - 1));
+}
+
 gboolean
 gimp_tile_handler_validate_buffer_set_extent (GeglBuffer          *buffer,
                                               const GeglRectangle *extent)
@@ -645,6 +901,12 @@ gimp_tile_handler_validate_buffer_set_extent (GeglBuffer          *buffer,
       cairo_region_intersect_rectangle (validate->dirty_region,
                                         (const cairo_rectangle_int_t *) extent);
 
+      if (validate->preview_region)
+        {
+          cairo_region_intersect_rectangle (validate->preview_region,
+                                            (const cairo_rectangle_int_t *) extent);
+        }
+
       return TRUE;
     }
 
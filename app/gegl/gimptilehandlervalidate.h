@@ -42,6 +42,7 @@ struct _GimpTileHandlerValidate
 
   GeglNode        *graph;
   cairo_region_t  *dirty_region;
+  cairo_region_t  *preview_region;
   const Babl      *format;
   gint             tile_width;
   gint             tile_height;
@@ -95,6 +96,15 @@ void                      gimp_tile_handler_validate_validate          (GimpTile
                                                                         const GeglRectangle     *rect,
                                                                         gboolean                 intersect,
                                                                         gboolean                 chunked);
+void                      gimp_tile_handler_validate_validate_parallel (GimpTileHandlerValidate *validate,
+                                                                        GeglBuffer              *buffer,
+                                                                        const GeglRectangle     *rect);
+void                      gimp_tile_handler_validate_preview           (GimpTileHandlerValidate *validate,
+                                                                        GeglBuffer              *buffer,
+                                                                        const GeglRectangle     *rect,
+                                                                        gint                     level);
+void                      gimp_tile_handler_validate_begin_preview     (void);
+void                      gimp_tile_handler_validate_end_preview       (void);
 
 gboolean                  gimp_tile_handler_validate_buffer_set_extent (GeglBuffer              *buffer,
                                                                         const GeglRectangle     *extent);
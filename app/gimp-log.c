@@ -17,8 +17,19 @@
 
 #include "config.h"
 
+#if defined (GIMP_TRACING_TRACY)
+#include <tracy/TracyC.h>
+#elif defined (GIMP_TRACING_JSON)
+#include <stdio.h>
+#include <stdlib.h>
+#endif
+
 #include "glib-object.h"
 
+#ifdef GIMP_TRACING_JSON
+#include <glib/gstdio.h>
+#endif
+
 #include "gimp-debug.h"
 #include "gimp-log.h"
 
@@ -45,7 +56,9 @@ static const GDebugKey log_keys[] =
   { "rectangle-tool",     GIMP_LOG_RECTANGLE_TOOL     },
   { "brush-cache",        GIMP_LOG_BRUSH_CACHE        },
   { "projection",         GIMP_LOG_PROJECTION         },
-  { "xcf",                GIMP_LOG_XCF                }
+  { "xcf",                GIMP_LOG_XCF                },
+  { "plug-in-pool",       GIMP_LOG_PLUG_IN_POOL       },
+  { "tile-sharing",       GIMP_LOG_TILE_SHARING       }
 };
 
 static const gchar * const log_domains[] =
@@ -86,6 +99,21 @@ static const gchar * const log_domains[] =
 
 GimpLogFlags gimp_log_flags = 0;
 
+#ifdef GIMP_TRACING_JSON
+static FILE     *trace_file       = NULL;
+static gboolean  trace_first      = TRUE;
+static gint64    trace_start_time = 0;
+static gint      trace_n_threads  = 0;
+static GPrivate  trace_thread_id;
+static GMutex    trace_mutex;
+#endif
+
+
+#ifdef GIMP_TRACING_JSON
+static void   gimp_trace_init (void);
+static void   gimp_trace_exit (void);
+#endif
+
 
 void
 gimp_log_init (void)
@@ -130,6 +158,10 @@ gimp_log_init (void)
                                                  G_N_ELEMENTS (log_keys));
         }
     }
+
+#ifdef GIMP_TRACING_JSON
+  gimp_trace_init ();
+#endif
 }
 
 void
@@ -217,3 +249,125 @@ gimp_log_remove_handler (GimpLogHandler handler)
 
   g_free (handler);
 }
+
+#if defined (GIMP_TRACING_TRACY)
+
+G_STATIC_ASSERT (sizeof (GimpTraceLocation) ==
+                 sizeof (struct ___tracy_source_location_data));
+
+void
+gimp_trace_begin (GimpTraceSpan           *span,
+                  const GimpTraceLocation *location)
+{
+  TracyCZoneCtx ctx;
+
+  ctx = ___tracy_emit_zone_begin (
+    (const struct ___tracy_source_location_data *) location, TRUE);
+
+  span->location = location;
+  span->id       = ctx.id;
+  span->active   = ctx.active;
+}
+
+void
+gimp_trace_end (GimpTraceSpan *span)
+{
+  TracyCZoneCtx ctx;
+
+  ctx.id     = span->id;
+  ctx.active = span->active;
+
+  ___tracy_emit_zone_end (ctx);
+}
+
+#elif defined (GIMP_TRACING_JSON)
+
+void
+gimp_trace_begin (GimpTraceSpan           *span,
+                  const GimpTraceLocation *location)
+{
+  span->location   = location;
+  span->start_time = trace_file ? g_get_monotonic_time () : 0;
+}
+
+void
+gimp_trace_end (GimpTraceSpan *span)
+{
+  gint64 end_time;
+  gint   thread_id;
+
+  if (! trace_file || ! span->start_time)
+    return;
+
+  end_time = g_get_monotonic_time ();
+
+  thread_id = GPOINTER_TO_INT (g_private_get (&trace_thread_id));
+
+  if (! thread_id)
+    {
+      thread_id = g_atomic_int_add (&trace_n_threads, 1) + 1;
+
+      g_private_set (&trace_thread_id, GINT_TO_POINTER (thread_id));
+    }
+
+  g_mutex_lock (&trace_mutex);
+
+  if (trace_file)
+    {
+      fprintf (trace_file,
+               "%s{\"name\":\"%s\",\"cat\":\"gimp\",\"ph\":\"X\","
+               "\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT ","
+               "\"pid\":1,\"tid\":%d}",
+               trace_first ? "" : ",\n",
+               span->location->name,
+               span->start_time - trace_start_time,
+               end_time - span->start_time,
+               thread_id);
+
+      trace_first = FALSE;
+    }
+
+  g_mutex_unlock (&trace_mutex);
+}
+
+
+/*  private functions  */
+
+static void
+gimp_trace_init (void)
+{
+  const gchar *filename = g_getenv ("GIMP_TRACE_FILE");
+
+  if (! filename || trace_file)
+    return;
+
+  trace_file = g_fopen (filename, "w");
+
+  if (! trace_file)
+    {
+      g_printerr ("Failed to open trace file '%s'\n", filename);
+
+      return;
+    }
+
+  trace_start_time = g_get_monotonic_time ();
+
+  fputs ("[\n", trace_file);
+
+  atexit (gimp_trace_exit);
+}
+
+static void
+gimp_trace_exit (void)
+{
+  g_mutex_lock (&trace_mutex);
+
+  fputs ("\n]\n", trace_file);
+  fclose (trace_file);
+
+  trace_file = NULL;
+
+  g_mutex_unlock (&trace_mutex);
+}
+
+#endif
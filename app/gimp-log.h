@@ -44,7 +44,9 @@ typedef enum
   GIMP_LOG_BRUSH_CACHE        = 1 << 18,
   GIMP_LOG_PROJECTION         = 1 << 19,
   GIMP_LOG_XCF                = 1 << 20,
-  GIMP_LOG_MAGIC_MATCH        = 1 << 21
+  GIMP_LOG_MAGIC_MATCH        = 1 << 21,
+  GIMP_LOG_PLUG_IN_POOL       = 1 << 22,
+  GIMP_LOG_TILE_SHARING       = 1 << 23
 } GimpLogFlags;
 
 
@@ -112,6 +114,7 @@ void             gimp_log_remove_handler (GimpLogHandler  handler);
 #define BRUSH_CACHE        GIMP_LOG_BRUSH_CACHE
 #define PROJECTION         GIMP_LOG_PROJECTION
 #define XCF                GIMP_LOG_XCF
+#define PLUG_IN_POOL       GIMP_LOG_PLUG_IN_POOL
 
 #if 0 /* last resort */
 #  define GIMP_LOG /* nothing => no varargs, no log */
@@ -131,5 +134,68 @@ GIMP_LOG (GimpLogFlags flags,
 
 #endif  /* !__GNUC__ */
 
+
+/*  trace spans, shown on a timeline by an external profiler when GIMP is
+ *  built with -Dtracing=tracy, or written as JSON trace events, which
+ *  Perfetto UI and chrome://tracing can open, to the file named by
+ *  GIMP_TRACE_FILE when built with -Dtracing=json.  otherwise, they
+ *  compile to nothing.
+ *
+ *  the span is declared with the function's other variables, and must be
+ *  ended on every path out of the scope it was begun in.  'name' must be
+ *  a string literal.
+ */
+
+#if defined (GIMP_TRACING_TRACY) || defined (GIMP_TRACING_JSON)
+
+/*  laid out like Tracy's source location, which must outlive the span  */
+typedef struct
+{
+  const gchar *name;
+  const gchar *function;
+  const gchar *file;
+  guint32      line;
+  guint32      color;
+} GimpTraceLocation;
+
+typedef struct
+{
+  const GimpTraceLocation *location;
+  gint64                   start_time;
+  guint32                  id;
+  gint                     active;
+} GimpTraceSpan;
+
+void             gimp_trace_begin        (GimpTraceSpan           *span,
+                                          const GimpTraceLocation *location);
+void             gimp_trace_end          (GimpTraceSpan           *span);
+
+#define GIMP_TRACE_SPAN(span) \
+        GimpTraceSpan span G_GNUC_UNUSED
+
+#define GIMP_TRACE_BEGIN(span, name) \
+        G_STMT_START { \
+        static const GimpTraceLocation span##_location = \
+          { name, __func__, __FILE__, __LINE__, 0 }; \
+        gimp_trace_begin (&(span), &span##_location); \
+        } G_STMT_END
+
+#define GIMP_TRACE_END(span) \
+        gimp_trace_end (&(span))
+
+#else /* no tracing */
+
+#define GIMP_TRACE_SPAN(span) \
+        gint span G_GNUC_UNUSED
+
+#define GIMP_TRACE_BEGIN(span, name) \
+        G_STMT_START { } G_STMT_END
+
+#define GIMP_TRACE_END(span) \
+        G_STMT_START { } G_STMT_END
+
+#endif
+
+
 #define geimnum(vienna)  gimp_l##vienna##l_dialog()
 #define fnord(kosmoso)   void gimp_##kosmoso##bl_dialog(void);
@@ -60,24 +60,30 @@ gimp_console_app_new (Gimp        *gimp,
                       gboolean     as_new,
                       const char **filenames,
                       const char  *batch_interpreter,
-                      const char **batch_commands)
+                      const char **batch_commands,
+                      const char  *batch_queue,
+                      gint         batch_jobs,
+                      guint64      batch_memory_limit)
 {
   GimpConsoleApp *app;
 
   app = g_object_new (GIMP_TYPE_CONSOLE_APP,
-                      "application-id",    GIMP_APPLICATION_ID,
+                      "application-id",     GIMP_APPLICATION_ID,
 #if GLIB_CHECK_VERSION(2,74,0)
-                      "flags",             G_APPLICATION_DEFAULT_FLAGS | G_APPLICATION_NON_UNIQUE,
+                      "flags",              G_APPLICATION_DEFAULT_FLAGS | G_APPLICATION_NON_UNIQUE,
 #else
-                      "flags",             G_APPLICATION_FLAGS_NONE | G_APPLICATION_NON_UNIQUE,
+                      "flags",              G_APPLICATION_FLAGS_NONE | G_APPLICATION_NON_UNIQUE,
 #endif
-                      "gimp",              gimp,
-                      "filenames",         filenames,
-                      "as-new",            as_new,
-
-                      "quit",              quit,
-                      "batch-interpreter", batch_interpreter,
-                      "batch-commands",    batch_commands,
+                      "gimp",               gimp,
+                      "filenames",          filenames,
+                      "as-new",             as_new,
+
+                      "quit",               quit,
+                      "batch-interpreter",  batch_interpreter,
+                      "batch-commands",     batch_commands,
+                      "batch-queue",        batch_queue,
+                      "batch-jobs",         batch_jobs,
+                      "batch-memory-limit", batch_memory_limit,
                       NULL);
 
   return G_APPLICATION (app);
@@ -40,6 +40,9 @@ struct _GimpCoreAppPrivate
   gboolean    quit;
   gchar      *batch_interpreter;
   gchar     **batch_commands;
+  gchar      *batch_queue;
+  gint        batch_jobs;
+  guint64     batch_memory_limit;
   gint        exit_status;
 };
 
@@ -93,6 +96,27 @@ gimp_core_app_default_init (GimpCoreAppInterface *iface)
                                                            "Batch commands to run",
                                                            G_TYPE_STRV,
                                                            GIMP_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+
+  g_object_interface_install_property (iface,
+                                       g_param_spec_string ("batch-queue",
+                                                            "File to read batch jobs from",
+                                                            "File to read batch jobs from",
+                                                            NULL,
+                                                            GIMP_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+
+  g_object_interface_install_property (iface,
+                                       g_param_spec_int ("batch-jobs",
+                                                         "Number of batch jobs to run at the same time",
+                                                         "Number of batch jobs to run at the same time",
+                                                         0, G_MAXINT, 0,
+                                                         GIMP_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+
+  g_object_interface_install_property (iface,
+                                       g_param_spec_uint64 ("batch-memory-limit",
+                                                            "Memory each batch job may use",
+                                                            "Memory each batch job may use",
+                                                            0, G_MAXUINT64, 0,
+                                                            GIMP_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
 }
 
 
@@ -116,6 +140,9 @@ gimp_core_app_install_properties (GObjectClass *klass)
   g_object_class_override_property (klass, GIMP_CORE_APP_PROP_QUIT, "quit");
   g_object_class_override_property (klass, GIMP_CORE_APP_PROP_BATCH_INTERPRETER, "batch-interpreter");
   g_object_class_override_property (klass, GIMP_CORE_APP_PROP_BATCH_COMMANDS, "batch-commands");
+  g_object_class_override_property (klass, GIMP_CORE_APP_PROP_BATCH_QUEUE, "batch-queue");
+  g_object_class_override_property (klass, GIMP_CORE_APP_PROP_BATCH_JOBS, "batch-jobs");
+  g_object_class_override_property (klass, GIMP_CORE_APP_PROP_BATCH_MEMORY_LIMIT, "batch-memory-limit");
 }
 
 void
@@ -148,6 +175,15 @@ gimp_core_app_set_property (GObject      *object,
     case GIMP_CORE_APP_PROP_BATCH_COMMANDS:
       private->batch_commands = g_value_dup_boxed (value);
       break;
+    case GIMP_CORE_APP_PROP_BATCH_QUEUE:
+      private->batch_queue = g_value_dup_string (value);
+      break;
+    case GIMP_CORE_APP_PROP_BATCH_JOBS:
+      private->batch_jobs = g_value_get_int (value);
+      break;
+    case GIMP_CORE_APP_PROP_BATCH_MEMORY_LIMIT:
+      private->batch_memory_limit = g_value_get_uint64 (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -184,6 +220,15 @@ gimp_core_app_get_property (GObject    *object,
     case GIMP_CORE_APP_PROP_BATCH_COMMANDS:
       g_value_set_static_boxed (value, private->batch_commands);
       break;
+    case GIMP_CORE_APP_PROP_BATCH_QUEUE:
+      g_value_set_static_string (value, private->batch_queue);
+      break;
+    case GIMP_CORE_APP_PROP_BATCH_JOBS:
+      g_value_set_int (value, private->batch_jobs);
+      break;
+    case GIMP_CORE_APP_PROP_BATCH_MEMORY_LIMIT:
+      g_value_set_uint64 (value, private->batch_memory_limit);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -265,6 +310,42 @@ gimp_core_app_get_batch_commands (GimpCoreApp *self)
   return (const gchar **) private->batch_commands;
 }
 
+const gchar *
+gimp_core_app_get_batch_queue (GimpCoreApp *self)
+{
+  GimpCoreAppPrivate *private;
+
+  g_return_val_if_fail (GIMP_IS_CORE_APP (self), NULL);
+
+  private = GIMP_CORE_APP_GET_PRIVATE (self);
+
+  return (const gchar *) private->batch_queue;
+}
+
+gint
+gimp_core_app_get_batch_jobs (GimpCoreApp *self)
+{
+  GimpCoreAppPrivate *private;
+
+  g_return_val_if_fail (GIMP_IS_CORE_APP (self), 0);
+
+  private = GIMP_CORE_APP_GET_PRIVATE (self);
+
+  return private->batch_jobs;
+}
+
+guint64
+gimp_core_app_get_batch_memory_limit (GimpCoreApp *self)
+{
+  GimpCoreAppPrivate *private;
+
+  g_return_val_if_fail (GIMP_IS_CORE_APP (self), 0);
+
+  private = GIMP_CORE_APP_GET_PRIVATE (self);
+
+  return private->batch_memory_limit;
+}
+
 void
 gimp_core_app_set_exit_status (GimpCoreApp *self, gint exit_status)
 {
@@ -322,6 +403,7 @@ gimp_core_app_private_finalize (GimpCoreAppPrivate *private)
   g_clear_pointer (&private->filenames, g_strfreev);
   g_clear_pointer (&private->batch_interpreter, g_free);
   g_clear_pointer (&private->batch_commands, g_strfreev);
+  g_clear_pointer (&private->batch_queue, g_free);
 
   g_slice_free (GimpCoreAppPrivate, private);
 }
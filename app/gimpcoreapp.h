@@ -30,8 +30,11 @@ enum
   GIMP_CORE_APP_PROP_QUIT,
   GIMP_CORE_APP_PROP_BATCH_INTERPRETER,
   GIMP_CORE_APP_PROP_BATCH_COMMANDS,
+  GIMP_CORE_APP_PROP_BATCH_QUEUE,
+  GIMP_CORE_APP_PROP_BATCH_JOBS,
+  GIMP_CORE_APP_PROP_BATCH_MEMORY_LIMIT,
 
-  GIMP_CORE_APP_PROP_LAST = GIMP_CORE_APP_PROP_BATCH_COMMANDS,
+  GIMP_CORE_APP_PROP_LAST = GIMP_CORE_APP_PROP_BATCH_MEMORY_LIMIT,
 };
 
 #define GIMP_TYPE_CORE_APP gimp_core_app_get_type()
@@ -61,6 +64,12 @@ const gchar *      gimp_core_app_get_batch_interpreter (GimpCoreApp *self);
 
 const gchar **     gimp_core_app_get_batch_commands    (GimpCoreApp *self);
 
+const gchar *      gimp_core_app_get_batch_queue       (GimpCoreApp *self);
+
+gint               gimp_core_app_get_batch_jobs        (GimpCoreApp *self);
+
+guint64            gimp_core_app_get_batch_memory_limit (GimpCoreApp *self);
+
 void               gimp_core_app_set_exit_status       (GimpCoreApp *self,
                                                         gint         exit_status);
 
@@ -125,12 +125,15 @@ gimp_app_new (Gimp        *gimp,
               gboolean     as_new,
               const char **filenames,
               const char  *batch_interpreter,
-              const char **batch_commands)
+              const char **batch_commands,
+              const char  *batch_queue,
+              gint         batch_jobs,
+              guint64      batch_memory_limit)
 {
   GimpApp *app;
 
   app = g_object_new (GIMP_TYPE_APP,
-                      "application-id",    GIMP_APPLICATION_ID,
+                      "application-id",     GIMP_APPLICATION_ID,
                       /* We have our own code to handle process uniqueness, so
                        * when we reached this code, we are already passed this
                        * (it means that either this is the first process, or we
@@ -143,19 +146,22 @@ gimp_app_new (Gimp        *gimp,
                        * inter-process communication. This should be tested.
                        */
 #if GLIB_CHECK_VERSION(2,74,0)
-                      "flags",             G_APPLICATION_DEFAULT_FLAGS | G_APPLICATION_NON_UNIQUE,
+                      "flags",              G_APPLICATION_DEFAULT_FLAGS | G_APPLICATION_NON_UNIQUE,
 #else
-                      "flags",             G_APPLICATION_FLAGS_NONE | G_APPLICATION_NON_UNIQUE,
+                      "flags",              G_APPLICATION_FLAGS_NONE | G_APPLICATION_NON_UNIQUE,
 #endif
-                      "gimp",              gimp,
-                      "filenames",         filenames,
-                      "as-new",            as_new,
-
-                      "quit",              quit,
-                      "batch-interpreter", batch_interpreter,
-                      "batch-commands",    batch_commands,
-
-                      "no-splash",         no_splash,
+                      "gimp",               gimp,
+                      "filenames",          filenames,
+                      "as-new",             as_new,
+
+                      "quit",               quit,
+                      "batch-interpreter",  batch_interpreter,
+                      "batch-commands",     batch_commands,
+                      "batch-queue",        batch_queue,
+                      "batch-jobs",         batch_jobs,
+                      "batch-memory-limit", batch_memory_limit,
+
+                      "no-splash",          no_splash,
                       NULL);
 
   return G_APPLICATION (app);
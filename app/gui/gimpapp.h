@@ -30,6 +30,9 @@ GApplication * gimp_app_new           (Gimp        *gimp,
                                        gboolean     as_new,
                                        const char **filenames,
                                        const char  *batch_interpreter,
-                                       const char **batch_commands);
+                                       const char **batch_commands,
+                                       const char  *batch_queue,
+                                       gint         batch_jobs,
+                                       guint64      batch_memory_limit);
 
 gboolean       gimp_app_get_no_splash (GimpApp     *self);
@@ -64,6 +64,7 @@
 #include "config/gimpconfig-dump.h"
 
 #include "core/gimp.h"
+#include "core/gimp-startup-profile.h"
 #include "core/gimpbacktrace.h"
 
 #include "pdb/gimppdb.h"
@@ -99,6 +100,10 @@ static gboolean  gimp_option_pdb_compat_mode  (const gchar  *option_name,
                                                const gchar  *value,
                                                gpointer      data,
                                                GError      **error);
+static gboolean  gimp_option_batch_memsize    (const gchar  *option_name,
+                                               const gchar  *value,
+                                               gpointer      data,
+                                               GError      **error);
 static gboolean  gimp_option_dump_gimprc      (const gchar  *option_name,
                                                const gchar  *value,
                                                gpointer      data,
@@ -125,6 +130,10 @@ static const gchar        *system_gimprc     = NULL;
 static const gchar        *user_gimprc       = NULL;
 static const gchar        *session_name      = NULL;
 static const gchar        *batch_interpreter = NULL;
+static const gchar        *batch_queue       = NULL;
+static gint                batch_jobs        = 0;
+static guint64             batch_memsize     = 0;
+static const gchar        *profile_startup   = NULL;
 static const gchar       **batch_commands    = NULL;
 static const gchar       **filenames         = NULL;
 static gboolean            quit              = FALSE;
@@ -132,6 +141,7 @@ static gboolean            as_new            = FALSE;
 static gboolean            no_interface      = FALSE;
 static gboolean            no_data           = FALSE;
 static gboolean            no_fonts          = FALSE;
+static gboolean            core_only         = FALSE;
 static gboolean            no_splash         = FALSE;
 static gboolean            be_verbose        = FALSE;
 static gboolean            new_instance      = FALSE;
@@ -198,6 +208,12 @@ static const GOptionEntry main_entries[] =
     G_OPTION_ARG_NONE, &no_fonts,
     N_("Do not load any fonts"), NULL
   },
+  {
+    "core-only", 0, 0,
+    G_OPTION_ARG_NONE, &core_only,
+    N_("Start only the core, for batch servers (implies --no-interface)"),
+    NULL
+  },
   {
     "no-splash", 's', 0,
     G_OPTION_ARG_NONE, &no_splash,
@@ -238,6 +254,22 @@ static const GOptionEntry main_entries[] =
     G_OPTION_ARG_STRING, &batch_interpreter,
     N_("The procedure to process batch commands with"), "<proc>"
   },
+  {
+    "batch-queue", 0, 0,
+    G_OPTION_ARG_FILENAME, &batch_queue,
+    N_("Run the batch jobs listed in a file, one JSON value per line"),
+    "<filename>"
+  },
+  {
+    "batch-jobs", 0, 0,
+    G_OPTION_ARG_INT, &batch_jobs,
+    N_("Number of batch jobs to run at the same time"), "<n>"
+  },
+  {
+    "batch-memory-limit", 0, 0,
+    G_OPTION_ARG_CALLBACK, gimp_option_batch_memsize,
+    N_("Memory the images of each batch job may use"), "<size>"
+  },
   {
     "quit", 0, 0,
     G_OPTION_ARG_NONE, &quit,
@@ -265,6 +297,12 @@ static const GOptionEntry main_entries[] =
     G_OPTION_ARG_NONE, &use_debug_handler,
     N_("Enable non-fatal debugging signal handlers"), NULL
   },
+  {
+    "profile-startup", 0, 0,
+    G_OPTION_ARG_FILENAME, &profile_startup,
+    N_("Write the duration of each startup phase to a trace file"),
+    "<filename>"
+  },
   {
     "g-fatal-warnings", 0, G_OPTION_FLAG_NO_ARG,
     G_OPTION_ARG_CALLBACK, gimp_option_fatal_warnings,
@@ -736,6 +774,10 @@ main (int    argc,
         {
           no_interface = TRUE;
         }
+      else if (strcmp (arg, "--core-only") == 0)
+        {
+          no_interface = TRUE;
+        }
       else if ((strcmp (arg, "--version") == 0) || (strcmp (arg, "-v") == 0))
         {
           gimp_show_version_and_exit ();
@@ -792,6 +834,8 @@ main (int    argc,
       app_exit (EXIT_FAILURE);
     }
 
+  gimp_startup_profile_init (profile_startup);
+
 #if GLIB_CHECK_VERSION(2,72,0)
   /* g_set_prgname() can only be called several times since 2.72.0. */
 #ifndef GIMP_CONSOLE_COMPILATION
@@ -835,10 +879,20 @@ main (int    argc,
 #endif
 #endif
 
-  if (no_interface || be_verbose || console_messages || batch_commands != NULL)
+  if (core_only)
+    {
+      no_interface = TRUE;
+      no_splash    = TRUE;
+    }
+
+  if (no_interface || be_verbose || console_messages ||
+      batch_commands != NULL || batch_queue != NULL)
     gimp_open_console_window ();
 
-  if (no_interface)
+  /*  batch queues are run by the process reading them, they can't be
+   *  handed over to a running instance
+   */
+  if (no_interface || batch_queue)
     new_instance = TRUE;
 
 #ifndef GIMP_CONSOLE_COMPILATION
@@ -877,11 +931,15 @@ main (int    argc,
                     session_name,
                     batch_interpreter,
                     batch_commands,
+                    batch_queue,
+                    batch_jobs,
+                    batch_memsize,
                     quit,
                     as_new,
                     no_interface,
                     no_data,
                     no_fonts,
+                    core_only,
                     no_splash,
                     be_verbose,
                     use_shm,
@@ -894,6 +952,8 @@ main (int    argc,
                     pdb_compat_mode,
                     backtrace_file);
 
+  gimp_startup_profile_exit ();
+
   g_free (backtrace_file);
 
   g_clear_object (&system_gimprc_file);
@@ -1019,6 +1079,15 @@ gimp_option_pdb_compat_mode (const gchar  *option_name,
   return TRUE;
 }
 
+static gboolean
+gimp_option_batch_memsize (const gchar  *option_name,
+                           const gchar  *value,
+                           gpointer      data,
+                           GError      **error)
+{
+  return gimp_memsize_deserialize (value, &batch_memsize);
+}
+
 static gboolean
 gimp_option_dump_gimprc (const gchar  *option_name,
                          const gchar  *value,
@@ -24,6 +24,8 @@
 #include <gegl.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
 
+#include <opencl/gegl-cl.h>
+
 #include "libgimpcolor/gimpcolor.h"
 #include "libgimpmath/gimpmath.h"
 
@@ -41,6 +43,12 @@ static gboolean gimp_operation_brightness_contrast_process (GeglOperation
                                                             glong                samples,
                                                             const GeglRectangle *roi,
                                                             gint                 level);
+static gboolean gimp_operation_brightness_contrast_cl_process (GeglOperation       *operation,
+                                                               cl_mem               in_tex,
+                                                               cl_mem               out_tex,
+                                                               size_t               global_worksize,
+                                                               const GeglRectangle *roi,
+                                                               gint                 level);
 
 
 G_DEFINE_TYPE (GimpOperationBrightnessContrast, gimp_operation_brightness_contrast,
@@ -49,12 +57,36 @@ G_DEFINE_TYPE (GimpOperationBrightnessContrast, gimp_operation_brightness_contra
 #define parent_class gimp_operation_brightness_contrast_parent_class
 
 
+static const gchar *kernel_source =
+"__kernel void gimp_brightness_contrast (__global const float4 *in,       \n"
+"                                        __global       float4 *out,      \n"
+"                                        float                  brightness,\n"
+"                                        float                  slant)     \n"
+"{                                                                        \n"
+"  int    gid = get_global_id (0);                                        \n"
+"  float4 src = in[gid];                                                  \n"
+"  float3 v   = src.xyz;                                                  \n"
+"                                                                         \n"
+"  if (brightness < 0.0f)                                                 \n"
+"    v = v * (1.0f + brightness);                                         \n"
+"  else                                                                   \n"
+"    v = v + (1.0f - v) * brightness;                                     \n"
+"                                                                         \n"
+"  v = (v - 0.5f) * slant + 0.5f;                                         \n"
+"                                                                         \n"
+"  out[gid] = (float4) (v, src.w);                                        \n"
+"}                                                                        \n";
+
+static GeglClRunData *cl_data = NULL;
+
+
 static void
 gimp_operation_brightness_contrast_class_init (GimpOperationBrightnessContrastClass *klass)
 {
   GObjectClass                  *object_class    = G_OBJECT_CLASS (klass);
   GeglOperationClass            *operation_class = GEGL_OPERATION_CLASS (klass);
   GeglOperationPointFilterClass *point_class     = GEGL_OPERATION_POINT_FILTER_CLASS (klass);
+  GimpOperationPointFilterClass *filter_class    = GIMP_OPERATION_POINT_FILTER_CLASS (klass);
 
   object_class->set_property   = gimp_operation_point_filter_set_property;
   object_class->get_property   = gimp_operation_point_filter_get_property;
@@ -66,6 +98,11 @@ gimp_operation_brightness_contrast_class_init (GimpOperationBrightnessContrastCl
                                  NULL);
 
   point_class->process         = gimp_operation_brightness_contrast_process;
+  point_class->cl_process      = gimp_operation_brightness_contrast_cl_process;
+
+  operation_class->opencl_support = TRUE;
+
+  filter_class->use_lut        = TRUE;
 
   g_object_class_install_property (object_class,
                                    GIMP_OPERATION_POINT_FILTER_PROP_CONFIG,
@@ -116,6 +153,10 @@ gimp_operation_brightness_contrast_process (GeglOperation       *operation,
   if (! config)
     return FALSE;
 
+  if (gimp_operation_point_filter_process_lut (operation, in_buf, out_buf,
+                                               samples, roi, level))
+    return TRUE;
+
   brightness = config->brightness / 2.0;
   slant = tan ((config->contrast + 1) * G_PI_4);
 
@@ -138,3 +179,50 @@ gimp_operation_brightness_contrast_process (GeglOperation       *operation,
 
   return TRUE;
 }
+
+static gboolean
+gimp_operation_brightness_contrast_cl_process (GeglOperation       *operation,
+                                               cl_mem               in_tex,
+                                               cl_mem               out_tex,
+                                               size_t               global_worksize,
+                                               const GeglRectangle *roi,
+                                               gint                 level)
+{
+  GimpOperationPointFilter     *point  = GIMP_OPERATION_POINT_FILTER (operation);
+  GimpBrightnessContrastConfig *config = GIMP_BRIGHTNESS_CONTRAST_CONFIG (point->config);
+  cl_float                      brightness;
+  cl_float                      slant;
+  cl_int                        cl_err;
+
+  if (! config)
+    return TRUE;
+
+  if (! cl_data)
+    {
+      const gchar *kernel_name[] = { "gimp_brightness_contrast", NULL };
+
+      cl_data = gegl_cl_compile_and_build (kernel_source, kernel_name);
+
+      if (! cl_data)
+        return TRUE;
+    }
+
+  brightness = config->brightness / 2.0;
+  slant      = tan ((config->contrast + 1) * G_PI_4);
+
+  cl_err = gegl_cl_set_kernel_args (cl_data->kernel[0],
+                                    sizeof (cl_mem),   &in_tex,
+                                    sizeof (cl_mem),   &out_tex,
+                                    sizeof (cl_float), &brightness,
+                                    sizeof (cl_float), &slant,
+                                    NULL);
+  if (cl_err != CL_SUCCESS)
+    return TRUE;
+
+  cl_err = gegl_clEnqueueNDRangeKernel (gegl_cl_get_command_queue (),
+                                        cl_data->kernel[0], 1,
+                                        NULL, &global_worksize, NULL,
+                                        0, NULL, NULL);
+
+  return cl_err != CL_SUCCESS;
+}
@@ -32,6 +32,17 @@
 #include "gimp-intl.h"
 
 
+#define PIXELS_PER_THREAD \
+  (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
+
+
+typedef struct
+{
+  GimpCageConfig *config;
+  GeglBuffer     *output;
+} CoefCalcData;
+
+
 static void           gimp_operation_cage_coef_calc_finalize         (GObject              *object);
 static void           gimp_operation_cage_coef_calc_get_property     (GObject              *object,
                                                                       guint                 property_id,
@@ -48,6 +59,8 @@ static gboolean       gimp_operation_cage_coef_calc_process          (GeglOperat
                                                                       GeglBuffer           *output,
                                                                       const GeglRectangle  *roi,
                                                                       gint                  level);
+static void           gimp_operation_cage_coef_calc_process_area     (const GeglRectangle  *area,
+                                                                      CoefCalcData         *data);
 
 
 G_DEFINE_TYPE (GimpOperationCageCoefCalc, gimp_operation_cage_coef_calc,
@@ -202,21 +215,40 @@ gimp_operation_cage_coef_calc_process (GeglOperation       *operation,
 {
   GimpOperationCageCoefCalc *occc   = GIMP_OPERATION_CAGE_COEF_CALC (operation);
   GimpCageConfig            *config = GIMP_CAGE_CONFIG (occc->config);
+  CoefCalcData               data;
 
-  const Babl *format;
+  if (! config)
+    return FALSE;
+
+  data.config = config;
+  data.output = output;
 
+  /*  each pixel's coefficients only depend on the cage, so the roi is
+   *  split across threads
+   */
+  gegl_parallel_distribute_area (
+    roi, PIXELS_PER_THREAD, GEGL_SPLIT_STRATEGY_AUTO,
+    (GeglParallelDistributeAreaFunc) gimp_operation_cage_coef_calc_process_area,
+    &data);
+
+  return TRUE;
+}
+
+static void
+gimp_operation_cage_coef_calc_process_area (const GeglRectangle *area,
+                                            CoefCalcData        *data)
+{
+  GimpCageConfig     *config = data->config;
+  const Babl         *format;
   GeglBufferIterator *it;
   guint               n_cage_vertices;
   GimpCagePoint      *current, *last;
 
-  if (! config)
-    return FALSE;
-
   format = babl_format_n (babl_type ("float"), 2 * gimp_cage_config_get_n_points (config));
 
   n_cage_vertices = gimp_cage_config_get_n_points (config);
 
-  it = gegl_buffer_iterator_new (output, roi, 0, format,
+  it = gegl_buffer_iterator_new (data->output, area, 0, format,
                                  GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE, 1);
 
   while (gegl_buffer_iterator_next (it))
@@ -294,6 +326,4 @@ gimp_operation_cage_coef_calc_process (GeglOperation       *operation,
             }
         }
     }
-
-  return TRUE;
 }
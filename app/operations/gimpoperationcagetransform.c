@@ -59,7 +59,7 @@ static gboolean     gimp_operation_cage_transform_process                 (GeglO
                                                                            gint                 level);
 static void         gimp_operation_cage_transform_interpolate_source_coords_recurs
                                                                           (GimpOperationCageTransform  *oct,
-                                                                           GeglBuffer          *out_buf,
+                                                                           gfloat              *output,
                                                                            const GeglRectangle *roi,
                                                                            GimpVector2          p1_s,
                                                                            GimpVector2          p1_d,
@@ -67,12 +67,12 @@ static void         gimp_operation_cage_transform_interpolate_source_coords_recu
                                                                            GimpVector2          p2_d,
                                                                            GimpVector2          p3_s,
                                                                            GimpVector2          p3_d,
-                                                                           gint                 recursion_depth,
-                                                                           gfloat              *coords);
-static GimpVector2  gimp_cage_transform_compute_destination               (GimpCageConfig      *config,
-                                                                           gfloat              *coef,
-                                                                           GeglSampler         *coef_sampler,
-                                                                           GimpVector2          coords);
+                                                                           gint                 recursion_depth);
+static void         gimp_cage_transform_compute_destinations              (const gdouble       *weights,
+                                                                           const gfloat        *coef,
+                                                                           gint                 n_coefs,
+                                                                           gint                 n_pixels,
+                                                                           GimpVector2         *dest);
 GeglRectangle       gimp_operation_cage_transform_get_cached_region       (GeglOperation       *operation,
                                                                            const GeglRectangle *roi);
 GeglRectangle       gimp_operation_cage_transform_get_required_for_output (GeglOperation       *operation,
@@ -218,20 +218,21 @@ gimp_operation_cage_transform_process (GeglOperation       *operation,
   GimpOperationCageTransform *oct    = GIMP_OPERATION_CAGE_TRANSFORM (operation);
   GimpCageConfig             *config = GIMP_CAGE_CONFIG (oct->config);
   GeglRectangle               cage_bb;
-  gfloat                     *coords;
+  gfloat                     *output;
   gfloat                     *coef;
+  gdouble                    *weights;
+  GimpVector2                *row_d[2];
   const Babl                 *format_coef;
-  GeglSampler                *coef_sampler;
   GimpVector2                 plain_color;
-  GeglBufferIterator         *it;
   gint                        x, y;
+  gint                        i;
   gboolean                    output_set;
   GimpCagePoint              *point;
   guint                       n_cage_vertices;
+  gint                        n_coefs;
 
-  /* pre-fill the out buffer with no-displacement coordinate */
-  it      = gegl_buffer_iterator_new (out_buf, roi, 0, NULL,
-                                      GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE, 1);
+  /* the output is built in memory, and written out once at the end */
+  output  = g_new (gfloat, (gsize) roi->width * roi->height * 2);
   cage_bb = gimp_cage_config_get_bounding_box (config);
 
   point = &(g_array_index (config->cage_points, GimpCagePoint, 0));
@@ -239,17 +240,12 @@ gimp_operation_cage_transform_process (GeglOperation       *operation,
   plain_color.y = (gint) point->src_point.y;
 
   n_cage_vertices = gimp_cage_config_get_n_points (config);
+  n_coefs         = 2 * n_cage_vertices;
 
-  while (gegl_buffer_iterator_next (it))
+  /* pre-fill the output with no-displacement coordinate */
+  for (y = roi->y, i = 0; y < roi->y + roi->height; y++)
     {
-      /* iterate inside the roi */
-      gint    n_pixels = it->length;
-      gfloat *output   = it->items[0].data;
-
-      x = it->items[0].roi.x; /* initial x         */
-      y = it->items[0].roi.y; /* and y coordinates */
-
-      while (n_pixels--)
+      for (x = roi->x; x < roi->x + roi->width; x++, i += 2)
         {
           output_set = FALSE;
           if (oct->fill_plain_color)
@@ -261,89 +257,101 @@ gimp_operation_cage_transform_process (GeglOperation       *operation,
                 {
                   if (gimp_cage_config_point_inside (config, x, y))
                     {
-                      output[0] = plain_color.x;
-                      output[1] = plain_color.y;
+                      output[i]     = plain_color.x;
+                      output[i + 1] = plain_color.y;
                       output_set = TRUE;
                     }
                 }
             }
           if (!output_set)
             {
-              output[0] = x + 0.5;
-              output[1] = y + 0.5;
-            }
-
-          output += 2;
-
-          /* update x and y coordinates */
-          x++;
-          if (x >= (it->items[0].roi.x + it->items[0].roi.width))
-            {
-              x = it->items[0].roi.x;
-              y++;
+              output[i]     = x + 0.5;
+              output[i + 1] = y + 0.5;
             }
         }
     }
 
-  if (! aux_buf)
-    return TRUE;
+  if (! aux_buf || cage_bb.width < 2 || cage_bb.height < 2)
+    {
+      gegl_buffer_set (out_buf, roi, 0, oct->format_coords, output,
+                       GEGL_AUTO_ROWSTRIDE);
+      g_free (output);
+
+      return TRUE;
+    }
 
   gegl_operation_progress (operation, 0.0, "");
 
-  /* pre-allocate memory outside of the loop */
-  coords       = g_slice_alloc (2 * sizeof (gfloat));
-  coef         = g_malloc (n_cage_vertices * 2 * sizeof (gfloat));
-  format_coef  = babl_format_n (babl_type ("float"), 2 * n_cage_vertices);
-  coef_sampler = gegl_buffer_sampler_new (aux_buf,
-                                          format_coef, GEGL_SAMPLER_NEAREST);
+  /* the coefficients only change with the cage topology, while the
+   * handles only move the destination points.  fold the handles into
+   * one weight per coefficient, so that each destination is a single
+   * dot product with a pixel's coefficients.
+   */
+  weights = g_new (gdouble, 2 * n_coefs);
+
+  for (i = 0; i < n_cage_vertices; i++)
+    {
+      point = &g_array_index (config->cage_points, GimpCagePoint, i);
+
+      weights[i]                             = point->dest_point.x;
+      weights[i + n_coefs]                   = point->dest_point.y;
+      weights[i + n_cage_vertices]           = point->edge_scaling_factor * point->edge_normal.x;
+      weights[i + n_cage_vertices + n_coefs] = point->edge_scaling_factor * point->edge_normal.y;
+    }
+
+  format_coef = babl_format_n (babl_type ("float"), n_coefs);
+  coef        = g_new (gfloat, (gsize) cage_bb.width * n_coefs);
+  row_d[0]    = g_new (GimpVector2, cage_bb.width);
+  row_d[1]    = g_new (GimpVector2, cage_bb.width);
+
+  /* compute the destination of each row of the cage bounding box once,
+   * from a single read of its coefficients
+   */
+  gegl_buffer_get (aux_buf,
+                   GEGL_RECTANGLE (cage_bb.x, cage_bb.y, cage_bb.width, 1),
+                   1.0, format_coef, coef,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+  gimp_cage_transform_compute_destinations (weights, coef, n_coefs,
+                                            cage_bb.width, row_d[0]);
 
   /* compute, reverse and interpolate the transformation */
   for (y = cage_bb.y; y < cage_bb.y + cage_bb.height - 1; y++)
     {
-      GimpVector2 p1_d, p2_d, p3_d, p4_d;
-      GimpVector2 p1_s, p2_s, p3_s, p4_s;
-
-      p1_s.y = y;
-      p2_s.y = y+1;
-      p3_s.y = y+1;
-      p3_s.x = cage_bb.x;
-      p4_s.y = y;
-      p4_s.x = cage_bb.x;
+      GimpVector2 *top    = row_d[(y - cage_bb.y) % 2];
+      GimpVector2 *bottom = row_d[(y - cage_bb.y + 1) % 2];
 
-      p3_d = gimp_cage_transform_compute_destination (config, coef, coef_sampler, p3_s);
-      p4_d = gimp_cage_transform_compute_destination (config, coef, coef_sampler, p4_s);
+      gegl_buffer_get (aux_buf,
+                       GEGL_RECTANGLE (cage_bb.x, y + 1, cage_bb.width, 1),
+                       1.0, format_coef, coef,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+      gimp_cage_transform_compute_destinations (weights, coef, n_coefs,
+                                                cage_bb.width, bottom);
 
       for (x = cage_bb.x; x < cage_bb.x + cage_bb.width - 1; x++)
         {
-          p1_s = p4_s;
-          p2_s = p3_s;
-          p3_s.x = x+1;
-          p4_s.x = x+1;
-
-          p1_d = p4_d;
-          p2_d = p3_d;
-          p3_d = gimp_cage_transform_compute_destination (config, coef, coef_sampler, p3_s);
-          p4_d = gimp_cage_transform_compute_destination (config, coef, coef_sampler, p4_s);
+          gint        col  = x - cage_bb.x;
+          GimpVector2 p1_s = { x,     y     };
+          GimpVector2 p2_s = { x,     y + 1 };
+          GimpVector2 p3_s = { x + 1, y + 1 };
+          GimpVector2 p4_s = { x + 1, y     };
 
           if (gimp_cage_config_point_inside (config, x, y))
             {
               gimp_operation_cage_transform_interpolate_source_coords_recurs (oct,
-                                                                              out_buf,
+                                                                              output,
                                                                               roi,
-                                                                              p1_s, p1_d,
-                                                                              p2_s, p2_d,
-                                                                              p3_s, p3_d,
-                                                                              0,
-                                                                              coords);
+                                                                              p1_s, top[col],
+                                                                              p2_s, bottom[col],
+                                                                              p3_s, bottom[col + 1],
+                                                                              0);
 
               gimp_operation_cage_transform_interpolate_source_coords_recurs (oct,
-                                                                              out_buf,
+                                                                              output,
                                                                               roi,
-                                                                              p1_s, p1_d,
-                                                                              p3_s, p3_d,
-                                                                              p4_s, p4_d,
-                                                                              0,
-                                                                              coords);
+                                                                              p1_s, top[col],
+                                                                              p3_s, bottom[col + 1],
+                                                                              p4_s, top[col + 1],
+                                                                              0);
             }
         }
 
@@ -360,9 +368,14 @@ gimp_operation_cage_transform_process (GeglOperation       *operation,
         }
     }
 
-  g_object_unref (coef_sampler);
+  gegl_buffer_set (out_buf, roi, 0, oct->format_coords, output,
+                   GEGL_AUTO_ROWSTRIDE);
+
+  g_free (row_d[0]);
+  g_free (row_d[1]);
   g_free (coef);
-  g_slice_free1 (2 * sizeof (gfloat), coords);
+  g_free (weights);
+  g_free (output);
 
   gegl_operation_progress (operation, 1.0, "");
 
@@ -372,7 +385,7 @@ gimp_operation_cage_transform_process (GeglOperation       *operation,
 
 static void
 gimp_operation_cage_transform_interpolate_source_coords_recurs (GimpOperationCageTransform *oct,
-                                                                GeglBuffer                 *out_buf,
+                                                                gfloat                     *output,
                                                                 const GeglRectangle        *roi,
                                                                 GimpVector2                 p1_s,
                                                                 GimpVector2                 p1_d,
@@ -380,8 +393,7 @@ gimp_operation_cage_transform_interpolate_source_coords_recurs (GimpOperationCag
                                                                 GimpVector2                 p2_d,
                                                                 GimpVector2                 p3_s,
                                                                 GimpVector2                 p3_d,
-                                                                gint                        recursion_depth,
-                                                                gfloat                     *coords)
+                                                                gint                        recursion_depth)
 {
   gint xmin, xmax, ymin, ymax, x, y;
 
@@ -450,23 +462,15 @@ gimp_operation_cage_transform_interpolate_source_coords_recurs (GimpOperationCag
       /* if a pixel is inside, we compute its source coordinate and
        * set it in the output buffer
        */
-      if ((a > 0 && b > 0 && c > 0) || (a < 0 && b < 0 && c < 0))
+      if (((a > 0 && b > 0 && c > 0) || (a < 0 && b < 0 && c < 0)) &&
+          xmin >= roi->x && xmin < roi->x + roi->width                &&
+          ymin >= roi->y && ymin < roi->y + roi->height)
         {
-          GeglRectangle rect = { 0, 0, 1, 1 };
-          gfloat        coords[2];
-
-          rect.x = xmin;
-          rect.y = ymin;
+          gfloat *coords = output + ((gsize) (ymin - roi->y) * roi->width +
+                                     (xmin - roi->x)) * 2;
 
           coords[0] = (a * p1_s.x + b * p2_s.x + c * p3_s.x);
           coords[1] = (a * p1_s.y + b * p2_s.y + c * p3_s.y);
-
-          gegl_buffer_set (out_buf,
-                           &rect,
-                           0,
-                           oct->format_coords,
-                           coords,
-                           GEGL_AUTO_ROWSTRIDE);
         }
 
       return;
@@ -505,69 +509,69 @@ gimp_operation_cage_transform_interpolate_source_coords_recurs (GimpOperationCag
       pm3_s.y = (p3_s.y + p1_s.y) / 2.0;
 
       gimp_operation_cage_transform_interpolate_source_coords_recurs (oct,
-                                                                      out_buf,
+                                                                      output,
                                                                       roi,
                                                                       p1_s, p1_d,
                                                                       pm1_s, pm1_d,
                                                                       pm3_s, pm3_d,
-                                                                      next_depth,
-                                                                      coords);
+                                                                      next_depth);
 
       gimp_operation_cage_transform_interpolate_source_coords_recurs (oct,
-                                                                      out_buf,
+                                                                      output,
                                                                       roi,
                                                                       pm1_s, pm1_d,
                                                                       p2_s, p2_d,
                                                                       pm2_s, pm2_d,
-                                                                      next_depth,
-                                                                      coords);
+                                                                      next_depth);
 
       gimp_operation_cage_transform_interpolate_source_coords_recurs (oct,
-                                                                      out_buf,
+                                                                      output,
                                                                       roi,
                                                                       pm1_s, pm1_d,
                                                                       pm2_s, pm2_d,
                                                                       pm3_s, pm3_d,
-                                                                      next_depth,
-                                                                      coords);
+                                                                      next_depth);
 
       gimp_operation_cage_transform_interpolate_source_coords_recurs (oct,
-                                                                      out_buf,
+                                                                      output,
                                                                       roi,
                                                                       pm3_s, pm3_d,
                                                                       pm2_s, pm2_d,
                                                                       p3_s, p3_d,
-                                                                      next_depth,
-                                                                      coords);
+                                                                      next_depth);
     }
 }
 
-static GimpVector2
-gimp_cage_transform_compute_destination (GimpCageConfig *config,
-                                         gfloat         *coef,
-                                         GeglSampler    *coef_sampler,
-                                         GimpVector2     coords)
+/* computes the destination of 'n_pixels' pixels, from their 'n_coefs'
+ * coefficients each, and the x and y weights of each coefficient
+ */
+static void
+gimp_cage_transform_compute_destinations (const gdouble *weights,
+                                          const gfloat  *coef,
+                                          gint           n_coefs,
+                                          gint           n_pixels,
+                                          GimpVector2   *dest)
 {
-  GimpVector2    result = {0, 0};
-  gint           n_cage_vertices = gimp_cage_config_get_n_points (config);
-  gint           i;
-  GimpCagePoint *point;
+  const gdouble *weights_x = weights;
+  const gdouble *weights_y = weights + n_coefs;
+  gint           i, j;
 
-  gegl_sampler_get (coef_sampler,
-                    coords.x, coords.y, NULL, coef, GEGL_ABYSS_NONE);
-
-  for (i = 0; i < n_cage_vertices; i++)
+  for (i = 0; i < n_pixels; i++)
     {
-      point = &g_array_index (config->cage_points, GimpCagePoint, i);
+      gdouble x = 0.0;
+      gdouble y = 0.0;
+
+      for (j = 0; j < n_coefs; j++)
+        {
+          x += coef[j] * weights_x[j];
+          y += coef[j] * weights_y[j];
+        }
 
-      result.x += coef[i] * point->dest_point.x;
-      result.y += coef[i] * point->dest_point.y;
+      dest[i].x = x;
+      dest[i].y = y;
 
-      result.x += coef[i + n_cage_vertices] * point->edge_scaling_factor * point->edge_normal.x;
-      result.y += coef[i + n_cage_vertices] * point->edge_scaling_factor * point->edge_normal.y;
+      coef += n_coefs;
     }
-
-  return result;
 }
 
 GeglRectangle
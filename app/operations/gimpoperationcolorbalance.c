@@ -24,6 +24,8 @@
 #include <gegl.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
 
+#include <opencl/gegl-cl.h>
+
 #include "libgimpcolor/gimpcolor.h"
 #include "libgimpmath/gimpmath.h"
 
@@ -35,13 +37,19 @@
 #include "gimp-intl.h"
 
 
-static void     gimp_operation_color_balance_prepare (GeglOperation       *operation);
-static gboolean gimp_operation_color_balance_process (GeglOperation       *operation,
-                                                      void                *in_buf,
-                                                      void                *out_buf,
-                                                      glong                samples,
-                                                      const GeglRectangle *roi,
-                                                      gint                 level);
+static void     gimp_operation_color_balance_prepare    (GeglOperation       *operation);
+static gboolean gimp_operation_color_balance_process    (GeglOperation       *operation,
+                                                         void                *in_buf,
+                                                         void                *out_buf,
+                                                         glong                samples,
+                                                         const GeglRectangle *roi,
+                                                         gint                 level);
+static gboolean gimp_operation_color_balance_cl_process (GeglOperation       *operation,
+                                                         cl_mem               in_tex,
+                                                         cl_mem               out_tex,
+                                                         size_t               global_worksize,
+                                                         const GeglRectangle *roi,
+                                                         gint                 level);
 
 
 G_DEFINE_TYPE (GimpOperationColorBalance, gimp_operation_color_balance,
@@ -50,6 +58,116 @@ G_DEFINE_TYPE (GimpOperationColorBalance, gimp_operation_color_balance,
 #define parent_class gimp_operation_color_balance_parent_class
 
 
+/*  the corrections are passed as float4s of the shadows, midtones and
+ *  highlights of the red, green and blue channels.  the operation
+ *  works on sRGB, so the HSL lightness is simply computed in the
+ *  kernel.  see gimp_operation_color_balance_map().
+ */
+static const gchar *kernel_source =
+"float3 rgb_to_hsl (float3 rgb)                                           \n"
+"{                                                                        \n"
+"  float max = fmax (rgb.x, fmax (rgb.y, rgb.z));                         \n"
+"  float min = fmin (rgb.x, fmin (rgb.y, rgb.z));                         \n"
+"  float l   = (max + min) / 2.0f;                                        \n"
+"  float d   = max - min;                                                 \n"
+"  float h;                                                               \n"
+"  float s;                                                               \n"
+"                                                                         \n"
+"  if (d == 0.0f)                                                         \n"
+"    return (float3) (0.0f, 0.0f, l);                                     \n"
+"                                                                         \n"
+"  s = l > 0.5f ? d / (2.0f - max - min) : d / (max + min);               \n"
+"                                                                         \n"
+"  if (max == rgb.x)                                                      \n"
+"    h = (rgb.y - rgb.z) / d + (rgb.y < rgb.z ? 6.0f : 0.0f);             \n"
+"  else if (max == rgb.y)                                                 \n"
+"    h = (rgb.z - rgb.x) / d + 2.0f;                                      \n"
+"  else                                                                   \n"
+"    h = (rgb.x - rgb.y) / d + 4.0f;                                      \n"
+"                                                                         \n"
+"  return (float3) (h / 6.0f, s, l);                                      \n"
+"}                                                                        \n"
+"                                                                         \n"
+"float hue_to_rgb (float p,                                               \n"
+"                  float q,                                               \n"
+"                  float t)                                               \n"
+"{                                                                        \n"
+"  if (t < 0.0f)                                                          \n"
+"    t += 1.0f;                                                           \n"
+"  else if (t > 1.0f)                                                     \n"
+"    t -= 1.0f;                                                           \n"
+"                                                                         \n"
+"  if (t < 1.0f / 6.0f)                                                   \n"
+"    return p + (q - p) * 6.0f * t;                                       \n"
+"  else if (t < 1.0f / 2.0f)                                              \n"
+"    return q;                                                            \n"
+"  else if (t < 2.0f / 3.0f)                                              \n"
+"    return p + (q - p) * (2.0f / 3.0f - t) * 6.0f;                       \n"
+"  else                                                                   \n"
+"    return p;                                                            \n"
+"}                                                                        \n"
+"                                                                         \n"
+"float3 hsl_to_rgb (float3 hsl)                                           \n"
+"{                                                                        \n"
+"  float p;                                                               \n"
+"  float q;                                                               \n"
+"                                                                         \n"
+"  if (hsl.y == 0.0f)                                                     \n"
+"    return (float3) (hsl.z);                                             \n"
+"                                                                         \n"
+"  q = hsl.z < 0.5f ? hsl.z * (1.0f + hsl.y)                              \n"
+"                   : hsl.z + hsl.y - hsl.z * hsl.y;                      \n"
+"  p = 2.0f * hsl.z - q;                                                  \n"
+"                                                                         \n"
+"  return (float3) (hue_to_rgb (p, q, hsl.x + 1.0f / 3.0f),               \n"
+"                   hue_to_rgb (p, q, hsl.x),                             \n"
+"                   hue_to_rgb (p, q, hsl.x - 1.0f / 3.0f));              \n"
+"}                                                                        \n"
+"                                                                         \n"
+"__kernel void gimp_color_balance (__global const float4 *in,             \n"
+"                                  __global       float4 *out,            \n"
+"                                  float4                 red,            \n"
+"                                  float4                 green,          \n"
+"                                  float4                 blue,           \n"
+"                                  int                    preserve)       \n"
+"{                                                                        \n"
+"  const float a     = 0.25f;                                             \n"
+"  const float b     = 0.333f;                                            \n"
+"  const float scale = 0.7f;                                              \n"
+"  int    gid        = get_global_id (0);                                 \n"
+"  float4 src        = in[gid];                                           \n"
+"  float  lightness  = rgb_to_hsl (src.xyz).z;                            \n"
+"  float4 mask;                                                           \n"
+"  float4 dest;                                                           \n"
+"                                                                         \n"
+"  mask.x = clamp ((lightness - b) / -a + 0.5f, 0.0f, 1.0f) * scale;      \n"
+"  mask.y = clamp ((lightness - b) /  a + 0.5f, 0.0f, 1.0f) *             \n"
+"           clamp ((lightness + b - 1.0f) / -a + 0.5f, 0.0f, 1.0f) *      \n"
+"           scale;                                                        \n"
+"  mask.z = clamp ((lightness + b - 1.0f) /  a + 0.5f, 0.0f, 1.0f) *      \n"
+"           scale;                                                        \n"
+"  mask.w = 0.0f;                                                         \n"
+"                                                                         \n"
+"  dest.x = src.x + dot (red,   mask);                                    \n"
+"  dest.y = src.y + dot (green, mask);                                    \n"
+"  dest.z = src.z + dot (blue,  mask);                                    \n"
+"  dest.xyz = clamp (dest.xyz, 0.0f, 1.0f);                               \n"
+"  dest.w = src.w;                                                        \n"
+"                                                                         \n"
+"  if (preserve)                                                          \n"
+"    {                                                                    \n"
+"      float3 hsl = rgb_to_hsl (dest.xyz);                                \n"
+"                                                                         \n"
+"      hsl.z    = lightness;                                              \n"
+"      dest.xyz = hsl_to_rgb (hsl);                                       \n"
+"    }                                                                    \n"
+"                                                                         \n"
+"  out[gid] = dest;                                                       \n"
+"}                                                                        \n";
+
+static GeglClRunData *cl_data = NULL;
+
+
 static void
 gimp_operation_color_balance_class_init (GimpOperationColorBalanceClass *klass)
 {
@@ -69,6 +187,9 @@ gimp_operation_color_balance_class_init (GimpOperationColorBalanceClass *klass)
   operation_class->prepare = gimp_operation_color_balance_prepare;
 
   point_class->process     = gimp_operation_color_balance_process;
+  point_class->cl_process  = gimp_operation_color_balance_cl_process;
+
+  operation_class->opencl_support = TRUE;
 
   g_object_class_install_property (object_class,
                                    GIMP_OPERATION_POINT_FILTER_PROP_CONFIG,
@@ -246,3 +367,67 @@ gimp_operation_color_balance_process (GeglOperation       *operation,
 
   return TRUE;
 }
+
+static gboolean
+gimp_operation_color_balance_cl_process (GeglOperation       *operation,
+                                         cl_mem               in_tex,
+                                         cl_mem               out_tex,
+                                         size_t               global_worksize,
+                                         const GeglRectangle *roi,
+                                         gint                 level)
+{
+  GimpOperationPointFilter *point  = GIMP_OPERATION_POINT_FILTER (operation);
+  GimpColorBalanceConfig   *config = GIMP_COLOR_BALANCE_CONFIG (point->config);
+  cl_float4                 red;
+  cl_float4                 green;
+  cl_float4                 blue;
+  cl_int                    preserve_luminosity;
+  cl_int                    cl_err;
+  gint                      range;
+
+  if (! config)
+    return TRUE;
+
+  if (! cl_data)
+    {
+      const gchar *kernel_name[] = { "gimp_color_balance", NULL };
+
+      cl_data = gegl_cl_compile_and_build (kernel_source, kernel_name);
+
+      if (! cl_data)
+        return TRUE;
+    }
+
+  for (range = GIMP_TRANSFER_SHADOWS;
+       range <= GIMP_TRANSFER_HIGHLIGHTS;
+       range++)
+    {
+      red.s[range]   = config->cyan_red[range];
+      green.s[range] = config->magenta_green[range];
+      blue.s[range]  = config->yellow_blue[range];
+    }
+
+  red.s[3]   = 0.0f;
+  green.s[3] = 0.0f;
+  blue.s[3]  = 0.0f;
+
+  preserve_luminosity = config->preserve_luminosity;
+
+  cl_err = gegl_cl_set_kernel_args (cl_data->kernel[0],
+                                    sizeof (cl_mem),    &in_tex,
+                                    sizeof (cl_mem),    &out_tex,
+                                    sizeof (cl_float4), &red,
+                                    sizeof (cl_float4), &green,
+                                    sizeof (cl_float4), &blue,
+                                    sizeof (cl_int),    &preserve_luminosity,
+                                    NULL);
+  if (cl_err != CL_SUCCESS)
+    return TRUE;
+
+  cl_err = gegl_clEnqueueNDRangeKernel (gegl_cl_get_command_queue (),
+                                        cl_data->kernel[0], 1,
+                                        NULL, &global_worksize, NULL,
+                                        0, NULL, NULL);
+
+  return cl_err != CL_SUCCESS;
+}
@@ -24,6 +24,8 @@
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gegl.h>
 
+#include <opencl/gegl-cl.h>
+
 #include "libgimpmath/gimpmath.h"
 
 #include "operations-types.h"
@@ -37,12 +39,18 @@
 #include "gimp-intl.h"
 
 
-static gboolean gimp_operation_curves_process (GeglOperation       *operation,
-                                               void                *in_buf,
-                                               void                *out_buf,
-                                               glong                samples,
-                                               const GeglRectangle *roi,
-                                               gint                 level);
+static gboolean gimp_operation_curves_process    (GeglOperation       *operation,
+                                                  void                *in_buf,
+                                                  void                *out_buf,
+                                                  glong                samples,
+                                                  const GeglRectangle *roi,
+                                                  gint                 level);
+static gboolean gimp_operation_curves_cl_process (GeglOperation       *operation,
+                                                  cl_mem               in_tex,
+                                                  cl_mem               out_tex,
+                                                  size_t               global_worksize,
+                                                  const GeglRectangle *roi,
+                                                  gint                 level);
 
 
 G_DEFINE_TYPE (GimpOperationCurves, gimp_operation_curves,
@@ -51,12 +59,89 @@ G_DEFINE_TYPE (GimpOperationCurves, gimp_operation_curves,
 #define parent_class gimp_operation_curves_parent_class
 
 
+/*  the samples of the five curves are passed in one buffer, in the
+ *  order colors, red, green, blue, alpha.  a curve with zero samples
+ *  is the identity, and only clamps.  which curves are applied to
+ *  which channel is decided on the CPU, the same way
+ *  gimp_curve_map_pixels() does.
+ */
+static const gchar *kernel_source =
+"float curves_map (__global const float *samples,                         \n"
+"                  int                   offset,                          \n"
+"                  int                   n_samples,                       \n"
+"                  float                 value)                           \n"
+"{                                                                        \n"
+"  if (n_samples == 0)                                                    \n"
+"    return isfinite (value) ? clamp (value, 0.0f, 1.0f) : 0.0f;          \n"
+"                                                                         \n"
+"  if (value > 0.0f && value < 1.0f)                                      \n"
+"    {                                                                    \n"
+"      int   index;                                                       \n"
+"      float f;                                                           \n"
+"                                                                         \n"
+"      value = value * (n_samples - 1);                                   \n"
+"      index = (int) value;                                               \n"
+"      f     = value - index;                                             \n"
+"                                                                         \n"
+"      return mix (samples[offset + index],                               \n"
+"                  samples[offset + index + 1], f);                       \n"
+"    }                                                                    \n"
+"  else if (value >= 1.0f)                                                \n"
+"    {                                                                    \n"
+"      return samples[offset + n_samples - 1];                            \n"
+"    }                                                                    \n"
+"  else                                                                   \n"
+"    {                                                                    \n"
+"      return samples[offset];                                            \n"
+"    }                                                                    \n"
+"}                                                                        \n"
+"                                                                         \n"
+"__kernel void gimp_curves (__global const float *in,                     \n"
+"                           __global       float *out,                    \n"
+"                           __global const float *samples,                \n"
+"                           int4                  offset,                 \n"
+"                           int4                  n_samples,              \n"
+"                           int                   colors_offset,          \n"
+"                           int                   colors_n_samples,       \n"
+"                           int4                  apply,                  \n"
+"                           int                   apply_colors)           \n"
+"{                                                                        \n"
+"  int gid = get_global_id (0);                                           \n"
+"  int offsets[4];                                                        \n"
+"  int n[4];                                                              \n"
+"  int applies[4];                                                        \n"
+"  int c;                                                                 \n"
+"                                                                         \n"
+"  vstore4 (offset,    0, offsets);                                       \n"
+"  vstore4 (n_samples, 0, n);                                             \n"
+"  vstore4 (apply,     0, applies);                                       \n"
+"                                                                         \n"
+"  for (c = 0; c < 4; c++)                                                \n"
+"    {                                                                    \n"
+"      float value = in[gid * 4 + c];                                     \n"
+"                                                                         \n"
+"      if (applies[c])                                                    \n"
+"        value = curves_map (samples, offsets[c], n[c], value);           \n"
+"                                                                         \n"
+"      /* don't apply the colors curve to the alpha channel */            \n"
+"      if (apply_colors && c < 3)                                         \n"
+"        value = curves_map (samples, colors_offset, colors_n_samples,    \n"
+"                            value);                                      \n"
+"                                                                         \n"
+"      out[gid * 4 + c] = value;                                          \n"
+"    }                                                                    \n"
+"}                                                                        \n";
+
+static GeglClRunData *cl_data = NULL;
+
+
 static void
 gimp_operation_curves_class_init (GimpOperationCurvesClass *klass)
 {
   GObjectClass                  *object_class    = G_OBJECT_CLASS (klass);
   GeglOperationClass            *operation_class = GEGL_OPERATION_CLASS (klass);
   GeglOperationPointFilterClass *point_class     = GEGL_OPERATION_POINT_FILTER_CLASS (klass);
+  GimpOperationPointFilterClass *filter_class    = GIMP_OPERATION_POINT_FILTER_CLASS (klass);
 
   object_class->set_property   = gimp_operation_point_filter_set_property;
   object_class->get_property   = gimp_operation_point_filter_get_property;
@@ -67,7 +152,12 @@ gimp_operation_curves_class_init (GimpOperationCurvesClass *klass)
                                  "description", _("Adjust color curves"),
                                  NULL);
 
-  point_class->process = gimp_operation_curves_process;
+  point_class->process    = gimp_operation_curves_process;
+  point_class->cl_process = gimp_operation_curves_cl_process;
+
+  operation_class->opencl_support = TRUE;
+
+  filter_class->use_lut = TRUE;
 
   g_object_class_install_property (object_class,
                                    GIMP_OPERATION_POINT_FILTER_PROP_TRC,
@@ -109,6 +199,10 @@ gimp_operation_curves_process (GeglOperation       *operation,
   if (! config)
     return FALSE;
 
+  if (gimp_operation_point_filter_process_lut (operation, in_buf, out_buf,
+                                               samples, roi, level))
+    return TRUE;
+
   gimp_curve_map_pixels (config->curve[0],
                          config->curve[1],
                          config->curve[2],
@@ -117,3 +211,152 @@ gimp_operation_curves_process (GeglOperation       *operation,
 
   return TRUE;
 }
+
+static gboolean
+gimp_operation_curves_cl_process (GeglOperation       *operation,
+                                  cl_mem               in_tex,
+                                  cl_mem               out_tex,
+                                  size_t               global_worksize,
+                                  const GeglRectangle *roi,
+                                  gint                 level)
+{
+  GimpOperationPointFilter *point  = GIMP_OPERATION_POINT_FILTER (operation);
+  GimpCurvesConfig         *config = GIMP_CURVES_CONFIG (point->config);
+  gfloat                   *samples;
+  cl_mem                    samples_tex;
+  cl_int4                   offset;
+  cl_int4                   n_samples;
+  cl_int4                   apply;
+  cl_int                    colors_offset;
+  cl_int                    colors_n_samples;
+  cl_int                    apply_colors;
+  cl_int                    cl_err;
+  gboolean                  identity[5];
+  gint                      n_total = 0;
+  gint                      channel;
+  gint                      i;
+
+  if (! config)
+    return TRUE;
+
+  if (! cl_data)
+    {
+      const gchar *kernel_name[] = { "gimp_curves", NULL };
+
+      cl_data = gegl_cl_compile_and_build (kernel_source, kernel_name);
+
+      if (! cl_data)
+        return TRUE;
+    }
+
+  for (channel = 0; channel < 5; channel++)
+    {
+      identity[channel] = gimp_curve_is_identity (config->curve[channel]);
+
+      if (! identity[channel])
+        n_total += config->curve[channel]->n_samples;
+    }
+
+  /*  always upload at least one sample, empty buffers are invalid  */
+  samples = g_new0 (gfloat, MAX (n_total, 1));
+
+  for (channel = 0, n_total = 0; channel < 5; channel++)
+    {
+      GimpCurve *curve = config->curve[channel];
+      gint       n     = identity[channel] ? 0 : curve->n_samples;
+
+      for (i = 0; i < n; i++)
+        samples[n_total + i] = curve->samples[i];
+
+      if (channel == GIMP_HISTOGRAM_VALUE)
+        {
+          colors_offset    = n_total;
+          colors_n_samples = n;
+        }
+      else
+        {
+          offset.s[channel - 1]    = n_total;
+          n_samples.s[channel - 1] = n;
+        }
+
+      n_total += n;
+    }
+
+  /*  see gimp_curve_map_pixels()  */
+  if (identity[GIMP_HISTOGRAM_RED]   &&
+      identity[GIMP_HISTOGRAM_GREEN] &&
+      identity[GIMP_HISTOGRAM_BLUE]  &&
+      identity[GIMP_HISTOGRAM_ALPHA])
+    {
+      apply_colors = ! identity[GIMP_HISTOGRAM_VALUE];
+
+      for (i = 0; i < 4; i++)
+        apply.s[i] = FALSE;
+    }
+  else if (identity[GIMP_HISTOGRAM_VALUE])
+    {
+      gboolean rgb = (! identity[GIMP_HISTOGRAM_RED]   &&
+                      ! identity[GIMP_HISTOGRAM_GREEN] &&
+                      ! identity[GIMP_HISTOGRAM_BLUE]  &&
+                      identity[GIMP_HISTOGRAM_ALPHA]);
+      gint     n_applied = 0;
+
+      for (i = 0; i < 4; i++)
+        n_applied += ! identity[i + 1];
+
+      if (rgb || n_applied == 1)
+        {
+          apply_colors = FALSE;
+
+          for (i = 0; i < 4; i++)
+            apply.s[i] = ! identity[i + 1];
+        }
+      else
+        {
+          apply_colors = TRUE;
+
+          for (i = 0; i < 4; i++)
+            apply.s[i] = TRUE;
+        }
+    }
+  else
+    {
+      apply_colors = TRUE;
+
+      for (i = 0; i < 4; i++)
+        apply.s[i] = TRUE;
+    }
+
+  samples_tex = gegl_clCreateBuffer (gegl_cl_get_context (),
+                                     CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                                     MAX (n_total, 1) * sizeof (gfloat),
+                                     samples, &cl_err);
+
+  g_free (samples);
+
+  if (cl_err != CL_SUCCESS)
+    return TRUE;
+
+  cl_err = gegl_cl_set_kernel_args (cl_data->kernel[0],
+                                    sizeof (cl_mem),  &in_tex,
+                                    sizeof (cl_mem),  &out_tex,
+                                    sizeof (cl_mem),  &samples_tex,
+                                    sizeof (cl_int4), &offset,
+                                    sizeof (cl_int4), &n_samples,
+                                    sizeof (cl_int),  &colors_offset,
+                                    sizeof (cl_int),  &colors_n_samples,
+                                    sizeof (cl_int4), &apply,
+                                    sizeof (cl_int),  &apply_colors,
+                                    NULL);
+
+  if (cl_err == CL_SUCCESS)
+    cl_err = gegl_clEnqueueNDRangeKernel (gegl_cl_get_command_queue (),
+                                          cl_data->kernel[0], 1,
+                                          NULL, &global_worksize, NULL,
+                                          0, NULL, NULL);
+
+  /*  the buffer is only freed once the kernel is done with it  */
+  gegl_clReleaseMemObject (samples_tex);
+
+  return cl_err != CL_SUCCESS;
+}
@@ -151,6 +151,17 @@ static gdouble         gradient_calc_shapeburst_dimpled_factor   (GeglSampler
                                                                   gdouble                x,
                                                                   gdouble                y);
 
+static gdouble         gradient_calc_factor                      (gdouble                x,
+                                                                  gdouble                y,
+                                                                  RenderBlendData       *rbd);
+static void            gradient_calc_row_factors                 (gint                   x,
+                                                                  gint                   y,
+                                                                  gint                   width,
+                                                                  gdouble               *factors,
+                                                                  RenderBlendData       *rbd);
+static void            gradient_get_color                        (gdouble                factor,
+                                                                  gdouble               *rgb,
+                                                                  RenderBlendData       *rbd);
 static void            gradient_render_pixel                     (gdouble                x,
                                                                   gdouble                y,
                                                                   gdouble               *color,
@@ -469,26 +480,18 @@ gimp_operation_gradient_set_property (GObject      *object,
 
     case PROP_START_X:
       self->start_x = g_value_get_double (value);
-
-      gimp_operation_gradient_invalidate_cache (self);
       break;
 
     case PROP_START_Y:
       self->start_y = g_value_get_double (value);
-
-      gimp_operation_gradient_invalidate_cache (self);
       break;
 
     case PROP_END_X:
       self->end_x = g_value_get_double (value);
-
-      gimp_operation_gradient_invalidate_cache (self);
       break;
 
     case PROP_END_Y:
       self->end_y = g_value_get_double (value);
-
-      gimp_operation_gradient_invalidate_cache (self);
       break;
 
     case PROP_GRADIENT_TYPE:
@@ -872,20 +875,12 @@ gradient_calc_shapeburst_dimpled_factor (GeglSampler *dist_sampler,
   return value;
 }
 
-static void
-gradient_render_pixel (gdouble   x,
-                       gdouble   y,
-                       gdouble  *rgb,
-                       gpointer  render_data)
+static gdouble
+gradient_calc_factor (gdouble          x,
+                      gdouble          y,
+                      RenderBlendData *rbd)
 {
-  RenderBlendData *rbd = render_data;
-  gdouble          factor;
-
-  /*  we want to calculate the color at the pixel's center  */
-  x += 0.5;
-  y += 0.5;
-
-  /* Calculate blending factor */
+  gdouble factor;
 
   switch (rbd->gradient_type)
     {
@@ -955,10 +950,120 @@ gradient_render_pixel (gdouble   x,
       break;
 
     default:
-      g_return_if_reached ();
+      g_return_val_if_reached (0.0);
       break;
     }
 
+  return factor;
+}
+
+/*  computes the blending factors of 'width' pixels of row 'y', starting
+ *  at 'x'.  the common shapes are evaluated in plain loops over the row,
+ *  which the compiler can vectorize.
+ */
+static void
+gradient_calc_row_factors (gint             x,
+                           gint             y,
+                           gint             width,
+                           gdouble         *factors,
+                           RenderBlendData *rbd)
+{
+  const gdouble dx     = x + 0.5 - rbd->sx;
+  const gdouble dy     = y + 0.5 - rbd->sy;
+  const gdouble offset = rbd->offset / 100.0;
+  gint          i;
+
+  if (rbd->dist == 0.0 &&
+      (rbd->gradient_type == GIMP_GRADIENT_LINEAR   ||
+       rbd->gradient_type == GIMP_GRADIENT_BILINEAR ||
+       rbd->gradient_type == GIMP_GRADIENT_RADIAL   ||
+       rbd->gradient_type == GIMP_GRADIENT_SQUARE))
+    {
+      for (i = 0; i < width; i++)
+        factors[i] = 0.0;
+
+      return;
+    }
+
+  switch (rbd->gradient_type)
+    {
+    case GIMP_GRADIENT_LINEAR:
+      {
+        const gdouble rat0 = (rbd->vec[0] * dx + rbd->vec[1] * dy) / rbd->dist;
+        const gdouble step = rbd->vec[0] / rbd->dist;
+
+        for (i = 0; i < width; i++)
+          {
+            const gdouble rat = rat0 + i * step;
+
+            if (rat >= 0.0 && rat < offset)
+              factors[i] = 0.0;
+            else if (offset == 1.0)
+              factors[i] = (rat >= 1.0) ? 1.0 : 0.0;
+            else if (rat < 0.0)
+              factors[i] = rat / (1.0 - offset);
+            else
+              factors[i] = (rat - offset) / (1.0 - offset);
+          }
+      }
+      break;
+
+    case GIMP_GRADIENT_BILINEAR:
+      {
+        const gdouble rat0 = (rbd->vec[0] * dx + rbd->vec[1] * dy) / rbd->dist;
+        const gdouble step = rbd->vec[0] / rbd->dist;
+
+        for (i = 0; i < width; i++)
+          {
+            const gdouble rat = rat0 + i * step;
+
+            if (fabs (rat) < offset)
+              factors[i] = 0.0;
+            else if (offset == 1.0)
+              factors[i] = (rat == 1.0) ? 1.0 : 0.0;
+            else
+              factors[i] = (fabs (rat) - offset) / (1.0 - offset);
+          }
+      }
+      break;
+
+    case GIMP_GRADIENT_RADIAL:
+    case GIMP_GRADIENT_SQUARE:
+      {
+        const gboolean radial = (rbd->gradient_type == GIMP_GRADIENT_RADIAL);
+
+        for (i = 0; i < width; i++)
+          {
+            const gdouble px  = dx + i;
+            gdouble       rat;
+
+            if (radial)
+              rat = sqrt (SQR (px) + SQR (dy)) / rbd->dist;
+            else
+              rat = MAX (fabs (px), fabs (dy)) / rbd->dist;
+
+            if (rat < offset)
+              factors[i] = 0.0;
+            else if (offset == 1.0)
+              factors[i] = (rat >= 1.0) ? 1.0 : 0.0;
+            else
+              factors[i] = (rat - offset) / (1.0 - offset);
+          }
+      }
+      break;
+
+    default:
+      for (i = 0; i < width; i++)
+        factors[i] = gradient_calc_factor (x + i + 0.5, y + 0.5, rbd);
+      break;
+    }
+}
+
+static void
+gradient_get_color (gdouble          factor,
+                    gdouble         *rgb,
+                    RenderBlendData *rbd)
+{
   /* Adjust for repeat */
 
   switch (rbd->repeat)
@@ -1023,6 +1128,19 @@ gradient_render_pixel (gdouble   x,
     }
 }
 
+static void
+gradient_render_pixel (gdouble   x,
+                       gdouble   y,
+                       gdouble  *rgb,
+                       gpointer  render_data)
+{
+  RenderBlendData *rbd = render_data;
+
+  /*  we want to calculate the color at the pixel's center  */
+  gradient_get_color (gradient_calc_factor (x + 0.5, y + 0.5, rbd),
+                      rgb, rbd);
+}
+
 static void
 gradient_put_pixel (gint      x,
                     gint      y,
@@ -1200,42 +1318,57 @@ gimp_operation_gradient_process (GeglOperation       *operation,
     }
   else
     {
+      gdouble *factors = NULL;
+      gint     n_factors = 0;
+
       while (gegl_buffer_iterator_next (iter))
         {
           gfloat *dest = iter->items[0].data;
-          gint    endx = roi->x + roi->width;
           gint    endy = roi->y + roi->height;
           gint    x, y;
 
-          if (dither_rand)
+          if (n_factors < roi->width)
             {
-              for (y = roi->y; y < endy; y++)
-                for (x = roi->x; x < endx; x++)
-                  {
-                    gdouble color[4] = { 0.0, 0.0, 0.0, 1.0 };
-
-                    gradient_render_pixel (x, y, color, &rbd);
-                    gradient_dither_pixel (color, dither_rand, dest);
+              g_free (factors);
 
-                    dest += 4;
-                  }
+              n_factors = roi->width;
+              factors   = g_new (gdouble, n_factors);
             }
-          else
+
+          for (y = roi->y; y < endy; y++)
             {
-              for (y = roi->y; y < endy; y++)
-                for (x = roi->x; x < endx; x++)
-                  {
-                    gdouble color[4] = { 0.0, 0.0, 0.0, 1.0 };
-
-                    gradient_render_pixel (x, y, color, &rbd);
-
-                    *dest++ = color[0];
-                    *dest++ = color[1];
-                    *dest++ = color[2];
-                    *dest++ = color[3];
-                  }
+              gradient_calc_row_factors (roi->x, y, roi->width, factors, &rbd);
+
+              if (dither_rand)
+                {
+                  for (x = 0; x < roi->width; x++)
+                    {
+                      gdouble color[4] = { 0.0, 0.0, 0.0, 1.0 };
+
+                      gradient_get_color (factors[x], color, &rbd);
+                      gradient_dither_pixel (color, dither_rand, dest);
+
+                      dest += 4;
+                    }
+                }
+              else
+                {
+                  for (x = 0; x < roi->width; x++)
+                    {
+                      gdouble color[4] = { 0.0, 0.0, 0.0, 1.0 };
+
+                      gradient_get_color (factors[x], color, &rbd);
+
+                      *dest++ = color[0];
+                      *dest++ = color[1];
+                      *dest++ = color[2];
+                      *dest++ = color[3];
+                    }
+                }
             }
         }
+
+      g_free (factors);
     }
 
   if (self->dither)
@@ -1265,28 +1398,35 @@ gimp_operation_gradient_validate_cache (GimpOperationGradient *self)
 
   g_mutex_lock (&self->gradient_cache_mutex);
 
-  if (self->gradient_cache)
-    {
-      g_mutex_unlock (&self->gradient_cache_mutex);
-
-      return;
-    }
-
   cache_size = ceil (hypot (self->start_x - self->end_x,
                             self->start_y - self->end_y)) *
                GRADIENT_CACHE_N_SUPERSAMPLES;
 
-  /*  have at least two values in the cache  */
-  cache_size = MAX (cache_size, 2);
-
-  /*  don't use a cache if its necessary size is too big  */
-  if (cache_size > GRADIENT_CACHE_MAX_SIZE)
+  /*  have at least two values in the cache, and don't let it get too
+   *  big, which still leaves more than one value per pixel for all but
+   *  the longest gradients
+   */
+  cache_size = CLAMP (cache_size, 2, GRADIENT_CACHE_MAX_SIZE);
+
+  /*  the cache only depends on the length of the gradient through its
+   *  size, so keep it while it's big enough; this is what happens while
+   *  the gradient tool's line is dragged
+   */
+  if (self->gradient_cache && self->gradient_cache_size >= cache_size)
     {
       g_mutex_unlock (&self->gradient_cache_mutex);
 
       return;
     }
 
+  /*  grow in powers of two, so that a growing gradient doesn't rebuild
+   *  the cache each time
+   */
+  cache_size = MIN (1 << g_bit_storage (cache_size - 1),
+                    GRADIENT_CACHE_MAX_SIZE);
+
+  g_free (self->gradient_cache);
+
   self->gradient_cache      = g_new0 (gdouble, cache_size * 4);
   self->gradient_cache_size = cache_size;
 
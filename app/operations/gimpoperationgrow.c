@@ -29,6 +29,8 @@
 
 #include "operations-types.h"
 
+#include "gegl/gimp-gegl-distance.h"
+
 #include "gimpoperationgrow.h"
 
 
@@ -225,6 +227,67 @@ rotate_pointers (gfloat  **p,
   p[i] = tmp;
 }
 
+/* Grows a mask whose pixels are all either selected or unselected through
+ * a distance transform: a pixel is selected if there's a selected pixel
+ * within an ellipse of the operation's radii around it.  This takes
+ * linear time regardless of the radii, unlike the algorithm below, but
+ * can't handle partially-selected pixels, in which case FALSE is returned.
+ */
+static gboolean
+gimp_operation_grow_process_binary (GimpOperationGrow   *self,
+                                    GeglBuffer          *input,
+                                    const Babl          *input_format,
+                                    GeglBuffer          *output,
+                                    const Babl          *output_format,
+                                    const GeglRectangle *roi)
+{
+  gsize   n_pixels = (gsize) roi->width * roi->height;
+  gfloat *map;
+  gsize   i;
+
+  map = g_new (gfloat, n_pixels);
+
+  gegl_buffer_get (input, roi, 1.0, input_format, map,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  /* the selected pixels are the features of the transform */
+  for (i = 0; i < n_pixels; i++)
+    {
+      if (map[i] == 1.0f)
+        {
+          map[i] = 0.0f;
+        }
+      else if (map[i] == 0.0f)
+        {
+          map[i] = 1.0f;
+        }
+      else
+        {
+          g_free (map);
+
+          return FALSE;
+        }
+    }
+
+  /* the radii are extended by half a pixel, to match the filter's mask
+   * of the algorithm below, which reaches the far edge of the outermost
+   * pixels
+   */
+  gimp_gegl_distance_transform (map, roi->width, roi->height,
+                                1.0 / SQR (self->radius_x + 0.5),
+                                1.0 / SQR (self->radius_y + 0.5),
+                                FALSE);
+
+  for (i = 0; i < n_pixels; i++)
+    map[i] = map[i] <= 1.0f ? 1.0f : 0.0f;
+
+  gegl_buffer_set (output, roi, 0, output_format, map, GEGL_AUTO_ROWSTRIDE);
+
+  g_free (map);
+
+  return TRUE;
+}
+
 static gboolean
 gimp_operation_grow_process (GeglOperation       *operation,
                              GeglBuffer          *input,
@@ -247,6 +310,14 @@ gimp_operation_grow_process (GeglOperation       *operation,
   gint16             last_index;
   gfloat            *buffer;
 
+  if (gimp_operation_grow_process_binary (self,
+                                          input,  input_format,
+                                          output, output_format,
+                                          roi))
+    {
+      return TRUE;
+    }
+
   max = g_new (gfloat *, roi->width + 2 * self->radius_x);
   buf = g_new (gfloat *, self->radius_y + 1);
 
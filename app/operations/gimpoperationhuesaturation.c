@@ -24,6 +24,8 @@
 #include <gegl.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
 
+#include <opencl/gegl-cl.h>
+
 #include "libgimpcolor/gimpcolor.h"
 #include "libgimpmath/gimpmath.h"
 
@@ -36,12 +38,18 @@
 
 static void gimp_operation_hue_saturation_prepare (GeglOperation *operation);
 
-static gboolean gimp_operation_hue_saturation_process (GeglOperation       *operation,
-                                                       void                *in_buf,
-                                                       void                *out_buf,
-                                                       glong                samples,
-                                                       const GeglRectangle *roi,
-                                                       gint                 level);
+static gboolean gimp_operation_hue_saturation_process    (GeglOperation       *operation,
+                                                          void                *in_buf,
+                                                          void                *out_buf,
+                                                          glong                samples,
+                                                          const GeglRectangle *roi,
+                                                          gint                 level);
+static gboolean gimp_operation_hue_saturation_cl_process (GeglOperation       *operation,
+                                                          cl_mem               in_tex,
+                                                          cl_mem               out_tex,
+                                                          size_t               global_worksize,
+                                                          const GeglRectangle *roi,
+                                                          gint                 level);
 
 
 G_DEFINE_TYPE (GimpOperationHueSaturation, gimp_operation_hue_saturation,
@@ -50,6 +58,145 @@ G_DEFINE_TYPE (GimpOperationHueSaturation, gimp_operation_hue_saturation,
 #define parent_class gimp_operation_hue_saturation_parent_class
 
 
+/*  the per-range adjustments are passed as float8s indexed by
+ *  GimpHueRange, the kernel is a port of
+ *  gimp_operation_hue_saturation_process().
+ */
+static const gchar *kernel_source =
+"float map_hue (float value,                                              \n"
+"               float v)                                                  \n"
+"{                                                                        \n"
+"  value += v / 2.0f;                                                     \n"
+"                                                                         \n"
+"  if (value < 0.0f)                                                      \n"
+"    return value + 1.0f;                                                 \n"
+"  else if (value > 1.0f)                                                 \n"
+"    return value - 1.0f;                                                 \n"
+"  else                                                                   \n"
+"    return value;                                                        \n"
+"}                                                                        \n"
+"                                                                         \n"
+"float map_saturation (float value,                                       \n"
+"                      float v)                                           \n"
+"{                                                                        \n"
+"  return clamp (value * (v + 1.0f), 0.0f, 1.0f);                         \n"
+"}                                                                        \n"
+"                                                                         \n"
+"float map_lightness (float value,                                        \n"
+"                     float v)                                            \n"
+"{                                                                        \n"
+"  if (v < 0.0f)                                                          \n"
+"    return value * (v + 1.0f);                                           \n"
+"  else                                                                   \n"
+"    return value + (v * (1.0f - value));                                 \n"
+"}                                                                        \n"
+"                                                                         \n"
+"__kernel void gimp_hue_saturation (__global const float4 *in,            \n"
+"                                   __global       float4 *out,           \n"
+"                                   float8                 hue,           \n"
+"                                   float8                 saturation,    \n"
+"                                   float8                 lightness,     \n"
+"                                   float                  overlap)       \n"
+"{                                                                        \n"
+"  int    gid                 = get_global_id (0);                        \n"
+"  float4 hsl                 = in[gid];                                  \n"
+"  float  h                   = hsl.x * 6.0f;                             \n"
+"  int    range               = 0;                                        \n"
+"  int    secondary_range     = 0;                                        \n"
+"  int    use_secondary       = 0;                                        \n"
+"  float  primary_intensity   = 0.0f;                                     \n"
+"  float  secondary_intensity = 0.0f;                                     \n"
+"  float  hues[8];                                                        \n"
+"  float  saturations[8];                                                 \n"
+"  float  lightnesses[8];                                                 \n"
+"  int    i;                                                              \n"
+"                                                                         \n"
+"  vstore8 (hue,        0, hues);                                         \n"
+"  vstore8 (saturation, 0, saturations);                                  \n"
+"  vstore8 (lightness,  0, lightnesses);                                  \n"
+"                                                                         \n"
+"  for (i = 0; i < 7; i++)                                                \n"
+"    {                                                                    \n"
+"      float hue_threshold = (float) i + 0.5f;                            \n"
+"                                                                         \n"
+"      if (h < hue_threshold + overlap)                                   \n"
+"        {                                                                \n"
+"          range = i;                                                     \n"
+"                                                                         \n"
+"          if (overlap > 0.0f && h > hue_threshold - overlap)             \n"
+"            {                                                            \n"
+"              use_secondary       = 1;                                   \n"
+"              secondary_range     = i + 1;                               \n"
+"              secondary_intensity =                                      \n"
+"                (h - hue_threshold + overlap) / (2.0f * overlap);        \n"
+"              primary_intensity   = 1.0f - secondary_intensity;          \n"
+"            }                                                            \n"
+"          else                                                           \n"
+"            {                                                            \n"
+"              use_secondary = 0;                                         \n"
+"            }                                                            \n"
+"                                                                         \n"
+"          break;                                                         \n"
+"        }                                                                \n"
+"    }                                                                    \n"
+"                                                                         \n"
+"  if (range >= 6)                                                        \n"
+"    {                                                                    \n"
+"      range         = 0;                                                 \n"
+"      use_secondary = 0;                                                 \n"
+"    }                                                                    \n"
+"                                                                         \n"
+"  if (secondary_range >= 6)                                              \n"
+"    secondary_range = 0;                                                 \n"
+"                                                                         \n"
+"  /*  transform into GimpHueRange values  */                             \n"
+"  range++;                                                               \n"
+"  secondary_range++;                                                     \n"
+"                                                                         \n"
+"  if (use_secondary)                                                     \n"
+"    {                                                                    \n"
+"      float s = hsl.y;                                                   \n"
+"      float l = hsl.z;                                                   \n"
+"                                                                         \n"
+"      hsl.x = map_hue (hsl.x,                                            \n"
+"                       hues[0] +                                         \n"
+"                       hues[range]           * primary_intensity +       \n"
+"                       hues[secondary_range] * secondary_intensity);     \n"
+"                                                                         \n"
+"      hsl.y = (map_saturation (s, saturations[0] +                       \n"
+"                                  saturations[range]) *                  \n"
+"               primary_intensity +                                       \n"
+"               map_saturation (s, saturations[0] +                       \n"
+"                                  saturations[secondary_range]) *        \n"
+"               secondary_intensity);                                     \n"
+"                                                                         \n"
+"      hsl.z = (map_lightness (l, lightnesses[0] +                        \n"
+"                                 lightnesses[range]) *                   \n"
+"               primary_intensity +                                       \n"
+"               map_lightness (l, lightnesses[0] +                        \n"
+"                                 lightnesses[secondary_range]) *         \n"
+"               secondary_intensity);                                     \n"
+"    }                                                                    \n"
+"  else if (hsl.y <= 0.0f)                                                \n"
+"    {                                                                    \n"
+"      hsl.z = map_lightness (hsl.z, lightnesses[0]);                     \n"
+"    }                                                                    \n"
+"  else                                                                   \n"
+"    {                                                                    \n"
+"      hsl.x = map_hue        (hsl.x,                                     \n"
+"                              hues[0] + hues[range]);                    \n"
+"      hsl.z = map_lightness  (hsl.z,                                     \n"
+"                              lightnesses[0] + lightnesses[range]);      \n"
+"      hsl.y = map_saturation (hsl.y,                                     \n"
+"                              saturations[0] + saturations[range]);      \n"
+"    }                                                                    \n"
+"                                                                         \n"
+"  out[gid] = hsl;                                                        \n"
+"}                                                                        \n";
+
+static GeglClRunData *cl_data = NULL;
+
+
 static void
 gimp_operation_hue_saturation_class_init (GimpOperationHueSaturationClass *klass)
 {
@@ -66,9 +213,12 @@ gimp_operation_hue_saturation_class_init (GimpOperationHueSaturationClass *klass
                                  "description", _("Adjust hue, saturation, and lightness"),
                                  NULL);
 
-  point_class->process = gimp_operation_hue_saturation_process;
+  point_class->process    = gimp_operation_hue_saturation_process;
+  point_class->cl_process = gimp_operation_hue_saturation_cl_process;
   operation_class->prepare = gimp_operation_hue_saturation_prepare;
 
+  operation_class->opencl_support = TRUE;
+
   g_object_class_install_property (object_class,
                                    GIMP_OPERATION_POINT_FILTER_PROP_CONFIG,
                                    g_param_spec_object ("config",
@@ -304,6 +454,73 @@ gimp_operation_hue_saturation_process (GeglOperation       *operation,
   return TRUE;
 }
 
+static gboolean
+gimp_operation_hue_saturation_cl_process (GeglOperation       *operation,
+                                          cl_mem               in_tex,
+                                          cl_mem               out_tex,
+                                          size_t               global_worksize,
+                                          const GeglRectangle *roi,
+                                          gint                 level)
+{
+  GimpOperationPointFilter *point  = GIMP_OPERATION_POINT_FILTER (operation);
+  GimpHueSaturationConfig  *config = GIMP_HUE_SATURATION_CONFIG (point->config);
+  cl_float8                 hue;
+  cl_float8                 saturation;
+  cl_float8                 lightness;
+  cl_float                  overlap;
+  cl_int                    cl_err;
+  gint                      range;
+
+  if (! config)
+    return TRUE;
+
+  if (! cl_data)
+    {
+      const gchar *kernel_name[] = { "gimp_hue_saturation", NULL };
+
+      cl_data = gegl_cl_compile_and_build (kernel_source, kernel_name);
+
+      if (! cl_data)
+        return TRUE;
+    }
+
+  for (range = 0; range < 8; range++)
+    {
+      if (range <= GIMP_HUE_RANGE_MAGENTA)
+        {
+          hue.s[range]        = config->hue[range];
+          saturation.s[range] = config->saturation[range];
+          lightness.s[range]  = config->lightness[range];
+        }
+      else
+        {
+          hue.s[range]        = 0.0f;
+          saturation.s[range] = 0.0f;
+          lightness.s[range]  = 0.0f;
+        }
+    }
+
+  overlap = config->overlap / 2.0;
+
+  cl_err = gegl_cl_set_kernel_args (cl_data->kernel[0],
+                                    sizeof (cl_mem),    &in_tex,
+                                    sizeof (cl_mem),    &out_tex,
+                                    sizeof (cl_float8), &hue,
+                                    sizeof (cl_float8), &saturation,
+                                    sizeof (cl_float8), &lightness,
+                                    sizeof (cl_float),  &overlap,
+                                    NULL);
+  if (cl_err != CL_SUCCESS)
+    return TRUE;
+
+  cl_err = gegl_clEnqueueNDRangeKernel (gegl_cl_get_command_queue (),
+                                        cl_data->kernel[0], 1,
+                                        NULL, &global_worksize, NULL,
+                                        0, NULL, NULL);
+
+  return cl_err != CL_SUCCESS;
+}
+
 
 /*  public functions  */
 
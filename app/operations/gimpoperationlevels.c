@@ -24,6 +24,8 @@
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gegl.h>
 
+#include <opencl/gegl-cl.h>
+
 #include "libgimpmath/gimpmath.h"
 
 #include "operations-types.h"
@@ -40,6 +42,12 @@ static gboolean gimp_operation_levels_process (GeglOperation       *operation,
                                                glong                samples,
                                                const GeglRectangle *roi,
                                                gint                 level);
+static gboolean gimp_operation_levels_cl_process (GeglOperation       *operation,
+                                                  cl_mem               in_tex,
+                                                  cl_mem               out_tex,
+                                                  size_t               global_worksize,
+                                                  const GeglRectangle *roi,
+                                                  gint                 level);
 
 
 G_DEFINE_TYPE (GimpOperationLevels, gimp_operation_levels,
@@ -48,12 +56,84 @@ G_DEFINE_TYPE (GimpOperationLevels, gimp_operation_levels,
 #define parent_class gimp_operation_levels_parent_class
 
 
+/*  per-channel parameters are passed as float4s, the parameters of the
+ *  overall curve, which isn't applied to alpha, as floats.  see
+ *  gimp_operation_levels_map().
+ */
+static const gchar *kernel_source =
+"float4 levels_map (float4 value,                                         \n"
+"                   float4 low_input,                                     \n"
+"                   float4 high_input,                                    \n"
+"                   int    clamp_input,                                   \n"
+"                   float4 inv_gamma,                                     \n"
+"                   float4 low_output,                                    \n"
+"                   float4 high_output,                                   \n"
+"                   int    clamp_output)                                  \n"
+"{                                                                        \n"
+"  value = select (value - low_input,                                     \n"
+"                  (value - low_input) / (high_input - low_input),        \n"
+"                  high_input != low_input);                              \n"
+"                                                                         \n"
+"  if (clamp_input)                                                       \n"
+"    value = clamp (value, 0.0f, 1.0f);                                   \n"
+"                                                                         \n"
+"  value = select (value, pow (value, inv_gamma),                         \n"
+"                  inv_gamma != 1.0f && value > 0.0f);                    \n"
+"                                                                         \n"
+"  value = select (low_output - value * (low_output - high_output),       \n"
+"                  value * (high_output - low_output) + low_output,       \n"
+"                  high_output >= low_output);                            \n"
+"                                                                         \n"
+"  if (clamp_output)                                                      \n"
+"    value = clamp (value, 0.0f, 1.0f);                                   \n"
+"                                                                         \n"
+"  return value;                                                          \n"
+"}                                                                        \n"
+"                                                                         \n"
+"__kernel void gimp_levels (__global const float4 *in,                    \n"
+"                           __global       float4 *out,                   \n"
+"                           float4                 low_input,             \n"
+"                           float4                 high_input,            \n"
+"                           float4                 inv_gamma,             \n"
+"                           float4                 low_output,            \n"
+"                           float4                 high_output,           \n"
+"                           float                  value_low_input,       \n"
+"                           float                  value_high_input,      \n"
+"                           float                  value_inv_gamma,       \n"
+"                           float                  value_low_output,      \n"
+"                           float                  value_high_output,     \n"
+"                           int                    clamp_input,           \n"
+"                           int                    clamp_output)          \n"
+"{                                                                        \n"
+"  int    gid = get_global_id (0);                                        \n"
+"  float4 src = in[gid];                                                  \n"
+"  float4 v;                                                              \n"
+"                                                                         \n"
+"  v = levels_map (src, low_input, high_input, clamp_input, inv_gamma,    \n"
+"                  low_output, high_output, clamp_output);                \n"
+"                                                                         \n"
+"  v.xyz = levels_map ((float4) (v.xyz, 0.0f),                            \n"
+"                      (float4) (value_low_input),                        \n"
+"                      (float4) (value_high_input),                       \n"
+"                      clamp_input,                                       \n"
+"                      (float4) (value_inv_gamma),                        \n"
+"                      (float4) (value_low_output),                       \n"
+"                      (float4) (value_high_output),                      \n"
+"                      clamp_output).xyz;                                 \n"
+"                                                                         \n"
+"  out[gid] = v;                                                          \n"
+"}                                                                        \n";
+
+static GeglClRunData *cl_data = NULL;
+
+
 static void
 gimp_operation_levels_class_init (GimpOperationLevelsClass *klass)
 {
   GObjectClass                  *object_class    = G_OBJECT_CLASS (klass);
   GeglOperationClass            *operation_class = GEGL_OPERATION_CLASS (klass);
   GeglOperationPointFilterClass *point_class     = GEGL_OPERATION_POINT_FILTER_CLASS (klass);
+  GimpOperationPointFilterClass *filter_class    = GIMP_OPERATION_POINT_FILTER_CLASS (klass);
 
   object_class->set_property   = gimp_operation_point_filter_set_property;
   object_class->get_property   = gimp_operation_point_filter_get_property;
@@ -64,7 +144,12 @@ gimp_operation_levels_class_init (GimpOperationLevelsClass *klass)
                                  "description", _("Adjust color levels"),
                                  NULL);
 
-  point_class->process = gimp_operation_levels_process;
+  point_class->process    = gimp_operation_levels_process;
+  point_class->cl_process = gimp_operation_levels_cl_process;
+
+  operation_class->opencl_support = TRUE;
+
+  filter_class->use_lut  = TRUE;
 
   g_object_class_install_property (object_class,
                                    GIMP_OPERATION_POINT_FILTER_PROP_TRC,
@@ -142,6 +227,10 @@ gimp_operation_levels_process (GeglOperation       *operation,
   if (! config)
     return FALSE;
 
+  if (gimp_operation_point_filter_process_lut (operation, in_buf, out_buf,
+                                               samples, roi, level))
+    return TRUE;
+
   for (channel = 0; channel < 5; channel++)
     {
       g_return_val_if_fail (config->gamma[channel] != 0.0, FALSE);
@@ -185,6 +274,92 @@ gimp_operation_levels_process (GeglOperation       *operation,
   return TRUE;
 }
 
+static gboolean
+gimp_operation_levels_cl_process (GeglOperation       *operation,
+                                  cl_mem               in_tex,
+                                  cl_mem               out_tex,
+                                  size_t               global_worksize,
+                                  const GeglRectangle *roi,
+                                  gint                 level)
+{
+  GimpOperationPointFilter *point  = GIMP_OPERATION_POINT_FILTER (operation);
+  GimpLevelsConfig         *config = GIMP_LEVELS_CONFIG (point->config);
+  cl_float4                 low_input;
+  cl_float4                 high_input;
+  cl_float4                 inv_gamma;
+  cl_float4                 low_output;
+  cl_float4                 high_output;
+  cl_float                  value_low_input;
+  cl_float                  value_high_input;
+  cl_float                  value_inv_gamma;
+  cl_float                  value_low_output;
+  cl_float                  value_high_output;
+  cl_int                    clamp_input;
+  cl_int                    clamp_output;
+  cl_int                    cl_err;
+  gint                      channel;
+
+  if (! config)
+    return TRUE;
+
+  if (! cl_data)
+    {
+      const gchar *kernel_name[] = { "gimp_levels", NULL };
+
+      cl_data = gegl_cl_compile_and_build (kernel_source, kernel_name);
+
+      if (! cl_data)
+        return TRUE;
+    }
+
+  for (channel = 0; channel < 5; channel++)
+    g_return_val_if_fail (config->gamma[channel] != 0.0, TRUE);
+
+  for (channel = 0; channel < 4; channel++)
+    {
+      low_input.s[channel]   = config->low_input[channel + 1];
+      high_input.s[channel]  = config->high_input[channel + 1];
+      inv_gamma.s[channel]   = 1.0 / config->gamma[channel + 1];
+      low_output.s[channel]  = config->low_output[channel + 1];
+      high_output.s[channel] = config->high_output[channel + 1];
+    }
+
+  value_low_input   = config->low_input[0];
+  value_high_input  = config->high_input[0];
+  value_inv_gamma   = 1.0 / config->gamma[0];
+  value_low_output  = config->low_output[0];
+  value_high_output = config->high_output[0];
+
+  clamp_input  = config->clamp_input;
+  clamp_output = config->clamp_output;
+
+  cl_err = gegl_cl_set_kernel_args (cl_data->kernel[0],
+                                    sizeof (cl_mem),    &in_tex,
+                                    sizeof (cl_mem),    &out_tex,
+                                    sizeof (cl_float4), &low_input,
+                                    sizeof (cl_float4), &high_input,
+                                    sizeof (cl_float4), &inv_gamma,
+                                    sizeof (cl_float4), &low_output,
+                                    sizeof (cl_float4), &high_output,
+                                    sizeof (cl_float),  &value_low_input,
+                                    sizeof (cl_float),  &value_high_input,
+                                    sizeof (cl_float),  &value_inv_gamma,
+                                    sizeof (cl_float),  &value_low_output,
+                                    sizeof (cl_float),  &value_high_output,
+                                    sizeof (cl_int),    &clamp_input,
+                                    sizeof (cl_int),    &clamp_output,
+                                    NULL);
+  if (cl_err != CL_SUCCESS)
+    return TRUE;
+
+  cl_err = gegl_clEnqueueNDRangeKernel (gegl_cl_get_command_queue (),
+                                        cl_data->kernel[0], 1,
+                                        NULL, &global_worksize, NULL,
+                                        0, NULL, NULL);
+
+  return cl_err != CL_SUCCESS;
+}
+
 
 /*  public functions  */
 
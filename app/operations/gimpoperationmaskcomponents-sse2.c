@@ -0,0 +1,121 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpoperationmaskcomponents-sse2.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <gegl.h>
+
+#include "operations-types.h"
+
+#include "gimpoperationmaskcomponents-sse2.h"
+
+
+#if COMPILE_SSE2_INTRINISICS
+
+#include <emmintrin.h>
+
+
+/*  masking components is a pure bit operation, the same for every pixel
+ *  format: since the pixel size of all the formats we process (4, 8 and 16
+ *  bytes) divides 16, a register always holds whole pixels, and the
+ *  masks repeat for every register.
+ *
+ *  returns the number of pixels processed, the caller takes care of the
+ *  remaining ones.
+ */
+gint
+gimp_operation_mask_components_process_sse2 (gconstpointer     in_buf,
+                                             gconstpointer     aux_buf,
+                                             gpointer          out_buf,
+                                             gint              n,
+                                             gint              bpp,
+                                             GimpComponentMask mask,
+                                             guint32           alpha_value)
+{
+  const guint8 *in  = in_buf;
+  const guint8 *aux = aux_buf;
+  guint8       *out = out_buf;
+  guint8        in_mask_bytes[16];
+  guint8        alpha_bytes[16];
+  __m128i       v_in_mask;
+  __m128i       v_alpha;
+  gint          n_vectors;
+  gint          component_size;
+  gint          i;
+
+  g_return_val_if_fail (bpp == 4 || bpp == 8 || bpp == 16, 0);
+
+  component_size = bpp / 4;
+
+  for (i = 0; i < 16; i++)
+    {
+      gint c    = (i % bpp) / component_size;
+      gint byte = (i % bpp) % component_size;
+
+      in_mask_bytes[i] = (mask & (1 << c)) ? 0x00 : 0xff;
+
+      /*  when there's no aux, masked-in alpha is set to alpha_value, and
+       *  masked-in colors to zero.  see ProcessGeneric.
+       */
+      if (! aux && c == 3 && (mask & GIMP_COMPONENT_MASK_ALPHA))
+        alpha_bytes[i] = (alpha_value >> (8 * byte)) & 0xff;
+      else
+        alpha_bytes[i] = 0;
+    }
+
+  v_in_mask = _mm_loadu_si128 ((const __m128i *) in_mask_bytes);
+  v_alpha   = _mm_loadu_si128 ((const __m128i *) alpha_bytes);
+
+  n_vectors = n * bpp / 16;
+
+  if (aux)
+    {
+      for (i = 0; i < n_vectors; i++)
+        {
+          __m128i v_in  = _mm_loadu_si128 ((const __m128i *) in);
+          __m128i v_aux = _mm_loadu_si128 ((const __m128i *) aux);
+
+          _mm_storeu_si128 ((__m128i *) out,
+                            _mm_or_si128 (_mm_and_si128    (v_in, v_in_mask),
+                                          _mm_andnot_si128 (v_in_mask, v_aux)));
+
+          in  += 16;
+          aux += 16;
+          out += 16;
+        }
+    }
+  else
+    {
+      for (i = 0; i < n_vectors; i++)
+        {
+          __m128i v_in = _mm_loadu_si128 ((const __m128i *) in);
+
+          _mm_storeu_si128 ((__m128i *) out,
+                            _mm_or_si128 (_mm_and_si128 (v_in, v_in_mask),
+                                          v_alpha));
+
+          in  += 16;
+          out += 16;
+        }
+    }
+
+  return n_vectors * 16 / bpp;
+}
+
+#endif /* COMPILE_SSE2_INTRINISICS */
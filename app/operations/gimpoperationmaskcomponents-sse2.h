@@ -0,0 +1,33 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpoperationmaskcomponents-sse2.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+#if COMPILE_SSE2_INTRINISICS
+
+gint   gimp_operation_mask_components_process_sse2 (gconstpointer     in_buf,
+                                                    gconstpointer     aux_buf,
+                                                    gpointer          out_buf,
+                                                    gint              n,
+                                                    gint              bpp,
+                                                    GimpComponentMask mask,
+                                                    guint32           alpha_value);
+
+#endif /* COMPILE_SSE2_INTRINISICS */
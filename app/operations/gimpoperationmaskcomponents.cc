@@ -25,9 +25,14 @@
 extern "C"
 {
 
+#include <opencl/gegl-cl.h>
+
+#include "libgimpbase/gimpbase.h"
+
 #include "operations-types.h"
 
 #include "gimpoperationmaskcomponents.h"
+#include "gimpoperationmaskcomponents-sse2.h"
 
 } /* extern "C" */
 
@@ -64,6 +69,13 @@ static gboolean        gimp_operation_mask_components_process          (GeglOper
                                                                         glong                samples,
                                                                         const GeglRectangle *roi,
                                                                         gint                 level);
+static gboolean        gimp_operation_mask_components_cl_process       (GeglOperation       *operation,
+                                                                        cl_mem               in_tex,
+                                                                        cl_mem               aux_tex,
+                                                                        cl_mem               out_tex,
+                                                                        size_t               global_worksize,
+                                                                        const GeglRectangle *roi,
+                                                                        gint                 level);
 
 
 G_DEFINE_TYPE (GimpOperationMaskComponents, gimp_operation_mask_components,
@@ -72,6 +84,34 @@ G_DEFINE_TYPE (GimpOperationMaskComponents, gimp_operation_mask_components,
 #define parent_class gimp_operation_mask_components_parent_class
 
 
+/*  the component mask is passed as an int4 of -1 for every masked-in
+ *  component, as expected by select().  only float buffers are handled,
+ *  see gimp_operation_mask_components_cl_process().
+ */
+static const gchar *kernel_source =
+"__kernel void gimp_mask_components (__global const float4 *in,           \n"
+"                                    __global const float4 *aux,          \n"
+"                                    __global       float4 *out,          \n"
+"                                    int4                   mask)         \n"
+"{                                                                        \n"
+"  int gid = get_global_id (0);                                           \n"
+"                                                                         \n"
+"  out[gid] = select (in[gid], aux[gid], mask);                           \n"
+"}                                                                        \n"
+"                                                                         \n"
+"__kernel void gimp_mask_components_no_aux (__global const float4 *in,    \n"
+"                                           __global       float4 *out,   \n"
+"                                           int4                   mask,  \n"
+"                                           float                  alpha) \n"
+"{                                                                        \n"
+"  int gid = get_global_id (0);                                           \n"
+"                                                                         \n"
+"  out[gid] = select (in[gid], (float4) (0.0f, 0.0f, 0.0f, alpha), mask); \n"
+"}                                                                        \n";
+
+static GeglClRunData *cl_data = NULL;
+
+
 static void
 gimp_operation_mask_components_class_init (GimpOperationMaskComponentsClass *klass)
 {
@@ -93,6 +133,9 @@ gimp_operation_mask_components_class_init (GimpOperationMaskComponentsClass *kla
   operation_class->process          = gimp_operation_mask_components_parent_process;
 
   point_class->process              = gimp_operation_mask_components_process;
+  point_class->cl_process           = gimp_operation_mask_components_cl_process;
+
+  operation_class->opencl_support   = TRUE;
 
   g_object_class_install_property (object_class, PROP_MASK,
                                    g_param_spec_flags ("mask",
@@ -349,6 +392,36 @@ struct Process<guint8>
 
 #endif /* G_BYTE_ORDER == G_LITTLE_ENDIAN */
 
+template <class T>
+static void
+process (gconstpointer     in_buf,
+         gconstpointer     aux_buf,
+         gpointer          out_buf,
+         gint              n,
+         GimpComponentMask mask,
+         T                 alpha_value)
+{
+#if COMPILE_SSE2_INTRINISICS
+  if (gimp_cpu_accel_get_support () & GIMP_CPU_ACCEL_X86_SSE2)
+    {
+      gint done;
+
+      done = gimp_operation_mask_components_process_sse2 (in_buf, aux_buf,
+                                                          out_buf, n,
+                                                          4 * sizeof (T),
+                                                          mask, alpha_value);
+
+      in_buf  = (const T *) in_buf  + 4 * done;
+      if (aux_buf)
+        aux_buf = (const T *) aux_buf + 4 * done;
+      out_buf = (T *)       out_buf + 4 * done;
+      n      -= done;
+    }
+#endif
+
+  Process<T>::process (in_buf, aux_buf, out_buf, n, mask, alpha_value);
+}
+
 template <class T>
 static gboolean
 gimp_operation_mask_components_process (GimpOperationMaskComponents *self,
@@ -359,8 +432,8 @@ gimp_operation_mask_components_process (GimpOperationMaskComponents *self,
                                         const GeglRectangle         *roi,
                                         gint                         level)
 {
-  Process<T>::process (in_buf, aux_buf, out_buf, samples,
-                       self->mask, self->alpha_value);
+  process<T> (in_buf, aux_buf, out_buf, samples,
+              self->mask, self->alpha_value);
 
   return TRUE;
 }
@@ -508,6 +581,78 @@ gimp_operation_mask_components_process (GeglOperation       *operation,
                                         roi, level);
 }
 
+static gboolean
+gimp_operation_mask_components_cl_process (GeglOperation       *operation,
+                                           cl_mem               in_tex,
+                                           cl_mem               aux_tex,
+                                           cl_mem               out_tex,
+                                           size_t               global_worksize,
+                                           const GeglRectangle *roi,
+                                           gint                 level)
+{
+  GimpOperationMaskComponents *self = GIMP_OPERATION_MASK_COMPONENTS (operation);
+  cl_kernel                    kernel;
+  cl_int4                      mask;
+  cl_float                     alpha;
+  cl_int                       cl_err;
+  gint                         c;
+
+  /*  the kernels only handle float buffers, let the integer formats
+   *  fall back to the CPU
+   */
+  if (babl_format_get_type (self->format, 0) != babl_type ("float"))
+    return TRUE;
+
+  if (! cl_data)
+    {
+      const gchar *kernel_name[] = { "gimp_mask_components",
+                                     "gimp_mask_components_no_aux",
+                                     NULL };
+
+      cl_data = gegl_cl_compile_and_build (kernel_source, kernel_name);
+
+      if (! cl_data)
+        return TRUE;
+    }
+
+  for (c = 0; c < 4; c++)
+    mask.s[c] = (self->mask & (1 << c)) ? -1 : 0;
+
+  if (aux_tex)
+    {
+      kernel = cl_data->kernel[0];
+
+      cl_err = gegl_cl_set_kernel_args (kernel,
+                                        sizeof (cl_mem),  &in_tex,
+                                        sizeof (cl_mem),  &aux_tex,
+                                        sizeof (cl_mem),  &out_tex,
+                                        sizeof (cl_int4), &mask,
+                                        NULL);
+    }
+  else
+    {
+      kernel = cl_data->kernel[1];
+      alpha  = self->alpha;
+
+      cl_err = gegl_cl_set_kernel_args (kernel,
+                                        sizeof (cl_mem),   &in_tex,
+                                        sizeof (cl_mem),   &out_tex,
+                                        sizeof (cl_int4),  &mask,
+                                        sizeof (cl_float), &alpha,
+                                        NULL);
+    }
+
+  if (cl_err != CL_SUCCESS)
+    return TRUE;
+
+  cl_err = gegl_clEnqueueNDRangeKernel (gegl_cl_get_command_queue (),
+                                        kernel, 1,
+                                        NULL, &global_worksize, NULL,
+                                        0, NULL, NULL);
+
+  return cl_err != CL_SUCCESS;
+}
+
 const Babl *
 gimp_operation_mask_components_get_format (const Babl *input_format)
 {
@@ -580,15 +725,15 @@ gimp_operation_mask_components_process (const Babl        *format,
   switch (babl_format_get_bytes_per_pixel (format))
     {
     case 4:
-      Process<guint8>::process (in, aux, out, n, mask, 0);
+      process<guint8> (in, aux, out, n, mask, 0);
       break;
 
     case 8:
-      Process<guint16>::process (in, aux, out, n, mask, 0);
+      process<guint16> (in, aux, out, n, mask, 0);
       break;
 
     case 16:
-      Process<guint32>::process (in, aux, out, n, mask, 0);
+      process<guint32> (in, aux, out, n, mask, 0);
       break;
 
     default:
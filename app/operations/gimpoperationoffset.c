@@ -356,37 +356,27 @@ gimp_operation_offset_process (GeglOperation       *operation,
 
   gimp_operation_offset_get_offset (offset, FALSE, &x, &y);
 
-  for (i = 0; i < 4; i++)
+  gimp_gegl_buffer_offset (input, &bounds, output, roi, x, y,
+                           offset->type == GIMP_OFFSET_WRAP_AROUND);
+
+  if (offset->type == GIMP_OFFSET_WRAP_AROUND || ! offset->color)
+    return TRUE;
+
+  /*  fill the area uncovered by the shift  */
+  for (i = 1; i < 4; i++)
     {
       GeglRectangle offset_bounds = bounds;
-      gint          offset_x      = x;
-      gint          offset_y      = y;
+
+      offset_bounds.x += x;
+      offset_bounds.y += y;
 
       if (i & 1)
-        offset_x += x < 0 ? bounds.width  : -bounds.width;
+        offset_bounds.x += x < 0 ? bounds.width  : -bounds.width;
       if (i & 2)
-        offset_y += y < 0 ? bounds.height : -bounds.height;
-
-      offset_bounds.x += offset_x;
-      offset_bounds.y += offset_y;
+        offset_bounds.y += y < 0 ? bounds.height : -bounds.height;
 
       if (gegl_rectangle_intersect (&offset_bounds, &offset_bounds, roi))
-        {
-          if (i == 0 || offset->type == GIMP_OFFSET_WRAP_AROUND)
-            {
-              GeglRectangle offset_roi = offset_bounds;
-
-              offset_roi.x -= offset_x;
-              offset_roi.y -= offset_y;
-
-              gimp_gegl_buffer_copy (input,  &offset_roi, GEGL_ABYSS_NONE,
-                                     output, &offset_bounds);
-            }
-          else if (offset->color)
-            {
-              gegl_buffer_set_color (output, &offset_bounds, offset->color);
-            }
-        }
+        gegl_buffer_set_color (output, &offset_bounds, offset->color);
     }
 
   return TRUE;
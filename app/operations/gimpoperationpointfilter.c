@@ -24,11 +24,22 @@
 
 #include "operations-types.h"
 
+#include "gegl/gimp-babl.h"
+
 #include "gimpoperationpointfilter.h"
 
 
-static void   gimp_operation_point_filter_finalize (GObject       *object);
-static void   gimp_operation_point_filter_prepare  (GeglOperation *operation);
+static void   gimp_operation_point_filter_finalize      (GObject                  *object);
+static void   gimp_operation_point_filter_notify        (GObject                  *object,
+                                                         GParamSpec               *pspec);
+static void   gimp_operation_point_filter_prepare       (GeglOperation            *operation);
+
+static void   gimp_operation_point_filter_config_notify (GObject                  *config,
+                                                         GParamSpec               *pspec,
+                                                         GimpOperationPointFilter *self);
+static void   gimp_operation_point_filter_bake_lut      (GimpOperationPointFilter *self,
+                                                         const GeglRectangle      *roi,
+                                                         gint                      level);
 
 
 G_DEFINE_ABSTRACT_TYPE (GimpOperationPointFilter, gimp_operation_point_filter,
@@ -44,6 +55,7 @@ gimp_operation_point_filter_class_init (GimpOperationPointFilterClass *klass)
   GeglOperationClass  *operation_class = GEGL_OPERATION_CLASS (klass);
 
   object_class->finalize = gimp_operation_point_filter_finalize;
+  object_class->notify   = gimp_operation_point_filter_notify;
 
   operation_class->prepare = gimp_operation_point_filter_prepare;
 }
@@ -51,6 +63,9 @@ gimp_operation_point_filter_class_init (GimpOperationPointFilterClass *klass)
 static void
 gimp_operation_point_filter_init (GimpOperationPointFilter *self)
 {
+  g_rec_mutex_init (&self->lut_mutex);
+
+  self->serial = 1;
 }
 
 static void
@@ -58,8 +73,16 @@ gimp_operation_point_filter_finalize (GObject *object)
 {
   GimpOperationPointFilter *self = GIMP_OPERATION_POINT_FILTER (object);
 
+  if (self->config)
+    g_signal_handlers_disconnect_by_func (self->config,
+                                          gimp_operation_point_filter_config_notify,
+                                          self);
+
   g_clear_object (&self->config);
 
+  g_clear_pointer (&self->lut, g_bytes_unref);
+  g_rec_mutex_clear (&self->lut_mutex);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -102,7 +125,17 @@ gimp_operation_point_filter_set_property (GObject      *object,
       break;
 
     case GIMP_OPERATION_POINT_FILTER_PROP_CONFIG:
+      if (self->config)
+        g_signal_handlers_disconnect_by_func (self->config,
+                                              gimp_operation_point_filter_config_notify,
+                                              self);
+
       g_set_object (&self->config, g_value_dup_object (value));
+
+      if (self->config)
+        g_signal_connect (self->config, "notify",
+                          G_CALLBACK (gimp_operation_point_filter_config_notify),
+                          self);
       break;
 
    default:
@@ -111,6 +144,18 @@ gimp_operation_point_filter_set_property (GObject      *object,
     }
 }
 
+static void
+gimp_operation_point_filter_notify (GObject    *object,
+                                    GParamSpec *pspec)
+{
+  GimpOperationPointFilter *self = GIMP_OPERATION_POINT_FILTER (object);
+
+  g_atomic_int_inc (&self->serial);
+
+  if (G_OBJECT_CLASS (parent_class)->notify)
+    G_OBJECT_CLASS (parent_class)->notify (object, pspec);
+}
+
 static void
 gimp_operation_point_filter_prepare (GeglOperation *operation)
 {
@@ -135,6 +180,215 @@ gimp_operation_point_filter_prepare (GeglOperation *operation)
       break;
     }
 
-  gegl_operation_set_format (operation, "input",  format);
+  gimp_operation_point_filter_set_format (operation, format);
+}
+
+
+/*  protected functions  */
+
+/*  sets @format, which must be a float format, as the output format.  if
+ *  the filter uses a lookup table and the input is 8 or 16 bit with the
+ *  same model, TRC and space, the input is requested in the matching
+ *  integer format, so that gimp_operation_point_filter_process_lut() can
+ *  map it; otherwise the input format is @format as well.
+ */
+void
+gimp_operation_point_filter_set_format (GeglOperation *operation,
+                                        const Babl    *format)
+{
+  const Babl *input_format = format;
+
+  /*  the OpenCL kernels only handle float buffers  */
+  if (GIMP_OPERATION_POINT_FILTER_GET_CLASS (operation)->use_lut &&
+      ! gegl_operation_use_opencl (operation))
+    {
+      const Babl *source_format;
+
+      source_format = gegl_operation_get_source_format (operation, "input");
+
+      if (source_format                                                 &&
+          babl_format_get_space (source_format) ==
+          babl_format_get_space (format)                                &&
+          gimp_babl_format_get_base_type (source_format) == GIMP_RGB    &&
+          gimp_babl_format_get_trc (source_format) ==
+          gimp_babl_format_get_trc (format))
+        {
+          GimpComponentType component_type;
+
+          component_type = gimp_babl_format_get_component_type (source_format);
+
+          if (component_type == GIMP_COMPONENT_TYPE_U8 ||
+              component_type == GIMP_COMPONENT_TYPE_U16)
+            {
+              input_format =
+                gimp_babl_format_change_component_type (format,
+                                                        component_type);
+            }
+        }
+    }
+
+  gegl_operation_set_format (operation, "input",  input_format);
   gegl_operation_set_format (operation, "output", format);
 }
+
+/*  to be called first thing by process() of filters using a lookup table.
+ *  returns TRUE if it mapped the samples, or FALSE if the input is float
+ *  and process() has to map them itself.
+ */
+gboolean
+gimp_operation_point_filter_process_lut (GeglOperation       *operation,
+                                         void                *in_buf,
+                                         void                *out_buf,
+                                         glong                samples,
+                                         const GeglRectangle *roi,
+                                         gint                 level)
+{
+  GimpOperationPointFilter *self = GIMP_OPERATION_POINT_FILTER (operation);
+  const Babl               *format;
+  GBytes                   *lut_bytes;
+  const gfloat             *lut;
+  gfloat                   *dest = out_buf;
+
+  format = gegl_operation_get_format (operation, "input");
+
+  if (babl_format_get_type (format, 0) == babl_type ("float"))
+    return FALSE;
+
+  g_rec_mutex_lock (&self->lut_mutex);
+
+  /*  we are being called by bake_lut() itself, with float input  */
+  if (self->lut_baking)
+    {
+      g_rec_mutex_unlock (&self->lut_mutex);
+
+      return FALSE;
+    }
+
+  if (! self->lut                                            ||
+      self->lut_format != format                             ||
+      self->lut_serial != g_atomic_int_get (&self->serial))
+    {
+      self->lut_format = format;
+
+      gimp_operation_point_filter_bake_lut (self, roi, level);
+    }
+
+  /*  the table is never modified once baked, baking again replaces it,
+   *  so keep a reference to it while mapping
+   */
+  lut_bytes = g_bytes_ref (self->lut);
+
+  g_rec_mutex_unlock (&self->lut_mutex);
+
+  lut = g_bytes_get_data (lut_bytes, NULL);
+
+  if (babl_format_get_type (format, 0) == babl_type ("u8"))
+    {
+      const guint8 *src = in_buf;
+
+      while (samples--)
+        {
+          dest[RED]   = lut[4 * src[RED]   + RED];
+          dest[GREEN] = lut[4 * src[GREEN] + GREEN];
+          dest[BLUE]  = lut[4 * src[BLUE]  + BLUE];
+          dest[ALPHA] = lut[4 * src[ALPHA] + ALPHA];
+
+          src  += 4;
+          dest += 4;
+        }
+    }
+  else
+    {
+      const guint16 *src = in_buf;
+
+      while (samples--)
+        {
+          dest[RED]   = lut[4 * src[RED]   + RED];
+          dest[GREEN] = lut[4 * src[GREEN] + GREEN];
+          dest[BLUE]  = lut[4 * src[BLUE]  + BLUE];
+          dest[ALPHA] = lut[4 * src[ALPHA] + ALPHA];
+
+          src  += 4;
+          dest += 4;
+        }
+    }
+
+  g_bytes_unref (lut_bytes);
+
+  return TRUE;
+}
+
+
+/*  private functions  */
+
+static void
+gimp_operation_point_filter_config_notify (GObject                  *config,
+                                           GParamSpec               *pspec,
+                                           GimpOperationPointFilter *self)
+{
+  g_atomic_int_inc (&self->serial);
+}
+
+/*  runs every possible input value through the filter's own process(),
+ *  after converting it to float the same way babl would, so that
+ *  looking up the result gives exactly what processing the converted
+ *  pixels would, and replaces the table with the new one.  must be
+ *  called with lut_mutex held.
+ */
+static void
+gimp_operation_point_filter_bake_lut (GimpOperationPointFilter *self,
+                                      const GeglRectangle      *roi,
+                                      gint                      level)
+{
+  GeglOperation                 *operation = GEGL_OPERATION (self);
+  GeglOperationPointFilterClass *point_class;
+  const Babl                    *float_format;
+  gint                           n_values;
+  gint                           bpc;
+  guint8                        *values;
+  gfloat                        *in;
+  gfloat                        *lut;
+  gint                           i;
+  gint                           c;
+
+  point_class  = GEGL_OPERATION_POINT_FILTER_GET_CLASS (self);
+  float_format = gegl_operation_get_format (operation, "output");
+
+  bpc      = babl_format_get_bytes_per_pixel (self->lut_format) / 4;
+  n_values = 1 << (8 * bpc);
+
+  values = g_malloc (n_values * 4 * bpc);
+
+  for (i = 0; i < n_values; i++)
+    {
+      for (c = 0; c < 4; c++)
+        {
+          if (bpc == 1)
+            values[4 * i + c] = i;
+          else
+            ((guint16 *) values)[4 * i + c] = i;
+        }
+    }
+
+  in = g_new (gfloat, n_values * 4);
+
+  babl_process (babl_fish (self->lut_format, float_format),
+                values, in, n_values);
+
+  g_free (values);
+
+  lut = g_new (gfloat, n_values * 4);
+
+  self->lut_serial = g_atomic_int_get (&self->serial);
+
+  self->lut_baking = TRUE;
+
+  point_class->process (operation, in, lut, n_values, roi, level);
+
+  self->lut_baking = FALSE;
+
+  g_free (in);
+
+  g_clear_pointer (&self->lut, g_bytes_unref);
+  self->lut = g_bytes_new_take (lut, n_values * 4 * sizeof (gfloat));
+}
@@ -48,21 +48,46 @@ struct _GimpOperationPointFilter
 
   GimpTRCType               trc;
   GObject                  *config;
+
+  GRecMutex                 lut_mutex;
+  gint                      serial;
+  gint                      lut_serial;
+  const Babl               *lut_format;
+  GBytes                   *lut;
+  gboolean                  lut_baking;
 };
 
 struct _GimpOperationPointFilterClass
 {
   GeglOperationPointFilterClass  parent_class;
+
+  /*  whether process() maps each channel independently of the other
+   *  channels, so that its result for 8 and 16 bit input can be baked
+   *  into a lookup table
+   */
+  gboolean                       use_lut;
 };
 
 
-GType   gimp_operation_point_filter_get_type     (void) G_GNUC_CONST;
+GType      gimp_operation_point_filter_get_type     (void) G_GNUC_CONST;
+
+void       gimp_operation_point_filter_get_property (GObject             *object,
+                                                     guint                property_id,
+                                                     GValue              *value,
+                                                     GParamSpec          *pspec);
+void       gimp_operation_point_filter_set_property (GObject             *object,
+                                                     guint                property_id,
+                                                     const GValue        *value,
+                                                     GParamSpec          *pspec);
+
+
+/*  protected  */
 
-void    gimp_operation_point_filter_get_property (GObject      *object,
-                                                  guint         property_id,
-                                                  GValue       *value,
-                                                  GParamSpec   *pspec);
-void    gimp_operation_point_filter_set_property (GObject      *object,
-                                                  guint         property_id,
-                                                  const GValue *value,
-                                                  GParamSpec   *pspec);
+void       gimp_operation_point_filter_set_format   (GeglOperation       *operation,
+                                                     const Babl          *format);
+gboolean   gimp_operation_point_filter_process_lut  (GeglOperation       *operation,
+                                                     void                *in_buf,
+                                                     void                *out_buf,
+                                                     glong                samples,
+                                                     const GeglRectangle *roi,
+                                                     gint                 level);
@@ -24,6 +24,8 @@
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gegl.h>
 
+#include <opencl/gegl-cl.h>
+
 #include "libgimpbase/gimpbase.h"
 #include "libgimpconfig/gimpconfig.h"
 #include "libgimpmath/gimpmath.h"
@@ -59,6 +61,12 @@ static gboolean gimp_operation_posterize_process      (GeglOperation       *oper
                                                        glong                samples,
                                                        const GeglRectangle *roi,
                                                        gint                 level);
+static gboolean gimp_operation_posterize_cl_process   (GeglOperation       *operation,
+                                                       cl_mem               in_tex,
+                                                       cl_mem               out_tex,
+                                                       size_t               global_worksize,
+                                                       const GeglRectangle *roi,
+                                                       gint                 level);
 
 
 G_DEFINE_TYPE (GimpOperationPosterize, gimp_operation_posterize,
@@ -67,17 +75,35 @@ G_DEFINE_TYPE (GimpOperationPosterize, gimp_operation_posterize,
 #define parent_class gimp_operation_posterize_parent_class
 
 
+static const gchar *kernel_source =
+"__kernel void gimp_posterize (__global const float4 *in,                 \n"
+"                              __global       float4 *out,                \n"
+"                              float                  levels)             \n"
+"{                                                                        \n"
+"  int gid = get_global_id (0);                                           \n"
+"                                                                         \n"
+"  out[gid] = rint (in[gid] * levels) / levels;                           \n"
+"}                                                                        \n";
+
+static GeglClRunData *cl_data = NULL;
+
+
 static void
 gimp_operation_posterize_class_init (GimpOperationPosterizeClass *klass)
 {
   GObjectClass                  *object_class    = G_OBJECT_CLASS (klass);
   GeglOperationClass            *operation_class = GEGL_OPERATION_CLASS (klass);
   GeglOperationPointFilterClass *point_class     = GEGL_OPERATION_POINT_FILTER_CLASS (klass);
+  GimpOperationPointFilterClass *filter_class    = GIMP_OPERATION_POINT_FILTER_CLASS (klass);
 
   object_class->set_property = gimp_operation_posterize_set_property;
   object_class->get_property = gimp_operation_posterize_get_property;
   operation_class->prepare   = gimp_operation_posterize_prepare;
   point_class->process       = gimp_operation_posterize_process;
+  point_class->cl_process    = gimp_operation_posterize_cl_process;
+  filter_class->use_lut      = TRUE;
+
+  operation_class->opencl_support = TRUE;
 
   gegl_operation_class_set_keys (operation_class,
                                  "name",        "gimp:posterize",
@@ -144,8 +170,7 @@ gimp_operation_posterize_prepare (GeglOperation *operation)
   const Babl *format = babl_format_with_space ("R~G~B~A float",
                                                gegl_operation_get_format (operation, "input"));
 
-  gegl_operation_set_format (operation, "input", format);
-  gegl_operation_set_format (operation, "output", format);
+  gimp_operation_point_filter_set_format (operation, format);
 }
 
 
@@ -162,6 +187,10 @@ gimp_operation_posterize_process (GeglOperation       *operation,
   gfloat                 *dest      = out_buf;
   gfloat                  levels;
 
+  if (gimp_operation_point_filter_process_lut (operation, in_buf, out_buf,
+                                               samples, roi, level))
+    return TRUE;
+
   levels = posterize->levels - 1.0;
 
   while (samples--)
@@ -177,3 +206,43 @@ gimp_operation_posterize_process (GeglOperation       *operation,
 
   return TRUE;
 }
+
+static gboolean
+gimp_operation_posterize_cl_process (GeglOperation       *operation,
+                                     cl_mem               in_tex,
+                                     cl_mem               out_tex,
+                                     size_t               global_worksize,
+                                     const GeglRectangle *roi,
+                                     gint                 level)
+{
+  GimpOperationPosterize *posterize = GIMP_OPERATION_POSTERIZE (operation);
+  cl_float                levels;
+  cl_int                  cl_err;
+
+  if (! cl_data)
+    {
+      const gchar *kernel_name[] = { "gimp_posterize", NULL };
+
+      cl_data = gegl_cl_compile_and_build (kernel_source, kernel_name);
+
+      if (! cl_data)
+        return TRUE;
+    }
+
+  levels = posterize->levels - 1.0;
+
+  cl_err = gegl_cl_set_kernel_args (cl_data->kernel[0],
+                                    sizeof (cl_mem),   &in_tex,
+                                    sizeof (cl_mem),   &out_tex,
+                                    sizeof (cl_float), &levels,
+                                    NULL);
+  if (cl_err != CL_SUCCESS)
+    return TRUE;
+
+  cl_err = gegl_clEnqueueNDRangeKernel (gegl_cl_get_command_queue (),
+                                        cl_data->kernel[0], 1,
+                                        NULL, &global_worksize, NULL,
+                                        0, NULL, NULL);
+
+  return cl_err != CL_SUCCESS;
+}
@@ -24,6 +24,8 @@
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gegl.h>
 
+#include <opencl/gegl-cl.h>
+
 #include "libgimpbase/gimpbase.h"
 #include "libgimpcolor/gimpcolor.h"
 #include "libgimpcolor/gimpcolor-private.h"
@@ -60,6 +62,12 @@ static gboolean gimp_operation_threshold_process (GeglOperation       *operation
                                                   glong                samples,
                                                   const GeglRectangle *roi,
                                                   gint                 level);
+static gboolean gimp_operation_threshold_cl_process (GeglOperation       *operation,
+                                                     cl_mem               in_tex,
+                                                     cl_mem               out_tex,
+                                                     size_t               global_worksize,
+                                                     const GeglRectangle *roi,
+                                                     gint                 level);
 
 static void gimp_operation_threshold_prepare (GeglOperation *operation);
 
@@ -69,6 +77,36 @@ G_DEFINE_TYPE (GimpOperationThreshold, gimp_operation_threshold,
 #define parent_class gimp_operation_threshold_parent_class
 
 
+/*  the value is the maximum of the color channels if mode is 1, their
+ *  minimum if mode is 2, and the weighted sum of all channels otherwise
+ */
+static const gchar *kernel_source =
+"__kernel void gimp_threshold (__global const float4 *in,                 \n"
+"                              __global       float4 *out,                \n"
+"                              int                    mode,               \n"
+"                              float4                 weights,            \n"
+"                              float                  low,                \n"
+"                              float                  high)               \n"
+"{                                                                        \n"
+"  int    gid = get_global_id (0);                                        \n"
+"  float4 src = in[gid];                                                  \n"
+"  float  value;                                                          \n"
+"                                                                         \n"
+"  if (mode == 1)                                                         \n"
+"    value = fmax (fmax (src.x, src.y), src.z);                           \n"
+"  else if (mode == 2)                                                    \n"
+"    value = fmin (fmin (src.x, src.y), src.z);                           \n"
+"  else                                                                   \n"
+"    value = dot (src, weights);                                          \n"
+"                                                                         \n"
+"  value = (value >= low && value <= high) ? 1.0f : 0.0f;                 \n"
+"                                                                         \n"
+"  out[gid] = (float4) (value, value, value, src.w);                      \n"
+"}                                                                        \n";
+
+static GeglClRunData *cl_data = NULL;
+
+
 static void
 gimp_operation_threshold_class_init (GimpOperationThresholdClass *klass)
 {
@@ -82,6 +120,9 @@ gimp_operation_threshold_class_init (GimpOperationThresholdClass *klass)
   operation_class->prepare   = gimp_operation_threshold_prepare;
 
   point_class->process       = gimp_operation_threshold_process;
+  point_class->cl_process    = gimp_operation_threshold_cl_process;
+
+  operation_class->opencl_support = TRUE;
 
   gegl_operation_class_set_keys (operation_class,
                                  "name",        "gimp:threshold",
@@ -245,3 +286,83 @@ gimp_operation_threshold_process (GeglOperation       *operation,
 
   return TRUE;
 }
+
+static gboolean
+gimp_operation_threshold_cl_process (GeglOperation       *operation,
+                                     cl_mem               in_tex,
+                                     cl_mem               out_tex,
+                                     size_t               global_worksize,
+                                     const GeglRectangle *roi,
+                                     gint                 level)
+{
+  GimpOperationThreshold *threshold = GIMP_OPERATION_THRESHOLD (operation);
+  cl_int                  mode      = 0;
+  cl_float4               weights   = { { 0.0f, 0.0f, 0.0f, 0.0f } };
+  cl_float                low;
+  cl_float                high;
+  cl_int                  cl_err;
+
+  if (! cl_data)
+    {
+      const gchar *kernel_name[] = { "gimp_threshold", NULL };
+
+      cl_data = gegl_cl_compile_and_build (kernel_source, kernel_name);
+
+      if (! cl_data)
+        return TRUE;
+    }
+
+  switch (threshold->channel)
+    {
+    case GIMP_HISTOGRAM_VALUE:
+      mode = 1;
+      break;
+
+    case GIMP_HISTOGRAM_RED:
+      weights.s[RED] = 1.0f;
+      break;
+
+    case GIMP_HISTOGRAM_GREEN:
+      weights.s[GREEN] = 1.0f;
+      break;
+
+    case GIMP_HISTOGRAM_BLUE:
+      weights.s[BLUE] = 1.0f;
+      break;
+
+    case GIMP_HISTOGRAM_ALPHA:
+      weights.s[ALPHA] = 1.0f;
+      break;
+
+    case GIMP_HISTOGRAM_RGB:
+      mode = 2;
+      break;
+
+    case GIMP_HISTOGRAM_LUMINANCE:
+      weights.s[RED]   = GIMP_RGB_LUMINANCE_RED;
+      weights.s[GREEN] = GIMP_RGB_LUMINANCE_GREEN;
+      weights.s[BLUE]  = GIMP_RGB_LUMINANCE_BLUE;
+      break;
+    }
+
+  low  = threshold->low;
+  high = threshold->high;
+
+  cl_err = gegl_cl_set_kernel_args (cl_data->kernel[0],
+                                    sizeof (cl_mem),    &in_tex,
+                                    sizeof (cl_mem),    &out_tex,
+                                    sizeof (cl_int),    &mode,
+                                    sizeof (cl_float4), &weights,
+                                    sizeof (cl_float),  &low,
+                                    sizeof (cl_float),  &high,
+                                    NULL);
+  if (cl_err != CL_SUCCESS)
+    return TRUE;
+
+  cl_err = gegl_clEnqueueNDRangeKernel (gegl_cl_get_command_queue (),
+                                        cl_data->kernel[0], 1,
+                                        NULL, &global_worksize, NULL,
+                                        0, NULL, NULL);
+
+  return cl_err != CL_SUCCESS;
+}
@@ -31,6 +31,28 @@
 
 #define RANDOM_TABLE_SIZE 4096
 
+#define NOISE_TILE_SIZE   64
+/*  4 KiB each, enough tiles to cover a 4K display, 8 MiB in total  */
+#define NOISE_CACHE_SIZE  2048
+
+#define NOISE_TILE_INDEX(coord) \
+  (((coord) >= 0 ? (coord) : (coord) - NOISE_TILE_SIZE + 1) / NOISE_TILE_SIZE)
+
+#define NOISE_TILE_KEY(tile_x, tile_y) \
+  ((gint64) (guint32) (tile_x) << 32 | (guint32) (tile_y))
+
+
+/*  the random values of a NOISE_TILE_SIZE x NOISE_TILE_SIZE tile, in
+ *  image coordinates
+ */
+typedef struct
+{
+  gint64 key;
+  gint   ref_count;
+  GList  link;
+  guint8 values[NOISE_TILE_SIZE * NOISE_TILE_SIZE];
+} NoiseTile;
+
 
 static gboolean                   gimp_operation_dissolve_process             (GeglOperation          *op,
                                                                                void                   *in,
@@ -49,6 +71,13 @@ G_DEFINE_TYPE (GimpOperationDissolve, gimp_operation_dissolve,
 
 static gint32 random_table[RANDOM_TABLE_SIZE];
 
+/*  the most recently used noise tiles, most recent first, and the same
+ *  tiles by key
+ */
+static GQueue      noise_cache       = G_QUEUE_INIT;
+static GHashTable *noise_cache_tiles = NULL;
+static GMutex      noise_cache_mutex;
+
 
 static void
 gimp_operation_dissolve_class_init (GimpOperationDissolveClass *klass)
@@ -80,6 +109,255 @@ gimp_operation_dissolve_init (GimpOperationDissolve *self)
 {
 }
 
+static void
+noise_tile_unref (NoiseTile *tile)
+{
+  if (g_atomic_int_dec_and_test (&tile->ref_count))
+    g_slice_free (NoiseTile, tile);
+}
+
+static NoiseTile *
+noise_tile_new (gint tile_x,
+                gint tile_y)
+{
+  NoiseTile *tile = g_slice_new (NoiseTile);
+
+  tile->key       = NOISE_TILE_KEY (tile_x, tile_y);
+  tile->ref_count = 1;
+  tile->link.data = tile;
+  tile->link.prev = NULL;
+  tile->link.next = NULL;
+
+  return tile;
+}
+
+/*  fills in the NULL entries of tiles, for the noise tiles tile_x1 to
+ *  tile_x2 of a row of tiles, which are all on the same side of column 0.
+ *
+ *  each row of pixels has its own pseudo random sequence, whose n-th
+ *  value belongs to column n, which is the pattern dissolve layers have
+ *  always had.  negative columns use the same sequence, backwards, so
+ *  that column -1 gets its first value.  the sequence is walked once
+ *  for all requested tiles, so fast-forwarding it to the first one is
+ *  paid once per row of pixels, and only on a cache miss.
+ */
+static void
+noise_tiles_new (gint        tile_x1,
+                 gint        tile_x2,
+                 gint        tile_y,
+                 NoiseTile **tiles)
+{
+  gint n_tiles = tile_x2 - tile_x1 + 1;
+  gint tile_x;
+  gint y;
+
+  for (tile_x = tile_x1; tile_x <= tile_x2; tile_x++)
+    {
+      if (! tiles[tile_x - tile_x1])
+        tiles[tile_x - tile_x1] = noise_tile_new (tile_x, tile_y);
+    }
+
+  for (y = 0; y < NOISE_TILE_SIZE; y++)
+    {
+      gint   row    = tile_y * NOISE_TILE_SIZE + y;
+      gint   offset = y * NOISE_TILE_SIZE;
+      GRand *gr;
+      gint   i, x;
+
+      /* The offset can be negative. I could just abs() the result, but we
+       * probably prefer to use different indexes of the table when possible for
+       * nicer randomization, so let's cycle the modulo so that -1 is the last
+       * table index.
+       */
+      gr = g_rand_new_with_seed (random_table[((row % RANDOM_TABLE_SIZE) + RANDOM_TABLE_SIZE) % RANDOM_TABLE_SIZE]);
+
+      if (tile_x1 >= 0)
+        {
+          /* fast forward through the rows pseudo random sequence */
+          for (x = 0; x < tile_x1 * NOISE_TILE_SIZE; x++)
+            g_rand_int (gr);
+
+          for (i = 0; i < n_tiles; i++)
+            {
+              guint8 *values = tiles[i]->values + offset;
+
+              for (x = 0; x < NOISE_TILE_SIZE; x++)
+                values[x] = g_rand_int_range (gr, 0, 255);
+            }
+        }
+      else
+        {
+          for (x = 0; x < (-tile_x2 - 1) * NOISE_TILE_SIZE; x++)
+            g_rand_int (gr);
+
+          for (i = n_tiles - 1; i >= 0; i--)
+            {
+              guint8 *values = tiles[i]->values + offset;
+
+              for (x = NOISE_TILE_SIZE - 1; x >= 0; x--)
+                values[x] = g_rand_int_range (gr, 0, 255);
+            }
+        }
+
+      g_rand_free (gr);
+    }
+}
+
+/*  stores references to the noise tiles tile_x1 to tile_x2 of a row of
+ *  tiles in tiles, which stay valid while the tiles are evicted from the
+ *  cache by other threads
+ */
+static void
+noise_tiles_get (gint        tile_x1,
+                 gint        tile_x2,
+                 gint        tile_y,
+                 NoiseTile **tiles)
+{
+  gint     n_tiles = tile_x2 - tile_x1 + 1;
+  gboolean missing = FALSE;
+  gint     i;
+
+  g_mutex_lock (&noise_cache_mutex);
+
+  if (! noise_cache_tiles)
+    noise_cache_tiles = g_hash_table_new (g_int64_hash, g_int64_equal);
+
+  for (i = 0; i < n_tiles; i++)
+    {
+      gint64     key  = NOISE_TILE_KEY (tile_x1 + i, tile_y);
+      NoiseTile *tile = g_hash_table_lookup (noise_cache_tiles, &key);
+
+      if (tile)
+        {
+          g_queue_unlink (&noise_cache, &tile->link);
+          g_queue_push_head_link (&noise_cache, &tile->link);
+
+          g_atomic_int_inc (&tile->ref_count);
+        }
+      else
+        {
+          missing = TRUE;
+        }
+
+      tiles[i] = tile;
+    }
+
+  g_mutex_unlock (&noise_cache_mutex);
+
+  if (! missing)
+    return;
+
+  /*  generate the tiles outside of the lock; if another thread does the
+   *  same meanwhile, both tiles have the same values, and only the first
+   *  one is cached.  the cached tiles in the range are generated again,
+   *  which is cheaper than stopping and restarting the sequence.
+   */
+  for (i = 0; i < n_tiles; i++)
+    {
+      if (tiles[i])
+        {
+          noise_tile_unref (tiles[i]);
+          tiles[i] = NULL;
+        }
+    }
+
+  if (tile_x1 < 0 && tile_x2 >= 0)
+    {
+      noise_tiles_new (tile_x1, -1, tile_y, tiles);
+      noise_tiles_new (0, tile_x2, tile_y, tiles - tile_x1);
+    }
+  else
+    {
+      noise_tiles_new (tile_x1, tile_x2, tile_y, tiles);
+    }
+
+  g_mutex_lock (&noise_cache_mutex);
+
+  for (i = 0; i < n_tiles; i++)
+    {
+      NoiseTile *tile = tiles[i];
+
+      if (! g_hash_table_contains (noise_cache_tiles, &tile->key))
+        {
+          g_atomic_int_inc (&tile->ref_count);
+
+          g_hash_table_insert (noise_cache_tiles, &tile->key, tile);
+          g_queue_push_head_link (&noise_cache, &tile->link);
+        }
+    }
+
+  while (noise_cache.length > NOISE_CACHE_SIZE)
+    {
+      GList     *last    = g_queue_pop_tail_link (&noise_cache);
+      NoiseTile *evicted = last->data;
+
+      g_hash_table_remove (noise_cache_tiles, &evicted->key);
+      noise_tile_unref (evicted);
+    }
+
+  g_mutex_unlock (&noise_cache_mutex);
+}
+
+static void
+gimp_operation_dissolve_process_row (GimpOperationLayerMode *layer_mode,
+                                     const gfloat           *in,
+                                     const gfloat           *layer,
+                                     const gfloat           *mask,
+                                     gfloat                 *out,
+                                     const guint8           *values,
+                                     gint                    samples,
+                                     gfloat                  opacity)
+{
+  while (samples--)
+    {
+      gfloat value = layer[ALPHA] * opacity * 255;
+
+      if (mask)
+        value *= *mask;
+
+      if (*values >= value)
+        {
+          out[0] = in[0];
+          out[1] = in[1];
+          out[2] = in[2];
+
+          if (layer_mode->composite_mode == GIMP_LAYER_COMPOSITE_UNION ||
+              layer_mode->composite_mode == GIMP_LAYER_COMPOSITE_CLIP_TO_BACKDROP)
+            {
+              out[3] = in[3];
+            }
+          else
+            {
+              out[3] = 0.0f;
+            }
+        }
+      else
+        {
+          out[0] = layer[0];
+          out[1] = layer[1];
+          out[2] = layer[2];
+
+          if (layer_mode->composite_mode == GIMP_LAYER_COMPOSITE_UNION ||
+              layer_mode->composite_mode == GIMP_LAYER_COMPOSITE_CLIP_TO_LAYER)
+            {
+              out[3] = 1.0f;
+            }
+          else
+            {
+              out[3] = in[3];
+            }
+        }
+
+      in     += 4;
+      layer  += 4;
+      out    += 4;
+      values += 1;
+
+      if (mask)
+        mask++;
+    }
+}
+
 static gboolean
 gimp_operation_dissolve_process (GeglOperation       *op,
                                  void                *in_p,
@@ -97,72 +375,56 @@ gimp_operation_dissolve_process (GeglOperation       *op,
   gfloat                 *mask       = mask_p;
   gfloat                  opacity    = layer_mode->opacity;
   const gboolean          has_mask   = mask != NULL;
-  gint                    x, y;
+  gint                    tile_x1, tile_y1;
+  gint                    tile_x2, tile_y2;
+  gint                    tile_x, tile_y;
+  NoiseTile             **tiles;
+  gint                    y;
 
-  for (y = result->y; y < result->y + result->height; y++)
-    {
-      GRand *gr;
+  tile_x1 = NOISE_TILE_INDEX (result->x);
+  tile_y1 = NOISE_TILE_INDEX (result->y);
+  tile_x2 = NOISE_TILE_INDEX (result->x + result->width  - 1);
+  tile_y2 = NOISE_TILE_INDEX (result->y + result->height - 1);
 
-      /* The offset can be negative. I could just abs() the result, but we
-       * probably prefer to use different indexes of the table when possible for
-       * nicer randomization, so let's cycle the modulo so that -1 is the last
-       * table index.
-       */
-      gr = g_rand_new_with_seed (random_table[((y % RANDOM_TABLE_SIZE) + RANDOM_TABLE_SIZE) % RANDOM_TABLE_SIZE]);
+  tiles = g_newa (NoiseTile *, tile_x2 - tile_x1 + 1);
 
-      /* fast forward through the rows pseudo random sequence */
-      for (x = 0; x < result->x; x++)
-        g_rand_int (gr);
+  for (tile_y = tile_y1; tile_y <= tile_y2; tile_y++)
+    {
+      gint y1 = MAX (tile_y * NOISE_TILE_SIZE, result->y);
+      gint y2 = MIN ((tile_y + 1) * NOISE_TILE_SIZE,
+                     result->y + result->height);
 
-      for (x = result->x; x < result->x + result->width; x++)
-        {
-          gfloat value = layer[ALPHA] * opacity * 255;
+      noise_tiles_get (tile_x1, tile_x2, tile_y, tiles);
 
-          if (has_mask)
-            value *= *mask;
+      for (tile_x = tile_x1; tile_x <= tile_x2; tile_x++)
+        {
+          NoiseTile *tile = tiles[tile_x - tile_x1];
+          gint       x1 = MAX (tile_x * NOISE_TILE_SIZE, result->x);
+          gint       x2 = MIN ((tile_x + 1) * NOISE_TILE_SIZE,
+                               result->x + result->width);
 
-          if (g_rand_int_range (gr, 0, 255) >= value)
-            {
-              out[0] = in[0];
-              out[1] = in[1];
-              out[2] = in[2];
-
-              if (layer_mode->composite_mode == GIMP_LAYER_COMPOSITE_UNION ||
-                  layer_mode->composite_mode == GIMP_LAYER_COMPOSITE_CLIP_TO_BACKDROP)
-                {
-                  out[3] = in[3];
-                }
-              else
-                {
-                  out[3] = 0.0f;
-                }
-            }
-          else
+          for (y = y1; y < y2; y++)
             {
-              out[0] = layer[0];
-              out[1] = layer[1];
-              out[2] = layer[2];
-
-              if (layer_mode->composite_mode == GIMP_LAYER_COMPOSITE_UNION ||
-                  layer_mode->composite_mode == GIMP_LAYER_COMPOSITE_CLIP_TO_LAYER)
-                {
-                  out[3] = 1.0f;
-                }
-              else
-                {
-                  out[3] = in[3];
-                }
+              const guint8 *values;
+              gint          offset;
+
+              values = tile->values +
+                       (y  - tile_y * NOISE_TILE_SIZE) * NOISE_TILE_SIZE +
+                       (x1 - tile_x * NOISE_TILE_SIZE);
+
+              offset = (y - result->y) * result->width + (x1 - result->x);
+
+              gimp_operation_dissolve_process_row (layer_mode,
+                                                   in    + 4 * offset,
+                                                   layer + 4 * offset,
+                                                   has_mask ? mask + offset :
+                                                              NULL,
+                                                   out   + 4 * offset,
+                                                   values, x2 - x1, opacity);
             }
 
-          in    += 4;
-          layer += 4;
-          out   += 4;
-
-          if (has_mask)
-            mask++;
+          noise_tile_unref (tile);
         }
-
-      g_rand_free (gr);
     }
 
   return TRUE;
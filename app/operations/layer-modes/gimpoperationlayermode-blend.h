@@ -194,3 +194,24 @@ void gimp_operation_layer_mode_blend_color_erase       (GeglOperation *operation
                                                         const gfloat  *layer,
                                                         gfloat        *comp,
                                                         gint           samples);
+
+
+/*  vectorized versions of the blend functions  */
+
+#if COMPILE_AVX2_INTRINISICS
+
+GimpLayerModeBlendFunc gimp_operation_layer_mode_blend_get_avx2 (GimpLayerModeBlendFunc blend_function);
+
+#endif /* COMPILE_AVX2_INTRINISICS */
+
+#if COMPILE_AVX512F_INTRINISICS
+
+GimpLayerModeBlendFunc gimp_operation_layer_mode_blend_get_avx512f (GimpLayerModeBlendFunc blend_function);
+
+#endif /* COMPILE_AVX512F_INTRINISICS */
+
+#if COMPILE_NEON_INTRINISICS
+
+GimpLayerModeBlendFunc gimp_operation_layer_mode_blend_get_neon (GimpLayerModeBlendFunc blend_function);
+
+#endif /* COMPILE_NEON_INTRINISICS */
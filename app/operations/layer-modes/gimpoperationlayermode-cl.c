@@ -0,0 +1,294 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpoperationlayermode-cl.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*  an OpenCL version of the fused loops in gimpoperationlayermode-fused.cc,
+ *  for the per-channel blend formulas and the non-subtractive composite
+ *  modes.  the formulas need to be kept in sync with the ones in
+ *  gimpoperationlayermode-blend.c and gimpoperationlayermode-composite.c,
+ *  but since the GPU doesn't round like the CPU, the results aren't
+ *  bit-identical.
+ */
+
+#include "config.h"
+
+#include <gegl-plugin.h>
+#include <cairo.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+#include "../operations-types.h"
+
+#include "gimpoperationlayermode-blend.h"
+#include "gimpoperationlayermode-cl.h"
+
+
+static const gchar *kernel_source =
+"#define COMPOSITE_UNION            1                                      \n"
+"#define COMPOSITE_CLIP_TO_BACKDROP 2                                      \n"
+"#define COMPOSITE_CLIP_TO_LAYER    3                                      \n"
+"#define COMPOSITE_INTERSECTION     4                                      \n"
+"                                                                          \n"
+"#define SAFE_DIV_MIN 1e-6f                                                \n"
+"#define SAFE_DIV_MAX (1.0f / SAFE_DIV_MIN)                                \n"
+"                                                                          \n"
+"float3 safe_div (float3 a,                                                \n"
+"                 float3 b)                                                \n"
+"{                                                                         \n"
+"  return select ((float3) (0.0f),                                         \n"
+"                 clamp (a / b, -SAFE_DIV_MAX, SAFE_DIV_MAX),              \n"
+"                 fabs (a) > SAFE_DIV_MIN);                                \n"
+"}                                                                         \n"
+"                                                                          \n"
+"float3 blend (int    mode,                                                \n"
+"              float3 in,                                                  \n"
+"              float3 layer)                                               \n"
+"{                                                                         \n"
+"  switch (mode)                                                           \n"
+"    {                                                                     \n"
+"    case 0: /* addition */                                                \n"
+"      return in + layer;                                                  \n"
+"    case 1: /* burn */                                                    \n"
+"      return 1.0f - safe_div (1.0f - in, layer);                          \n"
+"    case 2: /* darken only */                                             \n"
+"      return fmin (in, layer);                                            \n"
+"    case 3: /* difference */                                              \n"
+"      return fabs (in - layer);                                           \n"
+"    case 4: /* divide */                                                  \n"
+"      return safe_div (in, layer);                                        \n"
+"    case 5: /* dodge */                                                   \n"
+"      return safe_div (in, 1.0f - layer);                                 \n"
+"    case 6: /* exclusion */                                               \n"
+"      return 0.5f - 2.0f * (in - 0.5f) * (layer - 0.5f);                  \n"
+"    case 7: /* grain extract */                                           \n"
+"      return in - layer + 0.5f;                                           \n"
+"    case 8: /* grain merge */                                             \n"
+"      return in + layer - 0.5f;                                           \n"
+"    case 9: /* hard mix */                                                \n"
+"      return select ((float3) (1.0f), (float3) (0.0f), in + layer < 1.0f);\n"
+"    case 10: /* hardlight */                                              \n"
+"      return select (fmin (in * (layer * 2.0f), 1.0f),                    \n"
+"                     fmin (1.0f - (1.0f - in) *                           \n"
+"                           (1.0f - (layer - 0.5f) * 2.0f), 1.0f),         \n"
+"                     layer > 0.5f);                                       \n"
+"    case 11: /* lighten only */                                           \n"
+"      return fmax (in, layer);                                            \n"
+"    case 12: /* linear burn */                                            \n"
+"      return in + layer - 1.0f;                                           \n"
+"    case 13: /* linear light */                                           \n"
+"      return select (in + 2.0f * (layer - 0.5f),                          \n"
+"                     in + 2.0f * layer - 1.0f,                            \n"
+"                     layer <= 0.5f);                                      \n"
+"    case 14: /* multiply */                                               \n"
+"      return in * layer;                                                  \n"
+"    case 15: /* overlay */                                                \n"
+"      return select (1.0f - 2.0f * (1.0f - layer) * (1.0f - in),          \n"
+"                     2.0f * in * layer,                                   \n"
+"                     in < 0.5f);                                          \n"
+"    case 16: /* pin light */                                              \n"
+"      return select (fmin (in, 2.0f * layer),                             \n"
+"                     fmax (in, 2.0f * (layer - 0.5f)),                    \n"
+"                     layer > 0.5f);                                       \n"
+"    case 17: /* screen */                                                 \n"
+"      return 1.0f - (1.0f - in) * (1.0f - layer);                         \n"
+"    case 18: /* softlight */                                              \n"
+"      return (1.0f - in) * (in * layer) +                                 \n"
+"             in * (1.0f - (1.0f - in) * (1.0f - layer));                  \n"
+"    case 19: /* subtract */                                               \n"
+"      return in - layer;                                                  \n"
+"    default: /* vivid light */                                            \n"
+"      return select (fmin (safe_div (in, 2.0f * (1.0f - layer)), 1.0f),   \n"
+"                     fmax (1.0f - safe_div (1.0f - in, 2.0f * layer), 0.0f),\n"
+"                     layer <= 0.5f);                                      \n"
+"    }                                                                     \n"
+"}                                                                         \n"
+"                                                                          \n"
+"__kernel void gimp_layer_mode (__global const float4 *in,                 \n"
+"                               __global const float4 *layer,              \n"
+"                               __global const float  *mask,               \n"
+"                               __global       float4 *out,                \n"
+"                               int                    mode,               \n"
+"                               int                    composite_mode,     \n"
+"                               float                  opacity,            \n"
+"                               int                    has_mask)           \n"
+"{                                                                         \n"
+"  int    gid         = get_global_id (0);                                 \n"
+"  float4 src         = in[gid];                                           \n"
+"  float4 lay         = layer[gid];                                        \n"
+"  float  layer_alpha = lay.w * opacity;                                   \n"
+"  float4 dest;                                                            \n"
+"                                                                          \n"
+"  if (has_mask)                                                           \n"
+"    layer_alpha *= mask[gid];                                             \n"
+"                                                                          \n"
+"  if (composite_mode == COMPOSITE_INTERSECTION)                           \n"
+"    {                                                                     \n"
+"      float new_alpha = src.w * layer_alpha;                              \n"
+"                                                                          \n"
+"      if (new_alpha == 0.0f)                                              \n"
+"        dest.xyz = src.xyz;                                               \n"
+"      else                                                                \n"
+"        dest.xyz = blend (mode, src.xyz, lay.xyz);                        \n"
+"                                                                          \n"
+"      dest.w = new_alpha;                                                 \n"
+"    }                                                                     \n"
+"  else if (composite_mode == COMPOSITE_CLIP_TO_BACKDROP)                  \n"
+"    {                                                                     \n"
+"      if (src.w == 0.0f || layer_alpha == 0.0f)                           \n"
+"        dest.xyz = src.xyz;                                               \n"
+"      else                                                                \n"
+"        dest.xyz = mix (src.xyz, blend (mode, src.xyz, lay.xyz),          \n"
+"                        layer_alpha);                                     \n"
+"                                                                          \n"
+"      dest.w = src.w;                                                     \n"
+"    }                                                                     \n"
+"  else if (composite_mode == COMPOSITE_CLIP_TO_LAYER)                     \n"
+"    {                                                                     \n"
+"      if (layer_alpha == 0.0f)                                            \n"
+"        dest.xyz = src.xyz;                                               \n"
+"      else if (src.w == 0.0f)                                             \n"
+"        dest.xyz = lay.xyz;                                               \n"
+"      else                                                                \n"
+"        dest.xyz = mix (lay.xyz, blend (mode, src.xyz, lay.xyz),          \n"
+"                        src.w);                                           \n"
+"                                                                          \n"
+"      dest.w = layer_alpha;                                               \n"
+"    }                                                                     \n"
+"  else /* COMPOSITE_UNION */                                              \n"
+"    {                                                                     \n"
+"      float new_alpha = layer_alpha + (1.0f - layer_alpha) * src.w;       \n"
+"                                                                          \n"
+"      if (layer_alpha == 0.0f || new_alpha == 0.0f)                       \n"
+"        {                                                                 \n"
+"          dest.xyz = src.xyz;                                             \n"
+"        }                                                                 \n"
+"      else if (src.w == 0.0f)                                             \n"
+"        {                                                                 \n"
+"          dest.xyz = lay.xyz;                                             \n"
+"        }                                                                 \n"
+"      else                                                                \n"
+"        {                                                                 \n"
+"          float3 comp  = blend (mode, src.xyz, lay.xyz);                  \n"
+"          float  ratio = layer_alpha / new_alpha;                         \n"
+"                                                                          \n"
+"          dest.xyz = ratio * (src.w * (comp - lay.xyz) + lay.xyz - src.xyz) +\n"
+"                     src.xyz;                                             \n"
+"        }                                                                 \n"
+"                                                                          \n"
+"      dest.w = new_alpha;                                                 \n"
+"    }                                                                     \n"
+"                                                                          \n"
+"  out[gid] = dest;                                                        \n"
+"}                                                                         \n";
+
+static GeglClRunData *cl_data = NULL;
+
+/*  in the order of the cases in blend ()  */
+static const GimpLayerModeBlendFunc blend_functions[] =
+{
+  gimp_operation_layer_mode_blend_addition,
+  gimp_operation_layer_mode_blend_burn,
+  gimp_operation_layer_mode_blend_darken_only,
+  gimp_operation_layer_mode_blend_difference,
+  gimp_operation_layer_mode_blend_divide,
+  gimp_operation_layer_mode_blend_dodge,
+  gimp_operation_layer_mode_blend_exclusion,
+  gimp_operation_layer_mode_blend_grain_extract,
+  gimp_operation_layer_mode_blend_grain_merge,
+  gimp_operation_layer_mode_blend_hard_mix,
+  gimp_operation_layer_mode_blend_hardlight,
+  gimp_operation_layer_mode_blend_lighten_only,
+  gimp_operation_layer_mode_blend_linear_burn,
+  gimp_operation_layer_mode_blend_linear_light,
+  gimp_operation_layer_mode_blend_multiply,
+  gimp_operation_layer_mode_blend_overlay,
+  gimp_operation_layer_mode_blend_pin_light,
+  gimp_operation_layer_mode_blend_screen,
+  gimp_operation_layer_mode_blend_softlight,
+  gimp_operation_layer_mode_blend_subtract,
+  gimp_operation_layer_mode_blend_vivid_light
+};
+
+
+/*  public functions  */
+
+gint
+gimp_operation_layer_mode_cl_get_blend (GimpLayerModeBlendFunc blend_function)
+{
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (blend_functions); i++)
+    {
+      if (blend_functions[i] == blend_function)
+        return i;
+    }
+
+  return -1;
+}
+
+gboolean
+gimp_operation_layer_mode_cl_blend (gint                   blend,
+                                    GimpLayerCompositeMode composite_mode,
+                                    gfloat                 opacity,
+                                    cl_mem                 in_tex,
+                                    cl_mem                 layer_tex,
+                                    cl_mem                 mask_tex,
+                                    cl_mem                 out_tex,
+                                    size_t                 global_worksize)
+{
+  cl_int   mode       = blend;
+  cl_int   composite  = composite_mode;
+  cl_float cl_opacity = opacity;
+  cl_int   has_mask   = mask_tex != NULL;
+  cl_int   cl_err;
+
+  g_return_val_if_fail (blend >= 0 && blend < G_N_ELEMENTS (blend_functions),
+                        TRUE);
+
+  if (! cl_data)
+    {
+      const gchar *kernel_name[] = { "gimp_layer_mode", NULL };
+
+      cl_data = gegl_cl_compile_and_build (kernel_source, kernel_name);
+
+      if (! cl_data)
+        return TRUE;
+    }
+
+  /*  a NULL buffer argument is legal, the kernel doesn't touch the mask
+   *  unless has_mask is set
+   */
+  cl_err = gegl_cl_set_kernel_args (cl_data->kernel[0],
+                                    sizeof (cl_mem),   &in_tex,
+                                    sizeof (cl_mem),   &layer_tex,
+                                    sizeof (cl_mem),   &mask_tex,
+                                    sizeof (cl_mem),   &out_tex,
+                                    sizeof (cl_int),   &mode,
+                                    sizeof (cl_int),   &composite,
+                                    sizeof (cl_float), &cl_opacity,
+                                    sizeof (cl_int),   &has_mask,
+                                    NULL);
+  if (cl_err != CL_SUCCESS)
+    return TRUE;
+
+  cl_err = gegl_clEnqueueNDRangeKernel (gegl_cl_get_command_queue (),
+                                        cl_data->kernel[0], 1,
+                                        NULL, &global_worksize, NULL,
+                                        0, NULL, NULL);
+
+  return cl_err != CL_SUCCESS;
+}
@@ -0,0 +1,41 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpoperationlayermode-cl.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <opencl/gegl-cl.h>
+
+
+/*  returns the index of the blend formula in the OpenCL kernel, or -1 if
+ *  there is none for this blend function.
+ */
+gint       gimp_operation_layer_mode_cl_get_blend (GimpLayerModeBlendFunc  blend_function);
+
+/*  blends and composites in one pass, for when blending and compositing
+ *  happen in the same space, and the composite mode isn't subtractive.
+ *  like all GEGL OpenCL process functions, returns TRUE on error.
+ */
+gboolean   gimp_operation_layer_mode_cl_blend     (gint                    blend,
+                                                   GimpLayerCompositeMode  composite_mode,
+                                                   gfloat                  opacity,
+                                                   cl_mem                  in_tex,
+                                                   cl_mem                  layer_tex,
+                                                   cl_mem                  mask_tex,
+                                                   cl_mem                  out_tex,
+                                                   size_t                  global_worksize);
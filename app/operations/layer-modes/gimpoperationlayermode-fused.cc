@@ -0,0 +1,514 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpoperationlayermode-fused.cc
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*  when blending and compositing happen in the same space, the general
+ *  layer mode process function still blends the whole row into a
+ *  temporary buffer, and then composites it in a second pass, deciding
+ *  which composite function to call for every row.  the loops in this file
+ *  do both in one pass instead, with the blend formula, the composite mode,
+ *  and whether there is a mask and an opacity all known at compile time.
+ *
+ *  the results are the same as the ones of the blend functions in
+ *  gimpoperationlayermode-blend.c followed by the composite functions in
+ *  gimpoperationlayermode-composite.c, the formulas need to be kept in
+ *  sync.
+ */
+
+#include "config.h"
+
+#include <gegl-plugin.h>
+#include <cairo.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+extern "C"
+{
+
+#include "libgimpmath/gimpmath.h"
+
+#include "../operations-types.h"
+
+#include "gimpoperationlayermode-blend.h"
+#include "gimpoperationlayermode-fused.h"
+
+} /* extern "C" */
+
+
+#define EPSILON      1e-6f
+
+#define SAFE_DIV_MIN EPSILON
+#define SAFE_DIV_MAX (1.0f / SAFE_DIV_MIN)
+
+
+/*  see safe_div() in gimpoperationlayermode-blend.c  */
+static inline gfloat
+safe_div (gfloat a,
+          gfloat b)
+{
+  gfloat result = 0.0f;
+
+  if (fabsf (a) > SAFE_DIV_MIN)
+    {
+      result = a / b;
+      result = CLAMP (result, -SAFE_DIV_MAX, SAFE_DIV_MAX);
+    }
+
+  return result;
+}
+
+
+/*  blend formulas, per color component  */
+
+struct BlendAddition
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    return in + layer;
+  }
+};
+
+struct BlendBurn
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    return 1.0f - safe_div (1.0f - in, layer);
+  }
+};
+
+struct BlendDarkenOnly
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    return MIN (in, layer);
+  }
+};
+
+struct BlendDifference
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    return fabsf (in - layer);
+  }
+};
+
+struct BlendDivide
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    return safe_div (in, layer);
+  }
+};
+
+struct BlendDodge
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    return safe_div (in, 1.0f - layer);
+  }
+};
+
+struct BlendExclusion
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    return 0.5f - 2.0f * (in - 0.5f) * (layer - 0.5f);
+  }
+};
+
+struct BlendGrainExtract
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    return in - layer + 0.5f;
+  }
+};
+
+struct BlendGrainMerge
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    return in + layer - 0.5f;
+  }
+};
+
+struct BlendHardMix
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    return in + layer < 1.0f ? 0.0f : 1.0f;
+  }
+};
+
+struct BlendHardlight
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    gfloat val;
+
+    if (layer > 0.5f)
+      {
+        val = (1.0f - in) * (1.0f - (layer - 0.5f) * 2.0f);
+        val = MIN (1.0f - val, 1.0f);
+      }
+    else
+      {
+        val = in * (layer * 2.0f);
+        val = MIN (val, 1.0f);
+      }
+
+    return val;
+  }
+};
+
+struct BlendLightenOnly
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    return MAX (in, layer);
+  }
+};
+
+struct BlendLinearBurn
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    return in + layer - 1.0f;
+  }
+};
+
+struct BlendLinearLight
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    if (layer <= 0.5f)
+      return in + 2.0f * layer - 1.0f;
+    else
+      return in + 2.0f * (layer - 0.5f);
+  }
+};
+
+struct BlendMultiply
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    return in * layer;
+  }
+};
+
+struct BlendOverlay
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    if (in < 0.5f)
+      return 2.0f * in * layer;
+    else
+      return 1.0f - 2.0f * (1.0f - layer) * (1.0f - in);
+  }
+};
+
+struct BlendPinLight
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    if (layer > 0.5f)
+      return MAX (in, 2.0f * (layer - 0.5f));
+    else
+      return MIN (in, 2.0f * layer);
+  }
+};
+
+struct BlendScreen
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    return 1.0f - (1.0f - in) * (1.0f - layer);
+  }
+};
+
+struct BlendSoftlight
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    gfloat multiply = in * layer;
+    gfloat screen   = 1.0f - (1.0f - in) * (1.0f - layer);
+
+    return (1.0f - in) * multiply + in * screen;
+  }
+};
+
+struct BlendSubtract
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    return in - layer;
+  }
+};
+
+struct BlendVividLight
+{
+  static gfloat blend (gfloat in, gfloat layer)
+  {
+    gfloat val;
+
+    if (layer <= 0.5f)
+      {
+        val = 1.0f - safe_div (1.0f - in, 2.0f * layer);
+        val = MAX (val, 0.0f);
+      }
+    else
+      {
+        val = safe_div (in, 2.0f * (1.0f - layer));
+        val = MIN (val, 1.0f);
+      }
+
+    return val;
+  }
+};
+
+
+/*  the fused loops.  only the non-subtractive composite modes are handled,
+ *  for which comp[ALPHA] is layer[ALPHA].  the blend formula is only
+ *  evaluated for the pixels whose composited color depends on it.
+ */
+
+template <class                  Blend,
+          GimpLayerCompositeMode CompositeMode,
+          gboolean               HasMask,
+          gboolean               HasOpacity>
+struct FusedProcess
+{
+  static inline void
+  blend (const gfloat *in,
+         const gfloat *layer,
+         gfloat       *comp)
+  {
+    gint b;
+
+    for (b = RED; b < ALPHA; b++)
+      comp[b] = Blend::blend (in[b], layer[b]);
+  }
+
+  static void
+  process (const gfloat *in,
+           const gfloat *layer,
+           const gfloat *mask,
+           gfloat        opacity,
+           gfloat       *out,
+           gint          samples)
+  {
+    while (samples--)
+      {
+        gfloat in_alpha = in[ALPHA];
+        gfloat comp[3];
+        gint   b;
+
+        if (CompositeMode == GIMP_LAYER_COMPOSITE_INTERSECTION)
+          {
+            gfloat new_alpha = in_alpha * layer[ALPHA];
+
+            if (HasOpacity)
+              new_alpha *= opacity;
+
+            if (HasMask)
+              new_alpha *= *mask;
+
+            if (new_alpha == 0.0f)
+              {
+                for (b = RED; b < ALPHA; b++)
+                  out[b] = in[b];
+              }
+            else
+              {
+                blend (in, layer, comp);
+
+                for (b = RED; b < ALPHA; b++)
+                  out[b] = comp[b];
+              }
+
+            out[ALPHA] = new_alpha;
+          }
+        else
+          {
+            gfloat layer_alpha = layer[ALPHA];
+
+            if (HasOpacity)
+              layer_alpha *= opacity;
+
+            if (HasMask)
+              layer_alpha *= *mask;
+
+            if (CompositeMode == GIMP_LAYER_COMPOSITE_UNION)
+              {
+                gfloat new_alpha = layer_alpha + (1.0f - layer_alpha) * in_alpha;
+
+                if (layer_alpha == 0.0f || new_alpha == 0.0f)
+                  {
+                    for (b = RED; b < ALPHA; b++)
+                      out[b] = in[b];
+                  }
+                else if (in_alpha == 0.0f)
+                  {
+                    for (b = RED; b < ALPHA; b++)
+                      out[b] = layer[b];
+                  }
+                else
+                  {
+                    gfloat ratio = layer_alpha / new_alpha;
+
+                    blend (in, layer, comp);
+
+                    for (b = RED; b < ALPHA; b++)
+                      out[b] = ratio * (in_alpha * (comp[b] - layer[b]) + layer[b] - in[b]) + in[b];
+                  }
+
+                out[ALPHA] = new_alpha;
+              }
+            else if (CompositeMode == GIMP_LAYER_COMPOSITE_CLIP_TO_BACKDROP)
+              {
+                if (in_alpha == 0.0f || layer_alpha == 0.0f)
+                  {
+                    for (b = RED; b < ALPHA; b++)
+                      out[b] = in[b];
+                  }
+                else
+                  {
+                    blend (in, layer, comp);
+
+                    for (b = RED; b < ALPHA; b++)
+                      out[b] = comp[b] * layer_alpha + in[b] * (1.0f - layer_alpha);
+                  }
+
+                out[ALPHA] = in_alpha;
+              }
+            else /* GIMP_LAYER_COMPOSITE_CLIP_TO_LAYER */
+              {
+                if (layer_alpha == 0.0f)
+                  {
+                    for (b = RED; b < ALPHA; b++)
+                      out[b] = in[b];
+                  }
+                else if (in_alpha == 0.0f)
+                  {
+                    for (b = RED; b < ALPHA; b++)
+                      out[b] = layer[b];
+                  }
+                else
+                  {
+                    blend (in, layer, comp);
+
+                    for (b = RED; b < ALPHA; b++)
+                      out[b] = comp[b] * in_alpha + layer[b] * (1.0f - in_alpha);
+                  }
+
+                out[ALPHA] = layer_alpha;
+              }
+          }
+
+        in    += 4;
+        layer += 4;
+        out   += 4;
+
+        if (HasMask)
+          mask++;
+      }
+  }
+};
+
+template <class                  Blend,
+          GimpLayerCompositeMode CompositeMode>
+struct FusedFuncs
+{
+  static const GimpLayerModeFusedFuncs funcs;
+};
+
+template <class                  Blend,
+          GimpLayerCompositeMode CompositeMode>
+const GimpLayerModeFusedFuncs FusedFuncs<Blend, CompositeMode>::funcs =
+{
+  {
+    {
+      FusedProcess<Blend, CompositeMode, FALSE, FALSE>::process,
+      FusedProcess<Blend, CompositeMode, FALSE, TRUE>::process
+    },
+    {
+      FusedProcess<Blend, CompositeMode, TRUE,  FALSE>::process,
+      FusedProcess<Blend, CompositeMode, TRUE,  TRUE>::process
+    }
+  }
+};
+
+template <class Blend>
+static const GimpLayerModeFusedFuncs *
+get_fused_funcs (GimpLayerCompositeMode composite_mode)
+{
+  switch (composite_mode)
+    {
+    case GIMP_LAYER_COMPOSITE_AUTO:
+    case GIMP_LAYER_COMPOSITE_UNION:
+      return &FusedFuncs<Blend, GIMP_LAYER_COMPOSITE_UNION>::funcs;
+
+    case GIMP_LAYER_COMPOSITE_CLIP_TO_BACKDROP:
+      return &FusedFuncs<Blend, GIMP_LAYER_COMPOSITE_CLIP_TO_BACKDROP>::funcs;
+
+    case GIMP_LAYER_COMPOSITE_CLIP_TO_LAYER:
+      return &FusedFuncs<Blend, GIMP_LAYER_COMPOSITE_CLIP_TO_LAYER>::funcs;
+
+    case GIMP_LAYER_COMPOSITE_INTERSECTION:
+      return &FusedFuncs<Blend, GIMP_LAYER_COMPOSITE_INTERSECTION>::funcs;
+    }
+
+  return NULL;
+}
+
+
+/*  public functions  */
+
+extern "C" const GimpLayerModeFusedFuncs *
+gimp_operation_layer_mode_get_fused_funcs (GimpLayerModeBlendFunc blend_function,
+                                           GimpLayerCompositeMode composite_mode)
+{
+#define FUSED_FUNCS(name, Blend)                                  \
+  if (blend_function == gimp_operation_layer_mode_blend_##name)   \
+    return get_fused_funcs<Blend> (composite_mode)
+
+  FUSED_FUNCS (addition,      BlendAddition);
+  FUSED_FUNCS (burn,          BlendBurn);
+  FUSED_FUNCS (darken_only,   BlendDarkenOnly);
+  FUSED_FUNCS (difference,    BlendDifference);
+  FUSED_FUNCS (divide,        BlendDivide);
+  FUSED_FUNCS (dodge,         BlendDodge);
+  FUSED_FUNCS (exclusion,     BlendExclusion);
+  FUSED_FUNCS (grain_extract, BlendGrainExtract);
+  FUSED_FUNCS (grain_merge,   BlendGrainMerge);
+  FUSED_FUNCS (hard_mix,      BlendHardMix);
+  FUSED_FUNCS (hardlight,     BlendHardlight);
+  FUSED_FUNCS (lighten_only,  BlendLightenOnly);
+  FUSED_FUNCS (linear_burn,   BlendLinearBurn);
+  FUSED_FUNCS (linear_light,  BlendLinearLight);
+  FUSED_FUNCS (multiply,      BlendMultiply);
+  FUSED_FUNCS (overlay,       BlendOverlay);
+  FUSED_FUNCS (pin_light,     BlendPinLight);
+  FUSED_FUNCS (screen,        BlendScreen);
+  FUSED_FUNCS (softlight,     BlendSoftlight);
+  FUSED_FUNCS (subtract,      BlendSubtract);
+  FUSED_FUNCS (vivid_light,   BlendVividLight);
+
+#undef FUSED_FUNCS
+
+  return NULL;
+}
@@ -0,0 +1,45 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpoperationlayermode-fused.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+typedef void (* GimpLayerModeFusedFunc) (const gfloat *in,
+                                         const gfloat *layer,
+                                         const gfloat *mask,
+                                         gfloat        opacity,
+                                         gfloat       *out,
+                                         gint          samples);
+
+struct _GimpLayerModeFusedFuncs
+{
+  /*  indexed by whether there is a mask, and whether the opacity is
+   *  anything but 1.0
+   */
+  GimpLayerModeFusedFunc func[2 /* has mask */][2 /* has opacity */];
+};
+
+
+/*  returns the functions blending and compositing in one pass, for when
+ *  blending and compositing happen in the same space, or NULL if there are
+ *  none for this combination.
+ */
+const GimpLayerModeFusedFuncs *
+gimp_operation_layer_mode_get_fused_funcs (GimpLayerModeBlendFunc blend_function,
+                                           GimpLayerCompositeMode composite_mode);
@@ -0,0 +1,1002 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpoperationlayermode-simd-body.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*  blend and composite functions, operating on as many RGBA pixels at once
+ *  as fit a vector register.  this file is included by the
+ *  gimpoperationlayermode-<instruction set>.c files, which define
+ *  SIMD_WIDTH, the number of floats in a vector, and SIMD_SUFFIX, which is
+ *  appended to the names of the public functions.
+ *
+ *  the functions give the same results as the ones in
+ *  gimpoperationlayermode-blend.c and gimpoperationlayermode-composite.c,
+ *  which they fall back to for the trailing pixels.  they don't branch per
+ *  pixel, but compute all cases and select the right one, which is fine
+ *  since the blend and composite functions don't care about the color
+ *  values they produce for pixels which end up not being used.
+ */
+
+#if SIMD_WIDTH == 4
+#define SIMD_PIXELS(...)      __VA_ARGS__
+#define SIMD_CHANNEL_INDICES(c) \
+  c, c, c, c
+#elif SIMD_WIDTH == 8
+#define SIMD_PIXELS(...)      __VA_ARGS__, __VA_ARGS__
+#define SIMD_CHANNEL_INDICES(c) \
+  c, c, c, c, c + 4, c + 4, c + 4, c + 4
+#elif SIMD_WIDTH == 16
+#define SIMD_PIXELS(...)      __VA_ARGS__, __VA_ARGS__, __VA_ARGS__, __VA_ARGS__
+#define SIMD_CHANNEL_INDICES(c) \
+  c,      c,      c,      c,      c + 4,  c + 4,  c + 4,  c + 4, \
+  c + 8,  c + 8,  c + 8,  c + 8,  c + 12, c + 12, c + 12, c + 12
+#else
+#error "SIMD_WIDTH must be 4, 8 or 16"
+#endif
+
+#define SIMD_N_PIXELS         (SIMD_WIDTH / 4)
+
+#define SIMD_FUNC_CONCAT(name, suffix) name##_##suffix
+#define SIMD_FUNC_EVAL(name, suffix)   SIMD_FUNC_CONCAT (name, suffix)
+#define SIMD_FUNC(name)                SIMD_FUNC_EVAL (name, SIMD_SUFFIX)
+
+#define EPSILON      1e-6f
+
+#define SAFE_DIV_MIN EPSILON
+#define SAFE_DIV_MAX (1.0f / SAFE_DIV_MIN)
+
+
+typedef gfloat vfloat   __attribute__ ((vector_size (SIMD_WIDTH * sizeof (gfloat))));
+typedef gint32 vint     __attribute__ ((vector_size (SIMD_WIDTH * sizeof (gint32))));
+
+/*  the buffers are only guaranteed to be aligned to a float  */
+typedef gfloat vfloat_u __attribute__ ((vector_size (SIMD_WIDTH * sizeof (gfloat)),
+                                        aligned (sizeof (gfloat)),
+                                        may_alias));
+
+#if defined(__clang__)
+#define v_shuffle(v, ...) __builtin_shufflevector (v, v, __VA_ARGS__)
+#else
+#define v_shuffle(v, ...) __builtin_shuffle (v, (vint) { __VA_ARGS__ })
+#endif
+
+
+static const vint alpha_lanes = { SIMD_PIXELS (0, 0, 0, -1) };
+static const vint ab_lanes    = { SIMD_PIXELS (0, -1, -1, 0) };
+
+
+/*  private functions  */
+
+static inline vfloat
+v_load (const gfloat *p)
+{
+  return *(const vfloat_u *) p;
+}
+
+static inline void
+v_store (gfloat *p,
+         vfloat  v)
+{
+  *(vfloat_u *) p = v;
+}
+
+static inline vfloat
+v_splat (gfloat f)
+{
+  return (vfloat) { 0.0f } + f;
+}
+
+static inline vfloat
+v_select (vint   cond,
+          vfloat a,
+          vfloat b)
+{
+  return (vfloat) ((cond & (vint) a) | (~cond & (vint) b));
+}
+
+static inline vfloat
+v_min (vfloat a,
+       vfloat b)
+{
+  return v_select (a < b, a, b);
+}
+
+static inline vfloat
+v_max (vfloat a,
+       vfloat b)
+{
+  return v_select (a > b, a, b);
+}
+
+static inline vfloat
+v_abs (vfloat a)
+{
+  return (vfloat) ((vint) a & 0x7fffffff);
+}
+
+/*  returns channel c of each pixel, in all of the pixel's lanes  */
+#define v_channel(v, c) v_shuffle (v, SIMD_CHANNEL_INDICES (c))
+
+/*  returns the alpha of each pixel, in all of the pixel's lanes  */
+static inline vfloat
+v_alpha (vfloat v)
+{
+  return v_channel (v, 3);
+}
+
+/*  returns the smallest and largest of the red, green and blue components
+ *  of each pixel, in all of the pixel's lanes
+ */
+static inline vfloat
+v_rgb_min (vfloat v)
+{
+  return v_min (v_min (v_channel (v, 0), v_channel (v, 1)), v_channel (v, 2));
+}
+
+static inline vfloat
+v_rgb_max (vfloat v)
+{
+  return v_max (v_max (v_channel (v, 0), v_channel (v, 1)), v_channel (v, 2));
+}
+
+/*  returns sqrt (a) for a >= 0, as a times the usual initial guess for
+ *  1 / sqrt (a), refined by three newton-raphson steps.  the relative error
+ *  is below 1e-6 for normal values of a; denormals give 0.
+ */
+static inline vfloat
+v_sqrt (vfloat a)
+{
+  vfloat x = (vfloat) (0x5f3759df - ((vint) a >> 1));
+
+  x = x * (1.5f - 0.5f * a * x * x);
+  x = x * (1.5f - 0.5f * a * x * x);
+  x = x * (1.5f - 0.5f * a * x * x);
+
+  return v_select (a >= v_splat (G_MINFLOAT), a * x, v_splat (0.0f));
+}
+
+/*  returns the mask value of each pixel, in all of the pixel's lanes  */
+static inline vfloat
+v_mask (const gfloat *mask)
+{
+#if SIMD_WIDTH == 4
+  return v_splat (mask[0]);
+#elif SIMD_WIDTH == 8
+  return (vfloat) { mask[0], mask[0], mask[0], mask[0],
+                    mask[1], mask[1], mask[1], mask[1] };
+#else
+  return (vfloat) { mask[0], mask[0], mask[0], mask[0],
+                    mask[1], mask[1], mask[1], mask[1],
+                    mask[2], mask[2], mask[2], mask[2],
+                    mask[3], mask[3], mask[3], mask[3] };
+#endif
+}
+
+/*  see safe_div() in gimpoperationlayermode-blend.c  */
+static inline vfloat
+v_safe_div (vfloat a,
+            vfloat b)
+{
+  vfloat result = a / b;
+
+  result = v_select (result > v_splat (SAFE_DIV_MAX),
+                     v_splat (SAFE_DIV_MAX),
+                     v_select (result < v_splat (-SAFE_DIV_MAX),
+                               v_splat (-SAFE_DIV_MAX),
+                               result));
+
+  return v_select (v_abs (a) > v_splat (SAFE_DIV_MIN), result, v_splat (0.0f));
+}
+
+
+/*  blend functions  */
+
+static inline vfloat
+blend_addition (vfloat in,
+                vfloat layer)
+{
+  return in + layer;
+}
+
+static inline vfloat
+blend_burn (vfloat in,
+            vfloat layer)
+{
+  return 1.0f - v_safe_div (1.0f - in, layer);
+}
+
+static inline vfloat
+blend_darken_only (vfloat in,
+                   vfloat layer)
+{
+  return v_min (in, layer);
+}
+
+static inline vfloat
+blend_difference (vfloat in,
+                  vfloat layer)
+{
+  return v_abs (in - layer);
+}
+
+static inline vfloat
+blend_divide (vfloat in,
+              vfloat layer)
+{
+  return v_safe_div (in, layer);
+}
+
+static inline vfloat
+blend_dodge (vfloat in,
+             vfloat layer)
+{
+  return v_safe_div (in, 1.0f - layer);
+}
+
+static inline vfloat
+blend_exclusion (vfloat in,
+                 vfloat layer)
+{
+  return 0.5f - 2.0f * (in - 0.5f) * (layer - 0.5f);
+}
+
+static inline vfloat
+blend_grain_extract (vfloat in,
+                     vfloat layer)
+{
+  return in - layer + 0.5f;
+}
+
+static inline vfloat
+blend_grain_merge (vfloat in,
+                   vfloat layer)
+{
+  return in + layer - 0.5f;
+}
+
+static inline vfloat
+blend_hard_mix (vfloat in,
+                vfloat layer)
+{
+  return v_select (in + layer < 1.0f, v_splat (0.0f), v_splat (1.0f));
+}
+
+static inline vfloat
+blend_hardlight (vfloat in,
+                 vfloat layer)
+{
+  vfloat high = (1.0f - in) * (1.0f - (layer - 0.5f) * 2.0f);
+  vfloat low  = in * (layer * 2.0f);
+
+  high = v_min (1.0f - high, v_splat (1.0f));
+  low  = v_min (low,         v_splat (1.0f));
+
+  return v_select (layer > 0.5f, high, low);
+}
+
+static inline vfloat
+blend_hsl_color (vfloat in,
+                 vfloat layer)
+{
+  vfloat dest_l = (v_rgb_min (in)    + v_rgb_max (in))    / 2.0f;
+  vfloat src_l  = (v_rgb_min (layer) + v_rgb_max (layer)) / 2.0f;
+  vfloat dest_low;
+  vfloat src_low;
+  vfloat ratio;
+  vfloat offset;
+
+  dest_low = v_min (dest_l, 1.0f - dest_l);
+  src_low  = v_min (src_l,  1.0f - src_l);
+
+  ratio  = dest_low / src_low;
+
+  offset = v_select (dest_l > 0.5f, 1.0f - 2.0f * dest_low, v_splat (0.0f)) +
+           v_select (src_l  > 0.5f, 2.0f * dest_low - ratio, v_splat (0.0f));
+
+  return v_select ((v_abs (src_l) > EPSILON) & (v_abs (1.0f - src_l) > EPSILON),
+                   layer * ratio + offset,
+                   dest_l);
+}
+
+static inline vfloat
+blend_hsv_hue (vfloat in,
+               vfloat layer)
+{
+  vfloat src_max    = v_rgb_max (layer);
+  vfloat src_delta  = src_max - v_rgb_min (layer);
+  vfloat dest_max   = v_rgb_max (in);
+  vfloat dest_delta = dest_max - v_rgb_min (in);
+  vfloat dest_s;
+  vfloat ratio;
+  vfloat offset;
+
+  dest_s = v_select (dest_max != 0.0f, dest_delta / dest_max, v_splat (0.0f));
+
+  ratio  = dest_s * dest_max / src_delta;
+  offset = dest_max - src_max * ratio;
+
+  return v_select (src_delta > EPSILON, layer * ratio + offset, in);
+}
+
+static inline vfloat
+blend_hsv_saturation (vfloat in,
+                      vfloat layer)
+{
+  vfloat src_max    = v_rgb_max (layer);
+  vfloat src_delta  = src_max - v_rgb_min (layer);
+  vfloat dest_max   = v_rgb_max (in);
+  vfloat dest_delta = dest_max - v_rgb_min (in);
+  vfloat src_s;
+  vfloat ratio;
+  vfloat offset;
+
+  src_s = v_select (src_max != 0.0f, src_delta / src_max, v_splat (0.0f));
+
+  ratio  = src_s * dest_max / dest_delta;
+  offset = (1.0f - ratio) * dest_max;
+
+  return v_select (dest_delta > EPSILON, in * ratio + offset, dest_max);
+}
+
+static inline vfloat
+blend_hsv_value (vfloat in,
+                 vfloat layer)
+{
+  vfloat dest_v = v_rgb_max (in);
+  vfloat src_v  = v_rgb_max (layer);
+
+  return v_select (v_abs (dest_v) > EPSILON, in * (src_v / dest_v), src_v);
+}
+
+/*  the lch blend functions get lab pixels, and only need the ratio of the
+ *  chromas, which is the square root of the ratio of their squares.
+ */
+static inline vfloat
+blend_lch_chroma (vfloat in,
+                  vfloat layer)
+{
+  vfloat c1_sq = v_channel (in,    1) * v_channel (in,    1) +
+                 v_channel (in,    2) * v_channel (in,    2);
+  vfloat c2_sq = v_channel (layer, 1) * v_channel (layer, 1) +
+                 v_channel (layer, 2) * v_channel (layer, 2);
+  vfloat ratio = v_sqrt (c2_sq / c1_sq);
+
+  return v_select (ab_lanes & (c1_sq > EPSILON * EPSILON), in * ratio, in);
+}
+
+static inline vfloat
+blend_lch_color (vfloat in,
+                 vfloat layer)
+{
+  return v_select (ab_lanes, layer, in);
+}
+
+static inline vfloat
+blend_lch_hue (vfloat in,
+               vfloat layer)
+{
+  vfloat c1_sq = v_channel (in,    1) * v_channel (in,    1) +
+                 v_channel (in,    2) * v_channel (in,    2);
+  vfloat c2_sq = v_channel (layer, 1) * v_channel (layer, 1) +
+                 v_channel (layer, 2) * v_channel (layer, 2);
+  vfloat ratio = v_sqrt (c1_sq / c2_sq);
+
+  return v_select (ab_lanes & (c2_sq > EPSILON * EPSILON), layer * ratio, in);
+}
+
+static inline vfloat
+blend_lch_lightness (vfloat in,
+                     vfloat layer)
+{
+  return v_select (ab_lanes, in, layer);
+}
+
+static inline vfloat
+blend_lighten_only (vfloat in,
+                    vfloat layer)
+{
+  return v_max (in, layer);
+}
+
+static inline vfloat
+blend_linear_burn (vfloat in,
+                   vfloat layer)
+{
+  return in + layer - 1.0f;
+}
+
+static inline vfloat
+blend_linear_light (vfloat in,
+                    vfloat layer)
+{
+  return v_select (layer <= 0.5f,
+                   in + 2.0f * layer - 1.0f,
+                   in + 2.0f * (layer - 0.5f));
+}
+
+static inline vfloat
+blend_multiply (vfloat in,
+                vfloat layer)
+{
+  return in * layer;
+}
+
+static inline vfloat
+blend_overlay (vfloat in,
+               vfloat layer)
+{
+  return v_select (in < 0.5f,
+                   2.0f * in * layer,
+                   1.0f - 2.0f * (1.0f - layer) * (1.0f - in));
+}
+
+static inline vfloat
+blend_pin_light (vfloat in,
+                 vfloat layer)
+{
+  return v_select (layer > 0.5f,
+                   v_max (in, 2.0f * (layer - 0.5f)),
+                   v_min (in, 2.0f * layer));
+}
+
+static inline vfloat
+blend_screen (vfloat in,
+              vfloat layer)
+{
+  return 1.0f - (1.0f - in) * (1.0f - layer);
+}
+
+static inline vfloat
+blend_softlight (vfloat in,
+                 vfloat layer)
+{
+  vfloat multiply = in * layer;
+  vfloat screen   = 1.0f - (1.0f - in) * (1.0f - layer);
+
+  return (1.0f - in) * multiply + in * screen;
+}
+
+static inline vfloat
+blend_subtract (vfloat in,
+                vfloat layer)
+{
+  return in - layer;
+}
+
+static inline vfloat
+blend_vivid_light (vfloat in,
+                   vfloat layer)
+{
+  vfloat low  = 1.0f - v_safe_div (1.0f - in, 2.0f * layer);
+  vfloat high = v_safe_div (in, 2.0f * (1.0f - layer));
+
+  low  = v_max (low,  v_splat (0.0f));
+  high = v_min (high, v_splat (1.0f));
+
+  return v_select (layer <= 0.5f, low, high);
+}
+
+#define DEFINE_BLEND_FUNC(name)                                              \
+static void                                                                  \
+blend_func_##name (GeglOperation *operation,                                 \
+                   const gfloat  *in,                                        \
+                   const gfloat  *layer,                                     \
+                   gfloat        *comp,                                      \
+                   gint           samples)                                   \
+{                                                                            \
+  for (; samples >= SIMD_N_PIXELS; samples -= SIMD_N_PIXELS)                 \
+    {                                                                        \
+      vfloat v_in    = v_load (in);                                          \
+      vfloat v_layer = v_load (layer);                                       \
+                                                                             \
+      /*  comp[ALPHA] is layer[ALPHA]  */                                    \
+      v_store (comp, v_select (alpha_lanes,                                  \
+                               v_layer, blend_##name (v_in, v_layer)));      \
+                                                                             \
+      in    += SIMD_WIDTH;                                                   \
+      layer += SIMD_WIDTH;                                                   \
+      comp  += SIMD_WIDTH;                                                   \
+    }                                                                        \
+                                                                             \
+  if (samples > 0)                                                           \
+    gimp_operation_layer_mode_blend_##name (operation, in, layer, comp,      \
+                                            samples);                        \
+}
+
+DEFINE_BLEND_FUNC (addition)
+DEFINE_BLEND_FUNC (burn)
+DEFINE_BLEND_FUNC (darken_only)
+DEFINE_BLEND_FUNC (difference)
+DEFINE_BLEND_FUNC (divide)
+DEFINE_BLEND_FUNC (dodge)
+DEFINE_BLEND_FUNC (exclusion)
+DEFINE_BLEND_FUNC (grain_extract)
+DEFINE_BLEND_FUNC (grain_merge)
+DEFINE_BLEND_FUNC (hard_mix)
+DEFINE_BLEND_FUNC (hardlight)
+DEFINE_BLEND_FUNC (hsl_color)
+DEFINE_BLEND_FUNC (hsv_hue)
+DEFINE_BLEND_FUNC (hsv_saturation)
+DEFINE_BLEND_FUNC (hsv_value)
+DEFINE_BLEND_FUNC (lch_chroma)
+DEFINE_BLEND_FUNC (lch_color)
+DEFINE_BLEND_FUNC (lch_hue)
+DEFINE_BLEND_FUNC (lch_lightness)
+DEFINE_BLEND_FUNC (lighten_only)
+DEFINE_BLEND_FUNC (linear_burn)
+DEFINE_BLEND_FUNC (linear_light)
+DEFINE_BLEND_FUNC (multiply)
+DEFINE_BLEND_FUNC (overlay)
+DEFINE_BLEND_FUNC (pin_light)
+DEFINE_BLEND_FUNC (screen)
+DEFINE_BLEND_FUNC (softlight)
+DEFINE_BLEND_FUNC (subtract)
+DEFINE_BLEND_FUNC (vivid_light)
+
+#undef DEFINE_BLEND_FUNC
+
+
+/*  public functions  */
+
+/*  returns the vectorized version of blend_function, or NULL if there is
+ *  none.
+ */
+GimpLayerModeBlendFunc
+SIMD_FUNC (gimp_operation_layer_mode_blend_get) (GimpLayerModeBlendFunc blend_function)
+{
+#define BLEND_FUNC(name) { gimp_operation_layer_mode_blend_##name, \
+                           blend_func_##name }
+
+  static const struct
+  {
+    GimpLayerModeBlendFunc func;
+    GimpLayerModeBlendFunc simd_func;
+  }
+  blend_funcs[] =
+  {
+    BLEND_FUNC (addition),
+    BLEND_FUNC (burn),
+    BLEND_FUNC (darken_only),
+    BLEND_FUNC (difference),
+    BLEND_FUNC (divide),
+    BLEND_FUNC (dodge),
+    BLEND_FUNC (exclusion),
+    BLEND_FUNC (grain_extract),
+    BLEND_FUNC (grain_merge),
+    BLEND_FUNC (hard_mix),
+    BLEND_FUNC (hardlight),
+    BLEND_FUNC (hsl_color),
+    BLEND_FUNC (hsv_hue),
+    BLEND_FUNC (hsv_saturation),
+    BLEND_FUNC (hsv_value),
+    BLEND_FUNC (lch_chroma),
+    BLEND_FUNC (lch_color),
+    BLEND_FUNC (lch_hue),
+    BLEND_FUNC (lch_lightness),
+    BLEND_FUNC (lighten_only),
+    BLEND_FUNC (linear_burn),
+    BLEND_FUNC (linear_light),
+    BLEND_FUNC (multiply),
+    BLEND_FUNC (overlay),
+    BLEND_FUNC (pin_light),
+    BLEND_FUNC (screen),
+    BLEND_FUNC (softlight),
+    BLEND_FUNC (subtract),
+    BLEND_FUNC (vivid_light)
+  };
+
+#undef BLEND_FUNC
+
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (blend_funcs); i++)
+    {
+      if (blend_funcs[i].func == blend_function)
+        return blend_funcs[i].simd_func;
+    }
+
+  return NULL;
+}
+
+
+/*  non-subtractive compositing functions.  these functions expect comp[ALPHA]
+ *  to be the same as layer[ALPHA].  when in[ALPHA] or layer[ALPHA] are zero,
+ *  the value of comp[RED..BLUE] is unconstrained (in particular, it may be
+ *  NaN).
+ */
+
+void
+SIMD_FUNC (gimp_operation_layer_mode_composite_union) (const gfloat *in,
+                                                       const gfloat *layer,
+                                                       const gfloat *comp,
+                                                       const gfloat *mask,
+                                                       gfloat        opacity,
+                                                       gfloat       *out,
+                                                       gint          samples)
+{
+  const vfloat v_opacity = v_splat (opacity);
+
+  for (; samples >= SIMD_N_PIXELS; samples -= SIMD_N_PIXELS)
+    {
+      vfloat v_in        = v_load (in);
+      vfloat v_layer     = v_load (layer);
+      vfloat v_comp      = v_load (comp);
+      vfloat in_alpha    = v_alpha (v_in);
+      vfloat layer_alpha = v_alpha (v_layer) * v_opacity;
+      vfloat new_alpha;
+      vfloat ratio;
+      vfloat result;
+
+      if (mask)
+        layer_alpha *= v_mask (mask);
+
+      new_alpha = layer_alpha + (1.0f - layer_alpha) * in_alpha;
+      ratio     = layer_alpha / new_alpha;
+
+      result = ratio * (in_alpha * (v_comp - v_layer) + v_layer - v_in) + v_in;
+      result = v_select (in_alpha == 0.0f, v_layer, result);
+      result = v_select ((layer_alpha == 0.0f) | (new_alpha == 0.0f),
+                         v_in, result);
+
+      v_store (out, v_select (alpha_lanes, new_alpha, result));
+
+      in    += SIMD_WIDTH;
+      layer += SIMD_WIDTH;
+      comp  += SIMD_WIDTH;
+      out   += SIMD_WIDTH;
+
+      if (mask)
+        mask += SIMD_N_PIXELS;
+    }
+
+  if (samples > 0)
+    gimp_operation_layer_mode_composite_union (in, layer, comp, mask, opacity,
+                                               out, samples);
+}
+
+void
+SIMD_FUNC (gimp_operation_layer_mode_composite_clip_to_backdrop) (const gfloat *in,
+                                                                  const gfloat *layer,
+                                                                  const gfloat *comp,
+                                                                  const gfloat *mask,
+                                                                  gfloat        opacity,
+                                                                  gfloat       *out,
+                                                                  gint          samples)
+{
+  const vfloat v_opacity = v_splat (opacity);
+
+  for (; samples >= SIMD_N_PIXELS; samples -= SIMD_N_PIXELS)
+    {
+      vfloat v_in        = v_load (in);
+      vfloat v_comp      = v_load (comp);
+      vfloat in_alpha    = v_alpha (v_in);
+      vfloat layer_alpha = v_alpha (v_comp) * v_opacity;
+      vfloat result;
+
+      if (mask)
+        layer_alpha *= v_mask (mask);
+
+      result = v_comp * layer_alpha + v_in * (1.0f - layer_alpha);
+      result = v_select ((in_alpha == 0.0f) | (layer_alpha == 0.0f),
+                         v_in, result);
+
+      v_store (out, v_select (alpha_lanes, in_alpha, result));
+
+      in    += SIMD_WIDTH;
+      layer += SIMD_WIDTH;
+      comp  += SIMD_WIDTH;
+      out   += SIMD_WIDTH;
+
+      if (mask)
+        mask += SIMD_N_PIXELS;
+    }
+
+  if (samples > 0)
+    gimp_operation_layer_mode_composite_clip_to_backdrop (in, layer, comp,
+                                                          mask, opacity, out,
+                                                          samples);
+}
+
+void
+SIMD_FUNC (gimp_operation_layer_mode_composite_clip_to_layer) (const gfloat *in,
+                                                               const gfloat *layer,
+                                                               const gfloat *comp,
+                                                               const gfloat *mask,
+                                                               gfloat        opacity,
+                                                               gfloat       *out,
+                                                               gint          samples)
+{
+  const vfloat v_opacity = v_splat (opacity);
+
+  for (; samples >= SIMD_N_PIXELS; samples -= SIMD_N_PIXELS)
+    {
+      vfloat v_in        = v_load (in);
+      vfloat v_layer     = v_load (layer);
+      vfloat v_comp      = v_load (comp);
+      vfloat in_alpha    = v_alpha (v_in);
+      vfloat layer_alpha = v_alpha (v_layer) * v_opacity;
+      vfloat result;
+
+      if (mask)
+        layer_alpha *= v_mask (mask);
+
+      result = v_comp * in_alpha + v_layer * (1.0f - in_alpha);
+      result = v_select (in_alpha == 0.0f, v_layer, result);
+      result = v_select (layer_alpha == 0.0f, v_in, result);
+
+      v_store (out, v_select (alpha_lanes, layer_alpha, result));
+
+      in    += SIMD_WIDTH;
+      layer += SIMD_WIDTH;
+      comp  += SIMD_WIDTH;
+      out   += SIMD_WIDTH;
+
+      if (mask)
+        mask += SIMD_N_PIXELS;
+    }
+
+  if (samples > 0)
+    gimp_operation_layer_mode_composite_clip_to_layer (in, layer, comp,
+                                                       mask, opacity, out,
+                                                       samples);
+}
+
+void
+SIMD_FUNC (gimp_operation_layer_mode_composite_intersection) (const gfloat *in,
+                                                              const gfloat *layer,
+                                                              const gfloat *comp,
+                                                              const gfloat *mask,
+                                                              gfloat        opacity,
+                                                              gfloat       *out,
+                                                              gint          samples)
+{
+  const vfloat v_opacity = v_splat (opacity);
+
+  for (; samples >= SIMD_N_PIXELS; samples -= SIMD_N_PIXELS)
+    {
+      vfloat v_in      = v_load (in);
+      vfloat v_comp    = v_load (comp);
+      vfloat new_alpha = v_alpha (v_in) * v_alpha (v_comp) * v_opacity;
+      vfloat result;
+
+      if (mask)
+        new_alpha *= v_mask (mask);
+
+      result = v_select (new_alpha == 0.0f, v_in, v_comp);
+
+      v_store (out, v_select (alpha_lanes, new_alpha, result));
+
+      in    += SIMD_WIDTH;
+      layer += SIMD_WIDTH;
+      comp  += SIMD_WIDTH;
+      out   += SIMD_WIDTH;
+
+      if (mask)
+        mask += SIMD_N_PIXELS;
+    }
+
+  if (samples > 0)
+    gimp_operation_layer_mode_composite_intersection (in, layer, comp,
+                                                      mask, opacity, out,
+                                                      samples);
+}
+
+/*  subtractive compositing functions.  these functions expect comp[ALPHA] to
+ *  specify the modified alpha of the overlapping content, as a fraction of the
+ *  original overlapping content (i.e., an alpha of 1.0 specifies that no
+ *  content is subtracted.)  when in[ALPHA] or layer[ALPHA] are zero, the value
+ *  of comp[RED..BLUE] is unconstrained (in particular, it may be NaN).
+ */
+
+void
+SIMD_FUNC (gimp_operation_layer_mode_composite_union_sub) (const gfloat *in,
+                                                           const gfloat *layer,
+                                                           const gfloat *comp,
+                                                           const gfloat *mask,
+                                                           gfloat        opacity,
+                                                           gfloat       *out,
+                                                           gint          samples)
+{
+  const vfloat v_opacity = v_splat (opacity);
+
+  for (; samples >= SIMD_N_PIXELS; samples -= SIMD_N_PIXELS)
+    {
+      vfloat v_in        = v_load (in);
+      vfloat v_layer     = v_load (layer);
+      vfloat v_comp      = v_load (comp);
+      vfloat in_alpha    = v_alpha (v_in);
+      vfloat layer_alpha = v_alpha (v_layer) * v_opacity;
+      vfloat comp_alpha  = v_alpha (v_comp);
+      vfloat new_alpha;
+      vfloat ratio;
+      vfloat layer_coeff;
+      vfloat result;
+
+      if (mask)
+        layer_alpha *= v_mask (mask);
+
+      new_alpha = in_alpha + layer_alpha -
+                  (2.0f - comp_alpha) * in_alpha * layer_alpha;
+
+      ratio       = in_alpha / new_alpha;
+      layer_coeff = 1.0f / in_alpha - 1.0f;
+
+      result = ratio * (layer_alpha * (comp_alpha * v_comp +
+                                       layer_coeff * v_layer - v_in) + v_in);
+      result = v_select (in_alpha == 0.0f, v_layer, result);
+      result = v_select ((layer_alpha == 0.0f) | (new_alpha == 0.0f),
+                         v_in, result);
+
+      v_store (out, v_select (alpha_lanes, new_alpha, result));
+
+      in    += SIMD_WIDTH;
+      layer += SIMD_WIDTH;
+      comp  += SIMD_WIDTH;
+      out   += SIMD_WIDTH;
+
+      if (mask)
+        mask += SIMD_N_PIXELS;
+    }
+
+  if (samples > 0)
+    gimp_operation_layer_mode_composite_union_sub (in, layer, comp, mask,
+                                                   opacity, out, samples);
+}
+
+void
+SIMD_FUNC (gimp_operation_layer_mode_composite_clip_to_backdrop_sub) (const gfloat *in,
+                                                                      const gfloat *layer,
+                                                                      const gfloat *comp,
+                                                                      const gfloat *mask,
+                                                                      gfloat        opacity,
+                                                                      gfloat       *out,
+                                                                      gint          samples)
+{
+  const vfloat v_opacity = v_splat (opacity);
+
+  for (; samples >= SIMD_N_PIXELS; samples -= SIMD_N_PIXELS)
+    {
+      vfloat v_in        = v_load (in);
+      vfloat v_layer     = v_load (layer);
+      vfloat v_comp      = v_load (comp);
+      vfloat in_alpha    = v_alpha (v_in);
+      vfloat layer_alpha = v_alpha (v_layer) * v_opacity;
+      vfloat comp_alpha;
+      vfloat new_alpha;
+      vfloat ratio;
+      vfloat result;
+
+      if (mask)
+        layer_alpha *= v_mask (mask);
+
+      comp_alpha = v_alpha (v_comp) * layer_alpha;
+      new_alpha  = 1.0f - layer_alpha + comp_alpha;
+      ratio      = comp_alpha / new_alpha;
+
+      result = v_comp * ratio + v_in * (1.0f - ratio);
+      result = v_select ((in_alpha == 0.0f) | (comp_alpha == 0.0f),
+                         v_in, result);
+
+      v_store (out, v_select (alpha_lanes, new_alpha * in_alpha, result));
+
+      in    += SIMD_WIDTH;
+      layer += SIMD_WIDTH;
+      comp  += SIMD_WIDTH;
+      out   += SIMD_WIDTH;
+
+      if (mask)
+        mask += SIMD_N_PIXELS;
+    }
+
+  if (samples > 0)
+    gimp_operation_layer_mode_composite_clip_to_backdrop_sub (in, layer, comp,
+                                                              mask, opacity,
+                                                              out, samples);
+}
+
+void
+SIMD_FUNC (gimp_operation_layer_mode_composite_clip_to_layer_sub) (const gfloat *in,
+                                                                   const gfloat *layer,
+                                                                   const gfloat *comp,
+                                                                   const gfloat *mask,
+                                                                   gfloat        opacity,
+                                                                   gfloat       *out,
+                                                                   gint          samples)
+{
+  const vfloat v_opacity = v_splat (opacity);
+
+  for (; samples >= SIMD_N_PIXELS; samples -= SIMD_N_PIXELS)
+    {
+      vfloat v_in        = v_load (in);
+      vfloat v_layer     = v_load (layer);
+      vfloat v_comp      = v_load (comp);
+      vfloat in_alpha    = v_alpha (v_in);
+      vfloat layer_alpha = v_alpha (v_layer) * v_opacity;
+      vfloat comp_alpha;
+      vfloat new_alpha;
+      vfloat ratio;
+      vfloat result;
+
+      if (mask)
+        layer_alpha *= v_mask (mask);
+
+      comp_alpha = v_alpha (v_comp) * in_alpha;
+      new_alpha  = 1.0f - in_alpha + comp_alpha;
+      ratio      = comp_alpha / new_alpha;
+
+      result = v_comp * ratio + v_layer * (1.0f - ratio);
+      result = v_select (in_alpha == 0.0f, v_layer, result);
+      result = v_select (layer_alpha == 0.0f, v_in, result);
+
+      v_store (out, v_select (alpha_lanes, new_alpha * layer_alpha, result));
+
+      in    += SIMD_WIDTH;
+      layer += SIMD_WIDTH;
+      comp  += SIMD_WIDTH;
+      out   += SIMD_WIDTH;
+
+      if (mask)
+        mask += SIMD_N_PIXELS;
+    }
+
+  if (samples > 0)
+    gimp_operation_layer_mode_composite_clip_to_layer_sub (in, layer, comp,
+                                                           mask, opacity,
+                                                           out, samples);
+}
+
+void
+SIMD_FUNC (gimp_operation_layer_mode_composite_intersection_sub) (const gfloat *in,
+                                                                  const gfloat *layer,
+                                                                  const gfloat *comp,
+                                                                  const gfloat *mask,
+                                                                  gfloat        opacity,
+                                                                  gfloat       *out,
+                                                                  gint          samples)
+{
+  const vfloat v_opacity = v_splat (opacity);
+
+  for (; samples >= SIMD_N_PIXELS; samples -= SIMD_N_PIXELS)
+    {
+      vfloat v_in      = v_load (in);
+      vfloat v_layer   = v_load (layer);
+      vfloat v_comp    = v_load (comp);
+      vfloat new_alpha = v_alpha (v_in) * v_alpha (v_layer) *
+                         v_alpha (v_comp) * v_opacity;
+      vfloat result;
+
+      if (mask)
+        new_alpha *= v_mask (mask);
+
+      result = v_select (new_alpha == 0.0f, v_in, v_comp);
+
+      v_store (out, v_select (alpha_lanes, new_alpha, result));
+
+      in    += SIMD_WIDTH;
+      layer += SIMD_WIDTH;
+      comp  += SIMD_WIDTH;
+      out   += SIMD_WIDTH;
+
+      if (mask)
+        mask += SIMD_N_PIXELS;
+    }
+
+  if (samples > 0)
+    gimp_operation_layer_mode_composite_intersection_sub (in, layer, comp,
+                                                          mask, opacity,
+                                                          out, samples);
+}
@@ -21,6 +21,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <gegl-plugin.h>
 #include <cairo.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
@@ -29,9 +31,15 @@
 
 #include "../operations-types.h"
 
+#include "gegl/gimp-gegl-profile.h"
+#include "gegl/gimpopaquetiles.h"
+
 #include "gimp-layer-modes.h"
 #include "gimpoperationlayermode.h"
+#include "gimpoperationlayermode-blend.h"
 #include "gimpoperationlayermode-composite.h"
+#include "gimpoperationlayermode-fused.h"
+#include "gimpoperationlayermode-cl.h"
 
 
 /* the maximum number of samples to process in one go.  used to limit
@@ -55,7 +63,8 @@ enum
   PROP_OPACITY,
   PROP_BLEND_SPACE,
   PROP_COMPOSITE_SPACE,
-  PROP_COMPOSITE_MODE
+  PROP_COMPOSITE_MODE,
+  PROP_OPAQUE_TILES
 };
 
 
@@ -67,6 +76,8 @@ typedef void (* CompositeFunc) (const gfloat *in,
                                 gfloat       *out,
                                 gint          samples);
 
+typedef GimpLayerModeBlendFunc (* BlendFuncGetFunc) (GimpLayerModeBlendFunc blend_function);
+
 
 static void            gimp_operation_layer_mode_finalize            (GObject                *object);
 static void            gimp_operation_layer_mode_set_property        (GObject                *object,
@@ -80,6 +91,10 @@ static void            gimp_operation_layer_mode_get_property        (GObject
 
 static void            gimp_operation_layer_mode_prepare             (GeglOperation          *operation);
 static GeglRectangle   gimp_operation_layer_mode_get_bounding_box    (GeglOperation          *operation);
+static GeglRectangle   gimp_operation_layer_mode_get_required_for_output
+                                                                     (GeglOperation          *operation,
+                                                                      const gchar            *input_pad,
+                                                                      const GeglRectangle    *roi);
 static gboolean        gimp_operation_layer_mode_parent_process      (GeglOperation          *operation,
                                                                       GeglOperationContext   *context,
                                                                       const gchar            *output_prop,
@@ -94,6 +109,14 @@ static gboolean        gimp_operation_layer_mode_process             (GeglOperat
                                                                       glong                   samples,
                                                                       const GeglRectangle    *roi,
                                                                       gint                    level);
+static gboolean        gimp_operation_layer_mode_cl_process          (GeglOperation          *operation,
+                                                                      cl_mem                  in_tex,
+                                                                      cl_mem                  layer_tex,
+                                                                      cl_mem                  mask_tex,
+                                                                      cl_mem                  out_tex,
+                                                                      size_t                  global_worksize,
+                                                                      const GeglRectangle    *roi,
+                                                                      gint                    level);
 
 static gboolean        gimp_operation_layer_mode_real_parent_process (GeglOperation          *operation,
                                                                       GeglOperationContext   *context,
@@ -118,12 +141,17 @@ static gboolean        process_last_node                             (GeglOperat
                                                                       const GeglRectangle *roi,
                                                                       gint                 level);
 
+static gboolean        gimp_operation_layer_mode_is_occluding        (GimpOperationLayerMode  *op,
+                                                                      const GeglRectangle     *roi);
+
 static void            gimp_operation_layer_mode_cache_fishes        (GimpOperationLayerMode  *op,
                                                                       const Babl              *preferred_format,
                                                                       const Babl             **out_format,
                                                                       const Babl             **composite_to_blend_fish,
                                                                       const Babl             **blend_to_composite_fish);
 
+static void            gimp_operation_layer_mode_select_functions    (gboolean                 vectorized);
+
 
 G_DEFINE_TYPE (GimpOperationLayerMode, gimp_operation_layer_mode,
                GEGL_TYPE_OPERATION_POINT_COMPOSER3)
@@ -140,6 +168,11 @@ static CompositeFunc composite_clip_to_backdrop_sub = gimp_operation_layer_mode_
 static CompositeFunc composite_clip_to_layer_sub    = gimp_operation_layer_mode_composite_clip_to_layer_sub;
 static CompositeFunc composite_intersection_sub     = gimp_operation_layer_mode_composite_intersection_sub;
 
+/* returns the vectorized version of a blend function, if any */
+static BlendFuncGetFunc get_simd_blend_function     = NULL;
+
+static GimpLayerModePath layer_mode_path            = GIMP_LAYER_MODE_PATH_DEFAULT;
+
 
 static void
 gimp_operation_layer_mode_class_init (GimpOperationLayerModeClass *klass)
@@ -159,7 +192,13 @@ gimp_operation_layer_mode_class_init (GimpOperationLayerModeClass *klass)
   operation_class->get_bounding_box = gimp_operation_layer_mode_get_bounding_box;
   operation_class->process          = gimp_operation_layer_mode_parent_process;
 
+  operation_class->get_required_for_output =
+    gimp_operation_layer_mode_get_required_for_output;
+
   point_composer3_class->process    = gimp_operation_layer_mode_process;
+  point_composer3_class->cl_process = gimp_operation_layer_mode_cl_process;
+
+  operation_class->opencl_support   = TRUE;
 
   klass->parent_process             = gimp_operation_layer_mode_real_parent_process;
   klass->process                    = gimp_operation_layer_mode_real_process;
@@ -205,11 +244,13 @@ gimp_operation_layer_mode_class_init (GimpOperationLayerModeClass *klass)
                                                       GIMP_PARAM_READWRITE |
                                                       G_PARAM_CONSTRUCT));
 
+  g_object_class_install_property (object_class, PROP_OPAQUE_TILES,
+                                   g_param_spec_boxed ("opaque-tiles",
+                                                       NULL, NULL,
+                                                       GIMP_TYPE_OPAQUE_TILES,
+                                                       GIMP_PARAM_READWRITE));
 
-#if COMPILE_SSE2_INTRINISICS
-  if (gimp_cpu_accel_get_support () & GIMP_CPU_ACCEL_X86_SSE2)
-    composite_clip_to_backdrop = gimp_operation_layer_mode_composite_clip_to_backdrop_sse2;
-#endif
+  gimp_operation_layer_mode_select_functions (TRUE);
 }
 
 static void
@@ -225,6 +266,8 @@ gimp_operation_layer_mode_finalize (GObject *object)
 
   g_rw_lock_clear (&mode->cache_lock);
 
+  g_clear_pointer (&mode->opaque_tiles, gimp_opaque_tiles_unref);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -258,6 +301,11 @@ gimp_operation_layer_mode_set_property (GObject      *object,
       self->prop_composite_mode = g_value_get_enum (value);
       break;
 
+    case PROP_OPAQUE_TILES:
+      g_clear_pointer (&self->opaque_tiles, gimp_opaque_tiles_unref);
+      self->opaque_tiles = g_value_dup_boxed (value);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -294,6 +342,10 @@ gimp_operation_layer_mode_get_property (GObject    *object,
       g_value_set_enum (value, self->prop_composite_mode);
       break;
 
+    case PROP_OPAQUE_TILES:
+      g_value_set_boxed (value, self->opaque_tiles);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -308,6 +360,7 @@ gimp_operation_layer_mode_prepare (GeglOperation *operation)
   const GeglRectangle    *mask_extent;
   const Babl             *preferred_format;
   const Babl             *format;
+  const Babl             *composite_to_blend_fish = NULL;
 
   self->composite_mode = self->prop_composite_mode;
 
@@ -321,6 +374,8 @@ gimp_operation_layer_mode_prepare (GeglOperation *operation)
 
   self->function       = gimp_layer_mode_get_function       (self->layer_mode);
   self->blend_function = gimp_layer_mode_get_blend_function (self->layer_mode);
+  self->fused_funcs    = NULL;
+  self->cl_blend       = -1;
 
   input_extent = gegl_operation_source_get_bounding_box (operation, "input");
   mask_extent  = gegl_operation_source_get_bounding_box (operation, "aux2");
@@ -360,7 +415,65 @@ gimp_operation_layer_mode_prepare (GeglOperation *operation)
 
   self->has_mask = mask_extent && ! gegl_rectangle_is_empty (mask_extent);
 
-  gimp_operation_layer_mode_cache_fishes (self, preferred_format, &format, NULL, NULL);
+  if (self->blend_function)
+    {
+      GimpLayerModeBlendFunc simd_blend_function = NULL;
+
+      if (layer_mode_path == GIMP_LAYER_MODE_PATH_DEFAULT &&
+          ! gimp_layer_mode_is_subtractive (self->layer_mode))
+        {
+          self->cl_blend =
+            gimp_operation_layer_mode_cl_get_blend (self->blend_function);
+        }
+
+      if (get_simd_blend_function)
+        simd_blend_function = get_simd_blend_function (self->blend_function);
+
+      /*  the vectorized blend and composite functions are faster than
+       *  the fused loops, which in turn beat the plain two passes
+       */
+      if (simd_blend_function)
+        {
+          self->blend_function = simd_blend_function;
+        }
+      else if (layer_mode_path != GIMP_LAYER_MODE_PATH_REFERENCE &&
+               ! gimp_layer_mode_is_subtractive (self->layer_mode))
+        {
+          self->fused_funcs =
+            gimp_operation_layer_mode_get_fused_funcs (self->blend_function,
+                                                       self->composite_mode);
+        }
+    }
+
+  gimp_operation_layer_mode_cache_fishes (self, preferred_format, &format,
+                                          &composite_to_blend_fish, NULL);
+
+  /*  only the plain per-channel modes, blending and compositing in the
+   *  same space, have a kernel.  don't let GEGL upload the buffers for
+   *  any other mode, only to fall back to the CPU.
+   */
+  if (self->function != gimp_operation_layer_mode_real_process ||
+      self->is_last_node                                       ||
+      composite_to_blend_fish)
+    {
+      self->cl_blend = -1;
+    }
+
+  if (operation->node && gegl_cl_is_accelerated ())
+    {
+      gboolean use_opencl;
+
+      g_object_get (operation->node,
+                    "use-opencl", &use_opencl,
+                    NULL);
+
+      if (use_opencl != (self->cl_blend >= 0))
+        {
+          g_object_set (operation->node,
+                        "use-opencl", self->cl_blend >= 0,
+                        NULL);
+        }
+    }
 
   gegl_operation_set_format (operation, "input",  format);
   gegl_operation_set_format (operation, "output", format);
@@ -419,6 +532,24 @@ gimp_operation_layer_mode_get_bounding_box (GeglOperation *op)
   return result;
 }
 
+static GeglRectangle
+gimp_operation_layer_mode_get_required_for_output (GeglOperation       *operation,
+                                                   const gchar         *input_pad,
+                                                   const GeglRectangle *roi)
+{
+  GimpOperationLayerMode *self = GIMP_OPERATION_LAYER_MODE (operation);
+
+  /*  don't render the layers below at all, where we cover them  */
+  if (! strcmp (input_pad, "input") &&
+      gimp_operation_layer_mode_is_occluding (self, roi))
+    {
+      return *GEGL_RECTANGLE (0, 0, 0, 0);
+    }
+
+  return GEGL_OPERATION_CLASS (parent_class)->get_required_for_output (
+    operation, input_pad, roi);
+}
+
 static gboolean
 gimp_operation_layer_mode_parent_process (GeglOperation        *operation,
                                           GeglOperationContext *context,
@@ -427,6 +558,7 @@ gimp_operation_layer_mode_parent_process (GeglOperation        *operation,
                                           gint                  level)
 {
   GimpOperationLayerMode *point = GIMP_OPERATION_LAYER_MODE (operation);
+  gboolean                success;
 
   point->opacity = point->prop_opacity;
 
@@ -453,8 +585,12 @@ gimp_operation_layer_mode_parent_process (GeglOperation        *operation,
         point->opacity = 0.0;
     }
 
-  return GIMP_OPERATION_LAYER_MODE_GET_CLASS (point)->parent_process (
+  success = GIMP_OPERATION_LAYER_MODE_GET_CLASS (point)->parent_process (
     operation, context, output_prop, result, level);
+
+  gimp_gegl_profile_mark (operation, result);
+
+  return success;
 }
 
 static gboolean
@@ -471,6 +607,31 @@ gimp_operation_layer_mode_process (GeglOperation       *operation,
     operation, in, layer, mask, out, samples, roi, level);
 }
 
+static gboolean
+gimp_operation_layer_mode_cl_process (GeglOperation       *operation,
+                                      cl_mem               in_tex,
+                                      cl_mem               layer_tex,
+                                      cl_mem               mask_tex,
+                                      cl_mem               out_tex,
+                                      size_t               global_worksize,
+                                      const GeglRectangle *roi,
+                                      gint                 level)
+{
+  GimpOperationLayerMode *layer_mode = (gpointer) operation;
+
+  /*  prepare() only enables OpenCL for the modes that have a kernel, see
+   *  there.  returning TRUE makes GEGL fall back to the CPU.
+   */
+  if (layer_mode->cl_blend < 0 || ! in_tex || ! layer_tex)
+    return TRUE;
+
+  return gimp_operation_layer_mode_cl_blend (layer_mode->cl_blend,
+                                             layer_mode->composite_mode,
+                                             layer_mode->opacity,
+                                             in_tex, layer_tex, mask_tex,
+                                             out_tex, global_worksize);
+}
+
 static gboolean
 gimp_operation_layer_mode_real_parent_process (GeglOperation        *operation,
                                                GeglOperationContext *context,
@@ -489,6 +650,15 @@ gimp_operation_layer_mode_real_parent_process (GeglOperation        *operation,
   input = gegl_operation_context_get_object (context, "input");
   aux   = gegl_operation_context_get_object (context, "aux");
 
+  /* if 'aux' is opaque all over the roi, 'input' wasn't even rendered,
+   * and 'aux' is the output.
+   */
+  if (aux && gimp_operation_layer_mode_is_occluding (point, result))
+    {
+      gegl_operation_context_set_object (context, "output", aux);
+      return TRUE;
+    }
+
   /* disregard 'input' if it's not included in the roi. */
   has_input =
     input &&
@@ -670,6 +840,20 @@ gimp_operation_layer_mode_real_process (GeglOperation       *operation,
                                           &composite_to_blend_fish,
                                           &blend_to_composite_fish);
 
+  /* if blending and compositing happen in the same space, do both in one
+   * go if we can.
+   */
+  if (! composite_to_blend_fish && layer_mode->fused_funcs)
+    {
+      GimpLayerModeFusedFunc fused_func;
+
+      fused_func = layer_mode->fused_funcs->func[mask != NULL][opacity != 1.0f];
+
+      fused_func (in, layer, mask, opacity, out, samples);
+
+      return TRUE;
+    }
+
   /* if we need to convert the samples between the composite and blend
    * spaces...
    */
@@ -872,6 +1056,52 @@ process_last_node (GeglOperation       *operation,
   return TRUE;
 }
 
+/* returns whether the layer fully replaces the backdrop over 'roi', in
+ * which case the backdrop doesn't need to be rendered.  this only
+ * depends on the op's properties and on the layer's opaque tiles, so
+ * that it's the same when requesting the input and when processing.
+ */
+static gboolean
+gimp_operation_layer_mode_is_occluding (GimpOperationLayerMode *op,
+                                        const GeglRectangle    *roi)
+{
+  const GeglRectangle *aux_rect;
+  GeglRectangle        rect;
+
+  if (! op->opaque_tiles       ||
+      op->prop_opacity != 1.0  ||
+      op->has_mask             ||
+      op->is_last_node)
+    {
+      return FALSE;
+    }
+
+  if (op->layer_mode != GIMP_LAYER_MODE_NORMAL &&
+      op->layer_mode != GIMP_LAYER_MODE_NORMAL_LEGACY)
+    {
+      return FALSE;
+    }
+
+  if (op->composite_mode != GIMP_LAYER_COMPOSITE_UNION &&
+      op->composite_mode != GIMP_LAYER_COMPOSITE_CLIP_TO_LAYER)
+    {
+      return FALSE;
+    }
+
+  aux_rect = gegl_operation_source_get_bounding_box (GEGL_OPERATION (op),
+                                                     "aux");
+
+  if (! aux_rect || ! gegl_rectangle_contains (aux_rect, roi))
+    return FALSE;
+
+  /* the opaque tiles are in the coordinates of the layer's buffer */
+  rect    = *roi;
+  rect.x -= aux_rect->x;
+  rect.y -= aux_rect->y;
+
+  return gimp_opaque_tiles_covers (op->opaque_tiles, &rect);
+}
+
 static void
 gimp_operation_layer_mode_cache_fishes (GimpOperationLayerMode  *op,
                                         const Babl              *preferred_format,
@@ -1031,6 +1261,82 @@ gimp_operation_layer_mode_cache_fishes (GimpOperationLayerMode  *op,
     g_rw_lock_reader_unlock (&op->cache_lock);
 }
 
+static void
+gimp_operation_layer_mode_select_functions (gboolean vectorized)
+{
+  composite_union                = gimp_operation_layer_mode_composite_union;
+  composite_clip_to_backdrop     = gimp_operation_layer_mode_composite_clip_to_backdrop;
+  composite_clip_to_layer        = gimp_operation_layer_mode_composite_clip_to_layer;
+  composite_intersection         = gimp_operation_layer_mode_composite_intersection;
+
+  composite_union_sub            = gimp_operation_layer_mode_composite_union_sub;
+  composite_clip_to_backdrop_sub = gimp_operation_layer_mode_composite_clip_to_backdrop_sub;
+  composite_clip_to_layer_sub    = gimp_operation_layer_mode_composite_clip_to_layer_sub;
+  composite_intersection_sub     = gimp_operation_layer_mode_composite_intersection_sub;
+
+  get_simd_blend_function        = NULL;
+
+  if (! vectorized)
+    return;
+
+#if COMPILE_SSE2_INTRINISICS
+  if (gimp_cpu_accel_get_support () & GIMP_CPU_ACCEL_X86_SSE2)
+    composite_clip_to_backdrop = gimp_operation_layer_mode_composite_clip_to_backdrop_sse2;
+#endif
+
+  /*  the wider vectors win over the SSE2 function  */
+#if COMPILE_AVX2_INTRINISICS
+  if (gimp_cpu_accel_get_support () & GIMP_CPU_ACCEL_X86_AVX2)
+    {
+      composite_union            = gimp_operation_layer_mode_composite_union_avx2;
+      composite_clip_to_backdrop = gimp_operation_layer_mode_composite_clip_to_backdrop_avx2;
+      composite_clip_to_layer    = gimp_operation_layer_mode_composite_clip_to_layer_avx2;
+      composite_intersection     = gimp_operation_layer_mode_composite_intersection_avx2;
+
+      composite_union_sub            = gimp_operation_layer_mode_composite_union_sub_avx2;
+      composite_clip_to_backdrop_sub = gimp_operation_layer_mode_composite_clip_to_backdrop_sub_avx2;
+      composite_clip_to_layer_sub    = gimp_operation_layer_mode_composite_clip_to_layer_sub_avx2;
+      composite_intersection_sub     = gimp_operation_layer_mode_composite_intersection_sub_avx2;
+
+      get_simd_blend_function = gimp_operation_layer_mode_blend_get_avx2;
+    }
+#endif
+
+#if COMPILE_AVX512F_INTRINISICS
+  if (gimp_cpu_accel_get_support () & GIMP_CPU_ACCEL_X86_AVX512F)
+    {
+      composite_union            = gimp_operation_layer_mode_composite_union_avx512f;
+      composite_clip_to_backdrop = gimp_operation_layer_mode_composite_clip_to_backdrop_avx512f;
+      composite_clip_to_layer    = gimp_operation_layer_mode_composite_clip_to_layer_avx512f;
+      composite_intersection     = gimp_operation_layer_mode_composite_intersection_avx512f;
+
+      composite_union_sub            = gimp_operation_layer_mode_composite_union_sub_avx512f;
+      composite_clip_to_backdrop_sub = gimp_operation_layer_mode_composite_clip_to_backdrop_sub_avx512f;
+      composite_clip_to_layer_sub    = gimp_operation_layer_mode_composite_clip_to_layer_sub_avx512f;
+      composite_intersection_sub     = gimp_operation_layer_mode_composite_intersection_sub_avx512f;
+
+      get_simd_blend_function = gimp_operation_layer_mode_blend_get_avx512f;
+    }
+#endif
+
+#if COMPILE_NEON_INTRINISICS
+  if (gimp_cpu_accel_get_support () & GIMP_CPU_ACCEL_ARM_NEON)
+    {
+      composite_union            = gimp_operation_layer_mode_composite_union_neon;
+      composite_clip_to_backdrop = gimp_operation_layer_mode_composite_clip_to_backdrop_neon;
+      composite_clip_to_layer    = gimp_operation_layer_mode_composite_clip_to_layer_neon;
+      composite_intersection     = gimp_operation_layer_mode_composite_intersection_neon;
+
+      composite_union_sub            = gimp_operation_layer_mode_composite_union_sub_neon;
+      composite_clip_to_backdrop_sub = gimp_operation_layer_mode_composite_clip_to_backdrop_sub_neon;
+      composite_clip_to_layer_sub    = gimp_operation_layer_mode_composite_clip_to_layer_sub_neon;
+      composite_intersection_sub     = gimp_operation_layer_mode_composite_intersection_sub_neon;
+
+      get_simd_blend_function = gimp_operation_layer_mode_blend_get_neon;
+    }
+#endif
+}
+
 
 /*  public functions  */
 
@@ -1050,3 +1356,29 @@ gimp_operation_layer_mode_get_affected_region (GimpOperationLayerMode *layer_mod
 
   return GIMP_LAYER_COMPOSITE_REGION_INTERSECTION;
 }
+
+/*  selects the implementation of all the layer modes prepared from now
+ *  on, so that the tests can compare the faster ones against the plain
+ *  one.  must not be called while any layer mode is being processed.
+ */
+void
+gimp_operation_layer_mode_set_path (GimpLayerModePath path)
+{
+  GTypeClass *klass;
+
+  /*  make sure the class doesn't select the functions afterwards  */
+  klass = g_type_class_ref (GIMP_TYPE_OPERATION_LAYER_MODE);
+
+  layer_mode_path = path;
+
+  gimp_operation_layer_mode_select_functions (path ==
+                                              GIMP_LAYER_MODE_PATH_DEFAULT);
+
+  g_type_class_unref (klass);
+}
+
+GimpLayerModePath
+gimp_operation_layer_mode_get_path (void)
+{
+  return layer_mode_path;
+}
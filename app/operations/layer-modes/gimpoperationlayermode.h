@@ -33,26 +33,39 @@
 
 typedef struct _GimpOperationLayerModeClass GimpOperationLayerModeClass;
 
+/*  the implementations the blending and compositing may use, the default
+ *  being the fastest available.  the others are meant for testing.
+ */
+typedef enum
+{
+  GIMP_LAYER_MODE_PATH_DEFAULT,    /*  vectorized, fused or OpenCL  */
+  GIMP_LAYER_MODE_PATH_FUSED,      /*  the fused loops, if any      */
+  GIMP_LAYER_MODE_PATH_REFERENCE   /*  the plain, two-pass loops    */
+} GimpLayerModePath;
+
 struct _GimpOperationLayerMode
 {
-  GeglOperationPointComposer3  parent_instance;
-
-  GimpLayerMode                layer_mode;
-  gdouble                      opacity;
-  GimpLayerColorSpace          blend_space;
-  GimpLayerColorSpace          composite_space;
-  GimpLayerCompositeMode       composite_mode;
-  const Babl                  *cached_fish_format;
-  const Babl                  *space_fish[4 /* from */][4 /* to */];
-  GRWLock                      cache_lock;
-
-  gdouble                      prop_opacity;
-  GimpLayerCompositeMode       prop_composite_mode;
-
-  GimpLayerModeFunc            function;
-  GimpLayerModeBlendFunc       blend_function;
-  gboolean                     is_last_node;
-  gboolean                     has_mask;
+  GeglOperationPointComposer3    parent_instance;
+
+  GimpLayerMode                  layer_mode;
+  gdouble                        opacity;
+  GimpLayerColorSpace            blend_space;
+  GimpLayerColorSpace            composite_space;
+  GimpLayerCompositeMode         composite_mode;
+  const Babl                    *cached_fish_format;
+  const Babl                    *space_fish[4 /* from */][4 /* to */];
+  GRWLock                        cache_lock;
+
+  gdouble                        prop_opacity;
+  GimpLayerCompositeMode         prop_composite_mode;
+  GimpOpaqueTiles               *opaque_tiles;
+
+  GimpLayerModeFunc              function;
+  GimpLayerModeBlendFunc         blend_function;
+  const GimpLayerModeFusedFuncs *fused_funcs;
+  gint                           cl_blend;
+  gboolean                       is_last_node;
+  gboolean                       has_mask;
 };
 
 struct _GimpOperationLayerModeClass
@@ -85,3 +98,6 @@ struct _GimpOperationLayerModeClass
 GType                    gimp_operation_layer_mode_get_type            (void) G_GNUC_CONST;
 
 GimpLayerCompositeRegion gimp_operation_layer_mode_get_affected_region (GimpOperationLayerMode *layer_mode);
+
+void                     gimp_operation_layer_mode_set_path            (GimpLayerModePath       path);
+GimpLayerModePath        gimp_operation_layer_mode_get_path            (void);
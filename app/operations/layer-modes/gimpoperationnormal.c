@@ -27,6 +27,8 @@
 
 #include "../operations-types.h"
 
+#include "core/gimp-cpu-dispatch.h"
+
 #include "gimpoperationnormal.h"
 
 
@@ -57,6 +59,17 @@ gimp_operation_normal_class_init (GimpOperationNormalClass *klass)
   GeglOperationClass          *operation_class  = GEGL_OPERATION_CLASS (klass);
   GimpOperationLayerModeClass *layer_mode_class = GIMP_OPERATION_LAYER_MODE_CLASS (klass);
 
+  static const GimpCpuDispatchVariant process_variants[] =
+  {
+    { GIMP_CPU_ACCEL_NONE,       gimp_operation_normal_process      },
+#if COMPILE_SSE2_INTRINISICS
+    { GIMP_CPU_ACCEL_X86_SSE2,   gimp_operation_normal_process_sse2 },
+#endif
+#if COMPILE_SSE4_1_INTRINISICS
+    { GIMP_CPU_ACCEL_X86_SSE4_1, gimp_operation_normal_process_sse4 },
+#endif
+  };
+
   gegl_operation_class_set_keys (operation_class,
                                  "name",                  "gimp:normal",
                                  "description",           "GIMP normal mode operation",
@@ -64,17 +77,7 @@ gimp_operation_normal_class_init (GimpOperationNormalClass *klass)
                                  "reference-composition", reference_xml,
                                  NULL);
 
-  layer_mode_class->process = gimp_operation_normal_process;
-
-#if COMPILE_SSE2_INTRINISICS
-  if (gimp_cpu_accel_get_support() & GIMP_CPU_ACCEL_X86_SSE2)
-    layer_mode_class->process = gimp_operation_normal_process_sse2;
-#endif /* COMPILE_SSE2_INTRINISICS */
-
-#if COMPILE_SSE4_1_INTRINISICS
-  if (gimp_cpu_accel_get_support() & GIMP_CPU_ACCEL_X86_SSE4_1)
-    layer_mode_class->process = gimp_operation_normal_process_sse4;
-#endif /* COMPILE_SSE4_1_INTRINISICS */
+  layer_mode_class->process = GIMP_CPU_DISPATCH_SELECT (process_variants);
 }
 
 static void
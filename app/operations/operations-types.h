@@ -51,6 +51,7 @@ typedef struct _GimpThresholdConfig             GimpThresholdConfig;
 /*  non-object types  */
 
 typedef struct _GimpCagePoint                   GimpCagePoint;
+typedef struct _GimpLayerModeFusedFuncs         GimpLayerModeFusedFuncs;
 
 
 /*  functions  */
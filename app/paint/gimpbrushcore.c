@@ -152,6 +152,7 @@ gimp_brush_core_class_init (GimpBrushCoreClass *klass)
   klass->handles_changing_brush             = FALSE;
   klass->handles_transforming_brush         = TRUE;
   klass->handles_dynamic_transforming_brush = TRUE;
+  klass->handles_parallel_dabs              = FALSE;
 
   klass->set_brush                          = gimp_brush_core_real_set_brush;
   klass->set_dynamics                       = gimp_brush_core_real_set_dynamics;
@@ -475,6 +476,7 @@ gimp_brush_core_interpolate (GimpPaintCore    *paint_core,
   gdouble             dyn_spacing = core->spacing;
   gdouble             fade_point;
   gboolean            use_dyn_spacing;
+  gboolean            batch;
 
   g_return_if_fail (GIMP_IS_BRUSH (core->brush));
 
@@ -722,6 +724,15 @@ gimp_brush_core_interpolate (GimpPaintCore    *paint_core,
         }
     }
 
+  /*  paste the dabs of the segment in a batch, letting the ones that don't
+   *  overlap be pasted in parallel
+   */
+  batch = GIMP_BRUSH_CORE_GET_CLASS (core)->handles_parallel_dabs &&
+          num_points > 1;
+
+  if (batch)
+    gimp_paint_core_begin_paste_batch (paint_core);
+
   for (n = 0; n < num_points; n++)
     {
       gdouble t = t0 + n * dt;
@@ -783,6 +794,9 @@ gimp_brush_core_interpolate (GimpPaintCore    *paint_core,
                              GIMP_PAINT_STATE_MOTION, time);
     }
 
+  if (batch)
+    gimp_paint_core_end_paste_batch (paint_core);
+
   current_coords.x        = last_coords.x        + delta_vec.x;
   current_coords.y        = last_coords.y        + delta_vec.y;
   current_coords.pressure = last_coords.pressure + delta_pressure;
@@ -86,6 +86,11 @@ struct _GimpBrushCoreClass
   /*  Set for tools that don't mind if the brush scales mid stroke  */
   gboolean            handles_dynamic_transforming_brush;
 
+  /*  Set for tools whose dabs only paste to the canvas, without reading
+   *  it, so that the dabs of a segment can be pasted in parallel
+   */
+  gboolean            handles_parallel_dabs;
+
   void (* set_brush)    (GimpBrushCore *core,
                          GimpBrush     *brush);
   void (* set_dynamics) (GimpBrushCore *core,
@@ -49,6 +49,15 @@
 #include "gimp-intl.h"
 
 
+/* brushes at least this large, in either dimension, are healed using
+ * the multigrid solver
+ */
+#define MULTIGRID_MIN_SIZE 256
+
+#define PIXELS_PER_THREAD \
+  (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
+
+
 
 /* NOTES
  *
@@ -58,8 +67,8 @@
  * corrected, I1 is the reference pattern. Then we solve DeltaI=0
  * (Laplace) with I2 Dirichlet conditions at the borders of the
  * mask. The solver is a red/black checker Gauss-Seidel with over-relaxation.
- * It could benefit from a multi-grid evaluation of an initial solution
- * before the main iteration loop.
+ * For large brushes, the same system is solved with multigrid instead,
+ * see gimp_heal_multigrid_loop().
  *
  * I reduced the convergence criteria to 0.1% (0.001) as we are
  * dealing here with RGB integer components, more is overkill.
@@ -425,6 +434,381 @@ gimp_heal_laplace_loop (gfloat *pixels,
   g_free (Aidx);
 }
 
+/* Multigrid solver, used for large brushes, where Gauss-Seidel needs a
+ * number of iterations proportional to the brush size to converge.  The
+ * same system is solved with V-cycles: a few red/black Gauss-Seidel
+ * sweeps smooth out the high frequencies of the error, and the rest is
+ * solved for on a grid of half the resolution, recursively.
+ *
+ * Each equation reads  a * x - sum (neighbors) = b,  where a is the
+ * number of neighbors inside the canvas.  On the finest level, b is 0
+ * and the pixels outside the mask hold the Dirichlet conditions; on
+ * the coarser levels, x is the correction to the finer level's
+ * solution, and it is 0 outside the mask.
+ */
+typedef struct
+{
+  gint    width;
+  gint    height;
+  gint    depth;
+  guchar *mask;
+  gfloat *x;
+  gfloat *b;
+  gfloat *r;
+} HealLevel;
+
+typedef struct
+{
+  HealLevel *level;
+  gint       parity;
+  gfloat    *errs;
+} HealSweepData;
+
+static inline gfloat
+gimp_heal_multigrid_neighbors (const HealLevel *level,
+                               gint             i,
+                               gint             j,
+                               gint             k,
+                               gint            *n)
+{
+  const gint    width  = level->width;
+  const gint    depth  = level->depth;
+  const gfloat *x      = level->x + (i * width + j) * depth + k;
+  gfloat        sum    = 0.0f;
+
+  *n = 0;
+
+  if (j > 0)                 { sum += x[-depth];         (*n)++; }
+  if (j < width - 1)         { sum += x[depth];          (*n)++; }
+  if (i > 0)                 { sum += x[-width * depth]; (*n)++; }
+  if (i < level->height - 1) { sum += x[width * depth];  (*n)++; }
+
+  return sum;
+}
+
+static void
+gimp_heal_multigrid_smooth_rows (gsize          offset,
+                                 gsize          size,
+                                 HealSweepData *data)
+{
+  HealLevel *level = data->level;
+  gint       depth = level->depth;
+  gint       i, j, k;
+
+  for (i = offset; i < offset + size; i++)
+    {
+      for (j = (i + data->parity) & 1; j < level->width; j += 2)
+        {
+          gint index = i * level->width + j;
+
+          if (! level->mask[index])
+            continue;
+
+          for (k = 0; k < depth; k++)
+            {
+              gint   n;
+              gfloat sum = gimp_heal_multigrid_neighbors (level, i, j, k, &n);
+
+              level->x[index * depth + k] = (sum + level->b[index * depth + k]) / n;
+            }
+        }
+    }
+}
+
+static void
+gimp_heal_multigrid_residual_rows (gsize          offset,
+                                   gsize          size,
+                                   HealSweepData *data)
+{
+  HealLevel *level = data->level;
+  gint       depth = level->depth;
+  gint       i, j, k;
+
+  for (i = offset; i < offset + size; i++)
+    {
+      gfloat err = 0.0f;
+
+      for (j = 0; j < level->width; j++)
+        {
+          gint index = i * level->width + j;
+
+          for (k = 0; k < depth; k++)
+            {
+              gfloat r = 0.0f;
+
+              if (level->mask[index])
+                {
+                  gint   n;
+                  gfloat sum = gimp_heal_multigrid_neighbors (level, i, j, k, &n);
+
+                  r = level->b[index * depth + k] -
+                      (n * level->x[index * depth + k] - sum);
+                }
+
+              level->r[index * depth + k] = r;
+              err += r * r;
+            }
+        }
+
+      data->errs[i] = err;
+    }
+}
+
+static void
+gimp_heal_multigrid_rows (HealLevel                       *level,
+                          GeglParallelDistributeRangeFunc  func,
+                          gint                             parity,
+                          gfloat                          *errs)
+{
+  HealSweepData data = { level, parity, errs };
+
+  gegl_parallel_distribute_range (
+    level->height, PIXELS_PER_THREAD / (level->width * level->depth),
+    func, &data);
+}
+
+static void
+gimp_heal_multigrid_smooth (HealLevel *level,
+                            gint       n_sweeps)
+{
+  while (n_sweeps--)
+    {
+      gint parity;
+
+      /* red cells only depend on black cells, and vice versa, so the
+       * rows of each half-sweep can be processed in parallel
+       */
+      for (parity = 0; parity < 2; parity++)
+        {
+          gimp_heal_multigrid_rows (
+            level,
+            (GeglParallelDistributeRangeFunc) gimp_heal_multigrid_smooth_rows,
+            parity, NULL);
+        }
+    }
+}
+
+/* Compute the residual of the level, and return its sum of squares.
+ */
+static gfloat
+gimp_heal_multigrid_residual (HealLevel *level)
+{
+  gfloat *errs = g_new (gfloat, level->height);
+  gfloat  err  = 0.0f;
+  gint    i;
+
+  gimp_heal_multigrid_rows (
+    level,
+    (GeglParallelDistributeRangeFunc) gimp_heal_multigrid_residual_rows,
+    0, errs);
+
+  /* sum in order, so that the result doesn't depend on the threads */
+  for (i = 0; i < level->height; i++)
+    err += errs[i];
+
+  g_free (errs);
+
+  return err;
+}
+
+/* Create the next coarser level, with the restricted residual of the
+ * level as its right-hand side, or return NULL if the level is as coarse
+ * as it gets.
+ */
+static HealLevel *
+gimp_heal_multigrid_restrict (HealLevel *level)
+{
+  HealLevel *coarse;
+  gint       depth = level->depth;
+  gint       n_known   = 0;
+  gint       n_unknown = 0;
+  gint       i, j, k;
+
+  if (level->width < 4 || level->height < 4)
+    return NULL;
+
+  coarse = g_new (HealLevel, 1);
+
+  coarse->width  = (level->width  + 1) / 2;
+  coarse->height = (level->height + 1) / 2;
+  coarse->depth  = depth;
+  coarse->mask   = g_new  (guchar, coarse->width * coarse->height);
+  coarse->x      = g_new0 (gfloat, coarse->width * coarse->height * depth);
+  coarse->b      = g_new  (gfloat, coarse->width * coarse->height * depth);
+  coarse->r      = g_new  (gfloat, coarse->width * coarse->height * depth);
+
+  for (i = 0; i < coarse->height; i++)
+    for (j = 0; j < coarse->width; j++)
+      {
+        gint i0    = 2 * i;
+        gint j0    = 2 * j;
+        gint i1    = MIN (i0 + 1, level->height - 1);
+        gint j1    = MIN (j0 + 1, level->width  - 1);
+        gint index = i * coarse->width + j;
+
+        /* a coarse cell is unknown only if all of its fine cells are;
+         * growing the unknown region instead makes the cycles diverge
+         */
+        coarse->mask[index] = (level->mask[i0 * level->width + j0] &&
+                               level->mask[i0 * level->width + j1] &&
+                               level->mask[i1 * level->width + j0] &&
+                               level->mask[i1 * level->width + j1]);
+
+        if (coarse->mask[index])
+          n_unknown++;
+        else
+          n_known++;
+
+        /* the coarse operator is 4 times the fine one, so the residual
+         * is summed rather than averaged
+         */
+        for (k = 0; k < depth; k++)
+          {
+            coarse->b[index * depth + k] =
+              level->r[(i0 * level->width + j0) * depth + k] +
+              level->r[(i0 * level->width + j1) * depth + k] +
+              level->r[(i1 * level->width + j0) * depth + k] +
+              level->r[(i1 * level->width + j1) * depth + k];
+          }
+      }
+
+  /* without any Dirichlet condition, the system would be singular */
+  if (n_known == 0 || n_unknown == 0)
+    {
+      g_free (coarse->mask);
+      g_free (coarse->x);
+      g_free (coarse->b);
+      g_free (coarse->r);
+      g_free (coarse);
+
+      return NULL;
+    }
+
+  return coarse;
+}
+
+/* Interpolate the correction computed for the coarse level bilinearly,
+ * and add it to the unknowns of the level.
+ */
+static void
+gimp_heal_multigrid_prolong (HealLevel       *level,
+                             const HealLevel *coarse)
+{
+  gint depth = level->depth;
+  gint i, j, k;
+
+  for (i = 0; i < level->height; i++)
+    {
+      gfloat y  = CLAMP ((i + 0.5f) / 2.0f - 0.5f, 0, coarse->height - 1);
+      gint   y0 = (gint) y;
+      gint   y1 = MIN (y0 + 1, coarse->height - 1);
+      gfloat fy = y - y0;
+
+      for (j = 0; j < level->width; j++)
+        {
+          gint          index = i * level->width + j;
+          gfloat        x;
+          gint          x0, x1;
+          gfloat        fx;
+          const gfloat *e00, *e01, *e10, *e11;
+
+          if (! level->mask[index])
+            continue;
+
+          x  = CLAMP ((j + 0.5f) / 2.0f - 0.5f, 0, coarse->width - 1);
+          x0 = (gint) x;
+          x1 = MIN (x0 + 1, coarse->width - 1);
+          fx = x - x0;
+
+          e00 = coarse->x + (y0 * coarse->width + x0) * depth;
+          e01 = coarse->x + (y0 * coarse->width + x1) * depth;
+          e10 = coarse->x + (y1 * coarse->width + x0) * depth;
+          e11 = coarse->x + (y1 * coarse->width + x1) * depth;
+
+          for (k = 0; k < depth; k++)
+            {
+              level->x[index * depth + k] +=
+                (e00[k] * (1.0f - fx) + e01[k] * fx) * (1.0f - fy) +
+                (e10[k] * (1.0f - fx) + e11[k] * fx) * fy;
+            }
+        }
+    }
+}
+
+static void
+gimp_heal_multigrid_cycle (HealLevel *level)
+{
+  HealLevel *coarse;
+
+#define PRE_SWEEPS     2
+#define POST_SWEEPS    2
+
+  gimp_heal_multigrid_smooth (level, PRE_SWEEPS);
+
+  gimp_heal_multigrid_residual (level);
+
+  coarse = gimp_heal_multigrid_restrict (level);
+
+  if (coarse)
+    {
+      gimp_heal_multigrid_cycle (coarse);
+
+      gimp_heal_multigrid_prolong (level, coarse);
+
+      g_free (coarse->mask);
+      g_free (coarse->x);
+      g_free (coarse->b);
+      g_free (coarse->r);
+      g_free (coarse);
+
+      gimp_heal_multigrid_smooth (level, POST_SWEEPS);
+    }
+  else
+    {
+      /* coarsest level, which is small: just iterate */
+      gimp_heal_multigrid_smooth (level, 2 * (level->width + level->height));
+    }
+}
+
+/* Solve the laplace equation for pixels and store the result in-place,
+ * using multigrid.
+ */
+static void
+gimp_heal_multigrid_loop (gfloat *pixels,
+                          gint    height,
+                          gint    depth,
+                          gint    width,
+                          guchar *mask)
+{
+  /* same tolerance as gimp_heal_laplace_loop(), relative to the
+   * Gauss-Seidel update, which is a quarter of the residual
+   */
+#define MG_EPSILON  (4 * 0.1/255)
+#define MG_MAX_ITER 50
+
+  HealLevel level;
+  gint      iter;
+
+  level.width  = width;
+  level.height = height;
+  level.depth  = depth;
+  level.mask   = mask;
+  level.x      = pixels;
+  level.b      = g_new0 (gfloat, width * height * depth);
+  level.r      = g_new  (gfloat, width * height * depth);
+
+  for (iter = 0; iter < MG_MAX_ITER; iter++)
+    {
+      gimp_heal_multigrid_cycle (&level);
+
+      if (gimp_heal_multigrid_residual (&level) < MG_EPSILON * MG_EPSILON)
+        break;
+    }
+
+  g_free (level.b);
+  g_free (level.r);
+}
+
 /* Original Algorithm Design:
  *
  * T. Georgiev, "Photoshop Healing Brush: a Tool for Seamless Cloning
@@ -480,7 +864,10 @@ gimp_heal (GeglBuffer          *src_buffer,
   gegl_buffer_get (mask_buffer, mask_rect, 1.0, babl_format ("Y u8"),
                    mask, GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
 
-  gimp_heal_laplace_loop (diff, height, src_components, width, mask);
+  if (MAX (width, height) >= MULTIGRID_MIN_SIZE)
+    gimp_heal_multigrid_loop (diff, height, src_components, width, mask);
+  else
+    gimp_heal_laplace_loop (diff, height, src_components, width, mask);
 
   g_free (mask);
 
@@ -20,7 +20,9 @@
 
 #include "config.h"
 
-#include <glib-object.h>
+#include <string.h>
+
+#include <gegl.h>
 
 #include "libgimpmath/gimpmath.h"
 
@@ -29,6 +31,15 @@
 #include "gimpink-blob.h"
 
 
+/*  the number of freed blobs kept around for reuse  */
+#define POOL_SIZE        16
+
+/*  the granularity of the blobs' allocated height, so that a blob of
+ *  the pool fits the next blobs of a stroke, whose sizes vary slightly
+ */
+#define ALLOC_ALIGNMENT  64
+
+
 typedef enum
 {
   EDGE_NONE  = 0,
@@ -58,6 +69,12 @@ static void       gimp_blob_line           (GimpBlob *b,
 #endif
 
 
+G_LOCK_DEFINE_STATIC (blob_pool);
+
+static GimpBlob *pool[POOL_SIZE];
+static gint      n_pooled = 0;
+
+
 /*  public functions  */
 
 /* Return blob for the given (convex) polygon
@@ -85,7 +102,7 @@ gimp_blob_polygon (GimpBlobPoint *points,
     }
 
   result = gimp_blob_new (ymin, ymax - ymin + 1);
-  present = g_new0 (EdgeType, result->height);
+  present = gegl_scratch_new0 (EdgeType, result->height);
 
   im1 = n_points - 1;
   i = 0;
@@ -139,7 +156,7 @@ gimp_blob_polygon (GimpBlobPoint *points,
     }
 
   gimp_blob_fill (result, present);
-  g_free (present);
+  gegl_scratch_free (present);
 
   return result;
 }
@@ -287,7 +304,7 @@ gimp_blob_ellipse (gdouble xc,
   miny = floor (yc - fabs (yp) - fabs (yq));
 
   result = gimp_blob_new (miny, maxy - miny + 1);
-  present = g_new0 (EdgeType, result->height);
+  present = gegl_scratch_new0 (EdgeType, result->height);
 
   xc_base = floor (xc);
   yc_base = floor (yc);
@@ -354,7 +371,7 @@ gimp_blob_ellipse (gdouble xc,
   /* Now fill in missing points */
 
   gimp_blob_fill (result, present);
-  g_free (present);
+  gegl_scratch_free (present);
 
   return result;
 }
@@ -417,7 +434,7 @@ gimp_blob_convex_union (GimpBlob *b1,
   if (result->height == 0)
     return result;
 
-  present = g_new0 (EdgeType, result->height);
+  present = gegl_scratch_new0 (EdgeType, result->height);
 
   /* Initialize spans from original objects */
 
@@ -453,7 +470,7 @@ gimp_blob_convex_union (GimpBlob *b1,
 
   gimp_blob_make_convex (result, present);
 
-  g_free (present);
+  gegl_scratch_free (present);
 
   return result;
 }
@@ -461,9 +478,61 @@ gimp_blob_convex_union (GimpBlob *b1,
 GimpBlob *
 gimp_blob_duplicate (GimpBlob *b)
 {
+  GimpBlob *result;
+
   g_return_val_if_fail (b != NULL, NULL);
 
-  return g_memdup2 (b, sizeof (GimpBlob) +  sizeof (GimpBlobSpan) * (b->height - 1));
+  result = gimp_blob_new (b->y, b->height);
+
+  memcpy (result->data, b->data, sizeof (GimpBlobSpan) * b->height);
+
+  return result;
+}
+
+/* Blobs are created by the ink tool for every motion event, and
+ * destroyed shortly after, so instead of returning them to the system,
+ * a few of them are kept for reuse
+ */
+void
+gimp_blob_free (GimpBlob *b)
+{
+  GimpBlob *evicted = NULL;
+
+  if (! b)
+    return;
+
+  G_LOCK (blob_pool);
+
+  if (n_pooled < POOL_SIZE)
+    {
+      pool[n_pooled++] = b;
+    }
+  else
+    {
+      gint i;
+      gint smallest = 0;
+
+      /*  keep the larger blobs, which are the expensive ones  */
+      for (i = 1; i < POOL_SIZE; i++)
+        {
+          if (pool[i]->capacity < pool[smallest]->capacity)
+            smallest = i;
+        }
+
+      if (pool[smallest]->capacity < b->capacity)
+        {
+          evicted        = pool[smallest];
+          pool[smallest] = b;
+        }
+      else
+        {
+          evicted = b;
+        }
+    }
+
+  G_UNLOCK (blob_pool);
+
+  g_free (evicted);
 }
 
 void
@@ -507,9 +576,40 @@ static GimpBlob *
 gimp_blob_new (gint y,
                gint height)
 {
-  GimpBlob *result;
+  GimpBlob *result = NULL;
+  gint      best   = -1;
+  gint      i;
+
+  G_LOCK (blob_pool);
 
-  result = g_malloc (sizeof (GimpBlob) +  sizeof (GimpBlobSpan) * (height - 1));
+  /*  use the smallest pooled blob that is large enough  */
+  for (i = 0; i < n_pooled; i++)
+    {
+      if (pool[i]->capacity >= height &&
+          (best < 0 || pool[i]->capacity < pool[best]->capacity))
+        {
+          best = i;
+        }
+    }
+
+  if (best >= 0)
+    {
+      result     = pool[best];
+      pool[best] = pool[--n_pooled];
+    }
+
+  G_UNLOCK (blob_pool);
+
+  if (! result)
+    {
+      gint capacity = MAX (1, (height + ALLOC_ALIGNMENT - 1) /
+                              ALLOC_ALIGNMENT * ALLOC_ALIGNMENT);
+
+      result = g_malloc (sizeof (GimpBlob) +
+                         sizeof (GimpBlobSpan) * (capacity - 1));
+
+      result->capacity = capacity;
+    }
 
   result->y      = y;
   result->height = height;
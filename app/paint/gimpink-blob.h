@@ -49,6 +49,7 @@ struct _GimpBlob
 {
   gint         y;
   gint         height;
+  gint         capacity;  /* the number of allocated spans */
   GimpBlobSpan data[1];
 };
 
@@ -81,6 +82,7 @@ void       gimp_blob_bounds       (GimpBlob      *b,
 GimpBlob * gimp_blob_convex_union (GimpBlob      *b1,
                                    GimpBlob      *b2);
 GimpBlob * gimp_blob_duplicate    (GimpBlob      *b);
+void       gimp_blob_free         (GimpBlob      *b);
 void       gimp_blob_move         (GimpBlob      *b,
                                    gint           x,
                                    gint           y);
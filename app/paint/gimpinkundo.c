@@ -117,7 +117,8 @@ gimp_ink_undo_free (GimpUndo     *undo,
 
   if (ink_undo->last_blobs)
     {
-      g_list_free_full (ink_undo->last_blobs, g_free);
+      g_list_free_full (ink_undo->last_blobs,
+                        (GDestroyNotify) gimp_blob_free);
       ink_undo->last_blobs = NULL;
     }
 
@@ -343,6 +343,10 @@ gimp_mybrush_core_motion (GimpPaintCore    *paint_core,
       x2 = coords.x + radius;
       y2 = coords.y + radius;
 
+      /* the drawable's buffer might be replaced, apply queued dabs first */
+      if (paint_options->expand_use)
+        gimp_mypaint_surface_flush (mybrush->private->surface);
+
       expanded = gimp_paint_core_expand_drawable (paint_core, drawable, paint_options,
                                                   x1, x2, y1, y2,
                                                   &offset_change_x, &offset_change_y);
@@ -388,12 +392,11 @@ gimp_mybrush_core_motion (GimpPaintCore    *paint_core,
 
   if (rects.rectangles[0].width > 0 && rects.rectangles[0].height > 0)
     {
-      paint_core->x1 = MIN (paint_core->x1, rects.rectangles[0].x);
-      paint_core->y1 = MIN (paint_core->y1, rects.rectangles[0].y);
-      paint_core->x2 = MAX (paint_core->x2,
-                            rects.rectangles[0].x + rects.rectangles[0].width);
-      paint_core->y2 = MAX (paint_core->y2,
-                            rects.rectangles[0].y + rects.rectangles[0].height);
+      gimp_paint_core_add_undo_area (paint_core,
+                                     rects.rectangles[0].x,
+                                     rects.rectangles[0].y,
+                                     rects.rectangles[0].width,
+                                     rects.rectangles[0].height);
 
       gimp_drawable_update (drawable, rects.rectangles[0].x,
                             rects.rectangles[0].y, rects.rectangles[0].width,
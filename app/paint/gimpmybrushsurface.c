@@ -32,6 +32,51 @@
 #include "gimpmybrushsurface.h"
 
 
+/*  dabs are queued, and applied tile-by-tile, in parallel, when the
+ *  surface is flushed.  get_color() samples are read through a cache of
+ *  tiles, which is invalidated as dabs are applied.
+ */
+#define TILE_SIZE         64
+#define MAX_QUEUED_DABS   1024
+#define MAX_CACHED_TILES  256
+
+#define PIXELS_PER_THREAD \
+  (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
+
+
+typedef struct
+{
+  GeglRectangle rect;
+  gfloat        x;
+  gfloat        y;
+  gfloat        radius;
+  gfloat        color_r;
+  gfloat        color_g;
+  gfloat        color_b;
+  gfloat        color_a;
+  gfloat        hardness;
+  gfloat        aspect_ratio;
+  gfloat        sn;
+  gfloat        cs;
+  gfloat        one_over_radius2;
+  gfloat        segment1_slope;
+  gfloat        segment2_slope;
+  gfloat        r_aa_start;
+  gfloat        normal_mode;
+  gfloat        colorize;
+  gfloat        posterize;
+  gfloat        posterize_num;
+} GimpMybrushDab;
+
+typedef struct
+{
+  GimpMybrushSurface  *surface;
+  GArray             **tile_dabs;
+  gint                 tile_x;
+  gint                 tile_y;
+  gint                 n_tiles_x;
+} GimpMybrushFlushData;
+
 struct _GimpMybrushSurface
 {
   MyPaintSurface2     surface;
@@ -44,6 +89,11 @@ struct _GimpMybrushSurface
   GeglRectangle       dirty;
   GimpComponentMask   component_mask;
   GimpMybrushOptions *options;
+  const Babl         *rgb_to_hsl_fish;
+  const Babl         *hsl_to_rgb_fish;
+  GArray             *dabs;
+  GeglRectangle       dabs_bounds;
+  GHashTable         *color_tiles;
 };
 
 /* --- Taken from mypaint-tiled-surface.c --- */
@@ -231,6 +281,62 @@ calculate_dab_roi (float x,
   return *GEGL_RECTANGLE (x0, y0, x1 - x0, y1 - y0);
 }
 
+static inline gint
+tile_index (gint coord)
+{
+  return coord >= 0 ? coord / TILE_SIZE : (coord + 1) / TILE_SIZE - 1;
+}
+
+static inline gpointer
+tile_key (gint tile_x,
+          gint tile_y)
+{
+  return GUINT_TO_POINTER (((guint) tile_x & 0xffff) |
+                           ((guint) tile_y << 16));
+}
+
+static const gfloat *
+gimp_mypaint_surface_get_color_tile (GimpMybrushSurface *surface,
+                                     gint                tile_x,
+                                     gint                tile_y)
+{
+  gpointer  key = tile_key (tile_x, tile_y);
+  gfloat   *data;
+
+  data = g_hash_table_lookup (surface->color_tiles, key);
+
+  if (! data)
+    {
+      GeglRectangle rect = { tile_x * TILE_SIZE, tile_y * TILE_SIZE,
+                             TILE_SIZE,          TILE_SIZE };
+
+      if (g_hash_table_size (surface->color_tiles) >= MAX_CACHED_TILES)
+        g_hash_table_remove_all (surface->color_tiles);
+
+      data = g_new (gfloat, TILE_SIZE * TILE_SIZE * 5);
+
+      /* Read in clamp mode to avoid transparency bleeding in at the edges */
+      gegl_buffer_get (surface->buffer, &rect, 1.0,
+                       babl_format ("R'aG'aB'aA float"), data,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_CLAMP);
+
+      if (surface->paint_mask)
+        {
+          rect.x -= surface->paint_mask_x;
+          rect.y -= surface->paint_mask_y;
+
+          gegl_buffer_get (surface->paint_mask, &rect, 1.0,
+                           babl_format ("Y float"),
+                           data + TILE_SIZE * TILE_SIZE * 4,
+                           GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+        }
+
+      g_hash_table_insert (surface->color_tiles, key, data);
+    }
+
+  return data;
+}
+
 static void
 gimp_mypaint_surface_get_color_2 (MyPaintSurface2 *base_surface,
                                   gfloat           x,
@@ -264,55 +370,63 @@ gimp_mypaint_surface_get_color_2 (MyPaintSurface2 *base_surface,
     float sum_b = 0.0f;
     float sum_a = 0.0f;
 
-     /* Read in clamp mode to avoid transparency bleeding in at the edges */
-    GeglBufferIterator *iter = gegl_buffer_iterator_new (surface->buffer, &dabRect, 0,
-                                                         babl_format ("R'aG'aB'aA float"),
-                                                         GEGL_BUFFER_READ,
-                                                         GEGL_ABYSS_CLAMP, 2);
-    if (surface->paint_mask)
+    gint  tile_x, tile_y;
+
+    if (surface->dabs->len > 0 &&
+        gegl_rectangle_intersect (NULL, &dabRect, &surface->dabs_bounds))
       {
-        GeglRectangle mask_roi = dabRect;
-        mask_roi.x -= surface->paint_mask_x;
-        mask_roi.y -= surface->paint_mask_y;
-        gegl_buffer_iterator_add (iter, surface->paint_mask, &mask_roi, 0,
-                                  babl_format ("Y float"),
-                                  GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
+        gimp_mypaint_surface_flush (surface);
       }
 
-    while (gegl_buffer_iterator_next (iter))
+    for (tile_y = tile_index (dabRect.y);
+         tile_y <= tile_index (dabRect.y + dabRect.height - 1);
+         tile_y++)
       {
-        float *pixel = (float *)iter->items[0].data;
-        float *mask;
-        int iy, ix;
+        for (tile_x = tile_index (dabRect.x);
+             tile_x <= tile_index (dabRect.x + dabRect.width - 1);
+             tile_x++)
+          {
+            const gfloat  *data;
+            const gfloat  *mask = NULL;
+            GeglRectangle  area = { tile_x * TILE_SIZE, tile_y * TILE_SIZE,
+                                    TILE_SIZE,          TILE_SIZE };
+            int            iy, ix;
 
-        if (surface->paint_mask)
-          mask = iter->items[1].data;
-        else
-          mask = NULL;
+            gegl_rectangle_intersect (&area, &area, &dabRect);
 
-        for (iy = iter->items[0].roi.y; iy < iter->items[0].roi.y + iter->items[0].roi.height; iy++)
-          {
-            float yy = (iy + 0.5f - y);
-            for (ix = iter->items[0].roi.x; ix < iter->items[0].roi.x +  iter->items[0].roi.width; ix++)
+            data = gimp_mypaint_surface_get_color_tile (surface,
+                                                        tile_x, tile_y);
+
+            if (surface->paint_mask)
+              mask = data + TILE_SIZE * TILE_SIZE * 4;
+
+            for (iy = area.y; iy < area.y + area.height; iy++)
               {
-                /* pixel_weight == a standard dab with hardness = 0.5, aspect_ratio = 1.0, and angle = 0.0 */
-                float xx = (ix + 0.5f - x);
-                float rr = (yy * yy + xx * xx) * one_over_radius2;
-                float pixel_weight = 0.0f;
-                if (rr <= 1.0f)
-                  pixel_weight = 1.0f - rr;
-                if (mask)
-                  pixel_weight *= *mask;
-
-                sum_r += pixel_weight * pixel[RED];
-                sum_g += pixel_weight * pixel[GREEN];
-                sum_b += pixel_weight * pixel[BLUE];
-                sum_a += pixel_weight * pixel[ALPHA];
-                sum_weight += pixel_weight;
-
-                pixel += 4;
-                if (mask)
-                  mask += 1;
+                gint          offset = (iy - tile_y * TILE_SIZE) * TILE_SIZE +
+                                       (area.x - tile_x * TILE_SIZE);
+                const gfloat *pixel  = data + 4 * offset;
+                float         yy     = (iy + 0.5f - y);
+
+                for (ix = area.x; ix < area.x + area.width; ix++)
+                  {
+                    /* pixel_weight == a standard dab with hardness = 0.5, aspect_ratio = 1.0, and angle = 0.0 */
+                    float xx = (ix + 0.5f - x);
+                    float rr = (yy * yy + xx * xx) * one_over_radius2;
+                    float pixel_weight = 0.0f;
+                    if (rr <= 1.0f)
+                      pixel_weight = 1.0f - rr;
+                    if (mask)
+                      pixel_weight *= mask[offset];
+
+                    sum_r += pixel_weight * pixel[RED];
+                    sum_g += pixel_weight * pixel[GREEN];
+                    sum_b += pixel_weight * pixel[BLUE];
+                    sum_a += pixel_weight * pixel[ALPHA];
+                    sum_weight += pixel_weight;
+
+                    pixel += 4;
+                    offset++;
+                  }
               }
           }
       }
@@ -352,6 +466,227 @@ gimp_mypaint_surface_get_color_wrapper (MyPaintSurface *surface,
                                            -1.0);
 }
 
+static void
+gimp_mypaint_surface_paint_dab (GimpMybrushSurface   *surface,
+                                const GimpMybrushDab *dab,
+                                const GeglRectangle  *area,
+                                gfloat               *pixels,
+                                gint                  pixels_stride,
+                                const gfloat         *masks,
+                                gint                  masks_stride)
+{
+  GimpComponentMask component_mask = surface->component_mask;
+  int               iy, ix;
+
+  for (iy = area->y; iy < area->y + area->height; iy++)
+    {
+      float        *pixel = pixels + 4 * pixels_stride * (iy - area->y);
+      const gfloat *mask  = NULL;
+
+      if (masks)
+        mask = masks + masks_stride * (iy - area->y);
+
+      for (ix = area->x; ix < area->x + area->width; ix++)
+        {
+          float rr, base_alpha, alpha, dst_alpha, r, g, b, a;
+          if (dab->radius < 3.0f)
+            rr = calculate_rr_antialiased (ix, iy, dab->x, dab->y, dab->aspect_ratio, dab->sn, dab->cs, dab->one_over_radius2, dab->r_aa_start);
+          else
+            rr = calculate_rr (ix, iy, dab->x, dab->y, dab->aspect_ratio, dab->sn, dab->cs, dab->one_over_radius2);
+          base_alpha = calculate_alpha_for_rr (rr, dab->hardness, dab->segment1_slope, dab->segment2_slope);
+          alpha = base_alpha * dab->normal_mode;
+          if (mask)
+            alpha *= mask[ix - area->x];
+          dst_alpha = pixel[ALPHA];
+          /* a = alpha * color_a + dst_alpha * (1.0f - alpha);
+           * which converts to: */
+          a = alpha * (dab->color_a - dst_alpha) + dst_alpha;
+          r = pixel[RED];
+          g = pixel[GREEN];
+          b = pixel[BLUE];
+
+          if (a > 0.0f)
+            {
+              /* By definition the ratio between each color[] and pixel[] component in a non-pre-multipled blend always sums to 1.0f.
+               * Originally this would have been "(color[n] * alpha * color_a + pixel[n] * dst_alpha * (1.0f - alpha)) / a",
+               * instead we only calculate the cheaper term. */
+              float src_term = (alpha * dab->color_a) / a;
+              float dst_term = 1.0f - src_term;
+              r = dab->color_r * src_term + r * dst_term;
+              g = dab->color_g * src_term + g * dst_term;
+              b = dab->color_b * src_term + b * dst_term;
+            }
+
+          if (dab->colorize > 0.0f && base_alpha > 0.0f)
+            {
+              alpha = base_alpha * dab->colorize;
+              a = alpha + dst_alpha - alpha * dst_alpha;
+              if (a > 0.0f)
+                {
+                  float pixel_hsl[3], out_hsl[3];
+                  float pixel_rgb[3] = {dab->color_r, dab->color_g, dab->color_b};
+                  float out_rgb[3]   = {r, g, b};
+                  float src_term     = alpha / a;
+                  float dst_term     = 1.0f - src_term;
+
+                  /* Here I am completely unsure if the conversion are
+                   * right, regarding color spaces. What is the color space
+                   * of color_r/g/b arguments?
+                   * TODO: this code should be double-checked.
+                   */
+                  babl_process (surface->rgb_to_hsl_fish, pixel_rgb, pixel_hsl, 1);
+                  babl_process (surface->rgb_to_hsl_fish, out_rgb, out_hsl, 1);
+
+                  out_hsl[0] = pixel_hsl[0];
+                  out_hsl[1] = pixel_hsl[1];
+                  babl_process (surface->hsl_to_rgb_fish, out_hsl, out_rgb, 1);
+
+                  r = (float)out_rgb[0] * src_term + r * dst_term;
+                  g = (float)out_rgb[1] * src_term + g * dst_term;
+                  b = (float)out_rgb[2] * src_term + b * dst_term;
+                }
+            }
+
+          if (dab->posterize > 0.0f && base_alpha > 0.0f)
+            {
+              alpha = base_alpha * dab->posterize;
+              a     = alpha + dst_alpha - alpha * dst_alpha;
+              if (a > 0.0f)
+                {
+                  gfloat post_pixel[3];
+                  gfloat src_term = alpha / a;
+                  gfloat dst_term = 1.0f - src_term;
+
+                  post_pixel[0] = ROUND (r * dab->posterize_num) / dab->posterize_num;
+                  post_pixel[1] = ROUND (g * dab->posterize_num) / dab->posterize_num;
+                  post_pixel[2] = ROUND (b * dab->posterize_num) / dab->posterize_num;
+
+                  r = post_pixel[0] * src_term + r * dst_term;
+                  g = post_pixel[1] * src_term + g * dst_term;
+                  b = post_pixel[2] * src_term + b * dst_term;
+                }
+            }
+
+          if (surface->options->no_erasing)
+            a = MAX (a, pixel[ALPHA]);
+
+          if (component_mask != GIMP_COMPONENT_MASK_ALL)
+            {
+              if (component_mask & GIMP_COMPONENT_MASK_RED)
+                pixel[RED]   = r;
+              if (component_mask & GIMP_COMPONENT_MASK_GREEN)
+                pixel[GREEN] = g;
+              if (component_mask & GIMP_COMPONENT_MASK_BLUE)
+                pixel[BLUE]  = b;
+              if (component_mask & GIMP_COMPONENT_MASK_ALPHA)
+                pixel[ALPHA] = a;
+            }
+          else
+            {
+              pixel[RED]   = r;
+              pixel[GREEN] = g;
+              pixel[BLUE]  = b;
+              pixel[ALPHA] = a;
+            }
+
+          pixel += 4;
+        }
+    }
+}
+
+static void
+gimp_mypaint_surface_process_tiles (gsize                 offset,
+                                    gsize                 size,
+                                    GimpMybrushFlushData *data)
+{
+  GimpMybrushSurface *surface = data->surface;
+  const GeglRectangle extent  = *gegl_buffer_get_extent (surface->buffer);
+  gsize               i;
+
+  for (i = offset; i < offset + size; i++)
+    {
+      GArray        *indices = data->tile_dabs[i];
+      GeglRectangle  tile    = { (data->tile_x + i % data->n_tiles_x) * TILE_SIZE,
+                                 (data->tile_y + i / data->n_tiles_x) * TILE_SIZE,
+                                 TILE_SIZE, TILE_SIZE };
+      GeglRectangle  rect    = { 0, };
+      gfloat        *pixels;
+      gfloat        *masks   = NULL;
+      guint          j;
+
+      if (! indices)
+        continue;
+
+      /* only read and write back the part of the tile the dabs cover */
+      for (j = 0; j < indices->len; j++)
+        {
+          const GimpMybrushDab *dab = &g_array_index (surface->dabs,
+                                                      GimpMybrushDab,
+                                                      g_array_index (indices,
+                                                                     guint,
+                                                                     j));
+
+          gegl_rectangle_bounding_box (&rect, &rect, &dab->rect);
+        }
+
+      gegl_rectangle_intersect (&rect, &rect, &tile);
+      gegl_rectangle_intersect (&rect, &rect, &extent);
+
+      pixels = gegl_scratch_new (gfloat, rect.width * rect.height * 4);
+
+      gegl_buffer_get (surface->buffer, &rect, 1.0,
+                       babl_format ("R'G'B'A float"), pixels,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+      if (surface->paint_mask)
+        {
+          GeglRectangle mask_roi = rect;
+
+          mask_roi.x -= surface->paint_mask_x;
+          mask_roi.y -= surface->paint_mask_y;
+
+          masks = gegl_scratch_new (gfloat, rect.width * rect.height);
+
+          gegl_buffer_get (surface->paint_mask, &mask_roi, 1.0,
+                           babl_format ("Y float"), masks,
+                           GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+        }
+
+      /* the dabs are applied in the order they were queued, so the
+       * result is the same as painting them one by one
+       */
+      for (j = 0; j < indices->len; j++)
+        {
+          const GimpMybrushDab *dab = &g_array_index (surface->dabs,
+                                                      GimpMybrushDab,
+                                                      g_array_index (indices,
+                                                                     guint,
+                                                                     j));
+          GeglRectangle         area;
+          gint                  pixel_offset;
+
+          if (! gegl_rectangle_intersect (&area, &dab->rect, &rect))
+            continue;
+
+          pixel_offset = (area.y - rect.y) * rect.width + (area.x - rect.x);
+
+          gimp_mypaint_surface_paint_dab (surface, dab, &area,
+                                          pixels + 4 * pixel_offset, rect.width,
+                                          masks ? masks + pixel_offset : NULL,
+                                          rect.width);
+        }
+
+      gegl_buffer_set (surface->buffer, &rect, 0,
+                       babl_format ("R'G'B'A float"), pixels,
+                       GEGL_AUTO_ROWSTRIDE);
+
+      if (masks)
+        gegl_scratch_free (masks);
+
+      gegl_scratch_free (pixels);
+    }
+}
+
 static gint
 gimp_mypaint_surface_draw_dab_2 (MyPaintSurface2 *base_surface,
                                  gfloat           x,
@@ -372,38 +707,18 @@ gimp_mypaint_surface_draw_dab_2 (MyPaintSurface2 *base_surface,
                                  gfloat           paint)
 {
   GimpMybrushSurface *surface = (GimpMybrushSurface *)base_surface;
-  GeglBufferIterator *iter;
+  GimpMybrushDab      dab;
   GeglRectangle       dabRect;
-  GimpComponentMask   component_mask  = surface->component_mask;
-  /* XXX What spaces should we be working from and to? */
-  const Babl         *rgb_to_hsl_fish = babl_fish (babl_format ("R'G'B' float"), babl_format ("HSL float"));
-  const Babl         *hsl_to_rgb_fish = babl_fish (babl_format ("HSL float"), babl_format ("R'G'B' float"));
 
-  const float one_over_radius2 = 1.0f / (radius * radius);
   const double angle_rad = angle / 360 * 2 * M_PI;
-  const float cs = cos(angle_rad);
-  const float sn = sin(angle_rad);
-  float normal_mode;
-  float segment1_slope;
-  float segment2_slope;
-  float r_aa_start;
 
   posterize     = CLAMP (posterize, 0.0f, 1.0f);
   posterize_num = CLAMP (ROUND (posterize_num * 100.0), 1, 128);
   paint         = CLAMP (paint, 0.0f, 1.0f);
 
   hardness = CLAMP (hardness, 0.0f, 1.0f);
-  segment1_slope = -(1.0f / hardness - 1.0f);
-  segment2_slope = -hardness / (1.0f - hardness);
   aspect_ratio = MAX (1.0f, aspect_ratio);
 
-  r_aa_start = radius - 1.0f;
-  r_aa_start = MAX (r_aa_start, 0);
-  r_aa_start = (r_aa_start * r_aa_start) / aspect_ratio;
-
-  normal_mode = opaque * (1.0f - colorize) * (1.0f - posterize);
-  colorize = opaque * colorize;
-
   /* FIXME: This should use the real matrix values to trim aspect_ratio dabs */
   x += surface->off_x;
   y += surface->off_y;
@@ -415,142 +730,35 @@ gimp_mypaint_surface_draw_dab_2 (MyPaintSurface2 *base_surface,
 
   gegl_rectangle_bounding_box (&surface->dirty, &surface->dirty, &dabRect);
 
-  iter = gegl_buffer_iterator_new (surface->buffer, &dabRect, 0,
-                                   babl_format ("R'G'B'A float"),
-                                   GEGL_BUFFER_READWRITE,
-                                   GEGL_ABYSS_NONE, 2);
-  if (surface->paint_mask)
-    {
-      GeglRectangle mask_roi = dabRect;
-      mask_roi.x -= surface->paint_mask_x;
-      mask_roi.y -= surface->paint_mask_y;
-      gegl_buffer_iterator_add (iter, surface->paint_mask, &mask_roi, 0,
-                                babl_format ("Y float"),
-                                GEGL_ACCESS_READ, GEGL_ABYSS_NONE);
-    }
-
-  while (gegl_buffer_iterator_next (iter))
-    {
-      float *pixel = (float *)iter->items[0].data;
-      float *mask;
-      int iy, ix;
-
-      if (surface->paint_mask)
-        mask = iter->items[1].data;
-      else
-        mask = NULL;
-
-      for (iy = iter->items[0].roi.y; iy < iter->items[0].roi.y + iter->items[0].roi.height; iy++)
-        {
-          for (ix = iter->items[0].roi.x; ix < iter->items[0].roi.x +  iter->items[0].roi.width; ix++)
-            {
-              float rr, base_alpha, alpha, dst_alpha, r, g, b, a;
-              if (radius < 3.0f)
-                rr = calculate_rr_antialiased (ix, iy, x, y, aspect_ratio, sn, cs, one_over_radius2, r_aa_start);
-              else
-                rr = calculate_rr (ix, iy, x, y, aspect_ratio, sn, cs, one_over_radius2);
-              base_alpha = calculate_alpha_for_rr (rr, hardness, segment1_slope, segment2_slope);
-              alpha = base_alpha * normal_mode;
-              if (mask)
-                alpha *= *mask;
-              dst_alpha = pixel[ALPHA];
-              /* a = alpha * color_a + dst_alpha * (1.0f - alpha);
-               * which converts to: */
-              a = alpha * (color_a - dst_alpha) + dst_alpha;
-              r = pixel[RED];
-              g = pixel[GREEN];
-              b = pixel[BLUE];
-
-              if (a > 0.0f)
-                {
-                  /* By definition the ratio between each color[] and pixel[] component in a non-pre-multipled blend always sums to 1.0f.
-                   * Originally this would have been "(color[n] * alpha * color_a + pixel[n] * dst_alpha * (1.0f - alpha)) / a",
-                   * instead we only calculate the cheaper term. */
-                  float src_term = (alpha * color_a) / a;
-                  float dst_term = 1.0f - src_term;
-                  r = color_r * src_term + r * dst_term;
-                  g = color_g * src_term + g * dst_term;
-                  b = color_b * src_term + b * dst_term;
-                }
-
-              if (colorize > 0.0f && base_alpha > 0.0f)
-                {
-                  alpha = base_alpha * colorize;
-                  a = alpha + dst_alpha - alpha * dst_alpha;
-                  if (a > 0.0f)
-                    {
-                      float pixel_hsl[3], out_hsl[3];
-                      float pixel_rgb[3] = {color_r, color_g, color_b};
-                      float out_rgb[3]   = {r, g, b};
-                      float src_term     = alpha / a;
-                      float dst_term     = 1.0f - src_term;
-
-                      /* Here I am completely unsure if the conversion are
-                       * right, regarding color spaces. What is the color space
-                       * of color_r/g/b arguments?
-                       * TODO: this code should be double-checked.
-                       */
-                      babl_process (rgb_to_hsl_fish, pixel_rgb, pixel_hsl, 1);
-                      babl_process (rgb_to_hsl_fish, out_rgb, out_hsl, 1);
-
-                      out_hsl[0] = pixel_hsl[0];
-                      out_hsl[1] = pixel_hsl[1];
-                      babl_process (hsl_to_rgb_fish, out_hsl, out_rgb, 1);
-
-                      r = (float)out_rgb[0] * src_term + r * dst_term;
-                      g = (float)out_rgb[1] * src_term + g * dst_term;
-                      b = (float)out_rgb[2] * src_term + b * dst_term;
-                    }
-                }
-
-              if (posterize > 0.0f && base_alpha > 0.0f)
-                {
-                  alpha = base_alpha * posterize;
-                  a     = alpha + dst_alpha - alpha * dst_alpha;
-                  if (a > 0.0f)
-                    {
-                      gfloat post_pixel[3];
-                      gfloat src_term = alpha / a;
-                      gfloat dst_term = 1.0f - src_term;
-
-                      post_pixel[0] = ROUND (r * posterize_num) / posterize_num;
-                      post_pixel[1] = ROUND (g * posterize_num) / posterize_num;
-                      post_pixel[2] = ROUND (b * posterize_num) / posterize_num;
-
-                      r = post_pixel[0] * src_term + r * dst_term;
-                      g = post_pixel[1] * src_term + g * dst_term;
-                      b = post_pixel[2] * src_term + b * dst_term;
-                    }
-                }
-
-              if (surface->options->no_erasing)
-                a = MAX (a, pixel[ALPHA]);
-
-              if (component_mask != GIMP_COMPONENT_MASK_ALL)
-                {
-                  if (component_mask & GIMP_COMPONENT_MASK_RED)
-                    pixel[RED]   = r;
-                  if (component_mask & GIMP_COMPONENT_MASK_GREEN)
-                    pixel[GREEN] = g;
-                  if (component_mask & GIMP_COMPONENT_MASK_BLUE)
-                    pixel[BLUE]  = b;
-                  if (component_mask & GIMP_COMPONENT_MASK_ALPHA)
-                    pixel[ALPHA] = a;
-                }
-              else
-                {
-                  pixel[RED]   = r;
-                  pixel[GREEN] = g;
-                  pixel[BLUE]  = b;
-                  pixel[ALPHA] = a;
-                }
-
-              pixel += 4;
-              if (mask)
-                mask += 1;
-            }
-        }
-    }
+  dab.rect             = dabRect;
+  dab.x                = x;
+  dab.y                = y;
+  dab.radius           = radius;
+  dab.color_r          = color_r;
+  dab.color_g          = color_g;
+  dab.color_b          = color_b;
+  dab.color_a          = color_a;
+  dab.hardness         = hardness;
+  dab.aspect_ratio     = aspect_ratio;
+  dab.sn               = sin (angle_rad);
+  dab.cs               = cos (angle_rad);
+  dab.one_over_radius2 = 1.0f / (radius * radius);
+  dab.segment1_slope   = -(1.0f / hardness - 1.0f);
+  dab.segment2_slope   = -hardness / (1.0f - hardness);
+  dab.r_aa_start       = MAX (radius - 1.0f, 0);
+  dab.r_aa_start       = (dab.r_aa_start * dab.r_aa_start) / aspect_ratio;
+  dab.normal_mode      = opaque * (1.0f - colorize) * (1.0f - posterize);
+  dab.colorize         = opaque * colorize;
+  dab.posterize        = posterize;
+  dab.posterize_num    = posterize_num;
+
+  if (surface->dabs->len >= MAX_QUEUED_DABS)
+    gimp_mypaint_surface_flush (surface);
+
+  g_array_append_val (surface->dabs, dab);
+
+  gegl_rectangle_bounding_box (&surface->dabs_bounds,
+                               &surface->dabs_bounds, &dabRect);
 
   return 1;
 }
@@ -582,6 +790,26 @@ gimp_mypaint_surface_draw_dab_wrapper (MyPaintSurface *surface,
                                           pigment);
 }
 
+static void
+gimp_mypaint_surface_invalidate_color_tiles (GimpMybrushSurface  *surface,
+                                             const GeglRectangle *rect)
+{
+  gint tile_x, tile_y;
+
+  for (tile_y = tile_index (rect->y);
+       tile_y <= tile_index (rect->y + rect->height - 1);
+       tile_y++)
+    {
+      for (tile_x = tile_index (rect->x);
+           tile_x <= tile_index (rect->x + rect->width - 1);
+           tile_x++)
+        {
+          g_hash_table_remove (surface->color_tiles,
+                               tile_key (tile_x, tile_y));
+        }
+    }
+}
+
 static void
 gimp_mypaint_surface_begin_atomic (MyPaintSurface *base_surface)
 {
@@ -594,6 +822,8 @@ gimp_mypaint_surface_end_atomic_2 (MyPaintSurface2   *base_surface,
 {
   GimpMybrushSurface *surface = (GimpMybrushSurface *)base_surface;
 
+  gimp_mypaint_surface_flush (surface);
+
   if (rois)
     {
       const gint roi_rects = rois->num_rectangles;
@@ -625,6 +855,8 @@ gimp_mypaint_surface_destroy (MyPaintSurface *base_surface)
 
   g_clear_object (&surface->buffer);
   g_clear_object (&surface->paint_mask);
+  g_array_free (surface->dabs, TRUE);
+  g_hash_table_unref (surface->color_tiles);
   g_free (surface);
 }
 
@@ -666,6 +898,19 @@ gimp_mypaint_surface_new (GeglBuffer         *buffer,
   surface->off_x          = 0;
   surface->off_y          = 0;
 
+  /* XXX What spaces should we be working from and to? */
+  surface->rgb_to_hsl_fish = babl_fish (babl_format ("R'G'B' float"),
+                                        babl_format ("HSL float"));
+  surface->hsl_to_rgb_fish = babl_fish (babl_format ("HSL float"),
+                                        babl_format ("R'G'B' float"));
+
+  surface->dabs           = g_array_new (FALSE, FALSE, sizeof (GimpMybrushDab));
+  surface->dabs_bounds    = *GEGL_RECTANGLE (0, 0, 0, 0);
+  surface->color_tiles    = g_hash_table_new_full (g_direct_hash,
+                                                   g_direct_equal,
+                                                   NULL,
+                                                   g_free);
+
   return surface;
 }
 
@@ -675,6 +920,10 @@ gimp_mypaint_surface_set_buffer (GimpMybrushSurface *surface,
                                  gint                paint_mask_x,
                                  gint                paint_mask_y)
 {
+  gimp_mypaint_surface_flush (surface);
+
+  g_hash_table_remove_all (surface->color_tiles);
+
   g_object_unref (surface->buffer);
 
   surface->buffer = g_object_ref (buffer);
@@ -700,3 +949,78 @@ gimp_mypaint_surface_get_offset (GimpMybrushSurface *surface,
   *off_x = surface->off_x;
   *off_y = surface->off_y;
 }
+
+void
+gimp_mypaint_surface_flush (GimpMybrushSurface *surface)
+{
+  GimpMybrushFlushData  data;
+  GeglRectangle         bounds = surface->dabs_bounds;
+  gint                  n_tiles_y;
+  gint                  n_tiles;
+  guint                 i;
+
+  if (surface->dabs->len == 0)
+    return;
+
+  data.surface   = surface;
+  data.tile_x    = tile_index (bounds.x);
+  data.tile_y    = tile_index (bounds.y);
+  data.n_tiles_x = tile_index (bounds.x + bounds.width  - 1) - data.tile_x + 1;
+  n_tiles_y      = tile_index (bounds.y + bounds.height - 1) - data.tile_y + 1;
+  n_tiles        = data.n_tiles_x * n_tiles_y;
+
+  /* bin the queued dabs into the tiles they touch, keeping their order */
+  data.tile_dabs = g_new0 (GArray *, n_tiles);
+
+  for (i = 0; i < surface->dabs->len; i++)
+    {
+      const GimpMybrushDab *dab = &g_array_index (surface->dabs,
+                                                  GimpMybrushDab, i);
+      gint                  tile_x, tile_y;
+
+      for (tile_y = tile_index (dab->rect.y);
+           tile_y <= tile_index (dab->rect.y + dab->rect.height - 1);
+           tile_y++)
+        {
+          for (tile_x = tile_index (dab->rect.x);
+               tile_x <= tile_index (dab->rect.x + dab->rect.width - 1);
+               tile_x++)
+            {
+              gint index = (tile_y - data.tile_y) * data.n_tiles_x +
+                           (tile_x - data.tile_x);
+
+              if (! data.tile_dabs[index])
+                data.tile_dabs[index] = g_array_new (FALSE, FALSE,
+                                                     sizeof (guint));
+
+              g_array_append_val (data.tile_dabs[index], i);
+            }
+        }
+    }
+
+  /* tiles are independent, so they can be processed in parallel */
+  if (n_tiles == 1)
+    {
+      gimp_mypaint_surface_process_tiles (0, 1, &data);
+    }
+  else
+    {
+      gegl_parallel_distribute_range (
+        n_tiles, PIXELS_PER_THREAD / (TILE_SIZE * TILE_SIZE),
+        (GeglParallelDistributeRangeFunc) gimp_mypaint_surface_process_tiles,
+        &data);
+    }
+
+  for (i = 0; i < (guint) n_tiles; i++)
+    {
+      if (data.tile_dabs[i])
+        g_array_free (data.tile_dabs[i], TRUE);
+    }
+
+  g_free (data.tile_dabs);
+
+  gimp_mypaint_surface_invalidate_color_tiles (surface, &bounds);
+
+  g_array_set_size (surface->dabs, 0);
+  surface->dabs_bounds = *GEGL_RECTANGLE (0, 0, 0, 0);
+}
@@ -92,6 +92,7 @@ gimp_paintbrush_class_init (GimpPaintbrushClass *klass)
   paint_core_class->paint                  = gimp_paintbrush_paint;
 
   brush_core_class->handles_changing_brush = TRUE;
+  brush_core_class->handles_parallel_dabs  = TRUE;
 
   klass->get_color_history_color           = gimp_paintbrush_real_get_color_history_color;
   klass->get_paint_params                  = gimp_paintbrush_real_get_paint_params;
@@ -39,6 +39,7 @@
 #include "gegl/gimpapplicator.h"
 
 #include "core/gimp.h"
+#include "core/gimp-memory-tags.h"
 #include "core/gimp-utils.h"
 #include "core/gimpchannel.h"
 #include "core/gimpimage.h"
@@ -60,11 +61,25 @@
 
 #include "gimpairbrush.h"
 
+#include "gimp-log.h"
+
 #include "gimp-intl.h"
 
 
 #define STROKE_BUFFER_INIT_SIZE 2000
 
+/*  the maximal number of dabs, and the maximal amount of memory they use,
+ *  queued by a paste batch before it's flushed
+ */
+#define PASTE_BATCH_MAX_DABS    64
+#define PASTE_BATCH_MAX_SIZE    (64 << 20)
+
+#define PIXELS_PER_THREAD \
+  (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
+
+/*  the maximal number of drawable undos a stroke pushes per drawable  */
+#define MAX_UNDO_RECTS          32
+
 enum
 {
   PROP_0,
@@ -72,6 +87,22 @@ enum
 };
 
 
+typedef struct
+{
+  GimpDrawable                *drawable;
+  GeglRectangle                rect;
+  GimpPaintCoreLoopsParams     params;
+  GimpPaintCoreLoopsAlgorithm  algorithms;
+  gint                         wave;
+} PasteDab;
+
+typedef struct
+{
+  PasteDab *dabs;
+  gint     *indices;
+} PasteWaveData;
+
+
 /*  local function prototypes  */
 
 static void      gimp_paint_core_finalize            (GObject          *object);
@@ -123,6 +154,18 @@ static GimpUndo* gimp_paint_core_real_push_undo      (GimpPaintCore    *core,
                                                       GimpImage        *image,
                                                       const gchar      *undo_desc);
 
+static void      gimp_paint_core_queue_paste         (GimpPaintCore    *core,
+                                                      GimpDrawable     *drawable,
+                                                      const GimpPaintCoreLoopsParams *params,
+                                                      GimpPaintCoreLoopsAlgorithm     algorithms,
+                                                      gint              width,
+                                                      gint              height);
+static void      gimp_paint_core_flush_paste_batch   (GimpPaintCore    *core);
+
+static cairo_region_t *
+                 gimp_paint_core_get_undo_region     (GimpPaintCore    *core,
+                                                      const GeglRectangle *rect);
+
 
 G_DEFINE_TYPE (GimpPaintCore, gimp_paint_core, GIMP_TYPE_OBJECT)
 
@@ -163,6 +206,7 @@ gimp_paint_core_init (GimpPaintCore *core)
                                               NULL, g_object_unref);
   core->original_bounds = g_hash_table_new_full (g_direct_hash, g_direct_equal,
                                                  NULL, g_free);
+  core->undo_tiles = g_hash_table_new (g_direct_hash, g_direct_equal);
 }
 
 static void
@@ -175,6 +219,7 @@ gimp_paint_core_finalize (GObject *object)
   g_clear_pointer (&core->undo_desc, g_free);
   g_hash_table_unref (core->undo_buffers);
   g_hash_table_unref (core->original_bounds);
+  g_hash_table_unref (core->undo_tiles);
   if (core->applicators)
     g_hash_table_unref (core->applicators);
 
@@ -341,10 +386,14 @@ gimp_paint_core_paint (GimpPaintCore    *core,
       sym = g_object_ref (gimp_image_get_active_symmetry (image));
       gimp_symmetry_set_origin (sym, drawables->data, &core->cur_coords);
 
+      gimp_memory_tags_push (GIMP_MEMORY_TAG_PAINT, image);
+
       core_class->paint (core, drawables,
                          paint_options,
                          sym, paint_state, time);
 
+      gimp_memory_tags_pop ();
+
       gimp_symmetry_clear_origin (sym);
       g_object_unref (sym);
 
@@ -450,6 +499,13 @@ gimp_paint_core_start (GimpPaintCore     *core,
   core->x1 = core->x2 = core->cur_coords.x;
   core->y1 = core->y2 = core->cur_coords.y;
 
+  g_hash_table_remove_all (core->undo_tiles);
+
+  g_object_get (core->canvas_buffer,
+                "tile-width",  &core->undo_tile_width,
+                "tile-height", &core->undo_tile_height,
+                NULL);
+
   core->last_paint.x = -1e6;
   core->last_paint.y = -1e6;
 
@@ -580,28 +636,52 @@ gimp_paint_core_finish (GimpPaintCore *core,
               rect.width == old_rect.width &&
               rect.height == old_rect.height)
             {
+              cairo_region_t *region;
+              gint            n_rects;
+              gint            i;
+
               gimp_rectangle_intersect (core->x1, core->y1, core->x2 - core->x1,
                                         core->y2 - core->y1, 0, 0,
                                         gimp_item_get_width  (GIMP_ITEM (iter->data)),
                                         gimp_item_get_height (GIMP_ITEM (iter->data)),
                                         &rect.x, &rect.y, &rect.width, &rect.height);
 
-              gegl_rectangle_align_to_buffer (&rect, &rect, undo_buffer,
-                                              GEGL_RECTANGLE_ALIGNMENT_SUPERSET);
-
               GIMP_PAINT_CORE_GET_CLASS (core)->push_undo (core, image, NULL);
 
-              buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0, rect.width, rect.height),
-                                        gimp_drawable_get_format (iter->data));
+              /*  only keep the tiles which have actually been painted,
+               *  rather than the stroke's whole bounding box
+               */
+              region  = gimp_paint_core_get_undo_region (core, &rect);
+              n_rects = cairo_region_num_rectangles (region);
 
-              gimp_gegl_buffer_copy (undo_buffer,
-                                     &rect,
-                                     GEGL_ABYSS_NONE,
-                                     buffer,
-                                     GEGL_RECTANGLE (0, 0, 0, 0));
+              for (i = 0; i < n_rects; i++)
+                {
+                  cairo_rectangle_int_t undo_rect;
+
+                  cairo_region_get_rectangle (region, i, &undo_rect);
+
+                  buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0,
+                                                            undo_rect.width,
+                                                            undo_rect.height),
+                                            gimp_drawable_get_format (iter->data));
+
+                  gimp_gegl_buffer_copy (undo_buffer,
+                                         (GeglRectangle *) &undo_rect,
+                                         GEGL_ABYSS_NONE,
+                                         buffer,
+                                         GEGL_RECTANGLE (0, 0, 0, 0));
+
+                  gimp_drawable_push_undo (iter->data, NULL,
+                                           buffer,
+                                           undo_rect.x, undo_rect.y,
+                                           undo_rect.width, undo_rect.height);
 
-              gimp_drawable_push_undo (iter->data, NULL,
-                                       buffer, rect.x, rect.y, rect.width, rect.height);
+                  g_object_unref (buffer);
+                }
+
+              cairo_region_destroy (region);
+
+              buffer = NULL;
             }
           else
             {
@@ -677,7 +757,7 @@ gimp_paint_core_finish (GimpPaintCore *core,
               g_object_unref (drawable_buffer);
             }
 
-          g_object_unref (buffer);
+          g_clear_object (&buffer);
           g_object_unref (undo_buffer);
         }
 
@@ -842,6 +922,8 @@ gimp_paint_core_cleanup (GimpPaintCore *core)
 {
   g_return_if_fail (GIMP_IS_PAINT_CORE (core));
 
+  gimp_paint_core_end_paste_batch (core);
+
   g_hash_table_remove_all (core->undo_buffers);
   g_hash_table_remove_all (core->original_bounds);
 
@@ -1014,6 +1096,9 @@ gimp_paint_core_expand_drawable (GimpPaintCore    *core,
       GeglBuffer   *undo_buffer;
       GeglBuffer   *new_buffer;
 
+      /*  the queued dabs refer to the drawable's current buffer  */
+      gimp_paint_core_flush_paste_batch (core);
+
       if (gimp_item_get_lock_position (GIMP_ITEM (layer)))
         {
           if (core->lock_blink_state == GIMP_PAINT_LOCK_NOT_BLINKED)
@@ -1238,6 +1323,80 @@ gimp_paint_core_get_image_pickable (GimpPaintCore *core)
   return core->image_pickable;
 }
 
+/*  while a paste batch is active, gimp_paint_core_paste() queues the dabs
+ *  instead of pasting them right away.  when the batch is flushed, dabs
+ *  that don't overlap each other are pasted in parallel, while each dab
+ *  is still pasted after all the earlier dabs it overlaps, so the result
+ *  is the same as pasting them one by one.
+ *
+ *  this is only valid for tools whose dabs don't read the drawable or the
+ *  canvas buffer, other than through the paste itself.
+ */
+void
+gimp_paint_core_begin_paste_batch (GimpPaintCore *core)
+{
+  g_return_if_fail (GIMP_IS_PAINT_CORE (core));
+  g_return_if_fail (core->paste_batch == NULL);
+
+  core->paste_batch      = g_array_new (FALSE, FALSE, sizeof (PasteDab));
+  core->paste_batch_size = 0;
+}
+
+void
+gimp_paint_core_end_paste_batch (GimpPaintCore *core)
+{
+  g_return_if_fail (GIMP_IS_PAINT_CORE (core));
+
+  if (core->paste_batch)
+    {
+      gimp_paint_core_flush_paste_batch (core);
+
+      g_array_free (core->paste_batch, TRUE);
+      core->paste_batch = NULL;
+    }
+}
+
+/*  Record that the given area, in drawable coordinates, is being
+ *  painted, and needs to be restored on undo.
+ */
+void
+gimp_paint_core_add_undo_area (GimpPaintCore *core,
+                               gint           x,
+                               gint           y,
+                               gint           width,
+                               gint           height)
+{
+  gint tile_x1, tile_y1;
+  gint tile_x2, tile_y2;
+  gint tile_x,  tile_y;
+
+  g_return_if_fail (GIMP_IS_PAINT_CORE (core));
+
+  if (width <= 0 || height <= 0)
+    return;
+
+  core->x1 = MIN (core->x1, x);
+  core->y1 = MIN (core->y1, y);
+  core->x2 = MAX (core->x2, x + width);
+  core->y2 = MAX (core->y2, y + height);
+
+  /*  the undo only covers the drawable, so the tiles left or above of it
+   *  don't matter
+   */
+  tile_x1 = MAX (x,              0) / core->undo_tile_width;
+  tile_y1 = MAX (y,              0) / core->undo_tile_height;
+  tile_x2 = MAX (x + width  - 1, 0) / core->undo_tile_width;
+  tile_y2 = MAX (y + height - 1, 0) / core->undo_tile_height;
+
+  for (tile_y = tile_y1; tile_y <= tile_y2; tile_y++)
+    for (tile_x = tile_x1; tile_x <= tile_x2; tile_x++)
+      {
+        g_hash_table_add (core->undo_tiles,
+                          GUINT_TO_POINTER ((guint) tile_x |
+                                            ((guint) tile_y << 16)));
+      }
+}
+
 GeglBuffer *
 gimp_paint_core_get_orig_image (GimpPaintCore *core,
                                 GimpDrawable  *drawable)
@@ -1276,12 +1435,16 @@ gimp_paint_core_paste (GimpPaintCore            *core,
   gint               height = gegl_buffer_get_height (core->paint_buffer);
   GimpComponentMask  affect = gimp_drawable_get_active_mask (drawable);
   GeglBuffer        *undo_buffer;
+  gboolean           queued = FALSE;
+  GIMP_TRACE_SPAN (span);
 
   undo_buffer = g_hash_table_lookup (core->undo_buffers, drawable);
 
   if (! affect)
     return;
 
+  GIMP_TRACE_BEGIN (span, "paint-core-paste");
+
   if (core->applicators)
     {
       GimpApplicator *applicator;
@@ -1375,7 +1538,11 @@ gimp_paint_core_paste (GimpPaintCore            *core,
       params.paint_buf_offset_y = core->paint_buffer_y;
 
       if (! params.paint_buf)
-        return;
+        {
+          GIMP_TRACE_END (span);
+
+          return;
+        }
 
       params.dest_buffer = gimp_drawable_get_buffer (drawable);
 
@@ -1437,20 +1604,34 @@ gimp_paint_core_paste (GimpPaintCore            *core,
           algorithms |= GIMP_PAINT_CORE_LOOPS_ALGORITHM_MASK_COMPONENTS;
         }
 
-      gimp_paint_core_loops_process (&params, algorithms);
+      if (core->paste_batch)
+        {
+          /*  the drawable is updated when the batch is flushed  */
+          gimp_paint_core_queue_paste (core, drawable, &params, algorithms,
+                                       width, height);
+          queued = TRUE;
+        }
+      else
+        {
+          gimp_paint_core_loops_process (&params, algorithms);
+        }
     }
 
   /*  Update the undo extents  */
-  core->x1 = MIN (core->x1, core->paint_buffer_x);
-  core->y1 = MIN (core->y1, core->paint_buffer_y);
-  core->x2 = MAX (core->x2, core->paint_buffer_x + width);
-  core->y2 = MAX (core->y2, core->paint_buffer_y + height);
+  gimp_paint_core_add_undo_area (core,
+                                 core->paint_buffer_x, core->paint_buffer_y,
+                                 width, height);
 
   /*  Update the drawable  */
-  gimp_drawable_update (drawable,
-                        core->paint_buffer_x,
-                        core->paint_buffer_y,
-                        width, height);
+  if (! queued)
+    {
+      gimp_drawable_update (drawable,
+                            core->paint_buffer_x,
+                            core->paint_buffer_y,
+                            width, height);
+    }
+
+  GIMP_TRACE_END (span);
 }
 
 /* This works similarly to gimp_paint_core_paste. However, instead of
@@ -1488,6 +1669,9 @@ gimp_paint_core_replace (GimpPaintCore            *core,
       return;
     }
 
+  /*  replacing reads the drawable, so paste the queued dabs first  */
+  gimp_paint_core_flush_paste_batch (core);
+
   width  = gegl_buffer_get_width  (core->paint_buffer);
   height = gegl_buffer_get_height (core->paint_buffer);
 
@@ -1640,10 +1824,9 @@ gimp_paint_core_replace (GimpPaintCore            *core,
     }
 
   /*  Update the undo extents  */
-  core->x1 = MIN (core->x1, core->paint_buffer_x);
-  core->y1 = MIN (core->y1, core->paint_buffer_y);
-  core->x2 = MAX (core->x2, core->paint_buffer_x + width);
-  core->y2 = MAX (core->y2, core->paint_buffer_y + height);
+  gimp_paint_core_add_undo_area (core,
+                                 core->paint_buffer_x, core->paint_buffer_y,
+                                 width, height);
 
   /*  Update the drawable  */
   gimp_drawable_update (drawable,
@@ -1718,3 +1901,204 @@ gimp_paint_core_smooth_coords (GimpPaintCore    *core,
         }
     }
 }
+
+
+/*  private functions  */
+
+static void
+gimp_paint_core_queue_paste (GimpPaintCore                  *core,
+                             GimpDrawable                   *drawable,
+                             const GimpPaintCoreLoopsParams *params,
+                             GimpPaintCoreLoopsAlgorithm     algorithms,
+                             gint                            width,
+                             gint                            height)
+{
+  PasteDab dab;
+
+  dab.drawable   = drawable;
+  dab.rect       = *GEGL_RECTANGLE (params->paint_buf_offset_x,
+                                    params->paint_buf_offset_y,
+                                    width, height);
+  dab.params     = *params;
+  dab.algorithms = algorithms;
+  dab.wave       = 0;
+
+  /*  the paint buffer and the paint mask are reused by the next dab  */
+  dab.params.paint_buf = gimp_temp_buf_copy (params->paint_buf);
+
+  core->paste_batch_size += gimp_temp_buf_get_data_size (dab.params.paint_buf);
+
+  if (params->paint_mask)
+    {
+      dab.params.paint_mask = gimp_temp_buf_copy (params->paint_mask);
+
+      core->paste_batch_size +=
+        gimp_temp_buf_get_data_size (dab.params.paint_mask);
+    }
+
+  g_array_append_val (core->paste_batch, dab);
+
+  if (core->paste_batch->len >= PASTE_BATCH_MAX_DABS ||
+      core->paste_batch_size >= PASTE_BATCH_MAX_SIZE)
+    {
+      gimp_paint_core_flush_paste_batch (core);
+    }
+}
+
+static void
+gimp_paint_core_paste_wave_range (gsize          offset,
+                                  gsize          size,
+                                  PasteWaveData *data)
+{
+  gsize i;
+
+  for (i = offset; i < offset + size; i++)
+    {
+      const PasteDab *dab = &data->dabs[data->indices[i]];
+
+      gimp_paint_core_loops_process (&dab->params, dab->algorithms);
+    }
+}
+
+static void
+gimp_paint_core_flush_paste_batch (GimpPaintCore *core)
+{
+  PasteDab      *dabs;
+  PasteWaveData  data;
+  gint          *indices;
+  gint           n_dabs;
+  gint           n_waves = 0;
+  gint           wave;
+  gint           i, j;
+
+  if (! core->paste_batch || ! core->paste_batch->len)
+    return;
+
+  dabs   = (PasteDab *) core->paste_batch->data;
+  n_dabs = core->paste_batch->len;
+
+  /*  each dab goes in the wave following the last wave containing a dab it
+   *  overlaps, so that the dabs of each wave are disjoint
+   */
+  for (j = 0; j < n_dabs; j++)
+    {
+      for (i = 0; i < j; i++)
+        {
+          if (dabs[i].wave >= dabs[j].wave &&
+              gegl_rectangle_intersect (NULL, &dabs[i].rect, &dabs[j].rect))
+            {
+              dabs[j].wave = dabs[i].wave + 1;
+            }
+        }
+
+      n_waves = MAX (n_waves, dabs[j].wave + 1);
+    }
+
+  indices = g_new (gint, n_dabs);
+
+  data.dabs    = dabs;
+  data.indices = indices;
+
+  for (wave = 0; wave < n_waves; wave++)
+    {
+      gdouble n_pixels = 0.0;
+      gint    n        = 0;
+
+      for (i = 0; i < n_dabs; i++)
+        {
+          if (dabs[i].wave == wave)
+            {
+              indices[n++] = i;
+
+              n_pixels += (gdouble) dabs[i].rect.width * dabs[i].rect.height;
+            }
+        }
+
+      /*  a single dab is pasted using the parallelism of the paste itself.
+       *  otherwise, distribute the dabs, in which case each paste runs on a
+       *  single thread.
+       */
+      if (n == 1 || n_pixels < 2.0 * PIXELS_PER_THREAD)
+        {
+          gimp_paint_core_paste_wave_range (0, n, &data);
+        }
+      else
+        {
+          gegl_parallel_distribute_range (
+            n, n * PIXELS_PER_THREAD / n_pixels,
+            (GeglParallelDistributeRangeFunc)
+              gimp_paint_core_paste_wave_range,
+            &data);
+        }
+    }
+
+  g_free (indices);
+
+  for (i = 0; i < n_dabs; i++)
+    {
+      gimp_drawable_update (dabs[i].drawable,
+                            dabs[i].rect.x,
+                            dabs[i].rect.y,
+                            dabs[i].rect.width,
+                            dabs[i].rect.height);
+
+      gimp_temp_buf_unref (dabs[i].params.paint_buf);
+
+      if (dabs[i].params.paint_mask)
+        gimp_temp_buf_unref ((GimpTempBuf *) dabs[i].params.paint_mask);
+    }
+
+  g_array_set_size (core->paste_batch, 0);
+  core->paste_batch_size = 0;
+}
+
+/*  Returns the painted tiles which intersect rect, as at most
+ *  MAX_UNDO_RECTS rectangles.  When there are too many of them, the
+ *  tiles are grouped into larger and larger blocks.
+ */
+static cairo_region_t *
+gimp_paint_core_get_undo_region (GimpPaintCore       *core,
+                                 const GeglRectangle *rect)
+{
+  cairo_region_t *region;
+  gint            shift = 0;
+
+  /*  painted by a core which doesn't record its undo area  */
+  if (g_hash_table_size (core->undo_tiles) == 0)
+    return cairo_region_create_rectangle ((const cairo_rectangle_int_t *) rect);
+
+  while (TRUE)
+    {
+      GHashTableIter iter;
+      gpointer       key;
+      gint           block_width  = core->undo_tile_width  << shift;
+      gint           block_height = core->undo_tile_height << shift;
+
+      region = cairo_region_create ();
+
+      g_hash_table_iter_init (&iter, core->undo_tiles);
+
+      while (g_hash_table_iter_next (&iter, &key, NULL))
+        {
+          guint                 tile = GPOINTER_TO_UINT (key);
+          cairo_rectangle_int_t block;
+
+          block.x      = ((tile & 0xffff) >> shift) * block_width;
+          block.y      = ((tile >> 16)    >> shift) * block_height;
+          block.width  = block_width;
+          block.height = block_height;
+
+          cairo_region_union_rectangle (region, &block);
+        }
+
+      cairo_region_intersect_rectangle (region,
+                                        (const cairo_rectangle_int_t *) rect);
+
+      if (cairo_region_num_rectangles (region) <= MAX_UNDO_RECTS)
+        return region;
+
+      cairo_region_destroy (region);
+
+      shift++;
+    }
+}
@@ -58,6 +58,9 @@ struct _GimpPaintCore
   GimpPickable   *image_pickable;    /*  the image pickable                  */
 
   GHashTable     *undo_buffers;      /*  pixels which have been modified     */
+  GHashTable     *undo_tiles;        /*  tiles which have been modified      */
+  gint            undo_tile_width;
+  gint            undo_tile_height;
   GeglBuffer     *saved_proj_buffer; /*  proj tiles which have been modified */
   GeglBuffer     *canvas_buffer;     /*  the buffer to paint the mask to     */
   GeglBuffer     *paint_buffer;      /*  the buffer to paint pixels to       */
@@ -69,6 +72,9 @@ struct _GimpPaintCore
 
   GHashTable     *applicators;
 
+  GArray         *paste_batch;       /*  dabs queued for pasting             */
+  gsize           paste_batch_size;  /*  memory used by the queued dabs      */
+
   GArray         *stroke_buffer;
 
   GimpSymmetry   *sym;
@@ -197,6 +203,15 @@ GeglBuffer * gimp_paint_core_get_paint_buffer       (GimpPaintCore    *core,
 
 GimpPickable * gimp_paint_core_get_image_pickable   (GimpPaintCore    *core);
 
+void      gimp_paint_core_begin_paste_batch         (GimpPaintCore    *core);
+void      gimp_paint_core_end_paste_batch           (GimpPaintCore    *core);
+
+void      gimp_paint_core_add_undo_area             (GimpPaintCore    *core,
+                                                     gint              x,
+                                                     gint              y,
+                                                     gint              width,
+                                                     gint              height);
+
 GeglBuffer * gimp_paint_core_get_orig_image         (GimpPaintCore    *core,
                                                      GimpDrawable     *drawable);
 GeglBuffer * gimp_paint_core_get_orig_proj          (GimpPaintCore    *core);
@@ -1370,10 +1370,42 @@ gimp_paint_options_copy_props (GimpPaintOptions    *src,
 
   if (n_props > 0)
     {
-      g_object_getv (G_OBJECT (src), n_props, names, values);
-      g_object_setv (G_OBJECT (dest), n_props, names, values);
+      GObjectClass *klass = G_OBJECT_GET_CLASS (dest);
+      GValue        dest_values[max_n_props];
+      gint          n_changed = 0;
 
-      while (n_props--)
-        g_value_unset (&values[n_props]);
+      g_object_getv (G_OBJECT (src),  n_props, names, values);
+      g_object_getv (G_OBJECT (dest), n_props, names, dest_values);
+
+      /*  only set the properties which differ, each notification
+       *  updates the option widgets
+       */
+      for (i = 0; i < n_props; i++)
+        {
+          GParamSpec *pspec = g_object_class_find_property (klass, names[i]);
+
+          if (g_param_values_cmp (pspec, &values[i], &dest_values[i]))
+            {
+              if (n_changed != i)
+                {
+                  names[n_changed]  = names[i];
+                  values[n_changed] = values[i];
+                }
+
+              n_changed++;
+            }
+          else
+            {
+              g_value_unset (&values[i]);
+            }
+
+          g_value_unset (&dest_values[i]);
+        }
+
+      if (n_changed > 0)
+        g_object_setv (G_OBJECT (dest), n_changed, names, values);
+
+      while (n_changed--)
+        g_value_unset (&values[n_changed]);
     }
 }
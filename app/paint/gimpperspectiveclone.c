@@ -118,6 +118,9 @@ gimp_perspective_clone_init (GimpPerspectiveClone *clone)
 
   gimp_matrix3_identity (&clone->transform);
   gimp_matrix3_identity (&clone->transform_inv);
+
+  gimp_matrix3_identity (&clone->matrix);
+  gimp_matrix3_identity (&clone->matrix_inv);
 }
 
 static void
@@ -182,6 +185,8 @@ gimp_perspective_clone_paint (GimpPaintCore    *paint_core,
 
           clone->node = gegl_node_new ();
 
+          clone->src_buffer = NULL;
+
           g_object_set (clone->node,
                         "cache-policy", GEGL_CACHE_POLICY_NEVER,
                         NULL);
@@ -371,6 +376,14 @@ gimp_perspective_clone_paint (GimpPaintCore    *paint_core,
                 }
             }
 
+          /*  the transform doesn't change between the dabs of one
+           *  motion, compute it, and its inverse, only once
+           */
+          gimp_perspective_clone_get_matrix (clone, &clone->matrix);
+
+          clone->matrix_inv = clone->matrix;
+          gimp_matrix3_invert (&clone->matrix_inv);
+
           for (GList *iter = drawables; iter; iter = iter->next)
             gimp_source_core_motion (source_core, iter->data, paint_options,
                                      (g_list_length (drawables) > 1), sym);
@@ -379,9 +392,12 @@ gimp_perspective_clone_paint (GimpPaintCore    *paint_core,
 
     case GIMP_PAINT_STATE_FINISH:
       g_clear_object (&clone->node);
+      g_clear_object (&clone->dest_buffer);
       clone->crop           = NULL;
       clone->transform_node = NULL;
+      clone->src_node       = NULL;
       clone->dest_node      = NULL;
+      clone->src_buffer     = NULL;
       break;
 
     default:
@@ -421,7 +437,7 @@ gimp_perspective_clone_get_source (GimpSourceCore   *source_core,
   gint                  x1d, y1d, x2d, y2d;
   gdouble               x1s, y1s, x2s, y2s, x3s, y3s, x4s, y4s;
   gint                  xmin, ymin, xmax, ymax;
-  GimpMatrix3           matrix;
+  gint                  width, height;
   GimpMatrix3           gegl_matrix;
 
   if (self_drawable)
@@ -440,10 +456,10 @@ gimp_perspective_clone_get_source (GimpSourceCore   *source_core,
    * the box to paint in destination area to its correspondent in
    * source area bearing in mind perspective
    */
-  gimp_perspective_clone_get_source_point (clone, x1d, y1d, &x1s, &y1s);
-  gimp_perspective_clone_get_source_point (clone, x1d, y2d, &x2s, &y2s);
-  gimp_perspective_clone_get_source_point (clone, x2d, y1d, &x3s, &y3s);
-  gimp_perspective_clone_get_source_point (clone, x2d, y2d, &x4s, &y4s);
+  gimp_matrix3_transform_point (&clone->matrix_inv, x1d, y1d, &x1s, &y1s);
+  gimp_matrix3_transform_point (&clone->matrix_inv, x1d, y2d, &x2s, &y2s);
+  gimp_matrix3_transform_point (&clone->matrix_inv, x2d, y1d, &x3s, &y3s);
+  gimp_matrix3_transform_point (&clone->matrix_inv, x2d, y2d, &x4s, &y4s);
 
   xmin = floor (MIN4 (x1s, x2s, x3s, x4s));
   ymin = floor (MIN4 (y1s, y2s, y3s, y4s));
@@ -464,12 +480,21 @@ gimp_perspective_clone_get_source (GimpSourceCore   *source_core,
           /* if the source area is completely out of the image */
           return NULL;
         }
-      else
+      else if (src_buffer != clone->src_buffer)
         {
+          /*  setting the buffer invalidates the whole graph, only do it
+           *  when the buffer actually changes
+           */
           gegl_node_set (clone->src_node,
                          "buffer", src_buffer,
                          NULL);
+
+          clone->src_buffer = src_buffer;
         }
+
+      gimp_source_core_prefetch (source_core, src_buffer,
+                                 GEGL_RECTANGLE (xmin, ymin,
+                                                 xmax - xmin, ymax - ymin));
       break;
 
     case GIMP_CLONE_PATTERN:
@@ -482,28 +507,49 @@ gimp_perspective_clone_get_source (GimpSourceCore   *source_core,
       break;
     }
 
-  dest_buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0, x2d - x1d, y2d - y1d),
-                                 src_format_alpha);
+  width  = x2d - x1d;
+  height = y2d - y1d;
+
+  /*  the paint buffer's size only changes with the brush, so the same
+   *  buffer can be rendered into for most dabs
+   */
+  dest_buffer = clone->dest_buffer;
+
+  if (! dest_buffer                                     ||
+      gegl_buffer_get_width  (dest_buffer) != width     ||
+      gegl_buffer_get_height (dest_buffer) != height    ||
+      gegl_buffer_get_format (dest_buffer) != src_format_alpha)
+    {
+      g_clear_object (&clone->dest_buffer);
+
+      dest_buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0, width, height),
+                                     src_format_alpha);
 
-  gimp_perspective_clone_get_matrix (clone, &matrix);
+      clone->dest_buffer = dest_buffer;
+
+      gegl_node_set (clone->dest_node,
+                     "buffer", dest_buffer,
+                     NULL);
+    }
+  else
+    {
+      /*  the transform doesn't necessarily cover all of it  */
+      gegl_buffer_clear (dest_buffer, NULL);
+    }
 
   gimp_matrix3_identity (&gegl_matrix);
-  gimp_matrix3_mult (&matrix, &gegl_matrix);
+  gimp_matrix3_mult (&clone->matrix, &gegl_matrix);
   gimp_matrix3_translate (&gegl_matrix, -x1d, -y1d);
 
   gimp_gegl_node_set_matrix (clone->transform_node, &gegl_matrix);
 
-  gegl_node_set (clone->dest_node,
-                 "buffer", dest_buffer,
-                 NULL);
-
   gegl_node_blit (clone->dest_node, 1.0,
-                  GEGL_RECTANGLE (0, 0, x2d - x1d, y2d - y1d),
+                  GEGL_RECTANGLE (0, 0, width, height),
                   NULL, NULL, 0, GEGL_BLIT_DEFAULT);
 
-  *src_rect = *GEGL_RECTANGLE (0, 0, x2d - x1d, y2d - y1d);
+  *src_rect = *GEGL_RECTANGLE (0, 0, width, height);
 
-  return dest_buffer;
+  return g_object_ref (dest_buffer);
 }
 
 
@@ -43,11 +43,17 @@ struct _GimpPerspectiveClone
   GimpMatrix3    transform;
   GimpMatrix3    transform_inv;
 
+  GimpMatrix3    matrix;       /* source to destination              */
+  GimpMatrix3    matrix_inv;   /* destination to source              */
+
   GeglNode      *node;
   GeglNode      *crop;
   GeglNode      *transform_node;
   GeglNode      *src_node;
   GeglNode      *dest_node;
+
+  GeglBuffer    *src_buffer;   /* src_node's buffer, not referenced  */
+  GeglBuffer    *dest_buffer;  /* dest_node's buffer, reused by dabs */
 };
 
 struct _GimpPerspectiveCloneClass
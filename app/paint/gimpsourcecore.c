@@ -26,6 +26,7 @@
 #include "paint-types.h"
 
 #include "gegl/gimp-gegl-utils.h"
+#include "gegl/gimptilehandlervalidate.h"
 
 #include "core/gimp.h"
 #include "core/gimpcontainer.h"
@@ -121,6 +122,8 @@ gimp_source_core_init (GimpSourceCore *source_core)
   source_core->offset_x      = 0;
   source_core->offset_y      = 0;
   source_core->first_stroke  = TRUE;
+
+  source_core->prefetch_buffer = NULL;
 }
 
 static gboolean
@@ -142,6 +145,8 @@ gimp_source_core_start (GimpPaintCore     *paint_core,
 
   paint_core->use_saved_proj = FALSE;
 
+  source_core->prefetch_buffer = NULL;
+
   if (! source_core->set_source &&
       gimp_source_core_use_source (source_core, options))
     {
@@ -532,6 +537,86 @@ gimp_source_core_use_source (GimpSourceCore    *source_core,
                                                                options);
 }
 
+/**
+ * gimp_source_core_prefetch:
+ * @source_core: a #GimpSourceCore
+ * @src_buffer:  the buffer the dab's source pixels are read from
+ * @src_rect:    the dab's source area, in @src_buffer's coordinates
+ *
+ * If @src_buffer is rendered on demand, like the projection of an
+ * image, validates the dab's source area, together with the area the
+ * next dabs are expected to read, extrapolated from the stroke's
+ * direction.  Rendering one larger area is considerably cheaper than
+ * letting each dab render the tiles it touches, and the following
+ * dabs then read from already valid tiles.
+ **/
+void
+gimp_source_core_prefetch (GimpSourceCore      *source_core,
+                           GeglBuffer          *src_buffer,
+                           const GeglRectangle *src_rect)
+{
+  GimpTileHandlerValidate *validate;
+  GeglRectangle            rect;
+  gint                     dx;
+  gint                     dy;
+
+  g_return_if_fail (GIMP_IS_SOURCE_CORE (source_core));
+  g_return_if_fail (GEGL_IS_BUFFER (src_buffer));
+  g_return_if_fail (src_rect != NULL);
+
+  validate = gimp_tile_handler_validate_get_assigned (src_buffer);
+
+  if (! validate)
+    return;
+
+  if (src_buffer != source_core->prefetch_buffer)
+    {
+      source_core->prefetch_buffer = src_buffer;
+      source_core->prefetch_rect   = *GEGL_RECTANGLE (0, 0, 0, 0);
+      source_core->last_src_rect   = *src_rect;
+    }
+
+  if (! gegl_rectangle_contains (&source_core->prefetch_rect, src_rect))
+    {
+      dx = src_rect->x - source_core->last_src_rect.x;
+      dy = src_rect->y - source_core->last_src_rect.y;
+
+      /*  look ahead about one dab's size in the stroke's direction  */
+      if (dx || dy)
+        {
+          gdouble scale = (gdouble) MAX (src_rect->width, src_rect->height) /
+                                    MAX (abs (dx), abs (dy));
+
+          scale = MAX (scale, 1.0);
+
+          dx = RINT (dx * scale);
+          dy = RINT (dy * scale);
+        }
+
+      rect = *src_rect;
+
+      gegl_rectangle_bounding_box (&rect, &rect,
+                                   GEGL_RECTANGLE (src_rect->x + dx,
+                                                   src_rect->y + dy,
+                                                   src_rect->width,
+                                                   src_rect->height));
+
+      gegl_rectangle_align_to_buffer (&rect, &rect, src_buffer,
+                                      GEGL_RECTANGLE_ALIGNMENT_SUPERSET);
+
+      if (gegl_rectangle_intersect (&rect, &rect,
+                                    gegl_buffer_get_extent (src_buffer)))
+        {
+          gimp_tile_handler_validate_validate (validate, src_buffer, &rect,
+                                               TRUE, FALSE);
+        }
+
+      source_core->prefetch_rect = rect;
+    }
+
+  source_core->last_src_rect = *src_rect;
+}
+
 static gboolean
 gimp_source_core_real_use_source (GimpSourceCore    *source_core,
                                   GimpSourceOptions *options)
@@ -613,5 +698,7 @@ gimp_source_core_real_get_source (GimpSourceCore   *source_core,
 
   *src_rect = *GEGL_RECTANGLE (x, y, width, height);
 
+  gimp_source_core_prefetch (source_core, dest_buffer, src_rect);
+
   return g_object_ref (dest_buffer);
 }
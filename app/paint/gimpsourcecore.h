@@ -42,6 +42,10 @@ struct _GimpSourceCore
   gint           offset_x;
   gint           offset_y;
   gboolean       first_stroke;
+
+  GeglBuffer    *prefetch_buffer;  /* not referenced, only compared  */
+  GeglRectangle  prefetch_rect;    /* the area already validated      */
+  GeglRectangle  last_src_rect;    /* the source area of the last dab */
 };
 
 struct _GimpSourceCoreClass
@@ -95,6 +99,10 @@ GType    gimp_source_core_get_type   (void) G_GNUC_CONST;
 gboolean gimp_source_core_use_source (GimpSourceCore    *source_core,
                                       GimpSourceOptions *options);
 
+void     gimp_source_core_prefetch   (GimpSourceCore      *source_core,
+                                      GeglBuffer          *src_buffer,
+                                      const GeglRectangle *src_rect);
+
 /* TEMP HACK */
 void     gimp_source_core_motion     (GimpSourceCore    *source_core,
                                       GimpDrawable      *drawable,
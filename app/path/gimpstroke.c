@@ -20,6 +20,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <cairo.h>
 #include <gegl.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
@@ -59,6 +61,10 @@ static void    gimp_stroke_finalize                  (GObject      *object);
 static gint64  gimp_stroke_get_memsize               (GimpObject   *object,
                                                       gint64       *gui_size);
 
+static gboolean gimp_stroke_interpolation_is_valid   (GimpStroke   *stroke,
+                                                      gdouble       precision);
+static void    gimp_stroke_interpolation_clear       (GimpStroke   *stroke);
+
 static GimpAnchor * gimp_stroke_real_anchor_get      (GimpStroke       *stroke,
                                                       const GimpCoords *coord);
 static GimpAnchor * gimp_stroke_real_anchor_get_next (GimpStroke       *stroke,
@@ -345,6 +351,8 @@ gimp_stroke_finalize (GObject *object)
   g_queue_free_full (stroke->anchors, (GDestroyNotify) gimp_anchor_free);
   stroke->anchors = NULL;
 
+  gimp_stroke_interpolation_clear (stroke);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -357,6 +365,12 @@ gimp_stroke_get_memsize (GimpObject *object,
 
   memsize += gimp_g_queue_get_memsize (stroke->anchors, sizeof (GimpAnchor));
 
+  if (stroke->interpolation)
+    memsize += stroke->interpolation->len * sizeof (GimpCoords);
+
+  if (stroke->interpolation_anchors)
+    memsize += stroke->interpolation_anchors->len * sizeof (GimpAnchor);
+
   return memsize + GIMP_OBJECT_CLASS (parent_class)->get_memsize (object,
                                                                   gui_size);
 }
@@ -1020,10 +1034,47 @@ gimp_stroke_interpolate (GimpStroke *stroke,
                          gdouble     precision,
                          gboolean   *ret_closed)
 {
+  GArray *coords;
+
   g_return_val_if_fail (GIMP_IS_STROKE (stroke), NULL);
 
-  return GIMP_STROKE_GET_CLASS (stroke)->interpolate (stroke, precision,
-                                                      ret_closed);
+  /*  the path bounds, its preview, the transform tools and stroking
+   *  all flatten the same strokes over and over again, so keep the
+   *  last result around until the anchors change
+   */
+  if (! gimp_stroke_interpolation_is_valid (stroke, precision))
+    {
+      GList *list;
+
+      gimp_stroke_interpolation_clear (stroke);
+
+      stroke->interpolation =
+        GIMP_STROKE_GET_CLASS (stroke)->interpolate (stroke, precision,
+                                                     &stroke->interpolation_closed);
+      stroke->interpolation_precision = precision;
+
+      stroke->interpolation_anchors =
+        g_array_sized_new (FALSE, FALSE, sizeof (GimpAnchor),
+                           stroke->anchors->length);
+
+      for (list = stroke->anchors->head; list; list = g_list_next (list))
+        g_array_append_val (stroke->interpolation_anchors,
+                            *GIMP_ANCHOR (list->data));
+    }
+
+  if (ret_closed)
+    *ret_closed = stroke->interpolation_closed;
+
+  if (! stroke->interpolation)
+    return NULL;
+
+  coords = g_array_sized_new (FALSE, FALSE, sizeof (GimpCoords),
+                              stroke->interpolation->len);
+  g_array_append_vals (coords,
+                       stroke->interpolation->data,
+                       stroke->interpolation->len);
+
+  return coords;
 }
 
 static GArray *
@@ -1491,3 +1542,46 @@ gimp_stroke_real_get_point_at_dist (GimpStroke *stroke,
 
   return ret;
 }
+
+
+/*  private functions  */
+
+static gboolean
+gimp_stroke_interpolation_is_valid (GimpStroke *stroke,
+                                    gdouble     precision)
+{
+  GList *list;
+  gint   i;
+
+  if (! stroke->interpolation_anchors                  ||
+      stroke->interpolation_precision != precision     ||
+      stroke->interpolation_anchors->len != stroke->anchors->length)
+    return FALSE;
+
+  /*  anchors are modified in place by a lot of code, inside and outside
+   *  of the stroke classes, so compare against the anchors the cached
+   *  interpolation was made from instead of relying on notifications
+   */
+  for (list = stroke->anchors->head, i = 0;
+       list;
+       list = g_list_next (list), i++)
+    {
+      const GimpAnchor *anchor = list->data;
+      const GimpAnchor *cached = &g_array_index (stroke->interpolation_anchors,
+                                                 GimpAnchor, i);
+
+      if (anchor->type != cached->type ||
+          memcmp (&anchor->position, &cached->position,
+                  sizeof (GimpCoords)))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+gimp_stroke_interpolation_clear (GimpStroke *stroke)
+{
+  g_clear_pointer (&stroke->interpolation,         g_array_unref);
+  g_clear_pointer (&stroke->interpolation_anchors, g_array_unref);
+}
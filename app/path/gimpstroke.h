@@ -41,6 +41,14 @@ struct _GimpStroke
   GQueue     *anchors;
 
   gboolean    closed;
+
+  /*  cached result of the last interpolation, together with the
+   *  anchors it was computed from
+   */
+  GArray     *interpolation;
+  GArray     *interpolation_anchors;
+  gdouble     interpolation_precision;
+  gboolean    interpolation_closed;
 };
 
 struct _GimpStrokeClass
@@ -27,6 +27,7 @@
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gegl.h>
 
+#include "libgimpbase/gimpbase.h"
 #include "libgimpcolor/gimpcolor.h"
 #include "libgimpconfig/gimpconfig.h"
 #include "libgimpmath/gimpmath.h"
@@ -43,6 +44,8 @@
 #include "core/gimpstrokeoptions.h"
 #include "core/gimpparasitelist.h"
 
+#include "gimpanchor.h"
+#include "gimpstroke.h"
 #include "gimpvectorlayer.h"
 #include "gimpvectorlayeroptions.h"
 #include "gimppath.h"
@@ -58,6 +61,16 @@ enum
 };
 
 
+typedef struct _GimpVectorLayerStroke GimpVectorLayerStroke;
+
+struct _GimpVectorLayerStroke
+{
+  gint      id;
+  gboolean  closed;
+  GArray   *anchors;
+};
+
+
 /* local function declarations */
 
 static void       gimp_vector_layer_finalize        (GObject                *object);
@@ -123,7 +136,32 @@ static void       gimp_vector_layer_transform       (GimpItem               *ite
                                                      gboolean                push_undo);
 
 static gboolean   gimp_vector_layer_render          (GimpVectorLayer        *layer);
-static void       gimp_vector_layer_render_path     (GimpVectorLayer        *layer);
+static void       gimp_vector_layer_render_path     (GimpVectorLayer        *layer,
+                                                     const GeglRectangle    *area);
+static void       gimp_vector_layer_set_styles      (GimpVectorLayer        *layer);
+static gboolean   gimp_vector_layer_get_damage      (GimpVectorLayer        *layer,
+                                                     GList                  *strokes,
+                                                     gint                    offset_x,
+                                                     gint                    offset_y,
+                                                     gint                    width,
+                                                     gint                    height,
+                                                     GeglRectangle          *damage);
+static void       gimp_vector_layer_store_state     (GimpVectorLayer        *layer,
+                                                     GList                  *strokes);
+static void       gimp_vector_layer_clear_state     (GimpVectorLayer        *layer);
+
+static GList    * gimp_vector_layer_strokes_new     (GimpPath               *path);
+static void       gimp_vector_layer_strokes_free    (GList                  *strokes);
+static GimpVectorLayerStroke *
+                  gimp_vector_layer_strokes_find    (GList                  *strokes,
+                                                     gint                    id);
+static void       gimp_vector_layer_stroke_extents  (GimpVectorLayerStroke  *stroke,
+                                                     gint                    index,
+                                                     gint                    radius,
+                                                     gdouble                *x1,
+                                                     gdouble                *y1,
+                                                     gdouble                *x2,
+                                                     gdouble                *y2);
 static void       gimp_vector_layer_changed_options (GimpVectorLayer        *layer);
 
 static void       gimp_vector_layer_removed         (GimpItem               *item);
@@ -205,6 +243,8 @@ gimp_vector_layer_finalize (GObject *object)
       layer->options = NULL;
     }
 
+  gimp_vector_layer_clear_state (layer);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -273,6 +313,8 @@ gimp_vector_layer_set_vector_options (GimpVectorLayer        *layer,
       layer->options = NULL;
     }
 
+  gimp_vector_layer_clear_state (layer);
+
   if (options)
     g_set_object (&layer->options, options);
 
@@ -688,60 +730,96 @@ gimp_item_is_vector_layer (GimpItem *item)
 static gboolean
 gimp_vector_layer_render (GimpVectorLayer *layer)
 {
-  GimpDrawable *drawable = GIMP_DRAWABLE (layer);
-  GeglBuffer   *buffer   = NULL;
-  GimpItem     *item     = GIMP_ITEM (layer);
-  GimpImage    *image    = gimp_item_get_image (item);
-  gint          layer_x  = 0;
-  gint          layer_y  = 0;
-  gint          x        = 0;
-  gint          y        = 0;
-  gint          width    = gimp_image_get_width (image);
-  gint          height   = gimp_image_get_height (image);
-  gdouble       stroke   = 0;
+  GimpDrawable  *drawable = GIMP_DRAWABLE (layer);
+  GeglBuffer    *buffer   = NULL;
+  GimpItem      *item     = GIMP_ITEM (layer);
+  GimpImage     *image    = gimp_item_get_image (item);
+  GList         *strokes;
+  GeglRectangle  damage;
+  gint           x        = 0;
+  gint           y        = 0;
+  gint           width    = gimp_image_get_width (image);
+  gint           height   = gimp_image_get_height (image);
+  gint           offset_x;
+  gint           offset_y;
+  gint           buffer_width;
+  gint           buffer_height;
+  gdouble        stroke   = 0;
 
   g_return_val_if_fail (gimp_item_is_attached (GIMP_ITEM (drawable)), FALSE);
 
   g_object_freeze_notify (G_OBJECT (drawable));
 
+  gimp_vector_layer_set_styles (layer);
+
   if (layer->options->enable_stroke)
     stroke = gimp_stroke_options_get_width (layer->options->stroke_options);
 
   /* Resize layer according to path size */
-  gimp_item_get_offset (GIMP_ITEM (layer), &layer_x, &layer_y);
   gimp_item_bounds (GIMP_ITEM (layer->options->path), &x, &y, &width, &height);
 
-  buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0,
-                                            (gint) ceil (width + stroke),
-                                            (gint) ceil (height + stroke)),
-                            gimp_drawable_get_format (drawable));
-  gimp_drawable_set_buffer (drawable, FALSE, NULL, buffer);
-  g_object_unref (buffer);
+  offset_x      = x - (stroke / 2);
+  offset_y      = y - (stroke / 2);
+  buffer_width  = ceil (width + stroke);
+  buffer_height = ceil (height + stroke);
 
-  gimp_item_set_offset (GIMP_ITEM (layer), x - (stroke / 2), y - (stroke / 2));
+  strokes = gimp_vector_layer_strokes_new (layer->options->path);
+
+  if (gimp_vector_layer_get_damage (layer, strokes,
+                                    offset_x, offset_y,
+                                    buffer_width, buffer_height,
+                                    &damage))
+    {
+      /* only the changed segments need to be drawn again */
+      if (damage.width > 0 && damage.height > 0)
+        {
+          gegl_buffer_clear (gimp_drawable_get_buffer (drawable), &damage);
+
+          gimp_vector_layer_render_path (layer, &damage);
+
+          gimp_drawable_update (drawable,
+                                damage.x, damage.y,
+                                damage.width, damage.height);
+        }
+    }
+  else
+    {
+      buffer = gegl_buffer_new (GEGL_RECTANGLE (0, 0,
+                                                buffer_width, buffer_height),
+                                gimp_drawable_get_format (drawable));
+      gimp_drawable_set_buffer (drawable, FALSE, NULL, buffer);
+      g_object_unref (buffer);
 
-  /* make the layer background transparent */
-  gimp_drawable_fill (GIMP_DRAWABLE (layer),
-                      gimp_get_user_context (image->gimp),
-                      GIMP_FILL_TRANSPARENT);
+      gimp_item_set_offset (GIMP_ITEM (layer), offset_x, offset_y);
 
-  /* render path to the layer */
-  gimp_vector_layer_render_path (layer);
+      /* make the layer background transparent */
+      gimp_drawable_fill (GIMP_DRAWABLE (layer),
+                          gimp_get_user_context (image->gimp),
+                          GIMP_FILL_TRANSPARENT);
+
+      /* render path to the layer */
+      gimp_vector_layer_render_path (layer, NULL);
+    }
+
+  gimp_vector_layer_store_state (layer, strokes);
 
   g_object_thaw_notify (G_OBJECT (drawable));
 
   return TRUE;
 }
 
+/* renders the fill and stroke of the layer's path, clipped to
+ * @area if it is not NULL
+ */
 static void
-gimp_vector_layer_render_path (GimpVectorLayer *layer)
+gimp_vector_layer_render_path (GimpVectorLayer     *layer,
+                               const GeglRectangle *area)
 {
   GimpImage              *image     = gimp_item_get_image (GIMP_ITEM (layer));
   GimpVectorLayerOptions *options   = layer->options;
   GimpPath               *path      = NULL;
   GimpChannel            *selection = gimp_image_get_mask (image);
   GList                  *drawables;
-  GimpCustomStyle         style;
 
   if (options)
     path = options->path;
@@ -749,6 +827,44 @@ gimp_vector_layer_render_path (GimpVectorLayer *layer)
   /* Don't mask these fill/stroke operations  */
   gimp_selection_suspend (GIMP_SELECTION (selection));
 
+  /* Fill the path object onto the layer */
+  if (options->enable_fill)
+    gimp_drawable_fill_path_area (GIMP_DRAWABLE (layer),
+                                  options->fill_options,
+                                  path, area, FALSE, NULL);
+
+  /* stroke the path object onto the layer */
+  if (options->enable_stroke && gimp_item_is_attached (GIMP_ITEM (path)))
+    {
+      if (area)
+        {
+          gimp_drawable_stroke_path_area (GIMP_DRAWABLE (layer),
+                                          options->stroke_options,
+                                          path, area, FALSE, NULL);
+        }
+      else
+        {
+          drawables = g_list_prepend (NULL, GIMP_DRAWABLE (layer));
+
+          gimp_item_stroke (GIMP_ITEM (path), drawables,
+                            gimp_get_user_context (image->gimp),
+                            options->stroke_options,
+                            FALSE, FALSE,
+                            NULL, NULL);
+
+          g_list_free (drawables);
+        }
+    }
+
+  gimp_selection_resume (GIMP_SELECTION (selection));
+}
+
+static void
+gimp_vector_layer_set_styles (GimpVectorLayer *layer)
+{
+  GimpVectorLayerOptions *options = layer->options;
+  GimpCustomStyle         style;
+
   /* Convert from custom to standard styles */
   style = gimp_fill_options_get_custom_style (options->fill_options);
   if (style == GIMP_CUSTOM_STYLE_SOLID_COLOR ||
@@ -768,25 +884,321 @@ gimp_vector_layer_render_path (GimpVectorLayer *layer)
   else
     gimp_fill_options_set_style (GIMP_FILL_OPTIONS (options->stroke_options),
                                  GIMP_FILL_STYLE_PATTERN);
+}
 
-  /* Fill the path object onto the layer */
-  if (options->enable_fill)
-    gimp_drawable_fill_path (GIMP_DRAWABLE (layer),
-                             options->fill_options,
-                             path, FALSE, NULL);
+/* Finds the part of the layer that has to be rendered again after the
+ * path changed, in layer coordinates.  Returns FALSE if the whole
+ * layer needs to be rendered again instead.
+ */
+static gboolean
+gimp_vector_layer_get_damage (GimpVectorLayer *layer,
+                              GList           *strokes,
+                              gint             offset_x,
+                              gint             offset_y,
+                              gint             width,
+                              gint             height,
+                              GeglRectangle   *damage)
+{
+  GimpVectorLayerOptions *options = layer->options;
+  GimpItem               *item    = GIMP_ITEM (layer);
+  GList                  *list;
+  gdouble                 x1      = G_MAXDOUBLE;
+  gdouble                 y1      = G_MAXDOUBLE;
+  gdouble                 x2      = -G_MAXDOUBLE;
+  gdouble                 y2      = -G_MAXDOUBLE;
+  gdouble                 margin  = 1.0;
+  gint                    off_x;
+  gint                    off_y;
+
+  if (! layer->render_fill_options || layer->modified)
+    return FALSE;
+
+  gimp_item_get_offset (item, &off_x, &off_y);
+
+  if (off_x  != offset_x                     ||
+      off_y  != offset_y                     ||
+      width  != gimp_item_get_width  (item) ||
+      height != gimp_item_get_height (item))
+    return FALSE;
+
+  if (gimp_item_get_tattoo (GIMP_ITEM (options->path)) !=
+      layer->render_path_tattoo                         ||
+      options->enable_fill   != layer->render_fill      ||
+      options->enable_stroke != layer->render_stroke)
+    return FALSE;
+
+  if (! gimp_config_is_equal_to (GIMP_CONFIG (options->fill_options),
+                                 GIMP_CONFIG (layer->render_fill_options)) ||
+      ! gimp_config_is_equal_to (GIMP_CONFIG (options->stroke_options),
+                                 GIMP_CONFIG (layer->render_stroke_options)))
+    return FALSE;
+
+  if (options->enable_stroke)
+    {
+      GimpStrokeOptions *stroke_options = options->stroke_options;
+      GArray            *dash_info;
+      GimpUnit          *unit;
+      gdouble            stroke_width;
 
-  drawables = g_list_prepend (NULL, GIMP_DRAWABLE (layer));
-  /* stroke the path object onto the layer */
-  if (options->enable_stroke && gimp_item_is_attached (GIMP_ITEM (path)))
-    gimp_item_stroke (GIMP_ITEM (path), drawables,
-                      gimp_get_user_context (image->gimp),
-                      options->stroke_options,
-                      FALSE, FALSE,
-                      NULL, NULL);
+      /*  painted strokes have no known extent, and changing the length
+       *  of a segment moves the dashes on all following segments
+       */
+      if (gimp_stroke_options_get_method (stroke_options) != GIMP_STROKE_LINE)
+        return FALSE;
 
-  g_list_free (drawables);
+      dash_info = gimp_stroke_options_get_dash_info (stroke_options);
 
-  gimp_selection_resume (GIMP_SELECTION (selection));
+      if (dash_info && dash_info->len > 0)
+        return FALSE;
+
+      stroke_width = gimp_stroke_options_get_width (stroke_options);
+      unit         = gimp_stroke_options_get_unit (stroke_options);
+
+      if (unit != gimp_unit_pixel ())
+        {
+          GimpImage *image = gimp_item_get_image (item);
+          gdouble    xres;
+          gdouble    yres;
+
+          gimp_image_get_resolution (image, &xres, &yres);
+
+          stroke_width = gimp_units_to_pixels (stroke_width, unit,
+                                               MAX (xres, yres));
+        }
+
+      /*  square caps reach out by half the width diagonally, miter
+       *  joins by up to miter-limit times half the width
+       */
+      if (gimp_stroke_options_get_join_style (stroke_options) ==
+          GIMP_JOIN_MITER)
+        margin += stroke_width / 2.0 *
+                  MAX (gimp_stroke_options_get_miter_limit (stroke_options),
+                       G_SQRT2);
+      else
+        margin += stroke_width / 2.0 * G_SQRT2;
+    }
+
+  /*  a bezier segment lies within the hull of its anchor and control
+   *  points, and the fill can only change in between the old and the
+   *  new segments, so the extents of both around every changed point
+   *  cover everything that needs to be drawn again
+   */
+  for (list = strokes; list; list = g_list_next (list))
+    {
+      GimpVectorLayerStroke *stroke = list->data;
+      GimpVectorLayerStroke *old_stroke;
+
+      old_stroke = gimp_vector_layer_strokes_find (layer->render_strokes,
+                                                   stroke->id);
+
+      if (! old_stroke)
+        {
+          gimp_vector_layer_stroke_extents (stroke, -1, 0,
+                                            &x1, &y1, &x2, &y2);
+        }
+      else if (old_stroke->closed       != stroke->closed ||
+               old_stroke->anchors->len != stroke->anchors->len)
+        {
+          gimp_vector_layer_stroke_extents (old_stroke, -1, 0,
+                                            &x1, &y1, &x2, &y2);
+          gimp_vector_layer_stroke_extents (stroke, -1, 0,
+                                            &x1, &y1, &x2, &y2);
+        }
+      else
+        {
+          gint i;
+
+          for (i = 0; i < stroke->anchors->len; i++)
+            {
+              GimpAnchor *anchor;
+              GimpAnchor *old_anchor;
+
+              anchor     = &g_array_index (stroke->anchors, GimpAnchor, i);
+              old_anchor = &g_array_index (old_stroke->anchors, GimpAnchor, i);
+
+              if (anchor->type != old_anchor->type ||
+                  anchor->position.x != old_anchor->position.x ||
+                  anchor->position.y != old_anchor->position.y)
+                {
+                  gimp_vector_layer_stroke_extents (old_stroke, i, 3,
+                                                    &x1, &y1, &x2, &y2);
+                  gimp_vector_layer_stroke_extents (stroke, i, 3,
+                                                    &x1, &y1, &x2, &y2);
+                }
+            }
+        }
+    }
+
+  for (list = layer->render_strokes; list; list = g_list_next (list))
+    {
+      GimpVectorLayerStroke *old_stroke = list->data;
+
+      if (! gimp_vector_layer_strokes_find (strokes, old_stroke->id))
+        gimp_vector_layer_stroke_extents (old_stroke, -1, 0,
+                                          &x1, &y1, &x2, &y2);
+    }
+
+  damage->x      = 0;
+  damage->y      = 0;
+  damage->width  = 0;
+  damage->height = 0;
+
+  if (x1 <= x2 && y1 <= y2)
+    {
+      gint dx1 = floor (x1 - margin) - off_x;
+      gint dy1 = floor (y1 - margin) - off_y;
+      gint dx2 = ceil  (x2 + margin) - off_x;
+      gint dy2 = ceil  (y2 + margin) - off_y;
+
+      if (! gimp_rectangle_intersect (dx1, dy1, dx2 - dx1, dy2 - dy1,
+                                      0, 0, width, height,
+                                      &damage->x, &damage->y,
+                                      &damage->width, &damage->height))
+        {
+          damage->width  = 0;
+          damage->height = 0;
+        }
+    }
+
+  return TRUE;
+}
+
+static void
+gimp_vector_layer_store_state (GimpVectorLayer *layer,
+                               GList           *strokes)
+{
+  GimpVectorLayerOptions *options = layer->options;
+
+  gimp_vector_layer_clear_state (layer);
+
+  layer->render_strokes        = strokes;
+  layer->render_fill_options   =
+    gimp_config_duplicate (GIMP_CONFIG (options->fill_options));
+  layer->render_stroke_options =
+    gimp_config_duplicate (GIMP_CONFIG (options->stroke_options));
+  layer->render_path_tattoo    = gimp_item_get_tattoo (GIMP_ITEM (options->path));
+  layer->render_fill           = options->enable_fill;
+  layer->render_stroke         = options->enable_stroke;
+}
+
+static void
+gimp_vector_layer_clear_state (GimpVectorLayer *layer)
+{
+  gimp_vector_layer_strokes_free (layer->render_strokes);
+  layer->render_strokes = NULL;
+
+  g_clear_object (&layer->render_fill_options);
+  g_clear_object (&layer->render_stroke_options);
+}
+
+static GList *
+gimp_vector_layer_strokes_new (GimpPath *path)
+{
+  GimpStroke *stroke;
+  GList      *strokes = NULL;
+
+  for (stroke = gimp_path_stroke_get_next (path, NULL);
+       stroke;
+       stroke = gimp_path_stroke_get_next (path, stroke))
+    {
+      GimpVectorLayerStroke *copy = g_slice_new (GimpVectorLayerStroke);
+      GList                 *list;
+
+      copy->id      = gimp_stroke_get_id (stroke);
+      copy->closed  = stroke->closed;
+      copy->anchors = g_array_sized_new (FALSE, FALSE, sizeof (GimpAnchor),
+                                         stroke->anchors->length);
+
+      for (list = stroke->anchors->head; list; list = g_list_next (list))
+        g_array_append_val (copy->anchors, *GIMP_ANCHOR (list->data));
+
+      strokes = g_list_prepend (strokes, copy);
+    }
+
+  return g_list_reverse (strokes);
+}
+
+static void
+gimp_vector_layer_strokes_free (GList *strokes)
+{
+  GList *list;
+
+  for (list = strokes; list; list = g_list_next (list))
+    {
+      GimpVectorLayerStroke *stroke = list->data;
+
+      g_array_unref (stroke->anchors);
+      g_slice_free (GimpVectorLayerStroke, stroke);
+    }
+
+  g_list_free (strokes);
+}
+
+static GimpVectorLayerStroke *
+gimp_vector_layer_strokes_find (GList *strokes,
+                                gint   id)
+{
+  GList *list;
+
+  for (list = strokes; list; list = g_list_next (list))
+    {
+      GimpVectorLayerStroke *stroke = list->data;
+
+      if (stroke->id == id)
+        return stroke;
+    }
+
+  return NULL;
+}
+
+/* adds the points within @radius of @index to the extents, or all
+ * points of the stroke if @index is -1
+ */
+static void
+gimp_vector_layer_stroke_extents (GimpVectorLayerStroke *stroke,
+                                  gint                   index,
+                                  gint                   radius,
+                                  gdouble               *x1,
+                                  gdouble               *y1,
+                                  gdouble               *x2,
+                                  gdouble               *y2)
+{
+  gint n_anchors = stroke->anchors->len;
+  gint first;
+  gint last;
+  gint i;
+
+  if (n_anchors == 0)
+    return;
+
+  if (index < 0)
+    {
+      first = 0;
+      last  = n_anchors - 1;
+    }
+  else
+    {
+      first = index - radius;
+      last  = index + radius;
+    }
+
+  for (i = first; i <= last; i++)
+    {
+      GimpAnchor *anchor;
+      gint        j = i;
+
+      if (stroke->closed)
+        j = ((j % n_anchors) + n_anchors) % n_anchors;
+      else if (j < 0 || j >= n_anchors)
+        continue;
+
+      anchor = &g_array_index (stroke->anchors, GimpAnchor, j);
+
+      *x1 = MIN (*x1, anchor->position.x);
+      *y1 = MIN (*y1, anchor->position.y);
+      *x2 = MAX (*x2, anchor->position.x);
+      *y2 = MAX (*y2, anchor->position.y);
+    }
 }
 
 static void
@@ -42,6 +42,14 @@ struct _GimpVectorLayer
 
   GimpVectorLayerOptions *options;
   gboolean                modified;
+
+  /*  what the layer contents were last rendered from  */
+  GList                  *render_strokes;
+  GimpFillOptions        *render_fill_options;
+  GimpStrokeOptions      *render_stroke_options;
+  GimpTattoo              render_path_tattoo;
+  gboolean                render_fill;
+  gboolean                render_stroke;
 };
 
 struct _GimpVectorLayerClass
@@ -30,14 +30,16 @@
 #include "pdb-types.h"
 
 #include "core/gimpparamspecs.h"
+#include "gimppdb-profile.h"
 
 #include "gimppdb.h"
 #include "gimpprocedure.h"
 #include "internal-procs.h"
 
 
-static GTimer *gimp_debug_timer         = NULL;
-static gint    gimp_debug_timer_counter = 0;
+static GTimer *gimp_debug_timer               = NULL;
+static gint    gimp_debug_timer_counter       = 0;
+static gint    gimp_debug_pdb_profile_counter = 0;
 
 static GimpValueArray *
 debug_timer_start_invoker (GimpProcedure         *procedure,
@@ -89,6 +91,109 @@ debug_timer_end_invoker (GimpProcedure         *procedure,
   return return_vals;
 }
 
+static GimpValueArray *
+debug_pdb_profile_start_invoker (GimpProcedure         *procedure,
+                                 Gimp                  *gimp,
+                                 GimpContext           *context,
+                                 GimpProgress          *progress,
+                                 const GimpValueArray  *args,
+                                 GError               **error)
+{
+  gimp_pdb_profile_start (TRUE);
+
+  gimp_debug_pdb_profile_counter++;
+
+
+  return gimp_procedure_get_return_values (procedure, TRUE, NULL);
+}
+
+static GimpValueArray *
+debug_pdb_profile_end_invoker (GimpProcedure         *procedure,
+                               Gimp                  *gimp,
+                               GimpContext           *context,
+                               GimpProgress          *progress,
+                               const GimpValueArray  *args,
+                               GError               **error)
+{
+  gboolean success = TRUE;
+  GimpValueArray *return_vals;
+  gchar **procedure_names = NULL;
+
+  if (gimp_debug_pdb_profile_counter == 0)
+    {
+      success = FALSE;
+    }
+  else
+    {
+      GList *names;
+      GList *list;
+      gint   i;
+
+      gimp_debug_pdb_profile_counter--;
+
+      gimp_pdb_profile_stop ();
+      gimp_pdb_profile_dump ();
+
+      names = gimp_pdb_profile_get_procedures ();
+
+      procedure_names = g_new (gchar *, g_list_length (names) + 1);
+
+      for (list = names, i = 0; list; list = g_list_next (list), i++)
+        procedure_names[i] = list->data;
+
+      procedure_names[i] = NULL;
+
+      g_list_free (names);
+    }
+
+  return_vals = gimp_procedure_get_return_values (procedure, success,
+                                                  error ? *error : NULL);
+
+  if (success)
+    g_value_take_boxed (gimp_value_array_index (return_vals, 1), procedure_names);
+
+  return return_vals;
+}
+
+static GimpValueArray *
+debug_pdb_profile_get_procedure_invoker (GimpProcedure         *procedure,
+                                         Gimp                  *gimp,
+                                         GimpContext           *context,
+                                         GimpProgress          *progress,
+                                         const GimpValueArray  *args,
+                                         GError               **error)
+{
+  gboolean success = TRUE;
+  GimpValueArray *return_vals;
+  const gchar *procedure_name;
+  gint n_calls = 0;
+  gdouble total_time = 0.0;
+  gdouble max_time = 0.0;
+  gdouble marshal_time = 0.0;
+
+  procedure_name = g_value_get_string (gimp_value_array_index (args, 0));
+
+  if (success)
+    {
+      success = gimp_pdb_profile_get_procedure (procedure_name,
+                                                &n_calls, &total_time, &max_time,
+                                                &marshal_time);
+    }
+
+  return_vals = gimp_procedure_get_return_values (procedure, success,
+                                                  error ? *error : NULL);
+
+  if (success)
+    {
+      g_value_set_int (gimp_value_array_index (return_vals, 1), n_calls);
+      g_value_set_double (gimp_value_array_index (return_vals, 2), total_time);
+      g_value_set_double (gimp_value_array_index (return_vals, 3), max_time);
+      g_value_set_double (gimp_value_array_index (return_vals, 4), marshal_time);
+    }
+
+  return return_vals;
+}
+
 void
 register_debug_procs (GimpPDB *pdb)
 {
@@ -139,4 +244,98 @@ register_debug_procs (GimpPDB *pdb)
                                                         GIMP_PARAM_READWRITE));
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
+
+  /*
+   * gimp-debug-pdb-profile-start
+   */
+  procedure = gimp_procedure_new (debug_pdb_profile_start_invoker, FALSE);
+  gimp_object_set_static_name (GIMP_OBJECT (procedure),
+                               "gimp-debug-pdb-profile-start");
+  gimp_procedure_set_static_help (procedure,
+                                  "Starts profiling the procedural database.",
+                                  "This procedure clears the PDB profile, and starts recording the number of calls, and the time spent in, each procedure of the procedural database. Each call to this procedure should be matched by a call to 'gimp-debug-pdb-profile-end', which stops profiling, and prints the profile.\n"
+                                  "\n"
+                                  "This is a debug utility procedure. It is subject to change at any point, and should not be used in production.",
+                                  NULL);
+  gimp_procedure_set_static_attribution (procedure,
+                                         "Spencer Kimball & Peter Mattis",
+                                         "Spencer Kimball & Peter Mattis",
+                                         "2026");
+  gimp_pdb_register_procedure (pdb, procedure);
+  g_object_unref (procedure);
+
+  /*
+   * gimp-debug-pdb-profile-end
+   */
+  procedure = gimp_procedure_new (debug_pdb_profile_end_invoker, FALSE);
+  gimp_object_set_static_name (GIMP_OBJECT (procedure),
+                               "gimp-debug-pdb-profile-end");
+  gimp_procedure_set_static_help (procedure,
+                                  "Finishes profiling the procedural database.",
+                                  "This procedure stops profiling started by a previous 'gimp-debug-pdb-profile-start' call, prints the profile, and returns the names of the profiled procedures, with the slowest first. Use 'gimp-debug-pdb-profile-get-procedure' to get the profile of each of them.\n"
+                                  "\n"
+                                  "This is a debug utility procedure. It is subject to change at any point, and should not be used in production.",
+                                  NULL);
+  gimp_procedure_set_static_attribution (procedure,
+                                         "Spencer Kimball & Peter Mattis",
+                                         "Spencer Kimball & Peter Mattis",
+                                         "2026");
+  gimp_procedure_add_return_value (procedure,
+                                   g_param_spec_boxed ("procedure-names",
+                                                       "procedure names",
+                                                       "The names of the profiled procedures",
+                                                       G_TYPE_STRV,
+                                                       GIMP_PARAM_READWRITE));
+  gimp_pdb_register_procedure (pdb, procedure);
+  g_object_unref (procedure);
+
+  /*
+   * gimp-debug-pdb-profile-get-procedure
+   */
+  procedure = gimp_procedure_new (debug_pdb_profile_get_procedure_invoker, FALSE);
+  gimp_object_set_static_name (GIMP_OBJECT (procedure),
+                               "gimp-debug-pdb-profile-get-procedure");
+  gimp_procedure_set_static_help (procedure,
+                                  "Returns the profile of a procedure.",
+                                  "This procedure returns the number of calls to a procedure recorded since the last 'gimp-debug-pdb-profile-start' call, the total and longest time spent in it, and the time spent marshalling its arguments and return values to and from plug-ins.\n"
+                                  "\n"
+                                  "This is a debug utility procedure. It is subject to change at any point, and should not be used in production.",
+                                  NULL);
+  gimp_procedure_set_static_attribution (procedure,
+                                         "Spencer Kimball & Peter Mattis",
+                                         "Spencer Kimball & Peter Mattis",
+                                         "2026");
+  gimp_procedure_add_argument (procedure,
+                               gimp_param_spec_string ("procedure-name",
+                                                       "procedure name",
+                                                       "The procedure name",
+                                                       FALSE, FALSE, TRUE,
+                                                       NULL,
+                                                       GIMP_PARAM_READWRITE));
+  gimp_procedure_add_return_value (procedure,
+                                   g_param_spec_int ("n-calls",
+                                                     "n calls",
+                                                     "The number of calls",
+                                                     G_MININT32, G_MAXINT32, 0,
+                                                     GIMP_PARAM_READWRITE));
+  gimp_procedure_add_return_value (procedure,
+                                   g_param_spec_double ("total-time",
+                                                        "total time",
+                                                        "The total time of the calls, in seconds",
+                                                        -G_MAXDOUBLE, G_MAXDOUBLE, 0,
+                                                        GIMP_PARAM_READWRITE));
+  gimp_procedure_add_return_value (procedure,
+                                   g_param_spec_double ("max-time",
+                                                        "max time",
+                                                        "The time of the longest call, in seconds",
+                                                        -G_MAXDOUBLE, G_MAXDOUBLE, 0,
+                                                        GIMP_PARAM_READWRITE));
+  gimp_procedure_add_return_value (procedure,
+                                   g_param_spec_double ("marshal-time",
+                                                        "marshal time",
+                                                        "The time spent marshalling, in seconds",
+                                                        -G_MAXDOUBLE, G_MAXDOUBLE, 0,
+                                                        GIMP_PARAM_READWRITE));
+  gimp_pdb_register_procedure (pdb, procedure);
+  g_object_unref (procedure);
 }
@@ -221,6 +221,129 @@ drawable_set_pixel_invoker (GimpProcedure         *procedure,
                                            error ? *error : NULL);
 }
 
+static GimpValueArray *
+drawable_get_pixels_invoker (GimpProcedure         *procedure,
+                             Gimp                  *gimp,
+                             GimpContext           *context,
+                             GimpProgress          *progress,
+                             const GimpValueArray  *args,
+                             GError               **error)
+{
+  gboolean success = TRUE;
+  GimpValueArray *return_vals;
+  GimpDrawable *drawable;
+  gint x;
+  gint y;
+  gint width;
+  gint height;
+  const gchar *format;
+  GBytes *pixels = NULL;
+
+  drawable = g_value_get_object (gimp_value_array_index (args, 0));
+  x = g_value_get_int (gimp_value_array_index (args, 1));
+  y = g_value_get_int (gimp_value_array_index (args, 2));
+  width = g_value_get_int (gimp_value_array_index (args, 3));
+  height = g_value_get_int (gimp_value_array_index (args, 4));
+  format = g_value_get_string (gimp_value_array_index (args, 5));
+
+  if (success)
+    {
+      const Babl *pixel_format = NULL;
+
+      if (babl_format_exists (format))
+        pixel_format = babl_format_with_space (format,
+                                               gimp_drawable_get_space (drawable));
+
+      if (pixel_format &&
+          width  <= gimp_item_get_width  (GIMP_ITEM (drawable)) - x &&
+          height <= gimp_item_get_height (GIMP_ITEM (drawable)) - y)
+        {
+          gsize    size = (gsize) width * height *
+                          babl_format_get_bytes_per_pixel (pixel_format);
+          gpointer data = g_try_malloc (size);
+
+          if (data)
+            {
+              gegl_buffer_get (gimp_drawable_get_buffer (drawable),
+                               GEGL_RECTANGLE (x, y, width, height), 1.0,
+                               pixel_format, data,
+                               GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+              pixels = g_bytes_new_take (data, size);
+            }
+          else
+            success = FALSE;
+        }
+      else
+        success = FALSE;
+    }
+
+  return_vals = gimp_procedure_get_return_values (procedure, success,
+                                                  error ? *error : NULL);
+
+  if (success)
+    g_value_take_boxed (gimp_value_array_index (return_vals, 1), pixels);
+
+  return return_vals;
+}
+
+static GimpValueArray *
+drawable_set_pixels_invoker (GimpProcedure         *procedure,
+                             Gimp                  *gimp,
+                             GimpContext           *context,
+                             GimpProgress          *progress,
+                             const GimpValueArray  *args,
+                             GError               **error)
+{
+  gboolean success = TRUE;
+  GimpDrawable *drawable;
+  gint x;
+  gint y;
+  gint width;
+  gint height;
+  const gchar *format;
+  GBytes *pixels;
+
+  drawable = g_value_get_object (gimp_value_array_index (args, 0));
+  x = g_value_get_int (gimp_value_array_index (args, 1));
+  y = g_value_get_int (gimp_value_array_index (args, 2));
+  width = g_value_get_int (gimp_value_array_index (args, 3));
+  height = g_value_get_int (gimp_value_array_index (args, 4));
+  format = g_value_get_string (gimp_value_array_index (args, 5));
+  pixels = g_value_get_boxed (gimp_value_array_index (args, 6));
+
+  if (success)
+    {
+      const Babl *pixel_format = NULL;
+
+      if (babl_format_exists (format))
+        pixel_format = babl_format_with_space (format,
+                                               gimp_drawable_get_space (drawable));
+
+      if (pixel_format &&
+          gimp_pdb_item_is_modifiable (GIMP_ITEM (drawable),
+                                       GIMP_PDB_ITEM_CONTENT, error) &&
+          gimp_pdb_item_is_not_group (GIMP_ITEM (drawable), error) &&
+          width  <= gimp_item_get_width  (GIMP_ITEM (drawable)) - x &&
+          height <= gimp_item_get_height (GIMP_ITEM (drawable)) - y &&
+          g_bytes_get_size (pixels) ==
+          (gsize) width * height * babl_format_get_bytes_per_pixel (pixel_format))
+        {
+          gegl_buffer_set (gimp_drawable_get_buffer (drawable),
+                           GEGL_RECTANGLE (x, y, width, height), 0,
+                           pixel_format, g_bytes_get_data (pixels, NULL),
+                           GEGL_AUTO_ROWSTRIDE);
+
+          gimp_drawable_update (drawable, x, y, width, height);
+        }
+      else
+        success = FALSE;
+    }
+
+  return gimp_procedure_get_return_values (procedure, success,
+                                           error ? *error : NULL);
+}
+
 static GimpValueArray *
 drawable_type_invoker (GimpProcedure         *procedure,
                        Gimp                  *gimp,
@@ -713,6 +836,55 @@ drawable_merge_filter_invoker (GimpProcedure         *procedure,
                                            error ? *error : NULL);
 }
 
+static GimpValueArray *
+drawable_merge_filter_copy_invoker (GimpProcedure         *procedure,
+                                    Gimp                  *gimp,
+                                    GimpContext           *context,
+                                    GimpProgress          *progress,
+                                    const GimpValueArray  *args,
+                                    GError               **error)
+{
+  gboolean success = TRUE;
+  GimpDrawable *drawable;
+  GimpDrawableFilter *filter;
+
+  drawable = g_value_get_object (gimp_value_array_index (args, 0));
+  filter = g_value_get_object (gimp_value_array_index (args, 1));
+
+  if (success)
+    {
+      GimpDrawableFilter *copy = gimp_drawable_filter_copy (drawable, filter);
+
+      if (copy)
+        {
+          GimpContainer *filters;
+          gint           count;
+
+          gimp_drawable_filter_apply (copy, NULL);
+
+          filters = gimp_drawable_get_filters (drawable);
+          count   = gimp_container_get_n_children (filters);
+          if (count > 1)
+            gimp_container_reorder (filters, GIMP_OBJECT (copy), count - 1);
+
+          gimp_drawable_filter_layer_mask_freeze (copy);
+          gimp_drawable_filter_commit (copy, FALSE, NULL, FALSE);
+
+          g_object_unref (copy);
+        }
+      else
+        {
+          g_set_error (error, GIMP_PDB_ERROR, GIMP_PDB_ERROR_INVALID_ARGUMENT,
+                       "%s: the filter cannot be copied.",
+                       G_STRFUNC);
+          success = FALSE;
+        }
+    }
+
+  return gimp_procedure_get_return_values (procedure, success,
+                                           error ? *error : NULL);
+}
+
 static GimpValueArray *
 drawable_get_filters_invoker (GimpProcedure         *procedure,
                               Gimp                  *gimp,
@@ -1298,6 +1470,128 @@ register_drawable_procs (GimpPDB *pdb)
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
 
+  /*
+   * gimp-drawable-get-pixels
+   */
+  procedure = gimp_procedure_new (drawable_get_pixels_invoker, FALSE);
+  gimp_object_set_static_name (GIMP_OBJECT (procedure),
+                               "gimp-drawable-get-pixels");
+  gimp_procedure_set_static_help (procedure,
+                                  "Gets the pixels of an area of a drawable.",
+                                  "This procedure returns the pixels of the area of the drawable at (@x, @y) of size (@width, @height), converted to the Babl format of encoding @format in the drawable's color space, e.g. \"R'G'B'A u8\". The pixels are returned row by row, without padding.\n"
+                                  "Together with 'gimp-drawable-set-pixels', this allows to pass image data to and from GIMP without going through files.",
+                                  NULL);
+  gimp_procedure_set_static_attribution (procedure,
+                                         "Spencer Kimball & Peter Mattis",
+                                         "Spencer Kimball & Peter Mattis",
+                                         "2026");
+  gimp_procedure_add_argument (procedure,
+                               gimp_param_spec_drawable ("drawable",
+                                                         "drawable",
+                                                         "The drawable",
+                                                         FALSE,
+                                                         GIMP_PARAM_READWRITE));
+  gimp_procedure_add_argument (procedure,
+                               g_param_spec_int ("x",
+                                                 "x",
+                                                 "The x coordinate of the area",
+                                                 0, G_MAXINT32, 0,
+                                                 GIMP_PARAM_READWRITE));
+  gimp_procedure_add_argument (procedure,
+                               g_param_spec_int ("y",
+                                                 "y",
+                                                 "The y coordinate of the area",
+                                                 0, G_MAXINT32, 0,
+                                                 GIMP_PARAM_READWRITE));
+  gimp_procedure_add_argument (procedure,
+                               g_param_spec_int ("width",
+                                                 "width",
+                                                 "The width of the area",
+                                                 1, G_MAXINT32, 1,
+                                                 GIMP_PARAM_READWRITE));
+  gimp_procedure_add_argument (procedure,
+                               g_param_spec_int ("height",
+                                                 "height",
+                                                 "The height of the area",
+                                                 1, G_MAXINT32, 1,
+                                                 GIMP_PARAM_READWRITE));
+  gimp_procedure_add_argument (procedure,
+                               gimp_param_spec_string ("format",
+                                                       "format",
+                                                       "The Babl format encoding of the pixels",
+                                                       FALSE, FALSE, TRUE,
+                                                       NULL,
+                                                       GIMP_PARAM_READWRITE));
+  gimp_procedure_add_return_value (procedure,
+                                   g_param_spec_boxed ("pixels",
+                                                       "pixels",
+                                                       "The pixels",
+                                                       G_TYPE_BYTES,
+                                                       GIMP_PARAM_READWRITE));
+  gimp_pdb_register_procedure (pdb, procedure);
+  g_object_unref (procedure);
+
+  /*
+   * gimp-drawable-set-pixels
+   */
+  procedure = gimp_procedure_new (drawable_set_pixels_invoker, FALSE);
+  gimp_object_set_static_name (GIMP_OBJECT (procedure),
+                               "gimp-drawable-set-pixels");
+  gimp_procedure_set_static_help (procedure,
+                                  "Sets the pixels of an area of a drawable.",
+                                  "This procedure replaces the pixels of the area of the drawable at (@x, @y) of size (@width, @height) with @pixels, given row by row, without padding, in the Babl format of encoding @format in the drawable's color space, e.g. \"R'G'B'A u8\".\n"
+                                  "Note that this function is not undoable, you should use it only on drawables you just created yourself.",
+                                  NULL);
+  gimp_procedure_set_static_attribution (procedure,
+                                         "Spencer Kimball & Peter Mattis",
+                                         "Spencer Kimball & Peter Mattis",
+                                         "2026");
+  gimp_procedure_add_argument (procedure,
+                               gimp_param_spec_drawable ("drawable",
+                                                         "drawable",
+                                                         "The drawable",
+                                                         FALSE,
+                                                         GIMP_PARAM_READWRITE));
+  gimp_procedure_add_argument (procedure,
+                               g_param_spec_int ("x",
+                                                 "x",
+                                                 "The x coordinate of the area",
+                                                 0, G_MAXINT32, 0,
+                                                 GIMP_PARAM_READWRITE));
+  gimp_procedure_add_argument (procedure,
+                               g_param_spec_int ("y",
+                                                 "y",
+                                                 "The y coordinate of the area",
+                                                 0, G_MAXINT32, 0,
+                                                 GIMP_PARAM_READWRITE));
+  gimp_procedure_add_argument (procedure,
+                               g_param_spec_int ("width",
+                                                 "width",
+                                                 "The width of the area",
+                                                 1, G_MAXINT32, 1,
+                                                 GIMP_PARAM_READWRITE));
+  gimp_procedure_add_argument (procedure,
+                               g_param_spec_int ("height",
+                                                 "height",
+                                                 "The height of the area",
+                                                 1, G_MAXINT32, 1,
+                                                 GIMP_PARAM_READWRITE));
+  gimp_procedure_add_argument (procedure,
+                               gimp_param_spec_string ("format",
+                                                       "format",
+                                                       "The Babl format encoding of the pixels",
+                                                       FALSE, FALSE, TRUE,
+                                                       NULL,
+                                                       GIMP_PARAM_READWRITE));
+  gimp_procedure_add_argument (procedure,
+                               g_param_spec_boxed ("pixels",
+                                                   "pixels",
+                                                   "The pixels",
+                                                   G_TYPE_BYTES,
+                                                   GIMP_PARAM_READWRITE));
+  gimp_pdb_register_procedure (pdb, procedure);
+  g_object_unref (procedure);
+
   /*
    * gimp-drawable-type
    */
@@ -1774,6 +2068,37 @@ register_drawable_procs (GimpPDB *pdb)
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
 
+  /*
+   * gimp-drawable-merge-filter-copy
+   */
+  procedure = gimp_procedure_new (drawable_merge_filter_copy_invoker, TRUE);
+  gimp_object_set_static_name (GIMP_OBJECT (procedure),
+                               "gimp-drawable-merge-filter-copy");
+  gimp_procedure_set_static_help (procedure,
+                                  "Apply a copy of the specified effect directly to the drawable.",
+                                  "This procedure applies a copy of @filter, with its operation, arguments, blend mode, opacity and auxiliary inputs, on @drawable and merges it, just like [method@Gimp.Drawable.merge_filter] would.\n"
+                                  "Unlike the latter, @filter itself is neither applied nor invalidated, and it may have been created for any drawable, so a single configured filter can be merged on any number of drawables.\n"
+                                  "This function is private and should not be used. Use [method@Gimp.Drawable.merge_filter_copy] instead.",
+                                  NULL);
+  gimp_procedure_set_static_attribution (procedure,
+                                         "Spencer Kimball & Peter Mattis",
+                                         "Spencer Kimball & Peter Mattis",
+                                         "1995-1996");
+  gimp_procedure_add_argument (procedure,
+                               gimp_param_spec_drawable ("drawable",
+                                                         "drawable",
+                                                         "The drawable",
+                                                         FALSE,
+                                                         GIMP_PARAM_READWRITE));
+  gimp_procedure_add_argument (procedure,
+                               gimp_param_spec_drawable_filter ("filter",
+                                                                "filter",
+                                                                "The drawable filter to merge a copy of",
+                                                                FALSE,
+                                                                GIMP_PARAM_READWRITE));
+  gimp_pdb_register_procedure (pdb, procedure);
+  g_object_unref (procedure);
+
   /*
    * gimp-drawable-get-filters
    */
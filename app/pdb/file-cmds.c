@@ -32,6 +32,7 @@
 #include "pdb-types.h"
 
 #include "core/gimp.h"
+#include "core/gimpimage-merge.h"
 #include "core/gimpimage.h"
 #include "core/gimplayer.h"
 #include "core/gimpparamspecs.h"
@@ -44,6 +45,37 @@
 #include "gimpprocedure.h"
 #include "internal-procs.h"
 
+#include "gimp-intl.h"
+
+
+typedef struct
+{
+  Gimp       *gimp;
+  GimpImage **images;
+  GError     *error;
+} FileLoadManyResult;
+
+static void
+file_load_many_loaded (gint                index,
+                       GFile              *file,
+                       GimpImage          *image,
+                       GError             *error,
+                       FileLoadManyResult *result)
+{
+  if (image)
+    {
+      result->images[index] = image;
+    }
+  else if (error)
+    {
+      gimp_message (result->gimp, NULL, GIMP_MESSAGE_WARNING,
+                    _("Opening '%s' failed: %s"),
+                    gimp_file_get_utf8_name (file), error->message);
+
+      if (! result->error)
+        result->error = g_error_copy (error);
+    }
+}
 
 static GimpValueArray *
 file_load_invoker (GimpProcedure         *procedure,
@@ -236,6 +268,83 @@ file_load_layers_invoker (GimpProcedure         *procedure,
   return return_vals;
 }
 
+static GimpValueArray *
+file_load_many_invoker (GimpProcedure         *procedure,
+                        Gimp                  *gimp,
+                        GimpContext           *context,
+                        GimpProgress          *progress,
+                        const GimpValueArray  *args,
+                        GError               **error)
+{
+  gboolean success = TRUE;
+  GimpValueArray *return_vals;
+  gint run_mode;
+  const gchar **uris;
+  gint n_jobs;
+  GimpImage **images = NULL;
+
+  run_mode = g_value_get_enum (gimp_value_array_index (args, 0));
+  uris = g_value_get_boxed (gimp_value_array_index (args, 1));
+  n_jobs = g_value_get_int (gimp_value_array_index (args, 2));
+
+  if (success)
+    {
+      FileLoadManyResult   result;
+      GFile              **files;
+      gint                 n_files;
+      gint                 n_images = 0;
+      gint                 i;
+
+      n_files = uris ? g_strv_length ((gchar **) uris) : 0;
+
+      files         = g_new (GFile *, n_files);
+      result.gimp   = gimp;
+      result.images = g_new0 (GimpImage *, n_files);
+      result.error  = NULL;
+
+      for (i = 0; i < n_files; i++)
+        files[i] = g_file_new_for_uri (uris[i]);
+
+      gimp_plug_in_manager_file_load_many (gimp->plug_in_manager,
+                                           context, progress, run_mode,
+                                           files, n_files, n_jobs,
+                                           (GimpPlugInFileLoadFunc) file_load_many_loaded,
+                                           &result);
+
+      images = g_new0 (GimpImage *, n_files + 1);
+
+      for (i = 0; i < n_files; i++)
+        {
+          if (result.images[i])
+            images[n_images++] = result.images[i];
+
+          g_object_unref (files[i]);
+        }
+
+      if (n_files > 0 && n_images == 0)
+        {
+          g_clear_pointer (&images, g_free);
+
+          g_propagate_error (error, result.error);
+          result.error = NULL;
+
+          success = FALSE;
+        }
+
+      g_clear_error (&result.error);
+      g_free (result.images);
+      g_free (files);
+    }
+
+  return_vals = gimp_procedure_get_return_values (procedure, success,
+                                                  error ? *error : NULL);
+
+  if (success)
+    g_value_take_boxed (gimp_value_array_index (return_vals, 1), images);
+
+  return return_vals;
+}
+
 static GimpValueArray *
 file_save_invoker (GimpProcedure         *procedure,
                    Gimp                  *gimp,
@@ -401,6 +510,54 @@ file_create_thumbnail_invoker (GimpProcedure         *procedure,
                                            error ? *error : NULL);
 }
 
+static GimpValueArray *
+file_save_flattened_invoker (GimpProcedure         *procedure,
+                             Gimp                  *gimp,
+                             GimpContext           *context,
+                             GimpProgress          *progress,
+                             const GimpValueArray  *args,
+                             GError               **error)
+{
+  gboolean success = TRUE;
+  GimpImage *image;
+  GFile *file;
+
+  image = g_value_get_object (gimp_value_array_index (args, 0));
+  file = g_value_get_object (gimp_value_array_index (args, 1));
+
+  if (success)
+    {
+      GimpPlugInProcedure *file_proc;
+      GimpImage           *flat_image = NULL;
+
+      file_proc = gimp_plug_in_manager_file_procedure_find (gimp->plug_in_manager,
+                                                            GIMP_FILE_PROCEDURE_GROUP_SAVE,
+                                                            file, NULL);
+
+      if (! file_proc)
+        file_proc = gimp_plug_in_manager_file_procedure_find (gimp->plug_in_manager,
+                                                              GIMP_FILE_PROCEDURE_GROUP_EXPORT,
+                                                              file, error);
+
+      if (file_proc)
+        flat_image = gimp_image_flatten_to_image (image, context, progress, error);
+
+      if (flat_image)
+        {
+          success = (file_save (gimp, flat_image, progress, file, file_proc,
+                                GIMP_RUN_NONINTERACTIVE,
+                                FALSE, FALSE, FALSE, error) == GIMP_PDB_SUCCESS);
+
+          g_object_unref (flat_image);
+        }
+      else
+        success = FALSE;
+    }
+
+  return gimp_procedure_get_return_values (procedure, success,
+                                           error ? *error : NULL);
+}
+
 void
 register_file_procs (GimpPDB *pdb)
 {
@@ -532,6 +689,51 @@ register_file_procs (GimpPDB *pdb)
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
 
+  /*
+   * gimp-file-load-many
+   */
+  procedure = gimp_procedure_new (file_load_many_invoker, FALSE);
+  gimp_object_set_static_name (GIMP_OBJECT (procedure),
+                               "gimp-file-load-many");
+  gimp_procedure_set_static_help (procedure,
+                                  "Loads a list of image files, several of them at the same time.",
+                                  "This procedure behaves like the file-load procedure run on each of @uris in turn, but up to @n_jobs loader plug-ins run at the same time, and reusable loader plug-ins are kept running from one file to the next. If @n_jobs is 0, as many loaders as there are processors run at the same time.\n"
+                                  "The returned images are in the order of @uris. Files which can't be loaded are left out, and a message is reported for each of them. The procedure only fails if none of the files could be loaded.",
+                                  NULL);
+  gimp_procedure_set_static_attribution (procedure,
+                                         "Spencer Kimball & Peter Mattis",
+                                         "Spencer Kimball & Peter Mattis",
+                                         "2026");
+  gimp_procedure_add_argument (procedure,
+                               gimp_param_spec_enum ("run-mode",
+                                                     "run mode",
+                                                     "The run mode",
+                                                     GIMP_TYPE_RUN_MODE,
+                                                     GIMP_RUN_INTERACTIVE,
+                                                     GIMP_PARAM_READWRITE));
+  gimp_param_spec_enum_exclude_value (GIMP_PARAM_SPEC_ENUM (procedure->args[0]),
+                                      GIMP_RUN_WITH_LAST_VALS);
+  gimp_procedure_add_argument (procedure,
+                               g_param_spec_boxed ("uris",
+                                                   "uris",
+                                                   "The URIs of the files to load",
+                                                   G_TYPE_STRV,
+                                                   GIMP_PARAM_READWRITE));
+  gimp_procedure_add_argument (procedure,
+                               g_param_spec_int ("n-jobs",
+                                                 "n jobs",
+                                                 "The number of files to load at the same time, or 0",
+                                                 0, G_MAXINT32, 0,
+                                                 GIMP_PARAM_READWRITE));
+  gimp_procedure_add_return_value (procedure,
+                                   gimp_param_spec_core_object_array ("images",
+                                                                      "images",
+                                                                      "The loaded images",
+                                                                      GIMP_TYPE_IMAGE,
+                                                                      GIMP_PARAM_READWRITE));
+  gimp_pdb_register_procedure (pdb, procedure);
+  g_object_unref (procedure);
+
   /*
    * gimp-file-save
    */
@@ -647,4 +849,34 @@ register_file_procs (GimpPDB *pdb)
                                                     GIMP_PARAM_READWRITE));
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
+
+  /*
+   * gimp-file-save-flattened
+   */
+  procedure = gimp_procedure_new (file_save_flattened_invoker, FALSE);
+  gimp_object_set_static_name (GIMP_OBJECT (procedure),
+                               "gimp-file-save-flattened");
+  gimp_procedure_set_static_help (procedure,
+                                  "Saves a flattened copy of @image, without changing the image.",
+                                  "This procedure composites the visible layers of @image onto the background color, like gimp-image-flatten does, and saves the result to @file with the handler selected by the file's extension and/or prefix. @image itself is left unchanged, and its projection isn't rendered.\n"
+                                  "The layers are composited in chunks, and the result is kept in GEGL's tile cache, which swaps tiles out when it is full. Saving to XCF then writes the result tile by tile, so images larger than the available memory can be flattened this way. Other file formats may need the whole result in memory while exporting it.",
+                                  NULL);
+  gimp_procedure_set_static_attribution (procedure,
+                                         "Spencer Kimball & Peter Mattis",
+                                         "Spencer Kimball & Peter Mattis",
+                                         "2026");
+  gimp_procedure_add_argument (procedure,
+                               gimp_param_spec_image ("image",
+                                                      "image",
+                                                      "The image to flatten",
+                                                      FALSE,
+                                                      GIMP_PARAM_READWRITE));
+  gimp_procedure_add_argument (procedure,
+                               g_param_spec_object ("file",
+                                                    "file",
+                                                    "The file to save the flattened image in",
+                                                    G_TYPE_FILE,
+                                                    GIMP_PARAM_READWRITE));
+  gimp_pdb_register_procedure (pdb, procedure);
+  g_object_unref (procedure);
 }
@@ -0,0 +1,354 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995-2003 Spencer Kimball and Peter Mattis
+ *
+ * gimppdb-profile.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <gio/gio.h>
+
+#include "pdb-types.h"
+
+#include "gimppdb-profile.h"
+
+
+/* per-procedure statistics of the PDB calls, for batch scripts, the
+ * dashboard and the debug procedures.
+ *
+ * profiling is active as long as anybody started it, and not stopped
+ * it since.  the time of a call includes the time of the calls it makes
+ * itself; the total call time only counts the outermost calls.  the
+ * marshalling time is the time spent converting arguments and return
+ * values to and from the wire, and sending them, when calling plug-ins
+ * and when plug-ins call the PDB.
+ *
+ * calls are reported on the main thread; the stats may be read from any
+ * thread.
+ */
+
+
+typedef struct
+{
+  gint   n_calls;
+  gint64 total_time;
+  gint64 max_time;
+  gint64 marshal_time;
+} ProfileEntry;
+
+
+/*  local function prototypes  */
+
+static ProfileEntry * gimp_pdb_profile_get_entry      (const gchar   *name);
+static gint           gimp_pdb_profile_compare_names  (const gchar   *name1,
+                                                       const gchar   *name2);
+
+
+/*  local variables  */
+
+G_LOCK_DEFINE_STATIC (pdb_profile);
+
+static gint        profile_users        = 0;
+static gint        call_depth           = 0;
+
+static GHashTable *profile_entries      = NULL;
+static gint        profile_n_calls      = 0;
+static gint64      profile_call_time    = 0;
+static gint64      profile_max_time     = 0;
+static gint64      profile_marshal_time = 0;
+
+
+/*  private functions  */
+
+/*  must be called with the lock held  */
+static ProfileEntry *
+gimp_pdb_profile_get_entry (const gchar *name)
+{
+  ProfileEntry *entry;
+
+  if (! profile_entries)
+    profile_entries = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                             g_free, g_free);
+
+  entry = g_hash_table_lookup (profile_entries, name);
+
+  if (! entry)
+    {
+      entry = g_new0 (ProfileEntry, 1);
+
+      g_hash_table_insert (profile_entries, g_strdup (name), entry);
+    }
+
+  return entry;
+}
+
+/*  must be called with the lock held  */
+static gint
+gimp_pdb_profile_compare_names (const gchar *name1,
+                                const gchar *name2)
+{
+  const ProfileEntry *entry1 = g_hash_table_lookup (profile_entries, name1);
+  const ProfileEntry *entry2 = g_hash_table_lookup (profile_entries, name2);
+
+  if (entry1->total_time != entry2->total_time)
+    return entry1->total_time < entry2->total_time ? +1 : -1;
+
+  return strcmp (name1, name2);
+}
+
+
+/*  public functions  */
+
+void
+gimp_pdb_profile_start (gboolean reset)
+{
+  if (reset)
+    {
+      G_LOCK (pdb_profile);
+
+      if (profile_entries)
+        g_hash_table_remove_all (profile_entries);
+
+      profile_n_calls      = 0;
+      profile_call_time    = 0;
+      profile_max_time     = 0;
+      profile_marshal_time = 0;
+
+      G_UNLOCK (pdb_profile);
+    }
+
+  g_atomic_int_inc (&profile_users);
+}
+
+void
+gimp_pdb_profile_stop (void)
+{
+  g_return_if_fail (g_atomic_int_get (&profile_users) > 0);
+
+  g_atomic_int_add (&profile_users, -1);
+}
+
+gboolean
+gimp_pdb_profile_is_active (void)
+{
+  return g_atomic_int_get (&profile_users) > 0;
+}
+
+/* returns the start time of a call, to pass to
+ * gimp_pdb_profile_end_call() when it returns.
+ */
+gint64
+gimp_pdb_profile_begin_call (void)
+{
+  call_depth++;
+
+  return g_get_monotonic_time ();
+}
+
+void
+gimp_pdb_profile_end_call (const gchar *name,
+                           gint64       start_time)
+{
+  ProfileEntry *entry;
+  gint64        time;
+
+  g_return_if_fail (name != NULL);
+  g_return_if_fail (call_depth > 0);
+
+  time = g_get_monotonic_time () - start_time;
+
+  call_depth--;
+
+  G_LOCK (pdb_profile);
+
+  entry = gimp_pdb_profile_get_entry (name);
+
+  entry->n_calls++;
+  entry->total_time += time;
+  entry->max_time    = MAX (entry->max_time, time);
+
+  profile_n_calls++;
+  profile_max_time   = MAX (profile_max_time, time);
+
+  if (call_depth == 0)
+    profile_call_time += time;
+
+  G_UNLOCK (pdb_profile);
+}
+
+void
+gimp_pdb_profile_add_marshal (const gchar *name,
+                              gint64       time)
+{
+  ProfileEntry *entry;
+
+  g_return_if_fail (name != NULL);
+
+  G_LOCK (pdb_profile);
+
+  entry = gimp_pdb_profile_get_entry (name);
+
+  entry->marshal_time  += time;
+  profile_marshal_time += time;
+
+  G_UNLOCK (pdb_profile);
+}
+
+/* returns the names of the profiled procedures, slowest first.  free
+ * with g_list_free_full (list, g_free).
+ */
+GList *
+gimp_pdb_profile_get_procedures (void)
+{
+  GList *names = NULL;
+  GList *list;
+
+  G_LOCK (pdb_profile);
+
+  if (profile_entries)
+    {
+      names = g_hash_table_get_keys (profile_entries);
+      names = g_list_sort (names,
+                           (GCompareFunc) gimp_pdb_profile_compare_names);
+
+      for (list = names; list; list = g_list_next (list))
+        list->data = g_strdup (list->data);
+    }
+
+  G_UNLOCK (pdb_profile);
+
+  return names;
+}
+
+gboolean
+gimp_pdb_profile_get_procedure (const gchar *name,
+                                gint        *n_calls,
+                                gdouble     *total_time,
+                                gdouble     *max_time,
+                                gdouble     *marshal_time)
+{
+  ProfileEntry *entry = NULL;
+
+  g_return_val_if_fail (name != NULL, FALSE);
+
+  G_LOCK (pdb_profile);
+
+  if (profile_entries)
+    entry = g_hash_table_lookup (profile_entries, name);
+
+  if (entry)
+    {
+      if (n_calls)      *n_calls      = entry->n_calls;
+      if (total_time)   *total_time   = (gdouble) entry->total_time /
+                                        G_TIME_SPAN_SECOND;
+      if (max_time)     *max_time     = (gdouble) entry->max_time /
+                                        G_TIME_SPAN_SECOND;
+      if (marshal_time) *marshal_time = (gdouble) entry->marshal_time /
+                                        G_TIME_SPAN_SECOND;
+    }
+
+  G_UNLOCK (pdb_profile);
+
+  return entry != NULL;
+}
+
+void
+gimp_pdb_profile_dump (void)
+{
+  GList *names;
+  GList *list;
+
+  names = gimp_pdb_profile_get_procedures ();
+
+  g_printerr ("GIMP PDB profile: %d calls, %g seconds, "
+              "%g seconds marshalling\n",
+              gimp_pdb_profile_get_n_calls (),
+              gimp_pdb_profile_get_call_time (),
+              gimp_pdb_profile_get_marshal_time ());
+
+  if (names)
+    g_printerr ("%10s %12s %12s %12s  %s\n",
+                "calls", "total (s)", "max (s)", "marshal (s)", "procedure");
+
+  for (list = names; list; list = g_list_next (list))
+    {
+      gint    n_calls;
+      gdouble total_time;
+      gdouble max_time;
+      gdouble marshal_time;
+
+      if (gimp_pdb_profile_get_procedure (list->data,
+                                          &n_calls, &total_time, &max_time,
+                                          &marshal_time))
+        {
+          g_printerr ("%10d %12.6f %12.6f %12.6f  %s\n",
+                      n_calls, total_time, max_time, marshal_time,
+                      (const gchar *) list->data);
+        }
+    }
+
+  g_list_free_full (names, g_free);
+}
+
+gint
+gimp_pdb_profile_get_n_calls (void)
+{
+  gint result;
+
+  G_LOCK (pdb_profile);
+  result = profile_n_calls;
+  G_UNLOCK (pdb_profile);
+
+  return result;
+}
+
+gdouble
+gimp_pdb_profile_get_call_time (void)
+{
+  gdouble result;
+
+  G_LOCK (pdb_profile);
+  result = (gdouble) profile_call_time / G_TIME_SPAN_SECOND;
+  G_UNLOCK (pdb_profile);
+
+  return result;
+}
+
+gdouble
+gimp_pdb_profile_get_max_time (void)
+{
+  gdouble result;
+
+  G_LOCK (pdb_profile);
+  result = (gdouble) profile_max_time / G_TIME_SPAN_SECOND;
+  G_UNLOCK (pdb_profile);
+
+  return result;
+}
+
+gdouble
+gimp_pdb_profile_get_marshal_time (void)
+{
+  gdouble result;
+
+  G_LOCK (pdb_profile);
+  result = (gdouble) profile_marshal_time / G_TIME_SPAN_SECOND;
+  G_UNLOCK (pdb_profile);
+
+  return result;
+}
@@ -0,0 +1,44 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995-2003 Spencer Kimball and Peter Mattis
+ *
+ * gimppdb-profile.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+void       gimp_pdb_profile_start            (gboolean      reset);
+void       gimp_pdb_profile_stop             (void);
+gboolean   gimp_pdb_profile_is_active        (void);
+
+gint64     gimp_pdb_profile_begin_call       (void);
+void       gimp_pdb_profile_end_call         (const gchar  *name,
+                                              gint64        start_time);
+void       gimp_pdb_profile_add_marshal      (const gchar  *name,
+                                              gint64        time);
+
+GList    * gimp_pdb_profile_get_procedures   (void);
+gboolean   gimp_pdb_profile_get_procedure    (const gchar  *name,
+                                              gint         *n_calls,
+                                              gdouble      *total_time,
+                                              gdouble      *max_time,
+                                              gdouble      *marshal_time);
+void       gimp_pdb_profile_dump             (void);
+
+gint       gimp_pdb_profile_get_n_calls      (void);
+gdouble    gimp_pdb_profile_get_call_time    (void);
+gdouble    gimp_pdb_profile_get_max_time     (void);
+gdouble    gimp_pdb_profile_get_marshal_time (void);
@@ -36,6 +36,7 @@
 #include "core/gimpprogress.h"
 
 #include "gimppdb.h"
+#include "gimppdb-profile.h"
 #include "gimppdberror.h"
 #include "gimpprocedure.h"
 
@@ -288,6 +289,8 @@ gimp_pdb_execute_procedure_by_name_args (GimpPDB         *pdb,
 {
   GimpValueArray *return_vals = NULL;
   GList          *list;
+  gboolean        profile;
+  gint64          start_time  = 0;
 
   g_return_val_if_fail (GIMP_IS_PDB (pdb), NULL);
   g_return_val_if_fail (GIMP_IS_CONTEXT (context), NULL);
@@ -311,6 +314,11 @@ gimp_pdb_execute_procedure_by_name_args (GimpPDB         *pdb,
 
   g_return_val_if_fail (args != NULL, NULL);
 
+  profile = gimp_pdb_profile_is_active ();
+
+  if (profile)
+    start_time = gimp_pdb_profile_begin_call ();
+
   for (; list; list = g_list_next (list))
     {
       GimpProcedure *procedure = list->data;
@@ -343,6 +351,9 @@ gimp_pdb_execute_procedure_by_name_args (GimpPDB         *pdb,
         }
     }
 
+  if (profile)
+    gimp_pdb_profile_end_call (name, start_time);
+
   return return_vals;
 }
 
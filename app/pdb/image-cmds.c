@@ -57,6 +57,7 @@
 #include "core/gimpselection.h"
 #include "core/gimptempbuf.h"
 #include "file/file-utils.h"
+#include "gegl/gimp-babl-compat.h"
 #include "gegl/gimp-babl.h"
 #include "path/gimppath-export.h"
 #include "path/gimppath-import.h"
@@ -451,6 +452,83 @@ image_get_layers_invoker (GimpProcedure         *procedure,
   return return_vals;
 }
 
+static GimpValueArray *
+image_get_layer_tree_info_invoker (GimpProcedure         *procedure,
+                                   Gimp                  *gimp,
+                                   GimpContext           *context,
+                                   GimpProgress          *progress,
+                                   const GimpValueArray  *args,
+                                   GError               **error)
+{
+  gboolean success = TRUE;
+  GimpValueArray *return_vals;
+  GimpImage *image;
+  GimpLayer **layers = NULL;
+  gsize num_info = 0;
+  gint32 *info = NULL;
+  gchar **names = NULL;
+  gsize num_opacities = 0;
+  gdouble *opacities = NULL;
+
+  image = g_value_get_object (gimp_value_array_index (args, 0));
+
+  if (success)
+    {
+      GList *list = gimp_image_get_layer_list (image);
+      GList *iter;
+      gsize  num_layers;
+      gint   i;
+
+      num_layers = g_list_length (list);
+
+      layers    = g_new0 (GimpLayer *, num_layers + 1);
+      names     = g_new0 (gchar *,     num_layers + 1);
+      info      = g_new  (gint32,      num_layers * 10);
+      opacities = g_new  (gdouble,     num_layers);
+
+      num_info      = num_layers * 10;
+      num_opacities = num_layers;
+
+      for (iter = list, i = 0; iter; iter = g_list_next (iter), i++)
+        {
+          GimpItem *item   = iter->data;
+          GimpItem *parent = gimp_item_get_parent (item);
+          gint32   *values = info + i * 10;
+
+          layers[i] = iter->data;
+          names[i]  = g_strdup (gimp_object_get_name (item));
+
+          values[0] = gimp_item_get_id (item);
+          values[1] = parent ? gimp_item_get_id (parent) : -1;
+          values[2] = gimp_item_get_offset_x (item);
+          values[3] = gimp_item_get_offset_y (item);
+          values[4] = gimp_item_get_width  (item);
+          values[5] = gimp_item_get_height (item);
+          values[6] = gimp_layer_get_mode (GIMP_LAYER (item));
+          values[7] = gimp_item_get_visible (item);
+          values[8] = gimp_babl_format_get_image_type (gimp_drawable_get_format (GIMP_DRAWABLE (item)));
+          values[9] = gimp_viewable_get_children (GIMP_VIEWABLE (item)) != NULL;
+
+          opacities[i] = gimp_layer_get_opacity (GIMP_LAYER (item));
+        }
+
+      g_list_free (list);
+    }
+
+  return_vals = gimp_procedure_get_return_values (procedure, success,
+                                                  error ? *error : NULL);
+
+  if (success)
+    {
+      g_value_take_boxed (gimp_value_array_index (return_vals, 1), layers);
+      gimp_value_take_int32_array (gimp_value_array_index (return_vals, 2), info, num_info);
+      g_value_take_boxed (gimp_value_array_index (return_vals, 3), names);
+      gimp_value_take_double_array (gimp_value_array_index (return_vals, 4), opacities, num_opacities);
+    }
+
+  return return_vals;
+}
+
 static GimpValueArray *
 image_get_channels_invoker (GimpProcedure         *procedure,
                             Gimp                  *gimp,
@@ -3409,6 +3487,52 @@ register_image_procs (GimpPDB *pdb)
   gimp_pdb_register_procedure (pdb, procedure);
   g_object_unref (procedure);
 
+  /*
+   * gimp-image-get-layer-tree-info
+   */
+  procedure = gimp_procedure_new (image_get_layer_tree_info_invoker, FALSE);
+  gimp_object_set_static_name (GIMP_OBJECT (procedure),
+                               "gimp-image-get-layer-tree-info");
+  gimp_procedure_set_static_help (procedure,
+                                  "Returns the attributes of all the layers of the specified image.",
+                                  "This procedure returns all the layers of the image, and the attributes usually queried for each of them, in a single call. The layers are listed depth-first, from topmost to bottommost, each group layer being followed by its children.\n"
+                                  "@info contains 10 values per layer, in the order of @layers: the layer's ID, the ID of its parent group layer (or -1 for root layers), its X and Y offsets, its width and height, its #GimpLayerMode, its visibility (0 or 1), its #GimpImageType and whether it is a group layer (0 or 1). @names and @opacities contain each layer's name and opacity, in the same order.",
+                                  NULL);
+  gimp_procedure_set_static_attribution (procedure,
+                                         "Spencer Kimball & Peter Mattis",
+                                         "Spencer Kimball & Peter Mattis",
+                                         "2026");
+  gimp_procedure_add_argument (procedure,
+                               gimp_param_spec_image ("image",
+                                                      "image",
+                                                      "The image",
+                                                      FALSE,
+                                                      GIMP_PARAM_READWRITE));
+  gimp_procedure_add_return_value (procedure,
+                                   gimp_param_spec_core_object_array ("layers",
+                                                                      "layers",
+                                                                      "All the layers of the image",
+                                                                      GIMP_TYPE_LAYER,
+                                                                      GIMP_PARAM_READWRITE));
+  gimp_procedure_add_return_value (procedure,
+                                   gimp_param_spec_int32_array ("info",
+                                                                "info",
+                                                                "The integer attributes of the layers, 10 per layer",
+                                                                GIMP_PARAM_READWRITE));
+  gimp_procedure_add_return_value (procedure,
+                                   g_param_spec_boxed ("names",
+                                                       "names",
+                                                       "The names of the layers",
+                                                       G_TYPE_STRV,
+                                                       GIMP_PARAM_READWRITE));
+  gimp_procedure_add_return_value (procedure,
+                                   gimp_param_spec_double_array ("opacities",
+                                                                 "opacities",
+                                                                 "The opacities of the layers",
+                                                                 GIMP_PARAM_READWRITE));
+  gimp_pdb_register_procedure (pdb, procedure);
+  g_object_unref (procedure);
+
   /*
    * gimp-image-get-channels
    */
@@ -36,45 +36,95 @@
 #include "gegl/gimp-gegl-tile-compat.h"
 
 #include "core/gimp.h"
+#include "core/gimp-utils.h"
 #include "core/gimpdrawable.h"
 #include "core/gimpdrawable-shadow.h"
 
 #include "pdb/gimp-pdb-compat.h"
 #include "pdb/gimppdb.h"
+#include "pdb/gimppdb-profile.h"
 #include "pdb/gimppdberror.h"
 
 #include "gimpplugin.h"
 #include "gimpplugin-cleanup.h"
 #include "gimpplugin-message.h"
 #include "gimppluginmanager.h"
+#include "gimppluginmanager-pool.h"
 #include "gimpplugindef.h"
 #include "gimppluginshm.h"
+#include "gimpplugintilemap.h"
 #include "gimptemporaryprocedure.h"
 
+#include "gimp-log.h"
+
 #include "gimp-intl.h"
 
 
+typedef struct
+{
+  GPProcRunAsync      *proc_run_async;
+  GimpPlugInProcFrame *proc_frame;
+} GimpPlugInAsyncCall;
+
+
 /*  local function prototypes  */
 
-static void gimp_plug_in_handle_quit             (GimpPlugIn      *plug_in);
-static void gimp_plug_in_handle_tile_request     (GimpPlugIn      *plug_in,
-                                                  GPTileReq       *request);
-static void gimp_plug_in_handle_tile_put         (GimpPlugIn      *plug_in,
-                                                  GPTileReq       *request);
-static void gimp_plug_in_handle_tile_get         (GimpPlugIn      *plug_in,
-                                                  GPTileReq       *request);
-static void gimp_plug_in_handle_proc_run         (GimpPlugIn      *plug_in,
-                                                  GPProcRun       *proc_run);
-static void gimp_plug_in_handle_proc_return      (GimpPlugIn      *plug_in,
-                                                  GPProcReturn    *proc_return);
-static void gimp_plug_in_handle_temp_proc_return (GimpPlugIn      *plug_in,
-                                                  GPProcReturn    *proc_return);
-static void gimp_plug_in_handle_proc_install     (GimpPlugIn      *plug_in,
-                                                  GPProcInstall   *proc_install);
-static void gimp_plug_in_handle_proc_uninstall   (GimpPlugIn      *plug_in,
-                                                  GPProcUninstall *proc_uninstall);
-static void gimp_plug_in_handle_extension_ack    (GimpPlugIn      *plug_in);
-static void gimp_plug_in_handle_has_init         (GimpPlugIn      *plug_in);
+static void gimp_plug_in_handle_quit             (GimpPlugIn          *plug_in);
+static void gimp_plug_in_handle_tile_request     (GimpPlugIn          *plug_in,
+                                                  GPTileReq           *request);
+static void gimp_plug_in_handle_tile_put         (GimpPlugIn          *plug_in,
+                                                  GPTileReq           *request);
+static void gimp_plug_in_handle_tile_get         (GimpPlugIn          *plug_in,
+                                                  GPTileReq           *request);
+static void gimp_plug_in_handle_tile_list_get    (GimpPlugIn          *plug_in,
+                                                  GPTileListReq       *request);
+static void gimp_plug_in_handle_tile_map         (GimpPlugIn          *plug_in,
+                                                  GPTileMapReq        *request);
+static void gimp_plug_in_handle_tile_map_fill    (GimpPlugIn          *plug_in,
+                                                  GPTileListReq       *request);
+static GeglBuffer *
+            gimp_plug_in_get_read_buffer         (GimpPlugIn          *plug_in,
+                                                  gint32               drawable_id,
+                                                  gboolean             shadow);
+static GimpValueArray *
+            gimp_plug_in_execute_proc_run        (GimpPlugIn          *plug_in,
+                                                  GimpPlugInProcFrame *proc_frame,
+                                                  GPProcRun           *proc_run,
+                                                  GPProcRunList       *proc_run_list,
+                                                  guint                call,
+                                                  GimpValueArray     **return_vals_list);
+static gboolean
+            gimp_plug_in_apply_proc_links        (GPProcRunList       *proc_run_list,
+                                                  guint                call,
+                                                  GimpValueArray     **return_vals_list,
+                                                  GimpValueArray      *args,
+                                                  GError             **error);
+static void gimp_plug_in_handle_proc_run         (GimpPlugIn          *plug_in,
+                                                  GPProcRun           *proc_run);
+static void gimp_plug_in_handle_proc_run_list    (GimpPlugIn          *plug_in,
+                                                  GPProcRunList       *proc_run_list);
+static void gimp_plug_in_handle_proc_run_async   (GimpPlugIn          *plug_in,
+                                                  GPProcRunAsync      *proc_run_async);
+static void gimp_plug_in_handle_proc_async_poll  (GimpPlugIn          *plug_in,
+                                                  GPProcAsyncPoll     *proc_async_poll);
+static gint gimp_plug_in_find_async_call         (GimpPlugIn          *plug_in,
+                                                  guint32              handle);
+static void gimp_plug_in_run_async_call          (GimpPlugIn          *plug_in);
+static void gimp_plug_in_run_async_calls         (GimpPlugIn          *plug_in);
+static gboolean
+            gimp_plug_in_async_idle              (GimpPlugIn          *plug_in);
+static void gimp_plug_in_async_call_free         (GimpPlugInAsyncCall *async_call);
+static void gimp_plug_in_handle_proc_return      (GimpPlugIn          *plug_in,
+                                                  GPProcReturn        *proc_return);
+static void gimp_plug_in_handle_temp_proc_return (GimpPlugIn          *plug_in,
+                                                  GPProcReturn        *proc_return);
+static void gimp_plug_in_handle_proc_install     (GimpPlugIn          *plug_in,
+                                                  GPProcInstall       *proc_install);
+static void gimp_plug_in_handle_proc_uninstall   (GimpPlugIn          *plug_in,
+                                                  GPProcUninstall     *proc_uninstall);
+static void gimp_plug_in_handle_extension_ack    (GimpPlugIn          *plug_in);
+static void gimp_plug_in_handle_has_init         (GimpPlugIn          *plug_in);
+static void gimp_plug_in_handle_keep_alive       (GimpPlugIn          *plug_in);
 
 
 /*  public functions  */
@@ -83,10 +133,14 @@ void
 gimp_plug_in_handle_message (GimpPlugIn      *plug_in,
                              GimpWireMessage *msg)
 {
+  GIMP_TRACE_SPAN (span);
+
   g_return_if_fail (GIMP_IS_PLUG_IN (plug_in));
   g_return_if_fail (plug_in->open == TRUE);
   g_return_if_fail (msg != NULL);
 
+  GIMP_TRACE_BEGIN (span, "plug-in-message");
+
   switch (msg->type)
     {
     case GP_QUIT:
@@ -160,7 +214,92 @@ gimp_plug_in_handle_message (GimpPlugIn      *plug_in,
     case GP_HAS_INIT:
       gimp_plug_in_handle_has_init (plug_in);
       break;
+
+    case GP_TILE_LIST_REQ:
+      gimp_plug_in_handle_tile_list_get (plug_in, msg->data);
+      break;
+
+    case GP_TILE_LIST_DATA:
+      gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                    "Plug-in \"%s\"\n(%s)\n\n"
+                    "sent a TILE_LIST_DATA message.  This should not happen.",
+                    gimp_object_get_name (plug_in),
+                    gimp_file_get_utf8_name (plug_in->file));
+      gimp_plug_in_close (plug_in, TRUE);
+      break;
+
+    case GP_TILE_MAP_REQ:
+      gimp_plug_in_handle_tile_map (plug_in, msg->data);
+      break;
+
+    case GP_TILE_MAP_DATA:
+      gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                    "Plug-in \"%s\"\n(%s)\n\n"
+                    "sent a TILE_MAP_DATA message.  This should not happen.",
+                    gimp_object_get_name (plug_in),
+                    gimp_file_get_utf8_name (plug_in->file));
+      gimp_plug_in_close (plug_in, TRUE);
+      break;
+
+    case GP_TILE_MAP_FILL:
+      gimp_plug_in_handle_tile_map_fill (plug_in, msg->data);
+      break;
+
+    case GP_KEEP_ALIVE:
+      gimp_plug_in_handle_keep_alive (plug_in);
+      break;
+
+    case GP_PROC_RUN_LIST:
+      gimp_plug_in_handle_proc_run_list (plug_in, msg->data);
+      break;
+
+    case GP_PROC_RETURN_LIST:
+      gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                    "Plug-in \"%s\"\n(%s)\n\n"
+                    "sent a PROC_RETURN_LIST message.  This should not happen.",
+                    gimp_object_get_name (plug_in),
+                    gimp_file_get_utf8_name (plug_in->file));
+      gimp_plug_in_close (plug_in, TRUE);
+      break;
+
+    case GP_PROC_RUN_ASYNC:
+      gimp_plug_in_handle_proc_run_async (plug_in, msg->data);
+      /*  the call is queued, and freed once it ran  */
+      msg->data = NULL;
+      break;
+
+    case GP_PROC_ASYNC_POLL:
+      gimp_plug_in_handle_proc_async_poll (plug_in, msg->data);
+      break;
+
+    case GP_PROC_ASYNC_RETURN:
+      gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                    "Plug-in \"%s\"\n(%s)\n\n"
+                    "sent a PROC_ASYNC_RETURN message.  This should not happen.",
+                    gimp_object_get_name (plug_in),
+                    gimp_file_get_utf8_name (plug_in->file));
+      gimp_plug_in_close (plug_in, TRUE);
+      break;
+    }
+
+  GIMP_TRACE_END (span);
+}
+
+void
+gimp_plug_in_clear_async_calls (GimpPlugIn *plug_in)
+{
+  g_return_if_fail (GIMP_IS_PLUG_IN (plug_in));
+
+  g_clear_handle_id (&plug_in->async_idle_id, g_source_remove);
+
+  if (plug_in->async_calls)
+    {
+      g_queue_free_full (plug_in->async_calls,
+                         (GDestroyNotify) gimp_plug_in_async_call_free);
+      plug_in->async_calls = NULL;
     }
+
+  g_clear_pointer (&plug_in->async_returns, g_hash_table_unref);
 }
 
 
@@ -346,49 +485,17 @@ gimp_plug_in_handle_tile_get (GimpPlugIn *plug_in,
 {
   GPTileData       tile_data;
   GimpWireMessage  msg;
-  GimpDrawable    *drawable;
   GeglBuffer      *buffer;
   const Babl      *format;
   GeglRectangle    tile_rect;
   gint             tile_size;
 
-  drawable = (GimpDrawable *) gimp_item_get_by_id (plug_in->manager->gimp,
-                                                   request->drawable_id);
-
-  if (! GIMP_IS_DRAWABLE (drawable))
-    {
-      gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
-                    "Plug-in \"%s\"\n(%s)\n\n"
-                    "tried reading from invalid drawable %d (killing)",
-                    gimp_object_get_name (plug_in),
-                    gimp_file_get_utf8_name (plug_in->file),
-                    request->drawable_id);
-      gimp_plug_in_close (plug_in, TRUE);
-      return;
-    }
-  else if (gimp_item_is_removed (GIMP_ITEM (drawable)))
-    {
-      gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
-                    "Plug-in \"%s\"\n(%s)\n\n"
-                    "tried reading from drawable %d which was removed "
-                    "from the image (killing)",
-                    gimp_object_get_name (plug_in),
-                    gimp_file_get_utf8_name (plug_in->file),
-                    request->drawable_id);
-      gimp_plug_in_close (plug_in, TRUE);
-      return;
-    }
-
-  if (request->shadow)
-    {
-      buffer = gimp_drawable_get_shadow_buffer (drawable);
+  buffer = gimp_plug_in_get_read_buffer (plug_in,
+                                         request->drawable_id,
+                                         request->shadow);
 
-      gimp_plug_in_cleanup_add_shadow (plug_in, drawable);
-    }
-  else
-    {
-      buffer = gimp_drawable_get_buffer (drawable);
-    }
+  if (! buffer)
+    return;
 
   if (! gimp_gegl_buffer_get_tile_rect (buffer,
                                         GIMP_PLUG_IN_TILE_WIDTH,
@@ -461,6 +568,331 @@ gimp_plug_in_handle_tile_get (GimpPlugIn *plug_in,
   gimp_wire_destroy (&msg);
 }
 
+static void
+gimp_plug_in_handle_tile_list_get (GimpPlugIn    *plug_in,
+                                   GPTileListReq *request)
+{
+  GPTileListData   tile_list_data;
+  GimpWireMessage  msg;
+  GeglBuffer      *buffer;
+  const Babl      *format;
+  GeglRectangle    tile_rects[GP_TILE_LIST_MAX_TILES];
+  gsize            max_length;
+  gsize            length;
+  gint             bpp;
+  gint             n_tiles;
+  gint             i;
+
+  g_return_if_fail (request != NULL);
+
+  buffer = gimp_plug_in_get_read_buffer (plug_in,
+                                         request->drawable_id,
+                                         request->shadow);
+
+  if (! buffer)
+    return;
+
+  format = gegl_buffer_get_format (buffer);
+  bpp    = babl_format_get_bytes_per_pixel (format);
+
+  if (plug_in->manager->shm)
+    max_length = gimp_plug_in_shm_get_size (plug_in->manager->shm);
+  else
+    max_length = G_MAXUINT32;
+
+  /*  send as many of the requested tiles as fit in the shared memory
+   *  segment, but at least the first one.  the plug-in asks again for
+   *  the ones we leave out.
+   */
+  length = 0;
+
+  for (n_tiles = 0; n_tiles < (gint) request->n_tiles; n_tiles++)
+    {
+      gsize tile_size;
+
+      if (! gimp_gegl_buffer_get_tile_rect (buffer,
+                                            GIMP_PLUG_IN_TILE_WIDTH,
+                                            GIMP_PLUG_IN_TILE_HEIGHT,
+                                            request->tile_nums[n_tiles],
+                                            &tile_rects[n_tiles]))
+        {
+          gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                        "Plug-in \"%s\"\n(%s)\n\n"
+                        "requested invalid tile #%d for reading (killing)",
+                        gimp_object_get_name (plug_in),
+                        gimp_file_get_utf8_name (plug_in->file),
+                        request->tile_nums[n_tiles]);
+          gimp_plug_in_close (plug_in, TRUE);
+          return;
+        }
+
+      tile_size = (gsize) bpp * tile_rects[n_tiles].width *
+                  tile_rects[n_tiles].height;
+
+      if (n_tiles > 0 && length + tile_size > max_length)
+        break;
+
+      length += tile_size;
+    }
+
+  tile_list_data.drawable_id = request->drawable_id;
+  tile_list_data.shadow      = request->shadow;
+  tile_list_data.bpp         = bpp;
+  tile_list_data.n_tiles     = n_tiles;
+  tile_list_data.tile_nums   = request->tile_nums;
+  tile_list_data.use_shm     = (plug_in->manager->shm != NULL);
+  tile_list_data.length      = length;
+  tile_list_data.data        = NULL;
+
+  if (tile_list_data.use_shm)
+    tile_list_data.data = gimp_plug_in_shm_get_addr (plug_in->manager->shm);
+  else
+    tile_list_data.data = g_malloc (length);
+
+  for (i = 0, length = 0; i < n_tiles; i++)
+    {
+      gegl_buffer_get (buffer, &tile_rects[i], 1.0, format,
+                       tile_list_data.data + length,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+      length += (gsize) bpp * tile_rects[i].width * tile_rects[i].height;
+    }
+
+  if (tile_list_data.use_shm)
+    tile_list_data.data = NULL;
+
+  if (! gp_tile_list_data_write (plug_in->my_write, &tile_list_data, plug_in))
+    {
+      g_free (tile_list_data.data);
+
+      gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                    "%s: ERROR", G_STRFUNC);
+      gimp_plug_in_close (plug_in, TRUE);
+      return;
+    }
+
+  g_free (tile_list_data.data);
+
+  if (! gimp_wire_read_msg (plug_in->my_read, &msg, plug_in))
+    {
+      gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                    "%s: ERROR", G_STRFUNC);
+      gimp_plug_in_close (plug_in, TRUE);
+      return;
+    }
+
+  if (msg.type != GP_TILE_ACK)
+    {
+      gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                    "expected tile ack and received: %d", msg.type);
+      gimp_plug_in_close (plug_in, TRUE);
+      return;
+    }
+
+  gimp_wire_destroy (&msg);
+}
+
+static void
+gimp_plug_in_handle_tile_map (GimpPlugIn   *plug_in,
+                              GPTileMapReq *request)
+{
+  GimpPlugInProcFrame *proc_frame;
+  GimpPlugInTileMap   *map = NULL;
+  GimpDrawable        *drawable;
+  GPTileMapData        tile_map_data;
+  GList               *list;
+  gboolean             success;
+
+  g_return_if_fail (request != NULL);
+
+  if (! gimp_plug_in_get_read_buffer (plug_in, request->drawable_id, FALSE))
+    return;
+
+  drawable = (GimpDrawable *) gimp_item_get_by_id (plug_in->manager->gimp,
+                                                   request->drawable_id);
+
+  proc_frame = gimp_plug_in_get_proc_frame (plug_in);
+
+  if (proc_frame)
+    {
+      list = proc_frame->tile_maps;
+
+      while (list)
+        {
+          GimpPlugInTileMap *tile_map = list->data;
+
+          list = g_list_next (list);
+
+          /*  drop the maps of drawables which are gone, long-running
+           *  plug-ins would accumulate them otherwise
+           */
+          if (! gimp_plug_in_tile_map_validate (tile_map))
+            {
+              proc_frame->tile_maps = g_list_remove (proc_frame->tile_maps,
+                                                     tile_map);
+              gimp_plug_in_tile_map_free (tile_map);
+            }
+          else if (gimp_plug_in_tile_map_get_drawable (tile_map) == drawable)
+            {
+              map = tile_map;
+            }
+        }
+
+      if (! map)
+        {
+          map = gimp_plug_in_tile_map_new (drawable);
+
+          if (map)
+            proc_frame->tile_maps = g_list_prepend (proc_frame->tile_maps,
+                                                    map);
+        }
+    }
+
+  tile_map_data.drawable_id = request->drawable_id;
+  tile_map_data.pid         = gimp_get_pid ();
+  tile_map_data.map_id      = -1;
+  tile_map_data.bpp         = 0;
+  tile_map_data.n_tiles     = 0;
+  tile_map_data.header_size = 0;
+  tile_map_data.size        = 0;
+
+  if (map)
+    {
+      tile_map_data.map_id      = gimp_plug_in_tile_map_get_id (map);
+      tile_map_data.bpp         = gimp_plug_in_tile_map_get_bpp (map);
+      tile_map_data.n_tiles     = gimp_plug_in_tile_map_get_n_tiles (map);
+      tile_map_data.header_size = gimp_plug_in_tile_map_get_header_size (map);
+      tile_map_data.size        = gimp_plug_in_tile_map_get_size (map);
+    }
+
+  success = gp_tile_map_data_write (plug_in->my_write, &tile_map_data,
+                                    plug_in);
+
+#ifndef G_OS_WIN32
+  /*  the plug-in maps the memfd it's passed right after the message  */
+  if (success && map)
+    success = gimp_wire_write_fd (plug_in->my_write, tile_map_data.map_id,
+                                  plug_in);
+#endif
+
+  if (! success)
+    {
+      gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                    "%s: ERROR", G_STRFUNC);
+      gimp_plug_in_close (plug_in, TRUE);
+      return;
+    }
+}
+
+static void
+gimp_plug_in_handle_tile_map_fill (GimpPlugIn    *plug_in,
+                                   GPTileListReq *request)
+{
+  GimpPlugInProcFrame *proc_frame;
+  GimpPlugInTileMap   *map = NULL;
+  GimpDrawable        *drawable;
+  gint                 i;
+
+  g_return_if_fail (request != NULL);
+
+  drawable = (GimpDrawable *) gimp_item_get_by_id (plug_in->manager->gimp,
+                                                   request->drawable_id);
+
+  proc_frame = gimp_plug_in_get_proc_frame (plug_in);
+
+  if (drawable && proc_frame)
+    {
+      GList *list;
+
+      for (list = proc_frame->tile_maps; list; list = g_list_next (list))
+        {
+          if (gimp_plug_in_tile_map_get_drawable (list->data) == drawable)
+            {
+              map = list->data;
+              break;
+            }
+        }
+    }
+
+  /*  if the map went away in the meantime, the plug-in sees it as
+   *  invalid after the ack, and falls back to requesting tiles
+   */
+  if (map && gimp_plug_in_tile_map_validate (map))
+    {
+      for (i = 0; i < (gint) request->n_tiles; i++)
+        {
+          if (! gimp_plug_in_tile_map_fill (map, request->tile_nums[i]))
+            {
+              gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                            "Plug-in \"%s\"\n(%s)\n\n"
+                            "requested invalid tile #%d for mapping (killing)",
+                            gimp_object_get_name (plug_in),
+                            gimp_file_get_utf8_name (plug_in->file),
+                            request->tile_nums[i]);
+              gimp_plug_in_close (plug_in, TRUE);
+              return;
+            }
+        }
+    }
+
+  if (! gp_tile_ack_write (plug_in->my_write, plug_in))
+    {
+      gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                    "%s: ERROR", G_STRFUNC);
+      gimp_plug_in_close (plug_in, TRUE);
+      return;
+    }
+}
+
+static GeglBuffer *
+gimp_plug_in_get_read_buffer (GimpPlugIn *plug_in,
+                              gint32      drawable_id,
+                              gboolean    shadow)
+{
+  GimpDrawable *drawable;
+  GeglBuffer   *buffer;
+
+  drawable = (GimpDrawable *) gimp_item_get_by_id (plug_in->manager->gimp,
+                                                   drawable_id);
+
+  if (! GIMP_IS_DRAWABLE (drawable))
+    {
+      gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                    "Plug-in \"%s\"\n(%s)\n\n"
+                    "tried reading from invalid drawable %d (killing)",
+                    gimp_object_get_name (plug_in),
+                    gimp_file_get_utf8_name (plug_in->file),
+                    drawable_id);
+      gimp_plug_in_close (plug_in, TRUE);
+      return NULL;
+    }
+  else if (gimp_item_is_removed (GIMP_ITEM (drawable)))
+    {
+      gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                    "Plug-in \"%s\"\n(%s)\n\n"
+                    "tried reading from drawable %d which was removed "
+                    "from the image (killing)",
+                    gimp_object_get_name (plug_in),
+                    gimp_file_get_utf8_name (plug_in->file),
+                    drawable_id);
+      gimp_plug_in_close (plug_in, TRUE);
+      return NULL;
+    }
+
+  if (shadow)
+    {
+      buffer = gimp_drawable_get_shadow_buffer (drawable);
+
+      gimp_plug_in_cleanup_add_shadow (plug_in, drawable);
+    }
+  else
+    {
+      buffer = gimp_drawable_get_buffer (drawable);
+    }
+
+  return buffer;
+}
+
 static void
 gimp_plug_in_handle_proc_error (GimpPlugIn          *plug_in,
                                 GimpPlugInProcFrame *proc_frame,
@@ -496,25 +928,28 @@ gimp_plug_in_handle_proc_error (GimpPlugIn          *plug_in,
     }
 }
 
-static void
-gimp_plug_in_handle_proc_run (GimpPlugIn *plug_in,
-                              GPProcRun  *proc_run)
+/*  runs one call of the plug-in in 'proc_frame', 'call' of
+ *  'proc_run_list' if that's not NULL, whose earlier calls returned
+ *  'return_vals_list'
+ */
+static GimpValueArray *
+gimp_plug_in_execute_proc_run (GimpPlugIn          *plug_in,
+                               GimpPlugInProcFrame *proc_frame,
+                               GPProcRun           *proc_run,
+                               GPProcRunList       *proc_run_list,
+                               guint                call,
+                               GimpValueArray     **return_vals_list)
 {
-  GimpPlugInProcFrame *proc_frame;
   gchar               *canonical;
   const gchar         *proc_name   = NULL;
   GimpProcedure       *procedure;
   GimpValueArray      *args        = NULL;
   GimpValueArray      *return_vals = NULL;
   GError              *error       = NULL;
-
-  g_return_if_fail (proc_run != NULL);
-  g_return_if_fail (proc_run->name != NULL);
+  gint64               marshal_start = 0;
 
   canonical = gimp_canonicalize_identifier (proc_run->name);
 
-  proc_frame = gimp_plug_in_get_proc_frame (plug_in);
-
   procedure = gimp_pdb_lookup_procedure (plug_in->manager->gimp->pdb,
                                          canonical);
 
@@ -569,6 +1004,9 @@ gimp_plug_in_handle_proc_run (GimpPlugIn *plug_in,
   if (! proc_name)
     proc_name = canonical;
 
+  if (gimp_pdb_profile_is_active ())
+    marshal_start = g_get_monotonic_time ();
+
   args = _gimp_gp_params_to_value_array (plug_in->manager->gimp,
                                          procedure ? procedure->args     : NULL,
                                          procedure ? procedure->num_args : 0,
@@ -576,23 +1014,42 @@ gimp_plug_in_handle_proc_run (GimpPlugIn *plug_in,
                                          proc_run->n_params,
                                          FALSE);
 
-  /*  Execute the procedure even if gimp_pdb_lookup_procedure()
-   *  returned NULL, gimp_pdb_execute_procedure_by_name_args() will
-   *  return appropriate error return_vals.
-   */
-  gimp_plug_in_manager_plug_in_push (plug_in->manager, plug_in);
-  return_vals = gimp_pdb_execute_procedure_by_name_args (plug_in->manager->gimp->pdb,
-                                                         proc_frame->context_stack ?
-                                                         proc_frame->context_stack->data :
-                                                         proc_frame->main_context,
-                                                         proc_frame->progress,
-                                                         &error,
-                                                         proc_name,
-                                                         args);
-  gimp_plug_in_manager_plug_in_pop (plug_in->manager);
+  if (marshal_start)
+    gimp_pdb_profile_add_marshal (proc_name,
+                                  g_get_monotonic_time () - marshal_start);
+
+  if (proc_run_list &&
+      ! gimp_plug_in_apply_proc_links (proc_run_list, call, return_vals_list,
+                                       args, &error))
+    {
+      return_vals = gimp_procedure_get_return_values (procedure, FALSE, error);
+    }
+  else
+    {
+      /*  Execute the procedure even if gimp_pdb_lookup_procedure()
+       *  returned NULL, gimp_pdb_execute_procedure_by_name_args() will
+       *  return appropriate error return_vals.
+       */
+      gimp_plug_in_manager_plug_in_push (plug_in->manager, plug_in);
+      return_vals = gimp_pdb_execute_procedure_by_name_args (plug_in->manager->gimp->pdb,
+                                                             proc_frame->context_stack ?
+                                                             proc_frame->context_stack->data :
+                                                             proc_frame->main_context,
+                                                             proc_frame->progress,
+                                                             &error,
+                                                             proc_name,
+                                                             args);
+      gimp_plug_in_manager_plug_in_pop (plug_in->manager);
+    }
 
   gimp_value_array_unref (args);
 
+  /*  the procedure might have replaced or removed drawables the plug-in
+   *  has mapped, make sure it doesn't keep using stale tiles
+   */
+  g_list_foreach (proc_frame->tile_maps,
+                  (GFunc) gimp_plug_in_tile_map_validate, NULL);
+
   if (error)
     {
       gimp_plug_in_handle_proc_error (plug_in, proc_frame,
@@ -602,12 +1059,108 @@ gimp_plug_in_handle_proc_run (GimpPlugIn *plug_in,
 
   g_free (canonical);
 
+  return return_vals;
+}
+
+/*  replaces the arguments of call 'call' which are linked to return
+ *  values of earlier calls
+ */
+static gboolean
+gimp_plug_in_apply_proc_links (GPProcRunList   *proc_run_list,
+                               guint            call,
+                               GimpValueArray **return_vals_list,
+                               GimpValueArray  *args,
+                               GError         **error)
+{
+  guint i;
+
+  for (i = 0; i < proc_run_list->n_links; i++)
+    {
+      GPProcLink     *link = &proc_run_list->links[i];
+      GimpValueArray *source;
+      GValue         *src;
+      GValue         *dest;
+
+      if (link->call != call)
+        continue;
+
+      if (link->source_call >= call ||
+          link->argument >= gimp_value_array_length (args))
+        {
+          g_set_error (error, GIMP_PDB_ERROR, GIMP_PDB_ERROR_INVALID_ARGUMENT,
+                       "Invalid link to argument %u of call %u",
+                       link->argument, call);
+          return FALSE;
+        }
+
+      source = return_vals_list[link->source_call];
+
+      if (g_value_get_enum (gimp_value_array_index (source, 0)) !=
+          GIMP_PDB_SUCCESS)
+        {
+          g_set_error (error, GIMP_PDB_ERROR, GIMP_PDB_ERROR_FAILED,
+                       "Call %u was skipped, call %u it depends on failed",
+                       call, link->source_call);
+          return FALSE;
+        }
+
+      if (link->source_value >= gimp_value_array_length (source))
+        {
+          g_set_error (error, GIMP_PDB_ERROR, GIMP_PDB_ERROR_INVALID_ARGUMENT,
+                       "Call %u has no return value %u",
+                       link->source_call, link->source_value);
+          return FALSE;
+        }
+
+      src  = gimp_value_array_index (source, link->source_value);
+      dest = gimp_value_array_index (args, link->argument);
+
+      if (! g_value_transform (src, dest))
+        {
+          g_set_error (error, GIMP_PDB_ERROR, GIMP_PDB_ERROR_INVALID_ARGUMENT,
+                       "Return value %u of call %u, of type %s, can't be "
+                       "argument %u of call %u, of type %s",
+                       link->source_value, link->source_call,
+                       g_type_name (G_VALUE_TYPE (src)),
+                       link->argument, call,
+                       g_type_name (G_VALUE_TYPE (dest)));
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+static void
+gimp_plug_in_handle_proc_run (GimpPlugIn *plug_in,
+                              GPProcRun  *proc_run)
+{
+  GimpValueArray *return_vals;
+
+  g_return_if_fail (proc_run != NULL);
+  g_return_if_fail (proc_run->name != NULL);
+
+  /*  calls keep the order the plug-in made them in  */
+  gimp_plug_in_run_async_calls (plug_in);
+
+  if (! plug_in->open)
+    return;
+
+  return_vals = gimp_plug_in_execute_proc_run (plug_in,
+                                               gimp_plug_in_get_proc_frame (plug_in),
+                                               proc_run,
+                                               NULL, 0, NULL);
+
   /*  Don't bother to send the return value if executing the procedure
    *  closed the plug-in (e.g. if the procedure is gimp-quit)
    */
   if (plug_in->open)
     {
       GPProcReturn proc_return;
+      gint64       marshal_start = 0;
+
+      if (gimp_pdb_profile_is_active ())
+        marshal_start = g_get_monotonic_time ();
 
       /*  Return the name we got called with, *not* proc_name or canonical,
        *  since proc_name may have been remapped by gimp->procedural_compat_ht
@@ -625,19 +1178,335 @@ gimp_plug_in_handle_proc_run (GimpPlugIn *plug_in,
         }
 
       _gimp_gp_params_free (proc_return.params, proc_return.n_params, FALSE);
+
+      if (marshal_start)
+        {
+          gchar *canonical = gimp_canonicalize_identifier (proc_run->name);
+
+          gimp_pdb_profile_add_marshal (canonical,
+                                        g_get_monotonic_time () -
+                                        marshal_start);
+          g_free (canonical);
+        }
     }
 
   gimp_value_array_unref (return_vals);
 }
 
+static void
+gimp_plug_in_handle_proc_run_list (GimpPlugIn    *plug_in,
+                                   GPProcRunList *proc_run_list)
+{
+  GimpValueArray **return_vals_list;
+  guint            n_return_vals = 0;
+  guint            i;
+
+  g_return_if_fail (proc_run_list != NULL);
+
+  gimp_plug_in_run_async_calls (plug_in);
+
+  return_vals_list = g_new0 (GimpValueArray *, proc_run_list->n_runs);
+
+  for (i = 0; i < proc_run_list->n_runs && plug_in->open; i++)
+    {
+      GPProcRun *proc_run = &proc_run_list->runs[i];
+
+      if (! proc_run->name)
+        break;
+
+      return_vals_list[i] = gimp_plug_in_execute_proc_run (plug_in,
+                                                           gimp_plug_in_get_proc_frame (plug_in),
+                                                           proc_run,
+                                                           proc_run_list, i,
+                                                           return_vals_list);
+      n_return_vals++;
+    }
+
+  /*  Don't bother to send the return values if executing one of the
+   *  procedures closed the plug-in (e.g. if it was gimp-quit)
+   */
+  if (plug_in->open)
+    {
+      GPProcReturnList proc_return_list;
+
+      proc_return_list.n_returns = n_return_vals;
+      proc_return_list.returns   = g_new0 (GPProcReturn, n_return_vals);
+
+      for (i = 0; i < n_return_vals; i++)
+        {
+          GPProcReturn *proc_return = &proc_return_list.returns[i];
+
+          proc_return->name     = proc_run_list->runs[i].name;
+          proc_return->n_params = gimp_value_array_length (return_vals_list[i]);
+          proc_return->params   = _gimp_value_array_to_gp_params (return_vals_list[i],
+                                                                  FALSE);
+        }
+
+      if (! gp_proc_return_list_write (plug_in->my_write, &proc_return_list,
+                                       plug_in))
+        {
+          gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                        "%s: ERROR", G_STRFUNC);
+          gimp_plug_in_close (plug_in, TRUE);
+        }
+
+      for (i = 0; i < n_return_vals; i++)
+        _gimp_gp_params_free (proc_return_list.returns[i].params,
+                              proc_return_list.returns[i].n_params, FALSE);
+
+      g_free (proc_return_list.returns);
+    }
+
+  for (i = 0; i < n_return_vals; i++)
+    gimp_value_array_unref (return_vals_list[i]);
+
+  g_free (return_vals_list);
+}
+
+static void
+gimp_plug_in_handle_proc_run_async (GimpPlugIn     *plug_in,
+                                    GPProcRunAsync *proc_run_async)
+{
+  GimpPlugInAsyncCall *async_call;
+
+  if (! proc_run_async || ! proc_run_async->proc_run.name)
+    {
+      gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                    "Plug-in \"%s\"\n(%s)\n\n"
+                    "sent an invalid PROC_RUN_ASYNC message.",
+                    gimp_object_get_name (plug_in),
+                    gimp_file_get_utf8_name (plug_in->file));
+
+      if (proc_run_async)
+        {
+          GimpWireMessage msg;
+
+          msg.type = GP_PROC_RUN_ASYNC;
+          msg.data = proc_run_async;
+
+          gimp_wire_destroy (&msg);
+        }
+
+      gimp_plug_in_close (plug_in, TRUE);
+      return;
+    }
+
+  if (! plug_in->async_calls)
+    {
+      plug_in->async_calls   = g_queue_new ();
+      plug_in->async_returns =
+        g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                               (GDestroyNotify) gimp_value_array_unref);
+    }
+
+  /*  a reused handle forgets the earlier call's return values  */
+  g_hash_table_remove (plug_in->async_returns,
+                       GUINT_TO_POINTER (proc_run_async->handle));
+
+  async_call = g_slice_new (GimpPlugInAsyncCall);
+
+  async_call->proc_run_async = proc_run_async;
+  async_call->proc_frame     = gimp_plug_in_get_proc_frame (plug_in);
+
+  g_queue_push_tail (plug_in->async_calls, async_call);
+
+  if (! plug_in->async_idle_id)
+    plug_in->async_idle_id =
+      g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+                       (GSourceFunc) gimp_plug_in_async_idle,
+                       g_object_ref (plug_in),
+                       (GDestroyNotify) g_object_unref);
+}
+
+static void
+gimp_plug_in_handle_proc_async_poll (GimpPlugIn      *plug_in,
+                                     GPProcAsyncPoll *proc_async_poll)
+{
+  GPProcAsyncReturn  proc_async_return = { 0, };
+  GimpValueArray    *return_vals       = NULL;
+  gint               n_ahead;
+
+  g_return_if_fail (proc_async_poll != NULL);
+
+  if (proc_async_poll->wait)
+    {
+      while (plug_in->open &&
+             gimp_plug_in_find_async_call (plug_in,
+                                           proc_async_poll->handle) >= 0)
+        {
+          gimp_plug_in_run_async_call (plug_in);
+        }
+
+      if (! plug_in->open)
+        return;
+    }
+
+  proc_async_return.handle = proc_async_poll->handle;
+
+  n_ahead = gimp_plug_in_find_async_call (plug_in, proc_async_poll->handle);
+
+  if (n_ahead >= 0)
+    {
+      proc_async_return.status  = GP_PROC_ASYNC_PENDING;
+      proc_async_return.n_ahead = n_ahead;
+    }
+  else if (plug_in->async_returns &&
+           g_hash_table_steal_extended (plug_in->async_returns,
+                                        GUINT_TO_POINTER (proc_async_poll->handle),
+                                        NULL, (gpointer *) &return_vals))
+    {
+      GPProcReturn *proc_return = &proc_async_return.proc_return;
+
+      proc_async_return.status = GP_PROC_ASYNC_DONE;
+
+      proc_return->n_params = gimp_value_array_length (return_vals);
+      proc_return->params   = _gimp_value_array_to_gp_params (return_vals,
+                                                              FALSE);
+    }
+  else
+    {
+      proc_async_return.status = GP_PROC_ASYNC_UNKNOWN;
+    }
+
+  if (! gp_proc_async_return_write (plug_in->my_write, &proc_async_return,
+                                    plug_in))
+    {
+      gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                    "%s: ERROR", G_STRFUNC);
+      gimp_plug_in_close (plug_in, TRUE);
+    }
+
+  if (return_vals)
+    {
+      _gimp_gp_params_free (proc_async_return.proc_return.params,
+                            proc_async_return.proc_return.n_params, FALSE);
+      gimp_value_array_unref (return_vals);
+    }
+}
+
+/*  returns the number of calls queued before call 'handle', or -1 if
+ *  it isn't queued
+ */
+static gint
+gimp_plug_in_find_async_call (GimpPlugIn *plug_in,
+                              guint32     handle)
+{
+  GList *list;
+  gint   n_ahead = 0;
+
+  if (! plug_in->async_calls)
+    return -1;
+
+  for (list = plug_in->async_calls->head; list; list = g_list_next (list))
+    {
+      GimpPlugInAsyncCall *async_call = list->data;
+
+      if (async_call->proc_run_async->handle == handle)
+        return n_ahead;
+
+      n_ahead++;
+    }
+
+  return -1;
+}
+
+/*  runs the first queued call, keeping its return values until the
+ *  plug-in polls for them
+ */
+static void
+gimp_plug_in_run_async_call (GimpPlugIn *plug_in)
+{
+  GimpPlugInAsyncCall *async_call;
+  GimpValueArray      *return_vals;
+
+  async_call = g_queue_pop_head (plug_in->async_calls);
+
+  g_object_ref (plug_in);
+
+  return_vals = gimp_plug_in_execute_proc_run (plug_in,
+                                               async_call->proc_frame,
+                                               &async_call->proc_run_async->proc_run,
+                                               NULL, 0, NULL);
+
+  if (plug_in->open)
+    g_hash_table_insert (plug_in->async_returns,
+                         GUINT_TO_POINTER (async_call->proc_run_async->handle),
+                         return_vals);
+  else
+    gimp_value_array_unref (return_vals);
+
+  gimp_plug_in_async_call_free (async_call);
+
+  g_object_unref (plug_in);
+}
+
+/*  runs all queued calls, before anything the plug-in asks for
+ *  synchronously, and before their proc frames go away
+ */
+static void
+gimp_plug_in_run_async_calls (GimpPlugIn *plug_in)
+{
+  while (plug_in->open &&
+         plug_in->async_calls &&
+         ! g_queue_is_empty (plug_in->async_calls))
+    {
+      gimp_plug_in_run_async_call (plug_in);
+    }
+}
+
+static gboolean
+gimp_plug_in_async_idle (GimpPlugIn *plug_in)
+{
+  /*  one call per iteration, so the UI stays responsive in between  */
+  if (plug_in->open &&
+      plug_in->async_calls &&
+      ! g_queue_is_empty (plug_in->async_calls))
+    {
+      gimp_plug_in_run_async_call (plug_in);
+    }
+
+  if (plug_in->open &&
+      plug_in->async_calls &&
+      ! g_queue_is_empty (plug_in->async_calls))
+    {
+      return G_SOURCE_CONTINUE;
+    }
+
+  plug_in->async_idle_id = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gimp_plug_in_async_call_free (GimpPlugInAsyncCall *async_call)
+{
+  GimpWireMessage msg;
+
+  msg.type = GP_PROC_RUN_ASYNC;
+  msg.data = async_call->proc_run_async;
+
+  gimp_wire_destroy (&msg);
+
+  g_slice_free (GimpPlugInAsyncCall, async_call);
+}
+
 static void
 gimp_plug_in_handle_proc_return (GimpPlugIn   *plug_in,
                                  GPProcReturn *proc_return)
 {
-  GimpPlugInProcFrame *proc_frame = &plug_in->main_proc_frame;
+  GimpPlugInProcFrame *proc_frame    = &plug_in->main_proc_frame;
+  gint64               marshal_start = 0;
 
   g_return_if_fail (proc_return != NULL);
 
+  gimp_plug_in_run_async_calls (plug_in);
+
+  if (! plug_in->open)
+    return;
+
+  if (gimp_pdb_profile_is_active ())
+    marshal_start = g_get_monotonic_time ();
+
   proc_frame->return_vals =
     _gimp_gp_params_to_value_array (plug_in->manager->gimp,
                                     proc_frame->procedure->values,
@@ -646,6 +1515,10 @@ gimp_plug_in_handle_proc_return (GimpPlugIn   *plug_in,
                                     proc_return->n_params,
                                     TRUE);
 
+  if (marshal_start)
+    gimp_pdb_profile_add_marshal (gimp_object_get_name (proc_frame->procedure),
+                                  g_get_monotonic_time () - marshal_start);
+
   if (proc_frame->main_loop)
     {
       g_main_loop_quit (proc_frame->main_loop);
@@ -661,6 +1534,19 @@ gimp_plug_in_handle_proc_return (GimpPlugIn   *plug_in,
                                                    proc_frame->return_vals);
     }
 
+  /*  a reusable plug-in waits for its next call instead of quitting,
+   *  pool it if we can and tell it to quit otherwise
+   */
+  if (plug_in->keep_alive)
+    {
+      plug_in->keep_alive = FALSE;
+
+      if (gimp_plug_in_manager_pool_add (plug_in->manager, plug_in))
+        return;
+
+      gp_quit_write (plug_in->my_write, plug_in);
+    }
+
   gimp_plug_in_close (plug_in, FALSE);
 }
 
@@ -670,9 +1556,18 @@ gimp_plug_in_handle_temp_proc_return (GimpPlugIn   *plug_in,
 {
   g_return_if_fail (proc_return != NULL);
 
+  gimp_plug_in_run_async_calls (plug_in);
+
+  if (! plug_in->open)
+    return;
+
   if (plug_in->temp_proc_frames)
     {
-      GimpPlugInProcFrame *proc_frame = plug_in->temp_proc_frames->data;
+      GimpPlugInProcFrame *proc_frame    = plug_in->temp_proc_frames->data;
+      gint64               marshal_start = 0;
+
+      if (gimp_pdb_profile_is_active ())
+        marshal_start = g_get_monotonic_time ();
 
       proc_frame->return_vals =
         _gimp_gp_params_to_value_array (plug_in->manager->gimp,
@@ -682,6 +1577,10 @@ gimp_plug_in_handle_temp_proc_return (GimpPlugIn   *plug_in,
                                         proc_return->n_params,
                                         TRUE);
 
+      if (marshal_start)
+        gimp_pdb_profile_add_marshal (gimp_object_get_name (proc_frame->procedure),
+                                      g_get_monotonic_time () - marshal_start);
+
       gimp_plug_in_main_loop_quit (plug_in);
       gimp_plug_in_proc_frame_pop (plug_in);
     }
@@ -902,3 +1801,22 @@ gimp_plug_in_handle_has_init (GimpPlugIn *plug_in)
       gimp_plug_in_close (plug_in, TRUE);
     }
 }
+
+static void
+gimp_plug_in_handle_keep_alive (GimpPlugIn *plug_in)
+{
+  if (plug_in->call_mode == GIMP_PLUG_IN_CALL_RUN)
+    {
+      plug_in->keep_alive = TRUE;
+    }
+  else
+    {
+      gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                    "Plug-in \"%s\"\n(%s)\n\n"
+                    "sent a KEEP_ALIVE message while not being run.  "
+                    "This should not happen.",
+                    gimp_object_get_name (plug_in),
+                    gimp_file_get_utf8_name (plug_in->file));
+      gimp_plug_in_close (plug_in, TRUE);
+    }
+}
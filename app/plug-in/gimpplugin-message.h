@@ -20,6 +20,8 @@
 #pragma once
 
 
-void   gimp_plug_in_handle_message (GimpPlugIn      *plug_in,
-                                    GimpWireMessage *msg);
+void   gimp_plug_in_handle_message    (GimpPlugIn      *plug_in,
+                                       GimpWireMessage *msg);
+
+void   gimp_plug_in_clear_async_calls (GimpPlugIn      *plug_in);
 
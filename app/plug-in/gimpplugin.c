@@ -40,6 +40,10 @@
 #include <sys/param.h>
 #endif
 
+#if ! defined(_WIN32) && ! defined(__CYGWIN__)
+#include <sys/socket.h>
+#endif
+
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gegl.h>
 
@@ -156,6 +160,7 @@ gimp_plug_in_init (GimpPlugIn *plug_in)
   plug_in->call_mode          = GIMP_PLUG_IN_CALL_NONE;
   plug_in->open               = FALSE;
   plug_in->hup                = FALSE;
+  plug_in->keep_alive         = FALSE;
   plug_in->pid                = 0;
 
   plug_in->my_read            = NULL;
@@ -172,7 +177,13 @@ gimp_plug_in_init (GimpPlugIn *plug_in)
 
   plug_in->temp_proc_frames   = NULL;
 
+  plug_in->async_calls        = NULL;
+  plug_in->async_returns      = NULL;
+  plug_in->async_idle_id      = 0;
+
   plug_in->plug_in_def        = NULL;
+
+  plug_in->pool_idle_id       = 0;
 }
 
 static void
@@ -518,6 +529,7 @@ gimp_plug_in_open (GimpPlugIn         *plug_in,
   g_return_val_if_fail (GIMP_IS_PLUG_IN (plug_in), FALSE);
   g_return_val_if_fail (plug_in->call_mode == GIMP_PLUG_IN_CALL_NONE, FALSE);
 
+#if defined(G_OS_WIN32) || defined(G_WITH_CYGWIN)
   /* Open two pipes. (Bidirectional communication).
    */
   if ((pipe (my_read) == -1) || (pipe (my_write) == -1))
@@ -529,6 +541,22 @@ gimp_plug_in_open (GimpPlugIn         *plug_in,
                     g_strerror (errno));
       return FALSE;
     }
+#else
+  /* Open two sockets, each one used in one direction, like pipes, but
+   * they can also pass file descriptors to the plug-in, see
+   * gimp_wire_write_fd().
+   */
+  if ((socketpair (AF_UNIX, SOCK_STREAM, 0, my_read)  == -1) ||
+      (socketpair (AF_UNIX, SOCK_STREAM, 0, my_write) == -1))
+    {
+      gimp_message (plug_in->manager->gimp, NULL, GIMP_MESSAGE_ERROR,
+                    "Unable to run plug-in \"%s\"\n(%s)\n\nsocketpair() failed: %s",
+                    gimp_object_get_name (plug_in),
+                    gimp_file_get_utf8_name (plug_in->file),
+                    g_strerror (errno));
+      return FALSE;
+    }
+#endif
 
 #if defined(G_WITH_CYGWIN)
   /* Set to binary mode */
@@ -827,6 +855,9 @@ gimp_plug_in_close (GimpPlugIn *plug_in,
 
   gimp_wire_clear_error ();
 
+  /*  drop the asynchronous calls before their proc frames go away  */
+  gimp_plug_in_clear_async_calls (plug_in);
+
   while (plug_in->temp_proc_frames)
     {
       GimpPlugInProcFrame *proc_frame = plug_in->temp_proc_frames->data;
@@ -46,6 +46,7 @@ struct _GimpPlugIn
   GimpPlugInCallMode   call_mode;       /*  QUERY, INIT or RUN                */
   guint                open : 1;        /*  Is the plug-in open?              */
   guint                hup : 1;         /*  Did we receive a G_IO_HUP         */
+  guint                keep_alive : 1;  /*  Does it stay alive after returning */
   GPid                 pid;             /*  Plug-in's process id              */
 
   GIOChannel          *my_read;         /*  App's read and write channels     */
@@ -66,7 +67,13 @@ struct _GimpPlugIn
 
   GList               *temp_proc_frames;
 
+  GQueue              *async_calls;     /*  Pending GP_PROC_RUN_ASYNC calls   */
+  GHashTable          *async_returns;   /*  Finished calls' return values     */
+  guint                async_idle_id;   /*  Idle running async_calls          */
+
   GimpPlugInDef       *plug_in_def;     /*  Valid during query() and init()   */
+
+  guint                pool_idle_id;    /*  Idle timeout while in the pool    */
 };
 
 struct _GimpPlugInClass
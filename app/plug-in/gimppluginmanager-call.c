@@ -19,6 +19,8 @@
 
 #include "config.h"
 
+#include <errno.h>
+
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gegl.h>
 
@@ -47,6 +49,7 @@
 #include "core/gimpdisplay.h"
 #include "core/gimpprogress.h"
 
+#include "pdb/gimppdb-profile.h"
 #include "pdb/gimppdbcontext.h"
 
 #include "gimpplugin.h"
@@ -56,6 +59,7 @@
 #include "gimppluginmanager.h"
 #define __YES_I_NEED_GIMP_PLUG_IN_MANAGER_CALL__
 #include "gimppluginmanager-call.h"
+#include "gimppluginmanager-pool.h"
 #include "gimppluginshm.h"
 #include "gimptemporaryprocedure.h"
 
@@ -70,112 +74,49 @@ gimp_allow_set_foreground_window (GimpPlugIn *plug_in)
 #endif
 }
 
-
-/*  public functions  */
-
-void
-gimp_plug_in_manager_call_query (GimpPlugInManager *manager,
-                                 GimpContext       *context,
-                                 GimpPlugInDef     *plug_in_def)
+static void
+gimp_plug_in_manager_call_recv (GimpPlugIn *plug_in)
 {
-  GimpPlugIn *plug_in;
-
-  g_return_if_fail (GIMP_IS_PLUG_IN_MANAGER (manager));
-  g_return_if_fail (GIMP_IS_PDB_CONTEXT (context));
-  g_return_if_fail (GIMP_IS_PLUG_IN_DEF (plug_in_def));
-
-  plug_in = gimp_plug_in_new (manager, context, NULL,
-                              NULL, plug_in_def->file, NULL);
+  GimpWireMessage msg;
 
-  if (plug_in)
+  if (! gimp_wire_read_msg (plug_in->my_read, &msg, plug_in))
     {
-      plug_in->plug_in_def = plug_in_def;
-
-      if (gimp_plug_in_open (plug_in, GIMP_PLUG_IN_CALL_QUERY, TRUE))
-        {
-          while (plug_in->open)
-            {
-              GimpWireMessage msg;
-
-              if (! gimp_wire_read_msg (plug_in->my_read, &msg, plug_in))
-                {
-                  gimp_plug_in_close (plug_in, TRUE);
-                }
-              else
-                {
-                  gimp_plug_in_handle_message (plug_in, &msg);
-                  gimp_wire_destroy (&msg);
-                }
-            }
-        }
-
-      g_object_unref (plug_in);
+      gimp_plug_in_close (plug_in, TRUE);
     }
-}
-
-void
-gimp_plug_in_manager_call_init (GimpPlugInManager *manager,
-                                GimpContext       *context,
-                                GimpPlugInDef     *plug_in_def)
-{
-  GimpPlugIn *plug_in;
-
-  g_return_if_fail (GIMP_IS_PLUG_IN_MANAGER (manager));
-  g_return_if_fail (GIMP_IS_PDB_CONTEXT (context));
-  g_return_if_fail (GIMP_IS_PLUG_IN_DEF (plug_in_def));
-
-  plug_in = gimp_plug_in_new (manager, context, NULL,
-                              NULL, plug_in_def->file, NULL);
-
-  if (plug_in)
+  else
     {
-      plug_in->plug_in_def = plug_in_def;
-
-      if (gimp_plug_in_open (plug_in, GIMP_PLUG_IN_CALL_INIT, TRUE))
-        {
-          while (plug_in->open)
-            {
-              GimpWireMessage msg;
-
-              if (! gimp_wire_read_msg (plug_in->my_read, &msg, plug_in))
-                {
-                  gimp_plug_in_close (plug_in, TRUE);
-                }
-              else
-                {
-                  gimp_plug_in_handle_message (plug_in, &msg);
-                  gimp_wire_destroy (&msg);
-                }
-            }
-        }
-
-      g_object_unref (plug_in);
+      gimp_plug_in_handle_message (plug_in, &msg);
+      gimp_wire_destroy (&msg);
     }
 }
 
-GimpValueArray *
-gimp_plug_in_manager_call_run (GimpPlugInManager   *manager,
-                               GimpContext         *context,
-                               GimpProgress        *progress,
-                               GimpPlugInProcedure *procedure,
-                               GimpValueArray      *args,
-                               gboolean             synchronous,
-                               GimpDisplay         *display)
+/*  starts running the procedure in a plug-in, and returns the plug-in,
+ *  whose main proc frame receives the return values.  if the plug-in
+ *  couldn't be started, returns NULL, and sets 'return_vals' to the
+ *  error return values, if there are any
+ */
+static GimpPlugIn *
+gimp_plug_in_manager_call_start (GimpPlugInManager    *manager,
+                                 GimpContext          *context,
+                                 GimpProgress         *progress,
+                                 GimpPlugInProcedure  *procedure,
+                                 GimpValueArray       *args,
+                                 GimpDisplay          *display,
+                                 GimpValueArray      **return_vals)
 {
-  GimpValueArray *return_vals = NULL;
-  GimpPlugIn     *plug_in;
+  GimpPlugIn *plug_in;
 
-  g_return_val_if_fail (GIMP_IS_PLUG_IN_MANAGER (manager), NULL);
-  g_return_val_if_fail (GIMP_IS_PDB_CONTEXT (context), NULL);
-  g_return_val_if_fail (progress == NULL || GIMP_IS_PROGRESS (progress), NULL);
-  g_return_val_if_fail (GIMP_IS_PLUG_IN_PROCEDURE (procedure), NULL);
-  g_return_val_if_fail (args != NULL, NULL);
-  g_return_val_if_fail (display == NULL || GIMP_IS_DISPLAY (display), NULL);
+  *return_vals = NULL;
 
   if (! display)
     display = gimp_context_get_display (context);
 
-  plug_in = gimp_plug_in_new (manager, context, progress, procedure, NULL, display);
+  /*  reuse an idle process of the plug-in if there is one  */
+  plug_in = gimp_plug_in_manager_pool_take (manager, context, progress,
+                                            procedure, display);
+
+  if (! plug_in)
+    plug_in = gimp_plug_in_new (manager, context, progress, procedure, NULL, display);
 
   if (plug_in)
     {
@@ -191,8 +132,10 @@ gimp_plug_in_manager_call_run (GimpPlugInManager   *manager,
       const Babl        *format;
       const guint8      *icc;
       gint               icc_length;
+      gint64             marshal_start  = 0;
 
-      if (! gimp_plug_in_open (plug_in, GIMP_PLUG_IN_CALL_RUN, FALSE))
+      if (! plug_in->open &&
+          ! gimp_plug_in_open (plug_in, GIMP_PLUG_IN_CALL_RUN, FALSE))
         {
           const gchar *name  = gimp_object_get_name (plug_in);
           GError      *error = g_error_new (GIMP_PLUG_IN_ERROR,
@@ -202,11 +145,11 @@ gimp_plug_in_manager_call_run (GimpPlugInManager   *manager,
 
           g_object_unref (plug_in);
 
-          return_vals = gimp_procedure_get_return_values (GIMP_PROCEDURE (procedure),
-                                                          FALSE, error);
+          *return_vals = gimp_procedure_get_return_values (GIMP_PROCEDURE (procedure),
+                                                           FALSE, error);
           g_error_free (error);
 
-          return return_vals;
+          return NULL;
         }
 
       display_id = display ? gimp_display_get_id (display) : -1;
@@ -259,6 +202,9 @@ gimp_plug_in_manager_call_run (GimpPlugInManager   *manager,
       config.swap_compression     = gegl_config->swap_compression;
       config.num_processors       = gegl_config->num_processors;
 
+      if (gimp_pdb_profile_is_active ())
+        marshal_start = g_get_monotonic_time ();
+
       proc_run.name     = (gchar *) gimp_object_get_name (procedure);
       proc_run.n_params = gimp_value_array_length (args);
       proc_run.params   = _gimp_value_array_to_gp_params (args, FALSE);
@@ -280,11 +226,11 @@ gimp_plug_in_manager_call_run (GimpPlugInManager   *manager,
 
           g_object_unref (plug_in);
 
-          return_vals = gimp_procedure_get_return_values (GIMP_PROCEDURE (procedure),
-                                                          FALSE, error);
+          *return_vals = gimp_procedure_get_return_values (GIMP_PROCEDURE (procedure),
+                                                           FALSE, error);
           g_error_free (error);
 
-          return return_vals;
+          return NULL;
         }
 
       g_free (config.display_name);
@@ -296,6 +242,10 @@ gimp_plug_in_manager_call_run (GimpPlugInManager   *manager,
 
       _gimp_gp_params_free (proc_run.params, proc_run.n_params, FALSE);
 
+      if (marshal_start)
+        gimp_pdb_profile_add_marshal (proc_run.name,
+                                      g_get_monotonic_time () - marshal_start);
+
       /* If this is an extension,
        * wait for an installation-confirmation message
        */
@@ -309,7 +259,208 @@ gimp_plug_in_manager_call_run (GimpPlugInManager   *manager,
 
           g_clear_pointer (&plug_in->ext_main_loop, g_main_loop_unref);
         }
+    }
+
+  return plug_in;
+}
+
+
+/*  public functions  */
+
+void
+gimp_plug_in_manager_call_query (GimpPlugInManager *manager,
+                                 GimpContext       *context,
+                                 GimpPlugInDef     *plug_in_def)
+{
+  GimpPlugIn *plug_in;
+
+  g_return_if_fail (GIMP_IS_PLUG_IN_MANAGER (manager));
+  g_return_if_fail (GIMP_IS_PDB_CONTEXT (context));
+  g_return_if_fail (GIMP_IS_PLUG_IN_DEF (plug_in_def));
+
+  plug_in = gimp_plug_in_new (manager, context, NULL,
+                              NULL, plug_in_def->file, NULL);
+
+  if (plug_in)
+    {
+      plug_in->plug_in_def = plug_in_def;
+
+      if (gimp_plug_in_open (plug_in, GIMP_PLUG_IN_CALL_QUERY, TRUE))
+        {
+          while (plug_in->open)
+            gimp_plug_in_manager_call_recv (plug_in);
+        }
+
+      g_object_unref (plug_in);
+    }
+}
+
+void
+gimp_plug_in_manager_call_query_list (GimpPlugInManager  *manager,
+                                      GimpContext        *context,
+                                      GSList             *plug_in_defs,
+                                      gint                n_jobs,
+                                      GimpInitStatusFunc  status_callback)
+{
+  GPtrArray *running;
+  GPollFD   *fds;
+  gint       n_plugins;
+  gint       nth = 0;
+
+  g_return_if_fail (GIMP_IS_PLUG_IN_MANAGER (manager));
+  g_return_if_fail (GIMP_IS_PDB_CONTEXT (context));
+  g_return_if_fail (n_jobs > 0);
+  g_return_if_fail (status_callback != NULL);
+
+  n_plugins = g_slist_length (plug_in_defs);
+
+  running = g_ptr_array_new ();
+  fds     = g_new0 (GPollFD, n_jobs);
+
+  while (plug_in_defs || running->len > 0)
+    {
+      gint i;
+
+      /*  start new queries until n_jobs plug-ins are running  */
+      while (plug_in_defs && running->len < n_jobs)
+        {
+          GimpPlugInDef *plug_in_def = plug_in_defs->data;
+          GimpPlugIn    *plug_in;
+          gchar         *basename;
+
+          plug_in_defs = g_slist_next (plug_in_defs);
 
+          basename =
+            g_path_get_basename (gimp_file_get_utf8_name (plug_in_def->file));
+          status_callback (NULL, basename,
+                           (gdouble) nth++ / (gdouble) n_plugins);
+          g_free (basename);
+
+          if (manager->gimp->be_verbose)
+            g_print ("Querying plug-in: '%s'\n",
+                     gimp_file_get_utf8_name (plug_in_def->file));
+
+          plug_in = gimp_plug_in_new (manager, context, NULL,
+                                      NULL, plug_in_def->file, NULL);
+
+          if (plug_in)
+            {
+              plug_in->plug_in_def = plug_in_def;
+
+              if (gimp_plug_in_open (plug_in, GIMP_PLUG_IN_CALL_QUERY, TRUE))
+                g_ptr_array_add (running, plug_in);
+              else
+                g_object_unref (plug_in);
+            }
+        }
+
+      if (running->len == 0)
+        continue;
+
+      for (i = 0; i < running->len; i++)
+        {
+          GimpPlugIn *plug_in = g_ptr_array_index (running, i);
+
+#ifdef G_OS_WIN32
+          g_io_channel_win32_make_pollfd (plug_in->my_read,
+                                          G_IO_IN | G_IO_HUP | G_IO_ERR,
+                                          &fds[i]);
+#else
+          fds[i].fd     = g_io_channel_unix_get_fd (plug_in->my_read);
+          fds[i].events = G_IO_IN | G_IO_HUP | G_IO_ERR;
+#endif
+          fds[i].revents = 0;
+        }
+
+      if (g_poll (fds, running->len, -1) < 0)
+        {
+          if (errno == EINTR)
+            continue;
+
+          /*  no way to tell who is ready, just do blocking reads  */
+          for (i = 0; i < running->len; i++)
+            fds[i].revents = G_IO_IN;
+        }
+
+      /*  the messages are all handled here, in the main thread, the
+       *  plug-ins only run concurrently.  go backwards, so that removing a
+       *  plug-in doesn't move the ones which are still to be looked at
+       */
+      for (i = (gint) running->len - 1; i >= 0; i--)
+        {
+          GimpPlugIn *plug_in = g_ptr_array_index (running, i);
+
+          if (! fds[i].revents)
+            continue;
+
+          gimp_plug_in_manager_call_recv (plug_in);
+
+          if (! plug_in->open)
+            {
+              g_ptr_array_remove_index_fast (running, i);
+              g_object_unref (plug_in);
+            }
+        }
+    }
+
+  g_free (fds);
+  g_ptr_array_free (running, TRUE);
+}
+
+void
+gimp_plug_in_manager_call_init (GimpPlugInManager *manager,
+                                GimpContext       *context,
+                                GimpPlugInDef     *plug_in_def)
+{
+  GimpPlugIn *plug_in;
+
+  g_return_if_fail (GIMP_IS_PLUG_IN_MANAGER (manager));
+  g_return_if_fail (GIMP_IS_PDB_CONTEXT (context));
+  g_return_if_fail (GIMP_IS_PLUG_IN_DEF (plug_in_def));
+
+  plug_in = gimp_plug_in_new (manager, context, NULL,
+                              NULL, plug_in_def->file, NULL);
+
+  if (plug_in)
+    {
+      plug_in->plug_in_def = plug_in_def;
+
+      if (gimp_plug_in_open (plug_in, GIMP_PLUG_IN_CALL_INIT, TRUE))
+        {
+          while (plug_in->open)
+            gimp_plug_in_manager_call_recv (plug_in);
+        }
+
+      g_object_unref (plug_in);
+    }
+}
+
+
+GimpValueArray *
+gimp_plug_in_manager_call_run (GimpPlugInManager   *manager,
+                               GimpContext         *context,
+                               GimpProgress        *progress,
+                               GimpPlugInProcedure *procedure,
+                               GimpValueArray      *args,
+                               gboolean             synchronous,
+                               GimpDisplay         *display)
+{
+  GimpValueArray *return_vals;
+  GimpPlugIn     *plug_in;
+
+  g_return_val_if_fail (GIMP_IS_PLUG_IN_MANAGER (manager), NULL);
+  g_return_val_if_fail (GIMP_IS_PDB_CONTEXT (context), NULL);
+  g_return_val_if_fail (progress == NULL || GIMP_IS_PROGRESS (progress), NULL);
+  g_return_val_if_fail (GIMP_IS_PLUG_IN_PROCEDURE (procedure), NULL);
+  g_return_val_if_fail (args != NULL, NULL);
+  g_return_val_if_fail (display == NULL || GIMP_IS_DISPLAY (display), NULL);
+
+  plug_in = gimp_plug_in_manager_call_start (manager, context, progress,
+                                             procedure, args, display,
+                                             &return_vals);
+
+  if (plug_in)
+    {
       /* If this plug-in is requested to run synchronously,
        * wait for its return values
        */
@@ -334,6 +485,134 @@ gimp_plug_in_manager_call_run (GimpPlugInManager   *manager,
   return return_vals;
 }
 
+void
+gimp_plug_in_manager_call_run_list (GimpPlugInManager      *manager,
+                                    GimpContext            *context,
+                                    GimpPlugInProcedure   **procedures,
+                                    GimpValueArray        **args,
+                                    gint                    n_runs,
+                                    gint                    n_jobs,
+                                    GimpPlugInCallStartFunc start_callback,
+                                    GimpPlugInCallRunFunc   callback,
+                                    gpointer                user_data)
+{
+  GimpPlugIn **running;
+  gint        *indices;
+  GMainLoop   *main_loop;
+  gint         n_running = 0;
+  gint         next      = 0;
+
+  g_return_if_fail (GIMP_IS_PLUG_IN_MANAGER (manager));
+  g_return_if_fail (GIMP_IS_PDB_CONTEXT (context));
+  g_return_if_fail (n_runs == 0 || (procedures != NULL && args != NULL));
+  g_return_if_fail (n_jobs > 0);
+  g_return_if_fail (callback != NULL);
+
+  running = g_new (GimpPlugIn *, n_jobs);
+  indices = g_new (gint, n_jobs);
+
+  /*  the loop is never run, its only use is making
+   *  gimp_plug_in_handle_proc_return() leave the return values to us,
+   *  like for a synchronous run
+   */
+  main_loop = g_main_loop_new (NULL, FALSE);
+
+  while (next < n_runs || n_running > 0)
+    {
+      gint i;
+
+      /*  start new runs until n_jobs plug-ins are running  */
+      while (next < n_runs && n_running < n_jobs)
+        {
+          GimpValueArray *return_vals;
+          GimpPlugIn     *plug_in;
+
+          plug_in = gimp_plug_in_manager_call_start (manager, context, NULL,
+                                                     procedures[next],
+                                                     args[next], NULL,
+                                                     &return_vals);
+
+          if (plug_in)
+            {
+              plug_in->main_proc_frame.main_loop = g_main_loop_ref (main_loop);
+
+              running[n_running] = plug_in;
+              indices[n_running] = next;
+              n_running++;
+
+              if (start_callback)
+                start_callback (next, plug_in, user_data);
+            }
+          else
+            {
+              if (! return_vals)
+                return_vals =
+                  gimp_procedure_get_return_values (GIMP_PROCEDURE (procedures[next]),
+                                                    FALSE, NULL);
+
+              callback (next, return_vals, user_data);
+
+              gimp_value_array_unref (return_vals);
+            }
+
+          next++;
+        }
+
+      if (n_running == 0)
+        continue;
+
+      g_main_context_iteration (NULL, TRUE);
+
+      /*  hand out the return values of the runs which are done, in the
+       *  order they finish.  go backwards, so that removing a run
+       *  doesn't move the ones which are still to be looked at
+       */
+      for (i = n_running - 1; i >= 0; i--)
+        {
+          GimpPlugIn          *plug_in    = running[i];
+          GimpPlugInProcFrame *proc_frame = &plug_in->main_proc_frame;
+          GimpValueArray      *return_vals;
+
+          if (proc_frame->main_loop == main_loop &&
+              ! proc_frame->return_vals          &&
+              plug_in->open)
+            continue;
+
+          if (proc_frame->main_loop == main_loop)
+            {
+              g_clear_pointer (&proc_frame->main_loop, g_main_loop_unref);
+
+              return_vals =
+                gimp_plug_in_proc_frame_get_return_values (proc_frame);
+            }
+          else
+            {
+              /*  the pooled plug-in was taken for another call before
+               *  we got to its return values
+               */
+              return_vals =
+                gimp_procedure_get_return_values (GIMP_PROCEDURE (procedures[indices[i]]),
+                                                  FALSE, NULL);
+            }
+
+          callback (indices[i], return_vals, user_data);
+
+          gimp_value_array_unref (return_vals);
+          g_object_unref (plug_in);
+
+          n_running--;
+
+          running[i] = running[n_running];
+          indices[i] = indices[n_running];
+        }
+    }
+
+  g_main_loop_unref (main_loop);
+
+  g_free (indices);
+  g_free (running);
+}
+
 GimpValueArray *
 gimp_plug_in_manager_call_run_temp (GimpPlugInManager      *manager,
                                     GimpContext            *context,
@@ -356,10 +635,14 @@ gimp_plug_in_manager_call_run_temp (GimpPlugInManager      *manager,
     {
       GimpPlugInProcFrame *proc_frame;
       GPProcRun            proc_run;
+      gint64               marshal_start = 0;
 
       proc_frame = gimp_plug_in_proc_frame_push (plug_in, context, progress,
                                                  procedure);
 
+      if (gimp_pdb_profile_is_active ())
+        marshal_start = g_get_monotonic_time ();
+
       proc_run.name     = (gchar *) gimp_object_get_name (procedure);
       proc_run.n_params = gimp_value_array_length (args);
       proc_run.params   = _gimp_value_array_to_gp_params (args, FALSE);
@@ -388,6 +671,10 @@ gimp_plug_in_manager_call_run_temp (GimpPlugInManager      *manager,
 
       _gimp_gp_params_free (proc_run.params, proc_run.n_params, FALSE);
 
+      if (marshal_start)
+        gimp_pdb_profile_add_marshal (proc_run.name,
+                                      g_get_monotonic_time () - marshal_start);
+
       g_object_ref (plug_in);
       gimp_plug_in_proc_frame_ref (proc_frame);
 
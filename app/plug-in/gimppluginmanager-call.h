@@ -24,32 +24,64 @@
 #endif
 
 
+typedef void (* GimpPlugInCallStartFunc) (gint            index,
+                                          GimpPlugIn     *plug_in,
+                                          gpointer        user_data);
+typedef void (* GimpPlugInCallRunFunc)   (gint            index,
+                                          GimpValueArray *return_vals,
+                                          gpointer        user_data);
+
+
 /*  Call the plug-in's query() function
  */
-void             gimp_plug_in_manager_call_query    (GimpPlugInManager      *manager,
-                                                     GimpContext            *context,
-                                                     GimpPlugInDef          *plug_in_def);
+void             gimp_plug_in_manager_call_query       (GimpPlugInManager      *manager,
+                                                        GimpContext            *context,
+                                                        GimpPlugInDef          *plug_in_def);
+
+/*  Call the query() functions of a list of plug-ins, running up to
+ *  n_jobs of them at the same time
+ */
+void             gimp_plug_in_manager_call_query_list  (GimpPlugInManager      *manager,
+                                                        GimpContext            *context,
+                                                        GSList                 *plug_in_defs,
+                                                        gint                    n_jobs,
+                                                        GimpInitStatusFunc      status_callback);
 
 /*  Call the plug-in's init() function
  */
-void             gimp_plug_in_manager_call_init     (GimpPlugInManager      *manager,
-                                                     GimpContext            *context,
-                                                     GimpPlugInDef          *plug_in_def);
+void             gimp_plug_in_manager_call_init        (GimpPlugInManager      *manager,
+                                                        GimpContext            *context,
+                                                        GimpPlugInDef          *plug_in_def);
 
 /*  Run a plug-in as if it were a procedure database procedure
  */
-GimpValueArray * gimp_plug_in_manager_call_run      (GimpPlugInManager      *manager,
-                                                     GimpContext            *context,
-                                                     GimpProgress           *progress,
-                                                     GimpPlugInProcedure    *procedure,
-                                                     GimpValueArray         *args,
-                                                     gboolean                synchronous,
-                                                     GimpDisplay            *display);
+GimpValueArray * gimp_plug_in_manager_call_run         (GimpPlugInManager      *manager,
+                                                        GimpContext            *context,
+                                                        GimpProgress           *progress,
+                                                        GimpPlugInProcedure    *procedure,
+                                                        GimpValueArray         *args,
+                                                        gboolean                synchronous,
+                                                        GimpDisplay            *display);
+
+/*  Run a list of plug-in procedures, running up to n_jobs of them at
+ *  the same time, pass the plug-in running each to start_callback,
+ *  if any, and the return values of each to callback as soon as it
+ *  returns
+ */
+void             gimp_plug_in_manager_call_run_list    (GimpPlugInManager      *manager,
+                                                        GimpContext            *context,
+                                                        GimpPlugInProcedure   **procedures,
+                                                        GimpValueArray        **args,
+                                                        gint                    n_runs,
+                                                        gint                    n_jobs,
+                                                        GimpPlugInCallStartFunc start_callback,
+                                                        GimpPlugInCallRunFunc   callback,
+                                                        gpointer                user_data);
 
 /*  Run a temp plug-in proc as if it were a procedure database procedure
  */
-GimpValueArray * gimp_plug_in_manager_call_run_temp (GimpPlugInManager      *manager,
-                                                     GimpContext            *context,
-                                                     GimpProgress           *progress,
-                                                     GimpTemporaryProcedure *procedure,
-                                                     GimpValueArray         *args);
+GimpValueArray * gimp_plug_in_manager_call_run_temp    (GimpPlugInManager      *manager,
+                                                        GimpContext            *context,
+                                                        GimpProgress           *progress,
+                                                        GimpTemporaryProcedure *procedure,
+                                                        GimpValueArray         *args);
@@ -31,10 +31,17 @@
 
 #include "core/gimp.h"
 #include "core/gimp-utils.h"
+#include "core/gimpimage.h"
+#include "core/gimpparamspecs.h"
+#include "core/gimpprogress.h"
+
+#include "pdb/gimppdbcontext.h"
 
 #include "gimpplugin.h"
 #include "gimpplugindef.h"
 #include "gimppluginmanager.h"
+#define __YES_I_NEED_GIMP_PLUG_IN_MANAGER_CALL__
+#include "gimppluginmanager-call.h"
 #include "gimppluginmanager-file.h"
 #include "gimppluginprocedure.h"
 
@@ -56,6 +63,20 @@ typedef enum
 } FileMatchType;
 
 
+typedef struct
+{
+  GimpPlugInManager       *manager;
+  GimpProgress            *progress;
+  GFile                  **files;
+  GimpPlugInProcedure    **procs;
+  gint                    *indices;
+  gint                     n_files;
+  gint                     n_done;
+  GimpPlugInFileLoadFunc   callback;
+  gpointer                 user_data;
+} FileLoadMany;
+
+
 /*  local function prototypes  */
 
 static gboolean              file_proc_in_group (GimpPlugInProcedure    *file_proc,
@@ -87,6 +108,13 @@ static FileMatchType         file_check_single_magic     (const gchar  *offset,
                                                           gint          headsize,
                                                           GFile        *file,
                                                           GInputStream *input);
+
+static GimpValueArray      * file_load_get_arguments     (GimpPlugInProcedure *file_proc,
+                                                          GimpRunMode          run_mode,
+                                                          GFile               *file);
+static void                  file_load_many_done         (gint                 index,
+                                                          GimpValueArray      *return_vals,
+                                                          FileLoadMany        *data);
 static FileMatchType         file_check_magic_list       (GSList       *magics_list,
                                                           const guchar *head,
                                                           gint          headsize,
@@ -250,6 +278,110 @@ gimp_plug_in_manager_file_procedure_find_by_mime_type (GimpPlugInManager      *m
     }
 }
 
+void
+gimp_plug_in_manager_file_load_many (GimpPlugInManager       *manager,
+                                     GimpContext             *context,
+                                     GimpProgress            *progress,
+                                     GimpRunMode              run_mode,
+                                     GFile                  **files,
+                                     gint                     n_files,
+                                     gint                     n_jobs,
+                                     GimpPlugInFileLoadFunc   callback,
+                                     gpointer                 user_data)
+{
+  FileLoadMany     data;
+  GimpValueArray **args;
+  gint             n_runs = 0;
+  gint             i;
+
+  g_return_if_fail (GIMP_IS_PLUG_IN_MANAGER (manager));
+  g_return_if_fail (GIMP_IS_PDB_CONTEXT (context));
+  g_return_if_fail (progress == NULL || GIMP_IS_PROGRESS (progress));
+  g_return_if_fail (files != NULL || n_files == 0);
+  g_return_if_fail (callback != NULL);
+
+  if (n_jobs < 1)
+    n_jobs = MAX (g_get_num_processors (), 1);
+
+  data.manager   = manager;
+  data.progress  = progress;
+  data.files     = files;
+  data.procs     = g_new (GimpPlugInProcedure *, n_files);
+  data.indices   = g_new (gint, n_files);
+  data.n_files   = n_files;
+  data.n_done    = 0;
+  data.callback  = callback;
+  data.user_data = user_data;
+
+  args = g_new (GimpValueArray *, n_files);
+
+  /*  look up all loaders first, files without one, and files which
+   *  are loaded by the core itself, are done right away, and the
+   *  others are queued for the plug-ins
+   */
+  for (i = 0; i < n_files; i++)
+    {
+      GimpPlugInProcedure *file_proc;
+      GError              *error = NULL;
+
+      file_proc = gimp_plug_in_manager_file_procedure_find (manager,
+                                                            GIMP_FILE_PROCEDURE_GROUP_OPEN,
+                                                            files[i], &error);
+
+      if (! file_proc)
+        {
+          data.n_done++;
+
+          callback (i, files[i], NULL, error, user_data);
+
+          g_clear_error (&error);
+        }
+      else if (GIMP_PROCEDURE (file_proc)->proc_type ==
+               GIMP_PDB_PROC_TYPE_INTERNAL)
+        {
+          GimpValueArray *internal_args;
+          GimpValueArray *return_vals;
+
+          internal_args = file_load_get_arguments (file_proc, run_mode,
+                                                   files[i]);
+
+          return_vals = gimp_procedure_execute (GIMP_PROCEDURE (file_proc),
+                                                manager->gimp, context, NULL,
+                                                internal_args, NULL);
+
+          /*  borrow the next queue slot, it's still free  */
+          data.procs[n_runs]   = file_proc;
+          data.indices[n_runs] = i;
+
+          file_load_many_done (n_runs, return_vals, &data);
+
+          gimp_value_array_unref (return_vals);
+          gimp_value_array_unref (internal_args);
+        }
+      else
+        {
+          data.procs[n_runs]   = file_proc;
+          data.indices[n_runs] = i;
+          args[n_runs]         = file_load_get_arguments (file_proc, run_mode,
+                                                          files[i]);
+          n_runs++;
+        }
+    }
+
+  gimp_plug_in_manager_call_run_list (manager, context,
+                                      data.procs, args, n_runs, n_jobs,
+                                      NULL,
+                                      (GimpPlugInCallRunFunc) file_load_many_done,
+                                      &data);
+
+  for (i = 0; i < n_runs; i++)
+    gimp_value_array_unref (args[i]);
+
+  g_free (args);
+  g_free (data.indices);
+  g_free (data.procs);
+}
+
 
 /*  private functions  */
 
@@ -902,3 +1034,97 @@ file_check_magic_list (GSList       *magics_list,
 
   return best_match_val;
 }
+
+static GimpValueArray *
+file_load_get_arguments (GimpPlugInProcedure *file_proc,
+                         GimpRunMode          run_mode,
+                         GFile               *file)
+{
+  GimpProcedure  *proc = GIMP_PROCEDURE (file_proc);
+  GimpValueArray *args;
+  gint            i;
+
+  args = gimp_procedure_get_arguments (proc);
+
+  g_value_set_enum   (gimp_value_array_index (args, 0), run_mode);
+  g_value_set_object (gimp_value_array_index (args, 1), file);
+
+  /*  like gimp-file-load, run with the defaults of everything else  */
+  for (i = 2; i < proc->num_args; i++)
+    if (GIMP_IS_PARAM_SPEC_CHOICE (proc->args[i]))
+      {
+        GParamSpecString *string_spec = G_PARAM_SPEC_STRING (proc->args[i]);
+
+        g_value_set_static_string (gimp_value_array_index (args, i),
+                                   string_spec->default_value);
+      }
+    else if (G_IS_PARAM_SPEC_STRING (proc->args[i]))
+      {
+        g_value_set_static_string (gimp_value_array_index (args, i), "");
+      }
+
+  return args;
+}
+
+static void
+file_load_many_done (gint            index,
+                     GimpValueArray *return_vals,
+                     FileLoadMany   *data)
+{
+  GimpPlugInProcedure *file_proc = data->procs[index];
+  gint                 i         = data->indices[index];
+  GimpImage           *image     = NULL;
+  GError              *error     = NULL;
+  GimpPDBStatusType    status;
+
+  status = g_value_get_enum (gimp_value_array_index (return_vals, 0));
+
+  if (status == GIMP_PDB_SUCCESS)
+    {
+      if (gimp_value_array_length (return_vals) > 1 &&
+          GIMP_VALUE_HOLDS_IMAGE (gimp_value_array_index (return_vals, 1)))
+        {
+          image = g_value_get_object (gimp_value_array_index (return_vals, 1));
+        }
+
+      if (image)
+        {
+          /*  see file_open_image() and gimp-file-load  */
+          if (! gimp_image_get_load_proc (image))
+            gimp_image_set_load_proc (image, file_proc);
+
+          if (! gimp_image_get_file (image))
+            gimp_image_set_imported_file (image, data->files[i]);
+        }
+      else
+        {
+          g_set_error (&error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                       _("%s plug-in returned SUCCESS but did not "
+                         "return an image"),
+                       gimp_procedure_get_label (GIMP_PROCEDURE (file_proc)));
+        }
+    }
+  else if (gimp_value_array_length (return_vals) > 1 &&
+           G_VALUE_HOLDS_STRING (gimp_value_array_index (return_vals, 1)) &&
+           g_value_get_string (gimp_value_array_index (return_vals, 1)))
+    {
+      g_set_error_literal (&error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                           g_value_get_string (gimp_value_array_index (return_vals, 1)));
+    }
+  else
+    {
+      g_set_error (&error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                   _("%s plug-in could not open image"),
+                   gimp_procedure_get_label (GIMP_PROCEDURE (file_proc)));
+    }
+
+  data->n_done++;
+
+  if (data->progress)
+    gimp_progress_set_value (data->progress,
+                             (gdouble) data->n_done / (gdouble) data->n_files);
+
+  data->callback (i, data->files[i], image, error, data->user_data);
+
+  g_clear_error (&error);
+}
@@ -20,6 +20,13 @@
 #pragma once
 
 
+typedef void (* GimpPlugInFileLoadFunc) (gint       index,
+                                         GFile     *file,
+                                         GimpImage *image,
+                                         GError    *error,
+                                         gpointer   user_data);
+
+
 void       gimp_plug_in_manager_add_load_procedure    (GimpPlugInManager      *manager,
                                                        GimpPlugInProcedure    *proc);
 void       gimp_plug_in_manager_add_save_procedure    (GimpPlugInManager      *manager,
@@ -46,3 +53,15 @@ gimp_plug_in_manager_file_procedure_find_by_mime_type (GimpPlugInManager      *m
                                                        GimpFileProcedureGroup  group,
                                                        const gchar            *mime_type);
 
+/*  Load a list of files, running up to n_jobs loader plug-ins at the
+ *  same time, and pass each image to callback as soon as it is loaded
+ */
+void       gimp_plug_in_manager_file_load_many        (GimpPlugInManager      *manager,
+                                                       GimpContext            *context,
+                                                       GimpProgress           *progress,
+                                                       GimpRunMode             run_mode,
+                                                       GFile                 **files,
+                                                       gint                    n_files,
+                                                       gint                    n_jobs,
+                                                       GimpPlugInFileLoadFunc  callback,
+                                                       gpointer                user_data);
@@ -0,0 +1,277 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimppluginmanager-pool.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* plug-ins which called gimp_plug_in_set_reusable() don't quit after
+ * their procedure returned, but wait for another procedure run.  the
+ * pool keeps a few of them around, so that the next call into the same
+ * plug-in doesn't pay for starting a new process.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <gegl.h>
+
+#include "libgimpbase/gimpbase.h"
+#include "libgimpbase/gimpprotocol.h"
+
+#include "plug-in-types.h"
+
+#include "config/gimpcoreconfig.h"
+
+#include "core/gimp.h"
+
+#include "gimpplugin.h"
+#include "gimpplugin-cleanup.h"
+#include "gimpplugin-progress.h"
+#include "gimppluginmanager.h"
+#include "gimppluginmanager-pool.h"
+#include "gimppluginprocedure.h"
+#include "gimpplugintilemap.h"
+
+#include "gimp-log.h"
+
+
+static gboolean   gimp_plug_in_manager_pool_idle_timeout (GimpPlugIn *plug_in);
+static void       gimp_plug_in_manager_pool_release      (GimpPlugIn *plug_in);
+static guint64    gimp_plug_in_manager_pool_get_memsize  (GimpPlugIn *plug_in);
+
+
+/*  public functions  */
+
+gboolean
+gimp_plug_in_manager_pool_add (GimpPlugInManager *manager,
+                               GimpPlugIn        *plug_in)
+{
+  GimpCoreConfig      *config;
+  GimpPlugInProcFrame *proc_frame;
+  guint64              memsize;
+
+  g_return_val_if_fail (GIMP_IS_PLUG_IN_MANAGER (manager), FALSE);
+  g_return_val_if_fail (GIMP_IS_PLUG_IN (plug_in), FALSE);
+
+  config     = manager->gimp->config;
+  proc_frame = &plug_in->main_proc_frame;
+
+  if (config->plug_in_pool_size < 1)
+    return FALSE;
+
+  /*  only plug-ins which are done with everything can be reused  */
+  if (! plug_in->open                                ||
+      plug_in->call_mode != GIMP_PLUG_IN_CALL_RUN    ||
+      plug_in->temp_procedures                       ||
+      plug_in->temp_proc_frames                      ||
+      ! proc_frame->procedure                        ||
+      proc_frame->procedure->proc_type == GIMP_PDB_PROC_TYPE_PERSISTENT)
+    {
+      return FALSE;
+    }
+
+  memsize = gimp_plug_in_manager_pool_get_memsize (plug_in);
+
+  if (config->plug_in_pool_memory_limit > 0 &&
+      memsize > config->plug_in_pool_memory_limit)
+    {
+      GIMP_LOG (PLUG_IN_POOL,
+                "not keeping %s, it uses %" G_GUINT64_FORMAT " bytes",
+                gimp_object_get_name (plug_in), memsize);
+
+      return FALSE;
+    }
+
+  /*  clean up after the run now, instead of when the plug-in is
+   *  finalized.  the return values must stay, the caller might not have
+   *  picked them up yet
+   */
+  if (proc_frame->progress)
+    {
+      gimp_plug_in_progress_end (plug_in, proc_frame);
+
+      g_clear_object (&proc_frame->progress);
+    }
+
+  if (proc_frame->tile_maps)
+    {
+      g_list_free_full (proc_frame->tile_maps,
+                        (GDestroyNotify) gimp_plug_in_tile_map_free);
+      proc_frame->tile_maps = NULL;
+    }
+
+  if (proc_frame->image_cleanups || proc_frame->item_cleanups)
+    gimp_plug_in_cleanup (plug_in, proc_frame);
+
+  g_clear_weak_pointer (&plug_in->display);
+
+  /*  make room by dropping the plug-in which has been idle longest  */
+  while (g_list_length (manager->pooled_plug_ins) >=
+         config->plug_in_pool_size)
+    {
+      GList *last = g_list_last (manager->pooled_plug_ins);
+
+      gimp_plug_in_manager_pool_release (last->data);
+    }
+
+  manager->pooled_plug_ins = g_list_prepend (manager->pooled_plug_ins,
+                                             g_object_ref (plug_in));
+
+  plug_in->pool_idle_id =
+    g_timeout_add_seconds (config->plug_in_pool_idle_timeout,
+                           (GSourceFunc) gimp_plug_in_manager_pool_idle_timeout,
+                           plug_in);
+
+  GIMP_LOG (PLUG_IN_POOL, "keeping %s (%d idle)",
+            gimp_object_get_name (plug_in),
+            g_list_length (manager->pooled_plug_ins));
+
+  return TRUE;
+}
+
+GimpPlugIn *
+gimp_plug_in_manager_pool_take (GimpPlugInManager   *manager,
+                                GimpContext         *context,
+                                GimpProgress        *progress,
+                                GimpPlugInProcedure *procedure,
+                                GimpDisplay         *display)
+{
+  GFile *file;
+  GList *list;
+
+  g_return_val_if_fail (GIMP_IS_PLUG_IN_MANAGER (manager), NULL);
+  g_return_val_if_fail (GIMP_IS_PLUG_IN_PROCEDURE (procedure), NULL);
+
+  file = gimp_plug_in_procedure_get_file (procedure);
+
+  for (list = manager->pooled_plug_ins; list; list = g_list_next (list))
+    {
+      GimpPlugIn *plug_in = list->data;
+
+      if (g_file_equal (plug_in->file, file))
+        {
+          manager->pooled_plug_ins =
+            g_list_delete_link (manager->pooled_plug_ins, list);
+
+          g_clear_handle_id (&plug_in->pool_idle_id, g_source_remove);
+
+          gimp_plug_in_proc_frame_dispose (&plug_in->main_proc_frame,
+                                           plug_in);
+          gimp_plug_in_proc_frame_init (&plug_in->main_proc_frame,
+                                        context, progress, procedure);
+
+          g_set_weak_pointer (&plug_in->display, display);
+
+          GIMP_LOG (PLUG_IN_POOL, "reusing %s",
+                    gimp_object_get_name (plug_in));
+
+          /*  the pool's reference is the caller's now  */
+          return plug_in;
+        }
+    }
+
+  return NULL;
+}
+
+void
+gimp_plug_in_manager_pool_remove (GimpPlugInManager *manager,
+                                  GimpPlugIn        *plug_in)
+{
+  GList *list;
+
+  g_return_if_fail (GIMP_IS_PLUG_IN_MANAGER (manager));
+  g_return_if_fail (GIMP_IS_PLUG_IN (plug_in));
+
+  list = g_list_find (manager->pooled_plug_ins, plug_in);
+
+  if (list)
+    {
+      manager->pooled_plug_ins =
+        g_list_delete_link (manager->pooled_plug_ins, list);
+
+      g_clear_handle_id (&plug_in->pool_idle_id, g_source_remove);
+
+      g_object_unref (plug_in);
+    }
+}
+
+
+/*  private functions  */
+
+static gboolean
+gimp_plug_in_manager_pool_idle_timeout (GimpPlugIn *plug_in)
+{
+  plug_in->pool_idle_id = 0;
+
+  GIMP_LOG (PLUG_IN_POOL, "%s was idle for too long",
+            gimp_object_get_name (plug_in));
+
+  gimp_plug_in_manager_pool_release (plug_in);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gimp_plug_in_manager_pool_release (GimpPlugIn *plug_in)
+{
+  g_object_ref (plug_in);
+
+  gimp_plug_in_manager_pool_remove (plug_in->manager, plug_in);
+
+  /*  ask the plug-in to quit, it is closed when its GP_QUIT arrives  */
+  if (! gp_quit_write (plug_in->my_write, plug_in))
+    gimp_plug_in_close (plug_in, TRUE);
+
+  g_object_unref (plug_in);
+}
+
+static guint64
+gimp_plug_in_manager_pool_get_memsize (GimpPlugIn *plug_in)
+{
+  guint64 memsize = 0;
+
+#if defined(HAVE_UNISTD_H) && ! defined(G_OS_WIN32)
+  gchar *filename;
+  gchar *contents;
+
+  filename = g_strdup_printf ("/proc/%d/statm", (gint) plug_in->pid);
+
+  if (g_file_get_contents (filename, &contents, NULL, NULL))
+    {
+      unsigned long long resident;
+      long               page_size = sysconf (_SC_PAGE_SIZE);
+
+      if (page_size > 0 &&
+          sscanf (contents, "%*u %llu", &resident) == 1)
+        {
+          memsize = (guint64) resident * page_size;
+        }
+
+      g_free (contents);
+    }
+
+  g_free (filename);
+#endif
+
+  /*  0 if we don't know  */
+  return memsize;
+}
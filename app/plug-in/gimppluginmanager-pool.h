@@ -0,0 +1,40 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimppluginmanager-pool.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+/* Keep a plug-in which returned and said it stays alive, returns FALSE
+ * if the pool doesn't take it
+ */
+gboolean     gimp_plug_in_manager_pool_add    (GimpPlugInManager   *manager,
+                                               GimpPlugIn          *plug_in);
+
+/* Take an idle plug-in which can run procedure, ready to be sent the
+ * procedure's config and arguments
+ */
+GimpPlugIn * gimp_plug_in_manager_pool_take   (GimpPlugInManager   *manager,
+                                               GimpContext         *context,
+                                               GimpProgress        *progress,
+                                               GimpPlugInProcedure *procedure,
+                                               GimpDisplay         *display);
+
+/* Forget about a plug-in which is closed */
+void         gimp_plug_in_manager_pool_remove (GimpPlugInManager   *manager,
+                                               GimpPlugIn          *plug_in);
@@ -47,6 +47,7 @@
 #include "gimppluginmanager-restore.h"
 #include "gimppluginprocedure.h"
 #include "plug-in-rc.h"
+#include "plug-in-rc-cache.h"
 
 #include "gimp-intl.h"
 
@@ -134,7 +135,21 @@ gimp_plug_in_manager_restore (GimpPlugInManager  *manager,
       if (gimp->be_verbose)
         g_print ("Writing '%s'\n", gimp_file_get_utf8_name (pluginrc));
 
-      if (! plug_in_rc_write (manager->plug_in_defs, pluginrc, &error))
+      if (plug_in_rc_write (manager->plug_in_defs, pluginrc, &error))
+        {
+          GFile *cache = plug_in_rc_cache_get_file (pluginrc);
+
+          if (! plug_in_rc_cache_write (manager->plug_in_defs, cache,
+                                        pluginrc, &error))
+            {
+              gimp_message_literal (gimp,
+                                    NULL, GIMP_MESSAGE_ERROR, error->message);
+              g_clear_error (&error);
+            }
+
+          g_object_unref (cache);
+        }
+      else
         {
           gimp_message_literal (gimp,
                                 NULL, GIMP_MESSAGE_ERROR, error->message);
@@ -406,16 +421,46 @@ gimp_plug_in_manager_read_pluginrc (GimpPlugInManager  *manager,
                                     GFile              *pluginrc,
                                     GimpInitStatusFunc  status_callback)
 {
-  GSList *rc_defs;
-  GError *error = NULL;
+  GFile    *cache;
+  GSList   *rc_defs;
+  gboolean  stale;
+  GError   *error = NULL;
 
   status_callback (_("Resource configuration"),
                    gimp_file_get_utf8_name (pluginrc), 0.0);
 
+  cache = plug_in_rc_cache_get_file (pluginrc);
+
   if (manager->gimp->be_verbose)
-    g_print ("Parsing '%s'\n", gimp_file_get_utf8_name (pluginrc));
+    g_print ("Parsing '%s'\n", gimp_file_get_utf8_name (cache));
+
+  /*  the cache only has the entries of plug-ins which didn't change  */
+  if (plug_in_rc_cache_parse (manager->gimp, cache, pluginrc,
+                              manager->plug_in_defs, &rc_defs, &stale,
+                              &error))
+    {
+      if (stale)
+        manager->write_pluginrc = TRUE;
+    }
+  else
+    {
+      if (manager->gimp->be_verbose)
+        g_print ("Not using '%s': %s\n",
+                 gimp_file_get_utf8_name (cache), error->message);
+
+      g_clear_error (&error);
 
-  rc_defs = plug_in_rc_parse (manager->gimp, pluginrc, &error);
+      if (manager->gimp->be_verbose)
+        g_print ("Parsing '%s'\n", gimp_file_get_utf8_name (pluginrc));
+
+      rc_defs = plug_in_rc_parse (manager->gimp, pluginrc, &error);
+
+      /*  write the cache next time  */
+      if (rc_defs)
+        manager->write_pluginrc = TRUE;
+    }
+
+  g_object_unref (cache);
 
   if (rc_defs)
     {
@@ -443,11 +488,11 @@ gimp_plug_in_manager_query_new (GimpPlugInManager  *manager,
                                 GimpInitStatusFunc  status_callback)
 {
   GSList *list;
-  gint    n_plugins;
+  GSList *query_defs = NULL;
 
   status_callback (_("Querying new Plug-ins"), "", 0.0);
 
-  for (list = manager->plug_in_defs, n_plugins = 0; list; list = list->next)
+  for (list = manager->plug_in_defs; list; list = list->next)
     {
       GimpPlugInDef *plug_in_def = list->data;
 
@@ -455,36 +500,31 @@ gimp_plug_in_manager_query_new (GimpPlugInManager  *manager,
         gimp_plug_in_def_set_needs_query (plug_in_def, TRUE);
 
       if (plug_in_def->needs_query)
-        n_plugins++;
+        query_defs = g_slist_prepend (query_defs, plug_in_def);
     }
 
-  if (n_plugins)
+  if (query_defs)
     {
-      gint nth;
+      gint n_jobs;
 
       manager->write_pluginrc = TRUE;
 
-      for (list = manager->plug_in_defs, nth = 0; list; list = list->next)
-        {
-          GimpPlugInDef *plug_in_def = list->data;
-
-          if (plug_in_def->needs_query)
-            {
-              gchar *basename;
+      /*  the queries only wait for the plug-ins to start up and talk, so
+       *  run a few of them at once.  one at a time when debugging, to not
+       *  confuse whoever reads the output
+       */
+      if (manager->debug)
+        n_jobs = 1;
+      else
+        n_jobs = CLAMP (GIMP_GEGL_CONFIG (manager->gimp->config)->num_processors,
+                        1, 16);
 
-              basename =
-                g_path_get_basename (gimp_file_get_utf8_name (plug_in_def->file));
-              status_callback (NULL, basename,
-                               (gdouble) nth++ / (gdouble) n_plugins);
-              g_free (basename);
+      query_defs = g_slist_reverse (query_defs);
 
-              if (manager->gimp->be_verbose)
-                g_print ("Querying plug-in: '%s'\n",
-                         gimp_file_get_utf8_name (plug_in_def->file));
+      gimp_plug_in_manager_call_query_list (manager, context, query_defs,
+                                            n_jobs, status_callback);
 
-              gimp_plug_in_manager_call_query (manager, context, plug_in_def);
-            }
-        }
+      g_slist_free (query_defs);
     }
 
   status_callback (NULL, "", 1.0);
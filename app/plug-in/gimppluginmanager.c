@@ -47,6 +47,7 @@
 #include "gimppluginmanager-data.h"
 #include "gimppluginmanager-help-domain.h"
 #include "gimppluginmanager-menu-branch.h"
+#include "gimppluginmanager-pool.h"
 #include "gimppluginshm.h"
 #include "gimptemporaryprocedure.h"
 
@@ -416,6 +417,8 @@ gimp_plug_in_manager_remove_open_plug_in (GimpPlugInManager *manager,
 
   manager->open_plug_ins = g_slist_remove (manager->open_plug_ins, plug_in);
 
+  gimp_plug_in_manager_pool_remove (manager, plug_in);
+
   g_signal_emit (manager, manager_signals[PLUG_IN_CLOSED], 0,
                  plug_in);
 
@@ -59,6 +59,7 @@ struct _GimpPlugInManager
   GimpPlugIn        *current_plug_in;
   GSList            *open_plug_ins;
   GSList            *plug_in_stack;
+  GList             *pooled_plug_ins;
 
   GimpPlugInShm     *shm;
   GimpInterpreterDB *interpreter_db;
@@ -37,6 +37,7 @@
 #include "gimpplugin-cleanup.h"
 #include "gimpplugin-progress.h"
 #include "gimppluginprocedure.h"
+#include "gimpplugintilemap.h"
 
 #include "gimp-intl.h"
 
@@ -110,6 +111,13 @@ gimp_plug_in_proc_frame_dispose (GimpPlugInProcFrame *proc_frame,
       proc_frame->context_stack = NULL;
     }
 
+  if (proc_frame->tile_maps)
+    {
+      g_list_free_full (proc_frame->tile_maps,
+                        (GDestroyNotify) gimp_plug_in_tile_map_free);
+      proc_frame->tile_maps = NULL;
+    }
+
   g_clear_object (&proc_frame->main_context);
   g_clear_pointer (&proc_frame->return_vals, gimp_value_array_unref);
   g_clear_pointer (&proc_frame->main_loop, g_main_loop_unref);
@@ -41,6 +41,9 @@ struct _GimpPlugInProcFrame
   /*  lists of things to clean up on dispose  */
   GList               *image_cleanups;
   GList               *item_cleanups;
+
+  /*  drawables exported to the plug-in as tile maps  */
+  GList               *tile_maps;
 };
 
 
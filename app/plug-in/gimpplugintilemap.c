@@ -0,0 +1,420 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpplugintilemap.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* a drawable's tiles, exported to a plug-in as memory it can map, so that
+ * it can use the pixels without copying them.  the tiles are filled in on
+ * request, see GPTileMapData for the layout.
+ */
+
+#include "config.h"
+
+#ifndef _WIN32
+#define _GNU_SOURCE  /* need memfd_create() */
+#endif
+
+#include <errno.h>
+#include <string.h>
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifdef HAVE_MEMFD_CREATE
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <gegl.h>
+
+#if defined(G_OS_WIN32)
+
+#define STRICT
+#include <windows.h>
+
+#define USE_WIN32_TILE_MAP 1
+
+#elif defined(HAVE_MEMFD_CREATE)
+
+#define USE_MEMFD_TILE_MAP 1
+
+#endif
+
+#include "plug-in-types.h"
+
+#include "gegl/gimp-gegl-tile-compat.h"
+
+#include "core/gimp-utils.h"
+#include "core/gimpdrawable.h"
+
+#include "gimpplugintilemap.h"
+
+#include "gimp-log.h"
+
+
+/* keep the tiles page-aligned, so that a plug-in writing to one of them
+ * only ever gets a private copy of that very tile
+ */
+#define TILE_MAP_ALIGNMENT 4096
+
+
+struct _GimpPlugInTileMap
+{
+  GimpDrawable *drawable;
+  GeglBuffer   *buffer;
+  gulong        changed_handler;
+
+  gint          map_id;
+  gint          bpp;
+  gint          n_tile_cols;
+  gint          n_tile_rows;
+  gsize         tile_size;
+  gsize         header_size;
+  gsize         size;
+  guchar       *addr;
+
+#if defined(USE_WIN32_TILE_MAP)
+  HANDLE        handle;
+#endif
+};
+
+
+static void   gimp_plug_in_tile_map_buffer_changed (GeglBuffer          *buffer,
+                                                    const GeglRectangle *rect,
+                                                    GimpPlugInTileMap   *map);
+static void   gimp_plug_in_tile_map_invalidate     (GimpPlugInTileMap   *map);
+
+
+/*  public functions  */
+
+GimpPlugInTileMap *
+gimp_plug_in_tile_map_new (GimpDrawable *drawable)
+{
+#if defined(USE_WIN32_TILE_MAP) || defined(USE_MEMFD_TILE_MAP)
+  GimpPlugInTileMap *map;
+  GeglBuffer        *buffer;
+  gint               n_tiles;
+
+  g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), NULL);
+
+  buffer = gimp_drawable_get_buffer (drawable);
+
+  map = g_slice_new0 (GimpPlugInTileMap);
+
+  map->drawable    = drawable;
+  map->buffer      = buffer;
+  map->map_id      = -1;
+  map->bpp         = babl_format_get_bytes_per_pixel (gegl_buffer_get_format (buffer));
+  map->n_tile_cols = gimp_gegl_buffer_get_n_tile_cols (buffer,
+                                                       GIMP_PLUG_IN_TILE_WIDTH);
+  map->n_tile_rows = gimp_gegl_buffer_get_n_tile_rows (buffer,
+                                                       GIMP_PLUG_IN_TILE_HEIGHT);
+  map->tile_size   = ((gsize) GIMP_PLUG_IN_TILE_WIDTH *
+                      GIMP_PLUG_IN_TILE_HEIGHT * map->bpp);
+
+  n_tiles = map->n_tile_cols * map->n_tile_rows;
+
+  map->header_size = sizeof (gint32) + n_tiles;
+  map->header_size = ((map->header_size + TILE_MAP_ALIGNMENT - 1) /
+                      TILE_MAP_ALIGNMENT * TILE_MAP_ALIGNMENT);
+  map->size        = map->header_size + n_tiles * map->tile_size;
+
+#if defined(USE_WIN32_TILE_MAP)
+  {
+    static gint  map_serial = 0;
+    gchar        map_name[MAX_PATH];
+    wchar_t     *w_map_name;
+    gint         map_id     = g_atomic_int_add (&map_serial, 1);
+
+    g_snprintf (map_name, sizeof (map_name), "GIMP%d-%d.MAP",
+                gimp_get_pid (), map_id);
+
+    w_map_name = g_utf8_to_utf16 (map_name, -1, NULL, NULL, NULL);
+
+    map->handle = CreateFileMappingW (INVALID_HANDLE_VALUE, NULL,
+                                      PAGE_READWRITE,
+                                      (DWORD) ((guint64) map->size >> 32),
+                                      (DWORD) (map->size & 0xffffffff),
+                                      w_map_name);
+
+    g_free (w_map_name);
+
+    if (map->handle)
+      {
+        map->addr = MapViewOfFile (map->handle, FILE_MAP_ALL_ACCESS,
+                                   0, 0, map->size);
+
+        if (map->addr)
+          map->map_id = map_id;
+        else
+          CloseHandle (map->handle);
+      }
+
+    if (map->map_id == -1)
+      {
+        GIMP_LOG (SHM, "failed to create tile map: %u",
+                  (unsigned) GetLastError ());
+      }
+  }
+#elif defined(USE_MEMFD_TILE_MAP)
+  {
+    gint fd = memfd_create ("gimp-tile-map", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+
+    if (fd != -1)
+      {
+        if (ftruncate (fd, map->size) != -1)
+          {
+            map->addr = mmap (NULL, map->size,
+                              PROT_READ | PROT_WRITE, MAP_SHARED,
+                              fd, 0);
+
+            if (map->addr != MAP_FAILED)
+              map->map_id = fd;
+          }
+
+#ifdef F_ADD_SEALS
+        /*  the plug-in gets the descriptor itself, make sure it can't
+         *  shrink the memory under our feet, or write to it
+         */
+        if (map->map_id != -1)
+          {
+            gint seals = F_SEAL_SHRINK | F_SEAL_GROW;
+
+#ifdef F_SEAL_FUTURE_WRITE
+            /*  older kernels don't know this one  */
+            if (fcntl (fd, F_ADD_SEALS, seals | F_SEAL_FUTURE_WRITE) != -1)
+              seals = 0;
+#endif
+
+            if (seals && fcntl (fd, F_ADD_SEALS, seals) == -1)
+              GIMP_LOG (SHM, "failed to seal tile map: %s", g_strerror (errno));
+          }
+#endif
+
+        if (map->map_id == -1)
+          close (fd);
+      }
+
+    if (map->map_id == -1)
+      {
+        GIMP_LOG (SHM, "failed to create tile map: %s", g_strerror (errno));
+      }
+  }
+#endif
+
+  if (map->map_id == -1)
+    {
+      g_slice_free (GimpPlugInTileMap, map);
+
+      return NULL;
+    }
+
+  /*  mark the map as valid, and all the tiles as still to be filled  */
+  *(gint32 *) map->addr = 1;
+  memset (map->addr + sizeof (gint32), 1, n_tiles);
+
+  g_object_add_weak_pointer (G_OBJECT (map->drawable),
+                             (gpointer) &map->drawable);
+  g_object_add_weak_pointer (G_OBJECT (map->buffer),
+                             (gpointer) &map->buffer);
+
+  map->changed_handler =
+    gegl_buffer_signal_connect (buffer, "changed",
+                                G_CALLBACK (gimp_plug_in_tile_map_buffer_changed),
+                                map);
+
+  GIMP_LOG (SHM, "created tile map ID = %d, size = %" G_GSIZE_FORMAT,
+            map->map_id, map->size);
+
+  return map;
+#else
+  return NULL;
+#endif
+}
+
+void
+gimp_plug_in_tile_map_free (GimpPlugInTileMap *map)
+{
+  g_return_if_fail (map != NULL);
+
+  /*  the plug-in might keep the memory mapped, make sure it doesn't use it
+   *  anymore
+   */
+  gimp_plug_in_tile_map_invalidate (map);
+
+  if (map->drawable)
+    g_object_remove_weak_pointer (G_OBJECT (map->drawable),
+                                  (gpointer) &map->drawable);
+
+#if defined(USE_WIN32_TILE_MAP)
+  UnmapViewOfFile (map->addr);
+  CloseHandle (map->handle);
+#elif defined(USE_MEMFD_TILE_MAP)
+  munmap (map->addr, map->size);
+  close (map->map_id);
+#endif
+
+  GIMP_LOG (SHM, "freed tile map ID = %d", map->map_id);
+
+  g_slice_free (GimpPlugInTileMap, map);
+}
+
+GimpDrawable *
+gimp_plug_in_tile_map_get_drawable (GimpPlugInTileMap *map)
+{
+  g_return_val_if_fail (map != NULL, NULL);
+
+  return map->drawable;
+}
+
+gint
+gimp_plug_in_tile_map_get_id (GimpPlugInTileMap *map)
+{
+  g_return_val_if_fail (map != NULL, -1);
+
+  return map->map_id;
+}
+
+gint
+gimp_plug_in_tile_map_get_bpp (GimpPlugInTileMap *map)
+{
+  g_return_val_if_fail (map != NULL, 0);
+
+  return map->bpp;
+}
+
+gint
+gimp_plug_in_tile_map_get_n_tiles (GimpPlugInTileMap *map)
+{
+  g_return_val_if_fail (map != NULL, 0);
+
+  return map->n_tile_cols * map->n_tile_rows;
+}
+
+gsize
+gimp_plug_in_tile_map_get_header_size (GimpPlugInTileMap *map)
+{
+  g_return_val_if_fail (map != NULL, 0);
+
+  return map->header_size;
+}
+
+gsize
+gimp_plug_in_tile_map_get_size (GimpPlugInTileMap *map)
+{
+  g_return_val_if_fail (map != NULL, 0);
+
+  return map->size;
+}
+
+/*  checks that the map still mirrors the drawable, i.e. that the drawable
+ *  wasn't removed and didn't get a new buffer, and invalidates it otherwise.
+ */
+gboolean
+gimp_plug_in_tile_map_validate (GimpPlugInTileMap *map)
+{
+  g_return_val_if_fail (map != NULL, FALSE);
+
+  if (! map->buffer || ! map->drawable ||
+      gimp_drawable_get_buffer (map->drawable) != map->buffer)
+    {
+      gimp_plug_in_tile_map_invalidate (map);
+    }
+
+  return map->buffer != NULL;
+}
+
+gboolean
+gimp_plug_in_tile_map_fill (GimpPlugInTileMap *map,
+                            gint               tile_num)
+{
+  GeglRectangle tile_rect;
+
+  g_return_val_if_fail (map != NULL, FALSE);
+
+  if (! map->buffer)
+    return FALSE;
+
+  if (! gimp_gegl_buffer_get_tile_rect (map->buffer,
+                                        GIMP_PLUG_IN_TILE_WIDTH,
+                                        GIMP_PLUG_IN_TILE_HEIGHT,
+                                        tile_num, &tile_rect))
+    {
+      return FALSE;
+    }
+
+  /*  clear the flag first, so that a concurrent change marks the tile
+   *  again
+   */
+  map->addr[sizeof (gint32) + tile_num] = 0;
+
+  gegl_buffer_get (map->buffer, &tile_rect, 1.0,
+                   gegl_buffer_get_format (map->buffer),
+                   map->addr + map->header_size + tile_num * map->tile_size,
+                   GIMP_PLUG_IN_TILE_WIDTH * map->bpp,
+                   GEGL_ABYSS_NONE);
+
+  return TRUE;
+}
+
+
+/*  private functions  */
+
+static void
+gimp_plug_in_tile_map_buffer_changed (GeglBuffer          *buffer,
+                                      const GeglRectangle *rect,
+                                      GimpPlugInTileMap   *map)
+{
+  gint col0, col1;
+  gint row0, row1;
+  gint row;
+
+  /*  this can be called from any thread, it only marks the tiles as to be
+   *  filled again
+   */
+  col0 = MAX (rect->x, 0) / GIMP_PLUG_IN_TILE_WIDTH;
+  row0 = MAX (rect->y, 0) / GIMP_PLUG_IN_TILE_HEIGHT;
+  col1 = MIN ((rect->x + rect->width  - 1) / GIMP_PLUG_IN_TILE_WIDTH,
+              map->n_tile_cols - 1);
+  row1 = MIN ((rect->y + rect->height - 1) / GIMP_PLUG_IN_TILE_HEIGHT,
+              map->n_tile_rows - 1);
+
+  for (row = row0; row <= row1; row++)
+    {
+      if (col1 >= col0)
+        {
+          memset (map->addr + sizeof (gint32) + row * map->n_tile_cols + col0,
+                  1, col1 - col0 + 1);
+        }
+    }
+}
+
+static void
+gimp_plug_in_tile_map_invalidate (GimpPlugInTileMap *map)
+{
+  *(volatile gint32 *) map->addr = 0;
+
+  if (map->buffer)
+    {
+      g_signal_handler_disconnect (map->buffer, map->changed_handler);
+      g_object_remove_weak_pointer (G_OBJECT (map->buffer),
+                                    (gpointer) &map->buffer);
+      map->buffer = NULL;
+    }
+}
@@ -0,0 +1,35 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimpplugintilemap.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+GimpPlugInTileMap * gimp_plug_in_tile_map_new             (GimpDrawable      *drawable);
+void                gimp_plug_in_tile_map_free            (GimpPlugInTileMap *map);
+
+GimpDrawable      * gimp_plug_in_tile_map_get_drawable    (GimpPlugInTileMap *map);
+gint                gimp_plug_in_tile_map_get_id          (GimpPlugInTileMap *map);
+gint                gimp_plug_in_tile_map_get_bpp         (GimpPlugInTileMap *map);
+gint                gimp_plug_in_tile_map_get_n_tiles     (GimpPlugInTileMap *map);
+gsize               gimp_plug_in_tile_map_get_header_size (GimpPlugInTileMap *map);
+gsize               gimp_plug_in_tile_map_get_size        (GimpPlugInTileMap *map);
+
+gboolean            gimp_plug_in_tile_map_validate        (GimpPlugInTileMap *map);
+gboolean            gimp_plug_in_tile_map_fill            (GimpPlugInTileMap *map,
+                                                           gint               tile_num);
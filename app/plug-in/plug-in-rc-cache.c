@@ -0,0 +1,1309 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * plug-in-rc-cache.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* a binary copy of pluginrc, written next to it.  it is a GVariant which
+ * is used directly from the mapped file, and each of its plug-in entries
+ * starts with a checksum of the plug-in's path and mtime, so that only the
+ * entries of plug-ins which didn't change need to be looked at.
+ *
+ * pluginrc stays the reference: the cache remembers the size and mtime of
+ * the pluginrc it was written with, and isn't used if pluginrc changed or
+ * is gone.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <gegl.h>
+
+#include "libgimpbase/gimpbase.h"
+#include "libgimpbase/gimpprotocol.h"
+#include "libgimpconfig/gimpconfig.h"
+
+#include "libgimp/gimpgpparams.h"
+
+#include "plug-in-types.h"
+
+#include "core/gimp.h"
+
+#include "gimpplugindef.h"
+#include "gimppluginprocedure.h"
+#include "plug-in-rc-cache.h"
+
+#include "gimp-intl.h"
+
+
+#define PLUG_IN_RC_CACHE_MAGIC   "GIMP pluginrc cache"
+#define PLUG_IN_RC_CACHE_VERSION 1
+
+/*  (magic, protocol version, file version, pluginrc mtime, pluginrc size,
+ *   [(checksum, path, mtime, {plug-in-def}, [{proc-def}])])
+ */
+#define PLUG_IN_RC_CACHE_TYPE    "(suuxta(sayxa{sv}aa{sv}))"
+
+/*  (param def type, type name, value type name, name, nick, blurb, flags,
+ *   meta)
+ */
+#define PROC_ARG_TYPE            "(umaymaymaymaymayuv)"
+
+
+static gchar               * plug_in_rc_cache_checksum      (GFile               *file,
+                                                             gint64               mtime);
+
+static GimpPlugInDef       * plug_in_rc_cache_deserialize_def
+                                                            (GVariant            *record,
+                                                             GimpPlugInDef       *ondisk_def);
+static GimpPlugInProcedure * plug_in_rc_cache_deserialize_procedure
+                                                            (GVariant            *dict,
+                                                             GFile               *file);
+static gboolean              plug_in_rc_cache_deserialize_proc_arg
+                                                            (GVariant            *variant,
+                                                             GimpProcedure       *procedure,
+                                                             gboolean             return_value);
+
+static GVariant            * plug_in_rc_cache_serialize_def (GimpPlugInDef       *plug_in_def);
+static GVariant            * plug_in_rc_cache_serialize_procedure
+                                                            (GimpPlugInProcedure *proc);
+static GVariant            * plug_in_rc_cache_serialize_proc_arg
+                                                            (GParamSpec          *pspec);
+
+static GVariant            * plug_in_rc_cache_new_string    (const gchar         *str);
+static gchar               * plug_in_rc_cache_dup_string    (GVariant            *maybe);
+static gchar               * plug_in_rc_cache_get_string    (GVariant            *tuple,
+                                                             gsize                index);
+static void                  plug_in_rc_cache_add_string    (GVariantBuilder     *builder,
+                                                             const gchar         *key,
+                                                             const gchar         *str);
+static gchar               * plug_in_rc_cache_lookup_string (GVariant            *dict,
+                                                             const gchar         *key);
+static GVariant            * plug_in_rc_cache_new_data      (const guint8        *data,
+                                                             gsize                size);
+
+
+/*  public functions  */
+
+GFile *
+plug_in_rc_cache_get_file (GFile *pluginrc)
+{
+  GFile *parent;
+  GFile *file;
+  gchar *basename;
+  gchar *name;
+
+  g_return_val_if_fail (G_IS_FILE (pluginrc), NULL);
+
+  parent   = g_file_get_parent (pluginrc);
+  basename = g_file_get_basename (pluginrc);
+  name     = g_strconcat (basename, ".cache", NULL);
+
+  file = g_file_get_child (parent, name);
+
+  g_free (name);
+  g_free (basename);
+  g_object_unref (parent);
+
+  return file;
+}
+
+/*  looks up the plug-ins in plug_in_defs, which must have their file and
+ *  mtime set, and returns new plug-in defs for the ones which have an
+ *  up-to-date entry in the cache in rc_defs.  stale is set to TRUE if the
+ *  cache has entries which didn't match, and should be written again.
+ *
+ *  returns FALSE if the cache can't be used at all.
+ */
+gboolean
+plug_in_rc_cache_parse (Gimp      *gimp,
+                        GFile     *file,
+                        GFile     *pluginrc,
+                        GSList    *plug_in_defs,
+                        GSList   **rc_defs,
+                        gboolean  *stale,
+                        GError   **error)
+{
+  GFileInfo    *info;
+  GMappedFile  *mapped;
+  GBytes       *bytes;
+  GVariant     *variant;
+  GVariant     *records;
+  GHashTable   *ondisk_defs;
+  GSList       *list;
+  gchar        *path;
+  const gchar  *magic;
+  guint32       protocol_version;
+  guint32       file_version;
+  gint64        rc_mtime;
+  guint64       rc_size;
+  gint64        cache_rc_mtime;
+  guint64       cache_rc_size;
+  gsize         n_records;
+  gsize         i;
+
+  g_return_val_if_fail (GIMP_IS_GIMP (gimp), FALSE);
+  g_return_val_if_fail (G_IS_FILE (file), FALSE);
+  g_return_val_if_fail (G_IS_FILE (pluginrc), FALSE);
+  g_return_val_if_fail (rc_defs != NULL, FALSE);
+  g_return_val_if_fail (stale != NULL, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  *rc_defs = NULL;
+  *stale   = FALSE;
+
+  info = g_file_query_info (pluginrc,
+                            G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                            G_FILE_QUERY_INFO_NONE,
+                            NULL, error);
+  if (! info)
+    return FALSE;
+
+  rc_mtime = g_file_info_get_attribute_uint64 (info,
+                                               G_FILE_ATTRIBUTE_TIME_MODIFIED);
+  rc_size  = g_file_info_get_size (info);
+
+  g_object_unref (info);
+
+  path = g_file_get_path (file);
+
+  if (! path)
+    {
+      g_set_error (error, GIMP_CONFIG_ERROR, GIMP_CONFIG_ERROR_OPEN,
+                   _("Could not open '%s' for reading"),
+                   gimp_file_get_utf8_name (file));
+      return FALSE;
+    }
+
+  mapped = g_mapped_file_new (path, FALSE, error);
+  g_free (path);
+
+  if (! mapped)
+    return FALSE;
+
+  bytes = g_mapped_file_get_bytes (mapped);
+  g_mapped_file_unref (mapped);
+
+  /*  don't trust the data, GVariant then checks each access  */
+  variant = g_variant_new_from_bytes (G_VARIANT_TYPE (PLUG_IN_RC_CACHE_TYPE),
+                                      bytes, FALSE);
+  g_variant_ref_sink (variant);
+  g_bytes_unref (bytes);
+
+  g_variant_get_child (variant, 0, "&s", &magic);
+  g_variant_get_child (variant, 1, "u",  &protocol_version);
+  g_variant_get_child (variant, 2, "u",  &file_version);
+
+  if (strcmp (magic, PLUG_IN_RC_CACHE_MAGIC)        ||
+      protocol_version != GIMP_PROTOCOL_VERSION     ||
+      file_version     != PLUG_IN_RC_CACHE_VERSION)
+    {
+      g_set_error (error, GIMP_CONFIG_ERROR, GIMP_CONFIG_ERROR_VERSION,
+                   "Skipping '%s': wrong version",
+                   gimp_file_get_utf8_name (file));
+      g_variant_unref (variant);
+      return FALSE;
+    }
+
+  g_variant_get_child (variant, 3, "x", &cache_rc_mtime);
+  g_variant_get_child (variant, 4, "t", &cache_rc_size);
+
+  if (cache_rc_mtime != rc_mtime || cache_rc_size != rc_size)
+    {
+      g_set_error (error, GIMP_CONFIG_ERROR, GIMP_CONFIG_ERROR_VERSION,
+                   "Skipping '%s': it doesn't belong to '%s'",
+                   gimp_file_get_utf8_name (file),
+                   gimp_file_get_utf8_name (pluginrc));
+      g_variant_unref (variant);
+      return FALSE;
+    }
+
+  ondisk_defs = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                       g_free, NULL);
+
+  for (list = plug_in_defs; list; list = g_slist_next (list))
+    {
+      GimpPlugInDef *plug_in_def = list->data;
+      gchar         *checksum;
+
+      checksum = plug_in_rc_cache_checksum (plug_in_def->file,
+                                            plug_in_def->mtime);
+
+      if (checksum)
+        g_hash_table_insert (ondisk_defs, checksum, plug_in_def);
+    }
+
+  records   = g_variant_get_child_value (variant, 5);
+  n_records = g_variant_n_children (records);
+
+  for (i = 0; i < n_records; i++)
+    {
+      GVariant      *record = g_variant_get_child_value (records, i);
+      GimpPlugInDef *ondisk_def;
+      GimpPlugInDef *plug_in_def = NULL;
+      const gchar   *checksum;
+
+      g_variant_get_child (record, 0, "&s", &checksum);
+
+      /*  only the entries of unchanged plug-ins are read any further  */
+      ondisk_def = g_hash_table_lookup (ondisk_defs, checksum);
+
+      if (ondisk_def)
+        plug_in_def = plug_in_rc_cache_deserialize_def (record, ondisk_def);
+
+      if (plug_in_def)
+        *rc_defs = g_slist_prepend (*rc_defs, plug_in_def);
+      else
+        *stale = TRUE;
+
+      g_variant_unref (record);
+    }
+
+  g_variant_unref (records);
+  g_hash_table_unref (ondisk_defs);
+  g_variant_unref (variant);
+
+  *rc_defs = g_slist_reverse (*rc_defs);
+
+  return TRUE;
+}
+
+gboolean
+plug_in_rc_cache_write (GSList  *plug_in_defs,
+                        GFile   *file,
+                        GFile   *pluginrc,
+                        GError **error)
+{
+  GFileInfo       *info;
+  GVariantBuilder  records;
+  GVariant        *variant;
+  GSList          *list;
+  gboolean         success;
+
+  g_return_val_if_fail (G_IS_FILE (file), FALSE);
+  g_return_val_if_fail (G_IS_FILE (pluginrc), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  /*  pluginrc must be written first  */
+  info = g_file_query_info (pluginrc,
+                            G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                            G_FILE_QUERY_INFO_NONE,
+                            NULL, error);
+  if (! info)
+    return FALSE;
+
+  g_variant_builder_init (&records,
+                          G_VARIANT_TYPE ("a(sayxa{sv}aa{sv})"));
+
+  for (list = plug_in_defs; list; list = list->next)
+    {
+      GimpPlugInDef *plug_in_def = list->data;
+
+      if (plug_in_def->procedures)
+        {
+          GVariant *record = plug_in_rc_cache_serialize_def (plug_in_def);
+
+          if (record)
+            g_variant_builder_add_value (&records, record);
+        }
+    }
+
+  variant = g_variant_new ("(suuxta(sayxa{sv}aa{sv}))",
+                           PLUG_IN_RC_CACHE_MAGIC,
+                           (guint32) GIMP_PROTOCOL_VERSION,
+                           (guint32) PLUG_IN_RC_CACHE_VERSION,
+                           (gint64) g_file_info_get_attribute_uint64 (info,
+                                                                      G_FILE_ATTRIBUTE_TIME_MODIFIED),
+                           (guint64) g_file_info_get_size (info),
+                           &records);
+  g_variant_ref_sink (variant);
+
+  g_object_unref (info);
+
+  success = g_file_replace_contents (file,
+                                     g_variant_get_data (variant),
+                                     g_variant_get_size (variant),
+                                     NULL, FALSE,
+                                     G_FILE_CREATE_NONE,
+                                     NULL, NULL, error);
+
+  g_variant_unref (variant);
+
+  return success;
+}
+
+
+/*  private functions  */
+
+static gchar *
+plug_in_rc_cache_checksum (GFile  *file,
+                           gint64  mtime)
+{
+  GChecksum *checksum;
+  gchar     *path;
+  gchar     *str;
+
+  path = gimp_file_get_config_path (file, NULL);
+  if (! path)
+    return NULL;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA1);
+
+  g_checksum_update (checksum, (const guchar *) path, strlen (path) + 1);
+  g_checksum_update (checksum, (const guchar *) &mtime, sizeof (mtime));
+
+  str = g_strdup (g_checksum_get_string (checksum));
+
+  g_checksum_free (checksum);
+  g_free (path);
+
+  return str;
+}
+
+
+/* deserialize functions */
+
+static GimpPlugInDef *
+plug_in_rc_cache_deserialize_def (GVariant      *record,
+                                  GimpPlugInDef *ondisk_def)
+{
+  GimpPlugInDef *plug_in_def;
+  GVariant      *dict;
+  GVariant      *procs;
+  gchar         *path;
+  gchar         *ondisk_path;
+  gint64         mtime;
+  gboolean       has_init;
+  gsize          n_procs;
+  gsize          i;
+
+  path        = plug_in_rc_cache_get_string (record, 1);
+  ondisk_path = gimp_file_get_config_path (ondisk_def->file, NULL);
+
+  g_variant_get_child (record, 2, "x", &mtime);
+
+  /*  don't rely on the checksum alone  */
+  if (g_strcmp0 (path, ondisk_path) || mtime != ondisk_def->mtime)
+    {
+      g_free (path);
+      g_free (ondisk_path);
+
+      return NULL;
+    }
+
+  g_free (path);
+  g_free (ondisk_path);
+
+  plug_in_def = gimp_plug_in_def_new (ondisk_def->file);
+  plug_in_def->mtime = mtime;
+
+  dict = g_variant_get_child_value (record, 3);
+
+  if (g_variant_lookup (dict, "has-init", "b", &has_init) && has_init)
+    gimp_plug_in_def_set_has_init (plug_in_def, TRUE);
+
+  path = plug_in_rc_cache_lookup_string (dict, "help-domain-name");
+
+  if (path)
+    {
+      gchar *uri = plug_in_rc_cache_lookup_string (dict, "help-domain-uri");
+
+      gimp_plug_in_def_set_help_domain (plug_in_def, path, uri);
+
+      g_free (path);
+      g_free (uri);
+    }
+
+  g_variant_unref (dict);
+
+  procs   = g_variant_get_child_value (record, 4);
+  n_procs = g_variant_n_children (procs);
+
+  for (i = 0; i < n_procs; i++)
+    {
+      GimpPlugInProcedure *proc;
+
+      dict = g_variant_get_child_value (procs, i);
+      proc = plug_in_rc_cache_deserialize_procedure (dict, plug_in_def->file);
+      g_variant_unref (dict);
+
+      if (! proc)
+        {
+          /*  the plug-in is then queried again  */
+          g_clear_object (&plug_in_def);
+          break;
+        }
+
+      gimp_plug_in_def_add_procedure (plug_in_def, proc);
+      g_object_unref (proc);
+    }
+
+  g_variant_unref (procs);
+
+  return plug_in_def;
+}
+
+static GimpPlugInProcedure *
+plug_in_rc_cache_deserialize_procedure (GVariant *dict,
+                                        GFile    *file)
+{
+  GimpProcedure       *procedure;
+  GimpPlugInProcedure *proc;
+  GVariant            *value;
+  gchar               *name;
+  gchar               *str;
+  gint32               proc_type;
+  gint32               int_val;
+  gboolean             bool_val;
+  gboolean             success = TRUE;
+
+  name = plug_in_rc_cache_lookup_string (dict, "name");
+
+  if (! (name && *name)                                         ||
+      ! g_variant_lookup (dict, "proc-type", "i", &proc_type)   ||
+      (proc_type != GIMP_PDB_PROC_TYPE_PLUGIN &&
+       proc_type != GIMP_PDB_PROC_TYPE_PERSISTENT))
+    {
+      g_free (name);
+      return NULL;
+    }
+
+  procedure = gimp_plug_in_procedure_new (proc_type, file);
+  proc      = GIMP_PLUG_IN_PROCEDURE (procedure);
+
+  gimp_object_take_name (GIMP_OBJECT (procedure), name);
+
+  procedure->blurb     = plug_in_rc_cache_lookup_string (dict, "blurb");
+  procedure->help      = plug_in_rc_cache_lookup_string (dict, "help");
+  procedure->authors   = plug_in_rc_cache_lookup_string (dict, "authors");
+  procedure->copyright = plug_in_rc_cache_lookup_string (dict, "copyright");
+  procedure->date      = plug_in_rc_cache_lookup_string (dict, "date");
+  proc->menu_label     = plug_in_rc_cache_lookup_string (dict, "menu-label");
+
+  value = g_variant_lookup_value (dict, "menu-paths",
+                                  G_VARIANT_TYPE_BYTESTRING_ARRAY);
+  if (value)
+    {
+      gchar **menu_paths = g_variant_dup_bytestring_array (value, NULL);
+      gint    i;
+
+      /*  the list takes the strings  */
+      for (i = 0; menu_paths[i]; i++)
+        proc->menu_paths = g_list_append (proc->menu_paths, menu_paths[i]);
+
+      g_free (menu_paths);
+      g_variant_unref (value);
+    }
+
+  value = g_variant_lookup_value (dict, "icon-data",
+                                  G_VARIANT_TYPE_BYTESTRING);
+  if (value)
+    {
+      if (g_variant_lookup (dict, "icon-type", "i", &int_val))
+        {
+          switch (int_val)
+            {
+            case GIMP_ICON_TYPE_ICON_NAME:
+            case GIMP_ICON_TYPE_IMAGE_FILE:
+              gimp_plug_in_procedure_take_icon (proc, int_val,
+                                                (guint8 *)
+                                                g_variant_dup_bytestring (value,
+                                                                          NULL),
+                                                -1, NULL);
+              break;
+
+            case GIMP_ICON_TYPE_PIXBUF:
+              {
+                const guint8 *data;
+                gsize         size;
+
+                data = g_variant_get_fixed_array (value, &size, 1);
+
+                gimp_plug_in_procedure_take_icon (proc, int_val,
+                                                  g_memdup2 (data, size), size,
+                                                  NULL);
+              }
+              break;
+
+            default:
+              success = FALSE;
+              break;
+            }
+        }
+
+      g_variant_unref (value);
+    }
+
+  if (g_variant_lookup (dict, "file-proc", "b", &bool_val) && bool_val)
+    {
+      proc->file_proc = TRUE;
+
+      g_free (proc->extensions);
+      proc->extensions = plug_in_rc_cache_lookup_string (dict, "extensions");
+
+      g_free (proc->prefixes);
+      proc->prefixes = plug_in_rc_cache_lookup_string (dict, "prefixes");
+
+      g_free (proc->magics);
+      proc->magics = plug_in_rc_cache_lookup_string (dict, "magics");
+
+      if (g_variant_lookup (dict, "priority", "i", &int_val))
+        gimp_plug_in_procedure_set_priority (proc, int_val);
+
+      str = plug_in_rc_cache_lookup_string (dict, "mime-types");
+      if (str)
+        {
+          gimp_plug_in_procedure_set_mime_types (proc, str);
+          g_free (str);
+        }
+
+      if (g_variant_lookup (dict, "handles-remote", "b", &bool_val) &&
+          bool_val)
+        gimp_plug_in_procedure_set_handles_remote (proc);
+
+      if (g_variant_lookup (dict, "handles-raw", "b", &bool_val) &&
+          bool_val)
+        gimp_plug_in_procedure_set_handles_raw (proc);
+
+      if (g_variant_lookup (dict, "handles-vector", "b", &bool_val) &&
+          bool_val)
+        gimp_plug_in_procedure_set_handles_vector (proc);
+
+      str = plug_in_rc_cache_lookup_string (dict, "thumb-loader");
+      if (str)
+        {
+          gimp_plug_in_procedure_set_thumb_loader (proc, str);
+          g_free (str);
+        }
+    }
+  else
+    {
+      str = plug_in_rc_cache_lookup_string (dict, "batch-interpreter");
+      if (str)
+        {
+          gimp_plug_in_procedure_set_batch_interpreter (proc, str);
+          g_free (str);
+        }
+    }
+
+  str = plug_in_rc_cache_lookup_string (dict, "image-types");
+  gimp_plug_in_procedure_set_image_types (proc, str);
+  g_free (str);
+
+  if (g_variant_lookup (dict, "sensitivity-mask", "i", &int_val))
+    gimp_plug_in_procedure_set_sensitivity_mask (proc, int_val);
+
+  value = g_variant_lookup_value (dict, "args",
+                                  G_VARIANT_TYPE ("a" PROC_ARG_TYPE));
+  if (value)
+    {
+      gsize n = g_variant_n_children (value);
+      gsize i;
+
+      for (i = 0; success && i < n; i++)
+        {
+          GVariant *arg = g_variant_get_child_value (value, i);
+
+          success = plug_in_rc_cache_deserialize_proc_arg (arg, procedure,
+                                                           FALSE);
+          g_variant_unref (arg);
+        }
+
+      g_variant_unref (value);
+    }
+
+  value = g_variant_lookup_value (dict, "values",
+                                  G_VARIANT_TYPE ("a" PROC_ARG_TYPE));
+  if (value)
+    {
+      gsize n = g_variant_n_children (value);
+      gsize i;
+
+      for (i = 0; success && i < n; i++)
+        {
+          GVariant *arg = g_variant_get_child_value (value, i);
+
+          success = plug_in_rc_cache_deserialize_proc_arg (arg, procedure,
+                                                           TRUE);
+          g_variant_unref (arg);
+        }
+
+      g_variant_unref (value);
+    }
+
+  if (! success)
+    g_clear_object (&proc);
+
+  return proc;
+}
+
+static gboolean
+plug_in_rc_cache_deserialize_proc_arg (GVariant      *variant,
+                                       GimpProcedure *procedure,
+                                       gboolean       return_value)
+{
+  GPParamDef  param_def = { 0, };
+  GVariant   *meta;
+  GParamSpec *pspec;
+  gboolean    success   = TRUE;
+
+  g_variant_get_child (variant, 0, "u", &param_def.param_def_type);
+  g_variant_get_child (variant, 6, "u", &param_def.flags);
+  g_variant_get_child (variant, 7, "v", &meta);
+
+  param_def.type_name       = plug_in_rc_cache_get_string (variant, 1);
+  param_def.value_type_name = plug_in_rc_cache_get_string (variant, 2);
+  param_def.name            = plug_in_rc_cache_get_string (variant, 3);
+  param_def.nick            = plug_in_rc_cache_get_string (variant, 4);
+  param_def.blurb           = plug_in_rc_cache_get_string (variant, 5);
+
+  switch (param_def.param_def_type)
+    {
+    case GP_PARAM_DEF_TYPE_DEFAULT:
+    case GP_PARAM_DEF_TYPE_EXPORT_OPTIONS:
+      break;
+
+    case GP_PARAM_DEF_TYPE_INT:
+      if ((success = g_variant_is_of_type (meta, G_VARIANT_TYPE ("(xxx)"))))
+        g_variant_get (meta, "(xxx)",
+                       &param_def.meta.m_int.min_val,
+                       &param_def.meta.m_int.max_val,
+                       &param_def.meta.m_int.default_val);
+      break;
+
+    case GP_PARAM_DEF_TYPE_UNIT:
+      if ((success = g_variant_is_of_type (meta, G_VARIANT_TYPE ("(iii)"))))
+        g_variant_get (meta, "(iii)",
+                       &param_def.meta.m_unit.allow_pixels,
+                       &param_def.meta.m_unit.allow_percent,
+                       &param_def.meta.m_unit.default_val);
+      break;
+
+    case GP_PARAM_DEF_TYPE_ENUM:
+      if ((success = g_variant_is_of_type (meta, G_VARIANT_TYPE_INT32)))
+        param_def.meta.m_enum.default_val = g_variant_get_int32 (meta);
+      break;
+
+    case GP_PARAM_DEF_TYPE_CHOICE:
+      if ((success = g_variant_is_of_type (meta,
+                                           G_VARIANT_TYPE ("(maya(ayimaymay))"))))
+        {
+          GimpChoice *choice = gimp_choice_new ();
+          GVariant   *choices;
+          gsize       n_choices;
+          gsize       i;
+
+          param_def.meta.m_choice.choice      = choice;
+          param_def.meta.m_choice.default_val =
+            plug_in_rc_cache_get_string (meta, 0);
+
+          choices   = g_variant_get_child_value (meta, 1);
+          n_choices = g_variant_n_children (choices);
+
+          for (i = 0; i < n_choices; i++)
+            {
+              GVariant *entry = g_variant_get_child_value (choices, i);
+              gchar    *nick;
+              gchar    *label;
+              gchar    *help;
+              gint32    id;
+
+              g_variant_get_child (entry, 0, "^ay", &nick);
+              g_variant_get_child (entry, 1, "i",   &id);
+              label = plug_in_rc_cache_get_string (entry, 2);
+              help  = plug_in_rc_cache_get_string (entry, 3);
+
+              gimp_choice_add (choice, nick, id, label, help);
+
+              g_free (nick);
+              g_free (label);
+              g_free (help);
+              g_variant_unref (entry);
+            }
+
+          g_variant_unref (choices);
+        }
+      break;
+
+    case GP_PARAM_DEF_TYPE_BOOLEAN:
+      if ((success = g_variant_is_of_type (meta, G_VARIANT_TYPE_INT32)))
+        param_def.meta.m_boolean.default_val = g_variant_get_int32 (meta);
+      break;
+
+    case GP_PARAM_DEF_TYPE_DOUBLE:
+      if ((success = g_variant_is_of_type (meta, G_VARIANT_TYPE ("(ddd)"))))
+        g_variant_get (meta, "(ddd)",
+                       &param_def.meta.m_double.min_val,
+                       &param_def.meta.m_double.max_val,
+                       &param_def.meta.m_double.default_val);
+      break;
+
+    case GP_PARAM_DEF_TYPE_STRING:
+      if ((success = g_variant_is_of_type (meta, G_VARIANT_TYPE ("may"))))
+        param_def.meta.m_string.default_val =
+          plug_in_rc_cache_dup_string (meta);
+      break;
+
+    case GP_PARAM_DEF_TYPE_GEGL_COLOR:
+      if ((success = g_variant_is_of_type (meta,
+                                           G_VARIANT_TYPE ("(im(ayays))"))))
+        {
+          GVariant *maybe;
+          GVariant *color;
+
+          g_variant_get (meta, "(i@m(ayays))",
+                         &param_def.meta.m_gegl_color.has_alpha, &maybe);
+
+          color = g_variant_get_maybe (maybe);
+
+          if (color)
+            {
+              GVariant     *data;
+              GVariant     *profile;
+              const guint8 *bytes;
+              gsize         bpp;
+              gsize         profile_size;
+
+              data    = g_variant_get_child_value (color, 0);
+              profile = g_variant_get_child_value (color, 1);
+
+              bytes = g_variant_get_fixed_array (data, &bpp, 1);
+
+              if (bpp > 0 && bpp <= 40)
+                {
+                  GPParamColor *default_val = g_new0 (GPParamColor, 1);
+
+                  memcpy (default_val->data, bytes, bpp);
+                  default_val->size = bpp;
+
+                  g_variant_get_child (color, 2, "s",
+                                       &default_val->format.encoding);
+
+                  bytes = g_variant_get_fixed_array (profile, &profile_size, 1);
+
+                  if (profile_size > 0)
+                    {
+                      default_val->format.profile_size = profile_size;
+                      default_val->format.profile_data = g_memdup2 (bytes,
+                                                                    profile_size);
+                    }
+
+                  param_def.meta.m_gegl_color.default_val = default_val;
+                }
+              else if (bpp > 40)
+                {
+                  success = FALSE;
+                }
+
+              g_variant_unref (profile);
+              g_variant_unref (data);
+              g_variant_unref (color);
+            }
+
+          g_variant_unref (maybe);
+        }
+      break;
+
+    case GP_PARAM_DEF_TYPE_ID:
+      if ((success = g_variant_is_of_type (meta, G_VARIANT_TYPE_INT32)))
+        param_def.meta.m_id.none_ok = g_variant_get_int32 (meta);
+      break;
+
+    case GP_PARAM_DEF_TYPE_ID_ARRAY:
+      if ((success = g_variant_is_of_type (meta, G_VARIANT_TYPE ("may"))))
+        param_def.meta.m_id_array.type_name =
+          plug_in_rc_cache_dup_string (meta);
+      break;
+
+    case GP_PARAM_DEF_TYPE_RESOURCE:
+      if ((success = g_variant_is_of_type (meta, G_VARIANT_TYPE ("(iii)"))))
+        g_variant_get (meta, "(iii)",
+                       &param_def.meta.m_resource.none_ok,
+                       &param_def.meta.m_resource.default_to_context,
+                       &param_def.meta.m_resource.default_resource_id);
+      break;
+
+    case GP_PARAM_DEF_TYPE_FILE:
+      if ((success = g_variant_is_of_type (meta, G_VARIANT_TYPE ("(iimay)"))))
+        {
+          g_variant_get_child (meta, 0, "i", &param_def.meta.m_file.action);
+          g_variant_get_child (meta, 1, "i", &param_def.meta.m_file.none_ok);
+          param_def.meta.m_file.default_uri =
+            plug_in_rc_cache_get_string (meta, 2);
+        }
+      break;
+
+    default:
+      success = FALSE;
+      break;
+    }
+
+  g_variant_unref (meta);
+
+  if (success && param_def.name)
+    {
+      pspec = _gimp_gp_param_def_to_param_spec (&param_def);
+
+      if (return_value)
+        gimp_procedure_add_return_value (procedure, pspec);
+      else
+        gimp_procedure_add_argument (procedure, pspec);
+    }
+  else
+    {
+      success = FALSE;
+    }
+
+  g_free (param_def.type_name);
+  g_free (param_def.value_type_name);
+  g_free (param_def.name);
+  g_free (param_def.nick);
+  g_free (param_def.blurb);
+
+  switch (param_def.param_def_type)
+    {
+    case GP_PARAM_DEF_TYPE_STRING:
+      g_free (param_def.meta.m_string.default_val);
+      break;
+
+    case GP_PARAM_DEF_TYPE_GEGL_COLOR:
+      if (param_def.meta.m_gegl_color.default_val)
+        {
+          g_free (param_def.meta.m_gegl_color.default_val->format.encoding);
+          g_free (param_def.meta.m_gegl_color.default_val->format.profile_data);
+          g_free (param_def.meta.m_gegl_color.default_val);
+        }
+      break;
+
+    case GP_PARAM_DEF_TYPE_CHOICE:
+      g_clear_object (&param_def.meta.m_choice.choice);
+      g_free (param_def.meta.m_choice.default_val);
+      break;
+
+    case GP_PARAM_DEF_TYPE_ID_ARRAY:
+      g_free (param_def.meta.m_id_array.type_name);
+      break;
+
+    case GP_PARAM_DEF_TYPE_FILE:
+      g_free (param_def.meta.m_file.default_uri);
+      break;
+
+    default:
+      break;
+    }
+
+  return success;
+}
+
+
+/* serialize functions */
+
+static GVariant *
+plug_in_rc_cache_serialize_def (GimpPlugInDef *plug_in_def)
+{
+  GVariantBuilder  dict;
+  GVariantBuilder  procs;
+  GSList          *list;
+  gchar           *checksum;
+  gchar           *path;
+  GVariant        *record;
+
+  path = gimp_file_get_config_path (plug_in_def->file, NULL);
+  if (! path)
+    return NULL;
+
+  checksum = plug_in_rc_cache_checksum (plug_in_def->file,
+                                        plug_in_def->mtime);
+
+  g_variant_builder_init (&dict, G_VARIANT_TYPE_VARDICT);
+
+  plug_in_rc_cache_add_string (&dict, "help-domain-name",
+                               plug_in_def->help_domain_name);
+  plug_in_rc_cache_add_string (&dict, "help-domain-uri",
+                               plug_in_def->help_domain_uri);
+
+  if (plug_in_def->has_init)
+    g_variant_builder_add (&dict, "{sv}",
+                           "has-init", g_variant_new_boolean (TRUE));
+
+  g_variant_builder_init (&procs, G_VARIANT_TYPE ("aa{sv}"));
+
+  for (list = plug_in_def->procedures; list; list = list->next)
+    {
+      GimpPlugInProcedure *proc = list->data;
+
+      if (proc->installed_during_init)
+        continue;
+
+      g_variant_builder_add_value (&procs,
+                                   plug_in_rc_cache_serialize_procedure (proc));
+    }
+
+  record = g_variant_new ("(s@ayxa{sv}aa{sv})",
+                          checksum,
+                          g_variant_new_bytestring (path),
+                          plug_in_def->mtime,
+                          &dict,
+                          &procs);
+
+  g_free (checksum);
+  g_free (path);
+
+  return record;
+}
+
+static GVariant *
+plug_in_rc_cache_serialize_procedure (GimpPlugInProcedure *proc)
+{
+  GimpProcedure   *procedure = GIMP_PROCEDURE (proc);
+  GVariantBuilder  dict;
+  GVariantBuilder  args;
+  gint             i;
+
+  g_variant_builder_init (&dict, G_VARIANT_TYPE_VARDICT);
+
+  plug_in_rc_cache_add_string (&dict, "name",
+                               gimp_object_get_name (procedure));
+  g_variant_builder_add (&dict, "{sv}",
+                         "proc-type",
+                         g_variant_new_int32 (procedure->proc_type));
+
+  plug_in_rc_cache_add_string (&dict, "blurb",      procedure->blurb);
+  plug_in_rc_cache_add_string (&dict, "help",       procedure->help);
+  plug_in_rc_cache_add_string (&dict, "authors",    procedure->authors);
+  plug_in_rc_cache_add_string (&dict, "copyright",  procedure->copyright);
+  plug_in_rc_cache_add_string (&dict, "date",       procedure->date);
+  plug_in_rc_cache_add_string (&dict, "menu-label", proc->menu_label);
+
+  if (proc->menu_paths)
+    {
+      GVariantBuilder  menu_paths;
+      GList           *list;
+
+      g_variant_builder_init (&menu_paths, G_VARIANT_TYPE_BYTESTRING_ARRAY);
+
+      for (list = proc->menu_paths; list; list = list->next)
+        g_variant_builder_add_value (&menu_paths,
+                                     g_variant_new_bytestring (list->data));
+
+      g_variant_builder_add (&dict, "{sv}",
+                             "menu-paths",
+                             g_variant_builder_end (&menu_paths));
+    }
+
+  if (proc->icon_data)
+    {
+      GVariant *icon_data;
+
+      switch (proc->icon_type)
+        {
+        case GIMP_ICON_TYPE_ICON_NAME:
+        case GIMP_ICON_TYPE_IMAGE_FILE:
+          icon_data = g_variant_new_bytestring ((gchar *) proc->icon_data);
+          break;
+
+        case GIMP_ICON_TYPE_PIXBUF:
+        default:
+          icon_data = plug_in_rc_cache_new_data (proc->icon_data,
+                                                 MAX (proc->icon_data_length,
+                                                      0));
+          break;
+        }
+
+      g_variant_builder_add (&dict, "{sv}",
+                             "icon-type",
+                             g_variant_new_int32 (proc->icon_type));
+      g_variant_builder_add (&dict, "{sv}", "icon-data", icon_data);
+    }
+
+  if (proc->file_proc)
+    {
+      g_variant_builder_add (&dict, "{sv}",
+                             "file-proc", g_variant_new_boolean (TRUE));
+
+      plug_in_rc_cache_add_string (&dict, "extensions",   proc->extensions);
+      plug_in_rc_cache_add_string (&dict, "prefixes",     proc->prefixes);
+      plug_in_rc_cache_add_string (&dict, "magics",       proc->magics);
+      plug_in_rc_cache_add_string (&dict, "mime-types",   proc->mime_types);
+      plug_in_rc_cache_add_string (&dict, "thumb-loader", proc->thumb_loader);
+
+      if (proc->priority)
+        g_variant_builder_add (&dict, "{sv}",
+                               "priority",
+                               g_variant_new_int32 (proc->priority));
+
+      if (proc->handles_remote)
+        g_variant_builder_add (&dict, "{sv}",
+                               "handles-remote", g_variant_new_boolean (TRUE));
+
+      if (proc->handles_raw && ! proc->image_types)
+        g_variant_builder_add (&dict, "{sv}",
+                               "handles-raw", g_variant_new_boolean (TRUE));
+
+      if (proc->handles_vector)
+        g_variant_builder_add (&dict, "{sv}",
+                               "handles-vector", g_variant_new_boolean (TRUE));
+    }
+  else if (proc->batch_interpreter)
+    {
+      plug_in_rc_cache_add_string (&dict, "batch-interpreter",
+                                   proc->batch_interpreter_name);
+    }
+
+  plug_in_rc_cache_add_string (&dict, "image-types", proc->image_types);
+
+  g_variant_builder_add (&dict, "{sv}",
+                         "sensitivity-mask",
+                         g_variant_new_int32 (proc->sensitivity_mask));
+
+  g_variant_builder_init (&args, G_VARIANT_TYPE ("a" PROC_ARG_TYPE));
+
+  for (i = 0; i < procedure->num_args; i++)
+    g_variant_builder_add_value (&args,
+                                 plug_in_rc_cache_serialize_proc_arg (procedure->args[i]));
+
+  g_variant_builder_add (&dict, "{sv}", "args", g_variant_builder_end (&args));
+
+  g_variant_builder_init (&args, G_VARIANT_TYPE ("a" PROC_ARG_TYPE));
+
+  for (i = 0; i < procedure->num_values; i++)
+    g_variant_builder_add_value (&args,
+                                 plug_in_rc_cache_serialize_proc_arg (procedure->values[i]));
+
+  g_variant_builder_add (&dict, "{sv}", "values", g_variant_builder_end (&args));
+
+  return g_variant_builder_end (&dict);
+}
+
+static GVariant *
+plug_in_rc_cache_serialize_proc_arg (GParamSpec *pspec)
+{
+  GPParamDef  param_def = { 0, };
+  GVariant   *meta      = NULL;
+
+  _gimp_param_spec_to_gp_param_def (pspec, &param_def, FALSE);
+
+  switch (param_def.param_def_type)
+    {
+    case GP_PARAM_DEF_TYPE_DEFAULT:
+    case GP_PARAM_DEF_TYPE_EXPORT_OPTIONS:
+      break;
+
+    case GP_PARAM_DEF_TYPE_INT:
+      meta = g_variant_new ("(xxx)",
+                            param_def.meta.m_int.min_val,
+                            param_def.meta.m_int.max_val,
+                            param_def.meta.m_int.default_val);
+      break;
+
+    case GP_PARAM_DEF_TYPE_UNIT:
+      meta = g_variant_new ("(iii)",
+                            param_def.meta.m_unit.allow_pixels,
+                            param_def.meta.m_unit.allow_percent,
+                            param_def.meta.m_unit.default_val);
+      break;
+
+    case GP_PARAM_DEF_TYPE_ENUM:
+      meta = g_variant_new_int32 (param_def.meta.m_enum.default_val);
+      break;
+
+    case GP_PARAM_DEF_TYPE_CHOICE:
+      {
+        GVariantBuilder  choices;
+        GList           *nicks;
+        GList           *iter;
+
+        g_variant_builder_init (&choices, G_VARIANT_TYPE ("a(ayimaymay)"));
+
+        nicks = gimp_choice_list_nicks (param_def.meta.m_choice.choice);
+
+        for (iter = nicks; iter; iter = iter->next)
+          {
+            const gchar *nick = iter->data;
+            const gchar *label;
+            const gchar *help;
+            gint         id;
+
+            gimp_choice_get_documentation (param_def.meta.m_choice.choice,
+                                           nick, &label, &help);
+            id = gimp_choice_get_id (param_def.meta.m_choice.choice, nick);
+
+            g_variant_builder_add (&choices, "(@ayi@may@may)",
+                                   g_variant_new_bytestring (nick),
+                                   id,
+                                   plug_in_rc_cache_new_string (label),
+                                   plug_in_rc_cache_new_string (help));
+          }
+
+        meta = g_variant_new ("(@maya(ayimaymay))",
+                              plug_in_rc_cache_new_string (param_def.meta.m_choice.default_val),
+                              &choices);
+      }
+      break;
+
+    case GP_PARAM_DEF_TYPE_BOOLEAN:
+      meta = g_variant_new_int32 (param_def.meta.m_boolean.default_val);
+      break;
+
+    case GP_PARAM_DEF_TYPE_DOUBLE:
+      meta = g_variant_new ("(ddd)",
+                            param_def.meta.m_double.min_val,
+                            param_def.meta.m_double.max_val,
+                            param_def.meta.m_double.default_val);
+      break;
+
+    case GP_PARAM_DEF_TYPE_STRING:
+      meta = plug_in_rc_cache_new_string (param_def.meta.m_string.default_val);
+      break;
+
+    case GP_PARAM_DEF_TYPE_GEGL_COLOR:
+      {
+        GPParamColor *default_val = param_def.meta.m_gegl_color.default_val;
+        GVariant     *color       = NULL;
+
+        if (default_val && default_val->size > 0)
+          {
+            const gchar *encoding = default_val->format.encoding;
+
+            color = g_variant_new ("(@ay@ays)",
+                                   plug_in_rc_cache_new_data (default_val->data,
+                                                              default_val->size),
+                                   plug_in_rc_cache_new_data (default_val->format.profile_data,
+                                                              default_val->format.profile_size),
+                                   encoding ? encoding : "");
+          }
+
+        meta = g_variant_new ("(i@m(ayays))",
+                              param_def.meta.m_gegl_color.has_alpha,
+                              g_variant_new_maybe (G_VARIANT_TYPE ("(ayays)"),
+                                                   color));
+      }
+      break;
+
+    case GP_PARAM_DEF_TYPE_ID:
+      meta = g_variant_new_int32 (param_def.meta.m_id.none_ok);
+      break;
+
+    case GP_PARAM_DEF_TYPE_ID_ARRAY:
+      meta = plug_in_rc_cache_new_string (param_def.meta.m_id_array.type_name);
+      break;
+
+    case GP_PARAM_DEF_TYPE_RESOURCE:
+      meta = g_variant_new ("(iii)",
+                            param_def.meta.m_resource.none_ok,
+                            param_def.meta.m_resource.default_to_context,
+                            param_def.meta.m_resource.default_resource_id);
+      break;
+
+    case GP_PARAM_DEF_TYPE_FILE:
+      meta = g_variant_new ("(ii@may)",
+                            param_def.meta.m_file.action,
+                            param_def.meta.m_file.none_ok,
+                            plug_in_rc_cache_new_string (param_def.meta.m_file.default_uri));
+      break;
+    }
+
+  if (! meta)
+    meta = g_variant_new ("()");
+
+  return g_variant_new ("(u@may@may@may@may@mayuv)",
+                        param_def.param_def_type,
+                        plug_in_rc_cache_new_string (param_def.type_name),
+                        plug_in_rc_cache_new_string (param_def.value_type_name),
+                        plug_in_rc_cache_new_string (g_param_spec_get_name (pspec)),
+                        plug_in_rc_cache_new_string (g_param_spec_get_nick (pspec)),
+                        plug_in_rc_cache_new_string (g_param_spec_get_blurb (pspec)),
+                        pspec->flags,
+                        meta);
+}
+
+
+/*  strings are stored as byte strings, pluginrc doesn't require them to
+ *  be valid UTF-8 either
+ */
+
+static GVariant *
+plug_in_rc_cache_new_string (const gchar *str)
+{
+  return g_variant_new_maybe (G_VARIANT_TYPE_BYTESTRING,
+                              str ? g_variant_new_bytestring (str) : NULL);
+}
+
+static gchar *
+plug_in_rc_cache_dup_string (GVariant *maybe)
+{
+  GVariant *value = g_variant_get_maybe (maybe);
+  gchar    *str   = NULL;
+
+  if (value)
+    {
+      str = g_variant_dup_bytestring (value, NULL);
+      g_variant_unref (value);
+    }
+
+  return str;
+}
+
+static gchar *
+plug_in_rc_cache_get_string (GVariant *tuple,
+                             gsize     index)
+{
+  GVariant *maybe = g_variant_get_child_value (tuple, index);
+  gchar    *str   = plug_in_rc_cache_dup_string (maybe);
+
+  g_variant_unref (maybe);
+
+  return str;
+}
+
+static void
+plug_in_rc_cache_add_string (GVariantBuilder *builder,
+                             const gchar     *key,
+                             const gchar     *str)
+{
+  if (str)
+    g_variant_builder_add (builder, "{sv}",
+                           key, g_variant_new_bytestring (str));
+}
+
+static gchar *
+plug_in_rc_cache_lookup_string (GVariant    *dict,
+                                const gchar *key)
+{
+  GVariant *value;
+  gchar    *str;
+
+  value = g_variant_lookup_value (dict, key, G_VARIANT_TYPE_BYTESTRING);
+  if (! value)
+    return NULL;
+
+  str = g_variant_dup_bytestring (value, NULL);
+  g_variant_unref (value);
+
+  return str;
+}
+
+static GVariant *
+plug_in_rc_cache_new_data (const guint8 *data,
+                           gsize         size)
+{
+  return g_variant_new_fixed_array (G_VARIANT_TYPE_BYTE,
+                                    size ? data : NULL, size, 1);
+}
@@ -0,0 +1,1109 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimp-bench.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Micro-benchmarks of the core's pixel kernels.
+ *
+ * Each benchmark is run once to warm up, then --runs times, and
+ * reported on a line of tab-separated fields:
+ *
+ *   name  runs  mean-ms  min-ms  mpixels-per-s
+ *
+ * where the throughput is computed from the fastest run.  Lines
+ * starting with '#' are comments.  The benchmarks to run can be
+ * selected by giving prefixes of their names, e.g. "layer-modes/".
+ *
+ * With --corpus, the XCF files of a directory, such as the one written
+ * by tools/performance-corpus.py, are benchmarked too.  The output of
+ * two builds can be compared with tools/performance-log-compare.py.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+
+#include <gegl.h>
+#include <gtk/gtk.h>
+
+#include "libgimpbase/gimpbase.h"
+#include "libgimpmath/gimpmath.h"
+
+#include "paint/paint-types.h"
+
+#include "operations/layer-modes/gimp-layer-modes.h"
+
+#include "gegl/gimp-gegl-loops.h"
+#include "gegl/gimp-gegl-nodes.h"
+#include "gegl/gimp-gegl-utils.h"
+
+#include "core/gimp.h"
+#include "core/gimpboundary.h"
+#include "core/gimpbrush.h"
+#include "core/gimpbrushgenerated.h"
+#include "core/gimpdrawable.h"
+#include "core/gimpimage.h"
+#include "core/gimplayer.h"
+#include "core/gimplayer-new.h"
+#include "core/gimppickable.h"
+#include "core/gimppickable-contiguous-region.h"
+#include "core/gimpprojectable.h"
+#include "core/gimptempbuf.h"
+
+#include "paint/gimppaintcore-loops.h"
+
+#include "xcf/xcf.h"
+
+#include "tests.h"
+
+#include "gimp-app-test-utils.h"
+
+
+#define GIMP_BENCH_BUFFER_SIZE 512
+#define GIMP_BENCH_MODE_SIZE   256
+#define GIMP_BENCH_IMAGE_SIZE  1024
+#define GIMP_BENCH_N_LAYERS    8
+#define GIMP_BENCH_BRUSH_SIZE  200
+
+
+typedef void (* GimpBenchFunc) (gint     run,
+                                gpointer data);
+
+typedef struct
+{
+  Gimp       *gimp;
+  GeglBuffer *src;
+  GeglBuffer *dest;
+  GeglBuffer *mask;
+} GimpBenchData;
+
+
+static gint     n_runs   = 10;
+static gboolean list     = FALSE;
+static gchar  **prefixes = NULL;
+static gchar   *corpus   = NULL;
+
+static const GOptionEntry entries[] =
+{
+  { "runs", 'r', 0,
+    G_OPTION_ARG_INT, &n_runs,
+    "Number of timed runs of each benchmark", "N" },
+  { "list", 'l', 0,
+    G_OPTION_ARG_NONE, &list,
+    "List the benchmarks instead of running them", NULL },
+  { "corpus", 'c', 0,
+    G_OPTION_ARG_FILENAME, &corpus,
+    "Also benchmark loading, saving and rendering the XCF files in DIR",
+    "DIR" },
+  { G_OPTION_REMAINING, 0, 0,
+    G_OPTION_ARG_STRING_ARRAY, &prefixes,
+    NULL, NULL },
+  { NULL }
+};
+
+
+/*  utilities  */
+
+static gboolean
+gimp_bench_selected (const gchar *name)
+{
+  gint i;
+
+  if (! prefixes)
+    return TRUE;
+
+  for (i = 0; prefixes[i]; i++)
+    {
+      if (g_str_has_prefix (name, prefixes[i]))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/*  runs 'func' once to warm up, then 'n_runs' times, and prints its
+ *  timings, 'n_pixels' being the number of pixels a run processes
+ */
+static void
+gimp_bench_run (const gchar   *name,
+                gint64         n_pixels,
+                GimpBenchFunc  func,
+                gpointer       data)
+{
+  gint64 total = 0;
+  gint64 min   = G_MAXINT64;
+  gint   run;
+
+  if (! gimp_bench_selected (name))
+    return;
+
+  if (list)
+    {
+      g_print ("%s\n", name);
+      return;
+    }
+
+  func (0, data);
+
+  for (run = 1; run <= n_runs; run++)
+    {
+      gint64 start = g_get_monotonic_time ();
+      gint64 time;
+
+      func (run, data);
+
+      time   = g_get_monotonic_time () - start;
+      total += time;
+      min    = MIN (min, time);
+    }
+
+  g_print ("%s\t%d\t%.3f\t%.3f\t%.2f\n",
+           name, n_runs,
+           total / 1000.0 / n_runs,
+           min / 1000.0,
+           (gdouble) n_pixels / MAX (min, 1));
+}
+
+static GeglBuffer *
+gimp_bench_noise_buffer_new (gint        width,
+                             gint        height,
+                             const Babl *format,
+                             guint32     seed)
+{
+  const GeglRectangle  rect   = { 0, 0, width, height };
+  GeglBuffer          *buffer = gegl_buffer_new (&rect, format);
+  GRand               *rand   = g_rand_new_with_seed (seed);
+  gfloat              *pixels = g_new (gfloat, width * height * 4);
+  gint                 i;
+
+  for (i = 0; i < width * height * 4; i++)
+    pixels[i] = g_rand_double (rand);
+
+  gegl_buffer_set (buffer, &rect, 0, babl_format ("RGBA float"),
+                   pixels, GEGL_AUTO_ROWSTRIDE);
+
+  g_free (pixels);
+  g_rand_free (rand);
+
+  return buffer;
+}
+
+/*  smooth blobs, so that region-based algorithms have regions to find  */
+static GeglBuffer *
+gimp_bench_blobs_buffer_new (gint        width,
+                             gint        height,
+                             const Babl *format)
+{
+  const GeglRectangle  rect   = { 0, 0, width, height };
+  GeglBuffer          *buffer = gegl_buffer_new (&rect, format);
+  gfloat              *pixels = g_new (gfloat, width * height * 4);
+  gint                 x, y;
+
+  for (y = 0; y < height; y++)
+    for (x = 0; x < width; x++)
+      {
+        gfloat *p = pixels + (y * width + x) * 4;
+        gfloat  v = 0.5 + 0.5 * sin (x / 23.0) * cos (y / 17.0);
+
+        p[0] = v;
+        p[1] = 1.0 - v;
+        p[2] = 0.5 * v;
+        p[3] = 1.0;
+      }
+
+  gegl_buffer_set (buffer, &rect, 0, babl_format ("RGBA float"),
+                   pixels, GEGL_AUTO_ROWSTRIDE);
+
+  g_free (pixels);
+
+  return buffer;
+}
+
+static GimpImage *
+gimp_bench_image_new (Gimp *gimp)
+{
+  GimpImage *image;
+  gint       i;
+
+  image = gimp_image_new (gimp,
+                          GIMP_BENCH_IMAGE_SIZE, GIMP_BENCH_IMAGE_SIZE,
+                          GIMP_RGB, GIMP_PRECISION_U8_NON_LINEAR);
+
+  for (i = 0; i < GIMP_BENCH_N_LAYERS; i++)
+    {
+      static const GimpLayerMode modes[] =
+      {
+        GIMP_LAYER_MODE_NORMAL,
+        GIMP_LAYER_MODE_MULTIPLY,
+        GIMP_LAYER_MODE_SCREEN,
+        GIMP_LAYER_MODE_OVERLAY
+      };
+      GimpLayer  *layer;
+      GeglBuffer *buffer;
+
+      layer = gimp_layer_new (image,
+                              GIMP_BENCH_IMAGE_SIZE, GIMP_BENCH_IMAGE_SIZE,
+                              gimp_image_get_layer_format (image, TRUE),
+                              "Benchmark", 0.75,
+                              modes[i % G_N_ELEMENTS (modes)]);
+
+      if (i % 2)
+        buffer = gimp_bench_blobs_buffer_new (GIMP_BENCH_IMAGE_SIZE,
+                                              GIMP_BENCH_IMAGE_SIZE,
+                                              gimp_image_get_layer_format (image,
+                                                                           TRUE));
+      else
+        buffer = gimp_bench_noise_buffer_new (GIMP_BENCH_IMAGE_SIZE,
+                                              GIMP_BENCH_IMAGE_SIZE,
+                                              gimp_image_get_layer_format (image,
+                                                                           TRUE),
+                                              i);
+
+      gimp_gegl_buffer_copy (buffer, NULL, GEGL_ABYSS_NONE,
+                             gimp_drawable_get_buffer (GIMP_DRAWABLE (layer)),
+                             NULL);
+      g_object_unref (buffer);
+
+      gimp_image_add_layer (image, layer, NULL, 0, FALSE);
+    }
+
+  return image;
+}
+
+
+/*  layer modes  */
+
+typedef struct
+{
+  GeglNode   *mode;
+  GeglBuffer *dest;
+} ModeData;
+
+static void
+bench_layer_mode (gint      run,
+                  ModeData *data)
+{
+  gegl_node_blit_buffer (data->mode, data->dest, NULL, 0, GEGL_ABYSS_NONE);
+}
+
+static void
+bench_layer_modes (GimpBenchData *bench)
+{
+  GEnumClass *mode_class      = g_type_class_ref (GIMP_TYPE_LAYER_MODE);
+  GEnumClass *composite_class = g_type_class_ref (GIMP_TYPE_LAYER_COMPOSITE_MODE);
+  GeglBuffer *backdrop;
+  GeglBuffer *layer;
+  GeglNode   *graph;
+  GeglNode   *backdrop_node;
+  GeglNode   *layer_node;
+  ModeData    data;
+  gint        i;
+
+  backdrop = gimp_bench_noise_buffer_new (GIMP_BENCH_MODE_SIZE,
+                                          GIMP_BENCH_MODE_SIZE,
+                                          babl_format ("RGBA float"), 1);
+  layer    = gimp_bench_noise_buffer_new (GIMP_BENCH_MODE_SIZE,
+                                          GIMP_BENCH_MODE_SIZE,
+                                          babl_format ("RGBA float"), 2);
+  data.dest = gegl_buffer_dup (backdrop);
+
+  graph = gegl_node_new ();
+
+  backdrop_node = gegl_node_new_child (graph,
+                                       "operation", "gegl:buffer-source",
+                                       "buffer",    backdrop,
+                                       NULL);
+  layer_node    = gegl_node_new_child (graph,
+                                       "operation", "gegl:buffer-source",
+                                       "buffer",    layer,
+                                       NULL);
+  data.mode     = gegl_node_new_child (graph,
+                                       "operation",    "gimp:normal",
+                                       "cache-policy", GEGL_CACHE_POLICY_NEVER,
+                                       NULL);
+
+  gegl_node_link (backdrop_node, data.mode);
+  gegl_node_connect (layer_node, "output", data.mode, "aux");
+
+  for (i = 0; i < mode_class->n_values; i++)
+    {
+      GimpLayerMode mode = mode_class->values[i].value;
+      gint          j;
+
+      for (j = 0; j < composite_class->n_values; j++)
+        {
+          GimpLayerCompositeMode  composite = composite_class->values[j].value;
+          gchar                  *name;
+
+          if (composite == GIMP_LAYER_COMPOSITE_AUTO)
+            continue;
+
+          if (! gimp_layer_mode_is_composite_mode_mutable (mode) &&
+              composite != gimp_layer_mode_get_composite_mode (mode))
+            continue;
+
+          gimp_gegl_mode_node_set_mode (data.mode, mode,
+                                        GIMP_LAYER_COLOR_SPACE_AUTO,
+                                        GIMP_LAYER_COLOR_SPACE_AUTO,
+                                        composite);
+
+          name = g_strdup_printf ("layer-modes/%s/%s",
+                                  mode_class->values[i].value_nick,
+                                  composite_class->values[j].value_nick);
+
+          gimp_bench_run (name,
+                          GIMP_BENCH_MODE_SIZE * GIMP_BENCH_MODE_SIZE,
+                          (GimpBenchFunc) bench_layer_mode, &data);
+
+          g_free (name);
+        }
+    }
+
+  g_object_unref (graph);
+  g_object_unref (data.dest);
+  g_object_unref (layer);
+  g_object_unref (backdrop);
+
+  g_type_class_unref (composite_class);
+  g_type_class_unref (mode_class);
+}
+
+
+/*  gimp-gegl-loops.cc  */
+
+static const gfloat blur_kernel[9] =
+{
+  1,  1, 1,
+  1, 32, 1,
+  1,  1, 1
+};
+
+static void
+bench_buffer_copy (gint           run,
+                   GimpBenchData *bench)
+{
+  gimp_gegl_buffer_copy (bench->src, NULL, GEGL_ABYSS_NONE,
+                         bench->dest, NULL);
+}
+
+static void
+bench_clear (gint           run,
+             GimpBenchData *bench)
+{
+  gimp_gegl_clear (bench->dest, NULL);
+}
+
+static void
+bench_convolve (gint           run,
+                GimpBenchData *bench)
+{
+  gimp_gegl_convolve (bench->src, NULL, bench->dest, NULL,
+                      blur_kernel, 3, 40.0, GIMP_NORMAL_CONVOL, TRUE);
+}
+
+static void
+bench_dodgeburn (gint           run,
+                 GimpBenchData *bench)
+{
+  gimp_gegl_dodgeburn (bench->src, NULL, bench->dest, NULL,
+                       0.5, GIMP_DODGE_BURN_TYPE_DODGE, GIMP_TRANSFER_MIDTONES);
+}
+
+static void
+bench_apply_mask (gint           run,
+                  GimpBenchData *bench)
+{
+  gimp_gegl_apply_mask (bench->mask, NULL, bench->dest, NULL, 0.5);
+}
+
+static void
+bench_combine_mask (gint           run,
+                    GimpBenchData *bench)
+{
+  GeglBuffer *dest = gegl_buffer_dup (bench->mask);
+
+  gimp_gegl_combine_mask (bench->mask, NULL, dest, NULL, 0.5);
+
+  g_object_unref (dest);
+}
+
+static void
+bench_average_color (gint           run,
+                     GimpBenchData *bench)
+{
+  gfloat color[4];
+
+  gimp_gegl_average_color (bench->src, NULL, TRUE, GEGL_ABYSS_NONE,
+                           babl_format ("RGBA float"), color);
+}
+
+static void
+bench_smudge_with_paint (gint           run,
+                         GimpBenchData *bench)
+{
+  GeglColor *color = gegl_color_new ("red");
+
+  gimp_gegl_smudge_with_paint (bench->dest, NULL,
+                               bench->src, NULL,
+                               color, NULL, FALSE, 1.0, 0.5);
+
+  g_object_unref (color);
+}
+
+static void
+bench_gegl_loops (GimpBenchData *bench)
+{
+  const gint64 n_pixels = GIMP_BENCH_BUFFER_SIZE * GIMP_BENCH_BUFFER_SIZE;
+
+  gimp_bench_run ("gegl-loops/buffer-copy", n_pixels,
+                  (GimpBenchFunc) bench_buffer_copy, bench);
+  gimp_bench_run ("gegl-loops/clear", n_pixels,
+                  (GimpBenchFunc) bench_clear, bench);
+  gimp_bench_run ("gegl-loops/convolve", n_pixels,
+                  (GimpBenchFunc) bench_convolve, bench);
+  gimp_bench_run ("gegl-loops/dodgeburn", n_pixels,
+                  (GimpBenchFunc) bench_dodgeburn, bench);
+  gimp_bench_run ("gegl-loops/apply-mask", n_pixels,
+                  (GimpBenchFunc) bench_apply_mask, bench);
+  gimp_bench_run ("gegl-loops/combine-mask", n_pixels,
+                  (GimpBenchFunc) bench_combine_mask, bench);
+  gimp_bench_run ("gegl-loops/average-color", n_pixels,
+                  (GimpBenchFunc) bench_average_color, bench);
+  gimp_bench_run ("gegl-loops/smudge-with-paint", n_pixels,
+                  (GimpBenchFunc) bench_smudge_with_paint, bench);
+}
+
+
+/*  gimppaintcore-loops.cc  */
+
+typedef struct
+{
+  GimpPaintCoreLoopsParams    params;
+  GimpPaintCoreLoopsAlgorithm algorithms;
+} PaintData;
+
+static void
+bench_paint_core_loops_process (gint       run,
+                                PaintData *data)
+{
+  gimp_paint_core_loops_process (&data->params, data->algorithms);
+}
+
+static void
+bench_paint_core_loops (GimpBenchData *bench)
+{
+  static const struct
+  {
+    const gchar                 *name;
+    GimpPaintCoreLoopsAlgorithm  algorithms;
+    gboolean                     constant;
+  }
+  paths[] =
+  {
+    { "incremental",
+      GIMP_PAINT_CORE_LOOPS_ALGORITHM_PAINT_MASK_TO_COMP_MASK |
+      GIMP_PAINT_CORE_LOOPS_ALGORITHM_DO_LAYER_BLEND,
+      FALSE },
+    { "constant",
+      GIMP_PAINT_CORE_LOOPS_ALGORITHM_COMBINE_PAINT_MASK_TO_CANVAS_BUFFER |
+      GIMP_PAINT_CORE_LOOPS_ALGORITHM_CANVAS_BUFFER_TO_COMP_MASK          |
+      GIMP_PAINT_CORE_LOOPS_ALGORITHM_DO_LAYER_BLEND,
+      TRUE },
+    { "constant-masked",
+      GIMP_PAINT_CORE_LOOPS_ALGORITHM_COMBINE_PAINT_MASK_TO_CANVAS_BUFFER |
+      GIMP_PAINT_CORE_LOOPS_ALGORITHM_CANVAS_BUFFER_TO_COMP_MASK          |
+      GIMP_PAINT_CORE_LOOPS_ALGORITHM_DO_LAYER_BLEND                      |
+      GIMP_PAINT_CORE_LOOPS_ALGORITHM_MASK_COMPONENTS,
+      TRUE },
+    { "canvas-to-paint-buf-alpha",
+      GIMP_PAINT_CORE_LOOPS_ALGORITHM_CANVAS_BUFFER_TO_PAINT_BUF_ALPHA,
+      TRUE },
+    { "paint-mask-to-paint-buf-alpha",
+      GIMP_PAINT_CORE_LOOPS_ALGORITHM_PAINT_MASK_TO_PAINT_BUF_ALPHA,
+      FALSE }
+  };
+
+  const gint    size = GIMP_BENCH_BUFFER_SIZE;
+  GeglBuffer   *canvas;
+  GeglBuffer   *dest;
+  GimpTempBuf  *paint_buf;
+  GimpTempBuf  *paint_mask;
+  PaintData     data = { { 0, }, };
+  gint          i;
+
+  canvas     = gimp_bench_noise_buffer_new (size, size,
+                                            babl_format ("Y float"), 3);
+  dest       = gegl_buffer_dup (bench->src);
+  paint_buf  = gimp_temp_buf_new (size, size, babl_format ("RGBA float"));
+  paint_mask = gimp_temp_buf_new (size, size, babl_format ("Y float"));
+
+  gimp_temp_buf_data_clear (paint_buf);
+
+  gegl_buffer_get (bench->mask, NULL, 1.0, babl_format ("Y float"),
+                   gimp_temp_buf_get_data (paint_mask),
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  data.params.paint_buf     = paint_buf;
+  data.params.paint_mask    = paint_mask;
+  data.params.dest_buffer   = dest;
+  data.params.paint_opacity = 0.8;
+  data.params.image_opacity = 1.0;
+  data.params.paint_mode    = GIMP_LAYER_MODE_NORMAL;
+  data.params.affect        = GIMP_COMPONENT_MASK_RED |
+                              GIMP_COMPONENT_MASK_GREEN;
+
+  for (i = 0; i < G_N_ELEMENTS (paths); i++)
+    {
+      gchar *name = g_strdup_printf ("paint-core-loops/%s", paths[i].name);
+
+      data.algorithms           = paths[i].algorithms;
+      data.params.canvas_buffer = paths[i].constant ? canvas : NULL;
+      data.params.src_buffer    = paths[i].constant ? bench->src : dest;
+
+      gimp_bench_run (name, (gint64) size * size,
+                      (GimpBenchFunc) bench_paint_core_loops_process, &data);
+
+      g_free (name);
+    }
+
+  gimp_temp_buf_unref (paint_mask);
+  gimp_temp_buf_unref (paint_buf);
+  g_object_unref (dest);
+  g_object_unref (canvas);
+}
+
+
+/*  brush transform  */
+
+typedef struct
+{
+  GimpBrush *brush;
+  gdouble    scale;
+  gdouble    aspect_ratio;
+  gdouble    hardness;
+} BrushData;
+
+static void
+bench_brush_transform_mask (gint       run,
+                            BrushData *data)
+{
+  /*  a different angle each run, so the transform cache always misses  */
+  gimp_brush_transform_mask (data->brush,
+                             data->scale, data->aspect_ratio,
+                             run * 0.001, FALSE, data->hardness);
+}
+
+static void
+bench_brush_transform (GimpBenchData *bench)
+{
+  static const struct
+  {
+    const gchar *name;
+    gdouble      scale;
+    gdouble      aspect_ratio;
+    gdouble      hardness;
+  }
+  transforms[] =
+  {
+    { "rotate",     1.0, 0.0, 1.0 },
+    { "scale-up",   2.0, 0.0, 1.0 },
+    { "scale-down", 0.3, 0.0, 1.0 },
+    { "aspect",     1.0, 5.0, 1.0 },
+    { "soften",     1.0, 0.0, 0.5 }
+  };
+
+  BrushData data;
+  gint      i;
+
+  data.brush = GIMP_BRUSH (gimp_brush_generated_new ("Benchmark",
+                                                     GIMP_BRUSH_GENERATED_CIRCLE,
+                                                     GIMP_BENCH_BRUSH_SIZE / 2,
+                                                     2, 0.8, 1.0, 0.0));
+
+  for (i = 0; i < G_N_ELEMENTS (transforms); i++)
+    {
+      gchar *name = g_strdup_printf ("brush-transform/%s",
+                                     transforms[i].name);
+      gint   width;
+      gint   height;
+
+      data.scale        = transforms[i].scale;
+      data.aspect_ratio = transforms[i].aspect_ratio;
+      data.hardness     = transforms[i].hardness;
+
+      gimp_brush_transform_size (data.brush,
+                                 data.scale, data.aspect_ratio, 0.5, FALSE,
+                                 &width, &height);
+
+      gimp_bench_run (name, (gint64) width * height,
+                      (GimpBenchFunc) bench_brush_transform_mask, &data);
+
+      g_free (name);
+    }
+
+  g_object_unref (data.brush);
+}
+
+
+/*  contiguous region and boundary  */
+
+typedef struct
+{
+  GimpPickable *pickable;
+  GeglBuffer   *mask;
+} RegionData;
+
+static void
+bench_contiguous_region_by_seed (gint        run,
+                                 RegionData *data)
+{
+  GeglBuffer *mask;
+
+  mask = gimp_pickable_contiguous_region_by_seed (data->pickable,
+                                                  TRUE, 0.3, FALSE,
+                                                  GIMP_SELECT_CRITERION_COMPOSITE,
+                                                  FALSE,
+                                                  GIMP_BENCH_IMAGE_SIZE / 2,
+                                                  GIMP_BENCH_IMAGE_SIZE / 2,
+                                                  NULL);
+  g_object_unref (mask);
+}
+
+static void
+bench_contiguous_region_by_seed_diagonal (gint        run,
+                                          RegionData *data)
+{
+  GeglBuffer *mask;
+
+  mask = gimp_pickable_contiguous_region_by_seed (data->pickable,
+                                                  FALSE, 0.3, FALSE,
+                                                  GIMP_SELECT_CRITERION_COMPOSITE,
+                                                  TRUE,
+                                                  GIMP_BENCH_IMAGE_SIZE / 2,
+                                                  GIMP_BENCH_IMAGE_SIZE / 2,
+                                                  NULL);
+  g_object_unref (mask);
+}
+
+static void
+bench_boundary_find (gint        run,
+                     RegionData *data)
+{
+  GimpBoundSeg *segs;
+  gint          n_segs;
+
+  segs = gimp_boundary_find (data->mask, NULL,
+                             babl_format ("Y float"),
+                             GIMP_BOUNDARY_WITHIN_BOUNDS,
+                             0, 0,
+                             gegl_buffer_get_width  (data->mask),
+                             gegl_buffer_get_height (data->mask),
+                             GIMP_BOUNDARY_HALF_WAY,
+                             &n_segs);
+  g_free (segs);
+}
+
+static void
+bench_regions (GimpBenchData *bench)
+{
+  const gint64  n_pixels = GIMP_BENCH_IMAGE_SIZE * GIMP_BENCH_IMAGE_SIZE;
+  GimpImage    *image;
+  GimpLayer    *layer;
+  RegionData    data;
+
+  image = gimp_image_new (bench->gimp,
+                          GIMP_BENCH_IMAGE_SIZE, GIMP_BENCH_IMAGE_SIZE,
+                          GIMP_RGB, GIMP_PRECISION_U8_NON_LINEAR);
+  layer = gimp_layer_new (image,
+                          GIMP_BENCH_IMAGE_SIZE, GIMP_BENCH_IMAGE_SIZE,
+                          gimp_image_get_layer_format (image, TRUE),
+                          "Blobs", 1.0, GIMP_LAYER_MODE_NORMAL);
+  gimp_image_add_layer (image, layer, NULL, 0, FALSE);
+
+  data.mask = gimp_bench_blobs_buffer_new (GIMP_BENCH_IMAGE_SIZE,
+                                           GIMP_BENCH_IMAGE_SIZE,
+                                           gimp_image_get_layer_format (image,
+                                                                        TRUE));
+  gimp_gegl_buffer_copy (data.mask, NULL, GEGL_ABYSS_NONE,
+                         gimp_drawable_get_buffer (GIMP_DRAWABLE (layer)),
+                         NULL);
+  g_object_unref (data.mask);
+
+  data.pickable = GIMP_PICKABLE (layer);
+
+  gimp_bench_run ("contiguous-region/by-seed", n_pixels,
+                  (GimpBenchFunc) bench_contiguous_region_by_seed, &data);
+  gimp_bench_run ("contiguous-region/by-seed-diagonal", n_pixels,
+                  (GimpBenchFunc) bench_contiguous_region_by_seed_diagonal,
+                  &data);
+
+  data.mask = gimp_pickable_contiguous_region_by_seed (data.pickable,
+                                                       TRUE, 0.3, FALSE,
+                                                       GIMP_SELECT_CRITERION_COMPOSITE,
+                                                       FALSE,
+                                                       GIMP_BENCH_IMAGE_SIZE / 2,
+                                                       GIMP_BENCH_IMAGE_SIZE / 2,
+                                                       NULL);
+
+  gimp_bench_run ("boundary/find", n_pixels,
+                  (GimpBenchFunc) bench_boundary_find, &data);
+
+  g_object_unref (data.mask);
+  g_object_unref (image);
+}
+
+
+/*  XCF  */
+
+typedef struct
+{
+  Gimp      *gimp;
+  GimpImage *image;
+  GBytes    *xcf;
+} XcfData;
+
+static void
+bench_xcf_save (gint     run,
+                XcfData *data)
+{
+  GOutputStream *output = g_memory_output_stream_new_resizable ();
+  GError        *error  = NULL;
+
+  if (! xcf_save_stream (data->gimp, data->image, output, NULL, NULL,
+                         &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_clear_error (&error);
+    }
+
+  g_clear_pointer (&data->xcf, g_bytes_unref);
+  data->xcf =
+    g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (output));
+
+  g_object_unref (output);
+}
+
+static void
+bench_xcf_load (gint     run,
+                XcfData *data)
+{
+  GInputStream *input = g_memory_input_stream_new_from_bytes (data->xcf);
+  GimpImage    *image;
+  GError       *error = NULL;
+
+  image = xcf_load_stream (data->gimp, input, NULL, NULL, &error);
+
+  if (image)
+    {
+      g_object_unref (image);
+    }
+  else
+    {
+      g_printerr ("%s\n", error->message);
+      g_clear_error (&error);
+    }
+
+  g_object_unref (input);
+}
+
+static void
+bench_xcf (GimpBenchData *bench)
+{
+  const gint64 n_pixels = ((gint64) GIMP_BENCH_IMAGE_SIZE *
+                           GIMP_BENCH_IMAGE_SIZE * GIMP_BENCH_N_LAYERS);
+  XcfData      data;
+
+  data.gimp  = bench->gimp;
+  data.image = gimp_bench_image_new (bench->gimp);
+  data.xcf   = NULL;
+
+  gimp_bench_run ("xcf/save", n_pixels,
+                  (GimpBenchFunc) bench_xcf_save, &data);
+
+  /*  the file to load, unless saving was benchmarked already  */
+  if (! data.xcf && ! list && gimp_bench_selected ("xcf/load"))
+    bench_xcf_save (0, &data);
+
+  gimp_bench_run ("xcf/load", n_pixels,
+                  (GimpBenchFunc) bench_xcf_load, &data);
+
+  g_clear_pointer (&data.xcf, g_bytes_unref);
+  g_object_unref (data.image);
+}
+
+
+/*  projection  */
+
+typedef struct
+{
+  GeglNode   *graph;
+  GeglBuffer *dest;
+} ProjectionData;
+
+static void
+bench_projection_render (gint            run,
+                         ProjectionData *data)
+{
+  gegl_node_blit_buffer (data->graph, data->dest, NULL, 0, GEGL_ABYSS_NONE);
+}
+
+static void
+bench_projection (GimpBenchData *bench)
+{
+  GimpImage      *image = gimp_bench_image_new (bench->gimp);
+  ProjectionData  data;
+
+  data.graph = gimp_projectable_get_graph (GIMP_PROJECTABLE (image));
+  data.dest  = gegl_buffer_new (GEGL_RECTANGLE (0, 0,
+                                                GIMP_BENCH_IMAGE_SIZE,
+                                                GIMP_BENCH_IMAGE_SIZE),
+                                gimp_projectable_get_format (GIMP_PROJECTABLE (image)));
+
+  gimp_bench_run ("projection/render",
+                  GIMP_BENCH_IMAGE_SIZE * GIMP_BENCH_IMAGE_SIZE,
+                  (GimpBenchFunc) bench_projection_render, &data);
+
+  g_object_unref (data.dest);
+  g_object_unref (image);
+}
+
+
+/*  corpus  */
+
+static void
+bench_corpus_file (GimpBenchData *bench,
+                   GFile         *file)
+{
+  gchar          *basename = g_file_get_basename (file);
+  gchar          *load     = g_strdup_printf ("corpus/%s/load", basename);
+  gchar          *save     = g_strdup_printf ("corpus/%s/save", basename);
+  gchar          *render   = g_strdup_printf ("corpus/%s/projection",
+                                              basename);
+  XcfData         data;
+  ProjectionData  projection;
+  GInputStream   *input;
+  GimpImage      *image;
+  gint64          n_pixels;
+  GError         *error    = NULL;
+
+  if (list)
+    {
+      gimp_bench_run (load,   0, NULL, NULL);
+      gimp_bench_run (save,   0, NULL, NULL);
+      gimp_bench_run (render, 0, NULL, NULL);
+      goto out;
+    }
+
+  if (! gimp_bench_selected (load) &&
+      ! gimp_bench_selected (save) &&
+      ! gimp_bench_selected (render))
+    {
+      goto out;
+    }
+
+  data.gimp = bench->gimp;
+  data.xcf  = g_file_load_bytes (file, NULL, NULL, &error);
+
+  if (! data.xcf)
+    {
+      g_printerr ("%s\n", error->message);
+      g_clear_error (&error);
+      goto out;
+    }
+
+  input = g_memory_input_stream_new_from_bytes (data.xcf);
+  image = xcf_load_stream (bench->gimp, input, file, NULL, &error);
+  g_object_unref (input);
+
+  if (! image)
+    {
+      g_printerr ("%s: %s\n", basename, error->message);
+      g_clear_error (&error);
+      g_bytes_unref (data.xcf);
+      goto out;
+    }
+
+  data.image = image;
+  n_pixels   = ((gint64) gimp_image_get_width  (image) *
+                         gimp_image_get_height (image));
+
+  gimp_bench_run (load, n_pixels,
+                  (GimpBenchFunc) bench_xcf_load, &data);
+  gimp_bench_run (save, n_pixels,
+                  (GimpBenchFunc) bench_xcf_save, &data);
+
+  projection.graph = gimp_projectable_get_graph (GIMP_PROJECTABLE (image));
+  projection.dest  = gegl_buffer_new (GEGL_RECTANGLE (0, 0,
+                                                      gimp_image_get_width  (image),
+                                                      gimp_image_get_height (image)),
+                                      gimp_projectable_get_format (GIMP_PROJECTABLE (image)));
+
+  gimp_bench_run (render, n_pixels,
+                  (GimpBenchFunc) bench_projection_render, &projection);
+
+  g_object_unref (projection.dest);
+  g_bytes_unref (data.xcf);
+  g_object_unref (image);
+
+ out:
+  g_free (render);
+  g_free (save);
+  g_free (load);
+  g_free (basename);
+}
+
+static gint
+bench_corpus_compare (GFile *file1,
+                      GFile *file2)
+{
+  gchar *path1 = g_file_get_path (file1);
+  gchar *path2 = g_file_get_path (file2);
+  gint   result;
+
+  result = g_strcmp0 (path1, path2);
+
+  g_free (path1);
+  g_free (path2);
+
+  return result;
+}
+
+/*  only XCF files can be loaded here, other formats need their plug-in,
+ *  and are left to performance logs recorded in a GIMP session
+ */
+static void
+bench_corpus (GimpBenchData *bench)
+{
+  GFile           *dir;
+  GFileEnumerator *enumerator;
+  GFileInfo       *info;
+  GList           *files = NULL;
+  GList           *iter;
+  GError          *error = NULL;
+
+  if (! corpus)
+    return;
+
+  dir        = g_file_new_for_commandline_arg (corpus);
+  enumerator = g_file_enumerate_children (dir,
+                                          G_FILE_ATTRIBUTE_STANDARD_NAME,
+                                          G_FILE_QUERY_INFO_NONE,
+                                          NULL, &error);
+
+  if (! enumerator)
+    {
+      g_printerr ("%s\n", error->message);
+      g_clear_error (&error);
+      g_object_unref (dir);
+
+      return;
+    }
+
+  while ((info = g_file_enumerator_next_file (enumerator, NULL, NULL)))
+    {
+      const gchar *filename = g_file_info_get_name (info);
+
+      if (g_str_has_suffix (filename, ".xcf"))
+        files = g_list_prepend (files, g_file_get_child (dir, filename));
+
+      g_object_unref (info);
+    }
+
+  files = g_list_sort (files, (GCompareFunc) bench_corpus_compare);
+
+  for (iter = files; iter; iter = g_list_next (iter))
+    bench_corpus_file (bench, iter->data);
+
+  g_list_free_full (files, g_object_unref);
+  g_object_unref (enumerator);
+  g_object_unref (dir);
+}
+
+
+int
+main (int    argc,
+      char **argv)
+{
+  GOptionContext *context;
+  GError         *error = NULL;
+  GimpBenchData   bench;
+  gint            n_threads;
+
+  context = g_option_context_new ("[PREFIX...]");
+  g_option_context_set_summary (context,
+                                "Runs micro-benchmarks of GIMP's core "
+                                "kernels, whose names start with one of "
+                                "the PREFIXes if given.");
+  g_option_context_add_main_entries (context, entries, NULL);
+
+  if (! g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_clear_error (&error);
+      g_option_context_free (context);
+
+      return EXIT_FAILURE;
+    }
+
+  g_option_context_free (context);
+
+  n_runs = MAX (n_runs, 1);
+
+  gimp_test_utils_set_gimp3_directory ("GIMP_TESTING_ABS_TOP_SRCDIR",
+                                       "app/tests/gimpdir");
+
+  bench.gimp = gimp_init_for_testing ();
+
+  bench.src  = gimp_bench_noise_buffer_new (GIMP_BENCH_BUFFER_SIZE,
+                                            GIMP_BENCH_BUFFER_SIZE,
+                                            babl_format ("RGBA float"), 0);
+  bench.dest = gegl_buffer_dup (bench.src);
+  bench.mask = gimp_bench_noise_buffer_new (GIMP_BENCH_BUFFER_SIZE,
+                                            GIMP_BENCH_BUFFER_SIZE,
+                                            babl_format ("Y float"), 4);
+
+  g_object_get (gegl_config (),
+                "threads", &n_threads,
+                NULL);
+
+  if (! list)
+    g_print ("# gimp-bench %s, %d threads\n"
+             "# name\truns\tmean-ms\tmin-ms\tmpixels-per-s\n",
+             GIMP_VERSION, n_threads);
+
+  bench_layer_modes       (&bench);
+  bench_gegl_loops        (&bench);
+  bench_paint_core_loops  (&bench);
+  bench_brush_transform   (&bench);
+  bench_regions           (&bench);
+  bench_xcf               (&bench);
+  bench_projection        (&bench);
+  bench_corpus            (&bench);
+
+  g_object_unref (bench.mask);
+  g_object_unref (bench.dest);
+  g_object_unref (bench.src);
+
+  gimp_test_utils_set_gimp3_directory ("GIMP_TESTING_ABS_TOP_BUILDDIR",
+                                       "app/tests/gimpdir-output");
+
+  gimp_exit (bench.gimp, TRUE);
+
+  g_strfreev (prefixes);
+
+  return EXIT_SUCCESS;
+}
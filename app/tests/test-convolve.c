@@ -0,0 +1,370 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <gegl.h>
+#include <gtk/gtk.h>
+
+#include "libgimpmath/gimpmath.h"
+
+#include "core/core-types.h"
+
+#include "gegl/gimp-gegl-loops.h"
+
+#include "core/gimp.h"
+
+#include "tests.h"
+
+#include "gimp-app-test-utils.h"
+
+
+#define GIMP_TEST_BUFFER_SIZE 512
+
+/* the number of times each function is run, when measuring performance */
+#define GIMP_TEST_N_RUNS      20
+
+#define ADD_TEST(function) \
+  g_test_add ("/gimp-convolve/" #function, \
+              GimpTestFixture, \
+              NULL, \
+              gimp_test_convolve_setup, \
+              function, \
+              gimp_test_convolve_teardown);
+
+
+typedef struct
+{
+  GeglBuffer *src;
+  GeglBuffer *dest;
+} GimpTestFixture;
+
+
+/* the blur matrix of GimpConvolve, at 50% rate */
+static const gfloat blur[9] =
+{
+  1,  1,  1,
+  1, 32,  1,
+  1,  1,  1
+};
+
+/* the sharpen matrix of GimpConvolve, at 50% rate */
+static const gfloat sharpen[9] =
+{
+  1,    1, 1,
+  1, -288, 1,
+  1,    1, 1
+};
+
+static const gfloat horz_deriv[9] =
+{
+  1,  0, -1,
+  2,  0, -2,
+  1,  0, -1
+};
+
+/* not separable, runs the generic loop */
+static const gfloat laplace[9] =
+{
+  0,  1,  0,
+  1, -4,  1,
+  0,  1,  0
+};
+
+
+static void
+gimp_test_convolve_setup (GimpTestFixture *fixture,
+                          gconstpointer    data)
+{
+  const GeglRectangle rect = { 0, 0,
+                               GIMP_TEST_BUFFER_SIZE, GIMP_TEST_BUFFER_SIZE };
+  GRand              *rand = g_rand_new_with_seed (0);
+  gfloat             *pixels;
+  gint                i;
+
+  fixture->src  = gegl_buffer_new (&rect, babl_format ("RGBA float"));
+  fixture->dest = gegl_buffer_new (&rect, babl_format ("RGBA float"));
+
+  pixels = g_new (gfloat, rect.width * rect.height * 4);
+
+  for (i = 0; i < rect.width * rect.height * 4; i++)
+    pixels[i] = g_rand_double (rand);
+
+  /* make some pixels fully transparent */
+  for (i = 0; i < rect.width * rect.height; i += 7)
+    pixels[i * 4 + 3] = 0.0;
+
+  gegl_buffer_set (fixture->src, &rect, 0, babl_format ("RGBA float"),
+                   pixels, GEGL_AUTO_ROWSTRIDE);
+
+  g_free (pixels);
+  g_rand_free (rand);
+}
+
+static void
+gimp_test_convolve_teardown (GimpTestFixture *fixture,
+                             gconstpointer    data)
+{
+  g_clear_object (&fixture->src);
+  g_clear_object (&fixture->dest);
+}
+
+/**
+ * gimp_test_convolve_reference:
+ *
+ * A straightforward implementation of what gimp_gegl_convolve() is
+ * supposed to compute, for a 3x3 kernel.
+ **/
+static gfloat *
+gimp_test_convolve_reference (GeglBuffer          *src_buffer,
+                              const gfloat        *kernel,
+                              gdouble              divisor,
+                              GimpConvolutionType  mode,
+                              gboolean             alpha_weighting)
+{
+  const gint  size   = GIMP_TEST_BUFFER_SIZE;
+  gfloat     *src    = g_new (gfloat, size * size * 4);
+  gfloat     *dest   = g_new (gfloat, size * size * 4);
+  gdouble     offset = 0.0;
+  gint        x, y;
+
+  gegl_buffer_get (src_buffer, NULL, 1.0, babl_format ("RGBA float"), src,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  if (mode == GIMP_NEGATIVE_CONVOL)
+    offset = 0.5;
+
+  for (y = 0; y < size; y++)
+    for (x = 0; x < size; x++)
+      {
+        gdouble total[4]         = { 0.0, 0.0, 0.0, 0.0 };
+        gdouble weighted_divisor = 0.0;
+        gint    i, j, b;
+
+        for (j = 0; j < 3; j++)
+          for (i = 0; i < 3; i++)
+            {
+              gint          xx = CLAMP (x + i - 1, 0, size - 1);
+              gint          yy = CLAMP (y + j - 1, 0, size - 1);
+              const gfloat *s  = src + (yy * size + xx) * 4;
+              gdouble       m  = kernel[j * 3 + i];
+
+              if (alpha_weighting)
+                {
+                  weighted_divisor += m * s[3];
+
+                  for (b = 0; b < 3; b++)
+                    total[b] += m * s[3] * s[b];
+
+                  total[3] += m * s[3];
+                }
+              else
+                {
+                  for (b = 0; b < 4; b++)
+                    total[b] += m * s[b];
+                }
+            }
+
+        for (b = 0; b < 4; b++)
+          {
+            if (alpha_weighting && b < 3)
+              total[b] /= (weighted_divisor != 0.0 ? weighted_divisor :
+                                                     divisor);
+            else
+              total[b] /= divisor;
+
+            total[b] += offset;
+
+            if (mode == GIMP_ABSOLUTE_CONVOL && total[b] < 0.0)
+              total[b] = - total[b];
+
+            dest[(y * size + x) * 4 + b] = CLAMP (total[b], 0.0, 1.0);
+          }
+      }
+
+  g_free (src);
+
+  return dest;
+}
+
+static void
+gimp_test_convolve_run (GimpTestFixture     *fixture,
+                        const gchar         *name,
+                        const gfloat        *kernel,
+                        gdouble              divisor,
+                        GimpConvolutionType  mode,
+                        gboolean             alpha_weighting)
+{
+  const gint  size = GIMP_TEST_BUFFER_SIZE;
+  gfloat     *expected;
+  gfloat     *result;
+  gdouble     max_diff = 0.0;
+  gint        n_runs   = g_test_perf () ? GIMP_TEST_N_RUNS : 1;
+  gint        i;
+
+  g_test_timer_start ();
+
+  for (i = 0; i < n_runs; i++)
+    {
+      gimp_gegl_convolve (fixture->src, NULL, fixture->dest, NULL,
+                          kernel, 3, divisor, mode, alpha_weighting);
+    }
+
+  if (g_test_perf ())
+    {
+      g_test_minimized_result (g_test_timer_elapsed () / n_runs,
+                               "%s: %g ms per %dx%d buffer",
+                               name, 1000.0 * g_test_timer_elapsed () / n_runs,
+                               size, size);
+    }
+
+  expected = gimp_test_convolve_reference (fixture->src, kernel, divisor,
+                                           mode, alpha_weighting);
+
+  result = g_new (gfloat, size * size * 4);
+
+  gegl_buffer_get (fixture->dest, NULL, 1.0, babl_format ("RGBA float"),
+                   result, GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  for (i = 0; i < size * size * 4; i++)
+    max_diff = MAX (max_diff, fabs (result[i] - expected[i]));
+
+  g_assert_cmpfloat (max_diff, <, 1e-5);
+
+  g_free (expected);
+  g_free (result);
+}
+
+/**
+ * blur_matrix:
+ *
+ * Test the separable path of gimp_gegl_convolve(), as used by the blur
+ * tool.
+ **/
+static void
+blur_matrix (GimpTestFixture *fixture,
+             gconstpointer    data)
+{
+  gimp_test_convolve_run (fixture, "blur", blur, 40.0,
+                          GIMP_NORMAL_CONVOL, TRUE);
+}
+
+/**
+ * sharpen_matrix:
+ *
+ * Test the separable path of gimp_gegl_convolve(), as used by the
+ * sharpen tool.
+ **/
+static void
+sharpen_matrix (GimpTestFixture *fixture,
+                gconstpointer    data)
+{
+  gimp_test_convolve_run (fixture, "sharpen", sharpen, -280.0,
+                          GIMP_NORMAL_CONVOL, TRUE);
+}
+
+/**
+ * derivative_matrix:
+ *
+ * Test the separable path of gimp_gegl_convolve(), as used by the
+ * intelligent scissors.
+ **/
+static void
+derivative_matrix (GimpTestFixture *fixture,
+                   gconstpointer    data)
+{
+  gimp_test_convolve_run (fixture, "derivative", horz_deriv, 1.0,
+                          GIMP_NEGATIVE_CONVOL, FALSE);
+}
+
+/**
+ * laplace_matrix:
+ *
+ * Test the generic path of gimp_gegl_convolve(), for comparison.
+ **/
+static void
+laplace_matrix (GimpTestFixture *fixture,
+                gconstpointer    data)
+{
+  gimp_test_convolve_run (fixture, "laplace", laplace, 1.0,
+                          GIMP_ABSOLUTE_CONVOL, FALSE);
+}
+
+/**
+ * smudge:
+ *
+ * Measure gimp_gegl_smudge_with_paint(), as used by the smudge tool.
+ **/
+static void
+smudge (GimpTestFixture *fixture,
+        gconstpointer    data)
+{
+  const gint  size   = GIMP_TEST_BUFFER_SIZE;
+  GeglBuffer *accum  = gegl_buffer_dup (fixture->src);
+  GeglColor  *color  = gegl_color_new ("red");
+  gint        n_runs = g_test_perf () ? GIMP_TEST_N_RUNS : 1;
+  gint        i;
+
+  g_test_timer_start ();
+
+  for (i = 0; i < n_runs; i++)
+    {
+      gimp_gegl_smudge_with_paint (accum, NULL, fixture->src, NULL,
+                                   color, fixture->dest, FALSE, 0.5, 0.5);
+    }
+
+  if (g_test_perf ())
+    {
+      g_test_minimized_result (g_test_timer_elapsed () / n_runs,
+                               "smudge: %g ms per %dx%d buffer",
+                               1000.0 * g_test_timer_elapsed () / n_runs,
+                               size, size);
+    }
+
+  g_object_unref (color);
+  g_object_unref (accum);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  Gimp *gimp;
+  int   result;
+
+  g_test_init (&argc, &argv, NULL);
+
+  gimp_test_utils_set_gimp3_directory ("GIMP_TESTING_ABS_TOP_SRCDIR",
+                                       "app/tests/gimpdir");
+
+  gimp = gimp_init_for_testing ();
+
+  ADD_TEST (blur_matrix);
+  ADD_TEST (sharpen_matrix);
+  ADD_TEST (derivative_matrix);
+  ADD_TEST (laplace_matrix);
+  ADD_TEST (smudge);
+
+  result = g_test_run ();
+
+  gimp_test_utils_set_gimp3_directory ("GIMP_TESTING_ABS_TOP_BUILDDIR",
+                                       "app/tests/gimpdir-output");
+
+  gimp_exit (gimp, TRUE);
+
+  return result;
+}
@@ -25,6 +25,7 @@
 #include "core/gimp.h"
 #include "core/gimpcontext.h"
 #include "core/gimpimage.h"
+#include "core/gimpimage-merge.h"
 #include "core/gimplayer.h"
 #include "core/gimplayer-new.h"
 
@@ -225,6 +226,75 @@ remove_layer (GimpTestFixture *fixture,
   g_assert_cmpint (gimp_image_get_n_layers (image), ==, 0);
 }
 
+/**
+ * flatten_to_image:
+ * @fixture:
+ * @data:
+ *
+ * Makes sure gimp_image_flatten_to_image() composites the visible
+ * layers into a new single layer image, and leaves the image alone.
+ **/
+static void
+flatten_to_image (GimpTestFixture *fixture,
+                  gconstpointer    data)
+{
+  Gimp        *gimp    = GIMP (data);
+  GimpImage   *image   = fixture->image;
+  GimpContext *context = gimp_context_new (gimp, "Test", NULL /*template*/);
+  GimpImage   *new_image;
+  GimpLayer   *layer;
+  GeglColor   *color;
+  gfloat       pixel[4];
+  gint         i;
+
+  for (i = 0; i < 2; i++)
+    {
+      layer = gimp_layer_new (image,
+                              GIMP_TEST_IMAGE_SIZE,
+                              GIMP_TEST_IMAGE_SIZE,
+                              gimp_image_get_layer_format (image, TRUE),
+                              "Test Layer",
+                              GIMP_OPACITY_OPAQUE,
+                              GIMP_LAYER_MODE_NORMAL);
+
+      gimp_image_add_layer (image,
+                            layer,
+                            GIMP_IMAGE_ACTIVE_PARENT,
+                            0,
+                            FALSE);
+    }
+
+  /*  an opaque red top layer over an empty one  */
+  color = gegl_color_new ("red");
+  gegl_buffer_set_color (gimp_drawable_get_buffer (GIMP_DRAWABLE (layer)),
+                         NULL, color);
+  g_object_unref (color);
+
+  new_image = gimp_image_flatten_to_image (image, context, NULL, NULL);
+
+  g_assert_nonnull (new_image);
+  g_assert_cmpint (gimp_image_get_n_layers (image), ==, 2);
+  g_assert_cmpint (gimp_image_get_n_layers (new_image), ==, 1);
+  g_assert_cmpint (gimp_image_get_width  (new_image), ==, GIMP_TEST_IMAGE_SIZE);
+  g_assert_cmpint (gimp_image_get_height (new_image), ==, GIMP_TEST_IMAGE_SIZE);
+
+  layer = gimp_image_get_layer_iter (new_image)->data;
+
+  gegl_buffer_get (gimp_drawable_get_buffer (GIMP_DRAWABLE (layer)),
+                   GEGL_RECTANGLE (GIMP_TEST_IMAGE_SIZE / 2,
+                                   GIMP_TEST_IMAGE_SIZE / 2, 1, 1),
+                   1.0, babl_format ("RGBA float"), pixel,
+                   GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+  g_assert_cmpfloat_with_epsilon (pixel[0], 1.0, 1e-4);
+  g_assert_cmpfloat_with_epsilon (pixel[1], 0.0, 1e-4);
+  g_assert_cmpfloat_with_epsilon (pixel[2], 0.0, 1e-4);
+  g_assert_cmpfloat_with_epsilon (pixel[3], 1.0, 1e-4);
+
+  g_object_unref (new_image);
+  g_object_unref (context);
+}
+
 /**
  * white_graypoint_in_red_levels:
  * @fixture:
@@ -282,6 +352,7 @@ main (int    argc,
   ADD_IMAGE_TEST (add_layer);
   ADD_IMAGE_TEST (remove_layer);
   ADD_IMAGE_TEST (rotate_non_overlapping);
+  ADD_IMAGE_TEST (flatten_to_image);
   ADD_TEST (white_graypoint_in_red_levels);
 
   /* Run the tests */
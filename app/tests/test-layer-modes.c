@@ -0,0 +1,505 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <gegl.h>
+#include <gegl-plugin.h>
+#include <gtk/gtk.h>
+
+#include "libgimpbase/gimpbase.h"
+#include "libgimpmath/gimpmath.h"
+
+#include "core/core-types.h"
+
+#include "operations/layer-modes/gimp-layer-modes.h"
+#include "operations/layer-modes/gimpoperationlayermode.h"
+
+#include "gegl/gimp-babl.h"
+#include "gegl/gimp-gegl-nodes.h"
+
+#include "core/gimp.h"
+
+#include "tests.h"
+
+#include "gimp-app-test-utils.h"
+
+
+/* the size of the buffers the paths are compared on */
+#define GIMP_TEST_BUFFER_SIZE 32
+
+/* the size of the buffers, and the number of times each path is run,
+ * when measuring performance
+ */
+#define GIMP_TEST_PERF_SIZE   512
+#define GIMP_TEST_N_RUNS      10
+
+/* the largest difference to the reference path, relative to the
+ * reference value when it's beyond 1.0
+ */
+#define GIMP_TEST_TOLERANCE   1e-4
+
+
+static const GimpPrecision precisions[] =
+{
+  GIMP_PRECISION_U8_NON_LINEAR,
+  GIMP_PRECISION_U16_LINEAR,
+  GIMP_PRECISION_HALF_NON_LINEAR,
+  GIMP_PRECISION_FLOAT_LINEAR
+};
+
+typedef struct
+{
+  GeglBuffer *backdrop;
+  GeglBuffer *layer;
+  GeglBuffer *mask;
+} Inputs;
+
+typedef struct
+{
+  Inputs    inputs[G_N_ELEMENTS (precisions)];
+
+  GeglNode *graph;
+  GeglNode *backdrop_node;
+  GeglNode *layer_node;
+  GeglNode *mask_node;
+  GeglNode *mode_node;
+} GimpTestFixture;
+
+
+static const GimpLayerModePath paths[] =
+{
+  GIMP_LAYER_MODE_PATH_DEFAULT,
+  GIMP_LAYER_MODE_PATH_FUSED
+};
+
+
+static GeglBuffer *
+gimp_test_noise_buffer_new (gint        size,
+                            const Babl *format,
+                            gint        n_components,
+                            guint32     seed)
+{
+  const GeglRectangle  rect   = { 0, 0, size, size };
+  GeglBuffer          *buffer = gegl_buffer_new (&rect, format);
+  GRand               *rand   = g_rand_new_with_seed (seed);
+  gfloat              *pixels = g_new (gfloat, size * size * n_components);
+  gint                 i;
+
+  for (i = 0; i < size * size * n_components; i++)
+    pixels[i] = g_rand_double (rand);
+
+  /* make some pixels fully transparent, and some fully opaque, so that
+   * the unblended and occluded cases are covered
+   */
+  if (n_components == 4)
+    {
+      for (i = 0; i < size * size; i += 7)
+        pixels[i * 4 + 3] = 0.0;
+
+      for (i = 3; i < size * size; i += 5)
+        pixels[i * 4 + 3] = 1.0;
+    }
+
+  gegl_buffer_set (buffer, &rect, 0,
+                   n_components == 4 ? babl_format ("RGBA float") :
+                                       babl_format ("Y float"),
+                   pixels, GEGL_AUTO_ROWSTRIDE);
+
+  g_free (pixels);
+  g_rand_free (rand);
+
+  return buffer;
+}
+
+static void
+gimp_test_inputs_init (Inputs        *inputs,
+                       gint           size,
+                       GimpPrecision  precision)
+{
+  const Babl *format = gimp_babl_format (GIMP_RGB, precision, TRUE, NULL);
+  const Babl *mask   = gimp_babl_mask_format (precision);
+
+  inputs->backdrop = gimp_test_noise_buffer_new (size, format, 4, 1);
+  inputs->layer    = gimp_test_noise_buffer_new (size, format, 4, 2);
+  inputs->mask     = gimp_test_noise_buffer_new (size, mask,   1, 3);
+}
+
+static void
+gimp_test_inputs_clear (Inputs *inputs)
+{
+  g_clear_object (&inputs->backdrop);
+  g_clear_object (&inputs->layer);
+  g_clear_object (&inputs->mask);
+}
+
+static void
+gimp_test_layer_modes_setup (GimpTestFixture *fixture,
+                             gconstpointer    data)
+{
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (precisions); i++)
+    gimp_test_inputs_init (&fixture->inputs[i],
+                           GIMP_TEST_BUFFER_SIZE, precisions[i]);
+
+  fixture->graph = gegl_node_new ();
+
+  fixture->backdrop_node = gegl_node_new_child (fixture->graph,
+                                                "operation", "gegl:buffer-source",
+                                                NULL);
+  fixture->layer_node    = gegl_node_new_child (fixture->graph,
+                                                "operation", "gegl:buffer-source",
+                                                NULL);
+  fixture->mask_node     = gegl_node_new_child (fixture->graph,
+                                                "operation", "gegl:buffer-source",
+                                                NULL);
+  fixture->mode_node     = gegl_node_new_child (fixture->graph,
+                                                "operation",    "gimp:normal",
+                                                "cache-policy", GEGL_CACHE_POLICY_NEVER,
+                                                NULL);
+
+  gegl_node_link (fixture->backdrop_node, fixture->mode_node);
+  gegl_node_connect (fixture->layer_node, "output",
+                     fixture->mode_node,  "aux");
+}
+
+static void
+gimp_test_layer_modes_teardown (GimpTestFixture *fixture,
+                                gconstpointer    data)
+{
+  gint i;
+
+  g_clear_object (&fixture->graph);
+
+  for (i = 0; i < G_N_ELEMENTS (precisions); i++)
+    gimp_test_inputs_clear (&fixture->inputs[i]);
+
+  gimp_operation_layer_mode_set_path (GIMP_LAYER_MODE_PATH_DEFAULT);
+}
+
+static void
+gimp_test_layer_modes_set_inputs (GimpTestFixture *fixture,
+                                  Inputs          *inputs,
+                                  gboolean         masked)
+{
+  gegl_node_set (fixture->backdrop_node, "buffer", inputs->backdrop, NULL);
+  gegl_node_set (fixture->layer_node,    "buffer", inputs->layer,    NULL);
+  gegl_node_set (fixture->mask_node,     "buffer", inputs->mask,     NULL);
+
+  if (masked)
+    gegl_node_connect (fixture->mask_node, "output",
+                       fixture->mode_node, "aux2");
+  else
+    gegl_node_disconnect (fixture->mode_node, "aux2");
+
+  gimp_gegl_mode_node_set_opacity (fixture->mode_node, masked ? 0.6 : 1.0);
+}
+
+/* renders the mode node through 'path', setting the mode anew, so that
+ * the operation is prepared for the path
+ */
+static gfloat *
+gimp_test_layer_modes_render (GimpTestFixture        *fixture,
+                              gint                    size,
+                              GimpLayerModePath       path,
+                              GimpLayerMode           mode,
+                              GimpLayerColorSpace     blend_space,
+                              GimpLayerColorSpace     composite_space,
+                              GimpLayerCompositeMode  composite_mode)
+{
+  gfloat *pixels = g_new (gfloat, size * size * 4);
+
+  gimp_operation_layer_mode_set_path (path);
+
+  gimp_gegl_mode_node_set_mode (fixture->mode_node, mode,
+                                blend_space, composite_space, composite_mode);
+
+  gegl_node_blit (fixture->mode_node, 1.0,
+                  GEGL_RECTANGLE (0, 0, size, size),
+                  babl_format ("RGBA float"), pixels,
+                  GEGL_AUTO_ROWSTRIDE, GEGL_BLIT_DEFAULT);
+
+  return pixels;
+}
+
+static gdouble
+gimp_test_layer_modes_compare (const gfloat *result,
+                               const gfloat *expected,
+                               gint          n_pixels)
+{
+  gdouble max_diff = 0.0;
+  gint    i;
+
+  for (i = 0; i < n_pixels; i++)
+    {
+      const gfloat *r = result   + 4 * i;
+      const gfloat *e = expected + 4 * i;
+      gint          b;
+
+      /* the color of fully transparent pixels is unconstrained */
+      for (b = (e[3] == 0.0f ? 3 : 0); b < 4; b++)
+        {
+          if (! isfinite (e[b]))
+            continue;
+
+          max_diff = MAX (max_diff,
+                          fabs (r[b] - e[b]) / MAX (1.0, fabs (e[b])));
+        }
+    }
+
+  return max_diff;
+}
+
+static void
+gimp_test_layer_modes_check (GimpTestFixture        *fixture,
+                             GimpLayerMode           mode,
+                             GimpLayerColorSpace     blend_space,
+                             GimpLayerColorSpace     composite_space,
+                             GimpLayerCompositeMode  composite_mode)
+{
+  const gint size = GIMP_TEST_BUFFER_SIZE;
+  gint       i;
+
+  for (i = 0; i < G_N_ELEMENTS (precisions); i++)
+    {
+      gint masked;
+
+      for (masked = 0; masked < 2; masked++)
+        {
+          gfloat *expected;
+          gint    j;
+
+          gimp_test_layer_modes_set_inputs (fixture, &fixture->inputs[i],
+                                            masked);
+
+          expected = gimp_test_layer_modes_render (fixture, size,
+                                                   GIMP_LAYER_MODE_PATH_REFERENCE,
+                                                   mode,
+                                                   blend_space,
+                                                   composite_space,
+                                                   composite_mode);
+
+          for (j = 0; j < G_N_ELEMENTS (paths); j++)
+            {
+              gfloat  *result;
+              gdouble  diff;
+
+              result = gimp_test_layer_modes_render (fixture, size, paths[j],
+                                                     mode,
+                                                     blend_space,
+                                                     composite_space,
+                                                     composite_mode);
+
+              diff = gimp_test_layer_modes_compare (result, expected,
+                                                    size * size);
+
+              if (diff >= GIMP_TEST_TOLERANCE)
+                {
+                  g_test_message ("blend space %d, composite space %d, "
+                                  "composite mode %d, precision %d, %s, "
+                                  "path %d: off by %g",
+                                  blend_space, composite_space,
+                                  composite_mode, precisions[i],
+                                  masked ? "masked" : "unmasked",
+                                  paths[j], diff);
+                }
+
+              g_assert_cmpfloat (diff, <, GIMP_TEST_TOLERANCE);
+
+              g_free (result);
+            }
+
+          g_free (expected);
+        }
+    }
+}
+
+/* reports the throughput of each path, at the mode's default spaces and
+ * composite mode, in float
+ */
+static void
+gimp_test_layer_modes_perf (GimpTestFixture *fixture,
+                            GimpLayerMode    mode,
+                            const gchar     *name)
+{
+  static const GimpLayerModePath all_paths[] =
+  {
+    GIMP_LAYER_MODE_PATH_REFERENCE,
+    GIMP_LAYER_MODE_PATH_FUSED,
+    GIMP_LAYER_MODE_PATH_DEFAULT
+  };
+  static const gchar * const path_names[] =
+  {
+    "reference",
+    "fused",
+    "default"
+  };
+
+  const gint size   = GIMP_TEST_PERF_SIZE;
+  Inputs     inputs = { 0, };
+  gint       i;
+
+  gimp_test_inputs_init (&inputs, size, GIMP_PRECISION_FLOAT_LINEAR);
+  gimp_test_layer_modes_set_inputs (fixture, &inputs, FALSE);
+
+  for (i = 0; i < G_N_ELEMENTS (all_paths); i++)
+    {
+      gdouble elapsed = 0.0;
+      gint    j;
+
+      for (j = 0; j < GIMP_TEST_N_RUNS; j++)
+        {
+          gfloat *pixels;
+
+          g_test_timer_start ();
+
+          pixels = gimp_test_layer_modes_render (fixture, size, all_paths[i],
+                                                 mode,
+                                                 GIMP_LAYER_COLOR_SPACE_AUTO,
+                                                 GIMP_LAYER_COLOR_SPACE_AUTO,
+                                                 GIMP_LAYER_COMPOSITE_AUTO);
+
+          elapsed += g_test_timer_elapsed ();
+
+          g_free (pixels);
+        }
+
+      g_test_maximized_result (size * size * GIMP_TEST_N_RUNS / elapsed / 1e6,
+                               "%s, %s: %g Mpixels/s",
+                               name, path_names[i],
+                               size * size * GIMP_TEST_N_RUNS / elapsed / 1e6);
+    }
+
+  gimp_test_inputs_clear (&inputs);
+}
+
+/**
+ * layer_mode:
+ *
+ * Compare the vectorized and fused paths of a layer mode against its
+ * plain, two-pass path, in every blend space, composite space and
+ * composite mode it supports, and at every precision, with and without
+ * a mask.
+ **/
+static void
+layer_mode (GimpTestFixture *fixture,
+            gconstpointer    data)
+{
+  GimpLayerMode  mode            = GPOINTER_TO_INT (data);
+  GEnumClass    *space_class     = g_type_class_ref (GIMP_TYPE_LAYER_COLOR_SPACE);
+  GEnumClass    *composite_class = g_type_class_ref (GIMP_TYPE_LAYER_COMPOSITE_MODE);
+  gint           i;
+
+  for (i = 0; i < space_class->n_values; i++)
+    {
+      GimpLayerColorSpace blend_space = space_class->values[i].value;
+      gint                j;
+
+      if (gimp_layer_mode_is_blend_space_mutable (mode) ?
+          blend_space == GIMP_LAYER_COLOR_SPACE_AUTO :
+          blend_space != GIMP_LAYER_COLOR_SPACE_AUTO)
+        continue;
+
+      for (j = 0; j < space_class->n_values; j++)
+        {
+          GimpLayerColorSpace composite_space = space_class->values[j].value;
+          gint                k;
+
+          if (gimp_layer_mode_is_composite_space_mutable (mode) ?
+              composite_space == GIMP_LAYER_COLOR_SPACE_AUTO :
+              composite_space != GIMP_LAYER_COLOR_SPACE_AUTO)
+            continue;
+
+          for (k = 0; k < composite_class->n_values; k++)
+            {
+              GimpLayerCompositeMode composite_mode = composite_class->values[k].value;
+
+              if (gimp_layer_mode_is_composite_mode_mutable (mode) ?
+                  composite_mode == GIMP_LAYER_COMPOSITE_AUTO :
+                  composite_mode != GIMP_LAYER_COMPOSITE_AUTO)
+                continue;
+
+              gimp_test_layer_modes_check (fixture, mode,
+                                           blend_space,
+                                           composite_space,
+                                           composite_mode);
+            }
+        }
+    }
+
+  if (g_test_perf ())
+    {
+      GEnumClass *layer_class = g_type_class_ref (GIMP_TYPE_LAYER_MODE);
+
+      gimp_test_layer_modes_perf (fixture, mode,
+                                  g_enum_get_value (layer_class,
+                                                    mode)->value_nick);
+
+      g_type_class_unref (layer_class);
+    }
+
+  g_type_class_unref (composite_class);
+  g_type_class_unref (space_class);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  Gimp       *gimp;
+  GEnumClass *mode_class;
+  int         result;
+  gint        i;
+
+  g_test_init (&argc, &argv, NULL);
+
+  gimp_test_utils_set_gimp3_directory ("GIMP_TESTING_ABS_TOP_SRCDIR",
+                                       "app/tests/gimpdir");
+
+  gimp = gimp_init_for_testing ();
+
+  mode_class = g_type_class_ref (GIMP_TYPE_LAYER_MODE);
+
+  for (i = 0; i < mode_class->n_values; i++)
+    {
+      gchar *path;
+
+      path = g_strdup_printf ("/gimp-layer-modes/%s",
+                              mode_class->values[i].value_nick);
+
+      g_test_add (path,
+                  GimpTestFixture,
+                  GINT_TO_POINTER (mode_class->values[i].value),
+                  gimp_test_layer_modes_setup,
+                  layer_mode,
+                  gimp_test_layer_modes_teardown);
+
+      g_free (path);
+    }
+
+  result = g_test_run ();
+
+  g_type_class_unref (mode_class);
+
+  gimp_test_utils_set_gimp3_directory ("GIMP_TESTING_ABS_TOP_BUILDDIR",
+                                       "app/tests/gimpdir-output");
+
+  gimp_exit (gimp, TRUE);
+
+  return result;
+}
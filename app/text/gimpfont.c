@@ -558,6 +558,30 @@ gimp_font_set_font_info (GimpFont *font,
   font->family_style_concat = g_strconcat ((gchar*)font_info[PROP_FAMILY], " ", (gchar*)font_info[PROP_STYLE], NULL);
 }
 
+/* adds what identifies @font across sessions to @checksum, without
+ * reading the font file, unlike gimp_font_get_hash().
+ */
+void
+gimp_font_update_checksum (GimpFont  *font,
+                           GChecksum *checksum)
+{
+  gchar *str;
+
+  g_return_if_fail (GIMP_IS_FONT (font));
+  g_return_if_fail (checksum != NULL);
+
+  str = g_strdup_printf ("%s\n%s\n%s\n%d\n%d\n",
+                         font->fullname ? font->fullname : "",
+                         font->psname   ? font->psname   : "",
+                         font->style    ? font->style    : "",
+                         font->index,
+                         font->fontversion);
+
+  g_checksum_update (checksum, (const guchar *) str, -1);
+
+  g_free (str);
+}
+
 void
 gimp_font_set_lookup_name (GimpFont    *font,
                            gchar       *name)
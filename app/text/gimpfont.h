@@ -46,6 +46,8 @@ gboolean      gimp_font_match_by_description   (GimpFont        *font,
                                                 const gchar     *desc);
 void          gimp_font_set_font_info          (GimpFont        *font,
                                                 gpointer         font_info[]);
+void          gimp_font_update_checksum        (GimpFont        *font,
+                                                GChecksum       *checksum);
 void          gimp_font_class_set_font_factory (GimpFontFactory *factory);
 
 enum
@@ -37,10 +37,12 @@
 
 #include "core/gimp.h"
 #include "core/gimp-parallel.h"
+#include "core/gimp-startup-profile.h"
 #include "core/gimpasync.h"
 #include "core/gimpasyncset.h"
 #include "core/gimpcancelable.h"
 #include "core/gimpcontainer.h"
+#include "core/gimplist.h"
 
 #include "gimpfont.h"
 #include "gimpfontfactory.h"
@@ -50,8 +52,27 @@
 
 #include <fontconfig/fontconfig.h>
 
-#define CONF_FNAME "fonts.conf"
+#define CONF_FNAME  "fonts.conf"
 
+/* The index remembers, for each custom fonts directory, the state of
+ * its files when all of them were last added without failure, so that
+ * an unchanged directory can be added through fontconfig's own cache
+ */
+#define INDEX_FNAME "fonts-index"
+
+
+typedef struct
+{
+  GimpFontFactory *factory;
+  FcConfig        *config;
+  GList           *path;             /*  the custom directories to add  */
+  GHashTable      *known_fonts;      /*  the fonts which are loaded     */
+  gint             next_name;
+  GSList          *renaming_config;
+  GimpContainer   *fonts;
+  gint             n_fonts;
+  GError          *error;
+} GimpFontLoad;
 
 struct _GimpFontFactoryPrivate
 {
@@ -80,6 +101,7 @@ static void       gimp_font_factory_finalize        (GObject         *object);
 
 static void       gimp_font_factory_load            (GimpFontFactory *factory,
                                                      GError         **error);
+static FcConfig * gimp_font_factory_load_config     (GimpFontFactory *factory);
 static gboolean   gimp_font_factory_load_fonts_conf (FcConfig        *config,
                                                      GFile           *fonts_conf);
 static void       gimp_font_factory_add_directories (GimpFontFactory *factory,
@@ -90,7 +112,14 @@ static void       gimp_font_factory_recursive_add_fontdir
                                                     (FcConfig        *config,
                                                      GFile           *file,
                                                      GError         **error);
-static int        gimp_font_factory_load_names      (GimpFontFactory *container);
+static void       gimp_font_factory_get_dir_signature
+                                                    (GFile           *file,
+                                                     GChecksum       *checksum);
+static int        gimp_font_factory_load_names      (FcConfig        *config,
+                                                     GimpContainer   *container,
+                                                     GHashTable      *known_fonts,
+                                                     gint            *next_name,
+                                                     GSList         **renaming_config);
 static void       gimp_font_factory_load_aliases    (GimpContainer   *container,
                                                      PangoContext    *context);
 
@@ -267,21 +296,155 @@ gimp_font_factory_get_pango_context (GimpFontFactory *factory)
 /*  private functions  */
 
 static void
-gimp_font_factory_load_async (GimpAsync       *async,
-                              GimpFontFactory *factory)
+gimp_font_load_free (GimpFontLoad *load)
+{
+  g_list_free_full (load->path, (GDestroyNotify) g_object_unref);
+  g_clear_pointer (&load->known_fonts, g_hash_table_unref);
+  g_slist_free_full (load->renaming_config, (GDestroyNotify) g_free);
+  g_clear_object (&load->fonts);
+  g_clear_error (&load->error);
+
+  if (load->config)
+    FcConfigDestroy (load->config);
+
+  g_slice_free (GimpFontLoad, load);
+}
+
+static void
+gimp_font_factory_set_fonts (GimpFontFactory *factory,
+                             GimpFontLoad    *load)
+{
+  GimpContainer *container;
+  PangoFontMap  *fontmap;
+  PangoContext  *context;
+  GList         *list;
+
+  container = gimp_data_factory_get_container (GIMP_DATA_FACTORY (factory));
+
+  /*  the new config knows the unique names of all the loaded fonts  */
+  FcConfigSetCurrent (load->config);
+  load->config = NULL;
+
+  for (list = GIMP_LIST (load->fonts)->queue->head; list; list = list->next)
+    gimp_container_add (container, list->data);
+
+  g_slist_free_full (GET_PRIVATE (factory)->fonts_renaming_config,
+                     (GDestroyNotify) g_free);
+  GET_PRIVATE (factory)->fonts_renaming_config =
+    g_slist_copy_deep (load->renaming_config, (GCopyFunc) g_strdup, NULL);
+
+  fontmap = pango_cairo_font_map_new_for_font_type (CAIRO_FONT_TYPE_FT);
+  if (! fontmap)
+    g_error ("You are using a Pango that has been built against a cairo "
+             "that lacks the Freetype font backend");
+
+  pango_cairo_font_map_set_resolution (PANGO_CAIRO_FONT_MAP (fontmap),
+                                       72.0 /* FIXME */);
+  context = pango_font_map_create_context (fontmap);
+  g_clear_object (&GET_PRIVATE (factory)->pango_context);
+  GET_PRIVATE (factory)->pango_context = context;
+  g_object_unref (fontmap);
+}
+
+/*  lists the system fonts, which are usually in fontconfig's caches
+ *  already, so that text can be used as soon as possible
+ */
+static void
+gimp_font_factory_load_async (GimpAsync    *async,
+                              GimpFontLoad *load)
 {
-  if (FcConfigBuildFonts (NULL))
+  gint64 profile_time = gimp_startup_profile_begin ();
+
+  if (FcConfigBuildFonts (load->config))
     {
-      gimp_async_finish (async, GINT_TO_POINTER (gimp_font_factory_load_names (factory)));
+      load->n_fonts = gimp_font_factory_load_names (load->config,
+                                                    load->fonts,
+                                                    load->known_fonts,
+                                                    &load->next_name,
+                                                    &load->renaming_config);
+
+      gimp_startup_profile_end ("Fonts", profile_time);
+
+      gimp_async_finish_full (async, load,
+                              (GDestroyNotify) gimp_font_load_free);
     }
   else
     {
-      FcConfigDestroy (FcConfigGetCurrent ());
+      gimp_font_load_free (load);
 
       gimp_async_abort (async);
     }
 }
 
+/*  adds the custom fonts directories to a new config, which replaces
+ *  the current one once they are all loaded
+ */
+static void
+gimp_font_factory_load_custom_async (GimpAsync    *async,
+                                     GimpFontLoad *load)
+{
+  GSList *list;
+  gint64  profile_time = gimp_startup_profile_begin ();
+
+  gimp_font_factory_add_directories (load->factory, load->config, load->path,
+                                     &load->error);
+
+  if (! FcConfigBuildFonts (load->config))
+    {
+      gimp_font_load_free (load);
+
+      gimp_async_abort (async);
+      return;
+    }
+
+  /*  keep the names of the fonts which are already loaded  */
+  for (list = load->renaming_config; list; list = list->next)
+    FcConfigParseAndLoadFromMemory (load->config, list->data, FcTrue);
+
+  load->n_fonts = gimp_font_factory_load_names (load->config,
+                                                load->fonts,
+                                                load->known_fonts,
+                                                &load->next_name,
+                                                &load->renaming_config);
+
+  gimp_startup_profile_end ("Custom fonts", profile_time);
+
+  gimp_async_finish_full (async, load,
+                          (GDestroyNotify) gimp_font_load_free);
+}
+
+static void
+gimp_font_factory_load_custom_async_callback (GimpAsync       *async,
+                                              GimpFontFactory *factory)
+{
+  GimpContainer *container;
+  GimpFontLoad  *load;
+
+  /* the operation was canceled and the factory might be dead (see
+   * gimp_font_factory_data_cancel()).  bail.
+   */
+  if (gimp_async_is_canceled (async))
+    return;
+
+  if (! gimp_async_is_finished (async))
+    return;
+
+  container = gimp_data_factory_get_container (GIMP_DATA_FACTORY (factory));
+  load      = gimp_async_get_result (async);
+
+  if (load->n_fonts > 0)
+    {
+      gimp_container_freeze (container);
+      gimp_font_factory_set_fonts (factory, load);
+      gimp_container_thaw (container);
+    }
+
+  if (load->error)
+    gimp_message_literal (gimp_data_factory_get_gimp (GIMP_DATA_FACTORY (factory)),
+                          NULL, GIMP_MESSAGE_INFO,
+                          load->error->message);
+}
+
 static void
 gimp_font_factory_load_async_callback (GimpAsync       *async,
                                        GimpFontFactory *factory)
@@ -298,24 +461,54 @@ gimp_font_factory_load_async_callback (GimpAsync       *async,
 
   if (gimp_async_is_finished (async))
     {
-      gint          num_fonts = GPOINTER_TO_INT (gimp_async_get_result (async));
-      PangoFontMap *fontmap;
-      PangoContext *context;
-
-      fontmap = pango_cairo_font_map_new_for_font_type (CAIRO_FONT_TYPE_FT);
-      if (! fontmap)
-        g_error ("You are using a Pango that has been built against a cairo "
-                 "that lacks the Freetype font backend");
+      GimpFontLoad *load = gimp_async_get_result (async);
+      GimpFontLoad *custom;
+      GimpAsync    *custom_async;
 
-      pango_cairo_font_map_set_resolution (PANGO_CAIRO_FONT_MAP (fontmap),
-                                           72.0 /* FIXME */);
-      context = pango_font_map_create_context (fontmap);
-      GET_PRIVATE (factory)->pango_context = context;
-      g_object_unref (fontmap);
+      gimp_font_factory_set_fonts (factory, load);
 
       /* only create aliases if there is at least one font available */
-      if (num_fonts > 0)
-        gimp_font_factory_load_aliases (container, context);
+      if (load->n_fonts > 0)
+        gimp_font_factory_load_aliases (container,
+                                        GET_PRIVATE (factory)->pango_context);
+
+      custom = g_slice_new0 (GimpFontLoad);
+
+      custom->factory         = factory;
+      custom->config          = gimp_font_factory_load_config (factory);
+      custom->path            = g_steal_pointer (&load->path);
+      custom->known_fonts     = g_hash_table_ref (load->known_fonts);
+      custom->next_name       = load->next_name;
+      custom->renaming_config = g_slist_copy_deep (load->renaming_config,
+                                                   (GCopyFunc) g_strdup,
+                                                   NULL);
+      custom->fonts           = gimp_list_new (GIMP_TYPE_FONT, FALSE);
+
+      if (custom->config && custom->path)
+        {
+          /* add this before the async set drops the current one, so that
+           * the fonts count as loading until the custom ones are there
+           */
+          custom_async = gimp_parallel_run_async_independent_labeled_full (
+            "data", +10,
+            (GimpRunAsyncFunc) gimp_font_factory_load_custom_async,
+            custom);
+
+          gimp_async_add_callback_for_object (
+            custom_async,
+            (GimpAsyncCallback) gimp_font_factory_load_custom_async_callback,
+            factory,
+            factory);
+
+          gimp_async_set_add (gimp_data_factory_get_async_set (GIMP_DATA_FACTORY (factory)),
+                              custom_async);
+
+          g_object_unref (custom_async);
+        }
+      else
+        {
+          gimp_font_load_free (custom);
+        }
     }
 
   gimp_container_thaw (container);
@@ -328,9 +521,7 @@ gimp_font_factory_load (GimpFontFactory  *factory,
   GimpContainer *container;
   Gimp          *gimp;
   GimpAsyncSet  *async_set;
-  FcConfig      *config;
-  GFile         *fonts_conf;
-  GList         *path;
+  GimpFontLoad  *load;
   GimpAsync     *async;
 
   async_set = gimp_data_factory_get_async_set (GIMP_DATA_FACTORY (factory));
@@ -348,10 +539,63 @@ gimp_font_factory_load (GimpFontFactory  *factory,
   if (gimp->be_verbose)
     g_print ("Loading fonts\n");
 
+  load = g_slice_new0 (GimpFontLoad);
+
+  load->factory = factory;
+  load->config  = gimp_font_factory_load_config (factory);
+
+  if (! load->config)
+    {
+      gimp_font_load_free (load);
+      return;
+    }
+
+  load->path = gimp_data_factory_get_data_path (GIMP_DATA_FACTORY (factory));
+  if (! load->path)
+    {
+      gimp_font_load_free (load);
+      return;
+    }
+
+  load->known_fonts = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                             g_free, NULL);
+  load->fonts       = gimp_list_new (GIMP_TYPE_FONT, FALSE);
+
+  gimp_container_freeze (container);
+  gimp_container_clear (container);
+
+  /* We perform font cache initialization in a separate thread, so
+   * in the case a cache rebuild is to be done it will not block
+   * the UI.  The custom fonts directories are only scanned once the
+   * system fonts are available, see
+   * gimp_font_factory_load_async_callback().
+   */
+  async = gimp_parallel_run_async_independent_labeled_full (
+    "data", +10,
+    (GimpRunAsyncFunc) gimp_font_factory_load_async,
+    load);
+
+  gimp_async_add_callback_for_object (
+    async,
+    (GimpAsyncCallback) gimp_font_factory_load_async_callback,
+    factory,
+    factory);
+
+  gimp_async_set_add (async_set, async);
+
+  g_object_unref (async);
+}
+
+static FcConfig *
+gimp_font_factory_load_config (GimpFontFactory *factory)
+{
+  FcConfig *config;
+  GFile    *fonts_conf;
+
   config = FcInitLoadConfig ();
 
   if (! config)
-    return;
+    return NULL;
 
   fonts_conf = gimp_directory_file (CONF_FNAME, NULL);
   if (! gimp_font_factory_load_fonts_conf (config, fonts_conf))
@@ -381,35 +625,7 @@ gimp_font_factory_load (GimpFontFactory  *factory,
 
   g_object_unref (fonts_conf);
 
-  path = gimp_data_factory_get_data_path (GIMP_DATA_FACTORY (factory));
-  if (! path)
-    return;
-
-  gimp_container_freeze (container);
-  gimp_container_clear (container);
-
-  gimp_font_factory_add_directories (factory, config, path, error);
-  g_list_free_full (path, (GDestroyNotify) g_object_unref);
-
-  FcConfigSetCurrent (config);
-  /* We perform font cache initialization in a separate thread, so
-   * in the case a cache rebuild is to be done it will not block
-   * the UI.
-   */
-  async = gimp_parallel_run_async_independent_full (
-    +10,
-    (GimpRunAsyncFunc) gimp_font_factory_load_async,
-    factory);
-
-  gimp_async_add_callback_for_object (
-    async,
-    (GimpAsyncCallback) gimp_font_factory_load_async_callback,
-    factory,
-    factory);
-
-  gimp_async_set_add (async_set, async);
-
-  g_object_unref (async);
+  return config;
 }
 
 static gboolean
@@ -433,23 +649,102 @@ gimp_font_factory_add_directories (GimpFontFactory *factory,
                                    GList           *path,
                                    GError         **error)
 {
-  GList *list;
+  GKeyFile *index;
+  GKeyFile *new_index;
+  gchar    *index_path;
+  gchar    *old_data;
+  gchar    *new_data;
+  GList    *list;
+
+  index_path = g_build_filename (gimp_cache_directory (), INDEX_FNAME, NULL);
+  index      = g_key_file_new ();
+  new_index  = g_key_file_new ();
+
+  g_key_file_load_from_file (index, index_path, G_KEY_FILE_NONE, NULL);
 
   for (list = path; list; list = list->next)
     {
+      GChecksum *checksum;
+      gchar     *dir;
+      gchar     *signature;
+      gchar     *old_signature;
+      GError    *dir_error = NULL;
+
       /* The configured directories must exist or be created. */
       g_file_make_directory_with_parents (list->data, NULL, NULL);
 
-      /* Do not use FcConfigAppFontAddDir(). Instead use
-       * FcConfigAppFontAddFile() with our own recursive loop.
-       * Otherwise, when some fonts fail to load (e.g. permission
-       * issues), we end up in weird situations where the fonts are in
-       * the list, but are unusable and output many errors.
-       * See bug 748553.
-       */
-      gimp_font_factory_recursive_add_fontdir (config, list->data, error);
+      dir = g_file_get_path (list->data);
+
+      checksum = g_checksum_new (G_CHECKSUM_MD5);
+      gimp_font_factory_get_dir_signature (list->data, checksum);
+      signature = g_strdup (g_checksum_get_string (checksum));
+      g_checksum_free (checksum);
+
+      old_signature = dir ? g_key_file_get_string (index, dir, "signature",
+                                                   NULL) : NULL;
+
+      if (old_signature && ! strcmp (old_signature, signature) &&
+          FcConfigAppFontAddDir (config, (const FcChar8 *) dir))
+        {
+          /* Nothing changed since all of the directory's fonts were
+           * last added without failure, so it is safe to let
+           * fontconfig add it from its cache.
+           */
+        }
+      else
+        {
+          /* Do not use FcConfigAppFontAddDir(). Instead use
+           * FcConfigAppFontAddFile() with our own recursive loop.
+           * Otherwise, when some fonts fail to load (e.g. permission
+           * issues), we end up in weird situations where the fonts are in
+           * the list, but are unusable and output many errors.
+           * See bug 748553.
+           */
+          gimp_font_factory_recursive_add_fontdir (config, list->data,
+                                                   &dir_error);
+        }
+
+      if (dir && ! dir_error)
+        g_key_file_set_string (new_index, dir, "signature", signature);
+
+      if (dir_error && error)
+        {
+          if (*error)
+            {
+              gchar *current_message = g_strdup ((*error)->message);
+
+              g_clear_error (error);
+              g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                           "%s\n%s", current_message, dir_error->message);
+              g_free (current_message);
+            }
+          else
+            {
+              g_propagate_error (error, g_steal_pointer (&dir_error));
+            }
+        }
+
+      g_clear_error (&dir_error);
+      g_free (old_signature);
+      g_free (signature);
+      g_free (dir);
+    }
+
+  old_data = g_key_file_to_data (index,     NULL, NULL);
+  new_data = g_key_file_to_data (new_index, NULL, NULL);
+
+  if (strcmp (old_data, new_data))
+    {
+      g_mkdir_with_parents (gimp_cache_directory (), 0700);
+      g_file_set_contents (index_path, new_data, -1, NULL);
     }
 
+  g_free (new_data);
+  g_free (old_data);
+  g_key_file_unref (new_index);
+  g_key_file_unref (index);
+  g_free (index_path);
+
   if (error && *error)
     {
       gchar *font_list = g_strdup ((*error)->message);
@@ -599,6 +894,66 @@ gimp_font_factory_recursive_add_fontdir (FcConfig  *config,
   g_clear_error (&file_error);
 }
 
+/*  computes a checksum of the names, types, sizes and modification
+ *  times of everything below 'file', without opening any font
+ */
+static void
+gimp_font_factory_get_dir_signature (GFile     *file,
+                                     GChecksum *checksum)
+{
+  GFileEnumerator *enumerator;
+
+  enumerator = g_file_enumerate_children (file,
+                                          G_FILE_ATTRIBUTE_STANDARD_NAME ","
+                                          G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN ","
+                                          G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                                          G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                                          G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                                          G_FILE_QUERY_INFO_NONE,
+                                          NULL, NULL);
+  if (enumerator)
+    {
+      GFileInfo *info;
+
+      while ((info = g_file_enumerator_next_file (enumerator, NULL, NULL)))
+        {
+          GFileType file_type;
+          guint64   values[2];
+
+          if (g_file_info_get_attribute_boolean (info, G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN))
+            {
+              g_object_unref (info);
+              continue;
+            }
+
+          file_type = g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_STANDARD_TYPE);
+
+          values[0] = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_STANDARD_SIZE);
+          values[1] = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+
+          g_checksum_update (checksum,
+                             (const guchar *) g_file_info_get_name (info), -1);
+          g_checksum_update (checksum,
+                             (const guchar *) &file_type, sizeof (file_type));
+          g_checksum_update (checksum,
+                             (const guchar *) values, sizeof (values));
+
+          if (file_type == G_FILE_TYPE_DIRECTORY)
+            {
+              GFile *child = g_file_enumerator_get_child (enumerator, info);
+
+              gimp_font_factory_get_dir_signature (child, checksum);
+
+              g_object_unref (child);
+            }
+
+          g_object_unref (info);
+        }
+
+      g_object_unref (enumerator);
+    }
+}
+
 static void
 gimp_font_factory_add_font (GimpContainer        *container,
                             PangoFontDescription *desc,
@@ -751,10 +1106,17 @@ gimp_font_factory_load_aliases (GimpContainer *container,
     }
 }
 
+/*  adds the fonts of 'config' which are not in 'known_fonts' yet to
+ *  'container', and appends the fontconfig rules which give them their
+ *  unique names to 'renaming_config'
+ */
 static gint
-gimp_font_factory_load_names (GimpFontFactory *factory)
+gimp_font_factory_load_names (FcConfig       *config,
+                              GimpContainer  *container,
+                              GHashTable     *known_fonts,
+                              gint           *next_name,
+                              GSList        **renaming_config)
 {
-  GimpContainer *container;
   FcObjectSet   *os;
   FcPattern     *pat;
   FcFontSet     *fontset;
@@ -766,12 +1128,11 @@ gimp_font_factory_load_names (GimpFontFactory *factory)
   GString       *xml_bold_italic_variant_and_global;
   GString       *ignored_fonts;
   gint           n_ignored  = 0;
+  gint           n_known    = 0;
   gint           i;
   gint           num_fonts_in_current_config = 0;
   gint           n_loaded_fonts              = 0;
 
-  container = gimp_data_factory_get_container (GIMP_DATA_FACTORY (factory));
-
   os = FcObjectSetBuild (FC_FAMILY,
                          FC_STYLE,
                          FC_POSTSCRIPT_NAME,
@@ -799,14 +1160,14 @@ gimp_font_factory_load_names (GimpFontFactory *factory)
       return -1;
     }
 
-  fontset       = FcFontList (NULL, pat, os);
+  fontset       = FcFontList (config, pat, os);
 
   FcPatternDestroy (pat);
   FcObjectSetDestroy (os);
 
   g_return_val_if_fail (fontset, -1);
 
-  xml_configs_list = NULL;
+  xml_configs_list = *renaming_config;
   xml = g_string_new (NULL);
   xml_italic_variant = g_string_new (NULL);
   xml_bold_variant = g_string_new (NULL);
@@ -827,6 +1188,7 @@ gimp_font_factory_load_names (GimpFontFactory *factory)
       gchar                *fullname         = NULL;
       gchar                *escaped_file     = NULL;
       gchar                *file             = NULL;
+      gchar                *key;
       gint                  index            = -1;
       gint                  weight           = -1;
       gint                  width            = -1;
@@ -846,6 +1208,17 @@ gimp_font_factory_load_names (GimpFontFactory *factory)
           continue;
         }
 
+      FcPatternGetInteger (fontset->fonts[i], FC_INDEX, 0, &index);
+
+      /* already loaded from another config */
+      key = g_strdup_printf ("%s:%d", file, index);
+
+      if (! g_hash_table_add (known_fonts, key))
+        {
+          n_known++;
+          continue;
+        }
+
       if (FT_New_Face (ft, file, 0, &face))
         {
           g_string_append_printf (ignored_fonts, "- %s (Failed To Create A FreeType Face)\n", file);
@@ -921,7 +1294,7 @@ gimp_font_factory_load_names (GimpFontFactory *factory)
       font_info[PROP_FONTVERSION] = (gpointer) &fontversion;
       font_info[PROP_FILE]        = (gpointer)  file;
 
-      newname = g_strdup_printf ("gimpfont%i", i);
+      newname = g_strdup_printf ("gimpfont%i", (*next_name)++);
 
       if (num_fonts_in_current_config == MAX_NUM_FONTS_PER_CONFIG)
         {
@@ -930,7 +1303,7 @@ gimp_font_factory_load_names (GimpFontFactory *factory)
           xml_bold_italic_variant_and_global = g_string_append (xml_bold_italic_variant_and_global, xml->str);
           xml_bold_italic_variant_and_global = g_string_append (xml_bold_italic_variant_and_global, "</fontconfig>");
 
-          FcConfigParseAndLoadFromMemory (FcConfigGetCurrent (), (const FcChar8 *) xml_bold_italic_variant_and_global->str, FcTrue);
+          FcConfigParseAndLoadFromMemory (config, (const FcChar8 *) xml_bold_italic_variant_and_global->str, FcTrue);
 
           xml_configs_list = g_slist_append (xml_configs_list, g_string_free (xml_bold_italic_variant_and_global, FALSE));
 
@@ -1127,7 +1500,7 @@ gimp_font_factory_load_names (GimpFontFactory *factory)
       xml_bold_italic_variant_and_global = g_string_append (xml_bold_italic_variant_and_global, xml->str);
       xml_bold_italic_variant_and_global = g_string_append (xml_bold_italic_variant_and_global, "</fontconfig>");
 
-      FcConfigParseAndLoadFromMemory (FcConfigGetCurrent (), (const FcChar8 *) xml_bold_italic_variant_and_global->str, FcTrue);
+      FcConfigParseAndLoadFromMemory (config, (const FcChar8 *) xml_bold_italic_variant_and_global->str, FcTrue);
 
       xml_configs_list = g_slist_append (xml_configs_list, g_string_free (xml_bold_italic_variant_and_global, FALSE));
 
@@ -1136,9 +1509,7 @@ gimp_font_factory_load_names (GimpFontFactory *factory)
       g_string_free (xml_bold_variant, TRUE);
     }
 
-  g_slist_free_full (GET_PRIVATE (factory)->fonts_renaming_config, (GDestroyNotify) g_free);
-
-  GET_PRIVATE (factory)->fonts_renaming_config = xml_configs_list;
+  *renaming_config = xml_configs_list;
 
   if (n_ignored > 0)
     {
@@ -1150,7 +1521,7 @@ gimp_font_factory_load_names (GimpFontFactory *factory)
 #endif
     }
 
-  n_loaded_fonts = fontset->nfont - n_ignored;
+  n_loaded_fonts = fontset->nfont - n_ignored - n_known;
 
   g_string_free (ignored_fonts, TRUE);
   FT_Done_FreeType (ft);
@@ -34,6 +34,9 @@
 
 #include "text-types.h"
 
+#include "core/gimp.h"
+#include "core/gimpcontainer.h"
+#include "core/gimpdatafactory.h"
 #include "core/gimperror.h"
 
 #include "gimpfont.h"
@@ -44,6 +47,12 @@
 #include "gimp-intl.h"
 
 
+/*  the fontset fingerprint is appended to the serialized text as a
+ *  comment, which all versions of the parser skip
+ */
+#define FONTSET_COMMENT "\n# fontset "
+
+
 /****************************************/
 /*  The native GimpTextLayer parasite.  */
 /****************************************/
@@ -57,12 +66,140 @@ gimp_text_parasite_name (void)
 GimpParasite *
 gimp_text_to_parasite (GimpText *text)
 {
+  GimpParasite *parasite;
+  gchar        *str;
+  gchar        *fontset;
+  gchar        *data;
+
+  g_return_val_if_fail (GIMP_IS_TEXT (text), NULL);
+
+  str     = gimp_config_serialize_to_string (GIMP_CONFIG (text), NULL);
+  fontset = gimp_text_get_fontset (text);
+
+  data = g_strconcat (str, FONTSET_COMMENT, fontset, "\n", NULL);
+
+  parasite = gimp_parasite_new (gimp_text_parasite_name (),
+                                GIMP_PARASITE_PERSISTENT,
+                                strlen (data) + 1, data);
+
+  g_free (data);
+  g_free (fontset);
+  g_free (str);
+
+  return parasite;
+}
+
+/**
+ * gimp_text_parasite_get_fontset:
+ * @parasite: a text parasite
+ *
+ * Returns: (nullable): the fingerprint of the fonts the text was using
+ *          when @parasite was created, or %NULL if @parasite doesn't
+ *          have one.
+ **/
+gchar *
+gimp_text_parasite_get_fontset (const GimpParasite *parasite)
+{
+  const gchar *parasite_data;
+  guint32      parasite_data_size;
+  gchar       *data;
+  gchar       *fontset = NULL;
+  gchar       *p;
+
+  g_return_val_if_fail (parasite != NULL, NULL);
+
+  parasite_data = gimp_parasite_get_data (parasite, &parasite_data_size);
+  if (! parasite_data)
+    return NULL;
+
+  data = g_strndup (parasite_data, parasite_data_size);
+
+  p = g_strrstr (data, FONTSET_COMMENT);
+  if (p)
+    {
+      gchar *end;
+
+      p  += strlen (FONTSET_COMMENT);
+      end = strchr (p, '\n');
+
+      if (end)
+        fontset = g_strndup (p, end - p);
+    }
+
+  g_free (data);
+
+  return fontset;
+}
+
+/**
+ * gimp_text_get_fontset:
+ * @text: a #GimpText
+ *
+ * Computes a fingerprint of the fonts @text is using: its base font,
+ * and the fonts of its markup. Two texts resolved to the same fonts
+ * have the same fingerprint, even across sessions.
+ *
+ * Returns: the newly allocated fingerprint.
+ **/
+gchar *
+gimp_text_get_fontset (GimpText *text)
+{
+  GChecksum *checksum;
+  gchar     *fontset;
+
   g_return_val_if_fail (GIMP_IS_TEXT (text), NULL);
 
-  return gimp_config_serialize_to_parasite (GIMP_CONFIG (text),
-                                            gimp_text_parasite_name (),
-                                            GIMP_PARASITE_PERSISTENT,
-                                            NULL);
+  checksum = g_checksum_new (G_CHECKSUM_MD5);
+
+  if (text->font)
+    gimp_font_update_checksum (text->font, checksum);
+
+  if (text->markup)
+    {
+      GimpContainer *container;
+      PangoAttrList *attr_list;
+
+      container = gimp_data_factory_get_container (text->gimp->font_factory);
+
+      if (pango_parse_markup (text->markup, -1, 0, &attr_list,
+                              NULL, NULL, NULL))
+        {
+          GSList *list = pango_attr_list_get_attributes (attr_list);
+          GSList *iter;
+
+          for (iter = list; iter; iter = g_slist_next (iter))
+            {
+              PangoAttrFontDesc *attr_font_desc;
+              const gchar       *family;
+              GimpFont          *font = NULL;
+
+              attr_font_desc = pango_attribute_as_font_desc (iter->data);
+              if (! attr_font_desc)
+                continue;
+
+              family = pango_font_description_get_family (attr_font_desc->desc);
+
+              if (family)
+                font = GIMP_FONT (gimp_container_search (container,
+                                                         (GimpContainerSearchFunc) gimp_font_match_by_lookup_name,
+                                                         (gpointer) family));
+
+              if (font)
+                gimp_font_update_checksum (font, checksum);
+              else if (family)
+                g_checksum_update (checksum, (const guchar *) family, -1);
+            }
+
+          g_slist_free_full (list, (GDestroyNotify) pango_attribute_destroy);
+          pango_attr_list_unref (attr_list);
+        }
+    }
+
+  fontset = g_strdup (g_checksum_get_string (checksum));
+
+  g_checksum_free (checksum);
+
+  return fontset;
 }
 
 GimpText *
@@ -27,6 +27,8 @@ GimpText     * gimp_text_from_parasite          (const GimpParasite  *parasite,
                                                  Gimp                *gimp,
                                                  gboolean            *before_xcf_v19,
                                                  GError             **error);
+gchar        * gimp_text_parasite_get_fontset   (const GimpParasite  *parasite);
+gchar        * gimp_text_get_fontset            (GimpText            *text);
 
 const gchar  * gimp_text_gdyntext_parasite_name (void) G_GNUC_CONST;
 GimpText     * gimp_text_from_gdyntext_parasite (Gimp                *gimp,
@@ -20,6 +20,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gegl.h>
 #include <cairo.h>
@@ -28,6 +30,8 @@
 #include "text-types.h"
 
 #include "core/gimp.h"
+#include "core/gimpasyncset.h"
+#include "core/gimpdatafactory.h"
 #include "core/gimpdrawable-private.h" /* eek */
 #include "core/gimpimage.h"
 #include "core/gimplayer-xcf.h"
@@ -56,6 +60,7 @@ gimp_text_layer_xcf_load_hack (GimpLayer **layer)
   GimpText           *text = NULL;
   const GimpParasite *parasite;
   gboolean            before_xcf_v19 = FALSE;
+  gboolean            keep_pixels    = FALSE;
 
   g_return_val_if_fail (layer != NULL, FALSE);
   g_return_val_if_fail (GIMP_IS_LAYER (*layer), FALSE);
@@ -85,6 +90,41 @@ gimp_text_layer_xcf_load_hack (GimpLayer **layer)
                         error->message);
           g_clear_error (&error);
         }
+      else
+        {
+          Gimp         *gimp      = gimp_item_get_image (GIMP_ITEM (*layer))->gimp;
+          GimpAsyncSet *async_set = gimp_data_factory_get_async_set (gimp->font_factory);
+          gchar        *fontset   = gimp_text_parasite_get_fontset (parasite);
+
+          /*  if the text resolves to the fonts it was rendered with, the
+           *  stored pixels are what rendering it would give, and there is
+           *  no need to lay it out before it is changed.  the comparison
+           *  is only meaningful once all fonts are loaded.
+           */
+          if (fontset && gimp_async_set_is_empty (async_set))
+            {
+              gchar *current = gimp_text_get_fontset (text);
+
+              if (! strcmp (fontset, current))
+                {
+                  keep_pixels = TRUE;
+                }
+              else
+                {
+                  gimp_message (gimp, NULL, GIMP_MESSAGE_WARNING,
+                                _("Some fonts used by the text layer '%s' "
+                                  "are not available, or have changed.\n\n"
+                                  "The layer is shown as it was saved, but "
+                                  "it may look different once its text is "
+                                  "edited."),
+                                gimp_object_get_name (*layer));
+                }
+
+              g_free (current);
+            }
+
+          g_free (fontset);
+        }
     }
   else
     {
@@ -111,6 +151,7 @@ gimp_text_layer_xcf_load_hack (GimpLayer **layer)
       /*  let the text layer knows what parasite was used to create it  */
       GIMP_TEXT_LAYER (*layer)->text_parasite        = name;
       GIMP_TEXT_LAYER (*layer)->text_parasite_is_old = before_xcf_v19;
+      GIMP_TEXT_LAYER (*layer)->keep_pixels          = keep_pixels;
     }
 
   return (text != NULL);
@@ -69,9 +69,36 @@ enum
 
 struct _GimpTextLayerPrivate
 {
-  GimpTextDirection base_dir;
+  GimpTextDirection  base_dir;
+
+  /*  the layout of the last render, and what it was created from  */
+  GimpTextLayout    *layout;
+  GimpText          *layout_text;
+  const Babl        *layout_space;
+  GimpPrecision      layout_precision;
+  gdouble            layout_xres;
+  gdouble            layout_yres;
 };
 
+
+/*  the text properties which only affect how the layout is painted,
+ *  and not the layout itself
+ */
+static const gchar * const paint_only_properties[] =
+{
+  "color",
+  "outline-custom-style",
+  "outline-pattern",
+  "outline-foreground",
+  "outline-cap-style",
+  "outline-join-style",
+  "outline-miter-limit",
+  "outline-antialias",
+  "outline-dash-offset",
+  "outline-dash-info"
+};
+
+
 static void       gimp_text_layer_finalize       (GObject           *object);
 static void       gimp_text_layer_get_property   (GObject           *object,
                                                   guint              property_id,
@@ -118,6 +145,10 @@ static void       gimp_text_layer_convert_type   (GimpLayer         *layer,
                                                   GimpProgress      *progress);
 
 static void       gimp_text_layer_text_changed   (GimpTextLayer     *layer);
+static GimpTextLayout *
+                  gimp_text_layer_get_layout     (GimpTextLayer     *layer,
+                                                  GError           **error);
+static void       gimp_text_layer_clear_layout   (GimpTextLayer     *layer);
 static gboolean   gimp_text_layer_render         (GimpTextLayer     *layer);
 static void       gimp_text_layer_render_layout  (GimpTextLayer     *layer,
                                                   GimpTextLayout    *layout);
@@ -196,6 +227,7 @@ gimp_text_layer_init (GimpTextLayer *layer)
   layer->text                 = NULL;
   layer->text_parasite        = NULL;
   layer->text_parasite_is_old = FALSE;
+  layer->keep_pixels          = FALSE;
   layer->private              = gimp_text_layer_get_instance_private (layer);
 }
 
@@ -204,6 +236,8 @@ gimp_text_layer_finalize (GObject *object)
 {
   GimpTextLayer *layer = GIMP_TEXT_LAYER (object);
 
+  gimp_text_layer_clear_layout (layer);
+
   g_clear_object (&layer->text);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
@@ -319,6 +353,7 @@ gimp_text_layer_duplicate (GimpItem *item,
         {
           new_layer->text_parasite        = layer->text_parasite;
           new_layer->text_parasite_is_old = layer->text_parasite_is_old;
+          new_layer->keep_pixels          = layer->keep_pixels;
         }
 
       new_layer->private->base_dir = layer->private->base_dir;
@@ -414,8 +449,9 @@ gimp_text_layer_convert_type (GimpLayer         *layer,
   GimpTextLayer *text_layer = GIMP_TEXT_LAYER (layer);
   GimpImage     *image      = gimp_item_get_image (GIMP_ITEM (text_layer));
 
-  if (! text_layer->text   ||
-      text_layer->modified ||
+  if (! text_layer->text       ||
+      text_layer->modified     ||
+      text_layer->keep_pixels  ||
       layer_dither_type != GEGL_DITHER_NONE)
     {
       GIMP_LAYER_CLASS (parent_class)->convert_type (layer, dest_image,
@@ -505,6 +541,8 @@ gimp_text_layer_set_text (GimpTextLayer *layer,
       g_clear_object (&layer->text);
     }
 
+  gimp_text_layer_clear_layout (layer);
+
   if (text)
     {
       layer->text = g_object_ref (text);
@@ -640,6 +678,8 @@ gimp_text_layer_text_changed (GimpTextLayer *layer)
       layer->text_parasite_is_old = FALSE;
     }
 
+  layer->keep_pixels = FALSE;
+
   if (layer->text->box_mode == GIMP_TEXT_BOX_DYNAMIC)
     {
       gint                old_width;
@@ -706,6 +746,94 @@ gimp_text_layer_text_changed (GimpTextLayer *layer)
   layer->private->base_dir = layer->text->base_dir;
 }
 
+/* returns a layout for the layer's current text.  the layout of the
+ * last call is kept, and returned again as long as only properties
+ * which are applied when painting it changed since, so that changing
+ * the color or the outline style of a text layer doesn't lay out,
+ * and shape, all of its text again.
+ */
+static GimpTextLayout *
+gimp_text_layer_get_layout (GimpTextLayer  *layer,
+                            GError        **error)
+{
+  GimpTextLayerPrivate *private = layer->private;
+  GimpImage            *image   = gimp_item_get_image (GIMP_ITEM (layer));
+  GimpTextLayout       *layout;
+  const Babl           *space;
+  GimpPrecision         precision;
+  gdouble               xres;
+  gdouble               yres;
+  GError               *my_error = NULL;
+
+  gimp_image_get_resolution (image, &xres, &yres);
+
+  space     = gimp_image_get_layer_space (image);
+  precision = gimp_image_get_precision (image);
+
+  if (private->layout                        &&
+      private->layout_space     == space     &&
+      private->layout_precision == precision &&
+      private->layout_xres      == xres      &&
+      private->layout_yres      == yres)
+    {
+      GList    *diff;
+      GList    *list;
+      gboolean  valid = TRUE;
+
+      diff = gimp_config_diff (G_OBJECT (layer->text),
+                               G_OBJECT (private->layout_text), 0);
+
+      for (list = diff; list && valid; list = g_list_next (list))
+        {
+          GParamSpec *pspec = list->data;
+          gint        i;
+
+          valid = FALSE;
+
+          for (i = 0; i < G_N_ELEMENTS (paint_only_properties); i++)
+            {
+              if (! strcmp (pspec->name, paint_only_properties[i]))
+                {
+                  valid = TRUE;
+                  break;
+                }
+            }
+        }
+
+      g_list_free (diff);
+
+      if (valid)
+        return g_object_ref (private->layout);
+    }
+
+  gimp_text_layer_clear_layout (layer);
+
+  layout = gimp_text_layout_new (layer->text, image, xres, yres, &my_error);
+
+  if (my_error)
+    {
+      g_propagate_error (error, my_error);
+
+      return layout;
+    }
+
+  private->layout           = g_object_ref (layout);
+  private->layout_text      = gimp_config_duplicate (GIMP_CONFIG (layer->text));
+  private->layout_space     = space;
+  private->layout_precision = precision;
+  private->layout_xres      = xres;
+  private->layout_yres      = yres;
+
+  return layout;
+}
+
+static void
+gimp_text_layer_clear_layout (GimpTextLayer *layer)
+{
+  g_clear_object (&layer->private->layout);
+  g_clear_object (&layer->private->layout_text);
+}
+
 static gboolean
 gimp_text_layer_render (GimpTextLayer *layer)
 {
@@ -714,8 +842,6 @@ gimp_text_layer_render (GimpTextLayer *layer)
   GimpImage      *image;
   GimpContainer  *container;
   GimpTextLayout *layout;
-  gdouble         xres;
-  gdouble         yres;
   gint            width;
   gint            height;
   GError         *error = NULL;
@@ -738,9 +864,7 @@ gimp_text_layer_render (GimpTextLayer *layer)
       return FALSE;
     }
 
-  gimp_image_get_resolution (image, &xres, &yres);
-
-  layout = gimp_text_layout_new (layer->text, image, xres, yres, &error);
+  layout = gimp_text_layer_get_layout (layer, &error);
   if (error)
     {
       gimp_message_literal (image->gimp, NULL, GIMP_MESSAGE_ERROR, error->message);
@@ -44,6 +44,10 @@ struct _GimpTextLayer
                                        * is changed.
                                        */
   gboolean      text_parasite_is_old; /* Format before XCF 19. */
+  gboolean      keep_pixels;          /* the pixels were loaded with fonts
+                                       * matching the text's, and are used
+                                       * until the text is changed.
+                                       */
   gboolean      auto_rename;
   gboolean      modified;
 
@@ -20,10 +20,12 @@
 
 #include "config.h"
 
+#include <gegl.h>
 #include <pango/pangocairo.h>
 
 #include "text-types.h"
 
+#include "gimptext.h"
 #include "gimptextlayout.h"
 #include "gimptextlayout-render.h"
 
@@ -69,9 +71,25 @@ gimp_text_layout_render (GimpTextLayout    *layout,
   pango_layout = gimp_text_layout_get_pango_layout (layout);
 
   if (path)
-    pango_cairo_layout_path (cr, pango_layout);
+    {
+      pango_cairo_layout_path (cr, pango_layout);
+    }
   else
-    pango_cairo_show_layout (cr, pango_layout);
+    {
+      GimpText   *text   = gimp_text_layout_get_text (layout);
+      const Babl *format = gimp_text_layout_get_format (layout, "double");
+      gdouble     color[3];
+
+      /*  the base text color, spans with a color of their own override it  */
+      gegl_color_get_pixel (text->color, format, color);
+
+      if (! babl_space_is_gray (babl_format_get_space (format)))
+        cairo_set_source_rgba (cr, color[0], color[1], color[2], 1.0);
+      else
+        cairo_set_source_rgba (cr, color[0], color[0], color[0], 1.0);
+
+      pango_cairo_show_layout (cr, pango_layout);
+    }
 
   cairo_restore (cr);
 }
@@ -590,30 +590,14 @@ static gchar *
 gimp_text_layout_apply_tags (GimpTextLayout *layout,
                              const gchar    *markup)
 {
-  const Babl *format;
-  GimpText   *text  = layout->text;
-  gchar      *result;
-  guchar      color[3];
-
-  /* Unfortunately Pango markup are very limited, color-wise. Colors are
-   * written in hexadecimal, so they are u8 as maximum precision, and
-   * unbounded colors are not accessible.
-   * At the very least, what we do is to write color values in the target
-   * space in the PangoLayout, so that we don't end up stuck to sRGB text
-   * colors even in images with wider gamut spaces.
-   *
-   * Moreover this is limited to RGB and Grayscale spaces. Therefore, images
-   * with other backends will be limited to the sRGB gamut, for as long as Pango
-   * do not evolve (or unless we changed our rendering backend).
+  GimpText *text   = layout->text;
+  gchar    *result = g_strdup (markup);
+
+  /* The base text color is not part of the markup: it is set as the
+   * cairo source in gimp_text_layout_render(), so that the layout stays
+   * valid, and can be kept, when only the color changes. Colors set in
+   * the markup itself still take precedence.
    */
-  format = gimp_text_layout_get_format (layout, "u8");
-  gegl_color_get_pixel (text->color, format, color);
-  if (! babl_space_is_gray (babl_format_get_space (format)))
-    result = g_strdup_printf ("<span color=\"#%02x%02x%02x\">%s</span>",
-                              color[0], color[1], color[2], markup);
-  else
-    result = g_strdup_printf ("<span color=\"#%02x%02x%02x\">%s</span>",
-                              color[0], color[0], color[0], markup);
 
   /* Updating font 'locl' (if supported) with 'lang' feature tag */
   if (text->language)
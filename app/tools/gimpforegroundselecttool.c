@@ -1168,13 +1168,14 @@ gimp_foreground_select_tool_preview (GimpForegroundSelectTool *fg_select)
 
   g_clear_object (&fg_select->mask);
 
-  fg_select->mask = gimp_drawable_foreground_extract (drawable,
-                                                      options->engine,
-                                                      options->iterations,
-                                                      options->levels,
-                                                      options->active_levels,
-                                                      fg_select->trimap,
-                                                      GIMP_PROGRESS (fg_select));
+  fg_select->mask = gimp_drawable_foreground_extract_coarse_to_fine (
+    drawable,
+    options->engine,
+    options->iterations,
+    options->levels,
+    options->active_levels,
+    fg_select->trimap,
+    GIMP_PROGRESS (fg_select));
 
   gimp_foreground_select_tool_set_preview (fg_select);
 }
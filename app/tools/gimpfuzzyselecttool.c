@@ -47,8 +47,23 @@
 #include "gimp-intl.h"
 
 
-static GeglBuffer * gimp_fuzzy_select_tool_get_mask (GimpRegionSelectTool *region_select,
-                                                     GimpDisplay          *display);
+static void         gimp_fuzzy_select_tool_finalize       (GObject               *object);
+
+static void         gimp_fuzzy_select_tool_button_press   (GimpTool              *tool,
+                                                           const GimpCoords      *coords,
+                                                           guint32                time,
+                                                           GdkModifierType        state,
+                                                           GimpButtonPressType    press_type,
+                                                           GimpDisplay           *display);
+static void         gimp_fuzzy_select_tool_button_release (GimpTool              *tool,
+                                                           const GimpCoords      *coords,
+                                                           guint32                time,
+                                                           GdkModifierType        state,
+                                                           GimpButtonReleaseType  release_type,
+                                                           GimpDisplay           *display);
+
+static GeglBuffer * gimp_fuzzy_select_tool_get_mask       (GimpRegionSelectTool  *region_select,
+                                                           GimpDisplay           *display);
 
 
 G_DEFINE_TYPE (GimpFuzzySelectTool, gimp_fuzzy_select_tool,
@@ -77,12 +92,17 @@ gimp_fuzzy_select_tool_register (GimpToolRegisterCallback  callback,
 static void
 gimp_fuzzy_select_tool_class_init (GimpFuzzySelectToolClass *klass)
 {
-  GimpRegionSelectToolClass *region_class;
+  GObjectClass              *object_class = G_OBJECT_CLASS (klass);
+  GimpToolClass             *tool_class   = GIMP_TOOL_CLASS (klass);
+  GimpRegionSelectToolClass *region_class = GIMP_REGION_SELECT_TOOL_CLASS (klass);
 
-  region_class = GIMP_REGION_SELECT_TOOL_CLASS (klass);
+  object_class->finalize     = gimp_fuzzy_select_tool_finalize;
 
-  region_class->undo_desc = C_("command", "Fuzzy Select");
-  region_class->get_mask  = gimp_fuzzy_select_tool_get_mask;
+  tool_class->button_press   = gimp_fuzzy_select_tool_button_press;
+  tool_class->button_release = gimp_fuzzy_select_tool_button_release;
+
+  region_class->undo_desc    = C_("command", "Fuzzy Select");
+  region_class->get_mask     = gimp_fuzzy_select_tool_get_mask;
 }
 
 static void
@@ -94,20 +114,77 @@ gimp_fuzzy_select_tool_init (GimpFuzzySelectTool *fuzzy_select)
                                      GIMP_TOOL_CURSOR_FUZZY_SELECT);
 }
 
+static void
+gimp_fuzzy_select_tool_finalize (GObject *object)
+{
+  GimpFuzzySelectTool *fuzzy_select = GIMP_FUZZY_SELECT_TOOL (object);
+
+  g_clear_object (&fuzzy_select->distance_map);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gimp_fuzzy_select_tool_button_press (GimpTool            *tool,
+                                     const GimpCoords    *coords,
+                                     guint32              time,
+                                     GdkModifierType      state,
+                                     GimpButtonPressType  press_type,
+                                     GimpDisplay         *display)
+{
+  GimpFuzzySelectTool *fuzzy_select = GIMP_FUZZY_SELECT_TOOL (tool);
+
+  /*  a new seed, the distance map is recomputed by get_mask()  */
+  g_clear_object (&fuzzy_select->distance_map);
+
+  GIMP_TOOL_CLASS (parent_class)->button_press (tool, coords, time, state,
+                                                press_type, display);
+}
+
+static void
+gimp_fuzzy_select_tool_button_release (GimpTool              *tool,
+                                       const GimpCoords      *coords,
+                                       guint32                time,
+                                       GdkModifierType        state,
+                                       GimpButtonReleaseType  release_type,
+                                       GimpDisplay           *display)
+{
+  GimpFuzzySelectTool *fuzzy_select = GIMP_FUZZY_SELECT_TOOL (tool);
+
+  GIMP_TOOL_CLASS (parent_class)->button_release (tool, coords, time, state,
+                                                  release_type, display);
+
+  g_clear_object (&fuzzy_select->distance_map);
+}
+
 static GeglBuffer *
 gimp_fuzzy_select_tool_get_mask (GimpRegionSelectTool *region_select,
                                  GimpDisplay          *display)
 {
+  GimpFuzzySelectTool     *fuzzy_select = GIMP_FUZZY_SELECT_TOOL (region_select);
   GimpTool                *tool         = GIMP_TOOL (region_select);
   GimpSelectionOptions    *sel_options  = GIMP_SELECTION_TOOL_GET_OPTIONS (tool);
   GimpRegionSelectOptions *options      = GIMP_REGION_SELECT_TOOL_GET_OPTIONS (tool);
   GimpImage               *image        = gimp_display_get_image (display);
   GimpImage               *select_image = NULL;
-  GList                   *drawables    = gimp_image_get_selected_drawables (image);
+  GList                   *drawables;
   GimpPickable            *pickable;
-  GeglBuffer              *mask;
   gint                     x, y;
 
+  /*  while the threshold is dragged, the seed and the image don't change,
+   *  so the distance map computed on button press gives the region for
+   *  any threshold with a simple comparison
+   */
+  if (fuzzy_select->distance_map)
+    {
+      return gimp_pickable_contiguous_region_by_distance_map (
+        fuzzy_select->distance_map,
+        sel_options->antialias,
+        options->threshold / 255.0);
+    }
+
+  drawables = gimp_image_get_selected_drawables (image);
+
   x = region_select->x;
   y = region_select->y;
 
@@ -140,9 +217,8 @@ gimp_fuzzy_select_tool_get_mask (GimpRegionSelectTool *region_select,
 
   g_list_free (drawables);
 
-  mask = gimp_pickable_contiguous_region_by_seed (pickable,
-                                                  sel_options->antialias,
-                                                  options->threshold / 255.0,
+  fuzzy_select->distance_map =
+    gimp_pickable_contiguous_region_distance_map (pickable,
                                                   options->select_transparent,
                                                   options->select_criterion,
                                                   options->diagonal_neighbors,
@@ -151,5 +227,8 @@ gimp_fuzzy_select_tool_get_mask (GimpRegionSelectTool *region_select,
   if (select_image)
     g_object_unref (select_image);
 
-  return mask;
+  return gimp_pickable_contiguous_region_by_distance_map (
+    fuzzy_select->distance_map,
+    sel_options->antialias,
+    options->threshold / 255.0);
 }
@@ -36,6 +36,8 @@ typedef struct _GimpFuzzySelectToolClass GimpFuzzySelectToolClass;
 struct _GimpFuzzySelectTool
 {
   GimpRegionSelectTool  parent_instance;
+
+  GeglBuffer           *distance_map;
 };
 
 struct _GimpFuzzySelectToolClass
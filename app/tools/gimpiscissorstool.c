@@ -45,6 +45,7 @@
 #include "config.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <gegl.h>
 #include <gtk/gtk.h>
@@ -56,6 +57,7 @@
 #include "tools-types.h"
 
 #include "gegl/gimp-gegl-utils.h"
+#include "gegl/gimptilehandlervalidate.h"
 
 #include "core/gimpchannel.h"
 #include "core/gimpchannel-select.h"
@@ -97,6 +99,15 @@
 #define  PIXEL_COST(x)     ((x) >> 8)
 #define  PIXEL_DIR(x)      ((x) & 0x000000ff)
 
+/*  how far from the last vertex the live wire reaches, beyond that
+ *  segments are computed by find_optimal_path() instead
+ */
+#define  LIVEWIRE_RADIUS   512
+/*  how many pixels the live wire settles per idle iteration  */
+#define  LIVEWIRE_STEPS    16384
+/*  marks pixels that have not been reached yet  */
+#define  LIVEWIRE_NO_LINK  255
+
 
 struct _ISegment
 {
@@ -112,6 +123,29 @@ struct _ICurve
   gboolean  closed;
 };
 
+/*  The live wire is a shortest path tree rooted at the last vertex,
+ *  grown with Dijkstra's algorithm over a window of the gradient map.
+ *  It is grown in the background, so the path to the cursor is mostly
+ *  a lookup, and only grown on demand when the cursor gets ahead.
+ */
+typedef struct
+{
+  guint32 cost;
+  guint32 index;
+} ILivewireNode;
+
+struct _ILivewire
+{
+  gint           seed_x, seed_y;
+  GeglRectangle  area;         /*  the window, in image coordinates       */
+  guint8        *gradient;     /*  the gradient map within the window     */
+  guint32       *cost;         /*  cumulative cost to reach every pixel   */
+  guint8        *link;         /*  direction towards the seed, see move[] */
+  guint8        *settled;      /*  whether the pixel's cost is final      */
+  GArray        *heap;         /*  binary heap of ILivewireNodes          */
+  guint          idle_id;
+};
+
 
 /*  local function prototypes  */
 
@@ -239,6 +273,20 @@ static void          icurve_delete_segment     (ICurve            *curve,
 
 static void          icurve_close              (ICurve            *curve);
 
+static ILivewire   * ilivewire_new             (GeglBuffer        *gradient_map,
+                                                gint               seed_x,
+                                                gint               seed_y);
+static void          ilivewire_free            (ILivewire         *livewire);
+static gboolean      ilivewire_grow            (ILivewire         *livewire,
+                                                gint               max_steps,
+                                                gint               target);
+static gboolean      ilivewire_idle            (ILivewire         *livewire);
+static GPtrArray   * ilivewire_get_path        (ILivewire         *livewire,
+                                                gint               x,
+                                                gint               y);
+static gboolean      calculate_livewire_segment (GimpIscissorsTool *iscissors,
+                                                ISegment          *segment);
+
 static GimpScanConvert *
                     icurve_create_scan_convert (ICurve            *curve);
 
@@ -609,7 +657,8 @@ gimp_iscissors_tool_button_release (GimpTool              *tool,
                   if (segment->x1 != segment->x2 ||
                       segment->y1 != segment->y2)
                     {
-                      if (! options->interactive)
+                      if (! options->interactive &&
+                          ! calculate_livewire_segment (iscissors, segment))
                         calculate_segment (iscissors, segment);
 
                       gimp_iscissors_tool_free_redo (iscissors);
@@ -732,7 +781,8 @@ gimp_iscissors_tool_motion (GimpTool         *tool,
         }
       else
         {
-          if (options->interactive)
+          if (options->interactive &&
+              ! calculate_livewire_segment (iscissors, segment))
             calculate_segment (iscissors, segment);
         }
       break;
@@ -1290,6 +1340,7 @@ gimp_iscissors_tool_halt (GimpIscissorsTool *iscissors,
       iscissors->redo_stack = NULL;
     }
 
+  g_clear_pointer (&iscissors->livewire, ilivewire_free);
   g_clear_object (&iscissors->gradient_map);
   g_clear_object (&iscissors->mask);
 }
@@ -1892,6 +1943,361 @@ find_optimal_path (GeglBuffer  *gradient_map,
   g_object_unref (map_sampler);
 }
 
+/*  Like calculate_segment(), but looks the segment up in the live wire
+ *  rooted at its start, which is (re)created as needed.  Returns FALSE
+ *  if the segment's end is out of the live wire's reach.
+ */
+static gboolean
+calculate_livewire_segment (GimpIscissorsTool *iscissors,
+                            ISegment          *segment)
+{
+  GimpDisplay  *display  = GIMP_TOOL (iscissors)->display;
+  GimpPickable *pickable = GIMP_PICKABLE (gimp_display_get_image (display));
+  GPtrArray    *points;
+
+  if (! iscissors->gradient_map)
+    iscissors->gradient_map = gradient_map_new (pickable);
+
+  if (iscissors->livewire &&
+      (iscissors->livewire->seed_x != segment->x1 ||
+       iscissors->livewire->seed_y != segment->y1))
+    {
+      g_clear_pointer (&iscissors->livewire, ilivewire_free);
+    }
+
+  if (! iscissors->livewire)
+    {
+      iscissors->livewire = ilivewire_new (iscissors->gradient_map,
+                                           segment->x1, segment->y1);
+
+      if (! iscissors->livewire)
+        return FALSE;
+    }
+
+  points = ilivewire_get_path (iscissors->livewire, segment->x2, segment->y2);
+
+  if (! points)
+    return FALSE;
+
+  if (segment->points)
+    g_ptr_array_free (segment->points, TRUE);
+
+  segment->points = points;
+
+  return TRUE;
+}
+
+static inline void
+ilivewire_heap_push (GArray  *heap,
+                     guint32  cost,
+                     guint32  index)
+{
+  ILivewireNode *nodes;
+  gint           i;
+
+  g_array_set_size (heap, heap->len + 1);
+
+  nodes = (ILivewireNode *) heap->data;
+
+  for (i = heap->len - 1; i > 0; i = (i - 1) / 2)
+    {
+      gint parent = (i - 1) / 2;
+
+      if (nodes[parent].cost <= cost)
+        break;
+
+      nodes[i] = nodes[parent];
+    }
+
+  nodes[i].cost  = cost;
+  nodes[i].index = index;
+}
+
+static inline ILivewireNode
+ilivewire_heap_pop (GArray *heap)
+{
+  ILivewireNode *nodes = (ILivewireNode *) heap->data;
+  ILivewireNode  top   = nodes[0];
+  ILivewireNode  last  = nodes[heap->len - 1];
+  gint           n     = heap->len - 1;
+  gint           i     = 0;
+
+  while (2 * i + 1 < n)
+    {
+      gint child = 2 * i + 1;
+
+      if (child + 1 < n && nodes[child + 1].cost < nodes[child].cost)
+        child++;
+
+      if (last.cost <= nodes[child].cost)
+        break;
+
+      nodes[i] = nodes[child];
+      i = child;
+    }
+
+  nodes[i] = last;
+
+  g_array_set_size (heap, n);
+
+  return top;
+}
+
+static ILivewire *
+ilivewire_new (GeglBuffer *gradient_map,
+               gint        seed_x,
+               gint        seed_y)
+{
+  ILivewire               *livewire;
+  GimpTileHandlerValidate *validate;
+  GeglRectangle            area;
+  gint                     n_pixels;
+  gint                     seed;
+
+  if (! gegl_rectangle_intersect (&area,
+                                  GEGL_RECTANGLE (seed_x - LIVEWIRE_RADIUS,
+                                                  seed_y - LIVEWIRE_RADIUS,
+                                                  2 * LIVEWIRE_RADIUS + 1,
+                                                  2 * LIVEWIRE_RADIUS + 1),
+                                  gegl_buffer_get_extent (gradient_map)) ||
+      ! gegl_rectangle_contains (&area,
+                                 GEGL_RECTANGLE (seed_x, seed_y, 1, 1)))
+    {
+      return NULL;
+    }
+
+  /*  compute the still invalid parts of the window concurrently,
+   *  instead of tile by tile as they are read
+   */
+  validate = gimp_tile_handler_validate_get_assigned (gradient_map);
+
+  if (validate)
+    {
+      cairo_region_t *region;
+      gint            n_rects;
+      gint            i;
+
+      region = cairo_region_copy (validate->dirty_region);
+      cairo_region_intersect_rectangle (region,
+                                        (cairo_rectangle_int_t *) &area);
+
+      n_rects = cairo_region_num_rectangles (region);
+
+      for (i = 0; i < n_rects; i++)
+        {
+          cairo_rectangle_int_t rect;
+
+          cairo_region_get_rectangle (region, i, &rect);
+
+          gimp_tile_handler_validate_validate_parallel (
+            validate, gradient_map, (const GeglRectangle *) &rect);
+        }
+
+      cairo_region_destroy (region);
+    }
+
+  n_pixels = area.width * area.height;
+
+  livewire = g_slice_new0 (ILivewire);
+
+  livewire->seed_x   = seed_x;
+  livewire->seed_y   = seed_y;
+  livewire->area     = area;
+  livewire->gradient = g_new (guint8, n_pixels * COST_WIDTH);
+  livewire->cost     = g_new (guint32, n_pixels);
+  livewire->link     = g_new (guint8, n_pixels);
+  livewire->settled  = g_new0 (guint8, n_pixels);
+  livewire->heap     = g_array_sized_new (FALSE, FALSE,
+                                          sizeof (ILivewireNode), 1024);
+
+  gegl_buffer_get (gradient_map, &area, 1.0,
+                   gegl_buffer_get_format (gradient_map),
+                   livewire->gradient,
+                   area.width * COST_WIDTH, GEGL_ABYSS_NONE);
+
+  memset (livewire->cost, 0xff, n_pixels * sizeof (guint32));
+  memset (livewire->link, LIVEWIRE_NO_LINK, n_pixels);
+
+  seed = (seed_y - area.y) * area.width + (seed_x - area.x);
+
+  livewire->cost[seed] = 0;
+  livewire->link[seed] = SEED_POINT;
+
+  ilivewire_heap_push (livewire->heap, 0, seed);
+
+  livewire->idle_id = g_idle_add_full (G_PRIORITY_LOW,
+                                       (GSourceFunc) ilivewire_idle,
+                                       livewire, NULL);
+
+  return livewire;
+}
+
+static void
+ilivewire_free (ILivewire *livewire)
+{
+  if (livewire->idle_id)
+    g_source_remove (livewire->idle_id);
+
+  g_free (livewire->gradient);
+  g_free (livewire->cost);
+  g_free (livewire->link);
+  g_free (livewire->settled);
+  g_array_free (livewire->heap, TRUE);
+
+  g_slice_free (ILivewire, livewire);
+}
+
+/*  the cost of reaching (x, y) from its neighbor in direction 'back',
+ *  the same as calculate_link() for that neighbor
+ */
+static inline gint
+ilivewire_link_cost (ILivewire *livewire,
+                     gint       x,
+                     gint       y,
+                     gint       back)
+{
+  const GeglRectangle *area  = &livewire->area;
+  const guint8        *grad  = livewire->gradient;
+  gint                 link  = back & 3;
+  gint                 value = 0;
+  gint                 index;
+  guint8               grad1, dir1, dir2;
+
+  index = (y - area->y) * area->width + (x - area->x);
+  grad1 = 255 - grad[index * COST_WIDTH];
+  dir1  = grad[index * COST_WIDTH + 1];
+
+  if (link > 1)
+    value += diagonal_weight[grad1] * OMEGA_G;
+  else
+    value += grad1 * OMEGA_G;
+
+  index += move[back][1] * area->width + move[back][0];
+  dir2   = grad[index * COST_WIDTH + 1];
+
+  value +=
+    (direction_value[dir1][link] + direction_value[dir2][link]) * OMEGA_D;
+
+  return value;
+}
+
+/*  settles at most 'max_steps' pixels, stopping early once 'target'
+ *  is settled.  Returns FALSE if the whole window is settled.
+ */
+static gboolean
+ilivewire_grow (ILivewire *livewire,
+                gint       max_steps,
+                gint       target)
+{
+  const GeglRectangle *area = &livewire->area;
+
+  while (livewire->heap->len > 0 && max_steps-- > 0)
+    {
+      ILivewireNode node = ilivewire_heap_pop (livewire->heap);
+      gint          x, y;
+      gint          k;
+
+      /*  skip stale entries, superseded by a cheaper one  */
+      if (livewire->settled[node.index] ||
+          node.cost != livewire->cost[node.index])
+        {
+          max_steps++;
+          continue;
+        }
+
+      livewire->settled[node.index] = TRUE;
+
+      x = area->x + node.index % area->width;
+      y = area->y + node.index / area->width;
+
+      for (k = 0; k < 8; k++)
+        {
+          gint    nx = x + move[k][0];
+          gint    ny = y + move[k][1];
+          gint    back;
+          gint    index;
+          guint32 cost;
+
+          if (nx <  area->x || nx >= area->x + area->width ||
+              ny <  area->y || ny >= area->y + area->height)
+            continue;
+
+          index = (ny - area->y) * area->width + (nx - area->x);
+
+          if (livewire->settled[index])
+            continue;
+
+          back = (k > 3) ? k - 4 : k + 4;
+          cost = node.cost + ilivewire_link_cost (livewire, nx, ny, back);
+
+          if (cost < livewire->cost[index])
+            {
+              livewire->cost[index] = cost;
+              livewire->link[index] = back;
+
+              ilivewire_heap_push (livewire->heap, cost, index);
+            }
+        }
+
+      if (node.index == target)
+        break;
+    }
+
+  return livewire->heap->len > 0;
+}
+
+static gboolean
+ilivewire_idle (ILivewire *livewire)
+{
+  if (ilivewire_grow (livewire, LIVEWIRE_STEPS, -1))
+    return G_SOURCE_CONTINUE;
+
+  livewire->idle_id = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+/*  returns the points from (x, y) back to the seed, in the same order
+ *  as plot_pixels(), or NULL if (x, y) is outside the window
+ */
+static GPtrArray *
+ilivewire_get_path (ILivewire *livewire,
+                    gint       x,
+                    gint       y)
+{
+  const GeglRectangle *area = &livewire->area;
+  GPtrArray           *list;
+  gint                 index;
+
+  if (x <  area->x || x >= area->x + area->width ||
+      y <  area->y || y >= area->y + area->height)
+    return NULL;
+
+  index = (y - area->y) * area->width + (x - area->x);
+
+  if (! livewire->settled[index])
+    ilivewire_grow (livewire, G_MAXINT, index);
+
+  if (livewire->link[index] == LIVEWIRE_NO_LINK)
+    return NULL;
+
+  list = g_ptr_array_new ();
+
+  while (TRUE)
+    {
+      gint link = livewire->link[index];
+
+      g_ptr_array_add (list, GINT_TO_POINTER ((y << 16) + x));
+
+      if (link == SEED_POINT)
+        return list;
+
+      x     += move[link][0];
+      y     += move[link][1];
+      index += move[link][1] * area->width + move[link][0];
+    }
+}
+
 static GeglBuffer *
 gradient_map_new (GimpPickable *pickable)
 {
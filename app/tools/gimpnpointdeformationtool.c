@@ -60,8 +60,11 @@
 //#define GIMP_NPD_DEBUG
 #define GIMP_NPD_MAXIMUM_DEFORMATION_DELAY 100000 /* 100000 microseconds == 10 FPS */
 #define GIMP_NPD_DRAW_INTERVAL                 50 /*     50 milliseconds == 20 FPS */
+#define GIMP_NPD_SETTLE_ITERATIONS             30 /* iterations to run after a change */
 
 
+static void     gimp_n_point_deformation_tool_finalize                (GObject                   *object);
+
 static void     gimp_n_point_deformation_tool_start                   (GimpNPointDeformationTool *npd_tool,
                                                                        GimpDisplay               *display);
 static void     gimp_n_point_deformation_tool_halt                    (GimpNPointDeformationTool *npd_tool);
@@ -125,6 +128,7 @@ static void     gimp_n_point_deformation_tool_remove_cp_from_selection
                                                                       (GimpNPointDeformationTool *npd_tool,
                                                                        NPDControlPoint           *cp);
 static gpointer gimp_n_point_deformation_tool_deform_thread_func      (gpointer                   data);
+static void     gimp_n_point_deformation_tool_queue_deformation       (GimpNPointDeformationTool *npd_tool);
 static gboolean gimp_n_point_deformation_tool_canvas_update_timeout   (GimpNPointDeformationTool *npd_tool);
 static void     gimp_n_point_deformation_tool_perform_deformation     (GimpNPointDeformationTool *npd_tool);
 static void     gimp_n_point_deformation_tool_halt_threads            (GimpNPointDeformationTool *npd_tool);
@@ -167,9 +171,12 @@ gimp_n_point_deformation_tool_register (GimpToolRegisterCallback  callback,
 static void
 gimp_n_point_deformation_tool_class_init (GimpNPointDeformationToolClass *klass)
 {
+  GObjectClass      *object_class    = G_OBJECT_CLASS (klass);
   GimpToolClass     *tool_class      = GIMP_TOOL_CLASS (klass);
   GimpDrawToolClass *draw_tool_class = GIMP_DRAW_TOOL_CLASS (klass);
 
+  object_class->finalize     = gimp_n_point_deformation_tool_finalize;
+
   tool_class->options_notify = gimp_n_point_deformation_tool_options_notify;
   tool_class->button_press   = gimp_n_point_deformation_tool_button_press;
   tool_class->button_release = gimp_n_point_deformation_tool_button_release;
@@ -202,6 +209,20 @@ gimp_n_point_deformation_tool_init (GimpNPointDeformationTool *npd_tool)
                                               GIMP_DIRTY_DRAWABLE        |
                                               GIMP_DIRTY_SELECTION       |
                                               GIMP_DIRTY_ACTIVE_DRAWABLE);
+
+  g_mutex_init (&npd_tool->deform_mutex);
+  g_cond_init (&npd_tool->deform_cond);
+}
+
+static void
+gimp_n_point_deformation_tool_finalize (GObject *object)
+{
+  GimpNPointDeformationTool *npd_tool = GIMP_N_POINT_DEFORMATION_TOOL (object);
+
+  g_mutex_clear (&npd_tool->deform_mutex);
+  g_cond_clear (&npd_tool->deform_cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
 static void
@@ -308,7 +329,14 @@ gimp_n_point_deformation_tool_start (GimpNPointDeformationTool *npd_tool,
   gimp_item_set_visible (GIMP_ITEM (tool->drawables->data), FALSE, FALSE);
   gimp_image_flush (image);
 
-  /* create and start a deformation thread */
+  /* create and start a deformation thread, which sleeps until there
+   * is something to deform
+   */
+  npd_tool->deformation_active = TRUE;
+  npd_tool->deform_pending     = 0;
+  npd_tool->deform_serial      = 0;
+  npd_tool->drawn_serial       = 0;
+
   npd_tool->deform_thread =
     g_thread_new ("deform thread",
                   (GThreadFunc) gimp_n_point_deformation_tool_deform_thread_func,
@@ -416,6 +444,7 @@ gimp_n_point_deformation_tool_options_notify (GimpTool         *tool,
 
   gimp_npd_debug (("npd options notify\n"));
   gimp_n_point_deformation_tool_set_options (npd_tool, npd_options);
+  gimp_n_point_deformation_tool_queue_deformation (npd_tool);
 
   gimp_draw_tool_resume (draw_tool);
 }
@@ -444,6 +473,7 @@ gimp_n_point_deformation_tool_key_press (GimpTool    *tool,
           gimp_npd_debug (("removing last cp %p\n", cp));
           gimp_n_point_deformation_tool_remove_cp_from_selection (npd_tool, cp);
           npd_remove_control_point (npd_tool->model, cp);
+          gimp_n_point_deformation_tool_queue_deformation (npd_tool);
         }
       break;
 
@@ -454,6 +484,7 @@ gimp_n_point_deformation_tool_key_press (GimpTool    *tool,
           /* if there is at least one selected control point, remove it */
           npd_remove_control_points (npd_tool->model, npd_tool->selected_cps);
           gimp_n_point_deformation_tool_clear_selected_points_list (npd_tool);
+          gimp_n_point_deformation_tool_queue_deformation (npd_tool);
         }
       break;
 
@@ -645,6 +676,7 @@ gimp_n_point_deformation_tool_button_release (GimpTool              *tool,
           p.y = coords->y - npd_tool->offset_y;
 
           npd_add_control_point (npd_tool->model, &p);
+          gimp_n_point_deformation_tool_queue_deformation (npd_tool);
         }
     }
   else if (release_type == GIMP_BUTTON_RELEASE_NORMAL)
@@ -875,6 +907,8 @@ gimp_n_point_deformation_tool_motion (GimpTool         *tool,
           cp->point.x += shift_x;
           cp->point.y += shift_y;
         }
+
+      gimp_n_point_deformation_tool_queue_deformation (npd_tool);
     }
   else
     {
@@ -897,6 +931,12 @@ gimp_n_point_deformation_tool_canvas_update_timeout (GimpNPointDeformationTool *
   if (! GIMP_TOOL (npd_tool)->drawables->data)
     return FALSE;
 
+  /* only redraw once the deformation thread has a new result */
+  if (g_atomic_int_get (&npd_tool->deform_serial) == npd_tool->drawn_serial)
+    return TRUE;
+
+  npd_tool->drawn_serial = g_atomic_int_get (&npd_tool->deform_serial);
+
   gimp_npd_debug (("canvas update thread\n"));
 
   gimp_draw_tool_pause (GIMP_DRAW_TOOL(npd_tool));
@@ -916,10 +956,24 @@ gimp_n_point_deformation_tool_deform_thread_func (gpointer data)
 
   npd_options = GIMP_N_POINT_DEFORMATION_TOOL_GET_OPTIONS (npd_tool);
 
-  npd_tool->deformation_active = TRUE;
-
-  while (npd_tool->deformation_active)
+  while (TRUE)
     {
+      g_mutex_lock (&npd_tool->deform_mutex);
+
+      while (npd_tool->deformation_active && ! npd_tool->deform_pending)
+        g_cond_wait (&npd_tool->deform_cond, &npd_tool->deform_mutex);
+
+      if (! npd_tool->deformation_active)
+        {
+          g_mutex_unlock (&npd_tool->deform_mutex);
+
+          break;
+        }
+
+      npd_tool->deform_pending--;
+
+      g_mutex_unlock (&npd_tool->deform_mutex);
+
       start = g_get_monotonic_time ();
 
       gimp_n_point_deformation_tool_perform_deformation (npd_tool);
@@ -927,6 +981,8 @@ gimp_n_point_deformation_tool_deform_thread_func (gpointer data)
       if (npd_options->mesh_visible)
         gimp_n_point_deformation_tool_prepare_lattice (npd_tool);
 
+      g_atomic_int_inc (&npd_tool->deform_serial);
+
       duration = g_get_monotonic_time () - start;
       if (duration < GIMP_NPD_MAXIMUM_DEFORMATION_DELAY)
         {
@@ -939,6 +995,20 @@ gimp_n_point_deformation_tool_deform_thread_func (gpointer data)
   return NULL;
 }
 
+/*  makes the deformation thread run a few more iterations, so that the
+ *  deformation settles after control points were changed
+ */
+static void
+gimp_n_point_deformation_tool_queue_deformation (GimpNPointDeformationTool *npd_tool)
+{
+  g_mutex_lock (&npd_tool->deform_mutex);
+
+  npd_tool->deform_pending = GIMP_NPD_SETTLE_ITERATIONS;
+  g_cond_signal (&npd_tool->deform_cond);
+
+  g_mutex_unlock (&npd_tool->deform_mutex);
+}
+
 static void
 gimp_n_point_deformation_tool_perform_deformation (GimpNPointDeformationTool *npd_tool)
 {
@@ -962,7 +1032,13 @@ gimp_n_point_deformation_tool_halt_threads (GimpNPointDeformationTool *npd_tool)
     return;
 
   gimp_npd_debug (("waiting for deform thread to finish\n"));
+
+  g_mutex_lock (&npd_tool->deform_mutex);
+
   npd_tool->deformation_active = FALSE;
+  g_cond_signal (&npd_tool->deform_cond);
+
+  g_mutex_unlock (&npd_tool->deform_mutex);
 
   /* wait for deformation thread to finish its work */
   if (npd_tool->deform_thread)
@@ -42,6 +42,11 @@ struct _GimpNPointDeformationTool
 
   guint             draw_timeout_id;
   GThread          *deform_thread;
+  GMutex            deform_mutex;
+  GCond             deform_cond;
+  gint              deform_pending;  /* iterations left to run       */
+  gint              deform_serial;   /* number of finished iterations */
+  gint              drawn_serial;
 
   GeglNode         *graph;
   GeglNode         *source;
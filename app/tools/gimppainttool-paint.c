@@ -24,11 +24,14 @@
 
 #include "tools-types.h"
 
+#include "core/gimp-input-latency.h"
+#include "core/gimp-parallel.h"
 #include "core/gimpdrawable.h"
 #include "core/gimpimage.h"
 #include "core/gimplayer.h"
 #include "core/gimplayermask.h"
 #include "core/gimpprojection.h"
+#include "core/gimptoolinfo.h"
 
 #include "paint/gimppaintcore.h"
 #include "paint/gimppaintoptions.h"
@@ -64,6 +67,7 @@ typedef struct
   GList        *drawables;
   GimpCoords    coords;
   guint32       time;
+  gint64        event_time;
 } InterpolateData;
 
 
@@ -146,6 +150,9 @@ gimp_paint_tool_paint_thread (gpointer data)
           while (paint_timeout_pending)
             g_cond_wait (&paint_cond, &paint_mutex);
 
+          /*  painting is as interactive as it gets  */
+          gimp_parallel_place_current_thread (-1);
+
           item->func (item->paint_tool, item->data);
 
           g_mutex_unlock (&paint_mutex);
@@ -183,6 +190,10 @@ gimp_paint_tool_paint_timeout (GimpPaintTool *paint_tool)
   if (update && GIMP_PAINT_TOOL_GET_CLASS (paint_tool)->paint_flush)
     GIMP_PAINT_TOOL_GET_CLASS (paint_tool)->paint_flush (paint_tool);
 
+  /*  the paint thread is held, so everything painted so far is flushed  */
+  if (update)
+    gimp_input_latency_flushed ();
+
   paint_timeout_pending = FALSE;
   g_cond_signal (&paint_cond);
 
@@ -217,6 +228,10 @@ gimp_paint_tool_paint_interpolate (GimpPaintTool   *paint_tool,
   gimp_paint_core_interpolate (core, data->drawables, paint_options,
                                &data->coords, data->time);
 
+  gimp_input_latency_painted (
+    gimp_object_get_name (GIMP_TOOL (paint_tool)->tool_info),
+    data->event_time);
+
   /* Blink the lock box if required */
   if (core->lock_blink_state == GIMP_PAINT_LOCK_BLINK_PENDING)
     {
@@ -283,6 +298,9 @@ gimp_paint_tool_paint_start (GimpPaintTool     *paint_tool,
 
   curr_coords = *coords;
 
+  /*  drop the events which reached the canvas before the stroke  */
+  gimp_input_latency_take_event ();
+
   paint_tool->paint_x = curr_coords.x;
   paint_tool->paint_y = curr_coords.y;
 
@@ -520,6 +538,8 @@ gimp_paint_tool_paint_push (GimpPaintTool          *paint_tool,
 
       func (paint_tool, data);
 
+      gimp_input_latency_flushed ();
+
       gimp_projection_flush_now (gimp_image_get_projection (image), TRUE);
       gimp_display_flush_now (display);
 
@@ -547,9 +567,10 @@ gimp_paint_tool_paint_motion (GimpPaintTool    *paint_tool,
 
   data = g_slice_new (InterpolateData);
 
-  data->drawables = g_list_copy (drawables);
-  data->coords    = *coords;
-  data->time      = time;
+  data->drawables  = g_list_copy (drawables);
+  data->coords     = *coords;
+  data->time       = time;
+  data->event_time = gimp_input_latency_take_event ();
 
   paint_tool->cursor_x = data->coords.x;
   paint_tool->cursor_y = data->coords.y;
@@ -168,7 +168,8 @@ static void       gimp_seamless_clone_tool_create_filter      (GimpSeamlessClone
                                                                GimpDrawable          *drawable);
 static void       gimp_seamless_clone_tool_filter_flush       (GimpDrawableFilter     *filter,
                                                                GimpTool              *tool);
-static void       gimp_seamless_clone_tool_filter_update      (GimpSeamlessCloneTool *sc);
+static void       gimp_seamless_clone_tool_filter_update      (GimpSeamlessCloneTool *sc,
+                                                               gboolean               wait);
 
 
 G_DEFINE_TYPE (GimpSeamlessCloneTool, gimp_seamless_clone_tool,
@@ -231,6 +232,10 @@ gimp_seamless_clone_tool_init (GimpSeamlessCloneTool *self)
                                      GIMP_TOOL_CURSOR_MOVE);
 
   self->tool_state = SC_STATE_INIT;
+
+  self->rendered_xoff             = G_MAXINT;
+  self->rendered_yoff             = G_MAXINT;
+  self->rendered_max_refine_scale = -1;
 }
 
 static void
@@ -365,6 +370,10 @@ gimp_seamless_clone_tool_stop (GimpSeamlessCloneTool *sc,
       g_clear_object (&sc->paste);
       g_clear_object (&sc->render_node);
       sc->sc_node = NULL;
+
+      sc->rendered_xoff             = G_MAXINT;
+      sc->rendered_yoff             = G_MAXINT;
+      sc->rendered_max_refine_scale = -1;
     }
 
   /* This should always happen, even when we just switch a display */
@@ -438,7 +447,7 @@ gimp_seamless_clone_tool_button_press (GimpTool            *tool,
       gimp_draw_tool_resume (GIMP_DRAW_TOOL (tool));
 
       if (gimp_seamless_clone_tool_render_node_update (sc))
-        gimp_seamless_clone_tool_filter_update (sc);
+        gimp_seamless_clone_tool_filter_update (sc, TRUE);
 
       sc->tool_state = SC_STATE_RENDER_MOTION;
 
@@ -480,7 +489,7 @@ gimp_seamless_clone_tool_button_release (GimpTool              *tool,
       gimp_draw_tool_resume (GIMP_DRAW_TOOL (tool));
 
       if (gimp_seamless_clone_tool_render_node_update (sc))
-        gimp_seamless_clone_tool_filter_update (sc);
+        gimp_seamless_clone_tool_filter_update (sc, TRUE);
 
       sc->tool_state = SC_STATE_RENDER_WAIT;
     }
@@ -504,8 +513,11 @@ gimp_seamless_clone_tool_motion (GimpTool         *tool,
 
       gimp_draw_tool_resume (GIMP_DRAW_TOOL (tool));
 
+      /* don't wait for the whole paste to be rendered while it is
+       * dragged, the projection renders the visible part in chunks
+       */
       if (gimp_seamless_clone_tool_render_node_update (sc))
-        gimp_seamless_clone_tool_filter_update (sc);
+        gimp_seamless_clone_tool_filter_update (sc, FALSE);
     }
 }
 
@@ -619,7 +631,7 @@ gimp_seamless_clone_tool_options_notify (GimpTool         *tool,
   if (! strcmp (pspec->name, "max-refine-scale"))
     {
       if (gimp_seamless_clone_tool_render_node_update (sc))
-        gimp_seamless_clone_tool_filter_update (sc);
+        gimp_seamless_clone_tool_filter_update (sc, TRUE);
     }
 
   gimp_draw_tool_resume (GIMP_DRAW_TOOL (tool));
@@ -719,19 +731,15 @@ gimp_seamless_clone_tool_create_render_node (GimpSeamlessCloneTool *sc)
 static gboolean
 gimp_seamless_clone_tool_render_node_update (GimpSeamlessCloneTool *sc)
 {
-  static gint rendered__max_refine_scale = -1;
-  static gint rendered_xoff              = G_MAXINT;
-  static gint rendered_yoff              = G_MAXINT;
-
   GimpSeamlessCloneOptions *options = GIMP_SEAMLESS_CLONE_TOOL_GET_OPTIONS (sc);
   GimpDrawable             *bg      = GIMP_TOOL (sc)->drawables->data;
   gint                      off_x;
   gint                      off_y;
 
   /* All properties stay the same. No need to update. */
-  if (rendered__max_refine_scale == options->max_refine_scale &&
-      rendered_xoff == sc->xoff                               &&
-      rendered_yoff == sc->yoff)
+  if (sc->rendered_max_refine_scale == options->max_refine_scale &&
+      sc->rendered_xoff             == sc->xoff                  &&
+      sc->rendered_yoff             == sc->yoff)
     return FALSE;
 
   gimp_item_get_offset (GIMP_ITEM (bg), &off_x, &off_y);
@@ -742,9 +750,9 @@ gimp_seamless_clone_tool_render_node_update (GimpSeamlessCloneTool *sc)
                  "max-refine-scale", (gint) options->max_refine_scale,
                  NULL);
 
-  rendered__max_refine_scale = options->max_refine_scale;
-  rendered_xoff              = sc->xoff;
-  rendered_yoff              = sc->yoff;
+  sc->rendered_max_refine_scale = options->max_refine_scale;
+  sc->rendered_xoff             = sc->xoff;
+  sc->rendered_yoff             = sc->yoff;
 
   return TRUE;
 }
@@ -779,7 +787,8 @@ gimp_seamless_clone_tool_filter_flush (GimpDrawableFilter *filter,
 }
 
 static void
-gimp_seamless_clone_tool_filter_update (GimpSeamlessCloneTool *sc)
+gimp_seamless_clone_tool_filter_update (GimpSeamlessCloneTool *sc,
+                                        gboolean               wait)
 {
   GimpTool         *tool  = GIMP_TOOL (sc);
   GimpDisplayShell *shell = gimp_display_get_shell (tool->display);
@@ -795,9 +804,6 @@ gimp_seamless_clone_tool_filter_update (GimpSeamlessCloneTool *sc)
   GeglProcessor    *processor;
   gdouble           value;
 
-  progress = gimp_progress_start (GIMP_PROGRESS (sc), FALSE,
-                                  _("Cloning the foreground object"));
-
   /* Find out at which x,y is the top left corner of the currently
    * displayed part */
   gimp_display_shell_untransform_viewport (shell, ! shell->show_all,
@@ -836,7 +842,13 @@ gimp_seamless_clone_tool_filter_update (GimpSeamlessCloneTool *sc)
   /* Now update the image map and show this area */
   gimp_drawable_filter_apply (sc->filter, NULL);
 
+  if (! wait)
+    return;
+
   /* Show update progress. */
+  progress = gimp_progress_start (GIMP_PROGRESS (sc), FALSE,
+                                  _("Cloning the foreground object"));
+
   output = gegl_node_get_output_proxy (sc->render_node, "output");
   processor = gegl_node_new_processor (output, NULL);
 
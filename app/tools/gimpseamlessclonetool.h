@@ -63,6 +63,10 @@ struct _GimpSeamlessCloneTool
   gint xoff, yoff;                /* The current offset of the paste */
   gint xoff_p, yoff_p;            /* The previous offset of the paste */
 
+  gint rendered_xoff;             /* The offset and refine scale last */
+  gint rendered_yoff;             /* set on sc_node                   */
+  gint rendered_max_refine_scale;
+
   gdouble xclick, yclick;         /* The image location of the last
                                    * mouse click. To be used when the
                                    * mouse is in motion, to recalculate
@@ -51,11 +51,15 @@ static void   gimp_tile_handler_iscissors_get_property (GObject         *object,
                                                         GValue          *value,
                                                         GParamSpec      *pspec);
 
-static void   gimp_tile_handler_iscissors_validate     (GimpTileHandlerValidate *validate,
-                                                        const GeglRectangle     *rect,
-                                                        const Babl              *format,
-                                                        gpointer                 dest_buf,
-                                                        gint                     dest_stride);
+static void   gimp_tile_handler_iscissors_begin_validate  (GimpTileHandlerValidate *validate);
+static void   gimp_tile_handler_iscissors_validate        (GimpTileHandlerValidate *validate,
+                                                           const GeglRectangle     *rect,
+                                                           const Babl              *format,
+                                                           gpointer                 dest_buf,
+                                                           gint                     dest_stride);
+static void   gimp_tile_handler_iscissors_validate_buffer (GimpTileHandlerValidate *validate,
+                                                           const GeglRectangle     *rect,
+                                                           GeglBuffer              *buffer);
 
 
 G_DEFINE_TYPE (GimpTileHandlerIscissors, gimp_tile_handler_iscissors,
@@ -76,7 +80,9 @@ gimp_tile_handler_iscissors_class_init (GimpTileHandlerIscissorsClass *klass)
   object_class->set_property = gimp_tile_handler_iscissors_set_property;
   object_class->get_property = gimp_tile_handler_iscissors_get_property;
 
-  validate_class->validate   = gimp_tile_handler_iscissors_validate;
+  validate_class->begin_validate  = gimp_tile_handler_iscissors_begin_validate;
+  validate_class->validate        = gimp_tile_handler_iscissors_validate;
+  validate_class->validate_buffer = gimp_tile_handler_iscissors_validate_buffer;
 
   g_object_class_install_property (object_class, PROP_PICKABLE,
                                    g_param_spec_object ("pickable", NULL, NULL,
@@ -169,6 +175,19 @@ static const gfloat blur_32[9] =
 #define  MIN_GRADIENT  63      /* gradients < this are directionless */
 #define  COST_WIDTH     2      /* number of bytes for each pixel in cost map */
 
+static void
+gimp_tile_handler_iscissors_begin_validate (GimpTileHandlerValidate *validate)
+{
+  GimpTileHandlerIscissors *iscissors = GIMP_TILE_HANDLER_ISCISSORS (validate);
+
+  GIMP_TILE_HANDLER_VALIDATE_CLASS (parent_class)->begin_validate (validate);
+
+  /*  flush once here, rather than for every tile, which also keeps
+   *  validate() free of main-thread-only calls
+   */
+  gimp_pickable_flush (iscissors->pickable);
+}
+
 static void
 gimp_tile_handler_iscissors_validate (GimpTileHandlerValidate *validate,
                                       const GeglRectangle     *rect,
@@ -197,8 +216,6 @@ gimp_tile_handler_iscissors_validate (GimpTileHandlerValidate *validate,
               rect->height);
 #endif
 
-  gimp_pickable_flush (iscissors->pickable);
-
   src = gimp_pickable_get_buffer (iscissors->pickable);
 
   temp0 = gegl_buffer_new (GEGL_RECTANGLE (0, 0,
@@ -320,6 +337,39 @@ gimp_tile_handler_iscissors_validate (GimpTileHandlerValidate *validate,
   g_object_unref (temp2);
 }
 
+/*  called concurrently by gimp_tile_handler_validate_validate_parallel(),
+ *  so render to a private buffer.  validate() leaves the outermost pixels
+ *  of 'rect' without a gradient, so render one more pixel on each side,
+ *  to not leave seams between the pieces of the area.
+ */
+static void
+gimp_tile_handler_iscissors_validate_buffer (GimpTileHandlerValidate *validate,
+                                             const GeglRectangle     *rect,
+                                             GeglBuffer              *buffer)
+{
+  GeglRectangle  border_rect;
+  gint           stride;
+  guint8        *data;
+
+  border_rect = *rect;
+
+  border_rect.x      -= 1;
+  border_rect.y      -= 1;
+  border_rect.width  += 2;
+  border_rect.height += 2;
+
+  stride = border_rect.width * COST_WIDTH;
+  data   = g_malloc (stride * border_rect.height);
+
+  gimp_tile_handler_iscissors_validate (validate, &border_rect,
+                                        validate->format, data, stride);
+
+  gegl_buffer_set (buffer, rect, 0, validate->format,
+                   data + stride + COST_WIDTH, stride);
+
+  g_free (data);
+}
+
 GeglTileHandler *
 gimp_tile_handler_iscissors_new (GimpPickable *pickable)
 {
@@ -48,6 +48,7 @@ enum
   PROP_ABYSS_POLICY,
   PROP_HIGH_QUALITY_PREVIEW,
   PROP_REAL_TIME_PREVIEW,
+  PROP_BAKE_STROKES,
   PROP_STROKE_DURING_MOTION,
   PROP_STROKE_PERIODICALLY,
   PROP_STROKE_PERIODICALLY_RATE,
@@ -145,6 +146,15 @@ gimp_warp_options_class_init (GimpWarpOptionsClass *klass)
                             FALSE,
                             GIMP_PARAM_STATIC_STRINGS);
 
+  GIMP_CONFIG_PROP_BOOLEAN (object_class, PROP_BAKE_STROKES,
+                            "bake-strokes",
+                            _("Bake strokes"),
+                            _("Accumulate finished strokes into a single "
+                              "displacement buffer, so that rendering "
+                              "doesn't get slower with each stroke"),
+                            FALSE,
+                            GIMP_PARAM_STATIC_STRINGS);
+
   GIMP_CONFIG_PROP_BOOLEAN (object_class, PROP_STROKE_DURING_MOTION,
                             "stroke-during-motion",
                             _("During motion"),
@@ -216,6 +226,9 @@ gimp_warp_options_set_property (GObject      *object,
     case PROP_REAL_TIME_PREVIEW:
       options->real_time_preview = g_value_get_boolean (value);
       break;
+    case PROP_BAKE_STROKES:
+      options->bake_strokes = g_value_get_boolean (value);
+      break;
     case PROP_STROKE_DURING_MOTION:
       options->stroke_during_motion = g_value_get_boolean (value);
       break;
@@ -272,6 +285,9 @@ gimp_warp_options_get_property (GObject    *object,
     case PROP_REAL_TIME_PREVIEW:
       g_value_set_boolean (value, options->real_time_preview);
       break;
+    case PROP_BAKE_STROKES:
+      g_value_set_boolean (value, options->bake_strokes);
+      break;
     case PROP_STROKE_DURING_MOTION:
       g_value_set_boolean (value, options->stroke_during_motion);
       break;
@@ -346,6 +362,9 @@ gimp_warp_options_gui (GimpToolOptions *tool_options)
   button = gimp_prop_check_button_new (config, "real-time-preview", NULL);
   gtk_box_pack_start (GTK_BOX (vbox), button, FALSE, FALSE, 0);
 
+  button = gimp_prop_check_button_new (config, "bake-strokes", NULL);
+  gtk_box_pack_start (GTK_BOX (vbox), button, FALSE, FALSE, 0);
+
   /*  the stroke frame  */
   frame = gimp_frame_new (_("Stroke"));
   gtk_box_pack_start (GTK_BOX (vbox), frame, FALSE, FALSE, 0);
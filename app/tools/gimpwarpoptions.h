@@ -46,6 +46,7 @@ struct _GimpWarpOptions
   GeglAbyssPolicy        abyss_policy;
   gboolean               high_quality_preview;
   gboolean               real_time_preview;
+  gboolean               bake_strokes;
 
   gboolean               stroke_during_motion;
   gboolean               stroke_periodically;
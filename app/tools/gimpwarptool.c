@@ -152,6 +152,9 @@ static void            gimp_warp_tool_stroke_append             (GimpWarpTool
                                                                  gdouble                y);
 static void            gimp_warp_tool_filter_flush              (GimpDrawableFilter    *filter,
                                                                  GimpTool              *tool);
+static GeglNode      * gimp_warp_tool_get_stroke                (GeglNode              *node);
+static GeglNode      * gimp_warp_tool_bake_stroke               (GimpWarpTool          *wt,
+                                                                 GeglNode              *stroke);
 static void            gimp_warp_tool_add_op                    (GimpWarpTool          *wt,
                                                                  GeglNode              *op);
 static void            gimp_warp_tool_remove_op                 (GimpWarpTool          *wt,
@@ -592,15 +595,14 @@ gimp_warp_tool_can_undo (GimpTool    *tool,
 {
   GimpWarpTool *wt = GIMP_WARP_TOOL (tool);
   GeglNode     *to_delete;
-  const gchar  *type;
 
   if (! wt->render_node)
     return NULL;
 
   to_delete = gegl_node_get_producer (wt->render_node, "aux", NULL);
-  type = gegl_node_get_operation (to_delete);
+  to_delete = gimp_warp_tool_get_stroke (to_delete);
 
-  if (strcmp (type, "gegl:warp"))
+  if (! to_delete)
     return NULL;
 
   return _("Warp Tool Stroke");
@@ -627,6 +629,7 @@ gimp_warp_tool_undo (GimpTool    *tool,
   GeglNode     *prev_node;
 
   to_delete = gegl_node_get_producer (wt->render_node, "aux", NULL);
+  to_delete = gimp_warp_tool_get_stroke (to_delete);
 
   wt->redo_stack = g_list_prepend (wt->redo_stack, to_delete);
 
@@ -1171,7 +1174,9 @@ gimp_warp_tool_get_node_bounds (GeglNode *node)
 {
   GeglRectangle *bounds;
 
-  if (! node || strcmp (gegl_node_get_operation (node), "gegl:warp"))
+  node = gimp_warp_tool_get_stroke (node);
+
+  if (! node)
     return *GEGL_RECTANGLE (0, 0, 0, 0);
 
   bounds = g_object_get_data (G_OBJECT (node), "gimp-warp-tool-bounds");
@@ -1378,11 +1383,78 @@ gimp_warp_tool_filter_flush (GimpDrawableFilter *filter,
   gimp_projection_flush (gimp_image_get_projection (image));
 }
 
+/* returns the gegl:warp node of a stroke, given either the stroke's
+ * node itself, or the buffer source it was baked into, and NULL
+ * otherwise
+ */
+static GeglNode *
+gimp_warp_tool_get_stroke (GeglNode *node)
+{
+  if (! node)
+    return NULL;
+
+  if (! strcmp (gegl_node_get_operation (node), "gegl:warp"))
+    return node;
+
+  return g_object_get_data (G_OBJECT (node), "gimp-warp-tool-stroke");
+}
+
+/* renders the displacement after 'stroke' into a buffer source, so that
+ * following strokes don't re-evaluate the stroke stack.  'stroke' stays
+ * in the graph, and is found from the buffer source by
+ * gimp_warp_tool_get_stroke(), for undo.
+ */
+static GeglNode *
+gimp_warp_tool_bake_stroke (GimpWarpTool *wt,
+                            GeglNode     *stroke)
+{
+  GeglNode      *input;
+  GeglNode      *baked;
+  GeglBuffer    *base = NULL;
+  GeglBuffer    *buffer;
+  GeglRectangle  rect;
+
+  input = gegl_node_get_producer (stroke, "input", NULL);
+
+  if (input && ! strcmp (gegl_node_get_operation (input), "gegl:buffer-source"))
+    gegl_node_get (input, "buffer", &base, NULL);
+
+  /*  on top of an already baked displacement, only the stroke's own
+   *  area changes
+   */
+  if (base)
+    {
+      rect = gimp_warp_tool_get_stroke_bounds (stroke);
+    }
+  else
+    {
+      base = g_object_ref (wt->coords_buffer);
+      rect = gimp_warp_tool_get_node_bounds (stroke);
+    }
+
+  buffer = gegl_buffer_dup (base);
+  g_object_unref (base);
+
+  if (gegl_rectangle_intersect (&rect, &rect, gegl_buffer_get_extent (buffer)))
+    gegl_node_blit_buffer (stroke, buffer, &rect, 0, GEGL_ABYSS_NONE);
+
+  baked = gegl_node_new_child (wt->graph,
+                               "operation", "gegl:buffer-source",
+                               "buffer",    buffer,
+                               NULL);
+  g_object_unref (buffer);
+
+  g_object_set_data (G_OBJECT (baked), "gimp-warp-tool-stroke", stroke);
+
+  return baked;
+}
+
 static void
 gimp_warp_tool_add_op (GimpWarpTool *wt,
                        GeglNode     *op)
 {
-  GeglNode *last_op;
+  GimpWarpOptions *options = GIMP_WARP_TOOL_GET_OPTIONS (wt);
+  GeglNode        *last_op;
 
   g_return_if_fail (GEGL_IS_NODE (wt->render_node));
 
@@ -1390,6 +1462,13 @@ gimp_warp_tool_add_op (GimpWarpTool *wt,
 
   last_op = gegl_node_get_producer (wt->render_node, "aux", NULL);
 
+  if (options->bake_strokes                                    &&
+      ! strcmp (gegl_node_get_operation (op),      "gegl:warp") &&
+      ! strcmp (gegl_node_get_operation (last_op), "gegl:warp"))
+    {
+      last_op = gimp_warp_tool_bake_stroke (wt, last_op);
+    }
+
   gegl_node_disconnect (wt->render_node, "aux");
   gegl_node_link (last_op, op);
   gegl_node_connect (op,              "output",
@@ -122,7 +122,8 @@ gimp_action_group_class_init (GimpActionGroupClass *klass)
 static void
 gimp_action_group_init (GimpActionGroup *group)
 {
-  group->actions = NULL;
+  group->actions         = NULL;
+  group->actions_by_name = g_hash_table_new (g_str_hash, g_str_equal);
 }
 
 static void
@@ -188,6 +189,7 @@ gimp_action_group_dispose (GObject *object)
         }
     }
 
+  g_hash_table_remove_all (group->actions_by_name);
   g_list_free_full (g_steal_pointer (&group->actions), g_object_unref);
 
   G_OBJECT_CLASS (parent_class)->dispose (object);
@@ -198,8 +200,9 @@ gimp_action_group_finalize (GObject *object)
 {
   GimpActionGroup *group = GIMP_ACTION_GROUP (object);
 
-  g_clear_pointer (&group->label,     g_free);
-  g_clear_pointer (&group->icon_name, g_free);
+  g_clear_pointer (&group->label,           g_free);
+  g_clear_pointer (&group->icon_name,       g_free);
+  g_clear_pointer (&group->actions_by_name, g_hash_table_unref);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -382,10 +385,15 @@ gimp_action_group_add_action_with_accel (GimpActionGroup    *group,
 {
   g_return_if_fail (GIMP_IS_ACTION (action));
 
-  if (! g_list_find (group->actions, action))
+  if (g_hash_table_lookup (group->actions_by_name,
+                           gimp_action_get_name (action)) != action)
     {
       group->actions = g_list_prepend (group->actions, g_object_ref (action));
 
+      /*  the name is owned by the action, which the group keeps alive  */
+      g_hash_table_insert (group->actions_by_name,
+                           (gpointer) gimp_action_get_name (action), action);
+
       g_signal_emit_by_name (group, "action-added", gimp_action_get_name (action));
 
       if ((accelerators != NULL && accelerators[0] != NULL &&
@@ -480,8 +488,12 @@ void
 gimp_action_group_remove_action (GimpActionGroup *group,
                                  GimpAction      *action)
 {
-  if (g_list_find (group->actions, action))
+  if (g_hash_table_lookup (group->actions_by_name,
+                           gimp_action_get_name (action)) == action)
     {
+      g_hash_table_remove (group->actions_by_name,
+                           gimp_action_get_name (action));
+
       group->actions = g_list_remove (group->actions, action);
       g_signal_emit_by_name (group, "action-removed", gimp_action_get_name (action));
       g_object_unref (action);
@@ -492,15 +504,10 @@ GimpAction *
 gimp_action_group_get_action (GimpActionGroup *group,
                               const gchar     *action_name)
 {
-  for (GList *iter = group->actions; iter; iter = iter->next)
-    {
-      GimpAction *action = iter->data;
-
-      if (g_strcmp0 (gimp_action_get_name (action), action_name) == 0)
-        return action;
-    }
+  if (! action_name)
+    return NULL;
 
-  return NULL;
+  return g_hash_table_lookup (group->actions_by_name, action_name);
 }
 
 GList *
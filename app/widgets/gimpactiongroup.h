@@ -50,6 +50,7 @@ struct _GimpActionGroup
   GimpActionGroupUpdateFunc  update_func;
 
   GList                     *actions;
+  GHashTable                *actions_by_name;
 };
 
 struct _GimpActionGroupClass
@@ -402,7 +402,7 @@ gimp_blob_editor_draw_blob (GimpBlobEditor *editor,
 
   cairo_close_path (cr);
 
-  g_free (blob);
+  gimp_blob_free (blob);
 
   gtk_style_context_get_color (style, gtk_widget_get_state_flags (widget),
                                &color);
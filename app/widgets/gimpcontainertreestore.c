@@ -39,6 +39,12 @@
 #include "gimpviewrenderer.h"
 
 
+/*  the number of renderers of rows scrolled out of view that are kept
+ *  around for reuse, instead of being destroyed
+ */
+#define MAX_SPARE_RENDERERS 64
+
+
 enum
 {
   PROP_0,
@@ -55,12 +61,19 @@ struct _GimpContainerTreeStorePrivate
   GList             *renderer_cells;
   GList             *renderer_columns;
   gboolean           use_name;
+
+  GHashTable        *renderers;        /*  viewable -> renderer  */
+  GQueue             spare_renderers;
+  GimpViewRenderer  *placeholder;
 };
 
 #define GET_PRIVATE(store) \
         ((GimpContainerTreeStorePrivate *) gimp_container_tree_store_get_instance_private ((GimpContainerTreeStore *) (store)))
 
 
+static void   gimp_container_tree_store_tree_model_iface_init
+                                                        (GtkTreeModelIface      *iface);
+
 static void   gimp_container_tree_store_constructed     (GObject                *object);
 static void   gimp_container_tree_store_finalize        (GObject                *object);
 static void   gimp_container_tree_store_set_property    (GObject                *object,
@@ -72,6 +85,24 @@ static void   gimp_container_tree_store_get_property    (GObject
                                                          GValue                 *value,
                                                          GParamSpec             *pspec);
 
+static void   gimp_container_tree_store_get_value       (GtkTreeModel           *model,
+                                                         GtkTreeIter            *iter,
+                                                         gint                    column,
+                                                         GValue                 *value);
+
+static GimpViewRenderer *
+              gimp_container_tree_store_lookup_renderer (GimpContainerTreeStore *store,
+                                                         GtkTreeIter            *iter,
+                                                         gboolean                create);
+static GimpViewRenderer *
+              gimp_container_tree_store_acquire_renderer
+                                                        (GimpContainerTreeStore *store,
+                                                         GimpViewable           *viewable);
+static void   gimp_container_tree_store_release_renderer
+                                                        (GimpContainerTreeStore *store,
+                                                         GimpViewRenderer       *renderer);
+static void   gimp_container_tree_store_release_all     (GimpContainerTreeStore *store);
+
 static void   gimp_container_tree_store_set             (GimpContainerTreeStore *store,
                                                          GtkTreeIter            *iter,
                                                          GimpViewable           *viewable);
@@ -79,11 +110,16 @@ static void   gimp_container_tree_store_renderer_update (GimpViewRenderer
                                                          GimpContainerTreeStore *store);
 
 
-G_DEFINE_TYPE_WITH_PRIVATE (GimpContainerTreeStore, gimp_container_tree_store,
-                            GTK_TYPE_TREE_STORE)
+G_DEFINE_TYPE_WITH_CODE (GimpContainerTreeStore, gimp_container_tree_store,
+                         GTK_TYPE_TREE_STORE,
+                         G_ADD_PRIVATE (GimpContainerTreeStore)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+                                                gimp_container_tree_store_tree_model_iface_init))
 
 #define parent_class gimp_container_tree_store_parent_class
 
+static GtkTreeModelIface *parent_tree_model_iface = NULL;
+
 
 static void
 gimp_container_tree_store_class_init (GimpContainerTreeStoreClass *klass)
@@ -109,9 +145,22 @@ gimp_container_tree_store_class_init (GimpContainerTreeStoreClass *klass)
                                                          GIMP_PARAM_READWRITE));
 }
 
+static void
+gimp_container_tree_store_tree_model_iface_init (GtkTreeModelIface *iface)
+{
+  parent_tree_model_iface = g_type_interface_peek_parent (iface);
+
+  iface->get_value = gimp_container_tree_store_get_value;
+}
+
 static void
 gimp_container_tree_store_init (GimpContainerTreeStore *store)
 {
+  GimpContainerTreeStorePrivate *private = GET_PRIVATE (store);
+
+  private->renderers = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  g_queue_init (&private->spare_renderers);
 }
 
 static void
@@ -123,8 +172,15 @@ gimp_container_tree_store_constructed (GObject *object)
 static void
 gimp_container_tree_store_finalize (GObject *object)
 {
+  GimpContainerTreeStore        *store   = GIMP_CONTAINER_TREE_STORE (object);
   GimpContainerTreeStorePrivate *private = GET_PRIVATE (object);
 
+  gimp_container_tree_store_release_all (store);
+
+  g_clear_pointer (&private->renderers, g_hash_table_unref);
+  g_queue_clear_full (&private->spare_renderers, g_object_unref);
+  g_clear_object (&private->placeholder);
+
   g_list_free (private->renderer_cells);
   g_list_free (private->renderer_columns);
 
@@ -246,6 +302,113 @@ gimp_container_tree_store_get_renderer (GimpContainerTreeStore *store,
   return renderer;
 }
 
+/*  returns a reference to the renderer of the row's viewable.  renderers
+ *  are only created when a row's preview is actually needed, so if the
+ *  row's renderer doesn't exist yet and 'create' is FALSE, a placeholder
+ *  renderer of the same size is returned instead, which is enough for
+ *  measuring rows that are scrolled out of view.
+ */
+GimpViewRenderer *
+gimp_container_tree_store_get_row_renderer (GimpContainerTreeStore *store,
+                                            GtkTreeIter            *iter,
+                                            gboolean                create)
+{
+  GimpContainerTreeStorePrivate *private;
+  GimpViewRenderer              *renderer;
+
+  g_return_val_if_fail (GIMP_IS_CONTAINER_TREE_STORE (store), NULL);
+  g_return_val_if_fail (iter != NULL, NULL);
+
+  private = GET_PRIVATE (store);
+
+  renderer = gimp_container_tree_store_lookup_renderer (store, iter, create);
+
+  if (! renderer)
+    {
+      GimpViewable *viewable;
+
+      gtk_tree_model_get (GTK_TREE_MODEL (store), iter,
+                          GIMP_CONTAINER_TREE_STORE_COLUMN_VIEWABLE, &viewable,
+                          -1);
+
+      if (! viewable)
+        return NULL;
+
+      if (! private->placeholder)
+        {
+          GimpContext *context;
+          gint         view_size;
+          gint         border_width;
+
+          context   = gimp_container_view_get_context (private->container_view);
+          view_size = gimp_container_view_get_view_size (private->container_view,
+                                                         &border_width);
+
+          private->placeholder = gimp_view_renderer_new (context,
+                                                         GIMP_TYPE_VIEWABLE,
+                                                         view_size,
+                                                         border_width,
+                                                         FALSE);
+        }
+
+      renderer = private->placeholder;
+    }
+
+  return g_object_ref (renderer);
+}
+
+/*  drops the renderers of all rows outside the range from 'first' to
+ *  'last', keeping some of them around to be reused for the rows that
+ *  are scrolled into view next.  if 'first' or 'last' is NULL, all rows'
+ *  renderers are dropped.
+ */
+void
+gimp_container_tree_store_release_renderers (GimpContainerTreeStore *store,
+                                             GtkTreePath            *first,
+                                             GtkTreePath            *last)
+{
+  GimpContainerTreeStorePrivate *private;
+  GHashTableIter                 hash_iter;
+  gpointer                       key;
+  gpointer                       value;
+
+  g_return_if_fail (GIMP_IS_CONTAINER_TREE_STORE (store));
+
+  private = GET_PRIVATE (store);
+
+  g_hash_table_iter_init (&hash_iter, private->renderers);
+
+  while (g_hash_table_iter_next (&hash_iter, &key, &value))
+    {
+      GimpViewRenderer *renderer = value;
+      GtkTreeIter      *iter     = NULL;
+      gboolean          keep     = FALSE;
+
+      /*  the viewable might be gone already, check before using it  */
+      if (renderer->viewable == key)
+        iter = _gimp_container_view_lookup (private->container_view, key);
+
+      if (iter && first && last)
+        {
+          GtkTreePath *path;
+
+          path = gtk_tree_model_get_path (GTK_TREE_MODEL (store), iter);
+
+          keep = (gtk_tree_path_compare (path, first) >= 0 &&
+                  gtk_tree_path_compare (path, last)  <= 0);
+
+          gtk_tree_path_free (path);
+        }
+
+      if (! keep)
+        {
+          g_hash_table_iter_steal (&hash_iter);
+
+          gimp_container_tree_store_release_renderer (store, renderer);
+        }
+    }
+}
+
 void
 gimp_container_tree_store_set_use_name (GimpContainerTreeStore *store,
                                         gboolean                use_name)
@@ -271,35 +434,32 @@ gimp_container_tree_store_get_use_name (GimpContainerTreeStore *store)
   return GET_PRIVATE (store)->use_name;
 }
 
-static gboolean
-gimp_container_tree_store_set_context_foreach (GtkTreeModel *model,
-                                               GtkTreePath  *path,
-                                               GtkTreeIter  *iter,
-                                               gpointer      data)
+void
+gimp_container_tree_store_set_context (GimpContainerTreeStore *store,
+                                       GimpContext            *context)
 {
-  GimpContext      *context = data;
-  GimpViewRenderer *renderer;
+  GimpContainerTreeStorePrivate *private;
+  GHashTableIter                 iter;
+  gpointer                       renderer;
+  GList                         *list;
 
-  gtk_tree_model_get (model, iter,
-                      GIMP_CONTAINER_TREE_STORE_COLUMN_RENDERER, &renderer,
-                      -1);
+  g_return_if_fail (GIMP_IS_CONTAINER_TREE_STORE (store));
 
-  gimp_view_renderer_set_context (renderer, context);
+  private = GET_PRIVATE (store);
 
-  g_object_unref (renderer);
+  /*  rows without a renderer get the context when their renderer is
+   *  created, so only the existing renderers need to be updated
+   */
+  g_hash_table_iter_init (&iter, private->renderers);
 
-  return FALSE;
-}
+  while (g_hash_table_iter_next (&iter, NULL, &renderer))
+    gimp_view_renderer_set_context (renderer, context);
 
-void
-gimp_container_tree_store_set_context (GimpContainerTreeStore *store,
-                                       GimpContext            *context)
-{
-  g_return_if_fail (GIMP_IS_CONTAINER_TREE_STORE (store));
+  for (list = private->spare_renderers.head; list; list = g_list_next (list))
+    gimp_view_renderer_set_context (list->data, context);
 
-  gtk_tree_model_foreach (GTK_TREE_MODEL (store),
-                          gimp_container_tree_store_set_context_foreach,
-                          context);
+  if (private->placeholder)
+    gimp_view_renderer_set_context (private->placeholder, context);
 }
 
 GtkTreeIter *
@@ -355,6 +515,21 @@ gimp_container_tree_store_remove_item (GimpContainerTreeStore *store,
           for (list = private->renderer_cells; list; list = list->next)
             g_object_set (list->data, "renderer", NULL, NULL);
         }
+
+      if (viewable)
+        {
+          GimpContainerTreeStorePrivate *private = GET_PRIVATE (store);
+          GimpViewRenderer              *renderer;
+
+          renderer = g_hash_table_lookup (private->renderers, viewable);
+
+          if (renderer)
+            {
+              g_hash_table_remove (private->renderers, viewable);
+
+              gimp_container_tree_store_release_renderer (store, renderer);
+            }
+        }
     }
 }
 
@@ -483,53 +658,35 @@ gimp_container_tree_store_clear_items (GimpContainerTreeStore *store)
       for (list = private->renderer_cells; list; list = list->next)
         g_object_set (list->data, "renderer", NULL, NULL);
     }
-}
-
-typedef struct
-{
-  gint view_size;
-  gint border_width;
-} SetSizeForeachData;
-
-static gboolean
-gimp_container_tree_store_set_view_size_foreach (GtkTreeModel *model,
-                                                 GtkTreePath  *path,
-                                                 GtkTreeIter  *iter,
-                                                 gpointer      data)
-{
-  SetSizeForeachData *size_data = data;
-  GimpViewRenderer   *renderer;
-
-  gtk_tree_model_get (model, iter,
-                      GIMP_CONTAINER_TREE_STORE_COLUMN_RENDERER, &renderer,
-                      -1);
 
-  gimp_view_renderer_set_size (renderer,
-                               size_data->view_size,
-                               size_data->border_width);
-
-  g_object_unref (renderer);
-
-  return FALSE;
+  gimp_container_tree_store_release_all (store);
 }
 
 void
 gimp_container_tree_store_set_view_size (GimpContainerTreeStore *store)
 {
   GimpContainerTreeStorePrivate *private;
-  SetSizeForeachData             size_data;
+  GHashTableIter                 iter;
+  gpointer                       renderer;
+  gint                           view_size;
+  gint                           border_width;
 
   g_return_if_fail (GIMP_IS_CONTAINER_TREE_STORE (store));
 
   private = GET_PRIVATE (store);
 
-  size_data.view_size =
-    gimp_container_view_get_view_size (private->container_view,
-                                       &size_data.border_width);
+  view_size = gimp_container_view_get_view_size (private->container_view,
+                                                 &border_width);
+
+  /*  spare renderers are resized when they are reused  */
+  g_hash_table_iter_init (&iter, private->renderers);
 
-  gtk_tree_model_foreach (GTK_TREE_MODEL (store),
-                          gimp_container_tree_store_set_view_size_foreach,
-                          &size_data);
+  while (g_hash_table_iter_next (&iter, NULL, &renderer))
+    gimp_view_renderer_set_size (renderer, view_size, border_width);
+
+  if (private->placeholder)
+    gimp_view_renderer_set_size (private->placeholder,
+                                 view_size, border_width);
 }
 
 
@@ -562,6 +719,10 @@ gimp_container_tree_store_columns_init (GType *types,
   gimp_assert (GIMP_CONTAINER_TREE_STORE_COLUMN_USER_DATA ==
                gimp_container_tree_store_columns_add (types, n_types,
                                                       G_TYPE_POINTER));
+
+  gimp_assert (GIMP_CONTAINER_TREE_STORE_COLUMN_VIEWABLE ==
+               gimp_container_tree_store_columns_add (types, n_types,
+                                                      G_TYPE_POINTER));
 }
 
 gint
@@ -580,14 +741,93 @@ gimp_container_tree_store_columns_add (GType *types,
 }
 
 static void
-gimp_container_tree_store_set (GimpContainerTreeStore *store,
-                               GtkTreeIter            *iter,
-                               GimpViewable           *viewable)
+gimp_container_tree_store_get_value (GtkTreeModel *model,
+                                     GtkTreeIter  *iter,
+                                     gint          column,
+                                     GValue       *value)
+{
+  if (column == GIMP_CONTAINER_TREE_STORE_COLUMN_RENDERER)
+    {
+      GimpContainerTreeStore *store = GIMP_CONTAINER_TREE_STORE (model);
+
+      g_value_init (value, GIMP_TYPE_VIEW_RENDERER);
+      g_value_set_object (value,
+                          gimp_container_tree_store_lookup_renderer (store,
+                                                                     iter,
+                                                                     TRUE));
+    }
+  else
+    {
+      parent_tree_model_iface->get_value (model, iter, column, value);
+    }
+}
+
+/*  returns the row's renderer without adding a reference.  a renderer
+ *  set on the row explicitly takes precedence, otherwise the renderer
+ *  of the row's viewable is looked up, and created if 'create' is TRUE.
+ */
+static GimpViewRenderer *
+gimp_container_tree_store_lookup_renderer (GimpContainerTreeStore *store,
+                                           GtkTreeIter            *iter,
+                                           gboolean                create)
 {
   GimpContainerTreeStorePrivate *private = GET_PRIVATE (store);
-  GimpContext                   *context;
   GimpViewRenderer              *renderer;
-  gchar                         *name;
+  GimpViewable                  *viewable;
+  GValue                         value = G_VALUE_INIT;
+
+  parent_tree_model_iface->get_value (GTK_TREE_MODEL (store), iter,
+                                      GIMP_CONTAINER_TREE_STORE_COLUMN_RENDERER,
+                                      &value);
+  renderer = g_value_get_object (&value);
+  g_value_unset (&value);
+
+  /*  the store keeps its own reference  */
+  if (renderer)
+    return renderer;
+
+  parent_tree_model_iface->get_value (GTK_TREE_MODEL (store), iter,
+                                      GIMP_CONTAINER_TREE_STORE_COLUMN_VIEWABLE,
+                                      &value);
+  viewable = g_value_get_pointer (&value);
+  g_value_unset (&value);
+
+  if (! viewable)
+    return NULL;
+
+  renderer = g_hash_table_lookup (private->renderers, viewable);
+
+  /*  a renderer whose viewable was destroyed, while a new viewable was
+   *  allocated at the same address
+   */
+  if (renderer && renderer->viewable != viewable)
+    {
+      g_hash_table_remove (private->renderers, viewable);
+
+      gimp_container_tree_store_release_renderer (store, renderer);
+
+      renderer = NULL;
+    }
+
+  if (! renderer && create)
+    {
+      renderer = gimp_container_tree_store_acquire_renderer (store, viewable);
+
+      g_hash_table_insert (private->renderers, viewable, renderer);
+    }
+
+  return renderer;
+}
+
+static GimpViewRenderer *
+gimp_container_tree_store_acquire_renderer (GimpContainerTreeStore *store,
+                                            GimpViewable           *viewable)
+{
+  GimpContainerTreeStorePrivate *private  = GET_PRIVATE (store);
+  GimpViewRenderer              *renderer = NULL;
+  GimpContext                   *context;
+  GType                          viewable_type;
+  GList                         *list;
   gint                           view_size;
   gint                           border_width;
 
@@ -596,16 +836,94 @@ gimp_container_tree_store_set (GimpContainerTreeStore *store,
   view_size = gimp_container_view_get_view_size (private->container_view,
                                                  &border_width);
 
-  renderer = gimp_view_renderer_new (context,
-                                     G_TYPE_FROM_INSTANCE (viewable),
-                                     view_size, border_width,
-                                     FALSE);
+  viewable_type = G_TYPE_FROM_INSTANCE (viewable);
+
+  for (list = private->spare_renderers.head; list; list = g_list_next (list))
+    {
+      GimpViewRenderer *spare = list->data;
+
+      if (spare->viewable_type == viewable_type)
+        {
+          renderer = spare;
+
+          g_queue_delete_link (&private->spare_renderers, list);
+          break;
+        }
+    }
+
+  if (renderer)
+    {
+      gimp_view_renderer_set_context (renderer, context);
+      gimp_view_renderer_set_size (renderer, view_size, border_width);
+    }
+  else
+    {
+      renderer = gimp_view_renderer_new (context, viewable_type,
+                                         view_size, border_width,
+                                         FALSE);
+
+      g_signal_connect_object (renderer, "update",
+                               G_CALLBACK (gimp_container_tree_store_renderer_update),
+                               store, 0);
+    }
+
   gimp_view_renderer_set_viewable (renderer, viewable);
   gimp_view_renderer_remove_idle (renderer);
 
-  g_signal_connect (renderer, "update",
-                    G_CALLBACK (gimp_container_tree_store_renderer_update),
-                    store);
+  return renderer;
+}
+
+/*  takes over the reference to 'renderer'.  renderers nobody else uses
+ *  are kept as spares, up to MAX_SPARE_RENDERERS, the others are just
+ *  unreferenced.
+ */
+static void
+gimp_container_tree_store_release_renderer (GimpContainerTreeStore *store,
+                                            GimpViewRenderer       *renderer)
+{
+  GimpContainerTreeStorePrivate *private = GET_PRIVATE (store);
+
+  if (G_OBJECT (renderer)->ref_count == 1 &&
+      private->spare_renderers.length < MAX_SPARE_RENDERERS)
+    {
+      gimp_view_renderer_set_viewable (renderer, NULL);
+      gimp_view_renderer_remove_idle (renderer);
+
+      g_queue_push_head (&private->spare_renderers, renderer);
+    }
+  else
+    {
+      g_object_unref (renderer);
+    }
+}
+
+static void
+gimp_container_tree_store_release_all (GimpContainerTreeStore *store)
+{
+  GimpContainerTreeStorePrivate *private = GET_PRIVATE (store);
+  GHashTableIter                 iter;
+  gpointer                       renderer;
+
+  g_hash_table_iter_init (&iter, private->renderers);
+
+  while (g_hash_table_iter_next (&iter, NULL, &renderer))
+    {
+      g_hash_table_iter_steal (&iter);
+
+      gimp_container_tree_store_release_renderer (store, renderer);
+    }
+}
+
+/*  the row's renderer is only created when it's asked for, see
+ *  gimp_container_tree_store_lookup_renderer()
+ */
+static void
+gimp_container_tree_store_set (GimpContainerTreeStore *store,
+                               GtkTreeIter            *iter,
+                               GimpViewable           *viewable)
+{
+  GimpContainerTreeStorePrivate *private = GET_PRIVATE (store);
+  gchar                         *name;
 
   if (private->use_name)
     name = (gchar *) gimp_object_get_name (viewable);
@@ -613,15 +931,13 @@ gimp_container_tree_store_set (GimpContainerTreeStore *store,
     name = gimp_viewable_get_description (viewable, NULL);
 
   gtk_tree_store_set (GTK_TREE_STORE (store), iter,
-                      GIMP_CONTAINER_TREE_STORE_COLUMN_RENDERER,       renderer,
+                      GIMP_CONTAINER_TREE_STORE_COLUMN_VIEWABLE,       viewable,
                       GIMP_CONTAINER_TREE_STORE_COLUMN_NAME,           name,
                       GIMP_CONTAINER_TREE_STORE_COLUMN_NAME_SENSITIVE, TRUE,
                       -1);
 
   if (! private->use_name)
     g_free (name);
-
-  g_object_unref (renderer);
 }
 
 static void
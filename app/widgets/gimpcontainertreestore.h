@@ -28,6 +28,7 @@ enum
   GIMP_CONTAINER_TREE_STORE_COLUMN_NAME_ATTRIBUTES,
   GIMP_CONTAINER_TREE_STORE_COLUMN_NAME_SENSITIVE,
   GIMP_CONTAINER_TREE_STORE_COLUMN_USER_DATA,
+  GIMP_CONTAINER_TREE_STORE_COLUMN_VIEWABLE,
   GIMP_CONTAINER_TREE_STORE_N_COLUMNS
 };
 
@@ -71,6 +72,13 @@ void       gimp_container_tree_store_add_renderer_cell (GimpContainerTreeStore *
 GimpViewRenderer *
                gimp_container_tree_store_get_renderer  (GimpContainerTreeStore *store,
                                                         GtkTreeIter            *iter);
+GimpViewRenderer *
+           gimp_container_tree_store_get_row_renderer  (GimpContainerTreeStore *store,
+                                                        GtkTreeIter            *iter,
+                                                        gboolean                create);
+void       gimp_container_tree_store_release_renderers (GimpContainerTreeStore *store,
+                                                        GtkTreePath            *first,
+                                                        GtkTreePath            *last);
 
 void           gimp_container_tree_store_set_use_name  (GimpContainerTreeStore *store,
                                                         gboolean                use_name);
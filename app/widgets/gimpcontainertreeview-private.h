@@ -39,5 +39,7 @@ struct _GimpContainerTreeViewPrivate
   guint               scroll_timeout_interval;
   GdkScrollDirection  scroll_dir;
 
+  guint               release_idle_id;
+
   gboolean            dnd_drop_to_empty;
 };
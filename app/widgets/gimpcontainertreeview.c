@@ -110,6 +110,15 @@ static void          gimp_container_tree_view_name_started      (GtkCellRenderer
 static void          gimp_container_tree_view_name_canceled     (GtkCellRendererText         *cell,
                                                                  GimpContainerTreeView       *tree_view);
 
+static void          gimp_container_tree_view_renderer_cell_data(GtkTreeViewColumn           *column,
+                                                                 GtkCellRenderer             *cell,
+                                                                 GtkTreeModel                *model,
+                                                                 GtkTreeIter                 *iter,
+                                                                 GimpContainerTreeView       *tree_view);
+static void          gimp_container_tree_view_scrolled          (GtkAdjustment               *adjustment,
+                                                                 GimpContainerTreeView       *tree_view);
+static gboolean      gimp_container_tree_view_release_idle      (GimpContainerTreeView       *tree_view);
+
 static void          gimp_container_tree_view_selection_changed (GtkTreeSelection            *sel,
                                                                  GimpContainerTreeView       *tree_view);
 static gboolean      gimp_container_tree_view_button            (GtkWidget                   *widget,
@@ -277,10 +286,13 @@ gimp_container_tree_view_constructed (GObject *object)
                                    tree_view->renderer_cell,
                                    FALSE);
 
-  gtk_tree_view_column_set_attributes (tree_view->main_column,
-                                       tree_view->renderer_cell,
-                                       "renderer", GIMP_CONTAINER_TREE_STORE_COLUMN_RENDERER,
-                                       NULL);
+  /*  only rows that are actually shown get a renderer, see
+   *  gimp_container_tree_view_renderer_cell_data()
+   */
+  gtk_tree_view_column_set_cell_data_func (tree_view->main_column,
+                                           tree_view->renderer_cell,
+                                           (GtkTreeCellDataFunc) gimp_container_tree_view_renderer_cell_data,
+                                           tree_view, NULL);
 
   tree_view->priv->name_cell = gtk_cell_renderer_text_new ();
   g_object_set (tree_view->priv->name_cell, "xalign", 0.0, NULL);
@@ -312,6 +324,11 @@ gimp_container_tree_view_constructed (GObject *object)
                     G_CALLBACK (gimp_container_tree_view_selection_changed),
                     tree_view);
 
+  g_signal_connect (gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (tree_view->view)),
+                    "value-changed",
+                    G_CALLBACK (gimp_container_tree_view_scrolled),
+                    tree_view);
+
   g_signal_connect (tree_view->view, "drag-failed",
                     G_CALLBACK (gimp_container_tree_view_drag_failed),
                     tree_view);
@@ -341,6 +358,8 @@ gimp_container_tree_view_finalize (GObject *object)
 {
   GimpContainerTreeView *tree_view = GIMP_CONTAINER_TREE_VIEW (object);
 
+  g_clear_handle_id (&tree_view->priv->release_idle_id, g_source_remove);
+
   g_clear_object (&tree_view->model);
 
   if (tree_view->priv->toggle_cells)
@@ -368,9 +387,19 @@ gimp_container_tree_view_style_updated_foreach (GtkTreeModel *model,
                                                 GtkTreeIter  *iter,
                                                 gpointer      data)
 {
-  GimpViewRenderer *renderer;
+  GimpContainerTreeStore *store = GIMP_CONTAINER_TREE_STORE (model);
+  GimpViewRenderer       *renderer;
+  GimpViewable           *viewable;
+
+  /*  don't create the renderers of rows that weren't shown yet  */
+  gtk_tree_model_get (model, iter,
+                      GIMP_CONTAINER_TREE_STORE_COLUMN_VIEWABLE, &viewable,
+                      -1);
 
-  renderer = gimp_container_tree_store_get_renderer (GIMP_CONTAINER_TREE_STORE (model), iter);
+  if (viewable)
+    renderer = gimp_container_tree_store_get_row_renderer (store, iter, FALSE);
+  else
+    renderer = gimp_container_tree_store_get_renderer (store, iter);
 
   if (renderer)
     {
@@ -405,6 +434,8 @@ gimp_container_tree_view_unmap (GtkWidget *widget)
       tree_view->priv->scroll_timeout_id = 0;
     }
 
+  g_clear_handle_id (&tree_view->priv->release_idle_id, g_source_remove);
+
   GTK_WIDGET_CLASS (parent_class)->unmap (widget);
 }
 
@@ -1242,6 +1273,77 @@ gimp_container_tree_view_name_canceled (GtkCellRendererText   *cell,
     }
 }
 
+/*  rows that are scrolled out of view, which GtkTreeView measures all
+ *  the same, get a placeholder of the right size instead of their own
+ *  renderer, so a huge container doesn't create a renderer per item
+ */
+static void
+gimp_container_tree_view_renderer_cell_data (GtkTreeViewColumn     *column,
+                                             GtkCellRenderer       *cell,
+                                             GtkTreeModel          *model,
+                                             GtkTreeIter           *iter,
+                                             GimpContainerTreeView *tree_view)
+{
+  GimpViewRenderer *renderer;
+  GtkTreePath      *first;
+  GtkTreePath      *last;
+  gboolean          visible = FALSE;
+
+  if (gtk_tree_view_get_visible_range (tree_view->view, &first, &last))
+    {
+      GtkTreePath *path = gtk_tree_model_get_path (model, iter);
+
+      visible = (gtk_tree_path_compare (path, first) >= 0 &&
+                 gtk_tree_path_compare (path, last)  <= 0);
+
+      gtk_tree_path_free (path);
+      gtk_tree_path_free (first);
+      gtk_tree_path_free (last);
+    }
+
+  renderer = gimp_container_tree_store_get_row_renderer (GIMP_CONTAINER_TREE_STORE (model),
+                                                         iter, visible);
+
+  g_object_set (cell, "renderer", renderer, NULL);
+
+  if (renderer)
+    g_object_unref (renderer);
+}
+
+static void
+gimp_container_tree_view_scrolled (GtkAdjustment         *adjustment,
+                                   GimpContainerTreeView *tree_view)
+{
+  if (! tree_view->priv->release_idle_id)
+    tree_view->priv->release_idle_id =
+      g_idle_add_full (G_PRIORITY_LOW,
+                       (GSourceFunc) gimp_container_tree_view_release_idle,
+                       tree_view, NULL);
+}
+
+/*  drops the renderers of the rows scrolled out of view, once scrolling
+ *  settled down
+ */
+static gboolean
+gimp_container_tree_view_release_idle (GimpContainerTreeView *tree_view)
+{
+  GtkTreePath *first = NULL;
+  GtkTreePath *last  = NULL;
+
+  tree_view->priv->release_idle_id = 0;
+
+  if (gtk_tree_view_get_visible_range (tree_view->view, &first, &last))
+    {
+      gimp_container_tree_store_release_renderers (GIMP_CONTAINER_TREE_STORE (tree_view->model),
+                                                   first, last);
+
+      gtk_tree_path_free (first);
+      gtk_tree_path_free (last);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
 gimp_container_tree_view_selection_changed (GtkTreeSelection      *selection,
                                             GimpContainerTreeView *tree_view)
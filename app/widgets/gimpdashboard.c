@@ -59,14 +59,23 @@
 #include "widgets-types.h"
 
 #include "core/gimp.h"
+#include "core/gimp-frame-stats.h"
 #include "core/gimp-gui.h"
+#include "core/gimp-input-latency.h"
+#include "core/gimp-memory-tags.h"
 #include "core/gimp-utils.h"
 #include "core/gimp-parallel.h"
+#include "core/gimp-swap-stats.h"
 #include "core/gimpasync.h"
 #include "core/gimpbacktrace.h"
+#include "core/gimpbrushcache.h"
+#include "core/gimpimage-memory.h"
+#include "core/gimplayerstack.h"
 #include "core/gimptempbuf.h"
 #include "core/gimpwaitable.h"
 
+#include "pdb/gimppdb-profile.h"
+
 #include "gimpactiongroup.h"
 #include "gimpdocked.h"
 #include "gimpdashboard.h"
@@ -101,6 +110,7 @@
 #define LOG_DEFAULT_BACKTRACE          TRUE
 #define LOG_DEFAULT_MESSAGES           TRUE
 #define LOG_DEFAULT_PROGRESSIVE        FALSE
+#define LOG_DEFAULT_MEMORY_TAGS        FALSE
 
 
 typedef enum
@@ -131,6 +141,11 @@ typedef enum
   VARIABLE_SWAP_WRITTEN,
   VARIABLE_SWAP_WRITE_THROUGHPUT,
 
+  VARIABLE_SWAP_READ_LATENCY,
+  VARIABLE_SWAP_READ_LATENCY_P95,
+  VARIABLE_SWAP_READ_AHEAD,
+  VARIABLE_SWAP_WRITE_DELAY,
+
   VARIABLE_SWAP_COMPRESSION,
 
 #ifdef HAVE_CPU_GROUP
@@ -147,6 +162,47 @@ typedef enum
   VARIABLE_MEMORY_SIZE,
 #endif
 
+  /* display */
+  VARIABLE_FRAME_TIME,
+  VARIABLE_FRAME_TIME_P95,
+  VARIABLE_FRAME_TIME_P99,
+  VARIABLE_RENDER_TIME,
+  VARIABLE_PROJECTION_TIME,
+  VARIABLE_PROJECTION_CHUNKS,
+  VARIABLE_CHECKERBOARD_AREA,
+  VARIABLE_INPUT_LATENCY,
+  VARIABLE_INPUT_LATENCY_P95,
+  VARIABLE_INPUT_LATENCY_P99,
+
+  /* pdb */
+  VARIABLE_PDB_CALLS,
+  VARIABLE_PDB_CALL_RATE,
+  VARIABLE_PDB_CALL_TIME,
+  VARIABLE_PDB_MARSHAL_TIME,
+  VARIABLE_PDB_MAX_TIME,
+
+  /* async */
+  VARIABLE_ASYNC_QUEUED,
+  VARIABLE_ASYNC_LATENCY_HIGH,
+  VARIABLE_ASYNC_LATENCY_DEFAULT,
+  VARIABLE_ASYNC_LATENCY_LOW,
+  VARIABLE_ASYNC_DURATION_HIGH,
+  VARIABLE_ASYNC_DURATION_DEFAULT,
+  VARIABLE_ASYNC_DURATION_LOW,
+  VARIABLE_ASYNC_TIME_HISTOGRAM,
+  VARIABLE_ASYNC_TIME_LINE_ART,
+  VARIABLE_ASYNC_TIME_PREVIEW,
+  VARIABLE_ASYNC_TIME_PROJECTION,
+  VARIABLE_ASYNC_TIME_DATA,
+  VARIABLE_ASYNC_TIME_OTHER,
+
+  /* allocations */
+  VARIABLE_ALLOCATIONS_DRAWABLES,
+  VARIABLE_ALLOCATIONS_UNDO,
+  VARIABLE_ALLOCATIONS_PREVIEWS,
+  VARIABLE_ALLOCATIONS_PAINT,
+  VARIABLE_ALLOCATIONS_OTHER,
+
   /* misc */
   VARIABLE_MIPMAPED,
   VARIABLE_ASSIGNED_THREADS,
@@ -155,6 +211,11 @@ typedef enum
   VARIABLE_TILE_ALLOC_TOTAL,
   VARIABLE_SCRATCH_TOTAL,
   VARIABLE_TEMP_BUF_TOTAL,
+  VARIABLE_LAYER_STACK_CACHE_TOTAL,
+  VARIABLE_BRUSH_CACHE_TOTAL,
+  VARIABLE_BRUSH_CACHE_HIT_MISS,
+  VARIABLE_IMAGE_MEMORY_TOTAL,
+  VARIABLE_IMAGE_MEMORY_MAX,
 
 
   N_VARIABLES,
@@ -171,6 +232,7 @@ typedef enum
   VARIABLE_TYPE_INT_RATIO,
   VARIABLE_TYPE_PERCENTAGE,
   VARIABLE_TYPE_DURATION,
+  VARIABLE_TYPE_TIME,
   VARIABLE_TYPE_RATE_OF_CHANGE
 } VariableType;
 
@@ -186,6 +248,10 @@ typedef enum
 #ifdef HAVE_MEMORY_GROUP
   GROUP_MEMORY,
 #endif
+  GROUP_DISPLAY,
+  GROUP_PDB,
+  GROUP_ASYNC,
+  GROUP_ALLOCATIONS,
   GROUP_MISC,
 
   N_GROUPS
@@ -261,6 +327,7 @@ struct _VariableData
     } int_ratio;
     gdouble   percentage;     /* from 0 to 1                */
     gdouble   duration;       /* in seconds                 */
+    gdouble   time;           /* in seconds                 */
     gdouble   rate_of_change; /* in source units per second */
   } value;
 
@@ -311,6 +378,9 @@ struct _GimpDashboardPrivate
   gint                          update_idle_id;
   gint                          low_swap_space_idle_id;
 
+  gboolean                      pdb_profile;
+  gboolean                      memory_tags;
+
   GimpDashboardUpdateInteval    update_interval;
   GimpDashboardHistoryDuration  history_duration;
   gboolean                      low_swap_space_warning;
@@ -324,6 +394,8 @@ struct _GimpDashboardPrivate
   VariableData                  log_variables[N_VARIABLES];
   GimpBacktrace                *log_backtrace;
   GHashTable                   *log_addresses;
+  GArray                       *log_memory_tags;
+  GArray                       *log_input_latency;
   GimpLogHandler                log_log_handler;
 
   GtkWidget                    *log_record_button;
@@ -372,6 +444,14 @@ static void       gimp_dashboard_sample_variable_rate_of_change (GimpDashboard
                                                                  Variable             variable);
 static void       gimp_dashboard_sample_swap_limit              (GimpDashboard       *dashboard,
                                                                  Variable             variable);
+static void       gimp_dashboard_sample_swap_write_delay        (GimpDashboard       *dashboard,
+                                                                 Variable             variable);
+static void       gimp_dashboard_sample_brush_cache_hit_miss    (GimpDashboard       *dashboard,
+                                                                 Variable             variable);
+static void       gimp_dashboard_sample_async_label_time        (GimpDashboard       *dashboard,
+                                                                 Variable             variable);
+static void       gimp_dashboard_sample_memory_tag              (GimpDashboard       *dashboard,
+                                                                 Variable             variable);
 #ifdef HAVE_CPU_GROUP
 static void       gimp_dashboard_sample_cpu_usage               (GimpDashboard       *dashboard,
                                                                  Variable             variable);
@@ -623,6 +703,45 @@ static const VariableInfo variables[] =
     .data             = GINT_TO_POINTER (VARIABLE_SWAP_WRITTEN)
   },
 
+  [VARIABLE_SWAP_READ_LATENCY] =
+  { .name             = "swap-read-latency",
+    .title            = NC_("dashboard-variable", "Read latency"),
+    .description      = N_("Median time taken to read a tile back from "
+                           "the swap"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_swap_stats_get_read_latency
+  },
+
+  [VARIABLE_SWAP_READ_LATENCY_P95] =
+  { .name             = "swap-read-latency-p95",
+    .title            = NC_("dashboard-variable", "Read latency (95%)"),
+    .description      = N_("95th percentile of the recent times taken to "
+                           "read a tile back from the swap"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_swap_stats_get_read_latency_p95
+  },
+
+  [VARIABLE_SWAP_READ_AHEAD] =
+  { .name             = "swap-read-ahead",
+    .title            = NC_("dashboard-variable", "Read ahead"),
+    .description      = N_("Total amount of data read from the swap ahead "
+                           "of rendering"),
+    .type             = VARIABLE_TYPE_SIZE,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_swap_stats_get_read_ahead
+  },
+
+  [VARIABLE_SWAP_WRITE_DELAY] =
+  { .name             = "swap-write-delay",
+    .title            = NC_("dashboard-variable", "Write delay"),
+    .description      = N_("Estimated time until the data queued for "
+                           "writing to the swap is written"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_swap_write_delay
+  },
+
   [VARIABLE_SWAP_COMPRESSION] =
   { .name             = "swap-compression",
     .title            = NC_("dashboard-variable", "Compression"),
@@ -697,6 +816,330 @@ static const VariableInfo variables[] =
 #endif /* HAVE_MEMORY_GROUP */
 
 
+  /* display variables */
+
+  [VARIABLE_FRAME_TIME] =
+  { .name             = "frame-time",
+    .title            = NC_("dashboard-variable", "Frame"),
+    .description      = N_("Time taken to draw the last canvas frame"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_frame_stats_get_frame_time
+  },
+
+  [VARIABLE_FRAME_TIME_P95] =
+  { .name             = "frame-time-p95",
+    .title            = NC_("dashboard-variable", "Frame (95%)"),
+    .description      = N_("95th percentile of the recent canvas frame times"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_frame_stats_get_frame_time_p95
+  },
+
+  [VARIABLE_FRAME_TIME_P99] =
+  { .name             = "frame-time-p99",
+    .title            = NC_("dashboard-variable", "Frame (99%)"),
+    .description      = N_("99th percentile of the recent canvas frame times"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_frame_stats_get_frame_time_p99
+  },
+
+  [VARIABLE_RENDER_TIME] =
+  { .name             = "render-time",
+    .title            = NC_("dashboard-variable", "Render"),
+    .description      = N_("Time spent rendering and color-transforming "
+                           "the image during the last canvas frame"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_frame_stats_get_render_time
+  },
+
+  [VARIABLE_PROJECTION_TIME] =
+  { .name             = "projection-time",
+    .title            = NC_("dashboard-variable", "Projection"),
+    .description      = N_("Time spent rendering the projection before "
+                           "the last canvas frame"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_frame_stats_get_projection_time
+  },
+
+  [VARIABLE_PROJECTION_CHUNKS] =
+  { .name             = "projection-chunks",
+    .title            = NC_("dashboard-variable", "Chunks"),
+    .description      = N_("Number of projection chunks rendered before "
+                           "the last canvas frame"),
+    .type             = VARIABLE_TYPE_INTEGER,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_frame_stats_get_projection_chunks
+  },
+
+  [VARIABLE_CHECKERBOARD_AREA] =
+  { .name             = "checkerboard-area",
+    .title            = NC_("dashboard-variable", "Unrendered"),
+    .description      = N_("Canvas area, in pixels, drawn during the last "
+                           "frame before the projection was rendered"),
+    .type             = VARIABLE_TYPE_INTEGER,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_frame_stats_get_checkerboard_area
+  },
+
+  [VARIABLE_INPUT_LATENCY] =
+  { .name             = "input-latency",
+    .title            = NC_("dashboard-variable", "Latency"),
+    .description      = N_("Mean time from the recent input events of the "
+                           "last painting tool used to their pixels being "
+                           "drawn on the canvas"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_input_latency_get_mean
+  },
+
+  [VARIABLE_INPUT_LATENCY_P95] =
+  { .name             = "input-latency-p95",
+    .title            = NC_("dashboard-variable", "Latency (95%)"),
+    .description      = N_("95th percentile of the recent input latencies of "
+                           "the last painting tool used"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_input_latency_get_p95
+  },
+
+  [VARIABLE_INPUT_LATENCY_P99] =
+  { .name             = "input-latency-p99",
+    .title            = NC_("dashboard-variable", "Latency (99%)"),
+    .description      = N_("99th percentile of the recent input latencies of "
+                           "the last painting tool used"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_input_latency_get_p99
+  },
+
+
+  /* pdb variables */
+
+  [VARIABLE_PDB_CALLS] =
+  { .name             = "pdb-calls",
+    .title            = NC_("dashboard-variable", "Calls"),
+    .description      = N_("Number of profiled procedure calls"),
+    .type             = VARIABLE_TYPE_INTEGER,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_pdb_profile_get_n_calls
+  },
+
+  [VARIABLE_PDB_CALL_RATE] =
+  { .name             = "pdb-call-rate",
+    .title            = NC_("dashboard-variable", "Call rate"),
+    .description      = N_("The rate at which procedures are called"),
+    .type             = VARIABLE_TYPE_RATE_OF_CHANGE,
+    .sample_func      = gimp_dashboard_sample_variable_rate_of_change,
+    .data             = GINT_TO_POINTER (VARIABLE_PDB_CALLS)
+  },
+
+  [VARIABLE_PDB_CALL_TIME] =
+  { .name             = "pdb-call-time",
+    .title            = NC_("dashboard-variable", "Call time"),
+    .description      = N_("Total time spent in procedure calls"),
+    .type             = VARIABLE_TYPE_DURATION,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_pdb_profile_get_call_time
+  },
+
+  [VARIABLE_PDB_MARSHAL_TIME] =
+  { .name             = "pdb-marshal-time",
+    .title            = NC_("dashboard-variable", "Marshalling"),
+    .description      = N_("Total time spent passing arguments and return "
+                           "values to and from plug-ins"),
+    .type             = VARIABLE_TYPE_DURATION,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_pdb_profile_get_marshal_time
+  },
+
+  [VARIABLE_PDB_MAX_TIME] =
+  { .name             = "pdb-max-time",
+    .title            = NC_("dashboard-variable", "Longest call"),
+    .description      = N_("Time taken by the longest procedure call"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_pdb_profile_get_max_time
+  },
+
+
+  /* async variables */
+
+  [VARIABLE_ASYNC_QUEUED] =
+  { .name             = "async-queued",
+    .title            = NC_("dashboard-variable", "Queued"),
+    .description      = N_("Number of asynchronous tasks waiting to be run"),
+    .type             = VARIABLE_TYPE_INTEGER,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_parallel_get_n_queued
+  },
+
+  [VARIABLE_ASYNC_LATENCY_HIGH] =
+  { .name             = "async-latency-high",
+    .title            = NC_("dashboard-variable", "High wait"),
+    .description      = N_("95th percentile of the time recent high-priority tasks "
+                           "waited before being run"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_parallel_get_latency_high
+  },
+
+  [VARIABLE_ASYNC_LATENCY_DEFAULT] =
+  { .name             = "async-latency-default",
+    .title            = NC_("dashboard-variable", "Default wait"),
+    .description      = N_("95th percentile of the time recent default-priority "
+                           "tasks waited before being run"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_parallel_get_latency_default
+  },
+
+  [VARIABLE_ASYNC_LATENCY_LOW] =
+  { .name             = "async-latency-low",
+    .title            = NC_("dashboard-variable", "Low wait"),
+    .description      = N_("95th percentile of the time recent low-priority tasks "
+                           "waited before being run"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_parallel_get_latency_low
+  },
+
+  [VARIABLE_ASYNC_DURATION_HIGH] =
+  { .name             = "async-duration-high",
+    .title            = NC_("dashboard-variable", "High run"),
+    .description      = N_("95th percentile of the time recent high-priority tasks "
+                           "took to run"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_parallel_get_duration_high
+  },
+
+  [VARIABLE_ASYNC_DURATION_DEFAULT] =
+  { .name             = "async-duration-default",
+    .title            = NC_("dashboard-variable", "Default run"),
+    .description      = N_("95th percentile of the time recent default-priority "
+                           "tasks took to run"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_parallel_get_duration_default
+  },
+
+  [VARIABLE_ASYNC_DURATION_LOW] =
+  { .name             = "async-duration-low",
+    .title            = NC_("dashboard-variable", "Low run"),
+    .description      = N_("95th percentile of the time recent low-priority tasks "
+                           "took to run"),
+    .type             = VARIABLE_TYPE_TIME,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_parallel_get_duration_low
+  },
+
+  [VARIABLE_ASYNC_TIME_HISTOGRAM] =
+  { .name             = "async-time-histogram",
+    .title            = NC_("dashboard-variable", "Histogram"),
+    .description      = N_("Total time spent calculating histograms"),
+    .type             = VARIABLE_TYPE_DURATION,
+    .sample_func      = gimp_dashboard_sample_async_label_time,
+    .data             = "histogram"
+  },
+
+  [VARIABLE_ASYNC_TIME_LINE_ART] =
+  { .name             = "async-time-line-art",
+    .title            = NC_("dashboard-variable", "Line art"),
+    .description      = N_("Total time spent computing line art"),
+    .type             = VARIABLE_TYPE_DURATION,
+    .sample_func      = gimp_dashboard_sample_async_label_time,
+    .data             = "line-art"
+  },
+
+  [VARIABLE_ASYNC_TIME_PREVIEW] =
+  { .name             = "async-time-preview",
+    .title            = NC_("dashboard-variable", "Preview"),
+    .description      = N_("Total time spent rendering previews"),
+    .type             = VARIABLE_TYPE_DURATION,
+    .sample_func      = gimp_dashboard_sample_async_label_time,
+    .data             = "preview"
+  },
+
+  [VARIABLE_ASYNC_TIME_PROJECTION] =
+  { .name             = "async-time-projection",
+    .title            = NC_("dashboard-variable", "Projection"),
+    .description      = N_("Total time spent rendering the projection ahead"),
+    .type             = VARIABLE_TYPE_DURATION,
+    .sample_func      = gimp_dashboard_sample_async_label_time,
+    .data             = "projection"
+  },
+
+  [VARIABLE_ASYNC_TIME_DATA] =
+  { .name             = "async-time-data",
+    .title            = NC_("dashboard-variable", "Data"),
+    .description      = N_("Total time spent loading data"),
+    .type             = VARIABLE_TYPE_DURATION,
+    .sample_func      = gimp_dashboard_sample_async_label_time,
+    .data             = "data"
+  },
+
+  [VARIABLE_ASYNC_TIME_OTHER] =
+  { .name             = "async-time-other",
+    .title            = NC_("dashboard-variable", "Other"),
+    .description      = N_("Total time spent running other tasks"),
+    .type             = VARIABLE_TYPE_DURATION,
+    .sample_func      = gimp_dashboard_sample_async_label_time,
+    .data             = "other"
+  },
+
+
+  /* allocations variables */
+
+  [VARIABLE_ALLOCATIONS_DRAWABLES] =
+  { .name             = "allocations-drawables",
+    .title            = NC_("dashboard-variable", "Drawables"),
+    .description      = N_("Memory allocated for drawable buffers"),
+    .type             = VARIABLE_TYPE_SIZE,
+    .sample_func      = gimp_dashboard_sample_memory_tag,
+    .data             = GINT_TO_POINTER (GIMP_MEMORY_TAG_DRAWABLE)
+  },
+
+  [VARIABLE_ALLOCATIONS_UNDO] =
+  { .name             = "allocations-undo",
+    .title            = NC_("dashboard-variable", "Undo"),
+    .description      = N_("Memory allocated for undo steps"),
+    .type             = VARIABLE_TYPE_SIZE,
+    .sample_func      = gimp_dashboard_sample_memory_tag,
+    .data             = GINT_TO_POINTER (GIMP_MEMORY_TAG_UNDO)
+  },
+
+  [VARIABLE_ALLOCATIONS_PREVIEWS] =
+  { .name             = "allocations-previews",
+    .title            = NC_("dashboard-variable", "Previews"),
+    .description      = N_("Memory allocated for previews"),
+    .type             = VARIABLE_TYPE_SIZE,
+    .sample_func      = gimp_dashboard_sample_memory_tag,
+    .data             = GINT_TO_POINTER (GIMP_MEMORY_TAG_PREVIEW)
+  },
+
+  [VARIABLE_ALLOCATIONS_PAINT] =
+  { .name             = "allocations-paint",
+    .title            = NC_("dashboard-variable", "Paint"),
+    .description      = N_("Memory allocated while painting"),
+    .type             = VARIABLE_TYPE_SIZE,
+    .sample_func      = gimp_dashboard_sample_memory_tag,
+    .data             = GINT_TO_POINTER (GIMP_MEMORY_TAG_PAINT)
+  },
+
+  [VARIABLE_ALLOCATIONS_OTHER] =
+  { .name             = "allocations-other",
+    .title            = NC_("dashboard-variable", "Other"),
+    .description      = N_("Memory allocated for other temporary buffers"),
+    .type             = VARIABLE_TYPE_SIZE,
+    .sample_func      = gimp_dashboard_sample_memory_tag,
+    .data             = GINT_TO_POINTER (GIMP_MEMORY_TAG_OTHER)
+  },
+
+
   /* misc variables */
 
   [VARIABLE_MIPMAPED] =
@@ -764,6 +1207,52 @@ static const VariableInfo variables[] =
     .type             = VARIABLE_TYPE_SIZE,
     .sample_func      = gimp_dashboard_sample_function,
     .data             = gimp_temp_buf_get_total_memsize
+  },
+
+  [VARIABLE_LAYER_STACK_CACHE_TOTAL] =
+  { .name             = "layer-stack-cache-total",
+    .title            = NC_("dashboard-variable", "Stack cache"),
+    .description      = N_("Total size of cached layer stack composites"),
+    .type             = VARIABLE_TYPE_SIZE,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_layer_stack_get_total_cache_memsize
+  },
+
+  [VARIABLE_BRUSH_CACHE_TOTAL] =
+  { .name             = "brush-cache-total",
+    .title            = NC_("dashboard-variable", "Brush cache"),
+    .description      = N_("Total size of cached brush transformations"),
+    .type             = VARIABLE_TYPE_SIZE,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_brush_cache_get_total_memsize
+  },
+
+  [VARIABLE_BRUSH_CACHE_HIT_MISS] =
+  { .name             = "brush-cache-hit-miss",
+    .title            = NC_("dashboard-variable", "Brush hit/miss"),
+    .description      = N_("Brush cache hit/miss ratio"),
+    .type             = VARIABLE_TYPE_INT_RATIO,
+    .sample_func      = gimp_dashboard_sample_brush_cache_hit_miss
+  },
+
+  [VARIABLE_IMAGE_MEMORY_TOTAL] =
+  { .name             = "image-memory-total",
+    .title            = NC_("dashboard-variable", "Images"),
+    .description      = N_("Total memory used by the open images, "
+                           "including their undo history"),
+    .type             = VARIABLE_TYPE_SIZE,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_image_memory_get_total
+  },
+
+  [VARIABLE_IMAGE_MEMORY_MAX] =
+  { .name             = "image-memory-max",
+    .title            = NC_("dashboard-variable", "Largest image"),
+    .description      = N_("Memory used by the largest open image, "
+                           "including its undo history"),
+    .type             = VARIABLE_TYPE_SIZE,
+    .sample_func      = gimp_dashboard_sample_function,
+    .data             = gimp_image_memory_get_max
   }
 };
 
@@ -862,6 +1351,21 @@ static const GroupInfo groups[] =
 
                           { VARIABLE_SEPARATOR },
 
+                          { .variable         = VARIABLE_SWAP_READ_LATENCY,
+                            .default_active   = FALSE
+                          },
+                          { .variable         = VARIABLE_SWAP_READ_LATENCY_P95,
+                            .default_active   = FALSE
+                          },
+                          { .variable         = VARIABLE_SWAP_READ_AHEAD,
+                            .default_active   = FALSE
+                          },
+                          { .variable         = VARIABLE_SWAP_WRITE_DELAY,
+                            .default_active   = FALSE
+                          },
+
+                          { VARIABLE_SEPARATOR },
+
                           { .variable         = VARIABLE_SWAP_COMPRESSION,
                             .default_active   = FALSE
                           },
@@ -950,6 +1454,183 @@ static const GroupInfo groups[] =
   },
 #endif /* HAVE_MEMORY_GROUP */
 
+  /* display group */
+  [GROUP_DISPLAY] =
+  { .name             = "display",
+    .title            = NC_("dashboard-group", "Display"),
+    .description      = N_("Canvas drawing performance"),
+    .default_active   = FALSE,
+    .default_expanded = FALSE,
+    .has_meter        = FALSE,
+    .fields           = (const FieldInfo[])
+                        {
+                          { .variable       = VARIABLE_FRAME_TIME,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_FRAME_TIME_P95,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_FRAME_TIME_P99,
+                            .default_active = TRUE
+                          },
+
+                          { VARIABLE_SEPARATOR },
+
+                          { .variable       = VARIABLE_RENDER_TIME,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_PROJECTION_TIME,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_PROJECTION_CHUNKS,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_CHECKERBOARD_AREA,
+                            .default_active = TRUE
+                          },
+
+                          { VARIABLE_SEPARATOR },
+
+                          { .variable       = VARIABLE_INPUT_LATENCY,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_INPUT_LATENCY_P95,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_INPUT_LATENCY_P99,
+                            .default_active = TRUE
+                          },
+
+                          {}
+                        }
+  },
+
+  /* pdb group */
+  [GROUP_PDB] =
+  { .name             = "pdb",
+    .title            = NC_("dashboard-group", "PDB"),
+    .description      = N_("Procedure call performance"),
+    .default_active   = FALSE,
+    .default_expanded = FALSE,
+    .has_meter        = FALSE,
+    .fields           = (const FieldInfo[])
+                        {
+                          { .variable       = VARIABLE_PDB_CALLS,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_PDB_CALL_RATE,
+                            .default_active = TRUE
+                          },
+
+                          { VARIABLE_SEPARATOR },
+
+                          { .variable       = VARIABLE_PDB_CALL_TIME,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_PDB_MARSHAL_TIME,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_PDB_MAX_TIME,
+                            .default_active = TRUE
+                          },
+
+                          {}
+                        }
+  },
+
+  /* async group */
+  [GROUP_ASYNC] =
+  { .name             = "async",
+    .title            = NC_("dashboard-group", "Async"),
+    .description      = N_("Asynchronous task performance"),
+    .default_active   = FALSE,
+    .default_expanded = FALSE,
+    .has_meter        = FALSE,
+    .fields           = (const FieldInfo[])
+                        {
+                          { .variable       = VARIABLE_ASYNC_QUEUED,
+                            .default_active = TRUE
+                          },
+
+                          { VARIABLE_SEPARATOR },
+
+                          { .variable       = VARIABLE_ASYNC_LATENCY_HIGH,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_ASYNC_LATENCY_DEFAULT,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_ASYNC_LATENCY_LOW,
+                            .default_active = TRUE
+                          },
+
+                          { VARIABLE_SEPARATOR },
+
+                          { .variable       = VARIABLE_ASYNC_DURATION_HIGH,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_ASYNC_DURATION_DEFAULT,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_ASYNC_DURATION_LOW,
+                            .default_active = TRUE
+                          },
+
+                          { VARIABLE_SEPARATOR },
+
+                          { .variable       = VARIABLE_ASYNC_TIME_HISTOGRAM,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_ASYNC_TIME_LINE_ART,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_ASYNC_TIME_PREVIEW,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_ASYNC_TIME_PROJECTION,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_ASYNC_TIME_DATA,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_ASYNC_TIME_OTHER,
+                            .default_active = TRUE
+                          },
+
+                          {}
+                        }
+  },
+
+  /* allocations group */
+  [GROUP_ALLOCATIONS] =
+  { .name             = "allocations",
+    .title            = NC_("dashboard-group", "Allocations"),
+    .description      = N_("Memory allocations by subsystem"),
+    .default_active   = FALSE,
+    .default_expanded = FALSE,
+    .has_meter        = FALSE,
+    .fields           = (const FieldInfo[])
+                        {
+                          { .variable       = VARIABLE_ALLOCATIONS_DRAWABLES,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_ALLOCATIONS_UNDO,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_ALLOCATIONS_PREVIEWS,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_ALLOCATIONS_PAINT,
+                            .default_active = TRUE
+                          },
+                          { .variable       = VARIABLE_ALLOCATIONS_OTHER,
+                            .default_active = TRUE
+                          },
+
+                          {}
+                        }
+  },
+
   /* misc group */
   [GROUP_MISC] =
   { .name             = "misc",
@@ -981,6 +1662,21 @@ static const GroupInfo groups[] =
                           { .variable       = VARIABLE_TEMP_BUF_TOTAL,
                             .default_active = TRUE
                           },
+                          { .variable       = VARIABLE_LAYER_STACK_CACHE_TOTAL,
+                            .default_active = FALSE
+                          },
+                          { .variable       = VARIABLE_BRUSH_CACHE_TOTAL,
+                            .default_active = FALSE
+                          },
+                          { .variable       = VARIABLE_BRUSH_CACHE_HIT_MISS,
+                            .default_active = FALSE
+                          },
+                          { .variable       = VARIABLE_IMAGE_MEMORY_TOTAL,
+                            .default_active = FALSE
+                          },
+                          { .variable       = VARIABLE_IMAGE_MEMORY_MAX,
+                            .default_active = FALSE
+                          },
 
                           {}
                         }
@@ -1419,6 +2115,18 @@ gimp_dashboard_dispose (GObject *object)
       priv->low_swap_space_idle_id = 0;
     }
 
+  if (priv->pdb_profile)
+    {
+      gimp_pdb_profile_stop ();
+      priv->pdb_profile = FALSE;
+    }
+
+  if (priv->memory_tags)
+    {
+      gimp_memory_tags_disable ();
+      priv->memory_tags = FALSE;
+    }
+
   gimp_dashboard_log_stop_recording (dashboard, NULL);
 
   gimp_dashboard_reset_variables (dashboard);
@@ -2038,6 +2746,10 @@ gimp_dashboard_sample_function (GimpDashboard *dashboard,
       variable_data->value.duration = CALL_FUNC (gdouble);
       break;
 
+    case VARIABLE_TYPE_TIME:
+      variable_data->value.time = CALL_FUNC (gdouble);
+      break;
+
     case VARIABLE_TYPE_RATE_OF_CHANGE:
       variable_data->value.rate_of_change = CALL_FUNC (gdouble);
       break;
@@ -2221,6 +2933,85 @@ gimp_dashboard_sample_swap_limit (GimpDashboard *dashboard,
     }
 }
 
+static void
+gimp_dashboard_sample_swap_write_delay (GimpDashboard *dashboard,
+                                        Variable       variable)
+{
+  GimpDashboardPrivate *priv            = dashboard->priv;
+  VariableData         *variable_data   = &priv->variables[variable];
+  const VariableData   *queued_data     = &priv->variables[VARIABLE_SWAP_QUEUED];
+  const VariableData   *throughput_data = &priv->variables[VARIABLE_SWAP_WRITE_THROUGHPUT];
+
+  /* GEGL doesn't time the individual swap writes, so we estimate the delay
+   * from the size of the write queue, and the current write throughput
+   */
+
+  variable_data->available = FALSE;
+
+  if (queued_data->available && throughput_data->available)
+    {
+      if (queued_data->value.size == 0)
+        {
+          variable_data->available  = TRUE;
+          variable_data->value.time = 0.0;
+        }
+      else if (throughput_data->value.rate_of_change > 0.0)
+        {
+          variable_data->available  = TRUE;
+          variable_data->value.time = queued_data->value.size /
+                                      throughput_data->value.rate_of_change;
+        }
+    }
+}
+
+static void
+gimp_dashboard_sample_brush_cache_hit_miss (GimpDashboard *dashboard,
+                                            Variable       variable)
+{
+  GimpDashboardPrivate *priv          = dashboard->priv;
+  VariableData         *variable_data = &priv->variables[variable];
+
+  gimp_brush_cache_get_hit_miss (&variable_data->value.int_ratio.antecedent,
+                                 &variable_data->value.int_ratio.consequent);
+
+  variable_data->available = TRUE;
+}
+
+static void
+gimp_dashboard_sample_async_label_time (GimpDashboard *dashboard,
+                                        Variable       variable)
+{
+  GimpDashboardPrivate *priv          = dashboard->priv;
+  const VariableInfo   *variable_info = &variables[variable];
+  VariableData         *variable_data = &priv->variables[variable];
+
+  variable_data->value.duration =
+    gimp_parallel_get_label_time (variable_info->data);
+
+  variable_data->available = TRUE;
+}
+
+static void
+gimp_dashboard_sample_memory_tag (GimpDashboard *dashboard,
+                                  Variable       variable)
+{
+  GimpDashboardPrivate *priv          = dashboard->priv;
+  const VariableInfo   *variable_info = &variables[variable];
+  VariableData         *variable_data = &priv->variables[variable];
+
+  if (gimp_memory_tags_is_enabled ())
+    {
+      variable_data->value.size =
+        gimp_memory_tags_get_total (GPOINTER_TO_INT (variable_info->data));
+
+      variable_data->available = TRUE;
+    }
+  else
+    {
+      variable_data->available = FALSE;
+    }
+}
+
 #ifdef HAVE_CPU_GROUP
 
 #ifdef HAVE_SYS_TIMES_H
@@ -2800,6 +3591,17 @@ gimp_dashboard_sample_object (GimpDashboard *dashboard,
         }
       break;
 
+    case VARIABLE_TYPE_TIME:
+      if (g_object_class_find_property (klass, variable_info->data))
+        {
+          variable_data->available = TRUE;
+
+          g_object_get (object,
+                        variable_info->data, &variable_data->value.time,
+                        NULL);
+        }
+      break;
+
     case VARIABLE_TYPE_RATE_OF_CHANGE:
       if (g_object_class_find_property (klass, variable_info->data))
         {
@@ -2836,6 +3638,28 @@ gimp_dashboard_update_group (GimpDashboard *dashboard,
   gtk_widget_set_visible (GTK_WIDGET (group_data->expander),
                           group_data->active);
 
+  /*  only profile the pdb while its group is shown  */
+  if (group == GROUP_PDB && group_data->active != priv->pdb_profile)
+    {
+      priv->pdb_profile = group_data->active;
+
+      if (priv->pdb_profile)
+        gimp_pdb_profile_start (FALSE);
+      else
+        gimp_pdb_profile_stop ();
+    }
+
+  /*  likewise, only tag allocations while the allocations group is shown  */
+  if (group == GROUP_ALLOCATIONS && group_data->active != priv->memory_tags)
+    {
+      priv->memory_tags = group_data->active;
+
+      if (priv->memory_tags)
+        gimp_memory_tags_enable ();
+      else
+        gimp_memory_tags_disable ();
+    }
+
   if (! group_data->active)
     return;
 
@@ -3248,6 +4072,9 @@ gimp_dashboard_variable_to_boolean (GimpDashboard *dashboard,
         case VARIABLE_TYPE_DURATION:
           return variable_data->value.duration != 0.0;
 
+        case VARIABLE_TYPE_TIME:
+          return variable_data->value.time != 0.0;
+
         case VARIABLE_TYPE_RATE_OF_CHANGE:
           return variable_data->value.rate_of_change != 0.0;
         }
@@ -3299,6 +4126,9 @@ gimp_dashboard_variable_to_double (GimpDashboard *dashboard,
         case VARIABLE_TYPE_DURATION:
           return variable_data->value.duration;
 
+        case VARIABLE_TYPE_TIME:
+          return variable_data->value.time;
+
         case VARIABLE_TYPE_RATE_OF_CHANGE:
           return variable_data->value.rate_of_change;
         }
@@ -3409,6 +4239,17 @@ gimp_dashboard_field_to_string (GimpDashboard *dashboard,
           show_limit = FALSE;
           break;
 
+        case VARIABLE_TYPE_TIME:
+          /* Translators:  This string reports a short time interval.  The
+           * "%.1f" is replaced by the number of milliseconds, and "ms" is
+           * an abbreviation for "milliseconds".
+           */
+          str        = g_strdup_printf (_("%.1f ms"),
+                                        1000.0 * variable_data->value.time);
+          static_str = FALSE;
+          show_limit = FALSE;
+          break;
+
         case VARIABLE_TYPE_RATE_OF_CHANGE:
           /* Translators:  This string reports the rate of change of a measured
            * value.  The "%g" is replaced by a certain quantity, and the "/s"
@@ -3600,6 +4441,7 @@ gimp_dashboard_log_sample (GimpDashboard *dashboard,
   GimpDashboardPrivate *priv      = dashboard->priv;
   GimpBacktrace        *backtrace = NULL;
   GArray               *addresses = NULL;
+  GArray               *input_latency;
   gboolean              empty     = TRUE;
   Variable              variable;
 
@@ -3710,6 +4552,11 @@ gimp_dashboard_log_sample (GimpDashboard *dashboard,
                     variable_data->value.duration);
                   break;
 
+                case VARIABLE_TYPE_TIME:
+                  LOG_VAR_FLOAT (
+                    variable_data->value.time);
+                  break;
+
                 case VARIABLE_TYPE_RATE_OF_CHANGE:
                   LOG_VAR_FLOAT (
                     variable_data->value.rate_of_change);
@@ -3961,6 +4808,101 @@ gimp_dashboard_log_sample (GimpDashboard *dashboard,
   gimp_backtrace_free (priv->log_backtrace);
   priv->log_backtrace = backtrace;
 
+  if (priv->log_params.memory_tags)
+    {
+      GArray *memory_tags = gimp_memory_tags_get_images ();
+
+      if (! priv->log_memory_tags                          ||
+          memory_tags->len != priv->log_memory_tags->len   ||
+          memcmp (memory_tags->data, priv->log_memory_tags->data,
+                  memory_tags->len * sizeof (GimpMemoryTagsImage)))
+        {
+          guint i;
+
+          NONEMPTY ();
+
+          gimp_dashboard_log_printf (dashboard,
+                                     "<memory-tags>\n");
+
+          for (i = 0; i < memory_tags->len; i++)
+            {
+              const GimpMemoryTagsImage *image;
+              GimpMemoryTag              tag;
+
+              image = &g_array_index (memory_tags, GimpMemoryTagsImage, i);
+
+              gimp_dashboard_log_printf (dashboard,
+                                         "<image id=\"%d\"",
+                                         image->image_id);
+
+              for (tag = GIMP_MEMORY_TAG_OTHER;
+                   tag < GIMP_MEMORY_TAG_N_TAGS;
+                   tag++)
+                {
+                  gimp_dashboard_log_printf (dashboard,
+                                             " %s=\"%lld\"",
+                                             gimp_memory_tags_get_name (tag),
+                                             (long long) image->sizes[tag]);
+                }
+
+              gimp_dashboard_log_printf (dashboard,
+                                         " />\n");
+            }
+
+          gimp_dashboard_log_printf (dashboard,
+                                     "</memory-tags>\n");
+        }
+
+      g_clear_pointer (&priv->log_memory_tags, g_array_unref);
+      priv->log_memory_tags = memory_tags;
+    }
+
+  input_latency = gimp_input_latency_get_tools ();
+
+  if (input_latency->len > 0                                &&
+      (! priv->log_input_latency                            ||
+       input_latency->len != priv->log_input_latency->len   ||
+       memcmp (input_latency->data, priv->log_input_latency->data,
+               input_latency->len * sizeof (GimpInputLatencyTool))))
+    {
+      guint i;
+
+      NONEMPTY ();
+
+      gimp_dashboard_log_printf (dashboard,
+                                 "<input-latency>\n");
+
+      for (i = 0; i < input_latency->len; i++)
+        {
+          const GimpInputLatencyTool *tool;
+          gchar                       mean[G_ASCII_DTOSTR_BUF_SIZE];
+          gchar                       p95[G_ASCII_DTOSTR_BUF_SIZE];
+          gchar                       p99[G_ASCII_DTOSTR_BUF_SIZE];
+
+          tool = &g_array_index (input_latency, GimpInputLatencyTool, i);
+
+          gimp_dashboard_log_printf (dashboard,
+                                     "<tool name=\"");
+          gimp_dashboard_log_print_escaped (dashboard, tool->tool);
+          gimp_dashboard_log_printf (dashboard,
+                                     "\" n=\"%d\" mean=\"%s\" "
+                                     "p95=\"%s\" p99=\"%s\" />\n",
+                                     tool->n_events,
+                                     g_ascii_dtostr (mean, sizeof (mean),
+                                                     tool->mean),
+                                     g_ascii_dtostr (p95, sizeof (p95),
+                                                     tool->p95),
+                                     g_ascii_dtostr (p99, sizeof (p99),
+                                                     tool->p99));
+        }
+
+      gimp_dashboard_log_printf (dashboard,
+                                 "</input-latency>\n");
+    }
+
+  g_clear_pointer (&priv->log_input_latency, g_array_unref);
+  priv->log_input_latency = input_latency;
+
   if (empty)
     {
       gimp_dashboard_log_printf (dashboard,
@@ -4395,6 +5337,9 @@ gimp_dashboard_format_value (VariableType type,
                               (gint) floor (fmod (value / 60.0, 60.0)),
                               floor (fmod (value, 60.0) * 10.0) / 10.0);
 
+    case VARIABLE_TYPE_TIME:
+      return g_strdup_printf (_("%.1f ms"), 1000.0 * value);
+
     case VARIABLE_TYPE_RATE_OF_CHANGE:
       {
         gchar buf[64];
@@ -4495,6 +5440,12 @@ gimp_dashboard_log_start_recording (GimpDashboard                 *dashboard,
         atoi (g_getenv ("GIMP_PERFORMANCE_LOG_PROGRESSIVE")) ? 1 : 0;
     }
 
+  if (g_getenv ("GIMP_PERFORMANCE_LOG_MEMORY_TAGS"))
+    {
+      priv->log_params.memory_tags =
+        atoi (g_getenv ("GIMP_PERFORMANCE_LOG_MEMORY_TAGS")) ? 1 : 0;
+    }
+
   priv->log_params.sample_frequency = CLAMP (priv->log_params.sample_frequency,
                                              LOG_SAMPLE_FREQUENCY_MIN,
                                              LOG_SAMPLE_FREQUENCY_MAX);
@@ -4533,6 +5484,10 @@ gimp_dashboard_log_start_recording (GimpDashboard                 *dashboard,
   else
     has_backtrace = FALSE;
 
+  /*  allocations made before this point are not tagged  */
+  if (priv->log_params.memory_tags)
+    gimp_memory_tags_enable ();
+
   gimp_dashboard_log_printf (dashboard,
                              "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
                              "<gimp-performance-log version=\"%d\">\n",
@@ -4545,11 +5500,13 @@ gimp_dashboard_log_start_recording (GimpDashboard                 *dashboard,
                              "<backtrace>%d</backtrace>\n"
                              "<messages>%d</messages>\n"
                              "<progressive>%d</progressive>\n"
+                             "<memory-tags>%d</memory-tags>\n"
                              "</params>\n",
                              priv->log_params.sample_frequency,
                              has_backtrace,
                              priv->log_params.messages,
-                             priv->log_params.progressive);
+                             priv->log_params.progressive,
+                             priv->log_params.memory_tags);
 
   gimp_dashboard_log_printf (dashboard,
                              "\n"
@@ -4672,6 +5629,7 @@ gimp_dashboard_log_start_recording (GimpDashboard                 *dashboard,
         case VARIABLE_TYPE_INT_RATIO:      type = "int-ratio";      break;
         case VARIABLE_TYPE_PERCENTAGE:     type = "percentage";     break;
         case VARIABLE_TYPE_DURATION:       type = "duration";       break;
+        case VARIABLE_TYPE_TIME:           type = "time";           break;
         case VARIABLE_TYPE_RATE_OF_CHANGE: type = "rate-of-change"; break;
         }
 
@@ -4795,6 +5753,9 @@ gimp_dashboard_log_stop_recording (GimpDashboard  *dashboard,
   if (priv->log_params.backtrace)
     gimp_backtrace_stop ();
 
+  if (priv->log_params.memory_tags)
+    gimp_memory_tags_disable ();
+
   if (! priv->log_error)
     {
       g_output_stream_close (priv->log_output, NULL, &priv->log_error);
@@ -4821,6 +5782,8 @@ gimp_dashboard_log_stop_recording (GimpDashboard  *dashboard,
 
   g_clear_pointer (&priv->log_backtrace, gimp_backtrace_free);
   g_clear_pointer (&priv->log_addresses, g_hash_table_unref);
+  g_clear_pointer (&priv->log_memory_tags, g_array_unref);
+  g_clear_pointer (&priv->log_input_latency, g_array_unref);
 
   g_mutex_unlock (&priv->mutex);
 
@@ -4854,7 +5817,8 @@ gimp_dashboard_log_get_default_params (GimpDashboard *dashboard)
     .sample_frequency = LOG_DEFAULT_SAMPLE_FREQUENCY,
     .backtrace        = LOG_DEFAULT_BACKTRACE,
     .messages         = LOG_DEFAULT_MESSAGES,
-    .progressive      = LOG_DEFAULT_PROGRESSIVE
+    .progressive      = LOG_DEFAULT_PROGRESSIVE,
+    .memory_tags      = LOG_DEFAULT_MEMORY_TAGS
   };
 
   g_return_val_if_fail (GIMP_IS_DASHBOARD (dashboard), NULL);
@@ -29,6 +29,7 @@ struct _GimpDashboardLogParams
   gboolean backtrace;
   gboolean messages;
   gboolean progressive;
+  gboolean memory_tags;
 };
 
 
@@ -676,6 +676,7 @@ gimp_layer_tree_view_insert_item (GimpContainerView *view,
                                   layer_view->priv->model_column_mask,         renderer,
                                   layer_view->priv->model_column_mask_visible, TRUE,
                                   GIMP_CONTAINER_TREE_STORE_COLUMN_RENDERER,   NULL,
+                                  GIMP_CONTAINER_TREE_STORE_COLUMN_VIEWABLE,   NULL,
                                   -1);
               g_object_unref (renderer);
             }
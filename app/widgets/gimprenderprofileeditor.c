@@ -0,0 +1,378 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimprenderprofileeditor.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <gegl.h>
+#include <gtk/gtk.h>
+
+#include "libgimpbase/gimpbase.h"
+#include "libgimpwidgets/gimpwidgets.h"
+
+#include "widgets-types.h"
+
+#include "gegl/gimp-gegl-profile.h"
+
+#include "core/gimpcontainer.h"
+#include "core/gimpdrawable.h"
+#include "core/gimpdrawable-filters.h"
+#include "core/gimpdrawablefilter.h"
+#include "core/gimpimage.h"
+#include "core/gimplayer.h"
+#include "core/gimplist.h"
+
+#include "gimprenderprofileeditor.h"
+
+#include "gimp-intl.h"
+
+
+#define UPDATE_INTERVAL 500 /* milliseconds */
+
+
+enum
+{
+  COLUMN_NAME,
+  COLUMN_KIND,
+  COLUMN_TIME,
+  COLUMN_TIME_TEXT,
+  COLUMN_PIXELS_TEXT,
+  N_COLUMNS
+};
+
+
+static void       gimp_render_profile_editor_constructed   (GObject                 *object);
+static void       gimp_render_profile_editor_dispose       (GObject                 *object);
+
+static void       gimp_render_profile_editor_map           (GtkWidget               *widget);
+static void       gimp_render_profile_editor_unmap         (GtkWidget               *widget);
+
+static void       gimp_render_profile_editor_set_image     (GimpImageEditor         *image_editor,
+                                                            GimpImage               *image);
+
+static void       gimp_render_profile_editor_toggled       (GtkToggleButton         *toggle,
+                                                            GimpRenderProfileEditor *editor);
+static void       gimp_render_profile_editor_reset_clicked (GtkWidget               *widget,
+                                                            GimpRenderProfileEditor *editor);
+
+static void       gimp_render_profile_editor_start_updates (GimpRenderProfileEditor *editor);
+static void       gimp_render_profile_editor_stop_updates  (GimpRenderProfileEditor *editor);
+static gboolean   gimp_render_profile_editor_update        (GimpRenderProfileEditor *editor);
+static void       gimp_render_profile_editor_add           (GimpRenderProfileEditor *editor,
+                                                            GObject                 *owner,
+                                                            const gchar             *name,
+                                                            const gchar             *kind);
+
+
+G_DEFINE_TYPE (GimpRenderProfileEditor, gimp_render_profile_editor,
+               GIMP_TYPE_IMAGE_EDITOR)
+
+#define parent_class gimp_render_profile_editor_parent_class
+
+
+static void
+gimp_render_profile_editor_class_init (GimpRenderProfileEditorClass *klass)
+{
+  GObjectClass         *object_class       = G_OBJECT_CLASS (klass);
+  GtkWidgetClass       *widget_class       = GTK_WIDGET_CLASS (klass);
+  GimpImageEditorClass *image_editor_class = GIMP_IMAGE_EDITOR_CLASS (klass);
+
+  object_class->constructed     = gimp_render_profile_editor_constructed;
+  object_class->dispose         = gimp_render_profile_editor_dispose;
+
+  widget_class->map             = gimp_render_profile_editor_map;
+  widget_class->unmap           = gimp_render_profile_editor_unmap;
+
+  image_editor_class->set_image = gimp_render_profile_editor_set_image;
+}
+
+static void
+gimp_render_profile_editor_init (GimpRenderProfileEditor *editor)
+{
+  GtkWidget         *scrolled_window;
+  GtkTreeViewColumn *column;
+  GtkCellRenderer   *renderer;
+
+  editor->enable_toggle =
+    gtk_check_button_new_with_mnemonic (_("_Profile image rendering"));
+  gtk_box_pack_start (GTK_BOX (editor), editor->enable_toggle,
+                      FALSE, FALSE, 0);
+  gtk_widget_show (editor->enable_toggle);
+
+  gimp_help_set_help_data (editor->enable_toggle,
+                           _("Measure the time spent rendering each layer "
+                             "and filter.  Rendering is slightly slower "
+                             "while profiling."),
+                           NULL);
+
+  gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (editor->enable_toggle),
+                                gimp_gegl_profile_get_enabled ());
+
+  g_signal_connect (editor->enable_toggle, "toggled",
+                    G_CALLBACK (gimp_render_profile_editor_toggled),
+                    editor);
+
+  scrolled_window = gtk_scrolled_window_new (NULL, NULL);
+  gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (scrolled_window),
+                                  GTK_POLICY_AUTOMATIC,
+                                  GTK_POLICY_AUTOMATIC);
+  gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (scrolled_window),
+                                       GTK_SHADOW_IN);
+  gtk_box_pack_start (GTK_BOX (editor), scrolled_window, TRUE, TRUE, 0);
+  gtk_widget_show (scrolled_window);
+
+  editor->store = gtk_list_store_new (N_COLUMNS,
+                                      G_TYPE_STRING,
+                                      G_TYPE_STRING,
+                                      G_TYPE_DOUBLE,
+                                      G_TYPE_STRING,
+                                      G_TYPE_STRING);
+
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (editor->store),
+                                        COLUMN_TIME, GTK_SORT_DESCENDING);
+
+  editor->view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (editor->store));
+  g_object_unref (editor->store);
+
+  gtk_container_add (GTK_CONTAINER (scrolled_window), editor->view);
+  gtk_widget_show (editor->view);
+
+  renderer = gtk_cell_renderer_text_new ();
+  g_object_set (renderer, "ellipsize", PANGO_ELLIPSIZE_END, NULL);
+  column = gtk_tree_view_column_new_with_attributes (_("Name"), renderer,
+                                                     "text", COLUMN_NAME,
+                                                     NULL);
+  gtk_tree_view_column_set_expand (column, TRUE);
+  gtk_tree_view_column_set_sort_column_id (column, COLUMN_NAME);
+  gtk_tree_view_append_column (GTK_TREE_VIEW (editor->view), column);
+
+  renderer = gtk_cell_renderer_text_new ();
+  column = gtk_tree_view_column_new_with_attributes (_("Kind"), renderer,
+                                                     "text", COLUMN_KIND,
+                                                     NULL);
+  gtk_tree_view_column_set_sort_column_id (column, COLUMN_KIND);
+  gtk_tree_view_append_column (GTK_TREE_VIEW (editor->view), column);
+
+  renderer = gtk_cell_renderer_text_new ();
+  g_object_set (renderer, "xalign", 1.0, NULL);
+  column = gtk_tree_view_column_new_with_attributes (_("Time (ms)"), renderer,
+                                                     "text", COLUMN_TIME_TEXT,
+                                                     NULL);
+  gtk_tree_view_column_set_sort_column_id (column, COLUMN_TIME);
+  gtk_tree_view_append_column (GTK_TREE_VIEW (editor->view), column);
+
+  renderer = gtk_cell_renderer_text_new ();
+  g_object_set (renderer, "xalign", 1.0, NULL);
+  column = gtk_tree_view_column_new_with_attributes (_("Megapixels"), renderer,
+                                                     "text", COLUMN_PIXELS_TEXT,
+                                                     NULL);
+  gtk_tree_view_append_column (GTK_TREE_VIEW (editor->view), column);
+
+  gtk_widget_set_sensitive (GTK_WIDGET (editor), FALSE);
+}
+
+static void
+gimp_render_profile_editor_constructed (GObject *object)
+{
+  GimpRenderProfileEditor *editor = GIMP_RENDER_PROFILE_EDITOR (object);
+
+  G_OBJECT_CLASS (parent_class)->constructed (object);
+
+  editor->reset_button =
+    gimp_editor_add_button (GIMP_EDITOR (editor),
+                            GIMP_ICON_RESET, _("Reset the render profile"),
+                            NULL,
+                            G_CALLBACK (gimp_render_profile_editor_reset_clicked),
+                            NULL,
+                            G_OBJECT (editor));
+}
+
+static void
+gimp_render_profile_editor_dispose (GObject *object)
+{
+  GimpRenderProfileEditor *editor = GIMP_RENDER_PROFILE_EDITOR (object);
+
+  gimp_render_profile_editor_stop_updates (editor);
+
+  G_OBJECT_CLASS (parent_class)->dispose (object);
+}
+
+static void
+gimp_render_profile_editor_map (GtkWidget *widget)
+{
+  GTK_WIDGET_CLASS (parent_class)->map (widget);
+
+  gimp_render_profile_editor_start_updates (GIMP_RENDER_PROFILE_EDITOR (widget));
+}
+
+static void
+gimp_render_profile_editor_unmap (GtkWidget *widget)
+{
+  gimp_render_profile_editor_stop_updates (GIMP_RENDER_PROFILE_EDITOR (widget));
+
+  GTK_WIDGET_CLASS (parent_class)->unmap (widget);
+}
+
+static void
+gimp_render_profile_editor_set_image (GimpImageEditor *image_editor,
+                                      GimpImage       *image)
+{
+  GimpRenderProfileEditor *editor = GIMP_RENDER_PROFILE_EDITOR (image_editor);
+
+  GIMP_IMAGE_EDITOR_CLASS (parent_class)->set_image (image_editor, image);
+
+  gtk_widget_set_sensitive (GTK_WIDGET (editor), image != NULL);
+
+  gimp_render_profile_editor_update (editor);
+}
+
+
+/*  public functions  */
+
+GtkWidget *
+gimp_render_profile_editor_new (void)
+{
+  return g_object_new (GIMP_TYPE_RENDER_PROFILE_EDITOR, NULL);
+}
+
+
+/*  private functions  */
+
+static void
+gimp_render_profile_editor_toggled (GtkToggleButton         *toggle,
+                                    GimpRenderProfileEditor *editor)
+{
+  gimp_gegl_profile_set_enabled (gtk_toggle_button_get_active (toggle));
+
+  if (gtk_widget_get_mapped (GTK_WIDGET (editor)))
+    gimp_render_profile_editor_start_updates (editor);
+}
+
+static void
+gimp_render_profile_editor_reset_clicked (GtkWidget               *widget,
+                                          GimpRenderProfileEditor *editor)
+{
+  gimp_gegl_profile_reset ();
+
+  gimp_render_profile_editor_update (editor);
+}
+
+static void
+gimp_render_profile_editor_start_updates (GimpRenderProfileEditor *editor)
+{
+  if (! editor->update_id)
+    {
+      editor->update_id =
+        g_timeout_add (UPDATE_INTERVAL,
+                       (GSourceFunc) gimp_render_profile_editor_update,
+                       editor);
+    }
+
+  gimp_render_profile_editor_update (editor);
+}
+
+static void
+gimp_render_profile_editor_stop_updates (GimpRenderProfileEditor *editor)
+{
+  g_clear_handle_id (&editor->update_id, g_source_remove);
+}
+
+static gboolean
+gimp_render_profile_editor_update (GimpRenderProfileEditor *editor)
+{
+  GimpImage *image = GIMP_IMAGE_EDITOR (editor)->image;
+  GList     *drawables;
+  GList     *list;
+
+  gtk_list_store_clear (editor->store);
+
+  if (! image)
+    return G_SOURCE_CONTINUE;
+
+  drawables = g_list_concat (gimp_image_get_layer_list (image),
+                             gimp_image_get_channel_list (image));
+
+  for (list = drawables; list; list = g_list_next (list))
+    {
+      GimpDrawable  *drawable = list->data;
+      GimpContainer *filters;
+      GList         *iter;
+      const gchar   *kind;
+
+      if (gimp_viewable_get_children (GIMP_VIEWABLE (drawable)))
+        kind = _("Layer Group");
+      else if (GIMP_IS_LAYER (drawable))
+        kind = _("Layer");
+      else
+        kind = _("Channel");
+
+      gimp_render_profile_editor_add (editor, G_OBJECT (drawable),
+                                      gimp_object_get_name (drawable), kind);
+
+      filters = gimp_drawable_get_filters (drawable);
+
+      for (iter = GIMP_LIST (filters)->queue->head;
+           iter;
+           iter = g_list_next (iter))
+        {
+          gchar *name;
+
+          if (! GIMP_IS_DRAWABLE_FILTER (iter->data))
+            continue;
+
+          name = g_strdup_printf ("%s (%s)",
+                                  gimp_object_get_name (iter->data),
+                                  gimp_object_get_name (drawable));
+
+          gimp_render_profile_editor_add (editor, iter->data,
+                                          name, _("Filter"));
+
+          g_free (name);
+        }
+    }
+
+  g_list_free (drawables);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+gimp_render_profile_editor_add (GimpRenderProfileEditor *editor,
+                                GObject                 *owner,
+                                const gchar             *name,
+                                const gchar             *kind)
+{
+  gdouble time;
+  gint64  n_pixels;
+  gchar   time_text[32];
+  gchar   pixels_text[32];
+
+  if (! gimp_gegl_profile_get_stats (owner, &time, &n_pixels))
+    return;
+
+  g_snprintf (time_text,   sizeof (time_text),   "%.1f", 1000.0 * time);
+  g_snprintf (pixels_text, sizeof (pixels_text), "%.2f", n_pixels / 1e6);
+
+  gtk_list_store_insert_with_values (editor->store, NULL, -1,
+                                     COLUMN_NAME,        name,
+                                     COLUMN_KIND,        kind,
+                                     COLUMN_TIME,        time,
+                                     COLUMN_TIME_TEXT,   time_text,
+                                     COLUMN_PIXELS_TEXT, pixels_text,
+                                     -1);
+}
@@ -0,0 +1,55 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * gimprenderprofileeditor.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "gimpimageeditor.h"
+
+
+#define GIMP_TYPE_RENDER_PROFILE_EDITOR            (gimp_render_profile_editor_get_type ())
+#define GIMP_RENDER_PROFILE_EDITOR(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), GIMP_TYPE_RENDER_PROFILE_EDITOR, GimpRenderProfileEditor))
+#define GIMP_RENDER_PROFILE_EDITOR_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), GIMP_TYPE_RENDER_PROFILE_EDITOR, GimpRenderProfileEditorClass))
+#define GIMP_IS_RENDER_PROFILE_EDITOR(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GIMP_TYPE_RENDER_PROFILE_EDITOR))
+#define GIMP_IS_RENDER_PROFILE_EDITOR_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), GIMP_TYPE_RENDER_PROFILE_EDITOR))
+#define GIMP_RENDER_PROFILE_EDITOR_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), GIMP_TYPE_RENDER_PROFILE_EDITOR, GimpRenderProfileEditorClass))
+
+
+typedef struct _GimpRenderProfileEditorClass GimpRenderProfileEditorClass;
+
+struct _GimpRenderProfileEditor
+{
+  GimpImageEditor  parent_instance;
+
+  GtkWidget       *enable_toggle;
+  GtkListStore    *store;
+  GtkWidget       *view;
+  GtkWidget       *reset_button;
+
+  guint            update_id;
+};
+
+struct _GimpRenderProfileEditorClass
+{
+  GimpImageEditorClass  parent_class;
+};
+
+
+GType       gimp_render_profile_editor_get_type (void) G_GNUC_CONST;
+
+GtkWidget * gimp_render_profile_editor_new      (void);
@@ -45,8 +45,8 @@ typedef struct _GimpSaveDialogState GimpSaveDialogState;
 
 struct _GimpSaveDialogState
 {
-  gchar    *filter_name;
-  gboolean  compression;
+  gchar              *filter_name;
+  GimpXcfCompression  compression;
 };
 
 
@@ -58,8 +58,8 @@ static void     gimp_save_dialog_load_state        (GimpFileDialog      *dialog,
                                                     const gchar         *state_name);
 
 static void     gimp_save_dialog_add_extra_widgets (GimpSaveDialog      *dialog);
-static void     gimp_save_dialog_compression_toggled
-                                                   (GtkToggleButton     *button,
+static void     gimp_save_dialog_compression_changed
+                                                   (GtkWidget           *combo,
                                                     GimpSaveDialog      *dialog);
 
 static GimpSaveDialogState
@@ -159,14 +159,13 @@ gimp_save_dialog_set_image (GimpSaveDialog *dialog,
                             GimpObject     *display)
 {
   GimpFileDialog *file_dialog;
-  GtkWidget      *compression_toggle;
   GFile          *dir_file  = NULL;
   GFile          *name_file = NULL;
   GFile          *ext_file  = NULL;
   gchar          *basename;
   const gchar    *version_string;
   gint            rle_version;
-  gint            zlib_version;
+  gint            max_version;
 
   g_return_if_fail (GIMP_IS_SAVE_DIALOG (dialog));
   g_return_if_fail (GIMP_IS_IMAGE (image));
@@ -250,16 +249,21 @@ gimp_save_dialog_set_image (GimpSaveDialog *dialog,
   else
     ext_file = g_file_new_for_uri ("file:///we/only/care/about/extension.xcf");
 
-  gimp_image_get_xcf_version (image, FALSE, &rle_version,
+  gimp_image_get_xcf_version (image, GIMP_XCF_COMPRESSION_RLE,  &rle_version,
                               &version_string, NULL);
-  gimp_image_get_xcf_version (image, TRUE,  &zlib_version,
+  gimp_image_get_xcf_version (image, GIMP_XCF_COMPRESSION_ZLIB, &max_version,
                               NULL, NULL);
-  if (rle_version != zlib_version)
+#if defined (HAVE_ZSTD) || defined (HAVE_LZ4)
+  /* zstd and LZ4 need the same XCF version */
+  gimp_image_get_xcf_version (image, GIMP_XCF_COMPRESSION_ZSTD, &max_version,
+                              NULL, NULL);
+#endif
+  if (rle_version != max_version)
     {
       GtkWidget *label;
       gchar     *text;
 
-      text = g_strdup_printf (_("Keep compression disabled to make the XCF "
+      text = g_strdup_printf (_("Use RLE compression to make the XCF "
                                 "file readable by %s and later."),
                               version_string);
       label = gtk_label_new (text);
@@ -273,13 +277,17 @@ gimp_save_dialog_set_image (GimpSaveDialog *dialog,
       g_free (text);
     }
 
-  compression_toggle = gtk_frame_get_label_widget (GTK_FRAME (dialog->compression_frame));
-  gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (compression_toggle),
-                                gimp_image_get_xcf_compression (image));
-  /* Force a "toggled" signal since gtk_toggle_button_set_active() won't
-   * send it if the button status doesn't change.
+  if (! gimp_int_combo_box_set_active (GIMP_INT_COMBO_BOX (dialog->compression_combo),
+                                       gimp_image_get_xcf_compression (image)))
+    {
+      /* the image was saved with a compression this build doesn't support */
+      gimp_int_combo_box_set_active (GIMP_INT_COMBO_BOX (dialog->compression_combo),
+                                     GIMP_XCF_COMPRESSION_RLE);
+    }
+  /* Force an update since gimp_int_combo_box_set_active() won't emit
+   * "changed" if the active value doesn't change.
    */
-  gtk_toggle_button_toggled (GTK_TOGGLE_BUTTON (compression_toggle));
+  gimp_save_dialog_compression_changed (dialog->compression_combo, dialog);
 
   if (ext_file)
     {
@@ -317,20 +325,59 @@ gimp_save_dialog_set_image (GimpSaveDialog *dialog,
 static void
 gimp_save_dialog_add_extra_widgets (GimpSaveDialog *dialog)
 {
+  static const GimpXcfCompression compressions[] =
+  {
+    GIMP_XCF_COMPRESSION_RLE,
+    GIMP_XCF_COMPRESSION_ZLIB,
+#ifdef HAVE_ZSTD
+    GIMP_XCF_COMPRESSION_ZSTD,
+#endif
+#ifdef HAVE_LZ4
+    GIMP_XCF_COMPRESSION_LZ4,
+#endif
+  };
+
+  GtkWidget *hbox;
   GtkWidget *label;
   GtkWidget *reasons;
-  GtkWidget *compression_toggle;
+  gint       i;
+
+  /* Compression method. */
+  hbox = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 6);
+
+  label = gtk_label_new_with_mnemonic (_("_XCF compression:"));
+  gtk_box_pack_start (GTK_BOX (hbox), label, FALSE, FALSE, 0);
+  gtk_widget_show (label);
+
+  dialog->compression_combo = gimp_int_combo_box_new (NULL, 0);
 
-  /* Compression toggle. */
-  compression_toggle =
-    gtk_check_button_new_with_mnemonic (_("Save this _XCF file with better but slower compression"));
-  gtk_widget_set_tooltip_text (compression_toggle,
-                               _("On edge cases, better compression algorithms might still "
-                                 "end up on bigger file size; manual check recommended"));
+  for (i = 0; i < G_N_ELEMENTS (compressions); i++)
+    {
+      const gchar *desc;
+
+      gimp_enum_get_value (GIMP_TYPE_XCF_COMPRESSION, compressions[i],
+                           NULL, NULL, &desc, NULL);
+
+      gimp_int_combo_box_append (GIMP_INT_COMBO_BOX (dialog->compression_combo),
+                                 GIMP_INT_STORE_VALUE, compressions[i],
+                                 GIMP_INT_STORE_LABEL, desc,
+                                 -1);
+    }
+
+  gtk_widget_set_tooltip_text (dialog->compression_combo,
+                               _("RLE is fast and compatible with all GIMP "
+                                 "versions. zlib makes smaller but slower "
+                                 "to save files. Zstandard compresses about "
+                                 "as well as zlib, much faster, and LZ4 is "
+                                 "the fastest."));
+  gtk_label_set_mnemonic_widget (GTK_LABEL (label), dialog->compression_combo);
+  gtk_box_pack_start (GTK_BOX (hbox), dialog->compression_combo,
+                      FALSE, FALSE, 0);
+  gtk_widget_show (dialog->compression_combo);
 
   dialog->compression_frame = gimp_frame_new (NULL);
-  gtk_frame_set_label_widget (GTK_FRAME (dialog->compression_frame), compression_toggle);
-  gtk_widget_show (compression_toggle);
+  gtk_frame_set_label_widget (GTK_FRAME (dialog->compression_frame), hbox);
+  gtk_widget_show (hbox);
   gimp_file_dialog_add_extra_widget (GIMP_FILE_DIALOG (dialog), dialog->compression_frame,
                                      FALSE, FALSE, 0);
   gtk_widget_show (dialog->compression_frame);
@@ -353,14 +400,14 @@ gimp_save_dialog_add_extra_widgets (GimpSaveDialog *dialog)
                                      FALSE, FALSE, 0);
   gtk_widget_show (dialog->compat_info);
 
-  g_signal_connect (compression_toggle, "toggled",
-                    G_CALLBACK (gimp_save_dialog_compression_toggled),
+  g_signal_connect (dialog->compression_combo, "changed",
+                    G_CALLBACK (gimp_save_dialog_compression_changed),
                     dialog);
 }
 
 static void
-gimp_save_dialog_compression_toggled (GtkToggleButton *button,
-                                      GimpSaveDialog  *dialog)
+gimp_save_dialog_compression_changed (GtkWidget      *combo,
+                                      GimpSaveDialog *dialog)
 {
   const gchar    *version_string = NULL;
   GimpFileDialog *file_dialog    = GIMP_FILE_DIALOG (dialog);
@@ -368,19 +415,17 @@ gimp_save_dialog_compression_toggled (GtkToggleButton *button,
   gchar          *reason         = NULL;
   GtkWidget      *widget;
   GtkTextBuffer  *text_buffer;
+  gint            compression;
   gint            version;
 
   if (! file_dialog->image)
     return;
 
-  dialog->compression = gtk_toggle_button_get_active (button);
+  if (gimp_int_combo_box_get_active (GIMP_INT_COMBO_BOX (combo), &compression))
+    dialog->compression = compression;
 
-  if (dialog->compression)
-    gimp_image_get_xcf_version (file_dialog->image, TRUE,  &version,
-                                &version_string, &reason);
-  else
-    gimp_image_get_xcf_version (file_dialog->image, FALSE, &version,
-                                &version_string, &reason);
+  gimp_image_get_xcf_version (file_dialog->image, dialog->compression,
+                              &version, &version_string, &reason);
 
   /* Only show compatibility information for GIMP over 2.6. The reason
    * is mostly that we don't have details to make a compatibility list
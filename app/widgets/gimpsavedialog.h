@@ -42,8 +42,9 @@ struct _GimpSaveDialog
   GimpObject          *display_to_close;
 
   GtkWidget           *compression_frame;
+  GtkWidget           *compression_combo;
   GtkWidget           *compat_info;
-  gboolean             compression;
+  GimpXcfCompression   compression;
 };
 
 struct _GimpSaveDialogClass
@@ -27,20 +27,44 @@
 
 #include "widgets-types.h"
 
+#include "core/gimpasync.h"
+#include "core/gimpcancelable.h"
 #include "core/gimpimage.h"
+#include "core/gimpimage-preview.h"
 #include "core/gimpimageproxy.h"
 #include "core/gimptempbuf.h"
 
 #include "gimpviewrendererimage.h"
 
 
-static void   gimp_view_renderer_image_render (GimpViewRenderer *renderer,
-                                               GtkWidget        *widget);
+struct _GimpViewRendererImagePrivate
+{
+  GimpAsync *render_async;
+  GtkWidget *render_widget;
+  gboolean   render_update;
+
+  gint       prev_width;
+  gint       prev_height;
+};
+
+
+static void   gimp_view_renderer_image_dispose       (GObject               *object);
+
+static void   gimp_view_renderer_image_invalidate    (GimpViewRenderer      *renderer);
+static void   gimp_view_renderer_image_render        (GimpViewRenderer      *renderer,
+                                                      GtkWidget             *widget);
 
+static void   gimp_view_renderer_image_render_buf    (GimpViewRendererImage *rendererimage,
+                                                      GtkWidget             *widget,
+                                                      GimpTempBuf           *render_buf);
+static void   gimp_view_renderer_image_render_icon   (GimpViewRendererImage *rendererimage,
+                                                      GtkWidget             *widget);
+static void   gimp_view_renderer_image_cancel_render (GimpViewRendererImage *rendererimage);
 
-G_DEFINE_TYPE (GimpViewRendererImage,
-               gimp_view_renderer_image,
-               GIMP_TYPE_VIEW_RENDERER)
+
+G_DEFINE_TYPE_WITH_PRIVATE (GimpViewRendererImage,
+                            gimp_view_renderer_image,
+                            GIMP_TYPE_VIEW_RENDERER)
 
 #define parent_class gimp_view_renderer_image_parent_class
 
@@ -48,27 +72,88 @@ G_DEFINE_TYPE (GimpViewRendererImage,
 static void
 gimp_view_renderer_image_class_init (GimpViewRendererImageClass *klass)
 {
+  GObjectClass          *object_class   = G_OBJECT_CLASS (klass);
   GimpViewRendererClass *renderer_class = GIMP_VIEW_RENDERER_CLASS (klass);
 
-  renderer_class->render = gimp_view_renderer_image_render;
+  object_class->dispose      = gimp_view_renderer_image_dispose;
+
+  renderer_class->invalidate = gimp_view_renderer_image_invalidate;
+  renderer_class->render     = gimp_view_renderer_image_render;
 }
 
 static void
 gimp_view_renderer_image_init (GimpViewRendererImage *renderer)
 {
+  renderer->priv = gimp_view_renderer_image_get_instance_private (renderer);
+
   renderer->channel = -1;
 }
 
+static void
+gimp_view_renderer_image_dispose (GObject *object)
+{
+  GimpViewRendererImage *rendererimage = GIMP_VIEW_RENDERER_IMAGE (object);
+
+  gimp_view_renderer_image_cancel_render (rendererimage);
+
+  G_OBJECT_CLASS (parent_class)->dispose (object);
+}
+
+static void
+gimp_view_renderer_image_invalidate (GimpViewRenderer *renderer)
+{
+  GimpViewRendererImage *rendererimage = GIMP_VIEW_RENDERER_IMAGE (renderer);
+
+  gimp_view_renderer_image_cancel_render (rendererimage);
+
+  GIMP_VIEW_RENDERER_CLASS (parent_class)->invalidate (renderer);
+}
+
+static void
+gimp_view_renderer_image_render_async_callback (GimpAsync             *async,
+                                                GimpViewRendererImage *rendererimage)
+{
+  GtkWidget *widget;
+
+  /* rendering was canceled, see
+   * gimp_view_renderer_image_cancel_render().  bail.
+   */
+  if (gimp_async_is_canceled (async))
+    return;
+
+  widget = rendererimage->priv->render_widget;
+
+  rendererimage->priv->render_async  = NULL;
+  rendererimage->priv->render_widget = NULL;
+
+  if (gimp_async_is_finished (async))
+    {
+      GimpViewRenderer *renderer = GIMP_VIEW_RENDERER (rendererimage);
+
+      gimp_view_renderer_image_render_buf (rendererimage, widget,
+                                           gimp_temp_buf_ref (
+                                             gimp_async_get_result (async)));
+
+      if (rendererimage->priv->render_update)
+        gimp_view_renderer_update (renderer);
+    }
+
+  g_object_unref (widget);
+}
+
 static void
 gimp_view_renderer_image_render (GimpViewRenderer *renderer,
                                  GtkWidget        *widget)
 {
   GimpViewRendererImage *rendererimage = GIMP_VIEW_RENDERER_IMAGE (renderer);
   GimpImage             *image;
-  const gchar           *icon_name;
   gint                   width;
   gint                   height;
 
+  /* render is already in progress */
+  if (rendererimage->priv->render_async)
+    return;
+
   if (GIMP_IS_IMAGE (renderer->viewable))
     {
       image = GIMP_IMAGE (renderer->viewable);
@@ -128,6 +213,51 @@ gimp_view_renderer_image_render (GimpViewRenderer *renderer,
               gimp_temp_buf_unref (temp_buf);
             }
         }
+      else if (GIMP_IS_IMAGE (renderer->viewable))
+        {
+          /* downscaled image previews, as used by the navigation view
+           * and the images dialog, are rendered asynchronously, so that
+           * large images don't block the UI
+           */
+          GimpAsync *async;
+
+          async = gimp_image_get_preview_async (image,
+                                                view_width, view_height);
+
+          rendererimage->priv->render_async  = async;
+          rendererimage->priv->render_widget = g_object_ref (widget);
+          rendererimage->priv->render_update = FALSE;
+
+          gimp_async_add_callback_for_object (
+            async,
+            (GimpAsyncCallback) gimp_view_renderer_image_render_async_callback,
+            rendererimage,
+            rendererimage);
+
+          /* if rendering isn't done yet, update the render-view once it
+           * is, and either keep the old preview for now, or, if size
+           * changed (or there's no old preview,) render an icon in the
+           * meantime.
+           */
+          if (rendererimage->priv->render_async)
+            {
+              rendererimage->priv->render_update = TRUE;
+
+              if (renderer->width  != rendererimage->priv->prev_width ||
+                  renderer->height != rendererimage->priv->prev_height)
+                {
+                  gimp_view_renderer_image_render_icon (rendererimage,
+                                                        widget);
+                }
+            }
+
+          rendererimage->priv->prev_width  = renderer->width;
+          rendererimage->priv->prev_height = renderer->height;
+
+          g_object_unref (async);
+
+          return;
+        }
       else
         {
           render_buf = gimp_viewable_get_new_preview (renderer->viewable,
@@ -138,42 +268,81 @@ gimp_view_renderer_image_render (GimpViewRenderer *renderer,
 
       if (render_buf)
         {
-          gint render_buf_x    = 0;
-          gint render_buf_y    = 0;
-          gint component_index = -1;
+          rendererimage->priv->prev_width  = renderer->width;
+          rendererimage->priv->prev_height = renderer->height;
 
-          /*  xresolution != yresolution */
-          if (view_width > renderer->width || view_height > renderer->height)
-            {
-              GimpTempBuf *temp_buf;
+          gimp_view_renderer_image_render_buf (rendererimage, widget,
+                                               render_buf);
 
-              temp_buf = gimp_temp_buf_scale (render_buf,
-                                              renderer->width, renderer->height);
-              gimp_temp_buf_unref (render_buf);
-              render_buf = temp_buf;
-            }
+          return;
+        }
+    }
 
-          if (view_width  < renderer->width)
-            render_buf_x = (renderer->width  - view_width)  / 2;
+  rendererimage->priv->prev_width  = 0;
+  rendererimage->priv->prev_height = 0;
 
-          if (view_height < renderer->height)
-            render_buf_y = (renderer->height - view_height) / 2;
+  gimp_view_renderer_image_render_icon (rendererimage, widget);
+}
+
+/* takes ownership of 'render_buf' */
+static void
+gimp_view_renderer_image_render_buf (GimpViewRendererImage *rendererimage,
+                                     GtkWidget             *widget,
+                                     GimpTempBuf           *render_buf)
+{
+  GimpViewRenderer *renderer        = GIMP_VIEW_RENDERER (rendererimage);
+  gint              view_width      = gimp_temp_buf_get_width  (render_buf);
+  gint              view_height     = gimp_temp_buf_get_height (render_buf);
+  gint              render_buf_x    = 0;
+  gint              render_buf_y    = 0;
+  gint              component_index = -1;
+
+  /*  xresolution != yresolution */
+  if (view_width > renderer->width || view_height > renderer->height)
+    {
+      GimpTempBuf *temp_buf;
 
-          if (rendererimage->channel != -1)
-            component_index =
-              gimp_image_get_component_index (image, rendererimage->channel);
+      temp_buf = gimp_temp_buf_scale (render_buf,
+                                      renderer->width, renderer->height);
+      gimp_temp_buf_unref (render_buf);
+      render_buf = temp_buf;
+    }
 
-          gimp_view_renderer_render_temp_buf (renderer, widget, render_buf,
-                                              render_buf_x, render_buf_y,
-                                              component_index,
-                                              GIMP_VIEW_BG_CHECKS,
-                                              GIMP_VIEW_BG_WHITE);
-          gimp_temp_buf_unref (render_buf);
+  if (view_width  < renderer->width)
+    render_buf_x = (renderer->width  - view_width)  / 2;
 
-          return;
-        }
+  if (view_height < renderer->height)
+    render_buf_y = (renderer->height - view_height) / 2;
+
+  if (rendererimage->channel != -1)
+    {
+      GimpImage *image;
+
+      if (GIMP_IS_IMAGE (renderer->viewable))
+        image = GIMP_IMAGE (renderer->viewable);
+      else
+        image = gimp_image_proxy_get_image (
+          GIMP_IMAGE_PROXY (renderer->viewable));
+
+      component_index =
+        gimp_image_get_component_index (image, rendererimage->channel);
     }
 
+  gimp_view_renderer_render_temp_buf (renderer, widget, render_buf,
+                                      render_buf_x, render_buf_y,
+                                      component_index,
+                                      GIMP_VIEW_BG_CHECKS,
+                                      GIMP_VIEW_BG_WHITE);
+  gimp_temp_buf_unref (render_buf);
+}
+
+static void
+gimp_view_renderer_image_render_icon (GimpViewRendererImage *rendererimage,
+                                      GtkWidget             *widget)
+{
+  GimpViewRenderer *renderer = GIMP_VIEW_RENDERER (rendererimage);
+  const gchar      *icon_name;
+
   switch (rendererimage->channel)
     {
     case GIMP_CHANNEL_RED:     icon_name = GIMP_ICON_CHANNEL_RED;     break;
@@ -192,3 +361,22 @@ gimp_view_renderer_image_render (GimpViewRenderer *renderer,
                                   icon_name,
                                   gtk_widget_get_scale_factor (widget));
 }
+
+static void
+gimp_view_renderer_image_cancel_render (GimpViewRendererImage *rendererimage)
+{
+  /* cancel the async render operation (if one is ongoing) without actually
+   * waiting for it.  the render itself is shared with other views
+   * requesting the same preview, and keeps going for as long as any of
+   * them is interested in it.
+   */
+  if (rendererimage->priv->render_async)
+    {
+      gimp_cancelable_cancel (
+        GIMP_CANCELABLE (rendererimage->priv->render_async));
+
+      rendererimage->priv->render_async = NULL;
+    }
+
+  g_clear_object (&rendererimage->priv->render_widget);
+}
@@ -31,13 +31,16 @@
 #define GIMP_VIEW_RENDERER_IMAGE_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), GIMP_TYPE_VIEW_RENDERER_IMAGE, GimpViewRendererImageClass))
 
 
-typedef struct _GimpViewRendererImageClass  GimpViewRendererImageClass;
+typedef struct _GimpViewRendererImageClass   GimpViewRendererImageClass;
+typedef struct _GimpViewRendererImagePrivate GimpViewRendererImagePrivate;
 
 struct _GimpViewRendererImage
 {
-  GimpViewRenderer parent_instance;
+  GimpViewRenderer              parent_instance;
 
-  GimpChannelType     channel;
+  GimpChannelType               channel;
+
+  GimpViewRendererImagePrivate *priv;
 };
 
 struct _GimpViewRendererImageClass
@@ -75,6 +75,7 @@ typedef struct _GimpColormapEditor           GimpColormapEditor;
 typedef struct _GimpComponentEditor          GimpComponentEditor;
 typedef struct _GimpHistogramEditor          GimpHistogramEditor;
 typedef struct _GimpImageEditor              GimpImageEditor;
+typedef struct _GimpRenderProfileEditor      GimpRenderProfileEditor;
 typedef struct _GimpSamplePointEditor        GimpSamplePointEditor;
 typedef struct _GimpSelectionEditor          GimpSelectionEditor;
 typedef struct _GimpSymmetryEditor           GimpSymmetryEditor;
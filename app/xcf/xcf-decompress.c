@@ -0,0 +1,394 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <zlib.h>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+
+#include <cairo.h>
+#include <gegl.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+#include "core/core-types.h"
+
+#include "xcf-private.h"
+#include "xcf-decompress.h"
+#include "xcf-read.h"
+#include "xcf-utils.h"
+
+
+static gboolean   xcf_decompress_tile_none (const GeglRectangle *tile_rect,
+                                            gint                 bpp,
+                                            const guchar        *data,
+                                            gsize                data_length,
+                                            guchar              *tile_data);
+static gboolean   xcf_decompress_tile_rle  (const GeglRectangle *tile_rect,
+                                            gint                 bpp,
+                                            const guchar        *data,
+                                            gsize                data_length,
+                                            guchar              *tile_data);
+static gboolean   xcf_decompress_tile_zlib (const GeglRectangle *tile_rect,
+                                            gint                 bpp,
+                                            const guchar        *data,
+                                            gsize                data_length,
+                                            guchar              *tile_data);
+#ifdef HAVE_ZSTD
+static gboolean   xcf_decompress_tile_zstd (const GeglRectangle *tile_rect,
+                                            gint                 bpp,
+                                            const guchar        *data,
+                                            gsize                data_length,
+                                            guchar              *tile_data);
+#endif
+#ifdef HAVE_LZ4
+static gboolean   xcf_decompress_tile_lz4  (const GeglRectangle *tile_rect,
+                                            gint                 bpp,
+                                            const guchar        *data,
+                                            gsize                data_length,
+                                            guchar              *tile_data);
+#endif
+
+
+/*  public functions  */
+
+/* decompresses the on-disk data of a single tile, of 'data_length' bytes at
+ * 'data', into 'tile_data', which must be large enough to hold 'tile_rect' in
+ * 'format'.  the pixel data is converted to the native byte order.
+ * 'nonzero' is set to whether the tile has any nonzero content, in which case
+ * it needs to be written to the drawable's buffer.
+ *
+ * this function doesn't touch any global state, and may be called from any
+ * thread.
+ */
+gboolean
+xcf_decompress_tile (XcfCompressionType   compression,
+                     gint                 file_version,
+                     const Babl          *format,
+                     const GeglRectangle *tile_rect,
+                     const guchar        *data,
+                     gsize                data_length,
+                     guchar              *tile_data,
+                     gboolean            *nonzero)
+{
+  gint     bpp       = babl_format_get_bytes_per_pixel (format);
+  gint     tile_size = bpp * tile_rect->width * tile_rect->height;
+  gboolean success;
+
+  *nonzero = FALSE;
+
+  switch (compression)
+    {
+    case COMPRESS_NONE:
+      success = xcf_decompress_tile_none (tile_rect, bpp, data, data_length,
+                                          tile_data);
+      break;
+
+    case COMPRESS_RLE:
+      success = xcf_decompress_tile_rle (tile_rect, bpp, data, data_length,
+                                         tile_data);
+      break;
+
+    case COMPRESS_ZLIB:
+      success = xcf_decompress_tile_zlib (tile_rect, bpp, data, data_length,
+                                          tile_data);
+      break;
+
+#ifdef HAVE_ZSTD
+    case COMPRESS_ZSTD:
+      success = xcf_decompress_tile_zstd (tile_rect, bpp, data, data_length,
+                                          tile_data);
+      break;
+#endif
+
+#ifdef HAVE_LZ4
+    case COMPRESS_LZ4:
+      success = xcf_decompress_tile_lz4 (tile_rect, bpp, data, data_length,
+                                         tile_data);
+      break;
+#endif
+
+    default:
+      success = FALSE;
+      break;
+    }
+
+  if (! success)
+    return FALSE;
+
+  *nonzero = ! xcf_data_is_zero (tile_data, tile_size);
+
+  if (*nonzero && file_version >= 12)
+    {
+      gint n_components = babl_format_get_n_components (format);
+
+      xcf_read_from_be (bpp / n_components, tile_data,
+                        tile_size / bpp * n_components);
+    }
+
+  return TRUE;
+}
+
+
+/*  private functions  */
+
+static gboolean
+xcf_decompress_tile_none (const GeglRectangle *tile_rect,
+                          gint                 bpp,
+                          const guchar        *data,
+                          gsize                data_length,
+                          guchar              *tile_data)
+{
+  gsize tile_size = bpp * tile_rect->width * tile_rect->height;
+
+  if (data_length < tile_size)
+    return FALSE;
+
+  memcpy (tile_data, data, tile_size);
+
+  return TRUE;
+}
+
+static gboolean
+xcf_decompress_tile_rle (const GeglRectangle *tile_rect,
+                         gint                 bpp,
+                         const guchar        *data,
+                         gsize                data_length,
+                         guchar              *tile_data)
+{
+  const guchar *xcfdata      = data;
+  const guchar *xcfdatalimit = &data[data_length - 1];
+  gint          i;
+
+  for (i = 0; i < bpp; i++)
+    {
+      guchar *dest  = tile_data + i;
+      gint    size  = tile_rect->width * tile_rect->height;
+      guchar  val;
+      gint    length;
+      gint    j;
+
+      while (size > 0)
+        {
+          if (xcfdata > xcfdatalimit)
+            return FALSE;
+
+          val = *xcfdata++;
+
+          length = val;
+          if (length >= 128)
+            {
+              length = 255 - (length - 1);
+              if (length == 128)
+                {
+                  if (xcfdata >= xcfdatalimit)
+                    return FALSE;
+
+                  length = (*xcfdata << 8) + xcfdata[1];
+                  xcfdata += 2;
+                }
+
+              size -= length;
+
+              if (size < 0)
+                return FALSE;
+
+              if (&xcfdata[length - 1] > xcfdatalimit)
+                return FALSE;
+
+              while (length-- > 0)
+                {
+                  *dest = *xcfdata++;
+                  dest += bpp;
+                }
+            }
+          else
+            {
+              length += 1;
+              if (length == 128)
+                {
+                  if (xcfdata >= xcfdatalimit)
+                    return FALSE;
+
+                  length = (*xcfdata << 8) + xcfdata[1];
+                  xcfdata += 2;
+                }
+
+              size -= length;
+
+              if (size < 0)
+                return FALSE;
+
+              if (xcfdata > xcfdatalimit)
+                return FALSE;
+
+              val = *xcfdata++;
+
+              for (j = 0; j < length; j++)
+                {
+                  *dest = val;
+                  dest += bpp;
+                }
+            }
+        }
+    }
+
+  return TRUE;
+}
+
+static gboolean
+xcf_decompress_tile_zlib (const GeglRectangle *tile_rect,
+                          gint                 bpp,
+                          const guchar        *data,
+                          gsize                data_length,
+                          guchar              *tile_data)
+{
+  z_stream strm;
+  int      action;
+  int      status;
+
+  strm.next_out  = tile_data;
+  strm.avail_out = bpp * tile_rect->width * tile_rect->height;
+
+  strm.zalloc    = Z_NULL;
+  strm.zfree     = Z_NULL;
+  strm.opaque    = Z_NULL;
+  strm.next_in   = (guchar *) data;
+  strm.avail_in  = data_length;
+
+  /* Initialize the stream decompression. */
+  status = inflateInit (&strm);
+  if (status != Z_OK)
+    return FALSE;
+
+  action = Z_NO_FLUSH;
+
+  while (status == Z_OK)
+    {
+      if (strm.avail_in == 0)
+        {
+          action = Z_FINISH;
+        }
+
+      status = inflate (&strm, action);
+
+      if (status == Z_STREAM_END)
+        {
+          /* All the data was successfully decoded. */
+          break;
+        }
+      else if (status == Z_BUF_ERROR)
+        {
+          g_printerr ("xcf: decompressed tile bigger than the expected size.");
+          inflateEnd (&strm);
+          return FALSE;
+        }
+      else if (status != Z_OK)
+        {
+          g_printerr ("xcf: tile decompression failed: %s", zError (status));
+          inflateEnd (&strm);
+          return FALSE;
+        }
+    }
+
+  inflateEnd (&strm);
+
+  return TRUE;
+}
+
+#ifdef HAVE_ZSTD
+static gboolean
+xcf_decompress_tile_zstd (const GeglRectangle *tile_rect,
+                          gint                 bpp,
+                          const guchar        *data,
+                          gsize                data_length,
+                          guchar              *tile_data)
+{
+  gsize  tile_size = bpp * tile_rect->width * tile_rect->height;
+  size_t frame_size;
+  size_t size;
+
+  /* the data of the last tile of a level isn't delimited in the file, so
+   * only decode the first frame.
+   */
+  frame_size = ZSTD_findFrameCompressedSize (data, data_length);
+  if (ZSTD_isError (frame_size))
+    {
+      g_printerr ("xcf: tile decompression failed: %s",
+                  ZSTD_getErrorName (frame_size));
+      return FALSE;
+    }
+
+  size = ZSTD_decompress (tile_data, tile_size, data, frame_size);
+  if (ZSTD_isError (size))
+    {
+      g_printerr ("xcf: tile decompression failed: %s",
+                  ZSTD_getErrorName (size));
+      return FALSE;
+    }
+  else if (size != tile_size)
+    {
+      g_printerr ("xcf: decompressed tile size doesn't match.");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+#endif
+
+#ifdef HAVE_LZ4
+static gboolean
+xcf_decompress_tile_lz4 (const GeglRectangle *tile_rect,
+                         gint                 bpp,
+                         const guchar        *data,
+                         gsize                data_length,
+                         guchar              *tile_data)
+{
+  gint    tile_size = bpp * tile_rect->width * tile_rect->height;
+  guint32 block_size;
+  gint    size;
+
+  /* LZ4 blocks aren't self-delimiting, so each tile starts with the
+   * size of its block.
+   */
+  if (data_length < 4)
+    return FALSE;
+
+  memcpy (&block_size, data, 4);
+  block_size = GUINT32_FROM_BE (block_size);
+
+  if (block_size > data_length - 4)
+    return FALSE;
+
+  size = LZ4_decompress_safe ((const gchar *) data + 4, (gchar *) tile_data,
+                              block_size, tile_size);
+  if (size != tile_size)
+    {
+      g_printerr ("xcf: tile decompression failed.");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+#endif
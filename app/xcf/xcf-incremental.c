@@ -0,0 +1,552 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* incremental saving of XCF files.
+ *
+ * for every drawable that was loaded from, or saved to, an XCF file, we
+ * remember where its hierarchy (the image data, including all the tile
+ * levels) lives in that file, and watch the drawable's buffer for
+ * changes.  when the image is saved again, the hierarchies of the
+ * drawables that didn't change since are copied verbatim from the
+ * previous file, only relocating the offsets they contain, instead of
+ * compressing all their tiles again.
+ *
+ * the new file is still written from start to end, so it never contains
+ * any stale data.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <cairo.h>
+#include <gegl.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+#include "core/core-types.h"
+
+#include "gegl/gimptilehandlervalidate.h"
+
+#include "core/gimpdrawable.h"
+#include "core/gimpimage.h"
+
+#include "xcf-private.h"
+#include "xcf-incremental.h"
+#include "xcf-write.h"
+
+
+#define XCF_SOURCE_KEY "xcf-incremental-source"
+#define XCF_BLOCK_KEY  "xcf-incremental-block"
+
+/* the size of a dummy level: width, height and a 32-bit zero */
+#define XCF_DUMMY_LEVEL_SIZE 12
+
+
+typedef struct _XcfSource XcfSource;
+typedef struct _XcfBlock  XcfBlock;
+
+/*  the XCF file an image was last loaded from, or saved to  */
+struct _XcfSource
+{
+  GFile              *file;
+  gchar              *etag;
+  goffset             size;
+
+  gint                file_version;
+  XcfCompressionType  compression;
+  gint                bytes_per_offset;
+  guint               serial;
+};
+
+/*  the location of a drawable's hierarchy in that file  */
+struct _XcfBlock
+{
+  guint               serial;
+  GeglBuffer         *buffer;
+  const Babl         *format;
+  gulong              changed_handler;
+  gint                dirty;
+
+  goffset             start;
+  goffset             end;
+};
+
+
+static gboolean   xcf_incremental_query_file     (GFile               *file,
+                                                  gchar              **etag,
+                                                  goffset             *size);
+static void       xcf_incremental_source_free    (XcfSource           *source);
+static void       xcf_incremental_block_free     (XcfBlock            *block);
+static void       xcf_incremental_buffer_changed (GeglBuffer          *buffer,
+                                                  const GeglRectangle *rect,
+                                                  XcfBlock            *block);
+static gboolean   xcf_incremental_is_volatile    (GimpDrawable        *drawable);
+static gboolean   xcf_incremental_relocate       (XcfInfo             *info,
+                                                  GeglBuffer          *buffer,
+                                                  guchar              *data,
+                                                  gsize                length,
+                                                  goffset              old_start,
+                                                  goffset              new_start);
+
+
+static gint xcf_incremental_serial = 0;
+
+
+/*  public functions  */
+
+void
+xcf_incremental_begin (XcfInfo   *info,
+                       GimpImage *image)
+{
+  XcfSource         *source;
+  GFileInputStream  *input;
+  gchar             *etag;
+  goffset            size;
+
+  g_return_if_fail (info != NULL);
+  g_return_if_fail (image == NULL || GIMP_IS_IMAGE (image));
+
+  info->serial = (guint) g_atomic_int_add (&xcf_incremental_serial, 1) + 1;
+
+  /* when loading, there is nothing to reuse */
+  if (! info->output || ! info->file || ! image)
+    return;
+
+  source = g_object_get_data (G_OBJECT (image), XCF_SOURCE_KEY);
+
+  if (! source)
+    return;
+
+  /* the pixel data of the hierarchies must be encoded the same way, and
+   * their offsets must be of the same size
+   */
+  if (source->compression      != info->compression      ||
+      source->bytes_per_offset != info->bytes_per_offset ||
+      (source->file_version >= 12) != (info->file_version >= 12))
+    {
+      return;
+    }
+
+  /* make sure the file wasn't modified since, which covers the case where
+   * the output stream truncated it in place, if we are saving over it
+   */
+  if (! xcf_incremental_query_file (source->file, &etag, &size))
+    return;
+
+  if (g_strcmp0 (etag, source->etag) || size != source->size)
+    {
+      g_free (etag);
+
+      return;
+    }
+
+  g_free (etag);
+
+  input = g_file_read (source->file, NULL, NULL);
+
+  if (! input)
+    return;
+
+  if (! g_seekable_can_seek (G_SEEKABLE (input)))
+    {
+      g_object_unref (input);
+
+      return;
+    }
+
+  info->reuse_input  = G_INPUT_STREAM (input);
+  info->reuse_serial = source->serial;
+}
+
+void
+xcf_incremental_end (XcfInfo   *info,
+                     GimpImage *image,
+                     GFile     *file,
+                     gboolean   success)
+{
+  g_return_if_fail (info != NULL);
+  g_return_if_fail (image == NULL || GIMP_IS_IMAGE (image));
+  g_return_if_fail (file == NULL || G_IS_FILE (file));
+
+  if (info->reuse_input)
+    {
+      g_input_stream_close (info->reuse_input, NULL, NULL);
+      g_clear_object (&info->reuse_input);
+    }
+
+  if (success && image && file)
+    {
+      XcfSource *source = g_slice_new0 (XcfSource);
+
+      if (! xcf_incremental_query_file (file, &source->etag, &source->size))
+        {
+          g_slice_free (XcfSource, source);
+
+          g_object_set_data (G_OBJECT (image), XCF_SOURCE_KEY, NULL);
+
+          return;
+        }
+
+      source->file             = g_object_ref (file);
+      source->file_version     = info->file_version;
+      source->compression      = info->compression;
+      source->bytes_per_offset = info->bytes_per_offset;
+      source->serial           = info->serial;
+
+      g_object_set_data_full (G_OBJECT (image), XCF_SOURCE_KEY, source,
+                              (GDestroyNotify) xcf_incremental_source_free);
+    }
+}
+
+void
+xcf_incremental_remember (XcfInfo      *info,
+                          GimpDrawable *drawable,
+                          goffset       start,
+                          goffset       end)
+{
+  GeglBuffer *buffer;
+  XcfBlock   *block;
+
+  g_return_if_fail (info != NULL);
+  g_return_if_fail (GIMP_IS_DRAWABLE (drawable));
+
+  /* memory streams can't be reused */
+  if (! info->file)
+    return;
+
+  if (end <= start || xcf_incremental_is_volatile (drawable))
+    {
+      g_object_set_data (G_OBJECT (drawable), XCF_BLOCK_KEY, NULL);
+
+      return;
+    }
+
+  buffer = gimp_drawable_get_buffer (drawable);
+
+  block = g_slice_new0 (XcfBlock);
+
+  block->serial = info->serial;
+  block->buffer = buffer;
+  block->format = gegl_buffer_get_format (buffer);
+  block->start  = start;
+  block->end    = end;
+
+  g_object_add_weak_pointer (G_OBJECT (buffer), (gpointer) &block->buffer);
+
+  block->changed_handler =
+    gegl_buffer_signal_connect (buffer, "changed",
+                                G_CALLBACK (xcf_incremental_buffer_changed),
+                                block);
+
+  g_object_set_data_full (G_OBJECT (drawable), XCF_BLOCK_KEY, block,
+                          (GDestroyNotify) xcf_incremental_block_free);
+}
+
+gboolean
+xcf_incremental_copy (XcfInfo       *info,
+                      GimpDrawable  *drawable,
+                      gboolean      *copied,
+                      GError       **error)
+{
+  GeglBuffer *buffer;
+  XcfBlock   *block;
+  guchar     *data;
+  gsize       length;
+  gsize       bytes_read;
+  goffset     start;
+
+  g_return_val_if_fail (info != NULL, FALSE);
+  g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), FALSE);
+  g_return_val_if_fail (copied != NULL, FALSE);
+
+  *copied = FALSE;
+
+  if (! info->reuse_input)
+    return TRUE;
+
+  buffer = gimp_drawable_get_buffer (drawable);
+  block  = g_object_get_data (G_OBJECT (drawable), XCF_BLOCK_KEY);
+
+  if (! block                                       ||
+      block->serial != info->reuse_serial           ||
+      block->buffer != buffer                       ||
+      block->format != gegl_buffer_get_format (buffer) ||
+      g_atomic_int_get (&block->dirty)              ||
+      xcf_incremental_is_volatile (drawable))
+    {
+      return TRUE;
+    }
+
+  length = block->end - block->start;
+
+  if (length > G_MAXINT)
+    return TRUE;
+
+  data = g_try_malloc (length);
+
+  if (! data)
+    return TRUE;
+
+  start = info->cp;
+
+  /* any failure up to this point simply falls back to encoding the
+   * buffer again
+   */
+  if (! g_seekable_seek (G_SEEKABLE (info->reuse_input), block->start,
+                         G_SEEK_SET, NULL, NULL)                      ||
+      ! g_input_stream_read_all (info->reuse_input, data, length,
+                                 &bytes_read, NULL, NULL)              ||
+      bytes_read != length                                             ||
+      ! xcf_incremental_relocate (info, buffer, data, length,
+                                  block->start, start))
+    {
+      g_free (data);
+
+      return TRUE;
+    }
+
+  if (xcf_write_int8 (info, data, (gint) length, error) != length)
+    {
+      g_free (data);
+
+      return FALSE;
+    }
+
+  g_free (data);
+
+  *copied = TRUE;
+
+  return TRUE;
+}
+
+
+/*  private functions  */
+
+static gboolean
+xcf_incremental_query_file (GFile    *file,
+                            gchar   **etag,
+                            goffset  *size)
+{
+  GFileInfo *file_info;
+
+  file_info = g_file_query_info (file,
+                                 G_FILE_ATTRIBUTE_ETAG_VALUE ","
+                                 G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                                 G_FILE_QUERY_INFO_NONE,
+                                 NULL, NULL);
+
+  if (! file_info)
+    return FALSE;
+
+  if (! g_file_info_get_etag (file_info))
+    {
+      g_object_unref (file_info);
+
+      return FALSE;
+    }
+
+  *etag = g_strdup (g_file_info_get_etag (file_info));
+  *size = g_file_info_get_size (file_info);
+
+  g_object_unref (file_info);
+
+  return TRUE;
+}
+
+static void
+xcf_incremental_source_free (XcfSource *source)
+{
+  g_object_unref (source->file);
+  g_free (source->etag);
+
+  g_slice_free (XcfSource, source);
+}
+
+static void
+xcf_incremental_block_free (XcfBlock *block)
+{
+  if (block->buffer)
+    {
+      g_signal_handler_disconnect (block->buffer, block->changed_handler);
+      g_object_remove_weak_pointer (G_OBJECT (block->buffer),
+                                    (gpointer) &block->buffer);
+    }
+
+  g_slice_free (XcfBlock, block);
+}
+
+static void
+xcf_incremental_buffer_changed (GeglBuffer          *buffer,
+                                const GeglRectangle *rect,
+                                XcfBlock            *block)
+{
+  /* this can be called from any thread */
+  g_atomic_int_set (&block->dirty, TRUE);
+}
+
+static gboolean
+xcf_incremental_is_volatile (GimpDrawable *drawable)
+{
+  GeglBuffer *buffer = gimp_drawable_get_buffer (drawable);
+
+  /* the projections of group layers, and other rendered buffers, are not
+   * modified through the buffer's usual API, and their "changed" signal
+   * can't be trusted
+   */
+  return (gimp_viewable_get_children (GIMP_VIEWABLE (drawable)) != NULL ||
+          gimp_tile_handler_validate_get_assigned (buffer)       != NULL);
+}
+
+static inline goffset
+xcf_incremental_get_offset (const guchar *data,
+                            gint          bytes_per_offset)
+{
+  if (bytes_per_offset == 4)
+    {
+      guint32 offset;
+
+      memcpy (&offset, data, sizeof (offset));
+
+      return GUINT32_FROM_BE (offset);
+    }
+  else
+    {
+      guint64 offset;
+
+      memcpy (&offset, data, sizeof (offset));
+
+      return GUINT64_FROM_BE (offset);
+    }
+}
+
+static inline void
+xcf_incremental_set_offset (guchar  *data,
+                            gint     bytes_per_offset,
+                            goffset  value)
+{
+  if (bytes_per_offset == 4)
+    {
+      guint32 offset = GUINT32_TO_BE ((guint32) value);
+
+      memcpy (data, &offset, sizeof (offset));
+    }
+  else
+    {
+      guint64 offset = GUINT64_TO_BE ((guint64) value);
+
+      memcpy (data, &offset, sizeof (offset));
+    }
+}
+
+/* checks that 'data' holds a hierarchy laid out the way xcf_save_buffer()
+ * writes it -- the offset table, the top level with its tiles, followed by
+ * the dummy levels -- and moves all the offsets it contains from
+ * 'old_start' to 'new_start'.
+ */
+static gboolean
+xcf_incremental_relocate (XcfInfo    *info,
+                          GeglBuffer *buffer,
+                          guchar     *data,
+                          gsize       length,
+                          goffset     old_start,
+                          goffset     new_start)
+{
+  const gint bpo       = info->bytes_per_offset;
+  goffset    old_end   = old_start + length;
+  goffset    level     = 0;
+  goffset    tiles_end = old_end;
+  goffset    prev;
+  gsize      pos;
+  gint       n_levels  = 0;
+  guint32    header[3];
+
+  if (length < sizeof (header))
+    return FALSE;
+
+  memcpy (header, data, sizeof (header));
+
+  if ((gint) GUINT32_FROM_BE (header[0]) != gegl_buffer_get_width (buffer)  ||
+      (gint) GUINT32_FROM_BE (header[1]) != gegl_buffer_get_height (buffer) ||
+      (gint) GUINT32_FROM_BE (header[2]) !=
+      babl_format_get_bytes_per_pixel (gegl_buffer_get_format (buffer)))
+    {
+      return FALSE;
+    }
+
+  /* the level offsets.  the levels must come in order, with the dummy
+   * levels after the top level's tiles, the last one ending the block.
+   */
+  prev = 0;
+
+  for (pos = sizeof (header); ; pos += bpo, n_levels++)
+    {
+      goffset offset;
+
+      if (pos + bpo > length)
+        return FALSE;
+
+      offset = xcf_incremental_get_offset (data + pos, bpo);
+
+      if (offset == 0)
+        break;
+
+      if (offset <= prev || offset < old_start + pos + bpo || offset >= old_end)
+        return FALSE;
+
+      if (n_levels == 0)
+        level = offset - old_start;
+      else if (n_levels == 1)
+        tiles_end = offset;
+
+      xcf_incremental_set_offset (data + pos, bpo,
+                                  offset - old_start + new_start);
+
+      prev = offset;
+    }
+
+  if (n_levels == 0)
+    return FALSE;
+
+  if (n_levels > 1 && prev + XCF_DUMMY_LEVEL_SIZE != old_end)
+    return FALSE;
+
+  /* the top level's tile offsets */
+  prev = 0;
+
+  for (pos = level + 8; ; pos += bpo)
+    {
+      goffset offset;
+
+      if (pos + bpo > length)
+        return FALSE;
+
+      offset = xcf_incremental_get_offset (data + pos, bpo);
+
+      if (offset == 0)
+        break;
+
+      if (offset <= prev || offset < old_start + pos + bpo || offset >= tiles_end)
+        return FALSE;
+
+      xcf_incremental_set_offset (data + pos, bpo,
+                                  offset - old_start + new_start);
+
+      prev = offset;
+    }
+
+  return TRUE;
+}
@@ -18,7 +18,6 @@
 #include "config.h"
 
 #include <string.h>
-#include <zlib.h>
 
 #include <cairo.h>
 #include <gegl.h>
@@ -32,6 +31,7 @@
 #include "core/core-types.h"
 
 #include "config/gimpcoreconfig.h"
+#include "config/gimpgeglconfig.h"
 
 #include "gegl/gimp-babl.h"
 #include "gegl/gimp-gegl-tile-compat.h"
@@ -88,9 +88,12 @@
 #include "text/gimptextlayer-xcf.h"
 
 #include "xcf-private.h"
+#include "xcf-decompress.h"
+#include "xcf-incremental.h"
 #include "xcf-load.h"
 #include "xcf-read.h"
 #include "xcf-seek.h"
+#include "xcf-tile-handler.h"
 #include "xcf-utils.h"
 
 #include "gimp-log.h"
@@ -156,6 +159,31 @@ typedef struct
   GimpMatrix3           matrix;
 } LayerTransformData;
 
+/* Per thread data for xcf_load_tile_parallel */
+typedef struct
+{
+  /* Common to all jobs. */
+  GeglBuffer         *buffer;
+  gint                file_version;
+  XcfCompressionType  compression;
+
+  /* Job specific. */
+  gint                tile;
+  gint                batch_size;
+
+  /* Compressed tile data, read by the loading thread. */
+  guchar             *in_data;
+  gsize               in_data_size;
+  gsize               in_data_offset[XCF_TILE_LOAD_BATCH_SIZE];
+  gsize               in_data_len[XCF_TILE_LOAD_BATCH_SIZE];
+
+  /* Temp data to avoid too many allocations. */
+  guchar             *tile_data;
+
+  /* Return data. */
+  gboolean            success;
+} XcfLoadJobData;
+
 static void            xcf_load_add_masks     (GimpImage     *image);
 static void            xcf_load_add_effects   (XcfInfo       *info,
                                                GimpImage     *image);
@@ -210,23 +238,20 @@ static GimpPath      * xcf_load_path          (XcfInfo       *info,
 static GimpLayerMask * xcf_load_layer_mask    (XcfInfo       *info,
                                                GimpImage     *image);
 static gboolean        xcf_load_buffer        (XcfInfo       *info,
-                                               GeglBuffer    *buffer);
+                                               GimpDrawable  *drawable);
 static gboolean        xcf_load_level         (XcfInfo       *info,
                                                GeglBuffer    *buffer);
+static gboolean        xcf_load_level_parallel (XcfInfo       *info,
+                                                GeglBuffer    *buffer,
+                                                const goffset *offset_table,
+                                                gint           ntiles);
+static void            xcf_load_free_job_data (XcfLoadJobData *data);
+static void            xcf_load_tile_parallel (XcfLoadJobData *job_data,
+                                               GAsyncQueue    *queue);
 static gboolean        xcf_load_tile          (XcfInfo       *info,
                                                GeglBuffer    *buffer,
                                                GeglRectangle *tile_rect,
                                                const Babl    *format);
-static gboolean        xcf_load_tile_rle      (XcfInfo       *info,
-                                               GeglBuffer    *buffer,
-                                               GeglRectangle *tile_rect,
-                                               const Babl    *format,
-                                               gint           data_length);
-static gboolean        xcf_load_tile_zlib     (XcfInfo       *info,
-                                               GeglBuffer    *buffer,
-                                               GeglRectangle *tile_rect,
-                                               const Babl    *format,
-                                               gint           data_length);
 static GimpParasite  * xcf_load_parasite      (XcfInfo       *info);
 static gboolean        xcf_load_old_paths     (XcfInfo       *info,
                                                GimpImage     *image);
@@ -1387,26 +1412,46 @@ xcf_load_image_props (XcfInfo   *info,
 
         case PROP_COMPRESSION:
           {
-            guint8 compression;
+            guint8             compression;
+            GimpXcfCompression xcf_compression;
 
             xcf_read_int8 (info, (guint8 *) &compression, 1);
 
-            if ((compression != COMPRESS_NONE) &&
-                (compression != COMPRESS_RLE) &&
-                (compression != COMPRESS_ZLIB) &&
-                (compression != COMPRESS_FRACTAL))
+            switch (compression)
               {
+              case COMPRESS_NONE:
+              case COMPRESS_RLE:
+                xcf_compression = GIMP_XCF_COMPRESSION_RLE;
+                break;
+
+              case COMPRESS_ZLIB:
+              case COMPRESS_FRACTAL:
+                xcf_compression = GIMP_XCF_COMPRESSION_ZLIB;
+                break;
+
+#ifdef HAVE_ZSTD
+              case COMPRESS_ZSTD:
+                xcf_compression = GIMP_XCF_COMPRESSION_ZSTD;
+                break;
+#endif
+
+#ifdef HAVE_LZ4
+              case COMPRESS_LZ4:
+                xcf_compression = GIMP_XCF_COMPRESSION_LZ4;
+                break;
+#endif
+
+              default:
                 gimp_message (info->gimp, G_OBJECT (info->progress),
                               GIMP_MESSAGE_ERROR,
-                              "Unknown compression type: %d",
+                              "Unknown or unsupported compression type: %d",
                               (gint) compression);
                 return FALSE;
               }
 
             info->compression = compression;
 
-            gimp_image_set_xcf_compression (image,
-                                            compression >= COMPRESS_ZLIB);
+            gimp_image_set_xcf_compression (image, xcf_compression);
 
             GIMP_LOG (XCF, "prop compression=%d", compression);
           }
@@ -3509,8 +3554,7 @@ xcf_load_layer (XcfInfo    *info,
 
       GIMP_LOG (XCF, "loading buffer");
 
-      if (! xcf_load_buffer (info,
-                             gimp_drawable_get_buffer (GIMP_DRAWABLE (layer))))
+      if (! xcf_load_buffer (info, GIMP_DRAWABLE (layer)))
         goto error;
 
       GIMP_LOG (XCF, "buffer loaded");
@@ -3690,8 +3734,7 @@ xcf_load_channel (XcfInfo   *info,
   if (! xcf_seek_pos (info, hierarchy_offset, NULL))
     goto error;
 
-  if (! xcf_load_buffer (info,
-                         gimp_drawable_get_buffer (GIMP_DRAWABLE (channel))))
+  if (! xcf_load_buffer (info, GIMP_DRAWABLE (channel)))
     goto error;
 
   xcf_progress_update (info);
@@ -4229,8 +4272,7 @@ xcf_load_layer_mask (XcfInfo   *info,
   if (! xcf_seek_pos (info, hierarchy_offset, NULL))
     goto error;
 
-  if (! xcf_load_buffer (info,
-                         gimp_drawable_get_buffer (GIMP_DRAWABLE (layer_mask))))
+  if (! xcf_load_buffer (info, GIMP_DRAWABLE (layer_mask)))
     goto error;
 
   xcf_progress_update (info);
@@ -4258,18 +4300,25 @@ xcf_load_layer_mask (XcfInfo   *info,
 }
 
 static gboolean
-xcf_load_buffer (XcfInfo    *info,
-                 GeglBuffer *buffer)
+xcf_load_buffer (XcfInfo      *info,
+                 GimpDrawable *drawable)
 {
+  GeglBuffer *buffer = gimp_drawable_get_buffer (drawable);
   const Babl *format;
+  goffset     start;
   goffset     offset;
+  goffset     level_offset;
+  goffset     end = 0;
   gint        width;
   gint        height;
   gint        bpp;
+  gint        nlevels;
   goffset     cur_offset;
 
   format = gegl_buffer_get_format (buffer);
 
+  start = info->cp;
+
   xcf_read_int32 (info, (guint32 *) &width,  1);
   xcf_read_int32 (info, (guint32 *) &height, 1);
   xcf_read_int32 (info, (guint32 *) &bpp,    1);
@@ -4291,6 +4340,22 @@ xcf_load_buffer (XcfInfo    *info,
       return FALSE;
     }
 
+  /* the levels below the first are dummies, which follow the top level.
+   * the end of the last one is the end of the hierarchy, which lets an
+   * incremental save copy it as a whole.
+   */
+  for (nlevels = 1; ; nlevels++)
+    {
+      if (xcf_read_offset (info, &level_offset, 1) < info->bytes_per_offset ||
+          level_offset == 0)
+        break;
+
+      end = level_offset + 12;
+    }
+
+  if (nlevels < 2)
+    end = 0;
+
   /* seek to the level offset */
   if (! xcf_seek_pos (info, offset, NULL))
     return FALSE;
@@ -4302,6 +4367,8 @@ xcf_load_buffer (XcfInfo    *info,
   /* discard levels below first.
    */
 
+  xcf_incremental_remember (info, drawable, start, end);
+
   return TRUE;
 }
 
@@ -4312,9 +4379,8 @@ xcf_load_level (XcfInfo    *info,
 {
   const Babl *format;
   gint        bpp;
-  goffset     saved_pos;
-  goffset     offset;
-  goffset     offset2;
+  goffset     table_end;
+  goffset    *offset_table;
   goffset     max_data_length;
   gint        n_tile_rows;
   gint        n_tile_cols;
@@ -4322,7 +4388,7 @@ xcf_load_level (XcfInfo    *info,
   gint        width;
   gint        height;
   gint        i;
-  gint        fail;
+  gboolean    success;
 
   format = gegl_buffer_get_format (buffer);
   bpp    = babl_format_get_bytes_per_pixel (format);
@@ -4341,61 +4407,68 @@ xcf_load_level (XcfInfo    *info,
   max_data_length = XCF_TILE_WIDTH * XCF_TILE_HEIGHT * bpp *
                     XCF_TILE_MAX_DATA_LENGTH_FACTOR /* = 1.5, currently */;
 
-  /* read in the first tile offset.
-   *  if it is '0', then this tile level is empty
-   *  and we can simply return.
-   */
-  if (xcf_read_offset (info, &offset, 1) < info->bytes_per_offset)
-    {
-      GIMP_LOG (XCF, "Failed to read tile offset"
-                " at offset: %" G_GOFFSET_FORMAT, info->cp);
-      return FALSE;
-    }
-  if (offset == 0)
-    return TRUE;
-
   n_tile_rows = gimp_gegl_buffer_get_n_tile_rows (buffer, XCF_TILE_HEIGHT);
   n_tile_cols = gimp_gegl_buffer_get_n_tile_cols (buffer, XCF_TILE_WIDTH);
 
   ntiles = n_tile_rows * n_tile_cols;
-  for (i = 0; i < ntiles; i++)
-    {
-      GeglRectangle rect;
-
-      fail = FALSE;
-
-      if (offset == 0)
-        {
-          gimp_message_literal (info->gimp, G_OBJECT (info->progress),
-                                GIMP_MESSAGE_ERROR,
-                                "not enough tiles found in level");
-          return FALSE;
-        }
 
-      /* save the current position as it is where the
-       *  next tile offset is stored.
-       */
-      saved_pos = info->cp;
+  /* read in the whole offset table up front, so that the tile data can be
+   * read sequentially afterwards.  a '0' offset marks the table's end.  if
+   * the first offset is '0', then this tile level is empty and we can simply
+   * return.
+   *
+   * Do not use g_alloca since it may cause Stack Overflow on large images,
+   * see issue #6138.
+   */
+  offset_table = g_new (goffset, ntiles + 1);
 
-      /* read in the offset of the next tile so we can calculate the amount
-       * of data needed for this tile
-       */
-      if (xcf_read_offset (info, &offset2, 1) < info->bytes_per_offset)
+  for (i = 0; i <= ntiles; i++)
+    {
+      if (xcf_read_offset (info, &offset_table[i], 1) < info->bytes_per_offset)
         {
           GIMP_LOG (XCF, "Failed to read tile offset"
                     " at offset: %" G_GOFFSET_FORMAT, info->cp);
+          g_free (offset_table);
           return FALSE;
         }
 
-      /* if the offset is 0 then we need to read in the maximum possible
-       * allowing for negative compression
-       */
-      if (offset2 == 0)
-        offset2 = offset + max_data_length;
+      if (offset_table[i] == 0)
+        break;
+    }
 
-      /* seek to the tile offset */
-      if (! xcf_seek_pos (info, offset, NULL))
-        return FALSE;
+  table_end = info->cp;
+
+  if (i == 0)
+    {
+      g_free (offset_table);
+      return TRUE;
+    }
+  else if (i < ntiles)
+    {
+      gimp_message_literal (info->gimp, G_OBJECT (info->progress),
+                            GIMP_MESSAGE_ERROR,
+                            "not enough tiles found in level");
+      g_free (offset_table);
+      return FALSE;
+    }
+  else if (i > ntiles)
+    {
+      gimp_message (info->gimp, G_OBJECT (info->progress), GIMP_MESSAGE_ERROR,
+                    "encountered garbage after reading level: %" G_GOFFSET_FORMAT,
+                    offset_table[ntiles]);
+      g_free (offset_table);
+      return FALSE;
+    }
+
+  /* the last tile's data length is unknown, so we need to read in the
+   * maximum possible allowing for negative compression
+   */
+  offset_table[ntiles] = offset_table[ntiles - 1] + max_data_length;
+
+  for (i = 0; i < ntiles; i++)
+    {
+      goffset offset  = offset_table[i];
+      goffset offset2 = offset_table[i + 1];
 
       if (offset2 < offset || offset2 - offset > max_data_length)
         {
@@ -4403,355 +4476,327 @@ xcf_load_level (XcfInfo    *info,
                         GIMP_MESSAGE_ERROR,
                         "invalid tile data length: %" G_GOFFSET_FORMAT,
                         offset2 - offset);
+          g_free (offset_table);
           return FALSE;
         }
+    }
 
-      /* get buffer rectangle to write to */
-      gimp_gegl_buffer_get_tile_rect (buffer,
-                                      XCF_TILE_WIDTH, XCF_TILE_HEIGHT,
-                                      i, &rect);
+  /* when the file is mapped, the tiles are only decoded when they are
+   * first accessed.
+   */
+  if (info->mapped                          &&
+      info->compression != COMPRESS_FRACTAL &&
+      xcf_tile_handler_attach (buffer, info->mapped,
+                               info->file_version,
+                               info->compression,
+                               offset_table, ntiles))
+    {
+      g_free (offset_table);
 
-      GIMP_LOG (XCF, "loading tile %d/%d", i + 1, ntiles);
+      return xcf_seek_pos (info, table_end, NULL);
+    }
 
-      /* read in the tile */
-      switch (info->compression)
+  switch (info->compression)
+    {
+    case COMPRESS_NONE:
+      success = TRUE;
+
+      for (i = 0; success && i < ntiles; i++)
         {
-        case COMPRESS_NONE:
-          if (! xcf_load_tile (info, buffer, &rect, format))
-            fail = TRUE;
-          break;
-        case COMPRESS_RLE:
-          if (! xcf_load_tile_rle (info, buffer, &rect, format,
-                                   offset2 - offset))
-            fail = TRUE;
-          break;
-        case COMPRESS_ZLIB:
-          if (! xcf_load_tile_zlib (info, buffer, &rect, format,
-                                    offset2 - offset))
-            fail = TRUE;
-          break;
-        case COMPRESS_FRACTAL:
-          g_printerr ("xcf: fractal compression unimplemented. "
-                      "Possibly corrupt XCF file.");
-          fail = TRUE;
-          break;
-        default:
-          g_printerr ("xcf: unknown compression. "
-                      "Possibly corrupt XCF file.");
-          fail = TRUE;
-          break;
-        }
+          GeglRectangle rect;
 
-      if (fail)
-        return FALSE;
+          /* seek to the tile offset */
+          if (! xcf_seek_pos (info, offset_table[i], NULL))
+            {
+              success = FALSE;
+              break;
+            }
 
-      GIMP_LOG (XCF, "loaded tile %d/%d", i + 1, ntiles);
+          /* get buffer rectangle to write to */
+          gimp_gegl_buffer_get_tile_rect (buffer,
+                                          XCF_TILE_WIDTH, XCF_TILE_HEIGHT,
+                                          i, &rect);
 
-      /* restore the saved position so we'll be ready to
-       *  read the next offset.
-       */
-      if (!xcf_seek_pos (info, saved_pos, NULL))
-        return FALSE;
+          GIMP_LOG (XCF, "loading tile %d/%d", i + 1, ntiles);
 
-      /* read in the offset of the next tile */
-      if (xcf_read_offset (info, &offset, 1) < info->bytes_per_offset)
-        {
-          GIMP_LOG (XCF, "Failed to read tile offset"
-                    " at offset: %" G_GOFFSET_FORMAT, info->cp);
-          return FALSE;
-        }
-    }
+          success = xcf_load_tile (info, buffer, &rect, format);
 
-  if (offset != 0)
-    {
-      gimp_message (info->gimp, G_OBJECT (info->progress), GIMP_MESSAGE_ERROR,
-                    "encountered garbage after reading level: %" G_GOFFSET_FORMAT,
-                    offset);
-      return FALSE;
-    }
+          GIMP_LOG (XCF, "loaded tile %d/%d", i + 1, ntiles);
+        }
+      break;
 
-  return TRUE;
-}
+    case COMPRESS_RLE:
+    case COMPRESS_ZLIB:
+    case COMPRESS_ZSTD:
+    case COMPRESS_LZ4:
+      success = xcf_load_level_parallel (info, buffer, offset_table, ntiles);
+      break;
 
-static gboolean
-xcf_load_tile (XcfInfo       *info,
-               GeglBuffer    *buffer,
-               GeglRectangle *tile_rect,
-               const Babl    *format)
-{
-  gint    bpp       = babl_format_get_bytes_per_pixel (format);
-  gint    tile_size = bpp * tile_rect->width * tile_rect->height;
-  guchar *tile_data = g_alloca (tile_size);
+    case COMPRESS_FRACTAL:
+      g_printerr ("xcf: fractal compression unimplemented. "
+                  "Possibly corrupt XCF file.");
+      success = FALSE;
+      break;
 
-  if (info->file_version <= 11)
-    {
-      xcf_read_int8 (info, tile_data, tile_size);
+    default:
+      g_printerr ("xcf: unknown compression. "
+                  "Possibly corrupt XCF file.");
+      success = FALSE;
+      break;
     }
-  else
-    {
-      gint n_components = babl_format_get_n_components (format);
 
-      xcf_read_component (info, bpp / n_components, tile_data,
-                          tile_size / bpp * n_components);
-    }
+  g_free (offset_table);
 
-  if (! xcf_data_is_zero (tile_data, tile_size))
-    {
-      gegl_buffer_set (buffer, tile_rect, 0, format, tile_data,
-                       GEGL_AUTO_ROWSTRIDE);
-    }
+  /* leave the stream right after the offset table, as if the tiles had
+   * been read in between reading the offsets.
+   */
+  if (success && ! xcf_seek_pos (info, table_end, NULL))
+    success = FALSE;
 
-  return TRUE;
+  return success;
 }
 
+/* reads the compressed data of the level's tiles sequentially, and hands it,
+ * in batches, to a thread pool which decompresses the tiles and writes them
+ * into 'buffer'.  'offset_table' has 'ntiles' + 1 entries, the last of which
+ * is the end of the last tile's data.
+ */
 static gboolean
-xcf_load_tile_rle (XcfInfo       *info,
-                   GeglBuffer    *buffer,
-                   GeglRectangle *tile_rect,
-                   const Babl    *format,
-                   gint           data_length)
+xcf_load_level_parallel (XcfInfo       *info,
+                         GeglBuffer    *buffer,
+                         const goffset *offset_table,
+                         gint           ntiles)
 {
-  gint    bpp       = babl_format_get_bytes_per_pixel (format);
-  gint    tile_size = bpp * tile_rect->width * tile_rect->height;
-  guchar *tile_data = g_alloca (tile_size);
-  guchar  nonzero   = FALSE;
-  gsize   bytes_read;
-  gint    i;
-  guchar *xcfdata;
-  guchar *xcfodata;
-  guchar *xcfdatalimit;
-
-  /* Workaround for bug #357809: avoid crashing on g_malloc() and skip
-   * this tile (return TRUE without storing data) as if it did not
-   * contain any data.  It is better than returning FALSE, which would
-   * skip the whole hierarchy while there may still be some valid
-   * tiles in the file.
+  const Babl      *format;
+  XcfLoadJobData  *job_data;
+  GThreadPool     *pool;
+  GAsyncQueue     *queue;
+  gint             num_processors;
+  gint             num_tasks;
+  gint             n_jobs    = 0;
+  gint             tile_size;
+  gboolean         success   = TRUE;
+  gint             i;
+
+  num_processors = GIMP_GEGL_CONFIG (info->gimp->config)->num_processors;
+  num_tasks      = num_processors * 2;
+
+  format    = gegl_buffer_get_format (buffer);
+  tile_size = XCF_TILE_WIDTH * XCF_TILE_HEIGHT *
+              babl_format_get_bytes_per_pixel (format);
+
+  /* finished jobs are returned through 'queue', and are then reused for the
+   * next batch, so at most 'num_tasks' batches are held in memory at once.
    */
-  if (data_length <= 0)
-    return TRUE;
+  queue = g_async_queue_new ();
+  pool  = g_thread_pool_new_full ((GFunc) xcf_load_tile_parallel,
+                                  queue,
+                                  (GDestroyNotify) xcf_load_free_job_data,
+                                  num_processors, TRUE, NULL);
 
-  xcfdata = xcfodata = g_alloca (data_length);
-
-  /* we have to read directly instead of xcf_read_* because we may be
-   * reading past the end of the file here
-   */
-  g_input_stream_read_all (info->input, xcfdata, data_length,
-                           &bytes_read, NULL, NULL);
-  info->cp += bytes_read;
+  for (i = 0; i < ntiles; )
+    {
+      gsize in_data_size = 0;
+      gint  k;
 
-  if (bytes_read == 0)
-    return TRUE;
+      if (n_jobs < num_tasks)
+        {
+          job_data = g_new0 (XcfLoadJobData, 1);
 
-  xcfdatalimit = &xcfodata[bytes_read - 1];
+          job_data->buffer       = buffer;
+          job_data->file_version = info->file_version;
+          job_data->compression  = info->compression;
+          job_data->tile_data    = g_malloc (tile_size);
+          job_data->success      = TRUE;
 
-  for (i = 0; i < bpp; i++)
-    {
-      guchar *data  = tile_data + i;
-      gint    size  = tile_rect->width * tile_rect->height;
-      gint    count = 0;
-      guchar  val;
-      gint    length;
-      gint    j;
-
-      while (size > 0)
+          n_jobs++;
+        }
+      else
         {
-          if (xcfdata > xcfdatalimit)
+          job_data = g_async_queue_pop (queue);
+
+          if (! job_data->success)
             {
-              goto bogus_rle;
-            }
+              success = FALSE;
 
-          val = *xcfdata++;
+              g_async_queue_push (queue, job_data);
 
-          length = val;
-          if (length >= 128)
-            {
-              length = 255 - (length - 1);
-              if (length == 128)
-                {
-                  if (xcfdata >= xcfdatalimit)
-                    {
-                      goto bogus_rle;
-                    }
+              break;
+            }
+        }
 
-                  length = (*xcfdata << 8) + xcfdata[1];
-                  xcfdata += 2;
-                }
+      job_data->tile       = i;
+      job_data->batch_size = MIN (XCF_TILE_LOAD_BATCH_SIZE, ntiles - i);
 
-              count += length;
-              size -= length;
+      for (k = 0; k < job_data->batch_size; k++)
+        in_data_size += offset_table[i + k + 1] - offset_table[i + k];
 
-              if (size < 0)
-                {
-                  goto bogus_rle;
-                }
+      if (in_data_size > job_data->in_data_size)
+        {
+          g_free (job_data->in_data);
 
-              if (&xcfdata[length-1] > xcfdatalimit)
-                {
-                  goto bogus_rle;
-                }
+          job_data->in_data      = g_malloc (in_data_size);
+          job_data->in_data_size = in_data_size;
+        }
 
-              while (length-- > 0)
-                {
-                  *data = *xcfdata++;
-                  nonzero |= *data;
-                  data += bpp;
-                }
-            }
-          else
-            {
-              length += 1;
-              if (length == 128)
-                {
-                  if (xcfdata >= xcfdatalimit)
-                    {
-                      goto bogus_rle;
-                    }
+      in_data_size = 0;
 
-                  length = (*xcfdata << 8) + xcfdata[1];
-                  xcfdata += 2;
-                }
+      for (k = 0; k < job_data->batch_size; k++)
+        {
+          goffset offset      = offset_table[i + k];
+          gsize   data_length = offset_table[i + k + 1] - offset;
+          gsize   bytes_read  = 0;
 
-              count += length;
-              size -= length;
+          GIMP_LOG (XCF, "reading tile %d/%d", i + k + 1, ntiles);
 
-              if (size < 0)
+          if (data_length > 0)
+            {
+              if (! xcf_seek_pos (info, offset, NULL))
                 {
-                  goto bogus_rle;
+                  success = FALSE;
+                  break;
                 }
 
-              if (xcfdata > xcfdatalimit)
-                {
-                  goto bogus_rle;
-                }
+              /* we have to read directly instead of xcf_read_* because we
+               * may be reading past the end of the file here
+               */
+              g_input_stream_read_all (info->input,
+                                       job_data->in_data + in_data_size,
+                                       data_length,
+                                       &bytes_read, NULL, NULL);
+              info->cp += bytes_read;
+            }
 
-              val = *xcfdata++;
-              nonzero |= val;
+          job_data->in_data_offset[k] = in_data_size;
+          job_data->in_data_len[k]    = bytes_read;
 
-              for (j = 0; j < length; j++)
-                {
-                  *data = val;
-                  data += bpp;
-                }
-            }
+          in_data_size += bytes_read;
         }
-    }
 
-  if (nonzero)
-    {
-      if (info->file_version >= 12)
+      if (! success)
         {
-          gint n_components = babl_format_get_n_components (format);
+          g_async_queue_push (queue, job_data);
 
-          xcf_read_from_be (bpp / n_components, tile_data,
-                            tile_size / bpp * n_components);
+          break;
         }
 
-      gegl_buffer_set (buffer, tile_rect, 0, format, tile_data,
-                       GEGL_AUTO_ROWSTRIDE);
-    }
+      i += job_data->batch_size;
 
-  return TRUE;
+      g_thread_pool_push (pool, job_data, NULL);
+    }
 
- bogus_rle:
-  return FALSE;
-}
+  /* wait for all remaining jobs to finish */
+  while (n_jobs--)
+    {
+      job_data = g_async_queue_pop (queue);
 
-static gboolean
-xcf_load_tile_zlib (XcfInfo       *info,
-                    GeglBuffer    *buffer,
-                    GeglRectangle *tile_rect,
-                    const Babl    *format,
-                    gint           data_length)
-{
-  z_stream  strm;
-  int       action;
-  int       status;
-  gint      bpp       = babl_format_get_bytes_per_pixel (format);
-  gint      tile_size = bpp * tile_rect->width * tile_rect->height;
-  guchar   *tile_data = g_alloca (tile_size);
-  gsize     bytes_read;
-  guchar   *xcfdata;
-
-  /* Workaround for bug #357809: avoid crashing on g_malloc() and skip
-   * this tile (return TRUE without storing data) as if it did not
-   * contain any data.  It is better than returning FALSE, which would
-   * skip the whole hierarchy while there may still be some valid
-   * tiles in the file.
-   */
-  if (data_length <= 0)
-    return TRUE;
+      if (! job_data->success)
+        success = FALSE;
 
-  xcfdata = g_alloca (data_length);
+      xcf_load_free_job_data (job_data);
+    }
 
-  /* we have to read directly instead of xcf_read_* because we may be
-   * reading past the end of the file here
-   */
-  g_input_stream_read_all (info->input, xcfdata, data_length,
-                           &bytes_read, NULL, NULL);
-  info->cp += bytes_read;
+  g_thread_pool_free (pool, FALSE, TRUE);
+  g_async_queue_unref (queue);
 
-  if (bytes_read == 0)
-    return TRUE;
+  return success;
+}
 
-  strm.next_out  = tile_data;
-  strm.avail_out = tile_size;
+static void
+xcf_load_free_job_data (XcfLoadJobData *data)
+{
+  g_free (data->in_data);
+  g_free (data->tile_data);
+  g_free (data);
+}
 
-  strm.zalloc    = Z_NULL;
-  strm.zfree     = Z_NULL;
-  strm.opaque    = Z_NULL;
-  strm.next_in   = xcfdata;
-  strm.avail_in  = bytes_read;
+static void
+xcf_load_tile_parallel (XcfLoadJobData *job_data,
+                        GAsyncQueue    *queue)
+{
+  const Babl    *format;
+  GeglRectangle  tile_rect;
+  gint           i;
+  GIMP_TRACE_SPAN (span);
 
-  /* Initialize the stream decompression. */
-  status = inflateInit (&strm);
-  if (status != Z_OK)
-    return FALSE;
+  GIMP_TRACE_BEGIN (span, "xcf-load-tiles");
 
-  action = Z_NO_FLUSH;
+  format = gegl_buffer_get_format (job_data->buffer);
 
-  while (status == Z_OK)
+  for (i = 0; job_data->success && i < job_data->batch_size; i++)
     {
-      if (strm.avail_in == 0)
-        {
-          action = Z_FINISH;
-        }
+      const guchar *xcfdata;
+      gsize         data_length;
+      gboolean      nonzero;
+
+      gimp_gegl_buffer_get_tile_rect (job_data->buffer,
+                                      XCF_TILE_WIDTH,
+                                      XCF_TILE_HEIGHT,
+                                      job_data->tile + i,
+                                      &tile_rect);
+
+      xcfdata     = job_data->in_data + job_data->in_data_offset[i];
+      data_length = job_data->in_data_len[i];
+
+      /* Workaround for bug #357809: avoid crashing on g_malloc() and skip
+       * this tile (without storing data) as if it did not contain any data.
+       * It is better than failing, which would skip the whole hierarchy while
+       * there may still be some valid tiles in the file.
+       */
+      if (data_length == 0)
+        continue;
 
-      status = inflate (&strm, action);
+      job_data->success = xcf_decompress_tile (job_data->compression,
+                                               job_data->file_version,
+                                               format, &tile_rect,
+                                               xcfdata, data_length,
+                                               job_data->tile_data,
+                                               &nonzero);
 
-      if (status == Z_STREAM_END)
-        {
-          /* All the data was successfully decoded. */
-          break;
-        }
-      else if (status == Z_BUF_ERROR)
-        {
-          g_printerr ("xcf: decompressed tile bigger than the expected size.");
-          inflateEnd (&strm);
-          return FALSE;
-        }
-      else if (status != Z_OK)
+      if (job_data->success && nonzero)
         {
-          g_printerr ("xcf: tile decompression failed: %s", zError (status));
-          inflateEnd (&strm);
-          return FALSE;
+          gegl_buffer_set (job_data->buffer, &tile_rect, 0, format,
+                           job_data->tile_data, GEGL_AUTO_ROWSTRIDE);
         }
     }
 
-  if (! xcf_data_is_zero (tile_data, tile_size))
+  GIMP_TRACE_END (span);
+
+  g_async_queue_push (queue, job_data);
+}
+
+static gboolean
+xcf_load_tile (XcfInfo       *info,
+               GeglBuffer    *buffer,
+               GeglRectangle *tile_rect,
+               const Babl    *format)
+{
+  gint    bpp       = babl_format_get_bytes_per_pixel (format);
+  gint    tile_size = bpp * tile_rect->width * tile_rect->height;
+  guchar *tile_data = g_alloca (tile_size);
+  GIMP_TRACE_SPAN (span);
+
+  GIMP_TRACE_BEGIN (span, "xcf-load-tile");
+
+  if (info->file_version <= 11)
     {
-      if (info->file_version >= 12)
-        {
-          gint n_components = babl_format_get_n_components (format);
+      xcf_read_int8 (info, tile_data, tile_size);
+    }
+  else
+    {
+      gint n_components = babl_format_get_n_components (format);
 
-          xcf_read_from_be (bpp / n_components, tile_data,
-                            tile_size / bpp * n_components);
-        }
+      xcf_read_component (info, bpp / n_components, tile_data,
+                          tile_size / bpp * n_components);
+    }
 
+  if (! xcf_data_is_zero (tile_data, tile_size))
+    {
       gegl_buffer_set (buffer, tile_rect, 0, format, tile_data,
                        GEGL_AUTO_ROWSTRIDE);
     }
 
-  inflateEnd (&strm);
+  GIMP_TRACE_END (span);
 
   return TRUE;
 }
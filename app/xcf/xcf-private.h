@@ -22,6 +22,7 @@
 #define XCF_TILE_HEIGHT                 64
 #define XCF_TILE_MAX_DATA_LENGTH_FACTOR 1.5
 #define XCF_TILE_SAVE_BATCH_SIZE        128
+#define XCF_TILE_LOAD_BATCH_SIZE        32
 
 typedef enum
 {
@@ -81,8 +82,10 @@ typedef enum
 {
   COMPRESS_NONE              =  0,
   COMPRESS_RLE               =  1,
-  COMPRESS_ZLIB              =  2,  /* unused */
-  COMPRESS_FRACTAL           =  3   /* unused */
+  COMPRESS_ZLIB              =  2,
+  COMPRESS_FRACTAL           =  3,  /* unused */
+  COMPRESS_ZSTD              =  4,
+  COMPRESS_LZ4               =  5
 } XcfCompressionType;
 
 typedef enum
@@ -148,4 +151,17 @@ struct _XcfInfo
   goffset             floating_sel_offset;
   XcfCompressionType  compression;
   gint                file_version;
+
+  /* the input file, when it's mapped for lazy loading */
+  GMappedFile        *mapped;
+
+  /* incremental saving, see xcf-incremental.c */
+  guint               serial;
+  GInputStream       *reuse_input;
+  guint               reuse_serial;
+
+  /* the progress of a save running off the main thread, in 1/1000ths,
+   * used instead of @progress, see xcf_save_stream_async()
+   */
+  gint               *async_progress;
 };
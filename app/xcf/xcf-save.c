@@ -20,6 +20,14 @@
 #include <string.h>
 #include <zlib.h>
 
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+
 #include <cairo.h>
 #include <gegl.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
@@ -80,11 +88,14 @@
 #include "text/gimptextlayer-xcf.h"
 
 #include "xcf-private.h"
+#include "xcf-incremental.h"
 #include "xcf-read.h"
 #include "xcf-save.h"
 #include "xcf-seek.h"
 #include "xcf-write.h"
 
+#include "gimp-log.h"
+
 #include "gimp-intl.h"
 
 typedef void (* CompressTileFunc) (GeglRectangle  *tile_rect,
@@ -166,7 +177,7 @@ static gboolean xcf_save_path          (XcfInfo           *info,
                                         GError           **error);
 static gboolean xcf_save_buffer        (XcfInfo           *info,
                                         GimpImage         *image,
-                                        GeglBuffer        *buffer,
+                                        GimpDrawable      *drawable,
                                         GError           **error);
 static gboolean xcf_save_level         (XcfInfo           *info,
                                         GimpImage         *image,
@@ -195,6 +206,22 @@ static void     xcf_save_tile_zlib     (GeglRectangle     *tile_rect,
                                         guchar            *zlib_data,
                                         gint               zlib_data_max_len,
                                         gint              *lenptr);
+#ifdef HAVE_ZSTD
+static void     xcf_save_tile_zstd     (GeglRectangle     *tile_rect,
+                                        guchar            *tile_data,
+                                        const Babl        *format,
+                                        guchar            *out_data,
+                                        gint               out_data_max_len,
+                                        gint              *lenptr);
+#endif
+#ifdef HAVE_LZ4
+static void     xcf_save_tile_lz4      (GeglRectangle     *tile_rect,
+                                        guchar            *tile_data,
+                                        const Babl        *format,
+                                        guchar            *out_data,
+                                        gint               out_data_max_len,
+                                        gint              *lenptr);
+#endif
 static gboolean xcf_save_parasite      (XcfInfo           *info,
                                         GimpParasite      *parasite,
                                         GError           **error);
@@ -299,6 +326,9 @@ static gboolean xcf_save_old_vectors   (XcfInfo           *info,
     if (info->progress)                         \
       gimp_progress_set_value (info->progress,  \
                                (gdouble) progress / (gdouble) max_progress); \
+    else if (info->async_progress)              \
+      g_atomic_int_set (info->async_progress,   \
+                        1000 * progress / max_progress); \
   } G_STMT_END
 
 
@@ -2090,8 +2120,7 @@ xcf_save_layer (XcfInfo    *info,
   for (gint i = 0; i < num_effects + 1; i++)
     xcf_write_zero_offset_check_error (info, 1, ;);
 
-  xcf_check_error (xcf_save_buffer (info, image,
-                                    gimp_drawable_get_buffer (GIMP_DRAWABLE (layer)),
+  xcf_check_error (xcf_save_buffer (info, image, GIMP_DRAWABLE (layer),
                                     error), ;);
 
   offset = info->cp;
@@ -2193,8 +2222,7 @@ xcf_save_channel (XcfInfo      *info,
   offset = info->cp + info->bytes_per_offset;
   xcf_write_offset_check_error (info, &offset, 1, ;);
 
-  xcf_check_error (xcf_save_buffer (info, image,
-                                    gimp_drawable_get_buffer (GIMP_DRAWABLE (channel)),
+  xcf_check_error (xcf_save_buffer (info, image, GIMP_DRAWABLE (channel),
                                     error), ;);
 
   return TRUE;
@@ -2481,12 +2509,14 @@ xcf_calc_levels (gint size,
 
 
 static gboolean
-xcf_save_buffer (XcfInfo     *info,
-                 GimpImage   *image,
-                 GeglBuffer  *buffer,
-                 GError     **error)
+xcf_save_buffer (XcfInfo       *info,
+                 GimpImage     *image,
+                 GimpDrawable  *drawable,
+                 GError       **error)
 {
+  GeglBuffer *buffer = gimp_drawable_get_buffer (drawable);
   const Babl *format;
+  goffset     start;
   goffset     saved_pos;
   goffset     offset;
   guint32     width;
@@ -2495,8 +2525,23 @@ xcf_save_buffer (XcfInfo     *info,
   gint        i;
   gint        nlevels;
   gint        tmp1, tmp2;
+  gboolean    copied;
   GError     *tmp_error = NULL;
 
+  start = info->cp;
+
+  /* if the drawable didn't change since the last time it was loaded or
+   * saved, copy its hierarchy from that file instead of encoding it again
+   */
+  xcf_check_error (xcf_incremental_copy (info, drawable, &copied, error), ;);
+
+  if (copied)
+    {
+      xcf_incremental_remember (info, drawable, start, info->cp);
+
+      return TRUE;
+    }
+
   format = gegl_buffer_get_format (buffer);
 
   width  = gegl_buffer_get_width (buffer);
@@ -2567,6 +2612,8 @@ xcf_save_buffer (XcfInfo     *info,
    * the end of the level offsets
    */
 
+  xcf_incremental_remember (info, drawable, start, info->cp);
+
   return TRUE;
 }
 
@@ -2576,21 +2623,22 @@ xcf_save_level (XcfInfo     *info,
                 GeglBuffer  *buffer,
                 GError     **error)
 {
-  const Babl *format;
-  goffset    *offset_table;
-  goffset    *next_offset;
-  goffset     saved_pos;
-  goffset     offset;
-  goffset     max_data_length;
-  guint32     width;
-  guint32     height;
-  gint        bpp;
-  gint        n_tile_rows;
-  gint        n_tile_cols;
-  guint       ntiles;
-  gint        num_processors;
-  gint        i, j, k;
-  GError     *tmp_error = NULL;
+  const Babl       *format;
+  goffset          *offset_table;
+  goffset          *next_offset;
+  goffset           saved_pos;
+  goffset           offset;
+  goffset           max_data_length;
+  guint32           width;
+  guint32           height;
+  gint              bpp;
+  gint              n_tile_rows;
+  gint              n_tile_cols;
+  guint             ntiles;
+  gint              num_processors;
+  CompressTileFunc  compress;
+  gint              i, j, k;
+  GError           *tmp_error = NULL;
 
   num_processors = GIMP_GEGL_CONFIG (image->gimp->config)->num_processors;
 
@@ -2635,8 +2683,34 @@ xcf_save_level (XcfInfo     *info,
   /* 'offset' is where we will write the next tile */
   offset = info->cp;
 
-  if (info->compression == COMPRESS_RLE ||
-      info->compression == COMPRESS_ZLIB)
+  switch (info->compression)
+    {
+    case COMPRESS_RLE:
+      compress = xcf_save_tile_rle;
+      break;
+
+    case COMPRESS_ZLIB:
+      compress = xcf_save_tile_zlib;
+      break;
+
+#ifdef HAVE_ZSTD
+    case COMPRESS_ZSTD:
+      compress = xcf_save_tile_zstd;
+      break;
+#endif
+
+#ifdef HAVE_LZ4
+    case COMPRESS_LZ4:
+      compress = xcf_save_tile_lz4;
+      break;
+#endif
+
+    default:
+      compress = NULL;
+      break;
+    }
+
+  if (compress)
     {
       /* parallel implementation */
       XcfJobData  *job_data;
@@ -2675,8 +2749,7 @@ xcf_save_level (XcfInfo     *info,
           job_data->buffer        = buffer;
           job_data->file_version  = info->file_version;
           job_data->max_out_data_len = out_data_max_size;
-          job_data->compress      = (info->compression == COMPRESS_RLE) ?
-                                      xcf_save_tile_rle : xcf_save_tile_zlib;
+          job_data->compress      = compress;
           job_data->tile_data     = g_malloc (tile_size);
           job_data->out_data      = g_malloc (out_data_max_size * XCF_TILE_SAVE_BATCH_SIZE);
 
@@ -2910,6 +2983,9 @@ xcf_save_tile_parallel (XcfJobData  *job_data,
   const Babl    *format;
   GeglRectangle  tile_rect;
   gint           bpp;
+  GIMP_TRACE_SPAN (span);
+
+  GIMP_TRACE_BEGIN (span, "xcf-save-tiles");
 
   format = gegl_buffer_get_format (job_data->buffer);
   bpp    = babl_format_get_bytes_per_pixel (format);
@@ -2941,6 +3017,8 @@ xcf_save_tile_parallel (XcfJobData  *job_data,
                           job_data->out_data_len + i);
     }
 
+  GIMP_TRACE_END (span);
+
   g_async_queue_push_sorted (queue, job_data,
                              (GCompareDataFunc) xcf_save_sort_job_data,
                              NULL);
@@ -3128,6 +3206,71 @@ xcf_save_tile_zlib (GeglRectangle  *tile_rect,
   deflateEnd (&strm);
 }
 
+#ifdef HAVE_ZSTD
+static void
+xcf_save_tile_zstd (GeglRectangle  *tile_rect,
+                    guchar         *tile_data,
+                    const Babl     *format,
+                    guchar         *out_data,
+                    gint            out_data_max_len,
+                    gint           *lenptr)
+{
+  gint   bpp       = babl_format_get_bytes_per_pixel (format);
+  gint   tile_size = bpp * tile_rect->width * tile_rect->height;
+  size_t size;
+
+  *lenptr = 0;
+
+  size = ZSTD_compress (out_data, out_data_max_len, tile_data, tile_size,
+                        ZSTD_CLEVEL_DEFAULT);
+
+  if (ZSTD_isError (size))
+    {
+      g_printerr ("xcf: tile compression failed: %s",
+                  ZSTD_getErrorName (size));
+      return;
+    }
+
+  *lenptr = size;
+}
+#endif
+
+#ifdef HAVE_LZ4
+static void
+xcf_save_tile_lz4 (GeglRectangle  *tile_rect,
+                   guchar         *tile_data,
+                   const Babl     *format,
+                   guchar         *out_data,
+                   gint            out_data_max_len,
+                   gint           *lenptr)
+{
+  gint    bpp       = babl_format_get_bytes_per_pixel (format);
+  gint    tile_size = bpp * tile_rect->width * tile_rect->height;
+  guint32 block_size;
+  gint    size;
+
+  *lenptr = 0;
+
+  /* LZ4 blocks aren't self-delimiting, so prefix each tile with the size
+   * of its block.
+   */
+  size = LZ4_compress_default ((const gchar *) tile_data,
+                               (gchar *) out_data + 4,
+                               tile_size, out_data_max_len - 4);
+
+  if (size <= 0)
+    {
+      g_printerr ("xcf: tile compression failed.");
+      return;
+    }
+
+  block_size = GUINT32_TO_BE (size);
+  memcpy (out_data, &block_size, 4);
+
+  *lenptr = size + 4;
+}
+#endif
+
 static gboolean
 xcf_save_parasite (XcfInfo       *info,
                    GimpParasite  *parasite,
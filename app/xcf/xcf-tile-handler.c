@@ -0,0 +1,427 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <cairo.h>
+#include <gegl.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+#include "core/core-types.h"
+
+#include "xcf-private.h"
+#include "xcf-decompress.h"
+#include "xcf-tile-handler.h"
+
+
+static void       xcf_tile_handler_finalize    (GObject         *object);
+
+static gpointer   xcf_tile_handler_command     (GeglTileSource  *source,
+                                                GeglTileCommand  command,
+                                                gint             x,
+                                                gint             y,
+                                                gint             z,
+                                                gpointer         data);
+
+static void       xcf_tile_handler_decode_tile (XcfTileHandler  *handler,
+                                                gint             x,
+                                                gint             y);
+static void       xcf_tile_handler_decode_area (XcfTileHandler  *handler,
+                                                gint             x,
+                                                gint             y,
+                                                gint             z);
+static void       xcf_tile_handler_drop_tile   (XcfTileHandler  *handler,
+                                                gint             x,
+                                                gint             y);
+static void       xcf_tile_handler_release     (XcfTileHandler  *handler);
+
+
+G_DEFINE_TYPE (XcfTileHandler, xcf_tile_handler, GEGL_TYPE_TILE_HANDLER)
+
+#define parent_class xcf_tile_handler_parent_class
+
+
+static void
+xcf_tile_handler_class_init (XcfTileHandlerClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = xcf_tile_handler_finalize;
+}
+
+static void
+xcf_tile_handler_init (XcfTileHandler *handler)
+{
+  GeglTileSource *source = GEGL_TILE_SOURCE (handler);
+
+  source->command = xcf_tile_handler_command;
+}
+
+static void
+xcf_tile_handler_finalize (GObject *object)
+{
+  XcfTileHandler *handler = XCF_TILE_HANDLER (object);
+
+  xcf_tile_handler_release (handler);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static gpointer
+xcf_tile_handler_command (GeglTileSource  *source,
+                          GeglTileCommand  command,
+                          gint             x,
+                          gint             y,
+                          gint             z,
+                          gpointer         data)
+{
+  XcfTileHandler *handler = XCF_TILE_HANDLER (source);
+
+  /* once all the tiles are decoded, we're just a pass-through handler */
+  if (g_atomic_int_get (&handler->n_pending) == 0)
+    return gegl_tile_handler_source_command (source, command, x, y, z, data);
+
+  gegl_tile_handler_lock (GEGL_TILE_HANDLER (handler));
+
+  if (handler->n_pending > 0)
+    {
+      switch (command)
+        {
+        case GEGL_TILE_GET:
+        case GEGL_TILE_EXIST:
+          /* mipmap levels are rendered by the storage, below us, so we
+           * need to decode the entire level-0 footprint of the tile
+           */
+          xcf_tile_handler_decode_area (handler, x, y, z);
+          break;
+
+        case GEGL_TILE_COPY:
+          if (z == 0)
+            xcf_tile_handler_decode_tile (handler, x, y);
+          break;
+
+        case GEGL_TILE_SET:
+        case GEGL_TILE_VOID:
+          /* the tile is replaced as a whole, there is nothing to decode */
+          if (z == 0)
+            xcf_tile_handler_drop_tile (handler, x, y);
+          break;
+
+        case GEGL_TILE_REINIT:
+          handler->n_pending = 0;
+          break;
+
+        default:
+          break;
+        }
+
+      if (handler->n_pending == 0)
+        xcf_tile_handler_release (handler);
+    }
+
+  gegl_tile_handler_unlock (GEGL_TILE_HANDLER (handler));
+
+  return gegl_tile_handler_source_command (source, command, x, y, z, data);
+}
+
+/* decodes all the pending XCF tiles which intersect the GEGL tile at
+ * (x, y), at level 0, into the GEGL tile.  must be called with the tile
+ * storage locked.
+ */
+static void
+xcf_tile_handler_decode_tile (XcfTileHandler *handler,
+                              gint            x,
+                              gint            y)
+{
+  GeglTile     *tile      = NULL;
+  const guchar *file_data;
+  gsize         file_length;
+  gint          tile_stride;
+  gint          col1, col2;
+  gint          row1, row2;
+  gint          row;
+  gint          col;
+
+  if (x < 0 || y < 0)
+    return;
+
+  col1 = x * handler->tile_width / XCF_TILE_WIDTH;
+  col2 = MIN ((x + 1) * handler->tile_width / XCF_TILE_WIDTH,
+              handler->n_tile_cols);
+
+  row1 = y * handler->tile_height / XCF_TILE_HEIGHT;
+  row2 = MIN ((y + 1) * handler->tile_height / XCF_TILE_HEIGHT,
+              handler->n_tile_rows);
+
+  file_data   = (const guchar *) g_mapped_file_get_contents (handler->mapped);
+  file_length = g_mapped_file_get_length (handler->mapped);
+  tile_stride = handler->tile_width * handler->bpp;
+
+  for (row = row1; row < row2; row++)
+    {
+      for (col = col1; col < col2; col++)
+        {
+          gint          i = row * handler->n_tile_cols + col;
+          GeglRectangle rect;
+          goffset       offset;
+          goffset       offset2;
+          gboolean      nonzero;
+          guchar       *dest;
+          gint          j;
+
+          if (! handler->pending[i])
+            continue;
+
+          handler->pending[i] = FALSE;
+          handler->n_pending--;
+
+          offset  = handler->offset_table[i];
+          offset2 = MIN (handler->offset_table[i + 1], (goffset) file_length);
+
+          /* see the comment about bug #357809 in xcf-load.c; empty tiles
+           * are left transparent.
+           */
+          if (offset >= offset2)
+            continue;
+
+          rect.x      = col * XCF_TILE_WIDTH;
+          rect.y      = row * XCF_TILE_HEIGHT;
+          rect.width  = MIN (XCF_TILE_WIDTH,  handler->width  - rect.x);
+          rect.height = MIN (XCF_TILE_HEIGHT, handler->height - rect.y);
+
+          if (! xcf_decompress_tile (handler->compression,
+                                     handler->file_version,
+                                     handler->format, &rect,
+                                     file_data + offset, offset2 - offset,
+                                     handler->tile_data, &nonzero))
+            {
+              g_printerr ("xcf: failed to decode tile %d. "
+                          "Possibly corrupt XCF file.\n", i);
+              continue;
+            }
+
+          if (! nonzero)
+            continue;
+
+          if (! tile)
+            {
+              tile = gegl_tile_handler_get_source_tile (
+                GEGL_TILE_HANDLER (handler), x, y, 0, TRUE);
+
+              gegl_tile_lock (tile);
+            }
+
+          dest = gegl_tile_get_data (tile)                               +
+                 (rect.y - y * handler->tile_height) * tile_stride       +
+                 (rect.x - x * handler->tile_width)  * handler->bpp;
+
+          for (j = 0; j < rect.height; j++)
+            {
+              memcpy (dest,
+                      handler->tile_data + j * rect.width * handler->bpp,
+                      rect.width * handler->bpp);
+
+              dest += tile_stride;
+            }
+        }
+    }
+
+  if (tile)
+    {
+      gegl_tile_unlock (tile);
+      gegl_tile_unref (tile);
+    }
+}
+
+static void
+xcf_tile_handler_decode_area (XcfTileHandler *handler,
+                              gint            x,
+                              gint            y,
+                              gint            z)
+{
+  gint n_cols;
+  gint n_rows;
+  gint x1, x2;
+  gint y1, y2;
+  gint i, j;
+
+  n_cols = (handler->width  + handler->tile_width  - 1) / handler->tile_width;
+  n_rows = (handler->height + handler->tile_height - 1) / handler->tile_height;
+
+  if (x < 0 || y < 0 || z < 0  ||
+      x > ((n_cols - 1) >> z) ||
+      y > ((n_rows - 1) >> z))
+    {
+      return;
+    }
+
+  x1 = x << z;
+  y1 = y << z;
+
+  x2 = MIN (((gint64) x + 1) << z, n_cols);
+  y2 = MIN (((gint64) y + 1) << z, n_rows);
+
+  for (j = y1; j < y2 && handler->n_pending > 0; j++)
+    {
+      for (i = x1; i < x2 && handler->n_pending > 0; i++)
+        xcf_tile_handler_decode_tile (handler, i, j);
+    }
+}
+
+static void
+xcf_tile_handler_drop_tile (XcfTileHandler *handler,
+                            gint            x,
+                            gint            y)
+{
+  gint col1, col2;
+  gint row1, row2;
+  gint row;
+  gint col;
+
+  if (x < 0 || y < 0)
+    return;
+
+  col1 = x * handler->tile_width / XCF_TILE_WIDTH;
+  col2 = MIN ((x + 1) * handler->tile_width / XCF_TILE_WIDTH,
+              handler->n_tile_cols);
+
+  row1 = y * handler->tile_height / XCF_TILE_HEIGHT;
+  row2 = MIN ((y + 1) * handler->tile_height / XCF_TILE_HEIGHT,
+              handler->n_tile_rows);
+
+  for (row = row1; row < row2; row++)
+    {
+      for (col = col1; col < col2; col++)
+        {
+          gint i = row * handler->n_tile_cols + col;
+
+          if (handler->pending[i])
+            {
+              handler->pending[i] = FALSE;
+              handler->n_pending--;
+            }
+        }
+    }
+}
+
+/* frees the file mapping and the offset table, once there are no more
+ * tiles to decode.
+ */
+static void
+xcf_tile_handler_release (XcfTileHandler *handler)
+{
+  g_atomic_int_set (&handler->n_pending, 0);
+
+  g_clear_pointer (&handler->mapped,       g_mapped_file_unref);
+  g_clear_pointer (&handler->offset_table, g_free);
+  g_clear_pointer (&handler->pending,      g_free);
+  g_clear_pointer (&handler->tile_data,    g_free);
+}
+
+
+/*  public functions  */
+
+/* sets up 'buffer' to lazily load the level whose tiles are at
+ * 'offset_table', which has 'ntiles' + 1 entries, from 'mapped'.  the tiles
+ * are decoded when they are first accessed, instead of up front.
+ *
+ * returns FALSE, without touching 'buffer', if the buffer's tile grid
+ * doesn't fit the XCF tile grid, in which case the level should be loaded
+ * normally.
+ */
+gboolean
+xcf_tile_handler_attach (GeglBuffer         *buffer,
+                         GMappedFile        *mapped,
+                         gint                file_version,
+                         XcfCompressionType  compression,
+                         const goffset      *offset_table,
+                         gint                ntiles)
+{
+  XcfTileHandler      *handler;
+  const GeglRectangle *extent;
+  gint                 tile_width;
+  gint                 tile_height;
+  gint                 shift_x;
+  gint                 shift_y;
+  gint                 n_tile_cols;
+  gint                 n_tile_rows;
+
+  g_return_val_if_fail (GEGL_IS_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (mapped != NULL, FALSE);
+  g_return_val_if_fail (offset_table != NULL, FALSE);
+  g_return_val_if_fail (ntiles > 0, FALSE);
+
+  g_object_get (buffer,
+                "tile-width",  &tile_width,
+                "tile-height", &tile_height,
+                "shift-x",     &shift_x,
+                "shift-y",     &shift_y,
+                NULL);
+
+  extent = gegl_buffer_get_extent (buffer);
+
+  n_tile_cols = (extent->width  + XCF_TILE_WIDTH  - 1) / XCF_TILE_WIDTH;
+  n_tile_rows = (extent->height + XCF_TILE_HEIGHT - 1) / XCF_TILE_HEIGHT;
+
+  /* each GEGL tile must consist of whole XCF tiles, so that tiles can be
+   * decoded independently of their neighbors.
+   */
+  if (tile_width  % XCF_TILE_WIDTH  != 0 ||
+      tile_height % XCF_TILE_HEIGHT != 0 ||
+      shift_x != 0 || shift_y != 0       ||
+      extent->x != 0 || extent->y != 0   ||
+      n_tile_cols * n_tile_rows != ntiles)
+    {
+      return FALSE;
+    }
+
+  handler = g_object_new (XCF_TYPE_TILE_HANDLER, NULL);
+
+  handler->mapped       = g_mapped_file_ref (mapped);
+  handler->file_version = file_version;
+  handler->compression  = compression;
+  handler->format       = gegl_buffer_get_format (buffer);
+  handler->bpp          = babl_format_get_bytes_per_pixel (handler->format);
+
+  handler->width        = extent->width;
+  handler->height       = extent->height;
+  handler->tile_width   = tile_width;
+  handler->tile_height  = tile_height;
+
+  handler->n_tile_cols  = n_tile_cols;
+  handler->n_tile_rows  = n_tile_rows;
+
+  handler->offset_table = g_memdup2 (offset_table,
+                                     (ntiles + 1) * sizeof (goffset));
+  handler->pending      = g_malloc (ntiles);
+  handler->n_pending    = ntiles;
+  handler->tile_data    = g_malloc (XCF_TILE_WIDTH * XCF_TILE_HEIGHT *
+                                    handler->bpp);
+
+  memset (handler->pending, TRUE, ntiles);
+
+  gegl_buffer_add_handler (buffer, handler);
+
+  /* the handler is kept alive for as long as the buffer */
+  g_object_set_data_full (G_OBJECT (buffer),
+                          "xcf-tile-handler", handler,
+                          g_object_unref);
+
+  return TRUE;
+}
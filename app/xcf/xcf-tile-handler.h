@@ -0,0 +1,77 @@
+/* GIMP - The GNU Image Manipulation Program
+ * Copyright (C) 1995 Spencer Kimball and Peter Mattis
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <gegl-buffer-backend.h>
+
+
+/***
+ * XcfTileHandler is a GeglTileHandler that decodes the tiles of a
+ * memory-mapped XCF file on demand.
+ */
+
+#define XCF_TYPE_TILE_HANDLER            (xcf_tile_handler_get_type ())
+#define XCF_TILE_HANDLER(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), XCF_TYPE_TILE_HANDLER, XcfTileHandler))
+#define XCF_TILE_HANDLER_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass),  XCF_TYPE_TILE_HANDLER, XcfTileHandlerClass))
+#define XCF_IS_TILE_HANDLER(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), XCF_TYPE_TILE_HANDLER))
+#define XCF_IS_TILE_HANDLER_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  XCF_TYPE_TILE_HANDLER))
+#define XCF_TILE_HANDLER_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  XCF_TYPE_TILE_HANDLER, XcfTileHandlerClass))
+
+
+typedef struct _XcfTileHandler      XcfTileHandler;
+typedef struct _XcfTileHandlerClass XcfTileHandlerClass;
+
+struct _XcfTileHandler
+{
+  GeglTileHandler     parent_instance;
+
+  GMappedFile        *mapped;
+  gint                file_version;
+  XcfCompressionType  compression;
+  const Babl         *format;
+  gint                bpp;
+
+  gint                width;
+  gint                height;
+  gint                tile_width;
+  gint                tile_height;
+
+  /*  the XCF tiles, and the ones which weren't decoded yet  */
+  gint                n_tile_cols;
+  gint                n_tile_rows;
+  goffset            *offset_table;
+  guint8             *pending;
+  gint                n_pending;
+
+  guchar             *tile_data;
+};
+
+struct _XcfTileHandlerClass
+{
+  GeglTileHandlerClass  parent_class;
+};
+
+
+GType      xcf_tile_handler_get_type (void) G_GNUC_CONST;
+
+gboolean   xcf_tile_handler_attach   (GeglBuffer         *buffer,
+                                      GMappedFile        *mapped,
+                                      gint                file_version,
+                                      XcfCompressionType  compression,
+                                      const goffset      *offset_table,
+                                      gint                ntiles);
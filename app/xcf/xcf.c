@@ -29,8 +29,13 @@
 
 #include "core/core-types.h"
 
+#include "config/gimpcoreconfig.h"
+
 #include "core/gimp.h"
+#include "core/gimp-parallel.h"
+#include "core/gimpasync.h"
 #include "core/gimpimage.h"
+#include "core/gimpimage-duplicate.h"
 #include "core/gimpdrawable.h"
 #include "core/gimpparamspecs.h"
 #include "core/gimpprogress.h"
@@ -40,6 +45,7 @@
 
 #include "xcf.h"
 #include "xcf-private.h"
+#include "xcf-incremental.h"
 #include "xcf-load.h"
 #include "xcf-read.h"
 #include "xcf-save.h"
@@ -51,6 +57,20 @@ typedef GimpImage * GimpXcfLoaderFunc (Gimp     *gimp,
                                        XcfInfo  *info,
                                        GError  **error);
 
+typedef struct _XcfSaveAsync XcfSaveAsync;
+
+struct _XcfSaveAsync
+{
+  Gimp          *gimp;
+  GimpImage     *snapshot;
+  GOutputStream *output;
+  GFile         *file;
+
+  GimpProgress  *progress;
+  guint          progress_id;
+  gint           progress_value;
+};
+
 
 static GimpValueArray * xcf_load_invoker (GimpProcedure         *procedure,
                                           Gimp                  *gimp,
@@ -65,6 +85,20 @@ static GimpValueArray * xcf_save_invoker (GimpProcedure         *procedure,
                                           const GimpValueArray  *args,
                                           GError               **error);
 
+static gboolean   xcf_save_stream_internal (Gimp           *gimp,
+                                            GimpImage      *image,
+                                            GOutputStream  *output,
+                                            GFile          *output_file,
+                                            GimpProgress   *progress,
+                                            gint           *async_progress,
+                                            GError        **error);
+
+static void       xcf_save_async_func      (GimpAsync      *async,
+                                            XcfSaveAsync   *save);
+static void       xcf_save_async_callback  (GimpAsync      *async,
+                                            XcfSaveAsync   *save);
+static gboolean   xcf_save_async_progress  (XcfSaveAsync   *save);
+
 
 static GimpXcfLoaderFunc * const xcf_loaders[] =
 {
@@ -94,6 +128,7 @@ static GimpXcfLoaderFunc * const xcf_loaders[] =
   xcf_load_image,   /* version 23 */
   xcf_load_image,   /* version 24 */
   xcf_load_image,   /* version 25 */
+  xcf_load_image,   /* version 26 */
 };
 
 
@@ -267,9 +302,27 @@ xcf_load_stream (Gimp          *gimp,
   info.file             = input_file;
   info.compression      = COMPRESS_NONE;
 
+  if (gimp->config->xcf_lazy_load &&
+      input_file                  &&
+      G_IS_FILE_INPUT_STREAM (input))
+    {
+      gchar *path = g_file_get_path (input_file);
+
+      /* map the file, so that the pixel data of the drawables can be
+       * decoded lazily, straight from the mapping.  failing this, we
+       * just load the file normally.
+       */
+      if (path)
+        info.mapped = g_mapped_file_new (path, FALSE, NULL);
+
+      g_free (path);
+    }
+
   if (progress)
     gimp_progress_start (progress, FALSE, _("Opening '%s'"), filename);
 
+  xcf_incremental_begin (&info, NULL);
+
   success = TRUE;
 
   xcf_read_int8 (&info, (guint8 *) id, 14);
@@ -316,6 +369,10 @@ xcf_load_stream (Gimp          *gimp,
         }
     }
 
+  xcf_incremental_end (&info, image, input_file, success);
+
+  g_clear_pointer (&info.mapped, g_mapped_file_unref);
+
   if (progress)
     gimp_progress_end (progress);
 
@@ -330,12 +387,6 @@ xcf_save_stream (Gimp           *gimp,
                  GimpProgress   *progress,
                  GError        **error)
 {
-  XcfInfo       info     = { 0, };
-  const gchar  *filename;
-  gboolean      success  = FALSE;
-  GError       *my_error = NULL;
-  GCancellable *cancellable;
-
   g_return_val_if_fail (GIMP_IS_GIMP (gimp), FALSE);
   g_return_val_if_fail (GIMP_IS_IMAGE (image), FALSE);
   g_return_val_if_fail (G_IS_OUTPUT_STREAM (output), FALSE);
@@ -343,6 +394,102 @@ xcf_save_stream (Gimp           *gimp,
   g_return_val_if_fail (progress == NULL || GIMP_IS_PROGRESS (progress), FALSE);
   g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
+  return xcf_save_stream_internal (gimp, image, output, output_file,
+                                   progress, NULL, error);
+}
+
+/**
+ * xcf_save_stream_async:
+ * @gimp:        a #Gimp
+ * @image:       the image to save
+ * @output:      the stream to write to, it is closed when done
+ * @output_file: the file @output writes to, or %NULL
+ * @progress:    a #GimpProgress, or %NULL
+ *
+ * Saves @image like xcf_save_stream(), but without blocking: a
+ * snapshot of the image is taken right away, whose drawables share
+ * their tiles with @image until either side changes them, and the
+ * snapshot is written on a separate thread.  @image can be edited
+ * freely in the meantime.
+ *
+ * @progress is updated from the main thread while the save runs.
+ *
+ * Returns: a #GimpAsync which is finished with a %NULL result on
+ *          success, or with a #GError describing the failure.
+ **/
+GimpAsync *
+xcf_save_stream_async (Gimp          *gimp,
+                       GimpImage     *image,
+                       GOutputStream *output,
+                       GFile         *output_file,
+                       GimpProgress  *progress)
+{
+  XcfSaveAsync *save;
+  GimpAsync    *async;
+
+  g_return_val_if_fail (GIMP_IS_GIMP (gimp), NULL);
+  g_return_val_if_fail (GIMP_IS_IMAGE (image), NULL);
+  g_return_val_if_fail (G_IS_OUTPUT_STREAM (output), NULL);
+  g_return_val_if_fail (output_file == NULL || G_IS_FILE (output_file), NULL);
+  g_return_val_if_fail (progress == NULL || GIMP_IS_PROGRESS (progress), NULL);
+
+  save = g_slice_new0 (XcfSaveAsync);
+
+  save->gimp     = gimp;
+  save->snapshot = gimp_image_duplicate (image);
+  save->output   = g_object_ref (output);
+
+  if (output_file)
+    save->file = g_object_ref (output_file);
+
+  /*  not a duplicated property, but it decides the file format  */
+  gimp_image_set_xcf_compression (save->snapshot,
+                                  gimp_image_get_xcf_compression (image));
+
+  if (progress)
+    {
+      save->progress = g_object_ref (progress);
+
+      gimp_progress_start (progress, FALSE, _("Saving '%s'"),
+                           output_file ?
+                           gimp_file_get_utf8_name (output_file) :
+                           _("Memory Stream"));
+
+      save->progress_id =
+        g_timeout_add (100, (GSourceFunc) xcf_save_async_progress, save);
+    }
+
+  async = gimp_parallel_run_async_independent_labeled_full (
+    "xcf-save", 0,
+    (GimpRunAsyncFunc) xcf_save_async_func,
+    save);
+
+  gimp_async_add_callback (async,
+                           (GimpAsyncCallback) xcf_save_async_callback,
+                           save);
+
+  return async;
+}
+
+
+/*  private functions  */
+
+static gboolean
+xcf_save_stream_internal (Gimp           *gimp,
+                          GimpImage      *image,
+                          GOutputStream  *output,
+                          GFile          *output_file,
+                          GimpProgress   *progress,
+                          gint           *async_progress,
+                          GError        **error)
+{
+  XcfInfo             info     = { 0, };
+  const gchar        *filename;
+  GimpXcfCompression  compression;
+  gboolean            success  = FALSE;
+  GError             *my_error = NULL;
+  GCancellable       *cancellable;
+
   if (output_file)
     filename = gimp_file_get_utf8_name (output_file);
   else
@@ -354,15 +501,40 @@ xcf_save_stream (Gimp           *gimp,
   info.bytes_per_offset = 4;
   info.progress         = progress;
   info.file             = output_file;
+  info.async_progress   = async_progress;
 
-  if (gimp_image_get_xcf_compression (image))
-    info.compression = COMPRESS_ZLIB;
-  else
-    info.compression = COMPRESS_RLE;
+  compression = gimp_image_get_xcf_compression (image);
+
+  switch (compression)
+    {
+    case GIMP_XCF_COMPRESSION_RLE:
+      info.compression = COMPRESS_RLE;
+      break;
+
+    case GIMP_XCF_COMPRESSION_ZLIB:
+      info.compression = COMPRESS_ZLIB;
+      break;
+
+#ifdef HAVE_ZSTD
+    case GIMP_XCF_COMPRESSION_ZSTD:
+      info.compression = COMPRESS_ZSTD;
+      break;
+#endif
+
+#ifdef HAVE_LZ4
+    case GIMP_XCF_COMPRESSION_LZ4:
+      info.compression = COMPRESS_LZ4;
+      break;
+#endif
+
+    default:
+      /* not supported by this build, fall back to zlib */
+      compression      = GIMP_XCF_COMPRESSION_ZLIB;
+      info.compression = COMPRESS_ZLIB;
+      break;
+    }
 
-  info.file_version = gimp_image_get_xcf_version (image,
-                                                  info.compression ==
-                                                  COMPRESS_ZLIB,
+  info.file_version = gimp_image_get_xcf_version (image, compression,
                                                   NULL, NULL, NULL);
 
   if (info.file_version >= 11)
@@ -371,6 +543,8 @@ xcf_save_stream (Gimp           *gimp,
   if (progress)
     gimp_progress_start (progress, FALSE, _("Saving '%s'"), filename);
 
+  xcf_incremental_begin (&info, image);
+
   success = xcf_save_image (&info, image, &my_error);
 
   cancellable = g_cancellable_new ();
@@ -393,6 +567,8 @@ xcf_save_stream (Gimp           *gimp,
   success = g_output_stream_close (info.output, cancellable, &my_error);
   g_object_unref (cancellable);
 
+  xcf_incremental_end (&info, image, output_file, success);
+
   if (! success && my_error)
     g_propagate_prefixed_error (error, my_error,
                                 _("Error writing '%s': "), filename);
@@ -403,8 +579,53 @@ xcf_save_stream (Gimp           *gimp,
   return success;
 }
 
+static void
+xcf_save_async_func (GimpAsync    *async,
+                     XcfSaveAsync *save)
+{
+  GError *error = NULL;
 
-/*  private functions  */
+  if (xcf_save_stream_internal (save->gimp, save->snapshot,
+                                save->output, save->file,
+                                NULL, &save->progress_value,
+                                &error))
+    {
+      gimp_async_finish (async, NULL);
+    }
+  else
+    {
+      gimp_async_finish_full (async, error, (GDestroyNotify) g_error_free);
+    }
+}
+
+static void
+xcf_save_async_callback (GimpAsync    *async,
+                         XcfSaveAsync *save)
+{
+  if (save->progress)
+    {
+      g_source_remove (save->progress_id);
+
+      gimp_progress_end (save->progress);
+      g_object_unref (save->progress);
+    }
+
+  /*  the snapshot is in the image list, so drop it on the main thread  */
+  g_object_unref (save->snapshot);
+  g_object_unref (save->output);
+  g_clear_object (&save->file);
+
+  g_slice_free (XcfSaveAsync, save);
+}
+
+static gboolean
+xcf_save_async_progress (XcfSaveAsync *save)
+{
+  gimp_progress_set_value (save->progress,
+                           g_atomic_int_get (&save->progress_value) / 1000.0);
+
+  return G_SOURCE_CONTINUE;
+}
 
 static GimpValueArray *
 xcf_load_invoker (GimpProcedure         *procedure,
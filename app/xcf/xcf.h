@@ -33,3 +33,10 @@ gboolean    xcf_save_stream (Gimp           *gimp,
                              GFile          *output_file,
                              GimpProgress   *progress,
                              GError        **error);
+
+GimpAsync * xcf_save_stream_async
+                            (Gimp           *gimp,
+                             GimpImage      *image,
+                             GOutputStream  *output,
+                             GFile          *output_file,
+                             GimpProgress   *progress);
@@ -43,6 +43,18 @@
 
 #endif /* USE_POSIX_SHM */
 
+#if defined(HAVE_MEMFD_CREATE) && ! defined(_WIN32)
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <sys/mman.h>
+
+#define USE_FD_TILE_MAP 1
+
+#endif
+
 #include <glib.h>
 
 #if defined(G_OS_WIN32) || defined(G_WITH_CYGWIN)
@@ -61,7 +73,8 @@
 #include "gimp-shm.h"
 
 
-#define TILE_MAP_SIZE     (gimp_tile_width () * gimp_tile_height () * 32)
+/* must match the size of the segment allocated by the core */
+#define TILE_MAP_SIZE     (gimp_tile_width () * gimp_tile_height () * 32 * 4)
 #define ERRMSG_SHM_FAILED "Could not attach to gimp shared memory segment"
 
 
@@ -196,3 +209,76 @@ _gimp_shm_close (void)
 
 #endif
 }
+
+/*  maps a drawable's tiles exported by the core, see GPTileMapData.  on
+ *  Windows, the map is named after the core's @pid and @map_id, elsewhere
+ *  @fd is the map itself, passed over the wire, which stays owned by the
+ *  caller.  the mapping is private: the memory can be written to, but the
+ *  changes are only ever seen by the plug-in.
+ */
+guchar *
+_gimp_shm_map_tiles (gint  pid,
+                     gint  map_id,
+                     gint  fd,
+                     gsize size)
+{
+  guchar *addr = NULL;
+
+#if defined(USE_WIN32_SHM)
+
+  gchar    map_name[128];
+  wchar_t *w_map_name;
+  HANDLE   handle;
+
+  g_snprintf (map_name, sizeof (map_name), "GIMP%d-%d.MAP", pid, map_id);
+
+  w_map_name = g_utf8_to_utf16 (map_name, -1, NULL, NULL, NULL);
+
+  if (! w_map_name)
+    return NULL;
+
+  handle = OpenFileMappingW (FILE_MAP_READ, 0, w_map_name);
+
+  g_free (w_map_name);
+
+  if (handle)
+    {
+      addr = (guchar *) MapViewOfFile (handle, FILE_MAP_COPY, 0, 0, size);
+
+      /*  the view keeps the mapping alive  */
+      CloseHandle (handle);
+    }
+
+#elif defined(USE_FD_TILE_MAP)
+
+  if (fd != -1)
+    {
+      addr = (guchar *) mmap (NULL, size,
+                              PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                              fd, 0);
+
+      if (addr == MAP_FAILED)
+        addr = NULL;
+    }
+
+#endif
+
+  return addr;
+}
+
+void
+_gimp_shm_unmap_tiles (guchar *addr,
+                       gsize   size)
+{
+  g_return_if_fail (addr != NULL);
+
+#if defined(USE_WIN32_SHM)
+
+  UnmapViewOfFile (addr);
+
+#elif defined(USE_FD_TILE_MAP)
+
+  munmap (addr, size);
+
+#endif
+}
@@ -29,6 +29,13 @@ guchar * _gimp_shm_addr  (void);
 void     _gimp_shm_open  (gint shm_ID);
 void     _gimp_shm_close (void);
 
+guchar * _gimp_shm_map_tiles   (gint    pid,
+                                gint    map_id,
+                                gint    fd,
+                                gsize   size);
+void     _gimp_shm_unmap_tiles (guchar *addr,
+                                gsize   size);
+
 
 G_END_DECLS
 
@@ -1147,11 +1147,13 @@ _gimp_config (GPConfig *config)
   _export_comment       = config->export_comment;
   _num_processors       = config->num_processors;
   _default_display_id   = config->default_display_id;
-  _wm_class             = g_strdup (config->wm_class);
-  _display_name         = g_strdup (config->display_name);
   _monitor_number       = config->monitor_number;
   _timestamp            = config->timestamp;
-  _icon_theme_dir       = g_strdup (config->icon_theme_dir);
+
+  /*  a reusable plug-in gets a new config for each run  */
+  g_set_str (&_wm_class,       config->wm_class);
+  g_set_str (&_display_name,   config->display_name);
+  g_set_str (&_icon_theme_dir, config->icon_theme_dir);
 
   if (config->app_name)
     g_set_application_name (config->app_name);
@@ -1222,5 +1224,6 @@ _gimp_config (GPConfig *config)
   g_free (path);
   g_object_unref (file);
 
-  _gimp_shm_open (config->shm_id);
+  if (! _gimp_shm_addr ())
+    _gimp_shm_open (config->shm_id);
 }
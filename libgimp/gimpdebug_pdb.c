@@ -113,3 +113,139 @@ gimp_debug_timer_end (void)
 
   return elapsed;
 }
+
+/**
+ * gimp_debug_pdb_profile_start:
+ *
+ * Starts profiling the procedural database.
+ *
+ * This procedure clears the PDB profile, and starts recording the
+ * number of calls, and the time spent in, each procedure of the
+ * procedural database. Each call to this procedure should be matched
+ * by a call to gimp_debug_pdb_profile_end(), which stops profiling,
+ * and prints the profile.
+ *
+ * This is a debug utility procedure. It is subject to change at any
+ * point, and should not be used in production.
+ *
+ * Returns: TRUE on success.
+ *
+ * Since: 3.2
+ **/
+gboolean
+gimp_debug_pdb_profile_start (void)
+{
+  GimpValueArray *args;
+  GimpValueArray *return_vals;
+  gboolean success = TRUE;
+
+  args = gimp_value_array_new_from_types (NULL,
+                                          G_TYPE_NONE);
+
+  return_vals = _gimp_pdb_run_procedure_array (gimp_get_pdb (),
+                                               "gimp-debug-pdb-profile-start",
+                                               args);
+  gimp_value_array_unref (args);
+
+  success = GIMP_VALUES_GET_ENUM (return_vals, 0) == GIMP_PDB_SUCCESS;
+
+  gimp_value_array_unref (return_vals);
+
+  return success;
+}
+
+/**
+ * gimp_debug_pdb_profile_end:
+ *
+ * Finishes profiling the procedural database.
+ *
+ * This procedure stops profiling started by a previous
+ * gimp_debug_pdb_profile_start() call, prints the profile, and returns
+ * the names of the profiled procedures, with the slowest first. Use
+ * gimp_debug_pdb_profile_get_procedure() to get the profile of each of
+ * them.
+ *
+ * This is a debug utility procedure. It is subject to change at any
+ * point, and should not be used in production.
+ *
+ * Returns: (array zero-terminated=1) (transfer full):
+ *          The names of the profiled procedures.
+ *          The returned value must be freed with g_strfreev().
+ *
+ * Since: 3.2
+ **/
+gchar **
+gimp_debug_pdb_profile_end (void)
+{
+  GimpValueArray *args;
+  GimpValueArray *return_vals;
+  gchar **procedure_names = NULL;
+
+  args = gimp_value_array_new_from_types (NULL,
+                                          G_TYPE_NONE);
+
+  return_vals = _gimp_pdb_run_procedure_array (gimp_get_pdb (),
+                                               "gimp-debug-pdb-profile-end",
+                                               args);
+  gimp_value_array_unref (args);
+
+  if (GIMP_VALUES_GET_ENUM (return_vals, 0) == GIMP_PDB_SUCCESS)
+    procedure_names = GIMP_VALUES_DUP_STRV (return_vals, 1);
+
+  gimp_value_array_unref (return_vals);
+
+  return procedure_names;
+}
+
+/**
+ * gimp_debug_pdb_profile_get_procedure:
+ * @procedure_name: The procedure name.
+ * @total_time: (out): The total time of the calls, in seconds.
+ * @max_time: (out): The time of the longest call, in seconds.
+ * @marshal_time: (out): The time spent marshalling, in seconds.
+ *
+ * Returns the profile of a procedure.
+ *
+ * This procedure returns the number of calls to a procedure recorded
+ * since the last gimp_debug_pdb_profile_start() call, the total and
+ * longest time spent in it, and the time spent marshalling its
+ * arguments and return values to and from plug-ins.
+ *
+ * This is a debug utility procedure. It is subject to change at any
+ * point, and should not be used in production.
+ *
+ * Returns: The number of calls.
+ *
+ * Since: 3.2
+ **/
+gint
+gimp_debug_pdb_profile_get_procedure (const gchar *procedure_name,
+                                      gdouble     *total_time,
+                                      gdouble     *max_time,
+                                      gdouble     *marshal_time)
+{
+  GimpValueArray *args;
+  GimpValueArray *return_vals;
+  gint n_calls = 0;
+
+  args = gimp_value_array_new_from_types (NULL,
+                                          G_TYPE_STRING, procedure_name,
+                                          G_TYPE_NONE);
+
+  return_vals = _gimp_pdb_run_procedure_array (gimp_get_pdb (),
+                                               "gimp-debug-pdb-profile-get-procedure",
+                                               args);
+  gimp_value_array_unref (args);
+
+  if (GIMP_VALUES_GET_ENUM (return_vals, 0) == GIMP_PDB_SUCCESS)
+    {
+      n_calls = GIMP_VALUES_GET_INT (return_vals, 1);
+      *total_time = GIMP_VALUES_GET_DOUBLE (return_vals, 2);
+      *max_time = GIMP_VALUES_GET_DOUBLE (return_vals, 3);
+      *marshal_time = GIMP_VALUES_GET_DOUBLE (return_vals, 4);
+    }
+
+  gimp_value_array_unref (return_vals);
+
+  return n_calls;
+}
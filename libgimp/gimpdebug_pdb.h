@@ -32,8 +32,14 @@ G_BEGIN_DECLS
 /* For information look into the C source or the html documentation */
 
 
-gboolean gimp_debug_timer_start (void);
-gdouble  gimp_debug_timer_end   (void);
+gboolean gimp_debug_timer_start               (void);
+gdouble  gimp_debug_timer_end                 (void);
+gboolean gimp_debug_pdb_profile_start         (void);
+gchar**  gimp_debug_pdb_profile_end           (void);
+gint     gimp_debug_pdb_profile_get_procedure (const gchar *procedure_name,
+                                               gdouble     *total_time,
+                                               gdouble     *max_time,
+                                               gdouble     *marshal_time);
 
 
 G_END_DECLS
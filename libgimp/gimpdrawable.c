@@ -24,10 +24,30 @@
 
 #include <gobject/gvaluecollector.h>
 
+#include "gimpdrawablefilter-private.h"
 #include "gimppixbuf.h"
 #include "gimptilebackendplugin.h"
 
 
+#define PIXELS_PER_THREAD \
+  (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
+
+
+typedef struct
+{
+  GeglBuffer              *src_buffer;
+  GeglBuffer              *dest_buffer;
+  const Babl              *format;
+  GimpDrawableProcessFunc  func;
+  gpointer                 user_data;
+  gint                     canceled;
+} ProcessData;
+
+
+static void   gimp_drawable_process_area (const GeglRectangle *area,
+                                          ProcessData         *data);
+
+
 G_DEFINE_ABSTRACT_TYPE (GimpDrawable, gimp_drawable, GIMP_TYPE_ITEM)
 
 #define parent_class gimp_drawable_parent_class
@@ -494,6 +514,37 @@ gimp_drawable_merge_filter (GimpDrawable       *drawable,
   _gimp_drawable_merge_filter (drawable, filter);
 }
 
+/**
+ * gimp_drawable_merge_filter_copy:
+ * @drawable: The drawable.
+ * @filter: The drawable filter to copy.
+ *
+ * This procedure merges a copy of @filter on @drawable, with the same
+ * operation, arguments, opacity, blend mode and auxiliary inputs.
+ *
+ * Unlike with [method@Gimp.Drawable.merge_filter], @drawable may be
+ * any drawable, of any image, and @filter stays valid afterwards. This
+ * makes it possible to configure an effect once and apply it to many
+ * drawables, without recreating and re-configuring it for each of
+ * them. The settings of @filter are only synced with the core
+ * application when they changed since the last call.
+ *
+ * Returns: %TRUE on success.
+ *
+ * Since: 3.2
+ **/
+gboolean
+gimp_drawable_merge_filter_copy (GimpDrawable       *drawable,
+                                 GimpDrawableFilter *filter)
+{
+  g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), FALSE);
+  g_return_val_if_fail (GIMP_IS_DRAWABLE_FILTER (filter), FALSE);
+
+  _gimp_drawable_filter_sync (filter);
+
+  return _gimp_drawable_merge_filter_copy (drawable, filter);
+}
+
 /**
  * gimp_drawable_append_new_filter: (skip)
  * @drawable:       The #GimpDrawable.
@@ -671,3 +722,166 @@ gimp_drawable_merge_new_filter (GimpDrawable  *drawable,
   gimp_drawable_filter_set_opacity (filter, opacity);
   gimp_drawable_merge_filter (drawable, filter);
 }
+
+/**
+ * gimp_drawable_process_tiles_parallel:
+ * @drawable:      The drawable.
+ * @format:        (nullable): The format of the pixels passed to @func.
+ * @progress_text: (nullable): The text of the progress, or %NULL.
+ * @func:          (scope call): The function processing the pixels.
+ * @user_data:     User data passed to @func.
+ *
+ * Processes the pixels of @drawable within its selection bounds, in
+ * tile-aligned chunks spread over as many threads as the core uses,
+ * as set by the user in the preferences (see
+ * gimp_get_num_processors()).
+ *
+ * @func is called for each chunk, possibly from several threads at
+ * once, with the pixels of the chunk read from @drawable and the
+ * pixels to write to its shadow buffer, both in @format, or in the
+ * drawable's format if @format is %NULL. @func must therefore be
+ * thread-safe, and must not call any other libgimp function. It can
+ * return %FALSE to cancel the processing.
+ *
+ * If @progress_text is not %NULL, a progress is initialized with it
+ * and updated as the chunks get processed.
+ *
+ * When all the chunks have been processed, the shadow buffer is merged
+ * into @drawable, pushing an undo step, and @drawable is updated. If
+ * the processing was canceled, the shadow buffer is dropped and
+ * @drawable is left unchanged.
+ *
+ * Returns: %FALSE if @func canceled the processing, %TRUE otherwise.
+ *
+ * Since: 3.2
+ */
+gboolean
+gimp_drawable_process_tiles_parallel (GimpDrawable            *drawable,
+                                      const Babl              *format,
+                                      const gchar             *progress_text,
+                                      GimpDrawableProcessFunc  func,
+                                      gpointer                 user_data)
+{
+  ProcessData data;
+  gint        x, y, width, height;
+  gint        band_height;
+  gint        band_y;
+
+  g_return_val_if_fail (GIMP_IS_DRAWABLE (drawable), FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  if (! gimp_drawable_mask_intersect (drawable, &x, &y, &width, &height))
+    return TRUE;
+
+  if (! format)
+    format = gimp_drawable_get_format (drawable);
+
+  data.src_buffer  = gimp_drawable_get_buffer (drawable);
+  data.dest_buffer = gimp_drawable_get_shadow_buffer (drawable);
+  data.format      = format;
+  data.func        = func;
+  data.user_data   = user_data;
+  data.canceled    = FALSE;
+
+  if (progress_text)
+    gimp_progress_init (progress_text);
+
+  /*  process the area in bands of whole tile rows, each spread over all
+   *  threads, so that the progress can be updated from this thread in
+   *  between
+   */
+  band_height = gimp_tile_height ();
+  band_height = MAX (band_height * (gint) ceil (PIXELS_PER_THREAD *
+                                                gimp_get_num_processors () /
+                                                ((gdouble) width *
+                                                 band_height)),
+                     band_height);
+
+  for (band_y = y; band_y < y + height; )
+    {
+      GeglRectangle band;
+      gint          band_end;
+
+      /*  align the end of the band to the tile grid  */
+      band_end = (band_y / band_height + 1) * band_height;
+      band_end = MIN (band_end, y + height);
+
+      band.x      = x;
+      band.y      = band_y;
+      band.width  = width;
+      band.height = band_end - band_y;
+
+      gegl_parallel_distribute_area (
+        &band, PIXELS_PER_THREAD, GEGL_SPLIT_STRATEGY_AUTO,
+        (GeglParallelDistributeAreaFunc) gimp_drawable_process_area,
+        &data);
+
+      if (g_atomic_int_get (&data.canceled))
+        break;
+
+      band_y = band_end;
+
+      if (progress_text)
+        gimp_progress_update ((gdouble) (band_y - y) / height);
+    }
+
+  g_object_unref (data.src_buffer);
+
+  if (data.canceled)
+    {
+      g_object_unref (data.dest_buffer);
+
+      gimp_drawable_free_shadow (drawable);
+
+      return FALSE;
+    }
+
+  gegl_buffer_flush (data.dest_buffer);
+  g_object_unref (data.dest_buffer);
+
+  gimp_drawable_merge_shadow (drawable, TRUE);
+  gimp_drawable_update (drawable, x, y, width, height);
+
+  if (progress_text)
+    gimp_progress_update (1.0);
+
+  return TRUE;
+}
+
+
+/* Private functions. */
+
+static void
+gimp_drawable_process_area (const GeglRectangle *area,
+                            ProcessData         *data)
+{
+  GeglBufferIterator *iter;
+
+  if (g_atomic_int_get (&data->canceled))
+    return;
+
+  iter = gegl_buffer_iterator_new (data->src_buffer, area, 0,
+                                   data->format,
+                                   GEGL_ACCESS_READ, GEGL_ABYSS_NONE, 2);
+
+  gegl_buffer_iterator_add (iter, data->dest_buffer, area, 0,
+                            data->format,
+                            GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE);
+
+  while (gegl_buffer_iterator_next (iter))
+    {
+      if (g_atomic_int_get (&data->canceled) ||
+          ! data->func (iter->items[0].data,
+                        iter->items[1].data,
+                        iter->length,
+                        &iter->items[0].roi,
+                        data->user_data))
+        {
+          g_atomic_int_set (&data->canceled, TRUE);
+
+          gegl_buffer_iterator_stop (iter);
+
+          break;
+        }
+    }
+}
@@ -33,6 +33,29 @@ G_BEGIN_DECLS
 #include <libgimp/gimpitem.h>
 
 
+/**
+ * GimpDrawableProcessFunc:
+ * @src:       (not nullable): The source pixels of @roi.
+ * @dest:      (not nullable): The destination pixels of @roi.
+ * @n_pixels:  The number of pixels in @src and @dest.
+ * @roi:       The area of the pixels, in drawable coordinates.
+ * @user_data: User data passed to gimp_drawable_process_tiles_parallel().
+ *
+ * The function called by gimp_drawable_process_tiles_parallel() for
+ * each chunk of the drawable. It may be called from several threads at
+ * once.
+ *
+ * Returns: %FALSE to cancel the processing, %TRUE to continue.
+ *
+ * Since: 3.2
+ */
+typedef gboolean (* GimpDrawableProcessFunc) (gconstpointer        src,
+                                              gpointer             dest,
+                                              gint                 n_pixels,
+                                              const GeglRectangle *roi,
+                                              gpointer             user_data);
+
+
 #define GIMP_TYPE_DRAWABLE (gimp_drawable_get_type ())
 G_DECLARE_DERIVABLE_TYPE (GimpDrawable, gimp_drawable, GIMP, DRAWABLE, GimpItem)
 
@@ -97,6 +120,8 @@ void                 gimp_drawable_append_filter          (GimpDrawable
                                                            GimpDrawableFilter     *filter);
 void                 gimp_drawable_merge_filter           (GimpDrawable           *drawable,
                                                            GimpDrawableFilter     *filter);
+gboolean             gimp_drawable_merge_filter_copy      (GimpDrawable           *drawable,
+                                                           GimpDrawableFilter     *filter);
 
 GimpDrawableFilter * gimp_drawable_append_new_filter      (GimpDrawable           *drawable,
                                                            const gchar            *operation_name,
@@ -111,6 +136,12 @@ void                 gimp_drawable_merge_new_filter       (GimpDrawable
                                                            gdouble                 opacity,
                                                            ...) G_GNUC_NULL_TERMINATED;
 
+gboolean             gimp_drawable_process_tiles_parallel (GimpDrawable            *drawable,
+                                                           const Babl              *format,
+                                                           const gchar             *progress_text,
+                                                           GimpDrawableProcessFunc  func,
+                                                           gpointer                 user_data);
+
 
 G_END_DECLS
 
@@ -199,6 +199,120 @@ gimp_drawable_set_pixel (GimpDrawable *drawable,
   return success;
 }
 
+/**
+ * gimp_drawable_get_pixels:
+ * @drawable: The drawable.
+ * @x: The x coordinate of the area.
+ * @y: The y coordinate of the area.
+ * @width: The width of the area.
+ * @height: The height of the area.
+ * @format: The Babl format encoding of the pixels.
+ *
+ * Gets the pixels of an area of a drawable.
+ *
+ * This procedure returns the pixels of the area of the drawable at
+ * (@x, @y) of size (@width, @height), converted to the Babl format of
+ * encoding @format in the drawable's color space, e.g. \"R'G'B'A u8\".
+ * The pixels are returned row by row, without padding.
+ * Together with gimp_drawable_set_pixels(), this allows to pass image
+ * data to and from GIMP without going through files.
+ *
+ * Returns: (transfer full): The pixels.
+ *
+ * Since: 3.2
+ **/
+GBytes *
+gimp_drawable_get_pixels (GimpDrawable *drawable,
+                          gint          x,
+                          gint          y,
+                          gint          width,
+                          gint          height,
+                          const gchar  *format)
+{
+  GimpValueArray *args;
+  GimpValueArray *return_vals;
+  GBytes *pixels = NULL;
+
+  args = gimp_value_array_new_from_types (NULL,
+                                          GIMP_TYPE_DRAWABLE, drawable,
+                                          G_TYPE_INT, x,
+                                          G_TYPE_INT, y,
+                                          G_TYPE_INT, width,
+                                          G_TYPE_INT, height,
+                                          G_TYPE_STRING, format,
+                                          G_TYPE_NONE);
+
+  return_vals = _gimp_pdb_run_procedure_array (gimp_get_pdb (),
+                                               "gimp-drawable-get-pixels",
+                                               args);
+  gimp_value_array_unref (args);
+
+  if (GIMP_VALUES_GET_ENUM (return_vals, 0) == GIMP_PDB_SUCCESS)
+    pixels = GIMP_VALUES_DUP_BYTES (return_vals, 1);
+
+  gimp_value_array_unref (return_vals);
+
+  return pixels;
+}
+
+/**
+ * gimp_drawable_set_pixels:
+ * @drawable: The drawable.
+ * @x: The x coordinate of the area.
+ * @y: The y coordinate of the area.
+ * @width: The width of the area.
+ * @height: The height of the area.
+ * @format: The Babl format encoding of the pixels.
+ * @pixels: The pixels.
+ *
+ * Sets the pixels of an area of a drawable.
+ *
+ * This procedure replaces the pixels of the area of the drawable at
+ * (@x, @y) of size (@width, @height) with @pixels, given row by row,
+ * without padding, in the Babl format of encoding @format in the
+ * drawable's color space, e.g. \"R'G'B'A u8\".
+ * Note that this function is not undoable, you should use it only on
+ * drawables you just created yourself.
+ *
+ * Returns: TRUE on success.
+ *
+ * Since: 3.2
+ **/
+gboolean
+gimp_drawable_set_pixels (GimpDrawable *drawable,
+                          gint          x,
+                          gint          y,
+                          gint          width,
+                          gint          height,
+                          const gchar  *format,
+                          GBytes       *pixels)
+{
+  GimpValueArray *args;
+  GimpValueArray *return_vals;
+  gboolean success = TRUE;
+
+  args = gimp_value_array_new_from_types (NULL,
+                                          GIMP_TYPE_DRAWABLE, drawable,
+                                          G_TYPE_INT, x,
+                                          G_TYPE_INT, y,
+                                          G_TYPE_INT, width,
+                                          G_TYPE_INT, height,
+                                          G_TYPE_STRING, format,
+                                          G_TYPE_BYTES, pixels,
+                                          G_TYPE_NONE);
+
+  return_vals = _gimp_pdb_run_procedure_array (gimp_get_pdb (),
+                                               "gimp-drawable-set-pixels",
+                                               args);
+  gimp_value_array_unref (args);
+
+  success = GIMP_VALUES_GET_ENUM (return_vals, 0) == GIMP_PDB_SUCCESS;
+
+  gimp_value_array_unref (return_vals);
+
+  return success;
+}
+
 /**
  * gimp_drawable_type:
  * @drawable: The drawable.
@@ -776,6 +890,51 @@ _gimp_drawable_merge_filter (GimpDrawable       *drawable,
   return success;
 }
 
+/**
+ * _gimp_drawable_merge_filter_copy:
+ * @drawable: The drawable.
+ * @filter: The drawable filter to merge a copy of.
+ *
+ * Apply a copy of the specified effect directly to the drawable.
+ *
+ * This procedure applies a copy of @filter, with its operation,
+ * arguments, blend mode, opacity and auxiliary inputs, on @drawable
+ * and merges it, just like [method@Gimp.Drawable.merge_filter] would.
+ * Unlike the latter, @filter itself is neither applied nor
+ * invalidated, and it may have been created for any drawable, so a
+ * single configured filter can be merged on any number of drawables.
+ * This function is private and should not be used. Use
+ * [method@Gimp.Drawable.merge_filter_copy] instead.
+ *
+ * Returns: TRUE on success.
+ *
+ * Since: 3.2
+ **/
+gboolean
+_gimp_drawable_merge_filter_copy (GimpDrawable       *drawable,
+                                  GimpDrawableFilter *filter)
+{
+  GimpValueArray *args;
+  GimpValueArray *return_vals;
+  gboolean success = TRUE;
+
+  args = gimp_value_array_new_from_types (NULL,
+                                          GIMP_TYPE_DRAWABLE, drawable,
+                                          GIMP_TYPE_DRAWABLE_FILTER, filter,
+                                          G_TYPE_NONE);
+
+  return_vals = _gimp_pdb_run_procedure_array (gimp_get_pdb (),
+                                               "gimp-drawable-merge-filter-copy",
+                                               args);
+  gimp_value_array_unref (args);
+
+  success = GIMP_VALUES_GET_ENUM (return_vals, 0) == GIMP_PDB_SUCCESS;
+
+  gimp_value_array_unref (return_vals);
+
+  return success;
+}
+
 /**
  * gimp_drawable_get_filters:
  * @drawable: The drawable.
@@ -41,6 +41,19 @@ gboolean                 gimp_drawable_set_pixel             (GimpDrawable
                                                               gint                        x_coord,
                                                               gint                        y_coord,
                                                               GeglColor                  *color);
+GBytes*                  gimp_drawable_get_pixels            (GimpDrawable               *drawable,
+                                                              gint                        x,
+                                                              gint                        y,
+                                                              gint                        width,
+                                                              gint                        height,
+                                                              const gchar                *format);
+gboolean                 gimp_drawable_set_pixels            (GimpDrawable               *drawable,
+                                                              gint                        x,
+                                                              gint                        y,
+                                                              gint                        width,
+                                                              gint                        height,
+                                                              const gchar                *format,
+                                                              GBytes                     *pixels);
 GimpImageType            gimp_drawable_type                  (GimpDrawable               *drawable);
 GimpImageType            gimp_drawable_type_with_alpha       (GimpDrawable               *drawable);
 gboolean                 gimp_drawable_has_alpha             (GimpDrawable               *drawable);
@@ -67,6 +80,8 @@ G_GNUC_INTERNAL gboolean _gimp_drawable_append_filter        (GimpDrawable
                                                               GimpDrawableFilter         *filter);
 G_GNUC_INTERNAL gboolean _gimp_drawable_merge_filter         (GimpDrawable               *drawable,
                                                               GimpDrawableFilter         *filter);
+G_GNUC_INTERNAL gboolean _gimp_drawable_merge_filter_copy    (GimpDrawable               *drawable,
+                                                              GimpDrawableFilter         *filter);
 GimpDrawableFilter**     gimp_drawable_get_filters           (GimpDrawable               *drawable);
 gboolean                 gimp_drawable_merge_filters         (GimpDrawable               *drawable);
 gboolean                 gimp_drawable_merge_shadow          (GimpDrawable               *drawable,
@@ -0,0 +1,32 @@
+/* LIBGIMP - The GIMP Library
+ * Copyright (C) 1995-2000 Peter Mattis and Spencer Kimball
+ *
+ * gimpdrawablefilter-private.h
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GIMP_DRAWABLE_FILTER_PRIVATE_H__
+#define __GIMP_DRAWABLE_FILTER_PRIVATE_H__
+
+G_BEGIN_DECLS
+
+
+G_GNUC_INTERNAL void   _gimp_drawable_filter_sync (GimpDrawableFilter *filter);
+
+
+G_END_DECLS
+
+#endif /* __GIMP_DRAWABLE_FILTER_PRIVATE_H__ */
@@ -25,6 +25,7 @@
 
 #include "libgimpbase/gimpwire.h" /* FIXME kill this include */
 
+#include "gimpdrawablefilter-private.h"
 #include "gimpplugin-private.h"
 
 
@@ -49,6 +50,9 @@ struct _GimpDrawableFilter
   GHashTable               *pad_inputs;
 
   GimpDrawableFilterConfig *config;
+
+  /*  whether the settings changed since the last update  */
+  gboolean                  dirty;
 };
 
 
@@ -62,6 +66,10 @@ static void   gimp_drawable_filter_get_property  (GObject      *object,
                                                   GValue       *value,
                                                   GParamSpec   *pspec);
 
+static void   gimp_drawable_filter_config_notify (GObject            *config,
+                                                  GParamSpec         *pspec,
+                                                  GimpDrawableFilter *filter);
+
 
 G_DEFINE_TYPE (GimpDrawableFilter, gimp_drawable_filter, G_TYPE_OBJECT)
 
@@ -102,6 +110,8 @@ gimp_drawable_filter_init (GimpDrawableFilter *drawable_filter)
   drawable_filter->composite_space = GIMP_LAYER_COLOR_SPACE_AUTO;
 
   drawable_filter->pad_inputs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  drawable_filter->dirty = TRUE;
 }
 
 static void
@@ -236,6 +246,7 @@ gimp_drawable_filter_set_opacity (GimpDrawableFilter *filter,
   g_return_if_fail (opacity >= 0.0 && opacity <= 1.0);
 
   filter->opacity = opacity;
+  filter->dirty   = TRUE;
 }
 
 /**
@@ -257,6 +268,7 @@ gimp_drawable_filter_set_blend_mode (GimpDrawableFilter *filter,
   g_return_if_fail (GIMP_IS_DRAWABLE_FILTER (filter));
 
   filter->blend_mode = mode;
+  filter->dirty      = TRUE;
 }
 
 /**
@@ -282,6 +294,7 @@ gimp_drawable_filter_set_aux_input (GimpDrawableFilter *filter,
   g_return_if_fail (GIMP_IS_DRAWABLE (input));
 
   g_hash_table_insert (filter->pad_inputs, (gpointer) g_strdup (input_pad_name), input);
+  filter->dirty = TRUE;
 }
 
 /**
@@ -358,6 +371,10 @@ gimp_drawable_filter_get_config (GimpDrawableFilter *filter)
   g_strfreev (argnames);
   gimp_value_array_unref (values);
 
+  g_signal_connect_object (filter->config, "notify",
+                           G_CALLBACK (gimp_drawable_filter_config_notify),
+                           filter, 0);
+
   return filter->config;
 }
 
@@ -436,4 +453,29 @@ gimp_drawable_filter_update (GimpDrawableFilter *filter)
   gimp_value_array_unref (values);
   g_free (auxnames);
   g_free (auxinputs);
+
+  filter->dirty = FALSE;
+}
+
+
+/*  private functions  */
+
+/*  syncs @filter with the core application, unless none of its
+ *  settings changed since the last update
+ */
+void
+_gimp_drawable_filter_sync (GimpDrawableFilter *filter)
+{
+  g_return_if_fail (GIMP_IS_DRAWABLE_FILTER (filter));
+
+  if (filter->dirty)
+    gimp_drawable_filter_update (filter);
+}
+
+static void
+gimp_drawable_filter_config_notify (GObject            *config,
+                                    GParamSpec         *pspec,
+                                    GimpDrawableFilter *filter)
+{
+  filter->dirty = TRUE;
 }
@@ -167,6 +167,57 @@ gimp_file_load_layers (GimpRunMode  run_mode,
   return layers;
 }
 
+/**
+ * gimp_file_load_many:
+ * @run_mode: The run mode.
+ * @uris: (array zero-terminated=1): The URIs of the files to load.
+ * @n_jobs: The number of files to load at the same time, or 0.
+ *
+ * Loads a list of image files, several of them at the same time.
+ *
+ * This procedure behaves like the file-load procedure run on each of
+ * @uris in turn, but up to @n_jobs loader plug-ins run at the same
+ * time, and reusable loader plug-ins are kept running from one file to
+ * the next. If @n_jobs is 0, as many loaders as there are processors
+ * run at the same time.
+ * The returned images are in the order of @uris. Files which can't be
+ * loaded are left out, and a message is reported for each of them. The
+ * procedure only fails if none of the files could be loaded.
+ *
+ * Returns: (element-type GimpImage) (array zero-terminated=1) (transfer container):
+ *          The loaded images.
+ *          The returned value must be freed with g_free().
+ *
+ * Since: 3.2
+ **/
+GimpImage **
+gimp_file_load_many (GimpRunMode   run_mode,
+                     const gchar **uris,
+                     gint          n_jobs)
+{
+  GimpValueArray *args;
+  GimpValueArray *return_vals;
+  GimpImage **images = NULL;
+
+  args = gimp_value_array_new_from_types (NULL,
+                                          GIMP_TYPE_RUN_MODE, run_mode,
+                                          G_TYPE_STRV, uris,
+                                          G_TYPE_INT, n_jobs,
+                                          G_TYPE_NONE);
+
+  return_vals = _gimp_pdb_run_procedure_array (gimp_get_pdb (),
+                                               "gimp-file-load-many",
+                                               args);
+  gimp_value_array_unref (args);
+
+  if (GIMP_VALUES_GET_ENUM (return_vals, 0) == GIMP_PDB_SUCCESS)
+    images = g_value_dup_boxed (gimp_value_array_index (return_vals, 1));
+
+  gimp_value_array_unref (return_vals);
+
+  return images;
+}
+
 /**
  * gimp_file_save:
  * @run_mode: The run mode.
@@ -257,3 +308,50 @@ gimp_file_create_thumbnail (GimpImage *image,
 
   return success;
 }
+
+/**
+ * gimp_file_save_flattened:
+ * @image: The image to flatten.
+ * @file: The file to save the flattened image in.
+ *
+ * Saves a flattened copy of @image, without changing the image.
+ *
+ * This procedure composites the visible layers of @image onto the
+ * background color, like gimp-image-flatten does, and saves the result
+ * to @file with the handler selected by the file's extension and/or
+ * prefix. @image itself is left unchanged, and its projection isn't
+ * rendered.
+ * The layers are composited in chunks, and the result is kept in
+ * GEGL's tile cache, which swaps tiles out when it is full. Saving to
+ * XCF then writes the result tile by tile, so images larger than the
+ * available memory can be flattened this way. Other file formats may
+ * need the whole result in memory while exporting it.
+ *
+ * Returns: TRUE on success.
+ *
+ * Since: 3.2
+ **/
+gboolean
+gimp_file_save_flattened (GimpImage *image,
+                          GFile     *file)
+{
+  GimpValueArray *args;
+  GimpValueArray *return_vals;
+  gboolean success = TRUE;
+
+  args = gimp_value_array_new_from_types (NULL,
+                                          GIMP_TYPE_IMAGE, image,
+                                          G_TYPE_FILE, file,
+                                          G_TYPE_NONE);
+
+  return_vals = _gimp_pdb_run_procedure_array (gimp_get_pdb (),
+                                               "gimp-file-save-flattened",
+                                               args);
+  gimp_value_array_unref (args);
+
+  success = GIMP_VALUES_GET_ENUM (return_vals, 0) == GIMP_PDB_SUCCESS;
+
+  gimp_value_array_unref (return_vals);
+
+  return success;
+}
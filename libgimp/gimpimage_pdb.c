@@ -499,6 +499,71 @@ gimp_image_get_layers (GimpImage *image)
   return layers;
 }
 
+/**
+ * gimp_image_get_layer_tree_info:
+ * @image: The image.
+ * @num_info: (out): The number of integer attributes.
+ * @info: (out) (array length=num_info) (element-type gint32) (transfer full): The integer attributes of the layers, 10 per layer.
+ * @names: (out) (array zero-terminated=1) (transfer full): The names of the layers.
+ * @num_opacities: (out): The number of opacities.
+ * @opacities: (out) (array length=num_opacities) (element-type gdouble) (transfer full): The opacities of the layers.
+ *
+ * Returns the attributes of all the layers of the specified image.
+ *
+ * This procedure returns all the layers of the image, and the
+ * attributes usually queried for each of them, in a single call. The
+ * layers are listed depth-first, from topmost to bottommost, each
+ * group layer being followed by its children.
+ * @info contains 10 values per layer, in the order of @layers: the
+ * layer's ID, the ID of its parent group layer (or -1 for root
+ * layers), its X and Y offsets, its width and height, its
+ * #GimpLayerMode, its visibility (0 or 1), its #GimpImageType and
+ * whether it is a group layer (0 or 1). @names and @opacities contain
+ * each layer's name and opacity, in the same order.
+ *
+ * Returns: (element-type GimpLayer) (array zero-terminated=1) (transfer container):
+ *          All the layers of the image.
+ *          The returned value must be freed with g_free().
+ *
+ * Since: 3.2
+ **/
+GimpLayer **
+gimp_image_get_layer_tree_info (GimpImage   *image,
+                                gsize       *num_info,
+                                gint       **info,
+                                gchar     ***names,
+                                gsize       *num_opacities,
+                                gdouble    **opacities)
+{
+  GimpValueArray *args;
+  GimpValueArray *return_vals;
+  GimpLayer **layers = NULL;
+
+  args = gimp_value_array_new_from_types (NULL,
+                                          GIMP_TYPE_IMAGE, image,
+                                          G_TYPE_NONE);
+
+  return_vals = _gimp_pdb_run_procedure_array (gimp_get_pdb (),
+                                               "gimp-image-get-layer-tree-info",
+                                               args);
+  gimp_value_array_unref (args);
+
+  *num_info = 0;
+  *num_opacities = 0;
+
+  if (GIMP_VALUES_GET_ENUM (return_vals, 0) == GIMP_PDB_SUCCESS)
+    {
+      layers = g_value_dup_boxed (gimp_value_array_index (return_vals, 1));
+      *info = GIMP_VALUES_DUP_INT32_ARRAY (return_vals, 2, num_info);
+      *names = GIMP_VALUES_DUP_STRV (return_vals, 3);
+      *opacities = GIMP_VALUES_DUP_DOUBLE_ARRAY (return_vals, 4, num_opacities);
+    }
+
+  gimp_value_array_unref (return_vals);
+
+  return layers;
+}
+
 /**
  * gimp_image_get_channels:
  * @image: The image.
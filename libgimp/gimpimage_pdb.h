@@ -49,6 +49,12 @@ GimpLayerMode            gimp_image_get_default_new_layer_mode (GimpImage
 gint                     gimp_image_get_width                  (GimpImage            *image);
 gint                     gimp_image_get_height                 (GimpImage            *image);
 GimpLayer**              gimp_image_get_layers                 (GimpImage            *image);
+GimpLayer**              gimp_image_get_layer_tree_info        (GimpImage            *image,
+                                                                gsize                *num_info,
+                                                                gint                **info,
+                                                                gchar              ***names,
+                                                                gsize                *num_opacities,
+                                                                gdouble             **opacities);
 GimpChannel**            gimp_image_get_channels               (GimpImage            *image);
 GimpPath**               gimp_image_get_paths                  (GimpImage            *image);
 gboolean                 gimp_image_unset_active_channel       (GimpImage            *image);
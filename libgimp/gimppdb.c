@@ -30,6 +30,7 @@
 #include "gimppdb_pdb.h"
 #include "gimppdbprocedure.h"
 #include "gimpplugin-private.h"
+#include "gimptilebackendplugin.h"
 
 #include "libgimp-intl.h"
 
@@ -51,14 +52,27 @@ struct _GimpPDB
 
   GimpPDBStatusType   error_status;
   gchar              *error_message;
+
+  GArray             *batch_runs;
+  GArray             *batch_links;
+
+  guint32             async_handle;
+  GHashTable         *async_returns;
 };
 
 
-static void   gimp_pdb_dispose   (GObject        *object);
-static void   gimp_pdb_finalize  (GObject        *object);
+static void   gimp_pdb_dispose     (GObject        *object);
+static void   gimp_pdb_finalize    (GObject        *object);
+
+static void   gimp_pdb_set_error   (GimpPDB        *pdb,
+                                    GimpValueArray *return_values);
+static void   gimp_pdb_batch_clear (GimpPDB        *pdb);
 
-static void   gimp_pdb_set_error (GimpPDB        *pdb,
-                                  GimpValueArray *return_values);
+static GimpValueArray *
+              gimp_pdb_async_wait  (GimpPDB        *pdb,
+                                    gint            handle,
+                                    gboolean        wait,
+                                    gint           *n_ahead);
 
 
 G_DEFINE_TYPE (GimpPDB, gimp_pdb, G_TYPE_OBJECT)
@@ -81,6 +95,10 @@ gimp_pdb_init (GimpPDB *pdb)
   pdb->procedures = g_hash_table_new_full (g_str_hash, g_str_equal,
                                            g_free, g_object_unref);
 
+  pdb->async_returns = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                              NULL,
+                                              (GDestroyNotify) gimp_value_array_unref);
+
   pdb->error_status = GIMP_PDB_SUCCESS;
 }
 
@@ -99,6 +117,10 @@ gimp_pdb_finalize (GObject *object)
 {
   GimpPDB *pdb = GIMP_PDB (object);
 
+  gimp_pdb_batch_clear (pdb);
+
+  g_clear_pointer (&pdb->async_returns, g_hash_table_unref);
+
   g_clear_object (&pdb->plug_in);
   g_clear_pointer (&pdb->error_message, g_free);
 
@@ -369,6 +391,351 @@ gimp_pdb_get_last_status (GimpPDB *pdb)
   return pdb->error_status;
 }
 
+/**
+ * gimp_pdb_batch_begin:
+ * @pdb: a #GimpPDB.
+ *
+ * Starts a batch of procedure calls.  The calls added with
+ * gimp_pdb_batch_add() are not run right away, but all sent to GIMP at
+ * once by gimp_pdb_batch_commit(), which returns all of their return
+ * values at once.  This saves a round trip to GIMP per call, which
+ * matters when making many calls to quick procedures.
+ *
+ * Any batch which was begun and not committed is discarded.
+ *
+ * Since: 3.2
+ **/
+void
+gimp_pdb_batch_begin (GimpPDB *pdb)
+{
+  g_return_if_fail (GIMP_IS_PDB (pdb));
+
+  gimp_pdb_batch_clear (pdb);
+
+  pdb->batch_runs  = g_array_new (FALSE, FALSE, sizeof (GPProcRun));
+  pdb->batch_links = g_array_new (FALSE, FALSE, sizeof (GPProcLink));
+}
+
+/**
+ * gimp_pdb_batch_add:
+ * @pdb:            a #GimpPDB.
+ * @procedure_name: the procedure registered name.
+ * @arguments:      the call arguments.
+ *
+ * Adds a call of the procedure named @procedure_name with @arguments to
+ * the batch begun with gimp_pdb_batch_begin().
+ *
+ * Returns: the index of the call in the batch, or -1 on error.
+ *
+ * Since: 3.2
+ **/
+gint
+gimp_pdb_batch_add (GimpPDB              *pdb,
+                    const gchar          *procedure_name,
+                    const GimpValueArray *arguments)
+{
+  GPProcRun proc_run;
+
+  g_return_val_if_fail (GIMP_IS_PDB (pdb), -1);
+  g_return_val_if_fail (pdb->batch_runs != NULL, -1);
+  g_return_val_if_fail (gimp_is_canonical_identifier (procedure_name), -1);
+  g_return_val_if_fail (arguments != NULL, -1);
+  g_return_val_if_fail (pdb->batch_runs->len < GP_PROC_LIST_MAX_RUNS, -1);
+
+  proc_run.name     = g_strdup (procedure_name);
+  proc_run.n_params = gimp_value_array_length (arguments);
+  proc_run.params   = _gimp_value_array_to_gp_params (arguments, TRUE);
+
+  g_array_append_val (pdb->batch_runs, proc_run);
+
+  return pdb->batch_runs->len - 1;
+}
+
+/**
+ * gimp_pdb_batch_link:
+ * @pdb:          a #GimpPDB.
+ * @call:         the index of a call in the batch.
+ * @argument:     the index of an argument of @call.
+ * @source_call:  the index of an earlier call in the batch.
+ * @source_value: the index of a return value of @source_call.
+ *
+ * Makes argument @argument of call @call be return value @source_value
+ * of the earlier call @source_call, when the batch is run.  Return value
+ * 0 being the status, the first actual return value is 1.  The argument
+ * passed to gimp_pdb_batch_add() is only a placeholder then, which must
+ * be of the type expected by the procedure, e.g. a %NULL image.
+ *
+ * If @source_call fails, @call is not run, and returns
+ * %GIMP_PDB_CALLING_ERROR.
+ *
+ * Returns: TRUE on success.
+ *
+ * Since: 3.2
+ **/
+gboolean
+gimp_pdb_batch_link (GimpPDB *pdb,
+                     gint     call,
+                     gint     argument,
+                     gint     source_call,
+                     gint     source_value)
+{
+  GPProcLink proc_link;
+
+  g_return_val_if_fail (GIMP_IS_PDB (pdb), FALSE);
+  g_return_val_if_fail (pdb->batch_runs != NULL, FALSE);
+  g_return_val_if_fail (call >= 0 && call < (gint) pdb->batch_runs->len, FALSE);
+  g_return_val_if_fail (source_call >= 0 && source_call < call, FALSE);
+  g_return_val_if_fail (argument >= 0, FALSE);
+  g_return_val_if_fail (source_value >= 0, FALSE);
+  g_return_val_if_fail (pdb->batch_links->len < GP_PROC_LIST_MAX_LINKS, FALSE);
+
+  proc_link.call         = call;
+  proc_link.argument     = argument;
+  proc_link.source_call  = source_call;
+  proc_link.source_value = source_value;
+
+  g_array_append_val (pdb->batch_links, proc_link);
+
+  return TRUE;
+}
+
+/**
+ * gimp_pdb_batch_commit:
+ * @pdb:       a #GimpPDB.
+ * @n_results: (out): the number of calls in the batch.
+ *
+ * Runs the calls of the batch begun with gimp_pdb_batch_begin(), in the
+ * order they were added, in a single round trip to GIMP, and ends the
+ * batch.
+ *
+ * The last error and status of @pdb are those of the first call which
+ * failed, or of the last call if none did.
+ *
+ * Returns: (array length=n_results) (transfer full): the return values
+ *          of each call.
+ *
+ * Since: 3.2
+ **/
+GimpValueArray **
+gimp_pdb_batch_commit (GimpPDB *pdb,
+                       gint    *n_results)
+{
+  GPProcRunList      proc_run_list;
+  GPProcReturnList  *proc_return_list;
+  GimpWireMessage    msg;
+  GimpValueArray   **results;
+  GimpValueArray    *error_values = NULL;
+  guint              n_runs;
+  guint              i;
+
+  g_return_val_if_fail (GIMP_IS_PDB (pdb), NULL);
+  g_return_val_if_fail (pdb->batch_runs != NULL, NULL);
+  g_return_val_if_fail (n_results != NULL, NULL);
+
+  n_runs = pdb->batch_runs->len;
+
+  *n_results = n_runs;
+
+  if (n_runs == 0)
+    {
+      gimp_pdb_batch_clear (pdb);
+
+      return NULL;
+    }
+
+  proc_run_list.n_runs  = n_runs;
+  proc_run_list.runs    = (GPProcRun *) pdb->batch_runs->data;
+  proc_run_list.n_links = pdb->batch_links->len;
+  proc_run_list.links   = (GPProcLink *) pdb->batch_links->data;
+
+  /*  the procedures might change any drawable, drop read-ahead tiles  */
+  _gimp_tile_backend_plugin_drop_prefetched ();
+
+  if (! gp_proc_run_list_write (_gimp_plug_in_get_write_channel (pdb->plug_in),
+                                &proc_run_list, pdb->plug_in))
+    gimp_quit ();
+
+  gimp_pdb_batch_clear (pdb);
+
+  _gimp_plug_in_read_expect_msg (pdb->plug_in, &msg, GP_PROC_RETURN_LIST);
+
+  proc_return_list = msg.data;
+
+  results = g_new0 (GimpValueArray *, n_runs);
+
+  for (i = 0; i < n_runs; i++)
+    {
+      if (i < proc_return_list->n_returns)
+        {
+          GPProcReturn *proc_return = &proc_return_list->returns[i];
+
+          results[i] = _gimp_gp_params_to_value_array (NULL,
+                                                       NULL, 0,
+                                                       proc_return->params,
+                                                       proc_return->n_params,
+                                                       TRUE);
+        }
+      else
+        {
+          /*  GIMP stopped before running this call  */
+          GValue value = G_VALUE_INIT;
+
+          results[i] = gimp_value_array_new (1);
+
+          g_value_init (&value, GIMP_TYPE_PDB_STATUS_TYPE);
+          g_value_set_enum (&value, GIMP_PDB_CALLING_ERROR);
+          gimp_value_array_append (results[i], &value);
+          g_value_unset (&value);
+        }
+
+      if (! error_values &&
+          gimp_value_array_length (results[i]) > 0 &&
+          GIMP_VALUES_GET_ENUM (results[i], 0) != GIMP_PDB_SUCCESS)
+        {
+          error_values = results[i];
+        }
+    }
+
+  gimp_wire_destroy (&msg);
+
+  gimp_pdb_set_error (pdb, error_values ? error_values : results[n_runs - 1]);
+
+  return results;
+}
+
+/**
+ * gimp_pdb_run_procedure_async:
+ * @pdb:            a #GimpPDB.
+ * @procedure_name: the procedure registered name.
+ * @arguments:      the call arguments.
+ *
+ * Starts a call of the procedure named @procedure_name with @arguments,
+ * without waiting for it to finish.  GIMP runs the call in its main
+ * loop, while the plug-in goes on with other work, and
+ * gimp_pdb_async_finish() returns its return values.
+ *
+ * Calls run in the order they were made, and all pending calls are
+ * run before any procedure the plug-in runs synchronously, so the
+ * plug-in sees their effects then.  The plug-in should not access the
+ * pixels of the drawables used by a call before it finished.
+ *
+ * Returns: the handle of the call, or -1 on error.
+ *
+ * Since: 3.2
+ **/
+gint
+gimp_pdb_run_procedure_async (GimpPDB              *pdb,
+                              const gchar          *procedure_name,
+                              const GimpValueArray *arguments)
+{
+  GPProcRunAsync proc_run_async;
+
+  g_return_val_if_fail (GIMP_IS_PDB (pdb), -1);
+  g_return_val_if_fail (gimp_is_canonical_identifier (procedure_name), -1);
+  g_return_val_if_fail (arguments != NULL, -1);
+
+  proc_run_async.handle            = pdb->async_handle++ & G_MAXINT32;
+  proc_run_async.proc_run.name     = (gchar *) procedure_name;
+  proc_run_async.proc_run.n_params = gimp_value_array_length (arguments);
+  proc_run_async.proc_run.params   = _gimp_value_array_to_gp_params (arguments,
+                                                                     TRUE);
+
+  /*  the procedure might change any drawable, drop read-ahead tiles  */
+  _gimp_tile_backend_plugin_drop_prefetched ();
+
+  if (! gp_proc_run_async_write (_gimp_plug_in_get_write_channel (pdb->plug_in),
+                                 &proc_run_async, pdb->plug_in))
+    gimp_quit ();
+
+  _gimp_gp_params_free (proc_run_async.proc_run.params,
+                        proc_run_async.proc_run.n_params, TRUE);
+
+  /*  forget the return values of an earlier call with the same handle  */
+  g_hash_table_remove (pdb->async_returns,
+                       GINT_TO_POINTER (proc_run_async.handle));
+
+  return proc_run_async.handle;
+}
+
+/**
+ * gimp_pdb_async_poll:
+ * @pdb:     a #GimpPDB.
+ * @handle:  a handle returned by gimp_pdb_run_procedure_async().
+ * @n_ahead: (out) (optional): the number of calls GIMP runs before
+ *           this one.
+ *
+ * Checks whether the call @handle finished, without waiting for it.
+ * While it didn't, @n_ahead tells how far it still is from running,
+ * which can be used to show the progress of a series of calls.
+ *
+ * Returns: TRUE if the call finished, or is not known to GIMP.
+ *
+ * Since: 3.2
+ **/
+gboolean
+gimp_pdb_async_poll (GimpPDB *pdb,
+                     gint     handle,
+                     gint    *n_ahead)
+{
+  GimpValueArray *return_vals;
+
+  g_return_val_if_fail (GIMP_IS_PDB (pdb), TRUE);
+  g_return_val_if_fail (handle >= 0, TRUE);
+
+  if (n_ahead)
+    *n_ahead = 0;
+
+  if (g_hash_table_contains (pdb->async_returns, GINT_TO_POINTER (handle)))
+    return TRUE;
+
+  return_vals = gimp_pdb_async_wait (pdb, handle, FALSE, n_ahead);
+
+  if (! return_vals)
+    return FALSE;
+
+  g_hash_table_insert (pdb->async_returns,
+                       GINT_TO_POINTER (handle), return_vals);
+
+  return TRUE;
+}
+
+/**
+ * gimp_pdb_async_finish:
+ * @pdb:    a #GimpPDB.
+ * @handle: a handle returned by gimp_pdb_run_procedure_async().
+ *
+ * Waits for the call @handle to finish, if it didn't already, and
+ * returns its return values.  The last error and status of @pdb are
+ * set from them, as if the call was just run.
+ *
+ * The return values of a call can only be gotten once, finishing an
+ * unknown call returns %GIMP_PDB_CALLING_ERROR.
+ *
+ * Returns: (transfer full): the return values of the call.
+ *
+ * Since: 3.2
+ **/
+GimpValueArray *
+gimp_pdb_async_finish (GimpPDB *pdb,
+                       gint     handle)
+{
+  GimpValueArray *return_vals = NULL;
+
+  g_return_val_if_fail (GIMP_IS_PDB (pdb), NULL);
+  g_return_val_if_fail (handle >= 0, NULL);
+
+  if (! g_hash_table_steal_extended (pdb->async_returns,
+                                     GINT_TO_POINTER (handle),
+                                     NULL, (gpointer *) &return_vals))
+    {
+      return_vals = gimp_pdb_async_wait (pdb, handle, TRUE, NULL);
+    }
+
+  gimp_pdb_set_error (pdb, return_vals);
+
+  return return_vals;
+}
+
 /*  Cruft API  */
 
 /**
@@ -454,6 +821,9 @@ _gimp_pdb_run_procedure_array (GimpPDB              *pdb,
   proc_run.n_params = gimp_value_array_length (arguments);
   proc_run.params   = _gimp_value_array_to_gp_params (arguments, FALSE);
 
+  /*  the procedure might change any drawable, drop read-ahead tiles  */
+  _gimp_tile_backend_plugin_drop_prefetched ();
+
   if (! gp_proc_run_write (_gimp_plug_in_get_write_channel (pdb->plug_in),
                            &proc_run, pdb->plug_in))
     gimp_quit ();
@@ -511,3 +881,85 @@ gimp_pdb_set_error (GimpPDB        *pdb,
         }
     }
 }
+
+/*  asks GIMP for the return values of call 'handle', after running it
+ *  if 'wait' is TRUE; returns NULL while it is pending
+ */
+static GimpValueArray *
+gimp_pdb_async_wait (GimpPDB  *pdb,
+                     gint      handle,
+                     gboolean  wait,
+                     gint     *n_ahead)
+{
+  GPProcAsyncPoll    proc_async_poll;
+  GPProcAsyncReturn *proc_async_return;
+  GimpWireMessage    msg;
+  GimpValueArray    *return_vals = NULL;
+
+  proc_async_poll.handle = handle;
+  proc_async_poll.wait   = wait;
+
+  if (! gp_proc_async_poll_write (_gimp_plug_in_get_write_channel (pdb->plug_in),
+                                  &proc_async_poll, pdb->plug_in))
+    gimp_quit ();
+
+  _gimp_plug_in_read_expect_msg (pdb->plug_in, &msg, GP_PROC_ASYNC_RETURN);
+
+  proc_async_return = msg.data;
+
+  switch (proc_async_return->status)
+    {
+    case GP_PROC_ASYNC_PENDING:
+      if (n_ahead)
+        *n_ahead = proc_async_return->n_ahead;
+      break;
+
+    case GP_PROC_ASYNC_DONE:
+      return_vals =
+        _gimp_gp_params_to_value_array (NULL,
+                                        NULL, 0,
+                                        proc_async_return->proc_return.params,
+                                        proc_async_return->proc_return.n_params,
+                                        TRUE);
+      break;
+
+    default:
+      {
+        /*  GIMP doesn't know the call  */
+        GValue value = G_VALUE_INIT;
+
+        return_vals = gimp_value_array_new (1);
+
+        g_value_init (&value, GIMP_TYPE_PDB_STATUS_TYPE);
+        g_value_set_enum (&value, GIMP_PDB_CALLING_ERROR);
+        gimp_value_array_append (return_vals, &value);
+        g_value_unset (&value);
+      }
+      break;
+    }
+
+  gimp_wire_destroy (&msg);
+
+  return return_vals;
+}
+
+static void
+gimp_pdb_batch_clear (GimpPDB *pdb)
+{
+  if (pdb->batch_runs)
+    {
+      guint i;
+
+      for (i = 0; i < pdb->batch_runs->len; i++)
+        {
+          GPProcRun *proc_run = &g_array_index (pdb->batch_runs, GPProcRun, i);
+
+          _gimp_gp_params_free (proc_run->params, proc_run->n_params, TRUE);
+          g_free (proc_run->name);
+        }
+
+      g_clear_pointer (&pdb->batch_runs, g_array_unref);
+    }
+
+  g_clear_pointer (&pdb->batch_links, g_array_unref);
+}
@@ -58,6 +58,27 @@ gchar             ** gimp_pdb_query_procedures     (GimpPDB              *pdb,
 const gchar        * gimp_pdb_get_last_error       (GimpPDB              *pdb);
 GimpPDBStatusType    gimp_pdb_get_last_status      (GimpPDB              *pdb);
 
+void                 gimp_pdb_batch_begin          (GimpPDB              *pdb);
+gint                 gimp_pdb_batch_add            (GimpPDB              *pdb,
+                                                    const gchar          *procedure_name,
+                                                    const GimpValueArray *arguments);
+gboolean             gimp_pdb_batch_link           (GimpPDB              *pdb,
+                                                    gint                  call,
+                                                    gint                  argument,
+                                                    gint                  source_call,
+                                                    gint                  source_value);
+GimpValueArray    ** gimp_pdb_batch_commit         (GimpPDB              *pdb,
+                                                    gint                 *n_results);
+
+gint                 gimp_pdb_run_procedure_async  (GimpPDB              *pdb,
+                                                    const gchar          *procedure_name,
+                                                    const GimpValueArray *arguments);
+gboolean             gimp_pdb_async_poll           (GimpPDB              *pdb,
+                                                    gint                  handle,
+                                                    gint                 *n_ahead);
+GimpValueArray     * gimp_pdb_async_finish         (GimpPDB              *pdb,
+                                                    gint                  handle);
+
 
 /* Internal use */
 
@@ -139,6 +139,7 @@ typedef struct _GimpPlugInPrivate
   gulong      write_buffer_index;
 
   guint       persistent_source_id;
+  gboolean    reusable;
 
   gchar      *translation_domain_name;
   GFile      *translation_domain_path;
@@ -885,6 +886,38 @@ gimp_plug_in_get_pdb_error_handler (GimpPlugIn *plug_in)
   return _gimp_plug_in_get_pdb_error_handler ();
 }
 
+/**
+ * gimp_plug_in_set_reusable:
+ * @plug_in:  A plug-in
+ * @reusable: Whether the plug-in process can serve more than one call.
+ *
+ * Declares that the plug-in doesn't keep any state from one run of its
+ * procedures to the next, so that its process can be kept running after
+ * a procedure returned, and be handed the next call into the plug-in
+ * instead of starting a new process.
+ *
+ * Whether GIMP actually keeps the process around depends on the
+ * "plug-in-pool-size" setting in gimprc. If it doesn't, the plug-in
+ * quits as usual after its procedure returned.
+ *
+ * Call this before the plug-in's procedure returns, for example from
+ * the plug-in's constructor.
+ *
+ * Since: 3.2
+ **/
+void
+gimp_plug_in_set_reusable (GimpPlugIn *plug_in,
+                           gboolean    reusable)
+{
+  GimpPlugInPrivate *priv;
+
+  g_return_if_fail (GIMP_IS_PLUG_IN (plug_in));
+
+  priv = gimp_plug_in_get_instance_private (plug_in);
+
+  priv->reusable = reusable ? TRUE : FALSE;
+}
+
 
 /*  internal functions  */
 
@@ -1380,13 +1413,25 @@ gimp_plug_in_loop (GimpPlugIn *plug_in)
         case GP_TILE_REQ:
         case GP_TILE_ACK:
         case GP_TILE_DATA:
+        case GP_TILE_LIST_REQ:
+        case GP_TILE_LIST_DATA:
+        case GP_TILE_MAP_REQ:
+        case GP_TILE_MAP_DATA:
+        case GP_TILE_MAP_FILL:
           g_warning ("unexpected tile message received (should not happen)");
           break;
 
         case GP_PROC_RUN:
           gimp_plug_in_main_proc_run (plug_in, msg.data);
           gimp_wire_destroy (&msg);
-          return;
+
+          /*  a reusable plug-in waits for the next GP_CONFIG and
+           *  GP_PROC_RUN, or for a GP_QUIT
+           */
+          if (! priv->reusable)
+            return;
+
+          continue;
 
         case GP_PROC_RETURN:
           g_warning ("unexpected proc return message received (should not happen)");
@@ -1407,6 +1452,30 @@ gimp_plug_in_loop (GimpPlugIn *plug_in)
         case GP_HAS_INIT:
           g_warning ("unexpected has init message received (should not happen)");
           break;
+
+        case GP_KEEP_ALIVE:
+          g_warning ("unexpected keep alive message received (should not happen)");
+          break;
+
+        case GP_PROC_RUN_LIST:
+          g_warning ("unexpected proc run list message received (should not happen)");
+          break;
+
+        case GP_PROC_RETURN_LIST:
+          g_warning ("unexpected proc return list message received (should not happen)");
+          break;
+
+        case GP_PROC_RUN_ASYNC:
+          g_warning ("unexpected proc run async message received (should not happen)");
+          break;
+
+        case GP_PROC_ASYNC_POLL:
+          g_warning ("unexpected proc async poll message received (should not happen)");
+          break;
+
+        case GP_PROC_ASYNC_RETURN:
+          g_warning ("unexpected proc async return message received (should not happen)");
+          break;
         }
 
       gimp_wire_destroy (&msg);
@@ -1445,6 +1514,11 @@ gimp_plug_in_process_message (GimpPlugIn      *plug_in,
     case GP_TILE_REQ:
     case GP_TILE_ACK:
     case GP_TILE_DATA:
+    case GP_TILE_LIST_REQ:
+    case GP_TILE_LIST_DATA:
+    case GP_TILE_MAP_REQ:
+    case GP_TILE_MAP_DATA:
+    case GP_TILE_MAP_FILL:
       g_warning ("unexpected tile message received (should not happen)");
       break;
     case GP_PROC_RUN:
@@ -1465,6 +1539,24 @@ gimp_plug_in_process_message (GimpPlugIn      *plug_in,
     case GP_HAS_INIT:
       g_warning ("unexpected has init message received (should not happen)");
       break;
+    case GP_KEEP_ALIVE:
+      g_warning ("unexpected keep alive message received (should not happen)");
+      break;
+    case GP_PROC_RUN_LIST:
+      g_warning ("unexpected proc run list message received (should not happen)");
+      break;
+    case GP_PROC_RETURN_LIST:
+      g_warning ("unexpected proc return list message received (should not happen)");
+      break;
+    case GP_PROC_RUN_ASYNC:
+      g_warning ("unexpected proc run async message received (should not happen)");
+      break;
+    case GP_PROC_ASYNC_POLL:
+      g_warning ("unexpected proc async poll message received (should not happen)");
+      break;
+    case GP_PROC_ASYNC_RETURN:
+      g_warning ("unexpected proc async return message received (should not happen)");
+      break;
     }
 }
 
@@ -1487,6 +1579,11 @@ gimp_plug_in_main_proc_run (GimpPlugIn *plug_in,
 
   gimp_plug_in_main_run_cleanup (plug_in);
 
+  /*  tell the core we stay around after returning  */
+  if (priv->reusable &&
+      ! gp_keep_alive_write (priv->write_channel, plug_in))
+    gimp_quit ();
+
   if (! gp_proc_return_write (priv->write_channel,
                               &proc_return, plug_in))
     gimp_quit ();
@@ -209,6 +209,9 @@ void            gimp_plug_in_persistent_enable      (GimpPlugIn    *plug_in);
 void            gimp_plug_in_persistent_process     (GimpPlugIn    *plug_in,
                                                      guint          timeout);
 
+void            gimp_plug_in_set_reusable           (GimpPlugIn    *plug_in,
+                                                     gboolean       reusable);
+
 void            gimp_plug_in_set_pdb_error_handler  (GimpPlugIn    *plug_in,
                                                      GimpPDBErrorHandler  handler);
 GimpPDBErrorHandler
@@ -24,6 +24,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <glib/gstdio.h>
+
 #include "gimp.h"
 
 #include "libgimpbase/gimpprotocol.h"
@@ -38,7 +40,8 @@
 #define TILE_HEIGHT gimp_tile_height()
 
 
-typedef struct _GimpTile GimpTile;
+typedef struct _GimpTile    GimpTile;
+typedef struct _GimpTileMap GimpTileMap;
 
 struct _GimpTile
 {
@@ -50,25 +53,47 @@ struct _GimpTile
   guchar *data;     /* the pixel data for the tile */
 };
 
+struct _GimpTileMap
+{
+  gint    ref_count;
+
+  guchar *addr;        /* the drawable's tiles, as exported by the core */
+  gsize   size;
+  gsize   header_size;
+  gsize   tile_size;
+};
+
 
 struct _GimpTileBackendPluginPrivate
 {
-  gint32   drawable_id;
-  gboolean shadow;
-  gint     width;
-  gint     height;
-  gint     bpp;
-  gint     ntile_rows;
-  gint     ntile_cols;
+  gint32       drawable_id;
+  gboolean     shadow;
+  gint         width;
+  gint         height;
+  gint         bpp;
+  gint         ntile_rows;
+  gint         ntile_cols;
+
+  /* read-ahead */
+  gint         last_tile_num;
+  GHashTable  *prefetched;
+  gint         prefetch_serial;
+
+  /* tiles mapped from the core */
+  GimpTileMap *map;
+  gboolean     map_requested;
+  guint8      *written;
 };
 
 
-static gpointer   gimp_tile_backend_plugin_command (GeglTileSource  *tile_store,
-                                                    GeglTileCommand  command,
-                                                    gint             x,
-                                                    gint             y,
-                                                    gint             z,
-                                                    gpointer         data);
+static void       gimp_tile_backend_plugin_finalize (GObject         *object);
+
+static gpointer   gimp_tile_backend_plugin_command  (GeglTileSource  *tile_store,
+                                                     GeglTileCommand  command,
+                                                     gint             x,
+                                                     gint             y,
+                                                     gint             z,
+                                                     gpointer         data);
 
 static gboolean   gimp_tile_write (GimpTileBackendPlugin *backend_plugin,
                                    gint                   x,
@@ -86,9 +111,16 @@ static void       gimp_tile_unset (GimpTileBackendPlugin *backend_plugin,
                                    GimpTile              *tile);
 static void       gimp_tile_get   (GimpTileBackendPlugin *backend_plugin,
                                    GimpTile              *tile);
+static void       gimp_tile_drop  (GimpTileBackendPlugin *backend_plugin,
+                                   gint                   tile_num);
 static void       gimp_tile_put   (GimpTileBackendPlugin *backend_plugin,
                                    GimpTile              *tile);
 
+static void       gimp_tile_map_request (GimpTileBackendPlugin *backend_plugin);
+static GeglTile * gimp_tile_map_read    (GimpTileBackendPlugin *backend_plugin,
+                                         gint                   tile_num);
+static void       gimp_tile_map_unref   (GimpTileMap           *map);
+
 
 G_DEFINE_TYPE_WITH_PRIVATE (GimpTileBackendPlugin, _gimp_tile_backend_plugin,
                             GEGL_TYPE_TILE_BACKEND)
@@ -98,10 +130,16 @@ G_DEFINE_TYPE_WITH_PRIVATE (GimpTileBackendPlugin, _gimp_tile_backend_plugin,
 
 static GMutex backend_plugin_mutex;
 
+/* incremented whenever tiles fetched ahead of time might have become stale */
+static gint   backend_plugin_prefetch_serial = 0;
+
 
 static void
 _gimp_tile_backend_plugin_class_init (GimpTileBackendPluginClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = gimp_tile_backend_plugin_finalize;
 }
 
 static void
@@ -111,9 +149,27 @@ _gimp_tile_backend_plugin_init (GimpTileBackendPlugin *backend)
 
   backend->priv = _gimp_tile_backend_plugin_get_instance_private (backend);
 
+  backend->priv->last_tile_num = -1;
+  backend->priv->prefetched    = g_hash_table_new_full (g_direct_hash,
+                                                        g_direct_equal,
+                                                        NULL,
+                                                        g_free);
+
   source->command = gimp_tile_backend_plugin_command;
 }
 
+static void
+gimp_tile_backend_plugin_finalize (GObject *object)
+{
+  GimpTileBackendPlugin *backend_plugin = GIMP_TILE_BACKEND_PLUGIN (object);
+
+  g_clear_pointer (&backend_plugin->priv->prefetched, g_hash_table_unref);
+  g_clear_pointer (&backend_plugin->priv->map, gimp_tile_map_unref);
+  g_clear_pointer (&backend_plugin->priv->written, g_free);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static gpointer
 gimp_tile_backend_plugin_command (GeglTileSource  *tile_store,
                                   GeglTileCommand  command,
@@ -147,6 +203,20 @@ gimp_tile_backend_plugin_command (GeglTileSource  *tile_store,
         {
           g_mutex_lock (&backend_plugin_mutex);
 
+          if (x < backend_plugin->priv->ntile_cols &&
+              y < backend_plugin->priv->ntile_rows)
+            {
+              gint tile_num = y * backend_plugin->priv->ntile_cols + x;
+
+              gimp_tile_drop (backend_plugin, tile_num);
+
+              /*  the core doesn't see what we write to the mapped tiles,
+               *  so from now on, this one has to be read back the slow way
+               */
+              if (backend_plugin->priv->written)
+                backend_plugin->priv->written[tile_num] = TRUE;
+            }
+
           gimp_tile_write (backend_plugin, x, y, data);
 
           g_mutex_unlock (&backend_plugin_mutex);
@@ -202,6 +272,12 @@ _gimp_tile_backend_plugin_new (GimpDrawable *drawable,
   return backend;
 }
 
+void
+_gimp_tile_backend_plugin_drop_prefetched (void)
+{
+  g_atomic_int_inc (&backend_plugin_prefetch_serial);
+}
+
 
 /*  private functions  */
 
@@ -220,6 +296,17 @@ gimp_tile_read (GimpTileBackendPlugin *backend_plugin,
   if (! gimp_tile_init (backend_plugin, &gimp_tile, y, x))
     return NULL;
 
+  if (! priv->shadow && ! priv->map_requested)
+    gimp_tile_map_request (backend_plugin);
+
+  if (priv->map && ! priv->written[gimp_tile.tile_num])
+    {
+      tile = gimp_tile_map_read (backend_plugin, gimp_tile.tile_num);
+
+      if (tile)
+        return tile;
+    }
+
   tile_size  = gegl_tile_backend_get_tile_size (backend);
   tile       = gegl_tile_new (tile_size);
   tile_data  = gegl_tile_get_data (tile);
@@ -339,57 +426,137 @@ gimp_tile_get (GimpTileBackendPlugin *backend_plugin,
 {
   GimpTileBackendPluginPrivate *priv    = backend_plugin->priv;
   GimpPlugIn                   *plug_in = gimp_get_plug_in ();
-  GPTileReq                     tile_req;
-  GPTileData                   *tile_data;
+  GPTileListReq                 tile_list_req;
+  GPTileListData               *tile_list_data;
   GimpWireMessage               msg;
+  guint32                       tile_nums[GP_TILE_LIST_MAX_TILES];
+  gint                          n_tiles;
+  gint                          serial;
+  const guchar                 *data;
+  gsize                         length;
+  gint                          i;
 
-  tile_req.drawable_id = priv->drawable_id;
-  tile_req.tile_num    = tile->tile_num;
-  tile_req.shadow      = priv->shadow;
+  serial = g_atomic_int_get (&backend_plugin_prefetch_serial);
 
-  if (! gp_tile_req_write (_gimp_plug_in_get_write_channel (plug_in),
-                           &tile_req, plug_in))
+  if (priv->prefetch_serial != serial)
+    {
+      g_hash_table_remove_all (priv->prefetched);
+
+      priv->prefetch_serial = serial;
+    }
+
+  /*  use the tile if we already fetched it ahead of time  */
+  if (g_hash_table_steal_extended (priv->prefetched,
+                                   GUINT_TO_POINTER (tile->tile_num),
+                                   NULL, (gpointer *) &tile->data))
+    {
+      priv->last_tile_num = tile->tile_num;
+
+      return;
+    }
+
+  tile_nums[0] = tile->tile_num;
+  n_tiles      = 1;
+
+  /*  when the tiles are read in order, read the following ones along
+   *  with this one, it's one round trip instead of many
+   */
+  if (tile->tile_num == priv->last_tile_num + 1)
+    {
+      gint n_tiles_total = priv->ntile_rows * priv->ntile_cols;
+
+      while (n_tiles < GP_TILE_LIST_MAX_TILES &&
+             tile->tile_num + n_tiles < n_tiles_total)
+        {
+          tile_nums[n_tiles] = tile->tile_num + n_tiles;
+          n_tiles++;
+        }
+    }
+
+  priv->last_tile_num = tile->tile_num;
+
+  tile_list_req.drawable_id = priv->drawable_id;
+  tile_list_req.shadow      = priv->shadow;
+  tile_list_req.n_tiles     = n_tiles;
+  tile_list_req.tile_nums   = tile_nums;
+
+  if (! gp_tile_list_req_write (_gimp_plug_in_get_write_channel (plug_in),
+                                &tile_list_req, plug_in))
     gimp_quit ();
 
-  _gimp_plug_in_read_expect_msg (plug_in, &msg, GP_TILE_DATA);
+  _gimp_plug_in_read_expect_msg (plug_in, &msg, GP_TILE_LIST_DATA);
 
-  tile_data = msg.data;
-  if (tile_data->drawable_id != priv->drawable_id ||
-      tile_data->tile_num    != tile->tile_num    ||
-      tile_data->shadow      != priv->shadow      ||
-      tile_data->width       != tile->ewidth      ||
-      tile_data->height      != tile->eheight     ||
-      tile_data->bpp         != priv->bpp)
+  tile_list_data = msg.data;
+
+  /*  the core sends at least the first tile, and maybe some of the others  */
+  if (tile_list_data->drawable_id != priv->drawable_id ||
+      tile_list_data->shadow      != priv->shadow      ||
+      tile_list_data->bpp         != priv->bpp         ||
+      tile_list_data->n_tiles     <  1                 ||
+      tile_list_data->n_tiles     >  (guint) n_tiles)
     {
-#if 0
-      g_printerr ("tile_data: %d %d %d %d %d %d\n"
-                  "tile:      %d %d %d %d %d %d\n",
-                  tile_data->drawable_id,
-                  tile_data->tile_num,
-                  tile_data->shadow,
-                  tile_data->width,
-                  tile_data->height,
-                  tile_data->bpp,
-                  priv->drawable_id,
-                  tile->tile_num,
-                  priv->shadow,
-                  tile->ewidth,
-                  tile->eheight,
-                  priv->bpp);
-#endif
       g_printerr ("received tile info did not match computed tile info");
       gimp_quit ();
     }
 
-  if (tile_data->use_shm)
+  length = 0;
+
+  for (i = 0; i < (gint) tile_list_data->n_tiles; i++)
     {
-      tile->data = g_memdup2 (_gimp_shm_addr (),
-                              tile->ewidth * tile->eheight * priv->bpp);
+      GimpTile list_tile;
+
+      if (tile_list_data->tile_nums[i] != tile_nums[i])
+        {
+          g_printerr ("received tile info did not match computed tile info");
+          gimp_quit ();
+        }
+
+      gimp_tile_init (backend_plugin, &list_tile,
+                      tile_nums[i] / priv->ntile_cols,
+                      tile_nums[i] % priv->ntile_cols);
+
+      length += list_tile.ewidth * list_tile.eheight * priv->bpp;
     }
+
+  if (tile_list_data->length != length)
+    {
+      g_printerr ("received tile info did not match computed tile info");
+      gimp_quit ();
+    }
+
+  if (tile_list_data->use_shm)
+    data = _gimp_shm_addr ();
   else
+    data = tile_list_data->data;
+
+  /*  drop the tiles of the previous batch which were never used, and
+   *  keep the new ones instead
+   */
+  g_hash_table_remove_all (priv->prefetched);
+
+  for (i = 0; i < (gint) tile_list_data->n_tiles; i++)
     {
-      tile->data = tile_data->data;
-      tile_data->data = NULL;
+      GimpTile list_tile;
+      gsize    size;
+
+      gimp_tile_init (backend_plugin, &list_tile,
+                      tile_nums[i] / priv->ntile_cols,
+                      tile_nums[i] % priv->ntile_cols);
+
+      size = list_tile.ewidth * list_tile.eheight * priv->bpp;
+
+      if (i == 0)
+        {
+          tile->data = g_memdup2 (data, size);
+        }
+      else
+        {
+          g_hash_table_insert (priv->prefetched,
+                               GUINT_TO_POINTER (tile_nums[i]),
+                               g_memdup2 (data, size));
+        }
+
+      data += size;
     }
 
   if (! gp_tile_ack_write (_gimp_plug_in_get_write_channel (plug_in),
@@ -399,6 +566,14 @@ gimp_tile_get (GimpTileBackendPlugin *backend_plugin,
   gimp_wire_destroy (&msg);
 }
 
+static void
+gimp_tile_drop (GimpTileBackendPlugin *backend_plugin,
+                gint                   tile_num)
+{
+  g_hash_table_remove (backend_plugin->priv->prefetched,
+                       GUINT_TO_POINTER (tile_num));
+}
+
 static void
 gimp_tile_put (GimpTileBackendPlugin *backend_plugin,
                GimpTile              *tile)
@@ -455,3 +630,163 @@ gimp_tile_put (GimpTileBackendPlugin *backend_plugin,
 
   gimp_wire_destroy (&msg);
 }
+
+/*  asks the core to export the drawable's tiles, the plug-in then uses
+ *  them in place instead of having them copied over the wire
+ */
+static void
+gimp_tile_map_request (GimpTileBackendPlugin *backend_plugin)
+{
+  GimpTileBackendPluginPrivate *priv    = backend_plugin->priv;
+  GeglTileBackend              *backend = GEGL_TILE_BACKEND (backend_plugin);
+  GimpPlugIn                   *plug_in = gimp_get_plug_in ();
+  GPTileMapReq                  tile_map_req;
+  GPTileMapData                *tile_map_data;
+  GimpWireMessage               msg;
+  gint                          n_tiles;
+  gsize                         tile_size;
+  gint                          fd      = -1;
+
+  priv->map_requested = TRUE;
+
+  tile_map_req.drawable_id = priv->drawable_id;
+
+  if (! gp_tile_map_req_write (_gimp_plug_in_get_write_channel (plug_in),
+                               &tile_map_req, plug_in))
+    gimp_quit ();
+
+  _gimp_plug_in_read_expect_msg (plug_in, &msg, GP_TILE_MAP_DATA);
+
+  tile_map_data = msg.data;
+
+  n_tiles   = priv->ntile_rows * priv->ntile_cols;
+  tile_size = gegl_tile_backend_get_tile_size (backend);
+
+#ifndef G_OS_WIN32
+  /*  the core passes the map itself right after the message  */
+  if (tile_map_data->map_id != -1)
+    fd = gimp_wire_read_fd (_gimp_plug_in_get_read_channel (plug_in),
+                            plug_in);
+#endif
+
+  /*  silently use the wire if the core can't export the drawable, or
+   *  if what it exported isn't what we expect
+   */
+  if (tile_map_data->map_id      != -1                      &&
+      tile_map_data->drawable_id == priv->drawable_id       &&
+      tile_map_data->bpp         == (guint) priv->bpp       &&
+      tile_map_data->n_tiles     == (guint) n_tiles         &&
+      tile_map_data->header_size >= sizeof (gint32) + n_tiles &&
+      tile_map_data->size        == (tile_map_data->header_size +
+                                     (guint64) n_tiles * tile_size))
+    {
+      guchar *addr;
+
+      addr = _gimp_shm_map_tiles (tile_map_data->pid,
+                                  tile_map_data->map_id,
+                                  fd,
+                                  tile_map_data->size);
+
+      if (addr)
+        {
+          priv->map = g_slice_new0 (GimpTileMap);
+
+          priv->map->ref_count   = 1;
+          priv->map->addr        = addr;
+          priv->map->size        = tile_map_data->size;
+          priv->map->header_size = tile_map_data->header_size;
+          priv->map->tile_size   = tile_size;
+
+          priv->written = g_new0 (guint8, n_tiles);
+        }
+    }
+
+  /*  the mapping keeps the memory alive  */
+  if (fd != -1)
+    g_close (fd, NULL);
+
+  gimp_wire_destroy (&msg);
+}
+
+static GeglTile *
+gimp_tile_map_read (GimpTileBackendPlugin *backend_plugin,
+                    gint                   tile_num)
+{
+  GimpTileBackendPluginPrivate *priv    = backend_plugin->priv;
+  GimpTileMap                  *map     = priv->map;
+  const volatile guint8        *needs_fill;
+  GeglTile                     *tile;
+  gint                          n_tiles;
+
+  /*  the core clears the flag once the map doesn't mirror the drawable
+   *  anymore
+   */
+  if (! *(volatile gint32 *) map->addr)
+    return NULL;
+
+  needs_fill = map->addr + sizeof (gint32);
+  n_tiles    = priv->ntile_rows * priv->ntile_cols;
+
+  if (needs_fill[tile_num])
+    {
+      GimpPlugIn      *plug_in = gimp_get_plug_in ();
+      GPTileListReq    tile_list_req;
+      GimpWireMessage  msg;
+      guint32          tile_nums[GP_TILE_LIST_MAX_TILES];
+      gint             n_fill = 1;
+
+      tile_nums[0] = tile_num;
+
+      /*  have the following tiles filled in too, they are likely to be
+       *  read next
+       */
+      while (n_fill < GP_TILE_LIST_MAX_TILES &&
+             tile_num + n_fill < n_tiles     &&
+             needs_fill[tile_num + n_fill]   &&
+             ! priv->written[tile_num + n_fill])
+        {
+          tile_nums[n_fill] = tile_num + n_fill;
+          n_fill++;
+        }
+
+      tile_list_req.drawable_id = priv->drawable_id;
+      tile_list_req.shadow      = FALSE;
+      tile_list_req.n_tiles     = n_fill;
+      tile_list_req.tile_nums   = tile_nums;
+
+      if (! gp_tile_map_fill_write (_gimp_plug_in_get_write_channel (plug_in),
+                                    &tile_list_req, plug_in))
+        gimp_quit ();
+
+      _gimp_plug_in_read_expect_msg (plug_in, &msg, GP_TILE_ACK);
+
+      gimp_wire_destroy (&msg);
+
+      if (! *(volatile gint32 *) map->addr)
+        return NULL;
+    }
+
+  tile = gegl_tile_new_bare ();
+
+  g_atomic_int_inc (&map->ref_count);
+
+  gegl_tile_set_data_full (tile,
+                           map->addr + map->header_size +
+                           (gsize) tile_num * map->tile_size,
+                           map->tile_size,
+                           (GDestroyNotify) gimp_tile_map_unref,
+                           map);
+
+  return tile;
+}
+
+static void
+gimp_tile_map_unref (GimpTileMap *map)
+{
+  if (g_atomic_int_dec_and_test (&map->ref_count))
+    {
+      _gimp_shm_unmap_tiles (map->addr, map->size);
+
+      g_slice_free (GimpTileMap, map);
+    }
+}
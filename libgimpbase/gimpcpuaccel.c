@@ -59,6 +59,11 @@ static gboolean  use_cpu_accel = TRUE;
  *
  * Query for CPU acceleration support.
  *
+ * The result can be narrowed down with the GIMP_CPU_ACCEL environment
+ * variable, for testing and benchmarking the different code paths.  It
+ * takes a list of feature names, like "sse2,avx2", or "none"; features
+ * the CPU lacks are never reported.
+ *
  * Returns: #GimpCpuAccelFlags as supported by the CPU.
  *
  * Since: 2.4
@@ -127,13 +132,40 @@ enum
 {
   ARCH_X86_INTEL_FEATURE_PNI      = 1 << 0,
   ARCH_X86_INTEL_FEATURE_SSSE3    = 1 << 9,
+  ARCH_X86_INTEL_FEATURE_FMA      = 1 << 12,
   ARCH_X86_INTEL_FEATURE_SSE4_1   = 1 << 19,
   ARCH_X86_INTEL_FEATURE_SSE4_2   = 1 << 20,
-  ARCH_X86_INTEL_FEATURE_AVX      = 1 << 28
+  ARCH_X86_INTEL_FEATURE_OSXSAVE  = 1 << 27,
+  ARCH_X86_INTEL_FEATURE_AVX      = 1 << 28,
+  ARCH_X86_INTEL_FEATURE_F16C     = 1 << 29
 };
 
+/* cpuid leaf 7, ebx */
+enum
+{
+  ARCH_X86_INTEL_FEATURE_AVX2     = 1 << 5,
+  ARCH_X86_INTEL_FEATURE_AVX512F  = 1 << 16
+};
+
+/* the register state the OS saves on context switches, see XCR0 */
+enum
+{
+  ARCH_X86_XSTATE_SSE             = 1 << 1,
+  ARCH_X86_XSTATE_AVX             = 1 << 2,
+  ARCH_X86_XSTATE_OPMASK          = 1 << 5,
+  ARCH_X86_XSTATE_ZMM_HI256       = 1 << 6,
+  ARCH_X86_XSTATE_HI16_ZMM        = 1 << 7
+};
+
+#define ARCH_X86_XSTATE_AVX_MASK    (ARCH_X86_XSTATE_SSE | \
+                                     ARCH_X86_XSTATE_AVX)
+#define ARCH_X86_XSTATE_AVX512_MASK (ARCH_X86_XSTATE_AVX_MASK  | \
+                                     ARCH_X86_XSTATE_OPMASK    | \
+                                     ARCH_X86_XSTATE_ZMM_HI256 | \
+                                     ARCH_X86_XSTATE_HI16_ZMM)
+
 #if !defined(ARCH_X86_64) && (defined(PIC) || defined(__PIC__))
-#define cpuid(op,eax,ebx,ecx,edx)  \
+#define cpuid_count(op,count,eax,ebx,ecx,edx) \
   __asm__ ("movl %%ebx, %%esi\n\t" \
            "cpuid\n\t"             \
            "xchgl %%ebx,%%esi"     \
@@ -141,17 +173,28 @@ enum
              "=S" (ebx),           \
              "=c" (ecx),           \
              "=d" (edx)            \
-           : "0" (op))
+           : "0" (op),             \
+             "2" (count))
 #else
-#define cpuid(op,eax,ebx,ecx,edx)  \
+#define cpuid_count(op,count,eax,ebx,ecx,edx) \
   __asm__ ("cpuid"                 \
            : "=a" (eax),           \
              "=b" (ebx),           \
              "=c" (ecx),           \
              "=d" (edx)            \
-           : "0" (op))
+           : "0" (op),             \
+             "2" (count))
 #endif
 
+#define cpuid(op,eax,ebx,ecx,edx) cpuid_count (op, 0, eax, ebx, ecx, edx)
+
+/* xgetbv, spelled out for assemblers which don't know it */
+#define xgetbv(index,eax,edx)            \
+  __asm__ (".byte 0x0f, 0x01, 0xd0"      \
+           : "=a" (eax),                 \
+             "=d" (edx)                  \
+           : "c" (index))
+
 
 static X86Vendor
 arch_get_vendor (void)
@@ -238,7 +281,9 @@ arch_accel_intel (void)
 #ifdef USE_MMX
   {
     guint32 eax, ebx, ecx, edx;
+    guint32 max_leaf;
 
+    cpuid (0, max_leaf, ebx, ecx, edx);
     cpuid (1, eax, ebx, ecx, edx);
 
     if ((edx & ARCH_X86_INTEL_FEATURE_MMX) == 0)
@@ -267,6 +312,40 @@ arch_accel_intel (void)
 
     if (ecx & ARCH_X86_INTEL_FEATURE_AVX)
       caps |= GIMP_CPU_ACCEL_X86_AVX;
+
+    /*  FMA, F16C, AVX2 and AVX-512 can only be used if the OS saves
+     *  the wider registers, check XCR0 for that
+     */
+    if ((ecx & ARCH_X86_INTEL_FEATURE_OSXSAVE) &&
+        (ecx & ARCH_X86_INTEL_FEATURE_AVX)     &&
+        max_leaf >= 7)
+      {
+        guint32 xcr0, xcr0_high;
+        guint32 leaf1_ecx = ecx;
+
+        xgetbv (0, xcr0, xcr0_high);
+
+        cpuid_count (7, 0, eax, ebx, ecx, edx);
+
+        if ((xcr0 & ARCH_X86_XSTATE_AVX_MASK) == ARCH_X86_XSTATE_AVX_MASK)
+          {
+            if (leaf1_ecx & ARCH_X86_INTEL_FEATURE_FMA)
+              caps |= GIMP_CPU_ACCEL_X86_FMA;
+
+            if (leaf1_ecx & ARCH_X86_INTEL_FEATURE_F16C)
+              caps |= GIMP_CPU_ACCEL_X86_F16C;
+
+            if (ebx & ARCH_X86_INTEL_FEATURE_AVX2)
+              caps |= GIMP_CPU_ACCEL_X86_AVX2;
+
+            if ((ebx & ARCH_X86_INTEL_FEATURE_AVX512F) &&
+                (xcr0 & ARCH_X86_XSTATE_AVX512_MASK) ==
+                ARCH_X86_XSTATE_AVX512_MASK)
+              {
+                caps |= GIMP_CPU_ACCEL_X86_AVX512F;
+              }
+          }
+      }
 #endif /* USE_SSE */
   }
 #endif /* USE_MMX */
@@ -513,6 +592,58 @@ arch_accel (void)
 #endif /* ARCH_PPC && USE_ALTIVEC */
 
 
+#if defined(ARCH_ARM)
+
+#if defined(ARCH_AARCH64)
+
+#if defined(HAVE_SYS_AUXV_H) && defined(__linux__)
+#include <sys/auxv.h>
+
+#ifndef HWCAP_SVE
+#define HWCAP_SVE (1 << 22)
+#endif
+#endif
+
+#define HAVE_ACCEL 1
+
+static guint32
+arch_accel (void)
+{
+  /*  NEON is mandatory on aarch64  */
+  guint32 caps = GIMP_CPU_ACCEL_ARM_NEON;
+
+#if defined(HAVE_SYS_AUXV_H) && defined(__linux__)
+  if (getauxval (AT_HWCAP) & HWCAP_SVE)
+    caps |= GIMP_CPU_ACCEL_ARM_SVE;
+#endif
+
+  return caps;
+}
+
+#elif defined(HAVE_SYS_AUXV_H) && defined(__linux__)
+
+#include <sys/auxv.h>
+
+#ifndef HWCAP_NEON
+#define HWCAP_NEON (1 << 12)
+#endif
+
+#define HAVE_ACCEL 1
+
+static guint32
+arch_accel (void)
+{
+  if (getauxval (AT_HWCAP) & HWCAP_NEON)
+    return GIMP_CPU_ACCEL_ARM_NEON;
+
+  return 0;
+}
+
+#endif /* HAVE_SYS_AUXV_H && __linux__ */
+
+#endif /* ARCH_ARM */
+
+
 static GimpCpuAccelFlags
 cpu_accel (void)
 {
@@ -524,6 +655,36 @@ cpu_accel (void)
 
   accel = arch_accel ();
 
+  /*  let the environment disable features, to test and benchmark the
+   *  other code paths
+   */
+  if (g_getenv ("GIMP_CPU_ACCEL"))
+    {
+      static const GDebugKey keys[] =
+      {
+        { "mmx",     GIMP_CPU_ACCEL_X86_MMX     },
+        { "3dnow",   GIMP_CPU_ACCEL_X86_3DNOW   },
+        { "mmxext",  GIMP_CPU_ACCEL_X86_MMXEXT  },
+        { "sse",     GIMP_CPU_ACCEL_X86_SSE     },
+        { "sse2",    GIMP_CPU_ACCEL_X86_SSE2    },
+        { "sse3",    GIMP_CPU_ACCEL_X86_SSE3    },
+        { "ssse3",   GIMP_CPU_ACCEL_X86_SSSE3   },
+        { "sse4.1",  GIMP_CPU_ACCEL_X86_SSE4_1  },
+        { "sse4.2",  GIMP_CPU_ACCEL_X86_SSE4_2  },
+        { "avx",     GIMP_CPU_ACCEL_X86_AVX     },
+        { "avx2",    GIMP_CPU_ACCEL_X86_AVX2    },
+        { "avx512f", GIMP_CPU_ACCEL_X86_AVX512F },
+        { "fma",     GIMP_CPU_ACCEL_X86_FMA     },
+        { "f16c",    GIMP_CPU_ACCEL_X86_F16C    },
+        { "altivec", GIMP_CPU_ACCEL_PPC_ALTIVEC },
+        { "neon",    GIMP_CPU_ACCEL_ARM_NEON    },
+        { "sve",     GIMP_CPU_ACCEL_ARM_SVE     }
+      };
+
+      accel &= g_parse_debug_string (g_getenv ("GIMP_CPU_ACCEL"),
+                                     keys, G_N_ELEMENTS (keys));
+    }
+
   return (GimpCpuAccelFlags) accel;
 
 #else /* !HAVE_ACCEL */
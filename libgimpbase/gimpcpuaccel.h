@@ -39,7 +39,13 @@ G_BEGIN_DECLS
  * @GIMP_CPU_ACCEL_X86_SSE4_1:  SSE4_1
  * @GIMP_CPU_ACCEL_X86_SSE4_2:  SSE4_2
  * @GIMP_CPU_ACCEL_X86_AVX:     AVX
+ * @GIMP_CPU_ACCEL_X86_AVX2:    AVX2 (Since: 3.2)
+ * @GIMP_CPU_ACCEL_X86_AVX512F: AVX-512 Foundation (Since: 3.2)
+ * @GIMP_CPU_ACCEL_X86_FMA:     FMA3 (Since: 3.2)
+ * @GIMP_CPU_ACCEL_X86_F16C:    F16C (Since: 3.2)
  * @GIMP_CPU_ACCEL_PPC_ALTIVEC: Altivec
+ * @GIMP_CPU_ACCEL_ARM_NEON:    NEON (Since: 3.2)
+ * @GIMP_CPU_ACCEL_ARM_SVE:     SVE (Since: 3.2)
  *
  * Types of detectable CPU accelerations
  **/
@@ -58,9 +64,17 @@ typedef enum
   GIMP_CPU_ACCEL_X86_SSE4_1  = 0x00800000,
   GIMP_CPU_ACCEL_X86_SSE4_2  = 0x00400000,
   GIMP_CPU_ACCEL_X86_AVX     = 0x00200000,
+  GIMP_CPU_ACCEL_X86_AVX2    = 0x00100000,
+  GIMP_CPU_ACCEL_X86_AVX512F = 0x00080000,
+  GIMP_CPU_ACCEL_X86_FMA     = 0x00020000,
+  GIMP_CPU_ACCEL_X86_F16C    = 0x00010000,
 
   /* powerpc accelerations */
-  GIMP_CPU_ACCEL_PPC_ALTIVEC = 0x04000000
+  GIMP_CPU_ACCEL_PPC_ALTIVEC = 0x04000000,
+
+  /* arm accelerations */
+  GIMP_CPU_ACCEL_ARM_NEON    = 0x00040000,
+  GIMP_CPU_ACCEL_ARM_SVE     = 0x00008000
 } GimpCpuAccelFlags;
 
 
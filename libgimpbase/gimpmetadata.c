@@ -74,6 +74,9 @@ static void     gimp_metadata_add_namespace   (GHashTable      *namespaces,
 static void gimp_metadata_add_xmp_namespaces  (GHashTable      *namespaces,
                                                GString         *xml,
                                                const gchar     *tag);
+static GimpMetadata * gimp_metadata_new_from_xmp_packet
+                                              (const gchar     *packet,
+                                               gsize            packet_length);
 
 
 static const gchar *tiff_tags[] =
@@ -580,6 +583,18 @@ typedef struct
   GimpMetadata *metadata;
 } GimpMetadataParseData;
 
+/*  the metadata is only created once the first tag or packet is seen,
+ *  so that a leading XMP packet can become its base
+ */
+static GimpMetadata *
+gimp_metadata_parse_data_get_metadata (GimpMetadataParseData *parse_data)
+{
+  if (! parse_data->metadata)
+    parse_data->metadata = gimp_metadata_new ();
+
+  return parse_data->metadata;
+}
+
 static const gchar*
 gimp_metadata_attribute_name_to_value (const gchar **attribute_names,
                                        const gchar **attribute_values,
@@ -706,10 +721,12 @@ gimp_metadata_deserialize_text (GMarkupParseContext  *context,
 
       if (value)
         {
-          GExiv2Metadata  *g2_metadata = GEXIV2_METADATA (parse_data->metadata);
+          GExiv2Metadata  *g2_metadata;
           GError          *error       = NULL;
           gchar          **values;
 
+          g2_metadata = GEXIV2_METADATA (gimp_metadata_parse_data_get_metadata (parse_data));
+
           values = gexiv2_metadata_try_get_tag_multiple (g2_metadata,
                                                          parse_data->name,
                                                          &error);
@@ -774,6 +791,27 @@ gimp_metadata_deserialize_text (GMarkupParseContext  *context,
           g_free (value);
         }
     }
+  else if (! g_strcmp0 (current_element, "xmp-packet"))
+    {
+      GError *error = NULL;
+
+      /*  parsing the whole packet at once is a lot faster than setting
+       *  its tags one by one, but only possible before any other tag
+       */
+      if (! parse_data->metadata)
+        {
+          parse_data->metadata = gimp_metadata_new_from_xmp_packet (text,
+                                                                    text_len);
+        }
+      else if (! gimp_metadata_set_from_xmp (parse_data->metadata,
+                                             (const guchar *) text, text_len,
+                                             &error))
+        {
+          g_warning ("%s: failed to set XMP packet: %s\n",
+                     G_STRFUNC, error->message);
+          g_clear_error (&error);
+        }
+    }
   else if (! g_strcmp0 (current_element, "namespace"))
     {
       GError *error = NULL;
@@ -819,9 +857,7 @@ gimp_metadata_deserialize (const gchar *metadata_xml)
 
   g_return_val_if_fail (metadata_xml != NULL, NULL);
 
-  metadata = gimp_metadata_new ();
-
-  parse_data.metadata = metadata;
+  parse_data.metadata = NULL;
   parse_data.excessive_message_shown = FALSE;
 
   markup_parser.start_element = gimp_metadata_deserialize_start_element;
@@ -838,6 +874,8 @@ gimp_metadata_deserialize (const gchar *metadata_xml)
 
   g_markup_parse_context_unref (context);
 
+  metadata = gimp_metadata_parse_data_get_metadata (&parse_data);
+
   return metadata;
 }
 
@@ -1022,9 +1060,10 @@ gchar *
 gimp_metadata_serialize (GimpMetadata *metadata)
 {
   GString  *string;
-  gchar   **exif_data = NULL;
-  gchar   **iptc_data = NULL;
-  gchar   **xmp_data  = NULL;
+  gchar   **exif_data  = NULL;
+  gchar   **iptc_data  = NULL;
+  gchar   **xmp_data   = NULL;
+  gchar    *xmp_packet = NULL;
   gchar    *value;
   gchar    *escaped;
   GError   *error     = NULL;
@@ -1038,6 +1077,53 @@ gimp_metadata_serialize (GimpMetadata *metadata)
   g_string_append (string, "<?xml version='1.0' encoding='UTF-8'?>\n");
   g_string_append (string, "<metadata>\n");
 
+  /* XMP goes first, as a single packet, so that deserializing can
+   * parse it in one go, see gimp_metadata_deserialize_text().  Huge
+   * packets, like Lightroom's edit history, are way too slow to set
+   * tag by tag.
+   */
+  if (gexiv2_metadata_has_xmp (GEXIV2_METADATA (metadata)))
+    {
+      gchar **values;
+
+      values = gexiv2_metadata_try_get_tag_multiple (GEXIV2_METADATA (metadata),
+                                                     "Xmp.photoshop.DocumentAncestors",
+                                                     NULL);
+
+      /*  let the tag by tag code below trim those, see issue #7464  */
+      if (! values || g_strv_length (values) <= 1000)
+        {
+          xmp_packet =
+            gexiv2_metadata_try_generate_xmp_packet (GEXIV2_METADATA (metadata),
+                                                     GEXIV2_USE_COMPACT_FORMAT,
+                                                     0, &error);
+
+          if (error)
+            {
+              g_printerr ("%s: failed to generate XMP packet: %s\n",
+                          G_STRFUNC, error->message);
+              g_clear_error (&error);
+            }
+        }
+
+      g_strfreev (values);
+    }
+
+  if (xmp_packet)
+    {
+      escaped = g_markup_escape_text (xmp_packet, -1);
+
+      g_string_append_printf (string, "  <xmp-packet>%s</xmp-packet>\n",
+                              escaped);
+
+      g_free (escaped);
+      g_free (xmp_packet);
+    }
+  else
+    {
+      xmp_data = gexiv2_metadata_get_xmp_tags (GEXIV2_METADATA (metadata));
+    }
+
   exif_data = gexiv2_metadata_get_exif_tags (GEXIV2_METADATA (metadata));
 
   if (exif_data)
@@ -1064,8 +1150,6 @@ gimp_metadata_serialize (GimpMetadata *metadata)
       g_strfreev (exif_data);
     }
 
-  xmp_data = gexiv2_metadata_get_xmp_tags (GEXIV2_METADATA (metadata));
-
   if (xmp_data)
     {
       GHashTable *namespaces = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
@@ -2144,3 +2228,102 @@ gimp_metadata_add (GimpMetadata *src,
         }
     }
 }
+
+static guint32
+gimp_metadata_png_crc (const guint8 *data,
+                       gsize         length,
+                       guint32       crc)
+{
+  gsize i;
+  gint  k;
+
+  for (i = 0; i < length; i++)
+    {
+      crc ^= data[i];
+
+      for (k = 0; k < 8; k++)
+        crc = (crc >> 1) ^ (0xedb88320u & (0 - (crc & 1)));
+    }
+
+  return crc;
+}
+
+static void
+gimp_metadata_png_append_chunk (GByteArray   *png,
+                                const gchar  *type,
+                                const guint8 *data,
+                                gsize         length)
+{
+  guint32 value;
+  guint32 crc;
+
+  value = GUINT32_TO_BE (length);
+  g_byte_array_append (png, (const guint8 *) &value, 4);
+
+  g_byte_array_append (png, (const guint8 *) type, 4);
+  g_byte_array_append (png, data, length);
+
+  crc = gimp_metadata_png_crc ((const guint8 *) type, 4, 0xffffffff);
+  crc = gimp_metadata_png_crc (data, length, crc) ^ 0xffffffff;
+
+  value = GUINT32_TO_BE (crc);
+  g_byte_array_append (png, (const guint8 *) &value, 4);
+}
+
+/*  Creates metadata from an XMP packet, parsed by exiv2 in one go.  The
+ *  packet is wrapped into the iTXt chunk of a 1x1 PNG, which, unlike
+ *  the JPEG used by gimp_metadata_new(), has no size limit for XMP, and
+ *  supports Exif and IPTC as well.
+ */
+static GimpMetadata *
+gimp_metadata_new_from_xmp_packet (const gchar *packet,
+                                   gsize        packet_length)
+{
+  static const guint8  png_signature[] = { 0x89, 'P', 'N', 'G',
+                                           '\r', '\n', 0x1a, '\n' };
+  static const guint8  ihdr[]          = { 0, 0, 0, 1,   /* width        */
+                                           0, 0, 0, 1,   /* height       */
+                                           8, 0,         /* 8-bit gray   */
+                                           0, 0, 0 };
+  /*  a stored deflate block holding the single, unfiltered scanline  */
+  static const guint8  idat[]          = { 0x78, 0x01, 0x01, 0x02, 0x00,
+                                           0xfd, 0xff, 0x00, 0x00,
+                                           0x00, 0x02, 0x00, 0x01 };
+  /*  keyword, no compression, empty language and translated keyword,
+   *  the last terminator being the one of the string literal
+   */
+  static const gchar   itxt_header[]   = "XML:com.adobe.xmp\0\0\0\0";
+  GimpMetadata        *metadata;
+  GByteArray          *png;
+  GByteArray          *itxt;
+
+  if (! gexiv2_initialize ())
+    return NULL;
+
+  itxt = g_byte_array_sized_new (sizeof (itxt_header) + packet_length);
+  g_byte_array_append (itxt, (const guint8 *) itxt_header,
+                       sizeof (itxt_header));
+  g_byte_array_append (itxt, (const guint8 *) packet, packet_length);
+
+  png = g_byte_array_sized_new (itxt->len + 128);
+  g_byte_array_append (png, png_signature, sizeof (png_signature));
+  gimp_metadata_png_append_chunk (png, "IHDR", ihdr, sizeof (ihdr));
+  gimp_metadata_png_append_chunk (png, "iTXt", itxt->data, itxt->len);
+  gimp_metadata_png_append_chunk (png, "IDAT", idat, sizeof (idat));
+  gimp_metadata_png_append_chunk (png, "IEND", NULL, 0);
+
+  g_byte_array_unref (itxt);
+
+  metadata = g_object_new (GIMP_TYPE_METADATA, NULL);
+
+  if (! gexiv2_metadata_open_buf (GEXIV2_METADATA (metadata),
+                                  png->data, png->len, NULL) ||
+      ! gexiv2_metadata_has_xmp (GEXIV2_METADATA (metadata)))
+    {
+      g_clear_object (&metadata);
+    }
+
+  g_byte_array_unref (png);
+
+  return metadata;
+}
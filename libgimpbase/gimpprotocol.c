@@ -137,6 +137,14 @@ static void _gp_params_write             (GIOChannel       *channel,
                                           gpointer          user_data);
 static void _gp_params_destroy           (GPParam          *params,
                                           gint              n_params);
+static void _gp_params_read_internal     (GIOChannel       *channel,
+                                          GPParam         **params,
+                                          guint            *n_params,
+                                          gpointer          user_data);
+static void _gp_params_write_internal    (GIOChannel       *channel,
+                                          GPParam          *params,
+                                          gint              n_params,
+                                          gpointer          user_data);
 
 
 static void _gp_has_init_read            (GIOChannel       *channel,
@@ -147,6 +155,78 @@ static void _gp_has_init_write           (GIOChannel       *channel,
                                           gpointer          user_data);
 static void _gp_has_init_destroy         (GimpWireMessage  *msg);
 
+static void _gp_tile_list_req_read       (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_tile_list_req_write      (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_tile_list_req_destroy    (GimpWireMessage  *msg);
+
+static void _gp_tile_list_data_read      (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_tile_list_data_write     (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_tile_list_data_destroy   (GimpWireMessage  *msg);
+
+static void _gp_tile_map_req_read        (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_tile_map_req_write       (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_tile_map_req_destroy     (GimpWireMessage  *msg);
+
+static void _gp_tile_map_data_read       (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_tile_map_data_write      (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_tile_map_data_destroy    (GimpWireMessage  *msg);
+
+static void _gp_proc_run_list_read       (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_proc_run_list_write      (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_proc_run_list_destroy    (GimpWireMessage  *msg);
+
+static void _gp_proc_return_list_read    (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_proc_return_list_write   (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_proc_return_list_destroy (GimpWireMessage  *msg);
+
+static void _gp_proc_run_async_read      (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_proc_run_async_write     (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_proc_run_async_destroy   (GimpWireMessage  *msg);
+
+static void _gp_proc_async_poll_read     (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_proc_async_poll_write    (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_proc_async_poll_destroy  (GimpWireMessage  *msg);
+
+static void _gp_proc_async_return_read   (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_proc_async_return_write  (GIOChannel       *channel,
+                                          GimpWireMessage  *msg,
+                                          gpointer          user_data);
+static void _gp_proc_async_return_destroy (GimpWireMessage *msg);
+
 
 
 void
@@ -204,6 +284,50 @@ gp_init (void)
                       _gp_has_init_read,
                       _gp_has_init_write,
                       _gp_has_init_destroy);
+  gimp_wire_register (GP_TILE_LIST_REQ,
+                      _gp_tile_list_req_read,
+                      _gp_tile_list_req_write,
+                      _gp_tile_list_req_destroy);
+  gimp_wire_register (GP_TILE_LIST_DATA,
+                      _gp_tile_list_data_read,
+                      _gp_tile_list_data_write,
+                      _gp_tile_list_data_destroy);
+  gimp_wire_register (GP_TILE_MAP_REQ,
+                      _gp_tile_map_req_read,
+                      _gp_tile_map_req_write,
+                      _gp_tile_map_req_destroy);
+  gimp_wire_register (GP_TILE_MAP_DATA,
+                      _gp_tile_map_data_read,
+                      _gp_tile_map_data_write,
+                      _gp_tile_map_data_destroy);
+  gimp_wire_register (GP_TILE_MAP_FILL,
+                      _gp_tile_list_req_read,
+                      _gp_tile_list_req_write,
+                      _gp_tile_list_req_destroy);
+  gimp_wire_register (GP_KEEP_ALIVE,
+                      _gp_has_init_read,
+                      _gp_has_init_write,
+                      _gp_has_init_destroy);
+  gimp_wire_register (GP_PROC_RUN_LIST,
+                      _gp_proc_run_list_read,
+                      _gp_proc_run_list_write,
+                      _gp_proc_run_list_destroy);
+  gimp_wire_register (GP_PROC_RETURN_LIST,
+                      _gp_proc_return_list_read,
+                      _gp_proc_return_list_write,
+                      _gp_proc_return_list_destroy);
+  gimp_wire_register (GP_PROC_RUN_ASYNC,
+                      _gp_proc_run_async_read,
+                      _gp_proc_run_async_write,
+                      _gp_proc_run_async_destroy);
+  gimp_wire_register (GP_PROC_ASYNC_POLL,
+                      _gp_proc_async_poll_read,
+                      _gp_proc_async_poll_write,
+                      _gp_proc_async_poll_destroy);
+  gimp_wire_register (GP_PROC_ASYNC_RETURN,
+                      _gp_proc_async_return_read,
+                      _gp_proc_async_return_write,
+                      _gp_proc_async_return_destroy);
 }
 
 /* public writing API */
@@ -451,6 +575,214 @@ gp_has_init_write (GIOChannel *channel,
   return TRUE;
 }
 
+gboolean
+gp_tile_list_req_write (GIOChannel    *channel,
+                        GPTileListReq *tile_list_req,
+                        gpointer       user_data)
+{
+  GimpWireMessage msg;
+
+  msg.type = GP_TILE_LIST_REQ;
+  msg.data = tile_list_req;
+
+  if (! gimp_wire_write_msg (channel, &msg, user_data))
+    return FALSE;
+
+  if (! gimp_wire_flush (channel, user_data))
+    return FALSE;
+
+  return TRUE;
+}
+
+gboolean
+gp_tile_list_data_write (GIOChannel     *channel,
+                         GPTileListData *tile_list_data,
+                         gpointer        user_data)
+{
+  GimpWireMessage msg;
+
+  msg.type = GP_TILE_LIST_DATA;
+  msg.data = tile_list_data;
+
+  if (! gimp_wire_write_msg (channel, &msg, user_data))
+    return FALSE;
+
+  if (! gimp_wire_flush (channel, user_data))
+    return FALSE;
+
+  return TRUE;
+}
+
+gboolean
+gp_tile_map_req_write (GIOChannel   *channel,
+                       GPTileMapReq *tile_map_req,
+                       gpointer      user_data)
+{
+  GimpWireMessage msg;
+
+  msg.type = GP_TILE_MAP_REQ;
+  msg.data = tile_map_req;
+
+  if (! gimp_wire_write_msg (channel, &msg, user_data))
+    return FALSE;
+
+  if (! gimp_wire_flush (channel, user_data))
+    return FALSE;
+
+  return TRUE;
+}
+
+gboolean
+gp_tile_map_data_write (GIOChannel    *channel,
+                        GPTileMapData *tile_map_data,
+                        gpointer       user_data)
+{
+  GimpWireMessage msg;
+
+  msg.type = GP_TILE_MAP_DATA;
+  msg.data = tile_map_data;
+
+  if (! gimp_wire_write_msg (channel, &msg, user_data))
+    return FALSE;
+
+  if (! gimp_wire_flush (channel, user_data))
+    return FALSE;
+
+  return TRUE;
+}
+
+gboolean
+gp_tile_map_fill_write (GIOChannel    *channel,
+                        GPTileListReq *tile_list_req,
+                        gpointer       user_data)
+{
+  GimpWireMessage msg;
+
+  msg.type = GP_TILE_MAP_FILL;
+  msg.data = tile_list_req;
+
+  if (! gimp_wire_write_msg (channel, &msg, user_data))
+    return FALSE;
+
+  if (! gimp_wire_flush (channel, user_data))
+    return FALSE;
+
+  return TRUE;
+}
+
+gboolean
+gp_keep_alive_write (GIOChannel *channel,
+                     gpointer    user_data)
+{
+  GimpWireMessage msg;
+
+  msg.type = GP_KEEP_ALIVE;
+  msg.data = NULL;
+
+  if (! gimp_wire_write_msg (channel, &msg, user_data))
+    return FALSE;
+
+  if (! gimp_wire_flush (channel, user_data))
+    return FALSE;
+
+  return TRUE;
+}
+
+gboolean
+gp_proc_run_list_write (GIOChannel    *channel,
+                        GPProcRunList *proc_run_list,
+                        gpointer       user_data)
+{
+  GimpWireMessage msg;
+
+  msg.type = GP_PROC_RUN_LIST;
+  msg.data = proc_run_list;
+
+  if (! gimp_wire_write_msg (channel, &msg, user_data))
+    return FALSE;
+
+  if (! gimp_wire_flush (channel, user_data))
+    return FALSE;
+
+  return TRUE;
+}
+
+gboolean
+gp_proc_return_list_write (GIOChannel       *channel,
+                           GPProcReturnList *proc_return_list,
+                           gpointer          user_data)
+{
+  GimpWireMessage msg;
+
+  msg.type = GP_PROC_RETURN_LIST;
+  msg.data = proc_return_list;
+
+  if (! gimp_wire_write_msg (channel, &msg, user_data))
+    return FALSE;
+
+  if (! gimp_wire_flush (channel, user_data))
+    return FALSE;
+
+  return TRUE;
+}
+
+gboolean
+gp_proc_run_async_write (GIOChannel     *channel,
+                         GPProcRunAsync *proc_run_async,
+                         gpointer        user_data)
+{
+  GimpWireMessage msg;
+
+  msg.type = GP_PROC_RUN_ASYNC;
+  msg.data = proc_run_async;
+
+  if (! gimp_wire_write_msg (channel, &msg, user_data))
+    return FALSE;
+
+  if (! gimp_wire_flush (channel, user_data))
+    return FALSE;
+
+  return TRUE;
+}
+
+gboolean
+gp_proc_async_poll_write (GIOChannel      *channel,
+                          GPProcAsyncPoll *proc_async_poll,
+                          gpointer         user_data)
+{
+  GimpWireMessage msg;
+
+  msg.type = GP_PROC_ASYNC_POLL;
+  msg.data = proc_async_poll;
+
+  if (! gimp_wire_write_msg (channel, &msg, user_data))
+    return FALSE;
+
+  if (! gimp_wire_flush (channel, user_data))
+    return FALSE;
+
+  return TRUE;
+}
+
+gboolean
+gp_proc_async_return_write (GIOChannel        *channel,
+                            GPProcAsyncReturn *proc_async_return,
+                            gpointer           user_data)
+{
+  GimpWireMessage msg;
+
+  msg.type = GP_PROC_ASYNC_RETURN;
+  msg.data = proc_async_return;
+
+  if (! gimp_wire_write_msg (channel, &msg, user_data))
+    return FALSE;
+
+  if (! gimp_wire_flush (channel, user_data))
+    return FALSE;
+
+  return TRUE;
+}
+
 /*  quit  */
 
 static void
@@ -1816,11 +2148,50 @@ _gp_extension_ack_destroy (GimpWireMessage *msg)
 
 /*  params  */
 
+/*  the parameters are sent as a single block, which is read at once,
+ *  instead of field by field
+ */
 static void
 _gp_params_read (GIOChannel  *channel,
                  GPParam    **params,
                  guint       *n_params,
                  gpointer     user_data)
+{
+  *params   = NULL;
+  *n_params = 0;
+
+  if (! _gimp_wire_begin_read_block (channel, user_data))
+    return;
+
+  _gp_params_read_internal (channel, params, n_params, user_data);
+
+  if (! _gimp_wire_end_read_block ())
+    {
+      _gp_params_destroy (*params, *n_params);
+
+      *params   = NULL;
+      *n_params = 0;
+    }
+}
+
+static void
+_gp_params_write (GIOChannel *channel,
+                  GPParam    *params,
+                  gint        n_params,
+                  gpointer    user_data)
+{
+  _gimp_wire_begin_write_block ();
+
+  _gp_params_write_internal (channel, params, n_params, user_data);
+
+  _gimp_wire_end_write_block (channel, user_data);
+}
+
+static void
+_gp_params_read_internal (GIOChannel  *channel,
+                          GPParam    **params,
+                          guint       *n_params,
+                          gpointer     user_data)
 {
   guint i;
 
@@ -2051,8 +2422,8 @@ _gp_params_read (GIOChannel  *channel,
                                        user_data))
             goto cleanup;
 
-          (*params)[i].data.d_array.data = g_new0 (guint8,
-                                                   (*params)[i].data.d_array.size);
+          (*params)[i].data.d_array.data = g_new (guint8,
+                                                  (*params)[i].data.d_array.size);
 
           if (! _gimp_wire_read_int8 (channel,
                                       (*params)[i].data.d_array.data,
@@ -2073,7 +2444,7 @@ _gp_params_read (GIOChannel  *channel,
             if (! _gimp_wire_read_int32 (channel, &data_len, 1, user_data))
               goto cleanup;
 
-            data = g_new0 (guint8, data_len);
+            data = g_new (guint8, data_len);
 
             if (! _gimp_wire_read_int8 (channel, data, data_len, user_data))
               {
@@ -2183,10 +2554,10 @@ _gp_params_read (GIOChannel  *channel,
             guint n_values = 0;
 
             (*params)[i].data.d_value_array.values = NULL;
-            _gp_params_read (channel,
-                             &(*params)[i].data.d_value_array.values,
-                             &n_values,
-                             user_data);
+            _gp_params_read_internal (channel,
+                                      &(*params)[i].data.d_value_array.values,
+                                      &n_values,
+                                      user_data);
             (*params)[i].data.d_value_array.n_values = (guint32) n_values;
             break;
           }
@@ -2202,10 +2573,10 @@ _gp_params_read (GIOChannel  *channel,
 }
 
 static void
-_gp_params_write (GIOChannel *channel,
-                  GPParam    *params,
-                  gint        n_params,
-                  gpointer    user_data)
+_gp_params_write_internal (GIOChannel *channel,
+                           GPParam    *params,
+                           gint        n_params,
+                           gpointer    user_data)
 {
   gint i;
 
@@ -2415,10 +2786,10 @@ _gp_params_write (GIOChannel *channel,
           break;
 
         case GP_PARAM_TYPE_VALUE_ARRAY:
-          _gp_params_write (channel,
-                            params[i].data.d_value_array.values,
-                            params[i].data.d_value_array.n_values,
-                            user_data);
+          _gp_params_write_internal (channel,
+                                     params[i].data.d_value_array.values,
+                                     params[i].data.d_value_array.n_values,
+                                     user_data);
           break;
 
         }
@@ -2525,3 +2896,707 @@ static void
 _gp_has_init_destroy (GimpWireMessage *msg)
 {
 }
+
+/*  tile_list_req  */
+
+static void
+_gp_tile_list_req_read (GIOChannel      *channel,
+                        GimpWireMessage *msg,
+                        gpointer         user_data)
+{
+  GPTileListReq *tile_list_req = g_slice_new0 (GPTileListReq);
+
+  if (! _gimp_wire_read_int32 (channel,
+                               (guint32 *) &tile_list_req->drawable_id, 1,
+                               user_data))
+    goto cleanup;
+  if (! _gimp_wire_read_int32 (channel,
+                               &tile_list_req->shadow, 1, user_data))
+    goto cleanup;
+  if (! _gimp_wire_read_int32 (channel,
+                               &tile_list_req->n_tiles, 1, user_data))
+    goto cleanup;
+
+  if (tile_list_req->n_tiles < 1 ||
+      tile_list_req->n_tiles > GP_TILE_LIST_MAX_TILES)
+    goto cleanup;
+
+  tile_list_req->tile_nums = g_new (guint32, tile_list_req->n_tiles);
+
+  if (! _gimp_wire_read_int32 (channel,
+                               tile_list_req->tile_nums,
+                               tile_list_req->n_tiles, user_data))
+    goto cleanup;
+
+  msg->data = tile_list_req;
+  return;
+
+ cleanup:
+  g_free (tile_list_req->tile_nums);
+  g_slice_free (GPTileListReq, tile_list_req);
+  msg->data = NULL;
+}
+
+static void
+_gp_tile_list_req_write (GIOChannel      *channel,
+                         GimpWireMessage *msg,
+                         gpointer         user_data)
+{
+  GPTileListReq *tile_list_req = msg->data;
+
+  if (! _gimp_wire_write_int32 (channel,
+                                (const guint32 *) &tile_list_req->drawable_id, 1,
+                                user_data))
+    return;
+  if (! _gimp_wire_write_int32 (channel,
+                                &tile_list_req->shadow, 1, user_data))
+    return;
+  if (! _gimp_wire_write_int32 (channel,
+                                &tile_list_req->n_tiles, 1, user_data))
+    return;
+  if (! _gimp_wire_write_int32 (channel,
+                                tile_list_req->tile_nums,
+                                tile_list_req->n_tiles, user_data))
+    return;
+}
+
+static void
+_gp_tile_list_req_destroy (GimpWireMessage *msg)
+{
+  GPTileListReq *tile_list_req = msg->data;
+
+  if (tile_list_req)
+    {
+      g_free (tile_list_req->tile_nums);
+      g_slice_free (GPTileListReq, tile_list_req);
+    }
+}
+
+/*  tile_list_data  */
+
+static void
+_gp_tile_list_data_read (GIOChannel      *channel,
+                         GimpWireMessage *msg,
+                         gpointer         user_data)
+{
+  GPTileListData *tile_list_data = g_slice_new0 (GPTileListData);
+
+  if (! _gimp_wire_read_int32 (channel,
+                               (guint32 *) &tile_list_data->drawable_id, 1,
+                               user_data))
+    goto cleanup;
+  if (! _gimp_wire_read_int32 (channel,
+                               &tile_list_data->shadow, 1, user_data))
+    goto cleanup;
+  if (! _gimp_wire_read_int32 (channel,
+                               &tile_list_data->bpp, 1, user_data))
+    goto cleanup;
+  if (! _gimp_wire_read_int32 (channel,
+                               &tile_list_data->n_tiles, 1, user_data))
+    goto cleanup;
+
+  if (tile_list_data->n_tiles < 1 ||
+      tile_list_data->n_tiles > GP_TILE_LIST_MAX_TILES)
+    goto cleanup;
+
+  tile_list_data->tile_nums = g_new (guint32, tile_list_data->n_tiles);
+
+  if (! _gimp_wire_read_int32 (channel,
+                               tile_list_data->tile_nums,
+                               tile_list_data->n_tiles, user_data))
+    goto cleanup;
+  if (! _gimp_wire_read_int32 (channel,
+                               &tile_list_data->use_shm, 1, user_data))
+    goto cleanup;
+  if (! _gimp_wire_read_int32 (channel,
+                               &tile_list_data->length, 1, user_data))
+    goto cleanup;
+
+  if (! tile_list_data->use_shm)
+    {
+      tile_list_data->data = g_new (guchar, tile_list_data->length);
+
+      if (! _gimp_wire_read_int8 (channel,
+                                  (guint8 *) tile_list_data->data,
+                                  tile_list_data->length,
+                                  user_data))
+        goto cleanup;
+    }
+
+  msg->data = tile_list_data;
+  return;
+
+ cleanup:
+  g_free (tile_list_data->tile_nums);
+  g_free (tile_list_data->data);
+  g_slice_free (GPTileListData, tile_list_data);
+  msg->data = NULL;
+}
+
+static void
+_gp_tile_list_data_write (GIOChannel      *channel,
+                          GimpWireMessage *msg,
+                          gpointer         user_data)
+{
+  GPTileListData *tile_list_data = msg->data;
+
+  if (! _gimp_wire_write_int32 (channel,
+                                (const guint32 *) &tile_list_data->drawable_id, 1,
+                                user_data))
+    return;
+  if (! _gimp_wire_write_int32 (channel,
+                                &tile_list_data->shadow, 1, user_data))
+    return;
+  if (! _gimp_wire_write_int32 (channel,
+                                &tile_list_data->bpp, 1, user_data))
+    return;
+  if (! _gimp_wire_write_int32 (channel,
+                                &tile_list_data->n_tiles, 1, user_data))
+    return;
+  if (! _gimp_wire_write_int32 (channel,
+                                tile_list_data->tile_nums,
+                                tile_list_data->n_tiles, user_data))
+    return;
+  if (! _gimp_wire_write_int32 (channel,
+                                &tile_list_data->use_shm, 1, user_data))
+    return;
+  if (! _gimp_wire_write_int32 (channel,
+                                &tile_list_data->length, 1, user_data))
+    return;
+
+  if (! tile_list_data->use_shm)
+    {
+      if (! _gimp_wire_write_int8 (channel,
+                                   (const guint8 *) tile_list_data->data,
+                                   tile_list_data->length,
+                                   user_data))
+        return;
+    }
+}
+
+static void
+_gp_tile_list_data_destroy (GimpWireMessage *msg)
+{
+  GPTileListData *tile_list_data = msg->data;
+
+  if (tile_list_data)
+    {
+      g_free (tile_list_data->tile_nums);
+      g_free (tile_list_data->data);
+      g_slice_free (GPTileListData, tile_list_data);
+    }
+}
+
+/*  tile_map_req  */
+
+static void
+_gp_tile_map_req_read (GIOChannel      *channel,
+                       GimpWireMessage *msg,
+                       gpointer         user_data)
+{
+  GPTileMapReq *tile_map_req = g_slice_new0 (GPTileMapReq);
+
+  if (! _gimp_wire_read_int32 (channel,
+                               (guint32 *) &tile_map_req->drawable_id, 1,
+                               user_data))
+    goto cleanup;
+
+  msg->data = tile_map_req;
+  return;
+
+ cleanup:
+  g_slice_free (GPTileMapReq, tile_map_req);
+  msg->data = NULL;
+}
+
+static void
+_gp_tile_map_req_write (GIOChannel      *channel,
+                        GimpWireMessage *msg,
+                        gpointer         user_data)
+{
+  GPTileMapReq *tile_map_req = msg->data;
+
+  if (! _gimp_wire_write_int32 (channel,
+                                (const guint32 *) &tile_map_req->drawable_id, 1,
+                                user_data))
+    return;
+}
+
+static void
+_gp_tile_map_req_destroy (GimpWireMessage *msg)
+{
+  GPTileMapReq *tile_map_req = msg->data;
+
+  if (tile_map_req)
+    g_slice_free (GPTileMapReq, tile_map_req);
+}
+
+/*  tile_map_data  */
+
+static void
+_gp_tile_map_data_read (GIOChannel      *channel,
+                        GimpWireMessage *msg,
+                        gpointer         user_data)
+{
+  GPTileMapData *tile_map_data = g_slice_new0 (GPTileMapData);
+
+  if (! _gimp_wire_read_int32 (channel,
+                               (guint32 *) &tile_map_data->drawable_id, 1,
+                               user_data))
+    goto cleanup;
+  if (! _gimp_wire_read_int32 (channel,
+                               (guint32 *) &tile_map_data->pid, 1,
+                               user_data))
+    goto cleanup;
+  if (! _gimp_wire_read_int32 (channel,
+                               (guint32 *) &tile_map_data->map_id, 1,
+                               user_data))
+    goto cleanup;
+  if (! _gimp_wire_read_int32 (channel,
+                               &tile_map_data->bpp, 1, user_data))
+    goto cleanup;
+  if (! _gimp_wire_read_int32 (channel,
+                               &tile_map_data->n_tiles, 1, user_data))
+    goto cleanup;
+  if (! _gimp_wire_read_int64 (channel,
+                               &tile_map_data->header_size, 1, user_data))
+    goto cleanup;
+  if (! _gimp_wire_read_int64 (channel,
+                               &tile_map_data->size, 1, user_data))
+    goto cleanup;
+
+  msg->data = tile_map_data;
+  return;
+
+ cleanup:
+  g_slice_free (GPTileMapData, tile_map_data);
+  msg->data = NULL;
+}
+
+static void
+_gp_tile_map_data_write (GIOChannel      *channel,
+                         GimpWireMessage *msg,
+                         gpointer         user_data)
+{
+  GPTileMapData *tile_map_data = msg->data;
+
+  if (! _gimp_wire_write_int32 (channel,
+                                (const guint32 *) &tile_map_data->drawable_id, 1,
+                                user_data))
+    return;
+  if (! _gimp_wire_write_int32 (channel,
+                                (const guint32 *) &tile_map_data->pid, 1,
+                                user_data))
+    return;
+  if (! _gimp_wire_write_int32 (channel,
+                                (const guint32 *) &tile_map_data->map_id, 1,
+                                user_data))
+    return;
+  if (! _gimp_wire_write_int32 (channel,
+                                &tile_map_data->bpp, 1, user_data))
+    return;
+  if (! _gimp_wire_write_int32 (channel,
+                                &tile_map_data->n_tiles, 1, user_data))
+    return;
+  if (! _gimp_wire_write_int64 (channel,
+                                &tile_map_data->header_size, 1, user_data))
+    return;
+  if (! _gimp_wire_write_int64 (channel,
+                                &tile_map_data->size, 1, user_data))
+    return;
+}
+
+static void
+_gp_tile_map_data_destroy (GimpWireMessage *msg)
+{
+  GPTileMapData *tile_map_data = msg->data;
+
+  if (tile_map_data)
+    g_slice_free (GPTileMapData, tile_map_data);
+}
+
+/*  proc_run_list  */
+
+static void
+_gp_proc_run_list_read (GIOChannel      *channel,
+                        GimpWireMessage *msg,
+                        gpointer         user_data)
+{
+  GPProcRunList *proc_run_list = g_slice_new0 (GPProcRunList);
+  guint          i;
+
+  if (! _gimp_wire_read_int32 (channel,
+                               &proc_run_list->n_runs, 1, user_data))
+    goto cleanup;
+
+  if (proc_run_list->n_runs > GP_PROC_LIST_MAX_RUNS)
+    {
+      proc_run_list->n_runs = 0;
+      goto cleanup;
+    }
+
+  proc_run_list->runs = g_new0 (GPProcRun, proc_run_list->n_runs);
+
+  for (i = 0; i < proc_run_list->n_runs; i++)
+    {
+      GPProcRun *proc_run = &proc_run_list->runs[i];
+
+      if (! _gimp_wire_read_string (channel, &proc_run->name, 1, user_data))
+        goto cleanup;
+
+      _gp_params_read (channel,
+                       &proc_run->params, (guint *) &proc_run->n_params,
+                       user_data);
+    }
+
+  if (! _gimp_wire_read_int32 (channel,
+                               &proc_run_list->n_links, 1, user_data))
+    goto cleanup;
+
+  if (proc_run_list->n_links > GP_PROC_LIST_MAX_LINKS)
+    {
+      proc_run_list->n_links = 0;
+      goto cleanup;
+    }
+
+  proc_run_list->links = g_new0 (GPProcLink, proc_run_list->n_links);
+
+  if (! _gimp_wire_read_int32 (channel,
+                               (guint32 *) proc_run_list->links,
+                               proc_run_list->n_links * 4, user_data))
+    goto cleanup;
+
+  msg->data = proc_run_list;
+  return;
+
+ cleanup:
+  msg->data = proc_run_list;
+  _gp_proc_run_list_destroy (msg);
+  msg->data = NULL;
+}
+
+static void
+_gp_proc_run_list_write (GIOChannel      *channel,
+                         GimpWireMessage *msg,
+                         gpointer         user_data)
+{
+  GPProcRunList *proc_run_list = msg->data;
+  guint          i;
+
+  if (! _gimp_wire_write_int32 (channel,
+                                &proc_run_list->n_runs, 1, user_data))
+    return;
+
+  for (i = 0; i < proc_run_list->n_runs; i++)
+    {
+      GPProcRun *proc_run = &proc_run_list->runs[i];
+
+      if (! _gimp_wire_write_string (channel, &proc_run->name, 1, user_data))
+        return;
+
+      _gp_params_write (channel,
+                        proc_run->params, proc_run->n_params, user_data);
+    }
+
+  if (! _gimp_wire_write_int32 (channel,
+                                &proc_run_list->n_links, 1, user_data))
+    return;
+
+  if (! _gimp_wire_write_int32 (channel,
+                                (const guint32 *) proc_run_list->links,
+                                proc_run_list->n_links * 4, user_data))
+    return;
+}
+
+static void
+_gp_proc_run_list_destroy (GimpWireMessage *msg)
+{
+  GPProcRunList *proc_run_list = msg->data;
+
+  if (proc_run_list)
+    {
+      guint i;
+
+      for (i = 0; i < proc_run_list->n_runs; i++)
+        {
+          _gp_params_destroy (proc_run_list->runs[i].params,
+                              proc_run_list->runs[i].n_params);
+
+          g_free (proc_run_list->runs[i].name);
+        }
+
+      g_free (proc_run_list->runs);
+      g_free (proc_run_list->links);
+      g_slice_free (GPProcRunList, proc_run_list);
+    }
+}
+
+/*  proc_return_list  */
+
+static void
+_gp_proc_return_list_read (GIOChannel      *channel,
+                           GimpWireMessage *msg,
+                           gpointer         user_data)
+{
+  GPProcReturnList *proc_return_list = g_slice_new0 (GPProcReturnList);
+  guint             i;
+
+  if (! _gimp_wire_read_int32 (channel,
+                               &proc_return_list->n_returns, 1, user_data))
+    goto cleanup;
+
+  if (proc_return_list->n_returns > GP_PROC_LIST_MAX_RUNS)
+    {
+      proc_return_list->n_returns = 0;
+      goto cleanup;
+    }
+
+  proc_return_list->returns = g_new0 (GPProcReturn,
+                                      proc_return_list->n_returns);
+
+  for (i = 0; i < proc_return_list->n_returns; i++)
+    {
+      GPProcReturn *proc_return = &proc_return_list->returns[i];
+
+      if (! _gimp_wire_read_string (channel, &proc_return->name, 1, user_data))
+        goto cleanup;
+
+      _gp_params_read (channel,
+                       &proc_return->params, (guint *) &proc_return->n_params,
+                       user_data);
+    }
+
+  msg->data = proc_return_list;
+  return;
+
+ cleanup:
+  msg->data = proc_return_list;
+  _gp_proc_return_list_destroy (msg);
+  msg->data = NULL;
+}
+
+static void
+_gp_proc_return_list_write (GIOChannel      *channel,
+                            GimpWireMessage *msg,
+                            gpointer         user_data)
+{
+  GPProcReturnList *proc_return_list = msg->data;
+  guint             i;
+
+  if (! _gimp_wire_write_int32 (channel,
+                                &proc_return_list->n_returns, 1, user_data))
+    return;
+
+  for (i = 0; i < proc_return_list->n_returns; i++)
+    {
+      GPProcReturn *proc_return = &proc_return_list->returns[i];
+
+      if (! _gimp_wire_write_string (channel,
+                                     &proc_return->name, 1, user_data))
+        return;
+
+      _gp_params_write (channel,
+                        proc_return->params, proc_return->n_params,
+                        user_data);
+    }
+}
+
+static void
+_gp_proc_return_list_destroy (GimpWireMessage *msg)
+{
+  GPProcReturnList *proc_return_list = msg->data;
+
+  if (proc_return_list)
+    {
+      guint i;
+
+      for (i = 0; i < proc_return_list->n_returns; i++)
+        {
+          _gp_params_destroy (proc_return_list->returns[i].params,
+                              proc_return_list->returns[i].n_params);
+
+          g_free (proc_return_list->returns[i].name);
+        }
+
+      g_free (proc_return_list->returns);
+      g_slice_free (GPProcReturnList, proc_return_list);
+    }
+}
+
+/*  proc_run_async  */
+
+static void
+_gp_proc_run_async_read (GIOChannel      *channel,
+                         GimpWireMessage *msg,
+                         gpointer         user_data)
+{
+  GPProcRunAsync *proc_run_async = g_slice_new0 (GPProcRunAsync);
+  GPProcRun      *proc_run       = &proc_run_async->proc_run;
+
+  if (! _gimp_wire_read_int32 (channel,
+                               &proc_run_async->handle, 1, user_data))
+    goto cleanup;
+
+  if (! _gimp_wire_read_string (channel, &proc_run->name, 1, user_data))
+    goto cleanup;
+
+  _gp_params_read (channel,
+                   &proc_run->params, (guint *) &proc_run->n_params,
+                   user_data);
+
+  msg->data = proc_run_async;
+  return;
+
+ cleanup:
+  g_slice_free (GPProcRunAsync, proc_run_async);
+  msg->data = NULL;
+}
+
+static void
+_gp_proc_run_async_write (GIOChannel      *channel,
+                          GimpWireMessage *msg,
+                          gpointer         user_data)
+{
+  GPProcRunAsync *proc_run_async = msg->data;
+  GPProcRun      *proc_run       = &proc_run_async->proc_run;
+
+  if (! _gimp_wire_write_int32 (channel,
+                                &proc_run_async->handle, 1, user_data))
+    return;
+
+  if (! _gimp_wire_write_string (channel, &proc_run->name, 1, user_data))
+    return;
+
+  _gp_params_write (channel, proc_run->params, proc_run->n_params, user_data);
+}
+
+static void
+_gp_proc_run_async_destroy (GimpWireMessage *msg)
+{
+  GPProcRunAsync *proc_run_async = msg->data;
+
+  if (proc_run_async)
+    {
+      _gp_params_destroy (proc_run_async->proc_run.params,
+                          proc_run_async->proc_run.n_params);
+
+      g_free (proc_run_async->proc_run.name);
+      g_slice_free (GPProcRunAsync, proc_run_async);
+    }
+}
+
+/*  proc_async_poll  */
+
+static void
+_gp_proc_async_poll_read (GIOChannel      *channel,
+                          GimpWireMessage *msg,
+                          gpointer         user_data)
+{
+  GPProcAsyncPoll *proc_async_poll = g_slice_new0 (GPProcAsyncPoll);
+
+  if (! _gimp_wire_read_int32 (channel,
+                               &proc_async_poll->handle, 1, user_data) ||
+      ! _gimp_wire_read_int32 (channel,
+                               &proc_async_poll->wait, 1, user_data))
+    {
+      g_slice_free (GPProcAsyncPoll, proc_async_poll);
+      msg->data = NULL;
+      return;
+    }
+
+  msg->data = proc_async_poll;
+}
+
+static void
+_gp_proc_async_poll_write (GIOChannel      *channel,
+                           GimpWireMessage *msg,
+                           gpointer         user_data)
+{
+  GPProcAsyncPoll *proc_async_poll = msg->data;
+
+  if (! _gimp_wire_write_int32 (channel,
+                                &proc_async_poll->handle, 1, user_data) ||
+      ! _gimp_wire_write_int32 (channel,
+                                &proc_async_poll->wait, 1, user_data))
+    return;
+}
+
+static void
+_gp_proc_async_poll_destroy (GimpWireMessage *msg)
+{
+  GPProcAsyncPoll *proc_async_poll = msg->data;
+
+  if (proc_async_poll)
+    g_slice_free (GPProcAsyncPoll, proc_async_poll);
+}
+
+/*  proc_async_return  */
+
+static void
+_gp_proc_async_return_read (GIOChannel      *channel,
+                            GimpWireMessage *msg,
+                            gpointer         user_data)
+{
+  GPProcAsyncReturn *proc_async_return = g_slice_new0 (GPProcAsyncReturn);
+  GPProcReturn      *proc_return       = &proc_async_return->proc_return;
+
+  if (! _gimp_wire_read_int32 (channel,
+                               &proc_async_return->handle, 1, user_data) ||
+      ! _gimp_wire_read_int32 (channel,
+                               &proc_async_return->status, 1, user_data) ||
+      ! _gimp_wire_read_int32 (channel,
+                               &proc_async_return->n_ahead, 1, user_data))
+    goto cleanup;
+
+  if (! _gimp_wire_read_string (channel, &proc_return->name, 1, user_data))
+    goto cleanup;
+
+  _gp_params_read (channel,
+                   &proc_return->params, (guint *) &proc_return->n_params,
+                   user_data);
+
+  msg->data = proc_async_return;
+  return;
+
+ cleanup:
+  g_slice_free (GPProcAsyncReturn, proc_async_return);
+  msg->data = NULL;
+}
+
+static void
+_gp_proc_async_return_write (GIOChannel      *channel,
+                             GimpWireMessage *msg,
+                             gpointer         user_data)
+{
+  GPProcAsyncReturn *proc_async_return = msg->data;
+  GPProcReturn      *proc_return       = &proc_async_return->proc_return;
+
+  if (! _gimp_wire_write_int32 (channel,
+                                &proc_async_return->handle, 1, user_data) ||
+      ! _gimp_wire_write_int32 (channel,
+                                &proc_async_return->status, 1, user_data) ||
+      ! _gimp_wire_write_int32 (channel,
+                                &proc_async_return->n_ahead, 1, user_data))
+    return;
+
+  if (! _gimp_wire_write_string (channel, &proc_return->name, 1, user_data))
+    return;
+
+  _gp_params_write (channel,
+                    proc_return->params, proc_return->n_params, user_data);
+}
+
+static void
+_gp_proc_async_return_destroy (GimpWireMessage *msg)
+{
+  GPProcAsyncReturn *proc_async_return = msg->data;
+
+  if (proc_async_return)
+    {
+      _gp_params_destroy (proc_async_return->proc_return.params,
+                          proc_async_return->proc_return.n_params);
+
+      g_free (proc_async_return->proc_return.name);
+      g_slice_free (GPProcAsyncReturn, proc_async_return);
+    }
+}
@@ -26,7 +26,7 @@ G_BEGIN_DECLS
 
 /* Increment every time the protocol changes
  */
-#define GIMP_PROTOCOL_VERSION  0x0115
+#define GIMP_PROTOCOL_VERSION  0x011C
 
 
 enum
@@ -43,9 +43,39 @@ enum
   GP_PROC_INSTALL,
   GP_PROC_UNINSTALL,
   GP_EXTENSION_ACK,
-  GP_HAS_INIT
+  GP_HAS_INIT,
+  GP_TILE_LIST_REQ,
+  GP_TILE_LIST_DATA,
+  GP_TILE_MAP_REQ,
+  GP_TILE_MAP_DATA,
+  GP_TILE_MAP_FILL,
+  GP_KEEP_ALIVE,
+  GP_PROC_RUN_LIST,
+  GP_PROC_RETURN_LIST,
+  GP_PROC_RUN_ASYNC,
+  GP_PROC_ASYNC_POLL,
+  GP_PROC_ASYNC_RETURN
 };
 
+
+/* The maximal number of tiles which can be requested at once using
+ * GP_TILE_LIST_REQ
+ */
+#define GP_TILE_LIST_MAX_TILES 16
+
+/* The maximal number of procedure calls, and of links between them,
+ * which can be sent at once using GP_PROC_RUN_LIST
+ */
+#define GP_PROC_LIST_MAX_RUNS  1024
+#define GP_PROC_LIST_MAX_LINKS 8192
+
+typedef enum
+{
+  GP_PROC_ASYNC_PENDING,
+  GP_PROC_ASYNC_DONE,
+  GP_PROC_ASYNC_UNKNOWN
+} GPProcAsyncStatus;
+
 typedef enum
 {
   GP_PARAM_DEF_TYPE_DEFAULT,
@@ -88,6 +118,10 @@ typedef struct _GPConfig                 GPConfig;
 typedef struct _GPTileReq                GPTileReq;
 typedef struct _GPTileAck                GPTileAck;
 typedef struct _GPTileData               GPTileData;
+typedef struct _GPTileListReq            GPTileListReq;
+typedef struct _GPTileListData           GPTileListData;
+typedef struct _GPTileMapReq             GPTileMapReq;
+typedef struct _GPTileMapData            GPTileMapData;
 typedef struct _GPParamDef               GPParamDef;
 typedef struct _GPParamDefInt            GPParamDefInt;
 typedef struct _GPParamDefUnit           GPParamDefUnit;
@@ -114,6 +148,12 @@ typedef struct _GPProcRun                GPProcRun;
 typedef struct _GPProcReturn             GPProcReturn;
 typedef struct _GPProcInstall            GPProcInstall;
 typedef struct _GPProcUninstall          GPProcUninstall;
+typedef struct _GPProcLink               GPProcLink;
+typedef struct _GPProcRunList            GPProcRunList;
+typedef struct _GPProcReturnList         GPProcReturnList;
+typedef struct _GPProcRunAsync           GPProcRunAsync;
+typedef struct _GPProcAsyncPoll          GPProcAsyncPoll;
+typedef struct _GPProcAsyncReturn        GPProcAsyncReturn;
 
 
 struct _GPConfig
@@ -177,6 +217,57 @@ struct _GPTileData
   guchar  *data;
 };
 
+struct _GPTileListReq
+{
+  gint32   drawable_id;
+  guint32  shadow;
+  guint32  n_tiles;
+  guint32 *tile_nums;
+};
+
+/* the tiles are stored one after the other in 'data', or in the shared
+ * memory segment, each one of its effective size
+ */
+struct _GPTileListData
+{
+  gint32   drawable_id;
+  guint32  shadow;
+  guint32  bpp;
+  guint32  n_tiles;
+  guint32 *tile_nums;
+  guint32  use_shm;
+  guint32  length;
+  guchar  *data;
+};
+
+struct _GPTileMapReq
+{
+  gint32   drawable_id;
+};
+
+/* a drawable's tiles, exported by the core as memory the plug-in can map.
+ * the memory starts with a header of 'header_size' bytes: a gint32 which
+ * is non-zero as long as the map is valid, followed by one byte per tile
+ * which is non-zero when the tile needs to be filled in by the core, using
+ * GP_TILE_MAP_FILL (which takes a GPTileListReq).  then come the tiles, in
+ * tile number order, each one of the full tile size.
+ *
+ * 'map_id' is -1 if the drawable can't be exported.  otherwise, on
+ * Windows, the memory is a file mapping named after 'pid' and 'map_id';
+ * elsewhere, the core passes the memory's file descriptor right after
+ * this message, see gimp_wire_write_fd().
+ */
+struct _GPTileMapData
+{
+  gint32   drawable_id;
+  gint32   pid;
+  gint32   map_id;
+  guint32  bpp;
+  guint32  n_tiles;
+  guint64  header_size;
+  guint64  size;
+};
+
 struct _GPParamDefInt
 {
   gint64 min_val;
@@ -379,44 +470,131 @@ struct _GPProcUninstall
   gchar *name;
 };
 
+/* Replaces argument 'argument' of run 'call' of a GPProcRunList with
+ * return value 'source_value' of the earlier run 'source_call', return
+ * value 0 being the status.
+ */
+struct _GPProcLink
+{
+  guint32  call;
+  guint32  argument;
+  guint32  source_call;
+  guint32  source_value;
+};
+
+struct _GPProcRunList
+{
+  guint32     n_runs;
+  GPProcRun  *runs;
+  guint32     n_links;
+  GPProcLink *links;
+};
+
+struct _GPProcReturnList
+{
+  guint32       n_returns;
+  GPProcReturn *returns;
+};
+
+/* Runs 'proc_run' without waiting for its return values, 'handle'
+ * being chosen by the plug-in to refer to the call later
+ */
+struct _GPProcRunAsync
+{
+  guint32    handle;
+  GPProcRun  proc_run;
+};
+
+/* Asks for the status of call 'handle', after running it first if
+ * 'wait' is TRUE
+ */
+struct _GPProcAsyncPoll
+{
+  guint32  handle;
+  guint32  wait;
+};
+
+/* 'n_ahead' is the number of calls which run before a pending call,
+ * 'proc_return' holds return values only once the call is done
+ */
+struct _GPProcAsyncReturn
+{
+  guint32       handle;
+  guint32       status;
+  guint32       n_ahead;
+  GPProcReturn  proc_return;
+};
+
 
 void      gp_init                   (void);
 
-gboolean  gp_quit_write             (GIOChannel      *channel,
-                                     gpointer         user_data);
-gboolean  gp_config_write           (GIOChannel      *channel,
-                                     GPConfig        *config,
-                                     gpointer         user_data);
-gboolean  gp_tile_req_write         (GIOChannel      *channel,
-                                     GPTileReq       *tile_req,
-                                     gpointer         user_data);
-gboolean  gp_tile_ack_write         (GIOChannel      *channel,
-                                     gpointer         user_data);
-gboolean  gp_tile_data_write        (GIOChannel      *channel,
-                                     GPTileData      *tile_data,
-                                     gpointer         user_data);
-gboolean  gp_proc_run_write         (GIOChannel      *channel,
-                                     GPProcRun       *proc_run,
-                                     gpointer         user_data);
-gboolean  gp_proc_return_write      (GIOChannel      *channel,
-                                     GPProcReturn    *proc_return,
-                                     gpointer         user_data);
-gboolean  gp_temp_proc_run_write    (GIOChannel      *channel,
-                                     GPProcRun       *proc_run,
-                                     gpointer         user_data);
-gboolean  gp_temp_proc_return_write (GIOChannel      *channel,
-                                     GPProcReturn    *proc_return,
-                                     gpointer         user_data);
-gboolean  gp_proc_install_write     (GIOChannel      *channel,
-                                     GPProcInstall   *proc_install,
-                                     gpointer         user_data);
-gboolean  gp_proc_uninstall_write   (GIOChannel      *channel,
-                                     GPProcUninstall *proc_uninstall,
-                                     gpointer         user_data);
-gboolean  gp_extension_ack_write    (GIOChannel      *channel,
-                                     gpointer         user_data);
-gboolean  gp_has_init_write         (GIOChannel      *channel,
-                                     gpointer         user_data);
+gboolean  gp_quit_write             (GIOChannel       *channel,
+                                     gpointer          user_data);
+gboolean  gp_config_write           (GIOChannel       *channel,
+                                     GPConfig         *config,
+                                     gpointer          user_data);
+gboolean  gp_tile_req_write         (GIOChannel       *channel,
+                                     GPTileReq        *tile_req,
+                                     gpointer          user_data);
+gboolean  gp_tile_ack_write         (GIOChannel       *channel,
+                                     gpointer          user_data);
+gboolean  gp_tile_data_write        (GIOChannel       *channel,
+                                     GPTileData       *tile_data,
+                                     gpointer          user_data);
+gboolean  gp_proc_run_write         (GIOChannel       *channel,
+                                     GPProcRun        *proc_run,
+                                     gpointer          user_data);
+gboolean  gp_proc_return_write      (GIOChannel       *channel,
+                                     GPProcReturn     *proc_return,
+                                     gpointer          user_data);
+gboolean  gp_temp_proc_run_write    (GIOChannel       *channel,
+                                     GPProcRun        *proc_run,
+                                     gpointer          user_data);
+gboolean  gp_temp_proc_return_write (GIOChannel       *channel,
+                                     GPProcReturn     *proc_return,
+                                     gpointer          user_data);
+gboolean  gp_proc_install_write     (GIOChannel       *channel,
+                                     GPProcInstall    *proc_install,
+                                     gpointer          user_data);
+gboolean  gp_proc_uninstall_write   (GIOChannel       *channel,
+                                     GPProcUninstall  *proc_uninstall,
+                                     gpointer          user_data);
+gboolean  gp_extension_ack_write    (GIOChannel       *channel,
+                                     gpointer          user_data);
+gboolean  gp_has_init_write         (GIOChannel       *channel,
+                                     gpointer          user_data);
+gboolean  gp_tile_list_req_write    (GIOChannel       *channel,
+                                     GPTileListReq    *tile_list_req,
+                                     gpointer          user_data);
+gboolean  gp_tile_list_data_write   (GIOChannel       *channel,
+                                     GPTileListData   *tile_list_data,
+                                     gpointer          user_data);
+gboolean  gp_tile_map_req_write     (GIOChannel       *channel,
+                                     GPTileMapReq     *tile_map_req,
+                                     gpointer          user_data);
+gboolean  gp_tile_map_data_write    (GIOChannel       *channel,
+                                     GPTileMapData    *tile_map_data,
+                                     gpointer          user_data);
+gboolean  gp_tile_map_fill_write    (GIOChannel       *channel,
+                                     GPTileListReq    *tile_list_req,
+                                     gpointer          user_data);
+gboolean  gp_keep_alive_write       (GIOChannel       *channel,
+                                     gpointer          user_data);
+gboolean  gp_proc_run_list_write    (GIOChannel       *channel,
+                                     GPProcRunList    *proc_run_list,
+                                     gpointer          user_data);
+gboolean  gp_proc_return_list_write (GIOChannel       *channel,
+                                     GPProcReturnList *proc_return_list,
+                                     gpointer          user_data);
+gboolean  gp_proc_run_async_write   (GIOChannel       *channel,
+                                     GPProcRunAsync   *proc_run_async,
+                                     gpointer          user_data);
+gboolean  gp_proc_async_poll_write  (GIOChannel       *channel,
+                                     GPProcAsyncPoll  *proc_async_poll,
+                                     gpointer          user_data);
+gboolean  gp_proc_async_return_write (GIOChannel        *channel,
+                                      GPProcAsyncReturn *proc_async_return,
+                                      gpointer           user_data);
 
 
 G_END_DECLS
@@ -18,8 +18,15 @@
 
 #include "config.h"
 
+#include <errno.h>
 #include <string.h>
 
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
 #include <glib-object.h>
 
 #include <libgimpcolor/gimpcolortypes.h>
@@ -44,6 +51,19 @@ static GimpWireIOFunc     wire_write_func = NULL;
 static GimpWireFlushFunc  wire_flush_func = NULL;
 static gboolean           wire_error_val  = FALSE;
 
+/*  the block being written, or read, see _gimp_wire_begin_write_block()  */
+static GByteArray        *wire_write_block       = NULL;
+static gboolean           wire_writing_block     = FALSE;
+static guint8            *wire_read_block        = NULL;
+static gsize              wire_read_block_size   = 0;
+static gsize              wire_read_block_length = 0;
+static gsize              wire_read_block_offset = 0;
+static gboolean           wire_reading_block     = FALSE;
+
+
+/*  blocks larger than this are not kept around for the next message  */
+#define WIRE_BLOCK_KEEP_SIZE (64 * 1024)
+
 
 static void  gimp_wire_init (void);
 
@@ -96,6 +116,22 @@ gimp_wire_read (GIOChannel *channel,
                 gsize       count,
                 gpointer    user_data)
 {
+  if (wire_reading_block)
+    {
+      if (G_UNLIKELY (count > wire_read_block_length - wire_read_block_offset))
+        {
+          g_printerr ("%s: gimp_wire_read(): read past the end of a block\n",
+                      g_get_prgname ());
+          wire_error_val = TRUE;
+          return FALSE;
+        }
+
+      memcpy (buf, wire_read_block + wire_read_block_offset, count);
+      wire_read_block_offset += count;
+
+      return TRUE;
+    }
+
   if (wire_read_func)
     {
       if (!(* wire_read_func) (channel, buf, count, user_data))
@@ -164,6 +200,13 @@ gimp_wire_write (GIOChannel   *channel,
                  gsize         count,
                  gpointer      user_data)
 {
+  if (wire_writing_block)
+    {
+      g_byte_array_append (wire_write_block, buf, count);
+
+      return TRUE;
+    }
+
   if (wire_write_func)
     {
       if (!(* wire_write_func) (channel, (guint8 *) buf, count, user_data))
@@ -227,6 +270,144 @@ gimp_wire_flush (GIOChannel *channel,
   return FALSE;
 }
 
+/*  passes @fd to the other end of @channel, which has to be an unbuffered
+ *  channel on a Unix domain socket, after everything written so far.  the
+ *  other end receives its own descriptor for the same file with
+ *  gimp_wire_read_fd().  not supported on Windows.
+ */
+gboolean
+gimp_wire_write_fd (GIOChannel *channel,
+                    gint        fd,
+                    gpointer    user_data)
+{
+#ifndef G_OS_WIN32
+  struct msghdr   msg  = { 0, };
+  struct iovec    iov;
+  struct cmsghdr *cmsg;
+  guint8          byte = 0;
+  union
+  {
+    struct cmsghdr header;
+    gchar          buf[CMSG_SPACE (sizeof (gint))];
+  } control;
+  gssize          bytes;
+
+  if (! gimp_wire_flush (channel, user_data))
+    return FALSE;
+
+  /*  the descriptor rides along with a single byte of data  */
+  iov.iov_base = &byte;
+  iov.iov_len  = 1;
+
+  memset (&control, 0, sizeof (control));
+
+  msg.msg_iov        = &iov;
+  msg.msg_iovlen     = 1;
+  msg.msg_control    = control.buf;
+  msg.msg_controllen = sizeof (control.buf);
+
+  cmsg = CMSG_FIRSTHDR (&msg);
+
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type  = SCM_RIGHTS;
+  cmsg->cmsg_len   = CMSG_LEN (sizeof (gint));
+
+  memcpy (CMSG_DATA (cmsg), &fd, sizeof (gint));
+
+  do
+    {
+#ifdef MSG_NOSIGNAL
+      bytes = sendmsg (g_io_channel_unix_get_fd (channel), &msg, MSG_NOSIGNAL);
+#else
+      bytes = sendmsg (g_io_channel_unix_get_fd (channel), &msg, 0);
+#endif
+    }
+  while (G_UNLIKELY (bytes == -1 && errno == EINTR));
+
+  if (G_UNLIKELY (bytes != 1))
+    {
+      g_warning ("%s: gimp_wire_write_fd(): error: %s",
+                 g_get_prgname (), g_strerror (errno));
+
+      wire_error_val = TRUE;
+      return FALSE;
+    }
+
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
+/*  receives a descriptor sent with gimp_wire_write_fd(), right after
+ *  reading everything written before it.  returns -1 on error, otherwise
+ *  the caller has to close the descriptor.
+ */
+gint
+gimp_wire_read_fd (GIOChannel *channel,
+                   gpointer    user_data)
+{
+#ifndef G_OS_WIN32
+  struct msghdr   msg  = { 0, };
+  struct iovec    iov;
+  struct cmsghdr *cmsg;
+  guint8          byte;
+  union
+  {
+    struct cmsghdr header;
+    gchar          buf[CMSG_SPACE (sizeof (gint))];
+  } control;
+  gssize          bytes;
+  gint            fd   = -1;
+
+  iov.iov_base = &byte;
+  iov.iov_len  = 1;
+
+  msg.msg_iov        = &iov;
+  msg.msg_iovlen     = 1;
+  msg.msg_control    = control.buf;
+  msg.msg_controllen = sizeof (control.buf);
+
+  do
+    {
+#ifdef MSG_CMSG_CLOEXEC
+      bytes = recvmsg (g_io_channel_unix_get_fd (channel), &msg,
+                       MSG_CMSG_CLOEXEC);
+#else
+      bytes = recvmsg (g_io_channel_unix_get_fd (channel), &msg, 0);
+#endif
+    }
+  while (G_UNLIKELY (bytes == -1 && errno == EINTR));
+
+  if (G_UNLIKELY (bytes != 1))
+    {
+      if (bytes == 0)
+        g_warning ("%s: gimp_wire_read_fd(): unexpected EOF",
+                   g_get_prgname ());
+      else
+        g_warning ("%s: gimp_wire_read_fd(): error: %s",
+                   g_get_prgname (), g_strerror (errno));
+
+      wire_error_val = TRUE;
+      return -1;
+    }
+
+  for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg))
+    {
+      if (cmsg->cmsg_level == SOL_SOCKET &&
+          cmsg->cmsg_type  == SCM_RIGHTS &&
+          cmsg->cmsg_len   == CMSG_LEN (sizeof (gint)))
+        {
+          memcpy (&fd, CMSG_DATA (cmsg), sizeof (gint));
+        }
+    }
+
+  return fd;
+#else
+  return -1;
+#endif
+}
+
 gboolean
 gimp_wire_error (void)
 {
@@ -310,6 +491,126 @@ gimp_wire_destroy (GimpWireMessage *msg)
   (* handler->destroy_func) (msg);
 }
 
+/*  Blocks let a part of a message which is made of many small fields,
+ *  such as the parameters of a procedure call, be written in one go and
+ *  read with a single gimp_wire_read(), instead of one per field.  On the
+ *  wire, a block is its length, followed by its contents.
+ *
+ *  Between _gimp_wire_begin_write_block() and _gimp_wire_end_write_block(),
+ *  everything written is appended to the block, which is then written at
+ *  once.  Likewise, between _gimp_wire_begin_read_block() and
+ *  _gimp_wire_end_read_block(), everything is read from the block, which
+ *  the latter checks to have been read completely.  Blocks can't be
+ *  nested.
+ */
+void
+_gimp_wire_begin_write_block (void)
+{
+  g_return_if_fail (! wire_writing_block);
+
+  if (! wire_write_block)
+    wire_write_block = g_byte_array_new ();
+
+  g_byte_array_set_size (wire_write_block, 0);
+
+  wire_writing_block = TRUE;
+}
+
+gboolean
+_gimp_wire_end_write_block (GIOChannel *channel,
+                            gpointer    user_data)
+{
+  guint32  length;
+  gboolean success;
+
+  g_return_val_if_fail (wire_writing_block, FALSE);
+
+  wire_writing_block = FALSE;
+
+  length = wire_write_block->len;
+
+  success = (_gimp_wire_write_int32 (channel, &length, 1, user_data) &&
+             gimp_wire_write (channel,
+                              wire_write_block->data, length, user_data));
+
+  if (wire_write_block->len > WIRE_BLOCK_KEEP_SIZE)
+    g_clear_pointer (&wire_write_block, g_byte_array_unref);
+
+  return success;
+}
+
+gboolean
+_gimp_wire_begin_read_block (GIOChannel *channel,
+                             gpointer    user_data)
+{
+  guint32 length;
+
+  g_return_val_if_fail (! wire_reading_block, FALSE);
+
+  if (! _gimp_wire_read_int32 (channel, &length, 1, user_data))
+    return FALSE;
+
+  if (length > wire_read_block_size)
+    {
+      guint8 *block;
+
+      /* We may read crap on the wire (and as a consequence try to
+       * allocate far too much), which would be a plug-in error.
+       */
+      block = g_try_realloc (wire_read_block, length);
+
+      if (! block)
+        {
+          g_printerr ("%s: failed to allocate %u bytes\n", G_STRFUNC, length);
+          wire_error_val = TRUE;
+          return FALSE;
+        }
+
+      wire_read_block      = block;
+      wire_read_block_size = length;
+    }
+
+  if (! gimp_wire_read (channel, wire_read_block, length, user_data))
+    return FALSE;
+
+  wire_read_block_length = length;
+  wire_read_block_offset = 0;
+  wire_reading_block     = TRUE;
+
+  return TRUE;
+}
+
+gboolean
+_gimp_wire_end_read_block (void)
+{
+  gboolean success;
+
+  g_return_val_if_fail (wire_reading_block, FALSE);
+
+  wire_reading_block = FALSE;
+
+  success = (wire_read_block_offset == wire_read_block_length);
+
+  if (! success)
+    {
+      g_printerr ("%s: %" G_GSIZE_FORMAT " bytes left unread in a block\n",
+                  g_get_prgname (),
+                  wire_read_block_length - wire_read_block_offset);
+      wire_error_val = TRUE;
+    }
+
+  if (wire_read_block_size > WIRE_BLOCK_KEEP_SIZE)
+    {
+      g_clear_pointer (&wire_read_block, g_free);
+      wire_read_block_size = 0;
+    }
+
+  wire_read_block_length = 0;
+  wire_read_block_offset = 0;
+
+  return success;
+}
+
 gboolean
 _gimp_wire_read_int64 (GIOChannel *channel,
                        guint64    *data,
@@ -68,6 +68,12 @@ gboolean  gimp_wire_write         (GIOChannel          *channel,
 gboolean  gimp_wire_flush         (GIOChannel          *channel,
                                    gpointer             user_data);
 
+gboolean  gimp_wire_write_fd      (GIOChannel          *channel,
+                                   gint                 fd,
+                                   gpointer             user_data);
+gint      gimp_wire_read_fd       (GIOChannel          *channel,
+                                   gpointer             user_data);
+
 gboolean  gimp_wire_error         (void);
 void      gimp_wire_clear_error   (void);
 
@@ -146,6 +152,17 @@ G_GNUC_INTERNAL gboolean
                                                    gint            count,
                                                    gpointer        user_data);
 
+G_GNUC_INTERNAL void
+                     _gimp_wire_begin_write_block (void);
+G_GNUC_INTERNAL gboolean
+                     _gimp_wire_end_write_block   (GIOChannel     *channel,
+                                                   gpointer        user_data);
+G_GNUC_INTERNAL gboolean
+                     _gimp_wire_begin_read_block  (GIOChannel     *channel,
+                                                   gpointer        user_data);
+G_GNUC_INTERNAL gboolean
+                     _gimp_wire_end_read_block    (void);
+
 
 G_END_DECLS
 
@@ -31,10 +31,24 @@ cpu_accel_print_results (void)
               (support & GIMP_CPU_ACCEL_X86_SSE2)    ? "yes" : "no");
   g_printerr ("  sse3    : %s\n",
               (support & GIMP_CPU_ACCEL_X86_SSE3)    ? "yes" : "no");
+  g_printerr ("  avx2    : %s\n",
+              (support & GIMP_CPU_ACCEL_X86_AVX2)    ? "yes" : "no");
+  g_printerr ("  avx512f : %s\n",
+              (support & GIMP_CPU_ACCEL_X86_AVX512F) ? "yes" : "no");
+  g_printerr ("  fma     : %s\n",
+              (support & GIMP_CPU_ACCEL_X86_FMA)     ? "yes" : "no");
+  g_printerr ("  f16c    : %s\n",
+              (support & GIMP_CPU_ACCEL_X86_F16C)    ? "yes" : "no");
 #endif
 #ifdef ARCH_PPC
   g_printerr ("  altivec : %s\n",
               (support & GIMP_CPU_ACCEL_PPC_ALTIVEC) ? "yes" : "no");
+#endif
+#ifdef ARCH_ARM
+  g_printerr ("  neon    : %s\n",
+              (support & GIMP_CPU_ACCEL_ARM_NEON)    ? "yes" : "no");
+  g_printerr ("  sve     : %s\n",
+              (support & GIMP_CPU_ACCEL_ARM_SVE)     ? "yes" : "no");
 #endif
   g_printerr ("\n");
 }
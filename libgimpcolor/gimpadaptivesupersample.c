@@ -293,6 +293,15 @@ gimp_render_sub_pixel (gint             max_depth,
  * @progress_func:  (scope call): function to report progress.
  * @progress_data:  user data passed to @progress_func.
  *
+ * Renders the area from (@x1, @y1) to (@x2, @y2) with @render_func,
+ * sampling each pixel more finely where neighbouring samples differ
+ * by at least @threshold.
+ *
+ * All of the sampler's state is local to the call, so disjoint areas
+ * of an image, such as bands of rows, can be supersampled from
+ * several threads at once, as long as the passed functions are
+ * thread-safe themselves.
+ *
  * Returns: the number of pixels processed.
  **/
 gulong
@@ -41,6 +41,13 @@
 #include "libgimp/libgimp-intl.h"
 
 
+#define PIXELS_PER_THREAD \
+  (/* each thread costs as much as */ 64.0 * 64.0 /* pixels */)
+
+/* progress is reported after each band of about this many pixels */
+#define PIXELS_PER_BAND (256 * 256)
+
+
 /**
  * SECTION: gimpcolortransform
  * @title: GimpColorTransform
@@ -79,8 +86,22 @@ struct _GimpColorTransform
   const Babl       *fish;
 };
 
+typedef struct
+{
+  GimpColorTransform *transform;
+  GeglBuffer         *src_buffer;
+  const Babl         *src_format;
+  GeglBuffer         *dest_buffer;
+  const Babl         *dest_format;
+  gint                offset_x;
+  gint                offset_y;
+} ProcessBufferData;
+
+
+static void   gimp_color_transform_finalize     (GObject             *object);
 
-static void   gimp_color_transform_finalize (GObject *object);
+static void   gimp_color_transform_process_area (const GeglRectangle *area,
+                                                 ProcessBufferData   *data);
 
 
 G_DEFINE_TYPE (GimpColorTransform, gimp_color_transform, G_TYPE_OBJECT)
@@ -149,6 +170,71 @@ gimp_color_transform_finalize (GObject *object)
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
+/* called from several threads at once: both cmsDoTransform() and
+ * babl_process() only read the shared transform, and each area uses
+ * its own iterator.
+ */
+static void
+gimp_color_transform_process_area (const GeglRectangle *area,
+                                   ProcessBufferData   *data)
+{
+  GimpColorTransform *transform = data->transform;
+  GeglBufferIterator *iter;
+
+  if (data->src_buffer != data->dest_buffer)
+    {
+      GeglRectangle dest_area = *area;
+
+      dest_area.x += data->offset_x;
+      dest_area.y += data->offset_y;
+
+      iter = gegl_buffer_iterator_new (data->src_buffer, area, 0,
+                                       data->src_format,
+                                       GEGL_ACCESS_READ,
+                                       GEGL_ABYSS_NONE, 2);
+
+      gegl_buffer_iterator_add (iter, data->dest_buffer, &dest_area, 0,
+                                data->dest_format,
+                                GEGL_ACCESS_WRITE,
+                                GEGL_ABYSS_NONE);
+
+      while (gegl_buffer_iterator_next (iter))
+        {
+          if (transform->transform)
+            {
+              cmsDoTransform (transform->transform,
+                              iter->items[0].data, iter->items[1].data, iter->length);
+            }
+          else
+            {
+              babl_process (transform->fish,
+                            iter->items[0].data, iter->items[1].data, iter->length);
+            }
+        }
+    }
+  else
+    {
+      iter = gegl_buffer_iterator_new (data->src_buffer, area, 0,
+                                       data->src_format,
+                                       GEGL_ACCESS_READWRITE,
+                                       GEGL_ABYSS_NONE, 1);
+
+      while (gegl_buffer_iterator_next (iter))
+        {
+          if (transform->transform)
+            {
+              cmsDoTransform (transform->transform,
+                              iter->items[0].data, iter->items[0].data, iter->length);
+            }
+          else
+            {
+              babl_process (transform->fish,
+                            iter->items[0].data, iter->items[0].data, iter->length);
+            }
+        }
+    }
+}
+
 
 /**
  * gimp_color_transform_new:
@@ -493,99 +579,68 @@ gimp_color_transform_process_buffer (GimpColorTransform  *transform,
                                      GeglBuffer          *dest_buffer,
                                      const GeglRectangle *dest_rect)
 {
-  const Babl         *src_format;
-  const Babl         *dest_format;
-  GeglBufferIterator *iter;
-  gint                total_pixels;
-  gint                done_pixels = 0;
+  ProcessBufferData data;
+  GeglRectangle     rect;
+  gint              band_height;
+  gint              y;
 
   g_return_if_fail (GIMP_IS_COLOR_TRANSFORM (transform));
   g_return_if_fail (GEGL_IS_BUFFER (src_buffer));
   g_return_if_fail (GEGL_IS_BUFFER (dest_buffer));
 
   if (src_rect)
-    {
-      total_pixels = src_rect->width * src_rect->height;
-    }
+    rect = *src_rect;
   else
-    {
-      total_pixels = (gegl_buffer_get_width  (src_buffer) *
-                      gegl_buffer_get_height (src_buffer));
-    }
+    rect = *gegl_buffer_get_extent (src_buffer);
 
   /* we must not do any babl color transforms when reading from
    * src_buffer or writing to dest_buffer, so construct formats with
    * the transform's expected input and output encoding and
    * src_buffer's and dest_buffers's color spaces.
    */
-  src_format  = gegl_buffer_get_format (src_buffer);
-  dest_format = gegl_buffer_get_format (dest_buffer);
+  data.transform   = transform;
+  data.src_buffer  = src_buffer;
+  data.dest_buffer = dest_buffer;
 
-  src_format =
+  data.src_format =
     babl_format_with_space ((const gchar *) transform->src_format,
-                            babl_format_get_space (src_format));
-  dest_format =
+                            babl_format_get_space (gegl_buffer_get_format (src_buffer)));
+  data.dest_format =
     babl_format_with_space ((const gchar *) transform->dest_format,
-                            babl_format_get_space (dest_format));
+                            babl_format_get_space (gegl_buffer_get_format (dest_buffer)));
 
-  if (src_buffer != dest_buffer)
-    {
-      iter = gegl_buffer_iterator_new (src_buffer, src_rect, 0,
-                                       src_format,
-                                       GEGL_ACCESS_READ,
-                                       GEGL_ABYSS_NONE, 2);
+  data.offset_x = dest_rect ? dest_rect->x - rect.x : 0;
+  data.offset_y = dest_rect ? dest_rect->y - rect.y : 0;
 
-      gegl_buffer_iterator_add (iter, dest_buffer, dest_rect, 0,
-                                dest_format,
-                                GEGL_ACCESS_WRITE,
-                                GEGL_ABYSS_NONE);
-
-      while (gegl_buffer_iterator_next (iter))
-        {
-          if (transform->transform)
-            {
-              cmsDoTransform (transform->transform,
-                              iter->items[0].data, iter->items[1].data, iter->length);
-            }
-          else
-            {
-              babl_process (transform->fish,
-                            iter->items[0].data, iter->items[1].data, iter->length);
-            }
+  if (rect.width <= 0 || rect.height <= 0)
+    {
+      g_signal_emit (transform, gimp_color_transform_signals[PROGRESS], 0,
+                     1.0);
+      return;
+    }
 
-          done_pixels += iter->items[0].roi.width * iter->items[0].roi.height;
+  /* process the buffer in bands of rows, each of which is split across
+   * threads, and report progress from this thread after each band.
+   */
+  band_height = CLAMP (PIXELS_PER_BAND / rect.width, 1, rect.height);
 
-          g_signal_emit (transform, gimp_color_transform_signals[PROGRESS], 0,
-                         (gdouble) done_pixels /
-                         (gdouble) total_pixels);
-        }
-    }
-  else
+  for (y = rect.y; y < rect.y + rect.height; y += band_height)
     {
-      iter = gegl_buffer_iterator_new (src_buffer, src_rect, 0,
-                                       src_format,
-                                       GEGL_ACCESS_READWRITE,
-                                       GEGL_ABYSS_NONE, 1);
+      GeglRectangle band;
 
-      while (gegl_buffer_iterator_next (iter))
-        {
-          if (transform->transform)
-            {
-              cmsDoTransform (transform->transform,
-                              iter->items[0].data, iter->items[0].data, iter->length);
-            }
-          else
-            {
-              babl_process (transform->fish,
-                            iter->items[0].data, iter->items[0].data, iter->length);
-            }
+      band.x      = rect.x;
+      band.y      = y;
+      band.width  = rect.width;
+      band.height = MIN (band_height, rect.y + rect.height - y);
 
-          done_pixels += iter->items[0].roi.width * iter->items[0].roi.height;
+      gegl_parallel_distribute_area (
+        &band, PIXELS_PER_THREAD, GEGL_SPLIT_STRATEGY_AUTO,
+        (GeglParallelDistributeAreaFunc) gimp_color_transform_process_area,
+        &data);
 
-          g_signal_emit (transform, gimp_color_transform_signals[PROGRESS], 0,
-                         (gdouble) done_pixels /
-                         (gdouble) total_pixels);
-        }
+      g_signal_emit (transform, gimp_color_transform_signals[PROGRESS], 0,
+                     (gdouble) (band.y + band.height - rect.y) /
+                     (gdouble) rect.height);
     }
 
   g_signal_emit (transform, gimp_color_transform_signals[PROGRESS], 0,
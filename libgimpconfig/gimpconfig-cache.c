@@ -0,0 +1,511 @@
+/* LIBGIMP - The GIMP Library
+ * Copyright (C) 1995-1997 Spencer Kimball and Peter Mattis
+ *
+ * Binary snapshots of deserialized GimpConfig objects
+ *
+ * This library is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <gio/gio.h>
+#include <gegl.h>
+
+#include "libgimpbase/gimpbase.h"
+
+#include "gimpconfigtypes.h"
+
+#include "gimpconfigwriter.h"
+#include "gimpconfig-cache.h"
+#include "gimpconfig-iface.h"
+#include "gimpconfig-params.h"
+#include "gimpconfig-serialize.h"
+
+
+/**
+ * SECTION: gimpconfig-cache
+ * @title: GimpConfig-cache
+ * @short_description: Binary snapshots of deserialized config objects.
+ *
+ * A snapshot stores the serializable properties of a #GimpConfig
+ * object as it was after deserializing a set of text files, so that
+ * the object can be restored without parsing them again. The text
+ * files remain the source of truth: a snapshot is only used while
+ * the size, modification time and checksum of each file still match.
+ **/
+
+
+/*  (version, type name, sources, properties, text of the properties
+ *   which have no binary representation)
+ */
+#define SNAPSHOT_FORMAT "(ssa(sbxxs)a{sv}s)"
+#define SOURCE_FORMAT   "a(sbxxs)"
+
+
+static GVariant * gimp_config_cache_fingerprint      (GFile        **sources);
+static GVariant * gimp_config_cache_value_to_variant (const GValue  *value);
+static gboolean   gimp_config_cache_variant_to_value (GVariant      *variant,
+                                                      GValue        *value);
+
+
+/*  public functions  */
+
+/**
+ * gimp_config_cache_restore:
+ * @config: a #GimpConfig with its properties at their default values.
+ * @cache: the snapshot file.
+ * @sources: (array zero-terminated=1): the text files the snapshot
+ *           was made from.
+ * @data: user data passed to the deserialize implementation.
+ *
+ * Restores @config from the snapshot in @cache, if it was stored
+ * by gimp_config_cache_store() from the same, unchanged @sources and
+ * the same version of GIMP.
+ *
+ * If %FALSE is returned, @config is reset, and the caller should
+ * deserialize @sources as usual.
+ *
+ * Returns: %TRUE if @config was restored from @cache.
+ *
+ * Since: 3.2
+ **/
+gboolean
+gimp_config_cache_restore (GimpConfig  *config,
+                           GFile       *cache,
+                           GFile      **sources,
+                           gpointer     data)
+{
+  GObjectClass *klass;
+  GBytes       *bytes;
+  GVariant     *snapshot;
+  GVariant     *stored_sources;
+  GVariant     *current_sources;
+  GVariant     *properties;
+  const gchar  *version;
+  const gchar  *type_name;
+  const gchar  *text;
+  GVariantIter  iter;
+  const gchar  *name;
+  GVariant     *variant;
+  gchar        *contents;
+  gsize         length;
+  gboolean      success = TRUE;
+
+  g_return_val_if_fail (GIMP_IS_CONFIG (config), FALSE);
+  g_return_val_if_fail (G_IS_FILE (cache), FALSE);
+  g_return_val_if_fail (sources != NULL, FALSE);
+
+  if (! g_file_load_contents (cache, NULL, &contents, &length, NULL, NULL))
+    return FALSE;
+
+  bytes    = g_bytes_new_take (contents, length);
+  snapshot = g_variant_new_from_bytes (G_VARIANT_TYPE (SNAPSHOT_FORMAT),
+                                       bytes, FALSE);
+  g_bytes_unref (bytes);
+
+  g_variant_get (snapshot, "(&s&s@" SOURCE_FORMAT "@a{sv}&s)",
+                 &version, &type_name, &stored_sources, &properties, &text);
+
+  current_sources = gimp_config_cache_fingerprint (sources);
+
+  if (strcmp (version, GIMP_VERSION)                         ||
+      strcmp (type_name, G_OBJECT_TYPE_NAME (config))        ||
+      ! g_variant_equal (stored_sources, current_sources))
+    {
+      g_variant_unref (current_sources);
+      g_variant_unref (stored_sources);
+      g_variant_unref (properties);
+      g_variant_unref (snapshot);
+
+      return FALSE;
+    }
+
+  klass = G_OBJECT_GET_CLASS (config);
+
+  g_object_freeze_notify (G_OBJECT (config));
+
+  g_variant_iter_init (&iter, properties);
+
+  while (success && g_variant_iter_next (&iter, "{&sv}", &name, &variant))
+    {
+      GParamSpec *prop_spec = g_object_class_find_property (klass, name);
+      GValue      value     = G_VALUE_INIT;
+
+      if (prop_spec && (prop_spec->flags & GIMP_CONFIG_PARAM_SERIALIZE))
+        {
+          g_value_init (&value, prop_spec->value_type);
+
+          success = gimp_config_cache_variant_to_value (variant, &value);
+
+          if (success)
+            g_object_set_property (G_OBJECT (config), name, &value);
+
+          g_value_unset (&value);
+        }
+      else
+        {
+          success = FALSE;
+        }
+
+      g_variant_unref (variant);
+    }
+
+  if (success && *text)
+    success = gimp_config_deserialize_string (config, text, -1, data, NULL);
+
+  g_object_thaw_notify (G_OBJECT (config));
+
+  if (! success)
+    gimp_config_reset (config);
+
+  g_variant_unref (current_sources);
+  g_variant_unref (stored_sources);
+  g_variant_unref (properties);
+  g_variant_unref (snapshot);
+
+  return success;
+}
+
+/**
+ * gimp_config_cache_store:
+ * @config: a #GimpConfig.
+ * @cache: the snapshot file.
+ * @sources: (array zero-terminated=1): the text files @config was
+ *           just deserialized from.
+ * @error: return location for a possible error
+ *
+ * Stores a snapshot of the serializable properties of @config in
+ * @cache, for gimp_config_cache_restore().
+ *
+ * Only use this for objects whose state is fully described by their
+ * serializable properties, starting from the defaults, and only after
+ * @sources were deserialized successfully.
+ *
+ * Returns: %TRUE if the snapshot was written.
+ *
+ * Since: 3.2
+ **/
+gboolean
+gimp_config_cache_store (GimpConfig  *config,
+                         GFile       *cache,
+                         GFile      **sources,
+                         GError     **error)
+{
+  GObjectClass      *klass;
+  GParamSpec       **property_specs;
+  guint              n_property_specs;
+  guint              i;
+  GVariantBuilder    properties;
+  GString           *text;
+  GimpConfigWriter  *writer;
+  GVariant          *fingerprint;
+  GVariant          *snapshot;
+  gboolean           success;
+
+  g_return_val_if_fail (GIMP_IS_CONFIG (config), FALSE);
+  g_return_val_if_fail (G_IS_FILE (cache), FALSE);
+  g_return_val_if_fail (sources != NULL, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  klass = G_OBJECT_GET_CLASS (config);
+
+  property_specs = g_object_class_list_properties (klass, &n_property_specs);
+
+  g_variant_builder_init (&properties, G_VARIANT_TYPE ("a{sv}"));
+
+  text   = g_string_new (NULL);
+  writer = gimp_config_writer_new_from_string (text);
+
+  success = TRUE;
+
+  for (i = 0; success && i < n_property_specs; i++)
+    {
+      GParamSpec *prop_spec = property_specs[i];
+      GValue      value     = G_VALUE_INIT;
+      GVariant   *variant;
+
+      if (! (prop_spec->flags & GIMP_CONFIG_PARAM_SERIALIZE))
+        continue;
+
+      g_value_init (&value, prop_spec->value_type);
+      g_object_get_property (G_OBJECT (config), prop_spec->name, &value);
+
+      variant = gimp_config_cache_value_to_variant (&value);
+
+      /*  everything else, like colors and nested objects, is kept in
+       *  the text format, which is still much less to parse than the
+       *  sources
+       */
+      if (variant)
+        g_variant_builder_add (&properties, "{sv}", prop_spec->name, variant);
+      else
+        success = gimp_config_serialize_property (config, prop_spec, writer);
+
+      g_value_unset (&value);
+    }
+
+  g_free (property_specs);
+
+  if (! gimp_config_writer_finish (writer, NULL, error))
+    success = FALSE;
+
+  if (success)
+    {
+      fingerprint = gimp_config_cache_fingerprint (sources);
+
+      snapshot = g_variant_new ("(ss@" SOURCE_FORMAT "a{sv}s)",
+                                GIMP_VERSION,
+                                G_OBJECT_TYPE_NAME (config),
+                                fingerprint,
+                                &properties,
+                                text->str);
+      g_variant_ref_sink (snapshot);
+      g_variant_unref (fingerprint);
+
+      success = g_file_replace_contents (cache,
+                                         g_variant_get_data (snapshot),
+                                         g_variant_get_size (snapshot),
+                                         NULL, FALSE,
+                                         G_FILE_CREATE_NONE,
+                                         NULL, NULL, error);
+
+      g_variant_unref (snapshot);
+    }
+  else
+    {
+      g_variant_builder_clear (&properties);
+
+      if (error && ! *error)
+        g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                             "Could not serialize a property");
+    }
+
+  g_string_free (text, TRUE);
+
+  return success;
+}
+
+
+/*  private functions  */
+
+static GVariant *
+gimp_config_cache_fingerprint (GFile **sources)
+{
+  GVariantBuilder builder;
+  gint            i;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE (SOURCE_FORMAT));
+
+  for (i = 0; sources[i]; i++)
+    {
+      GFile     *file = sources[i];
+      GFileInfo *info;
+      gchar     *uri;
+      gchar     *contents;
+      gsize      length;
+
+      uri  = g_file_get_uri (file);
+      info = g_file_query_info (file,
+                                G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+                                G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+                                G_FILE_QUERY_INFO_NONE,
+                                NULL, NULL);
+
+      if (info &&
+          g_file_load_contents (file, NULL, &contents, &length, NULL, NULL))
+        {
+          gint64  mtime;
+          gchar  *checksum;
+
+          mtime = (g_file_info_get_attribute_uint64 (info,
+                                                     G_FILE_ATTRIBUTE_TIME_MODIFIED) *
+                   G_USEC_PER_SEC +
+                   g_file_info_get_attribute_uint32 (info,
+                                                     G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC));
+
+          checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA256,
+                                                  (const guchar *) contents,
+                                                  length);
+
+          g_variant_builder_add (&builder, "(sbxxs)",
+                                 uri, TRUE, (gint64) length, mtime, checksum);
+
+          g_free (checksum);
+          g_free (contents);
+        }
+      else
+        {
+          /*  a missing file is part of the fingerprint too, so that
+           *  the snapshot is dropped once it is created
+           */
+          g_variant_builder_add (&builder, "(sbxxs)",
+                                 uri, FALSE, (gint64) 0, (gint64) 0, "");
+        }
+
+      g_clear_object (&info);
+      g_free (uri);
+    }
+
+  return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+static GVariant *
+gimp_config_cache_value_to_variant (const GValue *value)
+{
+  switch (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (value)))
+    {
+    case G_TYPE_BOOLEAN:
+      return g_variant_new_boolean (g_value_get_boolean (value));
+
+    case G_TYPE_INT:
+      return g_variant_new_int32 (g_value_get_int (value));
+
+    case G_TYPE_UINT:
+      return g_variant_new_uint32 (g_value_get_uint (value));
+
+    case G_TYPE_LONG:
+      return g_variant_new_int64 (g_value_get_long (value));
+
+    case G_TYPE_ULONG:
+      return g_variant_new_uint64 (g_value_get_ulong (value));
+
+    case G_TYPE_INT64:
+      return g_variant_new_int64 (g_value_get_int64 (value));
+
+    case G_TYPE_UINT64:
+      return g_variant_new_uint64 (g_value_get_uint64 (value));
+
+    case G_TYPE_FLOAT:
+      return g_variant_new_double (g_value_get_float (value));
+
+    case G_TYPE_DOUBLE:
+      return g_variant_new_double (g_value_get_double (value));
+
+    case G_TYPE_ENUM:
+      return g_variant_new_int32 (g_value_get_enum (value));
+
+    case G_TYPE_FLAGS:
+      return g_variant_new_uint32 (g_value_get_flags (value));
+
+    case G_TYPE_STRING:
+      {
+        const gchar *str = g_value_get_string (value);
+
+        if (str && ! g_utf8_validate (str, -1, NULL))
+          return NULL;
+
+        return g_variant_new_maybe (G_VARIANT_TYPE_STRING,
+                                    str ? g_variant_new_string (str) : NULL);
+      }
+
+    default:
+      return NULL;
+    }
+}
+
+static gboolean
+gimp_config_cache_variant_to_value (GVariant *variant,
+                                    GValue   *value)
+{
+#define CHECK_TYPE(type) \
+  if (! g_variant_is_of_type (variant, type)) return FALSE
+
+  switch (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (value)))
+    {
+    case G_TYPE_BOOLEAN:
+      CHECK_TYPE (G_VARIANT_TYPE_BOOLEAN);
+      g_value_set_boolean (value, g_variant_get_boolean (variant));
+      break;
+
+    case G_TYPE_INT:
+      CHECK_TYPE (G_VARIANT_TYPE_INT32);
+      g_value_set_int (value, g_variant_get_int32 (variant));
+      break;
+
+    case G_TYPE_UINT:
+      CHECK_TYPE (G_VARIANT_TYPE_UINT32);
+      g_value_set_uint (value, g_variant_get_uint32 (variant));
+      break;
+
+    case G_TYPE_LONG:
+      CHECK_TYPE (G_VARIANT_TYPE_INT64);
+      g_value_set_long (value, g_variant_get_int64 (variant));
+      break;
+
+    case G_TYPE_ULONG:
+      CHECK_TYPE (G_VARIANT_TYPE_UINT64);
+      g_value_set_ulong (value, g_variant_get_uint64 (variant));
+      break;
+
+    case G_TYPE_INT64:
+      CHECK_TYPE (G_VARIANT_TYPE_INT64);
+      g_value_set_int64 (value, g_variant_get_int64 (variant));
+      break;
+
+    case G_TYPE_UINT64:
+      CHECK_TYPE (G_VARIANT_TYPE_UINT64);
+      g_value_set_uint64 (value, g_variant_get_uint64 (variant));
+      break;
+
+    case G_TYPE_FLOAT:
+      CHECK_TYPE (G_VARIANT_TYPE_DOUBLE);
+      g_value_set_float (value, g_variant_get_double (variant));
+      break;
+
+    case G_TYPE_DOUBLE:
+      CHECK_TYPE (G_VARIANT_TYPE_DOUBLE);
+      g_value_set_double (value, g_variant_get_double (variant));
+      break;
+
+    case G_TYPE_ENUM:
+      CHECK_TYPE (G_VARIANT_TYPE_INT32);
+      g_value_set_enum (value, g_variant_get_int32 (variant));
+      break;
+
+    case G_TYPE_FLAGS:
+      CHECK_TYPE (G_VARIANT_TYPE_UINT32);
+      g_value_set_flags (value, g_variant_get_uint32 (variant));
+      break;
+
+    case G_TYPE_STRING:
+      {
+        GVariant *str;
+
+        CHECK_TYPE (G_VARIANT_TYPE ("ms"));
+
+        str = g_variant_get_maybe (variant);
+
+        if (str)
+          {
+            g_value_set_string (value, g_variant_get_string (str, NULL));
+            g_variant_unref (str);
+          }
+        else
+          {
+            g_value_set_string (value, NULL);
+          }
+      }
+      break;
+
+    default:
+      return FALSE;
+    }
+
+#undef CHECK_TYPE
+
+  return TRUE;
+}
@@ -27,6 +27,7 @@
 
 #include <libgimpconfig/gimpconfigtypes.h>
 
+#include <libgimpconfig/gimpconfig-cache.h>
 #include <libgimpconfig/gimpconfig-deserialize.h>
 #include <libgimpconfig/gimpconfig-error.h>
 #include <libgimpconfig/gimpconfig-iface.h>
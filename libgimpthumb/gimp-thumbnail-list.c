@@ -21,12 +21,18 @@ static gboolean  parse_option_path  (const gchar  *option_name,
                                      GError      **error);
 static void      process_folder     (const gchar  *folder);
 static void      process_thumbnail  (const gchar  *filename);
+static void      check_done         (GObject      *source,
+                                     GAsyncResult *result,
+                                     gpointer      data);
+static void      print_thumbnail    (GimpThumbnail *thumbnail);
 
 
 static GimpThumbState  option_state   = STATE_NONE;
 static gboolean        option_verbose = FALSE;
 static gchar          *option_path    = NULL;
 
+static GList          *thumbnails     = NULL;
+
 
 static const GOptionEntry main_entries[] =
 {
@@ -94,6 +100,24 @@ main (gint   argc,
 
   g_dir_close (dir);
 
+  /*  the images are stat'ed in parallel, which matters when many of
+   *  them are on a slow file system
+   */
+  if (thumbnails)
+    {
+      GMainLoop *loop = g_main_loop_new (NULL, FALSE);
+
+      thumbnails = g_list_reverse (thumbnails);
+
+      gimp_thumbnail_list_check_async (thumbnails, GIMP_THUMB_SIZE_NORMAL, 0,
+                                       NULL, check_done, loop);
+
+      g_main_loop_run (loop);
+      g_main_loop_unref (loop);
+
+      g_list_free_full (thumbnails, g_object_unref);
+    }
+
   return 0;
 }
 
@@ -181,7 +205,6 @@ process_thumbnail (const gchar *filename)
 {
   GimpThumbnail *thumbnail;
   GError        *error = NULL;
-  gchar         *image_uri;
 
   thumbnail = gimp_thumbnail_new ();
 
@@ -196,59 +219,94 @@ process_thumbnail (const gchar *filename)
         }
 
       g_clear_error (&error);
+      g_object_unref (thumbnail);
     }
   else
     {
-      GimpThumbState state = gimp_thumbnail_peek_image (thumbnail);
+      g_object_set_data_full (G_OBJECT (thumbnail), "thumb-filename",
+                              g_strdup (filename), g_free);
 
-      g_object_get (thumbnail, "image-uri", &image_uri, NULL);
+      thumbnails = g_list_prepend (thumbnails, thumbnail);
+    }
+}
 
-      if ((option_state == STATE_NONE || state == option_state)
+static void
+check_done (GObject      *source,
+            GAsyncResult *result,
+            gpointer      data)
+{
+  GMainLoop *loop  = data;
+  GError    *error = NULL;
 
-          &&
+  if (gimp_thumbnail_list_check_finish (result, &error))
+    g_list_foreach (thumbnails, (GFunc) print_thumbnail, NULL);
+  else
+    g_printerr ("%s\n", error->message);
 
-          (option_path == NULL ||
-           strstr (image_uri, option_path)))
-        {
-          if (option_verbose)
-            g_print ("%s '%s'\n", filename, image_uri);
-          else
-            g_print ("%s\n", filename);
-        }
+  g_clear_error (&error);
+
+  g_main_loop_quit (loop);
+}
+
+static void
+print_thumbnail (GimpThumbnail *thumbnail)
+{
+  const gchar    *filename;
+  gchar          *image_uri;
+  GimpThumbState  state;
+
+  filename = g_object_get_data (G_OBJECT (thumbnail), "thumb-filename");
+
+  g_object_get (thumbnail,
+                "image-state", &state,
+                "image-uri",   &image_uri,
+                NULL);
+
+  if ((option_state == STATE_NONE || state == option_state)
+
+      &&
+
+      (option_path == NULL ||
+       strstr (image_uri, option_path)))
+    {
+      if (option_verbose)
+        g_print ("%s '%s'\n", filename, image_uri);
+      else
+        g_print ("%s\n", filename);
+    }
 
 #if 0
-      switch (foo)
-        {
-        case GIMP_THUMB_STATE_REMOTE:
-          g_print ("%s Remote image '%s'\n", filename, image_uri);
-          break;
+  switch (foo)
+    {
+    case GIMP_THUMB_STATE_REMOTE:
+      g_print ("%s Remote image '%s'\n", filename, image_uri);
+      break;
 
-        case GIMP_THUMB_STATE_FOLDER:
-          g_print ("%s Folder '%s'\n", filename, image_uri);
-          break;
+    case GIMP_THUMB_STATE_FOLDER:
+      g_print ("%s Folder '%s'\n", filename, image_uri);
+      break;
 
-        case GIMP_THUMB_STATE_SPECIAL:
-          g_print ("%s Special file '%s'\n", filename, image_uri);
-          break;
+    case GIMP_THUMB_STATE_SPECIAL:
+      g_print ("%s Special file '%s'\n", filename, image_uri);
+      break;
 
-        case GIMP_THUMB_STATE_NOT_FOUND:
-          g_print ("%s Image not found '%s'\n", filename, image_uri);
-          break;
+    case GIMP_THUMB_STATE_NOT_FOUND:
+      g_print ("%s Image not found '%s'\n", filename, image_uri);
+      break;
 
-        case GIMP_THUMB_STATE_OLD:
-          g_print ("%s Thumbnail old '%s'\n", filename, image_uri);
-          break;
+    case GIMP_THUMB_STATE_OLD:
+      g_print ("%s Thumbnail old '%s'\n", filename, image_uri);
+      break;
 
-        case GIMP_THUMB_STATE_FAILED:
-          g_print ("%s EEEEEEEEK '%s'\n", filename, image_uri);
-          break;
+    case GIMP_THUMB_STATE_FAILED:
+      g_print ("%s EEEEEEEEK '%s'\n", filename, image_uri);
+      break;
 
-        default:
-          g_print ("%s '%s'\n", filename, image_uri);
-          break;
-        }
-#endif
+    default:
+      g_print ("%s '%s'\n", filename, image_uri);
+      break;
     }
+#endif
 
-  g_object_unref (thumbnail);
+  g_free (image_uri);
 }
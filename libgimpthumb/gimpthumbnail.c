@@ -126,6 +126,25 @@ struct _GimpThumbnail
 };
 
 
+typedef struct _GimpThumbnailListCheck GimpThumbnailListCheck;
+typedef struct _GimpThumbnailCheckJob  GimpThumbnailCheckJob;
+
+struct _GimpThumbnailListCheck
+{
+  GTask         *task;
+  GThreadPool   *pool;
+  GimpThumbSize  size;
+  gint           n_pending;
+};
+
+struct _GimpThumbnailCheckJob
+{
+  GimpThumbnailListCheck *check;
+  GimpThumbnail          *thumbnail;
+  GimpThumbnail          *scratch;
+};
+
+
 static void      gimp_thumbnail_finalize     (GObject        *object);
 static void      gimp_thumbnail_set_property (GObject        *object,
                                               guint           property_id,
@@ -147,6 +166,15 @@ static gboolean  gimp_thumbnail_save         (GimpThumbnail  *thumbnail,
                                               GdkPixbuf      *pixbuf,
                                               const gchar    *software,
                                               GError        **error);
+
+static void      gimp_thumbnail_copy_state   (GimpThumbnail  *thumbnail,
+                                              GimpThumbnail  *source);
+
+static void      gimp_thumbnail_list_check_thread (GimpThumbnailCheckJob  *job,
+                                                   GimpThumbnailListCheck *check);
+static gboolean  gimp_thumbnail_list_check_done   (GimpThumbnailCheckJob  *job);
+static void      gimp_thumbnail_list_check_free   (GimpThumbnailListCheck *check);
+
 #ifdef GIMP_THUMB_DEBUG
 static void      gimp_thumbnail_debug_notify (GObject        *object,
                                               GParamSpec     *pspec);
@@ -157,6 +185,8 @@ G_DEFINE_TYPE (GimpThumbnail, gimp_thumbnail, G_TYPE_OBJECT)
 
 #define parent_class gimp_thumbnail_parent_class
 
+#define DEFAULT_MAX_IO 4
+
 
 static void
 gimp_thumbnail_class_init (GimpThumbnailClass *klass)
@@ -1443,3 +1473,200 @@ gimp_thumbnail_has_failed (GimpThumbnail *thumbnail)
 
   return failed;
 }
+
+/**
+ * gimp_thumbnail_list_check_async:
+ * @thumbnails: (element-type GimpThumbnail): a list of #GimpThumbnail objects
+ * @size: the preferred size of the thumbnail images
+ * @max_io: the maximum number of thumbnails checked at the same time,
+ *          or 0 for a default
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): called when all thumbnails are checked
+ * @user_data: data passed to @callback
+ *
+ * Does what gimp_thumbnail_check_thumb() does for each of @thumbnails,
+ * but in worker threads, checking up to @max_io thumbnails at a time,
+ * so that slow file systems don't block the caller.
+ *
+ * Each thumbnail is updated in the thread-default main context of the
+ * caller as soon as it is checked, so its property notifications are
+ * emitted there, and never from a worker thread. The thumbnails must
+ * not be checked, loaded or saved otherwise until @callback is called.
+ *
+ * When @cancellable is cancelled, the thumbnails not checked yet are
+ * left untouched, and gimp_thumbnail_list_check_finish() returns a
+ * %G_IO_ERROR_CANCELLED error.
+ *
+ * Since: 3.2
+ **/
+void
+gimp_thumbnail_list_check_async (GList               *thumbnails,
+                                 GimpThumbSize        size,
+                                 gint                 max_io,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+  GimpThumbnailListCheck *check;
+  GList                  *list;
+
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  check = g_slice_new0 (GimpThumbnailListCheck);
+
+  check->task = g_task_new (NULL, cancellable, callback, user_data);
+  check->size = size;
+
+  g_task_set_source_tag (check->task, gimp_thumbnail_list_check_async);
+
+  check->pool = g_thread_pool_new ((GFunc) gimp_thumbnail_list_check_thread,
+                                   check,
+                                   max_io > 0 ? max_io : DEFAULT_MAX_IO,
+                                   FALSE, NULL);
+
+  /*  hold one job back until all are queued, so that the check can't
+   *  finish while we are still queueing
+   */
+  check->n_pending = 1;
+
+  for (list = thumbnails; list; list = g_list_next (list))
+    {
+      GimpThumbnail         *thumbnail = list->data;
+      GimpThumbnailCheckJob *job;
+
+      if (! GIMP_IS_THUMBNAIL (thumbnail) || ! thumbnail->image_uri)
+        continue;
+
+      job = g_slice_new0 (GimpThumbnailCheckJob);
+
+      job->check     = check;
+      job->thumbnail = g_object_ref (thumbnail);
+
+      /*  the worker checks a private copy, to not emit notifications
+       *  from its thread
+       */
+      job->scratch = gimp_thumbnail_new ();
+      gimp_thumbnail_copy_state (job->scratch, thumbnail);
+
+      check->n_pending++;
+
+      g_thread_pool_push (check->pool, job, NULL);
+    }
+
+  if (--check->n_pending == 0)
+    gimp_thumbnail_list_check_free (check);
+}
+
+/**
+ * gimp_thumbnail_list_check_finish:
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for possible errors
+ *
+ * Finishes a check started with gimp_thumbnail_list_check_async().
+ * The state of each thumbnail is found in its properties.
+ *
+ * Returns: %TRUE if all thumbnails were checked, %FALSE if the check
+ *          was cancelled
+ *
+ * Since: 3.2
+ **/
+gboolean
+gimp_thumbnail_list_check_finish (GAsyncResult  *result,
+                                  GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+static void
+gimp_thumbnail_copy_state (GimpThumbnail *thumbnail,
+                           GimpThumbnail *source)
+{
+  g_object_freeze_notify (G_OBJECT (thumbnail));
+
+  if (g_strcmp0 (thumbnail->image_uri, source->image_uri))
+    {
+      g_free (thumbnail->image_uri);
+      thumbnail->image_uri = g_strdup (source->image_uri);
+
+      g_object_notify (G_OBJECT (thumbnail), "image-uri");
+    }
+
+  g_free (thumbnail->image_filename);
+  thumbnail->image_filename = g_strdup (source->image_filename);
+
+  g_free (thumbnail->thumb_filename);
+  thumbnail->thumb_filename = g_strdup (source->thumb_filename);
+
+  thumbnail->thumb_size     = source->thumb_size;
+  thumbnail->thumb_filesize = source->thumb_filesize;
+  thumbnail->thumb_mtime    = source->thumb_mtime;
+
+  g_object_set (thumbnail,
+                "image-state",           source->image_state,
+                "image-mtime",           source->image_mtime,
+                "image-filesize",        source->image_filesize,
+                "image-mimetype",        source->image_mimetype,
+                "image-width",           source->image_width,
+                "image-height",          source->image_height,
+                "image-type",            source->image_type,
+                "image-num-layers",      source->image_num_layers,
+                "image-not-found-errno", source->image_not_found_errno,
+                "thumb-state",           source->thumb_state,
+                NULL);
+
+  g_object_thaw_notify (G_OBJECT (thumbnail));
+}
+
+static void
+gimp_thumbnail_list_check_thread (GimpThumbnailCheckJob  *job,
+                                  GimpThumbnailListCheck *check)
+{
+  GCancellable *cancellable = g_task_get_cancellable (check->task);
+
+  if (! g_cancellable_is_cancelled (cancellable))
+    gimp_thumbnail_check_thumb (job->scratch, check->size);
+  else
+    g_clear_object (&job->scratch);
+
+  g_main_context_invoke (g_task_get_context (check->task),
+                         (GSourceFunc) gimp_thumbnail_list_check_done,
+                         job);
+}
+
+static gboolean
+gimp_thumbnail_list_check_done (GimpThumbnailCheckJob *job)
+{
+  GimpThumbnailListCheck *check = job->check;
+
+  /*  don't overwrite the thumbnail if another image was set meanwhile  */
+  if (job->scratch &&
+      ! g_strcmp0 (job->thumbnail->image_uri, job->scratch->image_uri))
+    {
+      gimp_thumbnail_copy_state (job->thumbnail, job->scratch);
+    }
+
+  g_clear_object (&job->scratch);
+  g_object_unref (job->thumbnail);
+  g_slice_free (GimpThumbnailCheckJob, job);
+
+  if (--check->n_pending == 0)
+    gimp_thumbnail_list_check_free (check);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gimp_thumbnail_list_check_free (GimpThumbnailListCheck *check)
+{
+  /*  all jobs are done, so the pool's threads are idle  */
+  g_thread_pool_free (check->pool, FALSE, FALSE);
+
+  if (! g_task_return_error_if_cancelled (check->task))
+    g_task_return_boolean (check->task, TRUE);
+
+  g_object_unref (check->task);
+  g_slice_free (GimpThumbnailListCheck, check);
+}
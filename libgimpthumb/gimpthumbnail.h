@@ -76,6 +76,15 @@ void             gimp_thumbnail_delete_others    (GimpThumbnail  *thumbnail,
 
 gboolean         gimp_thumbnail_has_failed       (GimpThumbnail  *thumbnail);
 
+void             gimp_thumbnail_list_check_async  (GList               *thumbnails,
+                                                   GimpThumbSize        size,
+                                                   gint                 max_io,
+                                                   GCancellable        *cancellable,
+                                                   GAsyncReadyCallback  callback,
+                                                   gpointer             user_data);
+gboolean         gimp_thumbnail_list_check_finish (GAsyncResult        *result,
+                                                   GError             **error);
+
 
 G_END_DECLS
 
@@ -42,6 +42,8 @@
 #define REMOVE_BACKDROP_PROC "plug-in-animation-remove-backdrop"
 #define FIND_BACKDROP_PROC   "plug-in-animation-find-backdrop"
 
+#define BAND_HEIGHT          64
+
 
 typedef enum
 {
@@ -60,6 +62,25 @@ typedef enum
 } operatingMode;
 
 
+/* the boxes of the pixels changed from the last frame, found in a band
+ * of rows
+ */
+typedef struct
+{
+  gint32   bbox_top, bbox_bottom, bbox_left, bbox_right;
+  gint32   rbox_top, rbox_bottom, rbox_left, rbox_right;
+  gboolean can_combine;
+} FrameDiff;
+
+typedef struct
+{
+  const guchar *this_frame;
+  const guchar *last_frame;
+  guchar       *opti_frame;
+  FrameDiff    *bands;
+} FrameDiffParams;
+
+
 typedef struct _Optimize      Optimize;
 typedef struct _OptimizeClass OptimizeClass;
 
@@ -480,6 +501,122 @@ compose_row (gint          frame_num,
 }
 
 
+/*  compares rows [y1, y2) of 'this' and 'last' frames, growing the
+ *  band's boxes and making the unchanged pixels of the optimized
+ *  frame transparent
+ */
+static void
+diff_rows (FrameDiffParams *params,
+           FrameDiff       *diff,
+           gint             y1,
+           gint             y2)
+{
+  gint xit, yit, byteit;
+
+  for (yit = y1; yit < y2; yit++)
+    {
+      for (xit = 0; xit < width; xit++)
+        {
+          const guchar *this_pix = params->this_frame +
+                                   (yit * width + xit) * pixelstep;
+          const guchar *last_pix = params->last_frame +
+                                   (yit * width + xit) * pixelstep;
+          gboolean      keep_pix;
+          gboolean      opaq_pix;
+
+          /* Check if 'this' and 'last' are transparent */
+          if (!(this_pix[pixelstep-1]&128) &&
+              !(last_pix[pixelstep-1]&128))
+            {
+              keep_pix = FALSE;
+              opaq_pix = FALSE;
+              goto decided;
+            }
+          /* Check if just 'this' is transparent */
+          if ((last_pix[pixelstep-1]&128) &&
+              !(this_pix[pixelstep-1]&128))
+            {
+              keep_pix = TRUE;
+              opaq_pix = FALSE;
+              diff->can_combine = FALSE;
+              goto decided;
+            }
+          /* Check if just 'last' is transparent */
+          if (!(last_pix[pixelstep-1]&128) &&
+              (this_pix[pixelstep-1]&128))
+            {
+              keep_pix = TRUE;
+              opaq_pix = TRUE;
+              goto decided;
+            }
+          /* If 'last' and 'this' are opaque, we have
+           *  to check if they're the same color - we
+           *  only have to keep the pixel if 'last' or
+           *  'this' are opaque and different.
+           */
+          keep_pix = FALSE;
+          opaq_pix = TRUE;
+          for (byteit=0; byteit<pixelstep-1; byteit++)
+            {
+              if (last_pix[byteit] != this_pix[byteit])
+                {
+                  keep_pix = TRUE;
+                  goto decided;
+                }
+            }
+        decided:
+          if (opaq_pix)
+            {
+              if (xit<diff->rbox_left) diff->rbox_left=xit;
+              if (xit>diff->rbox_right) diff->rbox_right=xit;
+              if (yit<diff->rbox_top) diff->rbox_top=yit;
+              if (yit>diff->rbox_bottom) diff->rbox_bottom=yit;
+            }
+          if (keep_pix)
+            {
+              if (xit<diff->bbox_left) diff->bbox_left=xit;
+              if (xit>diff->bbox_right) diff->bbox_right=xit;
+              if (yit<diff->bbox_top) diff->bbox_top=yit;
+              if (yit>diff->bbox_bottom) diff->bbox_bottom=yit;
+            }
+          else
+            {
+              /* pixel didn't change this frame - make
+               *  it transparent in our optimized buffer!
+               */
+              params->opti_frame[(yit * width + xit) * pixelstep
+                                 + pixelstep-1] = 0;
+            }
+        } /* xit */
+    } /* yit */
+}
+
+static void
+diff_bands (gsize            offset,
+            gsize            size,
+            FrameDiffParams *params)
+{
+  gsize i;
+
+  for (i = offset; i < offset + size; i++)
+    {
+      FrameDiff *diff = &params->bands[i];
+
+      diff->bbox_left   = width;
+      diff->bbox_top    = height;
+      diff->bbox_right  = 0;
+      diff->bbox_bottom = 0;
+      diff->rbox_left   = width;
+      diff->rbox_top    = height;
+      diff->rbox_right  = 0;
+      diff->rbox_bottom = 0;
+      diff->can_combine = TRUE;
+
+      diff_rows (params, diff,
+                 i * BAND_HEIGHT, MIN ((i + 1) * BAND_HEIGHT, height));
+    }
+}
+
 static GimpImage *
 do_optimizations (GimpRunMode  run_mode,
                   GimpImage   *image,
@@ -827,13 +964,30 @@ do_optimizations (GimpRunMode  run_mode,
               && (opmode == OPOPTIMIZE)
               )
             {
-              gint xit, yit, byteit;
-
-              can_combine = TRUE;
+              FrameDiffParams params;
+              gint            n_bands;
+              gint            xit, yit, byteit;
 
               /*
                * SEARCH FOR BOUNDING BOX
+               *
+               * The rows are compared in parallel bands, each finding
+               * its own boxes, which are then merged.
                */
+              n_bands = (height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+
+              params.this_frame = this_frame;
+              params.last_frame = last_frame;
+              params.opti_frame = opti_frame;
+              params.bands      = g_new (FrameDiff, n_bands);
+
+              gegl_parallel_distribute_range (
+                n_bands, 1,
+                (GeglParallelDistributeRangeFunc) diff_bands,
+                &params);
+
+              can_combine = TRUE;
+
               bbox_left   = width;
               bbox_top    = height;
               bbox_right  = 0;
@@ -843,92 +997,23 @@ do_optimizations (GimpRunMode  run_mode,
               rbox_right  = 0;
               rbox_bottom = 0;
 
-              for (yit=0; yit<height; yit++)
+              for (gint i = 0; i < n_bands; i++)
                 {
-                  for (xit=0; xit<width; xit++)
-                    {
-                      gboolean keep_pix;
-                      gboolean opaq_pix;
-
-                      /* Check if 'this' and 'last' are transparent */
-                      if (!(this_frame[yit*width*pixelstep + xit*pixelstep
-                                      + pixelstep-1]&128)
-                          &&
-                          !(last_frame[yit*width*pixelstep + xit*pixelstep
-                                      + pixelstep-1]&128))
-                        {
-                          keep_pix = FALSE;
-                          opaq_pix = FALSE;
-                          goto decided;
-                        }
-                      /* Check if just 'this' is transparent */
-                      if ((last_frame[yit*width*pixelstep + xit*pixelstep
-                                     + pixelstep-1]&128)
-                          &&
-                          !(this_frame[yit*width*pixelstep + xit*pixelstep
-                                      + pixelstep-1]&128))
-                        {
-                          keep_pix = TRUE;
-                          opaq_pix = FALSE;
-                          can_combine = FALSE;
-                          goto decided;
-                        }
-                      /* Check if just 'last' is transparent */
-                      if (!(last_frame[yit*width*pixelstep + xit*pixelstep
-                                      + pixelstep-1]&128)
-                          &&
-                          (this_frame[yit*width*pixelstep + xit*pixelstep
-                                     + pixelstep-1]&128))
-                        {
-                          keep_pix = TRUE;
-                          opaq_pix = TRUE;
-                          goto decided;
-                        }
-                      /* If 'last' and 'this' are opaque, we have
-                       *  to check if they're the same color - we
-                       *  only have to keep the pixel if 'last' or
-                       *  'this' are opaque and different.
-                       */
-                      keep_pix = FALSE;
-                      opaq_pix = TRUE;
-                      for (byteit=0; byteit<pixelstep-1; byteit++)
-                        {
-                          if ((last_frame[yit*width*pixelstep + xit*pixelstep
-                                         + byteit]
-                               !=
-                               this_frame[yit*width*pixelstep + xit*pixelstep
-                                         + byteit])
-                              )
-                            {
-                              keep_pix = TRUE;
-                              goto decided;
-                            }
-                        }
-                    decided:
-                      if (opaq_pix)
-                        {
-                          if (xit<rbox_left) rbox_left=xit;
-                          if (xit>rbox_right) rbox_right=xit;
-                          if (yit<rbox_top) rbox_top=yit;
-                          if (yit>rbox_bottom) rbox_bottom=yit;
-                        }
-                      if (keep_pix)
-                        {
-                          if (xit<bbox_left) bbox_left=xit;
-                          if (xit>bbox_right) bbox_right=xit;
-                          if (yit<bbox_top) bbox_top=yit;
-                          if (yit>bbox_bottom) bbox_bottom=yit;
-                        }
-                      else
-                        {
-                          /* pixel didn't change this frame - make
-                           *  it transparent in our optimized buffer!
-                           */
-                          opti_frame[yit*width*pixelstep + xit*pixelstep
-                                    + pixelstep-1] = 0;
-                        }
-                    } /* xit */
-                } /* yit */
+                  FrameDiff *band = &params.bands[i];
+
+                  can_combine = can_combine && band->can_combine;
+
+                  bbox_left   = MIN (bbox_left,   band->bbox_left);
+                  bbox_top    = MIN (bbox_top,    band->bbox_top);
+                  bbox_right  = MAX (bbox_right,  band->bbox_right);
+                  bbox_bottom = MAX (bbox_bottom, band->bbox_bottom);
+                  rbox_left   = MIN (rbox_left,   band->rbox_left);
+                  rbox_top    = MIN (rbox_top,    band->rbox_top);
+                  rbox_right  = MAX (rbox_right,  band->rbox_right);
+                  rbox_bottom = MAX (rbox_bottom, band->rbox_bottom);
+                }
+
+              g_free (params.bands);
 
               if (!can_combine)
                 {
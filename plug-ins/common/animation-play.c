@@ -46,6 +46,9 @@
 #define PLUG_IN_ROLE   "gimp-animation-play"
 #define DITHERTYPE     GDK_RGB_DITHER_NORMAL
 
+/* memory budget of the rendered frames, in bytes */
+#define FRAME_CACHE_SIZE (256 << 20)
+
 
 typedef enum
 {
@@ -67,6 +70,23 @@ typedef struct
   gint x, y;
 } CursorOffset;
 
+/* the frames rendered at the drawing area size, so that playback only
+ * has to paint them
+ */
+typedef struct
+{
+  cairo_surface_t **surfaces;
+  gint32            n_surfaces;
+  gsize             size;
+  gboolean          full;
+
+  guint             width;
+  guint             height;
+  gdouble           scale;
+
+  guint             idle_id;
+} FrameCache;
+
 struct _GimpPlay
 {
   GimpPlugIn      parent_instance;
@@ -179,6 +199,20 @@ static gboolean    repaint_da                (GtkWidget       *darea,
 
 static void        init_frames               (GimpPlay        *play);
 static void        render_frame              (gint32           whichframe);
+static cairo_surface_t *
+                   create_frame_surface      (gint32           whichframe,
+                                              guint            drawing_width,
+                                              guint            drawing_height,
+                                              gdouble          drawing_scale);
+static void        frame_cache_clear         (void);
+static cairo_surface_t *
+                   frame_cache_get           (gint32           whichframe,
+                                              guint            drawing_width,
+                                              guint            drawing_height,
+                                              gdouble          drawing_scale);
+static gboolean    frame_cache_add           (gint32           whichframe,
+                                              cairo_surface_t *surface);
+static gboolean    frame_cache_prerender     (gpointer         data);
 static void        show_frame                (void);
 static void        update_combobox           (void);
 static gdouble     get_duration_factor       (gint             index);
@@ -241,6 +275,7 @@ static gint32             total_frames              = 0;
 static GimpLayer        **frames                    = NULL;
 static guint32           *frame_durations           = NULL;
 static guint              frame_number              = 0;
+static FrameCache         frame_cache               = { 0, };
 
 static gboolean           playing                   = FALSE;
 static guint              timer                     = 0;
@@ -1042,6 +1077,8 @@ init_frames (GimpPlay *play)
   total_frames = g_list_length (layers);
 
   /* Cleanup before re-generation. */
+  frame_cache_clear ();
+
   if (frames)
     {
       gimp_image_delete (frames_image);
@@ -1174,7 +1211,6 @@ on_app_activate (GApplication *gapp,
 static void
 render_frame (gint32 whichframe)
 {
-  GeglBuffer       *buffer;
   GtkWidget        *da;
   cairo_surface_t **drawing_surface;
   guint             drawing_width, drawing_height;
@@ -1199,31 +1235,180 @@ render_frame (gint32 whichframe)
       drawing_scale   = scale;
     }
 
-  buffer = gimp_drawable_get_buffer (GIMP_DRAWABLE (frames[whichframe]));
-
   if (*drawing_surface)
     cairo_surface_destroy (*drawing_surface);
 
-  *drawing_surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
-                                                 drawing_width,
-                                                 drawing_height);
+  *drawing_surface = frame_cache_get (whichframe,
+                                      drawing_width, drawing_height,
+                                      drawing_scale);
 
-  cairo_surface_flush (*drawing_surface);
+  /* Display the preview buffer. */
+  gtk_widget_queue_draw (da);
+}
+
+static cairo_surface_t *
+create_frame_surface (gint32  whichframe,
+                      guint   drawing_width,
+                      guint   drawing_height,
+                      gdouble drawing_scale)
+{
+  GeglBuffer      *buffer;
+  cairo_surface_t *surface;
+
+  buffer = gimp_drawable_get_buffer (GIMP_DRAWABLE (frames[whichframe]));
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                        drawing_width,
+                                        drawing_height);
+
+  cairo_surface_flush (surface);
 
   /* Fetch and scale the whole raw new frame */
   gegl_buffer_get (buffer, GEGL_RECTANGLE (0, 0, drawing_width, drawing_height),
                    drawing_scale, babl_format ("cairo-ARGB32"),
-                   cairo_image_surface_get_data (*drawing_surface),
-                   cairo_image_surface_get_stride (*drawing_surface),
+                   cairo_image_surface_get_data (surface),
+                   cairo_image_surface_get_stride (surface),
                    GEGL_ABYSS_CLAMP);
 
-  cairo_surface_mark_dirty (*drawing_surface);
-
-  /* Display the preview buffer. */
-  gtk_widget_queue_draw (da);
+  cairo_surface_mark_dirty (surface);
 
   /* clean up */
   g_object_unref (buffer);
+
+  return surface;
+}
+
+/* Frame cache */
+
+static void
+frame_cache_clear (void)
+{
+  gint32 i;
+
+  if (frame_cache.idle_id)
+    g_source_remove (frame_cache.idle_id);
+
+  for (i = 0; i < frame_cache.n_surfaces; i++)
+    {
+      if (frame_cache.surfaces[i])
+        cairo_surface_destroy (frame_cache.surfaces[i]);
+    }
+
+  g_free (frame_cache.surfaces);
+
+  memset (&frame_cache, 0, sizeof (FrameCache));
+}
+
+/*
+ * Returns a new reference to the frame rendered at the drawing size,
+ * from the cache when possible. The cache is dropped whenever the
+ * drawing size changes, and the remaining frames are then rendered in
+ * the background, as long as they fit in the memory budget.
+ */
+static cairo_surface_t *
+frame_cache_get (gint32  whichframe,
+                 guint   drawing_width,
+                 guint   drawing_height,
+                 gdouble drawing_scale)
+{
+  cairo_surface_t *surface;
+
+  if (frame_cache.n_surfaces != total_frames  ||
+      frame_cache.width      != drawing_width  ||
+      frame_cache.height     != drawing_height ||
+      frame_cache.scale      != drawing_scale)
+    {
+      frame_cache_clear ();
+
+      frame_cache.surfaces   = g_new0 (cairo_surface_t *, total_frames);
+      frame_cache.n_surfaces = total_frames;
+      frame_cache.width      = drawing_width;
+      frame_cache.height     = drawing_height;
+      frame_cache.scale      = drawing_scale;
+    }
+
+  if (frame_cache.surfaces[whichframe])
+    {
+      surface = cairo_surface_reference (frame_cache.surfaces[whichframe]);
+    }
+  else
+    {
+      surface = create_frame_surface (whichframe,
+                                      drawing_width, drawing_height,
+                                      drawing_scale);
+
+      frame_cache_add (whichframe, surface);
+    }
+
+  if (! frame_cache.full && ! frame_cache.idle_id)
+    frame_cache.idle_id = g_idle_add_full (G_PRIORITY_LOW,
+                                           frame_cache_prerender,
+                                           NULL, NULL);
+
+  return surface;
+}
+
+static gboolean
+frame_cache_add (gint32           whichframe,
+                 cairo_surface_t *surface)
+{
+  gsize size;
+
+  size = (gsize) cairo_image_surface_get_stride (surface) *
+         cairo_image_surface_get_height (surface);
+
+  if (frame_cache.size + size > FRAME_CACHE_SIZE)
+    {
+      frame_cache.full = TRUE;
+
+      return FALSE;
+    }
+
+  frame_cache.surfaces[whichframe] = cairo_surface_reference (surface);
+  frame_cache.size += size;
+
+  return TRUE;
+}
+
+/*
+ * Renders one missing frame per idle call, starting with the ones
+ * coming next in playback order, so that playback and redraws always
+ * take precedence. GIMP's procedures can't be called from another
+ * thread, hence the idle rather than a worker thread.
+ */
+static gboolean
+frame_cache_prerender (gpointer data)
+{
+  gint32 i;
+
+  for (i = 1; i < frame_cache.n_surfaces; i++)
+    {
+      gint32 whichframe = (frame_number + i) % frame_cache.n_surfaces;
+
+      if (! frame_cache.surfaces[whichframe])
+        {
+          cairo_surface_t *surface;
+          gboolean         added;
+
+          surface = create_frame_surface (whichframe,
+                                          frame_cache.width,
+                                          frame_cache.height,
+                                          frame_cache.scale);
+
+          added = frame_cache_add (whichframe, surface);
+
+          cairo_surface_destroy (surface);
+
+          if (! added)
+            break;
+
+          return G_SOURCE_CONTINUE;
+        }
+    }
+
+  frame_cache.idle_id = 0;
+
+  return G_SOURCE_REMOVE;
 }
 
 static void
@@ -1280,6 +1465,8 @@ window_destroy (GtkWidget *widget,
   if (playing)
     remove_timer ();
 
+  frame_cache_clear ();
+
   if (shape_window)
     gtk_widget_destroy (GTK_WIDGET (shape_window));
 
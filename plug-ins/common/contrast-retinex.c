@@ -59,6 +59,25 @@ typedef struct
   gdouble b[4];
 } gauss3_coefs;
 
+typedef struct
+{
+  gfloat       *in;
+  gfloat       *out;
+  gint          width;
+  gint          height;
+  gauss3_coefs *coef;
+} RetinexSmooth;
+
+typedef struct
+{
+  guchar       *src;
+  gfloat       *dst;
+  const gfloat *out;
+  gint          bytes;
+  gint          channel;
+  gfloat        weight;
+} RetinexPixels;
+
 
 typedef struct _Retinex      Retinex;
 typedef struct _RetinexClass RetinexClass;
@@ -119,6 +138,19 @@ static void     gausssmooth                 (gfloat       *in,
                                              gint          rowtride,
                                              gauss3_coefs *c);
 
+static void     smooth_rows                 (gsize          offset,
+                                             gsize          size,
+                                             RetinexSmooth *smooth);
+static void     smooth_cols                 (gsize          offset,
+                                             gsize          size,
+                                             RetinexSmooth *smooth);
+static void     accumulate_pixels           (gsize          offset,
+                                             gsize          size,
+                                             RetinexPixels *pixels);
+static void     restore_pixels              (gsize          offset,
+                                             gsize          size,
+                                             RetinexPixels *pixels);
+
 
 /*
  * MSRCR = MultiScale Retinex with Color Restoration
@@ -598,6 +630,81 @@ gausssmooth (gfloat *in, gfloat *out, gint size, gint rowstride, gauss3_coefs *c
   g_free (w2);
 }
 
+/*
+ * The passes below are spread over all threads.  Rows, columns and
+ * pixels are all independent of each other.
+ */
+static void
+smooth_rows (gsize          offset,
+             gsize          size,
+             RetinexSmooth *smooth)
+{
+  gsize row;
+
+  for (row = offset; row < offset + size; row++)
+    {
+      gsize pos = row * smooth->width;
+
+      gausssmooth (smooth->in + pos, smooth->out + pos,
+                   smooth->width, 1, smooth->coef);
+    }
+}
+
+static void
+smooth_cols (gsize          offset,
+             gsize          size,
+             RetinexSmooth *smooth)
+{
+  gsize col;
+
+  for (col = offset; col < offset + size; col++)
+    {
+      gausssmooth (smooth->in + col, smooth->out + col,
+                   smooth->height, smooth->width, smooth->coef);
+    }
+}
+
+static void
+accumulate_pixels (gsize          offset,
+                   gsize          size,
+                   RetinexPixels *pixels)
+{
+  gsize i;
+  gsize pos;
+
+  for (i = offset, pos = offset * pixels->bytes + pixels->channel;
+       i < offset + size;
+       i++, pos += pixels->bytes)
+    {
+      pixels->dst[pos] += pixels->weight * (log (pixels->src[pos] + 1.) -
+                                            log (pixels->out[i]));
+    }
+}
+
+static void
+restore_pixels (gsize          offset,
+                gsize          size,
+                RetinexPixels *pixels)
+{
+  const gfloat alpha = 128.;
+  const gfloat gain  = 1.;
+  const gfloat shift = 0.;
+  gsize        i;
+
+  for (i = offset; i < offset + size; i++)
+    {
+      guchar *psrc = pixels->src + i * pixels->bytes;
+      gfloat *pdst = pixels->dst + i * pixels->bytes;
+      gfloat  logl;
+
+      logl = log((gfloat)psrc[0] + (gfloat)psrc[1] + (gfloat)psrc[2] + 3.);
+
+      pdst[0] = gain * ((log(alpha * (psrc[0]+1.)) - logl) * pdst[0]) + shift;
+      pdst[1] = gain * ((log(alpha * (psrc[1]+1.)) - logl) * pdst[1]) + shift;
+      pdst[2] = gain * ((log(alpha * (psrc[2]+1.)) - logl) * pdst[2]) + shift;
+    }
+}
+
 /*
  * This function is the heart of the algo.
  * (a)  Filterings at several scales and sumarize the results.
@@ -612,7 +719,7 @@ MSRCR (GObject *config,
        gboolean preview_mode)
 {
 
-  gint          scale,row,col;
+  gint          scale;
   gint          i,j;
   gint          size;
   gint          channel;
@@ -623,11 +730,10 @@ MSRCR (GObject *config,
   gint          channelsize;            /* Float memory cache for one channel */
   gfloat        weight;
   gauss3_coefs  coef;
+  RetinexSmooth smooth;
+  RetinexPixels pixels;
   gfloat        mean, var;
   gfloat        mini, range, maxi;
-  gfloat        alpha;
-  gfloat        gain;
-  gfloat        offset;
   gdouble       max_preview = 0.0;
   gint          scales_mode;
   gint          config_scale;
@@ -692,6 +798,16 @@ MSRCR (GObject *config,
   */
   weight = 1./ (gfloat) nscales;
 
+  smooth.width  = width;
+  smooth.height = height;
+  smooth.coef   = &coef;
+
+  pixels.src    = src;
+  pixels.dst    = dst;
+  pixels.out    = out;
+  pixels.bytes  = bytes;
+  pixels.weight = weight;
+
   /*
     The recursive filtering algorithm needs different coefficients according
     to the selected scale (~ = standard deviation of Gaussian).
@@ -713,11 +829,13 @@ MSRCR (GObject *config,
            *
            *  Filter rows first
            */
-          for (row=0 ;row < height; row++)
-            {
-              pos =  row * width;
-              gausssmooth (in + pos, out + pos, width, 1, &coef);
-            }
+          smooth.in  = in;
+          smooth.out = out;
+
+          gegl_parallel_distribute_range (
+            height, 16,
+            (GeglParallelDistributeRangeFunc) smooth_rows,
+            &smooth);
 
           memcpy(in,  out, channelsize * sizeof(gfloat));
           memset(out, 0  , channelsize * sizeof(gfloat));
@@ -727,20 +845,21 @@ MSRCR (GObject *config,
            *
            *  Second columns
            */
-          for (col=0; col < width; col++)
-            {
-              pos = col;
-              gausssmooth(in + pos, out + pos, height, width, &coef);
-            }
+          gegl_parallel_distribute_range (
+            width, 16,
+            (GeglParallelDistributeRangeFunc) smooth_cols,
+            &smooth);
 
           /*
              Summarize the filtered values.
              In fact one calculates a ratio between the original values and the filtered values.
            */
-          for (i = 0, pos = channel; i < channelsize; i++, pos += bytes)
-            {
-              dst[pos] += weight * (log (src[pos] + 1.) - log (out[i]));
-            }
+          pixels.channel = channel;
+
+          gegl_parallel_distribute_range (
+            channelsize, 4096,
+            (GeglParallelDistributeRangeFunc) accumulate_pixels,
+            &pixels);
 
            if (!preview_mode)
              gimp_progress_update ((channel * nscales + scale) /
@@ -756,23 +875,10 @@ MSRCR (GObject *config,
   */
   /* Ci(x,y)=log[a Ii(x,y)]-log[ Ei=1-s Ii(x,y)] */
 
-  alpha  = 128.;
-  gain   = 1.;
-  offset = 0.;
-
-  for (i = 0; i < size; i += bytes)
-    {
-      gfloat logl;
-
-      psrc = src+i;
-      pdst = dst+i;
-
-      logl = log((gfloat)psrc[0] + (gfloat)psrc[1] + (gfloat)psrc[2] + 3.);
-
-      pdst[0] = gain * ((log(alpha * (psrc[0]+1.)) - logl) * pdst[0]) + offset;
-      pdst[1] = gain * ((log(alpha * (psrc[1]+1.)) - logl) * pdst[1]) + offset;
-      pdst[2] = gain * ((log(alpha * (psrc[2]+1.)) - logl) * pdst[2]) + offset;
-    }
+  gegl_parallel_distribute_range (
+    channelsize, 4096,
+    (GeglParallelDistributeRangeFunc) restore_pixels,
+    &pixels);
 
 /*  if (!preview_mode)
     gimp_progress_update ((2.0 + (nscales * 3)) /
@@ -49,6 +49,12 @@
 /* List that stores pixels falling in to the same luma bucket */
 #define MAX_LIST_ELEMS   SQR(2 * MAX_RADIUS + 1)
 
+/* Rows filtered by a single thread at a time, and between progress
+ * updates, when the filter isn't recursive
+ */
+#define BAND_HEIGHT       32
+#define STEP_HEIGHT      (8 * BAND_HEIGHT)
+
 
 typedef struct
 {
@@ -65,8 +71,31 @@ typedef struct
   gint       ymin;
   gint       xmax;
   gint       ymax; /* Source rect */
+
+  /* Number of pixels in actual histogram falling into each category */
+  gint       hist0;    /* Less than min threshold */
+  gint       hist255;  /* More than max threshold */
+  gint       histrest; /* From min to max        */
+
+  gint       adapt_radius;
+  GRand     *rand;
 } DespeckleHistogram;
 
+typedef struct
+{
+  guchar *src;
+  guchar *dst;
+  gint    width;
+  gint    height;
+  gint    bpp;
+  gint    radius;
+  gint    filter_type;
+  gint    black_level;
+  gint    white_level;
+  gint    y;          /* First row of the current step */
+  gint    y_end;      /* End of the current step       */
+} DespeckleParams;
+
 
 typedef struct _Despeckle      Despeckle;
 typedef struct _DespeckleClass DespeckleClass;
@@ -123,14 +152,6 @@ GIMP_MAIN (DESPECKLE_TYPE)
 DEFINE_STD_SET_I18N
 
 
-/* Number of pixels in actual histogram falling into each category */
-static gint                hist0;    /* Less than min threshold */
-static gint                hist255;  /* More than max threshold */
-static gint                histrest; /* From min to max        */
-
-static DespeckleHistogram  histogram;
-
-
 static void
 despeckle_class_init (DespeckleClass *klass)
 {
@@ -538,9 +559,10 @@ list_del_elem (PixelsList* list)
 }
 
 static inline const guchar *
-list_get_random_elem (PixelsList *list)
+list_get_random_elem (PixelsList *list,
+                      GRand      *rand)
 {
-  const gint pos = list->start + rand () % list->count;
+  const gint pos = list->start + g_rand_int_range (rand, 0, list->count);
 
   if (pos >= MAX_LIST_ELEMS)
     return list->elems[pos - MAX_LIST_ELEMS];
@@ -581,7 +603,7 @@ static inline const guchar *
 histogram_get_median (DespeckleHistogram *hist,
                       const guchar       *_default)
 {
-  gint count = histrest;
+  gint count = hist->histrest;
   gint i;
   gint sum = 0;
 
@@ -594,7 +616,7 @@ histogram_get_median (DespeckleHistogram *hist,
   while ((sum += hist->elems[i]) < count)
     i++;
 
-  return list_get_random_elem (&hist->origs[i]);
+  return list_get_random_elem (&hist->origs[i], hist->rand);
 }
 
 static inline void
@@ -613,15 +635,15 @@ add_val (DespeckleHistogram *hist,
   if (value > black_level && value < white_level)
     {
       histogram_add (hist, value, src + pos);
-      histrest++;
+      hist->histrest++;
     }
   else
     {
       if (value <= black_level)
-        hist0++;
+        hist->hist0++;
 
       if (value >= white_level)
-        hist255++;
+        hist->hist255++;
     }
 }
 
@@ -641,15 +663,15 @@ del_val (DespeckleHistogram *hist,
   if (value > black_level && value < white_level)
     {
       histogram_remove (hist, value);
-      histrest--;
+      hist->histrest--;
     }
   else
     {
       if (value <= black_level)
-        hist0--;
+        hist->hist0--;
 
       if (value >= white_level)
-        hist255--;
+        hist->hist255--;
     }
 }
 
@@ -753,91 +775,75 @@ update_histogram (DespeckleHistogram *hist,
   hist->ymax = ymax;
 }
 
+/* Filters the rows from 'y1' to 'y2' of the image, using 'hist' */
 static void
-despeckle_median (GObject  *config,
-                  guchar   *src,
-                  guchar   *dst,
-                  gint      width,
-                  gint      height,
-                  gint      bpp,
-                  gboolean  preview)
+despeckle_rows (const DespeckleParams *params,
+                DespeckleHistogram    *hist,
+                gint                   y1,
+                gint                   y2)
 {
-  gint   radius;
-  gint   filter_type;
-  gint   black_level;
-  gint   white_level;
-  guint  progress;
-  guint  max_progress;
-  gint   x, y;
-  gint   adapt_radius;
-  gint   pos;
-  gint   ymin;
-  gint   ymax;
-  gint   xmin;
-  gint   xmax;
-
-  g_object_get (config,
-                "radius", &radius,
-                "black",  &black_level,
-                "white",  &white_level,
-                NULL);
-  filter_type = gimp_procedure_config_get_choice_id (GIMP_PROCEDURE_CONFIG (config),
-                                                     "type");
-
-  memset (&histogram, 0, sizeof(histogram));
-  progress     = 0;
-  max_progress = width * height;
-
-  if (! preview)
-    gimp_progress_init (_("Despeckle"));
+  guchar     *src         = params->src;
+  guchar     *dst         = params->dst;
+  const gint  width       = params->width;
+  const gint  height      = params->height;
+  const gint  bpp         = params->bpp;
+  const gint  radius      = params->radius;
+  const gint  filter_type = params->filter_type;
+  const gint  black_level = params->black_level;
+  const gint  white_level = params->white_level;
+  gint        x, y;
+  gint        pos;
+  gint        ymin;
+  gint        ymax;
+  gint        xmin;
+  gint        xmax;
 
-  adapt_radius = radius;
-  for (y = 0; y < height; y++)
+  for (y = y1; y < y2; y++)
     {
       x = 0;
-      ymin = MAX (0, y - adapt_radius);
-      ymax = MIN (height - 1, y + adapt_radius);
-      xmin = MAX (0, x - adapt_radius);
-      xmax = MIN (width - 1, x + adapt_radius);
-      hist0   = 0;
-      histrest = 0;
-      hist255 = 0;
-      histogram_clean (&histogram);
-      histogram.xmin = xmin;
-      histogram.ymin = ymin;
-      histogram.xmax = xmax;
-      histogram.ymax = ymax;
-      add_vals (&histogram,
+      ymin = MAX (0, y - hist->adapt_radius);
+      ymax = MIN (height - 1, y + hist->adapt_radius);
+      xmin = MAX (0, x - hist->adapt_radius);
+      xmax = MIN (width - 1, x + hist->adapt_radius);
+      hist->hist0    = 0;
+      hist->histrest = 0;
+      hist->hist255  = 0;
+      histogram_clean (hist);
+      hist->xmin = xmin;
+      hist->ymin = ymin;
+      hist->xmax = xmax;
+      hist->ymax = ymax;
+      add_vals (hist,
                 black_level, white_level,
                 src, width, bpp,
-                histogram.xmin, histogram.ymin,
-                histogram.xmax, histogram.ymax);
+                hist->xmin, hist->ymin,
+                hist->xmax, hist->ymax);
 
       for (x = 0; x < width; x++)
         {
           const guchar *pixel;
 
-          ymin = MAX (0, y - adapt_radius); /* update ymin, ymax when adapt_radius changed (FILTER_ADAPTIVE) */
-          ymax = MIN (height - 1, y + adapt_radius);
-          xmin = MAX (0, x - adapt_radius);
-          xmax = MIN (width - 1, x + adapt_radius);
+          ymin = MAX (0, y - hist->adapt_radius); /* update ymin, ymax when adapt_radius changed (FILTER_ADAPTIVE) */
+          ymax = MIN (height - 1, y + hist->adapt_radius);
+          xmin = MAX (0, x - hist->adapt_radius);
+          xmax = MIN (width - 1, x + hist->adapt_radius);
 
-          update_histogram (&histogram,
+          update_histogram (hist,
                             black_level, white_level,
                             src, width, bpp, xmin, ymin, xmax, ymax);
 
           pos = (x + (y * width)) * bpp;
-          pixel = histogram_get_median (&histogram, src + pos);
+          pixel = histogram_get_median (hist, src + pos);
 
           if (filter_type & FILTER_RECURSIVE)
             {
-              del_val (&histogram,
+              del_val (hist,
                        black_level, white_level,
                        src, width, bpp, x, y);
 
               pixel_copy (src + pos, pixel, bpp);
 
-              add_val (&histogram,
+              add_val (hist,
                        black_level, white_level,
                        src, width, bpp, x, y);
             }
@@ -849,22 +855,115 @@ despeckle_median (GObject  *config,
            */
           if (filter_type & FILTER_ADAPTIVE)
             {
-              if (hist0 >= adapt_radius || hist255 >= adapt_radius)
+              if (hist->hist0 >= hist->adapt_radius ||
+                  hist->hist255 >= hist->adapt_radius)
                 {
-                  if (adapt_radius < radius)
-                    adapt_radius++;
+                  if (hist->adapt_radius < radius)
+                    hist->adapt_radius++;
                 }
-              else if (adapt_radius > 1)
+              else if (hist->adapt_radius > 1)
                 {
-                  adapt_radius--;
+                  hist->adapt_radius--;
                 }
             }
         }
+    }
+}
 
-      progress += width;
+/* Filters the bands from 'offset' to 'offset + size' of the current
+ * step.  Each band starts from scratch, with its own random sequence,
+ * so the result doesn't depend on the number of threads.
+ */
+static void
+despeckle_bands (gsize                  offset,
+                 gsize                  size,
+                 const DespeckleParams *params)
+{
+  DespeckleHistogram *hist = g_new0 (DespeckleHistogram, 1);
+  gsize               i;
+
+  for (i = offset; i < offset + size; i++)
+    {
+      gint y1 = params->y + i * BAND_HEIGHT;
+      gint y2 = MIN (y1 + BAND_HEIGHT, params->y_end);
+
+      hist->adapt_radius = params->radius;
+      hist->rand         = g_rand_new_with_seed (y1);
+
+      despeckle_rows (params, hist, y1, y2);
+
+      g_rand_free (hist->rand);
+    }
 
-      if (! preview && y % 32 == 0)
-        gimp_progress_update ((gdouble) progress / (gdouble) max_progress);
+  g_free (hist);
+}
+
+static void
+despeckle_median (GObject  *config,
+                  guchar   *src,
+                  guchar   *dst,
+                  gint      width,
+                  gint      height,
+                  gint      bpp,
+                  gboolean  preview)
+{
+  DespeckleParams     params;
+  DespeckleHistogram *hist = NULL;
+
+  params.src    = src;
+  params.dst    = dst;
+  params.width  = width;
+  params.height = height;
+  params.bpp    = bpp;
+
+  g_object_get (config,
+                "radius", &params.radius,
+                "black",  &params.black_level,
+                "white",  &params.white_level,
+                NULL);
+  params.filter_type = gimp_procedure_config_get_choice_id (GIMP_PROCEDURE_CONFIG (config),
+                                                            "type");
+
+  if (! preview)
+    gimp_progress_init (_("Despeckle"));
+
+  /* The recursive filter writes its result back into the source, so each
+   * pixel depends on all of the previous ones, and the image has to be
+   * filtered in one go.  Otherwise, rows only depend on the source, and
+   * the image is split into bands filtered in parallel.
+   */
+  if (params.filter_type & FILTER_RECURSIVE)
+    {
+      hist = g_new0 (DespeckleHistogram, 1);
+
+      hist->adapt_radius = params.radius;
+      hist->rand         = g_rand_new_with_seed (0);
+    }
+
+  for (params.y = 0; params.y < height; params.y = params.y_end)
+    {
+      params.y_end = MIN (params.y + STEP_HEIGHT, height);
+
+      if (hist)
+        {
+          despeckle_rows (&params, hist, params.y, params.y_end);
+        }
+      else
+        {
+          gegl_parallel_distribute_range (
+            (params.y_end - params.y + BAND_HEIGHT - 1) / BAND_HEIGHT, 1,
+            (GeglParallelDistributeRangeFunc) despeckle_bands,
+            &params);
+        }
+
+      if (! preview)
+        gimp_progress_update ((gdouble) params.y_end / (gdouble) height);
+    }
+
+  if (hist)
+    {
+      g_rand_free (hist->rand);
+      g_free (hist);
     }
 
   if (! preview)
@@ -33,6 +33,7 @@
 #define LOAD_PROC_AV1    "file-heif-av1-load"
 #define LOAD_PROC_HEJ2   "file-heif-hej2-load"
 #define LOAD_PROC_AVCI   "file-heif-avci-load"
+#define LOAD_THUMB_PROC  "file-heif-load-thumb"
 #define EXPORT_PROC      "file-heif-export"
 #define EXPORT_PROC_AV1  "file-heif-av1-export"
 #define EXPORT_PROC_HEJ2 "file-heif-hej2-export"
@@ -83,6 +84,11 @@ static GimpValueArray * heif_load             (GimpProcedure                *pro
                                                GimpMetadataLoadFlags        *flags,
                                                GimpProcedureConfig          *config,
                                                gpointer                      run_data);
+static GimpValueArray * heif_load_thumb       (GimpProcedure                *procedure,
+                                               GFile                        *file,
+                                               gint                          size,
+                                               GimpProcedureConfig          *config,
+                                               gpointer                      run_data);
 static GimpValueArray * heif_export           (GimpProcedure                *procedure,
                                                GimpRunMode                   run_mode,
                                                GimpImage                    *image,
@@ -118,6 +124,12 @@ static GimpImage      * load_image            (GFile                        *fil
                                                gboolean                      interactive,
                                                GimpPDBStatusType            *status,
                                                GError                      **error);
+static GimpImage      * load_thumbnail_image  (GFile                        *file,
+                                               gint                          size,
+                                               gint                         *width,
+                                               gint                         *height,
+                                               GimpImageType                *type,
+                                               GError                      **error);
 static gboolean         export_image          (GFile                        *file,
                                                GimpImage                    *image,
                                                GimpDrawable                 *drawable,
@@ -202,6 +214,15 @@ heif_init_procedures (GimpPlugIn *plug_in)
     }
 #endif
 
+  /*  all the loaders share a thumbnail procedure  */
+  if (g_list_find_custom (list, LOAD_PROC,      (GCompareFunc) strcmp) ||
+      g_list_find_custom (list, LOAD_PROC_AV1,  (GCompareFunc) strcmp) ||
+      g_list_find_custom (list, LOAD_PROC_HEJ2, (GCompareFunc) strcmp) ||
+      g_list_find_custom (list, LOAD_PROC_AVCI, (GCompareFunc) strcmp))
+    {
+      list = g_list_append (list, g_strdup (LOAD_THUMB_PROC));
+    }
+
   heif_deinit ();
 
   return list;
@@ -250,6 +271,27 @@ heif_create_procedure (GimpPlugIn  *plug_in,
                                       "4,string,ftypheis,4,string,ftyphevm,"
                                       "4,string,ftyphevs,4,string,ftypmif1,"
                                       "4,string,ftypmsf1");
+
+      gimp_load_procedure_set_thumbnail_loader (GIMP_LOAD_PROCEDURE (procedure),
+                                                LOAD_THUMB_PROC);
+    }
+  else if (! strcmp (name, LOAD_THUMB_PROC))
+    {
+      procedure = gimp_thumbnail_procedure_new (plug_in, name,
+                                                GIMP_PDB_PROC_TYPE_PLUGIN,
+                                                heif_load_thumb, NULL, NULL);
+
+      gimp_procedure_set_documentation (procedure,
+                                        _("Loads a thumbnail from a HEIF image"),
+                                        _("Loads the thumbnail image embedded "
+                                          "in a HEIF file for its primary "
+                                          "image. Files without one are "
+                                          "left to the full loader."),
+                                        name);
+      gimp_procedure_set_attribution (procedure,
+                                      "Dirk Farin <farin@struktur.de>",
+                                      "Dirk Farin <farin@struktur.de>",
+                                      "2018");
     }
   else if (! strcmp (name, EXPORT_PROC))
     {
@@ -329,6 +371,14 @@ heif_create_procedure (GimpPlugIn  *plug_in,
                                           "balanced",
                                           G_PARAM_READWRITE);
 
+      gimp_procedure_add_int_argument (procedure, "encoder-threads",
+                                       _("Encoder _threads"),
+                                       _("The number of threads the encoder "
+                                         "may use, or 0 to follow GIMP's "
+                                         "number of processors"),
+                                       0, 64, 0,
+                                       G_PARAM_READWRITE);
+
       gimp_procedure_add_boolean_argument (procedure, "include-exif",
                                            _("Save Exi_f"),
                                            _("Toggle saving Exif data"),
@@ -369,6 +419,9 @@ heif_create_procedure (GimpPlugIn  *plug_in,
                                       "4,string,ftypmif1,4,string,ftypavif");
 
       gimp_file_procedure_set_priority (GIMP_FILE_PROCEDURE (procedure), 100);
+
+      gimp_load_procedure_set_thumbnail_loader (GIMP_LOAD_PROCEDURE (procedure),
+                                                LOAD_THUMB_PROC);
     }
   else if (! strcmp (name, EXPORT_PROC_AV1))
     {
@@ -450,6 +503,14 @@ heif_create_procedure (GimpPlugIn  *plug_in,
                                           "balanced",
                                           G_PARAM_READWRITE);
 
+      gimp_procedure_add_int_argument (procedure, "encoder-threads",
+                                       _("Encoder _threads"),
+                                       _("The number of threads the encoder "
+                                         "may use, or 0 to follow GIMP's "
+                                         "number of processors"),
+                                       0, 64, 0,
+                                       G_PARAM_READWRITE);
+
       gimp_procedure_add_boolean_argument (procedure, "include-exif",
                                            _("Save Exi_f"),
                                            _("Toggle saving Exif data"),
@@ -487,6 +548,9 @@ heif_create_procedure (GimpPlugIn  *plug_in,
 
       gimp_file_procedure_set_magics (GIMP_FILE_PROCEDURE (procedure),
                                       "4,string,ftypj2ki");
+
+      gimp_load_procedure_set_thumbnail_loader (GIMP_LOAD_PROCEDURE (procedure),
+                                                LOAD_THUMB_PROC);
     }
 #endif
 #if LIBHEIF_HAVE_VERSION(1,19,6)
@@ -514,6 +578,9 @@ heif_create_procedure (GimpPlugIn  *plug_in,
 
       gimp_file_procedure_set_magics (GIMP_FILE_PROCEDURE (procedure),
                                       "4,string,ftypavci");
+
+      gimp_load_procedure_set_thumbnail_loader (GIMP_LOAD_PROCEDURE (procedure),
+                                                LOAD_THUMB_PROC);
     }
 #endif
 #if LIBHEIF_HAVE_VERSION(1,19,8)
@@ -640,6 +707,46 @@ heif_load (GimpProcedure         *procedure,
   return return_vals;
 }
 
+static GimpValueArray *
+heif_load_thumb (GimpProcedure       *procedure,
+                 GFile               *file,
+                 gint                 size,
+                 GimpProcedureConfig *config,
+                 gpointer             run_data)
+{
+  GimpValueArray *return_vals;
+  GimpImage      *image;
+  gint            width  = 0;
+  gint            height = 0;
+  GimpImageType   type   = GIMP_RGB_IMAGE;
+  GError         *error  = NULL;
+
+  gegl_init (NULL, NULL);
+
+  heif_init (NULL);
+
+  image = load_thumbnail_image (file, size, &width, &height, &type, &error);
+
+  heif_deinit ();
+
+  if (! image)
+    return gimp_procedure_new_return_values (procedure,
+                                             GIMP_PDB_EXECUTION_ERROR,
+                                             error);
+
+  return_vals = gimp_procedure_new_return_values (procedure,
+                                                  GIMP_PDB_SUCCESS,
+                                                  NULL);
+
+  GIMP_VALUES_SET_IMAGE (return_vals, 1, image);
+  GIMP_VALUES_SET_INT   (return_vals, 2, width);
+  GIMP_VALUES_SET_INT   (return_vals, 3, height);
+  GIMP_VALUES_SET_ENUM  (return_vals, 4, type);
+  GIMP_VALUES_SET_INT   (return_vals, 5, 1);
+
+  return return_vals;
+}
+
 static GimpValueArray *
 heif_export (GimpProcedure        *procedure,
              GimpRunMode           run_mode,
@@ -1559,6 +1666,171 @@ load_image (GFile                 *file,
   return image;
 }
 
+/* loads the smallest thumbnail item of the primary image that is at
+ * least 'size' pixels large, or the largest one if none is.  the
+ * thumbnail items are coded independently of the image they preview,
+ * so none of the primary image's tiles are decoded.
+ */
+static GimpImage *
+load_thumbnail_image (GFile          *file,
+                      gint            size,
+                      gint           *width,
+                      gint           *height,
+                      GimpImageType  *type,
+                      GError        **error)
+{
+  gchar                    *file_buffer = NULL;
+  gsize                     file_size;
+  struct heif_context      *ctx;
+  struct heif_error         err;
+  struct heif_image_handle *handle       = NULL;
+  struct heif_image_handle *thumb_handle = NULL;
+  struct heif_image        *img          = NULL;
+  heif_item_id              primary;
+  heif_item_id             *thumb_ids;
+  gint                      n_thumbs;
+  gint                      best_size    = 0;
+  gboolean                  has_alpha;
+  GimpImage                *image        = NULL;
+  GimpLayer                *layer;
+  GeglBuffer               *buffer;
+  const guint8             *data;
+  gint                      stride;
+  gint                      thumb_width;
+  gint                      thumb_height;
+  gint                      i;
+
+  if (! g_file_load_contents (file, NULL, &file_buffer, &file_size,
+                              NULL, error))
+    return NULL;
+
+  ctx = heif_context_alloc ();
+
+  err = heif_context_read_from_memory_without_copy (ctx, file_buffer,
+                                                    file_size, NULL);
+  if (! err.code)
+    err = heif_context_get_primary_image_handle (ctx, &handle);
+
+  if (err.code)
+    {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                   _("Loading HEIF image failed: %s"),
+                   err.message);
+      goto out;
+    }
+
+  *width  = heif_image_handle_get_width  (handle);
+  *height = heif_image_handle_get_height (handle);
+
+  has_alpha = heif_image_handle_has_alpha_channel (handle);
+
+  n_thumbs = heif_image_handle_get_number_of_thumbnails (handle);
+  if (n_thumbs < 1)
+    {
+      g_set_error_literal (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                           "The HEIF file contains no thumbnail");
+      goto out;
+    }
+
+  thumb_ids = g_new (heif_item_id, n_thumbs);
+  n_thumbs  = heif_image_handle_get_list_of_thumbnail_IDs (handle, thumb_ids,
+                                                           n_thumbs);
+
+  for (i = 0; i < n_thumbs; i++)
+    {
+      struct heif_image_handle *candidate;
+      gint                      candidate_size;
+
+      err = heif_image_handle_get_thumbnail (handle, thumb_ids[i], &candidate);
+      if (err.code)
+        continue;
+
+      candidate_size = MAX (heif_image_handle_get_width  (candidate),
+                            heif_image_handle_get_height (candidate));
+
+      if (! thumb_handle                                          ||
+          (best_size < size && candidate_size > best_size)       ||
+          (candidate_size >= size && candidate_size < best_size))
+        {
+          if (thumb_handle)
+            heif_image_handle_release (thumb_handle);
+
+          thumb_handle = candidate;
+          best_size    = candidate_size;
+        }
+      else
+        {
+          heif_image_handle_release (candidate);
+        }
+    }
+
+  g_free (thumb_ids);
+
+  if (! thumb_handle)
+    {
+      g_set_error_literal (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                           "The HEIF file contains no readable thumbnail");
+      goto out;
+    }
+
+  has_alpha = has_alpha || heif_image_handle_has_alpha_channel (thumb_handle);
+
+  err = heif_decode_image (thumb_handle,
+                           &img,
+                           heif_colorspace_RGB,
+                           has_alpha ? heif_chroma_interleaved_RGBA :
+                                       heif_chroma_interleaved_RGB,
+                           NULL);
+  if (err.code)
+    {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                   _("Loading HEIF image failed: %s"),
+                   err.message);
+      goto out;
+    }
+
+  thumb_width  = heif_image_get_width  (img, heif_channel_interleaved);
+  thumb_height = heif_image_get_height (img, heif_channel_interleaved);
+
+  image = gimp_image_new (thumb_width, thumb_height, GIMP_RGB);
+
+  layer = gimp_layer_new (image,
+                          _("image content"),
+                          thumb_width, thumb_height,
+                          has_alpha ? GIMP_RGBA_IMAGE : GIMP_RGB_IMAGE,
+                          100.0,
+                          gimp_image_get_default_new_layer_mode (image));
+
+  gimp_image_insert_layer (image, layer, NULL, 0);
+
+  buffer = gimp_drawable_get_buffer (GIMP_DRAWABLE (layer));
+
+  data = heif_image_get_plane_readonly (img, heif_channel_interleaved,
+                                        &stride);
+
+  gegl_buffer_set (buffer,
+                   GEGL_RECTANGLE (0, 0, thumb_width, thumb_height), 0,
+                   babl_format (has_alpha ? "R'G'B'A u8" : "R'G'B' u8"),
+                   data, stride);
+
+  g_object_unref (buffer);
+
+  *type = has_alpha ? GIMP_RGBA_IMAGE : GIMP_RGB_IMAGE;
+
+ out:
+  if (img)
+    heif_image_release (img);
+  if (thumb_handle)
+    heif_image_handle_release (thumb_handle);
+  if (handle)
+    heif_image_handle_release (handle);
+
+  heif_context_free (ctx);
+  g_free (file_buffer);
+
+  return image;
+}
+
 static struct heif_error
 write_callback (struct heif_context *ctx,
                 const void          *data,
@@ -2031,6 +2303,29 @@ export_image (GFile                        *file,
           g_printerr ("Failed to set preset %s for %s encoder: %s", parameter_value, encoder_name, err.message);
         }
 
+      if (g_strcmp0 (encoder_name, "x265") == 0)
+        {
+          gint   encoder_threads;
+          gchar *pools;
+
+          g_object_get (config,
+                        "encoder-threads", &encoder_threads,
+                        NULL);
+
+          /* x265 sizes its thread pool from all cores by default */
+          if (encoder_threads > 0)
+            {
+              pools = g_strdup_printf ("%d", encoder_threads);
+
+              err = heif_encoder_set_parameter_string (encoder, "x265:pools", pools);
+              if (err.code != 0)
+                {
+                  g_printerr ("Failed to set pools=%s for %s encoder: %s", pools, encoder_name, err.message);
+                }
+
+              g_free (pools);
+            }
+        }
     }
   else if (compression == heif_compression_AV1)
     {
@@ -2040,8 +2335,15 @@ export_image (GFile                        *file,
 
       int parameter_number;
 
-      parameter_number = gimp_get_num_processors();
-      parameter_number = CLAMP(parameter_number, 1, 16);
+      g_object_get (config,
+                    "encoder-threads", &parameter_number,
+                    NULL);
+
+      if (parameter_number == 0)
+        {
+          parameter_number = gimp_get_num_processors();
+          parameter_number = CLAMP(parameter_number, 1, 16);
+        }
 
       err = heif_encoder_set_parameter_integer (encoder, "threads", parameter_number);
       if (err.code != 0)
@@ -2098,6 +2400,28 @@ export_image (GFile                        *file,
               g_printerr ("Failed to set speed=%d for %s encoder: %s", parameter_number, encoder_name, err.message);
             }
 
+        }
+      else if (g_strcmp0 (encoder_name, "svt") == 0) /* SVT-AV1 encoder */
+        {
+          switch (encoder_speed_av1)
+            {
+            case HEIFPLUGIN_ENCODER_SPEED_SLOW:
+              parameter_number = 4;
+              break;
+            case HEIFPLUGIN_ENCODER_SPEED_FASTER:
+              parameter_number = 12;
+              break;
+            default: /*  HEIFPLUGIN_ENCODER_SPEED_BALANCED */
+              parameter_number = 8;
+              break;
+            }
+
+          err = heif_encoder_set_parameter_integer (encoder, "speed", parameter_number);
+          if (err.code != 0)
+            {
+              g_printerr ("Failed to set speed=%d for %s encoder: %s", parameter_number, encoder_name, err.message);
+            }
+
         }
       else
         {
@@ -2667,6 +2991,7 @@ save_dialog (GimpProcedure *procedure,
                                   "lossless", "quality",
                                   "pixel-format",
                                   "save-bit-depth", "encoder-speed",
+                                  "encoder-threads",
                                   "include-color-profile",
                                   "include-exif", "include-xmp", NULL);
     }
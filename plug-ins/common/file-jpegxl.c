@@ -33,6 +33,7 @@
 #include "libgimp/stdplugins-intl.h"
 
 #define LOAD_PROC       "file-jpegxl-load"
+#define LOAD_THUMB_PROC "file-jpegxl-load-thumb"
 #define EXPORT_PROC     "file-jpegxl-export"
 #define PLUG_IN_BINARY  "file-jpegxl"
 
@@ -66,6 +67,11 @@ static GimpValueArray *jpegxl_load              (GimpProcedure         *procedur
                                                  GimpMetadataLoadFlags *flags,
                                                  GimpProcedureConfig   *config,
                                                  gpointer               run_data);
+static GimpValueArray *jpegxl_load_thumb        (GimpProcedure         *procedure,
+                                                 GFile                 *file,
+                                                 gint                   size,
+                                                 GimpProcedureConfig   *config,
+                                                 gpointer               run_data);
 static GimpValueArray *jpegxl_export            (GimpProcedure         *procedure,
                                                  GimpRunMode            run_mode,
                                                  GimpImage             *image,
@@ -121,6 +127,7 @@ jpegxl_query_procedures (GimpPlugIn *plug_in)
   GList *list = NULL;
 
   list = g_list_append (list, g_strdup (LOAD_PROC));
+  list = g_list_append (list, g_strdup (LOAD_THUMB_PROC));
   list = g_list_append (list, g_strdup (EXPORT_PROC));
 
   return list;
@@ -156,6 +163,26 @@ jpegxl_create_procedure (GimpPlugIn  *plug_in,
       gimp_file_procedure_set_magics (GIMP_FILE_PROCEDURE (procedure),
                                       "0,string,\xFF\x0A,0,string,\\000\\000\\000\x0CJXL\\040\\015\\012\x87\\012");
 
+      gimp_load_procedure_set_thumbnail_loader (GIMP_LOAD_PROCEDURE (procedure),
+                                                LOAD_THUMB_PROC);
+    }
+  else if (! strcmp (name, LOAD_THUMB_PROC))
+    {
+      procedure = gimp_thumbnail_procedure_new (plug_in, name,
+                                                GIMP_PDB_PROC_TYPE_PLUGIN,
+                                                jpegxl_load_thumb, NULL, NULL);
+
+      gimp_procedure_set_documentation (procedure,
+                                        _("Loads a thumbnail from a JPEG XL image"),
+                                        _("Loads the preview frame embedded in "
+                                          "a JPEG XL image or, when there is "
+                                          "none, only the 1:8 DC pass of its "
+                                          "first frame."),
+                                        name);
+      gimp_procedure_set_attribution (procedure,
+                                      "Daniel Novomesky",
+                                      "(C) 2021 Daniel Novomesky",
+                                      "2021");
     }
   else if (! strcmp (name, EXPORT_PROC))
     {
@@ -223,6 +250,22 @@ jpegxl_create_procedure (GimpPlugIn  *plug_in,
                                           "squirrel",
                                           G_PARAM_READWRITE);
 
+      gimp_procedure_add_boolean_argument (procedure, "progressive",
+                                           _("Pro_gressive"),
+                                           _("Order the image data so that "
+                                             "downscaled previews can be "
+                                             "decoded from the start of the "
+                                             "file"),
+                                           FALSE,
+                                           G_PARAM_READWRITE);
+
+      gimp_procedure_add_int_argument (procedure, "decoding-speed",
+                                       _("_Faster decoding"),
+                                       _("Trade some compression for faster "
+                                         "decoding. Range: 0 .. 4"),
+                                       0, 4, 0,
+                                       G_PARAM_READWRITE);
+
       gimp_procedure_add_boolean_argument (procedure, "cmyk",
                                            _("Export as CMY_K"),
                                            _("Create a CMYK JPEG XL image using the soft-proofing color profile"),
@@ -1153,6 +1196,267 @@ load_image (GFile                 *file,
   return image;
 }
 
+typedef struct
+{
+  guchar *pixels;
+  gint    width;
+  gint    height;
+  gint    factor;
+  gint    bpp;
+} ThumbnailOut;
+
+/* called by libjxl, possibly from several runner threads at once, for
+ * each decoded run of a row.  only every factor-th pixel of every
+ * factor-th row is kept, so the full-size image is never allocated.
+ */
+static void
+thumbnail_image_out (void       *opaque,
+                     size_t      x,
+                     size_t      y,
+                     size_t      num_pixels,
+                     const void *pixels)
+{
+  ThumbnailOut *out = opaque;
+  const guchar *src = pixels;
+  gsize         i;
+
+  if (y % out->factor || y / out->factor >= out->height)
+    return;
+
+  y /= out->factor;
+
+  for (i = (out->factor - x % out->factor) % out->factor;
+       i < num_pixels;
+       i += out->factor)
+    {
+      gsize dest_x = (x + i) / out->factor;
+
+      if (dest_x >= out->width)
+        break;
+
+      memcpy (out->pixels + (y * out->width + dest_x) * out->bpp,
+              src + i * out->bpp,
+              out->bpp);
+    }
+}
+
+/* loads a thumbnail of at least 'size' pixels, if the image is large
+ * enough: the embedded preview frame if there is one, and otherwise the
+ * DC pass of the first frame, which libjxl decodes without running the
+ * full-resolution passes.  the DC image is upsampled to the full frame
+ * size, so it's subsampled back while it is being output.
+ */
+static GimpImage *
+load_thumbnail_image (GFile          *file,
+                      gint            size,
+                      gint           *width,
+                      gint           *height,
+                      GimpImageType  *type,
+                      GError        **error)
+{
+  gchar            *memory = NULL;
+  gsize             memory_size;
+  JxlDecoder       *decoder;
+  void             *runner;
+  JxlBasicInfo      basicinfo;
+  JxlDecoderStatus  status;
+  JxlPixelFormat    pixel_format  = { 4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0 };
+  size_t            pixels_size;
+  guchar           *pixels        = NULL;
+  gint              pixels_width  = 0;
+  gint              pixels_height = 0;
+  ThumbnailOut      thumb_out     = { NULL, };
+  gboolean          is_gray;
+  gboolean          has_alpha;
+  gboolean          done          = FALSE;
+  GimpImage        *image         = NULL;
+  GimpLayer        *layer;
+  GeglBuffer       *buffer;
+  gint              factor;
+  gint              thumb_width;
+  gint              thumb_height;
+  gint              bpp;
+  gint              x, y;
+
+  if (! g_file_load_contents (file, NULL, &memory, &memory_size, NULL, error))
+    return NULL;
+
+  decoder = JxlDecoderCreate (NULL);
+  runner  = JxlThreadParallelRunnerCreate (NULL, gimp_get_num_processors ());
+
+  if (! decoder || ! runner                                                  ||
+      JxlDecoderSetParallelRunner (decoder, JxlThreadParallelRunner,
+                                   runner)                 != JXL_DEC_SUCCESS ||
+      JxlDecoderSetInput (decoder, (const uint8_t *) memory,
+                          memory_size)                     != JXL_DEC_SUCCESS ||
+      JxlDecoderSubscribeEvents (decoder,
+                                 JXL_DEC_BASIC_INFO        |
+                                 JXL_DEC_PREVIEW_IMAGE     |
+                                 JXL_DEC_FRAME_PROGRESSION |
+                                 JXL_DEC_FULL_IMAGE)       != JXL_DEC_SUCCESS ||
+      JxlDecoderSetProgressiveDetail (decoder, kDC)        != JXL_DEC_SUCCESS)
+    {
+      g_set_error (error, G_FILE_ERROR, 0,
+                   "ERROR: JxlDecoder initialization failed");
+      goto out;
+    }
+
+  JxlDecoderCloseInput (decoder);
+
+  while (! done)
+    {
+      status = JxlDecoderProcessInput (decoder);
+
+      switch (status)
+        {
+        case JXL_DEC_BASIC_INFO:
+          if (JxlDecoderGetBasicInfo (decoder, &basicinfo) != JXL_DEC_SUCCESS)
+            {
+              g_set_error (error, G_FILE_ERROR, 0,
+                           "ERROR: JxlDecoderGetBasicInfo failed");
+              goto out;
+            }
+
+          pixel_format.num_channels = basicinfo.alpha_bits > 0 ? 4 : 3;
+          break;
+
+        case JXL_DEC_NEED_PREVIEW_OUT_BUFFER:
+          if (JxlDecoderPreviewOutBufferSize (decoder, &pixel_format,
+                                              &pixels_size) != JXL_DEC_SUCCESS)
+            {
+              g_set_error (error, G_FILE_ERROR, 0,
+                           "ERROR: JxlDecoderPreviewOutBufferSize failed");
+              goto out;
+            }
+
+          pixels_width  = basicinfo.preview.xsize;
+          pixels_height = basicinfo.preview.ysize;
+          pixels        = g_malloc (pixels_size);
+
+          if (JxlDecoderSetPreviewOutBuffer (decoder, &pixel_format,
+                                             pixels,
+                                             pixels_size) != JXL_DEC_SUCCESS)
+            {
+              g_set_error (error, G_FILE_ERROR, 0,
+                           "ERROR: JxlDecoderSetPreviewOutBuffer failed");
+              goto out;
+            }
+          break;
+
+        case JXL_DEC_NEED_IMAGE_OUT_BUFFER:
+          thumb_out.factor = MAX (MAX (basicinfo.xsize, basicinfo.ysize) /
+                                  MAX (size, 1), 1);
+          thumb_out.width  = MAX (basicinfo.xsize / thumb_out.factor, 1);
+          thumb_out.height = MAX (basicinfo.ysize / thumb_out.factor, 1);
+          thumb_out.bpp    = pixel_format.num_channels;
+          thumb_out.pixels = g_malloc0 ((gsize) thumb_out.width *
+                                        thumb_out.height * thumb_out.bpp);
+
+          pixels_width  = thumb_out.width;
+          pixels_height = thumb_out.height;
+          pixels        = thumb_out.pixels;
+
+          if (JxlDecoderSetImageOutCallback (decoder, &pixel_format,
+                                             thumbnail_image_out,
+                                             &thumb_out) != JXL_DEC_SUCCESS)
+            {
+              g_set_error (error, G_FILE_ERROR, 0,
+                           "ERROR: JxlDecoderSetImageOutCallback failed");
+              goto out;
+            }
+          break;
+
+        case JXL_DEC_FRAME_PROGRESSION:
+          if (JxlDecoderFlushImage (decoder) != JXL_DEC_SUCCESS)
+            {
+              g_set_error (error, G_FILE_ERROR, 0,
+                           "ERROR: JxlDecoderFlushImage failed");
+              goto out;
+            }
+
+          done = TRUE;
+          break;
+
+        case JXL_DEC_PREVIEW_IMAGE:
+        case JXL_DEC_FULL_IMAGE:
+          /*  small or non-progressive images may not have a DC pass to
+           *  stop at, in which case the first frame was fully decoded
+           */
+          done = TRUE;
+          break;
+
+        default:
+          g_set_error (error, G_FILE_ERROR, 0,
+                       "Decoding the JXL thumbnail failed (event %d)",
+                       status);
+          goto out;
+        }
+    }
+
+  is_gray   = (basicinfo.num_color_channels == 1);
+  has_alpha = (pixel_format.num_channels == 4);
+  bpp       = pixel_format.num_channels;
+
+  /*  the frame was subsampled on output already  */
+  if (thumb_out.pixels)
+    factor = 1;
+  else
+    factor = CLAMP (MAX (pixels_width, pixels_height) / MAX (size, 1), 1, 8);
+
+  thumb_width  = MAX (pixels_width  / factor, 1);
+  thumb_height = MAX (pixels_height / factor, 1);
+
+  /*  subsample in place; the source never trails the destination  */
+  if (factor > 1)
+    {
+      for (y = 0; y < thumb_height; y++)
+        for (x = 0; x < thumb_width; x++)
+          memmove (pixels + ((gsize) y * thumb_width + x) * bpp,
+                   pixels + ((gsize) y * factor * pixels_width +
+                             x * factor) * bpp,
+                   bpp);
+    }
+
+  image = gimp_image_new (thumb_width, thumb_height, GIMP_RGB);
+
+  layer = gimp_layer_new (image, "Background",
+                          thumb_width, thumb_height,
+                          has_alpha ? GIMP_RGBA_IMAGE : GIMP_RGB_IMAGE,
+                          100.0,
+                          gimp_image_get_default_new_layer_mode (image));
+
+  gimp_image_insert_layer (image, layer, NULL, 0);
+
+  buffer = gimp_drawable_get_buffer (GIMP_DRAWABLE (layer));
+
+  gegl_buffer_set (buffer,
+                   GEGL_RECTANGLE (0, 0, thumb_width, thumb_height), 0,
+                   babl_format (has_alpha ? "R'G'B'A u8" : "R'G'B' u8"),
+                   pixels, GEGL_AUTO_ROWSTRIDE);
+
+  g_object_unref (buffer);
+
+  *width  = basicinfo.xsize;
+  *height = basicinfo.ysize;
+
+  if (is_gray)
+    *type = has_alpha ? GIMP_GRAYA_IMAGE : GIMP_GRAY_IMAGE;
+  else
+    *type = has_alpha ? GIMP_RGBA_IMAGE : GIMP_RGB_IMAGE;
+
+ out:
+  g_free (pixels);
+
+  if (runner)
+    JxlThreadParallelRunnerDestroy (runner);
+  if (decoder)
+    JxlDecoderDestroy (decoder);
+
+  g_free (memory);
+
+  return image;
+}
+
 static GimpValueArray *
 jpegxl_load (GimpProcedure         *procedure,
              GimpRunMode            run_mode,
@@ -1184,6 +1488,42 @@ jpegxl_load (GimpProcedure         *procedure,
   return return_vals;
 }
 
+static GimpValueArray *
+jpegxl_load_thumb (GimpProcedure       *procedure,
+                   GFile               *file,
+                   gint                 size,
+                   GimpProcedureConfig *config,
+                   gpointer             run_data)
+{
+  GimpValueArray *return_vals;
+  GimpImage      *image;
+  gint            width  = 0;
+  gint            height = 0;
+  GimpImageType   type   = GIMP_RGB_IMAGE;
+  GError         *error  = NULL;
+
+  gegl_init (NULL, NULL);
+
+  image = load_thumbnail_image (file, size, &width, &height, &type, &error);
+
+  if (! image)
+    return gimp_procedure_new_return_values (procedure,
+                                             GIMP_PDB_EXECUTION_ERROR,
+                                             error);
+
+  return_vals = gimp_procedure_new_return_values (procedure,
+                                                  GIMP_PDB_SUCCESS,
+                                                  NULL);
+
+  GIMP_VALUES_SET_IMAGE (return_vals, 1, image);
+  GIMP_VALUES_SET_INT   (return_vals, 2, width);
+  GIMP_VALUES_SET_INT   (return_vals, 3, height);
+  GIMP_VALUES_SET_ENUM  (return_vals, 4, type);
+  GIMP_VALUES_SET_INT   (return_vals, 5, 1);
+
+  return return_vals;
+}
+
 static void
 extract_cmyk (GeglBuffer *buffer,
               gpointer   *cmy_data,
@@ -1381,6 +1721,8 @@ export_image (GFile               *file,
   gdouble                  compression = 1.0;
   gboolean                 lossless = FALSE;
   gint                     speed = 7;
+  gboolean                 progressive = FALSE;
+  gint                     decoding_speed = 0;
   gint                     bit_depth = 8;
   gboolean                 cmyk = FALSE;
   gboolean                 save_exif = FALSE;
@@ -1393,6 +1735,8 @@ export_image (GFile               *file,
                 "lossless",              &lossless,
                 "compression",           &compression,
                 "save-bit-depth",        &bit_depth,
+                "progressive",           &progressive,
+                "decoding-speed",        &decoding_speed,
                 "cmyk",                  &cmyk,
                 "include-exif",          &save_exif,
                 "include-xmp",           &save_xmp,
@@ -1763,6 +2107,39 @@ export_image (GFile               *file,
       g_printerr ("JxlEncoderFrameSettingsSetOption failed to set effort %d", speed);
     }
 
+  if (progressive)
+    {
+      /* lossless images get a responsive (squeezed) modular encoding,
+       * lossy ones progressive DC and AC passes; both let a decoder stop
+       * early with a downscaled image
+       */
+      if (lossless)
+        {
+          status = JxlEncoderFrameSettingsSetOption (encoder_options,
+                                                     JXL_ENC_FRAME_SETTING_RESPONSIVE,
+                                                     1);
+        }
+      else
+        {
+          status = JxlEncoderFrameSettingsSetOption (encoder_options,
+                                                     JXL_ENC_FRAME_SETTING_PROGRESSIVE_DC,
+                                                     1);
+          if (status == JXL_ENC_SUCCESS)
+            status = JxlEncoderFrameSettingsSetOption (encoder_options,
+                                                       JXL_ENC_FRAME_SETTING_PROGRESSIVE_AC,
+                                                       1);
+        }
+
+      if (status != JXL_ENC_SUCCESS)
+        g_printerr ("JxlEncoderFrameSettingsSetOption failed to enable progressive encoding");
+    }
+
+  status = JxlEncoderFrameSettingsSetOption (encoder_options, JXL_ENC_FRAME_SETTING_DECODING_SPEED, decoding_speed);
+  if (status != JXL_ENC_SUCCESS)
+    {
+      g_printerr ("JxlEncoderFrameSettingsSetOption failed to set decoding speed %d", decoding_speed);
+    }
+
   gimp_progress_update (0.5);
 
   status = JxlEncoderAddImageFrame (encoder_options, &pixel_format,
@@ -2070,7 +2447,8 @@ save_dialog (GimpImage     *image,
 
   gimp_procedure_dialog_fill (GIMP_PROCEDURE_DIALOG (dialog),
                               "lossless", "compression",
-                              "speed", "save-bit-depth",
+                              "speed", "progressive", "decoding-speed",
+                              "save-bit-depth",
                               "cmyk-frame",
                               "include-exif", "include-xmp",
                               NULL);
@@ -42,6 +42,14 @@
 
 #define THUMBNAIL_SIZE  128
 
+#define PASSWORD_KEY    "gimp-pdf-password"
+
+/* pages are rendered in strips of this many rows, and at most this
+ * many rendered strips wait per page for being copied to its layer
+ */
+#define STRIP_HEIGHT    256
+#define MAX_STRIPS      4
+
 #define GIMP_PLUGIN_PDF_LOAD_ERROR gimp_plugin_pdf_load_error_quark ()
 static GQuark
 gimp_plugin_pdf_load_error_quark (void)
@@ -561,9 +569,10 @@ open_document (GFile        *file,
                GError      **load_error)
 {
   PopplerDocument *doc;
-  GError          *error = NULL;
+  gchar           *password = g_strdup (PDF_password);
+  GError          *error    = NULL;
 
-  doc = poppler_document_new_from_gfile (file, PDF_password, NULL, &error);
+  doc = poppler_document_new_from_gfile (file, password, NULL, &error);
 
   if (run_mode == GIMP_RUN_INTERACTIVE)
     {
@@ -602,8 +611,9 @@ open_document (GFile        *file,
           if (run == GTK_RESPONSE_OK)
             {
               g_clear_error (&error);
-              doc = poppler_document_new_from_gfile (file,
-                                                     gtk_entry_get_text (GTK_ENTRY (entry)),
+              g_free (password);
+              password = g_strdup (gtk_entry_get_text (GTK_ENTRY (entry)));
+              doc = poppler_document_new_from_gfile (file, password,
                                                      NULL, &error);
             }
           label = gtk_label_new (_("Wrong password! Please input the right one:"));
@@ -628,9 +638,16 @@ open_document (GFile        *file,
                    gimp_file_get_utf8_name (file),
                    error->message);
       g_error_free (error);
+      g_free (password);
       return NULL;
     }
 
+  /* keep the password around, for opening the document again in the
+   * render threads
+   */
+  g_object_set_data_full (G_OBJECT (doc), PASSWORD_KEY, password,
+                          (GDestroyNotify) g_free);
+
   if (width && height)
     {
       gint n_pages;
@@ -672,6 +689,7 @@ layer_from_surface (GimpImage       *image,
 
 static cairo_surface_t *
 render_page_to_surface (PopplerPage *page,
+                        int          y,
                         int          width,
                         int          height,
                         double       scale,
@@ -685,7 +703,7 @@ render_page_to_surface (PopplerPage *page,
   cr = cairo_create (surface);
 
   cairo_save (cr);
-  cairo_translate (cr, 0.0, 0.0);
+  cairo_translate (cr, 0.0, -y);
 
   if (scale != 1.0)
     cairo_scale (cr, scale, scale);
@@ -731,7 +749,7 @@ render_page_to_pixbuf (PopplerPage *page,
   GdkPixbuf *pixbuf;
   cairo_surface_t *surface;
 
-  surface = render_page_to_surface (page, width, height, scale);
+  surface = render_page_to_surface (page, 0, width, height, scale);
   pixbuf = gdk_pixbuf_get_from_surface (surface, 0, 0,
                                         cairo_image_surface_get_width (surface),
                                         cairo_image_surface_get_height (surface));
@@ -742,6 +760,99 @@ render_page_to_pixbuf (PopplerPage *page,
 
 #endif
 
+typedef struct
+{
+  gint    page_no;
+  gint    width;
+  gint    height;
+  gchar  *label;
+
+  /* rendered strips, top to bottom, not yet copied to the layer */
+  GQueue  strips;
+} RenderPage;
+
+typedef struct
+{
+  RenderPage *pages;
+  gint        n_pages;
+  gdouble     scale;
+  gboolean    antialias;
+  gboolean    white_background;
+
+  GMutex      mutex;
+  GCond       cond;
+  gint        next_page;
+} RenderData;
+
+typedef struct
+{
+  RenderData      *data;
+  PopplerDocument *document;
+  GThread         *thread;
+} RenderThread;
+
+/* Each render thread has a document handle of its own, since poppler
+ * documents can't be used from several threads at once.  A thread
+ * takes the next page in import order and renders it strip by strip,
+ * waiting whenever MAX_STRIPS of them are not yet picked up, so the
+ * pages never need a whole-page surface.
+ */
+static gpointer
+render_thread (gpointer user_data)
+{
+  RenderThread *thread = user_data;
+  RenderData   *data   = thread->data;
+
+  while (TRUE)
+    {
+      RenderPage  *render_page;
+      PopplerPage *page;
+      gint         y;
+
+      g_mutex_lock (&data->mutex);
+
+      if (data->next_page == data->n_pages)
+        {
+          g_mutex_unlock (&data->mutex);
+          break;
+        }
+
+      render_page = &data->pages[data->next_page++];
+
+      g_mutex_unlock (&data->mutex);
+
+      page = poppler_document_get_page (thread->document,
+                                        render_page->page_no);
+
+      for (y = 0; y < render_page->height; y += STRIP_HEIGHT)
+        {
+          cairo_surface_t *surface;
+
+          surface = render_page_to_surface (page, y,
+                                            render_page->width,
+                                            MIN (STRIP_HEIGHT,
+                                                 render_page->height - y),
+                                            data->scale,
+                                            data->antialias,
+                                            data->white_background);
+
+          g_mutex_lock (&data->mutex);
+
+          while (g_queue_get_length (&render_page->strips) >= MAX_STRIPS)
+            g_cond_wait (&data->cond, &data->mutex);
+
+          g_queue_push_tail (&render_page->strips, surface);
+          g_cond_broadcast (&data->cond);
+
+          g_mutex_unlock (&data->mutex);
+        }
+
+      g_object_unref (page);
+    }
+
+  return NULL;
+}
+
 static GimpImage *
 load_image (PopplerDocument        *doc,
             GFile                  *file,
@@ -756,13 +867,18 @@ load_image (PopplerDocument        *doc,
             gboolean                reverse_order,
             PdfSelectedPages       *pages)
 {
-  GimpImage  *image = NULL;
-  GimpImage **images   = NULL;
-  gint        i;
-  gdouble     scale;
-  gdouble     doc_progress = 0;
-  gint        base_index = 0;
-  gint        sign = 1;
+  GimpImage    *image = NULL;
+  GimpImage   **images   = NULL;
+  RenderData    data;
+  RenderThread *threads;
+  gint          n_threads;
+  const gchar  *password;
+  const Babl   *format;
+  gint          i;
+  gdouble       scale;
+  gdouble       doc_progress = 0;
+  gint          base_index = 0;
+  gint          sign = 1;
 
   if (reverse_order && pages->n_pages > 0)
     {
@@ -778,29 +894,75 @@ load_image (PopplerDocument        *doc,
 
   scale = (gdouble) doc_width / extracted_data.width;
 
-  /* read the file */
+  data.pages            = g_new0 (RenderPage, pages->n_pages);
+  data.n_pages          = pages->n_pages;
+  data.scale            = scale;
+  data.antialias        = antialias;
+  data.white_background = white_background;
+  data.next_page        = 0;
+
+  g_mutex_init (&data.mutex);
+  g_cond_init (&data.cond);
 
   for (i = 0; i < pages->n_pages; i++)
     {
+      RenderPage  *render_page = &data.pages[i];
       PopplerPage *page;
-      gchar       *page_label;
       gdouble      page_width;
       gdouble      page_height;
 
-      cairo_surface_t *surface;
-      gint             width;
-      gint             height;
-      gint             page_index;
-
-      page_index = base_index + sign * i;
+      render_page->page_no = pages->pages[base_index + sign * i];
 
-      page = poppler_document_get_page (doc, pages->pages[page_index]);
+      page = poppler_document_get_page (doc, render_page->page_no);
 
       poppler_page_get_size (page, &page_width, &page_height);
-      width  = (gint) ceil (page_width  * scale);
-      height = (gint) ceil (page_height * scale);
+      render_page->width  = (gint) ceil (page_width  * scale);
+      render_page->height = (gint) ceil (page_height * scale);
+
+      g_object_get (G_OBJECT (page), "label", &render_page->label, NULL);
+
+      g_queue_init (&render_page->strips);
+
+      g_object_unref (page);
+    }
+
+  /* start the render threads.  The first one uses @doc, which isn't
+   * touched from here on; the others open the file again, and are
+   * simply not started if that fails
+   */
+  n_threads = CLAMP (gimp_get_num_processors (), 1, MAX (pages->n_pages, 1));
+  threads   = g_new0 (RenderThread, n_threads);
+  password  = g_object_get_data (G_OBJECT (doc), PASSWORD_KEY);
 
-      g_object_get (G_OBJECT (page), "label", &page_label, NULL);
+  threads[0].document = g_object_ref (doc);
+
+  for (i = 1; i < n_threads; i++)
+    {
+      threads[i].document = poppler_document_new_from_gfile (file, password,
+                                                             NULL, NULL);
+      if (! threads[i].document)
+        break;
+    }
+
+  n_threads = i;
+
+  for (i = 0; i < n_threads; i++)
+    {
+      threads[i].data   = &data;
+      threads[i].thread = g_thread_new ("pdf-render", render_thread,
+                                        &threads[i]);
+    }
+
+  format = babl_format ("cairo-ARGB32");
+
+  /* read the file */
+
+  for (i = 0; i < pages->n_pages; i++)
+    {
+      RenderPage *render_page = &data.pages[i];
+      GimpLayer  *layer;
+      GeglBuffer *buffer;
+      gint        y;
 
       if (! image)
         {
@@ -810,14 +972,48 @@ load_image (PopplerDocument        *doc,
           gimp_image_set_resolution (image, resolution, resolution);
         }
 
-      surface = render_page_to_surface (page, width, height, scale,
-                                        antialias, white_background);
+      layer = gimp_layer_new (image, render_page->label,
+                              render_page->width, render_page->height,
+                              GIMP_RGBA_IMAGE, 100.0,
+                              gimp_image_get_default_new_layer_mode (image));
+      gimp_image_insert_layer (image, layer, NULL, 0);
 
-      layer_from_surface (image, page_label, 0, surface,
-                          doc_progress, 1.0 / pages->n_pages);
+      buffer = gimp_drawable_get_buffer (GIMP_DRAWABLE (layer));
 
-      g_free (page_label);
-      cairo_surface_destroy (surface);
+      /* copy the strips to the layer as they are rendered */
+      for (y = 0; y < render_page->height; y += STRIP_HEIGHT)
+        {
+          cairo_surface_t *surface;
+          gint             height;
+
+          g_mutex_lock (&data.mutex);
+
+          while (g_queue_is_empty (&render_page->strips))
+            g_cond_wait (&data.cond, &data.mutex);
+
+          surface = g_queue_pop_head (&render_page->strips);
+          g_cond_broadcast (&data.cond);
+
+          g_mutex_unlock (&data.mutex);
+
+          height = cairo_image_surface_get_height (surface);
+
+          cairo_surface_flush (surface);
+
+          gegl_buffer_set (buffer,
+                           GEGL_RECTANGLE (0, y, render_page->width, height),
+                           0, format,
+                           cairo_image_surface_get_data (surface),
+                           cairo_image_surface_get_stride (surface));
+
+          cairo_surface_destroy (surface);
+
+          gimp_progress_update (doc_progress +
+                                (gdouble) (y + height) /
+                                render_page->height / pages->n_pages);
+        }
+
+      g_object_unref (buffer);
 
       doc_progress = (double) (i + 1) / pages->n_pages;
       gimp_progress_update (doc_progress);
@@ -834,6 +1030,22 @@ load_image (PopplerDocument        *doc,
     }
   gimp_progress_update (1.0);
 
+  for (i = 0; i < n_threads; i++)
+    {
+      g_thread_join (threads[i].thread);
+      g_object_unref (threads[i].document);
+    }
+
+  g_free (threads);
+
+  for (i = 0; i < pages->n_pages; i++)
+    g_free (data.pages[i].label);
+
+  g_free (data.pages);
+
+  g_mutex_clear (&data.mutex);
+  g_cond_clear (&data.cond);
+
   if (image)
     {
       gimp_image_undo_enable (image);
@@ -888,7 +1100,7 @@ get_thumb_surface (PopplerDocument *doc,
       width  *= scale;
       height *= scale;
 
-      surface = render_page_to_surface (page, width, height, scale, TRUE, white_background);
+      surface = render_page_to_surface (page, 0, width, height, scale, TRUE, white_background);
     }
 
   g_object_unref (page);
@@ -54,6 +54,8 @@
 #define PLUG_IN_BINARY "van-gogh-lic"
 #define PLUG_IN_ROLE   "gimp-van-gogh-lic"
 
+#define STEP_HEIGHT    64       /* Rows computed between progress updates */
+
 typedef enum
 {
   LIC_HUE,
@@ -62,6 +64,17 @@ typedef enum
 } LICEffectChannel;
 
 
+typedef struct
+{
+  GeglBuffer   *src_buffer;
+  GeglBuffer   *dest_buffer;
+  const guchar *scalarfield;
+  gboolean      rotate;
+  gint          effect_convolve;
+  gint          y;              /* First row of the current step */
+} LicParams;
+
+
 typedef struct _Lic      Lic;
 typedef struct _LicClass LicClass;
 
@@ -307,26 +320,16 @@ static gint    border_x, border_y, border_w, border_h;
 /* Convenience routines */
 /************************/
 
+/* Each thread samples the source through its own nearest sampler,
+ * which returns "RGBA double"
+ */
 static void
-peek (GeglBuffer *buffer,
-      gint        x,
-      gint        y,
-      gdouble    *color)
-{
-  gegl_buffer_sample (buffer, x, y, NULL,
-                      color, babl_format ("RGBA double"),
-                      GEGL_SAMPLER_NEAREST, GEGL_ABYSS_NONE);
-}
-
-static void
-poke (GeglBuffer *buffer,
-      gint        x,
-      gint        y,
-      gdouble    *color)
+peek (GeglSampler *sampler,
+      gint         x,
+      gint         y,
+      gdouble     *color)
 {
-  gegl_buffer_set (buffer, GEGL_RECTANGLE (x, y, 1, 1), 0,
-                   babl_format ("RGBA double"), color,
-                   GEGL_AUTO_ROWSTRIDE);
+  gegl_sampler_get (sampler, x, y, NULL, color, GEGL_ABYSS_NONE);
 }
 
 static gint
@@ -531,10 +534,10 @@ lic_noise (gint    x,
 }
 
 static void
-getpixel (GeglBuffer *buffer,
-          gdouble    *p,
-          gdouble     u,
-          gdouble     v)
+getpixel (GeglSampler *sampler,
+          gdouble     *p,
+          gdouble      u,
+          gdouble      v)
 {
   register gint x1, y1, x2, y2;
   gint width, height;
@@ -560,16 +563,16 @@ getpixel (GeglBuffer *buffer,
   x2 = (x1 + 1) % width;
   y2 = (y1 + 1) % height;
 
-  peek (buffer, x1, y1, pp);
+  peek (sampler, x1, y1, pp);
   for (gint i = 0; i < 4; i++)
     pixels[i] = pp[i];
-  peek (buffer, x2, y1, pp);
+  peek (sampler, x2, y1, pp);
   for (gint i = 0; i < 4; i++)
     pixels[i + 4] = pp[i];
-  peek (buffer, x1, y2, pp);
+  peek (sampler, x1, y2, pp);
   for (gint i = 0; i < 4; i++)
     pixels[i + 8] = pp[i];
-  peek (buffer, x2, y2, pp);
+  peek (sampler, x2, y2, pp);
   for (gint i = 0; i < 4; i++)
     pixels[i + 12] = pp[i];
 
@@ -577,12 +580,12 @@ getpixel (GeglBuffer *buffer,
 }
 
 static void
-lic_image (GeglBuffer *buffer,
-           gint        x,
-           gint        y,
-           gdouble     vx,
-           gdouble     vy,
-           gdouble    *color)
+lic_image (GeglSampler *sampler,
+           gint         x,
+           gint         y,
+           gdouble      vx,
+           gdouble      vy,
+           gdouble     *color)
 {
   gdouble u, step = 2.0 * l / isteps;
   gdouble xx = (gdouble) x, yy = (gdouble) y;
@@ -599,7 +602,7 @@ lic_image (GeglBuffer *buffer,
   /* Calculate integral numerically */
   /* ============================== */
 
-  getpixel (buffer, col1, xx + l * c, yy + l * s);
+  getpixel (sampler, col1, xx + l * c, yy + l * s);
 
   if (source_drw_has_alpha)
     {
@@ -614,7 +617,7 @@ lic_image (GeglBuffer *buffer,
 
   for (u = -l + step; u <= l; u += step)
     {
-      getpixel (buffer, col2, xx - u * c, yy - u * s);
+      getpixel (sampler, col2, xx - u * c, yy - u * s);
 
       if (source_drw_has_alpha)
         {
@@ -672,7 +675,7 @@ rgb_to_hsl (GimpDrawable     *drawable,
 {
   GeglBuffer *buffer;
   guchar     *themap;
-  gfloat      data[3];
+  gfloat     *row;
   gint        x, y;
   gint        height_max;
   gint        width_max;
@@ -690,14 +693,17 @@ rgb_to_hsl (GimpDrawable     *drawable,
   buffer = gimp_drawable_get_buffer (drawable);
 
   themap = g_new (guchar, maxc);
+  row    = g_new (gfloat, 3 * width_max);
 
   for (y = 0; y < height_max; y++)
     {
+      gegl_buffer_get (buffer, GEGL_RECTANGLE (0, y, width_max, 1), 1.0,
+                       babl_format ("HSL float"), row,
+                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
       for (x = 0; x < width_max; x++)
         {
-          gegl_buffer_sample (buffer, x, y, NULL,
-                              data, babl_format ("HSL float"),
-                              GEGL_SAMPLER_NEAREST, GEGL_ABYSS_NONE);
+          const gfloat *data = row + 3 * x;
 
           switch (effect_channel)
             {
@@ -721,43 +727,49 @@ rgb_to_hsl (GimpDrawable     *drawable,
 
   g_object_unref (buffer);
 
+  g_free (row);
   g_rand_free (gr);
 
   return themap;
 }
 
 
+/* Computes the rows from 'offset' to 'offset + size' of the current
+ * step.  Each pixel only depends on the source, so rows can be computed
+ * in parallel.
+ */
 static void
-compute_lic (GimpProcedureConfig *config,
-             GimpDrawable        *drawable,
-             const guchar        *scalarfield,
-             gboolean             rotate)
+compute_lic_rows (gsize            offset,
+                  gsize            size,
+                  const LicParams *params)
 {
-  GeglBuffer *src_buffer;
-  GeglBuffer *dest_buffer;
-  gint        xcount, ycount;
-  gdouble     color[4] = { 0.0, 0.0, 0.0, 1.0 };
-  gdouble     vx, vy, tmp;
-  gint        effect_convolve;
+  GeglSampler *sampler;
+  gdouble     *row;
+  gdouble      vx, vy, tmp;
+  gint         xcount, ycount;
+  gint         y1 = params->y + offset;
+  gint         y2 = y1 + size;
 
-  effect_convolve = gimp_procedure_config_get_choice_id (config,
-                                                         "effect-convolve");
+  sampler = gegl_buffer_sampler_new (params->src_buffer,
+                                     babl_format ("RGBA double"),
+                                     GEGL_SAMPLER_NEAREST);
 
-  src_buffer  = gimp_drawable_get_buffer (drawable);
-  dest_buffer = gimp_drawable_get_shadow_buffer (drawable);
+  row = g_new (gdouble, 4 * border_w);
 
-  for (ycount = 0; ycount < border_h; ycount++)
+  for (ycount = y1; ycount < y2; ycount++)
     {
       for (xcount = 0; xcount < border_w; xcount++)
         {
+          gdouble *color = row + 4 * xcount;
+
           /* Get derivative at (x,y) and normalize it */
           /* ============================================================== */
 
-          vx = gradx (scalarfield, xcount, ycount);
-          vy = grady (scalarfield, xcount, ycount);
+          vx = gradx (params->scalarfield, xcount, ycount);
+          vy = grady (params->scalarfield, xcount, ycount);
 
           /* Rotate if needed */
-          if (rotate)
+          if (params->rotate)
             {
               tmp = vy;
               vy = -vx;
@@ -775,9 +787,9 @@ compute_lic (GimpProcedureConfig *config,
           /* Convolve with the LIC at (x,y) */
           /* ============================== */
 
-          if (effect_convolve == 0)
+          if (params->effect_convolve == 0)
             {
-              peek (src_buffer, xcount, ycount, color);
+              peek (sampler, xcount, ycount, color);
 
               tmp = lic_noise (xcount, ycount, vx, vy);
 
@@ -794,17 +806,48 @@ compute_lic (GimpProcedureConfig *config,
             }
           else
             {
-              lic_image (src_buffer, xcount, ycount, vx, vy, color);
+              lic_image (sampler, xcount, ycount, vx, vy, color);
             }
-
-          poke (dest_buffer, xcount, ycount, color);
         }
 
-      gimp_progress_update ((gfloat) ycount / (gfloat) border_h);
+      gegl_buffer_set (params->dest_buffer,
+                       GEGL_RECTANGLE (0, ycount, border_w, 1), 0,
+                       babl_format ("RGBA double"), row,
+                       GEGL_AUTO_ROWSTRIDE);
+    }
+
+  g_free (row);
+  g_object_unref (sampler);
+}
+
+static void
+compute_lic (GimpProcedureConfig *config,
+             GimpDrawable        *drawable,
+             const guchar        *scalarfield,
+             gboolean             rotate)
+{
+  LicParams params;
+
+  params.effect_convolve = gimp_procedure_config_get_choice_id (config,
+                                                                "effect-convolve");
+  params.scalarfield     = scalarfield;
+  params.rotate          = rotate;
+
+  params.src_buffer  = gimp_drawable_get_buffer (drawable);
+  params.dest_buffer = gimp_drawable_get_shadow_buffer (drawable);
+
+  for (params.y = 0; params.y < border_h; params.y += STEP_HEIGHT)
+    {
+      gegl_parallel_distribute_range (
+        MIN (STEP_HEIGHT, border_h - params.y), 1,
+        (GeglParallelDistributeRangeFunc) compute_lic_rows,
+        &params);
+
+      gimp_progress_update ((gfloat) params.y / (gfloat) border_h);
     }
 
-  g_object_unref (src_buffer);
-  g_object_unref (dest_buffer);
+  g_object_unref (params.src_buffer);
+  g_object_unref (params.dest_buffer);
 
   gimp_progress_update (1.0);
 }
@@ -46,6 +46,23 @@ static gboolean  is_pixel_anchor      (guchar        subset_index,
                                        guchar        pixel_index,
                                        guint         partition_id);
 
+static void      fit_endpoints        (gfloat        pixels[16][4],
+                                       gfloat        endpoints[2][4]);
+static void      refine_endpoints     (gfloat        pixels[16][4],
+                                       const guchar  indexes[16],
+                                       gfloat        endpoints[2][4]);
+static void      quantize_endpoint    (const gfloat  endpoint[4],
+                                       guchar        color[4],
+                                       guchar       *p_bit);
+static gfloat    find_indexes         (gfloat        pixels[16][4],
+                                       guchar        colors[2][4],
+                                       guchar        p_bits[2],
+                                       guchar        indexes[16]);
+static void      put_bits             (guchar       *block,
+                                       guint        *start_bit,
+                                       guint         value,
+                                       guint         length);
+
 
 gint
 bc7_decompress (guchar *src,
@@ -200,6 +217,96 @@ bc7_decompress (guchar *src,
 }
 
 
+/* Encodes 'block', 16 RGBA pixels, as a mode 6 BC7 block: one subset,
+ * 7-bit RGBA endpoints with a p-bit each, and 4-bit indexes.  Mode 6
+ * handles alpha and opaque blocks alike, and preserves smooth gradients
+ * better than BC3 at the same size.
+ */
+void
+bc7_compress (guchar       *dst,
+              const guchar *block)
+{
+  gfloat pixels[16][4];
+  gfloat endpoints[2][4];
+  guchar colors[2][4];
+  guchar p_bits[2];
+  guchar indexes[16];
+  gfloat error;
+  guint  current_bit = 0;
+
+  for (gint i = 0; i < 16; i++)
+    for (gint c = 0; c < 4; c++)
+      pixels[i][c] = block[(i * 4) + c];
+
+  fit_endpoints (pixels, endpoints);
+
+  for (gint e = 0; e < 2; e++)
+    quantize_endpoint (endpoints[e], colors[e], &p_bits[e]);
+
+  error = find_indexes (pixels, colors, p_bits, indexes);
+
+  /* Each least-squares pass refits the endpoints to the current indexes,
+   * which in turn may pick better indexes; two passes capture nearly all
+   * of the gain.
+   */
+  for (gint pass = 0; pass < 2 && error > 0.0f; pass++)
+    {
+      guchar new_colors[2][4];
+      guchar new_p_bits[2];
+      guchar new_indexes[16];
+      gfloat new_error;
+
+      refine_endpoints (pixels, indexes, endpoints);
+
+      for (gint e = 0; e < 2; e++)
+        quantize_endpoint (endpoints[e], new_colors[e], &new_p_bits[e]);
+
+      new_error = find_indexes (pixels, new_colors, new_p_bits, new_indexes);
+
+      if (new_error >= error)
+        break;
+
+      memcpy (colors,  new_colors,  sizeof (colors));
+      memcpy (p_bits,  new_p_bits,  sizeof (p_bits));
+      memcpy (indexes, new_indexes, sizeof (indexes));
+      error = new_error;
+    }
+
+  /* The anchor pixel's index drops its most significant bit, so it must
+   * be less than 8.  Swapping the endpoints inverts the indexes.
+   */
+  if (indexes[0] & 0x08)
+    {
+      for (gint c = 0; c < 4; c++)
+        SWAP (colors[0][c], colors[1][c]);
+
+      SWAP (p_bits[0], p_bits[1]);
+
+      for (gint i = 0; i < 16; i++)
+        indexes[i] = 15 - indexes[i];
+    }
+
+  memset (dst, 0, 16);
+
+  /* Mode 6 is six 0 bits followed by a 1 */
+  put_bits (dst, &current_bit, 1 << 6, 7);
+
+  for (gint c = 0; c < 4; c++)
+    {
+      put_bits (dst, &current_bit, colors[0][c], 7);
+      put_bits (dst, &current_bit, colors[1][c], 7);
+    }
+
+  put_bits (dst, &current_bit, p_bits[0], 1);
+  put_bits (dst, &current_bit, p_bits[1], 1);
+
+  put_bits (dst, &current_bit, indexes[0], 3);
+
+  for (gint i = 1; i < 16; i++)
+    put_bits (dst, &current_bit, indexes[i], 4);
+}
+
+
 /* Private Functions */
 
 static guchar
@@ -359,3 +466,232 @@ is_pixel_anchor (guchar  subset_index,
 
   return FALSE;
 }
+
+/* Takes the endpoints from the extent of the pixels along their
+ * principal axis, found by power iteration on the covariance matrix.
+ */
+static void
+fit_endpoints (gfloat pixels[16][4],
+               gfloat endpoints[2][4])
+{
+  gfloat mean[4] = { 0.0f, };
+  gfloat cov[4][4] = { { 0.0f, }, };
+  gfloat axis[4];
+  gfloat t_min = G_MAXFLOAT;
+  gfloat t_max = -G_MAXFLOAT;
+  gfloat length;
+
+  for (gint i = 0; i < 16; i++)
+    for (gint c = 0; c < 4; c++)
+      mean[c] += pixels[i][c] / 16.0f;
+
+  for (gint i = 0; i < 16; i++)
+    for (gint c = 0; c < 4; c++)
+      for (gint d = 0; d < 4; d++)
+        cov[c][d] += (pixels[i][c] - mean[c]) * (pixels[i][d] - mean[d]);
+
+  for (gint c = 0; c < 4; c++)
+    axis[c] = 1.0f;
+
+  for (gint iter = 0; iter < 8; iter++)
+    {
+      gfloat next[4];
+
+      length = 0.0f;
+
+      for (gint c = 0; c < 4; c++)
+        {
+          next[c] = 0.0f;
+
+          for (gint d = 0; d < 4; d++)
+            next[c] += cov[c][d] * axis[d];
+
+          length = MAX (length, fabsf (next[c]));
+        }
+
+      if (length < 1e-6f)
+        break;
+
+      for (gint c = 0; c < 4; c++)
+        axis[c] = next[c] / length;
+    }
+
+  length = 0.0f;
+  for (gint c = 0; c < 4; c++)
+    length += axis[c] * axis[c];
+
+  if (length < 1e-6f)
+    {
+      /* A flat block */
+      for (gint c = 0; c < 4; c++)
+        endpoints[0][c] = endpoints[1][c] = mean[c];
+
+      return;
+    }
+
+  for (gint i = 0; i < 16; i++)
+    {
+      gfloat t = 0.0f;
+
+      for (gint c = 0; c < 4; c++)
+        t += (pixels[i][c] - mean[c]) * axis[c];
+
+      t_min = MIN (t_min, t);
+      t_max = MAX (t_max, t);
+    }
+
+  for (gint c = 0; c < 4; c++)
+    {
+      endpoints[0][c] = CLAMP (mean[c] + t_min * axis[c] / length, 0.0f, 255.0f);
+      endpoints[1][c] = CLAMP (mean[c] + t_max * axis[c] / length, 0.0f, 255.0f);
+    }
+}
+
+/* Solves, per channel, for the endpoints minimizing the squared error of
+ * the pixels interpolated with 'indexes'.
+ */
+static void
+refine_endpoints (gfloat        pixels[16][4],
+                  const guchar  indexes[16],
+                  gfloat        endpoints[2][4])
+{
+  gfloat aa = 0.0f;
+  gfloat ab = 0.0f;
+  gfloat bb = 0.0f;
+  gfloat det;
+
+  for (gint i = 0; i < 16; i++)
+    {
+      gfloat b = weight_4[indexes[i]] / 64.0f;
+      gfloat a = 1.0f - b;
+
+      aa += a * a;
+      ab += a * b;
+      bb += b * b;
+    }
+
+  det = aa * bb - ab * ab;
+
+  /* All the pixels use the same index */
+  if (fabsf (det) < 1e-6f)
+    return;
+
+  for (gint c = 0; c < 4; c++)
+    {
+      gfloat ax = 0.0f;
+      gfloat bx = 0.0f;
+
+      for (gint i = 0; i < 16; i++)
+        {
+          gfloat b = weight_4[indexes[i]] / 64.0f;
+          gfloat a = 1.0f - b;
+
+          ax += a * pixels[i][c];
+          bx += b * pixels[i][c];
+        }
+
+      endpoints[0][c] = CLAMP ((bb * ax - ab * bx) / det, 0.0f, 255.0f);
+      endpoints[1][c] = CLAMP ((aa * bx - ab * ax) / det, 0.0f, 255.0f);
+    }
+}
+
+/* Quantizes an endpoint to 7 bits per channel, choosing the p-bit that
+ * brings the expanded 8-bit color closest to it.
+ */
+static void
+quantize_endpoint (const gfloat  endpoint[4],
+                   guchar        color[4],
+                   guchar       *p_bit)
+{
+  gfloat best_error = G_MAXFLOAT;
+
+  for (guchar p = 0; p < 2; p++)
+    {
+      guchar candidate[4];
+      gfloat error = 0.0f;
+
+      for (gint c = 0; c < 4; c++)
+        {
+          gint   value;
+          gfloat diff;
+
+          value        = (gint) floorf ((endpoint[c] - p) / 2.0f + 0.5f);
+          candidate[c] = CLAMP (value, 0, 127);
+
+          diff   = (gfloat) ((candidate[c] << 1) | p) - endpoint[c];
+          error += diff * diff;
+        }
+
+      if (error < best_error)
+        {
+          best_error = error;
+          *p_bit     = p;
+          memcpy (color, candidate, 4);
+        }
+    }
+}
+
+/* Picks the closest of the 16 interpolated colors for each pixel, and
+ * returns the block's total squared error.
+ */
+static gfloat
+find_indexes (gfloat  pixels[16][4],
+              guchar  colors[2][4],
+              guchar  p_bits[2],
+              guchar  indexes[16])
+{
+  guint  e[2][4];
+  gfloat palette[16][4];
+  gfloat total = 0.0f;
+
+  for (gint i = 0; i < 2; i++)
+    for (gint c = 0; c < 4; c++)
+      e[i][c] = (colors[i][c] << 1) | p_bits[i];
+
+  for (gint j = 0; j < 16; j++)
+    for (gint c = 0; c < 4; c++)
+      palette[j][c] = ((64 - weight_4[j]) * e[0][c] +
+                       weight_4[j] * e[1][c] + 32) >> 6;
+
+  for (gint i = 0; i < 16; i++)
+    {
+      gfloat best = G_MAXFLOAT;
+
+      for (gint j = 0; j < 16; j++)
+        {
+          gfloat error = 0.0f;
+
+          for (gint c = 0; c < 4; c++)
+            {
+              gfloat diff = palette[j][c] - pixels[i][c];
+
+              error += diff * diff;
+            }
+
+          if (error < best)
+            {
+              best       = error;
+              indexes[i] = j;
+            }
+        }
+
+      total += best;
+    }
+
+  return total;
+}
+
+static void
+put_bits (guchar *block,
+          guint  *start_bit,
+          guint   value,
+          guint   length)
+{
+  for (guint i = 0; i < length; i++)
+    {
+      if ((value >> i) & 1)
+        block[(*start_bit) >> 3] |= 1 << ((*start_bit) & 7);
+
+      (*start_bit)++;
+    }
+}
@@ -239,9 +239,11 @@ static const guchar anchor_index_table[4][64] =
 };
 
 
-gint bc7_decompress (guchar *src,
-                     guint   size,
-                     guchar *block);
+gint bc7_decompress (guchar       *src,
+                     guint         size,
+                     guchar       *block);
+void bc7_compress   (guchar       *dst,
+                     const guchar *block);
 
 
 #endif /* __BC7_H__ */
\ No newline at end of file
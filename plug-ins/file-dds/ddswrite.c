@@ -1571,6 +1571,12 @@ write_image (FILE                *fp,
           dxgi_format = DXGI_FORMAT_BC5_UNORM;
           /*is_dx10 = TRUE;*/
           break;
+
+        case DDS_COMPRESS_BC7:
+          /* BC7 has no FourCC of its own */
+          dxgi_format = DXGI_FORMAT_BC7_UNORM;
+          is_dx10 = TRUE;
+          break;
         }
 
       if ((compression == DDS_COMPRESS_BC3N) ||
@@ -1620,12 +1626,14 @@ write_image (FILE                *fp,
   if (is_dx10)
     {
       array_size = ((savetype == DDS_SAVE_SELECTED_LAYER ||
-                     savetype == DDS_SAVE_VISIBLE_LAYERS) ?
+                     savetype == DDS_SAVE_VISIBLE_LAYERS ||
+                     savetype == DDS_SAVE_CUBEMAP) ?
                     1 : get_array_size (image));
 
       PUTL32 (hdr10 +  0, dxgi_format);
       PUTL32 (hdr10 +  4, D3D10_RESOURCE_DIMENSION_TEXTURE2D);
-      PUTL32 (hdr10 +  8, 0);
+      PUTL32 (hdr10 +  8, (savetype == DDS_SAVE_CUBEMAP) ?
+                          D3D10_RESOURCE_MISC_TEXTURECUBE : 0);
       PUTL32 (hdr10 + 12, array_size);
       PUTL32 (hdr10 + 16, 0);
 
@@ -846,161 +846,64 @@ encode_alpha_block_BC3 (unsigned char       *dst,
     }
 }
 
-#define BLOCK_COUNT(w, h)          ((((h) + 3) >> 2) * (((w) + 3) >> 2))
 #define BLOCK_OFFSET(x, y, w, bs)  (((y) >> 2) * ((bs) * (((w) + 3) >> 2)) + ((bs) * ((x) >> 2)))
 
-static void
-compress_BC1 (unsigned char       *dst,
-              const unsigned char *src,
-              int                  w,
-              int                  h,
-              int                  flags)
-{
-  const unsigned int block_count = BLOCK_COUNT(w, h);
-  unsigned int i;
-  unsigned char block[64], *p;
-  int x, y;
-
-#ifdef _OPENMP
-#pragma omp parallel for schedule(dynamic, 256) private(block, p, x, y)
-#endif
-  for (i = 0; i < block_count; ++i)
-    {
-      x = (i % ((w + 3) >> 2)) << 2;
-      y = (i / ((w + 3) >> 2)) << 2;
-      p = dst + BLOCK_OFFSET(x, y, w, 8);
-      extract_block(src, x, y, w, h, block);
-      encode_color_block(p, block, DXT_BC1 | flags);
-    }
-}
-
-static void
-compress_BC2 (unsigned char       *dst,
-              const unsigned char *src,
-              int                  w,
-              int                  h,
-              int                  flags)
-{
-  const unsigned int block_count = BLOCK_COUNT(w, h);
-  unsigned int i;
-  unsigned char block[64], *p;
-  int x, y;
-
-#ifdef _OPENMP
-#pragma omp parallel for schedule(dynamic, 256) private(block, p, x, y)
-#endif
-  for (i = 0; i < block_count; ++i)
-    {
-      x = (i % ((w + 3) >> 2)) << 2;
-      y = (i / ((w + 3) >> 2)) << 2;
-      p = dst + BLOCK_OFFSET(x, y, w, 16);
-      extract_block(src, x, y, w, h, block);
-      encode_alpha_block_BC2(p, block);
-      encode_color_block(p + 8, block, DXT_BC2 | flags);
-    }
-}
-
-static void
-compress_BC3 (unsigned char       *dst,
-              const unsigned char *src,
-              int                  w,
-              int                  h,
-              int                  flags)
-{
-  const unsigned int block_count = BLOCK_COUNT(w, h);
-  unsigned int i;
-  unsigned char block[64], *p;
-  int x, y;
-
-#ifdef _OPENMP
-#pragma omp parallel for schedule(dynamic, 256) private(block, p, x, y)
-#endif
-  for (i = 0; i < block_count; ++i)
-    {
-      x = (i % ((w + 3) >> 2)) << 2;
-      y = (i / ((w + 3) >> 2)) << 2;
-      p = dst + BLOCK_OFFSET(x, y, w, 16);
-      extract_block(src, x, y, w, h, block);
-      encode_alpha_block_BC3(p, block, 0);
-      encode_color_block(p + 8, block, DXT_BC3 | flags);
-    }
-}
-
-static void
-compress_BC4 (unsigned char       *dst,
-              const unsigned char *src,
-              int                  w,
-              int                  h)
+typedef struct
 {
-  const unsigned int block_count = BLOCK_COUNT(w, h);
-  unsigned int i;
-  unsigned char block[64], *p;
-  int x, y;
-
-#ifdef _OPENMP
-#pragma omp parallel for schedule(dynamic, 256) private(block, p, x, y)
-#endif
-  for (i = 0; i < block_count; ++i)
-    {
-      x = (i % ((w + 3) >> 2)) << 2;
-      y = (i / ((w + 3) >> 2)) << 2;
-      p = dst + BLOCK_OFFSET(x, y, w, 8);
-      extract_block(src, x, y, w, h, block);
-      encode_alpha_block_BC3(p, block, -1);
-    }
-}
+  unsigned char       *dst;
+  const unsigned char *src;
+  int                  w;
+  int                  h;
+  int                  first_row;
+} dxt_level_t;
 
 static void
-compress_BC5 (unsigned char       *dst,
-              const unsigned char *src,
-              int                  w,
-              int                  h)
+compress_block (unsigned char *dst,
+                unsigned char *block,
+                int            format,
+                int            flags)
 {
-  const unsigned int block_count = BLOCK_COUNT(w, h);
-  unsigned int i;
-  unsigned char block[64], *p;
-  int x, y;
+  int i;
 
-#ifdef _OPENMP
-#pragma omp parallel for schedule(dynamic, 256) private(block, p, x, y)
-#endif
-  for (i = 0; i < block_count; ++i)
+  switch (format)
     {
-      x = (i % ((w + 3) >> 2)) << 2;
-      y = (i / ((w + 3) >> 2)) << 2;
-      p = dst + BLOCK_OFFSET(x, y, w, 16);
-      extract_block(src, x, y, w, h, block);
+    case DDS_COMPRESS_BC1:
+      encode_color_block(dst, block, DXT_BC1 | flags);
+      break;
+    case DDS_COMPRESS_BC2:
+      encode_alpha_block_BC2(dst, block);
+      encode_color_block(dst + 8, block, DXT_BC2 | flags);
+      break;
+    case DDS_COMPRESS_BC4:
+      encode_alpha_block_BC3(dst, block, -1);
+      break;
+    case DDS_COMPRESS_BC5:
       /* Pixels are ordered as BGRA (see write_layer)
        * First we encode red  -1+3: channel 2;
        * then we encode green -2+3: channel 1.
        */
-      encode_alpha_block_BC3(p, block, -1);
-      encode_alpha_block_BC3(p + 8, block, -2);
-    }
-}
-
-static void
-compress_YCoCg (unsigned char       *dst,
-                const unsigned char *src,
-                int                  w,
-                int                  h)
-{
-  const unsigned int block_count = BLOCK_COUNT(w, h);
-  unsigned int i;
-  unsigned char block[64], *p;
-  int x, y;
-
-#ifdef _OPENMP
-#pragma omp parallel for schedule(dynamic, 256) private(block, p, x, y)
-#endif
-  for (i = 0; i < block_count; ++i)
-    {
-      x = (i % ((w + 3) >> 2)) << 2;
-      y = (i / ((w + 3) >> 2)) << 2;
-      p = dst + BLOCK_OFFSET(x, y, w, 16);
-      extract_block(src, x, y, w, h, block);
-      encode_alpha_block_BC3(p, block, 0);
-      encode_YCoCg_block(p + 8, block);
+      encode_alpha_block_BC3(dst, block, -1);
+      encode_alpha_block_BC3(dst + 8, block, -2);
+      break;
+    case DDS_COMPRESS_BC7:
+      /* BC7 endpoints are stored as RGBA */
+      for (i = 0; i < 16; ++i)
+        SWAP(block[i * 4 + 0], block[i * 4 + 2]);
+      bc7_compress(dst, block);
+      break;
+    case DDS_COMPRESS_YCOCGS:
+      encode_alpha_block_BC3(dst, block, 0);
+      encode_YCoCg_block(dst + 8, block);
+      break;
+    case DDS_COMPRESS_BC3:
+    case DDS_COMPRESS_BC3N:
+    case DDS_COMPRESS_RXGB:
+    case DDS_COMPRESS_AEXP:
+    case DDS_COMPRESS_YCOCG:
+    default:
+      encode_alpha_block_BC3(dst, block, 0);
+      encode_color_block(dst + 8, block, DXT_BC3 | flags);
+      break;
     }
 }
 
@@ -1019,6 +922,10 @@ dxt_compress (unsigned char *dst,
   unsigned char *tmp = NULL;
   int j;
   unsigned char *s;
+  dxt_level_t *levels;
+  int block_size;
+  int n_rows;
+  int row;
 
   if (bpp == 1)
     {
@@ -1073,6 +980,12 @@ dxt_compress (unsigned char *dst,
       bpp = 4;
     }
 
+  block_size = (format == DDS_COMPRESS_BC1 ||
+                format == DDS_COMPRESS_BC4) ? 8 : 16;
+
+  levels = g_new(dxt_level_t, mipmaps);
+  n_rows = 0;
+
   offset = 0;
   w = width;
   h = height;
@@ -1080,40 +993,51 @@ dxt_compress (unsigned char *dst,
 
   for (i = 0; i < mipmaps; ++i)
     {
-      switch (format)
-        {
-        case DDS_COMPRESS_BC1:
-          compress_BC1(dst + offset, s, w, h, flags);
-          break;
-        case DDS_COMPRESS_BC2:
-          compress_BC2(dst + offset, s, w, h, flags);
-          break;
-        case DDS_COMPRESS_BC3:
-        case DDS_COMPRESS_BC3N:
-        case DDS_COMPRESS_RXGB:
-        case DDS_COMPRESS_AEXP:
-        case DDS_COMPRESS_YCOCG:
-          compress_BC3(dst + offset, s, w, h, flags);
-          break;
-        case DDS_COMPRESS_BC4:
-          compress_BC4(dst + offset, s, w, h);
-          break;
-        case DDS_COMPRESS_BC5:
-          compress_BC5(dst + offset, s, w, h);
-          break;
-        case DDS_COMPRESS_YCOCGS:
-          compress_YCoCg(dst + offset, s, w, h);
-          break;
-        default:
-          compress_BC3(dst + offset, s, w, h, flags);
-          break;
-        }
+      levels[i].dst       = dst + offset;
+      levels[i].src       = s;
+      levels[i].w         = w;
+      levels[i].h         = h;
+      levels[i].first_row = n_rows;
+
+      n_rows += (h + 3) >> 2;
+
       s += (w * h * bpp);
       offset += get_mipmapped_size(w, h, 0, 0, 1, format);
       w = MAX(1, w >> 1);
       h = MAX(1, h >> 1);
     }
 
+  /* The rows of blocks of all the mipmap levels are distributed at once,
+   * so that the small levels don't each pay for a parallel region of
+   * their own, and no thread idles while another finishes a level.
+   */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for (row = 0; row < n_rows; ++row)
+    {
+      const dxt_level_t *level;
+      unsigned char      block[64];
+      int                l = mipmaps - 1;
+      int                x, y;
+
+      while (levels[l].first_row > row)
+        --l;
+
+      level = &levels[l];
+      y = (row - level->first_row) << 2;
+
+      for (x = 0; x < level->w; x += 4)
+        {
+          extract_block(level->src, x, y, level->w, level->h, block);
+          compress_block(level->dst +
+                         BLOCK_OFFSET(x, y, level->w, block_size),
+                         block, format, flags);
+        }
+    }
+
+  g_free(levels);
+
   if (tmp)
     g_free(tmp);
 
@@ -28,6 +28,9 @@
 #define PLUG_IN_BINARY  "file-exr"
 #define PLUG_IN_VERSION "0.0.0"
 
+/* the most pixel data read from the file at once */
+#define MAX_READ_SIZE   (64 << 20)
+
 
 typedef struct _Exr      Exr;
 typedef struct _ExrClass ExrClass;
@@ -63,6 +66,8 @@ static GimpValueArray * exr_load             (GimpProcedure         *procedure,
 static GimpImage      * load_image           (GFile                 *file,
                                               GimpMetadata          *metadata,
                                               GimpMetadataLoadFlags *flags,
+                                              gint                   part,
+                                              const gchar           *only_layer,
                                               gboolean               interactive,
                                               GError               **error);
 static void             sanitize_comment     (gchar                 *comment);
@@ -127,6 +132,21 @@ exr_create_procedure (GimpPlugIn  *plug_in,
                                           "exr");
       gimp_file_procedure_set_magics (GIMP_FILE_PROCEDURE (procedure),
                                       "0,long,0x762f3101");
+
+      gimp_procedure_add_int_argument (procedure, "part",
+                                       _("_Part"),
+                                       _("The part of a multipart file "
+                                         "to load"),
+                                       0, G_MAXINT, 0,
+                                       G_PARAM_READWRITE);
+
+      gimp_procedure_add_string_argument (procedure, "layer",
+                                          _("_Layer"),
+                                          _("The name of the only layer to "
+                                            "load, or empty to load all "
+                                            "layers"),
+                                          NULL,
+                                          G_PARAM_READWRITE);
     }
 
   return procedure;
@@ -143,13 +163,23 @@ exr_load (GimpProcedure         *procedure,
 {
   GimpValueArray *return_vals;
   GimpImage      *image;
+  gint            part;
+  gchar          *layer  = NULL;
   GError         *error  = NULL;
 
   gegl_init (NULL, NULL);
 
-  image = load_image (file, metadata, flags, run_mode == GIMP_RUN_INTERACTIVE,
+  g_object_get (config,
+                "part",  &part,
+                "layer", &layer,
+                NULL);
+
+  image = load_image (file, metadata, flags, part, layer,
+                      run_mode == GIMP_RUN_INTERACTIVE,
                       &error);
 
+  g_free (layer);
+
   if (! image)
     return gimp_procedure_new_return_values (procedure,
                                              GIMP_PDB_EXECUTION_ERROR,
@@ -168,6 +198,8 @@ static GimpImage *
 load_image (GFile                 *file,
             GimpMetadata          *metadata,
             GimpMetadataLoadFlags *flags,
+            gint                   part,
+            const gchar           *only_layer,
             gboolean               interactive,
             GError               **error)
 {
@@ -184,6 +216,7 @@ load_image (GFile                 *file,
   const Babl       *format;
   gint              bpp;
   gint              tile_height;
+  gint              n_layers_loaded = 0;
   gchar            *pixels = NULL;
   gint              begin;
   gint32            success = FALSE;
@@ -197,7 +230,11 @@ load_image (GFile                 *file,
   gimp_progress_init_printf (_("Opening '%s'"),
                              gimp_file_get_utf8_name (file));
 
-  loader = exr_loader_new (g_file_peek_path (file));
+  if (only_layer && ! *only_layer)
+    only_layer = NULL;
+
+  loader = exr_loader_new (g_file_peek_path (file), part,
+                           gimp_get_num_processors ());
 
   if (! loader)
     {
@@ -298,9 +335,19 @@ load_image (GFile                 *file,
 
       if (i > -1)
         layer_name = exr_loader_get_layer_name (loader, i);
+      else if (only_layer)
+        continue;
       else
         layer_name = _("Background");
 
+      if (only_layer && g_strcmp0 (layer_name, only_layer))
+        {
+          g_free (layer_name);
+          continue;
+        }
+
+      n_layers_loaded++;
+
       layer = gimp_layer_new (image, layer_name, width, height,
                               layer_type, 100,
                               gimp_image_get_default_new_layer_mode (image));
@@ -313,8 +360,13 @@ load_image (GFile                 *file,
       format = gimp_drawable_get_format (GIMP_DRAWABLE (layer));
       bpp = babl_format_get_bytes_per_pixel (format);
 
-      tile_height = gimp_tile_height ();
-      pixels = g_new0 (gchar, tile_height * width * bpp);
+      /* read a tile row per thread at a time, within MAX_READ_SIZE, so
+       * that OpenEXR can decode them in parallel
+       */
+      tile_height = MIN (gimp_tile_height () * gimp_get_num_processors (),
+                         MAX_READ_SIZE / ((gsize) width * bpp));
+      tile_height = CLAMP (tile_height, gimp_tile_height (), height);
+      pixels = g_new0 (gchar, (gsize) tile_height * width * bpp);
 
       for (begin = 0; begin < height; begin += tile_height)
         {
@@ -324,20 +376,13 @@ load_image (GFile                 *file,
           end = MIN (begin + tile_height, height);
           num = end - begin;
 
-          for (gint j = 0; j < num; j++)
+          if (exr_loader_read_pixel_rows (loader, pixels, bpp,
+                                          begin, num, i) < 0)
             {
-              gint retval;
-
-              retval = exr_loader_read_pixel_row (loader,
-                                                  pixels + (j * width * bpp),
-                                                  bpp, begin + j, i);
-              if (retval < 0)
-                {
-                  g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
-                               _("Error reading pixel data from '%s'"),
-                               gimp_file_get_utf8_name (file));
-                  goto out;
-                }
+              g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                           _("Error reading pixel data from '%s'"),
+                           gimp_file_get_utf8_name (file));
+              goto out;
             }
 
           gegl_buffer_set (buffer, GEGL_RECTANGLE (0, begin, width, num),
@@ -350,6 +395,14 @@ load_image (GFile                 *file,
       g_clear_pointer (&pixels, g_free);
     }
 
+  if (only_layer && n_layers_loaded == 0)
+    {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                   _("No layer named '%s' in '%s'"),
+                   only_layer, gimp_file_get_utf8_name (file));
+      goto out;
+    }
+
   /* try to read the file comment */
   comment = exr_loader_get_comment (loader);
   if (comment)
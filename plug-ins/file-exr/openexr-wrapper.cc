@@ -52,6 +52,9 @@
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated"
 #include <ImfInputFile.h>
+#include <ImfInputPart.h>
+#include <ImfMultiPartInputFile.h>
+#include <ImfThreading.h>
 #include <ImfChannelList.h>
 #include <ImfRgbaFile.h>
 #include <ImfRgbaYca.h>
@@ -76,9 +79,11 @@ static bool XYZ_equal(cmsCIEXYZ *a, cmsCIEXYZ *b)
 
 struct _EXRLoader
 {
-  _EXRLoader(const char* filename) :
+  _EXRLoader(const char* filename,
+             int         part) :
     refcount_(1),
-    file_(filename),
+    multi_file_(filename),
+    file_(multi_file_, part),
     data_window_(file_.header().dataWindow()),
     channels_(file_.header().channels())
   {
@@ -212,19 +217,22 @@ struct _EXRLoader
     return can_load_;
   }
 
-  int readPixelRow(char *pixels,
-                   int   bpp,
-                   int   row,
-                   int   layer_index)
+  int readPixelRows(char *pixels,
+                    int   bpp,
+                    int   row,
+                    int   n_rows,
+                    int   layer_index)
   {
     const int        actual_row = data_window_.min.y + row;
+    const size_t     stride     = (size_t) getWidth() * bpp;
     FrameBuffer      fb;
     std::set<string> layerNames;
     std::string      prefix     = "";
     // This is necessary because OpenEXR expects the buffer to begin at
     // (0, 0). Though it probably results in some unmapped address,
     // hopefully OpenEXR will not make use of it. :/
-    char* base = pixels - (data_window_.min.x * bpp);
+    char* base = pixels - (data_window_.min.x * bpp) -
+                 ((ptrdiff_t) actual_row * (ptrdiff_t) stride);
 
     if (layer_index > -1)
       {
@@ -236,31 +244,33 @@ struct _EXRLoader
     switch (image_type_)
       {
       case IMAGE_TYPE_UNKNOWN_1_CHANNEL:
-        fb.insert(unknown_channel_name_, Slice(pt_, base, bpp, 0, 1, 1, 0.5));
+        fb.insert(unknown_channel_name_, Slice(pt_, base, bpp, stride, 1, 1, 0.5));
         break;
 
       case IMAGE_TYPE_YUV:
       case IMAGE_TYPE_GRAY:
-        fb.insert(prefix + "Y", Slice(pt_, base, bpp, 0, 1, 1, 0.5));
+        fb.insert(prefix + "Y", Slice(pt_, base, bpp, stride, 1, 1, 0.5));
         if (hasAlpha())
           {
-            fb.insert(prefix + "A", Slice(pt_, base + bpc_, bpp, 0, 1, 1, 1.0));
+            fb.insert(prefix + "A", Slice(pt_, base + bpc_, bpp, stride, 1, 1, 1.0));
           }
         break;
 
       case IMAGE_TYPE_RGB:
       default:
-        fb.insert(prefix + "R", Slice(pt_, base + (bpc_ * 0), bpp, 0, 1, 1, 0.0));
-        fb.insert(prefix + "G", Slice(pt_, base + (bpc_ * 1), bpp, 0, 1, 1, 0.0));
-        fb.insert(prefix + "B", Slice(pt_, base + (bpc_ * 2), bpp, 0, 1, 1, 0.0));
+        fb.insert(prefix + "R", Slice(pt_, base + (bpc_ * 0), bpp, stride, 1, 1, 0.0));
+        fb.insert(prefix + "G", Slice(pt_, base + (bpc_ * 1), bpp, stride, 1, 1, 0.0));
+        fb.insert(prefix + "B", Slice(pt_, base + (bpc_ * 2), bpp, stride, 1, 1, 0.0));
         if (hasAlpha())
           {
-            fb.insert(prefix + "A", Slice(pt_, base + (bpc_ * 3), bpp, 0, 1, 1, 1.0));
+            fb.insert(prefix + "A", Slice(pt_, base + (bpc_ * 3), bpp, stride, 1, 1, 1.0));
           }
       }
 
     file_.setFrameBuffer(fb);
-    file_.readPixels(actual_row);
+    // Reading several rows at once lets OpenEXR decode their line
+    // buffers or tiles on its thread pool.
+    file_.readPixels(actual_row, actual_row + n_rows - 1);
 
     return 0;
   }
@@ -483,7 +493,8 @@ struct _EXRLoader
   }
 
   size_t refcount_;
-  InputFile file_;
+  MultiPartInputFile multi_file_;
+  InputPart file_;
   const Box2i data_window_;
   const ChannelList& channels_;
   PixelType pt_;
@@ -498,7 +509,9 @@ struct _EXRLoader
 };
 
 EXRLoader*
-exr_loader_new (const char *filename)
+exr_loader_new (const char *filename,
+                int         part,
+                int         n_threads)
 {
   EXRLoader* file;
 
@@ -506,7 +519,13 @@ exr_loader_new (const char *filename)
   try
     {
       Imf::BlobAttribute::registerAttributeType();
-      file = new EXRLoader(filename);
+
+      // The files' threads are taken from the global pool, so size it
+      // before opening the file.
+      if (n_threads != globalThreadCount())
+        setGlobalThreadCount(n_threads);
+
+      file = new EXRLoader(filename, part);
 
       if (file && ! file->canLoad())
         {
@@ -635,17 +654,18 @@ exr_loader_get_layer_info (EXRLoader *loader,
 }
 
 int
-exr_loader_read_pixel_row (EXRLoader *loader,
-                           char      *pixels,
-                           int        bpp,
-                           int        row,
-                           int        layer_index)
+exr_loader_read_pixel_rows (EXRLoader *loader,
+                            char      *pixels,
+                            int        bpp,
+                            int        row,
+                            int        n_rows,
+                            int        layer_index)
 {
   int retval = -1;
   // Don't let any exceptions propagate to the C layer.
   try
     {
-      retval = loader->readPixelRow(pixels, bpp, row, layer_index);
+      retval = loader->readPixelRows(pixels, bpp, row, n_rows, layer_index);
     }
   catch (...)
     {
@@ -41,7 +41,9 @@ typedef enum
 } EXRImageType;
 
 
-EXRLoader        * exr_loader_new            (const char *filename);
+EXRLoader        * exr_loader_new            (const char *filename,
+                                              int         part,
+                                              int         n_threads);
 
 EXRLoader        * exr_loader_ref            (EXRLoader  *loader);
 void               exr_loader_unref          (EXRLoader  *loader);
@@ -66,11 +68,12 @@ int                exr_loader_get_layer_info (EXRLoader  *loader,
                                               gint       *num_layers,
                                               gboolean   *layers_only);
 
-int                exr_loader_read_pixel_row (EXRLoader *loader,
-                                              char      *pixels,
-                                              int        bpp,
-                                              int        row,
-                                              int        layer_index);
+int                exr_loader_read_pixel_rows (EXRLoader *loader,
+                                               char      *pixels,
+                                               int        bpp,
+                                               int        row,
+                                               int        n_rows,
+                                               int        layer_index);
 
 G_END_DECLS
 
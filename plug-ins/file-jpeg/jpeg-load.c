@@ -40,12 +40,45 @@
 #include "jpeg-settings.h"
 #include "jpeg-load.h"
 
+
+#if LIBJPEG_TURBO_VERSION_NUMBER >= 1005000
+
+/*  the least number of rows each thread decodes, since every band but
+ *  the first has to skip over the rows above it
+ */
+#define ROWS_PER_BAND 512
+
+
+typedef struct
+{
+  GMappedFile                   *mapped;
+  struct jpeg_decompress_struct *cinfo;
+  guchar                        *buf;
+  gint                           rowstride;
+  gint                           failed;
+} ParallelData;
+
+#endif
+
+
 static gboolean  jpeg_load_resolution       (GimpImage *image,
                                              struct jpeg_decompress_struct
                                                        *cinfo);
 
 static void      jpeg_load_sanitize_comment (gchar    *comment);
 
+#if LIBJPEG_TURBO_VERSION_NUMBER >= 1005000
+static void      jpeg_load_silent_message   (j_common_ptr  cinfo);
+static void      jpeg_load_band             (gsize         offset,
+                                             gsize         size,
+                                             ParallelData *data);
+static gboolean  jpeg_load_parallel         (GFile        *file,
+                                             struct jpeg_decompress_struct
+                                                          *cinfo,
+                                             GeglBuffer   *buffer,
+                                             const Babl   *format);
+#endif
+
 
 GimpImage * volatile  preview_image;
 GimpLayer *           preview_layer;
@@ -54,6 +87,7 @@ GimpImage *
 load_image (GFile        *file,
             GimpRunMode   runmode,
             gboolean      preview,
+            gint          scale_denom,
             gboolean     *resolution_loaded,
             gboolean     *ps_metadata_loaded,
             GError      **error)
@@ -166,13 +200,20 @@ load_image (GFile        *file,
 
   /* Step 4: set parameters for decompression */
 
-  /* In this example, we don't need to change any of the defaults set by
-   * jpeg_read_header(), so we do nothing here, except set the DCT
-   * method.
+  /* We don't need to change any of the defaults set by jpeg_read_header(),
+   * except for the DCT method, and the output scale when loading at a
+   * reduced size.  The library scales in the DCT domain, which is much
+   * cheaper than decoding at full size and scaling afterwards.
    */
 
   cinfo.dct_method = JDCT_FLOAT;
 
+  if (scale_denom > 1)
+    {
+      cinfo.scale_num   = 1;
+      cinfo.scale_denom = scale_denom;
+    }
+
   /* Step 5: Start decompressor */
 
   jpeg_start_decompress (&cinfo);
@@ -419,6 +460,17 @@ load_image (GFile        *file,
     }
   format = babl_format_with_space (encoding, space);
 
+#if LIBJPEG_TURBO_VERSION_NUMBER >= 1005000
+  if (! preview && jpeg_load_parallel (file, &cinfo, buffer, format))
+    {
+      /*  the main decompressor hasn't read any scanlines, skip
+       *  jpeg_finish_decompress(), jpeg_destroy_decompress() below
+       *  aborts it
+       */
+      goto finish;
+    }
+#endif
+
   while (cinfo.output_scanline < cinfo.output_height)
     {
       gint     start, end;
@@ -443,8 +495,9 @@ load_image (GFile        *file,
 
       if (cinfo.data_precision <= 8 || ! support_12_bit)
         {
-          for (i = 0; i < scanlines; i++)
-            jpeg_read_scanlines (&cinfo, (JSAMPARRAY) &rowbuf[i], 1);
+          for (i = 0; i < scanlines; )
+            i += jpeg_read_scanlines (&cinfo, (JSAMPARRAY) &rowbuf[i],
+                                      scanlines - i);
         }
 #if LIBJPEG_TURBO_VERSION_NUMBER >= 3000000
       else
@@ -456,15 +509,17 @@ load_image (GFile        *file,
 
           if (cinfo.data_precision <= 12)
             {
-              for (i = 0; i < scanlines; i++)
-                jpeg12_read_scanlines (&cinfo, (J12SAMPARRAY) &rowbuf_16[i],
-                                       1);
+              for (i = 0; i < scanlines; )
+                i += jpeg12_read_scanlines (&cinfo,
+                                            (J12SAMPARRAY) &rowbuf_16[i],
+                                            scanlines - i);
             }
           else
             {
-              for (i = 0; i < scanlines; i++)
-                jpeg16_read_scanlines (&cinfo, (J16SAMPARRAY) &rowbuf_16[i],
-                                       1);
+              for (i = 0; i < scanlines; )
+                i += jpeg16_read_scanlines (&cinfo,
+                                            (J16SAMPARRAY) &rowbuf_16[i],
+                                            scanlines - i);
             }
 
           /* Normalize to 16 bit range */
@@ -608,6 +663,10 @@ jpeg_load_resolution (GimpImage                     *image,
       gdouble xresolution = cinfo->X_density;
       gdouble yresolution = cinfo->Y_density;
       gdouble asymmetry   = 1.0;
+      gdouble scale;
+
+      /*  keep the physical size of images loaded at a reduced size  */
+      scale = (gdouble) cinfo->output_width / (gdouble) cinfo->image_width;
 
       switch (cinfo->density_unit)
         {
@@ -622,11 +681,13 @@ jpeg_load_resolution (GimpImage                     *image,
           break;
 
         case 1: /* dots per inch */
+          xresolution *= scale;
+          yresolution *= scale;
           break;
 
         case 2: /* dots per cm */
-          xresolution *= 2.54;
-          yresolution *= 2.54;
+          xresolution *= 2.54 * scale;
+          yresolution *= 2.54 * scale;
           gimp_image_set_unit (image, gimp_unit_mm ());
           break;
 
@@ -670,8 +731,148 @@ jpeg_load_sanitize_comment (gchar *comment)
     }
 }
 
+#if LIBJPEG_TURBO_VERSION_NUMBER >= 1005000
+
+static void
+jpeg_load_silent_message (j_common_ptr cinfo)
+{
+}
+
+/* decodes rows [offset, offset + size) of the image with a decompressor
+ * of its own, reading the file from memory.  the rows above the band are
+ * skipped, which only entropy-decodes them.
+ */
+static void
+jpeg_load_band (gsize         offset,
+                gsize         size,
+                ParallelData *data)
+{
+  struct jpeg_decompress_struct cinfo;
+  struct my_error_mgr           jerr;
+  JSAMPROW                      rows[16];
+
+  cinfo.err = jpeg_std_error (&jerr.pub);
+  jerr.pub.error_exit     = my_error_exit;
+  jerr.pub.output_message = jpeg_load_silent_message;
+
+  if (setjmp (jerr.setjmp_buffer))
+    {
+      g_atomic_int_set (&data->failed, TRUE);
+
+      jpeg_destroy_decompress (&cinfo);
+
+      return;
+    }
+
+  jpeg_create_decompress (&cinfo);
+
+  jpeg_mem_src (&cinfo,
+                (guchar *) g_mapped_file_get_contents (data->mapped),
+                g_mapped_file_get_length (data->mapped));
+
+  jpeg_read_header (&cinfo, TRUE);
+
+  cinfo.dct_method      = data->cinfo->dct_method;
+  cinfo.scale_num       = data->cinfo->scale_num;
+  cinfo.scale_denom     = data->cinfo->scale_denom;
+  cinfo.out_color_space = data->cinfo->out_color_space;
+
+  jpeg_start_decompress (&cinfo);
+
+  if (cinfo.output_width      != data->cinfo->output_width      ||
+      cinfo.output_height     != data->cinfo->output_height     ||
+      cinfo.output_components != data->cinfo->output_components ||
+      (offset > 0 && jpeg_skip_scanlines (&cinfo, offset) != offset))
+    {
+      g_atomic_int_set (&data->failed, TRUE);
+    }
+
+  while (cinfo.output_scanline < offset + size &&
+         ! g_atomic_int_get (&data->failed))
+    {
+      gint n_rows = MIN (offset + size - cinfo.output_scanline,
+                         G_N_ELEMENTS (rows));
+      gint i;
+
+      for (i = 0; i < n_rows; i++)
+        {
+          rows[i] = data->buf +
+                    (gsize) (cinfo.output_scanline + i) * data->rowstride;
+        }
+
+      jpeg_read_scanlines (&cinfo, rows, n_rows);
+    }
+
+  /*  leave corrupt data to the serial decoder, which reports it  */
+  if (jerr.pub.num_warnings > 0)
+    g_atomic_int_set (&data->failed, TRUE);
+
+  jpeg_destroy_decompress (&cinfo);
+}
+
+/* decodes a large baseline image in bands, one per thread, each band with
+ * a decompressor of its own.  returns FALSE, leaving 'buffer' untouched,
+ * when the image should be decoded serially instead.
+ */
+static gboolean
+jpeg_load_parallel (GFile                         *file,
+                    struct jpeg_decompress_struct *cinfo,
+                    GeglBuffer                    *buffer,
+                    const Babl                    *format)
+{
+  ParallelData data;
+  gboolean     success = FALSE;
+
+  if (cinfo->progressive_mode                 ||
+      cinfo->data_precision != 8               ||
+      cinfo->output_height < 2 * ROWS_PER_BAND ||
+      gimp_get_num_processors () < 2)
+    {
+      return FALSE;
+    }
+
+  data.mapped = g_mapped_file_new (g_file_peek_path (file), FALSE, NULL);
+
+  if (! data.mapped)
+    return FALSE;
+
+  data.cinfo     = cinfo;
+  data.rowstride = cinfo->output_width * cinfo->output_components;
+  data.buf       = g_try_malloc ((gsize) data.rowstride *
+                                 cinfo->output_height);
+  data.failed    = FALSE;
+
+  if (data.buf)
+    {
+      gegl_parallel_distribute_range (
+        cinfo->output_height, ROWS_PER_BAND,
+        (GeglParallelDistributeRangeFunc) jpeg_load_band,
+        &data);
+
+      if (! data.failed)
+        {
+          gegl_buffer_set (buffer,
+                           GEGL_RECTANGLE (0, 0,
+                                           cinfo->output_width,
+                                           cinfo->output_height),
+                           0, format, data.buf, data.rowstride);
+
+          success = TRUE;
+        }
+
+      g_free (data.buf);
+    }
+
+  g_mapped_file_unref (data.mapped);
+
+  return success;
+}
+
+#endif
+
 GimpImage *
 load_thumbnail_image (GFile         *file,
+                      gint           size,
                       gint          *width,
                       gint          *height,
                       GimpImageType *type,
@@ -680,14 +881,16 @@ load_thumbnail_image (GFile         *file,
   GimpImage * volatile          image = NULL;
   struct jpeg_decompress_struct cinfo;
   struct my_error_mgr           jerr;
-  FILE                         *infile   = NULL;
+  FILE                         *infile    = NULL;
+  gboolean                      supported = TRUE;
 
   gimp_progress_init_printf (_("Opening thumbnail for '%s'"),
                              g_file_get_parse_name (file));
 
-  image = gimp_image_metadata_load_thumbnail (file, error);
-  if (! image)
-    return NULL;
+  /*  without an Exif thumbnail, we decode the image itself at a reduced
+   *  size below
+   */
+  image = gimp_image_metadata_load_thumbnail (file, NULL);
 
   cinfo.err = jpeg_std_error (&jerr.pub);
   jerr.pub.error_exit     = my_error_exit;
@@ -760,8 +963,11 @@ load_thumbnail_image (GFile         *file,
                  cinfo.output_components, cinfo.out_color_space,
                  cinfo.jpeg_color_space);
 
-      gimp_image_delete (image);
-      image = NULL;
+      if (image)
+        gimp_image_delete (image);
+
+      image     = NULL;
+      supported = FALSE;
       break;
     }
 
@@ -774,5 +980,22 @@ load_thumbnail_image (GFile         *file,
 
   fclose (infile);
 
+  if (! image && supported)
+    {
+      gboolean resolution_loaded  = FALSE;
+      gboolean ps_metadata_loaded = FALSE;
+      gint     scale_denom        = 8;
+
+      /*  use the smallest DCT scale that still covers the requested size  */
+      while (scale_denom > 1 &&
+             MAX (*width, *height) / scale_denom < size)
+        {
+          scale_denom /= 2;
+        }
+
+      image = load_image (file, GIMP_RUN_NONINTERACTIVE, FALSE, scale_denom,
+                          &resolution_loaded, &ps_metadata_loaded, error);
+    }
+
   return image;
 }
@@ -21,11 +21,13 @@
 GimpImage * load_image           (GFile         *file,
                                   GimpRunMode    runmode,
                                   gboolean       preview,
+                                  gint           scale_denom,
                                   gboolean      *resolution_loaded,
                                   gboolean      *ps_metadata_loaded,
                                   GError       **error);
 
 GimpImage * load_thumbnail_image (GFile         *file,
+                                  gint           size,
                                   gint          *width,
                                   gint          *height,
                                   GimpImageType *type,
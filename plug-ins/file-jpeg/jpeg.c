@@ -152,6 +152,13 @@ jpeg_create_procedure (GimpPlugIn  *plug_in,
 
       gimp_load_procedure_set_thumbnail_loader (GIMP_LOAD_PROCEDURE (procedure),
                                                 LOAD_THUMB_PROC);
+
+      gimp_procedure_add_int_argument (procedure, "reduce",
+                                       _("_Reduce by"),
+                                       _("Load the image at 1/N of its size, "
+                                         "scaling while decoding"),
+                                       1, 8, 1,
+                                       G_PARAM_READWRITE);
     }
   else if (! strcmp (name, LOAD_THUMB_PROC))
     {
@@ -161,8 +168,9 @@ jpeg_create_procedure (GimpPlugIn  *plug_in,
 
       gimp_procedure_set_documentation (procedure,
                                         _("Loads a thumbnail from a JPEG image"),
-                                        _("Loads a thumbnail from a JPEG image, "
-                                          "if one exists"),
+                                        _("Loads the Exif thumbnail of a JPEG "
+                                          "image, or decodes the image itself "
+                                          "at a reduced size if it has none"),
                                         name);
       gimp_procedure_set_attribution (procedure,
                                       "Mukund Sivaraman <muks@mukund.org>, "
@@ -334,10 +342,15 @@ jpeg_load (GimpProcedure         *procedure,
   GimpImage      *image;
   gboolean        resolution_loaded  = FALSE;
   gboolean        ps_metadata_loaded = FALSE;
+  gint            reduce;
   GError         *error              = NULL;
 
   gegl_init (NULL, NULL);
 
+  g_object_get (config,
+                "reduce", &reduce,
+                NULL);
+
   preview_image = NULL;
   preview_layer = NULL;
 
@@ -352,7 +365,7 @@ jpeg_load (GimpProcedure         *procedure,
       break;
     }
 
-  image = load_image (file, run_mode, FALSE,
+  image = load_image (file, run_mode, FALSE, reduce,
                       &resolution_loaded, &ps_metadata_loaded, &error);
 
   if (image)
@@ -394,7 +407,7 @@ jpeg_load_thumb (GimpProcedure       *procedure,
   preview_image = NULL;
   preview_layer = NULL;
 
-  image = load_thumbnail_image (file, &width, &height, &type,
+  image = load_thumbnail_image (file, size, &width, &height, &type,
                                 &error);
 
 
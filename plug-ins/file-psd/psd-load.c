@@ -39,6 +39,23 @@
 
 #define COMP_MODE_SIZE sizeof(guint16)
 
+/* the amount of layer channel data, compressed and decoded, that is read
+ * ahead of the layers being added, so that the channels of several layers
+ * can be decoded in parallel.
+ */
+#define LAYER_BATCH_SIZE (256 << 20)
+
+typedef struct
+{
+  PSDchannel *channel;
+  guint16     bps;
+  guint16     compression;
+  guint32    *rle_pack_len;  /* RLE packed row lengths */
+  gchar      *src;           /* channel data, as read from the file */
+  guint32     src_len;
+  GError     *error;
+} ChannelData;
+
 typedef struct
 {
   gint32  group_index; /* first layer from the top that has clipping */
@@ -84,6 +101,16 @@ static gint             add_image_resources        (GimpImage      *image,
                                                     gboolean       *profile_loaded,
                                                     GError        **error);
 
+static gint             read_layer_batch           (PSDimage       *img_a,
+                                                    PSDlayer      **lyr_a,
+                                                    gint            first,
+                                                    PSDchannel   ***layer_chn,
+                                                    gboolean       *layer_empty_mask,
+                                                    GInputStream   *input,
+                                                    GError        **error);
+static void             add_layer_info             (GimpImage      *image,
+                                                    PSDimage       *img_a,
+                                                    PSDlayer      **lyr_a);
 static gint             add_layers                 (GimpImage      *image,
                                                     PSDimage       *img_a,
                                                     PSDlayer      **lyr_a,
@@ -127,11 +154,22 @@ static void             free_lyr_chn               (PSDchannel    **lyr_chn,
                                                     gint            channel_count);
 
 static gboolean         read_RLE_channel           (PSDimage       *img_a,
-                                                    PSDchannel     *lyr_chn,
+                                                    ChannelData    *chn_data,
                                                     guint64         channel_data_len,
                                                     GInputStream   *input,
                                                     GError        **error);
 
+static gint             read_channel_src           (ChannelData    *chn_data,
+                                                    GInputStream   *input,
+                                                    guint32         comp_len,
+                                                    GError        **error);
+static gint             decode_channel_src         (ChannelData    *chn_data,
+                                                    GError        **error);
+static void             decode_channels            (gsize           offset,
+                                                    gsize           size,
+                                                    ChannelData    *chn_data);
+static void             free_channel_data          (ChannelData    *chn_data);
+
 static gint             read_channel_data          (PSDchannel     *channel,
                                                     guint16         bps,
                                                     guint16         compression,
@@ -169,6 +207,7 @@ load_image (GFile        *file,
   GInputStream  *input;
   PSDimage       img_a;
   PSDlayer     **lyr_a;
+  PSDSupport     layer_features;
   GimpImage     *image = NULL;
   GError        *error = NULL;
 
@@ -177,6 +216,7 @@ load_image (GFile        *file,
   img_a.cmyk_profile = NULL;
 
   initialize_unsupported (unsupported_features);
+  initialize_unsupported (&layer_features);
   img_a.unsupported_features = unsupported_features;
 
   /* ----- Open PSD file ----- */
@@ -231,8 +271,17 @@ load_image (GFile        *file,
   IFDBG(2) g_debug ("Read layer & mask block at offset %" G_GOFFSET_FORMAT,
                     PSD_TELL(input));
   img_a.mask_layer_len = 0;
+
+  /* Only the layer records are read along with the merged image, don't
+   * report the features of layers that won't be loaded.
+   */
+  if (merged_image_only)
+    img_a.unsupported_features = &layer_features;
+
   lyr_a = read_layer_block (&img_a, input, &error);
 
+  img_a.unsupported_features = unsupported_features;
+
   if (merged_image_only)
     {
       if (error)
@@ -285,8 +334,24 @@ load_image (GFile        *file,
 
   /* ----- Add layers -----*/
   IFDBG(2) g_debug ("Add layers");
-  if (add_layers (image, &img_a, lyr_a, input, &error) < 0)
-    goto load_error;
+  if (merged_image_only)
+    {
+      add_layer_info (image, &img_a, lyr_a);
+    }
+  else
+    {
+      gint result;
+
+      /* Add all layers as one batch, instead of updating the image
+       * for each of them
+       */
+      gimp_image_freeze_layers (image);
+      result = add_layers (image, &img_a, lyr_a, input, &error);
+      gimp_image_thaw_layers (image);
+
+      if (result < 0)
+        goto load_error;
+    }
   gimp_progress_update (0.9);
 
   /* ----- Add merged image data and extra alpha channels ----- */
@@ -799,7 +864,7 @@ read_layer_info (PSDimage      *img_a,
       img_a->num_layers = -img_a->num_layers;
     }
 
-  if (! img_a->merged_image_only && img_a->num_layers)
+  if (img_a->num_layers)
     {
       /* Read layer records */
       PSDlayerres  res_a;
@@ -1783,15 +1848,16 @@ psd_convert_lab_to_srgb (PSDimage *img_a,
 
 static gboolean
 read_RLE_channel (PSDimage      *img_a,
-                  PSDchannel    *lyr_chn,
+                  ChannelData   *chn_data,
                   guint64        channel_data_len,
                   GInputStream  *input,
                   GError       **error)
 {
-  gint      rle_count_size = (img_a->version == 1 ? 2 : 4);
-  gint      rle_row_size   = lyr_chn->rows * rle_count_size;
-  guint32  *rle_pack_len;
-  gint      rowi;
+  PSDchannel *lyr_chn        = chn_data->channel;
+  gint        rle_count_size = (img_a->version == 1 ? 2 : 4);
+  gint        rle_row_size   = lyr_chn->rows * rle_count_size;
+  guint32    *rle_pack_len;
+  gint        rowi;
 
   IFDBG(4) g_debug ("RLE channel length %" G_GSIZE_FORMAT
                     ", RLE length data: %d, "
@@ -1819,16 +1885,14 @@ read_RLE_channel (PSDimage      *img_a,
                              GUINT32_FROM_BE (rle_pack_len[rowi]);
     }
 
-  if (read_channel_data (lyr_chn, img_a->bps,
-                         PSD_COMP_RLE, rle_pack_len, input, 0,
-                         error) < 1)
+  chn_data->rle_pack_len = rle_pack_len;
+
+  if (read_channel_src (chn_data, input, 0, error) < 1)
     {
       psd_set_error (error);
-      g_free (rle_pack_len);
       return FALSE;
     }
 
-  g_free (rle_pack_len);
   return TRUE;
 }
 
@@ -2029,75 +2093,97 @@ mark_clipping_groups (PSDimage  *img_a,
   g_array_free (clipping_group_stack, FALSE);
 }
 
-static gint
-add_layers (GimpImage     *image,
-            PSDimage      *img_a,
-            PSDlayer     **lyr_a,
-            GInputStream  *input,
-            GError       **error)
+/* When only the merged image is loaded, the layer records are still read,
+ * without any of the layer pixels, and an outline of the layers is
+ * attached to the image as the "psd-layers" parasite, one line per layer,
+ * from the bottom up:
+ *
+ *   <group type> <x> <y> <width> <height> <visible> <opacity> <name>
+ *
+ * where the name is escaped as by g_strescape().  This lets the layers be
+ * listed quickly, and the file be loaded in full only when they are needed.
+ */
+static void
+add_layer_info (GimpImage  *image,
+                PSDimage   *img_a,
+                PSDlayer  **lyr_a)
 {
-  PSDchannel          **lyr_chn;
-  GArray               *parent_group_stack;
-  GimpLayer            *parent_group = NULL;
-  guint16               alpha_chn;
-  guint16               user_mask_chn;
-  guint16               layer_channels, base_channels;
-  guint16               channel_idx[MAX_CHANNELS];
-  guint16               bps;
-  gint32                l_x;                   /* Layer x */
-  gint32                l_y;                   /* Layer y */
-  gint32                l_w;                   /* Layer width */
-  gint32                l_h;                   /* Layer height */
-  gint32                lm_x;                  /* Layer mask x */
-  gint32                lm_y;                  /* Layer mask y */
-  gint32                lm_w;                  /* Layer mask width */
-  gint32                lm_h;                  /* Layer mask height */
-  GimpLayer            *layer           = NULL;
-  GimpLayerMask        *mask            = NULL;
-  GList                *selected_layers = NULL;
-  gint                  lidx;                  /* Layer index */
-  gint                  cidx;                  /* Channel index */
-  gboolean              alpha;
-  gboolean              user_mask;
-  gboolean              empty;
-  gboolean              empty_mask;
-  GeglBuffer           *buffer;
-  GimpImageType         image_type;
-  LayerModeInfo         mode_info;
+  GimpParasite *parasite;
+  GString      *info;
+  gint          lidx;
 
+  if (! lyr_a)
+    return;
 
-  IFDBG(2) g_debug ("Number of layers: %d", img_a->num_layers);
+  info = g_string_new (NULL);
 
-  if (img_a->merged_image_only || img_a->num_layers == 0)
+  for (lidx = 0; lidx < img_a->num_layers; ++lidx)
     {
-      IFDBG(2) g_debug ("No layers to process");
-      return 0;
-    }
+      gchar *name;
 
-  /* Layered image - Photoshop 3 style */
-  if (! psd_seek (input, img_a->layer_data_start, G_SEEK_SET, error))
-    {
-      psd_set_error (error);
-      return -1;
-    }
+      if (! lyr_a[lidx])
+        continue;
 
-  mark_clipping_groups (img_a, lyr_a);
+      name = g_strescape (lyr_a[lidx]->name ? lyr_a[lidx]->name : "", NULL);
 
-  /* set the root of the group hierarchy */
-  parent_group_stack = g_array_new (FALSE, FALSE, sizeof (GimpLayer *));
-  g_array_append_val (parent_group_stack, parent_group);
+      g_string_append_printf (info, "%d %d %d %d %d %d %d %s\n",
+                              lyr_a[lidx]->group_type,
+                              lyr_a[lidx]->left,
+                              lyr_a[lidx]->top,
+                              lyr_a[lidx]->right - lyr_a[lidx]->left,
+                              lyr_a[lidx]->bottom - lyr_a[lidx]->top,
+                              lyr_a[lidx]->layer_flags.visible,
+                              lyr_a[lidx]->opacity,
+                              name);
 
-  for (lidx = 0; lidx < img_a->num_layers; ++lidx)
+      g_free (name);
+
+      g_free (lyr_a[lidx]->chn_info);
+      g_free (lyr_a[lidx]->name);
+      g_free (lyr_a[lidx]->layer_styles);
+      g_free (lyr_a[lidx]);
+    }
+  g_free (lyr_a);
+
+  if (info->len > 0)
     {
-      IFDBG(2) g_debug ("Process Layer No %d (%s).", lidx, lyr_a[lidx]->name);
+      parasite = gimp_parasite_new (PSD_PARASITE_LAYERS, 0,
+                                    info->len + 1, info->str);
+      gimp_image_attach_parasite (image, parasite);
+      gimp_parasite_free (parasite);
+    }
 
-      /* Empty layer */
-      if (lyr_a[lidx]->bottom - lyr_a[lidx]->top == 0
-          || lyr_a[lidx]->right - lyr_a[lidx]->left == 0)
-          empty = TRUE;
-      else
-          empty = FALSE;
+  g_string_free (info, TRUE);
+}
 
+/* reads the channel data of the layers from 'first' on, until about
+ * LAYER_BATCH_SIZE bytes have been read, and decodes all their channels
+ * in parallel.  returns the index of the layer following the batch, or -1
+ * on error.
+ */
+static gint
+read_layer_batch (PSDimage       *img_a,
+                  PSDlayer      **lyr_a,
+                  gint            first,
+                  PSDchannel   ***layer_chn,
+                  gboolean       *layer_empty_mask,
+                  GInputStream   *input,
+                  GError        **error)
+{
+  PSDchannel **lyr_chn;
+  GArray      *batch;
+  guint64      batch_size = 0;
+  gint         lidx;                  /* Layer index */
+  gint         cidx;                  /* Channel index */
+  gint         i;
+  gboolean     empty_mask;
+
+  batch = g_array_new (FALSE, TRUE, sizeof (ChannelData));
+
+  for (lidx = first;
+       lidx < img_a->num_layers && batch_size < LAYER_BATCH_SIZE;
+       ++lidx)
+    {
       /* Empty mask */
       if (lyr_a[lidx]->layer_mask.bottom - lyr_a[lidx]->layer_mask.top == 0
           || lyr_a[lidx]->layer_mask.right - lyr_a[lidx]->layer_mask.left == 0)
@@ -2113,6 +2199,7 @@ add_layers (GimpImage     *image,
       IFDBG(2) g_debug ("Number of channels: %d", lyr_a[lidx]->num_channels);
       /* Create pointer array for the channel records */
       lyr_chn = g_new0 (PSDchannel *, lyr_a[lidx]->num_channels);
+      layer_chn[lidx] = lyr_chn;
       for (cidx = 0; cidx < lyr_a[lidx]->num_channels; ++cidx)
         {
           guint16 comp_mode = PSD_COMP_RAW;
@@ -2131,8 +2218,7 @@ add_layers (GimpImage     *image,
                               G_SEEK_CUR, error))
                 {
                   psd_set_error (error);
-                  free_lyr_chn (lyr_chn, lyr_a[lidx]->num_channels);
-                  return -1;
+                  goto error;
                 }
 
               continue;
@@ -2176,8 +2262,7 @@ add_layers (GimpImage     *image,
               if (psd_read (input, &comp_mode, COMP_MODE_SIZE, error) < COMP_MODE_SIZE)
                 {
                   psd_set_error (error);
-                  free_lyr_chn (lyr_chn, lyr_a[lidx]->num_channels);
-                  return -1;
+                  goto error;
                 }
 
               if (! img_a->ibm_pc_format)
@@ -2188,55 +2273,201 @@ add_layers (GimpImage     *image,
             }
           if (lyr_a[lidx]->chn_info[cidx].data_len > COMP_MODE_SIZE)
             {
+              ChannelData chn_data = { 0, };
+
+              chn_data.channel     = lyr_chn[cidx];
+              chn_data.bps         = img_a->bps;
+              chn_data.compression = comp_mode;
+
               switch (comp_mode)
                 {
                   case PSD_COMP_RAW:        /* Planar raw data */
                     IFDBG(3) g_debug ("Raw data length: %" G_GSIZE_FORMAT,
                                       lyr_a[lidx]->chn_info[cidx].data_len - 2);
-                    if (read_channel_data (lyr_chn[cidx], img_a->bps,
-                                           PSD_COMP_RAW, NULL, input, 0,
-                                           error) < 1)
+                    if (read_channel_src (&chn_data, input, 0, error) < 1)
                       {
                         psd_set_error (error);
-                        free_lyr_chn (lyr_chn, lyr_a[lidx]->num_channels);
-                        return -1;
+                        goto error;
                       }
                     break;
 
                   case PSD_COMP_RLE:        /* Packbits */
-                    if (! read_RLE_channel (img_a, lyr_chn[cidx],
+                    if (! read_RLE_channel (img_a, &chn_data,
                                             lyr_a[lidx]->chn_info[cidx].data_len,
                                             input, error))
                       {
                         psd_set_error (error);
-                        free_lyr_chn (lyr_chn, lyr_a[lidx]->num_channels);
-                        return -1;
+                        free_channel_data (&chn_data);
+                        goto error;
                       }
                     break;
 
                   case PSD_COMP_ZIP:                 /* ? */
                   case PSD_COMP_ZIP_PRED:
-                    if (read_channel_data (lyr_chn[cidx], img_a->bps,
-                                           comp_mode, NULL, input,
-                                           lyr_a[lidx]->chn_info[cidx].data_len - 2,
-                                           error) < 1)
+                    if (read_channel_src (&chn_data, input,
+                                          lyr_a[lidx]->chn_info[cidx].data_len - 2,
+                                          error) < 1)
                       {
                         psd_set_error (error);
-                        free_lyr_chn (lyr_chn, lyr_a[lidx]->num_channels);
-                        return -1;
+                        goto error;
                       }
                     break;
 
                   default:
                     g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
                                  _("Unsupported compression mode: %d"), comp_mode);
-                    free_lyr_chn (lyr_chn, lyr_a[lidx]->num_channels);
-                    return -1;
+                    goto error;
                     break;
                 }
+
+              g_array_append_val (batch, chn_data);
+
+              batch_size += chn_data.src_len;
+              batch_size += (guint64) lyr_chn[cidx]->rows    *
+                                      lyr_chn[cidx]->columns *
+                                      MAX (img_a->bps / 8, 1);
+            }
+        }
+
+      layer_empty_mask[lidx] = empty_mask;
+    }
+
+  if (batch->len > 0)
+    {
+      gegl_parallel_distribute_range (
+        batch->len, 1,
+        (GeglParallelDistributeRangeFunc) decode_channels,
+        batch->data);
+    }
+
+  for (i = 0; i < batch->len; i++)
+    {
+      ChannelData *chn_data = &g_array_index (batch, ChannelData, i);
+
+      if (chn_data->error)
+        {
+          g_propagate_error (error, g_steal_pointer (&chn_data->error));
+          goto error;
+        }
+    }
+
+  g_array_free (batch, TRUE);
+
+  return lidx;
+
+error:
+  for (i = 0; i < batch->len; i++)
+    free_channel_data (&g_array_index (batch, ChannelData, i));
+  g_array_free (batch, TRUE);
+
+  for (i = first; i < img_a->num_layers; i++)
+    {
+      if (layer_chn[i])
+        {
+          for (cidx = 0; cidx < lyr_a[i]->num_channels; ++cidx)
+            if (layer_chn[i][cidx])
+              g_free (layer_chn[i][cidx]->data);
+
+          free_lyr_chn (layer_chn[i], lyr_a[i]->num_channels);
+          layer_chn[i] = NULL;
+        }
+    }
+
+  return -1;
+}
+
+static gint
+add_layers (GimpImage     *image,
+            PSDimage      *img_a,
+            PSDlayer     **lyr_a,
+            GInputStream  *input,
+            GError       **error)
+{
+  PSDchannel         ***layer_chn;
+  PSDchannel          **lyr_chn;
+  gboolean             *layer_empty_mask;
+  gint                  batch_end       = 0;
+  GArray               *parent_group_stack;
+  GimpLayer            *parent_group = NULL;
+  guint16               alpha_chn;
+  guint16               user_mask_chn;
+  guint16               layer_channels, base_channels;
+  guint16               channel_idx[MAX_CHANNELS];
+  guint16               bps;
+  gint32                l_x;                   /* Layer x */
+  gint32                l_y;                   /* Layer y */
+  gint32                l_w;                   /* Layer width */
+  gint32                l_h;                   /* Layer height */
+  gint32                lm_x;                  /* Layer mask x */
+  gint32                lm_y;                  /* Layer mask y */
+  gint32                lm_w;                  /* Layer mask width */
+  gint32                lm_h;                  /* Layer mask height */
+  GimpLayer            *layer           = NULL;
+  GimpLayerMask        *mask            = NULL;
+  GList                *selected_layers = NULL;
+  gint                  lidx;                  /* Layer index */
+  gint                  cidx;                  /* Channel index */
+  gboolean              alpha;
+  gboolean              user_mask;
+  gboolean              empty;
+  gboolean              empty_mask;
+  GeglBuffer           *buffer;
+  GimpImageType         image_type;
+  LayerModeInfo         mode_info;
+
+
+  IFDBG(2) g_debug ("Number of layers: %d", img_a->num_layers);
+
+  if (img_a->merged_image_only || img_a->num_layers == 0)
+    {
+      IFDBG(2) g_debug ("No layers to process");
+      return 0;
+    }
+
+  /* Layered image - Photoshop 3 style */
+  if (! psd_seek (input, img_a->layer_data_start, G_SEEK_SET, error))
+    {
+      psd_set_error (error);
+      return -1;
+    }
+
+  mark_clipping_groups (img_a, lyr_a);
+
+  /* set the root of the group hierarchy */
+  parent_group_stack = g_array_new (FALSE, FALSE, sizeof (GimpLayer *));
+  g_array_append_val (parent_group_stack, parent_group);
+
+  layer_chn        = g_new0 (PSDchannel **, img_a->num_layers);
+  layer_empty_mask = g_new0 (gboolean, img_a->num_layers);
+
+  for (lidx = 0; lidx < img_a->num_layers; ++lidx)
+    {
+      IFDBG(2) g_debug ("Process Layer No %d (%s).", lidx, lyr_a[lidx]->name);
+
+      /* Empty layer */
+      if (lyr_a[lidx]->bottom - lyr_a[lidx]->top == 0
+          || lyr_a[lidx]->right - lyr_a[lidx]->left == 0)
+          empty = TRUE;
+      else
+          empty = FALSE;
+
+      /* Load layer channel data, a batch of layers at a time */
+      if (lidx == batch_end)
+        {
+          batch_end = read_layer_batch (img_a, lyr_a, lidx,
+                                        layer_chn, layer_empty_mask,
+                                        input, error);
+          if (batch_end < 0)
+            {
+              g_free (layer_chn);
+              g_free (layer_empty_mask);
+              return -1;
             }
         }
 
+      lyr_chn    = layer_chn[lidx];
+      empty_mask = layer_empty_mask[lidx];
+
       /* Draw layer */
 
       alpha = FALSE;
@@ -2747,6 +2978,7 @@ add_layers (GimpImage     *image,
         }
 
       free_lyr_chn (lyr_chn, lyr_a[lidx]->num_channels);
+      layer_chn[lidx] = NULL;
 
       g_free (lyr_a[lidx]->chn_info);
       g_free (lyr_a[lidx]->name);
@@ -2754,6 +2986,8 @@ add_layers (GimpImage     *image,
       g_free (lyr_a[lidx]);
     }
   g_free (lyr_a);
+  g_free (layer_chn);
+  g_free (layer_empty_mask);
   g_array_free (parent_group_stack, FALSE);
 
   /* Set the selected layers */
@@ -3431,18 +3665,16 @@ zzfree (voidpf opaque, voidpf address)
 }
 
 static gint
-read_channel_data (PSDchannel     *channel,
-                   guint16         bps,
-                   guint16         compression,
-                   const guint32  *rle_pack_len,
-                   GInputStream   *input,
-                   guint32         comp_len,
-                   GError        **error)
+read_channel_src (ChannelData   *chn_data,
+                  GInputStream  *input,
+                  guint32        comp_len,
+                  GError       **error)
 {
-  gchar    *raw_data = NULL;
-  gchar    *src;
-  guint32   readline_len;
-  gint      i, j;
+  PSDchannel *channel = chn_data->channel;
+  guint16     bps     = chn_data->bps;
+  guint64     src_len;
+  guint32     readline_len;
+  gint        i;
 
   if (bps == 1)
     readline_len = ((channel->columns + 7) / 8);
@@ -3461,58 +3693,91 @@ read_channel_data (PSDchannel     *channel,
       return -1;
     }
 
-  raw_data = g_malloc (readline_len * channel->rows);
-  switch (compression)
+  switch (chn_data->compression)
     {
       case PSD_COMP_RAW:
-        if (psd_read (input, raw_data, readline_len * channel->rows, error) < readline_len * channel->rows)
-          {
-            psd_set_error (error);
-            g_free (raw_data);
-            return -1;
-          }
+        src_len = (guint64) readline_len * channel->rows;
         break;
 
       case PSD_COMP_RLE:
+        /* the packed rows are stored back to back, read them at once */
+        src_len = 0;
+        for (i = 0; i < channel->rows; ++i)
+          src_len += chn_data->rle_pack_len[i];
+        break;
+
+      default:
+        src_len = comp_len;
+        break;
+    }
+
+  if (src_len > G_MAXINT32)
+    {
+      psd_set_error (error);
+      return -1;
+    }
+
+  chn_data->src     = g_try_malloc (MAX (src_len, 1));
+  chn_data->src_len = src_len;
+
+  if (! chn_data->src ||
+      psd_read (input, chn_data->src, src_len, error) < (gint) src_len)
+    {
+      psd_set_error (error);
+      g_clear_pointer (&chn_data->src, g_free);
+      return -1;
+    }
+
+  return 1;
+}
+
+/* decompresses and converts the data read by read_channel_src().  this
+ * doesn't touch the input stream, and may be called from any thread.
+ */
+static gint
+decode_channel_src (ChannelData  *chn_data,
+                    GError      **error)
+{
+  PSDchannel *channel  = chn_data->channel;
+  guint16     bps      = chn_data->bps;
+  gchar      *raw_data = NULL;
+  gchar      *src;
+  guint32     readline_len;
+  gint        i, j;
+
+  if (bps == 1)
+    readline_len = ((channel->columns + 7) / 8);
+  else
+    readline_len = (channel->columns * bps / 8);
+
+  switch (chn_data->compression)
+    {
+      case PSD_COMP_RAW:
+        raw_data      = chn_data->src;
+        chn_data->src = NULL;
+        break;
+
+      case PSD_COMP_RLE:
+        raw_data = g_malloc (readline_len * channel->rows);
+        src      = chn_data->src;
         for (i = 0; i < channel->rows; ++i)
           {
-            src = gegl_scratch_alloc (rle_pack_len[i]);
-/*      FIXME check for over-run
-            if (PSD_TELL(input) + rle_pack_len[i] > block_end)
-              {
-                psd_set_error (TRUE, errno, error);
-                return -1;
-              }
-*/
-            if (psd_read (input, src, rle_pack_len[i], error) < rle_pack_len[i])
-              {
-                psd_set_error (error);
-                gegl_scratch_free (src);
-                g_free (raw_data);
-                return -1;
-              }
             /* FIXME check for errors returned from decode packbits */
             decode_packbits (src, raw_data + i * readline_len,
-                             rle_pack_len[i], readline_len);
-            gegl_scratch_free (src);
+                             chn_data->rle_pack_len[i], readline_len);
+            src += chn_data->rle_pack_len[i];
           }
         break;
+
       case PSD_COMP_ZIP:
       case PSD_COMP_ZIP_PRED:
         {
           z_stream zs;
 
-          src = g_malloc (comp_len);
-          if (psd_read (input, src, comp_len, error) < comp_len)
-            {
-              psd_set_error (error);
-              g_free (src);
-              g_free (raw_data);
-              return -1;
-            }
+          raw_data = g_malloc (readline_len * channel->rows);
 
-          zs.next_in = (guchar*) src;
-          zs.avail_in = comp_len;
+          zs.next_in = (guchar*) chn_data->src;
+          zs.avail_in = chn_data->src_len;
           zs.next_out = (guchar*) raw_data;
           zs.avail_out = readline_len * channel->rows;
           zs.zalloc = zzalloc;
@@ -3527,16 +3792,16 @@ read_channel_data (PSDchannel     *channel,
             {
               g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
                            _("Failed to decompress data"));
-              g_free (src);
+              g_clear_pointer (&chn_data->src, g_free);
               g_free (raw_data);
               return -1;
             }
-
-          g_free (src);
           break;
         }
     }
 
+  g_clear_pointer (&chn_data->src, g_free);
+
   /* Convert channel data to GIMP format */
   switch (bps)
     {
@@ -3545,7 +3810,7 @@ read_channel_data (PSDchannel     *channel,
         guint32 *data;
         guint64  pos;
 
-        if (compression == PSD_COMP_ZIP_PRED)
+        if (chn_data->compression == PSD_COMP_ZIP_PRED)
           {
             IFDBG(3) g_debug ("Converting 32 bit predictor data");
             channel->data = (gchar *) g_malloc0 (channel->rows * channel->columns * 4);
@@ -3576,7 +3841,7 @@ read_channel_data (PSDchannel     *channel,
         for (i = 0; i < channel->rows * channel->columns; ++i)
           data[i] = GUINT16_FROM_BE (data[i]);
 
-        if (compression == PSD_COMP_ZIP_PRED)
+        if (chn_data->compression == PSD_COMP_ZIP_PRED)
           {
             IFDBG(3) g_debug ("Converting 16 bit predictor data");
             for (i = 0; i < channel->rows; ++i)
@@ -3590,7 +3855,7 @@ read_channel_data (PSDchannel     *channel,
         channel->data = raw_data;
         raw_data      = NULL;
 
-        if (compression == PSD_COMP_ZIP_PRED)
+        if (chn_data->compression == PSD_COMP_ZIP_PRED)
           {
             IFDBG(3) g_debug ("Converting 8 bit predictor data");
             for (i = 0; i < channel->rows; ++i)
@@ -3615,6 +3880,58 @@ read_channel_data (PSDchannel     *channel,
   return 1;
 }
 
+static void
+decode_channels (gsize        offset,
+                 gsize        size,
+                 ChannelData *chn_data)
+{
+  gsize i;
+
+  for (i = offset; i < offset + size; i++)
+    {
+      if (decode_channel_src (&chn_data[i], &chn_data[i].error) < 1)
+        psd_set_error (&chn_data[i].error);
+    }
+}
+
+static void
+free_channel_data (ChannelData *chn_data)
+{
+  g_free (chn_data->src);
+  g_free (chn_data->rle_pack_len);
+  g_clear_error (&chn_data->error);
+}
+
+static gint
+read_channel_data (PSDchannel     *channel,
+                   guint16         bps,
+                   guint16         compression,
+                   const guint32  *rle_pack_len,
+                   GInputStream   *input,
+                   guint32         comp_len,
+                   GError        **error)
+{
+  ChannelData chn_data = { 0, };
+  gint        result;
+
+  chn_data.channel     = channel;
+  chn_data.bps         = bps;
+  chn_data.compression = compression;
+
+  if (rle_pack_len)
+    chn_data.rle_pack_len = g_memdup2 (rle_pack_len,
+                                       channel->rows * sizeof (guint32));
+
+  result = read_channel_src (&chn_data, input, comp_len, error);
+
+  if (result > 0)
+    result = decode_channel_src (&chn_data, error);
+
+  free_channel_data (&chn_data);
+
+  return result;
+}
+
 /*
  * For reference on zip predictor see:
  * - TIFFTN3d1.pdf
@@ -169,7 +169,10 @@ psd_create_procedure (GimpPlugIn  *plug_in,
                                           "PSD and PSB file formats"),
                                         _("This plug-in loads the merged image "
                                           "data in Adobe Photoshop (TM) native "
-                                          "PSD and PSB format."),
+                                          "PSD and PSB format. The layer "
+                                          "pixels are not decoded, but an "
+                                          "outline of the layers is attached "
+                                          "as the \"psd-layers\" parasite."),
                                         name);
       gimp_procedure_set_attribution (procedure,
                                       "Ell",
@@ -334,6 +334,15 @@ darktable_create_procedure (GimpPlugIn  *plug_in,
           gimp_load_procedure_set_thumbnail_loader (GIMP_LOAD_PROCEDURE (procedure),
                                                     LOAD_THUMB_PROC);
 
+          gimp_procedure_add_boolean_argument (procedure, "quick-open",
+                                               _("_Quick open"),
+                                               _("Open the JPEG preview embedded "
+                                                 "in the raw file, if there is "
+                                                 "one, instead of developing "
+                                                 "the raw"),
+                                               FALSE,
+                                               G_PARAM_READWRITE);
+
           g_free (load_proc);
           g_free (load_blurb);
           g_free (load_help);
@@ -355,10 +364,20 @@ darktable_load (GimpProcedure         *procedure,
                 gpointer               run_data)
 {
   GimpValueArray *return_vals;
-  GimpImage      *image;
+  GimpImage      *image = NULL;
   GError         *error = NULL;
+  gboolean        quick_open;
+
+  g_object_get (config, "quick-open", &quick_open, NULL);
+
+  /* for culling, the camera's own preview is good enough, and only
+   * takes a moment to load
+   */
+  if (quick_open)
+    image = file_raw_load_embedded_preview (file, 0, NULL, NULL);
 
-  image = load_image (file, run_mode, &error);
+  if (! image)
+    image = load_image (file, run_mode, &error);
 
   if (! image)
     return gimp_procedure_new_return_values (procedure,
@@ -390,7 +409,10 @@ darktable_load_thumb (GimpProcedure       *procedure,
   width  = size;
   height = size;
 
-  image = load_thumbnail_image (file, width, &width, &height, &error);
+  image = file_raw_load_embedded_preview (file, size, &width, &height);
+
+  if (! image)
+    image = load_thumbnail_image (file, size, &width, &height, &error);
 
   if (! image)
     return gimp_procedure_new_return_values (procedure,
@@ -32,6 +32,8 @@
 
 #include <libgimp/gimp.h>
 
+#include "libgimp/stdplugins-intl.h"
+
 #include "file-raw-utils.h"
 
 
@@ -151,3 +153,145 @@ file_raw_get_executable_path (const gchar *main_executable,
 
   return g_strdup (main_executable);
 }
+
+/*
+ * Loads the JPEG preview that cameras embed in their raw files, without
+ * developing the raw at all.  With a @min_size > 0, the smallest preview
+ * that is at least that large is used, and it is decoded at about that
+ * size; otherwise the largest one, usually the full-size preview, is
+ * loaded as is.  The dimensions of the raw image are returned in @width
+ * and @height, if they are known.
+ *
+ * Returns NULL if the file has no JPEG preview, so that the caller can
+ * fall back to developing the raw.
+ */
+GimpImage *
+file_raw_load_embedded_preview (GFile *file,
+                                gint   min_size,
+                                gint  *width,
+                                gint  *height)
+{
+  GimpMetadata             *metadata;
+  GExiv2PreviewProperties **props;
+  GExiv2PreviewProperties  *best      = NULL;
+  guint32                   best_size = 0;
+  GExiv2PreviewImage       *preview;
+  GdkPixbufLoader          *loader;
+  GdkPixbuf                *pixbuf    = NULL;
+  GimpImage                *image     = NULL;
+  const guint8             *data;
+  guint32                   data_size;
+  gint                      i;
+
+  metadata = gimp_metadata_load_from_file (file, NULL);
+
+  if (! metadata)
+    return NULL;
+
+  props = gexiv2_metadata_get_preview_properties (GEXIV2_METADATA (metadata));
+
+  for (i = 0; props && props[i]; i++)
+    {
+      guint32  size = MAX (gexiv2_preview_properties_get_width  (props[i]),
+                           gexiv2_preview_properties_get_height (props[i]));
+      gboolean better;
+
+      if (g_strcmp0 (gexiv2_preview_properties_get_mime_type (props[i]),
+                     "image/jpeg"))
+        continue;
+
+      if (! best)
+        better = TRUE;
+      else if (min_size > 0 && best_size >= min_size)
+        better = (size >= min_size && size < best_size);
+      else
+        better = (size > best_size);
+
+      if (better)
+        {
+          best      = props[i];
+          best_size = size;
+        }
+    }
+
+  if (! best)
+    {
+      g_object_unref (metadata);
+
+      return NULL;
+    }
+
+  preview = gexiv2_metadata_try_get_preview_image (GEXIV2_METADATA (metadata),
+                                                   best, NULL);
+
+  if (preview)
+    {
+      data = gexiv2_preview_image_get_data (preview, &data_size);
+
+      loader = gdk_pixbuf_loader_new_with_mime_type ("image/jpeg", NULL);
+
+      if (loader)
+        {
+          /*  let the JPEG decoder scale down while decoding  */
+          if (min_size > 0 && best_size > min_size)
+            {
+              gdouble scale = (gdouble) min_size / best_size;
+
+              gdk_pixbuf_loader_set_size (loader,
+                                          MAX (1, gexiv2_preview_properties_get_width  (best) * scale),
+                                          MAX (1, gexiv2_preview_properties_get_height (best) * scale));
+            }
+
+          if (gdk_pixbuf_loader_write (loader, data, data_size, NULL) &&
+              gdk_pixbuf_loader_close (loader, NULL))
+            {
+              pixbuf = gdk_pixbuf_loader_get_pixbuf (loader);
+
+              if (pixbuf)
+                g_object_ref (pixbuf);
+            }
+          else
+            {
+              gdk_pixbuf_loader_close (loader, NULL);
+            }
+
+          g_object_unref (loader);
+        }
+
+      g_object_unref (preview);
+    }
+
+  if (pixbuf)
+    {
+      GimpLayer *layer;
+
+      image = gimp_image_new (gdk_pixbuf_get_width  (pixbuf),
+                              gdk_pixbuf_get_height (pixbuf),
+                              GIMP_RGB);
+
+      layer = gimp_layer_new_from_pixbuf (image, _("Background"), pixbuf,
+                                          100.0,
+                                          gimp_image_get_default_new_layer_mode (image),
+                                          0.0, 1.0);
+      gimp_image_insert_layer (image, layer, NULL, 0);
+
+      if (width && height)
+        {
+          *width  = gexiv2_metadata_get_pixel_width  (GEXIV2_METADATA (metadata));
+          *height = gexiv2_metadata_get_pixel_height (GEXIV2_METADATA (metadata));
+
+          if (*width <= 0 || *height <= 0)
+            {
+              *width  = gdk_pixbuf_get_width  (pixbuf);
+              *height = gdk_pixbuf_get_height (pixbuf);
+            }
+        }
+
+      g_object_unref (pixbuf);
+    }
+
+  /*  the preview properties belong to the metadata  */
+  g_object_unref (metadata);
+
+  return image;
+}
@@ -22,12 +22,17 @@
 #define __FILE_RAW_UTILS_H__
 
 
-gchar * file_raw_get_executable_path (const gchar *main_executable,
-                                      const gchar *suffix,
-                                      const gchar *env_variable,
-                                      const gchar *mac_bundle_id,
-                                      const gchar *win32_registry_key_base,
-                                      gboolean    *search_path);
+gchar     * file_raw_get_executable_path   (const gchar *main_executable,
+                                            const gchar *suffix,
+                                            const gchar *env_variable,
+                                            const gchar *mac_bundle_id,
+                                            const gchar *win32_registry_key_base,
+                                            gboolean    *search_path);
+
+GimpImage * file_raw_load_embedded_preview (GFile       *file,
+                                            gint         min_size,
+                                            gint        *width,
+                                            gint        *height);
 
 
 #endif /* __FILE_RAW_UTILS_H__ */
@@ -243,6 +243,15 @@ rawtherapee_create_procedure (GimpPlugIn  *plug_in,
           gimp_load_procedure_set_thumbnail_loader (GIMP_LOAD_PROCEDURE (procedure),
                                                     LOAD_THUMB_PROC);
 
+          gimp_procedure_add_boolean_argument (procedure, "quick-open",
+                                               _("_Quick open"),
+                                               _("Open the JPEG preview embedded "
+                                                 "in the raw file, if there is "
+                                                 "one, instead of developing "
+                                                 "the raw"),
+                                               FALSE,
+                                               G_PARAM_READWRITE);
+
           g_free (load_proc);
           g_free (load_blurb);
           g_free (load_help);
@@ -264,10 +273,20 @@ rawtherapee_load (GimpProcedure         *procedure,
                   gpointer               run_data)
 {
   GimpValueArray *return_vals;
-  GimpImage      *image;
+  GimpImage      *image = NULL;
   GError         *error = NULL;
+  gboolean        quick_open;
 
-  image = load_image (file, run_mode, &error);
+  g_object_get (config, "quick-open", &quick_open, NULL);
+
+  /* for culling, the camera's own preview is good enough, and only
+   * takes a moment to load
+   */
+  if (quick_open)
+    image = file_raw_load_embedded_preview (file, 0, NULL, NULL);
+
+  if (! image)
+    image = load_image (file, run_mode, &error);
 
   if (! image)
     return gimp_procedure_new_return_values (procedure,
@@ -292,9 +311,14 @@ rawtherapee_load_thumb (GimpProcedure       *procedure,
 {
   GimpValueArray *return_vals;
   GimpImage      *image;
-  GError         *error = NULL;
+  gint            width  = 0;
+  gint            height = 0;
+  GError         *error  = NULL;
 
-  image = load_thumbnail_image (file, size, &error);
+  image = file_raw_load_embedded_preview (file, size, &width, &height);
+
+  if (! image)
+    image = load_thumbnail_image (file, size, &error);
 
   if (! image)
     return gimp_procedure_new_return_values (procedure,
@@ -306,8 +330,8 @@ rawtherapee_load_thumb (GimpProcedure       *procedure,
                                                   NULL);
 
   GIMP_VALUES_SET_IMAGE (return_vals, 1, image);
-  GIMP_VALUES_SET_INT   (return_vals, 2, 0);
-  GIMP_VALUES_SET_INT   (return_vals, 3, 0);
+  GIMP_VALUES_SET_INT   (return_vals, 2, width);
+  GIMP_VALUES_SET_INT   (return_vals, 3, height);
   GIMP_VALUES_SET_ENUM  (return_vals, 4, GIMP_RGB_IMAGE);
   GIMP_VALUES_SET_INT   (return_vals, 5, 1);
 
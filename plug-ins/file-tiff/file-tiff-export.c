@@ -49,6 +49,11 @@
 
 #include <tiffio.h>
 #include <gexiv2/gexiv2.h>
+#include <zlib.h>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 
 #include <libgimp/gimp.h>
 #include <libgimp/gimpui.h>
@@ -62,6 +67,29 @@
 
 #define PLUG_IN_ROLE "gimp-file-tiff-export"
 
+/* TIFF tiles must be a multiple of 16 pixels, this one is also a multiple
+ * of GIMP's own tiles
+ */
+#define TILE_SIZE  256
+
+/* libtiff's default Zstandard level */
+#define ZSTD_LEVEL 9
+
+
+typedef struct
+{
+  const guchar  *band;
+  gint           band_stride;
+  gint           tile_stride;
+  gint           bps;
+  gint           spp;
+  gushort        compression;
+  gushort        predictor;
+  guchar       **encoded;
+  gsize         *encoded_size;
+  gint           failed;
+} TileData;
+
 
 static gboolean  save_paths             (TIFF          *tif,
                                          GimpImage     *image,
@@ -75,6 +103,24 @@ static void      byte2bit               (const guchar  *byteline,
                                          guchar        *bitline,
                                          gboolean       invert);
 
+static void      save_tiles_extract     (TileData      *data,
+                                         gint           x,
+                                         guchar        *tile);
+static void      save_tiles_predict     (TileData      *data,
+                                         guchar        *tile);
+static void      save_tiles_encode      (gsize          offset,
+                                         gsize          size,
+                                         TileData      *data);
+static gboolean  save_tiles             (TIFF          *tif,
+                                         GeglBuffer    *buffer,
+                                         const Babl    *format,
+                                         gushort        compression,
+                                         gshort         bitspersample,
+                                         gshort         samplesperpixel,
+                                         gdouble        progress_base,
+                                         gdouble        progress_fraction,
+                                         GError       **error);
+
 
 static void
 double_to_psd_fixed (gdouble  value,
@@ -324,6 +370,7 @@ save_layer (TIFF        *tif,
   gboolean          config_save_geotiff_tags;
   gboolean          config_save_profile;
   gboolean          config_cmyk;
+  gboolean          config_tiled;
 
   g_object_get (config,
                 "gimp-comment",            &config_comment,
@@ -332,6 +379,7 @@ save_layer (TIFF        *tif,
                 "save-geotiff",            &config_save_geotiff_tags,
                 "include-color-profile",   &config_save_profile,
                 "cmyk",                    &config_cmyk,
+                "tiled",                   &config_tiled,
                 NULL);
 
   config_compression = gimp_procedure_config_get_choice_id (GIMP_PROCEDURE_CONFIG (config), "compression");
@@ -773,8 +821,22 @@ save_layer (TIFF        *tif,
 
   TIFFSetField (tif, TIFFTAG_PHOTOMETRIC, photometric);
   TIFFSetField (tif, TIFFTAG_SAMPLESPERPIXEL, samplesperpixel);
-  TIFFSetField (tif, TIFFTAG_ROWSPERSTRIP, rowsperstrip);
-  /* TIFFSetField( tif, TIFFTAG_STRIPBYTECOUNTS, rows / rowsperstrip ); */
+
+  /*  bilevel images are packed a row at a time, and stay in strips  */
+  if (is_bw)
+    config_tiled = FALSE;
+
+  if (config_tiled)
+    {
+      TIFFSetField (tif, TIFFTAG_TILEWIDTH,  TILE_SIZE);
+      TIFFSetField (tif, TIFFTAG_TILELENGTH, TILE_SIZE);
+    }
+  else
+    {
+      TIFFSetField (tif, TIFFTAG_ROWSPERSTRIP, rowsperstrip);
+      /* TIFFSetField( tif, TIFFTAG_STRIPBYTECOUNTS, rows / rowsperstrip ); */
+    }
+
   TIFFSetField (tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
 
   /* resolution fields */
@@ -814,63 +876,73 @@ save_layer (TIFF        *tif,
   if (page == 0)
     save_paths (tif, orig_image, cols, rows, offset_x, offset_y);
 
-  /* array to rearrange data */
-  src  = g_new (guchar, bytesperrow * tile_height);
-  data = g_new (guchar, bytesperrow);
-
-  /* Now write the TIFF data. */
-  for (y = 0; y < rows; y = yend)
+  if (config_tiled)
     {
-      yend = y + tile_height;
-      yend = MIN (yend, rows);
-
-      gegl_buffer_get (buffer,
-                       GEGL_RECTANGLE (0, y, cols, yend - y), 1.0,
-                       format, src,
-                       GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+      if (! save_tiles (tif, buffer, format, compression,
+                        bitspersample, samplesperpixel,
+                        progress_base, progress_fraction, error))
+        goto out;
+    }
+  else
+    {
+      /* array to rearrange data */
+      src  = g_new (guchar, bytesperrow * tile_height);
+      data = g_new (guchar, bytesperrow);
 
-      for (row = y; row < yend; row++)
+      /* Now write the TIFF data. */
+      for (y = 0; y < rows; y = yend)
         {
-          guchar *t = src + bytesperrow * (row - y);
+          yend = y + tile_height;
+          yend = MIN (yend, rows);
 
-          switch (drawable_type)
+          gegl_buffer_get (buffer,
+                           GEGL_RECTANGLE (0, y, cols, yend - y), 1.0,
+                           format, src,
+                           GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
+
+          for (row = y; row < yend; row++)
             {
-            case GIMP_INDEXED_IMAGE:
-            case GIMP_INDEXEDA_IMAGE:
-              if (is_bw)
-                {
-                  byte2bit (t, bytesperrow, data, invert);
-                  success = (TIFFWriteScanline (tif, data, row, 0) >= 0);
-                }
-              else
+              guchar *t = src + bytesperrow * (row - y);
+
+              switch (drawable_type)
                 {
+                case GIMP_INDEXED_IMAGE:
+                case GIMP_INDEXEDA_IMAGE:
+                  if (is_bw)
+                    {
+                      byte2bit (t, bytesperrow, data, invert);
+                      success = (TIFFWriteScanline (tif, data, row, 0) >= 0);
+                    }
+                  else
+                    {
+                      success = (TIFFWriteScanline (tif, t, row, 0) >= 0);
+                    }
+                  break;
+
+                case GIMP_GRAY_IMAGE:
+                case GIMP_GRAYA_IMAGE:
+                case GIMP_RGB_IMAGE:
+                case GIMP_RGBA_IMAGE:
                   success = (TIFFWriteScanline (tif, t, row, 0) >= 0);
-                }
-              break;
+                  break;
 
-            case GIMP_GRAY_IMAGE:
-            case GIMP_GRAYA_IMAGE:
-            case GIMP_RGB_IMAGE:
-            case GIMP_RGBA_IMAGE:
-              success = (TIFFWriteScanline (tif, t, row, 0) >= 0);
-              break;
+                default:
+                  success = FALSE;
+                  break;
+                }
 
-            default:
-              success = FALSE;
-              break;
+              if (!success)
+                {
+                  g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                               _("Failed a scanline write on row %d"), row);
+                  goto out;
+                }
             }
 
-          if (!success)
-            {
-              g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
-                           _("Failed a scanline write on row %d"), row);
-              goto out;
-            }
+          if ((row % 32) == 0)
+            gimp_progress_update (progress_base + progress_fraction
+                                  * (gdouble) row / (gdouble) rows);
         }
-
-      if ((row % 32) == 0)
-        gimp_progress_update (progress_base + progress_fraction
-                              * (gdouble) row / (gdouble) rows);
     }
 
   /* Save GeoTIFF tags to file, if available */
@@ -1354,6 +1426,7 @@ save_dialog (GimpImage     *image,
     gimp_procedure_dialog_fill (GIMP_PROCEDURE_DIALOG (dialog),
                                 "big-tif-warning",
                                 "compression",
+                                "tiled",
                                 "bigtiff",
                                 "layers-frame",
                                 "save-transparent-pixels",
@@ -1362,6 +1435,7 @@ save_dialog (GimpImage     *image,
   else
     gimp_procedure_dialog_fill (GIMP_PROCEDURE_DIALOG (dialog),
                                 "compression",
+                                "tiled",
                                 "bigtiff",
                                 "layers-frame",
                                 "save-transparent-pixels",
@@ -1430,3 +1504,267 @@ byte2bit (const guchar *byteline,
       *bitline = invert ? ~bitval & (0xff << (8 - width)) : bitval;
     }
 }
+
+/* copies the x-th tile of the band into 'tile' */
+static void
+save_tiles_extract (TileData *data,
+                    gint      x,
+                    guchar   *tile)
+{
+  const guchar *src = data->band + (gsize) x * data->tile_stride;
+  gint          row;
+
+  for (row = 0; row < TILE_SIZE; row++)
+    {
+      memcpy (tile, src, data->tile_stride);
+
+      tile += data->tile_stride;
+      src  += data->band_stride;
+    }
+}
+
+/* applies the horizontal differencing predictor to 'tile', as libtiff
+ * would when compressing it itself
+ */
+static void
+save_tiles_predict (TileData *data,
+                    guchar   *tile)
+{
+  gint n = TILE_SIZE * data->spp;
+  gint row;
+  gint i;
+
+  for (row = 0; row < TILE_SIZE; row++)
+    {
+      switch (data->bps)
+        {
+        case 8:
+          {
+            guint8 *p = tile;
+
+            for (i = n - 1; i >= data->spp; i--)
+              p[i] -= p[i - data->spp];
+          }
+          break;
+
+        case 16:
+          {
+            guint16 *p = (guint16 *) tile;
+
+            for (i = n - 1; i >= data->spp; i--)
+              p[i] -= p[i - data->spp];
+          }
+          break;
+
+        case 32:
+          {
+            guint32 *p = (guint32 *) tile;
+
+            for (i = n - 1; i >= data->spp; i--)
+              p[i] -= p[i - data->spp];
+          }
+          break;
+        }
+
+      tile += data->tile_stride;
+    }
+}
+
+/* compresses tiles [offset, offset + size) of the band */
+static void
+save_tiles_encode (gsize     offset,
+                   gsize     size,
+                   TileData *data)
+{
+  gsize   tile_size = (gsize) data->tile_stride * TILE_SIZE;
+  guchar *tile      = g_malloc (tile_size);
+  gsize   x;
+
+  for (x = offset; x < offset + size; x++)
+    {
+      save_tiles_extract (data, x, tile);
+
+      if (data->predictor == PREDICTOR_HORIZONTAL)
+        save_tiles_predict (data, tile);
+
+      switch (data->compression)
+        {
+        case COMPRESSION_ADOBE_DEFLATE:
+          {
+            uLongf length = compressBound (tile_size);
+
+            data->encoded[x] = g_malloc (length);
+
+            if (compress2 (data->encoded[x], &length, tile, tile_size,
+                           Z_DEFAULT_COMPRESSION) != Z_OK)
+              {
+                g_atomic_int_set (&data->failed, TRUE);
+              }
+
+            data->encoded_size[x] = length;
+          }
+          break;
+
+#if defined (HAVE_ZSTD) && defined (COMPRESSION_ZSTD)
+        case COMPRESSION_ZSTD:
+          {
+            gsize length = ZSTD_compressBound (tile_size);
+
+            data->encoded[x] = g_malloc (length);
+
+            length = ZSTD_compress (data->encoded[x], length, tile, tile_size,
+                                    ZSTD_LEVEL);
+
+            if (ZSTD_isError (length))
+              g_atomic_int_set (&data->failed, TRUE);
+            else
+              data->encoded_size[x] = length;
+          }
+          break;
+#endif
+
+        default:
+          g_atomic_int_set (&data->failed, TRUE);
+          break;
+        }
+    }
+
+  g_free (tile);
+}
+
+/* writes the image a row of tiles at a time, so that only one such row is
+ * ever held in memory.  deflate and zstd tiles are compressed here, in
+ * parallel, and written raw; libtiff compresses the others itself, one
+ * tile at a time.
+ */
+static gboolean
+save_tiles (TIFF        *tif,
+            GeglBuffer  *buffer,
+            const Babl  *format,
+            gushort      compression,
+            gshort       bitspersample,
+            gshort       samplesperpixel,
+            gdouble      progress_base,
+            gdouble      progress_fraction,
+            GError     **error)
+{
+  TileData  data;
+  gint      cols         = gegl_buffer_get_width  (buffer);
+  gint      rows         = gegl_buffer_get_height (buffer);
+  gint      tiles_across = (cols + TILE_SIZE - 1) / TILE_SIZE;
+  gsize     tile_size;
+  gboolean  parallel;
+  guchar   *band;
+  guchar   *tile         = NULL;
+  gint      y;
+  gint      x;
+
+  data.bps          = bitspersample;
+  data.spp          = samplesperpixel;
+  data.compression  = compression;
+  data.tile_stride  = TILE_SIZE * babl_format_get_bytes_per_pixel (format);
+  data.band_stride  = tiles_across * data.tile_stride;
+  data.encoded      = NULL;
+  data.encoded_size = NULL;
+
+  TIFFGetFieldDefaulted (tif, TIFFTAG_PREDICTOR, &data.predictor);
+
+  tile_size = (gsize) data.tile_stride * TILE_SIZE;
+
+  parallel = (compression == COMPRESSION_ADOBE_DEFLATE
+#if defined (HAVE_ZSTD) && defined (COMPRESSION_ZSTD)
+              || compression == COMPRESSION_ZSTD
+#endif
+              );
+
+  /*  leave predictors we don't implement, and their errors, to libtiff  */
+  if (data.predictor != PREDICTOR_NONE &&
+      (data.predictor != PREDICTOR_HORIZONTAL || data.bps > 32))
+    {
+      parallel = FALSE;
+    }
+
+  band = g_malloc ((gsize) data.band_stride * TILE_SIZE);
+
+  data.band = band;
+
+  if (parallel)
+    {
+      data.encoded      = g_new0 (guchar *, tiles_across);
+      data.encoded_size = g_new0 (gsize,    tiles_across);
+    }
+  else
+    {
+      tile = g_malloc (tile_size);
+    }
+
+  for (y = 0; y < rows; y += TILE_SIZE)
+    {
+      gboolean success = TRUE;
+
+      /*  pixels past the image's edges are read as zeros  */
+      gegl_buffer_get (buffer,
+                       GEGL_RECTANGLE (0, y, tiles_across * TILE_SIZE,
+                                       TILE_SIZE), 1.0,
+                       format, band,
+                       data.band_stride, GEGL_ABYSS_NONE);
+
+      if (parallel)
+        {
+          data.failed = FALSE;
+
+          gegl_parallel_distribute_range (
+            tiles_across, 1,
+            (GeglParallelDistributeRangeFunc) save_tiles_encode,
+            &data);
+
+          success = ! data.failed;
+
+          for (x = 0; x < tiles_across; x++)
+            {
+              if (success &&
+                  TIFFWriteRawTile (tif,
+                                    TIFFComputeTile (tif, x * TILE_SIZE, y,
+                                                     0, 0),
+                                    data.encoded[x],
+                                    data.encoded_size[x]) == -1)
+                {
+                  success = FALSE;
+                }
+
+              g_clear_pointer (&data.encoded[x], g_free);
+            }
+        }
+      else
+        {
+          for (x = 0; x < tiles_across && success; x++)
+            {
+              save_tiles_extract (&data, x, tile);
+
+              success = (TIFFWriteEncodedTile (tif,
+                                               TIFFComputeTile (tif,
+                                                                x * TILE_SIZE,
+                                                                y, 0, 0),
+                                               tile, tile_size) != -1);
+            }
+        }
+
+      if (! success)
+        {
+          g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                       _("Failed a tile write on row %d"), y);
+          break;
+        }
+
+      gimp_progress_update (progress_base + progress_fraction *
+                            (gdouble) MIN (y + TILE_SIZE, rows) /
+                            (gdouble) rows);
+    }
+
+  g_free (band);
+  g_free (tile);
+  g_free (data.encoded);
+  g_free (data.encoded_size);
+
+  return y >= rows;
+}
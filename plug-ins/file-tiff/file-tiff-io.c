@@ -31,8 +31,15 @@
 
 #include "file-tiff-io.h"
 
+#include "libgimp/stdplugins-intl.h"
+
 static gboolean tiff_file_size_error = FALSE;
 
+/*  libtiff's message handlers are global, only the thread which opened
+ *  the first handle may report messages through GIMP
+ */
+static GThread *tiff_main_thread     = NULL;
+
 typedef struct
 {
   GFile         *file;
@@ -85,70 +92,109 @@ register_geotags (TIFF *tif)
 }
 
 
-static TiffIO tiff_io = { 0, };
-
-
 TIFF *
 tiff_open (GFile        *file,
            const gchar  *mode,
            GError      **error)
 {
+  TiffIO *io;
+  TIFF   *tif;
+
   TIFFSetWarningHandler ((TIFFErrorHandler) tiff_io_warning);
   TIFFSetErrorHandler ((TIFFErrorHandler) tiff_io_error);
 
   parent_extender = TIFFSetTagExtender (register_geotags);
 
-  tiff_io.file = file;
+  if (! tiff_main_thread)
+    tiff_main_thread = g_thread_self ();
+
+  io = g_new0 (TiffIO, 1);
+
+  io->file = file;
 
   if (! strcmp (mode, "r"))
     {
-      tiff_io.input = G_INPUT_STREAM (g_file_read (file, NULL, error));
-      if (! tiff_io.input)
-        return NULL;
+      io->input = G_INPUT_STREAM (g_file_read (file, NULL, error));
 
-      tiff_io.stream = G_OBJECT (tiff_io.input);
+      io->stream = G_OBJECT (io->input);
     }
   else if(! strcmp (mode, "w") || ! strcmp (mode, "w8"))
     {
-      tiff_io.output = G_OUTPUT_STREAM (g_file_replace (file,
-                                                        NULL, FALSE,
-                                                        G_FILE_CREATE_NONE,
-                                                        NULL, error));
-      if (! tiff_io.output)
-        return NULL;
-
-      tiff_io.stream = G_OBJECT (tiff_io.output);
+      io->output = G_OUTPUT_STREAM (g_file_replace (file,
+                                                    NULL, FALSE,
+                                                    G_FILE_CREATE_NONE,
+                                                    NULL, error));
+
+      io->stream = G_OBJECT (io->output);
     }
   else if(! strcmp (mode, "a"))
     {
       GIOStream *iostream = G_IO_STREAM (g_file_open_readwrite (file, NULL,
                                                                 error));
-      if (! iostream)
-        return NULL;
-
-      tiff_io.input  = g_io_stream_get_input_stream (iostream);
-      tiff_io.output = g_io_stream_get_output_stream (iostream);
-      tiff_io.stream = G_OBJECT (iostream);
+      if (iostream)
+        {
+          io->input  = g_io_stream_get_input_stream (iostream);
+          io->output = g_io_stream_get_output_stream (iostream);
+          io->stream = G_OBJECT (iostream);
+        }
     }
   else
     {
       g_assert_not_reached ();
     }
 
+  if (! io->stream)
+    {
+      g_free (io);
+
+      return NULL;
+    }
+
 #if 0
 #warning FIXME !can_seek code is broken
-  tiff_io.can_seek = g_seekable_can_seek (G_SEEKABLE (tiff_io.stream));
+  io->can_seek = g_seekable_can_seek (G_SEEKABLE (io->stream));
 #endif
-  tiff_io.can_seek = TRUE;
-
-  return TIFFClientOpen ("file-tiff", mode,
-                         (thandle_t) &tiff_io,
-                         tiff_io_read,
-                         tiff_io_write,
-                         tiff_io_seek,
-                         tiff_io_close,
-                         tiff_io_get_file_size,
-                         NULL, NULL);
+  io->can_seek = TRUE;
+
+  tif = TIFFClientOpen ("file-tiff", mode,
+                        (thandle_t) io,
+                        tiff_io_read,
+                        tiff_io_write,
+                        tiff_io_seek,
+                        tiff_io_close,
+                        tiff_io_get_file_size,
+                        NULL, NULL);
+
+  /*  libtiff doesn't close the handle when failing to open it  */
+  if (! tif)
+    tiff_io_close ((thandle_t) io);
+
+  return tif;
+}
+
+/* opens another handle to the file 'tif' was opened from, at the same
+ * directory, so that the two can be read from different threads.
+ */
+TIFF *
+tiff_open_clone (TIFF    *tif,
+                 GError **error)
+{
+  TiffIO *io = (TiffIO *) TIFFClientdata (tif);
+  TIFF   *clone;
+
+  clone = tiff_open (io->file, "r", error);
+
+  if (clone && ! TIFFSetSubDirectory (clone, TIFFCurrentDirOffset (tif)))
+    {
+      TIFFClose (clone);
+
+      g_set_error_literal (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                           _("Could not read the TIFF directory"));
+
+      return NULL;
+    }
+
+  return clone;
 }
 
 gboolean
@@ -172,6 +218,16 @@ tiff_io_warning (const gchar *module,
 {
   gint tag = 0;
 
+  if (g_thread_self () != tiff_main_thread)
+    {
+      gchar *msg = g_strdup_vprintf (fmt, ap);
+
+      g_printerr ("LibTiff warning: [%s] %s\n", module, msg);
+      g_free (msg);
+
+      return;
+    }
+
   if (max_msgs_per_instance > 0)
     max_msgs_per_instance--;
   else
@@ -287,6 +343,16 @@ tiff_io_error (const gchar *module,
 {
   gchar *msg;
 
+  if (g_thread_self () != tiff_main_thread)
+    {
+      msg = g_strdup_vprintf (fmt, ap);
+
+      g_printerr ("LibTiff error: [%s] %s\n", module, msg);
+      g_free (msg);
+
+      return;
+    }
+
   if (max_msgs_per_instance > 0)
     max_msgs_per_instance--;
   else
@@ -550,16 +616,9 @@ tiff_io_close (thandle_t handle)
     }
 
   g_object_unref (io->stream);
-  io->stream = NULL;
-  io->input  = NULL;
-  io->output = NULL;
 
   g_free (io->buffer);
-  io->buffer = NULL;
-
-  io->allocated = 0;
-  io->used      = 0;
-  io->position  = 0;
+  g_free (io);
 
   return closed ? 0 : -1;
 }
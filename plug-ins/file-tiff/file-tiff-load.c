@@ -67,6 +67,12 @@
 /* Custom constant for extended Alias/Sketchbook metadata */
 #define TIFFTAG_ALIAS_LAYER_METADATA_2 50787
 
+/* The maximal number of handles decoding tiles in parallel, and the
+ * number of tiles each of them decodes between progress updates
+ */
+#define MAX_THREADS      64
+#define TILES_PER_THREAD 4
+
 typedef struct
 {
   GimpDrawable *drawable;
@@ -91,8 +97,35 @@ typedef enum
   GIMP_TIFF_GRAY_MINISWHITE,
 } TiffColorMode;
 
+typedef struct
+{
+  TIFF          **tifs;
+  ChannelData    *channel;
+  const Babl     *src_format;
+  gushort         bps;
+  gushort         spp;
+  TiffColorMode   tiff_mode;
+  gboolean        is_signed;
+  gint            extra;
+  gint            bytes_per_pixel;
+  gboolean        needs_upscale;
+  guint32         image_width;
+  guint32         image_height;
+  guint32         tile_width;
+  guint32         tile_height;
+  guint32         first_tile;
+  guint32         n_tiles;
+  gint            failed_row;
+} ContiguousData;
+
 /* Declare some local functions */
 
+static gboolean    is_better_thumbnail      (TIFF                *tif,
+                                            guint32              page_width,
+                                            guint32              page_height,
+                                            gint                 size,
+                                            gint                *best_size);
+
 static GimpColorProfile * load_profile     (TIFF                *tif);
 
 static void               load_rgba        (TIFF                *tif,
@@ -105,6 +138,15 @@ static void               load_contiguous  (TIFF                *tif,
                                             TiffColorMode        tiff_mode,
                                             gboolean             is_signed,
                                             gint                 extra);
+static gboolean      load_contiguous_tile  (ContiguousData      *data,
+                                            gint                 thread,
+                                            guint32              x,
+                                            guint32              y,
+                                            guchar              *buffer,
+                                            guchar              *bw_buffer);
+static void          load_contiguous_tiles (gint                 i,
+                                            gint                 n,
+                                            ContiguousData      *data);
 static void               load_separate    (TIFF                *tif,
                                             ChannelData         *channel,
                                             const Babl          *type,
@@ -1103,6 +1145,9 @@ load_image (GimpProcedure        *procedure,
               case COMPRESSION_JPEG:
               case COMPRESSION_CCITTFAX3:
               case COMPRESSION_CCITTFAX4:
+#ifdef COMPRESSION_ZSTD
+              case COMPRESSION_ZSTD:
+#endif
                 break;
 
               case COMPRESSION_OJPEG:
@@ -1215,6 +1260,10 @@ load_image (GimpProcedure        *procedure,
         gimp_config_writer_printf (writer, "%d", gimp_compression);
         gimp_config_writer_close (writer);
 
+        gimp_config_writer_open (writer, "tiled");
+        gimp_config_writer_identifier (writer, TIFFIsTiled (tif) ? "yes" : "no");
+        gimp_config_writer_close (writer);
+
         gimp_config_writer_finish (writer, NULL, NULL);
 
         parasite = gimp_parasite_new ("GimpProcedureConfig-file-tiff-save-last",
@@ -1871,6 +1920,215 @@ load_image (GimpProcedure        *procedure,
   return GIMP_PDB_SUCCESS;
 }
 
+/* loads a thumbnail from the reduced-resolution images of the first page:
+ * its SubIFDs, or the following pages marked FILETYPE_REDUCEDIMAGE, as
+ * written by pyramidal TIFF writers and digital cameras.  the smallest
+ * one that is at least 'size' pixels large is read, or the largest one
+ * if none is.  files without reduced images are left to the full loader.
+ */
+GimpImage *
+load_thumbnail_image (GFile          *file,
+                      gint            size,
+                      gint           *width,
+                      gint           *height,
+                      GimpImageType  *type,
+                      GError        **error)
+{
+  TIFF       *tif;
+  guint32     page_width;
+  guint32     page_height;
+  gushort     photomet;
+  gushort     extra;
+  gushort    *extra_types;
+  gushort     n_subifds;
+  toff_t     *subifds;
+  toff_t     *offsets     = NULL;
+  toff_t      best_offset = 0;
+  tdir_t      best_dir    = 0;
+  gint        best_size   = 0;
+  tdir_t      n_dirs;
+  tdir_t      dir;
+  guint32     thumb_width;
+  guint32     thumb_height;
+  guint32    *raster;
+  GimpImage  *image       = NULL;
+  GimpLayer  *layer;
+  GeglBuffer *buffer;
+  gint        i;
+
+  tif = tiff_open (file, "r", error);
+  if (! tif)
+    return NULL;
+
+  if (! TIFFGetField (tif, TIFFTAG_IMAGEWIDTH,  &page_width) ||
+      ! TIFFGetField (tif, TIFFTAG_IMAGELENGTH, &page_height))
+    {
+      g_set_error_literal (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                           "Could not get image width or height");
+      TIFFClose (tif);
+      return NULL;
+    }
+
+  *width  = page_width;
+  *height = page_height;
+
+  TIFFGetFieldDefaulted (tif, TIFFTAG_PHOTOMETRIC, &photomet);
+  if (! TIFFGetField (tif, TIFFTAG_EXTRASAMPLES, &extra, &extra_types))
+    extra = 0;
+
+  if (photomet == PHOTOMETRIC_MINISBLACK ||
+      photomet == PHOTOMETRIC_MINISWHITE)
+    *type = extra ? GIMP_GRAYA_IMAGE : GIMP_GRAY_IMAGE;
+  else
+    *type = extra ? GIMP_RGBA_IMAGE : GIMP_RGB_IMAGE;
+
+  /*  the SubIFD offsets are only valid while the first page is current  */
+  if (TIFFGetField (tif, TIFFTAG_SUBIFD, &n_subifds, &subifds))
+    offsets = g_memdup2 (subifds, n_subifds * sizeof (toff_t));
+  else
+    n_subifds = 0;
+
+  for (i = 0; i < n_subifds; i++)
+    {
+      if (TIFFSetSubDirectory (tif, offsets[i]) &&
+          is_better_thumbnail (tif, page_width, page_height, size,
+                               &best_size))
+        {
+          best_offset = offsets[i];
+        }
+    }
+
+  g_free (offsets);
+
+  n_dirs = TIFFNumberOfDirectories (tif);
+
+  for (dir = 1; dir < n_dirs; dir++)
+    {
+      guint32 file_type;
+
+      if (TIFFSetDirectory (tif, dir)                          &&
+          TIFFGetField (tif, TIFFTAG_SUBFILETYPE, &file_type) &&
+          (file_type & FILETYPE_REDUCEDIMAGE)                 &&
+          is_better_thumbnail (tif, page_width, page_height, size,
+                               &best_size))
+        {
+          best_offset = 0;
+          best_dir    = dir;
+        }
+    }
+
+  if (best_size == 0)
+    {
+      g_set_error_literal (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                           "The TIFF file contains no reduced-resolution image");
+      TIFFClose (tif);
+      return NULL;
+    }
+
+  if (best_offset ? ! TIFFSetSubDirectory (tif, best_offset) :
+                    ! TIFFSetDirectory (tif, best_dir))
+    {
+      g_set_error_literal (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                           "Could not read the reduced-resolution image");
+      TIFFClose (tif);
+      return NULL;
+    }
+
+  TIFFGetField (tif, TIFFTAG_IMAGEWIDTH,  &thumb_width);
+  TIFFGetField (tif, TIFFTAG_IMAGELENGTH, &thumb_height);
+
+  raster = g_try_new (guint32, (gsize) thumb_width * thumb_height);
+
+  if (! raster ||
+      ! TIFFReadRGBAImageOriented (tif, thumb_width, thumb_height, raster,
+                                   ORIENTATION_TOPLEFT, 0))
+    {
+      g_set_error_literal (error, G_FILE_ERROR, G_FILE_ERROR_FAILED,
+                           "Could not read the reduced-resolution image");
+      g_free (raster);
+      TIFFClose (tif);
+      return NULL;
+    }
+
+  TIFFClose (tif);
+
+#if G_BYTE_ORDER == G_BIG_ENDIAN
+  /*  the RGBA interface packs the components from the least significant
+   *  byte up
+   */
+  {
+    gsize n;
+
+    for (n = 0; n < (gsize) thumb_width * thumb_height; n++)
+      raster[n] = GUINT32_SWAP_LE_BE (raster[n]);
+  }
+#endif
+
+  image = gimp_image_new (thumb_width, thumb_height, GIMP_RGB);
+
+  layer = gimp_layer_new (image, _("Background"),
+                          thumb_width, thumb_height,
+                          GIMP_RGBA_IMAGE,
+                          100.0,
+                          gimp_image_get_default_new_layer_mode (image));
+
+  gimp_image_insert_layer (image, layer, NULL, 0);
+
+  buffer = gimp_drawable_get_buffer (GIMP_DRAWABLE (layer));
+
+  /*  the RGBA interface premultiplies unassociated alpha  */
+  gegl_buffer_set (buffer,
+                   GEGL_RECTANGLE (0, 0, thumb_width, thumb_height), 0,
+                   babl_format ("R'aG'aB'aA u8"),
+                   raster, GEGL_AUTO_ROWSTRIDE);
+
+  g_object_unref (buffer);
+  g_free (raster);
+
+  return image;
+}
+
+/* returns whether the current directory is a reduced-resolution copy of
+ * the 'page_width' x 'page_height' first page that is closer to 'size'
+ * than '*best_size', and if so, updates '*best_size'.
+ */
+static gboolean
+is_better_thumbnail (TIFF    *tif,
+                     guint32  page_width,
+                     guint32  page_height,
+                     gint     size,
+                     gint    *best_size)
+{
+  guint32 width;
+  guint32 height;
+  gint    candidate_size;
+
+  if (! TIFFGetField (tif, TIFFTAG_IMAGEWIDTH,  &width) ||
+      ! TIFFGetField (tif, TIFFTAG_IMAGELENGTH, &height))
+    return FALSE;
+
+  if (width == 0 || height == 0 || width >= page_width || height >= page_height)
+    return FALSE;
+
+  /*  a copy of the page scaled down, and not a page of its own  */
+  if (ABS ((gint64) width * page_height - (gint64) height * page_width) >
+      (gint64) MAX (page_width, page_height))
+    return FALSE;
+
+  candidate_size = MAX (width, height);
+
+  if (*best_size == 0                                       ||
+      (*best_size < size && candidate_size > *best_size)    ||
+      (candidate_size >= size && candidate_size < *best_size))
+    {
+      *best_size = candidate_size;
+
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
 static GimpColorProfile *
 load_profile (TIFF *tif)
 {
@@ -1902,7 +2160,9 @@ load_rgba (TIFF        *tif,
 {
   guint32  image_width;
   guint32  image_height;
-  guint32  row;
+  guint32  tile_width;
+  guint32  tile_height;
+  guint32  y;
   guint32 *buffer;
 
   g_printerr ("%s\n", __func__);
@@ -1910,42 +2170,232 @@ load_rgba (TIFF        *tif,
   TIFFGetField (tif, TIFFTAG_IMAGEWIDTH,  &image_width);
   TIFFGetField (tif, TIFFTAG_IMAGELENGTH, &image_height);
 
-  buffer = g_new (uint32_t, image_width * image_height);
-
-  if (! TIFFReadRGBAImage (tif, image_width, image_height, buffer, 0))
+  /*  read the image a tile, or a strip, at a time, rather than as a whole  */
+  if (TIFFIsTiled (tif))
     {
-      g_message (_("%s: Unsupported image format, no RGBA loader available"),
-                 G_STRFUNC);
-      g_free (buffer);
-      return;
+      TIFFGetField (tif, TIFFTAG_TILEWIDTH,  &tile_width);
+      TIFFGetField (tif, TIFFTAG_TILELENGTH, &tile_height);
+    }
+  else
+    {
+      tile_width = image_width;
+
+      TIFFGetFieldDefaulted (tif, TIFFTAG_ROWSPERSTRIP, &tile_height);
+
+      tile_height = MIN (tile_height, image_height);
     }
 
-  for (row = 0; row < image_height; row++)
+  buffer = g_new (uint32_t, (gsize) tile_width * tile_height);
+
+  for (y = 0; y < image_height; y += tile_height)
     {
+      guint32 rows = MIN (image_height - y, tile_height);
+      guint32 x;
+
+      for (x = 0; x < image_width; x += tile_width)
+        {
+          guint32 cols = MIN (image_width - x, tile_width);
+          guint32 row;
+          gint    success;
+
+          if (TIFFIsTiled (tif))
+            success = TIFFReadRGBATile (tif, x, y, buffer);
+          else
+            success = TIFFReadRGBAStrip (tif, y, buffer);
+
+          if (! success)
+            {
+              g_message (_("%s: Unsupported image format, no RGBA loader available"),
+                         G_STRFUNC);
+              g_free (buffer);
+              return;
+            }
+
+          for (row = 0; row < rows; row++)
+            {
+              guint32 *src;
+
+              /*  the rasters are bottom-up, tiles are always a whole tile
+               *  tall, strips only as tall as the rows they hold
+               */
+              if (TIFFIsTiled (tif))
+                src = buffer + (gsize) (tile_height - row - 1) * tile_width;
+              else
+                src = buffer + (gsize) (rows - row - 1) * tile_width;
+
 #if G_BYTE_ORDER != G_LITTLE_ENDIAN
-      /* Make sure our channels are in the right order */
-      guint32 row_start = row * image_width;
-      guint32 row_end   = row_start + image_width;
-      guint32 i;
+              {
+                /* Make sure our channels are in the right order */
+                guint32 i;
 
-      for (i = row_start; i < row_end; i++)
-        buffer[i] = GUINT32_FROM_LE (buffer[i]);
+                for (i = 0; i < cols; i++)
+                  src[i] = GUINT32_FROM_LE (src[i]);
+              }
 #endif
 
-      gegl_buffer_set (channel[0].buffer,
-                       GEGL_RECTANGLE (0, image_height - row - 1,
-                                       image_width, 1),
-                       0, channel[0].format,
-                       ((guchar *) buffer) + row * image_width * 4,
-                       GEGL_AUTO_ROWSTRIDE);
+              gegl_buffer_set (channel[0].buffer,
+                               GEGL_RECTANGLE (x, y + row, cols, 1),
+                               0, channel[0].format,
+                               src,
+                               GEGL_AUTO_ROWSTRIDE);
+            }
+        }
 
-      if ((row % 32) == 0)
-        gimp_progress_update ((gdouble) row / (gdouble) image_height);
+      gimp_progress_update ((gdouble) (y + rows) / (gdouble) image_height);
     }
 
   g_free (buffer);
 }
 
+/* reads the tile, or scanline, at 'x', 'y' of data->tifs[thread] into the
+ * channel buffers.  may be called from several threads at once, each with
+ * a handle and buffers of its own.
+ */
+static gboolean
+load_contiguous_tile (ContiguousData *data,
+                      gint            thread,
+                      guint32         x,
+                      guint32         y,
+                      guchar         *buffer,
+                      guchar         *bw_buffer)
+{
+  TIFF       *tif = data->tifs[thread];
+  GeglBuffer *src_buf;
+  guint32     rows;
+  guint32     cols;
+  gint        offset;
+  gint        i;
+
+  if (TIFFIsTiled (tif))
+    {
+      if (TIFFReadTile (tif, buffer, x, y, 0, 0) == -1)
+        return FALSE;
+    }
+  else if (TIFFReadScanline (tif, buffer, y, 0) == -1)
+    {
+      return FALSE;
+    }
+
+  cols = MIN (data->image_width  - x, data->tile_width);
+  rows = MIN (data->image_height - y, data->tile_height);
+
+  if (data->needs_upscale)
+    {
+      if (data->bps == 1)
+        convert_bit2byte (buffer, bw_buffer, cols, rows);
+      else if (data->bps == 2)
+        convert_2bit2byte (buffer, bw_buffer, cols, rows);
+      else if (data->bps == 4)
+        convert_4bit2byte (buffer, bw_buffer, cols, rows);
+    }
+  else if (data->is_signed)
+    {
+      convert_int2uint (buffer, data->bps, data->spp, cols, rows,
+                        data->tile_width * data->bytes_per_pixel);
+    }
+
+  if (data->tiff_mode == GIMP_TIFF_GRAY_MINISWHITE && data->bps == 8)
+    {
+      convert_miniswhite (buffer, cols, rows);
+    }
+
+  src_buf = gegl_buffer_linear_new_from_data (data->needs_upscale ?
+                                              bw_buffer : buffer,
+                                              data->src_format,
+                                              GEGL_RECTANGLE (0, 0, cols, rows),
+                                              data->tile_width *
+                                              data->bytes_per_pixel,
+                                              NULL, NULL);
+
+  offset = 0;
+
+  for (i = 0; i <= data->extra; i++)
+    {
+      ChannelData        *channel = &data->channel[i];
+      GeglBufferIterator *iter;
+      gint                src_bpp;
+      gint                dest_bpp;
+
+      src_bpp  = babl_format_get_bytes_per_pixel (data->src_format);
+      dest_bpp = babl_format_get_bytes_per_pixel (channel->format);
+
+      iter = gegl_buffer_iterator_new (src_buf,
+                                       GEGL_RECTANGLE (0, 0, cols, rows),
+                                       0, NULL,
+                                       GEGL_ACCESS_READ,
+                                       GEGL_ABYSS_NONE, 2);
+      gegl_buffer_iterator_add (iter, channel->buffer,
+                                GEGL_RECTANGLE (x, y, cols, rows),
+                                0, channel->format,
+                                GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE);
+
+      while (gegl_buffer_iterator_next (iter))
+        {
+          guchar *s      = iter->items[0].data;
+          guchar *d      = iter->items[1].data;
+          gint    length = iter->length;
+
+          s += offset;
+
+          while (length--)
+            {
+              memcpy (d, s, dest_bpp);
+              d += dest_bpp;
+              s += src_bpp;
+            }
+        }
+
+      offset += dest_bpp;
+    }
+
+  g_object_unref (src_buf);
+
+  return TRUE;
+}
+
+/* reads the i-th of n parts of the current batch of tiles, using the i-th
+ * handle.
+ */
+static void
+load_contiguous_tiles (gint            i,
+                       gint            n,
+                       ContiguousData *data)
+{
+  guint32  tiles_across;
+  guint32  first;
+  guint32  last;
+  guint32  tile;
+  guchar  *buffer;
+  guchar  *bw_buffer = NULL;
+
+  tiles_across = (data->image_width + data->tile_width - 1) /
+                 data->tile_width;
+
+  first = data->first_tile + (guint64) data->n_tiles * i       / n;
+  last  = data->first_tile + (guint64) data->n_tiles * (i + 1) / n;
+
+  buffer = g_malloc (TIFFTileSize (data->tifs[i]));
+
+  if (data->needs_upscale)
+    bw_buffer = g_malloc (data->tile_width * data->tile_height);
+
+  for (tile = first; tile < last; tile++)
+    {
+      guint32 x = (tile % tiles_across) * data->tile_width;
+      guint32 y = (tile / tiles_across) * data->tile_height;
+
+      if (! load_contiguous_tile (data, i, x, y, buffer, bw_buffer))
+        {
+          /*  report the first failure only  */
+          g_atomic_int_compare_and_exchange (&data->failed_row, -1, y);
+          break;
+        }
+    }
+
+  g_free (buffer);
+  g_free (bw_buffer);
+}
+
 static void
 load_contiguous (TIFF         *tif,
                  ChannelData  *channel,
@@ -1956,164 +2406,150 @@ load_contiguous (TIFF         *tif,
                  gboolean      is_signed,
                  gint          extra)
 {
-  guint32     image_width;
-  guint32     image_height;
-  guint32     tile_width;
-  guint32     tile_height;
-  gint        bytes_per_pixel;
-  const Babl *src_format;
-  guchar     *buffer;
-  guchar     *bw_buffer = NULL;
-  gdouble     progress  = 0.0;
-  gdouble     one_row;
-  guint32     y;
-  gint        i;
-  gboolean    needs_upscale = FALSE;
+  ContiguousData  data;
+  TIFF           *tifs[MAX_THREADS];
+  gint            n_tifs = 1;
+  guchar         *buffer;
+  guchar         *bw_buffer = NULL;
+  gdouble         progress  = 0.0;
+  gdouble         one_row;
+  guint32         y;
+  gint            i;
 
   g_printerr ("%s\n", __func__);
 
-  TIFFGetField (tif, TIFFTAG_IMAGEWIDTH,  &image_width);
-  TIFFGetField (tif, TIFFTAG_IMAGELENGTH, &image_height);
+  data.tifs      = tifs;
+  data.channel   = channel;
+  data.bps       = bps;
+  data.spp       = spp;
+  data.tiff_mode = tiff_mode;
+  data.is_signed = is_signed;
+  data.extra     = extra;
 
-  tile_width = image_width;
+  tifs[0] = tif;
+
+  TIFFGetField (tif, TIFFTAG_IMAGEWIDTH,  &data.image_width);
+  TIFFGetField (tif, TIFFTAG_IMAGELENGTH, &data.image_height);
 
   if (TIFFIsTiled (tif))
     {
-      TIFFGetField (tif, TIFFTAG_TILEWIDTH,  &tile_width);
-      TIFFGetField (tif, TIFFTAG_TILELENGTH, &tile_height);
+      TIFFGetField (tif, TIFFTAG_TILEWIDTH,  &data.tile_width);
+      TIFFGetField (tif, TIFFTAG_TILELENGTH, &data.tile_height);
 
       buffer = g_malloc (TIFFTileSize (tif));
     }
   else
     {
-      tile_width  = image_width;
-      tile_height = 1;
+      data.tile_width  = data.image_width;
+      data.tile_height = 1;
 
       buffer = g_malloc (TIFFScanlineSize (tif));
     }
 
-  if (tiff_mode != GIMP_TIFF_DEFAULT && bps < 8)
-    {
-      needs_upscale = TRUE;
-      bw_buffer = g_malloc (tile_width * tile_height);
-    }
+  data.needs_upscale = (tiff_mode != GIMP_TIFF_DEFAULT && bps < 8);
 
-  one_row = (gdouble) tile_height / (gdouble) image_height;
+  if (data.needs_upscale)
+    bw_buffer = g_malloc (data.tile_width * data.tile_height);
+
+  one_row = (gdouble) data.tile_height / (gdouble) data.image_height;
 
-  src_format = babl_format_n (type, spp);
+  data.src_format = babl_format_n (type, spp);
 
   /* consistency check */
-  bytes_per_pixel = 0;
+  data.bytes_per_pixel = 0;
   for (i = 0; i <= extra; i++)
-    bytes_per_pixel += babl_format_get_bytes_per_pixel (channel[i].format);
+    data.bytes_per_pixel += babl_format_get_bytes_per_pixel (channel[i].format);
 
   g_printerr ("bytes_per_pixel: %d, format: %d\n",
-              bytes_per_pixel,
-              babl_format_get_bytes_per_pixel (src_format));
+              data.bytes_per_pixel,
+              babl_format_get_bytes_per_pixel (data.src_format));
 
-  for (y = 0; y < image_height; y += tile_height)
+  /*  tiles are independent of each other, so we decode them in parallel,
+   *  each thread reading through a handle of its own
+   */
+  if (TIFFIsTiled (tif))
     {
-      guint32 x;
+      gint n_threads = CLAMP (gimp_get_num_processors (), 1, MAX_THREADS);
 
-      for (x = 0; x < image_width; x += tile_width)
+      while (n_tifs < n_threads)
         {
-          GeglBuffer *src_buf;
-          guint32     rows;
-          guint32     cols;
-          gint        offset;
+          tifs[n_tifs] = tiff_open_clone (tif, NULL);
 
-          gimp_progress_update (progress + one_row *
-                                ((gdouble) x / (gdouble) image_width));
+          if (! tifs[n_tifs])
+            break;
 
-          if (TIFFIsTiled (tif))
-            {
-              if (TIFFReadTile (tif, buffer, x, y, 0, 0) == -1)
-                {
-                  g_message (_("Reading tile failed. Image may be corrupt at line %d."), y);
-                  g_free (buffer);
-                  g_free (bw_buffer);
-                  return;
-                }
-            }
-          else if (TIFFReadScanline (tif, buffer, y, 0) == -1)
-            {
-              /* Error reading scanline, stop loading */
-              g_message (_("Reading scanline failed. Image may be corrupt at line %d."), y);
-              g_free (buffer);
-              g_free (bw_buffer);
-              return;
-            }
+          n_tifs++;
+        }
+    }
 
-          cols = MIN (image_width  - x, tile_width);
-          rows = MIN (image_height - y, tile_height);
+  if (n_tifs > 1)
+    {
+      guint32 tiles_across;
+      guint32 n_tiles;
+      guint32 tile;
 
-          if (needs_upscale)
-            {
-              if (bps == 1)
-                convert_bit2byte (buffer, bw_buffer, cols, rows);
-              else if (bps == 2)
-                convert_2bit2byte (buffer, bw_buffer, cols, rows);
-              else if (bps == 4)
-                convert_4bit2byte (buffer, bw_buffer, cols, rows);
-            }
-          else if (is_signed)
-            {
-              convert_int2uint (buffer, bps, spp, cols, rows,
-                                tile_width * bytes_per_pixel);
-            }
+      tiles_across = (data.image_width  + data.tile_width  - 1) /
+                     data.tile_width;
+      n_tiles      = (data.image_height + data.tile_height - 1) /
+                     data.tile_height * tiles_across;
+
+      data.failed_row = -1;
+
+      for (tile = 0; tile < n_tiles; tile += data.n_tiles)
+        {
+          data.first_tile = tile;
+          data.n_tiles    = MIN (n_tiles - tile, TILES_PER_THREAD * n_tifs);
+
+          gegl_parallel_distribute (
+            n_tifs,
+            (GeglParallelDistributeFunc) load_contiguous_tiles,
+            &data);
 
-          if (tiff_mode == GIMP_TIFF_GRAY_MINISWHITE && bps == 8)
+          if (data.failed_row >= 0)
             {
-              convert_miniswhite (buffer, cols, rows);
+              g_message (_("Reading tile failed. Image may be corrupt at line %d."),
+                         data.failed_row);
+              break;
             }
 
-          src_buf = gegl_buffer_linear_new_from_data (needs_upscale ? bw_buffer : buffer,
-                                                      src_format,
-                                                      GEGL_RECTANGLE (0, 0, cols, rows),
-                                                      tile_width * bytes_per_pixel,
-                                                      NULL, NULL);
+          gimp_progress_update ((gdouble) (tile + data.n_tiles) /
+                                (gdouble) n_tiles);
+        }
 
-          offset = 0;
+      for (i = 1; i < n_tifs; i++)
+        TIFFClose (tifs[i]);
 
-          for (i = 0; i <= extra; i++)
-            {
-              GeglBufferIterator *iter;
-              gint                src_bpp;
-              gint                dest_bpp;
-
-              src_bpp  = babl_format_get_bytes_per_pixel (src_format);
-              dest_bpp = babl_format_get_bytes_per_pixel (channel[i].format);
-
-              iter = gegl_buffer_iterator_new (src_buf,
-                                               GEGL_RECTANGLE (0, 0, cols, rows),
-                                               0, NULL,
-                                               GEGL_ACCESS_READ,
-                                               GEGL_ABYSS_NONE, 2);
-              gegl_buffer_iterator_add (iter, channel[i].buffer,
-                                        GEGL_RECTANGLE (x, y, cols, rows),
-                                        0, channel[i].format,
-                                        GEGL_ACCESS_WRITE, GEGL_ABYSS_NONE);
-
-              while (gegl_buffer_iterator_next (iter))
-                {
-                  guchar *s      = iter->items[0].data;
-                  guchar *d      = iter->items[1].data;
-                  gint    length = iter->length;
+      g_free (buffer);
+      g_free (bw_buffer);
 
-                  s += offset;
+      return;
+    }
 
-                  while (length--)
-                    {
-                      memcpy (d, s, dest_bpp);
-                      d += dest_bpp;
-                      s += src_bpp;
-                    }
+  for (y = 0; y < data.image_height; y += data.tile_height)
+    {
+      guint32 x;
+
+      for (x = 0; x < data.image_width; x += data.tile_width)
+        {
+          gimp_progress_update (progress + one_row *
+                                ((gdouble) x / (gdouble) data.image_width));
+
+          if (! load_contiguous_tile (&data, 0, x, y, buffer, bw_buffer))
+            {
+              if (TIFFIsTiled (tif))
+                {
+                  g_message (_("Reading tile failed. Image may be corrupt at line %d."), y);
+                }
+              else
+                {
+                  /* Error reading scanline, stop loading */
+                  g_message (_("Reading scanline failed. Image may be corrupt at line %d."), y);
                 }
 
-              offset += dest_bpp;
+              g_free (buffer);
+              g_free (bw_buffer);
+              return;
             }
-
-          g_object_unref (src_buf);
         }
 
       progress += one_row;
@@ -2123,7 +2559,6 @@ load_contiguous (TIFF         *tif,
   g_free (bw_buffer);
 }
 
-
 static void
 load_separate (TIFF         *tif,
                ChannelData  *channel,
@@ -22,7 +22,8 @@
 #ifndef __FILE_TIFF_LOAD_H__
 #define __FILE_TIFF_LOAD_H__
 
-#define LOAD_PROC      "file-tiff-load"
+#define LOAD_PROC       "file-tiff-load"
+#define LOAD_THUMB_PROC "file-tiff-load-thumb"
 
 typedef enum
 {
@@ -46,15 +47,21 @@ typedef struct
 } TiffSelectedPages;
 
 
-GimpPDBStatusType load_image  (GimpProcedure        *procedure,
-                               GFile                *file,
-                               GimpRunMode           run_mode,
-                               GimpImage           **image,
-                               gboolean             *resolution_loaded,
-                               gboolean             *profile_loaded,
-                               gboolean             *ps_metadata_loaded,
-                               GimpProcedureConfig  *config,
-                               GError              **error);
+GimpPDBStatusType load_image           (GimpProcedure        *procedure,
+                                        GFile                *file,
+                                        GimpRunMode           run_mode,
+                                        GimpImage           **image,
+                                        gboolean             *resolution_loaded,
+                                        gboolean             *profile_loaded,
+                                        gboolean             *ps_metadata_loaded,
+                                        GimpProcedureConfig  *config,
+                                        GError              **error);
+GimpImage *       load_thumbnail_image (GFile                *file,
+                                        gint                  size,
+                                        gint                 *width,
+                                        gint                 *height,
+                                        GimpImageType        *type,
+                                        GError              **error);
 
 
 #endif /* __FILE_TIFF_LOAD_H__ */
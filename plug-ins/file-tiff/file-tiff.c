@@ -91,6 +91,11 @@ static GimpValueArray         * tiff_load             (GimpProcedure         *pr
                                                        GimpMetadataLoadFlags *flags,
                                                        GimpProcedureConfig   *config,
                                                        gpointer               run_data);
+static GimpValueArray         * tiff_load_thumb       (GimpProcedure         *procedure,
+                                                       GFile                 *file,
+                                                       gint                   size,
+                                                       GimpProcedureConfig   *config,
+                                                       gpointer               run_data);
 static GimpValueArray         * tiff_export           (GimpProcedure         *procedure,
                                                        GimpRunMode            run_mode,
                                                        GimpImage             *image,
@@ -144,6 +149,7 @@ tiff_query_procedures (GimpPlugIn *plug_in)
   GList *list = NULL;
 
   list = g_list_append (list, g_strdup (LOAD_PROC));
+  list = g_list_append (list, g_strdup (LOAD_THUMB_PROC));
   list = g_list_append (list, g_strdup (EXPORT_PROC));
 
   return list;
@@ -182,6 +188,9 @@ tiff_create_procedure (GimpPlugIn  *plug_in,
       gimp_file_procedure_set_magics (GIMP_FILE_PROCEDURE (procedure),
                                       "0,string,II*\\0,0,string,MM\\0*");
 
+      gimp_load_procedure_set_thumbnail_loader (GIMP_LOAD_PROCEDURE (procedure),
+                                                LOAD_THUMB_PROC);
+
       /* TODO: the 2 below AUX arguments should likely be real arguments, but I
        * just wanted to get rid of gimp_get_data/gimp_set_data() usage at first
        * and didn't dig much into proper and full usage. Since it's always
@@ -199,8 +208,29 @@ tiff_create_procedure (GimpPlugIn  *plug_in,
                                                _("_Keep empty space around imported layers"),
                                                NULL, TRUE, GIMP_PARAM_READWRITE);
     }
+  else if (! strcmp (name, LOAD_THUMB_PROC))
+    {
+      procedure = gimp_thumbnail_procedure_new (plug_in, name,
+                                                GIMP_PDB_PROC_TYPE_PLUGIN,
+                                                tiff_load_thumb, NULL, NULL);
+
+      gimp_procedure_set_documentation (procedure,
+                                        _("Loads a thumbnail from a TIFF image"),
+                                        _("Loads the reduced-resolution image "
+                                          "(SubIFD or reduced page) closest "
+                                          "to the requested size. Files "
+                                          "without one are left to the full "
+                                          "loader."),
+                                        name);
+      gimp_procedure_set_attribution (procedure,
+                                      "Spencer Kimball, Peter Mattis & Nick Lamb",
+                                      "Nick Lamb <njl195@zepler.org.uk>",
+                                      "1995-1996,1998-2003");
+    }
   else if (! strcmp (name, EXPORT_PROC))
     {
+      GimpChoice *compressions;
+
       procedure = gimp_export_procedure_new (plug_in, name,
                                              GIMP_PDB_PROC_TYPE_PLUGIN,
                                              TRUE, tiff_export, NULL, NULL);
@@ -241,19 +271,35 @@ tiff_create_procedure (GimpPlugIn  *plug_in,
                                            FALSE,
                                            G_PARAM_READWRITE);
 
+      compressions = gimp_choice_new_with_values ("none",          GIMP_COMPRESSION_NONE,          _("None"),              NULL,
+                                                  "lzw",           GIMP_COMPRESSION_LZW,           _("LZW"),               NULL,
+                                                  "packbits",      GIMP_COMPRESSION_PACKBITS,      _("Pack Bits"),         NULL,
+                                                  "adobe_deflate", GIMP_COMPRESSION_ADOBE_DEFLATE, _("Deflate"),           NULL,
+                                                  "jpeg",          GIMP_COMPRESSION_JPEG,          _("JPEG"),              NULL,
+                                                  "ccittfax3",     GIMP_COMPRESSION_CCITTFAX3,     _("CCITT Group 3 fax"), NULL,
+                                                  "ccittfax4",     GIMP_COMPRESSION_CCITTFAX4,     _("CCITT Group 4 fax"), NULL,
+                                                  NULL);
+#ifdef COMPRESSION_ZSTD
+      if (TIFFIsCODECConfigured (COMPRESSION_ZSTD))
+        gimp_choice_add (compressions,
+                         "zstd",           GIMP_COMPRESSION_ZSTD,          _("Zstandard"),         NULL);
+#endif
+
       gimp_procedure_add_choice_argument (procedure, "compression",
                                           _("Co_mpression"),
                                           _("Compression type"),
-                                          gimp_choice_new_with_values ("none",          GIMP_COMPRESSION_NONE,          _("None"),              NULL,
-                                                                       "lzw",           GIMP_COMPRESSION_LZW,           _("LZW"),               NULL,
-                                                                       "packbits",      GIMP_COMPRESSION_PACKBITS,      _("Pack Bits"),         NULL,
-                                                                       "adobe_deflate", GIMP_COMPRESSION_ADOBE_DEFLATE, _("Deflate"),           NULL,
-                                                                       "jpeg",          GIMP_COMPRESSION_JPEG,          _("JPEG"),              NULL,
-                                                                       "ccittfax3",     GIMP_COMPRESSION_CCITTFAX3,     _("CCITT Group 3 fax"), NULL,
-                                                                       "ccittfax4",     GIMP_COMPRESSION_CCITTFAX4,     _("CCITT Group 4 fax"), NULL,
-                                                                       NULL),
+                                          compressions,
                                           "none", G_PARAM_READWRITE);
 
+      gimp_procedure_add_boolean_argument (procedure, "tiled",
+                                           _("Save as _tiles"),
+                                           _("Store the image in square tiles rather "
+                                             "than in strips, which lets readers load "
+                                             "any part of it without the rest, and "
+                                             "lets it be compressed in parallel"),
+                                           FALSE,
+                                           G_PARAM_READWRITE);
+
       gimp_procedure_add_boolean_argument (procedure, "save-transparent-pixels",
                                            _("Save color _values from transparent pixels"),
                                            _("Keep the color data masked by an alpha channel "
@@ -345,6 +391,42 @@ tiff_load (GimpProcedure         *procedure,
   return return_vals;
 }
 
+static GimpValueArray *
+tiff_load_thumb (GimpProcedure       *procedure,
+                 GFile               *file,
+                 gint                 size,
+                 GimpProcedureConfig *config,
+                 gpointer             run_data)
+{
+  GimpValueArray *return_vals;
+  GimpImage      *image;
+  gint            width  = 0;
+  gint            height = 0;
+  GimpImageType   type   = GIMP_RGB_IMAGE;
+  GError         *error  = NULL;
+
+  gegl_init (NULL, NULL);
+
+  image = load_thumbnail_image (file, size, &width, &height, &type, &error);
+
+  if (! image)
+    return gimp_procedure_new_return_values (procedure,
+                                             GIMP_PDB_EXECUTION_ERROR,
+                                             error);
+
+  return_vals = gimp_procedure_new_return_values (procedure,
+                                                  GIMP_PDB_SUCCESS,
+                                                  NULL);
+
+  GIMP_VALUES_SET_IMAGE (return_vals, 1, image);
+  GIMP_VALUES_SET_INT   (return_vals, 2, width);
+  GIMP_VALUES_SET_INT   (return_vals, 3, height);
+  GIMP_VALUES_SET_ENUM  (return_vals, 4, type);
+  GIMP_VALUES_SET_INT   (return_vals, 5, 1);
+
+  return return_vals;
+}
+
 static GimpValueArray *
 tiff_export (GimpProcedure        *procedure,
              GimpRunMode           run_mode,
@@ -557,6 +639,11 @@ gimp_compression_to_tiff_compression (GimpCompression compression)
     case GIMP_COMPRESSION_JPEG:          return COMPRESSION_JPEG;
     case GIMP_COMPRESSION_CCITTFAX3:     return COMPRESSION_CCITTFAX3;
     case GIMP_COMPRESSION_CCITTFAX4:     return COMPRESSION_CCITTFAX4;
+#ifdef COMPRESSION_ZSTD
+    case GIMP_COMPRESSION_ZSTD:          return COMPRESSION_ZSTD;
+#else
+    case GIMP_COMPRESSION_ZSTD:          break;
+#endif
     }
 
   return COMPRESSION_NONE;
@@ -576,6 +663,9 @@ tiff_compression_to_gimp_compression (gint compression)
     case COMPRESSION_JPEG:          return GIMP_COMPRESSION_JPEG;
     case COMPRESSION_CCITTFAX3:     return GIMP_COMPRESSION_CCITTFAX3;
     case COMPRESSION_CCITTFAX4:     return GIMP_COMPRESSION_CCITTFAX4;
+#ifdef COMPRESSION_ZSTD
+    case COMPRESSION_ZSTD:          return GIMP_COMPRESSION_ZSTD;
+#endif
     }
 
   return GIMP_COMPRESSION_NONE;
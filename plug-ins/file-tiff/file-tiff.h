@@ -14,7 +14,8 @@ typedef enum
  GIMP_COMPRESSION_ADOBE_DEFLATE,
  GIMP_COMPRESSION_JPEG,
  GIMP_COMPRESSION_CCITTFAX3,
- GIMP_COMPRESSION_CCITTFAX4
+ GIMP_COMPRESSION_CCITTFAX4,
+ GIMP_COMPRESSION_ZSTD
 } GimpCompression;
 
 
@@ -101,9 +101,13 @@ save_dialog (GimpImage     *image,
   gimp_procedure_dialog_set_sensitive (GIMP_PROCEDURE_DIALOG (dialog),
                                        "use-sharp-yuv",
                                        TRUE, config, "lossless", TRUE);
+  gimp_procedure_dialog_get_widget (GIMP_PROCEDURE_DIALOG (dialog),
+                                    "effort", GIMP_TYPE_SPIN_SCALE);
   gimp_procedure_dialog_fill_box (GIMP_PROCEDURE_DIALOG (dialog),
                                   "advanced-options",
                                   "use-sharp-yuv",
+                                  "effort",
+                                  "multithreaded",
                                   NULL);
 
   gimp_procedure_dialog_fill_frame (GIMP_PROCEDURE_DIALOG (dialog),
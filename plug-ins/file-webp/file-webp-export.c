@@ -159,12 +159,16 @@ save_layer (GFile         *file,
   gdouble           quality;
   gdouble           alpha_quality;
   gboolean          use_sharp_yuv;
+  gint              effort;
+  gboolean          multithreaded;
 
   g_object_get (config,
                 "lossless",      &lossless,
                 "quality",       &quality,
                 "alpha-quality", &alpha_quality,
                 "use-sharp-yuv", &use_sharp_yuv,
+                "effort",        &effort,
+                "multithreaded", &multithreaded,
                 NULL);
   preset = gimp_procedure_config_get_choice_id (GIMP_PROCEDURE_CONFIG (config),
                                                 "preset");
@@ -244,9 +248,10 @@ save_layer (GFile         *file,
       WebPConfigPreset (&webp_config, preset, quality);
 
       webp_config.lossless       = lossless;
-      webp_config.method         = 6;  /* better quality */
+      webp_config.method         = effort;
       webp_config.alpha_quality  = alpha_quality;
       webp_config.use_sharp_yuv  = use_sharp_yuv ? 1 : 0;
+      webp_config.thread_level   = multithreaded ? 1 : 0;
 
       /* Prepare the WebP structure */
       WebPPictureInit (&picture);
@@ -540,6 +545,8 @@ save_animation (GFile         *file,
   gint                   default_delay;
   gboolean               force_delay;
   gboolean               use_sharp_yuv;
+  gint                   effort;
+  gboolean               multithreaded;
 
   g_return_val_if_fail (n_drawables > 0, FALSE);
 
@@ -554,6 +561,8 @@ save_animation (GFile         *file,
                 "default-delay",     &default_delay,
                 "force-delay",       &force_delay,
                 "use-sharp-yuv",     &use_sharp_yuv,
+                "effort",            &effort,
+                "multithreaded",     &multithreaded,
                 NULL);
   preset = gimp_procedure_config_get_choice_id (GIMP_PROCEDURE_CONFIG (config),
                                                 "preset");
@@ -711,10 +720,11 @@ save_animation (GFile         *file,
           WebPConfigPreset (&webp_config, preset, quality);
 
           webp_config.lossless      = lossless;
-          webp_config.method        = 6;  /* better quality */
+          webp_config.method        = effort;
           webp_config.alpha_quality = alpha_quality;
           webp_config.exact         = 1;
           webp_config.use_sharp_yuv = use_sharp_yuv ? 1 : 0;
+          webp_config.thread_level  = multithreaded ? 1 : 0;
 
           WebPMemoryWriterInit (&mw);
 
@@ -250,3 +250,118 @@ load_image (GFile                  *file,
 
   return image;
 }
+
+/* loads a thumbnail fitting in 'size' pixels.  libwebp scales while it
+ * decodes, so only the thumbnail-sized RGBA buffer is ever allocated.
+ * animations are thumbnailed by their first frame, when it covers the
+ * whole canvas.
+ */
+GimpImage *
+load_thumbnail_image (GFile   *file,
+                      gint     size,
+                      gint    *width,
+                      gint    *height,
+                      GError **error)
+{
+  uint8_t           *indata = NULL;
+  gsize              indatalen;
+  WebPData           wp_data;
+  WebPDemuxer       *demux  = NULL;
+  WebPIterator       iter   = { 0, };
+  WebPDecoderConfig  config;
+  GimpImage         *image  = NULL;
+  gint               thumb_width;
+  gint               thumb_height;
+
+  if (! g_file_get_contents (g_file_peek_path (file),
+                             (gchar **) &indata,
+                             &indatalen,
+                             error))
+    {
+      return NULL;
+    }
+
+  wp_data.bytes = indata;
+  wp_data.size  = indatalen;
+
+  demux = WebPDemux (&wp_data);
+  if (! demux || ! WebPDemuxGetFrame (demux, 1, &iter))
+    {
+      g_set_error (error, G_FILE_ERROR, 0,
+                   _("Invalid WebP file '%s'"),
+                   gimp_file_get_utf8_name (file));
+      goto out;
+    }
+
+  *width  = WebPDemuxGetI (demux, WEBP_FF_CANVAS_WIDTH);
+  *height = WebPDemuxGetI (demux, WEBP_FF_CANVAS_HEIGHT);
+
+  if (iter.x_offset != 0       || iter.y_offset != 0 ||
+      iter.width    != *width  || iter.height   != *height)
+    {
+      g_set_error (error, G_FILE_ERROR, 0,
+                   "The first frame of '%s' does not cover the canvas",
+                   gimp_file_get_utf8_name (file));
+      goto out;
+    }
+
+  if (! WebPInitDecoderConfig (&config))
+    {
+      g_set_error (error, G_FILE_ERROR, 0,
+                   _("Failed to decode WebP file '%s'"),
+                   gimp_file_get_utf8_name (file));
+      goto out;
+    }
+
+  thumb_width  = *width;
+  thumb_height = *height;
+
+  if (MAX (thumb_width, thumb_height) > size)
+    {
+      if (thumb_width > thumb_height)
+        {
+          thumb_height = MAX (1, (gint64) thumb_height * size / thumb_width);
+          thumb_width  = size;
+        }
+      else
+        {
+          thumb_width  = MAX (1, (gint64) thumb_width * size / thumb_height);
+          thumb_height = size;
+        }
+
+      config.options.use_scaling   = 1;
+      config.options.scaled_width  = thumb_width;
+      config.options.scaled_height = thumb_height;
+    }
+
+  config.options.bypass_filtering    = 1;
+  config.options.no_fancy_upsampling = 1;
+  config.output.colorspace           = MODE_RGBA;
+
+  if (WebPDecode (iter.fragment.bytes, iter.fragment.size,
+                  &config) != VP8_STATUS_OK)
+    {
+      g_set_error (error, G_FILE_ERROR, 0,
+                   _("Failed to decode WebP file '%s'"),
+                   gimp_file_get_utf8_name (file));
+      goto out;
+    }
+
+  image = gimp_image_new (thumb_width, thumb_height, GIMP_RGB);
+
+  create_layer (image, config.output.u.RGBA.rgba, 0, _("Background"),
+                thumb_width, thumb_height);
+
+  WebPFreeDecBuffer (&config.output);
+
+ out:
+  if (demux)
+    {
+      WebPDemuxReleaseIterator (&iter);
+      WebPDemuxDelete (demux);
+    }
+
+  g_free (indata);
+
+  return image;
+}
@@ -23,10 +23,15 @@
 #define __WEBP_LOAD_H__
 
 
-GimpImage * load_image (GFile                  *file,
-                        gboolean                interactive,
-                        GimpMetadataLoadFlags  *flags,
-                        GError                **error);
+GimpImage * load_image           (GFile                  *file,
+                                  gboolean                interactive,
+                                  GimpMetadataLoadFlags  *flags,
+                                  GError                **error);
+GimpImage * load_thumbnail_image (GFile                  *file,
+                                  gint                    size,
+                                  gint                   *width,
+                                  gint                   *height,
+                                  GError                **error);
 
 
 #endif /* __WEBP_LOAD_H__ */
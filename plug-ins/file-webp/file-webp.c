@@ -66,6 +66,11 @@ static GimpValueArray         * webp_load             (GimpProcedure         *pr
                                                        GimpMetadataLoadFlags *flags,
                                                        GimpProcedureConfig   *config,
                                                        gpointer               run_data);
+static GimpValueArray         * webp_load_thumb       (GimpProcedure         *procedure,
+                                                       GFile                 *file,
+                                                       gint                   size,
+                                                       GimpProcedureConfig   *config,
+                                                       gpointer               run_data);
 static GimpValueArray         * webp_export           (GimpProcedure         *procedure,
                                                        GimpRunMode            run_mode,
                                                        GimpImage             *image,
@@ -108,6 +113,7 @@ webp_query_procedures (GimpPlugIn *plug_in)
   GList *list = NULL;
 
   list = g_list_append (list, g_strdup (LOAD_PROC));
+  list = g_list_append (list, g_strdup (LOAD_THUMB_PROC));
   list = g_list_append (list, g_strdup (EXPORT_PROC));
 
   return list;
@@ -143,6 +149,27 @@ webp_create_procedure (GimpPlugIn  *plug_in,
                                           "webp");
       gimp_file_procedure_set_magics (GIMP_FILE_PROCEDURE (procedure),
                                       "8,string,WEBP");
+
+      gimp_load_procedure_set_thumbnail_loader (GIMP_LOAD_PROCEDURE (procedure),
+                                                LOAD_THUMB_PROC);
+    }
+  else if (! strcmp (name, LOAD_THUMB_PROC))
+    {
+      procedure = gimp_thumbnail_procedure_new (plug_in, name,
+                                                GIMP_PDB_PROC_TYPE_PLUGIN,
+                                                webp_load_thumb, NULL, NULL);
+
+      gimp_procedure_set_documentation (procedure,
+                                        "Loads a thumbnail from a WebP image",
+                                        "Decodes a WebP image, or the first "
+                                        "frame of an animation, directly at "
+                                        "thumbnail size",
+                                        name);
+      gimp_procedure_set_attribution (procedure,
+                                      "Nathan Osman, Ben Touchette",
+                                      "(C) 2015-2016 Nathan Osman, "
+                                      "(C) 2016 Ben Touchette",
+                                      "2015,2016");
     }
   else if (! strcmp (name, EXPORT_PROC))
     {
@@ -214,6 +241,19 @@ webp_create_procedure (GimpPlugIn  *plug_in,
                                            FALSE,
                                            G_PARAM_READWRITE);
 
+      gimp_procedure_add_int_argument (procedure, "effort",
+                                       _("E_ffort"),
+                                       _("Encoding effort, from 0 (fastest) "
+                                         "to 6 (smallest files)"),
+                                       0, 6, 6,
+                                       G_PARAM_READWRITE);
+
+      gimp_procedure_add_boolean_argument (procedure, "multithreaded",
+                                           _("_Multithreaded encoding"),
+                                           _("Let the encoder use several threads"),
+                                           TRUE,
+                                           G_PARAM_READWRITE);
+
       gimp_procedure_add_boolean_argument (procedure, "animation-loop",
                                            _("Loop _forever"),
                                            _("Loop animation infinitely"),
@@ -292,6 +332,41 @@ webp_load (GimpProcedure         *procedure,
   return return_vals;
 }
 
+static GimpValueArray *
+webp_load_thumb (GimpProcedure       *procedure,
+                 GFile               *file,
+                 gint                 size,
+                 GimpProcedureConfig *config,
+                 gpointer             run_data)
+{
+  GimpValueArray *return_vals;
+  GimpImage      *image;
+  gint            width  = 0;
+  gint            height = 0;
+  GError         *error  = NULL;
+
+  gegl_init (NULL, NULL);
+
+  image = load_thumbnail_image (file, size, &width, &height, &error);
+
+  if (! image)
+    return gimp_procedure_new_return_values (procedure,
+                                             GIMP_PDB_EXECUTION_ERROR,
+                                             error);
+
+  return_vals = gimp_procedure_new_return_values (procedure,
+                                                  GIMP_PDB_SUCCESS,
+                                                  NULL);
+
+  GIMP_VALUES_SET_IMAGE (return_vals, 1, image);
+  GIMP_VALUES_SET_INT   (return_vals, 2, width);
+  GIMP_VALUES_SET_INT   (return_vals, 3, height);
+  GIMP_VALUES_SET_ENUM  (return_vals, 4, GIMP_RGBA_IMAGE);
+  GIMP_VALUES_SET_INT   (return_vals, 5, 1);
+
+  return return_vals;
+}
+
 static GimpValueArray *
 webp_export (GimpProcedure        *procedure,
              GimpRunMode           run_mode,
@@ -23,10 +23,11 @@
 #define __FILE_WEBP_H__
 
 
-#define LOAD_PROC      "file-webp-load"
-#define EXPORT_PROC    "file-webp-export"
-#define PLUG_IN_BINARY "file-webp"
-#define PLUG_IN_ROLE   "gimp-file-webp"
+#define LOAD_PROC       "file-webp-load"
+#define LOAD_THUMB_PROC "file-webp-load-thumb"
+#define EXPORT_PROC     "file-webp-export"
+#define PLUG_IN_BINARY  "file-webp"
+#define PLUG_IN_ROLE    "gimp-file-webp"
 
 
 #endif /* __FILE_WEBP_H__ */
@@ -36,6 +36,26 @@
 
 #include <libgimp/stdplugins-intl.h>
 
+/* Strokes are composited in parallel, in bands of rows */
+#define BAND_HEIGHT 64
+
+typedef struct
+{
+  int n;          /* Brush */
+  int tx, ty;     /* Top-left corner of the brush */
+  int r, g, b;
+} stroke_t;
+
+typedef struct
+{
+  ppm_t          *brushes;
+  ppm_t          *shadows;
+  const stroke_t *strokes;
+  GArray        **bands;  /* Indices of the strokes touching each band */
+  ppm_t          *p;
+  ppm_t          *a;
+} composite_t;
+
 static gimpressionist_vals_t runningvals;
 
 static double
@@ -224,11 +244,17 @@ choose_best_brush (ppm_t *p, ppm_t *a, int tx, int ty,
   return best;
 }
 
+/*
+ * Applies the stroke to the rows from y1 to y2 of p (and a).  Every
+ * pixel only depends on its own previous value, so a stroke can be
+ * applied to different rows independently.
+ */
 static void
 apply_brush (ppm_t *brush,
              ppm_t *shadow,
              ppm_t *p, ppm_t *a,
-             int tx, int ty, int r, int g, int b)
+             int tx, int ty, int r, int g, int b,
+             int y1, int y2)
 {
   ppm_t  tmp;
   ppm_t  atmp;
@@ -251,7 +277,7 @@ apply_brush (ppm_t *brush,
       int sx = tx + shadowdepth - shadowblur * 2;
       int sy = ty + shadowdepth - shadowblur * 2;
 
-      for (y = 0; y < shadow->height; y++)
+      for (y = MAX (0, y1 - sy); y < MIN (shadow->height, y2 - sy); y++)
         {
           guchar *row, *arow = NULL;
 
@@ -288,7 +314,7 @@ apply_brush (ppm_t *brush,
         }
     }
 
-  for (y = 0; y < brush->height; y++)
+  for (y = MAX (0, y1 - ty); y < MIN (brush->height, y2 - ty); y++)
     {
       guchar *row = tmp.col + (ty + y) * tmp.width * 3;
       guchar *arow = NULL;
@@ -327,7 +353,7 @@ apply_brush (ppm_t *brush,
 
   if (relief > 0.001)
     {
-      for (y = 1; y < brush->height; y++)
+      for (y = MAX (1, y1 - ty); y < MIN (brush->height, y2 - ty); y++)
         {
           guchar *row = tmp.col + (ty + y) * tmp.width * 3;
 
@@ -346,6 +372,113 @@ apply_brush (ppm_t *brush,
     }
 }
 
+static void
+add_stroke (GArray *strokes,
+            int n, int tx, int ty, int r, int g, int b)
+{
+  stroke_t stroke = { n, tx, ty, r, g, b };
+
+  g_array_append_val (strokes, stroke);
+}
+
+static void
+composite_bands (gsize        offset,
+                 gsize        size,
+                 composite_t *composite)
+{
+  gsize band;
+
+  for (band = offset; band < offset + size; band++)
+    {
+      GArray *indices = composite->bands[band];
+      int     y1      = band * BAND_HEIGHT;
+      int     y2      = y1 + BAND_HEIGHT;
+      guint   i;
+
+      for (i = 0; i < indices->len; i++)
+        {
+          const stroke_t *stroke;
+
+          stroke = &composite->strokes[g_array_index (indices, guint, i)];
+
+          apply_brush (&composite->brushes[stroke->n],
+                       composite->shadows ? &composite->shadows[stroke->n] : NULL,
+                       composite->p, composite->a,
+                       stroke->tx, stroke->ty,
+                       stroke->r, stroke->g, stroke->b,
+                       y1, y2);
+        }
+    }
+}
+
+/*
+ * Composites the strokes into p (and a), in order.  Each band of rows
+ * gets the strokes touching it, in the same order, so that the bands can
+ * be composited in parallel with the same result as compositing the
+ * strokes one after the other.
+ */
+static void
+composite_strokes (GArray *strokes,
+                   ppm_t  *brushes,
+                   ppm_t  *shadows,
+                   ppm_t  *p,
+                   ppm_t  *a)
+{
+  composite_t composite;
+  int         shadowdepth = pcvals.general_shadow_depth;
+  int         shadowblur  = pcvals.general_shadow_blur;
+  int         n_bands;
+  guint       i;
+  int         band;
+
+  n_bands = (p->height + BAND_HEIGHT - 1) / BAND_HEIGHT;
+
+  composite.brushes = brushes;
+  composite.shadows = shadows;
+  composite.strokes = (const stroke_t *) strokes->data;
+  composite.bands   = g_new (GArray *, n_bands);
+  composite.p       = p;
+  composite.a       = a;
+
+  for (band = 0; band < n_bands; band++)
+    composite.bands[band] = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  for (i = 0; i < strokes->len; i++)
+    {
+      const stroke_t *stroke = &g_array_index (strokes, stroke_t, i);
+      int             y1     = stroke->ty;
+      int             y2     = stroke->ty + brushes[stroke->n].height;
+
+      if (shadows)
+        {
+          int sy = stroke->ty + shadowdepth - shadowblur * 2;
+
+          y1 = MIN (y1, sy);
+          y2 = MAX (y2, sy + shadows[stroke->n].height);
+        }
+
+      y1 = MAX (y1, 0);
+      y2 = MIN (y2, p->height);
+
+      for (band = y1 / BAND_HEIGHT;
+           band < n_bands && band * BAND_HEIGHT < y2;
+           band++)
+        {
+          g_array_append_val (composite.bands[band], i);
+        }
+    }
+
+  gegl_parallel_distribute_range (
+    n_bands, 1,
+    (GeglParallelDistributeRangeFunc) composite_bands,
+    &composite);
+
+  for (band = 0; band < n_bands; band++)
+    g_array_free (composite.bands[band], TRUE);
+
+  g_free (composite.bands);
+}
+
 void
 repaint (ppm_t *p, ppm_t *a)
 {
@@ -357,7 +490,7 @@ repaint (ppm_t *p, ppm_t *a)
   int         num_brushes, maxbrushwidth, maxbrushheight;
   guchar      back[3] = {0, 0, 0};
   ppm_t      *brushes, *shadows;
-  ppm_t      *brush, *shadow = NULL;
+  ppm_t      *brush;
   double     *brushes_sum;
   int         cx, cy, maxdist;
   double      scale, relief, startangle, anglespan, density, bgamma;
@@ -367,6 +500,7 @@ repaint (ppm_t *p, ppm_t *a)
   ppm_t       sizmap = {0, 0, NULL};
   int        *xpos = NULL, *ypos = NULL;
   int         progstep;
+  GArray     *strokes;
   static int  running = 0;
 
   int dropshadow = pcvals.general_drop_shadow;
@@ -838,6 +972,13 @@ repaint (ppm_t *p, ppm_t *a)
         }
     }
 
+  /*
+   * Place the strokes, and choose their brush and color.  These only
+   * depend on the source image, so the strokes are composited
+   * afterwards, all at once.
+   */
+  strokes = g_array_new (FALSE, FALSE, sizeof (stroke_t));
+
   for (; i; i--)
     {
       int n;
@@ -847,7 +988,7 @@ repaint (ppm_t *p, ppm_t *a)
         {
           if(runningvals.run)
             {
-              gimp_progress_update (0.8 - 0.8 * ((double)i / max_progress));
+              gimp_progress_update (0.6 - 0.6 * ((double)i / max_progress));
             }
           else
             {
@@ -985,8 +1126,6 @@ repaint (ppm_t *p, ppm_t *a)
       ty -= maxbrushheight/2;
 
       brush = &brushes[n];
-      if (dropshadow)
-        shadow = &shadows[n];
       thissum = brushes_sum[n];
 
       /* Calculate color - avg. of in-brush pixels */
@@ -1047,7 +1186,7 @@ repaint (ppm_t *p, ppm_t *a)
 #undef MYASSIGN
         }
 
-      apply_brush (brush, shadow, &tmp, &atmp, tx,ty, r,g,b);
+      add_stroke (strokes, n, tx, ty, r, g, b);
 
       if (runningvals.general_tileable && runningvals.general_paint_edges)
         {
@@ -1057,35 +1196,44 @@ repaint (ppm_t *p, ppm_t *a)
 
           if (tx < maxbrushwidth)
             {
-              apply_brush (brush, shadow, &tmp, &atmp, tx+orig_width,ty, r,g,b);
+              add_stroke (strokes, n, tx + orig_width, ty, r, g, b);
               dox = -1;
             }
           else if (tx > orig_width)
             {
-              apply_brush (brush, shadow, &tmp, &atmp, tx-orig_width,ty, r,g,b);
+              add_stroke (strokes, n, tx - orig_width, ty, r, g, b);
               dox = 1;
             }
           if (ty < maxbrushheight)
             {
-              apply_brush (brush, shadow, &tmp, &atmp, tx,ty+orig_height, r,g,b);
+              add_stroke (strokes, n, tx, ty + orig_height, r, g, b);
               doy = 1;
             }
           else if (ty > orig_height)
             {
-              apply_brush (brush, shadow, &tmp, &atmp, tx,ty-orig_height, r,g,b);
+              add_stroke (strokes, n, tx, ty - orig_height, r, g, b);
               doy = -1;
             }
           if (doy)
             {
               if (dox < 0)
-                apply_brush (brush, shadow, &tmp, &atmp,
-                             tx+orig_width, ty + doy * orig_height, r, g, b);
+                add_stroke (strokes, n,
+                            tx + orig_width, ty + doy * orig_height, r, g, b);
               if (dox > 0)
-                apply_brush (brush, shadow, &tmp, &atmp,
-                             tx-orig_width, ty + doy * orig_height, r, g, b);
+                add_stroke (strokes, n,
+                            tx - orig_width, ty + doy * orig_height, r, g, b);
             }
         }
     }
+
+  composite_strokes (strokes, brushes, shadows, &tmp,
+                     img_has_alpha ? &atmp : NULL);
+
+  g_array_free (strokes, TRUE);
+
+  if (runningvals.run)
+    gimp_progress_update (0.8);
+
   for (i = 0; i < num_brushes; i++)
     {
       ppm_kill (&brushes[i]);
@@ -16,24 +16,99 @@
 #include "libgimp/stdplugins-intl.h"
 
 
+/* Rows shaded by a single thread at a time, and between progress
+ * updates
+ */
+#define BAND_HEIGHT  32
+#define STEP_HEIGHT  (8 * BAND_HEIGHT)
+
+
+typedef struct
+{
+  get_ray_func  ray_func;
+  const Babl   *format;
+  gint          bpp;
+  gint          y;
+  gint          y_end;
+} LightingParams;
+
+
 /*************/
 /* Main loop */
 /*************/
 
-void
-compute_image (void)
+static void
+compute_rows (const LightingParams *params,
+              gint                  y1,
+              gint                  y2)
 {
-  gint         xcount, ycount;
+  ShadeRows   *rows;
+  guchar      *buffer;
+  guchar      *dest;
+  gboolean     bump_mapped;
   gdouble      color[4];
-  glong        progress_counter = 0;
   GimpVector3  p;
-  GimpImage   *new_image = NULL;
-  GimpLayer   *new_layer = NULL;
-  gint32       index;
-  guchar      *row = NULL;
-  guchar       obpp;
-  gboolean     has_alpha;
-  get_ray_func ray_func;
+  gint         xcount, ycount;
+
+  rows   = shade_rows_new ();
+  buffer = g_new (guchar, params->bpp * width * (y2 - y1));
+  dest   = buffer;
+
+  bump_mapped = mapvals.bump_mapped == TRUE && mapvals.bumpmap_id != -1;
+
+  if (bump_mapped)
+    shade_rows_seek (rows, 0, width, y1);
+
+  for (ycount = y1; ycount < y2; ycount++)
+    {
+      if (bump_mapped)
+        precompute_normals (rows, 0, width, ycount);
+
+      for (xcount = 0; xcount < width; xcount++)
+        {
+          p = int_to_pos (xcount, ycount);
+          (* params->ray_func) (rows, &p, color);
+
+          *dest++ = (guchar) (color[0] * 255.0);
+          *dest++ = (guchar) (color[1] * 255.0);
+          *dest++ = (guchar) (color[2] * 255.0);
+
+          if (params->bpp == 4)
+            *dest++ = (guchar) (color[3] * 255.0);
+        }
+    }
+
+  gegl_buffer_set (dest_buffer, GEGL_RECTANGLE (0, y1, width, y2 - y1), 0,
+                   params->format, buffer,
+                   GEGL_AUTO_ROWSTRIDE);
+
+  g_free (buffer);
+  shade_rows_free (rows);
+}
+
+static void
+compute_bands (gsize                 offset,
+               gsize                 size,
+               const LightingParams *params)
+{
+  gsize i;
+
+  for (i = offset; i < offset + size; i++)
+    {
+      gint y1 = params->y + i * BAND_HEIGHT;
+      gint y2 = MIN (y1 + BAND_HEIGHT, params->y_end);
+
+      compute_rows (params, y1, y2);
+    }
+}
+
+void
+compute_image (void)
+{
+  GimpImage      *new_image = NULL;
+  GimpLayer      *new_layer = NULL;
+  gboolean        has_alpha;
+  LightingParams  params;
 
   if (mapvals.create_new_image == TRUE ||
       (mapvals.transparent_background == TRUE &&
@@ -80,66 +155,39 @@ compute_image (void)
 
   if (! mapvals.env_mapped || mapvals.envmap_id == -1)
     {
-      ray_func = get_ray_color;
+      params.ray_func = get_ray_color;
     }
   else
     {
       envmap_setup (gimp_drawable_get_by_id (mapvals.envmap_id));
 
-      ray_func = get_ray_color_ref;
+      params.ray_func = get_ray_color_ref;
     }
 
   dest_buffer = gimp_drawable_get_shadow_buffer (output_drawable);
 
   has_alpha = gimp_drawable_has_alpha (output_drawable);
 
-  /* FIXME */
-  obpp = has_alpha ? 4 : 3; //gimp_drawable_get_bpp (output_drawable);
-
-  row = g_new (guchar, obpp * width);
+  params.format = has_alpha ?
+                  babl_format ("R'G'B'A u8") : babl_format ("R'G'B' u8");
+  params.bpp    = babl_format_get_bytes_per_pixel (params.format);
 
   gimp_progress_init (_("Lighting Effects"));
 
-  /* Init the first row */
-  if (mapvals.bump_mapped == TRUE && mapvals.bumpmap_id != -1 && height >= 2)
-    interpol_row (0, width, 0);
-
-  for (ycount = 0; ycount < height; ycount++)
+  for (params.y = 0; params.y < height; params.y = params.y_end)
     {
-      if (mapvals.bump_mapped == TRUE && mapvals.bumpmap_id != -1)
-	precompute_normals (0, width, ycount);
-
-      index = 0;
-
-      for (xcount = 0; xcount < width; xcount++)
-        {
-          p = int_to_pos (xcount, ycount);
-          (* ray_func) (&p, color);
-
-          row[index++] = (guchar) (color[0] * 255.0);
-          row[index++] = (guchar) (color[1] * 255.0);
-          row[index++] = (guchar) (color[2] * 255.0);
-
-          if (has_alpha)
-            row[index++] = (guchar) (color[3] * 255.0);
+      params.y_end = MIN (params.y + STEP_HEIGHT, height);
 
-          progress_counter++;
-        }
-
-      gimp_progress_update ((gdouble) progress_counter /
-                            (gdouble) maxcounter);
+      gegl_parallel_distribute_range (
+        (params.y_end - params.y + BAND_HEIGHT - 1) / BAND_HEIGHT, 1,
+        (GeglParallelDistributeRangeFunc) compute_bands,
+        &params);
 
-      gegl_buffer_set (dest_buffer, GEGL_RECTANGLE (0, ycount, width, 1), 0,
-                       has_alpha ?
-                       babl_format ("R'G'B'A u8") : babl_format ("R'G'B' u8"),
-                       row,
-                       GEGL_AUTO_ROWSTRIDE);
+      gimp_progress_update ((gdouble) params.y_end / (gdouble) height);
     }
 
   gimp_progress_update (1.0);
 
-  g_free (row);
-
   g_object_unref (dest_buffer);
 
   gimp_drawable_merge_shadow (output_drawable, TRUE);
@@ -4,6 +4,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <gtk/gtk.h>
 
 #include <libgimp/gimp.h>
@@ -20,6 +22,9 @@
 
 #define LIGHT_SYMBOL_SIZE 8
 
+/* Size of the blocks shaded as one pixel while a light is dragged */
+#define COARSE_PREVIEW_STEP 4
+
 static gint handle_xpos = 0, handle_ypos = 0;
 
 /* g_free()'ed on exit */
@@ -36,6 +41,7 @@ static guint preview_update_timer = 0;
 
 /* Protos */
 /* ====== */
+static void      preview_compute_step                (gint     step);
 static gboolean  interactive_preview_timer_callback  (gpointer data);
 
 void             composite_behind                    (gdouble *color1,
@@ -45,7 +51,8 @@ static void
 compute_preview (gint startx,
                  gint starty,
                  gint w,
-                 gint h)
+                 gint h,
+                 gint step)
 {
   gint xcnt, ycnt, f1, f2;
   guchar r, g, b;
@@ -56,6 +63,7 @@ compute_preview (gint startx,
   gdouble darkcheck[4]  = { GIMP_CHECK_DARK,  GIMP_CHECK_DARK, GIMP_CHECK_DARK, 1.0 };
   GimpVector3 pos;
   get_ray_func ray_func;
+  ShadeRows *rows;
 
   if (xpostab_size != w)
     {
@@ -99,6 +107,8 @@ compute_preview (gint startx,
       bumpmap_setup (gimp_drawable_get_by_id (mapvals.bumpmap_id));
     }
 
+  rows = shade_rows_new ();
+
   imagey = 0;
 
   if (mapvals.previewquality)
@@ -121,10 +131,31 @@ compute_preview (gint startx,
   for (ycnt = 0; ycnt < PREVIEW_HEIGHT; ycnt++)
     {
       index = ycnt * preview_rgb_stride;
+
+      /*  in a coarse preview, only every step-th row and column is
+       *  shaded, and the others repeat the pixels above and left of them
+       */
+      if ((ycnt > starty && ycnt < (starty + h)) &&
+          (ycnt - starty) % step != 0)
+        {
+          memcpy (preview_rgb_data + index,
+                  preview_rgb_data + index - preview_rgb_stride,
+                  preview_rgb_stride);
+          continue;
+        }
+
       for (xcnt = 0; xcnt < PREVIEW_WIDTH; xcnt++)
         {
           if ((ycnt >= starty && ycnt < (starty + h)) &&
-              (xcnt >= startx && xcnt < (startx + w)))
+              (xcnt >  startx && xcnt < (startx + w)) &&
+              (xcnt - startx) % step != 0)
+            {
+              memcpy (preview_rgb_data + index,
+                      preview_rgb_data + index - 4, 4);
+              index += 4;
+            }
+          else if ((ycnt >= starty && ycnt < (starty + h)) &&
+                   (xcnt >= startx && xcnt < (startx + w)))
             {
               imagex = xpostab[xcnt - startx];
               imagey = ypostab[ycnt - starty];
@@ -135,10 +166,10 @@ compute_preview (gint startx,
                   xcnt == startx)
                 {
                   pos_to_float (pos.x, pos.y, &imagex, &imagey);
-                  precompute_normals (0, width, RINT (imagey));
+                  precompute_normals (rows, 0, width, RINT (imagey));
                 }
 
-              (*ray_func) (&pos, color);
+              (*ray_func) (rows, &pos, color);
 
               if (color[3] < 1.0)
                 {
@@ -189,6 +220,8 @@ compute_preview (gint startx,
         }
     }
   cairo_surface_mark_dirty (preview_surface);
+
+  shade_rows_free (rows);
 }
 
 static void
@@ -378,6 +411,12 @@ update_light (gint xpos, gint ypos)
 
 void
 preview_compute (void)
+{
+  preview_compute_step (1);
+}
+
+static void
+preview_compute_step (gint step)
 {
   GdkDisplay *display = gtk_widget_get_display (previewarea);
   GdkCursor  *cursor;
@@ -391,7 +430,7 @@ preview_compute (void)
       gdk_window_set_cursor (gtk_widget_get_window (previewarea), cursor);
       g_object_unref (cursor);
 
-      compute_preview (startx, starty, pw, ph);
+      compute_preview (startx, starty, pw, ph, step);
       cursor = gdk_cursor_new_for_display (display, GDK_HAND2);
       gdk_window_set_cursor (gtk_widget_get_window (previewarea), cursor);
       g_object_unref (cursor);
@@ -420,6 +459,10 @@ preview_events (GtkWidget *area,
       break;
     case GDK_BUTTON_RELEASE:
       left_button_pressed = FALSE;
+
+      /*  replace the coarse preview of the dragged light  */
+      if (light_hit == TRUE && mapvals.interactive_preview == TRUE)
+        interactive_preview_callback (NULL);
       break;
     case GDK_MOTION_NOTIFY:
       if (left_button_pressed == TRUE &&
@@ -497,7 +540,7 @@ interactive_preview_timer_callback (gpointer data)
 
   mapvals.update_enabled = TRUE;
 
-  preview_compute ();
+  preview_compute_step (left_button_pressed ? COARSE_PREVIEW_STEP : 1);
 
   gtk_widget_queue_draw (previewarea);
 
@@ -11,14 +11,11 @@
 #include "lighting-shade.h"
 
 
-static GimpVector3 *triangle_normals[2] = { NULL, NULL };
-static GimpVector3 *vertex_normals[3]   = { NULL, NULL, NULL };
-static gdouble     *heights[3] = { NULL, NULL, NULL };
-static gdouble      xstep, ystep;
-static guchar      *bumprow = NULL;
+static gdouble xstep, ystep;
 
-static gint pre_w = -1;
-static gint pre_h = -1;
+static gint pre_w   = -1;
+static gint pre_h   = -1;
+static gint pre_bpp =  1;
 
 /*****************/
 /* Phong shading */
@@ -32,6 +29,7 @@ phong_shade (GimpVector3 *position,
              gdouble     *diff_col,
              gdouble     *light_col,
              LightType    light_type,
+             gdouble      diffuse_int,
              gdouble     *diffuse_color)
 {
   gdouble      specular_color[4];
@@ -85,7 +83,7 @@ phong_shade (GimpVector3 *position,
       for (gint i = 0; i < 4; i++)
         diffuse_color[i] = light_col[i];
       for (gint i = 0; i < 3; i++)
-        diffuse_color[i] *= mapvals.material.diffuse_int;
+        diffuse_color[i] *= diffuse_int;
 
       diffuse_color[0] *= diff_col[0];
       diffuse_color[1] *= diff_col[1];
@@ -123,60 +121,96 @@ void
 precompute_init (gint w,
                  gint h)
 {
-  gint n;
-  gint bpp=1;
-
   xstep = 1.0 / (gdouble) width;
   ystep = 1.0 / (gdouble) height;
 
-  pre_w = w;
-  pre_h = h;
+  pre_w   = w;
+  pre_h   = h;
+  pre_bpp = 1;
 
-  for (n = 0; n < 3; n++)
+  if (mapvals.bumpmap_id != -1)
     {
-      if (vertex_normals[n] != NULL)
-        g_free (vertex_normals[n]);
+      GimpDrawable *drawable = gimp_drawable_get_by_id (mapvals.bumpmap_id);
 
-      if (heights[n] != NULL)
-        g_free (heights[n]);
+      pre_bpp = gimp_drawable_get_bpp (drawable);
+    }
+}
+
+/* The rows of bump map heights and normals used while shading a
+ * run of consecutive rows.  Every thread rendering rows of its own
+ * needs separate ones.
+ */
+ShadeRows *
+shade_rows_new (void)
+{
+  ShadeRows *rows = g_new (ShadeRows, 1);
+  gint       n;
 
-      heights[n]        = g_new (gdouble, w);
-      vertex_normals[n] = g_new (GimpVector3, w);
+  for (n = 0; n < 3; n++)
+    {
+      rows->heights[n]        = g_new (gdouble, pre_w);
+      rows->vertex_normals[n] = g_new (GimpVector3, pre_w);
     }
 
-  for (n = 0; n < 2; n++)
-    if (triangle_normals[n] != NULL)
-      g_free (triangle_normals[n]);
+  rows->bumprow = g_new (guchar, pre_w * pre_bpp);
 
-  g_clear_pointer (&bumprow, g_free);
+  rows->triangle_normals[0] = g_new (GimpVector3, (pre_w << 1) + 2);
+  rows->triangle_normals[1] = g_new (GimpVector3, (pre_w << 1) + 2);
 
-  if (mapvals.bumpmap_id != -1)
+  for (n = 0; n < (pre_w << 1) + 1; n++)
     {
-      GimpDrawable *drawable = gimp_drawable_get_by_id (mapvals.bumpmap_id);
+      gimp_vector3_set (&rows->triangle_normals[0][n], 0.0, 0.0, 1.0);
+      gimp_vector3_set (&rows->triangle_normals[1][n], 0.0, 0.0, 1.0);
+    }
 
-      bpp = gimp_drawable_get_bpp (drawable);
+  for (n = 0; n < pre_w; n++)
+    {
+      gimp_vector3_set (&rows->vertex_normals[0][n], 0.0, 0.0, 1.0);
+      gimp_vector3_set (&rows->vertex_normals[1][n], 0.0, 0.0, 1.0);
+      gimp_vector3_set (&rows->vertex_normals[2][n], 0.0, 0.0, 1.0);
+      rows->heights[0][n] = 0.0;
+      rows->heights[1][n] = 0.0;
+      rows->heights[2][n] = 0.0;
     }
 
-  bumprow = g_new (guchar, w * bpp);
+  return rows;
+}
 
-  triangle_normals[0] = g_new (GimpVector3, (w << 1) + 2);
-  triangle_normals[1] = g_new (GimpVector3, (w << 1) + 2);
+void
+shade_rows_free (ShadeRows *rows)
+{
+  gint n;
 
-  for (n = 0; n < (w << 1) + 1; n++)
+  for (n = 0; n < 3; n++)
     {
-      gimp_vector3_set (&triangle_normals[0][n], 0.0, 0.0, 1.0);
-      gimp_vector3_set (&triangle_normals[1][n], 0.0, 0.0, 1.0);
+      g_free (rows->heights[n]);
+      g_free (rows->vertex_normals[n]);
     }
 
-  for (n = 0; n < w; n++)
-    {
-      gimp_vector3_set (&vertex_normals[0][n], 0.0, 0.0, 1.0);
-      gimp_vector3_set (&vertex_normals[1][n], 0.0, 0.0, 1.0);
-      gimp_vector3_set (&vertex_normals[2][n], 0.0, 0.0, 1.0);
-      heights[0][n] = 0.0;
-      heights[1][n] = 0.0;
-      heights[2][n] = 0.0;
-    }
+  g_free (rows->triangle_normals[0]);
+  g_free (rows->triangle_normals[1]);
+  g_free (rows->bumprow);
+
+  g_free (rows);
+}
+
+/* Bring a fresh set of rows to the state they would have after
+ * rendering all the rows above y, so that the bump map normals of
+ * a band match those of rendering the image top to bottom.
+ */
+void
+shade_rows_seek (ShadeRows *rows,
+                 gint       x1,
+                 gint       x2,
+                 gint       y)
+{
+  gint start = MAX (y - 2, 0);
+
+  if (start == 0 && pre_h >= 2)
+    interpol_row (rows, x1, x2, 0);
+
+  for (; start < y; start++)
+    precompute_normals (rows, x1, x2, start);
 }
 
 
@@ -184,9 +218,10 @@ precompute_init (gint w,
  * using the next row
  */
 void
-interpol_row (gint x1,
-              gint x2,
-              gint y)
+interpol_row (ShadeRows *rows,
+              gint       x1,
+              gint       x2,
+              gint       y)
 {
   GimpVector3  p1, p2, p3;
   gint         n, i;
@@ -196,11 +231,7 @@ interpol_row (gint x1,
   guchar      *bumprow2 = NULL;
 
   if (mapvals.bumpmap_id != -1)
-    {
-      bumpmap_setup (gimp_drawable_get_by_id (mapvals.bumpmap_id));
-
-      bpp = babl_format_get_bytes_per_pixel (bump_format);
-    }
+    bpp = babl_format_get_bytes_per_pixel (bump_format);
 
   bumprow1 = g_new0 (guchar, pre_w * bpp);
   bumprow2 = g_new0 (guchar, pre_w * bpp);
@@ -251,13 +282,13 @@ interpol_row (gint x1,
 
       if (mapvals.bumpmaptype > 0)
         {
-          heights[1][n] = (gdouble) mapvals.bumpmax * (gdouble) map[mapval1] / 255.0;
-          heights[2][n] = (gdouble) mapvals.bumpmax * (gdouble) map[mapval] / 255.0;
+          rows->heights[1][n] = (gdouble) mapvals.bumpmax * (gdouble) map[mapval1] / 255.0;
+          rows->heights[2][n] = (gdouble) mapvals.bumpmax * (gdouble) map[mapval] / 255.0;
         }
       else
         {
-          heights[1][n] = (gdouble) mapvals.bumpmax * (gdouble) mapval1 / 255.0;
-          heights[2][n] = (gdouble) mapvals.bumpmax * (gdouble) mapval / 255.0;
+          rows->heights[1][n] = (gdouble) mapvals.bumpmax * (gdouble) mapval1 / 255.0;
+          rows->heights[2][n] = (gdouble) mapvals.bumpmax * (gdouble) mapval / 255.0;
         }
     }
 
@@ -267,21 +298,21 @@ interpol_row (gint x1,
       /* heights rows 1 and 2 are inverted */
       p1.x = 0.0;
       p1.y = ystep;
-      p1.z = heights[1][n] - heights[2][n];
+      p1.z = rows->heights[1][n] - rows->heights[2][n];
 
       p2.x = xstep;
       p2.y = ystep;
-      p2.z = heights[1][n+1] - heights[2][n];
+      p2.z = rows->heights[1][n+1] - rows->heights[2][n];
 
       p3.x = xstep;
       p3.y = 0.0;
-      p3.z = heights[2][n+1] - heights[2][n];
+      p3.z = rows->heights[2][n+1] - rows->heights[2][n];
 
-      triangle_normals[1][i] = gimp_vector3_cross_product (&p2, &p1);
-      triangle_normals[1][i+1] = gimp_vector3_cross_product (&p3, &p2);
+      rows->triangle_normals[1][i] = gimp_vector3_cross_product (&p2, &p1);
+      rows->triangle_normals[1][i+1] = gimp_vector3_cross_product (&p3, &p2);
 
-      gimp_vector3_normalize (&triangle_normals[1][i]);
-      gimp_vector3_normalize (&triangle_normals[1][i+1]);
+      gimp_vector3_normalize (&rows->triangle_normals[1][i]);
+      gimp_vector3_normalize (&rows->triangle_normals[1][i+1]);
 
       i += 2;
     }
@@ -296,9 +327,10 @@ interpol_row (gint x1,
 
 
 void
-precompute_normals (gint x1,
-                    gint x2,
-                    gint y)
+precompute_normals (ShadeRows *rows,
+                    gint       x1,
+                    gint       x2,
+                    gint       y)
 {
   GimpVector3 *tmpv, p1, p2, p3, normal;
   gdouble     *tmpd;
@@ -311,29 +343,25 @@ precompute_normals (gint x1,
   /* First, compute the heights */
   /* ========================== */
 
-  tmpv                = triangle_normals[0];
-  triangle_normals[0] = triangle_normals[1];
-  triangle_normals[1] = tmpv;
+  tmpv                      = rows->triangle_normals[0];
+  rows->triangle_normals[0] = rows->triangle_normals[1];
+  rows->triangle_normals[1] = tmpv;
 
-  tmpv              = vertex_normals[0];
-  vertex_normals[0] = vertex_normals[1];
-  vertex_normals[1] = vertex_normals[2];
-  vertex_normals[2] = tmpv;
+  tmpv                    = rows->vertex_normals[0];
+  rows->vertex_normals[0] = rows->vertex_normals[1];
+  rows->vertex_normals[1] = rows->vertex_normals[2];
+  rows->vertex_normals[2] = tmpv;
 
-  tmpd       = heights[0];
-  heights[0] = heights[1];
-  heights[1] = heights[2];
-  heights[2] = tmpd;
+  tmpd             = rows->heights[0];
+  rows->heights[0] = rows->heights[1];
+  rows->heights[1] = rows->heights[2];
+  rows->heights[2] = tmpd;
 
   if (mapvals.bumpmap_id != -1)
-    {
-      bumpmap_setup (gimp_drawable_get_by_id (mapvals.bumpmap_id));
-
-      bpp = babl_format_get_bytes_per_pixel (bump_format);
-    }
+    bpp = babl_format_get_bytes_per_pixel (bump_format);
 
   gegl_buffer_get (bump_buffer, GEGL_RECTANGLE (x1, y, x2 - x1, 1), 1.0,
-                   bump_format, bumprow,
+                   bump_format, rows->bumprow,
                    GEGL_AUTO_ROWSTRIDE, GEGL_ABYSS_NONE);
 
   if (mapvals.bumpmaptype > 0)
@@ -355,16 +383,16 @@ precompute_normals (gint x1,
         {
           if (bpp > 1)
             {
-              mapval = (guchar)((float)((bumprow[n * bpp + 0] +
-                                         bumprow[n * bpp + 1] +
-                                         bumprow[n * bpp + 2])  /3.0));
+              mapval = (guchar)((float)((rows->bumprow[n * bpp + 0] +
+                                         rows->bumprow[n * bpp + 1] +
+                                         rows->bumprow[n * bpp + 2])  /3.0));
             }
           else
             {
-              mapval = bumprow[n * bpp];
+              mapval = rows->bumprow[n * bpp];
             }
 
-          heights[2][n] = (gdouble) mapvals.bumpmax * (gdouble) map[mapval] / 255.0;
+          rows->heights[2][n] = (gdouble) mapvals.bumpmax * (gdouble) map[mapval] / 255.0;
         }
     }
   else
@@ -373,16 +401,16 @@ precompute_normals (gint x1,
         {
           if (bpp > 1)
             {
-              mapval = (guchar)((float)((bumprow[n * bpp + 0] +
-                                         bumprow[n * bpp + 1] +
-                                         bumprow[n * bpp + 2]) / 3.0));
+              mapval = (guchar)((float)((rows->bumprow[n * bpp + 0] +
+                                         rows->bumprow[n * bpp + 1] +
+                                         rows->bumprow[n * bpp + 2]) / 3.0));
             }
           else
             {
-              mapval = bumprow[n * bpp];
+              mapval = rows->bumprow[n * bpp];
             }
 
-          heights[2][n] = (gdouble) mapvals.bumpmax * (gdouble) mapval / 255.0;
+          rows->heights[2][n] = (gdouble) mapvals.bumpmax * (gdouble) mapval / 255.0;
         }
     }
 
@@ -394,21 +422,21 @@ precompute_normals (gint x1,
     {
       p1.x = 0.0;
       p1.y = ystep;
-      p1.z = heights[2][n] - heights[1][n];
+      p1.z = rows->heights[2][n] - rows->heights[1][n];
 
       p2.x = xstep;
       p2.y = ystep;
-      p2.z = heights[2][n+1] - heights[1][n];
+      p2.z = rows->heights[2][n+1] - rows->heights[1][n];
 
       p3.x = xstep;
       p3.y = 0.0;
-      p3.z = heights[1][n+1] - heights[1][n];
+      p3.z = rows->heights[1][n+1] - rows->heights[1][n];
 
-      triangle_normals[1][i] = gimp_vector3_cross_product (&p2, &p1);
-      triangle_normals[1][i+1] = gimp_vector3_cross_product (&p3, &p2);
+      rows->triangle_normals[1][i] = gimp_vector3_cross_product (&p2, &p1);
+      rows->triangle_normals[1][i+1] = gimp_vector3_cross_product (&p3, &p2);
 
-      gimp_vector3_normalize (&triangle_normals[1][i]);
-      gimp_vector3_normalize (&triangle_normals[1][i+1]);
+      gimp_vector3_normalize (&rows->triangle_normals[1][i]);
+      gimp_vector3_normalize (&rows->triangle_normals[1][i+1]);
 
       i += 2;
     }
@@ -427,14 +455,14 @@ precompute_normals (gint x1,
         {
           if (y > 0)
             {
-              gimp_vector3_add (&normal, &normal, &triangle_normals[0][i-1]);
-              gimp_vector3_add (&normal, &normal, &triangle_normals[0][i-2]);
+              gimp_vector3_add (&normal, &normal, &rows->triangle_normals[0][i-1]);
+              gimp_vector3_add (&normal, &normal, &rows->triangle_normals[0][i-2]);
               nv += 2;
             }
 
           if (y < pre_h)
             {
-              gimp_vector3_add (&normal, &normal, &triangle_normals[1][i-1]);
+              gimp_vector3_add (&normal, &normal, &rows->triangle_normals[1][i-1]);
               nv++;
             }
         }
@@ -443,22 +471,22 @@ precompute_normals (gint x1,
         {
           if (y > 0)
             {
-              gimp_vector3_add (&normal, &normal, &triangle_normals[0][i]);
-              gimp_vector3_add (&normal, &normal, &triangle_normals[0][i+1]);
+              gimp_vector3_add (&normal, &normal, &rows->triangle_normals[0][i]);
+              gimp_vector3_add (&normal, &normal, &rows->triangle_normals[0][i+1]);
               nv += 2;
             }
 
           if (y < pre_h)
             {
-              gimp_vector3_add (&normal, &normal, &triangle_normals[1][i]);
-              gimp_vector3_add (&normal, &normal, &triangle_normals[1][i+1]);
+              gimp_vector3_add (&normal, &normal, &rows->triangle_normals[1][i]);
+              gimp_vector3_add (&normal, &normal, &rows->triangle_normals[1][i+1]);
               nv += 2;
             }
         }
 
       gimp_vector3_mul (&normal, 1.0 / (gdouble) nv);
       gimp_vector3_normalize (&normal);
-      vertex_normals[1][n] = normal;
+      rows->vertex_normals[1][n] = normal;
 
       i += 2;
     }
@@ -495,8 +523,8 @@ sphere_to_image (GimpVector3 *normal,
                  gdouble     *u,
                  gdouble     *v)
 {
-  static gdouble     alpha, fac;
-  static GimpVector3 cross_prod;
+  gdouble            alpha, fac;
+  GimpVector3        cross_prod;
   static GimpVector3 firstaxis  = { 1.0, 0.0, 0.0 };
   static GimpVector3 secondaxis = { 0.0, 1.0, 0.0 };
 
@@ -534,7 +562,8 @@ sphere_to_image (GimpVector3 *normal,
 /*********************************************************************/
 
 void
-get_ray_color (GimpVector3 *position,
+get_ray_color (ShadeRows   *rows,
+               GimpVector3 *position,
                gdouble     *color_sum)
 {
   gdouble       color[4];
@@ -549,7 +578,7 @@ get_ray_color (GimpVector3 *position,
 
   x = RINT (xf);
 
-  if (mapvals.transparent_background && heights[1][x] == 0)
+  if (mapvals.transparent_background && rows->heights[1][x] == 0)
     {
       color_sum[3] = 0.0;
     }
@@ -587,11 +616,12 @@ get_ray_color (GimpVector3 *position,
                            color,
                            color_int,
                            mapvals.lightsource[k].type,
+                           mapvals.material.diffuse_int,
                            light_color);
             }
           else
             {
-              normal = vertex_normals[1][(gint) RINT (xf)];
+              normal = rows->vertex_normals[1][(gint) RINT (xf)];
 
               phong_shade (position,
                            &mapvals.viewpoint,
@@ -600,6 +630,7 @@ get_ray_color (GimpVector3 *position,
                            color,
                            color_int,
                            mapvals.lightsource[k].type,
+                           mapvals.material.diffuse_int,
                            light_color);
             }
 
@@ -613,7 +644,8 @@ get_ray_color (GimpVector3 *position,
 }
 
 void
-get_ray_color_ref (GimpVector3 *position,
+get_ray_color_ref (ShadeRows   *rows,
+                   GimpVector3 *position,
                    gdouble     *color_sum)
 {
   gdouble      color_int[4];
@@ -623,7 +655,6 @@ get_ray_color_ref (GimpVector3 *position,
   gdouble      xf, yf;
   GimpVector3  normal, *p, v, r;
   gint         k;
-  gdouble      tmpval;
 
   pos_to_float (position->x, position->y, &xf, &yf);
 
@@ -636,12 +667,12 @@ get_ray_color_ref (GimpVector3 *position,
     }
   else
     {
-      normal = vertex_normals[1][(gint) RINT (xf)];
+      normal = rows->vertex_normals[1][(gint) RINT (xf)];
     }
 
   gimp_vector3_normalize (&normal);
 
-  if (mapvals.transparent_background && heights[1][x] == 0)
+  if (mapvals.transparent_background && rows->heights[1][x] == 0)
     {
       color_sum[3] = 0.0;
     }
@@ -676,6 +707,7 @@ get_ray_color_ref (GimpVector3 *position,
                        color,
                        color_int,
                        mapvals.lightsource[0].type,
+                       mapvals.material.diffuse_int,
                        light_color);
         }
 
@@ -692,8 +724,6 @@ get_ray_color_ref (GimpVector3 *position,
                     RINT (env_height * yf),
                     env_color);
 
-      tmpval = mapvals.material.diffuse_int;
-      mapvals.material.diffuse_int = 0.;
 
       phong_shade (position,
                    &mapvals.viewpoint,
@@ -702,10 +732,9 @@ get_ray_color_ref (GimpVector3 *position,
                    color,
                    env_color,
                    DIRECTIONAL_LIGHT,
+                   0.0,
                    light_color);
 
-      mapvals.material.diffuse_int = tmpval;
-
       for (gint i = 0; i < 3; i++)
         color_sum[i] += light_color[i];
     }
@@ -715,7 +744,8 @@ get_ray_color_ref (GimpVector3 *position,
 }
 
 void
-get_ray_color_no_bilinear (GimpVector3 *position,
+get_ray_color_no_bilinear (ShadeRows   *rows,
+                           GimpVector3 *position,
                            gdouble     *color_sum)
 {
   gdouble       color[4];
@@ -730,7 +760,7 @@ get_ray_color_no_bilinear (GimpVector3 *position,
 
   x = RINT (xf);
 
-  if (mapvals.transparent_background && heights[1][x] == 0)
+  if (mapvals.transparent_background && rows->heights[1][x] == 0)
     {
       color_sum[3] = 0.0;
     }
@@ -768,11 +798,12 @@ get_ray_color_no_bilinear (GimpVector3 *position,
                            color,
                            color_int,
                            mapvals.lightsource[k].type,
+                           mapvals.material.diffuse_int,
                            light_color);
             }
           else
             {
-              normal = vertex_normals[1][x];
+              normal = rows->vertex_normals[1][x];
 
               phong_shade (position,
                            &mapvals.viewpoint,
@@ -781,6 +812,7 @@ get_ray_color_no_bilinear (GimpVector3 *position,
                            color,
                            color_int,
                            mapvals.lightsource[k].type,
+                           mapvals.material.diffuse_int,
                            light_color);
             }
 
@@ -794,7 +826,8 @@ get_ray_color_no_bilinear (GimpVector3 *position,
 }
 
 void
-get_ray_color_no_bilinear_ref (GimpVector3 *position,
+get_ray_color_no_bilinear_ref (ShadeRows   *rows,
+                               GimpVector3 *position,
                                gdouble     *color_sum)
 {
   gdouble      color_int[4];
@@ -804,7 +837,6 @@ get_ray_color_no_bilinear_ref (GimpVector3 *position,
   gdouble      xf, yf;
   GimpVector3  normal, *p, v, r;
   gint         k;
-  gdouble      tmpval;
 
   pos_to_float (position->x, position->y, &xf, &yf);
 
@@ -817,12 +849,12 @@ get_ray_color_no_bilinear_ref (GimpVector3 *position,
     }
   else
     {
-      normal = vertex_normals[1][(gint) RINT (xf)];
+      normal = rows->vertex_normals[1][(gint) RINT (xf)];
     }
 
   gimp_vector3_normalize (&normal);
 
-  if (mapvals.transparent_background && heights[1][x] == 0)
+  if (mapvals.transparent_background && rows->heights[1][x] == 0)
     {
       color_sum[3] = 0.0;
     }
@@ -857,6 +889,7 @@ get_ray_color_no_bilinear_ref (GimpVector3 *position,
                        color,
                        color_int,
                        mapvals.lightsource[0].type,
+                       mapvals.material.diffuse_int,
                        light_color);
         }
 
@@ -873,8 +906,6 @@ get_ray_color_no_bilinear_ref (GimpVector3 *position,
                     RINT (env_height * yf),
                     env_color);
 
-      tmpval = mapvals.material.diffuse_int;
-      mapvals.material.diffuse_int = 0.0;
 
       phong_shade (position,
                    &mapvals.viewpoint,
@@ -883,10 +914,9 @@ get_ray_color_no_bilinear_ref (GimpVector3 *position,
                    color,
                    env_color,
                    DIRECTIONAL_LIGHT,
+                   0.0,
                    light_color);
 
-      mapvals.material.diffuse_int = tmpval;
-
       for (gint i = 0; i < 3; i++)
         color_sum[i] += light_color[i];
     }
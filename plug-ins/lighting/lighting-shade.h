@@ -1,24 +1,45 @@
 #ifndef __LIGHTING_SHADE_H__
 #define __LIGHTING_SHADE_H__
 
-typedef void (* get_ray_func) (GimpVector3 *vector,
+typedef struct
+{
+  GimpVector3 *triangle_normals[2];
+  GimpVector3 *vertex_normals[3];
+  gdouble     *heights[3];
+  guchar      *bumprow;
+} ShadeRows;
+
+typedef void (* get_ray_func) (ShadeRows   *rows,
+                               GimpVector3 *vector,
                                gdouble     *color_sum);
 
-void get_ray_color                 (GimpVector3 *position,
+void get_ray_color                 (ShadeRows   *rows,
+                                    GimpVector3 *position,
                                     gdouble     *color_sum);
-void get_ray_color_no_bilinear     (GimpVector3 *position,
+void get_ray_color_no_bilinear     (ShadeRows   *rows,
+                                    GimpVector3 *position,
                                     gdouble     *color_sum);
-void get_ray_color_ref             (GimpVector3 *position,
+void get_ray_color_ref             (ShadeRows   *rows,
+                                    GimpVector3 *position,
                                     gdouble     *color_sum);
-void get_ray_color_no_bilinear_ref (GimpVector3 *position,
+void get_ray_color_no_bilinear_ref (ShadeRows   *rows,
+                                    GimpVector3 *position,
                                     gdouble     *color_sum);
 
-void    precompute_init               (gint         w,
+void        precompute_init           (gint         w,
                                        gint         h);
-void    precompute_normals            (gint         x1,
+ShadeRows * shade_rows_new            (void);
+void        shade_rows_free           (ShadeRows   *rows);
+void        shade_rows_seek           (ShadeRows   *rows,
+                                       gint         x1,
+                                       gint         x2,
+                                       gint         y);
+void        precompute_normals        (ShadeRows   *rows,
+                                       gint         x1,
                                        gint         x2,
                                        gint         y);
-void    interpol_row                  (gint         x1,
+void        interpol_row              (ShadeRows   *rows,
+                                       gint         x1,
                                        gint         x2,
                                        gint         y);
 
@@ -19,6 +19,26 @@
 #include "libgimp/stdplugins-intl.h"
 
 
+/* Rows rendered by a single thread at a time, and between progress
+ * updates
+ */
+#define BAND_HEIGHT  16
+#define STEP_HEIGHT  (8 * BAND_HEIGHT)
+
+
+typedef struct
+{
+  gint y;
+  gint y_end;
+} ComputeParams;
+
+typedef struct
+{
+  gint     y;
+  gdouble *pixels;
+} ComputeBand;
+
+
 /*************/
 /* Main loop */
 /*************/
@@ -196,12 +216,80 @@ render (gdouble   x,
 }
 
 static void
-show_progress (gint     min,
-               gint     max,
-               gint     curr,
-               gpointer data)
+put_pixel (gint         x,
+           gint         y,
+           gdouble     *color,
+           ComputeBand *band)
 {
-  gimp_progress_update ((gdouble) curr / (gdouble) max);
+  memcpy (band->pixels + 4 * ((y - band->y) * width + x),
+          color, 4 * sizeof (gdouble));
+}
+
+static void
+compute_rows (gint y1,
+              gint y2)
+{
+  ComputeBand  band;
+  gdouble     *dest;
+  GimpVector3  p;
+  gint         xcount, ycount;
+
+  band.y      = y1;
+  band.pixels = g_new (gdouble, 4 * width * (y2 - y1));
+
+  if (! mapvals.antialiasing)
+    {
+      dest = band.pixels;
+
+      for (ycount = y1; ycount < y2; ycount++)
+        {
+          for (xcount = 0; xcount < width; xcount++)
+            {
+              p = int_to_pos (xcount, ycount);
+              (* get_ray_color) (&p, dest);
+
+              dest += 4;
+            }
+        }
+    }
+  else
+    {
+      /*  the supersampler keeps all its state on the stack, so each
+       *  band is antialiased on its own
+       */
+      gimp_adaptive_supersample_area (0, y1,
+                                      width - 1, y2 - 1,
+                                      max_depth,
+                                      mapvals.pixelthreshold,
+                                      render,
+                                      NULL,
+                                      (GimpPutPixelFunc) put_pixel,
+                                      &band,
+                                      NULL,
+                                      NULL);
+    }
+
+  gegl_buffer_set (dest_buffer, GEGL_RECTANGLE (0, y1, width, y2 - y1), 0,
+                   babl_format ("R'G'B'A double"), band.pixels,
+                   GEGL_AUTO_ROWSTRIDE);
+
+  g_free (band.pixels);
+}
+
+static void
+compute_bands (gsize                offset,
+               gsize                size,
+               const ComputeParams *params)
+{
+  gsize i;
+
+  for (i = offset; i < offset + size; i++)
+    {
+      gint y1 = params->y + i * BAND_HEIGHT;
+      gint y2 = MIN (y1 + BAND_HEIGHT, params->y_end);
+
+      compute_rows (y1, y2);
+    }
 }
 
 /**************************************************/
@@ -212,13 +300,10 @@ show_progress (gint     min,
 void
 compute_image (void)
 {
-  gint         xcount, ycount;
-  gdouble      color[4];
-  glong        progress_counter = 0;
-  GimpVector3  p;
-  GimpImage   *new_image    = NULL;
-  GimpLayer   *new_layer    = NULL;
-  gboolean     insert_layer = FALSE;
+  GimpImage     *new_image    = NULL;
+  GimpLayer     *new_layer    = NULL;
+  gboolean       insert_layer = FALSE;
+  ComputeParams  params;
 
   init_compute ();
 
@@ -272,35 +357,16 @@ compute_image (void)
       break;
     }
 
-  if (! mapvals.antialiasing)
+  for (params.y = 0; params.y < height; params.y = params.y_end)
     {
-      for (ycount = 0; ycount < height; ycount++)
-        {
-          for (xcount = 0; xcount < width; xcount++)
-            {
-              p = int_to_pos (xcount, ycount);
-              (* get_ray_color) (&p, color);
-              poke (xcount, ycount, color, NULL);
+      params.y_end = MIN (params.y + STEP_HEIGHT, height);
 
-              progress_counter++;
-            }
+      gegl_parallel_distribute_range (
+        (params.y_end - params.y + BAND_HEIGHT - 1) / BAND_HEIGHT, 1,
+        (GeglParallelDistributeRangeFunc) compute_bands,
+        &params);
 
-          gimp_progress_update ((gdouble) progress_counter /
-                                (gdouble) maxcounter);
-        }
-    }
-  else
-    {
-      gimp_adaptive_supersample_area (0, 0,
-                                      width - 1, height - 1,
-                                      max_depth,
-                                      mapvals.pixelthreshold,
-                                      render,
-                                      NULL,
-                                      poke,
-                                      NULL,
-                                      show_progress,
-                                      NULL);
+      gimp_progress_update ((gdouble) params.y_end / (gdouble) height);
     }
 
   gimp_progress_update (1.0);
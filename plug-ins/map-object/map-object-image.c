@@ -98,17 +98,6 @@ peek_cylinder_image (gint     image,
     color[3] = 1.0;
 }
 
-void
-poke (gint      x,
-      gint      y,
-      gdouble  *color,
-      gpointer  user_data)
-{
-  gegl_buffer_set (dest_buffer, GEGL_RECTANGLE (x, y, 1, 1), 0,
-                   babl_format ("R'G'B'A double"), color,
-                   GEGL_AUTO_ROWSTRIDE);
-}
-
 gint
 checkbounds (gint x,
              gint y)
@@ -43,10 +43,6 @@ extern gint        checkbounds              (gint          x,
 extern void        peek                     (gint          x,
                                              gint          y,
                                              gdouble      *color);
-extern void        poke                     (gint          x,
-                                             gint          y,
-                                             gdouble      *color,
-                                             gpointer      user_data);
 extern GimpVector3 int_to_pos               (gint          x,
                                              gint          y);
 extern void        pos_to_int               (gdouble       x,
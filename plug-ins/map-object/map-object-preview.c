@@ -17,12 +17,23 @@
 #include "map-object-preview.h"
 
 
+typedef struct
+{
+  const gdouble *xpostab;
+  const gdouble *ypostab;
+  gint           pw;
+} PreviewParams;
+
+
 gdouble mat[3][4];
 gint    lightx, lighty;
 
 /* Protos */
 /* ====== */
 
+static void compute_preview_rows    (gsize                offset,
+                                     gsize                size,
+                                     const PreviewParams *params);
 static void compute_preview         (gint x,
                                      gint y,
                                      gint w,
@@ -70,6 +81,73 @@ static void draw_wireframe_cylinder (cairo_t *cr,
                                      gint        pw,
                                      gint        ph);
 
+static void
+compute_preview_rows (gsize                offset,
+                      gsize                size,
+                      const PreviewParams *params)
+{
+  GimpVector3  p1;
+  gdouble      color[4];
+  gdouble      lightcheck[4] = { GIMP_CHECK_LIGHT, GIMP_CHECK_LIGHT, GIMP_CHECK_LIGHT, 1.0 };
+  gdouble      darkcheck[4]  = { GIMP_CHECK_DARK, GIMP_CHECK_DARK, GIMP_CHECK_DARK, 1.0 };
+  gint         xcnt, f1, f2;
+  gsize        ycnt;
+  guchar       r, g, b;
+  glong        index = 0;
+
+  p1.z = 0.0;
+
+  for (ycnt = offset; ycnt < offset + size; ycnt++)
+    {
+      index = ycnt * preview_rgb_stride;
+      for (xcnt = 0; xcnt < params->pw; xcnt++)
+        {
+          p1.x = params->xpostab[xcnt];
+          p1.y = params->ypostab[ycnt];
+
+          (* get_ray_color) (&p1, color);
+
+          if (color[3] < 1.0)
+            {
+              f1 = ((xcnt % 32) < 16);
+              f2 = ((ycnt % 32) < 16);
+              f1 = f1 ^ f2;
+
+              if (f1)
+                {
+                  if (color[3] == 0.0)
+                    {
+                      for (gint i = 0; i < 4; i++)
+                        color[i] = lightcheck[i];
+                    }
+                  else
+                    {
+                      composite (color, lightcheck, COMPOSITE_BEHIND);
+                    }
+                 }
+              else
+                {
+                  if (color[3] == 0.0)
+                    {
+                      for (gint i = 0; i < 4; i++)
+                        color[i] = darkcheck[i];
+                    }
+                  else
+                    {
+                      composite (color, darkcheck, COMPOSITE_BEHIND);
+                    }
+                }
+            }
+
+          r = (guchar) (color[0] * 255);
+          g = (guchar) (color[1] * 255);
+          b = (guchar) (color[2] * 255);
+          GIMP_CAIRO_RGB24_SET_PIXEL((preview_rgb_data + index), r, g, b);
+          index += 4;
+        }
+    }
+}
+
 /**************************************************************/
 /* Computes a preview of the rectangle starting at (x,y) with */
 /* dimensions (w,h), placing the result in preview_RGB_data.  */
@@ -83,17 +161,13 @@ compute_preview (gint x,
                  gint pw,
                  gint ph)
 {
-  gdouble      xpostab[PREVIEW_WIDTH];
-  gdouble      ypostab[PREVIEW_HEIGHT];
-  gdouble      realw;
-  gdouble      realh;
-  GimpVector3  p1, p2;
-  gdouble      color[4];
-  gdouble      lightcheck[4] = { GIMP_CHECK_LIGHT, GIMP_CHECK_LIGHT, GIMP_CHECK_LIGHT, 1.0 };
-  gdouble      darkcheck[4]  = { GIMP_CHECK_DARK, GIMP_CHECK_DARK, GIMP_CHECK_DARK, 1.0 };
-  gint         xcnt, ycnt, f1, f2;
-  guchar       r, g, b;
-  glong        index = 0;
+  gdouble        xpostab[PREVIEW_WIDTH];
+  gdouble        ypostab[PREVIEW_HEIGHT];
+  gdouble        realw;
+  gdouble        realh;
+  GimpVector3    p1, p2;
+  gint           xcnt, ycnt;
+  PreviewParams  params;
 
   init_compute ();
 
@@ -135,60 +209,17 @@ compute_preview (gint x,
       g_object_unref (gegl_color);
     }
 
-  gimp_vector3_set (&p2, -1.0, -1.0, 0.0);
-
   cairo_surface_flush (preview_surface);
 
-  for (ycnt = 0; ycnt < ph; ycnt++)
-    {
-      index = ycnt * preview_rgb_stride;
-      for (xcnt = 0; xcnt < pw; xcnt++)
-        {
-          p1.x = xpostab[xcnt];
-          p1.y = ypostab[ycnt];
+  params.xpostab = xpostab;
+  params.ypostab = ypostab;
+  params.pw      = pw;
 
-          p2 = p1;
-          (* get_ray_color) (&p1, color);
-
-          if (color[3] < 1.0)
-            {
-              f1 = ((xcnt % 32) < 16);
-              f2 = ((ycnt % 32) < 16);
-              f1 = f1 ^ f2;
-
-              if (f1)
-                {
-                  if (color[3] == 0.0)
-                    {
-                      for (gint i = 0; i < 4; i++)
-                        color[i] = lightcheck[i];
-                    }
-                  else
-                    {
-                      composite (color, lightcheck, COMPOSITE_BEHIND);
-                    }
-                 }
-              else
-                {
-                  if (color[3] == 0.0)
-                    {
-                      for (gint i = 0; i < 4; i++)
-                        color[i] = darkcheck[i];
-                    }
-                  else
-                    {
-                      composite (color, darkcheck, COMPOSITE_BEHIND);
-                    }
-                }
-            }
+  gegl_parallel_distribute_range (
+    ph, 8,
+    (GeglParallelDistributeRangeFunc) compute_preview_rows,
+    &params);
 
-          r = (guchar) (color[0] * 255);
-          g = (guchar) (color[1] * 255);
-          b = (guchar) (color[2] * 255);
-          GIMP_CAIRO_RGB24_SET_PIXEL((preview_rgb_data + index), r, g, b);
-          index += 4;
-        }
-    }
   cairo_surface_mark_dirty (preview_surface);
 }
 
@@ -0,0 +1,461 @@
+#!/usr/bin/env python3
+
+#   GIMP - The GNU Image Manipulation Program
+#   Copyright (C) 1995 Spencer Kimball and Peter Mattis
+#
+#   gimp-python-host.py
+#
+#   This program is free software: you can redistribute it and/or modify
+#   it under the terms of the GNU General Public License as published by
+#   the Free Software Foundation; either version 3 of the License, or
+#   (at your option) any later version.
+#
+#   This program is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+# A resident host for Python plug-ins.
+#
+# Set as the interpreter of Python plug-ins (see pygimp-host.interp), this
+# script is started by GIMP in place of python3, with the plug-in script
+# and GIMP's arguments.  Started this way, it is the "launcher": it doesn't
+# import gi, but hands the plug-in over to the host of the GIMP session,
+# starting it first if needed, and then only relays signals and the exit
+# status.
+#
+# The host imports gi and loads the typelibs once, and forks for each
+# plug-in.  The forked process takes over the launcher's standard streams
+# and wire file descriptors, its working directory, environment and
+# arguments, and runs the plug-in script as __main__.  Each plug-in thus
+# starts from the warm interpreter, in its own process, whatever it changes
+# being gone once it exits.
+#
+# The host exits when GIMP does, or after being idle for a while.  Whenever
+# it can't be used, the launcher just runs the plug-in with python3, as if
+# there was no host; setting GIMP_PYTHON_HOST=0 in the environment disables
+# it.
+
+import array
+import json
+import os
+import socket
+import stat
+import struct
+import sys
+import time
+
+HOST_IDLE_TIMEOUT    = 600  # seconds
+HOST_START_TIMEOUT   = 10   # seconds
+HOST_POLL_INTERVAL   = 10   # seconds
+
+FORWARDED_SIGNALS    = ('SIGTERM', 'SIGINT', 'SIGHUP', 'SIGQUIT')
+
+
+def get_socket_path(gimp_pid):
+    runtime_dir = os.environ.get('XDG_RUNTIME_DIR')
+
+    if not runtime_dir or not os.path.isdir(runtime_dir):
+        import tempfile
+
+        runtime_dir = os.path.join(tempfile.gettempdir(),
+                                   'gimp-python-host-%d' % os.getuid())
+
+        try:
+            os.mkdir(runtime_dir, 0o700)
+        except FileExistsError:
+            pass
+
+    # only trust a directory nobody else can write to
+    st = os.lstat(runtime_dir)
+    if (not stat.S_ISDIR(st.st_mode) or st.st_uid != os.getuid() or
+        st.st_mode & (stat.S_IWGRP | stat.S_IWOTH)):
+        return None
+
+    return os.path.join(runtime_dir, 'gimp-python-host-%d' % gimp_pid)
+
+
+def send_message(sock, message, fds=()):
+    data = json.dumps(message).encode('utf-8')
+    data = struct.pack('!I', len(data)) + data
+
+    if fds:
+        ancillary = [(socket.SOL_SOCKET, socket.SCM_RIGHTS,
+                      array.array('i', fds).tobytes())]
+    else:
+        ancillary = []
+
+    sent = sock.sendmsg([data], ancillary)
+    if sent < len(data):
+        sock.sendall(data[sent:])
+
+
+def recv_exactly(sock, size):
+    data = b''
+
+    while len(data) < size:
+        chunk = sock.recv(size - len(data))
+        if not chunk:
+            raise EOFError
+        data += chunk
+
+    return data
+
+
+def recv_message(sock, max_fds=0):
+    fds = array.array('i')
+
+    if max_fds:
+        data, ancillary, flags, address = sock.recvmsg(
+            4, socket.CMSG_SPACE(max_fds * fds.itemsize))
+
+        for level, type, cmsg_data in ancillary:
+            if level == socket.SOL_SOCKET and type == socket.SCM_RIGHTS:
+                fds.frombytes(cmsg_data[:len(cmsg_data) -
+                                        (len(cmsg_data) % fds.itemsize)])
+
+        if not data:
+            raise EOFError
+
+        data += recv_exactly(sock, 4 - len(data))
+    else:
+        data = recv_exactly(sock, 4)
+
+    size, = struct.unpack('!I', data)
+    message = json.loads(recv_exactly(sock, size).decode('utf-8'))
+
+    return message, list(fds)
+
+
+#  the launcher  #
+
+def run_directly():
+    os.execv(sys.executable, [sys.executable] + sys.argv[1:])
+
+
+def connect(path):
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+
+    try:
+        sock.connect(path)
+    except OSError:
+        sock.close()
+        return None
+
+    return sock
+
+
+def start_host(path, gimp_pid):
+    import subprocess
+
+    subprocess.Popen([sys.executable, os.path.abspath(__file__),
+                      '--serve', path, str(gimp_pid)],
+                     stdin=subprocess.DEVNULL,
+                     stdout=subprocess.DEVNULL,
+                     stderr=subprocess.DEVNULL,
+                     close_fds=True,
+                     start_new_session=True)
+
+    deadline = time.monotonic() + HOST_START_TIMEOUT
+
+    while time.monotonic() < deadline:
+        sock = connect(path)
+        if sock:
+            return sock
+
+        time.sleep(0.02)
+
+    return None
+
+
+def launch():
+    import signal
+
+    args = sys.argv[1:]
+
+    # only plug-ins run by GIMP go through the host
+    if (os.environ.get('GIMP_PYTHON_HOST', '1') == '0' or
+        len(args) < 6 or args[1] != '-gimp'):
+        run_directly()
+
+    gimp_pid = os.getppid()
+    path     = get_socket_path(gimp_pid)
+
+    if not path:
+        run_directly()
+
+    sock = connect(path) or start_host(path, gimp_pid)
+
+    if not sock:
+        run_directly()
+
+    try:
+        read_fd  = int(args[3])
+        write_fd = int(args[4])
+
+        targets = [0, 1, 2, read_fd, write_fd]
+
+        send_message(sock,
+                     { 'argv':    args,
+                       'cwd':     os.getcwd(),
+                       'env':     dict(os.environ),
+                       'targets': targets },
+                     targets)
+
+        message, fds = recv_message(sock)
+        pid = message['pid']
+    except (OSError, EOFError, ValueError, KeyError):
+        sock.close()
+        run_directly()
+
+    # the plug-in owns the wire now, GIMP must see it close when the
+    # plug-in exits
+    os.close(read_fd)
+    os.close(write_fd)
+
+    def forward(signum, frame):
+        try:
+            os.kill(pid, signum)
+        except OSError:
+            pass
+
+    for name in FORWARDED_SIGNALS:
+        signal.signal(getattr(signal, name), forward)
+
+    try:
+        message, fds = recv_message(sock)
+        status = message['status']
+    except (OSError, EOFError, ValueError, KeyError):
+        status = 1
+
+    sys.exit(128 - status if status < 0 else status)
+
+
+#  the host  #
+
+def preload():
+    # whatever fails to load here is loaded by the plug-ins themselves
+    try:
+        import gi
+
+        gi.require_version('Babl', '0.1')
+        gi.require_version('Gegl', '0.4')
+        gi.require_version('Gimp', '3.0')
+        gi.require_version('GimpUi', '3.0')
+        gi.require_version('Gtk', '3.0')
+
+        from gi.repository import Babl, Gegl, Gimp, GLib, GObject, Gio
+
+        # importing Gtk or GimpUi initializes GTK, which can't be shared
+        # by the forked plug-ins, only load their typelibs
+        from gi.repository import GIRepository
+
+        repository = GIRepository.Repository.get_default()
+        repository.require('GimpUi', '3.0', 0)
+        repository.require('Gtk', '3.0', 0)
+    except Exception:
+        pass
+
+    import gettext, locale, runpy, traceback
+
+
+def run_plug_in(message, fds):
+    import fcntl
+    import runpy
+
+    targets = message['targets']
+
+    # take over the launcher's streams and wire, moving the received
+    # descriptors out of the way of the targets first
+    moved = [fcntl.fcntl(fd, fcntl.F_DUPFD, max(targets) + 1) for fd in fds]
+
+    for fd in fds:
+        os.close(fd)
+
+    for fd, target in zip(moved, targets):
+        os.dup2(fd, target, inheritable=True)
+        os.close(fd)
+
+    os.chdir(message['cwd'])
+
+    os.environ.clear()
+    os.environ.update(message['env'])
+
+    sys.argv = message['argv']
+    sys.stdin  = open(0, 'r', closefd=False)
+    sys.stdout = open(1, 'w', closefd=False)
+    sys.stderr = open(2, 'w', closefd=False)
+
+    sys.path[0] = os.path.dirname(os.path.abspath(sys.argv[0]))
+
+    status = 0
+
+    try:
+        runpy.run_path(sys.argv[0], run_name='__main__')
+    except SystemExit as e:
+        if e.code is None:
+            status = 0
+        elif isinstance(e.code, int):
+            status = e.code
+        else:
+            print(e.code, file=sys.stderr)
+            status = 1
+    except BaseException:
+        import traceback
+        traceback.print_exc()
+        status = 1
+
+    try:
+        sys.stdout.flush()
+        sys.stderr.flush()
+    except Exception:
+        pass
+
+    os._exit(status & 0xff)
+
+
+def serve(path, gimp_pid):
+    import selectors
+    import signal
+
+    listener = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    old_umask = os.umask(0o077)
+
+    try:
+        try:
+            listener.bind(path)
+        except OSError:
+            # another launcher started a host first
+            sock = connect(path)
+            if sock:
+                sock.close()
+                return
+
+            # or it's left around from a previous session with that pid
+            os.unlink(path)
+            listener.bind(path)
+    finally:
+        os.umask(old_umask)
+
+    listener.listen()
+
+    preload()
+
+    wakeup_r, wakeup_w = os.pipe()
+    os.set_blocking(wakeup_r, False)
+    os.set_blocking(wakeup_w, False)
+    signal.set_wakeup_fd(wakeup_w)
+    signal.signal(signal.SIGCHLD, lambda signum, frame: None)
+
+    selector = selectors.DefaultSelector()
+    selector.register(listener, selectors.EVENT_READ)
+    selector.register(wakeup_r, selectors.EVENT_READ)
+
+    children  = {}
+    last_used = time.monotonic()
+
+    while True:
+        for key, events in selector.select(HOST_POLL_INTERVAL):
+            if key.fileobj is listener:
+                conn, address = listener.accept()
+
+                # only serve the user running GIMP
+                if hasattr(socket, 'SO_PEERCRED'):
+                    creds = conn.getsockopt(socket.SOL_SOCKET,
+                                            socket.SO_PEERCRED,
+                                            struct.calcsize('3i'))
+                    peer_pid, uid, gid = struct.unpack('3i', creds)
+
+                    if uid != os.getuid():
+                        conn.close()
+                        continue
+
+                try:
+                    message, fds = recv_message(conn, 5)
+                except (OSError, EOFError, ValueError):
+                    conn.close()
+                    continue
+
+                pid = os.fork()
+
+                if pid == 0:
+                    selector.close()
+                    listener.close()
+                    os.close(wakeup_r)
+                    os.close(wakeup_w)
+                    signal.set_wakeup_fd(-1)
+                    signal.signal(signal.SIGCHLD, signal.SIG_DFL)
+
+                    for other in children.values():
+                        other.close()
+                    conn.close()
+
+                    run_plug_in(message, fds)
+
+                for fd in fds:
+                    os.close(fd)
+
+                try:
+                    send_message(conn, { 'pid': pid })
+                except OSError:
+                    pass
+
+                children[pid] = conn
+                last_used     = time.monotonic()
+            else:
+                try:
+                    while os.read(wakeup_r, 512):
+                        pass
+                except BlockingIOError:
+                    pass
+
+        while children:
+            try:
+                pid, wait_status = os.waitpid(-1, os.WNOHANG)
+            except ChildProcessError:
+                break
+
+            if pid == 0:
+                break
+
+            conn = children.pop(pid, None)
+
+            if conn:
+                try:
+                    send_message(conn,
+                                 { 'status': os.waitstatus_to_exitcode(wait_status) })
+                except OSError:
+                    pass
+
+                conn.close()
+
+        if children:
+            last_used = time.monotonic()
+
+        try:
+            os.kill(gimp_pid, 0)
+            gimp_running = True
+        except ProcessLookupError:
+            gimp_running = False
+        except PermissionError:
+            gimp_running = True
+
+        if (not children and
+            (not gimp_running or
+             time.monotonic() - last_used > HOST_IDLE_TIMEOUT)):
+            break
+
+    try:
+        os.unlink(path)
+    except OSError:
+        pass
+
+
+if __name__ == '__main__':
+    if len(sys.argv) == 4 and sys.argv[1] == '--serve':
+        serve(sys.argv[2], int(sys.argv[3]))
+    else:
+        launch()
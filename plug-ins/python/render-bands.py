@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Flattens a huge XCF file by rendering horizontal bands of it in
+several GIMP processes, possibly on other machines, and exports the
+assembled result.
+
+Each worker is a batch mode GIMP started with one of the worker
+commands, for instance "gimp-console-3.0" to use a local process, or
+"ssh node1 gimp-console-3.0" for a remote one.  Repeat a command to
+run several workers on the same machine.  Workers load the XCF file,
+crop it to their band, which only keeps the pixels of the band in each
+layer, merge the visible layers and save the band next to the output
+file.  Remote workers must therefore see the XCF file and the output
+directory under the same paths, for instance over a network file
+system.
+
+The bands are added to the output image as they arrive, and merged in
+a single pass at the end, before exporting the output file.
+"""
+
+import concurrent.futures
+import os
+import shlex
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+
+import gi
+gi.require_version('Gimp', '3.0')
+from gi.repository import Gimp
+from gi.repository import GObject
+from gi.repository import GLib
+from gi.repository import Gio
+
+def N_(message): return message
+def _(message): return GLib.dgettext(None, message)
+
+# Run by python-fu-eval in each worker.
+band_code = """
+procedure = Gimp.get_pdb().lookup_procedure('python-fu-render-band')
+config = procedure.create_config()
+config.set_property('file', Gio.File.new_for_path({file!r}))
+config.set_property('band-file', Gio.File.new_for_path({band_file!r}))
+config.set_property('y', {y})
+config.set_property('height', {height})
+result = procedure.run(config)
+if result.index(0) != Gimp.PDBStatusType.SUCCESS:
+    raise Exception(result.index(1))
+"""
+
+def xcf_get_size(path):
+    """ Reads the image size from the XCF header, without loading the file. """
+    with open(path, "rb") as xcf:
+        header = xcf.read(22)
+
+    if len(header) < 22 or not header.startswith(b"gimp xcf "):
+        raise ValueError(_("'{}' is not an XCF file").format(path))
+
+    return struct.unpack(">II", header[14:22])
+
+def render_band(worker, path, band_path, y, height):
+    cmd = shlex.split(worker) + [
+        "--core-only", "--no-data",
+        "--batch-interpreter=python-fu-eval",
+        "-b", band_code.format(file=path, band_file=band_path,
+                               y=y, height=height),
+        "--quit"
+    ]
+
+    result = subprocess.run(cmd, stdin=subprocess.DEVNULL,
+                            stdout=subprocess.DEVNULL,
+                            stderr=subprocess.PIPE,
+                            universal_newlines=True)
+
+    if result.returncode != 0 or not os.path.exists(band_path):
+        raise RuntimeError(_("Rendering the band at {} with '{}' failed:\n{}").format(
+                           y, worker, result.stderr[-2000:]))
+
+    return y, band_path
+
+def render_bands(procedure, config, data):
+    xcf_file    = config.get_property("file")
+    output_file = config.get_property("output-file")
+    band_height = config.get_property("band-height")
+    workers     = config.get_property("workers")
+
+    if xcf_file is None or output_file is None:
+        return procedure.new_return_values(Gimp.PDBStatusType.CALLING_ERROR,
+                                           GLib.Error(_("No file given")))
+
+    workers = [w.strip() for w in workers.split(";") if w.strip()]
+    if not workers:
+        version = Gimp.version().split(".")
+        workers = ["gimp-console-{}.{}".format(version[0], version[1])]
+
+    path = xcf_file.get_path()
+
+    try:
+        width, height = xcf_get_size(path)
+    except (OSError, ValueError) as error:
+        return procedure.new_return_values(Gimp.PDBStatusType.EXECUTION_ERROR,
+                                           GLib.Error(str(error)))
+
+    bands = [(y, min(band_height, height - y))
+             for y in range(0, height, band_height)]
+
+    # Each worker command runs one band at a time, there are as many
+    # threads as workers, so there is always an idle one.
+    idle_workers = list(workers)
+    lock         = threading.Lock()
+
+    def run_band(y, h, band_path):
+        with lock:
+            worker = idle_workers.pop()
+        try:
+            return render_band(worker, path, band_path, y, h)
+        finally:
+            with lock:
+                idle_workers.append(worker)
+
+    output_dir = os.path.dirname(output_file.get_path())
+    band_dir   = tempfile.mkdtemp(prefix=".render-bands-", dir=output_dir)
+    executor   = concurrent.futures.ThreadPoolExecutor(len(workers))
+    image      = None
+
+    Gimp.progress_init(_("Rendering bands"))
+
+    try:
+        futures = [executor.submit(run_band, y, h,
+                                   os.path.join(band_dir, "band-{:06d}.xcf".format(y)))
+                   for y, h in bands]
+        done = 0
+
+        for future in concurrent.futures.as_completed(futures):
+            y, band_path = future.result()
+            band_file    = Gio.File.new_for_path(band_path)
+
+            # The first band decides the precision of the output.
+            if image is None:
+                image = Gimp.file_load(Gimp.RunMode.NONINTERACTIVE, band_file)
+                image.resize(width, height, 0, y)
+            else:
+                layer = Gimp.file_load_layer(Gimp.RunMode.NONINTERACTIVE,
+                                             image, band_file)
+                image.insert_layer(layer, None, 0)
+                layer.set_offsets(0, y)
+
+            os.remove(band_path)
+
+            done += 1
+            Gimp.progress_update(done / len(bands))
+
+        image.merge_visible_layers(Gimp.MergeType.CLIP_TO_IMAGE)
+
+        if not Gimp.file_save(Gimp.RunMode.NONINTERACTIVE, image, output_file, None):
+            raise RuntimeError(_("Exporting '{}' failed").format(output_file.get_path()))
+    except Exception as error:
+        return procedure.new_return_values(Gimp.PDBStatusType.EXECUTION_ERROR,
+                                           GLib.Error(str(error)))
+    finally:
+        # Don't start the remaining bands after a failure, but let the
+        # running workers finish before removing their directory.
+        executor.shutdown(wait=True, cancel_futures=True)
+
+        if image is not None:
+            image.delete()
+        shutil.rmtree(band_dir, ignore_errors=True)
+
+    return procedure.new_return_values(Gimp.PDBStatusType.SUCCESS, GLib.Error())
+
+def render_band_run(procedure, config, data):
+    xcf_file  = config.get_property("file")
+    band_file = config.get_property("band-file")
+    y         = config.get_property("y")
+    height    = config.get_property("height")
+
+    image = Gimp.file_load(Gimp.RunMode.NONINTERACTIVE, xcf_file)
+    if image is None:
+        return procedure.new_return_values(Gimp.PDBStatusType.EXECUTION_ERROR,
+                                           GLib.Error(_("Could not open '{}'").format(xcf_file.get_path())))
+
+    # Cropping first, so that merging only composites the band.
+    image.crop(image.get_width(), min(height, image.get_height() - y), 0, y)
+    image.merge_visible_layers(Gimp.MergeType.CLIP_TO_IMAGE)
+
+    success = Gimp.file_save(Gimp.RunMode.NONINTERACTIVE, image, band_file, None)
+    image.delete()
+
+    if not success:
+        return procedure.new_return_values(Gimp.PDBStatusType.EXECUTION_ERROR,
+                                           GLib.Error(_("Could not save '{}'").format(band_file.get_path())))
+
+    return procedure.new_return_values(Gimp.PDBStatusType.SUCCESS, GLib.Error())
+
+class RenderBands (Gimp.PlugIn):
+    ## GimpPlugIn virtual methods ##
+    def do_set_i18n(self, procname):
+        return True, 'gimp30-python', None
+
+    def do_query_procedures(self):
+        return [ 'python-fu-render-bands',
+                 'python-fu-render-band' ]
+
+    def do_create_procedure(self, name):
+        if name == 'python-fu-render-bands':
+            procedure = Gimp.Procedure.new(self, name,
+                                           Gimp.PDBProcType.PLUGIN,
+                                           render_bands, None)
+            procedure.set_documentation (_("Flatten a huge XCF file in bands, over several GIMP processes"),
+                                         globals()["__doc__"],
+                                         name)
+            procedure.add_file_argument ("file", _("_File"),
+                                         _("The XCF file to flatten"),
+                                         Gimp.FileChooserAction.OPEN,
+                                         False, None, GObject.ParamFlags.READWRITE)
+            procedure.add_file_argument ("output-file", _("_Output file"),
+                                         _("The file to export the flattened image to"),
+                                         Gimp.FileChooserAction.SAVE,
+                                         False, None, GObject.ParamFlags.READWRITE)
+            procedure.add_int_argument ("band-height", _("_Band height"),
+                                        _("Height of the band rendered by each job"),
+                                        1, GLib.MAXINT, 4096, GObject.ParamFlags.READWRITE)
+            procedure.add_string_argument ("workers", _("_Workers"),
+                                           _("Commands starting a worker GIMP, separated by ';', "
+                                             "the local gimp-console if empty"),
+                                           "", GObject.ParamFlags.READWRITE)
+        elif name == 'python-fu-render-band':
+            procedure = Gimp.Procedure.new(self, name,
+                                           Gimp.PDBProcType.PLUGIN,
+                                           render_band_run, None)
+            procedure.set_documentation (_("Flatten a band of an XCF file"),
+                                         _("Flattens the rows from y to y + height of an XCF file "
+                                           "and saves them, as a worker of python-fu-render-bands"),
+                                         name)
+            procedure.add_file_argument ("file", _("_File"),
+                                         _("The XCF file to flatten"),
+                                         Gimp.FileChooserAction.OPEN,
+                                         False, None, GObject.ParamFlags.READWRITE)
+            procedure.add_file_argument ("band-file", _("_Band file"),
+                                         _("The file to save the band to"),
+                                         Gimp.FileChooserAction.SAVE,
+                                         False, None, GObject.ParamFlags.READWRITE)
+            procedure.add_int_argument ("y", _("_Y"), _("First row of the band"),
+                                        0, GLib.MAXINT, 0, GObject.ParamFlags.READWRITE)
+            procedure.add_int_argument ("height", _("_Height"), _("Height of the band"),
+                                        1, GLib.MAXINT, 1, GObject.ParamFlags.READWRITE)
+        else:
+            return None
+
+        procedure.set_attribution("GIMP Team",
+                                  "GIMP Team",
+                                  "2026")
+
+        return procedure
+
+Gimp.main(RenderBands.__gtype__, sys.argv)
@@ -79,6 +79,8 @@ script_fu_run_image_procedure (GimpProcedure        *procedure, /* GimpImageProc
   if (! script)
     return gimp_procedure_new_return_values (procedure, GIMP_PDB_CALLING_ERROR, NULL);
 
+  script_fu_scripts_load_deferred ();
+
   ts_set_run_mode (run_mode);
 
   /* Need Gegl.  Also inits ui, needed when mode is interactive. */
@@ -163,6 +165,8 @@ script_fu_run_regular_procedure (GimpProcedure        *procedure,
   if (! script)
     return gimp_procedure_new_return_values (procedure, GIMP_PDB_CALLING_ERROR, NULL);
 
+  script_fu_scripts_load_deferred ();
+
   /* Unlike ImageProcedure, run-mode is a prop in the config. */
   g_object_get (config, "run-mode", &run_mode, NULL);
   ts_set_run_mode (run_mode);
@@ -247,6 +251,8 @@ script_fu_run_procedure (GimpProcedure       *procedure,
                                              GIMP_PDB_CALLING_ERROR,
                                              NULL);
 
+  script_fu_scripts_load_deferred ();
+
   pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (config), &n_pspecs);
   gimp_procedure_get_aux_arguments (procedure, &n_aux_args);
 
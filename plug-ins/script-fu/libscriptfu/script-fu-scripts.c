@@ -17,6 +17,8 @@
 
 #include "config.h"
 
+#include <errno.h>
+#include <math.h>
 #include <string.h>
 #include <glib.h>
 
@@ -44,8 +46,13 @@
  *  Local Functions
  */
 
+static void             script_fu_scripts_load   (GimpPlugIn           *plug_in,
+                                                  GList                *paths,
+                                                  gboolean              use_cache);
 static void             script_fu_load_directory (GFile                *directory);
 static void             script_fu_load_script    (GFile                *file);
+static gboolean         script_fu_load_script_file
+                                                 (GFile                *file);
 static gboolean         script_fu_install_script (gpointer              foo,
                                                   GList                *scripts,
                                                   gpointer              data);
@@ -61,6 +68,17 @@ static gint             script_fu_menu_compare   (gconstpointer         a,
 static void             script_fu_try_map_menu           (SFScript     *script);
 static void             script_fu_append_script_to_tree  (SFScript     *script);
 
+static void             script_fu_cache_open             (void);
+static void             script_fu_cache_save             (void);
+static gboolean         script_fu_cache_replay           (GFile        *file,
+                                                          const gchar  *group);
+static void             script_fu_cache_record           (scheme       *sc,
+                                                          const gchar  *function,
+                                                          pointer       a);
+static gboolean         script_fu_cache_write_datum      (scheme       *sc,
+                                                          pointer       datum,
+                                                          GString      *str);
+
 /*
  *  Local variables
  */
@@ -68,6 +86,34 @@ static void             script_fu_append_script_to_tree  (SFScript     *script);
 static GTree *script_tree      = NULL;
 static GList *script_menu_list = NULL;
 
+/* The cache of script registrations, used by extension-script-fu.
+ *
+ * For each script file, it keeps the file's mtime and size,
+ * and the calls the script made to the registration functions,
+ * with their arguments as evaluated, written back as quoted Scheme data.
+ * An unchanged script is registered by interpreting those calls again,
+ * and the script itself is only loaded when any script is first run.
+ * All deferred scripts are loaded then, in their original order,
+ * since scripts may use functions defined by other scripts.
+ *
+ * The arguments can depend on the GIMP version (enum values)
+ * and on the language (strings marked for translation),
+ * so the cache is only used for the same version and languages.
+ */
+#define SCRIPT_FU_CACHE_FILE  "script-fu-scripts.cache"
+#define SCRIPT_FU_CACHE_GROUP "script-fu-cache"
+
+static GKeyFile   *script_cache          = NULL; /* as read */
+static GKeyFile   *script_new_cache      = NULL; /* as written */
+static gchar      *script_cache_group    = NULL; /* of the script being loaded */
+static GString    *script_cache_calls    = NULL; /* recorded, or NULL */
+static gboolean    script_cache_failed   = FALSE;
+static GHashTable *script_cache_groups   = NULL; /* proc name => group */
+static GHashTable *script_cache_replayed = NULL; /* groups */
+
+static GList      *deferred_scripts      = NULL; /* of GFile */
+static gboolean    loading_deferred      = FALSE;
+
 
 /*
  *  Function definitions
@@ -131,26 +177,8 @@ GTree *
 script_fu_scripts_load_into_tree ( GimpPlugIn *plug_in,
                                    GList      *paths)
 {
-  script_fu_scripts_clear_tree (plug_in);
+  script_fu_scripts_load (plug_in, paths, FALSE);
 
-  script_tree = g_tree_new ((GCompareFunc) g_utf8_collate);
-
-  if (paths)
-    {
-      GList *list;
-
-      for (list = paths; list; list = g_list_next (list))
-        {
-          script_fu_load_directory (list->data);
-        }
-    }
-
-  /*
-   * Assert result is not NULL, but may be an empty tree.
-   * When paths is NULL, or no scripts found at paths.
-   */
-
-  g_debug ("script_fu_find_scripts_into_tree found %i scripts", g_tree_nnodes (script_tree));
   return script_tree;
 }
 
@@ -171,13 +199,16 @@ void
 script_fu_find_scripts (GimpPlugIn *plug_in,
                         GList      *path)
 {
-  script_fu_scripts_load_into_tree (plug_in, path);
+  script_fu_scripts_load (plug_in, path, TRUE);
 
   /*  Now that all scripts are read in and sorted, tell gimp about them  */
   g_tree_foreach (script_tree,
                   (GTraverseFunc) script_fu_install_script,
                   plug_in);
 
+  /* Only after the install, which drops the scripts failing it. */
+  script_fu_cache_save ();
+
   script_menu_list = g_list_sort (script_menu_list,
                                   (GCompareFunc) script_fu_menu_compare);
 
@@ -202,6 +233,11 @@ script_fu_add_script (scheme  *sc,
   SFScript    *script;
   pointer      args_error;
 
+  if (loading_deferred)
+    return sc->NIL;
+
+  script_fu_cache_record (sc, "script-fu-register", a);
+
   /*  Check metadata args args are present */
   if (sc->vptr->list_length (sc, a) < 7)
     return foreign_error (sc, "script-fu-register: Not enough arguments", 0);
@@ -254,6 +290,11 @@ script_fu_add_script_filter (scheme  *sc,
   SFScript    *script;
   pointer      args_error;  /* a foreign_error or NIL. */
 
+  if (loading_deferred)
+    return sc->NIL;
+
+  script_fu_cache_record (sc, "script-fu-register-filter", a);
+
   /* Check metadata args args are present.
    * Has one more arg than script-fu-register.
    */
@@ -298,6 +339,11 @@ script_fu_add_script_regular (scheme  *sc,
   SFScript    *script;
   pointer      args_error;  /* a foreign_error or NIL. */
 
+  if (loading_deferred)
+    return sc->NIL;
+
+  script_fu_cache_record (sc, "script-fu-register-procedure", a);
+
   /* Check metadata args args are present.
    * Has two less arg than script-fu-register.
    * Last metadata arg is "copyright date"
@@ -333,6 +379,11 @@ script_fu_add_menu (scheme  *sc,
   const gchar *name;
   const gchar *path;
 
+  if (loading_deferred)
+    return sc->NIL;
+
+  script_fu_cache_record (sc, "script-fu-menu-register", a);
+
   /*  Check the length of a  */
   if (sc->vptr->list_length (sc, a) != 2)
     return foreign_error (sc, "Incorrect number of arguments for script-fu-menu-register", 0);
@@ -392,6 +443,11 @@ script_fu_add_i18n (scheme  *sc,
 
   g_debug ("%s", G_STRFUNC);
 
+  if (loading_deferred)
+    return sc->NIL;
+
+  script_fu_cache_record (sc, "script-fu-register-i18n", a);
+
   /*  Check arg count  */
   if (sc->vptr->list_length (sc, a) < 2)
     return foreign_error (sc, "script-fu-register-i18n takes two or three args", 0);
@@ -460,8 +516,70 @@ script_fu_scripts_are_loaded (void)
   return (script_tree != NULL);
 }
 
+/* Load the scripts which were registered from the cache
+ * and which were not loaded yet, so that their run functions
+ * and whatever else they define are defined.
+ * To be called before running any script.
+ * Their calls to the registration functions are ignored.
+ */
+void
+script_fu_scripts_load_deferred (void)
+{
+  GList *scripts;
+  GList *list;
+
+  if (! deferred_scripts)
+    return;
+
+  scripts = g_list_reverse (g_steal_pointer (&deferred_scripts));
+
+  g_debug ("%s: loading %i scripts", G_STRFUNC, g_list_length (scripts));
+
+  loading_deferred = TRUE;
+
+  for (list = scripts; list; list = g_list_next (list))
+    script_fu_load_script_file (list->data);
+
+  loading_deferred = FALSE;
+
+  g_list_free_full (scripts, g_object_unref);
+}
+
 /*  private functions  */
 
+static void
+script_fu_scripts_load (GimpPlugIn *plug_in,
+                        GList      *paths,
+                        gboolean    use_cache)
+{
+  script_fu_scripts_clear_tree (plug_in);
+
+  script_tree = g_tree_new ((GCompareFunc) g_utf8_collate);
+
+  /* Any deferred scripts are registered again, from the cache or not. */
+  g_list_free_full (g_steal_pointer (&deferred_scripts), g_object_unref);
+
+  if (use_cache)
+    script_fu_cache_open ();
+
+  if (paths)
+    {
+      GList *list;
+
+      for (list = paths; list; list = g_list_next (list))
+        {
+          script_fu_load_directory (list->data);
+        }
+    }
+
+  /*
+   * Assert result is not NULL, but may be an empty tree.
+   * When paths is NULL, or no scripts found at paths.
+   */
+
+  g_debug ("script_fu_find_scripts_into_tree found %i scripts", g_tree_nnodes (script_tree));
+}
+
 /* Load scripts from a directory tree.
  * Recursively, descending into subdirectories.
  * Only loads terminal files with suffix .scm.
@@ -526,37 +644,120 @@ script_fu_load_directory (GFile *directory)
 static void
 script_fu_load_script (GFile *file)
 {
-  if (gimp_file_has_extension (file, ".scm"))
+  GFileInfo *info;
+  gchar     *path;
+  gint64     mtime;
+  guint64    size;
+
+  if (! gimp_file_has_extension (file, ".scm"))
+    return;
+
+  if (! script_new_cache)
     {
-      gchar  *path    = g_file_get_path (file);
-      gchar  *escaped = script_fu_strescape (path);
-      gchar  *command;
-      GError *error   = NULL;
+      script_fu_load_script_file (file);
+      return;
+    }
 
-      command = g_strdup_printf ("(load \"%s\")", escaped);
-      g_free (escaped);
+  info = g_file_query_info (file,
+                            G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                            G_FILE_QUERY_INFO_NONE,
+                            NULL, NULL);
+  if (! info)
+    {
+      script_fu_load_script_file (file);
+      return;
+    }
 
-      if (! script_fu_run_command (command, &error))
-        {
-          gchar *message = g_strdup_printf (_("Error while loading %s:"),
-                                            gimp_file_get_utf8_name (file));
+  mtime = g_file_info_get_attribute_uint64 (info,
+                                            G_FILE_ATTRIBUTE_TIME_MODIFIED);
+  size  = g_file_info_get_size (info);
 
-          g_message ("%s\n\n%s", message, error->message);
+  g_object_unref (info);
 
-          g_clear_error (&error);
-          g_free (message);
+  /* A group name can't hold all the characters of a path. */
+  path = g_file_get_path (file);
+  script_cache_group = g_compute_checksum_for_string (G_CHECKSUM_MD5,
+                                                      path, -1);
+
+  if (script_cache &&
+      g_key_file_has_group (script_cache, script_cache_group) &&
+      g_key_file_get_int64 (script_cache, script_cache_group,
+                            "mtime", NULL)  == mtime &&
+      g_key_file_get_uint64 (script_cache, script_cache_group,
+                             "size", NULL)  == size &&
+      script_fu_cache_replay (file, script_cache_group))
+    {
+      g_key_file_set_string (script_new_cache, script_cache_group,
+                             "path", path);
+      g_key_file_set_int64 (script_new_cache, script_cache_group,
+                            "mtime", mtime);
+      g_key_file_set_uint64 (script_new_cache, script_cache_group,
+                             "size", size);
+    }
+  else
+    {
+      script_cache_calls  = g_string_new (NULL);
+      script_cache_failed = FALSE;
+
+      if (script_fu_load_script_file (file) && ! script_cache_failed)
+        {
+          g_key_file_set_string (script_new_cache, script_cache_group,
+                                 "path", path);
+          g_key_file_set_int64 (script_new_cache, script_cache_group,
+                                "mtime", mtime);
+          g_key_file_set_uint64 (script_new_cache, script_cache_group,
+                                 "size", size);
+          g_key_file_set_string (script_new_cache, script_cache_group,
+                                 "calls", script_cache_calls->str);
         }
 
+      g_string_free (g_steal_pointer (&script_cache_calls), TRUE);
+    }
+
+  g_clear_pointer (&script_cache_group, g_free);
+  g_free (path);
+}
+
+/* Interpret a script file.
+ * Returns whether it was interpreted without errors.
+ */
+static gboolean
+script_fu_load_script_file (GFile *file)
+{
+  gchar    *path    = g_file_get_path (file);
+  gchar    *escaped = script_fu_strescape (path);
+  gchar    *command;
+  GError   *error   = NULL;
+  gboolean  success;
+
+  command = g_strdup_printf ("(load \"%s\")", escaped);
+  g_free (escaped);
+
+  success = script_fu_run_command (command, &error);
+
+  if (! success)
+    {
+      gchar *message = g_strdup_printf (_("Error while loading %s:"),
+                                        gimp_file_get_utf8_name (file));
+
+      g_message ("%s\n\n%s", message, error->message);
+
+      g_clear_error (&error);
+      g_free (message);
+    }
+
 #ifdef G_OS_WIN32
-      /* No, I don't know why, but this is
-       * necessary on NT 4.0.
-       */
-      Sleep (0);
+  /* No, I don't know why, but this is
+   * necessary on NT 4.0.
+   */
+  Sleep (0);
 #endif
 
-      g_free (command);
-      g_free (path);
-    }
+  g_free (command);
+  g_free (path);
+
+  return success;
 }
 
 /* This is-a GTraverseFunction.
@@ -576,11 +777,28 @@ script_fu_install_script (gpointer  foo G_GNUC_UNUSED,
     {
       SFScript *script = list->data;
 
-      const gchar* name = script->name;
-      if (script_fu_is_defined (name))
-        script_fu_script_install_proc (plug_in, script);
+      const gchar* name  = script->name;
+      const gchar* group = NULL;
+
+      if (script_cache_groups)
+        group = g_hash_table_lookup (script_cache_groups, name);
+
+      /* The run function of a script registered from the cache
+       * is not defined yet, but it was when the script was cached.
+       */
+      if ((group && g_hash_table_contains (script_cache_replayed, group)) ||
+          script_fu_is_defined (name))
+        {
+          script_fu_script_install_proc (plug_in, script);
+        }
       else
-        g_warning ("Run function not defined, or does not match PDB procedure name: %s", name);
+        {
+          g_warning ("Run function not defined, or does not match PDB procedure name: %s", name);
+
+          /* Check the script again next time. */
+          if (group)
+            g_key_file_remove_group (script_new_cache, group, NULL);
+        }
     }
 
   return FALSE;
@@ -799,4 +1017,285 @@ script_fu_append_script_to_tree (SFScript *script)
 
   g_tree_insert (script_tree, (gpointer) script->menu_label,
                   g_list_append (list, script));
+
+  if (script_cache_group)
+    g_hash_table_insert (script_cache_groups,
+                         g_strdup (script->name),
+                         g_strdup (script_cache_group));
+}
+
+/* Start using the cache, reading any cache file of the same
+ * GIMP version and languages.
+ */
+static void
+script_fu_cache_open (void)
+{
+  gchar *filename;
+  gchar *languages;
+
+  g_clear_pointer (&script_cache,          g_key_file_unref);
+  g_clear_pointer (&script_new_cache,      g_key_file_unref);
+  g_clear_pointer (&script_cache_groups,   g_hash_table_unref);
+  g_clear_pointer (&script_cache_replayed, g_hash_table_unref);
+
+  filename  = g_build_filename (gimp_cache_directory (),
+                                SCRIPT_FU_CACHE_FILE, NULL);
+  languages = g_strjoinv (":", (gchar **) g_get_language_names ());
+
+  script_cache = g_key_file_new ();
+
+  if (! g_key_file_load_from_file (script_cache, filename,
+                                   G_KEY_FILE_NONE, NULL))
+    {
+      g_clear_pointer (&script_cache, g_key_file_unref);
+    }
+  else
+    {
+      gchar *version;
+      gchar *cache_languages;
+
+      version         = g_key_file_get_string (script_cache,
+                                               SCRIPT_FU_CACHE_GROUP,
+                                               "version", NULL);
+      cache_languages = g_key_file_get_string (script_cache,
+                                               SCRIPT_FU_CACHE_GROUP,
+                                               "languages", NULL);
+
+      if (g_strcmp0 (version, GIMP_VERSION) ||
+          g_strcmp0 (cache_languages, languages))
+        g_clear_pointer (&script_cache, g_key_file_unref);
+
+      g_free (version);
+      g_free (cache_languages);
+    }
+
+  script_new_cache = g_key_file_new ();
+
+  g_key_file_set_string (script_new_cache, SCRIPT_FU_CACHE_GROUP,
+                         "version", GIMP_VERSION);
+  g_key_file_set_string (script_new_cache, SCRIPT_FU_CACHE_GROUP,
+                         "languages", languages);
+
+  script_cache_groups   = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                 g_free, g_free);
+  script_cache_replayed = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                 g_free, NULL);
+
+  g_free (languages);
+  g_free (filename);
+}
+
+/* Write the cache, if it changed, and stop using it. */
+static void
+script_fu_cache_save (void)
+{
+  gchar *data;
+  gchar *old_data = NULL;
+  gsize  length;
+
+  if (! script_new_cache)
+    return;
+
+  data = g_key_file_to_data (script_new_cache, &length, NULL);
+
+  if (script_cache)
+    old_data = g_key_file_to_data (script_cache, NULL, NULL);
+
+  if (g_strcmp0 (data, old_data))
+    {
+      gchar  *filename = g_build_filename (gimp_cache_directory (),
+                                           SCRIPT_FU_CACHE_FILE, NULL);
+      GError *error    = NULL;
+
+      if (g_mkdir_with_parents (gimp_cache_directory (), 0700) ||
+          ! g_file_set_contents (filename, data, length, &error))
+        {
+          g_debug ("%s: could not write %s: %s", G_STRFUNC, filename,
+                   error ? error->message : g_strerror (errno));
+          g_clear_error (&error);
+        }
+
+      g_free (filename);
+    }
+
+  g_free (old_data);
+  g_free (data);
+
+  g_clear_pointer (&script_cache,          g_key_file_unref);
+  g_clear_pointer (&script_new_cache,      g_key_file_unref);
+  g_clear_pointer (&script_cache_groups,   g_hash_table_unref);
+  g_clear_pointer (&script_cache_replayed, g_hash_table_unref);
+}
+
+/* Register a script by interpreting its cached calls,
+ * and defer loading it.
+ * Returns FALSE when the script must be loaded now instead.
+ */
+static gboolean
+script_fu_cache_replay (GFile       *file,
+                        const gchar *group)
+{
+  gchar  *calls;
+  GError *error = NULL;
+
+  calls = g_key_file_get_string (script_cache, group, "calls", NULL);
+
+  if (! calls)
+    return FALSE;
+
+  if (*calls && ! script_fu_run_command (calls, &error))
+    {
+      /* Not expected, the script registered fine when it was cached. */
+      g_debug ("%s: %s", G_STRFUNC, error->message);
+      g_clear_error (&error);
+      g_free (calls);
+
+      return FALSE;
+    }
+
+  g_free (calls);
+
+  g_hash_table_add (script_cache_replayed, g_strdup (group));
+
+  deferred_scripts = g_list_prepend (deferred_scripts, g_object_ref (file));
+
+  return TRUE;
+}
+
+/* Append a call to a registration function, as evaluated,
+ * to the calls of the script being loaded.
+ */
+static void
+script_fu_cache_record (scheme      *sc,
+                        const gchar *function,
+                        pointer      a)
+{
+  if (! script_cache_calls || script_cache_failed)
+    return;
+
+  g_string_append_printf (script_cache_calls, "(%s", function);
+
+  for (; sc->vptr->is_pair (a); a = sc->vptr->pair_cdr (a))
+    {
+      g_string_append (script_cache_calls, " '");
+
+      if (! script_fu_cache_write_datum (sc, sc->vptr->pair_car (a),
+                                         script_cache_calls))
+        {
+          /* Don't cache the script, it is always loaded. */
+          script_cache_failed = TRUE;
+          return;
+        }
+    }
+
+  g_string_append (script_cache_calls, ")\n");
+}
+
+/* Write datum in a form the reader reads back, when quoted.
+ * Only the kinds of data expected as arguments to the registration
+ * functions are handled, returns FALSE for anything else.
+ */
+static gboolean
+script_fu_cache_write_datum (scheme  *sc,
+                             pointer  datum,
+                             GString *str)
+{
+  if (datum == sc->NIL)
+    {
+      g_string_append (str, "()");
+    }
+  else if (datum == sc->T)
+    {
+      g_string_append (str, "#t");
+    }
+  else if (datum == sc->F)
+    {
+      g_string_append (str, "#f");
+    }
+  else if (sc->vptr->is_string (datum))
+    {
+      const gchar *p;
+
+      g_string_append_c (str, '"');
+
+      for (p = sc->vptr->string_value (datum); *p; p++)
+        {
+          switch (*p)
+            {
+            case '"':
+            case '\\':
+              g_string_append_c (str, '\\');
+              g_string_append_c (str, *p);
+              break;
+
+            case '\n':
+              g_string_append (str, "\\n");
+              break;
+
+            default:
+              g_string_append_c (str, *p);
+              break;
+            }
+        }
+
+      g_string_append_c (str, '"');
+    }
+  else if (sc->vptr->is_real (datum))
+    {
+      /* Test before is_integer, which is also true of 1.0. */
+      gchar   buf[G_ASCII_DTOSTR_BUF_SIZE];
+      gdouble value = sc->vptr->rvalue (datum);
+
+      if (! isfinite (value))
+        return FALSE;
+
+      g_ascii_dtostr (buf, sizeof (buf), value);
+      g_string_append (str, buf);
+
+      /* Else the reader would make it an integer. */
+      if (! strpbrk (buf, ".eE"))
+        g_string_append (str, ".0");
+    }
+  else if (sc->vptr->is_number (datum))
+    {
+      g_string_append_printf (str, "%ld", sc->vptr->ivalue (datum));
+    }
+  else if (sc->vptr->is_symbol (datum))
+    {
+      g_string_append (str, sc->vptr->symname (datum));
+    }
+  else if (sc->vptr->is_pair (datum))
+    {
+      g_string_append_c (str, '(');
+
+      while (TRUE)
+        {
+          if (! script_fu_cache_write_datum (sc, sc->vptr->pair_car (datum),
+                                             str))
+            return FALSE;
+
+          datum = sc->vptr->pair_cdr (datum);
+
+          if (! sc->vptr->is_pair (datum))
+            break;
+
+          g_string_append_c (str, ' ');
+        }
+
+      if (datum != sc->NIL)
+        {
+          g_string_append (str, " . ");
+
+          if (! script_fu_cache_write_datum (sc, datum, str))
+            return FALSE;
+        }
+
+      g_string_append_c (str, ')');
+    }
+  else
+    {
+      return FALSE;
+    }
+
+  return TRUE;
 }
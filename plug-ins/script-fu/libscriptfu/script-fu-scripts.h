@@ -34,6 +34,7 @@ pointer   script_fu_add_i18n      (scheme     *sc,
 GTree          * script_fu_scripts_load_into_tree (GimpPlugIn  *plug_in,
                                                    GList       *path);
 gboolean         script_fu_scripts_are_loaded     (void);
+void             script_fu_scripts_load_deferred  (void);
 SFScript       * script_fu_find_script            (const gchar *name);
 GList          * script_fu_get_menu_list          (void);
 
@@ -53,6 +53,10 @@
 #include <unistd.h>
 #endif
 
+#ifndef G_OS_WIN32
+#include <fcntl.h>
+#endif
+
 #ifdef HAVE_SYS_TIME_H
 #include <sys/time.h>
 #endif
@@ -98,9 +102,16 @@ typedef short sa_family_t; /* Not defined by winsock */
 #define CLOSESOCKET(fd) close(fd)
 #endif
 
-#define COMMAND_HEADER  3
-#define RESPONSE_HEADER 4
-#define MAGIC           'G'
+#define COMMAND_HEADER      3
+#define RESPONSE_HEADER     4
+#define MAGIC               'G'
+
+#define EXT_COMMAND_HEADER  5
+#define EXT_RESPONSE_HEADER 14
+#define EXT_MAGIC           'H'
+
+/*  the longest command an extended request may carry  */
+#define MAX_COMMAND_LEN     (64 << 20)
 
 #ifndef HAVE_DIFFTIME
 #define difftime(a,b) (((gdouble)(a)) - ((gdouble)(b)))
@@ -141,15 +152,47 @@ typedef short sa_family_t; /* Not defined by winsock */
 #define RSP_LEN_H_BYTE  2
 #define RSP_LEN_L_BYTE  3
 
+/*  Extended requests, starting with EXT_MAGIC instead of MAGIC, have
+ *  32 bit lengths, and their responses report how long the command
+ *  waited in the queue, and how long it ran, in microseconds.  All
+ *  numbers are big endian.
+ *
+ *  Header format for incoming extended commands...
+ *    bytes: 1          2 - 5
+ *           EXT_MAGIC  CMD_LEN
+ *
+ *  Header format for outgoing extended responses...
+ *    bytes: 1          2          3 - 6      7 - 10     11 - 14
+ *           EXT_MAGIC  ERROR?     RSP_LEN    QUEUE_TIME RUN_TIME
+ */
+
+#define EXT_CMD_LEN_BYTE    1
+
+#define EXT_RSP_LEN_BYTE    2
+#define EXT_QUEUE_TIME_BYTE 6
+#define EXT_RUN_TIME_BYTE   10
+
 /*
  *  Local Types
  */
 
 typedef struct
 {
-  gchar *command;
-  gint   filedes;
-  gint   request_no;
+  gint        ref_count;
+  gint        filedes;     /*  -1 once the client disconnected  */
+  gchar      *address;
+  GByteArray *input;       /*  received bytes not parsed yet    */
+  GByteArray *output;      /*  responses not sent yet           */
+  GQueue     *commands;    /*  the client's pending commands    */
+} SFClient;
+
+typedef struct
+{
+  gchar    *command;
+  SFClient *client;
+  gint      request_no;
+  gboolean  extended;
+  gint64    received_time;
 } SFCommand;
 
 typedef struct
@@ -174,6 +217,23 @@ typedef union
   struct sockaddr_in6      sa_in6;
 } sa_union;
 
+static inline guint32
+get_uint32 (const guchar *data)
+{
+  return ((guint32) data[0] << 24 | (guint32) data[1] << 16 |
+          (guint32) data[2] << 8  | (guint32) data[3]);
+}
+
+static inline void
+put_uint32 (guchar  *data,
+            guint32  value)
+{
+  data[0] = (guchar) (value >> 24);
+  data[1] = (guchar) (value >> 16);
+  data[2] = (guchar) (value >> 8);
+  data[3] = (guchar) (value & 0xFF);
+}
+
 /*
  *  Local Functions
  */
@@ -182,7 +242,14 @@ static void      server_start       (const gchar *listen_ip,
                                      gint         port,
                                      const gchar *logfile);
 static void      execute_command    (SFCommand   *cmd);
-static gint      read_from_client   (gint         filedes);
+static gint      read_from_client   (SFClient    *client);
+static gint      write_to_client    (SFClient    *client);
+static gboolean  parse_commands     (SFClient    *client);
+static SFCommand * next_command     (void);
+static void      free_command       (SFCommand   *cmd);
+static SFClient  * client_ref       (SFClient    *client);
+static void      client_unref       (SFClient    *client);
+static void      client_disconnect  (SFClient    *client);
 static gint      make_socket        (const struct addrinfo
                                                  *ai);
 static void      server_log         (const gchar *format,
@@ -204,7 +271,7 @@ static gint         server_socks[2],
                     server_socks_used = 0;
 static const gint   server_socks_len = sizeof (server_socks) /
                                        sizeof (server_socks[0]);
-static GList       *command_queue   = NULL;
+static GQueue      *ready_clients   = NULL;
 static gint         queue_length    = 0;
 static gint         request_no      = 0;
 static FILE        *server_log_file = NULL;
@@ -316,38 +383,31 @@ script_fu_server_add_fd (gpointer key,
                          gpointer value,
                          gpointer data)
 {
-  FD_SET (GPOINTER_TO_INT (key), (SELECT_MASK *) data);
+  SELECT_MASK **fds    = data;
+  SFClient     *client = value;
+
+  FD_SET (client->filedes, fds[0]);
+
+  if (client->output->len > 0)
+    FD_SET (client->filedes, fds[1]);
 }
 
 static gboolean
-script_fu_server_read_fd (gpointer key,
-                          gpointer value,
-                          gpointer data)
+script_fu_server_service_fd (gpointer key,
+                             gpointer value,
+                             gpointer data)
 {
-  gint fd = GPOINTER_TO_INT (key);
+  SELECT_MASK **fds    = data;
+  SFClient     *client = value;
 
-  if (FD_ISSET (fd, (SELECT_MASK *) data))
+  if ((FD_ISSET (client->filedes, fds[1]) && write_to_client (client) < 0) ||
+      (FD_ISSET (client->filedes, fds[0]) && read_from_client (client) < 0))
     {
-      if (read_from_client (fd) < 0)
-        {
-          GList *list;
-
-          server_log ("disconnect from host %s.\n", (gchar *) value);
+      server_log ("disconnect from host %s.\n", client->address);
 
-          CLOSESOCKET (fd);
+      client_disconnect (client);
 
-          /*  Invalidate the file descriptor for pending commands
-              from the disconnected client.  */
-          for (list = command_queue; list; list = list->next)
-            {
-              SFCommand *cmd = (SFCommand *) command_queue->data;
-
-              if (cmd->filedes == fd)
-                cmd->filedes = -1;
-            }
-
-          return TRUE;  /*  remove this client from the hash table  */
-        }
+      return TRUE;  /*  remove this client from the hash table  */
     }
 
   return FALSE;
@@ -358,28 +418,31 @@ script_fu_server_listen (gint timeout)
 {
   struct timeval  tv;
   struct timeval *tvp = NULL;
-  SELECT_MASK     fds;
+  SELECT_MASK     read_fds;
+  SELECT_MASK     write_fds;
+  SELECT_MASK    *fds[2] = { &read_fds, &write_fds };
   gint            sockno;
 
-  /*  Set time struct  */
-  if (timeout)
+  /*  Set time struct, don't wait if there are commands to run  */
+  if (timeout || ! g_queue_is_empty (ready_clients))
     {
       tv.tv_sec  = timeout / 1000;
       tv.tv_usec = timeout % 1000;
       tvp = &tv;
     }
 
-  FD_ZERO (&fds);
+  FD_ZERO (&read_fds);
+  FD_ZERO (&write_fds);
   for (sockno = 0; sockno < server_socks_used; sockno++)
     {
-      FD_SET (server_socks[sockno], &fds);
+      FD_SET (server_socks[sockno], &read_fds);
     }
-  g_hash_table_foreach (clients, script_fu_server_add_fd, &fds);
+  g_hash_table_foreach (clients, script_fu_server_add_fd, fds);
 
-  /* Block until input arrives on one or more active sockets
-     or timeout occurs. */
+  /* Block until input arrives on one or more active sockets,
+     a client can take more of its responses, or timeout occurs. */
 
-  if (select (FD_SETSIZE, &fds, NULL, NULL, tvp) < 0)
+  if (select (FD_SETSIZE, &read_fds, &write_fds, NULL, tvp) < 0)
     {
       print_socket_api_error ("select");
       return;
@@ -393,10 +456,11 @@ script_fu_server_listen (gint timeout)
 
       /* Connection request on original socket. */
       socklen_t                size = sizeof (client);
+      SFClient                *sf_client;
       gint                     new;
       guint                    portno;
 
-      if (! FD_ISSET (server_socks[sockno], &fds))
+      if (! FD_ISSET (server_socks[sockno], &read_fds))
         {
           continue;
         }
@@ -409,6 +473,19 @@ script_fu_server_listen (gint timeout)
           return;
         }
 
+      /*  A slow client must not hold up the others, never wait
+       *  for one to send or take data.
+       */
+#ifdef G_OS_WIN32
+      {
+        u_long nonblocking = 1;
+
+        ioctlsocket (new, FIONBIO, &nonblocking);
+      }
+#else
+      fcntl (new, F_SETFL, fcntl (new, F_GETFL) | O_NONBLOCK);
+#endif
+
       /*  Associate the client address with the socket  */
 
       /* If all else fails ... */
@@ -418,8 +495,16 @@ script_fu_server_listen (gint timeout)
       (void) getnameinfo (&(client.sa), size, clientname, sizeof (clientname),
                           NULL, 0, NI_NUMERICHOST);
 
-      g_hash_table_insert (clients, GINT_TO_POINTER (new),
-                           g_strdup (clientname));
+      sf_client = g_new0 (SFClient, 1);
+
+      sf_client->ref_count = 1;
+      sf_client->filedes   = new;
+      sf_client->address   = g_strdup (clientname);
+      sf_client->input     = g_byte_array_new ();
+      sf_client->output    = g_byte_array_new ();
+      sf_client->commands  = g_queue_new ();
+
+      g_hash_table_insert (clients, GINT_TO_POINTER (new), sf_client);
 
       /* Determine port number */
       switch (client.family)
@@ -439,7 +524,7 @@ script_fu_server_listen (gint timeout)
     }
 
   /* Service the client sockets. */
-  g_hash_table_foreach_remove (clients, script_fu_server_read_fd, &fds);
+  g_hash_table_foreach_remove (clients, script_fu_server_service_fd, fds);
 }
 
 static void
@@ -547,33 +632,34 @@ server_start (const gchar *listen_ip,
   if (! server_log_file)
     server_log_file = stdout;
 
-  /*  Set up the clientname hash table  */
-  clients = g_hash_table_new_full (g_direct_hash, NULL,
-                                   NULL, (GDestroyNotify) g_free);
+  /*  Set up the client hash table, and the queue of clients with
+   *  commands to run
+   */
+  clients = g_hash_table_new (g_direct_hash, NULL);
+  ready_clients = g_queue_new ();
 
   progress = server_progress_install ();
 
   server_log ("initialized and listening...\n");
 
-  /*  Loop until the server is finished  */
+  /*  Loop until the server is finished, running one command at a
+   *  time, taken from each client with commands in turn, and
+   *  servicing the sockets in between
+   */
   while (! script_fu_done)
     {
+      SFCommand *cmd;
+
       script_fu_server_listen (0);
 
-      while (command_queue)
-        {
-          SFCommand *cmd = (SFCommand *) command_queue->data;
+      cmd = next_command ();
 
+      if (cmd)
+        {
           execute_command (cmd);
 
-          /*  Remove the command from the list  */
-          command_queue = g_list_remove (command_queue, cmd);
-          queue_length--;
-
-          /*  Free the request  */
-          g_free (cmd->command);
-          g_free (cmd);
-      }
+          free_command (cmd);
+        }
     }
 
   server_progress_uninstall (progress);
@@ -636,15 +722,22 @@ get_interpretation_result (SFCommand *cmd, GString **script_stdout)
 static void
 execute_command (SFCommand *cmd)
 {
-  guchar      buffer[RESPONSE_HEADER];
+  guchar      buffer[EXT_RESPONSE_HEADER];
   GString    *response = NULL;
   time_t      clocknow;
   gdouble     total_time;
+  gint64      start_time;
+  gint64      queue_time;
+  gint64      run_time;
   GTimer     *timer;
   gboolean    is_script_error;
+  SFClient   *client = cmd->client;
 
   server_log ("Processing request #%d\n", cmd->request_no);
 
+  start_time = g_get_monotonic_time ();
+  queue_time = start_time - cmd->received_time;
+
   timer = g_timer_new ();
 
   is_script_error = get_interpretation_result (cmd, &response);
@@ -654,129 +747,310 @@ execute_command (SFCommand *cmd)
 
   server_log ("%s\n", response->str);
 
+  run_time   = g_get_monotonic_time () - start_time;
   total_time = g_timer_elapsed (timer, NULL);
   time (&clocknow);
-  server_log ("Request #%d processed in %.3f seconds, finishing on %s",
-              cmd->request_no, total_time, ctime (&clocknow));
+  server_log ("Request #%d processed in %.3f seconds, "
+              "after waiting %.3f seconds, finishing on %s",
+              cmd->request_no, total_time, queue_time / 1000000.0,
+              ctime (&clocknow));
 
   g_timer_destroy (timer);
 
-  buffer[MAGIC_BYTE]     = MAGIC;
-  buffer[ERROR_BYTE]     = is_script_error ? TRUE : FALSE;
-  buffer[RSP_LEN_H_BYTE] = (guchar) (response->len >> 8);
-  buffer[RSP_LEN_L_BYTE] = (guchar) (response->len & 0xFF);
-
-  /*  Write a header to the client, as one message. */
-  if (cmd->filedes > 0 &&
-      send (cmd->filedes, (const void *) (buffer), RESPONSE_HEADER, 0) < 0)
+  /*  The client may have gone while the command ran  */
+  if (client->filedes < 0)
     {
-      /*  Write error  */
-      g_debug ("%s error sending header", G_STRFUNC);
-      print_socket_api_error ("send");
       g_string_free (response, TRUE);
       return;
     }
 
-  /*  Write the script response to the client, as one message. */
-  if (cmd->filedes > 0 &&
-      send (cmd->filedes, response->str, response->len, 0) < 0)
+  /*  Queue the header and the script response for the client, they
+   *  are sent while servicing the sockets, as fast as it takes them.
+   */
+  if (cmd->extended)
     {
-      /*  Write error.  A client may have closed before taking all bytes.  */
-      g_debug ("%s error sending response", G_STRFUNC);
-      print_socket_api_error ("send");
-      g_string_free (response, TRUE);
-      return;
+      buffer[MAGIC_BYTE] = EXT_MAGIC;
+      buffer[ERROR_BYTE] = is_script_error ? TRUE : FALSE;
+
+      put_uint32 (buffer + EXT_RSP_LEN_BYTE,    response->len);
+      put_uint32 (buffer + EXT_QUEUE_TIME_BYTE, CLAMP (queue_time, 0, G_MAXUINT32));
+      put_uint32 (buffer + EXT_RUN_TIME_BYTE,   CLAMP (run_time,   0, G_MAXUINT32));
+
+      g_byte_array_append (client->output, buffer, EXT_RESPONSE_HEADER);
     }
+  else
+    {
+      /*  The header has room for 16 bits of length only  */
+      if (response->len > G_MAXUINT16)
+        {
+          server_log ("Response to request #%d truncated to %d bytes.\n",
+                      cmd->request_no, G_MAXUINT16);
+          g_string_truncate (response, G_MAXUINT16);
+        }
+
+      buffer[MAGIC_BYTE]     = MAGIC;
+      buffer[ERROR_BYTE]     = is_script_error ? TRUE : FALSE;
+      buffer[RSP_LEN_H_BYTE] = (guchar) (response->len >> 8);
+      buffer[RSP_LEN_L_BYTE] = (guchar) (response->len & 0xFF);
+
+      g_byte_array_append (client->output, buffer, RESPONSE_HEADER);
+    }
+
+  g_byte_array_append (client->output,
+                       (const guint8 *) response->str, response->len);
 
   g_string_free (response, TRUE);
 }
 
+/* Reads whatever the client sent, without waiting for more,
+ * and queues each complete command.
+ * Returns -1 when the client disconnected or sent garbage.
+ */
 static gint
-read_from_client (gint filedes)
+read_from_client (SFClient *client)
 {
-  SFCommand *cmd;
-  guchar     buffer[COMMAND_HEADER];
-  gchar     *command;
-  gchar     *clientaddr;
-  time_t     clock;
-  gint       command_len;
-  gint       nbytes;
-  gint       i;
-
-  for (i = 0; i < COMMAND_HEADER;)
+  guchar buffer[4096];
+  gint   nbytes;
+
+  while (TRUE)
     {
-      nbytes = recv (filedes, (void *) (buffer + i), COMMAND_HEADER - i, 0);
+      nbytes = recv (client->filedes, (void *) buffer, sizeof (buffer), 0);
 
       if (nbytes < 0)
         {
-#ifndef G_OS_WIN32
+#ifdef G_OS_WIN32
+          if (WSAGetLastError () == WSAEWOULDBLOCK)
+            break;
+#else
           if (errno == EINTR)
             continue;
+
+          if (errno == EAGAIN || errno == EWOULDBLOCK)
+            break;
 #endif
-          server_log ("Error reading command header.\n");
+          server_log ("Error reading from client.\n");
           return -1;
         }
 
       if (nbytes == 0)
         return -1;  /* EOF */
 
-      i += nbytes;
-    }
+      g_byte_array_append (client->input, buffer, nbytes);
 
-  if (buffer[MAGIC_BYTE] != MAGIC)
-    {
-      server_log ("Error in script-fu command transmission.\n");
-      return -1;
+      if (nbytes < (gint) sizeof (buffer))
+        break;
     }
 
-  command_len = (buffer [CMD_LEN_H_BYTE] << 8) | buffer [CMD_LEN_L_BYTE];
-  command = g_new (gchar, command_len + 1);
+  if (! parse_commands (client))
+    return -1;
+
+  return 0;
+}
 
-  for (i = 0; i < command_len;)
+/* Sends as much of the pending responses as the client takes.
+ * Returns -1 when the client disconnected.
+ */
+static gint
+write_to_client (SFClient *client)
+{
+  while (client->output->len > 0)
     {
-      nbytes = recv (filedes, command + i, command_len - i, 0);
+      gint nbytes;
 
-      if (nbytes <= 0)
+      nbytes = send (client->filedes, (const void *) client->output->data,
+                     client->output->len, 0);
+
+      if (nbytes < 0)
         {
-#ifndef G_OS_WIN32
-          if (nbytes < 0 && errno == EINTR)
+#ifdef G_OS_WIN32
+          if (WSAGetLastError () == WSAEWOULDBLOCK)
+            break;
+#else
+          if (errno == EINTR)
             continue;
+
+          if (errno == EAGAIN || errno == EWOULDBLOCK)
+            break;
 #endif
-           server_log ("Error reading command.  Read %d out of %d bytes.\n",
-                       i, command_len);
-           g_free (command);
-           return -1;
+          /*  A client may have closed before taking all bytes.  */
+          g_debug ("%s error sending response", G_STRFUNC);
+          print_socket_api_error ("send");
+          return -1;
         }
 
-      i += nbytes;
+      g_byte_array_remove_range (client->output, 0, nbytes);
     }
 
-  command[command_len] = '\0';
-  cmd = g_new (SFCommand, 1);
-
-  cmd->filedes    = filedes;
-  cmd->command    = command;
-  cmd->request_no = request_no ++;
-
-  /*  Add the command to the queue  */
-  command_queue = g_list_append (command_queue, cmd);
-  queue_length ++;
-
-  /*  Get the client address from the address/socket table  */
-  clientaddr = g_hash_table_lookup (clients, GINT_TO_POINTER (cmd->filedes));
-  time (&clock);
-  /* ! ctime has trailing newline so put it last. */
-  server_log ("received request #%d from IP address %s: %s,"
-              "[queue length: %d] on %s",
-              cmd->request_no,
-              clientaddr ? clientaddr : "<invalid>",
-              cmd->command,
-              queue_length,
-              ctime (&clock));
-
   return 0;
 }
 
+/* Takes the complete commands off the client's input, and queues
+ * them in the order they came, so a client may send several commands
+ * without waiting for the responses.
+ * Returns FALSE if the client sent garbage.
+ */
+static gboolean
+parse_commands (SFClient *client)
+{
+  gsize offset = 0;
+
+  while (client->input->len - offset > 0)
+    {
+      const guchar *data     = client->input->data + offset;
+      gsize         len      = client->input->len - offset;
+      gboolean      extended = FALSE;
+      gsize         header_len;
+      gsize         command_len;
+      SFCommand    *cmd;
+      time_t        clock;
+
+      if (data[MAGIC_BYTE] == MAGIC)
+        {
+          header_len = COMMAND_HEADER;
+
+          if (len < header_len)
+            break;
+
+          command_len = (data[CMD_LEN_H_BYTE] << 8) | data[CMD_LEN_L_BYTE];
+        }
+      else if (data[MAGIC_BYTE] == EXT_MAGIC)
+        {
+          header_len = EXT_COMMAND_HEADER;
+          extended   = TRUE;
+
+          if (len < header_len)
+            break;
+
+          command_len = get_uint32 (data + EXT_CMD_LEN_BYTE);
+
+          if (command_len > MAX_COMMAND_LEN)
+            {
+              server_log ("Command of %" G_GSIZE_FORMAT " bytes is too long.\n",
+                          command_len);
+              return FALSE;
+            }
+        }
+      else
+        {
+          server_log ("Error in script-fu command transmission.\n");
+          return FALSE;
+        }
+
+      if (len < header_len + command_len)
+        break;
+
+      cmd = g_new0 (SFCommand, 1);
+
+      cmd->command       = g_strndup ((const gchar *) data + header_len,
+                                      command_len);
+      cmd->client        = client_ref (client);
+      cmd->request_no    = request_no ++;
+      cmd->extended      = extended;
+      cmd->received_time = g_get_monotonic_time ();
+
+      /*  Add the command to the client's queue, and the client to the
+       *  ones waiting for their turn
+       */
+      if (g_queue_is_empty (client->commands))
+        g_queue_push_tail (ready_clients, client);
+
+      g_queue_push_tail (client->commands, cmd);
+      queue_length ++;
+
+      offset += header_len + command_len;
+
+      time (&clock);
+      /* ! ctime has trailing newline so put it last. */
+      server_log ("received request #%d from IP address %s: %s,"
+                  "[queue length: %d] on %s",
+                  cmd->request_no,
+                  client->address,
+                  cmd->command,
+                  queue_length,
+                  ctime (&clock));
+    }
+
+  g_byte_array_remove_range (client->input, 0, offset);
+
+  return TRUE;
+}
+
+/* Takes the next command to run, from the client whose turn it is,
+ * so that clients sending many commands don't starve the others.
+ */
+static SFCommand *
+next_command (void)
+{
+  SFClient  *client;
+  SFCommand *cmd;
+
+  client = g_queue_pop_head (ready_clients);
+
+  if (! client)
+    return NULL;
+
+  cmd = g_queue_pop_head (client->commands);
+  queue_length--;
+
+  if (! g_queue_is_empty (client->commands))
+    g_queue_push_tail (ready_clients, client);
+
+  return cmd;
+}
+
+static void
+free_command (SFCommand *cmd)
+{
+  client_unref (cmd->client);
+
+  g_free (cmd->command);
+  g_free (cmd);
+}
+
+static SFClient *
+client_ref (SFClient *client)
+{
+  client->ref_count++;
+
+  return client;
+}
+
+static void
+client_unref (SFClient *client)
+{
+  if (--client->ref_count == 0)
+    {
+      g_free (client->address);
+      g_byte_array_unref (client->input);
+      g_byte_array_unref (client->output);
+      g_queue_free (client->commands);
+      g_free (client);
+    }
+}
+
+/* Closes the client's socket, and drops its pending commands.
+ * The caller removes the client from the client hash table.
+ */
+static void
+client_disconnect (SFClient *client)
+{
+  SFCommand *cmd;
+
+  CLOSESOCKET (client->filedes);
+
+  client->filedes = -1;
+
+  g_queue_remove (ready_clients, client);
+
+  while ((cmd = g_queue_pop_head (client->commands)))
+    {
+      queue_length--;
+      free_command (cmd);
+    }
+
+  client_unref (client);
+}
+
 static gint
 make_socket (const struct addrinfo *ai)
 {
@@ -857,12 +1131,17 @@ server_log (const gchar *format,
     fflush (server_log_file);
 }
 
-static void
+static gboolean
 script_fu_server_shutdown_fd (gpointer key,
                               gpointer value,
                               gpointer data)
 {
-  shutdown (GPOINTER_TO_INT (key), 2);
+  SFClient *client = value;
+
+  shutdown (client->filedes, 2);
+  client_disconnect (client);
+
+  return TRUE;
 }
 
 static void
@@ -877,22 +1156,13 @@ server_quit (void)
 
   if (clients)
     {
-      g_hash_table_foreach (clients, script_fu_server_shutdown_fd, NULL);
+      g_hash_table_foreach_remove (clients, script_fu_server_shutdown_fd, NULL);
       g_hash_table_destroy (clients);
       clients = NULL;
     }
 
-  while (command_queue)
-    {
-      SFCommand *cmd = command_queue->data;
-
-      g_free (cmd->command);
-      g_free (cmd);
-    }
-
-  g_list_free (command_queue);
-  command_queue = NULL;
-  queue_length  = 0;
+  g_clear_pointer (&ready_clients, g_queue_free);
+  queue_length = 0;
 
   server_log ("quitting\n");
 
@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+
+"""
+performance-corpus.py -- Write the standard corpus of documents GIMP's
+                         performance is measured on
+Copyright (C) 2026  The GIMP Team
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Usage: GIMP_PERFORMANCE_CORPUS=outdir \\
+       [GIMP_TESTING_ABS_TOP_SRCDIR=srcdir (default: .)] \\
+       gimp-console-3 -idf --quit \\
+                      --batch-interpreter python-fu-eval \\
+                      --batch - < performance-corpus.py
+
+The documents are generated rather than distributed, from fixed seeds,
+so that every build measures the very same data:
+
+  huge.xcf          an 8192x8192 image of a few full-size layers
+  deep-stack.xcf    app/tests/files/gimp-2-6-file.xcf, under a stack of
+                    nested layer groups of various modes
+  text-heavy.psd    a page of many small text layers
+  scan-16bit.tif    a 16-bit RGB photo-sized scan
+
+The XCF files can be benchmarked with gimp-bench --corpus; all of them
+can be opened in a GIMP session recording a performance log.  The
+results of two builds are compared with performance-log-compare.py.
+"""
+
+import os
+
+from gi.repository import Gimp, Gio
+
+HUGE_SIZE         = 8192
+HUGE_N_LAYERS     = 4
+
+DEEP_N_GROUPS     = 16
+DEEP_N_LAYERS     = 8
+DEEP_MODES        = (Gimp.LayerMode.NORMAL,
+                     Gimp.LayerMode.MULTIPLY,
+                     Gimp.LayerMode.SCREEN,
+                     Gimp.LayerMode.OVERLAY,
+                     Gimp.LayerMode.DIFFERENCE,
+                     Gimp.LayerMode.HSV_HUE)
+
+TEXT_WIDTH        = 2480
+TEXT_HEIGHT       = 3508
+TEXT_N_LINES      = 120
+TEXT_SIZE         = 20
+
+SCAN_WIDTH        = 6000
+SCAN_HEIGHT       = 4000
+
+def noise_layer (image, name, width, height, seed):
+    layer = Gimp.Layer.new (image, name, width, height,
+                            Gimp.ImageType.RGBA_IMAGE
+                            if image.get_base_type () == Gimp.ImageBaseType.RGB
+                            else Gimp.ImageType.GRAYA_IMAGE,
+                            100.0, Gimp.LayerMode.NORMAL)
+
+    filter = Gimp.DrawableFilter.new (layer, "gegl:plasma", None)
+    filter.get_config ().set_property ("seed", seed)
+    layer.merge_filter (filter)
+
+    return layer
+
+def save (image, out_dir, name):
+    Gimp.file_save (Gimp.RunMode.NONINTERACTIVE, image,
+                    Gio.File.new_for_path (os.path.join (out_dir, name)),
+                    None)
+    image.delete ()
+
+def write_huge (out_dir):
+    image = Gimp.Image.new (HUGE_SIZE, HUGE_SIZE, Gimp.ImageBaseType.RGB)
+
+    for i in range (HUGE_N_LAYERS):
+        layer = noise_layer (image, "Layer %d" % i,
+                             HUGE_SIZE, HUGE_SIZE, i)
+        layer.set_opacity (100.0 / (i + 1))
+        image.insert_layer (layer, None, 0)
+
+    save (image, out_dir, "huge.xcf")
+
+def write_deep_stack (out_dir, src_dir):
+    base  = os.path.join (src_dir, "app", "tests", "files",
+                          "gimp-2-6-file.xcf")
+    image = Gimp.file_load (Gimp.RunMode.NONINTERACTIVE,
+                            Gio.File.new_for_path (base))
+
+    width  = image.get_width ()
+    height = image.get_height ()
+    parent = None
+
+    for i in range (DEEP_N_GROUPS):
+        group = Gimp.GroupLayer.new (image, "Group %d" % i)
+        group.set_mode (DEEP_MODES[i % len (DEEP_MODES)])
+        image.insert_layer (group, parent, 0)
+
+        for j in range (DEEP_N_LAYERS):
+            layer = noise_layer (image, "Layer %d.%d" % (i, j),
+                                 width // 2, height // 2,
+                                 i * DEEP_N_LAYERS + j)
+            layer.set_mode (DEEP_MODES[j % len (DEEP_MODES)])
+            layer.set_opacity (50.0)
+            layer.set_offsets ((j * width)  // (2 * DEEP_N_LAYERS),
+                               (j * height) // (2 * DEEP_N_LAYERS))
+            image.insert_layer (layer, group, 0)
+
+        parent = group
+
+    save (image, out_dir, "deep-stack.xcf")
+
+def write_text_heavy (out_dir):
+    image = Gimp.Image.new (TEXT_WIDTH, TEXT_HEIGHT, Gimp.ImageBaseType.RGB)
+    font  = Gimp.Font.get_by_name ("Sans-serif")
+    unit  = Gimp.Unit.pixel ()
+
+    background = Gimp.Layer.new (image, "Background",
+                                 TEXT_WIDTH, TEXT_HEIGHT,
+                                 Gimp.ImageType.RGB_IMAGE,
+                                 100.0, Gimp.LayerMode.NORMAL)
+    background.fill (Gimp.FillType.WHITE)
+    image.insert_layer (background, None, 0)
+
+    for i in range (TEXT_N_LINES):
+        text  = ("%d. The quick brown fox jumps over the lazy dog, "
+                 "again and again." % i)
+        layer = Gimp.TextLayer.new (image, text, font, TEXT_SIZE, unit)
+        image.insert_layer (layer, None, 0)
+        layer.set_offsets (TEXT_SIZE * 4,
+                           TEXT_SIZE * 4 +
+                           i * (TEXT_HEIGHT - TEXT_SIZE * 8) // TEXT_N_LINES)
+
+    save (image, out_dir, "text-heavy.psd")
+
+def write_scan_16bit (out_dir):
+    image = Gimp.Image.new_with_precision (SCAN_WIDTH, SCAN_HEIGHT,
+                                           Gimp.ImageBaseType.RGB,
+                                           Gimp.Precision.U16_NON_LINEAR)
+
+    layer = noise_layer (image, "Scan", SCAN_WIDTH, SCAN_HEIGHT, 0)
+    image.insert_layer (layer, None, 0)
+    image.flatten ()
+
+    save (image, out_dir, "scan-16bit.tif")
+
+out_dir = os.environ.get ("GIMP_PERFORMANCE_CORPUS", "performance-corpus")
+src_dir = os.environ.get ("GIMP_TESTING_ABS_TOP_SRCDIR", ".")
+
+os.makedirs (out_dir, exist_ok=True)
+
+write_huge       (out_dir)
+write_deep_stack (out_dir, src_dir)
+write_text_heavy (out_dir)
+write_scan_16bit (out_dir)
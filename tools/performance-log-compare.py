@@ -0,0 +1,262 @@
+#!/usr/bin/env python3
+
+"""
+performance-log-compare.py -- Compare the performance of two GIMP builds,
+                              flagging significant regressions
+Copyright (C) 2026  The GIMP Team
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+Usage: performance-log-compare.py [options] BASELINE CANDIDATE
+
+BASELINE and CANDIDATE are each a log, or a directory of logs of
+repeated runs, of either kind:
+
+  - the output of gimp-bench, whose metrics are the mean times of the
+    benchmarks, one sample per log;
+
+  - a performance log recorded by the Dashboard, whose metrics are its
+    numeric variables, one sample per log sample.
+
+Each metric is compared using the Mann-Whitney U test, and flagged as a
+regression when it got worse by more than --threshold, with a p-value
+below --alpha.  A metric getting worse means it increased, unless it is
+given with --higher-is-better.
+
+The exit status is 1 if any regression was found, so that builds can be
+gated on it, and 0 otherwise.
+"""
+
+import argparse
+import fnmatch
+import math
+import os
+import sys
+from xml.etree import ElementTree
+
+def read_bench_log (text, metrics):
+    for line in text.splitlines ():
+        if not line.strip () or line.startswith ("#"):
+            continue
+
+        fields = line.split ("\t")
+
+        if len (fields) < 3:
+            continue
+
+        try:
+            mean = float (fields[2])
+        except ValueError:
+            continue
+
+        metrics.setdefault (fields[0], []).append (mean)
+
+def read_dashboard_log (text, metrics):
+    try:
+        log = ElementTree.fromstring (text)
+    except ElementTree.ParseError:
+        sys.exit ("log is not well formed, try "
+                  "performance-log-close-tags.py first")
+
+    values = {}
+
+    for sample in log.iterfind ("samples/sample"):
+        vars = sample.find ("vars")
+
+        if vars is not None:
+            for var in vars:
+                try:
+                    values[var.tag] = float (var.text)
+                except (TypeError, ValueError):
+                    # unavailable, or a ratio
+                    values.pop (var.tag, None)
+
+        for name, value in values.items ():
+            metrics.setdefault (name, []).append (value)
+
+def read_log (path, metrics):
+    with open (path, "rb") as file:
+        text = file.read ().decode ("utf-8", errors="replace")
+
+    if text.lstrip ().startswith ("<"):
+        read_dashboard_log (text, metrics)
+    else:
+        read_bench_log (text, metrics)
+
+def read_logs (path):
+    metrics = {}
+
+    if os.path.isdir (path):
+        for name in sorted (os.listdir (path)):
+            filename = os.path.join (path, name)
+
+            if os.path.isfile (filename):
+                read_log (filename, metrics)
+    else:
+        read_log (path, metrics)
+
+    return metrics
+
+def median (values):
+    values = sorted (values)
+    n      = len (values)
+
+    if n % 2:
+        return values[n // 2]
+    else:
+        return (values[n // 2 - 1] + values[n // 2]) / 2
+
+def mann_whitney (a, b):
+    """Returns the two-sided p-value of the Mann-Whitney U test of 'a' and
+       'b', using the normal approximation, corrected for ties."""
+
+    n1 = len (a)
+    n2 = len (b)
+    n  = n1 + n2
+
+    values = sorted ([(value, 0) for value in a] +
+                     [(value, 1) for value in b])
+
+    rank_sum = 0.0
+    ties     = 0.0
+    i        = 0
+
+    while i < n:
+        j = i
+
+        while j + 1 < n and values[j + 1][0] == values[i][0]:
+            j += 1
+
+        rank = (i + j) / 2 + 1
+        t    = j - i + 1
+
+        rank_sum += rank * sum (1 for k in range (i, j + 1)
+                                if values[k][1] == 0)
+        ties     += t ** 3 - t
+
+        i = j + 1
+
+    u     = rank_sum - n1 * (n1 + 1) / 2
+    mean  = n1 * n2 / 2
+    var   = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)))
+
+    if var <= 0:
+        return 1.0
+
+    z = (abs (u - mean) - 0.5) / math.sqrt (var)
+
+    return min (1.0, math.erfc (max (z, 0.0) / math.sqrt (2)))
+
+def main ():
+    parser = argparse.ArgumentParser (
+        description="Compare the performance of two GIMP builds")
+    parser.add_argument ("baseline",
+                         help="baseline log, or directory of logs")
+    parser.add_argument ("candidate",
+                         help="candidate log, or directory of logs")
+    parser.add_argument ("-t", "--threshold", type=float, default=5.0,
+                         help="smallest change flagged, in percent "
+                              "(default: %(default)s)")
+    parser.add_argument ("-a", "--alpha", type=float, default=0.01,
+                         help="significance level (default: %(default)s)")
+    parser.add_argument ("-m", "--metric", action="append", default=[],
+                         metavar="PATTERN",
+                         help="only compare metrics matching PATTERN")
+    parser.add_argument ("--higher-is-better", action="append", default=[],
+                         metavar="PATTERN",
+                         help="metrics matching PATTERN improve when "
+                              "they increase")
+    parser.add_argument ("-q", "--quiet", action="store_true",
+                         help="only list significant changes")
+
+    args = parser.parse_args ()
+
+    baseline  = read_logs (args.baseline)
+    candidate = read_logs (args.candidate)
+
+    names = sorted (set (baseline) & set (candidate))
+
+    if args.metric:
+        names = [name for name in names
+                 if any (fnmatch.fnmatch (name, pattern)
+                         for pattern in args.metric)]
+
+    if not names:
+        sys.exit ("no metrics in common")
+
+    width       = max (len (name) for name in names)
+    regressions = 0
+    untested    = 0
+
+    print ("%-*s  %12s  %12s  %8s  %8s" %
+           (width, "metric", "baseline", "candidate", "change", "p"))
+
+    for name in names:
+        a = baseline[name]
+        b = candidate[name]
+
+        base_median = median (a)
+        cand_median = median (b)
+
+        if base_median:
+            change = (cand_median - base_median) / abs (base_median) * 100
+        elif cand_median:
+            change = math.copysign (math.inf, cand_median)
+        else:
+            change = 0.0
+
+        if any (fnmatch.fnmatch (name, pattern)
+                for pattern in args.higher_is_better):
+            worse = change < 0
+        else:
+            worse = change > 0
+
+        if len (a) < 2 or len (b) < 2:
+            p        = None
+            untested += 1
+        else:
+            p = mann_whitney (a, b)
+
+        significant = (p is not None and p < args.alpha and
+                       abs (change) >= args.threshold)
+
+        if significant and worse:
+            verdict      = "REGRESSION"
+            regressions += 1
+        elif significant:
+            verdict = "improvement"
+        else:
+            verdict = ""
+
+        if args.quiet and not significant:
+            continue
+
+        print (("%-*s  %12.6g  %12.6g  %+7.1f%%  %8s  %s" %
+                (width, name, base_median, cand_median, change,
+                 "%.2g" % p if p is not None else "n/a", verdict)).rstrip ())
+
+    if untested:
+        print ("\n%d metrics have less than 2 samples on a side and were "
+               "not tested; pass directories of repeated runs" % untested,
+               file=sys.stderr)
+
+    if regressions:
+        print ("\n%d significant regressions" % regressions,
+               file=sys.stderr)
+
+    return 1 if regressions else 0
+
+if __name__ == "__main__":
+    sys.exit (main ())
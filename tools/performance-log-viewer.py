@@ -199,6 +199,12 @@ var_types = {
         format_numeric = None
     ),
 
+    "time": VariableType (
+        parse          = float,
+        format         = lambda x: "%g ms" % (round (10000 * x) / 10),
+        format_numeric = None
+    ),
+
     "rate-of-change": VariableType (
         parse          = float,
         format         = lambda x: "%s/s" % format_size (x),